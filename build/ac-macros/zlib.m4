@@ -100,3 +100,61 @@ AC_DEFUN(SVN_ZLIB_PKG_CONFIG,
     fi
   fi
 ])
+
+dnl SVN_LIBDEFLATE()
+dnl Look for the optional libdeflate library, which provides a faster
+dnl one-shot implementation of zlib compatible compression.  Use it by
+dnl default if it can be found; --without-libdeflate disables it.
+AC_DEFUN(SVN_LIBDEFLATE,
+[
+  libdeflate_found=no
+  libdeflate_prefix=std
+
+  AC_ARG_WITH(libdeflate,AS_HELP_STRING([--with-libdeflate=PREFIX],
+                                        [use libdeflate for zlib compatible
+                                         compression [default=auto]]),
+  [
+    if test "$withval" = "no"; then
+      libdeflate_prefix=no
+    elif test "$withval" != "yes"; then
+      libdeflate_prefix="$withval"
+    fi
+  ])
+
+  if test "$libdeflate_prefix" != "no"; then
+    save_cppflags="$CPPFLAGS"
+    save_ldflags="$LDFLAGS"
+    libdeflate_includes=""
+    libdeflate_libs="-ldeflate"
+
+    if test "$libdeflate_prefix" = "std" && test -n "$PKG_CONFIG" \
+       && $PKG_CONFIG libdeflate --exists; then
+      libdeflate_includes=`$PKG_CONFIG libdeflate --cflags`
+      libdeflate_libs=`$PKG_CONFIG libdeflate --libs`
+      libdeflate_libs="`SVN_REMOVE_STANDARD_LIB_DIRS($libdeflate_libs)`"
+    elif test "$libdeflate_prefix" != "std"; then
+      libdeflate_includes="-I$libdeflate_prefix/include"
+      libdeflate_libs="`SVN_REMOVE_STANDARD_LIB_DIRS(-L$libdeflate_prefix/lib)` -ldeflate"
+      LDFLAGS="$LDFLAGS -L$libdeflate_prefix/lib"
+    fi
+
+    CPPFLAGS="$CPPFLAGS $libdeflate_includes"
+    AC_CHECK_HEADER(libdeflate.h, [
+      AC_CHECK_LIB(deflate, libdeflate_zlib_compress, [
+        libdeflate_found=yes
+      ])
+    ])
+    CPPFLAGS="$save_cppflags"
+    LDFLAGS="$save_ldflags"
+
+    if test "$libdeflate_found" = "yes"; then
+      AC_MSG_NOTICE([using libdeflate for zlib compatible compression])
+      AC_DEFINE([SVN_HAVE_LIBDEFLATE], [1],
+                [Define to use libdeflate for zlib compatible compression])
+      SVN_ZLIB_INCLUDES="$SVN_ZLIB_INCLUDES $libdeflate_includes"
+      SVN_ZLIB_LIBS="$SVN_ZLIB_LIBS $libdeflate_libs"
+    elif test "$libdeflate_prefix" != "std"; then
+      AC_MSG_ERROR([libdeflate requested but not found])
+    fi
+  fi
+])
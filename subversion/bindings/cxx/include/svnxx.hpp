@@ -26,13 +26,17 @@
 #define SVNXX_HPP
 
 // Expose the whole API and alias the default version namespace
+#include "svnxx/coroutine.hpp"
 #include "svnxx/depth.hpp"
 #include "svnxx/init.hpp"
 #include "svnxx/exception.hpp"
+#include "svnxx/executor.hpp"
+#include "svnxx/node_kind.hpp"
 #include "svnxx/revision.hpp"
 #include "svnxx/tristate.hpp"
 
 #include "svnxx/client.hpp"
+#include "svnxx/ra.hpp"
 
 namespace svn = ::apache::subversion::svnxx;
 
@@ -25,31 +25,241 @@
 #ifndef SVNXX_CLIENT_STATUS_HPP
 #define SVNXX_CLIENT_STATUS_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 
 #include "svnxx/detail/future.hpp"
 #include "svnxx/client/context.hpp"
+#include "svnxx/executor.hpp"
 
 #include "svnxx/depth.hpp"
+#include "svnxx/node_kind.hpp"
 #include "svnxx/revision.hpp"
 
+struct svn_client_status_t;
+
 namespace apache {
 namespace subversion {
 namespace svnxx {
 namespace client {
 
 /**
- * @warning TODO: Work in progress
+ * @brief The status of a working copy item (see @ref svn_wc_status_kind).
  */
-struct status_notification{};
+// NOTE: Keep these values identical to those in svn_wc_status_kind!
+enum class status_kind : std::int8_t
+  {
+    none        = 1,
+    unversioned,
+    normal,
+    added,
+    missing,
+    deleted,
+    replaced,
+    modified,
+    merged,
+    conflicted,
+    ignored,
+    obstructed,
+    external,
+    incomplete,
+  };
 
 /**
- * @warning TODO: Work in progress
+ * @brief The status of a single working copy node, as reported by
+ * the status operation (see @ref svn_client_status_t).
+ *
+ * A @c status_notification is a lightweight view of the status
+ * structure that the client library creates for each node; creating
+ * or copying it does not allocate memory or copy any strings.
+ *
+ * @warning The notification and any strings returned from its
+ *          accessors are only valid for the duration of the status
+ *          callback that received it.
+ *
+ * Accessors that return a string return @c nullptr when the value
+ * is not known or not applicable to the node.
+ */
+class status_notification
+{
+public:
+  /** @brief The kind of node as recorded in the working copy. */
+  node_kind kind() const noexcept;
+
+  /** @brief The absolute path of the node. */
+  const char* local_abspath() const noexcept;
+
+  /** @brief The on-disk size of the node, or -1 if unknown. */
+  std::int64_t filesize() const noexcept;
+
+  /** @brief Is the node under version control? */
+  bool versioned() const noexcept;
+
+  /** @brief Is the node in a conflicted state? */
+  bool conflicted() const noexcept;
+
+  /** @brief The overall status of the node. */
+  status_kind node_status() const noexcept;
+
+  /** @brief The status of the node's text. */
+  status_kind text_status() const noexcept;
+
+  /** @brief The status of the node's properties. */
+  status_kind prop_status() const noexcept;
+
+  /** @brief Is the node locked in the working copy? */
+  bool wc_is_locked() const noexcept;
+
+  /** @brief Is the node scheduled for addition with history? */
+  bool copied() const noexcept;
+
+  /** @brief Is the node switched relative to its parent? */
+  bool switched() const noexcept;
+
+  /** @brief Is the node a file external? */
+  bool file_external() const noexcept;
+
+  /** @brief The URL of the repository root. */
+  const char* repos_root_url() const noexcept;
+
+  /** @brief The UUID of the repository. */
+  const char* repos_uuid() const noexcept;
+
+  /** @brief The path of the node relative to the repository root. */
+  const char* repos_relpath() const noexcept;
+
+  /** @brief The base revision of the node. */
+  revision::number revnum() const noexcept;
+
+  /** @brief The revision in which the node was last changed. */
+  revision::number changed_revnum() const noexcept;
+
+  /** @brief The date of the last change to the node. */
+  revision::time<revision::usec> changed_date() const noexcept;
+
+  /** @brief The author of the last change to the node. */
+  const char* changed_author() const noexcept;
+
+  /** @brief The name of the changelist the node belongs to. */
+  const char* changelist() const noexcept;
+
+  /** @brief The depth of the node's actual working copy. */
+  svnxx::depth depth() const noexcept;
+
+  /**
+   * @brief The status of the node in the repository.
+   * Only set when @c check_out_of_date was used.
+   */
+  status_kind repos_node_status() const noexcept;
+
+  /** @brief The path of the node this one was moved from. */
+  const char* moved_from_abspath() const noexcept;
+
+  /** @brief The path of the node this one was moved to. */
+  const char* moved_to_abspath() const noexcept;
+
+protected:
+  explicit status_notification(const svn_client_status_t* status_) noexcept
+    : status(status_)
+    {}
+
+private:
+  const svn_client_status_t* status;
+};
+
+/**
+ * @brief The type of the callback for the status operation.
  */
 using status_callback = std::function<void(const char* path,
                                            const status_notification& st)>;
 
+/**
+ * @brief A path and its status, as stored in a #status_batch.
+ */
+struct status_entry
+{
+  const char* path;             ///< The path of the status target.
+  status_notification status;   ///< The status of the target.
+};
+
+/**
+ * @brief A sequence of status notifications for nodes in the same
+ * directory.
+ *
+ * The status operation collects notifications for consecutive
+ * nodes with the same parent directory and delivers them to a
+ * #status_batch_callback all at once. Memory used by the batch is
+ * reused for the next one, so walking even a very large working
+ * copy does not cause allocations per node.
+ *
+ * Nodes from one directory may be delivered in more than one batch,
+ * for example when the status walk descends into a subdirectory, or
+ * when the directory contains many nodes.
+ *
+ * @warning The batch and all its entries are only valid for the
+ *          duration of the callback that received it.
+ */
+class status_batch
+{
+public:
+  using const_iterator = const status_entry*;
+
+  /** @brief The directory that contains the nodes in this batch. */
+  const char* directory() const noexcept
+    {
+      return dir;
+    }
+
+  /** @brief The number of entries in this batch. */
+  std::size_t size() const noexcept
+    {
+      return count;
+    }
+
+  /** @brief Returns @c true if there are no entries in this batch. */
+  bool empty() const noexcept
+    {
+      return count == 0;
+    }
+
+  /** @brief Returns the entry at @a index in this batch. */
+  const status_entry& operator[](std::size_t index) const noexcept
+    {
+      return entries[index];
+    }
+
+  /** @brief Returns an iterator to the first entry in the batch. */
+  const_iterator begin() const noexcept
+    {
+      return entries;
+    }
+
+  /** @brief Returns an iterator past the last entry in the batch. */
+  const_iterator end() const noexcept
+    {
+      return entries + count;
+    }
+
+protected:
+  status_batch(const char* dir_, const status_entry* entries_,
+               std::size_t count_) noexcept
+    : dir(dir_),
+      entries(entries_),
+      count(count_)
+    {}
+
+private:
+  const char* dir;
+  const status_entry* entries;
+  std::size_t count;
+};
+
+/**
+ * @brief The type of the batch callback for the status operation.
+ */
+using status_batch_callback = std::function<void(const status_batch& batch)>;
+
 /**
  * @brief Flags that modify the behaviour of the status operation.
  * @see svn_client_status6
@@ -98,6 +308,20 @@ status(context& ctx, const char* path,
        const revision& rev, depth depth, status_flags flags,
        status_callback callback);
 
+/**
+ * @overload
+ * @ingroup svnxx_client
+ * @brief Perform a status operation on @a path, delivering the
+ * results in batches.
+ * @param callback a function that will be called for each
+ *        #status_batch that the status walk produces
+ * @see svn_client_status6
+ */
+revision::number
+status(context& ctx, const char* path,
+       const revision& rev, depth depth, status_flags flags,
+       status_batch_callback callback);
+
 namespace async {
 
 /**
@@ -129,6 +353,25 @@ status(context& ctx, const char* path,
        const revision& rev, depth depth_, status_flags flags,
        status_callback callback);
 
+/**
+ * @overload
+ * @ingroup svnxx_client
+ * @brief Perform an asynchronous status operation on @a path,
+ * running it on one of the worker threads of @a exec.
+ *
+ * Many operations may be queued on the same executor without
+ * creating a thread for each of them. Operations that run at the
+ * same time use separate internal client contexts, even if they
+ * were started with the same @a ctx.
+ *
+ * @warning The status @a callback will be called in the context of
+ *          one of the @a exec worker threads.
+ */
+svnxx::detail::future<revision::number>
+status(executor& exec, context& ctx, const char* path,
+       const revision& rev, depth depth_, status_flags flags,
+       status_callback callback);
+
 } // namespace async
 } // namespace client
 } // namespace svnxx
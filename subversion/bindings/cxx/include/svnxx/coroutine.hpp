@@ -0,0 +1,100 @@
+/**
+ * @file svnxx/coroutine.hpp
+ * @file svnxx/client/context.hpp
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#ifndef SVNXX_COROUTINE_HPP
+#define SVNXX_COROUTINE_HPP
+
+#if (defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L) \
+  || defined(DOXYGEN)
+
+#include <coroutine>
+
+#include "executor.hpp"
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+
+namespace detail {
+/**
+ * @ingroup svnxx_detail
+ * @brief The awaitable returned by svn::resume_on().
+ */
+class resume_on_awaitable
+{
+public:
+  explicit resume_on_awaitable(svnxx::executor& exec_) noexcept
+    : exec(exec_)
+    {}
+
+  bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+  void await_suspend(std::coroutine_handle<> handle)
+    {
+      exec.post([handle] { handle.resume(); });
+    }
+
+  void await_resume() const noexcept
+    {}
+
+private:
+  svnxx::executor& exec;
+};
+} // namespace detail
+
+/**
+ * @brief Suspend the calling coroutine and resume it on one of the
+ * worker threads of @a exec.
+ *
+ * Any number of coroutines can wait for the workers of one executor,
+ * so many long-running SVN++ operations can be interleaved on a few
+ * threads, for example:
+ * @code{.cpp}
+ *   co_await svn::resume_on(exec);
+ *   // Now running on one of the executor's workers.
+ *   const auto revnum = svn::client::status(ctx, path, rev, depth,
+ *                                           flags, callback);
+ *   co_await svn::resume_on(event_loop_executor);
+ * @endcode
+ *
+ * @note Only available when compiling with C++20 coroutine support;
+ *       the rest of the SVN++ API only requires C++11.
+ * @warning Coroutines that may run at the same time must not share
+ *          an svn::client::context for synchronous operations.
+ */
+inline detail::resume_on_awaitable resume_on(executor& exec) noexcept
+{
+  return detail::resume_on_awaitable(exec);
+}
+
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
+
+#endif  // __cpp_impl_coroutine
+#endif  // SVNXX_COROUTINE_HPP
@@ -0,0 +1,85 @@
+/**
+ * @file svnxx/executor.hpp
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#ifndef SVNXX_EXECUTOR_HPP
+#define SVNXX_EXECUTOR_HPP
+
+#include <functional>
+#include <memory>
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+
+namespace detail {
+class executor;
+using executor_ptr = std::shared_ptr<executor>;
+} // namespace detail
+
+/**
+ * @brief A fixed set of worker threads that run asynchronous
+ * SVN++ operations.
+ *
+ * Operations submitted to an executor wait in a queue until one of
+ * its workers is free, so no more than concurrency() of them run at
+ * the same time and no thread is created per operation. Each worker
+ * reuses its own scratch memory between operations.
+ *
+ * The destructor waits until all submitted operations have finished.
+ */
+class executor : protected detail::executor_ptr
+{
+public:
+  /**
+   * Start @a concurrency worker threads. If @a concurrency is zero,
+   * use as many workers as the hardware can run threads concurrently.
+   */
+  explicit executor(unsigned concurrency = 0);
+  ~executor();
+
+  /**
+   * Return the number of worker threads.
+   */
+  unsigned concurrency() const noexcept;
+
+  /**
+   * Queue @a work to run on the next free worker thread.
+   *
+   * This is the building block for scheduling arbitrary work, such
+   * as resuming a coroutine (see svn::resume_on()), on the executor.
+   *
+   * @warning @a work must not throw; an exception that escapes from
+   *          it terminates the program.
+   */
+  void post(std::function<void()> work);
+
+protected:
+  using inherited = detail::executor_ptr;
+};
+
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
+
+#endif  // SVNXX_EXECUTOR_HPP
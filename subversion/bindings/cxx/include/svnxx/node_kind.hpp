@@ -0,0 +1,54 @@
+/**
+ * @file svnxx/node_kind.hpp
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#ifndef SVNXX_NODE_KIND_HPP
+#define SVNXX_NODE_KIND_HPP
+
+#include "svn_types_impl.h"
+
+#include <cstdint>
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+
+/**
+ * @brief The kind of a versioned or unversioned node
+ * (see @ref svn_node_kind_t).
+ */
+// NOTE: Keep these values identical to those in svn_node_kind_t!
+enum class node_kind : std::int8_t
+  {
+    none    = svn_node_none,
+    file    = svn_node_file,
+    dir     = svn_node_dir,
+    unknown = svn_node_unknown,
+    symlink = svn_node_symlink,
+  };
+
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
+
+#endif  // SVNXX_NODE_KIND_HPP
@@ -0,0 +1,42 @@
+/**
+ * @file svnxx/ra.hpp
+ * @file svnxx/client/context.hpp
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#ifndef SVNXX_RA_HPP
+#define SVNXX_RA_HPP
+
+/**
+ * @defgroup svnxx_ra SVN++ Repository Access
+ * @brief Repository Access Operations
+ *
+ * Repository Access Operations
+ * ============================
+ * Read directly from a repository through an RA session, without a
+ * working copy. All results are delivered through callbacks, as views
+ * of the data that the repository access layer provides.
+ */
+
+#include "ra/session.hpp"
+
+#endif  // SVNXX_RA_HPP
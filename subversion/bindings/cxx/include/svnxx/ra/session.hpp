@@ -0,0 +1,240 @@
+/**
+ * @file svnxx/ra/session.hpp
+ * @file svnxx/client/context.hpp
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#ifndef SVNXX_RA_SESSION_HPP
+#define SVNXX_RA_SESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "svnxx/client/context.hpp"
+#include "svnxx/node_kind.hpp"
+#include "svnxx/revision.hpp"
+
+struct svn_dirent_t;
+struct svn_log_entry_t;
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+namespace ra {
+
+namespace detail {
+class session;
+using session_ptr = std::shared_ptr<session>;
+} // namespace detail
+
+/**
+ * @brief A directory entry, as reported by session::get_dir()
+ * (see @ref svn_dirent_t).
+ *
+ * A @c dirent is a view of the structure returned by the repository
+ * access layer; creating or copying it does not allocate memory.
+ *
+ * @warning The dirent and any strings returned from its accessors are
+ *          only valid for the duration of the callback that received it.
+ */
+class dirent
+{
+public:
+  /** @brief The kind of the node. */
+  node_kind kind() const noexcept;
+
+  /** @brief The length of the file text, or -1 for directories. */
+  std::int64_t size() const noexcept;
+
+  /** @brief Does the node have any properties? */
+  bool has_props() const noexcept;
+
+  /** @brief The revision in which the node was last changed. */
+  revision::number created_rev() const noexcept;
+
+  /** @brief The date of the last change to the node. */
+  revision::time<revision::usec> time() const noexcept;
+
+  /** @brief The author of the last change to the node, or @c nullptr. */
+  const char* last_author() const noexcept;
+
+protected:
+  explicit dirent(const svn_dirent_t* dirent_) noexcept
+    : entry(dirent_)
+    {}
+
+private:
+  const svn_dirent_t* entry;
+};
+
+/**
+ * @brief A log entry, as reported by session::get_log()
+ * (see @ref svn_log_entry_t).
+ *
+ * A @c log_entry is a view of the structure returned by the
+ * repository access layer; creating or copying it does not allocate
+ * memory.
+ *
+ * @warning The log entry and any strings returned from its accessors
+ *          are only valid for the duration of the callback that
+ *          received it.
+ */
+class log_entry
+{
+public:
+  /** @brief The revision of this entry. */
+  revision::number revnum() const noexcept;
+
+  /** @brief The author of the revision, or @c nullptr. */
+  const char* author() const noexcept;
+
+  /** @brief The date of the revision as an ISO-8601 string, or @c nullptr. */
+  const char* date() const noexcept;
+
+  /** @brief The log message of the revision, or @c nullptr. */
+  const char* message() const noexcept;
+
+  /**
+   * @brief Returns @c true if the revision has merged revisions as
+   * children.
+   */
+  bool has_children() const noexcept;
+
+protected:
+  explicit log_entry(const svn_log_entry_t* entry_) noexcept
+    : entry(entry_)
+    {}
+
+private:
+  const svn_log_entry_t* entry;
+};
+
+/**
+ * @brief Callback for session::get_file().
+ *
+ * Receives the file contents in chunks of @a size bytes at @a data.
+ * The chunks are the buffers that the repository access layer reads
+ * from the network or disk; @a data is only valid until the callback
+ * returns.
+ */
+using file_chunk_callback = std::function<void(const char* data,
+                                               std::size_t size)>;
+
+/**
+ * @brief Callback for session::get_dir().
+ */
+using dirent_callback = std::function<void(const char* name,
+                                           const dirent& entry)>;
+
+/**
+ * @brief Callback for session::get_log().
+ */
+using log_callback = std::function<void(const log_entry& entry)>;
+
+/**
+ * @ingroup svnxx_ra
+ * @brief A repository access session, see @ref svn_ra_session_t.
+ *
+ * All operations deliver their results to a callback while the
+ * operation is running, so that a consumer that processes the data
+ * more slowly than the repository delivers it naturally slows down the
+ * transfer, and no result is buffered as a whole. Any callback may
+ * throw svn::stop_iteration to end the operation early; the operation
+ * then throws svn::cancelled.
+ *
+ * @warning A session must not be used by more than one thread at a
+ *          time.
+ */
+class session : protected detail::session_ptr
+{
+public:
+  /**
+   * @brief Open a session to @a url, using the authentication and
+   * configuration settings in @a ctx.
+   * @see svn_client_open_ra_session2
+   */
+  session(client::context& ctx, const char* url);
+  ~session();
+
+  /**
+   * @brief Return the youngest revision in the repository.
+   * @see svn_ra_get_latest_revnum
+   */
+  revision::number latest_revnum();
+
+  /**
+   * @brief Return the kind of node at @a path in @a rev.
+   * @param path a path relative to the session URL
+   * @param rev a revision number, or revision::number::invalid for HEAD
+   * @see svn_ra_check_path
+   */
+  node_kind check_path(const char* path, revision::number rev);
+
+  /**
+   * @brief Stream the contents of the file at @a path in @a rev to
+   * @a callback.
+   * @param path a path relative to the session URL
+   * @param rev a revision number, or revision::number::invalid for HEAD
+   * @param callback called for each chunk of the file contents
+   * @returns the revision that was read
+   * @see svn_ra_get_file
+   */
+  revision::number get_file(const char* path, revision::number rev,
+                            file_chunk_callback callback);
+
+  /**
+   * @brief Report the entries of the directory at @a path in @a rev
+   * to @a callback.
+   * @param path a path relative to the session URL
+   * @param rev a revision number, or revision::number::invalid for HEAD
+   * @param callback called for each directory entry
+   * @returns the revision that was read
+   * @see svn_ra_get_dir2
+   */
+  revision::number get_dir(const char* path, revision::number rev,
+                           dirent_callback callback);
+
+  /**
+   * @brief Report the log entries for @a path to @a callback.
+   * @param path a path relative to the session URL
+   * @param start the first revision to report
+   * @param end the last revision to report
+   * @param limit report at most this many entries, or all if 0
+   * @param callback called for each log entry
+   * @see svn_ra_get_log2
+   */
+  void get_log(const char* path,
+               revision::number start, revision::number end,
+               int limit, log_callback callback);
+
+protected:
+  using inherited = detail::session_ptr;
+};
+
+} // namespace ra
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
+
+#endif  // SVNXX_RA_SESSION_HPP
@@ -25,6 +25,7 @@
 #define SVNXX_PRIVATE_APRWRAP_ARRAY_H
 
 #include <stdexcept>
+#include <utility>
 
 #include "pool.hpp"
 
@@ -138,6 +139,14 @@ public:
       APR_ARRAY_PUSH(proxied, value_type) = value;
     }
 
+  /**
+   * Move @a value onto the end of the APR array.
+   */
+  void push(value_type&& value)
+    {
+      APR_ARRAY_PUSH(proxied, value_type) = std::move(value);
+    }
+
   /**
    * Pop a value from the end of the array.
    * @return A pointer to the value that was removed, or @c NULL if
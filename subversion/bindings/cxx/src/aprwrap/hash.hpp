@@ -24,6 +24,10 @@
 #ifndef SVNXX_PRIVATE_APRWRAP_HASH_H
 #define SVNXX_PRIVATE_APRWRAP_HASH_H
 
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
 #include <apr_hash.h>
 #include "pool.hpp"
 
@@ -45,6 +49,7 @@ class Hash<void, void>
 {
 public:
   struct Iteration;
+  class iterator;
 
   /**
    * Iterate over all the key-value pairs in the hash table, invoking
@@ -96,6 +101,7 @@ public:
      * The hash table wrapper must be able to call the protected constructor.
      */
     friend void Hash::iterate(Hash::Iteration&, const pool&);
+    friend class Hash::iterator;
 
   private:
     const key_type m_key;       ///< Immutable reference to the key
@@ -107,6 +113,96 @@ public:
   typedef void* value_type;
   typedef unsigned int size_type;
 
+  /**
+   * Iterator over the key-value pairs in the hash table.
+   *
+   * Dereferencing the iterator returns the key and value stored in
+   * the hash table; neither is copied and no memory is allocated.
+   *
+   * The iterator uses the hash table's internal iteration state, so
+   * a hash table must not be iterated this way by more than one
+   * thread at a time or in nested loops; use Hash::iterate() with a
+   * scratch pool for that.
+   */
+  class iterator
+  {
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef std::pair<Key, void*> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef value_type reference;
+
+    /**
+     * Construct the past-the-end iterator.
+     */
+    iterator() noexcept
+      : m_index(NULL)
+      {}
+
+    /**
+     * Construct an iterator that starts at @a index.
+     */
+    explicit iterator(apr_hash_index_t* index) noexcept
+      : m_index(index)
+      {}
+
+    /**
+     * Return the key and value at the current position.
+     */
+    reference operator*() const noexcept
+      {
+        const void* key;
+        Key::size_type klen;
+        void* val;
+
+        apr_hash_this(m_index, &key, &klen, &val);
+        return value_type(Key(key, klen), val);
+      }
+
+    iterator& operator++() noexcept
+      {
+        m_index = apr_hash_next(m_index);
+        return *this;
+      }
+
+    iterator operator++(int) noexcept
+      {
+        const iterator prev(*this);
+        ++*this;
+        return prev;
+      }
+
+    bool operator==(const iterator& that) const noexcept
+      {
+        return m_index == that.m_index;
+      }
+
+    bool operator!=(const iterator& that) const noexcept
+      {
+        return m_index != that.m_index;
+      }
+
+  private:
+    apr_hash_index_t* m_index;  ///< Current position, NULL at the end
+  };
+
+  /**
+   * Return an iterator to the first key-value pair in the hash table.
+   */
+  iterator begin() const noexcept
+    {
+      return iterator(apr_hash_first(NULL, m_hash));
+    }
+
+  /**
+   * Return the past-the-end iterator.
+   */
+  iterator end() const noexcept
+    {
+      return iterator();
+    }
+
   /**
    * Create and proxy a new APR hash table in @a result_pool.
    */
@@ -212,6 +308,8 @@ class Hash : private Hash<void, void>
   typedef Hash<void, void> inherited;
 
 public:
+  class iterator;
+
   /**
    * Proxy for a key in an APR hash table.
    *
@@ -228,6 +326,7 @@ public:
      * convert references to the base class.
      */
     friend class Hash;
+    friend class Hash::iterator;
 
   public:
     typedef const K* key_type;
@@ -266,6 +365,85 @@ public:
   typedef typename Key::key_type key_type;
   typedef V* value_type;
 
+  /**
+   * Iterator over the key-value pairs in the hash table.
+   * Adapts the generic iterator to the instantiated types.
+   */
+  class iterator
+  {
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef std::pair<Key, V*> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef value_type reference;
+
+    /**
+     * Construct the past-the-end iterator.
+     */
+    iterator() noexcept
+      {}
+
+    /**
+     * Adapt the generic iterator @a raw.
+     */
+    explicit iterator(const inherited::iterator& raw) noexcept
+      : m_raw(raw)
+      {}
+
+    /**
+     * Return the key and value at the current position.
+     */
+    reference operator*() const noexcept
+      {
+        const typename inherited::iterator::value_type raw = *m_raw;
+        return value_type(Key(raw.first), static_cast<V*>(raw.second));
+      }
+
+    iterator& operator++() noexcept
+      {
+        ++m_raw;
+        return *this;
+      }
+
+    iterator operator++(int) noexcept
+      {
+        const iterator prev(*this);
+        ++m_raw;
+        return prev;
+      }
+
+    bool operator==(const iterator& that) const noexcept
+      {
+        return m_raw == that.m_raw;
+      }
+
+    bool operator!=(const iterator& that) const noexcept
+      {
+        return m_raw != that.m_raw;
+      }
+
+  private:
+    inherited::iterator m_raw;  ///< The generic iterator
+  };
+
+  /**
+   * Return an iterator to the first key-value pair in the hash table.
+   * @see Hash<void, void>::iterator for restrictions.
+   */
+  iterator begin() const noexcept
+    {
+      return iterator(inherited::begin());
+    }
+
+  /**
+   * Return the past-the-end iterator.
+   */
+  iterator end() const noexcept
+    {
+      return iterator();
+    }
+
   /**
    * Create and proxy a new APR hash table allocated from @a result_pool.
    */
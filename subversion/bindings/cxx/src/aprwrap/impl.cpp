@@ -21,6 +21,8 @@
  * @endcopyright
  */
 
+#include <vector>
+
 #include "pool.hpp"
 #include "hash.hpp"
 
@@ -35,10 +37,95 @@ namespace apr {
 // Pool implementation
 //
 
-apr_pool_t* pool::get_root_pool()
+namespace {
+// Per-thread free list of cleared top-level pools.
+class recycler
+{
+public:
+  // The most pools we'll keep around in one thread.
+  static constexpr std::size_t max_free_pools = 16;
+
+  recycler()
+    {
+      free_pools.reserve(max_free_pools);
+    }
+
+  ~recycler()
+    {
+      alive = false;
+      discard(state.lock());
+    }
+
+  apr_pool_t* acquire(const detail::global_state::ptr& current)
+    {
+      auto owner = state.lock();
+      if (owner != current)
+        {
+          // The free list belongs to a different (possibly already
+          // terminated) instance of the library state.
+          discard(owner);
+          state = current;
+        }
+      else if (!free_pools.empty())
+        {
+          apr_pool_t* const pool = free_pools.back();
+          free_pools.pop_back();
+          return pool;
+        }
+      return svn_pool_create(current->get_root_pool());
+    }
+
+  bool release(apr_pool_t* pool) noexcept
+    {
+      if (free_pools.size() >= max_free_pools)
+        return false;
+
+      const auto owner = state.lock();
+      if (!owner || apr_pool_parent_get(pool) != owner->get_root_pool())
+        return false;
+
+      apr_pool_clear(pool);
+      free_pools.push_back(pool);
+      return true;
+    }
+
+  // Set to false when the thread's recycler is destroyed, so that
+  // pools released during thread exit are simply destroyed.
+  static thread_local bool alive;
+
+private:
+  void discard(const detail::global_state::ptr& owner) noexcept
+    {
+      // If the owner is gone, so is its root pool, and with it all
+      // the pools on the free list.
+      if (owner)
+        {
+          for (const auto pool : free_pools)
+            svn_pool_destroy(pool);
+        }
+      free_pools.clear();
+    }
+
+  detail::global_state::weak_ptr state;
+  std::vector<apr_pool_t*> free_pools;
+};
+
+constexpr std::size_t recycler::max_free_pools;
+thread_local bool recycler::alive = true;
+thread_local recycler pool_recycler;
+} // anonymous namespace
+
+apr_pool_t* pool::create_recycled(const detail::global_state::ptr& state)
+{
+  if (recycler::alive)
+    return pool_recycler.acquire(state);
+  return svn_pool_create(state->get_root_pool());
+}
+
+void delete_pool::operator() (apr_pool_t* pool) noexcept
 {
-  auto state = detail::global_state::get();
-  return state->get_root_pool();
+  if (!recycler::alive || !pool_recycler.release(pool))
+    svn_pool_destroy(pool);
 }
 
 //
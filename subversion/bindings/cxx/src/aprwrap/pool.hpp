@@ -40,12 +40,14 @@ namespace subversion {
 namespace svnxx {
 namespace apr {
 
+/**
+ * Pool deleter. Top-level pools are cleared and kept on a small
+ * per-thread free list for reuse by the next pool created in the
+ * same thread; other pools are destroyed.
+ */
 struct delete_pool
 {
-  void operator() (apr_pool_t* pool)
-    {
-      svn_pool_destroy(pool);
-    }
+  void operator() (apr_pool_t* pool) noexcept;
 };
 
 using pool_ptr = std::unique_ptr<apr_pool_t, delete_pool>;
@@ -61,7 +63,7 @@ class pool : pool_ptr
     pool& proxied_pool;
   };
 
-  static apr_pool_t* get_root_pool();
+  static apr_pool_t* create_recycled(const detail::global_state::ptr& state);
 
   struct allocation_size_overflowed final : public allocation_failed
   {
@@ -82,11 +84,22 @@ class pool : pool_ptr
 public:
   /**
    * Create a pool as a child of the application's root pool.
+   * Reuses a pool from the current thread's free list if possible.
    */
   pool()
-    : pool_ptr(svn_pool_create(get_root_pool()))
+    : pool_ptr(create_recycled(detail::global_state::get()))
     {}
 
+  /**
+   * Move constructor; @a that will not own a pool afterwards.
+   */
+  pool(pool&& that) noexcept = default;
+
+  /**
+   * Move assignment; releases the pool currently owned by this object.
+   */
+  pool& operator=(pool&& that) noexcept = default;
+
   /**
    * Return a pool pointer that can be used by the C APIs.
    */
@@ -104,9 +117,10 @@ public:
 
   /**
    * Create a pool as a child of the global pool in @a state.
+   * Reuses a pool from the current thread's free list if possible.
    */
   explicit pool(const detail::global_state::ptr& state)
-    : pool_ptr(svn_pool_create(state->get_root_pool()))
+    : pool_ptr(create_recycled(state))
     {}
 
   /**
@@ -41,6 +41,35 @@ svn_client_ctx_t* context::create_ctx(const apr::pool& pool)
   return ctx;
 }
 
+svn_client_ctx_t* context::acquire_ctx()
+{
+  std::lock_guard<std::mutex> lock(spare_guard);
+  if (spare_ctxs.empty())
+    {
+      // Allocating from the context pool is safe from here, because
+      // we hold the lock and nothing else allocates from it.
+      return create_ctx(ctx_pool);
+    }
+
+  const auto spare = spare_ctxs.back();
+  spare_ctxs.pop_back();
+  return spare;
+}
+
+void context::release_ctx(svn_client_ctx_t* spare) noexcept
+{
+  try
+    {
+      std::lock_guard<std::mutex> lock(spare_guard);
+      spare_ctxs.push_back(spare);
+    }
+  catch (...)
+    {
+      // The spare context just won't be reused; it lives in the
+      // context pool anyway.
+    }
+}
+
 } // namespace detail
 
 //
@@ -21,12 +21,19 @@
  * @endcopyright
  */
 
+#include <cstring>
+#include <vector>
+
 #include "svnxx/client/status.hpp"
 
 #include "aprwrap.hpp"
 #include "private.hpp"
 
+#include "apr_strings.h"
+
 #include "svn_client.h"
+#include "svn_dirent_uri.h"
+#include "svn_wc.h"
 
 namespace apache {
 namespace subversion {
@@ -34,16 +41,58 @@ namespace svnxx {
 
 namespace impl {
 namespace {
+using status_kind = client::status_kind;
 using status_notification = client::status_notification;
 using status_callback = client::status_callback;
+using status_entry = client::status_entry;
+using status_batch = client::status_batch;
+using status_batch_callback = client::status_batch_callback;
 using status_flags = client::status_flags;
 
+static_assert(status_kind::none == status_kind(svn_wc_status_none)
+              && status_kind::unversioned
+                 == status_kind(svn_wc_status_unversioned)
+              && status_kind::normal == status_kind(svn_wc_status_normal)
+              && status_kind::added == status_kind(svn_wc_status_added)
+              && status_kind::missing == status_kind(svn_wc_status_missing)
+              && status_kind::deleted == status_kind(svn_wc_status_deleted)
+              && status_kind::replaced
+                 == status_kind(svn_wc_status_replaced)
+              && status_kind::modified
+                 == status_kind(svn_wc_status_modified)
+              && status_kind::merged == status_kind(svn_wc_status_merged)
+              && status_kind::conflicted
+                 == status_kind(svn_wc_status_conflicted)
+              && status_kind::ignored == status_kind(svn_wc_status_ignored)
+              && status_kind::obstructed
+                 == status_kind(svn_wc_status_obstructed)
+              && status_kind::external
+                 == status_kind(svn_wc_status_external)
+              && status_kind::incomplete
+                 == status_kind(svn_wc_status_incomplete),
+              "svn::client::status_kind does not match svn_wc_status_kind");
+
+// Wrappers that give us access to the protected constructors.
+struct notification : public status_notification
+{
+  explicit notification(const svn_client_status_t* status) noexcept
+    : status_notification(status)
+    {}
+};
+
+struct batch : public status_batch
+{
+  batch(const char* dir, const std::vector<status_entry>& entries) noexcept
+    : status_batch(dir, entries.data(), entries.size())
+    {}
+};
+
 struct status_func
 {
   status_callback& proxy;
   static svn_error_t* callback(void* baton,
                                const char *path,
-                               const svn_client_status_t* /*status*/,
+                               const svn_client_status_t* status,
                                apr_pool_t* /*scratch_pool*/)
     {
       const auto self = static_cast<status_func*>(baton);
@@ -51,7 +100,7 @@ struct status_func
         {
           try
             {
-              self->proxy(path, status_notification{});
+              self->proxy(path, notification(status));
             }
           catch (const stop_iteration&)
             {
@@ -61,14 +110,90 @@ struct status_func
       return SVN_NO_ERROR;
     }
 };
-} // anonymous namespace
+
+struct status_batch_func
+{
+  // The largest number of entries collected in one batch; this
+  // bounds the memory used for very large directories.
+  static constexpr std::size_t max_batch_size = 1024;
+
+  status_batch_func(status_batch_callback& proxy_, const apr::pool& parent)
+    : proxy(proxy_),
+      batch_pool(&parent),
+      dir(nullptr)
+    {
+      entries.reserve(max_batch_size);
+    }
+
+  // Deliver the collected entries to the proxy and release their memory.
+  void flush()
+    {
+      if (entries.empty())
+        return;
+
+      try
+        {
+          proxy(batch(dir, entries));
+        }
+      catch (...)
+        {
+          reset();
+          throw;
+        }
+      reset();
+    }
+
+  void reset() noexcept
+    {
+      entries.clear();
+      batch_pool.clear();
+      dir = nullptr;
+    }
+
+  static svn_error_t* callback(void* baton,
+                               const char *path,
+                               const svn_client_status_t* status,
+                               apr_pool_t* scratch_pool)
+    {
+      const auto self = static_cast<status_batch_func*>(baton);
+      if (!self->proxy)
+        return SVN_NO_ERROR;
+
+      try
+        {
+          const char* const parent = svn_dirent_dirname(path, scratch_pool);
+          if (self->entries.size() >= max_batch_size
+              || (self->dir && 0 != std::strcmp(self->dir, parent)))
+            self->flush();
+
+          apr_pool_t* const pool = self->batch_pool.get();
+          if (!self->dir)
+            self->dir = apr_pstrdup(pool, parent);
+          self->entries.push_back(
+              status_entry{apr_pstrdup(pool, path),
+                           notification(svn_client_status_dup(status, pool))});
+        }
+      catch (const stop_iteration&)
+        {
+          return impl::iteration_stopped();
+        }
+      return SVN_NO_ERROR;
+    }
+
+  status_batch_callback& proxy;
+  apr::pool batch_pool;
+  const char* dir;
+  std::vector<status_entry> entries;
+};
+
+constexpr std::size_t status_batch_func::max_batch_size;
 
 revision::number
 status(svn_client_ctx_t* ctx, const char* path,
        const svn_opt_revision_t* rev, depth depth_, status_flags flags,
-       status_callback callback_, apr_pool_t* scratch_pool)
+       svn_client_status_func_t status_func, void* status_baton,
+       apr_pool_t* scratch_pool)
 {
-  status_func callback{callback_};
   svn_revnum_t result;
 
   impl::checked_call(
@@ -81,14 +206,175 @@ status(svn_client_ctx_t* ctx, const char* path,
                          bool(flags & status_flags::ignore_externals),
                          bool(flags & status_flags::depth_as_sticky),
                          nullptr, // TODO: changelists,
-                         status_func::callback, &callback,
+                         status_func, status_baton,
                          scratch_pool));
   return revision::number(result);
 }
+} // anonymous namespace
+
+revision::number
+status(svn_client_ctx_t* ctx, const char* path,
+       const svn_opt_revision_t* rev, depth depth_, status_flags flags,
+       status_callback callback_, apr_pool_t* scratch_pool)
+{
+  status_func callback{callback_};
+  return status(ctx, path, rev, depth_, flags,
+                status_func::callback, &callback, scratch_pool);
+}
+
+revision::number
+status(svn_client_ctx_t* ctx, const char* path,
+       const svn_opt_revision_t* rev, depth depth_, status_flags flags,
+       status_batch_callback callback_, const apr::pool& scratch_pool)
+{
+  status_batch_func callback(callback_, scratch_pool);
+  const auto result = status(ctx, path, rev, depth_, flags,
+                             status_batch_func::callback, &callback,
+                             scratch_pool.get());
+  try
+    {
+      callback.flush();
+    }
+  catch (const stop_iteration&)
+    {
+      // The walk is already complete.
+    }
+  return result;
+}
 
 } // namespace impl
 namespace client {
 
+//
+// class status_notification
+//
+
+node_kind status_notification::kind() const noexcept
+{
+  return node_kind(status->kind);
+}
+
+const char* status_notification::local_abspath() const noexcept
+{
+  return status->local_abspath;
+}
+
+std::int64_t status_notification::filesize() const noexcept
+{
+  return status->filesize;
+}
+
+bool status_notification::versioned() const noexcept
+{
+  return status->versioned;
+}
+
+bool status_notification::conflicted() const noexcept
+{
+  return status->conflicted;
+}
+
+status_kind status_notification::node_status() const noexcept
+{
+  return status_kind(status->node_status);
+}
+
+status_kind status_notification::text_status() const noexcept
+{
+  return status_kind(status->text_status);
+}
+
+status_kind status_notification::prop_status() const noexcept
+{
+  return status_kind(status->prop_status);
+}
+
+bool status_notification::wc_is_locked() const noexcept
+{
+  return status->wc_is_locked;
+}
+
+bool status_notification::copied() const noexcept
+{
+  return status->copied;
+}
+
+bool status_notification::switched() const noexcept
+{
+  return status->switched;
+}
+
+bool status_notification::file_external() const noexcept
+{
+  return status->file_external;
+}
+
+const char* status_notification::repos_root_url() const noexcept
+{
+  return status->repos_root_url;
+}
+
+const char* status_notification::repos_uuid() const noexcept
+{
+  return status->repos_uuid;
+}
+
+const char* status_notification::repos_relpath() const noexcept
+{
+  return status->repos_relpath;
+}
+
+revision::number status_notification::revnum() const noexcept
+{
+  return revision::number(status->revision);
+}
+
+revision::number status_notification::changed_revnum() const noexcept
+{
+  return revision::number(status->changed_rev);
+}
+
+revision::time<revision::usec>
+status_notification::changed_date() const noexcept
+{
+  return revision::time<revision::usec>(
+      revision::usec(status->changed_date));
+}
+
+const char* status_notification::changed_author() const noexcept
+{
+  return status->changed_author;
+}
+
+const char* status_notification::changelist() const noexcept
+{
+  return status->changelist;
+}
+
+svnxx::depth status_notification::depth() const noexcept
+{
+  return svnxx::depth(status->depth);
+}
+
+status_kind status_notification::repos_node_status() const noexcept
+{
+  return status_kind(status->repos_node_status);
+}
+
+const char* status_notification::moved_from_abspath() const noexcept
+{
+  return status->moved_from_abspath;
+}
+
+const char* status_notification::moved_to_abspath() const noexcept
+{
+  return status->moved_to_abspath;
+}
+
+//
+// status operation
+//
+
 revision::number
 status(context& ctx_, const char* path,
        const revision& rev_, depth depth_, status_flags flags,
@@ -101,6 +387,18 @@ status(context& ctx_, const char* path,
                       callback, scratch_pool.get());
 }
 
+revision::number
+status(context& ctx_, const char* path,
+       const revision& rev_, depth depth_, status_flags flags,
+       status_batch_callback callback)
+{
+  const auto ctx = impl::unwrap(ctx_);
+  const auto rev = impl::convert(rev_);
+  const auto scratch_pool = apr::pool(&ctx->get_pool());
+  return impl::status(ctx->get_ctx(), path, &rev, depth_, flags,
+                      callback, scratch_pool);
+}
+
 namespace async {
 
 svnxx::detail::future<revision::number>
@@ -118,15 +416,38 @@ status(std::launch policy, context& ctx_, const char* path,
               if (!ctx)
                 return revision::number::invalid;
 
+              const impl::context_lease lease(ctx);
               const auto rev = impl::convert(rev_);
               const auto scratch_pool = apr::pool(&ctx->get_pool());
 
-              return impl::status(ctx->get_ctx(), path, &rev, depth_, flags,
+              return impl::status(lease.get(), path, &rev, depth_, flags,
                                   callback, scratch_pool.get());
             }),
       impl::make_future_result());
 }
 
+svnxx::detail::future<revision::number>
+status(executor& exec, context& ctx_, const char* path,
+       const revision& rev_, depth depth_, status_flags flags,
+       status_callback callback)
+{
+  detail::weak_context_ptr weak_ctx = impl::unwrap(ctx_);
+  return impl::schedule<revision::number>(
+      exec,
+      [weak_ctx, path, rev_, depth_, flags, callback](apr::pool& scratch_pool)
+        {
+          auto ctx = weak_ctx.lock();
+          if (!ctx)
+            return revision::number::invalid;
+
+          const impl::context_lease lease(ctx);
+          const auto rev = impl::convert(rev_);
+
+          return impl::status(lease.get(), path, &rev, depth_, flags,
+                              callback, scratch_pool.get());
+        });
+}
+
 svnxx::detail::future<revision::number>
 status(context& ctx_, const char* path,
        const revision& rev_, depth depth_, status_flags flags,
@@ -0,0 +1,138 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#include <algorithm>
+
+#include "private/executor_private.hpp"
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+
+//
+// class detail::executor
+//
+
+namespace detail {
+
+executor::executor(unsigned concurrency)
+  : state(global_state::get())
+{
+  if (!concurrency)
+    concurrency = std::max(1U, std::thread::hardware_concurrency());
+
+  workers.reserve(concurrency);
+  try
+    {
+      for (unsigned i = 0; i < concurrency; ++i)
+        workers.emplace_back(&executor::run, this);
+    }
+  catch (...)
+    {
+      stop();
+      throw;
+    }
+}
+
+executor::~executor()
+{
+  stop();
+}
+
+void executor::submit(task&& task_)
+{
+  {
+    std::lock_guard<std::mutex> lock(guard);
+    tasks.push_back(std::move(task_));
+  }
+  wakeup.notify_one();
+}
+
+void executor::run()
+{
+  // Each worker reuses its own scratch pool for all the tasks it
+  // runs, instead of creating a new pool for every operation.
+  apr::pool scratch_pool(state);
+
+  for (;;)
+    {
+      task next;
+      {
+        std::unique_lock<std::mutex> lock(guard);
+        wakeup.wait(lock, [this] { return stopping || !tasks.empty(); });
+        if (tasks.empty())
+          return;
+
+        next = std::move(tasks.front());
+        tasks.pop_front();
+      }
+
+      apr::pool::iteration iterpool(scratch_pool);
+      next(iterpool.get_pool());
+    }
+}
+
+void executor::stop() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock(guard);
+    stopping = true;
+  }
+  wakeup.notify_all();
+
+  for (auto& worker : workers)
+    {
+      if (worker.joinable())
+        worker.join();
+    }
+}
+
+} // namespace detail
+
+//
+// class executor
+//
+
+executor::executor(unsigned concurrency)
+  : inherited(new detail::executor(concurrency))
+{}
+
+executor::~executor()
+{}
+
+unsigned executor::concurrency() const noexcept
+{
+  return inherited::get()->concurrency();
+}
+
+void executor::post(std::function<void()> work)
+{
+  inherited::get()->submit([work](apr::pool&)
+                             {
+                               work();
+                             });
+}
+
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
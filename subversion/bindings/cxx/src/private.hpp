@@ -26,11 +26,13 @@
 
 #include "private/depth_private.hpp"
 #include "private/exception_private.hpp"
+#include "private/executor_private.hpp"
 #include "private/future_private.hpp"
 #include "private/revision_private.hpp"
 #include "private/strings_private.hpp"
 #include "private/tristate_private.hpp"
 
 #include "private/client_context_private.hpp"
+#include "private/ra_session_private.hpp"
 
 #endif // SVNXX_PRIVATE_PRIVATE_HPP
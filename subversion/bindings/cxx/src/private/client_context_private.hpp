@@ -24,7 +24,11 @@
 #ifndef SVNXX_PRIVATE_CLIENT_CONTEXT_HPP
 #define SVNXX_PRIVATE_CLIENT_CONTEXT_HPP
 
+#include <mutex>
+#include <vector>
+
 #include "svnxx/client/context.hpp"
+#include "svnxx/detail/noncopyable.hpp"
 
 #include "../private/init_private.hpp"
 #include "../aprwrap.hpp"
@@ -53,11 +57,22 @@ public:
   const apr::pool& get_pool() const noexcept { return ctx_pool; }
   svn_client_ctx_t* get_ctx() const noexcept { return ctx; };
 
+  // Return a client context that no other operation uses until it is
+  // given back with release_ctx(). Concurrent asynchronous operations
+  // must not share an svn_client_ctx_t, so they take one from a set
+  // of spare contexts that grows to the number of operations that
+  // run at the same time.
+  svn_client_ctx_t* acquire_ctx();
+  void release_ctx(svn_client_ctx_t* spare) noexcept;
+
 private:
   const global_state::ptr state;
   apr::pool ctx_pool;
   svn_client_ctx_t* const ctx;
 
+  std::mutex spare_guard;
+  std::vector<svn_client_ctx_t*> spare_ctxs;
+
   static svn_client_ctx_t* create_ctx(const apr::pool& pool);
 };
 
@@ -79,6 +94,28 @@ inline client::detail::context_ptr unwrap(client::context& ctx)
   return static_cast<context_wrapper&>(ctx).get();
 }
 
+// Holds a client context taken from a client::detail::context for the
+// duration of a single asynchronous operation.
+class context_lease : svnxx::detail::noncopyable
+{
+public:
+  explicit context_lease(const client::detail::context_ptr& owner_)
+    : owner(owner_),
+      ctx(owner_->acquire_ctx())
+    {}
+
+  ~context_lease() noexcept
+    {
+      owner->release_ctx(ctx);
+    }
+
+  svn_client_ctx_t* get() const noexcept { return ctx; }
+
+private:
+  const client::detail::context_ptr owner;
+  svn_client_ctx_t* const ctx;
+};
+
 } // namesapce impl
 } // namespace svnxx
 } // namespace subversion
@@ -0,0 +1,123 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#ifndef SVNXX_PRIVATE_EXECUTOR_HPP
+#define SVNXX_PRIVATE_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "svnxx/executor.hpp"
+#include "svnxx/detail/noncopyable.hpp"
+
+#include "../private/future_private.hpp"
+#include "../private/init_private.hpp"
+#include "../aprwrap.hpp"
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+namespace detail {
+
+// The worker threads and the queue of pending tasks behind the
+// public executor class.
+class executor : noncopyable
+{
+public:
+  // Tasks receive the scratch pool of the worker that runs them.
+  // The worker clears the pool before each task.
+  using task = std::function<void(apr::pool& scratch_pool)>;
+
+  explicit executor(unsigned concurrency);
+  ~executor();
+
+  unsigned concurrency() const noexcept
+    {
+      return unsigned(workers.size());
+    }
+
+  // Queue a task for the next free worker.
+  void submit(task&& task_);
+
+private:
+  // The main loop of each worker thread.
+  void run();
+
+  // Wait until all queued tasks have run and join the workers.
+  void stop() noexcept;
+
+  const global_state::ptr state;
+  std::mutex guard;
+  std::condition_variable wakeup;
+  std::deque<task> tasks;
+  bool stopping{false};
+  std::vector<std::thread> workers;
+};
+
+} // namespace detail
+namespace impl {
+
+// Return the implementation behind the public executor object.
+inline detail::executor_ptr unwrap(executor& exec)
+{
+  struct executor_wrapper final : public executor
+  {
+    inherited get() const noexcept
+      {
+        return *this;
+      }
+  };
+
+  return static_cast<executor_wrapper&>(exec).get();
+}
+
+// Run FUNC on one of the workers of EXEC and return a future for
+// its result. FUNC receives the worker's scratch pool.
+template<typename T, typename Func>
+inline svnxx::detail::future<T> schedule(executor& exec, Func&& func)
+{
+  using task_type = std::packaged_task<T(apr::pool&)>;
+
+  // std::function needs a copyable target, so share the task.
+  const auto task = std::make_shared<task_type>(std::forward<Func>(func));
+  auto result = task->get_future();
+  unwrap(exec)->submit([task](apr::pool& scratch_pool)
+                         {
+                           (*task)(scratch_pool);
+                         });
+  return impl::future<T>(std::move(result), make_future_result());
+}
+
+} // namespace impl
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
+
+#endif // SVNXX_PRIVATE_EXECUTOR_HPP
@@ -0,0 +1,84 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#ifndef SVNXX_PRIVATE_RA_SESSION_HPP
+#define SVNXX_PRIVATE_RA_SESSION_HPP
+
+#include "svnxx/ra/session.hpp"
+#include "svnxx/detail/noncopyable.hpp"
+
+#include "../private/client_context_private.hpp"
+#include "../aprwrap.hpp"
+
+#include "svn_ra.h"
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+namespace ra {
+namespace detail {
+
+// The RA session and the pool it lives in. Keeps the client context
+// that provides the session callbacks alive for as long as the
+// session exists.
+class session : svnxx::detail::noncopyable
+{
+public:
+  session(const client::detail::context_ptr& ctx_, const char* url);
+
+  const apr::pool& get_pool() const noexcept { return session_pool; }
+  svn_ra_session_t* get_session() const noexcept { return ra_session; }
+
+private:
+  const client::detail::context_ptr ctx;
+  apr::pool session_pool;
+  svn_ra_session_t* const ra_session;
+
+  static svn_ra_session_t* open(const client::detail::context_ptr& ctx,
+                                const char* url, const apr::pool& pool);
+};
+
+} // namespace detail
+} // namespace ra
+namespace impl {
+
+// TODO: document this
+inline ra::detail::session_ptr unwrap(ra::session& session)
+{
+  struct session_wrapper final : public ra::session
+  {
+    inherited get() const noexcept
+      {
+        return *this;
+      }
+  };
+
+  return static_cast<session_wrapper&>(session).get();
+}
+
+} // namespace impl
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
+
+#endif // SVNXX_PRIVATE_RA_SESSION_HPP
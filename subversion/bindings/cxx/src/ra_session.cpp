@@ -0,0 +1,307 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+#include "svnxx/ra/session.hpp"
+
+#include "aprwrap.hpp"
+#include "private.hpp"
+
+#include "svn_client.h"
+#include "svn_props.h"
+#include "svn_ra.h"
+
+namespace apache {
+namespace subversion {
+namespace svnxx {
+
+namespace impl {
+namespace {
+using dirent = ra::dirent;
+using log_entry = ra::log_entry;
+using file_chunk_callback = ra::file_chunk_callback;
+using dirent_callback = ra::dirent_callback;
+using log_callback = ra::log_callback;
+
+// Wrappers that give us access to the protected constructors.
+struct dirent_view : public dirent
+{
+  explicit dirent_view(const svn_dirent_t* entry) noexcept
+    : dirent(entry)
+    {}
+};
+
+struct log_entry_view : public log_entry
+{
+  explicit log_entry_view(const svn_log_entry_t* entry) noexcept
+    : log_entry(entry)
+    {}
+};
+
+struct file_chunk_func
+{
+  file_chunk_callback& proxy;
+  static svn_error_t* write(void* baton, const char* data, apr_size_t* len)
+    {
+      const auto self = static_cast<file_chunk_func*>(baton);
+      if (self->proxy)
+        {
+          try
+            {
+              self->proxy(data, *len);
+            }
+          catch (const stop_iteration&)
+            {
+              return impl::iteration_stopped();
+            }
+        }
+      return SVN_NO_ERROR;
+    }
+};
+
+struct log_func
+{
+  log_callback& proxy;
+  static svn_error_t* receiver(void* baton,
+                               svn_log_entry_t* entry,
+                               apr_pool_t* /*scratch_pool*/)
+    {
+      const auto self = static_cast<log_func*>(baton);
+      if (self->proxy)
+        {
+          try
+            {
+              self->proxy(log_entry_view(entry));
+            }
+          catch (const stop_iteration&)
+            {
+              return impl::iteration_stopped();
+            }
+        }
+      return SVN_NO_ERROR;
+    }
+};
+
+const char* revprop(const svn_log_entry_t* entry, const char* name) noexcept
+{
+  const svn_string_t* const value =
+    entry->revprops ? svn_prop_get_value(entry->revprops, name) : nullptr;
+  return value ? value->data : nullptr;
+}
+} // anonymous namespace
+} // namespace impl
+
+namespace ra {
+
+//
+// class dirent
+//
+
+node_kind dirent::kind() const noexcept
+{
+  return node_kind(entry->kind);
+}
+
+std::int64_t dirent::size() const noexcept
+{
+  return entry->size;
+}
+
+bool dirent::has_props() const noexcept
+{
+  return entry->has_props;
+}
+
+revision::number dirent::created_rev() const noexcept
+{
+  return revision::number(entry->created_rev);
+}
+
+revision::time<revision::usec> dirent::time() const noexcept
+{
+  return revision::time<revision::usec>(revision::usec(entry->time));
+}
+
+const char* dirent::last_author() const noexcept
+{
+  return entry->last_author;
+}
+
+//
+// class log_entry
+//
+
+revision::number log_entry::revnum() const noexcept
+{
+  return revision::number(entry->revision);
+}
+
+const char* log_entry::author() const noexcept
+{
+  return impl::revprop(entry, SVN_PROP_REVISION_AUTHOR);
+}
+
+const char* log_entry::date() const noexcept
+{
+  return impl::revprop(entry, SVN_PROP_REVISION_DATE);
+}
+
+const char* log_entry::message() const noexcept
+{
+  return impl::revprop(entry, SVN_PROP_REVISION_LOG);
+}
+
+bool log_entry::has_children() const noexcept
+{
+  return entry->has_children;
+}
+
+//
+// class detail::session
+//
+
+namespace detail {
+
+session::session(const client::detail::context_ptr& ctx_, const char* url)
+  : ctx(ctx_),
+    session_pool(ctx_->get_state()),
+    ra_session(open(ctx_, url, session_pool))
+{}
+
+svn_ra_session_t* session::open(const client::detail::context_ptr& ctx,
+                                const char* url, const apr::pool& pool)
+{
+  svn_ra_session_t* ra_session;
+  const apr::pool scratch_pool(&pool);
+  impl::checked_call(
+      svn_client_open_ra_session2(&ra_session, url, nullptr,
+                                  ctx->get_ctx(),
+                                  pool.get(), scratch_pool.get()));
+  return ra_session;
+}
+
+} // namespace detail
+
+//
+// class session
+//
+
+session::session(client::context& ctx, const char* url)
+  : inherited(new detail::session(impl::unwrap(ctx), url))
+{}
+
+session::~session()
+{}
+
+revision::number session::latest_revnum()
+{
+  const auto self = impl::unwrap(*this);
+  const apr::pool scratch_pool(&self->get_pool());
+  svn_revnum_t result;
+  impl::checked_call(
+      svn_ra_get_latest_revnum(self->get_session(), &result,
+                               scratch_pool.get()));
+  return revision::number(result);
+}
+
+node_kind session::check_path(const char* path, revision::number rev)
+{
+  const auto self = impl::unwrap(*this);
+  const apr::pool scratch_pool(&self->get_pool());
+  svn_node_kind_t kind;
+  impl::checked_call(
+      svn_ra_check_path(self->get_session(), path, svn_revnum_t(rev),
+                        &kind, scratch_pool.get()));
+  return node_kind(kind);
+}
+
+revision::number session::get_file(const char* path, revision::number rev,
+                                   file_chunk_callback callback_)
+{
+  const auto self = impl::unwrap(*this);
+  const apr::pool scratch_pool(&self->get_pool());
+  impl::file_chunk_func callback{callback_};
+
+  svn_stream_t* const stream = svn_stream_create(&callback,
+                                                 scratch_pool.get());
+  svn_stream_set_write(stream, impl::file_chunk_func::write);
+
+  svn_revnum_t fetched_rev;
+  impl::checked_call(
+      svn_ra_get_file(self->get_session(), path, svn_revnum_t(rev),
+                      stream, &fetched_rev, nullptr, scratch_pool.get()));
+  return revision::number(fetched_rev);
+}
+
+revision::number session::get_dir(const char* path, revision::number rev,
+                                  dirent_callback callback)
+{
+  const auto self = impl::unwrap(*this);
+  const apr::pool scratch_pool(&self->get_pool());
+
+  apr_hash_t* dirents;
+  svn_revnum_t fetched_rev;
+  impl::checked_call(
+      svn_ra_get_dir2(self->get_session(), &dirents, &fetched_rev, nullptr,
+                      path, svn_revnum_t(rev), SVN_DIRENT_ALL,
+                      scratch_pool.get()));
+
+  if (callback)
+    {
+      for (const auto& entry : apr::Hash<char, svn_dirent_t>(dirents))
+        {
+          try
+            {
+              callback(entry.first.get(), impl::dirent_view(entry.second));
+            }
+          catch (const stop_iteration&)
+            {
+              impl::checked_call(impl::iteration_stopped());
+            }
+        }
+    }
+  return revision::number(fetched_rev);
+}
+
+void session::get_log(const char* path,
+                      revision::number start, revision::number end,
+                      int limit, log_callback callback_)
+{
+  const auto self = impl::unwrap(*this);
+  const apr::pool scratch_pool(&self->get_pool());
+  impl::log_func callback{callback_};
+
+  apr::array<const char*> paths(scratch_pool, 1);
+  paths.push(path);
+
+  impl::checked_call(
+      svn_ra_get_log2(self->get_session(), paths.get_array(),
+                      svn_revnum_t(start), svn_revnum_t(end), limit,
+                      false, false, false, nullptr,
+                      impl::log_func::receiver, &callback,
+                      scratch_pool.get()));
+}
+
+} // namespace ra
+} // namespace svnxx
+} // namespace subversion
+} // namespace apache
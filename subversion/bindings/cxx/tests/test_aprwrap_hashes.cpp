@@ -107,4 +107,24 @@ BOOST_AUTO_TEST_CASE(iterate)
   hash.iterate(callback, pool);
 }
 
+BOOST_AUTO_TEST_CASE(range_iteration)
+{
+  typedef APR::Hash<char, const char> H;
+
+  apr::pool pool;
+  H hash(pool);
+  hash.set("aa", "a");
+  hash.set("bbb", "b");
+  hash.set("cccc", "c");
+
+  H::size_type count = 0;
+  for (const auto& entry : hash)
+    {
+      BOOST_TEST(entry.second == hash.get(entry.first));
+      ++count;
+    }
+  BOOST_TEST(count == hash.size());
+  BOOST_TEST((H(pool).begin() == H(pool).end()));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -47,6 +47,27 @@ BOOST_AUTO_TEST_CASE(create_subpool)
   BOOST_TEST(pool.get() == apr_pool_parent_get(subpool.get()));
 }
 
+BOOST_AUTO_TEST_CASE(move_pool)
+{
+  apr::pool pool;
+  apr_pool_t* const raw = pool.get();
+  apr::pool moved(std::move(pool));
+  BOOST_TEST(moved.get() == raw);
+  BOOST_TEST(pool.get() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(recycle_pool)
+{
+  apr_pool_t* raw;
+  {
+    apr::pool pool;
+    raw = pool.get();
+  }
+  // The pool was cleared and put on this thread's free list.
+  apr::pool pool;
+  BOOST_TEST(pool.get() == raw);
+}
+
 BOOST_AUTO_TEST_CASE(typed_allocate)
 {
   apr::pool pool;
@@ -68,4 +68,24 @@ BOOST_AUTO_TEST_CASE(async_example,
   std::cout << "got revision: " << long(future.get()) << std::endl;
 }
 
+BOOST_AUTO_TEST_CASE(batch_example,
+                     * boost::unit_test::disabled())
+{
+  svn::client::context ctx;
+  const auto revnum = svn::client::status(
+      ctx, working_copy_root,
+      svn::revision(),
+      svn::depth::unknown,
+      svn::client::status_flags::empty,
+      [](const svn::client::status_batch& batch)
+        {
+          std::cout << "status batch in: " << batch.directory()
+                    << " (" << batch.size() << " entries)" << std::endl;
+          for (const auto& entry : batch)
+            std::cout << "  " << entry.path << ": "
+                      << int(entry.status.node_status()) << std::endl;
+        });
+  std::cout << "got revision: " << long(revnum) << std::endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END();
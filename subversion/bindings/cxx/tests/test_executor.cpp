@@ -0,0 +1,119 @@
+/*
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../src/private/executor_private.hpp"
+
+#include "fixture_init.hpp"
+
+namespace svn = ::apache::subversion::svnxx;
+namespace impl = ::apache::subversion::svnxx::impl;
+
+BOOST_AUTO_TEST_SUITE(executors,
+                      * boost::unit_test::fixture<init>());
+
+BOOST_AUTO_TEST_CASE(default_concurrency)
+{
+  svn::executor exec;
+  BOOST_TEST(exec.concurrency() > 0U);
+}
+
+BOOST_AUTO_TEST_CASE(bounded_concurrency)
+{
+  constexpr unsigned workers = 3;
+  constexpr int task_count = 50;
+
+  svn::executor exec(workers);
+  BOOST_TEST(exec.concurrency() == workers);
+
+  std::atomic<unsigned> running{0};
+  std::atomic<unsigned> max_running{0};
+  std::atomic<int> pools{0};
+
+  std::vector<svn::detail::future<int>> results;
+  for (int i = 0; i < task_count; ++i)
+    {
+      results.push_back(impl::schedule<int>(
+          exec,
+          [&, i](apr::pool& scratch_pool)
+            {
+              const unsigned now = ++running;
+              unsigned seen = max_running.load();
+              while (now > seen
+                     && !max_running.compare_exchange_weak(seen, now))
+                ;
+              if (scratch_pool.get())
+                ++pools;
+
+              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+              --running;
+              return i;
+            }));
+    }
+
+  for (int i = 0; i < task_count; ++i)
+    BOOST_TEST(results[i].get() == i);
+  BOOST_TEST(pools.load() == task_count);
+  BOOST_TEST(max_running.load() <= workers);
+}
+
+BOOST_AUTO_TEST_CASE(propagate_exceptions)
+{
+  svn::executor exec(1);
+  auto result = impl::schedule<int>(
+      exec,
+      [](apr::pool&) -> int
+        {
+          throw std::runtime_error("task failed");
+        });
+  BOOST_CHECK_THROW(result.get(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(finish_queued_tasks)
+{
+  std::atomic<int> done{0};
+  {
+    svn::executor exec(2);
+    for (int i = 0; i < 10; ++i)
+      impl::schedule<void>(exec, [&done](apr::pool&) { ++done; });
+  }
+  BOOST_TEST(done.load() == 10);
+}
+
+BOOST_AUTO_TEST_CASE(post_work)
+{
+  std::atomic<int> done{0};
+  {
+    svn::executor exec(2);
+    for (int i = 0; i < 10; ++i)
+      exec.post([&done] { ++done; });
+  }
+  BOOST_TEST(done.load() == 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,83 @@
+/*
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "fixture_init.hpp"
+
+#include <iostream>
+
+#include "svnxx/ra/session.hpp"
+
+namespace svn = ::apache::subversion::svnxx;
+
+BOOST_AUTO_TEST_SUITE(ra_session,
+                      * boost::unit_test::fixture<init>());
+
+namespace {
+const char repository_url[] = "https://svn.apache.org/repos/asf/subversion";
+}
+
+BOOST_AUTO_TEST_CASE(get_dir_example,
+                     * boost::unit_test::disabled())
+{
+  svn::client::context ctx;
+  svn::ra::session session(ctx, repository_url);
+  const auto revnum = session.get_dir(
+      "trunk", svn::revision::number::invalid,
+      [](const char* name, const svn::ra::dirent& entry)
+        {
+          std::cout << name << ": r" << long(entry.created_rev())
+                    << " " << entry.size() << std::endl;
+        });
+  std::cout << "got revision: " << long(revnum) << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(get_file_example,
+                     * boost::unit_test::disabled())
+{
+  svn::client::context ctx;
+  svn::ra::session session(ctx, repository_url);
+  std::size_t total = 0;
+  session.get_file("trunk/README", svn::revision::number::invalid,
+                   [&total](const char*, std::size_t size)
+                     {
+                       total += size;
+                     });
+  std::cout << "read " << total << " bytes" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(get_log_example,
+                     * boost::unit_test::disabled())
+{
+  svn::client::context ctx;
+  svn::ra::session session(ctx, repository_url);
+  const auto head = session.latest_revnum();
+  session.get_log("trunk", head, svn::revision::number(0), 10,
+                  [](const svn::ra::log_entry& entry)
+                    {
+                      std::cout << "r" << long(entry.revnum()) << " | "
+                                << (entry.author() ? entry.author() : "")
+                                << std::endl;
+                    });
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -54,7 +54,9 @@ CreateJ::ConflictDescriptor(const svn_wc_conflict_description2_t *desc)
     return NULL;
 
   // Create an instance of the conflict descriptor.
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/ConflictDescriptor"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz =
+    clazz_cache.getClass(env, JAVAHL_CLASS("/ConflictDescriptor"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -177,7 +179,9 @@ CreateJ::ConflictVersion(const svn_wc_conflict_version_t *version)
     return NULL;
 
   // Create an instance of the conflict version.
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/types/ConflictVersion"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz =
+    clazz_cache.getClass(env, JAVAHL_CLASS("/types/ConflictVersion"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -228,7 +232,8 @@ CreateJ::Checksum(const svn_checksum_t *checksum)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/types/Checksum"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/types/Checksum"));
   if (JNIUtil::isExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -273,7 +278,8 @@ CreateJ::DirEntry(const char *path, const char *absPath,
   if (JNIUtil::isJavaExceptionThrown())
     return SVN_NO_ERROR;
 
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/types/DirEntry"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/types/DirEntry"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -327,7 +333,8 @@ CreateJ::Info(const char *path, const svn_client_info2_t *info)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/types/Info"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/types/Info"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -473,7 +480,8 @@ CreateJ::Lock(const svn_lock_t *lock)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/types/Lock"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/types/Lock"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -524,7 +532,8 @@ CreateJ::LockMap(const apr_hash_t *locks, apr_pool_t *pool)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass("java/util/HashMap");
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, "java/util/HashMap");
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -587,7 +596,9 @@ CreateJ::ChangedPath(const char *path, svn_log_changed_path2_t *log_item)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazzCP = env->FindClass(JAVAHL_CLASS("/types/ChangePath"));
+  static JNIGlobalRefCache clazzCP_cache;
+  jclass clazzCP =
+    clazzCP_cache.getClass(env, JAVAHL_CLASS("/types/ChangePath"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -649,7 +660,8 @@ CreateJ::Status(svn_wc_context_t *wc_ctx,
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/types/Status"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/types/Status"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -792,7 +804,9 @@ CreateJ::ClientNotifyInformation(const svn_wc_notify_t *wcNotify)
     return NULL;
 
   static jmethodID midCT = 0;
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/ClientNotifyInformation"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz =
+    clazz_cache.getClass(env, JAVAHL_CLASS("/ClientNotifyInformation"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -925,7 +939,9 @@ CreateJ::ReposNotifyInformation(const svn_repos_notify_t *reposNotify)
     return NULL;
 
   static jmethodID midCT = 0;
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/ReposNotifyInformation"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz =
+    clazz_cache.getClass(env, JAVAHL_CLASS("/ReposNotifyInformation"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -983,7 +999,8 @@ CreateJ::CommitItem(svn_client_commit_item3_t *item)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/CommitItem"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/CommitItem"));
   if (JNIUtil::isExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -1065,7 +1082,8 @@ CreateJ::CommitInfo(const svn_commit_info_t *commit_info)
     return NULL;
 
   static jmethodID midCT = 0;
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/CommitInfo"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/CommitInfo"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -1235,7 +1253,8 @@ jobject property_map(apr_hash_t *prop_hash, apr_array_header_t* prop_diffs,
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass("java/util/HashMap");
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, "java/util/HashMap");
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -1304,7 +1323,8 @@ jobject CreateJ::InheritedProps(apr_array_header_t *iprops)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass list_cls = env->FindClass("java/util/ArrayList");
+  static JNIGlobalRefCache list_cls_cache;
+  jclass list_cls = list_cls_cache.getClass(env, "java/util/ArrayList");
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -1325,8 +1345,10 @@ jobject CreateJ::InheritedProps(apr_array_header_t *iprops)
         POP_AND_RETURN_NULL;
     }
 
-  jclass item_cls = env->FindClass(
-      JAVAHL_CLASS("/callback/InheritedProplistCallback$InheritedItem"));
+  static JNIGlobalRefCache item_cls_cache;
+  jclass item_cls =
+    item_cls_cache.getClass(
+        env, JAVAHL_CLASS("/callback/InheritedProplistCallback$InheritedItem"));
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -1379,7 +1401,8 @@ jobject CreateJ::Mergeinfo(svn_mergeinfo_t mergeinfo, apr_pool_t* scratch_pool)
 
   // Transform mergeinfo into Java Mergeinfo object.
   JNIEnv *env = JNIUtil::getEnv();
-  jclass clazz = env->FindClass(JAVAHL_CLASS("/types/Mergeinfo"));
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, JAVAHL_CLASS("/types/Mergeinfo"));
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
@@ -1427,8 +1450,6 @@ jobject CreateJ::Mergeinfo(svn_mergeinfo_t mergeinfo, apr_pool_t* scratch_pool)
       env->DeleteLocalRef(jpath);
     }
 
-  env->DeleteLocalRef(clazz);
-
   return jmergeinfo;
 }
 
@@ -1442,7 +1463,8 @@ jobject CreateJ::Set(std::vector<jobject> &objects)
   if (JNIUtil::isJavaExceptionThrown())
     return NULL;
 
-  jclass clazz = env->FindClass("java/util/HashSet");
+  static JNIGlobalRefCache clazz_cache;
+  jclass clazz = clazz_cache.getClass(env, "java/util/HashSet");
   if (JNIUtil::isJavaExceptionThrown())
     POP_AND_RETURN_NULL;
 
@@ -34,16 +34,17 @@
 
 jobject EnumMapper::mapChangePathAction(const char action)
 {
+  static JNIGlobalRefCache values;
   switch (action)
     {
       case 'A':
-        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), 0);
+        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), values, 0);
       case 'D':
-        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), 1);
+        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), values, 1);
       case 'R':
-        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), 2);
+        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), values, 2);
       case 'M':
-        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), 3);
+        return mapEnum(JAVAHL_CLASS("/types/ChangePath$Action"), values, 3);
       default:
         return NULL;
     }
@@ -55,7 +56,8 @@ jobject EnumMapper::mapChangePathAction(const char action)
 jobject EnumMapper::mapNotifyState(svn_wc_notify_state_t state)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ClientNotifyInformation$Status"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ClientNotifyInformation$Status"), values,
                  static_cast<int>(state));
 }
 
@@ -65,14 +67,16 @@ jobject EnumMapper::mapNotifyState(svn_wc_notify_state_t state)
 jobject EnumMapper::mapNotifyAction(svn_wc_notify_action_t action)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ClientNotifyInformation$Action"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ClientNotifyInformation$Action"), values,
                  static_cast<int>(action));
 }
 
 jobject EnumMapper::mapReposNotifyNodeAction(svn_node_action action)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ReposNotifyInformation$NodeAction"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ReposNotifyInformation$NodeAction"), values,
                  static_cast<int>(action));
 }
 
@@ -82,7 +86,8 @@ jobject EnumMapper::mapReposNotifyNodeAction(svn_node_action action)
 jobject EnumMapper::mapReposNotifyAction(svn_repos_notify_action_t action)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ReposNotifyInformation$Action"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ReposNotifyInformation$Action"), values,
                  static_cast<int>(action));
 }
 
@@ -92,7 +97,8 @@ jobject EnumMapper::mapReposNotifyAction(svn_repos_notify_action_t action)
 jobject EnumMapper::mapNodeKind(svn_node_kind_t nodeKind)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/types/NodeKind"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/types/NodeKind"), values,
                  static_cast<int>(nodeKind));
 }
 
@@ -102,7 +108,8 @@ jobject EnumMapper::mapNodeKind(svn_node_kind_t nodeKind)
 jobject EnumMapper::mapNotifyLockState(svn_wc_notify_lock_state_t state)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ClientNotifyInformation$LockStatus"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ClientNotifyInformation$LockStatus"), values,
                  static_cast<int>(state));
 }
 
@@ -112,7 +119,8 @@ jobject EnumMapper::mapNotifyLockState(svn_wc_notify_lock_state_t state)
 jobject EnumMapper::mapScheduleKind(svn_wc_schedule_t schedule)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/types/Info$ScheduleKind"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/types/Info$ScheduleKind"), values,
                  static_cast<int>(schedule));
 }
 
@@ -123,63 +131,68 @@ jobject EnumMapper::mapStatusKind(svn_wc_status_kind svnKind)
 {
   // We're assuming a valid value for the C enum above
   // The offset here is +1
-  return mapEnum(JAVAHL_CLASS("/types/Status$Kind"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/types/Status$Kind"), values,
                  static_cast<int>(svnKind) - 1);
 }
 
 jobject EnumMapper::mapChecksumKind(svn_checksum_kind_t kind)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/types/Checksum$Kind"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/types/Checksum$Kind"), values,
                  static_cast<int>(kind));
 }
 
 jobject EnumMapper::mapConflictKind(svn_wc_conflict_kind_t kind)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Kind"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Kind"), values,
                  static_cast<int>(kind));
 }
 
 jobject EnumMapper::mapConflictAction(svn_wc_conflict_action_t action)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Action"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Action"), values,
                  static_cast<int>(action));
 }
 
 jobject EnumMapper::mapConflictReason(svn_wc_conflict_reason_t reason)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Reason"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Reason"), values,
                  static_cast<int>(reason));
 }
 
 int EnumMapper::toMergeinfoLogKind(jobject jLogKind)
 {
-  return getOrdinal(JAVAHL_CLASS("/types/Mergeinfo$LogKind"), jLogKind);
+  return getOrdinal(jLogKind);
 }
 
 int EnumMapper::toLogLevel(jobject jLogLevel)
 {
-  return getOrdinal(JAVAHL_CLASS("/SVNClient$ClientLogLevel"), jLogLevel);
+  return getOrdinal(jLogLevel);
 }
 
 svn_node_kind_t EnumMapper::toNodeKind(jobject jNodeKind)
 {
   return svn_node_kind_t(
-      getOrdinal(JAVAHL_CLASS("/types/NodeKind"), jNodeKind));
+      getOrdinal(jNodeKind));
 }
 
 svn_checksum_kind_t EnumMapper::toChecksumKind(jobject jChecksumKind)
 {
   return svn_checksum_kind_t(
-      getOrdinal(JAVAHL_CLASS("/types/Checksum$Kind"), jChecksumKind));
+      getOrdinal(jChecksumKind));
 }
 
 svn_tristate_t EnumMapper::toTristate(jobject jTristate)
 {
-  switch (getOrdinal(JAVAHL_CLASS("/types/Tristate"), jTristate))
+  switch (getOrdinal(jTristate))
     {
     case 1: return svn_tristate_false;
     case 2: return svn_tristate_true;
@@ -190,14 +203,14 @@ svn_tristate_t EnumMapper::toTristate(jobject jTristate)
 svn_depth_t EnumMapper::toDepth(jobject jdepth)
 {
   // The offset for depths is -2
-  return static_cast<svn_depth_t>(getOrdinal(JAVAHL_CLASS("/types/Depth"), jdepth) - 2);
+  return static_cast<svn_depth_t>(getOrdinal(jdepth) - 2);
 }
 
 svn_mergeinfo_inheritance_t
 EnumMapper::toMergeinfoInheritance(jobject jInheritance)
 {
   return static_cast<svn_mergeinfo_inheritance_t>(
-      getOrdinal(JAVAHL_CLASS("/types/Mergeinfo$Inheritance"), jInheritance));
+      getOrdinal(jInheritance));
 }
 
 
@@ -205,100 +218,121 @@ jobject EnumMapper::mapDepth(svn_depth_t depth)
 {
   // We're assuming a valid value for the C enum above
   // The offset for depths is -2
-  return mapEnum(JAVAHL_CLASS("/types/Depth"), static_cast<int>(depth) + 2);
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/types/Depth"), values,
+                 static_cast<int>(depth) + 2);
 }
 
 jobject EnumMapper::mapOperation(svn_wc_operation_t operation)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Operation"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/ConflictDescriptor$Operation"), values,
                  static_cast<int>(operation));
 }
 
 jobject EnumMapper::mapTristate(svn_tristate_t tristate)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/types/Tristate"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/types/Tristate"), values,
                  static_cast<int>(tristate - svn_tristate_false));
 }
 
 svn_wc_conflict_choice_t EnumMapper::toConflictChoice(jobject jchoice)
 {
   return static_cast<svn_wc_conflict_choice_t>
-             (getOrdinal(JAVAHL_CLASS("/ConflictResult$Choice"), jchoice));
+             (getOrdinal(jchoice));
 }
 
 svn_opt_revision_kind EnumMapper::toRevisionKind(jobject jkind)
 {
   return static_cast<svn_opt_revision_kind>
-             (getOrdinal(JAVAHL_CLASS("/types/Revision$Kind"), jkind));
+             (getOrdinal(jkind));
 }
 
 jobject EnumMapper::mapSummarizeKind(svn_client_diff_summarize_kind_t sKind)
 {
   // We're assuming a valid value for the C enum above
-  return mapEnum(JAVAHL_CLASS("/DiffSummary$DiffKind"),
+  static JNIGlobalRefCache values;
+  return mapEnum(JAVAHL_CLASS("/DiffSummary$DiffKind"), values,
                  static_cast<int>(sKind));
 }
 
-jobject EnumMapper::mapEnum(const char *clazzName, int index)
+jobject EnumMapper::mapEnum(const char *clazzName, JNIGlobalRefCache &values,
+                            int index)
 {
   // The fact that we can even do this depends upon a couple of assumptions,
   // mainly some knowledge about the orderin of the various constants in
   // both the C and Java enums.  Should those values ever change,
   // the World Will End.
 
-  std::string methodSig("()[L");
-  methodSig.append(clazzName);
-  methodSig.append(";");
-
   JNIEnv *env = JNIUtil::getEnv();
 
-  // Create a local frame for our references
-  env->PushLocalFrame(LOCAL_FRAME_SIZE);
-  if (JNIUtil::isJavaExceptionThrown())
-    return NULL;
+  // The constants of an enum never change, so the array returned by
+  // values() is fetched once and kept for as long as we are loaded.
+  jobjectArray jvalues = static_cast<jobjectArray>(values.get());
+  if (jvalues == NULL)
+    {
+      std::string methodSig("()[L");
+      methodSig.append(clazzName);
+      methodSig.append(";");
 
-  jclass clazz = env->FindClass(clazzName);
-  if (JNIUtil::isJavaExceptionThrown())
-    POP_AND_RETURN_NULL;
+      // Create a local frame for our references
+      env->PushLocalFrame(LOCAL_FRAME_SIZE);
+      if (JNIUtil::isJavaExceptionThrown())
+        return NULL;
 
-  jmethodID mid = env->GetStaticMethodID(clazz, "values", methodSig.c_str());
-  if (JNIUtil::isJavaExceptionThrown())
-    POP_AND_RETURN_NULL;
+      jclass clazz = env->FindClass(clazzName);
+      if (JNIUtil::isJavaExceptionThrown())
+        POP_AND_RETURN_NULL;
 
-  jobjectArray jvalues = (jobjectArray) env->CallStaticObjectMethod(clazz, mid);
-  if (JNIUtil::isJavaExceptionThrown())
-    POP_AND_RETURN_NULL;
+      jmethodID mid = env->GetStaticMethodID(clazz, "values",
+                                             methodSig.c_str());
+      if (JNIUtil::isJavaExceptionThrown())
+        POP_AND_RETURN_NULL;
+
+      jobject jarray = env->CallStaticObjectMethod(clazz, mid);
+      if (JNIUtil::isJavaExceptionThrown())
+        POP_AND_RETURN_NULL;
+
+      jvalues = static_cast<jobjectArray>(values.set(env, jarray));
+      env->PopLocalFrame(NULL);
+      if (jvalues == NULL)
+        return NULL;
+    }
 
   jobject jthing = env->GetObjectArrayElement(jvalues, index);
   if (JNIUtil::isJavaExceptionThrown())
-    POP_AND_RETURN_NULL;
+    return NULL;
 
-  return env->PopLocalFrame(jthing);
+  return jthing;
 }
 
-int EnumMapper::getOrdinal(const char *clazzName, jobject jenum)
+int EnumMapper::getOrdinal(jobject jenum)
 {
   JNIEnv *env = JNIUtil::getEnv();
 
-  // Create a local frame for our references
-  env->PushLocalFrame(LOCAL_FRAME_SIZE);
-  if (JNIUtil::isJavaExceptionThrown())
-    return -1;
+  // Enum.ordinal() is final, so one method id serves all enums.  It
+  // will not change during the time this library is loaded, so it
+  // can be cached.
+  static jmethodID mid = 0;
+  if (mid == 0)
+    {
+      jclass clazz = env->FindClass("java/lang/Enum");
+      if (JNIUtil::isJavaExceptionThrown())
+        return -1;
 
-  jclass clazz = env->FindClass(clazzName);
-  if (JNIUtil::isJavaExceptionThrown())
-    POP_AND_RETURN(-1);
+      mid = env->GetMethodID(clazz, "ordinal", "()I");
+      if (JNIUtil::isJavaExceptionThrown())
+        return -1;
 
-  jmethodID mid = env->GetMethodID(clazz, "ordinal", "()I");
-  if (JNIUtil::isJavaExceptionThrown())
-    POP_AND_RETURN(-1);
+      env->DeleteLocalRef(clazz);
+    }
 
   jint jorder = env->CallIntMethod(jenum, mid);
   if (JNIUtil::isJavaExceptionThrown())
-    POP_AND_RETURN(-1);
+    return -1;
 
-  env->PopLocalFrame(NULL);
   return static_cast<int>(jorder);
 }
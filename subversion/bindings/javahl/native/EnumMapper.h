@@ -34,6 +34,7 @@
 #include "svn_types.h"
 
 class JNIStringHolder;
+class JNIGlobalRefCache;
 
 /**
  * This class contains all the mappers between the C enum's and the
@@ -73,8 +74,9 @@ class EnumMapper
   static jobject mapTristate(svn_tristate_t);
   static jobject mapSummarizeKind(svn_client_diff_summarize_kind_t);
  private:
-  static jobject mapEnum(const char *clazzName, int offset);
-  static int getOrdinal(const char *clazzName, jobject jenum);
+  static jobject mapEnum(const char *clazzName, JNIGlobalRefCache &values,
+                         int offset);
+  static int getOrdinal(jobject jenum);
 };
 
 #endif  // ENUM_MAPPER_H
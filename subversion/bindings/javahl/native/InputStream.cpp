@@ -28,6 +28,18 @@
 #include "JNIUtil.h"
 #include "JNIByteArray.h"
 
+namespace {
+// The largest chunk that is copied through the reusable byte array
+// in one call to InputStream.read.
+const jsize MAX_ARRAY_CHUNK = 256 * 1024;
+
+// The smallest reusable byte array we bother to allocate.
+const jsize MIN_ARRAY_CHUNK = 16 * 1024;
+
+// The largest chunk that is wrapped in one direct ByteBuffer.
+const apr_size_t MAX_DIRECT_CHUNK = 1024 * 1024 * 1024;
+} // anonymous namespace
+
 /**
  * Create an InputStream object.
  * @param jthis the Java object to be stored
@@ -35,12 +47,20 @@
 InputStream::InputStream(jobject jthis)
 {
   m_jthis = jthis;
+  m_buffer = NULL;
+  m_buffer_size = 0;
+  m_is_channel = -1;
 }
 
 InputStream::~InputStream()
 {
   // The m_jthis does not need to be destroyed, because it is the
   // passed in parameter to the Java method.
+  if (m_buffer)
+    {
+      JNIEnv *env = JNIUtil::getEnv();
+      env->DeleteGlobalRef(m_buffer);
+    }
 }
 
 /**
@@ -62,6 +82,13 @@ svn_stream_t *InputStream::getStream(const SVN::Pool &pool)
 
 /**
  * Implements svn_read_fn_t to read to data into Subversion.
+ *
+ * If the Java object is also a @c java.nio.channels.ReadableByteChannel,
+ * it reads straight into @a buffer through a direct @c ByteBuffer; the
+ * channel must not keep that buffer after its @c read method returns.
+ * Otherwise, the data is read into a Java byte array that is reused
+ * for the lifetime of this object and copied once into @a buffer.
+ *
  * @param baton     an InputStream object for the callback
  * @param buffer    the buffer for the read data
  * @param len       on input the buffer len, on output the number of read bytes
@@ -76,54 +103,149 @@ svn_error_t *InputStream::read(void *baton, char *buffer, apr_size_t *len)
   // An object of our class is passed in as the baton.
   InputStream *that = static_cast<InputStream *>(baton);
 
+  // Find out once whether the source can fill a ByteBuffer.
+  if (that->m_is_channel < 0)
+    {
+      jclass clazz = env->FindClass("java/nio/channels/ReadableByteChannel");
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      that->m_is_channel = env->IsInstanceOf(that->m_jthis, clazz) ? 1 : 0;
+      env->DeleteLocalRef(clazz);
+    }
+
+  if (that->m_is_channel)
+    return that->readChannel(env, buffer, len);
+  return that->readArray(env, buffer, len);
+}
+
+/**
+ * Read up to @a *len bytes from the Java object into @a buffer through
+ * ReadableByteChannel.read, wrapping @a buffer in a direct ByteBuffer.
+ */
+svn_error_t *InputStream::readChannel(JNIEnv *env, char *buffer,
+                                      apr_size_t *len)
+{
   // The method id will not change during the time this library is
   // loaded, so it can be cached.
   static jmethodID mid = 0;
   if (mid == 0)
     {
-      jclass clazz = env->FindClass("java/io/InputStream");
+      jclass clazz = env->FindClass("java/nio/channels/ReadableByteChannel");
       if (JNIUtil::isJavaExceptionThrown())
         return SVN_NO_ERROR;
 
-      mid = env->GetMethodID(clazz, "read", "([B)I");
+      mid = env->GetMethodID(clazz, "read", "(Ljava/nio/ByteBuffer;)I");
       if (JNIUtil::isJavaExceptionThrown() || mid == 0)
         return SVN_NO_ERROR;
 
       env->DeleteLocalRef(clazz);
     }
 
-  // Allocate a Java byte array to read the data.
-  jbyteArray data = JNIUtil::makeJByteArray(buffer, static_cast<int>(*len));
+  const apr_size_t chunk = (*len > MAX_DIRECT_CHUNK ? MAX_DIRECT_CHUNK : *len);
+  jobject data = env->NewDirectByteBuffer(buffer, static_cast<jlong>(chunk));
   if (JNIUtil::isJavaExceptionThrown())
     return SVN_NO_ERROR;
 
+  // The VM does not support direct buffers; copy instead.
+  if (data == NULL)
+    {
+      m_is_channel = 0;
+      return readArray(env, buffer, len);
+    }
+
   // Read the data.
-  jint jread = env->CallIntMethod(that->m_jthis, mid, data);
+  jint jread = env->CallIntMethod(m_jthis, mid, data);
+  if (JNIUtil::isJavaExceptionThrown())
+    return SVN_NO_ERROR;
+
+  env->DeleteLocalRef(data);
+
+  // Convert -1 from ReadableByteChannel.read that means EOF, and
+  // catch when the channel claims to have read too much data.
+  if (jread < 0 || static_cast<apr_size_t>(jread) > chunk)
+    jread = 0;
+
+  *len = jread;
+  return SVN_NO_ERROR;
+}
+
+/**
+ * Read up to @a *len bytes from the Java object into @a buffer through
+ * InputStream.read, going through the reused #m_buffer.
+ */
+svn_error_t *InputStream::readArray(JNIEnv *env, char *buffer,
+                                    apr_size_t *len)
+{
+  // The method id will not change during the time this library is
+  // loaded, so it can be cached.
+  static jmethodID mid = 0;
+  if (mid == 0)
+    {
+      jclass clazz = env->FindClass("java/io/InputStream");
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      mid = env->GetMethodID(clazz, "read", "([BII)I");
+      if (JNIUtil::isJavaExceptionThrown() || mid == 0)
+        return SVN_NO_ERROR;
+
+      env->DeleteLocalRef(clazz);
+    }
+
+  const jsize chunk = (*len > static_cast<apr_size_t>(MAX_ARRAY_CHUNK)
+                       ? MAX_ARRAY_CHUNK : static_cast<jsize>(*len));
+
+  // Grow the reusable byte array if this chunk does not fit.
+  if (chunk > m_buffer_size)
+    {
+      jsize size = (m_buffer_size * 2 > MIN_ARRAY_CHUNK
+                    ? m_buffer_size * 2 : MIN_ARRAY_CHUNK);
+      if (size < chunk)
+        size = chunk;
+      if (size > MAX_ARRAY_CHUNK)
+        size = MAX_ARRAY_CHUNK;
+
+      jbyteArray data = env->NewByteArray(size);
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      if (m_buffer)
+        env->DeleteGlobalRef(m_buffer);
+      m_buffer = static_cast<jbyteArray>(env->NewGlobalRef(data));
+      env->DeleteLocalRef(data);
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+      m_buffer_size = size;
+    }
+
+  // Read the data.
+  jint jread = env->CallIntMethod(m_jthis, mid, m_buffer, jint(0),
+                                  jint(chunk));
   if (JNIUtil::isJavaExceptionThrown())
     return SVN_NO_ERROR;
 
   /*
    * Convert -1 from InputStream.read that means EOF, 0 which is subversion equivalent
    */
-  if(jread == -1)
+  if (jread == -1)
     {
       jread = 0;
     }
 
-  // Put the Java byte array into a helper object to retrieve the
-  // data bytes.
-  JNIByteArray outdata(data, true);
-  if (JNIUtil::isJavaExceptionThrown())
-    return SVN_NO_ERROR;
-
   // Catch when the Java method tells us it read too much data.
-  if (jread > (jint) *len)
+  if (jread > chunk)
     jread = 0;
 
   // In the case of success copy the data back to the Subversion
   // buffer.
   if (jread > 0)
-    memcpy(buffer, outdata.getBytes(), jread);
+    {
+      env->GetByteArrayRegion(m_buffer, 0, jread,
+                              reinterpret_cast<jbyte *>(buffer));
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+    }
 
   // Copy the number of read bytes back to Subversion.
   *len = jread;
@@ -42,6 +42,26 @@ class InputStream
    * A local reference to the Java object.
    */
   jobject m_jthis;
+
+  /**
+   * A global reference to a Java byte array that is reused for every
+   * chunk read from a plain @c java.io.InputStream, or NULL.
+   */
+  jbyteArray m_buffer;
+
+  /**
+   * The length of #m_buffer.
+   */
+  jsize m_buffer_size;
+
+  /**
+   * Whether #m_jthis also implements
+   * @c java.nio.channels.ReadableByteChannel; -1 if not known yet.
+   */
+  int m_is_channel;
+
+  svn_error_t *readChannel(JNIEnv *env, char *buffer, apr_size_t *len);
+  svn_error_t *readArray(JNIEnv *env, char *buffer, apr_size_t *len);
   static svn_error_t *read(void *baton, char *buffer, apr_size_t *len);
   static svn_error_t *close(void *baton);
  public:
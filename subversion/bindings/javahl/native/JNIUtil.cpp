@@ -44,6 +44,7 @@
 #include <apr_lib.h>
 #include <apr_file_info.h>
 #include <apr_time.h>
+#include <apr_atomic.h>
 
 #include "svn_pools.h"
 #include "svn_error.h"
@@ -1169,3 +1170,43 @@ jthrowable JNIUtil::unwrapJavaException(const svn_error_t *err)
     return
         WrappedException::get_exception(err->pool);
 }
+
+JNIGlobalRefCache::JNIGlobalRefCache()
+  : m_ref(NULL)
+{
+}
+
+jobject JNIGlobalRefCache::get() const
+{
+  return static_cast<jobject>(apr_atomic_casptr(&m_ref, NULL, NULL));
+}
+
+jobject JNIGlobalRefCache::set(JNIEnv *env, jobject local)
+{
+  jobject ref = env->NewGlobalRef(local);
+  env->DeleteLocalRef(local);
+  if (JNIUtil::isJavaExceptionThrown() || ref == NULL)
+    return NULL;
+
+  jobject cached = static_cast<jobject>(apr_atomic_casptr(&m_ref, ref, NULL));
+  if (cached != NULL)
+    {
+      // Another thread won the race; use its reference.
+      env->DeleteGlobalRef(ref);
+      return cached;
+    }
+  return ref;
+}
+
+jclass JNIGlobalRefCache::getClass(JNIEnv *env, const char *name)
+{
+  jobject cached = get();
+  if (cached != NULL)
+    return static_cast<jclass>(cached);
+
+  jclass clazz = env->FindClass(name);
+  if (JNIUtil::isJavaExceptionThrown())
+    return NULL;
+
+  return static_cast<jclass>(set(env, clazz));
+}
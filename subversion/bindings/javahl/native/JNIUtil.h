@@ -227,6 +227,46 @@ class JNIUtil
   static std::ofstream g_logStream;
 };
 
+/**
+ * A lazily created global reference that is kept for as long as the
+ * library is loaded.  Meant to be used as a function-level static,
+ * like the cached method IDs, for classes and other objects that
+ * would otherwise be looked up on every call.
+ *
+ * @since 1.15
+ */
+class JNIGlobalRefCache
+{
+ public:
+  JNIGlobalRefCache();
+
+  /**
+   * @return the cached reference, or NULL if it was not set yet.
+   */
+  jobject get() const;
+
+  /**
+   * Cache a global reference to @a local and delete @a local.  If
+   * another thread got here first, keep its reference instead.
+   * @return the cached reference, or NULL if a Java exception was
+   * thrown.
+   */
+  jobject set(JNIEnv *env, jobject local);
+
+  /**
+   * @return the cached class, looking it up by @a name on first use,
+   * or NULL if a Java exception was thrown.
+   */
+  jclass getClass(JNIEnv *env, const char *name);
+
+ private:
+  // Non-copyable
+  JNIGlobalRefCache(const JNIGlobalRefCache&);
+  JNIGlobalRefCache& operator=(const JNIGlobalRefCache&);
+
+  mutable volatile void *m_ref;
+};
+
 /**
  * A statement macro used for checking NULL pointers, in the style of
  * SVN_ERR().
@@ -27,6 +27,19 @@
 #include "OutputStream.h"
 #include "JNIUtil.h"
 #include "JNIByteArray.h"
+#include "svn_error.h"
+
+namespace {
+// The largest chunk that is copied through the reusable byte array
+// in one call to OutputStream.write.
+const jsize MAX_ARRAY_CHUNK = 256 * 1024;
+
+// The smallest reusable byte array we bother to allocate.
+const jsize MIN_ARRAY_CHUNK = 16 * 1024;
+
+// The largest chunk that is wrapped in one direct ByteBuffer.
+const apr_size_t MAX_DIRECT_CHUNK = 1024 * 1024 * 1024;
+} // anonymous namespace
 
 /**
  * Create an OutputStream object.
@@ -35,6 +48,9 @@
 OutputStream::OutputStream(jobject jthis)
 {
   m_jthis = jthis;
+  m_buffer = NULL;
+  m_buffer_size = 0;
+  m_is_channel = -1;
 }
 
 /**
@@ -44,6 +60,11 @@ OutputStream::~OutputStream()
 {
   // The m_jthis does not need to be destroyed, because it is the
   // passed in parameter to the Java method.
+  if (m_buffer)
+    {
+      JNIEnv *env = JNIUtil::getEnv();
+      env->DeleteGlobalRef(m_buffer);
+    }
 }
 
 /**
@@ -64,6 +85,13 @@ svn_stream_t *OutputStream::getStream(const SVN::Pool &pool)
 
 /**
  * Implements svn_write_fn_t to write data out from Subversion.
+ *
+ * If the Java object is also a @c java.nio.channels.WritableByteChannel,
+ * the data is handed over without copying in a direct @c ByteBuffer
+ * that wraps @a buffer; the channel must not keep that buffer after
+ * its @c write method returns.  Otherwise, the data is copied into a
+ * Java byte array that is reused for the lifetime of this object.
+ *
  * @param baton     an OutputStream object for the callback
  * @param buffer    the buffer for the write data
  * @param len       on input the buffer len, on output the number of written
@@ -78,6 +106,97 @@ svn_error_t *OutputStream::write(void *baton, const char *buffer,
   // An object of our class is passed in as the baton.
   OutputStream *that = static_cast<OutputStream *>(baton);
 
+  // Find out once whether the target can take a ByteBuffer.
+  if (that->m_is_channel < 0)
+    {
+      jclass clazz = env->FindClass("java/nio/channels/WritableByteChannel");
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      that->m_is_channel = env->IsInstanceOf(that->m_jthis, clazz) ? 1 : 0;
+      env->DeleteLocalRef(clazz);
+    }
+
+  if (that->m_is_channel)
+    return that->writeChannel(env, buffer, *len);
+  return that->writeArray(env, buffer, *len);
+}
+
+/**
+ * Write @a len bytes from @a buffer to the Java object through
+ * WritableByteChannel.write, wrapping @a buffer in a direct ByteBuffer.
+ */
+svn_error_t *OutputStream::writeChannel(JNIEnv *env, const char *buffer,
+                                        apr_size_t len)
+{
+  // The method id will not change during the time this library is
+  // loaded, so it can be cached.
+  static jmethodID mid = 0;
+  if (mid == 0)
+    {
+      jclass clazz = env->FindClass("java/nio/channels/WritableByteChannel");
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      mid = env->GetMethodID(clazz, "write", "(Ljava/nio/ByteBuffer;)I");
+      if (JNIUtil::isJavaExceptionThrown() || mid == 0)
+        return SVN_NO_ERROR;
+
+      env->DeleteLocalRef(clazz);
+    }
+
+  while (len > 0)
+    {
+      const apr_size_t chunk = (len > MAX_DIRECT_CHUNK
+                                ? MAX_DIRECT_CHUNK : len);
+
+      // The channel only reads from the buffer, so it is safe to
+      // cast away the const here.
+      jobject data = env->NewDirectByteBuffer(const_cast<char *>(buffer),
+                                              static_cast<jlong>(chunk));
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      // The VM does not support direct buffers; copy instead.
+      if (data == NULL)
+        {
+          m_is_channel = 0;
+          return writeArray(env, buffer, len);
+        }
+
+      // A channel may accept fewer bytes than offered, so keep
+      // writing until the buffer is drained.
+      apr_size_t written = 0;
+      while (written < chunk)
+        {
+          jint jwritten = env->CallIntMethod(m_jthis, mid, data);
+          if (JNIUtil::isJavaExceptionThrown())
+            return SVN_NO_ERROR;
+
+          if (jwritten < 0)
+            {
+              env->DeleteLocalRef(data);
+              return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                                      NULL);
+            }
+          written += jwritten;
+        }
+
+      env->DeleteLocalRef(data);
+      buffer += chunk;
+      len -= chunk;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/**
+ * Write @a len bytes from @a buffer to the Java object through
+ * OutputStream.write, copying them into the reused #m_buffer.
+ */
+svn_error_t *OutputStream::writeArray(JNIEnv *env, const char *buffer,
+                                      apr_size_t len)
+{
   // The method id will not change during the time this library is
   // loaded, so it can be cached.
   static jmethodID mid = 0;
@@ -87,24 +206,54 @@ svn_error_t *OutputStream::write(void *baton, const char *buffer,
       if (JNIUtil::isJavaExceptionThrown())
         return SVN_NO_ERROR;
 
-      mid = env->GetMethodID(clazz, "write", "([B)V");
+      mid = env->GetMethodID(clazz, "write", "([BII)V");
       if (JNIUtil::isJavaExceptionThrown() || mid == 0)
         return SVN_NO_ERROR;
 
       env->DeleteLocalRef(clazz);
     }
 
-  // convert the data to a Java byte array
-  jbyteArray data = JNIUtil::makeJByteArray(buffer, static_cast<int>(*len));
-  if (JNIUtil::isJavaExceptionThrown())
-    return SVN_NO_ERROR;
+  while (len > 0)
+    {
+      const jsize chunk = (len > static_cast<apr_size_t>(MAX_ARRAY_CHUNK)
+                           ? MAX_ARRAY_CHUNK : static_cast<jsize>(len));
+
+      // Grow the reusable byte array if this chunk does not fit.
+      if (chunk > m_buffer_size)
+        {
+          jsize size = (m_buffer_size * 2 > MIN_ARRAY_CHUNK
+                        ? m_buffer_size * 2 : MIN_ARRAY_CHUNK);
+          if (size < chunk)
+            size = chunk;
+          if (size > MAX_ARRAY_CHUNK)
+            size = MAX_ARRAY_CHUNK;
+
+          jbyteArray data = env->NewByteArray(size);
+          if (JNIUtil::isJavaExceptionThrown())
+            return SVN_NO_ERROR;
 
-  // write the data
-  env->CallObjectMethod(that->m_jthis, mid, data);
-  if (JNIUtil::isJavaExceptionThrown())
-    return SVN_NO_ERROR;
+          if (m_buffer)
+            env->DeleteGlobalRef(m_buffer);
+          m_buffer = static_cast<jbyteArray>(env->NewGlobalRef(data));
+          env->DeleteLocalRef(data);
+          if (JNIUtil::isJavaExceptionThrown())
+            return SVN_NO_ERROR;
+          m_buffer_size = size;
+        }
 
-  env->DeleteLocalRef(data);
+      env->SetByteArrayRegion(m_buffer, 0, chunk,
+                              reinterpret_cast<const jbyte *>(buffer));
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      // write the data
+      env->CallVoidMethod(m_jthis, mid, m_buffer, jint(0), jint(chunk));
+      if (JNIUtil::isJavaExceptionThrown())
+        return SVN_NO_ERROR;
+
+      buffer += chunk;
+      len -= chunk;
+    }
 
   return SVN_NO_ERROR;
 }
@@ -41,6 +41,26 @@ class OutputStream
    * A local reference to the Java object.
    */
   jobject m_jthis;
+
+  /**
+   * A global reference to a Java byte array that is reused for every
+   * chunk written to a plain @c java.io.OutputStream, or NULL.
+   */
+  jbyteArray m_buffer;
+
+  /**
+   * The length of #m_buffer.
+   */
+  jsize m_buffer_size;
+
+  /**
+   * Whether #m_jthis also implements
+   * @c java.nio.channels.WritableByteChannel; -1 if not known yet.
+   */
+  int m_is_channel;
+
+  svn_error_t *writeChannel(JNIEnv *env, const char *buffer, apr_size_t len);
+  svn_error_t *writeArray(JNIEnv *env, const char *buffer, apr_size_t len);
   static svn_error_t *write(void *baton,
                             const char *buffer, apr_size_t *len);
   static svn_error_t *close(void *baton);
@@ -29,13 +29,46 @@
 #include "JNIMutex.h"
 #include "JNICriticalSection.h"
 #include "svn_pools.h"
+#include <apr_atomic.h>
+
+namespace {
+/* Spare pools of the global pool.  Several JNI calls can run at the
+   same time on different threads, so keep a few of them around. */
+const int GLOBAL_SPARE_COUNT = 16;
+volatile void *global_spares[GLOBAL_SPARE_COUNT];
+
+/* Take a spare pool out of one of the COUNT slots in SPARES, or
+   return NULL if they are all empty. */
+apr_pool_t *take_spare(volatile void **spares, int count)
+{
+  for (int i = 0; i < count; ++i)
+    {
+      void *spare = apr_atomic_casptr(&spares[i], NULL, NULL);
+      if (spare && apr_atomic_casptr(&spares[i], NULL, spare) == spare)
+        return static_cast<apr_pool_t *>(spare);
+    }
+  return NULL;
+}
+
+/* Put POOL into an empty slot of the COUNT slots in SPARES.  Return
+   false if there is no empty slot. */
+bool put_spare(volatile void **spares, int count, apr_pool_t *pool)
+{
+  for (int i = 0; i < count; ++i)
+    {
+      if (apr_atomic_casptr(&spares[i], pool, NULL) == NULL)
+        return true;
+    }
+  return false;
+}
+} // anonymous namespace
 
 /**
  * Constructor to create one apr pool as the subpool of the global pool.
  */
 SVN::Pool::Pool()
 {
-  m_pool = svn_pool_create(JNIUtil::getPool());
+  acquire(JNIUtil::getPool(), global_spares, GLOBAL_SPARE_COUNT);
 }
 
 /**
@@ -43,27 +76,58 @@ SVN::Pool::Pool()
  */
 SVN::Pool::Pool(const Pool &parent_pool)
 {
-  m_pool = svn_pool_create(parent_pool.m_pool);
+  acquire(parent_pool.m_pool, &parent_pool.m_spare, 1);
 }
 
 /**
  * Constructor to create one apr pool as a subpool of the passed pool.
+ * The parent is not a Pool object, so this one is not recycled.
  */
 SVN::Pool::Pool(apr_pool_t *parent_pool)
 {
   m_pool = svn_pool_create(parent_pool);
+  m_parent_spares = NULL;
+  m_parent_spare_count = 0;
+  m_spare = NULL;
 }
 
 /**
- * Destructor to destroy the apr pool and to clear the request pool
- * pointer.
+ * Reuse a spare subpool of @a parent_pool from @a spares, or create a
+ * new one.
+ */
+void SVN::Pool::acquire(apr_pool_t *parent_pool,
+                        volatile void **spares, int spare_count)
+{
+  m_pool = take_spare(spares, spare_count);
+  if (!m_pool)
+    m_pool = svn_pool_create(parent_pool);
+  m_parent_spares = spares;
+  m_parent_spare_count = spare_count;
+  m_spare = NULL;
+}
+
+/**
+ * Destructor to clear the apr pool and hand it back to its parent for
+ * reuse, or to destroy it if the parent already has enough spares.
  */
 SVN::Pool::~Pool()
 {
   if (m_pool)
     {
+      // Our own spare is a child of m_pool; it goes away with it.
+      m_spare = NULL;
+
+      if (m_parent_spares)
+        {
+          svn_pool_clear(m_pool);
+          if (put_spare(m_parent_spares, m_parent_spare_count, m_pool))
+            {
+              m_pool = NULL;
+              return;
+            }
+        }
+
       svn_pool_destroy(m_pool);
       m_pool = NULL;
     }
 }
-
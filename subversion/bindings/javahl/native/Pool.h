@@ -34,6 +34,12 @@ namespace SVN {
    * This class manages one APR pool.  Objects of this class are
    * allocated on the stack of the SVNClient and SVNAdmin methods as the
    * request pool.  Leaving the methods will destroy the pool.
+   *
+   * Pools created from the global pool or from another Pool object
+   * are recycled: instead of being destroyed, they are cleared and
+   * kept as a spare by their parent, and the next Pool created from
+   * the same parent reuses the spare.  This saves the create/destroy
+   * cycle and the allocator traffic of short, frequent requests.
    */
   class Pool
   {
@@ -51,6 +57,25 @@ namespace SVN {
      */
     apr_pool_t *m_pool;
 
+    /**
+     * The spare slots of the parent, to which this pool is returned
+     * when the object is destroyed, or NULL.
+     */
+    volatile void **m_parent_spares;
+
+    /**
+     * The number of slots in #m_parent_spares.
+     */
+    int m_parent_spare_count;
+
+    /**
+     * A cleared child pool that is waiting to be reused, or NULL.
+     */
+    mutable volatile void *m_spare;
+
+    void acquire(apr_pool_t *parent_pool,
+                 volatile void **spares, int spare_count);
+
     /**
      * We declare the assignment operator private here, so that the compiler
      * won't inadvertently use them for us.
@@ -75,6 +100,8 @@ namespace SVN {
   inline
   void Pool::clear() const
   {
+    // Clearing destroys the spare child pool, too.
+    m_spare = NULL;
     svn_pool_clear(m_pool);
   }
 }
@@ -49,6 +49,7 @@
 #include "PatchCallback.h"
 #include "CommitCallback.h"
 #include "StatusCallback.h"
+#include "StatusBatchCallback.h"
 #include "ChangelistCallback.h"
 #include "ListCallback.h"
 #include "ImportFilterCallback.h"
@@ -227,6 +228,38 @@ SVNClient::status(const char *path, svn_depth_t depth,
                                    subPool.getPool()), );
 }
 
+void
+SVNClient::statusBatch(const char *path, svn_depth_t depth,
+                       bool onServer, bool onDisk, bool getAll,
+                       bool noIgnore, bool ignoreExternals,
+                       bool depthAsSticky, StringArray &changelists,
+                       StatusBatchCallback *callback)
+{
+    SVN::Pool subPool(pool);
+    svn_revnum_t youngest = SVN_INVALID_REVNUM;
+    svn_opt_revision_t rev;
+
+    SVN_JNI_NULL_PTR_EX(path, "path", );
+
+    svn_client_ctx_t *ctx = context.getContext(NULL, subPool);
+    if (ctx == NULL)
+        return;
+
+    Path checkedPath(path, subPool);
+    SVN_JNI_ERR(checkedPath.error_occurred(), );
+
+    rev.kind = svn_opt_revision_unspecified;
+
+    SVN_JNI_ERR(svn_client_status6(&youngest, ctx, checkedPath.c_str(),
+                                   &rev, depth,
+                                   getAll, onServer, onDisk,
+                                   noIgnore, ignoreExternals, depthAsSticky,
+                                   changelists.array(subPool),
+                                   StatusBatchCallback::callback, callback,
+                                   subPool.getPool()), );
+    SVN_JNI_ERR(callback->flush(), );
+}
+
 /* Convert a vector of revision ranges to an APR array of same. */
 static apr_array_header_t *
 rev_range_vector_to_apr_array(std::vector<RevisionRange> &revRanges,
@@ -1442,8 +1475,8 @@ jstring SVNClient::getVersionInfo(const char *path, const char *trailUrl,
 
     SVN_JNI_ERR(svn_dirent_get_absolute(&local_abspath, intPath.c_str(),
                                         subPool.getPool()), NULL);
-    SVN_JNI_ERR(svn_wc_revision_status2(&result, ctx->wc_ctx, local_abspath,
-                                        trailUrl, lastChanged,
+    SVN_JNI_ERR(svn_wc_revision_status3(&result, ctx->wc_ctx, local_abspath,
+                                        trailUrl, lastChanged, FALSE,
                                         ctx->cancel_func, ctx->cancel_baton,
                                         subPool.getPool(),
                                         subPool.getPool()), NULL);
@@ -48,6 +48,7 @@ class CommitCallback;
 class ListCallback;
 class ImportFilterCallback;
 class StatusCallback;
+class StatusBatchCallback;
 class OutputStream;
 class PatchCallback;
 class ChangelistCallback;
@@ -188,6 +189,11 @@ class SVNClient :public SVNBase
               bool noIgnore, bool ignoreExternals,
               bool depthAsSticky, StringArray &changelists,
               StatusCallback *callback);
+  void statusBatch(const char *path, svn_depth_t depth,
+                   bool onServer, bool onDisk, bool getAll,
+                   bool noIgnore, bool ignoreExternals,
+                   bool depthAsSticky, StringArray &changelists,
+                   StatusBatchCallback *callback);
   void list(const char *url, Revision &revision, Revision &pegRevision,
             StringArray &patterns, svn_depth_t depth, int direntFields,
             bool fetchLocks, bool includeExternals,
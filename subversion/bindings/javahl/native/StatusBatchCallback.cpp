@@ -0,0 +1,249 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file StatusBatchCallback.cpp
+ * @brief Implementation of the class StatusBatchCallback
+ */
+
+#include <cstring>
+
+#include "StatusBatchCallback.h"
+#include "JNIUtil.h"
+#include "svn_path.h"
+#include "../include/org_apache_subversion_javahl_types_Revision.h"
+
+namespace {
+// Send a batch when it holds this many items or this many bytes.
+const std::size_t MAX_BATCH_ITEMS = 4096;
+const std::size_t MAX_BATCH_BYTES = 1024 * 1024;
+
+// Record flags; keep in sync with types/StatusBatch.java.
+const int FLAG_LOCKED = 1 << 0;
+const int FLAG_COPIED = 1 << 1;
+const int FLAG_CONFLICTED = 1 << 2;
+const int FLAG_SWITCHED = 1 << 3;
+const int FLAG_FILE_EXTERNAL = 1 << 4;
+
+// These offsets match the ones used by EnumMapper.
+inline int statusKind(svn_wc_status_kind kind)
+{
+  return static_cast<int>(kind) - 1;
+}
+
+inline int depthKind(svn_depth_t depth)
+{
+  return static_cast<int>(depth) + 2;
+}
+
+// Empties the batch buffers when a batch has been sent, or when
+// sending it failed.
+struct BatchReset
+{
+  std::vector<char> &buffer;
+  std::vector<apr_int32_t> &offsets;
+
+  ~BatchReset()
+  {
+    buffer.clear();
+    offsets.clear();
+  }
+};
+} // anonymous namespace
+
+/**
+ * Create a StatusBatchCallback object
+ * @param jcallback the Java callback object.
+ */
+StatusBatchCallback::StatusBatchCallback(jobject jcallback)
+{
+  m_callback = jcallback;
+  m_buffer.reserve(MAX_BATCH_BYTES + MAX_BATCH_BYTES / 4);
+  m_offsets.reserve(MAX_BATCH_ITEMS);
+}
+
+/**
+ * Destroy a StatusBatchCallback object
+ */
+StatusBatchCallback::~StatusBatchCallback()
+{
+  // the m_callback does not need to be destroyed, because it is the passed
+  // in parameter to the Java SVNClient.statusBatch method.
+}
+
+svn_error_t *
+StatusBatchCallback::callback(void *baton,
+                              const char *local_abspath,
+                              const svn_client_status_t *status,
+                              apr_pool_t *pool)
+{
+  if (baton)
+    return static_cast<StatusBatchCallback *>(baton)->doStatus(
+            local_abspath, status, pool);
+
+  return SVN_NO_ERROR;
+}
+
+void
+StatusBatchCallback::putByte(int value)
+{
+  m_buffer.push_back(static_cast<char>(value));
+}
+
+void
+StatusBatchCallback::putLong(apr_int64_t value)
+{
+  const char *const bytes = reinterpret_cast<const char *>(&value);
+  m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(value));
+}
+
+void
+StatusBatchCallback::putString(const char *value)
+{
+  const apr_int32_t length =
+    (value ? static_cast<apr_int32_t>(std::strlen(value)) : -1);
+  const char *const bytes = reinterpret_cast<const char *>(&length);
+  m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(length));
+  if (value)
+    m_buffer.insert(m_buffer.end(), value, value + length);
+}
+
+/**
+ * Serialize a single status item into the current batch.
+ */
+svn_error_t *
+StatusBatchCallback::doStatus(const char *local_abspath,
+                              const svn_client_status_t *status,
+                              apr_pool_t *pool)
+{
+  if (status == NULL)
+    return SVN_NO_ERROR;
+
+  if (m_offsets.size() >= MAX_BATCH_ITEMS
+      || m_buffer.size() >= MAX_BATCH_BYTES)
+    SVN_ERR(flush());
+
+  // Use the same values for unversioned items as CreateJ::Status.
+  const bool versioned = status->versioned;
+  const int flags = ((status->wc_is_locked ? FLAG_LOCKED : 0)
+                     | (status->copied ? FLAG_COPIED : 0)
+                     | (status->conflicted ? FLAG_CONFLICTED : 0)
+                     | (status->switched ? FLAG_SWITCHED : 0)
+                     | (status->file_external ? FLAG_FILE_EXTERNAL : 0));
+
+  m_offsets.push_back(static_cast<apr_int32_t>(m_buffer.size()));
+  putByte(versioned ? static_cast<int>(status->kind) : -1);
+  putByte(statusKind(status->node_status));
+  putByte(statusKind(status->text_status));
+  putByte(statusKind(status->prop_status));
+  putByte(statusKind(status->repos_node_status));
+  putByte(statusKind(status->repos_text_status));
+  putByte(statusKind(status->repos_prop_status));
+  putByte(depthKind(status->depth));
+  putByte(static_cast<int>(status->ood_kind));
+  putByte(flags);
+  putLong(versioned ? status->revision
+          : org_apache_subversion_javahl_types_Revision_SVN_INVALID_REVNUM);
+  putLong(versioned ? status->changed_rev
+          : org_apache_subversion_javahl_types_Revision_SVN_INVALID_REVNUM);
+  putLong(versioned ? status->changed_date : 0);
+  putLong(status->ood_changed_rev);
+  putLong(status->ood_changed_date);
+
+  putString(status->local_abspath);
+  putString(status->repos_root_url
+            ? svn_path_url_add_component2(status->repos_root_url,
+                                          status->repos_relpath, pool)
+            : NULL);
+  putString(versioned ? status->changed_author : NULL);
+  putString(status->ood_changed_author);
+  putString(versioned ? status->changelist : NULL);
+  putString(status->moved_from_abspath);
+  putString(status->moved_to_abspath);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+StatusBatchCallback::flush()
+{
+  if (m_offsets.empty())
+    return SVN_NO_ERROR;
+
+  JNIEnv *env = JNIUtil::getEnv();
+  const BatchReset reset = { m_buffer, m_offsets };
+
+  // Append the offset table and the item count.
+  const apr_int32_t count = static_cast<apr_int32_t>(m_offsets.size());
+  const char *const table = reinterpret_cast<const char *>(&m_offsets[0]);
+  m_buffer.insert(m_buffer.end(), table,
+                  table + m_offsets.size() * sizeof(apr_int32_t));
+  const char *const countBytes = reinterpret_cast<const char *>(&count);
+  m_buffer.insert(m_buffer.end(), countBytes, countBytes + sizeof(count));
+
+  // Create a local frame for our references
+  env->PushLocalFrame(LOCAL_FRAME_SIZE);
+  if (JNIUtil::isJavaExceptionThrown())
+    return SVN_NO_ERROR;
+
+  static jmethodID mid = 0; // the method id will not change during
+  // the time this library is loaded, so
+  // it can be cached.
+  static jmethodID ctor = 0;
+  static JNIGlobalRefCache batchClazz_cache;
+  jclass batchClazz =
+    batchClazz_cache.getClass(env, JAVAHL_CLASS("/types/StatusBatch"));
+  if (JNIUtil::isJavaExceptionThrown())
+    POP_AND_RETURN(SVN_NO_ERROR);
+
+  if (mid == 0)
+    {
+      jclass clazz =
+        env->FindClass(JAVAHL_CLASS("/callback/StatusBatchCallback"));
+      if (JNIUtil::isJavaExceptionThrown())
+        POP_AND_RETURN(SVN_NO_ERROR);
+
+      mid = env->GetMethodID(clazz, "doStatusBatch",
+                             "(" JAVAHL_ARG("/types/StatusBatch;") ")V");
+      if (JNIUtil::isJavaExceptionThrown() || mid == 0)
+        POP_AND_RETURN(SVN_NO_ERROR);
+
+      ctor = env->GetMethodID(batchClazz, "<init>",
+                              "(Ljava/nio/ByteBuffer;)V");
+      if (JNIUtil::isJavaExceptionThrown() || ctor == 0)
+        POP_AND_RETURN(SVN_NO_ERROR);
+    }
+
+  jobject jbuffer = env->NewDirectByteBuffer(&m_buffer[0],
+                                             jlong(m_buffer.size()));
+  if (JNIUtil::isJavaExceptionThrown())
+    POP_AND_RETURN(SVN_NO_ERROR);
+
+  jobject jbatch = env->NewObject(batchClazz, ctor, jbuffer);
+  if (JNIUtil::isJavaExceptionThrown())
+    POP_AND_RETURN(SVN_NO_ERROR);
+
+  // The Java side must not keep the batch, so the buffer can be
+  // reused as soon as the callback returns.
+  env->CallVoidMethod(m_callback, mid, jbatch);
+
+  POP_AND_RETURN_EXCEPTION_AS_SVNERROR();
+}
@@ -0,0 +1,79 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file StatusBatchCallback.h
+ * @brief Interface of the class StatusBatchCallback
+ */
+
+#ifndef STATUSBATCHCALLBACK_H
+#define STATUSBATCHCALLBACK_H
+
+#include <jni.h>
+#include <vector>
+#include "svn_client.h"
+
+/**
+ * This class holds a Java callback object that receives status items
+ * in batches. The status items are serialized into a buffer that is
+ * handed to Java as a direct ByteBuffer; see the Java StatusBatch
+ * class for the layout.
+ */
+class StatusBatchCallback
+{
+ public:
+  StatusBatchCallback(jobject jcallback);
+  ~StatusBatchCallback();
+
+  static svn_error_t* callback(void *baton,
+                               const char *local_abspath,
+                               const svn_client_status_t *status,
+                               apr_pool_t *pool);
+
+  /**
+   * Send the collected status items to Java, if there are any.
+   */
+  svn_error_t *flush();
+
+ protected:
+  svn_error_t *doStatus(const char *local_abspath,
+                        const svn_client_status_t *status,
+                        apr_pool_t *pool);
+
+ private:
+  void putByte(int value);
+  void putLong(apr_int64_t value);
+  void putString(const char *value);
+
+  /**
+   * This a local reference to the Java object.
+   */
+  jobject m_callback;
+
+  /**
+   * The serialized records, followed by the offset table when the
+   * batch is sent. Reused for all batches.
+   */
+  std::vector<char> m_buffer;
+  std::vector<apr_int32_t> m_offsets;
+};
+
+#endif // STATUSBATCHCALLBACK_H
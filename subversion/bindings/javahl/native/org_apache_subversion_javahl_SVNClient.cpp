@@ -46,6 +46,7 @@
 #include "LogMessageCallback.h"
 #include "InfoCallback.h"
 #include "StatusCallback.h"
+#include "StatusBatchCallback.h"
 #include "ListCallback.h"
 #include "ImportFilterCallback.h"
 #include "ChangelistCallback.h"
@@ -217,6 +218,34 @@ Java_org_apache_subversion_javahl_SVNClient_status
              bool(jdepthAsSticky), changelists, &callback);
 }
 
+JNIEXPORT void JNICALL
+Java_org_apache_subversion_javahl_SVNClient_statusBatch
+(JNIEnv *env, jobject jthis, jstring jpath, jobject jdepth,
+ jboolean jonServer, jboolean jonDisk, jboolean jgetAll,
+ jboolean jnoIgnore, jboolean jignoreExternals,
+ jboolean jdepthAsSticky, jobject jchangelists,
+ jobject jstatusCallback)
+{
+  JNIEntry(SVNClient, statusBatch);
+  SVNClient *cl = SVNClient::getCppObject(jthis);
+  if (cl == NULL)
+    return;
+
+  JNIStringHolder path(jpath);
+  if (JNIUtil::isExceptionThrown())
+    return;
+
+  StringArray changelists(jchangelists);
+  if (JNIUtil::isExceptionThrown())
+    return;
+
+  StatusBatchCallback callback(jstatusCallback);
+  cl->statusBatch(path, EnumMapper::toDepth(jdepth),
+                  bool(jonServer), bool(jonDisk), bool(jgetAll),
+                  bool(jnoIgnore), bool(jignoreExternals),
+                  bool(jdepthAsSticky), changelists, &callback);
+}
+
 JNIEXPORT void JNICALL
 Java_org_apache_subversion_javahl_SVNClient_username
 (JNIEnv *env, jobject jthis, jstring jusername)
@@ -103,6 +103,38 @@ public interface ISVNClient
                 Collection<String> changelists, StatusCallback callback)
             throws ClientException;
 
+    /**
+     * Return the status of the working copy and maybe repository,
+     * delivering status items in batches.
+     * <p>
+     * Behaves like {@link #status(String, Depth, boolean, boolean,
+     * boolean, boolean, boolean, boolean, Collection, StatusCallback)},
+     * but serializes many status items into a single buffer that
+     * crosses the JNI boundary at once, instead of creating Java
+     * objects for each item. This makes the status of very large
+     * working copies much cheaper to obtain.
+     *
+     * @param path        Path to explore.
+     * @param depth       How deep to recurse into subdirectories.
+     * @param onServer    Request status information from server.
+     * @param onDisk      Check the working copy for local modifications.
+     * @param getAll      get status for uninteresting (unchanged) files.
+     * @param noIgnore    get status for normally ignored files and directories.
+     * @param ignoreExternals if externals are ignored during status
+     * @param depthAsSticky When set, interpret <code>depth</code> as
+     *                      the ambient depth of the working copy.
+     * @param changelists changelists to filter by
+     * @param callback    receives the batches of status items
+     * @since 1.15
+     */
+    void statusBatch(String path, Depth depth,
+                     boolean onServer, boolean onDisk,
+                     boolean getAll, boolean noIgnore,
+                     boolean ignoreExternals, boolean depthAsSticky,
+                     Collection<String> changelists,
+                     StatusBatchCallback callback)
+            throws ClientException;
+
     /**
      * Return information about the status of the working copy and
      * maybe repository.
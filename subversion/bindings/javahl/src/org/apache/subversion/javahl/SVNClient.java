@@ -130,6 +130,15 @@ public class SVNClient implements ISVNClient
                               StatusCallback callback)
             throws ClientException;
 
+    public native void statusBatch(String path, Depth depth,
+                                   boolean onServer, boolean onDisk,
+                                   boolean getAll, boolean noIgnore,
+                                   boolean ignoreExternals,
+                                   boolean depthAsSticky,
+                                   Collection<String> changelists,
+                                   StatusBatchCallback callback)
+            throws ClientException;
+
     @Deprecated
     public void status(String path, Depth depth, boolean onServer,
                        boolean getAll, boolean noIgnore,
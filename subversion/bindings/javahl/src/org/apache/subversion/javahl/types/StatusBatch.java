@@ -0,0 +1,262 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ */
+
+package org.apache.subversion.javahl.types;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * A batch of status items, as received by
+ * {@link org.apache.subversion.javahl.callback.StatusBatchCallback}.
+ * <p>
+ * The native code serializes the status items into a direct byte
+ * buffer, so that the whole batch crosses the JNI boundary at once.
+ * Items are decoded only when one of the accessors is called; each
+ * accessor reads only the fields it returns.
+ * <p>
+ * The buffer is reused for the next batch, so a <code>StatusBatch</code>
+ * must not be used after the callback that received it has returned.
+ * The values returned by the accessors, including the objects
+ * returned by {@link #getStatus}, remain valid.
+ * <p>
+ * Lock information is not included in the batch; use
+ * {@link org.apache.subversion.javahl.ISVNClient#status} to get it.
+ * @since 1.15
+ */
+public class StatusBatch
+{
+    // Byte offsets of the fixed-size fields in each record.
+    // Keep these in sync with native/StatusBatchCallback.cpp.
+    private static final int NODE_KIND = 0;
+    private static final int NODE_STATUS = 1;
+    private static final int TEXT_STATUS = 2;
+    private static final int PROP_STATUS = 3;
+    private static final int REPOS_NODE_STATUS = 4;
+    private static final int REPOS_TEXT_STATUS = 5;
+    private static final int REPOS_PROP_STATUS = 6;
+    private static final int DEPTH = 7;
+    private static final int REPOS_KIND = 8;
+    private static final int FLAGS = 9;
+    private static final int REVISION = 10;
+    private static final int LAST_CHANGED_REVISION = 18;
+    private static final int LAST_CHANGED_DATE = 26;
+    private static final int REPOS_LAST_CMT_REVISION = 34;
+    private static final int REPOS_LAST_CMT_DATE = 42;
+    private static final int STRINGS = 50;
+
+    // Bits in the FLAGS field.
+    private static final int FLAG_LOCKED = 1 << 0;
+    private static final int FLAG_COPIED = 1 << 1;
+    private static final int FLAG_CONFLICTED = 1 << 2;
+    private static final int FLAG_SWITCHED = 1 << 3;
+    private static final int FLAG_FILE_EXTERNAL = 1 << 4;
+
+    // Order of the variable-length strings that follow the fixed fields.
+    private static final int PATH = 0;
+    private static final int URL = 1;
+    private static final int LAST_COMMIT_AUTHOR = 2;
+    private static final int REPOS_LAST_CMT_AUTHOR = 3;
+    private static final int CHANGELIST = 4;
+    private static final int MOVED_FROM_ABSPATH = 5;
+    private static final int MOVED_TO_ABSPATH = 6;
+
+    private static final Status.Kind[] KINDS = Status.Kind.values();
+    private static final NodeKind[] NODE_KINDS = NodeKind.values();
+    private static final Depth[] DEPTHS = Depth.values();
+
+    private final ByteBuffer buffer;
+    private final int count;
+    private final int offsets;
+
+    /**
+     * This constructor is only called from the native code.
+     * <p>
+     * The batch consists of the records, followed by a table with
+     * the offset of each record and by the number of records; all
+     * integers are in native byte order.
+     */
+    protected StatusBatch(ByteBuffer buffer)
+    {
+        this.buffer = buffer.order(ByteOrder.nativeOrder());
+        this.count = this.buffer.getInt(this.buffer.limit() - 4);
+        this.offsets = this.buffer.limit() - 4 * (count + 1);
+    }
+
+    /**
+     * @return the number of status items in this batch.
+     */
+    public int size()
+    {
+        return count;
+    }
+
+    /**
+     * @return the path of the item at <code>index</code>.
+     */
+    public String getPath(int index)
+    {
+        return getString(index, PATH);
+    }
+
+    /**
+     * @return the node kind of the item at <code>index</code>, or
+     *         <code>null</code> if the item is not versioned.
+     */
+    public NodeKind getNodeKind(int index)
+    {
+        return getNodeKind(index, NODE_KIND);
+    }
+
+    /**
+     * @return the overall status of the item at <code>index</code>.
+     */
+    public Status.Kind getNodeStatus(int index)
+    {
+        return getKind(index, NODE_STATUS);
+    }
+
+    /**
+     * @return the text status of the item at <code>index</code>.
+     */
+    public Status.Kind getTextStatus(int index)
+    {
+        return getKind(index, TEXT_STATUS);
+    }
+
+    /**
+     * @return the property status of the item at <code>index</code>.
+     */
+    public Status.Kind getPropStatus(int index)
+    {
+        return getKind(index, PROP_STATUS);
+    }
+
+    /**
+     * @return the base revision of the item at <code>index</code>.
+     */
+    public long getRevision(int index)
+    {
+        return buffer.getLong(record(index) + REVISION);
+    }
+
+    /**
+     * @return <code>true</code> if the item at <code>index</code>
+     *         is in a conflicted state.
+     */
+    public boolean isConflicted(int index)
+    {
+        return (buffer.get(record(index) + FLAGS) & FLAG_CONFLICTED) != 0;
+    }
+
+    /**
+     * Decode all fields of the item at <code>index</code>.
+     * @return a new status object.
+     */
+    public Status getStatus(int index)
+    {
+        final int rec = record(index);
+        final int flags = buffer.get(rec + FLAGS);
+        final String[] strings = new String[MOVED_TO_ABSPATH + 1];
+        int pos = rec + STRINGS;
+        for (int i = 0; i < strings.length; ++i)
+        {
+            final int length = buffer.getInt(pos);
+            pos += 4;
+            if (length >= 0)
+            {
+                strings[i] = decode(pos, length);
+                pos += length;
+            }
+        }
+
+        return new Status(strings[PATH], strings[URL],
+                          getNodeKind(index, NODE_KIND),
+                          buffer.getLong(rec + REVISION),
+                          buffer.getLong(rec + LAST_CHANGED_REVISION),
+                          buffer.getLong(rec + LAST_CHANGED_DATE),
+                          strings[LAST_COMMIT_AUTHOR],
+                          getKind(index, NODE_STATUS),
+                          getKind(index, TEXT_STATUS),
+                          getKind(index, PROP_STATUS),
+                          getKind(index, REPOS_NODE_STATUS),
+                          getKind(index, REPOS_TEXT_STATUS),
+                          getKind(index, REPOS_PROP_STATUS),
+                          (flags & FLAG_LOCKED) != 0,
+                          (flags & FLAG_COPIED) != 0,
+                          DEPTHS[buffer.get(rec + DEPTH)],
+                          (flags & FLAG_CONFLICTED) != 0,
+                          (flags & FLAG_SWITCHED) != 0,
+                          (flags & FLAG_FILE_EXTERNAL) != 0,
+                          null, null,
+                          buffer.getLong(rec + REPOS_LAST_CMT_REVISION),
+                          buffer.getLong(rec + REPOS_LAST_CMT_DATE),
+                          getNodeKind(index, REPOS_KIND),
+                          strings[REPOS_LAST_CMT_AUTHOR],
+                          strings[CHANGELIST],
+                          strings[MOVED_FROM_ABSPATH],
+                          strings[MOVED_TO_ABSPATH]);
+    }
+
+    private int record(int index)
+    {
+        if (index < 0 || index >= count)
+            throw new IndexOutOfBoundsException("StatusBatch index: "
+                                                + index);
+        return buffer.getInt(offsets + 4 * index);
+    }
+
+    private Status.Kind getKind(int index, int field)
+    {
+        return KINDS[buffer.get(record(index) + field)];
+    }
+
+    private NodeKind getNodeKind(int index, int field)
+    {
+        final int kind = buffer.get(record(index) + field);
+        return (kind < 0 ? null : NODE_KINDS[kind]);
+    }
+
+    private String getString(int index, int which)
+    {
+        int pos = record(index) + STRINGS;
+        for (int i = 0; i < which; ++i)
+        {
+            final int length = buffer.getInt(pos);
+            pos += 4 + Math.max(length, 0);
+        }
+
+        final int length = buffer.getInt(pos);
+        return (length < 0 ? null : decode(pos + 4, length));
+    }
+
+    private String decode(int pos, int length)
+    {
+        final byte[] bytes = new byte[length];
+        final ByteBuffer view = buffer.duplicate();
+        view.position(pos);
+        view.get(bytes);
+        return new String(bytes, StandardCharsets.UTF_8);
+    }
+}
@@ -348,6 +348,70 @@ public class BasicTests extends SVNTests
             fail("File foo.c should return exactly one empty status.");
     }
 
+    /**
+     * Test that {@link
+     * org.apache.subversion.javahl.SVNClient#statusBatch()} reports
+     * the same status as {@link
+     * org.apache.subversion.javahl.SVNClient#status()}.
+     *
+     * @throws Throwable
+     */
+    public void testStatusBatch() throws Throwable
+    {
+        // build the test setup
+        OneTest thisTest = new OneTest();
+
+        // make a local modification, so that not all items are normal
+        File iota = new File(thisTest.getWorkingCopy(), "iota");
+        PrintWriter writer = new PrintWriter(new FileOutputStream(iota, true));
+        writer.print("more iota");
+        writer.close();
+
+        MyStatusCallback statusCallback = new MyStatusCallback();
+        client.status(thisTest.getWCPath(), Depth.infinity,
+                      false, true, true, false, false, false,
+                      null, statusCallback);
+        final Status[] expected = statusCallback.getStatusArray();
+
+        final List<Status> batched = new ArrayList<Status>();
+        client.statusBatch(thisTest.getWCPath(), Depth.infinity,
+                           false, true, true, false, false, false,
+                           null, new StatusBatchCallback() {
+                               public void doStatusBatch(StatusBatch batch)
+                               {
+                                   for (int i = 0; i < batch.size(); ++i)
+                                   {
+                                       Status st = batch.getStatus(i);
+                                       assertEquals(st.getPath(),
+                                                    batch.getPath(i));
+                                       assertEquals(st.getNodeStatus(),
+                                                    batch.getNodeStatus(i));
+                                       batched.add(st);
+                                   }
+                               }
+                           });
+
+        assertEquals(expected.length, batched.size());
+        for (int i = 0; i < expected.length; ++i)
+        {
+            Status st = batched.get(i);
+            assertEquals(expected[i].getPath(), st.getPath());
+            assertEquals(expected[i].getUrl(), st.getUrl());
+            assertEquals(expected[i].getNodeKind(), st.getNodeKind());
+            assertEquals(expected[i].getRevisionNumber(),
+                         st.getRevisionNumber());
+            assertEquals(expected[i].getLastChangedRevisionNumber(),
+                         st.getLastChangedRevisionNumber());
+            assertEquals(expected[i].getLastCommitAuthor(),
+                         st.getLastCommitAuthor());
+            assertEquals(expected[i].getNodeStatus(), st.getNodeStatus());
+            assertEquals(expected[i].getTextStatus(), st.getTextStatus());
+            assertEquals(expected[i].getPropStatus(), st.getPropStatus());
+            assertEquals(expected[i].getDepth(), st.getDepth());
+            assertEquals(expected[i].isConflicted(), st.isConflicted());
+        }
+    }
+
     /**
      * Test the "out of date" info from {@link
      * org.apache.subversion.javahl.SVNClient#status()}.
@@ -2307,6 +2371,53 @@ public class BasicTests extends SVNTests
         assertTrue("content changed", Arrays.equals(content, testContent));
     }
 
+    /**
+     * An output stream that is also a channel, so the native side
+     * hands it the file contents in a direct ByteBuffer.
+     */
+    private static class ChannelOutputStream extends ByteArrayOutputStream
+        implements WritableByteChannel
+    {
+        public int channelWrites = 0;
+
+        public boolean isOpen()
+        {
+            return true;
+        }
+
+        public int write(ByteBuffer src)
+        {
+            ++channelWrites;
+            int length = src.remaining();
+            byte[] data = new byte[length];
+            src.get(data);
+            write(data, 0, length);
+            return length;
+        }
+    }
+
+    /**
+     * Test SVNClient.streamFileContent into a WritableByteChannel.
+     * @throws Throwable
+     */
+    public void testBasicCatChannel() throws Throwable
+    {
+        // create the working copy
+        OneTest thisTest = new OneTest();
+
+        ChannelOutputStream out = new ChannelOutputStream();
+        client.streamFileContent(thisTest.getWCPath() + "/A/mu", null, null,
+                                 out);
+
+        byte[] content = out.toByteArray();
+        byte[] testContent = thisTest.getWc().getItemContent("A/mu").getBytes();
+
+        // the content should be the same, and it should have been
+        // delivered through the channel interface
+        assertTrue("content changed", Arrays.equals(content, testContent));
+        assertTrue("channel not used", out.channelWrites > 0);
+    }
+
     /**
      * Test the basic SVNClient.list functionality.
      * @throws Throwable
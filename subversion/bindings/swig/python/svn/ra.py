@@ -76,3 +76,106 @@ class Callbacks:
   progress_func = None
   cancel_func = None
   get_client_string = None
+
+import threading as _threading
+try:
+  import queue as _queue
+except ImportError:
+  import Queue as _queue
+import svn.core as _svncore
+
+class LogEntry(object):
+  """A log entry that no longer depends on the pool of the receiver.
+
+  Instances are created by iter_log from the svn_log_entry_t handed to
+  the log receiver.  Only the members that were asked for are
+  converted: changed_paths is None unless discover_changed_paths was
+  set, and revprops holds just the requested revision properties."""
+  __slots__ = ('revision', 'revprops', 'changed_paths', 'has_children',
+               'non_inheritable', 'subtractive_merge')
+
+  def __init__(self, log_entry, discover_changed_paths):
+    self.revision = log_entry.revision
+    self.revprops = log_entry.revprops
+    if discover_changed_paths:
+      self.changed_paths = log_entry.changed_paths2
+    else:
+      self.changed_paths = None
+    self.has_children = bool(log_entry.has_children)
+    self.non_inheritable = bool(log_entry.non_inheritable)
+    self.subtractive_merge = bool(log_entry.subtractive_merge)
+
+def iter_log(session, paths, start, end, limit=0,
+             discover_changed_paths=False, strict_node_history=True,
+             include_merged_revisions=False, revprops=None,
+             batch_size=100, max_pending=4):
+  """Generate the log of PATHS in SESSION as lists of LogEntry objects.
+
+  The arguments up to REVPROPS are the same as for get_log2.  Entries
+  are handed out in lists of up to BATCH_SIZE, so the consumer runs
+  once per batch rather than once per revision.  The log is read by
+  a worker thread, which holds the GIL only while it converts an entry;
+  at most MAX_PENDING batches are buffered ahead of the consumer.
+
+  SESSION must not be used for anything else until the generator is
+  exhausted or closed.  Closing the generator early cancels the log
+  request."""
+  batches = _queue.Queue(max_pending)
+  abandoned = _threading.Event()
+  finished = object()
+  batch = []
+
+  def put(item):
+    while not abandoned.is_set():
+      try:
+        batches.put(item, True, 0.1)
+        return True
+      except _queue.Full:
+        pass
+    return False
+
+  def receiver(log_entry, pool):
+    batch.append(LogEntry(log_entry, discover_changed_paths))
+    if len(batch) >= batch_size:
+      if not put(batch[:]):
+        raise _svncore.SubversionException("Log iteration was abandoned",
+                                           _svncore.SVN_ERR_CANCELLED)
+      del batch[:]
+
+  def produce():
+    try:
+      get_log2(session, paths, start, end, limit, discover_changed_paths,
+               strict_node_history, include_merged_revisions, revprops,
+               receiver)
+      if batch:
+        put(batch[:])
+      put(finished)
+    except BaseException as e:
+      put(e)
+
+  worker = _threading.Thread(target=produce)
+  worker.daemon = True
+  worker.start()
+  try:
+    while True:
+      item = batches.get()
+      if item is finished:
+        break
+      if isinstance(item, BaseException):
+        raise item
+      yield item
+  finally:
+    abandoned.set()
+    worker.join()
+
+def iter_dir(session, path, revision,
+             dirent_fields=_svncore.SVN_DIRENT_KIND, batch_size=100):
+  """Generate the entries of PATH at REVISION in SESSION as lists of up
+  to BATCH_SIZE (name, svn_dirent_t) pairs, sorted by name.
+
+  DIRENT_FIELDS selects the svn_dirent_t members to fetch, as for
+  get_dir2; asking for fewer fields makes the listing cheaper."""
+  (dirents, _, _) = get_dir2(session, path, revision, dirent_fields)
+  names = sorted(dirents.keys())
+  for i in range(0, len(names), batch_size):
+    yield [(name, dirents[name]) for name in names[i:i + batch_size]]
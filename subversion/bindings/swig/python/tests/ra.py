@@ -395,6 +395,45 @@ class SubversionRepositoryAccessTestCase(unittest.TestCase):
                     log_revprops, receiver)
         self.assertTrue(called[0])
 
+  def test_iter_log(self):
+    youngest = ra.get_latest_revnum(self.ra_ctx)
+    expected = []
+    def receiver(log_entry, pool):
+      expected.append(log_entry.revision)
+    ra.get_log2(self.ra_ctx, [b""], youngest, 0, 0, False, True, False,
+                [b"svn:log"], receiver)
+
+    revisions = []
+    for batch in ra.iter_log(self.ra_ctx, [b""], youngest, 0,
+                             revprops=[b"svn:log"], batch_size=3):
+      self.assertTrue(0 < len(batch) <= 3)
+      for entry in batch:
+        self.assertEqual(entry.changed_paths, None)
+        self.assertFalse(entry.has_children)
+        revisions.append(entry.revision)
+    self.assertEqual(revisions, expected)
+
+    # Closing the generator early cancels the log request.
+    batches = ra.iter_log(self.ra_ctx, [b""], youngest, 0,
+                          discover_changed_paths=True, batch_size=1)
+    first = next(batches)
+    self.assertEqual(first[0].revision, youngest)
+    self.assertTrue(len(first[0].changed_paths) > 0)
+    batches.close()
+
+    # The session is usable again afterwards.
+    self.assertEqual(ra.get_latest_revnum(self.ra_ctx), youngest)
+
+  def test_iter_dir(self):
+    (dirents, _, _) = ra.get_dir2(self.ra_ctx, b'', 1, core.SVN_DIRENT_KIND)
+    names = []
+    for batch in ra.iter_dir(self.ra_ctx, b'', 1, batch_size=2):
+      self.assertTrue(0 < len(batch) <= 2)
+      for (name, dirent) in batch:
+        self.assertEqual(dirent.kind, dirents[name].kind)
+        names.append(name)
+    self.assertEqual(names, sorted(dirents.keys()))
+
   def test_update(self):
     class TestEditor(delta.Editor):
         pass
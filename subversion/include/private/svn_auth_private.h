@@ -231,6 +231,13 @@ svn_auth__ssl_client_cert_pw_set(svn_boolean_t *done,
                                  svn_boolean_t non_interactive,
                                  apr_pool_t *pool);
 
+/* Serialize the credential lookups through AUTH_BATON, and through the
+   per-session copies made of it from now on, so that sessions using them
+   may run on different threads.  The providers, including any prompting
+   ones, are then never called concurrently. */
+svn_error_t *
+svn_auth__make_thread_safe(svn_auth_baton_t *auth_baton);
+
 /* Apply the specified configuration for connecting with SERVER_NAME
    to the auth baton */
 svn_error_t *
@@ -125,6 +125,13 @@ typedef struct svn_cache__t svn_cache__t;
  * Use svn_cache__get_info() to get this data. Note that not all types
  * of caches will be able to report complete and correct information.
  */
+/**
+ * Number of alternative cache sizes in #svn_cache__info_t.estimate_sizes.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_CACHE__SIZE_ESTIMATES 7
+
 typedef struct svn_cache__info_t
 {
   /** A string identifying the cache instance. Usually a copy of the @a id
@@ -148,6 +155,11 @@ typedef struct svn_cache__info_t
    */
   apr_uint64_t failures;
 
+  /** Number of setter calls whose data has been rejected by the cache's
+   * admission filter.
+   */
+  apr_uint64_t admission_rejects;
+
   /** Size of the data currently stored in the cache.
    * May be 0 if that information is not available.
    */
@@ -179,6 +191,21 @@ typedef struct svn_cache__info_t
    * highest array index.
    */
   apr_uint64_t histogram[32];
+
+  /** Data sizes in bytes from 1/8 to 8 times the current @a data_size,
+   * for which @a estimated_hit_ratios are given.  All 0 if the cache
+   * does not provide estimates.
+   *
+   * @since New in 1.15.
+   */
+  apr_uint64_t estimate_sizes[SVN_CACHE__SIZE_ESTIMATES];
+
+  /** Hit ratios between 0 and 1 that an LRU cache of the respective
+   * @a estimate_sizes would have had for the recent requests.
+   *
+   * @since New in 1.15.
+   */
+  double estimated_hit_ratios[SVN_CACHE__SIZE_ESTIMATES];
 } svn_cache__info_t;
 
 /**
@@ -310,6 +337,66 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
                                   svn_boolean_t allow_blocking_writes,
                                   apr_pool_t *result_pool);
 
+/**
+ * Like svn_cache__membuffer_cache_create() but allocate the whole @a *cache
+ * in anonymous shared memory and serialize write access with locks that
+ * work across processes.  All processes forked from the current one after
+ * this call will see and update the same cache contents.  Other processes
+ * cannot attach to it.  Writes will always block.
+ *
+ * If @a admission_filter is set, enable the admission filter as well.
+ * It must not be enabled later with
+ * svn_cache__membuffer_enable_admission_filter().
+ *
+ * The shared memory and the lock objects will be allocated in
+ * @a result_pool.  Return #SVN_ERR_UNSUPPORTED_FEATURE if the platform
+ * does not provide the necessary shared memory and locks.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         svn_boolean_t admission_filter,
+                                         apr_pool_t *result_pool);
+
+/**
+ * Enable the frequency-based admission filter for the membuffer @a cache.
+ *
+ * The cache will then track how often keys get requested.  Once it is
+ * full, new items will only be added if their keys have been requested
+ * more often than that of the item to be evicted.  Data that gets read
+ * only once, e.g. during a full repository scan, will not flush the
+ * frequently used items from the cache anymore.
+ *
+ * This must be called before the @a cache is being used.  The filter
+ * data will be allocated in @a result_pool, which must be the pool
+ * the @a cache has been allocated in.
+ */
+svn_error_t *
+svn_cache__membuffer_enable_admission_filter(svn_membuffer_t *cache,
+                                             apr_pool_t *result_pool);
+
+/**
+ * Make the membuffer @a cache estimate which hit ratios it would achieve
+ * at other sizes.  It will then keep shadow tags for a small sample of
+ * all keys requested and report the estimates in the
+ * #svn_cache__info_t.estimated_hit_ratios of its caches and of
+ * svn_cache__membuffer_get_global_info().
+ *
+ * This must be called before the @a cache is being used.  The estimator
+ * data will be allocated in @a result_pool, which must be the pool the
+ * @a cache has been allocated in.  Return #SVN_ERR_UNSUPPORTED_FEATURE
+ * for caches shared between processes.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_cache__membuffer_enable_size_estimates(svn_membuffer_t *cache,
+                                           apr_pool_t *result_pool);
+
 /**
  * @defgroup Standard priority classes for #svn_cache__create_membuffer_cache.
  * @{
@@ -391,6 +478,24 @@ svn_cache__create_null(svn_cache__t **cache_p,
                        const char *id,
                        apr_pool_t *result_pool);
 
+/**
+ * Creates a cache instance in @a *cache_p, allocated from @a result_pool,
+ * that combines the caches @a front and @a back.  Both must use the same
+ * key and value types.
+ *
+ * Lookups try @a front first and copy entries found only in @a back into
+ * @a front.  Updates go to both caches.  This is meant for putting a
+ * local cache in front of one shared between processes or hosts, e.g. a
+ * membuffer cache in front of a memcache.
+ *
+ * These caches do not support svn_cache__iter.
+ */
+svn_error_t *
+svn_cache__create_layered(svn_cache__t **cache_p,
+                          svn_cache__t *front,
+                          svn_cache__t *back,
+                          apr_pool_t *result_pool);
+
 /**
  * Sets @a handler to be @a cache's error handling routine.  If any
  * error is returned from a call to svn_cache__get or svn_cache__set, @a
@@ -561,6 +666,18 @@ svn_cache__get_global_membuffer_cache(void);
 svn_cache__info_t *
 svn_cache__membuffer_get_global_info(apr_pool_t *pool);
 
+/**
+ * Like svn_cache__membuffer_get_global_info() but return the stats of
+ * each segment of the global membuffer cache separately, as an array of
+ * svn_cache__info_t * whose IDs are the segment numbers.  Return an
+ * empty array if there is no global membuffer cache.  The result will
+ * be allocated in POOL.
+ *
+ * @since New in 1.15.
+ */
+apr_array_header_t *
+svn_cache__membuffer_get_global_segment_infos(apr_pool_t *pool);
+
 /**
  * Remove all current contents from CACHE.
  *
@@ -108,6 +108,154 @@ svn_txdelta__read_raw_window_len(apr_size_t *window_len,
                                  svn_stream_t *stream,
                                  apr_pool_t *pool);
 
+/** Incrementally composes a chain of delta windows into a single window.
+ *
+ * Windows get added newest first, i.e. each added window must produce
+ * the source view of the composite of the previously added windows.
+ * All compositions share one range index, so folding long chains does
+ * not rebuild that structure from scratch for every link.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_txdelta__composer_t svn_txdelta__composer_t;
+
+/** Return a new, empty window composer allocated in @a result_pool.
+ *
+ * @since New in 1.15.
+ */
+svn_txdelta__composer_t *
+svn_txdelta__composer_create(apr_pool_t *result_pool);
+
+/** Fold @a window into @a composer.  The composer does not keep any
+ * reference to @a window.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_txdelta__composer_add(svn_txdelta__composer_t *composer,
+                          const svn_txdelta_window_t *window);
+
+/** Return TRUE if the composite in @a composer does not depend on any
+ * source data anymore, i.e. adding further windows would not change it.
+ *
+ * @since New in 1.15.
+ */
+svn_boolean_t
+svn_txdelta__composer_done(const svn_txdelta__composer_t *composer);
+
+/** Return the composite of all windows added to @a composer or NULL if
+ * no window has been added.  The result remains valid until the next
+ * call to svn_txdelta__composer_add() or svn_txdelta__composer_reset().
+ *
+ * @since New in 1.15.
+ */
+svn_txdelta_window_t *
+svn_txdelta__composer_get(const svn_txdelta__composer_t *composer);
+
+/** Remove all windows from @a composer such that it may be used for
+ * another chain.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_txdelta__composer_reset(svn_txdelta__composer_t *composer);
+
+/** Return the composite of the delta chain @a windows, an array of
+ * #svn_txdelta_window_t *, ordered newest first as described for
+ * #svn_txdelta__composer_t.  Windows after the first one that does not
+ * depend on its source will be ignored.  Return NULL for an empty chain.
+ *
+ * Allocate the result in @a result_pool and use @a scratch_pool for
+ * temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_txdelta_window_t *
+svn_txdelta__compose_window_list(const apr_array_header_t *windows,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
+/** A reversible transformation of file contents that makes deltas
+ * between versions of some file formats smaller, e.g. by inflating the
+ * compressed members of zip archives.
+ *
+ * The transformed form may depend on the version of the libraries used
+ * to produce it and must not be stored persistently.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_txdelta__transform_t
+{
+  /** Short name of the transformation, for diagnostics. */
+  const char *name;
+
+  /** Set @a *encoded to the transformed form of @a data, allocated in
+   * @a result_pool.  This must accept any @a data, no matter whether it
+   * is of the expected format or not. */
+  svn_error_t *(*encode)(svn_stringbuf_t **encoded,
+                         const svn_string_t *data,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool);
+
+  /** Set @a *decoded to the data that has been transformed into
+   * @a encoded, allocated in @a result_pool.  Return
+   * #SVN_ERR_SVNDIFF_INVALID_COMPRESSED_DATA if that data can't be
+   * reproduced exactly. */
+  svn_error_t *(*decode)(svn_stringbuf_t **decoded,
+                         const svn_string_t *encoded,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool);
+} svn_txdelta__transform_t;
+
+/** Return the transformation for file contents of type @a mime_type, the
+ * value of an @c svn:mime-type property, or NULL if there is none.
+ * Currently, this knows about zip based formats like office documents
+ * and Java archives.  @a mime_type may be NULL.
+ *
+ * @since New in 1.15.
+ */
+const svn_txdelta__transform_t *
+svn_txdelta__transform_for_mime_type(const char *mime_type,
+                                     apr_pool_t *scratch_pool);
+
+/** Like svn_txdelta_run() but run @a source and @a target through
+ * @a transform first.  The delta windows describe the transformed target
+ * and must be applied using svn_txdelta__apply_transformed() with the
+ * same @a transform.  @a *checksum is calculated over the untransformed
+ * @a target.
+ *
+ * Both streams will be read completely into memory.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_txdelta__run_transformed(svn_stream_t *source,
+                             svn_stream_t *target,
+                             const svn_txdelta__transform_t *transform,
+                             svn_txdelta_window_handler_t handler,
+                             void *handler_baton,
+                             svn_checksum_kind_t checksum_kind,
+                             svn_checksum_t **checksum,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
+/** Like svn_txdelta_apply() without checksum and error info, but for the
+ * delta windows produced by svn_txdelta__run_transformed() with the same
+ * @a transform.  Nothing gets written to @a target before the last
+ * window has been received.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_txdelta__apply_transformed(svn_stream_t *source,
+                               svn_stream_t *target,
+                               const svn_txdelta__transform_t *transform,
+                               apr_pool_t *pool,
+                               svn_txdelta_window_handler_t *handler,
+                               void **handler_baton);
+
 /* Return a debug editor that wraps @a wrapped_editor.
  *
  * The debug editor simply prints an indication of what callbacks are being
@@ -148,6 +148,37 @@ svn_diff_hunk__create_deletes_single_line(svn_diff_hunk_t **hunk,
 svn_linenum_t
 svn_diff_hunk__get_fuzz_penalty(const svn_diff_hunk_t *hunk);
 
+/** A series of file diffs where each "modified" file is usually the
+ * "original" file of the next diff, as in blame.  Keeps the tokens of
+ * the last "modified" file, so they don't need to be read again.
+ */
+typedef struct svn_diff__file_chain_t svn_diff__file_chain_t;
+
+/** Create a new file diff chain in @a result_pool that diffs with
+ * @a options.  @a options must remain valid for the lifetime of the
+ * chain.
+ */
+svn_diff__file_chain_t *
+svn_diff__file_chain_create(const svn_diff_file_options_t *options,
+                            apr_pool_t *result_pool);
+
+/** Like svn_diff_file_diff_2() with the options of @a chain.  If
+ * @a original is the path that was passed as the @a modified file of the
+ * previous call on @a chain, reuse the tokens of its lines that were
+ * kept by that call.  Only the file paths are compared, so the contents
+ * of a file must not change between the calls.
+ *
+ * The memory kept by @a chain grows with the number of lines of
+ * @a modified that differ from @a original.  It is released by the next
+ * call and when the pool of @a chain gets cleared.
+ */
+svn_error_t *
+svn_diff__file_chain_diff(svn_diff_t **diff,
+                          svn_diff__file_chain_t *chain,
+                          const char *original,
+                          const char *modified,
+                          apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
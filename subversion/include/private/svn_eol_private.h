@@ -51,6 +51,14 @@ extern "C" {
 #  define SVN__N_MASK          0x0d0d0d0d
 #endif
 
+/* SSE2 is part of the x86-64 baseline, so the chunky string processing
+ * functions may use 16 byte vectors there without any runtime checks.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SVN__HAVE_SSE2 1
+#endif
+
 /* Generic EOL character helper routines */
 
 /* Look for the start of an end-of-line sequence (i.e. CR or LF)
@@ -168,6 +168,32 @@ typedef struct svn_fs_fs__node_stats_t
   apr_uint64_t size;
 } svn_fs_fs__node_stats_t;
 
+/* Read costs of the latest text representation of a file path.
+ */
+typedef struct svn_fs_fs__path_cost_t
+{
+  /* created path of the file */
+  const char *path;
+
+  /* revision that contains the latest text representation */
+  svn_revnum_t revision;
+
+  /* number of node revisions with this path, i.e. how often it changed */
+  apr_uint64_t change_count;
+
+  /* length of the delta chain of the latest text representation */
+  apr_uint64_t chain_length;
+
+  /* number of shards that this delta chain touches */
+  apr_uint64_t shard_count;
+
+  /* size of the fulltext */
+  apr_uint64_t expanded_size;
+
+  /* number of bytes to read from the delta chain to reconstruct it */
+  apr_uint64_t reconstruct_size;
+} svn_fs_fs__path_cost_t;
+
 /* Comprises all the information needed to create the output of the
  * 'svnfsfs stats' command.
  */
@@ -251,8 +277,40 @@ typedef struct svn_fs_fs__stats_t
   /* histogram of sizes of directories property representations */
   svn_fs_fs__histogram_t dir_prop_rep_histogram;
 
+  /* histogram of representation delta chain lengths */
+  svn_fs_fs__histogram_t chain_length_histogram;
+
   /* extension -> svn_fs_fs__extension_info_t* map */
   apr_hash_t *by_extension;
+
+  /* number of delta representations */
+  apr_uint64_t delta_count;
+
+  /* number of delta representations whose base is in a different shard */
+  apr_uint64_t cross_shard_delta_count;
+
+  /* total fulltext size of the latest text of every file path */
+  apr_uint64_t head_expanded_size;
+
+  /* total bytes to read from the delta chains to reconstruct those */
+  apr_uint64_t head_reconstruct_size;
+
+  /* histogram of delta chain lengths of the latest text of every file */
+  svn_fs_fs__histogram_t head_chain_length_histogram;
+
+  /* histogram of bytes read to reconstruct the latest text of every file */
+  svn_fs_fs__histogram_t head_reconstruct_histogram;
+
+  /* histogram of the number of shards those delta chains touch */
+  svn_fs_fs__histogram_t head_shard_histogram;
+
+  /* svn_fs_fs__path_cost_t * of the file paths that are most expensive to
+   * read at their latest version, in descending RECONSTRUCT_SIZE order */
+  apr_array_header_t *costly_paths;
+
+  /* svn_fs_fs__path_cost_t * of the most frequently changed file paths,
+   * in descending CHANGE_COUNT order */
+  apr_array_header_t *hot_paths;
 } svn_fs_fs__stats_t;
 
 /* A node-revision ID in FSFS consists of 3 sub-IDs ("parts") that consist
@@ -359,6 +417,8 @@ typedef struct svn_fs_fs__ioctl_build_rep_cache_input_t
   svn_revnum_t end_rev;
   svn_fs_progress_notify_func_t progress_func;
   void *progress_baton;
+  /* Maximum number of revisions to scan concurrently.  0 means 1. */
+  int jobs;
 } svn_fs_fs__ioctl_build_rep_cache_input_t;
 
 /* See svn_fs_fs__build_rep_cache(). */
@@ -215,6 +215,16 @@ svn_fs_path_change3_t *
 svn_fs__path_change_create_internal2(svn_fs_path_change_kind_t change_kind,
                                      apr_pool_t *result_pool);
 
+/* Return TRUE, if a change to CHANGED_PATH shall be reported when only
+   changes relevant to FILTER_PATH have been requested.  That is the case
+   if CHANGED_PATH is FILTER_PATH or below it or, if INCLUDE_PARENTS is
+   set, one of its parent directories.  Both paths must be canonical
+   absolute paths. */
+svn_boolean_t
+svn_fs__path_change_matches(const char *filter_path,
+                            svn_boolean_t include_parents,
+                            const char *changed_path);
+
 /* Append REL_PATH (which may contain slashes) to each path that exists in
    the mergeinfo INPUT, and return a new mergeinfo in *OUTPUT.  Deep
    copies the values.  Perform all allocations in POOL. */
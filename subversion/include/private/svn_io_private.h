@@ -84,6 +84,42 @@ svn_error_t *
 svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
+/**
+ * Tell the OS that the @a length bytes starting at @a offset in @a file
+ * will be read soon.  The OS may then fetch that data in the background,
+ * allowing multiple ranges to be read concurrently.
+ *
+ * This is a mere hint and a no-op on platforms that don't support it.
+ * Errors are silently ignored.
+ */
+void
+svn_io__file_prefetch(apr_file_t *file,
+                      apr_off_t offset,
+                      apr_off_t length);
+
+/**
+ * Create @a to_path as a hard link to the file @a from_path.  Both must
+ * be on the same file system, and @a to_path must not exist yet.
+ * Use @a pool for temporary allocations.
+ */
+svn_error_t *
+svn_io__file_link(const char *from_path,
+                  const char *to_path,
+                  apr_pool_t *pool);
+
+/**
+ * Create @a to_path as a copy-on-write clone of the file @a from_path,
+ * which shares the data of @a from_path on disk until either is
+ * modified.  @a to_path must not exist yet.  Return an error with
+ * #SVN_ERR_UNSUPPORTED_FEATURE, and leave no @a to_path behind, if the
+ * platform or the file system can't clone files.
+ * Use @a pool for temporary allocations.
+ */
+svn_error_t *
+svn_io__file_clone(const char *from_path,
+                   const char *to_path,
+                   apr_pool_t *pool);
+
 
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
@@ -91,6 +127,21 @@ svn_io__file_lock_autocreate(const char *lock_file,
 apr_file_t *
 svn_stream__aprfile(svn_stream_t *stream);
 
+/* Set *STREAM to a readable stream returning the contents of FILE from
+   its current position on, which a separate thread reads ahead of the
+   consumer, so that waiting for the input overlaps with processing it.
+
+   FILE must not be accessed by anyone else until *STREAM has been closed
+   or RESULT_POOL has been cleaned up.  Closing *STREAM does not close
+   FILE, but FILE's position will be somewhere behind the data returned
+   by *STREAM.  Without thread support, this is the same as
+   svn_stream_from_aprfile2() with DISOWN set.
+ */
+svn_error_t *
+svn_stream__create_read_ahead(svn_stream_t **stream,
+                              apr_file_t *file,
+                              apr_pool_t *result_pool);
+
 /* Creates as *INSTALL_STREAM a stream that once completed can be installed
    using Windows checkouts much slower than Unix.
 
@@ -135,6 +186,58 @@ svn_stream__from_aprfile(apr_file_t *file,
                          svn_boolean_t truncate_on_seek,
                          apr_pool_t *pool);
 
+/* Like svn_stream_checksummed2() but optionally calculate a second
+   checksum of kind CHECKSUM_KIND2 into *READ_CHECKSUM2 and
+   *WRITE_CHECKSUM2, respectively.  Both checksums are being updated in
+   a single pass over each buffer.  Any of the checksum pointers may be
+   NULL. */
+svn_stream_t *
+svn_stream__checksummed(svn_stream_t *stream,
+                        svn_checksum_t **read_checksum,
+                        svn_checksum_t **read_checksum2,
+                        svn_checksum_t **write_checksum,
+                        svn_checksum_t **write_checksum2,
+                        svn_checksum_kind_t checksum_kind,
+                        svn_checksum_kind_t checksum_kind2,
+                        svn_boolean_t read_all,
+                        apr_pool_t *pool);
+
+/* Borrowed read handler type for streams.  Set *DATA to point to the
+   next bytes of the stream, held in a buffer owned by the stream, and
+   *LEN to their number.  On entry, *LEN is the maximum number of bytes
+   the caller is willing to consume; on exit it may be smaller.  *LEN is
+   set to 0 only at the end of the stream.
+
+   The data must not be modified and remains valid only until the next
+   operation on the stream. */
+typedef svn_error_t *(*svn_stream__read_borrowed_fn_t)(void *baton,
+                                                       const char **data,
+                                                       apr_size_t *len);
+
+/* Set STREAM's borrowed read function to READ_BORROWED_FN. */
+void
+svn_stream__set_read_borrowed(svn_stream_t *stream,
+                              svn_stream__read_borrowed_fn_t read_borrowed_fn);
+
+/* Return whether STREAM supports svn_stream__read_borrowed(). */
+svn_boolean_t
+svn_stream__supports_read_borrowed(svn_stream_t *stream);
+
+/* Read from STREAM without copying: set *DATA to point to up to *LEN
+   bytes of data held in a buffer owned by STREAM and update *LEN to the
+   number of bytes actually made available.  If *LEN is 0 on return, the
+   end of the stream has been reached.
+
+   The buffer is read-only and becomes invalid at the next operation on
+   STREAM.  Callers may mix this with regular reads.
+
+   Return SVN_ERR_STREAM_NOT_SUPPORTED if STREAM has no borrowed read
+   handler; see svn_stream__supports_read_borrowed(). */
+svn_error_t *
+svn_stream__read_borrowed(svn_stream_t *stream,
+                          const char **data,
+                          apr_size_t *len);
+
 #if defined(WIN32)
 
 /* ### Move to something like io.h or subr.h, to avoid making it
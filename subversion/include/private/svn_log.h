@@ -198,6 +198,15 @@ svn_log__get_file_revs(const char *path, svn_revnum_t start, svn_revnum_t end,
                        svn_boolean_t include_merged_revisions,
                        apr_pool_t *pool);
 
+/**
+ * Return a log string for a blame action.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_log__blame(const char *path, svn_revnum_t start, svn_revnum_t end,
+               apr_pool_t *pool);
+
 /**
  * Return a log string for a lock action.
  *
@@ -264,6 +273,27 @@ svn_log__list(const char *path, svn_revnum_t revision,
               apr_array_header_t *patterns, svn_depth_t depth,
               apr_uint32_t dirent_fields, apr_pool_t *pool);
 
+/**
+ * Return a log string describing the cost of a request that took
+ * @a elapsed microseconds of wall time.  @a changes is an array of
+ * svn_stats__info_t * as returned by svn_stats__get_changes() for the
+ * duration of the request and may be @c NULL.
+ *
+ * The result is a space-separated list of NAME=VALUE pairs, starting
+ * with "time".  Depending on the counters in @a changes, it continues
+ * with the time spent reading files ("fs-read"), the number of cache hits
+ * and misses ("cache-hits", "cache-misses"), the time spent on path-based
+ * authorization ("authz") and on computing and combining deltas ("delta"),
+ * the number of bytes sent to the client ("sent") and the time spent
+ * writing them to the network ("net-wait").  Times are in microseconds.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_log__stats(apr_interval_time_t elapsed,
+               const apr_array_header_t *changes,
+               apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -287,6 +287,68 @@ svn_rangelist__merge_many(svn_rangelist_t *merged_rangelist,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+/* A compact, immutable representation of mergeinfo.
+
+   All merge source paths are kept in a single array sorted by strcmp()
+   and all ranges in a single packed array of svn_merge_range_t, i.e.
+   without per-range allocations.  Paths are shared by reference between
+   the source it was created from and the results of the set operations
+   below.
+
+   This is meant for internal processing of large mergeinfo, e.g. when
+   accumulating many mergeinfos, where the set operations become linear
+   merges instead of hash lookups plus rangelist array manipulations. */
+typedef struct svn_mergeinfo__flat_t
+{
+  /* Number of merge source paths. */
+  int nelts;
+
+  /* NELTS merge source paths, sorted by strcmp(). */
+  const char **paths;
+
+  /* NELTS + 1 offsets into RANGES.  The canonical rangelist for PATHS[i]
+     is RANGES[OFFSETS[i]] up to but not including RANGES[OFFSETS[i+1]]. */
+  int *offsets;
+
+  /* All ranges of all paths. */
+  svn_merge_range_t *ranges;
+} svn_mergeinfo__flat_t;
+
+/* Set *FLAT to the flat representation of MERGEINFO, allocated in
+   RESULT_POOL.  The paths are not copied and must outlive *FLAT.
+   MERGEINFO may be NULL.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_mergeinfo__flat_from_mergeinfo(svn_mergeinfo__flat_t **flat,
+                                   svn_mergeinfo_t mergeinfo,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool);
+
+/* Set *MERGEINFO to a mergeinfo hash with the same contents as FLAT,
+   deeply allocated in RESULT_POOL. */
+svn_error_t *
+svn_mergeinfo__flat_to_mergeinfo(svn_mergeinfo_t *mergeinfo,
+                                 const svn_mergeinfo__flat_t *flat,
+                                 apr_pool_t *result_pool);
+
+/* Set *RESULT to the union of FLAT1 and FLAT2, allocated in RESULT_POOL.
+   The inheritability of the result follows svn_mergeinfo_merge2(). */
+svn_error_t *
+svn_mergeinfo__flat_merge(svn_mergeinfo__flat_t **result,
+                          const svn_mergeinfo__flat_t *flat1,
+                          const svn_mergeinfo__flat_t *flat2,
+                          apr_pool_t *result_pool);
+
+/* Set *RESULT to the intersection of FLAT1 and FLAT2, allocated in
+   RESULT_POOL.  CONSIDER_INHERITANCE has the same meaning as for
+   svn_mergeinfo_intersect2() and, like there, paths with an empty
+   intersection are omitted from *RESULT. */
+svn_error_t *
+svn_mergeinfo__flat_intersect(svn_mergeinfo__flat_t **result,
+                              const svn_mergeinfo__flat_t *flat1,
+                              const svn_mergeinfo__flat_t *flat2,
+                              svn_boolean_t consider_inheritance,
+                              apr_pool_t *result_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
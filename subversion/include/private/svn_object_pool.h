@@ -82,6 +82,17 @@ svn_object_pool__create(svn_object_pool__t **object_pool,
                         svn_boolean_t thread_safe,
                         apr_pool_t *pool);
 
+/* Like svn_object_pool__create but the object pool will operate in
+ * exclusive mode:  Every object gets handed out to at most one user at
+ * a time and becomes available for the next lookup once that reference
+ * has been returned.  Hence, there may be multiple objects per key and
+ * svn_object_pool__insert will always add the new object.
+ */
+svn_error_t *
+svn_object_pool__create_exclusive(svn_object_pool__t **object_pool,
+                                  svn_boolean_t thread_safe,
+                                  apr_pool_t *pool);
+
 /* Return a pool to allocate the new object.
  */
 apr_pool_t *
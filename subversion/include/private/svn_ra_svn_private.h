@@ -132,6 +132,56 @@ svn_ra_svn__set_capabilities(svn_ra_svn_conn_t *conn,
 int
 svn_ra_svn__svndiff_version(svn_ra_svn_conn_t *conn);
 
+/** Let @a conn adapt its compression level to the connection's
+ * throughput, keeping it between @a min_level and @a max_level.
+ * The level is raised while sending the data is limited by the network
+ * and lowered while it is limited by the CPU.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_ra_svn__tune_compression(svn_ra_svn_conn_t *conn,
+                             int min_level,
+                             int max_level);
+
+/** A TLS server configuration, shared by all connections accepted by
+ * a server process.  It also holds the state for resuming the TLS
+ * sessions of returning clients.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_ra_svn__tls_server_t svn_ra_svn__tls_server_t;
+
+/** Return TRUE if ra_svn has been built with TLS support.
+ *
+ * @since New in 1.15.
+ */
+svn_boolean_t
+svn_ra_svn__tls_supported(void);
+
+/** Set @a *server to a new TLS server configuration, allocated in
+ * @a result_pool, that presents the PEM encoded certificate chain from
+ * @a cert_file and authenticates with the private key in @a key_file.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__tls_server_create(svn_ra_svn__tls_server_t **server,
+                              const char *cert_file,
+                              const char *key_file,
+                              apr_pool_t *result_pool);
+
+/** Perform the server side of the TLS handshake on @a conn, using
+ * @a server, and send all further traffic on @a conn through TLS.
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__tls_accept(svn_ra_svn_conn_t *conn,
+                       svn_ra_svn__tls_server_t *server,
+                       apr_pool_t *scratch_pool);
+
 
 /**
  * Set the shim callbacks to be used by @a conn to @a shim_callbacks.
@@ -169,6 +219,19 @@ svn_ra_svn__write_string(svn_ra_svn_conn_t *conn,
                          apr_pool_t *pool,
                          const svn_string_t *str);
 
+/** Write the @a length bytes at @a offset in @a file over the net, as a
+ * sequence of strings.  Where possible, the data is passed from @a file
+ * to the socket by the kernel without being copied into user space.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__write_file_range(svn_ra_svn_conn_t *conn,
+                             apr_pool_t *pool,
+                             apr_file_t *file,
+                             apr_off_t offset,
+                             svn_filesize_t length);
+
 /** Write a cstring over the net.
  *
  * Writes will be buffered until the next read or flush.
@@ -365,6 +428,53 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
                         svn_ra_svn_conn_t *conn,
                         apr_pool_t *pool);
 
+/** Like svn_ra_svn__has_command() but set @a *has_command only once a
+ * whole command has been received from @a conn, reading as much data as
+ * is available without blocking.  Partially received commands remain
+ * buffered in @a conn and later calls resume from there.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__has_complete_command(svn_boolean_t *has_command,
+                                 svn_boolean_t *terminated,
+                                 svn_ra_svn_conn_t *conn,
+                                 apr_pool_t *pool);
+
+/** Return the name of the next command buffered in @a conn, allocated
+ * in @a pool, without consuming any data.  Return @c NULL if the buffer
+ * does not start with a command name, e.g. because it is empty.
+ *
+ * @since New in 1.15.
+ */
+const char *
+svn_ra_svn__peek_command(svn_ra_svn_conn_t *conn,
+                         apr_pool_t *pool);
+
+/** Return the time at which svn_ra_svn__handle_command() finished reading
+ * the most recent command from @a conn, i.e. when its execution started.
+ * Return 0 if no command has been handled, yet.
+ *
+ * @since New in 1.15.
+ */
+apr_time_t
+svn_ra_svn__command_start_time(svn_ra_svn_conn_t *conn);
+
+/** Handle the commands of a "batch" command, given as its @a params, on
+ * @a conn.  Only those in @a commands, which must not contain commands
+ * that change the command set or end the session, are accepted; others
+ * fail like unknown commands.  Command handlers will be passed @a conn,
+ * a subpool of @a pool, their parameters, and @a baton.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__handle_batch(svn_ra_svn_conn_t *conn,
+                         apr_pool_t *pool,
+                         const svn_ra_svn__list_t *params,
+                         const svn_ra_svn__cmd_entry_t *commands,
+                         void *baton);
+
 /** Accept a single command from @a conn and handle them according
  * to @a cmd_hash.  Command handlers will be passed @a conn, @a pool,
  * the parameters of the command, and @a baton.  @a *terminate will be
@@ -841,6 +951,25 @@ svn_ra_svn__write_cmd_check_path(svn_ra_svn_conn_t *conn,
                                  const char *path,
                                  svn_revnum_t rev);
 
+/** Start a "batch" command over connection @a conn.  Commands written
+ * until the matching svn_ra_svn__write_cmd_batch_end() become part of
+ * the batch.  Use @a pool for allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__write_cmd_batch_start(svn_ra_svn_conn_t *conn,
+                                  apr_pool_t *pool);
+
+/** End a "batch" command over connection @a conn.
+ * Use @a pool for allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__write_cmd_batch_end(svn_ra_svn_conn_t *conn,
+                                apr_pool_t *pool);
+
 /** Send a "stat" command over connection @a conn.
  * Use @a pool for allocations.
  *
@@ -1026,6 +1155,25 @@ svn_ra_svn__write_dirent(svn_ra_svn_conn_t *conn,
                          svn_dirent_t *dirent,
                          apr_uint32_t dirent_fields);
 
+/** Send the entry @a name of a directory listing, as part of the
+ * "get-dir" response, over connection @a conn.  Use @a pool for
+ * allocations.  @a cdate and @a last_author may be @c NULL.
+ *
+ * @see svn_dirent_t for a description of the other parameters.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__write_data_dir_entry(svn_ra_svn_conn_t *conn,
+                                 apr_pool_t *pool,
+                                 const char *name,
+                                 svn_node_kind_t kind,
+                                 svn_filesize_t size,
+                                 svn_boolean_t has_props,
+                                 svn_revnum_t created_rev,
+                                 const char *cdate,
+                                 const char *last_author);
+
 /**
  * @}
  */
@@ -1035,6 +1183,43 @@ svn_ra_svn__write_dirent(svn_ra_svn_conn_t *conn,
  * @{
  */
 
+/** Take the data tuple ITEMS received over ra_svn and convert it to a
+ * directory entry, as sent by svn_ra_svn__write_data_dir_entry().
+ * @a *cdate and @a *last_author may be set to @c NULL.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__read_data_dir_entry(const svn_ra_svn__list_t *items,
+                                const char **name,
+                                const char **kind_word,
+                                apr_uint64_t *size,
+                                svn_boolean_t *has_props,
+                                svn_revnum_t *created_rev,
+                                const char **cdate,
+                                const char **last_author);
+
+/** Take the data tuple ITEMS received over ra_svn and convert it to the
+ * parts of a log entry, as sent by svn_ra_svn__write_data_log_entry()
+ * and followed by the revprops list and the subtractive-merge flag.
+ * Elements that older servers don't send are set to
+ * #SVN_RA_SVN_UNSPECIFIED_NUMBER or @c NULL, respectively.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_svn__read_data_log_entry(const svn_ra_svn__list_t *items,
+                                const svn_ra_svn__list_t **changed_paths,
+                                svn_revnum_t *revision,
+                                svn_string_t **author,
+                                svn_string_t **date,
+                                svn_string_t **message,
+                                apr_uint64_t *has_children,
+                                apr_uint64_t *invalid_revnum,
+                                apr_uint64_t *revprop_count,
+                                const svn_ra_svn__list_t **revprops,
+                                apr_uint64_t *subtractive_merge);
+
 /** Take the data tuple ITEMS received over ra_svn and convert it to the
  * a changed path (as part of receiving a log entry).
  *
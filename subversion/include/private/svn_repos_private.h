@@ -155,6 +155,36 @@ svn_repos__replay_ev2(svn_fs_root_t *root,
                       void *authz_read_baton,
                       apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_repos_get_logs5() but with the additional, optional
+ * @a authz_subtree_func.  If given, it will be called with
+ * @a authz_read_baton to check recursive read access to the longest
+ * common ancestor of the paths changed in a revision.  If that is
+ * granted, the changed paths of that revision will not be checked
+ * individually through @a authz_read_func.
+ *
+ * Both callbacks must implement the same, purely path-based rules, i.e.
+ * @a authz_subtree_func must grant recursive read access only where
+ * @a authz_read_func would grant read access to every path below.
+ */
+svn_error_t *
+svn_repos__get_logs(svn_repos_t *repos,
+                    const apr_array_header_t *paths,
+                    svn_revnum_t start,
+                    svn_revnum_t end,
+                    int limit,
+                    svn_boolean_t strict_node_history,
+                    svn_boolean_t include_merged_revisions,
+                    const apr_array_header_t *revprops,
+                    svn_repos_authz_func_t authz_read_func,
+                    svn_repos_authz_callback_t authz_subtree_func,
+                    void *authz_read_baton,
+                    svn_repos_path_change_receiver_t path_change_receiver,
+                    void *path_change_receiver_baton,
+                    svn_repos_log_entry_receiver_t revision_receiver,
+                    void *revision_receiver_baton,
+                    apr_pool_t *scratch_pool);
+
 /**
  * Non-deprecated alias for svn_repos_get_logs4.
  *
@@ -230,6 +260,52 @@ svn_repos__config_pool_get(svn_config_t **cfg,
 
 /** @} */
 
+/**
+ * @defgroup svn_repos_pool Repository object pool API
+ * @{
+ */
+
+/* Opaque thread-safe factory and container for repository objects.
+ *
+ * Every instance handed out is used by a single caller at a time.  Once
+ * that caller releases it, the next request for the same repository will
+ * get it instead of opening the repository again.
+ */
+typedef svn_object_pool__t svn_repos__repos_pool_t;
+
+/* Create a new repository pool object with a lifetime determined by
+ * POOL and return it in *REPOS_POOL.
+ *
+ * The THREAD_SAFE flag indicates whether the pool actually needs to be
+ * thread-safe and POOL must be also be thread-safe if this flag is set.
+ */
+svn_error_t *
+svn_repos__repos_pool_create(svn_repos__repos_pool_t **repos_pool,
+                             svn_boolean_t thread_safe,
+                             apr_pool_t *pool);
+
+/* Set *REPOS_P to an open instance of the repository at PATH, like
+ * svn_repos_open3() does with FS_CONFIG.  Take it from REPOS_POOL, if an
+ * unused instance of the same repository is available, and open a new
+ * one otherwise.  Repositories that have been re-created at PATH since
+ * will not be confused with their predecessors.
+ *
+ * RESULT_POOL determines the lifetime of the reference; the instance
+ * is reusable once it gets cleaned up.  Callers must not change the
+ * repository object in ways that would affect later users, apart from
+ * the FS access context which gets reset here.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+svn_error_t *
+svn_repos__repos_pool_get(svn_repos_t **repos_p,
+                          svn_repos__repos_pool_t *repos_pool,
+                          const char *path,
+                          apr_hash_t *fs_config,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool);
+
+/** @} */
+
 /* Adjust mergeinfo paths and revisions in ways that are useful when loading
  * a dump stream.
  *
@@ -129,6 +129,30 @@ svn_sqlite__open(svn_sqlite__db_t **db, const char *path,
                  apr_int32_t timeout,
                  apr_pool_t *result_pool, apr_pool_t *scratch_pool);
 
+/* Report statistics for the statements in DB under the names given in
+   STATEMENT_INFO, as declared by the *_DECLARE_STATEMENT_INFO macro that
+   corresponds to the STATEMENTS given to svn_sqlite__open().  With
+   statistics collection enabled, each statement then gets its own
+   "sqlite.STMT_*" step timer and "sqlite.STMT_*.fullscan_steps" counter.
+   STATEMENT_INFO must live at least as long as DB. */
+void
+svn_sqlite__set_statement_info(svn_sqlite__db_t *db,
+                               const char * const statement_info[][2]);
+
+/* Tune the connection in DB for the expected access pattern.  Use up to
+   CACHE_SIZE bytes for the page cache and memory-map up to MMAP_SIZE bytes
+   of the database file.  Values <= 0 keep SQLite's defaults.  If USE_WAL
+   is set, switch the database to write-ahead logging, which lets readers
+   proceed while a writer is active; otherwise switch it back to the
+   default journal mode when possible.  Only enable USE_WAL if all users
+   of the database can create files next to it. */
+svn_error_t *
+svn_sqlite__tune(svn_sqlite__db_t *db,
+                 apr_int64_t cache_size,
+                 apr_int64_t mmap_size,
+                 svn_boolean_t use_wal,
+                 apr_pool_t *scratch_pool);
+
 /* Explicitly close the connection in DB. */
 svn_error_t *
 svn_sqlite__close(svn_sqlite__db_t *db);
@@ -432,6 +456,38 @@ svn_error_t *
 svn_sqlite__finish_savepoint(svn_sqlite__db_t *db,
                              svn_error_t *err);
 
+/* Begin a batch in DB, unless one is open already.  Until the batch is
+ * finished with svn_sqlite__finish_batch(), the transactions begun in
+ * DB become savepoints of a single transaction holding a 'RESERVED'
+ * lock: they can still be rolled back on their own, but only become
+ * durable, together, when the batch is finished.  This saves syncing
+ * the database to disk for every one of them.
+ *
+ * Callers must not do anything that relies on changes made within the
+ * batch having been committed, e.g. acting on the file system, before
+ * finishing it. */
+svn_error_t *
+svn_sqlite__begin_batch(svn_sqlite__db_t *db);
+
+/* Commit the batch open in DB, if any, if ERR is SVN_NO_ERROR; otherwise
+ * roll it back.  Return a composition of ERR and any error that may occur
+ * during the commit or roll-back. */
+svn_error_t *
+svn_sqlite__finish_batch(svn_sqlite__db_t *db,
+                         svn_error_t *err);
+
+/* Return TRUE if a batch is open in DB. */
+svn_boolean_t
+svn_sqlite__in_batch(svn_sqlite__db_t *db);
+
+/* Return a value that changes whenever a row is inserted, updated or
+ * deleted through DB, or a transaction or savepoint in DB is rolled back.
+ * Callers keeping data read from DB in memory can compare stamps to find
+ * out whether that data may be out of date.  Changes made through other
+ * connections to the same database are not noticed. */
+apr_int64_t
+svn_sqlite__change_stamp(svn_sqlite__db_t *db);
+
 /* Evaluate the expression EXPR within a transaction.
  *
  * Begin a transaction in DB; evaluate the expression EXPR, which would
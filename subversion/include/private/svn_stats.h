@@ -0,0 +1,243 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_stats.h
+ * @brief Lightweight process-wide counters and timers.
+ */
+
+#ifndef SVN_STATS_H
+#define SVN_STATS_H
+
+#include <apr_pools.h>
+#include <apr_tables.h>
+#include <apr_time.h>
+
+#include "svn_types.h"
+#include "svn_string.h"
+#include "private/svn_atomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @defgroup svn_stats Statistics counters
+ * @{
+ *
+ * Named counters that accumulate process-wide event counts and timings
+ * for instrumentation purposes.  Collection is off by default and gets
+ * enabled by setting the @c SVN_STATS environment variable to any value
+ * other than "0" or by calling svn_stats__set_enabled().  When enabled,
+ * all non-empty counters are also written to @c stderr at process exit.
+ *
+ * A counter is a static variable defined with #SVN__COUNTER_DEFINE and
+ * updated through #SVN__COUNTER_ADD or the #SVN__TIMER_START /
+ * #SVN__TIMER_STOP pair.  Each counter decides at its first use whether
+ * collection is enabled.  From then on, a disabled counter costs a
+ * single test of a static variable per update.
+ *
+ * Counter names should use dot-separated "subsystem.event" form, e.g.
+ * "fsfs.rev_file_opens".
+ */
+
+/** Counter states, see #svn_stats__counter_t. */
+#define SVN_STATS__UNINITIALIZED 0
+#define SVN_STATS__DISABLED      1
+#define SVN_STATS__REGISTERING   2
+#define SVN_STATS__ENABLED       3
+
+/** A single named counter.  Do not access the members directly; use the
+ * macros below.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_stats__counter_t
+{
+  /** Name of the counter as shown in reports. */
+  const char *name;
+
+  /** One of the SVN_STATS__* state values. */
+  volatile svn_atomic_t state;
+
+  /** Number of recorded events. */
+  volatile apr_uint64_t count;
+
+  /** Sum of the amounts recorded, in usec for timers. */
+  volatile apr_uint64_t total;
+
+  /** Next registered counter. */
+  struct svn_stats__counter_t *next;
+} svn_stats__counter_t;
+
+/** Define a static counter variable @a var with the name @a name. */
+#define SVN__COUNTER_DEFINE(var, name) \
+  static svn_stats__counter_t var = { (name), SVN_STATS__UNINITIALIZED }
+
+/** Record one event adding @a amount to counter @a var. */
+#define SVN__COUNTER_ADD(var, amount)                     \
+  do {                                                    \
+    if ((var).state != SVN_STATS__DISABLED)               \
+      svn_stats__counter_add(&(var), (amount));           \
+  } while (0)
+
+/** Record one event for counter @a var. */
+#define SVN__COUNTER_INC(var) SVN__COUNTER_ADD(var, 1)
+
+/** Start timing with counter @a var and store the start time in the
+ * #apr_time_t variable @a start.  @a start will be 0 if collection
+ * is disabled.
+ */
+#define SVN__TIMER_START(var, start)                      \
+  ((start) = ((var).state != SVN_STATS__DISABLED          \
+              ? svn_stats__timer_start(&(var))            \
+              : 0))
+
+/** Stop the timing started with #SVN__TIMER_START using the same @a var
+ * and @a start.  This records one event with the elapsed time.
+ */
+#define SVN__TIMER_STOP(var, start)                       \
+  do {                                                    \
+    if (start)                                            \
+      svn_stats__counter_add(&(var),                      \
+                             apr_time_now() - (start));   \
+  } while (0)
+
+/** Record one event adding @a amount to @a counter.  If this is the first
+ * use of @a counter, decide whether collection is enabled and register
+ * @a counter for reporting.
+ *
+ * Use #SVN__COUNTER_ADD instead of calling this directly.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_stats__counter_add(svn_stats__counter_t *counter,
+                       apr_uint64_t amount);
+
+/** Initialize @a counter like svn_stats__counter_add() does but don't
+ * record any event.  Return the current time if collection is enabled
+ * and 0 otherwise.
+ *
+ * Use #SVN__TIMER_START instead of calling this directly.
+ *
+ * @since New in 1.15.
+ */
+apr_time_t
+svn_stats__timer_start(svn_stats__counter_t *counter);
+
+/** Enable or disable collection as indicated by @a enabled, overriding
+ * the @c SVN_STATS environment variable.  Only counters that have not
+ * been used yet are affected, so this should be called early during
+ * process initialization.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_stats__set_enabled(svn_boolean_t enabled);
+
+/** Return whether counters collect data, i.e. whether the @c SVN_STATS
+ * environment variable or svn_stats__set_enabled() turned collection on.
+ *
+ * @since New in 1.15.
+ */
+svn_boolean_t
+svn_stats__enabled(void);
+
+/** Return the counter named @a name, creating and registering it upon
+ * the first request for that name.  This is meant for counters whose
+ * names are only known at runtime, e.g. one per SQL statement.  Use
+ * the macros with @c *counter to update the result.  Such counters live
+ * until the process ends.
+ *
+ * Return @c NULL if collection is disabled.
+ *
+ * @since New in 1.15.
+ */
+svn_stats__counter_t *
+svn_stats__get_counter(const char *name);
+
+/** A snapshot of a single counter, see svn_stats__get_info().
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_stats__info_t
+{
+  /** Name of the counter. */
+  const char *name;
+
+  /** Number of recorded events. */
+  apr_uint64_t count;
+
+  /** Sum of the amounts recorded. */
+  apr_uint64_t total;
+} svn_stats__info_t;
+
+/** Set @a *infos to an array of #svn_stats__info_t *, one for each counter
+ * that has been enabled and registered so far, sorted by name.  Allocate
+ * the result in @a result_pool.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_stats__get_info(apr_array_header_t **infos,
+                    apr_pool_t *result_pool);
+
+/** Set @a *changes to an array of #svn_stats__info_t *, one for each
+ * counter in @a after that recorded events since the snapshot @a before
+ * has been taken.  The counts and totals are the differences between
+ * both snapshots.  Counters missing from @a before count as 0.  Both
+ * inputs must have been produced by svn_stats__get_info().  Allocate
+ * the result in @a result_pool.
+ *
+ * Counters are process-wide, i.e. the changes cover all threads.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_stats__get_changes(apr_array_header_t **changes,
+                       const apr_array_header_t *before,
+                       const apr_array_header_t *after,
+                       apr_pool_t *result_pool);
+
+/** Return a human readable single-line representation of @a info,
+ * allocated in @a result_pool.
+ *
+ * @since New in 1.15.
+ */
+svn_string_t *
+svn_stats__format_info(const svn_stats__info_t *info,
+                       apr_pool_t *result_pool);
+
+/** Reset all registered counters to zero.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_stats__reset(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_STATS_H */
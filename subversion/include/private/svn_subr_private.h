@@ -269,6 +269,18 @@ svn_checksum__from_digest_fnv1a_32x4(const unsigned char *digest,
                                      apr_pool_t *result_pool);
 
 
+/**
+ * Feed @a len bytes from @a data into both checksum contexts @a ctx1 and
+ * @a ctx2.  This is equivalent to calling svn_checksum_update() on each of
+ * them but walks @a data in chunks small enough to stay in the CPU cache
+ * for the second context.  Either context may be @c NULL.
+ */
+svn_error_t *
+svn_checksum__update2(svn_checksum_ctx_t *ctx1,
+                      svn_checksum_ctx_t *ctx2,
+                      const void *data,
+                      apr_size_t len);
+
 /**
  * Return a stream that calculates a checksum of type @a kind over all
  * data written to the @a inner_stream.  When the returned stream gets
@@ -382,6 +394,100 @@ svn_hash__make(apr_pool_t *pool);
 
 /** @} */
 
+/**
+ * @defgroup svn_hash_table Open addressing hash tables
+ * @{
+ */
+
+/** A string-keyed hash table with the same key semantics as apr_hash_t
+ * but using open addressing.  All entries live in a single slot array,
+ * i.e. there is no per-entry allocation, and lookups scan a compact array
+ * of control bytes before touching any key.  This makes it considerably
+ * faster than apr_hash_t for temporary tables with many lookups.
+ *
+ * Like with apr_hash_t, keys and values are stored by reference and must
+ * remain valid for the lifetime of the table.  Iteration order is
+ * unspecified.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_hash__table_t svn_hash__table_t;
+
+/** Return a new, empty table allocated in @a pool.  The table will grow
+ * automatically but pre-allocates enough room for @a size_hint entries.
+ *
+ * @since New in 1.15.
+ */
+svn_hash__table_t *
+svn_hash__table_create(apr_size_t size_hint,
+                       apr_pool_t *pool);
+
+/** Return the number of entries in @a table.
+ *
+ * @since New in 1.15.
+ */
+apr_size_t
+svn_hash__table_count(const svn_hash__table_t *table);
+
+/** Return the value stored for @a key of length @a klen in @a table or
+ * @c NULL if there is none.  @a klen may be #APR_HASH_KEY_STRING.
+ *
+ * @since New in 1.15.
+ */
+void *
+svn_hash__table_get(const svn_hash__table_t *table,
+                    const char *key,
+                    apr_ssize_t klen);
+
+/** Store @a value for @a key of length @a klen in @a table, replacing any
+ * previous value.  If @a value is @c NULL, remove @a key from @a table.
+ * @a klen may be #APR_HASH_KEY_STRING.
+ *
+ * @since New in 1.15.
+ */
+void
+svn_hash__table_set(svn_hash__table_t *table,
+                    const char *key,
+                    apr_ssize_t klen,
+                    void *value);
+
+/** Iterate over the entries in @a table.  Set @a *iter to 0 before the
+ * first call.  Returns @c TRUE and sets @a *key, @a *klen and @a *value
+ * to the next entry, or returns @c FALSE if there are no more entries.
+ * Any of @a key, @a klen and @a value may be @c NULL.
+ *
+ * Entries must not be added while iterating but setting values for
+ * existing keys, including removing them, is allowed.
+ *
+ * @since New in 1.15.
+ */
+svn_boolean_t
+svn_hash__table_next(const svn_hash__table_t *table,
+                     apr_size_t *iter,
+                     const char **key,
+                     apr_size_t *klen,
+                     void **value);
+
+/** Return a new table allocated in @a pool with the same contents as
+ * @a hash.  Keys and values are not copied.
+ *
+ * @since New in 1.15.
+ */
+svn_hash__table_t *
+svn_hash__table_from_apr(apr_hash_t *hash,
+                         apr_pool_t *pool);
+
+/** Return a new APR hash allocated in @a pool with the same contents as
+ * @a table.  Keys and values are not copied.
+ *
+ * @since New in 1.15.
+ */
+apr_hash_t *
+svn_hash__table_to_apr(const svn_hash__table_t *table,
+                       apr_pool_t *pool);
+
+/** @} */
+
 /**
  * @defgroup svn_hash_read Reading serialized hash tables
  * @{
@@ -591,6 +697,31 @@ svn__decompress_lz4(const void *data, apr_size_t len,
                     svn_stringbuf_t *out,
                     apr_size_t limit);
 
+/* Same as svn__compress_zlib(), but use Zstandard compression at the
+ * given COMPRESSION_LEVEL.  A COMPRESSION_LEVEL of 0 or less selects the
+ * library's default level.  Return SVN_ERR_UNSUPPORTED_FEATURE if this
+ * build does not support Zstandard; see svn__zstd_supported().
+ */
+svn_error_t *
+svn__compress_zstd(const void *data, apr_size_t len,
+                   svn_stringbuf_t *out,
+                   int compression_level);
+
+/* Same as svn__decompress_zlib(), but use Zstandard compression.
+ * Return SVN_ERR_UNSUPPORTED_FEATURE if this build does not support
+ * Zstandard.
+ */
+svn_error_t *
+svn__decompress_zstd(const void *data, apr_size_t len,
+                     svn_stringbuf_t *out,
+                     apr_size_t limit);
+
+/* Return TRUE if this build supports Zstandard compression, i.e. if
+ * svn__compress_zstd() and svn__decompress_zstd() are functional.
+ */
+svn_boolean_t
+svn__zstd_supported(void);
+
 /** @} */
 
 /**
@@ -746,6 +877,15 @@ const char *svn_lz4__compiled_version(void);
  */
 int svn_lz4__runtime_version(void);
 
+/* Return the Zstandard version we compiled against.
+ * Only available if SVN_HAVE_ZSTD is defined. */
+const char *svn_zstd__compiled_version(void);
+
+/* Return the Zstandard version we run against as a composed value:
+ * major * 100 * 100 + minor * 100 + release
+ * Only available if SVN_HAVE_ZSTD is defined. */
+int svn_zstd__runtime_version(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,187 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_thread_pool.h
+ * @brief Worker threads running jobs on behalf of a single owner thread
+ */
+
+#ifndef SVN_THREAD_POOL_H
+#define SVN_THREAD_POOL_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * A set of worker threads that run jobs for the thread that created it,
+ * its "owner".  Only the owner may call the functions below.
+ *
+ * Workers claim the jobs in the order they have been submitted.  The
+ * owner typically waits for them in that order as well, such that it
+ * can process their results in a deterministic order.  All results are
+ * handed over through the job batons; the thread pool only reports the
+ * error returned by each job.
+ *
+ * The worker threads get started on demand and may be stopped while no
+ * jobs are pending, e.g. to not keep idle threads around.  Without APR
+ * thread support, jobs get run by the owner as soon as they are being
+ * submitted.
+ */
+typedef struct svn_thread_pool__t svn_thread_pool__t;
+
+/** A job that has been submitted to a #svn_thread_pool__t. */
+typedef struct svn_thread_pool__job_t svn_thread_pool__job_t;
+
+/** Create the state of a single worker in @a *worker_baton, allocated in
+ * @a worker_pool.  @a baton is the baton given to svn_thread_pool__create()
+ * and @a worker_index identifies the worker, counting from 0.
+ *
+ * This gets called by the owner before the respective worker thread is
+ * being started for the first time.  @a worker_pool may only be used by
+ * that worker afterwards, e.g. for FS instances that it uses exclusively.
+ */
+typedef svn_error_t *
+(*svn_thread_pool__worker_init_t)(void **worker_baton,
+                                  void *baton,
+                                  int worker_index,
+                                  apr_pool_t *worker_pool);
+
+/** Run the job given by @a job_baton, using the state in @a worker_baton
+ * as created by the #svn_thread_pool__worker_init_t of the thread pool,
+ * or NULL if there is none.  Use @a scratch_pool for temporary
+ * allocations.
+ *
+ * @a cancel_func with @a cancel_baton returns #SVN_ERR_CANCELLED once the
+ * owner is no longer interested in the result of this job, e.g. because
+ * the thread pool is being aborted.  Long-running jobs should call it
+ * regularly.
+ */
+typedef svn_error_t *
+(*svn_thread_pool__job_func_t)(void *job_baton,
+                               void *worker_baton,
+                               svn_cancel_func_t cancel_func,
+                               void *cancel_baton,
+                               apr_pool_t *scratch_pool);
+
+/** Create a thread pool in @a *thread_pool with up to @a thread_count
+ * worker threads, allocated in @a result_pool.  If @a init_func is not
+ * NULL, call it with @a init_baton to create the state of each worker.
+ *
+ * When @a result_pool gets cleaned up, all workers are being aborted as
+ * by svn_thread_pool__join() before any other cleanup of that pool runs.
+ */
+svn_error_t *
+svn_thread_pool__create(svn_thread_pool__t **thread_pool,
+                        int thread_count,
+                        svn_thread_pool__worker_init_t init_func,
+                        void *init_baton,
+                        apr_pool_t *result_pool);
+
+/** Submit a job to @a thread_pool that will call @a func with
+ * @a job_baton.  Start the worker threads, if they are not running, yet.
+ * Return the new job in @a *job.
+ *
+ * Run with fewer worker threads if some of them can't be created but
+ * return an error if there would be none.
+ *
+ * The job does not touch @a job_baton anymore once it has been waited
+ * for by svn_thread_pool__wait() or when svn_thread_pool__join() returns.
+ */
+svn_error_t *
+svn_thread_pool__submit(svn_thread_pool__job_t **job,
+                        svn_thread_pool__t *thread_pool,
+                        svn_thread_pool__job_func_t func,
+                        void *job_baton);
+
+/** Wait until @a job in @a thread_pool has been run and return the error
+ * that it returned.  While waiting, call @a cancel_func with
+ * @a cancel_baton, if not NULL, in regular intervals.  If that returns an
+ * error, return it and leave @a job pending.
+ *
+ * @a job becomes invalid once this returned its result.
+ */
+svn_error_t *
+svn_thread_pool__wait(svn_thread_pool__t *thread_pool,
+                      svn_thread_pool__job_t *job,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton);
+
+/** Tell @a thread_pool that the result of @a job is no longer needed.
+ * If no worker claimed @a job yet, it will not be run at all.  Otherwise,
+ * the cancellation function passed to the running job starts returning
+ * #SVN_ERR_CANCELLED.
+ *
+ * @a job must still be waited for with svn_thread_pool__wait().
+ */
+svn_error_t *
+svn_thread_pool__cancel_job(svn_thread_pool__t *thread_pool,
+                            svn_thread_pool__job_t *job);
+
+/** Stop the worker threads of @a thread_pool and wait for them to
+ * terminate.
+ *
+ * If @a abort is not set, the workers run all jobs that have been
+ * submitted before they terminate.  Those jobs may then still be waited
+ * for.  Otherwise, jobs that no worker claimed yet will not be run at all,
+ * the running ones will be notified through their cancellation function
+ * and all jobs that have not been waited for become invalid.
+ *
+ * Submitting another job afterwards starts the worker threads again.
+ */
+svn_error_t *
+svn_thread_pool__join(svn_thread_pool__t *thread_pool,
+                      svn_boolean_t abort);
+
+/** Return a new root pool that may be used by any single thread at a
+ * time, e.g. for data being handed over between the owner and a worker.
+ * If @a owner is not NULL, the new pool gets destroyed when @a owner is
+ * being cleaned up.
+ */
+apr_pool_t *
+svn_thread_pool__create_root_pool(apr_pool_t *owner);
+
+/** Make @a owner destroy @a root_pool, as created by
+ * svn_thread_pool__create_root_pool() with a NULL owner, when @a owner is
+ * being cleaned up.
+ */
+void
+svn_thread_pool__attach_root_pool(apr_pool_t *root_pool,
+                                  apr_pool_t *owner);
+
+/** Destroy @a root_pool immediately.  @a owner must be the pool that it
+ * got attached to by svn_thread_pool__create_root_pool() or
+ * svn_thread_pool__attach_root_pool(), if any, and NULL otherwise.
+ */
+void
+svn_thread_pool__destroy_root_pool(apr_pool_t *root_pool,
+                                   apr_pool_t *owner);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_THREAD_POOL_H */
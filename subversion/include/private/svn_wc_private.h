@@ -924,8 +924,8 @@ svn_wc__node_get_lock_tokens_recursive(apr_hash_t **lock_tokens,
  * the caller doesn't care about that return value.
  *
  * This function provides a subset of the functionality of
- * svn_wc_revision_status2() and is more efficient if the caller
- * doesn't need all information returned by svn_wc_revision_status2(). */
+ * svn_wc_revision_status3() and is more efficient if the caller
+ * doesn't need all information returned by svn_wc_revision_status3(). */
 svn_error_t *
 svn_wc__min_max_revisions(svn_revnum_t *min_revision,
                           svn_revnum_t *max_revision,
@@ -945,8 +945,8 @@ svn_wc__min_max_revisions(svn_revnum_t *min_revision,
  * @a local_abspath's actual URL, then report a "switched" status.
  *
  * This function provides a subset of the functionality of
- * svn_wc_revision_status2() and is more efficient if the caller
- * doesn't need all information returned by svn_wc_revision_status2(). */
+ * svn_wc_revision_status3() and is more efficient if the caller
+ * doesn't need all information returned by svn_wc_revision_status3(). */
 svn_error_t *
 svn_wc__has_switched_subtrees(svn_boolean_t *is_switched,
                               svn_wc_context_t *wc_ctx,
@@ -1042,7 +1042,9 @@ svn_wc__node_get_md5_from_sha1(const svn_checksum_t **md5_checksum,
 /* Like svn_wc_get_pristine_contents2(), but keyed on the CHECKSUM
    rather than on the local absolute path of the working file.
    WRI_ABSPATH is any versioned path of the working copy in whose
-   pristine database we'll be looking for these contents.  */
+   pristine database we'll be looking for these contents.  If that
+   working copy doesn't have them, look in the shared pristine store
+   (see SVN_CONFIG_OPTION_SHARED_PRISTINES), if any.  */
 svn_error_t *
 svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
                                           svn_wc_context_t *wc_ctx,
@@ -1051,6 +1053,53 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
                                           apr_pool_t *result_pool,
                                           apr_pool_t *scratch_pool);
 
+/* Set *CONTENTS to a readable stream of the pristine text with the
+   checksum CHECKSUM in the shared pristine store configured for WC_CTX
+   (see SVN_CONFIG_OPTION_SHARED_PRISTINES), or to NULL if there is none
+   or it doesn't have these contents.
+
+   @since New in 1.15. */
+svn_error_t *
+svn_wc__get_shared_pristine_contents(svn_stream_t **contents,
+                                     svn_wc_context_t *wc_ctx,
+                                     const svn_checksum_t *checksum,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool);
+
+/* Write the text of REPOS_RELPATH at REVISION in the repository at
+   REPOS_ROOT_URL to CONTENTS, without closing it.  Used by
+   svn_wc__textbase_sync().
+
+   @since New in 1.15. */
+typedef svn_error_t *(*svn_wc__textbase_fetch_cb_t)(
+  void *baton,
+  const char *repos_root_url,
+  const char *repos_relpath,
+  svn_revnum_t revision,
+  svn_stream_t *contents,
+  svn_cancel_func_t cancel_func,
+  void *cancel_baton,
+  apr_pool_t *scratch_pool);
+
+/* If the working copy of LOCAL_ABSPATH keeps pristines on demand (as chosen
+   by SVN_CONFIG_OPTION_PRISTINES_ON_DEMAND when it was created), fetch the pristine texts of
+   LOCAL_ABSPATH and its descendants down to DEPTH that it doesn't store
+   and can't restore from their working files, using FETCH_FUNC with
+   FETCH_BATON.
+   Callers do this before operations that need the pristine texts of
+   modified files, such as reverting, diffing or updating them.
+
+   @since New in 1.15. */
+svn_error_t *
+svn_wc__textbase_sync(svn_wc_context_t *wc_ctx,
+                      const char *local_abspath,
+                      svn_depth_t depth,
+                      svn_wc__textbase_fetch_cb_t fetch_func,
+                      void *fetch_baton,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool);
+
 /* Gets an array of const char *repos_relpaths of descendants of LOCAL_ABSPATH,
  * which must be the op root of an addition, copy or move. The descendants
  * returned are at the same op_depth, but are to be deleted by the commit
@@ -2128,6 +2177,142 @@ svn_wc__translated_stream(svn_stream_t **stream,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+/* A queue of svn_wc_merge5() style merges whose text merges may run
+   concurrently in worker threads while the results still get installed
+   in the working copy strictly in the order the merges were queued. */
+typedef struct svn_wc__merge_queue_t svn_wc__merge_queue_t;
+
+/* Callback invoked by a svn_wc__merge_queue_t after the merge into
+   TARGET_ABSPATH has been installed in the working copy.  CONTENT_OUTCOME
+   and PROPS_OUTCOME are the outcomes that svn_wc_merge5() would have
+   returned; PROPS_OUTCOME is svn_wc_notify_state_unchanged if no property
+   merge was requested.  BATON is the DONE_BATON passed to
+   svn_wc__merge_queue_add(). */
+typedef svn_error_t *(*svn_wc__merge_done_func_t)(
+  void *baton,
+  const char *target_abspath,
+  enum svn_wc_merge_outcome_t content_outcome,
+  svn_wc_notify_state_t props_outcome,
+  apr_pool_t *scratch_pool);
+
+/* Create a merge queue in *QUEUE for merges into WC_CTX that runs up to
+   JOBS text merges concurrently.  If JOBS is smaller than 2 or threads are
+   not supported, all merges will be performed immediately by
+   svn_wc__merge_queue_add().  CANCEL_FUNC with CANCEL_BATON will only be
+   called from the calling thread.  Allocate the queue in RESULT_POOL. */
+svn_error_t *
+svn_wc__merge_queue_create(svn_wc__merge_queue_t **queue,
+                           svn_wc_context_t *wc_ctx,
+                           int jobs,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *result_pool);
+
+/* Schedule a merge into TARGET_ABSPATH in QUEUE.  The arguments are as
+   for svn_wc_merge5(), except that properties will be merged if and only
+   if MERGE_PROPS is set and that no conflict resolver will be invoked.
+
+   The working copy checks and the property merge happen before this
+   returns.  The text merge may be deferred, in which case the files at
+   LEFT_ABSPATH and RIGHT_ABSPATH will be copied.  Either way, once the
+   result has been installed in the working copy, DONE_FUNC gets called
+   with DONE_BATON, which must remain valid until then.  This happens
+   during this or a later call to svn_wc__merge_queue_add() or during
+   svn_wc__merge_queue_flush() at the latest.
+
+   Merges are installed in the order in which they were added.  Adding
+   a merge into a target that already has a merge pending flushes QUEUE
+   first. */
+svn_error_t *
+svn_wc__merge_queue_add(svn_wc__merge_queue_t *queue,
+                        const char *left_abspath,
+                        const char *right_abspath,
+                        const char *target_abspath,
+                        const char *left_label,
+                        const char *right_label,
+                        const char *target_label,
+                        const svn_wc_conflict_version_t *left_version,
+                        const svn_wc_conflict_version_t *right_version,
+                        svn_boolean_t dry_run,
+                        const char *diff3_cmd,
+                        const apr_array_header_t *merge_options,
+                        apr_hash_t *original_props,
+                        const apr_array_header_t *prop_diff,
+                        svn_boolean_t merge_props,
+                        svn_wc__merge_done_func_t done_func,
+                        void *done_baton,
+                        apr_pool_t *scratch_pool);
+
+/* Wait for all merges in QUEUE and install them.  If an error occurs,
+   the remaining merges are discarded.  QUEUE may be reused afterwards. */
+svn_error_t *
+svn_wc__merge_queue_flush(svn_wc__merge_queue_t *queue,
+                          apr_pool_t *scratch_pool);
+
+/* A queue of svn_wc_transmit_text_deltas3() style text transmissions
+   whose deltas may be computed concurrently in worker threads, buffered
+   in memory or temporary files, while the results still get sent through
+   the editor by the calling thread strictly in the order they were
+   queued. */
+typedef struct svn_wc__transmit_queue_t svn_wc__transmit_queue_t;
+
+/* Callback invoked by a svn_wc__transmit_queue_t after the text of
+   LOCAL_ABSPATH has been sent and its file baton been closed.
+   NEW_TEXT_BASE_MD5_CHECKSUM and NEW_TEXT_BASE_SHA1_CHECKSUM are what
+   svn_wc_transmit_text_deltas3() would have returned, allocated in the
+   RESULT_POOL given to svn_wc__transmit_queue_create().
+
+   If the transmission failed, ERR is set and both checksums are NULL.
+   The callback takes ownership of ERR and returns the error to report,
+   e.g. ERR itself.  BATON is the DONE_BATON passed to
+   svn_wc__transmit_queue_add(). */
+typedef svn_error_t *(*svn_wc__transmit_done_func_t)(
+  void *baton,
+  const char *local_abspath,
+  const svn_checksum_t *new_text_base_md5_checksum,
+  const svn_checksum_t *new_text_base_sha1_checksum,
+  svn_error_t *err,
+  apr_pool_t *scratch_pool);
+
+/* Create a transmit queue in *QUEUE that sends the texts of files in
+   WC_CTX through EDITOR, computing up to JOBS deltas concurrently.  If
+   JOBS is smaller than 2 or threads are not supported, all texts will be
+   sent immediately by svn_wc__transmit_queue_add().  CANCEL_FUNC with
+   CANCEL_BATON will only be called from the calling thread.  Allocate
+   the queue in RESULT_POOL. */
+svn_error_t *
+svn_wc__transmit_queue_create(svn_wc__transmit_queue_t **queue,
+                              svn_wc_context_t *wc_ctx,
+                              const svn_delta_editor_t *editor,
+                              int jobs,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *result_pool);
+
+/* Schedule the transmission of the text of LOCAL_ABSPATH to FILE_BATON
+   in QUEUE, as svn_wc_transmit_text_deltas3() with FULLTEXT would do it.
+   The new pristine text is always installed.
+
+   Once the file baton has been closed, DONE_FUNC gets called with
+   DONE_BATON, which must remain valid until then, as must FILE_BATON.
+   This happens during this or a later call to svn_wc__transmit_queue_add()
+   or during svn_wc__transmit_queue_flush() at the latest. */
+svn_error_t *
+svn_wc__transmit_queue_add(svn_wc__transmit_queue_t *queue,
+                           const char *local_abspath,
+                           svn_boolean_t fulltext,
+                           void *file_baton,
+                           svn_wc__transmit_done_func_t done_func,
+                           void *done_baton,
+                           apr_pool_t *scratch_pool);
+
+/* Wait for all transmissions in QUEUE and send them.  If an error occurs,
+   the remaining transmissions are discarded without sending their texts
+   or calling their DONE_FUNC. */
+svn_error_t *
+svn_wc__transmit_queue_flush(svn_wc__transmit_queue_t *queue,
+                             apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
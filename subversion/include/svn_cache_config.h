@@ -83,6 +83,79 @@ svn_cache_config_get(void);
 void
 svn_cache_config_set(const svn_cache_config_t *settings);
 
+/** Cache resource settings, extended version of #svn_cache_config_t.
+   The first members are the same as in #svn_cache_config_t.
+
+   @note Do not extend this data structure as this would break binary
+         compatibility.
+
+   @since New in 1.15.
+ */
+typedef struct svn_cache_config2_t
+{
+  /** total cache size in bytes. Please note that this is only soft limit
+     to the total application memory usage and will be exceeded due to
+     temporary objects and other program state.
+     May be 0, resulting in default caching code being used. */
+  apr_uint64_t cache_size;
+
+  /** maximum number of files kept open */
+  apr_size_t file_handle_count;
+
+  /** is this application guaranteed to be single-threaded? */
+  svn_boolean_t single_threaded;
+
+  /** If set, a full cache will only accept new items that have been
+     requested more often than the items they would replace.  This keeps
+     large, one-time scans like 'svnadmin dump' from flushing the data
+     used by everybody else. */
+  svn_boolean_t admission_filter;
+
+  /** If set, allocate the cache in shared memory such that all processes
+     forked after its creation use the same cache.  Pre-forking servers
+     must call svn_cache_config_preallocate() before forking their worker
+     processes.  Ignored where not supported. */
+  svn_boolean_t shared_memory;
+
+  /* DON'T add new members here.  Bump struct and API version instead. */
+} svn_cache_config2_t;
+
+/** Get the current cache configuration. If it has not been set,
+   this function will return the default settings.
+
+   @since New in 1.15.
+ */
+const svn_cache_config2_t *
+svn_cache_config2_get(void);
+
+/** Like svn_cache_config_set() but also sets the settings not available
+   in #svn_cache_config_t.
+
+   This function is not thread-safe. Therefore, it should be called
+   from the processes' initialization code only.
+
+   @since New in 1.15.
+ */
+void
+svn_cache_config2_set(const svn_cache_config2_t *settings);
+
+/** Allocate the process-global cache according to the current
+   configuration, unless that already happened.  Servers using the
+   #svn_cache_config2_t.shared_memory option must call this before
+   forking their worker processes.  Otherwise, each worker would create
+   its own cache upon first use.
+
+   Failure to create the cache is not an error; one will merely read all
+   data from disk.
+
+   This function is not thread-safe. Therefore, it should be called
+   from the processes' initialization code only.
+
+   @since New in 1.15.
+ */
+void
+svn_cache_config_preallocate(void);
+
 /** @} */
 
 /** @} */
@@ -112,6 +112,16 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS      "http-max-connections"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS     "http-chunked-requests"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_HTTP_ENABLE_HTTP2         "http-enable-http2"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_HTTP_CONTENT_CACHE_DIR    "http-content-cache-dir"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_HTTP_CONTENT_CACHE_SIZE   "http-content-cache-size"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_HTTP_REUSE_CONNECTIONS    "http-reuse-connections"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_SVN_USE_TLS               "svn-use-tls"
 
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SERF_LOG_COMPONENTS       "serf-log-components"
@@ -161,6 +171,12 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_MEMORY_CACHE_SIZE         "memory-cache-size"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_DIFF_IGNORE_CONTENT_TYPE  "diff-ignore-content-type"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_MERGE_JOBS                "merge-jobs"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_EXTERNALS_JOBS            "externals-jobs"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_COMMIT_JOBS               "commit-jobs"
 #define SVN_CONFIG_SECTION_TUNNELS              "tunnels"
 #define SVN_CONFIG_SECTION_AUTO_PROPS           "auto-props"
 /** @since New in 1.8. */
@@ -171,6 +187,20 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_SQLITE_EXCLUSIVE_CLIENTS  "exclusive-locking-clients"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SQLITE_BUSY_TIMEOUT       "busy-timeout"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_INSTALL_JOBS              "install-jobs"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_FSMONITOR                 "fsmonitor"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_STATUS_JOBS               "status-jobs"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_COMPRESS_PRISTINES        "compress-pristines"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_SHARED_PRISTINES          "shared-pristines"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_PRISTINES_ON_DEMAND       "pristines-on-demand"
+/** @since New in 1.15. */
+#define SVN_CONFIG_OPTION_CHECKSUM_CACHE            "checksum-cache"
 /** @} */
 
 /** @name Repository conf directory configuration files strings
@@ -235,6 +265,8 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_DEFAULT_OPTION_STORE_SSL_CLIENT_CERT_PP_PLAINTEXT \
                                                              SVN_CONFIG_ASK
 #define SVN_CONFIG_DEFAULT_OPTION_HTTP_MAX_CONNECTIONS       4
+/** @since New in 1.15. */
+#define SVN_CONFIG_DEFAULT_OPTION_HTTP_CONTENT_CACHE_SIZE    1024
 
 /** Read configuration information from the standard sources and merge it
  * into the hash @a *cfg_hash.  If @a config_dir is not NULL it specifies a
@@ -526,7 +526,12 @@ svn_txdelta_apply(svn_stream_t *source,
  *
  * @since New in 1.7.  Since 1.10, @a svndiff_version can be 2 for the
  * svndiff2 format.  @a compression_level is currently ignored if
- * @a svndiff_version is set to 2.
+ * @a svndiff_version is set to 2.  Since 1.15, @a svndiff_version can be
+ * 3 for the Zstandard based svndiff3 format, in which case
+ * @a compression_level is used as the Zstandard compression level
+ * (#SVN_DELTA_COMPRESSION_LEVEL_NONE selecting the library default).
+ * svndiff3 is only available if Subversion has been built with Zstandard
+ * support; otherwise the handler returns #SVN_ERR_UNSUPPORTED_FEATURE.
  */
 void
 svn_txdelta_to_svndiff3(svn_txdelta_window_handler_t *handler,
@@ -1527,6 +1532,30 @@ typedef svn_error_t *(*svn_file_rev_handler_t)(
   apr_array_header_t *prop_diffs,
   apr_pool_t *pool);
 
+/**
+ * The callback invoked by blame computations, such as svn_ra_blame() and
+ * svn_repos_blame(), for each run of lines of a file that were last
+ * changed in the same revision.
+ *
+ * @a baton is provided by the caller.  The @a line_count lines starting at
+ * the zero-based line @a start_line were last changed in @a revision, whose
+ * revision properties are @a rev_props.  @a revision is
+ * #SVN_INVALID_REVNUM and @a rev_props is @c NULL for lines that already
+ * existed before the start of the blamed range.  Runs are reported in
+ * order, cover the whole file and don't overlap.
+ *
+ * @a pool may be used for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *(*svn_blame_run_receiver_t)(
+  void *baton,
+  apr_int64_t start_line,
+  apr_int64_t line_count,
+  svn_revnum_t revision,
+  apr_hash_t *rev_props,
+  apr_pool_t *pool);
+
 /**
  * The old file rev handler interface.
  *
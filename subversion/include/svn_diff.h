@@ -455,6 +455,22 @@ typedef enum svn_diff_file_ignore_space_t
   svn_diff_file_ignore_space_all
 } svn_diff_file_ignore_space_t;
 
+/** The algorithm used to find the differences between files.
+ *
+ * @since New in 1.15.
+ */
+typedef enum svn_diff_file_algorithm_t
+{
+  /** The default algorithm, which finds a minimal set of changes. */
+  svn_diff_file_algorithm_myers,
+
+  /** Histogram diff.  Lines that occur rarely in both files are matched
+   * up first.  This tends to be faster on large, heavily edited files
+   * and to produce hunks that follow the structure of the text more
+   * closely, at the expense of sometimes not being minimal. */
+  svn_diff_file_algorithm_histogram
+} svn_diff_file_algorithm_t;
+
 /** Options to control the behaviour of the file diff routines.
  *
  * @since New in 1.4.
@@ -487,6 +503,21 @@ typedef struct svn_diff_file_options_t
    *
    * @since New in 1.9 */
   int context_size;
+
+  /** The algorithm to use for comparing the files.  The default is
+   * @c svn_diff_file_algorithm_myers.
+   *
+   * @since New in 1.15. */
+  svn_diff_file_algorithm_t algorithm;
+
+  /** If positive, svn_diff_file_diff_2() compares the files in windows of
+   * at most this many lines each, once their identical prefix and suffix
+   * have been skipped.  This bounds the memory needed to diff arbitrarily
+   * large files, but the resulting diff may not be minimal.  The
+   * default is 0, which compares the files in one go.
+   *
+   * @since New in 1.15. */
+  apr_off_t window_lines;
 } svn_diff_file_options_t;
 
 /** Allocate a @c svn_diff_file_options_t structure in @a pool, initializing
@@ -510,6 +541,8 @@ svn_diff_file_options_create(apr_pool_t *pool);
  * - --ignore-eol-style
  * - --show-c-function, -p @since New in 1.5.
  * - --context, -U ARG @since New in 1.9.
+ * - --histogram @since New in 1.15.
+ * - --window-lines ARG @since New in 1.15.
  * - --unified, -u (for compatibility, does nothing).
  */
 svn_error_t *
@@ -576,6 +576,11 @@ SVN_ERROR_START
              SVN_ERR_WC_CATEGORY_START + 41,
              "Duplicate targets in svn:externals property")
 
+  /** @since New in 1.15. */
+  SVN_ERRDEF(SVN_ERR_WC_PRISTINE_DEHYDRATED,
+             SVN_ERR_WC_CATEGORY_START + 42,
+             "The pristine text of a file is not kept in the working copy")
+
   /* fs errors */
 
   SVN_ERRDEF(SVN_ERR_FS_GENERAL,
@@ -1502,6 +1507,16 @@ SVN_ERROR_START
              SVN_ERR_MISC_CATEGORY_START + 47,
              "Could not canonicalize path or URI")
 
+  /** @since New in 1.15. */
+  SVN_ERRDEF(SVN_ERR_ZSTD_COMPRESSION_FAILED,
+             SVN_ERR_MISC_CATEGORY_START + 48,
+             "Zstandard compression failed")
+
+  /** @since New in 1.15. */
+  SVN_ERRDEF(SVN_ERR_ZSTD_DECOMPRESSION_FAILED,
+             SVN_ERR_MISC_CATEGORY_START + 49,
+             "Zstandard decompression failed")
+
   /* command-line client errors */
 
   SVN_ERRDEF(SVN_ERR_CL_ARG_PARSING_ERROR,
@@ -1607,6 +1622,16 @@ SVN_ERROR_START
              SVN_ERR_RA_SVN_CATEGORY_START + 10,
              "Server response too long")
 
+  /** @since New in 1.15  */
+  SVN_ERRDEF(SVN_ERR_RA_SVN_SERVER_BUSY,
+             SVN_ERR_RA_SVN_CATEGORY_START + 11,
+             "Server is too busy to accept the connection")
+
+  /** @since New in 1.15  */
+  SVN_ERRDEF(SVN_ERR_RA_SVN_TLS_FAILED,
+             SVN_ERR_RA_SVN_CATEGORY_START + 12,
+             "TLS connection failed")
+
   /* libsvn_auth errors */
 
        /* this error can be used when an auth provider doesn't have
@@ -140,6 +140,18 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_CACHE_NODEPROPS      "fsfs-cache-nodeprops"
 
+/** Weight of a FSFS repository's data in the shared cache, in percent
+ * of the normal weight, as a decimal string between "1" and "10000".
+ *
+ * All repositories served by a process compete for the same cache
+ * memory.  Giving a rarely used repository a low weight lets its data
+ * be evicted before that of busier ones, while a weight above "100"
+ * protects the data of an important repository.  Defaults to "100".
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSFS_CACHE_WEIGHT          "fsfs-cache-weight"
+
 /** Enable / disable the FSFS format 7 "block read" feature.
  *
  * @since New in 1.9.
@@ -166,6 +178,18 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_LOG_ADDRESSING       "fsfs-log-addressing"
 
+/** Enable / disable the persistent DAG cache snapshot for a FSX repository.
+ *
+ * If enabled, the path@revision to node lookups performed by this
+ * filesystem instance will be periodically written to disk and re-used by
+ * future instances opened with the same option set.  That skips most of
+ * the directory tree walks, e.g. after server restarts.  Disabled by
+ * default.
+ *
+ * @since New in 1.15.
+ */
+#define SVN_FS_CONFIG_FSX_DAG_CACHE_SNAPSHOT    "fsx-dag-cache-snapshot"
+
 /* Note to maintainers: if you add further SVN_FS_CONFIG_FSFS_CACHE_* knobs,
    update fs_fs.c:verify_as_revision_before_current_plus_plus(). */
 
@@ -1735,6 +1759,66 @@ svn_fs_paths_changed3(svn_fs_path_change_iterator_t **iterator,
                       apr_pool_t *result_pool,
                       apr_pool_t *scratch_pool);
 
+/** Same as svn_fs_paths_changed3() but only report changes to @a path and
+ * the nodes below it.  If @a include_parents is set, also report changes
+ * to the parent directories of @a path.
+ *
+ * Back-ends may skip changes to other paths while reading the changed
+ * paths list instead of constructing all change objects first.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_paths_changed_below(svn_fs_path_change_iterator_t **iterator,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           svn_boolean_t include_parents,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+/** The type of a callback function used with svn_fs_paths_changed_range().
+ *
+ * @a iterator gives access to the changed paths in @a revision, just like
+ * the one returned by svn_fs_paths_changed3() for the respective revision
+ * root.  It becomes invalid once the callback returns.
+ *
+ * @a baton is the callback baton.  Use @a scratch_pool for temporary
+ * allocations.
+ *
+ * @since New in 1.15.
+ */
+typedef svn_error_t *
+(*svn_fs_changes_receiver_t)(void *baton,
+                             svn_revnum_t revision,
+                             svn_fs_path_change_iterator_t *iterator,
+                             apr_pool_t *scratch_pool);
+
+/** Report the changed paths of all revisions from @a start to @a end,
+ * inclusive, in filesystem @a fs by invoking @a receiver with
+ * @a receiver_baton once per revision.  If @a start is larger than
+ * @a end, the revisions will be reported in descending order, otherwise
+ * in ascending order.
+ *
+ * This is equivalent to calling svn_fs_paths_changed3() for each revision
+ * root but back-ends may read the changed paths lists of many revisions
+ * in a single pass.  FSFS, for instance, keeps the pack file open while
+ * reading the lists of all revisions within a shard.
+ *
+ * The @a cancel_func and @a cancel_baton will be called between revisions.
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_paths_changed_range(svn_fs_t *fs,
+                           svn_revnum_t start,
+                           svn_revnum_t end,
+                           svn_fs_changes_receiver_t receiver,
+                           void *receiver_baton,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool);
+
 /** Same as svn_fs_paths_changed3() but returning all changes in a single,
  * large data structure and using a single pool for all allocations.
  *
@@ -2339,6 +2423,90 @@ svn_fs_dir_optimal_order(apr_array_header_t **ordered_p,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/** Node information about a directory entry, as returned by
+ * #svn_fs_dir_entries_info.
+ *
+ * @note To allow for extending this structure in future releases,
+ * only the filesystem library may allocate instances of it.
+ *
+ * @since New in 1.15.
+ */
+typedef struct svn_fs_dirent_info_t
+{
+  /** The name of this directory entry.  */
+  const char *name;
+
+  /** The node kind. */
+  svn_node_kind_t kind;
+
+  /** The revision in which this node was last changed. */
+  svn_revnum_t created_rev;
+
+  /** The file size or #SVN_INVALID_FILESIZE for directories. */
+  svn_filesize_t size;
+
+  /** Whether this node has any properties. */
+  svn_boolean_t has_props;
+
+  /** All properties of this node, mapping names to <tt>svn_string_t
+   * *</tt> values, if requested.  @c NULL otherwise. */
+  apr_hash_t *props;
+
+  /** The file contents checksum, if requested and available.  @c NULL
+   * for directories. */
+  svn_checksum_t *checksum;
+
+} svn_fs_dirent_info_t;
+
+/** Set @a *entries_p to a newly allocated APR array of
+ * <tt>svn_fs_dirent_info_t *</tt> describing all entries of the directory
+ * at @a path in @a root.  This is equivalent to calling
+ * #svn_fs_check_path, #svn_fs_node_created_rev, #svn_fs_file_length and
+ * #svn_fs_node_has_props for each entry but lets the backend read the
+ * node data in the order it is stored.  The array is in the same order
+ * as #svn_fs_dir_optimal_order would return.
+ *
+ * If @a include_props is set, fill in the @c props member as per
+ * #svn_fs_node_proplist.  If @a include_checksums is set, fill in the
+ * @c checksum member for files as per #svn_fs_file_checksum with
+ * @a checksum_kind, not forcing its calculation.
+ *
+ * Allocate the result in @a result_pool and use @a scratch_pool for
+ * temporaries.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_dir_entries_info(apr_array_header_t **entries_p,
+                        svn_fs_root_t *root,
+                        const char *path,
+                        svn_boolean_t include_props,
+                        svn_boolean_t include_checksums,
+                        svn_checksum_kind_t checksum_kind,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool);
+
+/** Tell the filesystem that the caller is about to walk the whole tree
+ * at @a path in @a root, e.g. to export or check it out.  Back-ends may
+ * use this to read the respective node and directory data in storage
+ * order ahead of time, so that the subsequent walk is served from caches.
+ *
+ * This is a mere performance hint and has no effect on the results of
+ * any other function.  Back-ends that don't support it do nothing.
+ * The amount of data prefetched is limited by the configured cache size.
+ *
+ * Call @a cancel_func with @a cancel_baton regularly.  Use @a scratch_pool
+ * for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_prefetch_tree(svn_fs_root_t *root,
+                     const char *path,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool);
+
 /** Create a new directory named @a path in @a root.  The new directory has
  * no entries, and no properties.  @a root must be the root of a transaction,
  * not a revision.
@@ -2540,6 +2708,28 @@ svn_fs_try_process_file_contents(svn_boolean_t *success,
                                  void* baton,
                                  apr_pool_t *pool);
 
+/** Locate the contents of the file @a path in @a root within the storage
+ * of the filesystem, so that they can be sent without being read through
+ * a stream first, e.g. via sendfile().
+ *
+ * If the contents are stored as a contiguous, unencoded byte range, set
+ * @a *file to an open file allocated in @a result_pool, @a *offset to
+ * the position of the first byte in that file and @a *length to the
+ * number of bytes.  Otherwise, and for backends that don't support
+ * this, set @a *file to @c NULL.  The caller must not write to
+ * @a *file.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_file_contents_range(apr_file_t **file,
+                           apr_off_t *offset,
+                           svn_filesize_t *length,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
 /** Create a new file named @a path in @a root.  The file's initial contents
  * are the empty string, and it has no properties.  @a root must be the
  * root of a transaction, not a revision.
@@ -3301,11 +3491,38 @@ typedef svn_error_t *(*svn_fs_pack_notify_t)(void *baton,
                                              apr_pool_t *pool);
 
 /**
- * Possibly update the filesystem located in the directory @a path
+ * Possibly update the filesystem located in the directory @a db_path
  * to use disk space more efficiently.
  *
+ * If @a jobs is larger than 1, the backend may build the packed data for
+ * up to @a jobs shards concurrently.  Shards will still be switched over
+ * to their packed form in ascending order, i.e. the repository will be
+ * consistent at all times and notifications will be sent in the same
+ * order as for a sequential pack.  Values smaller than 1 are treated as 1.
+ * Backends that don't support concurrent packing silently ignore @a jobs.
+ *
+ * If given, @a notify_func will be called with @a notify_baton to report
+ * progress.  @a cancel_func and @a cancel_baton are only ever invoked
+ * from the calling thread.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_pack2(const char *db_path,
+             int jobs,
+             svn_fs_pack_notify_t notify_func,
+             void *notify_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *pool);
+
+/**
+ * Like svn_fs_pack2(), but with @a jobs always set to 1.
+ *
  * @since New in 1.6.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_fs_pack(const char *db_path,
             svn_fs_pack_notify_t notify_func,
@@ -3352,11 +3569,36 @@ svn_fs_pack(const char *db_path,
  * a single revision in #svn_fs_verify_root.  This function is meant for
  * global checks or tests that require an expensive context setup.
  *
- * @see svn_repos_verify_fs2()
+ * If @a jobs is larger than 1, the backend may check independent parts
+ * of the repository, e.g. pack files, concurrently in up to @a jobs
+ * threads.  Values smaller than 1 are treated as 1.  Backends that don't
+ * support concurrent verification silently ignore @a jobs.  Notifications
+ * and cancellation checks will only be run in the calling thread.
+ *
+ * @see svn_repos_verify_fs4()
  * @see svn_fs_verify_root()
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_fs_verify2(const char *path,
+               apr_hash_t *fs_config,
+               svn_revnum_t start,
+               svn_revnum_t end,
+               int jobs,
+               svn_fs_progress_notify_func_t notify_func,
+               void *notify_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_fs_verify2(), but with @a jobs always set to 1.
+ *
  * @since New in 1.8.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_fs_verify(const char *path,
               apr_hash_t *fs_config,
@@ -37,6 +37,7 @@
 #include "svn_types.h"
 #include "svn_string.h"
 #include "svn_delta.h"
+#include "svn_diff.h"
 #include "svn_auth.h"
 #include "svn_mergeinfo.h"
 
@@ -1747,6 +1748,30 @@ svn_ra_stat(svn_ra_session_t *session,
             svn_dirent_t **dirent,
             apr_pool_t *pool);
 
+/**
+ * Like svn_ra_stat(), but for all of @a paths (an array of <tt>const
+ * char *</tt> paths relative to the @a session's URL) at once.
+ *
+ * Set @a *dirents to a hash mapping each path that exists in @a revision
+ * to its @c svn_dirent_t.  Paths that don't exist are left out.
+ *
+ * RA layers may have several of these requests in flight at the same
+ * time, which makes this much faster than calling svn_ra_stat() for each
+ * path over high-latency connections.
+ *
+ * Allocate @a *dirents in @a result_pool.  Use @a scratch_pool for
+ * temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_stat_many(svn_ra_session_t *session,
+                 apr_hash_t **dirents,
+                 const apr_array_header_t *paths,
+                 svn_revnum_t revision,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool);
+
 
 /**
  * Set @a *uuid to the repository's UUID, allocated in @a pool.
@@ -1898,6 +1923,35 @@ svn_ra_get_file_revs2(svn_ra_session_t *session,
                       void *handler_baton,
                       apr_pool_t *pool);
 
+/**
+ * Let the server compute the blame of the file @a path (relative to the
+ * URL of @a session) as seen in revision @a end, over the revisions
+ * @a start to @a end, and invoke @a receiver with @a receiver_baton for
+ * each run of lines that were last changed in the same revision.  Lines
+ * that were last changed before @a start are reported with
+ * #SVN_INVALID_REVNUM.  Lines are compared with @a diff_options, which
+ * may be @c NULL for the defaults.  See svn_repos_blame().
+ *
+ * This only transfers the blame instead of every revision of the file,
+ * so callers should prefer it over svn_ra_get_file_revs2() when they
+ * don't need the texts.  Return #SVN_ERR_UNSUPPORTED_FEATURE if the
+ * server doesn't have the #SVN_RA_CAPABILITY_BLAME capability, or if
+ * @a start is younger than @a end.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_ra_blame(svn_ra_session_t *session,
+             const char *path,
+             svn_revnum_t start,
+             svn_revnum_t end,
+             const svn_diff_file_options_t *diff_options,
+             svn_blame_run_receiver_t receiver,
+             void *receiver_baton,
+             apr_pool_t *scratch_pool);
+
 /**
  * Similar to svn_ra_get_file_revs2(), but with @a include_merged_revisions
  * set to FALSE.
@@ -2265,6 +2319,13 @@ svn_ra_has_capability(svn_ra_session_t *session,
  */
 #define SVN_RA_CAPABILITY_LIST "list"
 
+/**
+ * The capability of a server to compute blame itself, see svn_ra_blame().
+ *
+ * @since New in 1.15.
+ */
+#define SVN_RA_CAPABILITY_BLAME "blame"
+
 
 /*       *** PLEASE READ THIS IF YOU ADD A NEW CAPABILITY ***
  *
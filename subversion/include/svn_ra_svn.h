@@ -50,6 +50,7 @@ extern "C" {
 #define SVN_RA_SVN_CAP_EDIT_PIPELINE "edit-pipeline"
 #define SVN_RA_SVN_CAP_SVNDIFF1 "svndiff1"
 #define SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED "accepts-svndiff2"
+#define SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED "accepts-svndiff3"
 #define SVN_RA_SVN_CAP_ABSENT_ENTRIES "absent-entries"
 /* maps to SVN_RA_CAPABILITY_COMMIT_REVPROPS: */
 #define SVN_RA_SVN_CAP_COMMIT_REVPROPS "commit-revprops"
@@ -71,6 +72,12 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/* server understands the batch command; new in 1.15 */
+#define SVN_RA_SVN_CAP_COMMAND_BATCH "command-batch"
+/* maps to SVN_RA_CAPABILITY_BLAME; new in 1.15 */
+#define SVN_RA_SVN_CAP_BLAME "blame"
+/* server offers TLS, client starts it; new in 1.15 */
+#define SVN_RA_SVN_CAP_STARTTLS "starttls"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
@@ -35,6 +35,7 @@
 #include "svn_types.h"
 #include "svn_string.h"
 #include "svn_delta.h"
+#include "svn_diff.h"
 #include "svn_fs.h"
 #include "svn_io.h"
 #include "svn_mergeinfo.h"
@@ -730,8 +731,57 @@ svn_repos_hotcopy(const char *src_path,
  * Possibly update the repository, @a repos, to use a more efficient
  * filesystem representation.  Use @a pool for allocations.
  *
+ * If @a jobs is larger than 1, allow the backend to process up to that
+ * many shards concurrently.  See svn_fs_pack2() for details.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_fs_pack3(svn_repos_t *repos,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Load frequently used data of @a repos into the in-memory caches of
+ * the filesystem layer, e.g. after a server restart.
+ *
+ * Read the revision properties and root directories of the latest
+ * @a recent_revisions revisions.  Then prefetch the trees below all
+ * paths in @a paths (const char *, may be @c NULL) in the youngest
+ * revision using svn_fs_prefetch_tree().  Paths that don't exist in
+ * that revision are skipped.
+ *
+ * If @a pause is positive, sleep that long before each step to limit
+ * the I/O load caused by this function.  Call @a cancel_func with
+ * @a cancel_baton regularly.  Use @a scratch_pool for temporary
+ * allocations.
+ *
+ * This is a mere performance optimization.  It is only useful if the
+ * caches are shared with whatever process or thread serves later
+ * requests.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_warm_cache(svn_repos_t *repos,
+                     const apr_array_header_t *paths,
+                     int recent_revisions,
+                     apr_interval_time_t pause,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool);
+
+/**
+ * Similar to svn_repos_fs_pack3(), but with @a jobs always set to 1.
+ *
  * @since New in 1.7.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_fs_pack2(svn_repos_t *repos,
                    svn_repos_notify_func_t notify_func,
@@ -991,6 +1041,12 @@ svn_repos_post_unlock_hook(svn_repos_t *repos,
  * file does not define any environment variables, hooks will run in
  * an empty environment.
  *
+ * The "[async-hooks]" section of the configuration file may enable the
+ * post-commit and post-revprop-change hooks to run in the background, in
+ * which case their failures are not reported to the caller.  Its
+ * "[pre-commit-checks]" section configures commit checks that run within
+ * the current process before the pre-commit hook.  (Since 1.15.)
+ *
  * @since New in 1.8.
  */
 svn_error_t *
@@ -2199,6 +2255,48 @@ svn_repos_get_logs5(svn_repos_t *repos,
                     void *revision_receiver_baton,
                     apr_pool_t *scratch_pool);
 
+/**
+ * Like svn_repos_get_logs5(), but deliver the log one page at a time.
+ *
+ * Invoke the receivers for at most @a limit revisions, which must be
+ * greater than zero, walking backwards from @a start towards @a end.
+ * @a start must not be older than @a end.  Merged revisions are not
+ * supported.
+ *
+ * If more revisions remain, set @a *next_cursor to an opaque string,
+ * allocated in @a result_pool, that describes where the history walk
+ * stopped.  Otherwise, set it to @c NULL.  Pass a cursor as @a cursor in
+ * a subsequent call, with the same @a end, @a limit and
+ * @a strict_node_history, to get the next page.  The walk then resumes at
+ * the recorded locations, and @a paths and @a start are ignored.  Unlike
+ * repeating the svn_repos_get_logs5() query with a lower @a start, this
+ * does not re-trace the history of @a paths, which may have been moved
+ * since.
+ *
+ * All other parameters are as for svn_repos_get_logs5().  Use
+ * @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_get_logs_page(const char **next_cursor,
+                        svn_repos_t *repos,
+                        const apr_array_header_t *paths,
+                        svn_revnum_t start,
+                        svn_revnum_t end,
+                        int limit,
+                        const char *cursor,
+                        svn_boolean_t strict_node_history,
+                        const apr_array_header_t *revprops,
+                        svn_repos_authz_func_t authz_read_func,
+                        void *authz_read_baton,
+                        svn_repos_path_change_receiver_t path_change_receiver,
+                        void *path_change_receiver_baton,
+                        svn_repos_log_entry_receiver_t revision_receiver,
+                        void *revision_receiver_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool);
+
 /**
  * Similar to svn_repos_get_logs5 but using a #svn_log_entry_receiver_t
  * @a receiver to receive revision properties and changed paths through a
@@ -2428,6 +2526,39 @@ svn_repos_get_file_revs2(svn_repos_t *repos,
                          void *handler_baton,
                          apr_pool_t *pool);
 
+/**
+ * Compute the blame of the file @a path in @a repos as seen in revision
+ * @a end, over the revisions @a start to @a end, and report it to
+ * @a receiver with @a receiver_baton as runs of lines.  Lines that were
+ * last changed before @a start are reported with #SVN_INVALID_REVNUM.
+ * Invalid revision numbers mean the youngest revision.
+ *
+ * This does what a client does with the file revisions reported by
+ * svn_repos_get_file_revs2(), without sending the texts anywhere.  Lines
+ * are compared with @a diff_options, which may be @c NULL for the
+ * defaults.  @a authz_read_func and @a authz_read_baton are used as with
+ * svn_repos_get_file_revs2().
+ *
+ * Return #SVN_ERR_UNSUPPORTED_FEATURE if @a start is younger than
+ * @a end.  Use @a cancel_func and @a cancel_baton to check for
+ * cancellation, and @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_blame(svn_repos_t *repos,
+                const char *path,
+                svn_revnum_t start,
+                svn_revnum_t end,
+                const svn_diff_file_options_t *diff_options,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_blame_run_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool);
+
 /**
  * Similar to #svn_file_rev_handler_t, but without the @a
  * result_of_merge parameter.
@@ -3138,10 +3269,10 @@ enum svn_repos_load_uuid
   svn_repos_load_uuid_force
 };
 
-/** Callback type for use with svn_repos_verify_fs3().  @a revision
+/** Callback type for use with svn_repos_verify_fs4().  @a revision
  * and @a verify_err are the details of a single verification failure
- * that occurred during the svn_repos_verify_fs3() call.  @a baton is
- * the same baton given to svn_repos_verify_fs3().  @a scratch_pool is
+ * that occurred during the svn_repos_verify_fs4() call.  @a baton is
+ * the same baton given to svn_repos_verify_fs4().  @a scratch_pool is
  * provided for the convenience of the implementor, who should not
  * expect it to live longer than a single callback call.
  *
@@ -3151,7 +3282,7 @@ enum svn_repos_load_uuid
  * should also call svn_error_dup() for @a verify_err.  Implementors of this
  * callback are forbidden to call svn_error_clear() for @a verify_err.
  *
- * @see svn_repos_verify_fs3
+ * @see svn_repos_verify_fs4
  *
  * @since New in 1.9.
  */
@@ -3180,6 +3311,16 @@ typedef svn_error_t *(*svn_repos_verify_callback_t)(void *baton,
  * file context reconstruction and verification.  For FSFS format 7+ and
  * FSX, this allows for a very fast check against external corruption.
  *
+ * If @a jobs is larger than 1, verify up to @a jobs revisions concurrently,
+ * each in a separate thread using its own filesystem instance.  All
+ * notifications and invocations of @a verify_callback will still happen
+ * in the calling thread and in the same order as for a sequential run.
+ * The backend-specific metadata checks may run concurrently as well, see
+ * svn_fs_verify2().  This makes @a metadata_only checks of large, packed
+ * FSFS repositories scale with the number of cores.
+ * Values smaller than 1 are treated as 1.  @a jobs is ignored if threads
+ * are not supported or the backend is BDB.
+ *
  * If @a verify_callback is not @c NULL, call it with @a verify_baton upon
  * receiving an FS-specific structure failure or a revision verification
  * failure.  Set @c revision callback argument to #SVN_INVALID_REVNUM or
@@ -3228,8 +3369,30 @@ typedef svn_error_t *(*svn_repos_verify_callback_t)(void *baton,
  *
  * @see svn_repos_verify_callback_t
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_verify_fs4(svn_repos_t *repos,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     svn_boolean_t check_normalization,
+                     svn_boolean_t metadata_only,
+                     int jobs,
+                     svn_repos_notify_func_t notify_func,
+                     void *notify_baton,
+                     svn_repos_verify_callback_t verify_callback,
+                     void *verify_baton,
+                     svn_cancel_func_t cancel,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_repos_verify_fs4(), but with @a jobs always set to 1.
+ *
  * @since New in 1.9.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_verify_fs3(svn_repos_t *repos,
                      svn_revnum_t start_rev,
@@ -3287,7 +3450,7 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * Dump the contents of the filesystem within already-open @a repos into
  * writable @a dumpstream.  If @a dumpstream is
  * @c NULL, this is effectively a primitive verify.  It is not complete,
- * however; see instead svn_repos_verify_fs3().
+ * however; see instead svn_repos_verify_fs4().
  *
  * Begin at revision @a start_rev, and dump every revision up through
  * @a end_rev.  If @a start_rev is #SVN_INVALID_REVNUM, start at revision
@@ -3310,6 +3473,14 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * If @a include_changes is @c TRUE, output the revision contents, i.e.
  * tree and node changes.
  *
+ * If @a jobs is larger than 1, prepare the contents of up to @a jobs
+ * revisions concurrently, using separate filesystem instances.  The
+ * output is the same as for a sequential dump; all notifications,
+ * cancellation checks and writes to @a dumpstream still happen in the
+ * calling thread, but @a filter_func must support being called from
+ * multiple threads at the same time.  This parameter is ignored for
+ * BDB repositories and if APR has no thread support.
+ *
  * If @a notify_func is not null, then call it with @a notify_baton and
  * with a notification structure in which the fields are set as follows.
  * (For a warning or error notification that does not apply to a specific
@@ -3344,8 +3515,33 @@ svn_repos_verify_fs(svn_repos_t *repos,
  *
  * Use @a scratch_pool for temporary allocation.
  *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_dump_fs5(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   int jobs,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/**
+ * Like svn_repos_dump_fs5(), but with @a jobs always set to 1.
+ *
  * @since New in 1.10.
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_stream_t *stream,
@@ -4310,6 +4506,32 @@ svn_repos_authz_check_access(svn_authz_t *authz,
                              svn_boolean_t *access_granted,
                              apr_pool_t *pool);
 
+/**
+ * Like svn_repos_authz_check_access() but check the @a required_access
+ * for all paths in @a paths (an array of <tt>const char *</tt>) at once.
+ * Set the elements of @a access_granted, which must have room for
+ * @a paths->nelts entries, to indicate whether the respective path is
+ * accessible.
+ *
+ * None of the @a paths may be NULL.  They may be given in any order but
+ * checking is fastest if they are sorted, e.g. by svn_sort_compare_paths(),
+ * as the shared parts of neighboring paths will then be evaluated only
+ * once.  If @a user has recursive access to the longest common ancestor
+ * of all @a paths, the individual paths will not be checked at all.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.15.
+ */
+svn_error_t *
+svn_repos_authz_check_access_many(svn_authz_t *authz,
+                                  const char *repos_name,
+                                  const apr_array_header_t *paths,
+                                  const char *user,
+                                  svn_repos_authz_access_t required_access,
+                                  svn_boolean_t *access_granted,
+                                  apr_pool_t *scratch_pool);
+
 
 
 /** Revision Access Levels
@@ -8176,7 +8176,11 @@ typedef struct svn_wc_revision_status_t
  * status.
  *
  * Set @a (*result_p)->modified to indicate whether any item is locally
- * modified.
+ * modified.  Files whose size and timestamp match the recorded values are
+ * considered unmodified.  If @a skip_content_check is TRUE, any file whose
+ * size or timestamp differs is considered modified, without comparing its
+ * contents to the pristine version.  This is faster, but reports files
+ * that have merely been touched as modified, too.
  *
  * If @a cancel_func is non-NULL, call it with @a cancel_baton to determine
  * if the client has canceled the operation.
@@ -8186,8 +8190,27 @@ typedef struct svn_wc_revision_status_t
  *
  * @a wc_ctx should be a valid working copy context.
  *
+ * @since New in 1.15
+ */
+svn_error_t *
+svn_wc_revision_status3(svn_wc_revision_status_t **result_p,
+                        svn_wc_context_t *wc_ctx,
+                        const char *local_abspath,
+                        const char *trail_url,
+                        svn_boolean_t committed,
+                        svn_boolean_t skip_content_check,
+                        svn_cancel_func_t cancel_func,
+                        void *cancel_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool);
+
+/** Similar to svn_wc_revision_status3(), but with @a skip_content_check
+ * always set to FALSE.
+ *
  * @since New in 1.7
+ * @deprecated Provided for backward compatibility with the 1.14 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_wc_revision_status2(svn_wc_revision_status_t **result_p,
                         svn_wc_context_t *wc_ctx,
@@ -8200,8 +8223,8 @@ svn_wc_revision_status2(svn_wc_revision_status_t **result_p,
                         apr_pool_t *scratch_pool);
 
 
-/** Similar to svn_wc_revision_status2(), but with a (possibly) local
- * path and no wc_ctx parameter.
+/** Similar to svn_wc_revision_status3(), but with a (possibly) local
+ * path, no wc_ctx parameter and @a skip_content_check set to FALSE.
  *
  * @since New in 1.4.
  * @deprecated Provided for backward compatibility with the 1.6 API.
@@ -265,9 +265,12 @@ svn_client__get_paths_auto_props(apr_hash_t **properties,
   return SVN_NO_ERROR;
 }
 
-/* Only call this if the on-disk node kind is a file. */
+/* Only call this if the on-disk node kind is a file.  IS_SPECIAL tells
+   whether LOCAL_ABSPATH is a special file, as reported by the caller's
+   stat or directory listing. */
 static svn_error_t *
 add_file(const char *local_abspath,
+         svn_boolean_t is_special,
          svn_magic__cookie_t *magic_cookie,
          apr_hash_t *autoprops,
          svn_boolean_t no_autoprops,
@@ -276,11 +279,6 @@ add_file(const char *local_abspath,
 {
   apr_hash_t *properties;
   const char *mimetype;
-  svn_node_kind_t kind;
-  svn_boolean_t is_special;
-
-  /* Check to see if this is a special file. */
-  SVN_ERR(svn_io_check_special_path(local_abspath, &kind, &is_special, pool));
 
   /* Determine the properties that the file should have */
   if (is_special)
@@ -472,8 +470,8 @@ add_dir_recursive(const char *dir_abspath,
       else if ((dirent->kind == svn_node_file || dirent->special)
                && depth >= svn_depth_files)
         {
-          err = add_file(abspath, magic_cookie, config_autoprops,
-                         no_autoprops, ctx, iterpool);
+          err = add_file(abspath, dirent->special, magic_cookie,
+                         config_autoprops, no_autoprops, ctx, iterpool);
           if (err && err->apr_err == SVN_ERR_ENTRY_EXISTS && force)
             svn_error_clear(err);
           else
@@ -784,6 +782,7 @@ add(const char *local_abspath,
     apr_pool_t *scratch_pool)
 {
   svn_node_kind_t kind;
+  svn_boolean_t is_special;
   svn_error_t *err;
   svn_magic__cookie_t *magic_cookie;
   apr_array_header_t *ignores = NULL;
@@ -832,7 +831,8 @@ add(const char *local_abspath,
       svn_pool_destroy(iterpool);
     }
 
-  SVN_ERR(svn_io_check_path(local_abspath, &kind, scratch_pool));
+  SVN_ERR(svn_io_check_special_path(local_abspath, &kind, &is_special,
+                                    scratch_pool));
   if (kind == svn_node_dir)
     {
       /* We use add_dir_recursive for all directory targets
@@ -844,7 +844,7 @@ add(const char *local_abspath,
                               scratch_pool, scratch_pool);
     }
   else if (kind == svn_node_file)
-    err = add_file(local_abspath, magic_cookie, NULL,
+    err = add_file(local_abspath, is_special, magic_cookie, NULL,
                    no_autoprops, ctx, scratch_pool);
   else if (kind == svn_node_none)
     {
@@ -38,6 +38,7 @@
 #include "svn_sorts.h"
 
 #include "private/svn_wc_private.h"
+#include "private/svn_diff_private.h"
 
 #include "svn_private_config.h"
 
@@ -65,6 +66,7 @@ struct blame_chain
 {
   struct blame *blame;      /* linked list of blame chunks */
   struct blame *avail;      /* linked list of free blame chunks */
+  svn_diff__file_chain_t *diffs; /* the diffs that produced this chain */
   struct apr_pool_t *pool;  /* Allocate members from this pool. */
 };
 
@@ -290,7 +292,6 @@ add_file_blame(const char *last_file,
                const char *cur_file,
                struct blame_chain *chain,
                struct rev *rev,
-               const svn_diff_file_options_t *diff_options,
                svn_cancel_func_t cancel_func,
                void *cancel_baton,
                apr_pool_t *pool)
@@ -308,9 +309,11 @@ add_file_blame(const char *last_file,
       diff_baton.chain = chain;
       diff_baton.rev = rev;
 
-      /* We have a previous file.  Get the diff and adjust blame info. */
-      SVN_ERR(svn_diff_file_diff_2(&diff, last_file, cur_file,
-                                   diff_options, pool));
+      /* We have a previous file.  Get the diff and adjust blame info.
+         LAST_FILE was the CUR_FILE of the previous diff on CHAIN, so this
+         reuses what was read of it back then. */
+      SVN_ERR(svn_diff__file_chain_diff(&diff, chain->diffs, last_file,
+                                        cur_file, pool));
       SVN_ERR(svn_diff_output2(diff, &diff_baton, &output_fns,
                                cancel_func, cancel_baton));
     }
@@ -344,7 +347,6 @@ update_blame(void *baton)
   /* Process this file. */
   SVN_ERR(add_file_blame(frb->last_filename,
                          dbaton->filename, chain, dbaton->rev,
-                         frb->diff_options,
                          frb->ctx->cancel_func, frb->ctx->cancel_baton,
                          frb->currpool));
 
@@ -357,7 +359,6 @@ update_blame(void *baton)
 
       SVN_ERR(add_file_blame(frb->last_original_filename,
                              dbaton->filename, frb->chain, dbaton->rev,
-                             frb->diff_options,
                              frb->ctx->cancel_func, frb->ctx->cancel_baton,
                              frb->currpool));
 
@@ -414,6 +415,33 @@ window_handler(svn_txdelta_window_t *window, void *baton)
 }
 
 
+/* Notify the client of FRB that revision REVNUM of the file at the
+   repository path PATH, with REV_PROPS, is being looked at. */
+static void
+notify_blame_revision(struct file_rev_baton *frb,
+                      const char *path,
+                      svn_revnum_t revnum,
+                      apr_hash_t *rev_props,
+                      apr_pool_t *pool)
+{
+  if (frb->ctx->notify_func2)
+    {
+      svn_wc_notify_t *notify
+            = svn_wc_create_notify_url(
+                            svn_path_url_add_component2(frb->repos_root_url,
+                                                        path+1, pool),
+                            svn_wc_notify_blame_revision, pool);
+      notify->path = path;
+      notify->kind = svn_node_none;
+      notify->content_state = notify->prop_state
+        = svn_wc_notify_state_inapplicable;
+      notify->lock_state = svn_wc_notify_lock_state_inapplicable;
+      notify->revision = revnum;
+      notify->rev_props = rev_props;
+      frb->ctx->notify_func2(frb->ctx->notify_baton2, notify, pool);
+    }
+}
+
 /* Calculate and record blame information for one revision of the file,
  * by comparing the file content against the previously seen revision.
  *
@@ -461,22 +489,7 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
         }
     }
 
-  if (frb->ctx->notify_func2)
-    {
-      svn_wc_notify_t *notify
-            = svn_wc_create_notify_url(
-                            svn_path_url_add_component2(frb->repos_root_url,
-                                                        path+1, pool),
-                            svn_wc_notify_blame_revision, pool);
-      notify->path = path;
-      notify->kind = svn_node_none;
-      notify->content_state = notify->prop_state
-        = svn_wc_notify_state_inapplicable;
-      notify->lock_state = svn_wc_notify_lock_state_inapplicable;
-      notify->revision = revnum;
-      notify->rev_props = rev_props;
-      frb->ctx->notify_func2(frb->ctx->notify_baton2, notify, pool);
-    }
+  notify_blame_revision(frb, path, revnum, rev_props, pool);
 
   if (frb->ctx->cancel_func)
     SVN_ERR(frb->ctx->cancel_func(frb->ctx->cancel_baton));
@@ -591,6 +604,473 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   return SVN_NO_ERROR;
 }
 
+/* The baton used by server_blame_receiver(). */
+struct server_blame_baton {
+  struct file_rev_baton *frb;
+  struct blame *tail;  /* the last chunk of FRB->chain */
+  apr_hash_t *revs;    /* svn_revnum_t -> struct rev * */
+};
+
+/* Append the run of lines reported by the server to the blame chain of
+   BATON, a struct server_blame_baton.
+
+   Implements svn_blame_run_receiver_t. */
+static svn_error_t *
+server_blame_receiver(void *baton,
+                      apr_int64_t start_line,
+                      apr_int64_t line_count,
+                      svn_revnum_t revision,
+                      apr_hash_t *rev_props,
+                      apr_pool_t *pool)
+{
+  struct server_blame_baton *sbb = baton;
+  struct file_rev_baton *frb = sbb->frb;
+  struct rev *rev;
+  struct blame *blame;
+
+  if (frb->ctx->cancel_func)
+    SVN_ERR(frb->ctx->cancel_func(frb->ctx->cancel_baton));
+
+  rev = apr_hash_get(sbb->revs, &revision, sizeof(revision));
+  if (!rev)
+    {
+      rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+      rev->revision = revision;
+      if (rev_props)
+        rev->rev_props = svn_prop_hash_dup(rev_props, frb->mainpool);
+      apr_hash_set(sbb->revs, &rev->revision, sizeof(rev->revision), rev);
+    }
+
+  blame = blame_create(frb->chain, rev, start_line);
+  if (sbb->tail)
+    sbb->tail->next = blame;
+  else
+    frb->chain->blame = blame;
+  sbb->tail = blame;
+
+  return SVN_NO_ERROR;
+}
+
+/* Let the server of RA_SESSION compute the blame chain of FRB, and fetch
+   the text of FRB->end_rev the lines are read from into
+   FRB->last_filename.  Return SVN_ERR_UNSUPPORTED_FEATURE, without
+   changing FRB, if the server can't. */
+static svn_error_t *
+blame_on_server(struct file_rev_baton *frb,
+                svn_ra_session_t *ra_session,
+                apr_pool_t *pool)
+{
+  struct server_blame_baton sbb;
+  svn_stream_t *stream;
+  svn_error_t *err;
+
+  sbb.frb = frb;
+  sbb.tail = NULL;
+  sbb.revs = apr_hash_make(pool);
+
+  err = svn_ra_blame(ra_session, "", frb->start_rev, frb->end_rev,
+                     frb->diff_options, server_blame_receiver, &sbb, pool);
+  if (err)
+    {
+      frb->chain->blame = NULL;
+      return svn_error_trace(err);
+    }
+
+  SVN_ERR(svn_stream_open_unique(&stream, &frb->last_filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 pool, pool));
+  SVN_ERR(svn_ra_get_file(ra_session, "", frb->end_rev, stream, NULL, NULL,
+                          pool));
+  SVN_ERR(svn_stream_close(stream));
+
+  /* An empty file has no runs, but the chain needs a chunk. */
+  if (!frb->chain->blame)
+    {
+      struct rev *rev = apr_pcalloc(frb->mainpool, sizeof(*rev));
+
+      rev->revision = SVN_INVALID_REVNUM;
+      frb->chain->blame = blame_create(frb->chain, rev, 0);
+    }
+  frb->last_rev = sbb.tail ? (struct rev *)sbb.tail->rev : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* The baton used while walking the revisions of a file from the youngest
+   to older ones in youngest_first_handler(). Lives the entire walk. */
+struct youngest_first_baton {
+  struct file_rev_baton *frb;
+  /* name of the file with the text of the youngest revision */
+  const char *end_filename;
+  /* the number of lines in END_FILENAME, once known */
+  apr_off_t end_lines;
+  /* name of the file with the text of CUR_REV.  NULL before the first
+     revision. */
+  const char *cur_filename;
+  const struct rev *cur_rev;
+  /* For each line of CUR_FILENAME, the apr_off_t line of END_FILENAME it
+     still has to attribute, or -1 if it doesn't survive into END_FILENAME
+     or that line is already attributed.  NULL for END_FILENAME itself,
+     in which case every line maps to itself. */
+  apr_array_header_t *cur_map;
+  /* the const struct rev * of every line of END_FILENAME, NULL as long
+     as the line isn't attributed */
+  apr_array_header_t *line_revs;
+  apr_pool_t *lastpool;  /* used for CUR_FILENAME and CUR_MAP */
+  apr_pool_t *currpool;  /* used for the revision being read */
+};
+
+/* The baton used by the txdelta window handler of the youngest-first
+   walk. Allocated per revision */
+struct youngest_first_delta_baton {
+  svn_txdelta_window_handler_t wrapped_handler;
+  void *wrapped_baton;
+  struct youngest_first_baton *yfb;
+  svn_stream_t *source_stream;  /* the delta source */
+  const char *filename;
+  struct rev *rev;     /* the rev struct for the current revision */
+};
+
+/* The baton used for the diff output routines of the youngest-first
+   walk. */
+struct youngest_first_diff_baton {
+  struct youngest_first_baton *yfb;
+  apr_array_header_t *map;  /* the map being built for the older text */
+  apr_off_t pending;        /* the number of lines MAP still attributes */
+};
+
+/* Return the line of YFB->end_filename that line LINE of YFB->cur_filename
+   attributes, or -1. */
+static apr_off_t
+youngest_first_map(const struct youngest_first_baton *yfb,
+                   apr_off_t line)
+{
+  if (!yfb->cur_map)
+    return line;
+
+  return APR_ARRAY_IDX(yfb->cur_map, line, apr_off_t);
+}
+
+/* Attribute line LINE of YFB->end_filename to REV. */
+static void
+youngest_first_attribute(struct youngest_first_baton *yfb,
+                         apr_off_t line,
+                         const struct rev *rev)
+{
+  while (yfb->line_revs->nelts <= line)
+    APR_ARRAY_PUSH(yfb->line_revs, const struct rev *) = NULL;
+
+  APR_ARRAY_IDX(yfb->line_revs, line, const struct rev *) = rev;
+}
+
+/* Lines common to the older and the younger text keep waiting for their
+   attribution. */
+static svn_error_t *
+youngest_first_output_common(void *baton,
+                             apr_off_t original_start,
+                             apr_off_t original_length,
+                             apr_off_t modified_start,
+                             apr_off_t modified_length,
+                             apr_off_t latest_start,
+                             apr_off_t latest_length)
+{
+  struct youngest_first_diff_baton *db = baton;
+  apr_off_t i;
+
+  SVN_ERR_ASSERT(db->map->nelts == original_start);
+
+  for (i = 0; i < original_length; i++)
+    {
+      apr_off_t line = youngest_first_map(db->yfb, modified_start + i);
+
+      APR_ARRAY_PUSH(db->map, apr_off_t) = line;
+      if (line >= 0)
+        db->pending++;
+    }
+
+  if (!db->yfb->cur_map)
+    db->yfb->end_lines = MAX(db->yfb->end_lines,
+                             modified_start + modified_length);
+
+  return SVN_NO_ERROR;
+}
+
+/* Lines of the younger text that the older text doesn't have were
+   changed in the younger revision. */
+static svn_error_t *
+youngest_first_output_modified(void *baton,
+                               apr_off_t original_start,
+                               apr_off_t original_length,
+                               apr_off_t modified_start,
+                               apr_off_t modified_length,
+                               apr_off_t latest_start,
+                               apr_off_t latest_length)
+{
+  struct youngest_first_diff_baton *db = baton;
+  apr_off_t i;
+
+  SVN_ERR_ASSERT(db->map->nelts == original_start);
+
+  for (i = 0; i < modified_length; i++)
+    {
+      apr_off_t line = youngest_first_map(db->yfb, modified_start + i);
+
+      if (line >= 0)
+        youngest_first_attribute(db->yfb, line, db->yfb->cur_rev);
+    }
+
+  for (i = 0; i < original_length; i++)
+    APR_ARRAY_PUSH(db->map, apr_off_t) = -1;
+
+  if (!db->yfb->cur_map)
+    db->yfb->end_lines = MAX(db->yfb->end_lines,
+                             modified_start + modified_length);
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_output_fns_t youngest_first_output_fns = {
+        youngest_first_output_common,
+        youngest_first_output_modified
+};
+
+/* Attribute the lines changed between the text of the revision in BATON,
+   a struct youngest_first_delta_baton, and the younger text read before
+   it.  Return SVN_ERR_CEASE_INVOCATION once every line is attributed. */
+static svn_error_t *
+youngest_first_update(void *baton)
+{
+  struct youngest_first_delta_baton *dbaton = baton;
+  struct youngest_first_baton *yfb = dbaton->yfb;
+  struct file_rev_baton *frb = yfb->frb;
+  struct youngest_first_diff_baton db;
+  svn_diff_t *diff;
+
+  if (dbaton->source_stream)
+    SVN_ERR(svn_stream_close(dbaton->source_stream));
+
+  if (!yfb->cur_filename)
+    {
+      /* The youngest text; all of its lines still want a revision. */
+      yfb->end_filename = dbaton->filename;
+      yfb->cur_filename = dbaton->filename;
+      yfb->cur_rev = dbaton->rev;
+      return SVN_NO_ERROR;
+    }
+
+  db.yfb = yfb;
+  db.map = apr_array_make(yfb->currpool, 0, sizeof(apr_off_t));
+  db.pending = 0;
+
+  SVN_ERR(svn_diff_file_diff_2(&diff, dbaton->filename, yfb->cur_filename,
+                               frb->diff_options, yfb->currpool));
+  SVN_ERR(svn_diff_output2(diff, &db, &youngest_first_output_fns,
+                           frb->ctx->cancel_func, frb->ctx->cancel_baton));
+
+  /* Prepare for the next, older, revision. */
+  yfb->cur_filename = dbaton->filename;
+  yfb->cur_rev = dbaton->rev;
+  yfb->cur_map = db.map;
+
+  {
+    apr_pool_t *tmp_pool = yfb->lastpool;
+    yfb->lastpool = yfb->currpool;
+    yfb->currpool = tmp_pool;
+  }
+
+  /* Nothing older can change the blame anymore. */
+  if (db.pending == 0)
+    return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* The delta window handler of the youngest-first walk.
+
+   Implements svn_txdelta_window_handler_t. */
+static svn_error_t *
+youngest_first_window_handler(svn_txdelta_window_t *window, void *baton)
+{
+  struct youngest_first_delta_baton *dbaton = baton;
+
+  SVN_ERR(dbaton->wrapped_handler(window, dbaton->wrapped_baton));
+
+  if (window)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(youngest_first_update(baton));
+}
+
+/* Receive the revisions of the file from the youngest to older ones, for
+   the youngest-first walk in BATON, a struct youngest_first_baton.
+
+   Implements svn_file_rev_handler_t. */
+static svn_error_t *
+youngest_first_handler(void *baton,
+                       const char *path,
+                       svn_revnum_t revnum,
+                       apr_hash_t *rev_props,
+                       svn_boolean_t merged_revision,
+                       svn_txdelta_window_handler_t *content_delta_handler,
+                       void **content_delta_baton,
+                       apr_array_header_t *prop_diffs,
+                       apr_pool_t *pool)
+{
+  struct youngest_first_baton *yfb = baton;
+  struct file_rev_baton *frb = yfb->frb;
+  struct youngest_first_delta_baton *delta_baton;
+  svn_stream_t *cur_stream;
+  apr_pool_t *filepool;
+
+  notify_blame_revision(frb, path, revnum, rev_props, pool);
+
+  if (frb->ctx->cancel_func)
+    SVN_ERR(frb->ctx->cancel_func(frb->ctx->cancel_baton));
+
+  /* Revisions that only change properties don't attribute lines. */
+  if (!content_delta_handler)
+    return SVN_NO_ERROR;
+
+  svn_pool_clear(yfb->currpool);
+
+  delta_baton = apr_pcalloc(yfb->currpool, sizeof(*delta_baton));
+  delta_baton->yfb = yfb;
+
+  delta_baton->rev = apr_pcalloc(frb->mainpool, sizeof(*delta_baton->rev));
+  delta_baton->rev->revision = revnum;
+  delta_baton->rev->rev_props = svn_prop_hash_dup(rev_props, frb->mainpool);
+
+  /* The deltas come against the younger text read before. */
+  if (yfb->cur_filename)
+    SVN_ERR(svn_stream_open_readonly(&delta_baton->source_stream,
+                                     yfb->cur_filename,
+                                     yfb->currpool, pool));
+  else
+    delta_baton->source_stream = NULL;
+
+  /* The youngest text is the one the blame is reported for. */
+  filepool = yfb->cur_filename ? yfb->currpool : frb->mainpool;
+  SVN_ERR(svn_stream_open_unique(&cur_stream, &delta_baton->filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 filepool, pool));
+
+  svn_txdelta_apply(delta_baton->source_stream
+                      ? delta_baton->source_stream
+                      : svn_stream_empty(yfb->currpool),
+                    cur_stream, NULL, NULL, yfb->currpool,
+                    &delta_baton->wrapped_handler,
+                    &delta_baton->wrapped_baton);
+
+  *content_delta_handler = youngest_first_window_handler;
+  *content_delta_baton = delta_baton;
+
+  return SVN_NO_ERROR;
+}
+
+/* Build the blame chain of FRB by walking the revisions of the file from
+   FRB->end_rev to older ones, stopping as soon as every line of the text
+   in FRB->end_rev is attributed, and put that text into
+   FRB->last_filename.  The server of RA_SESSION must support
+   SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE. */
+static svn_error_t *
+blame_youngest_first(struct file_rev_baton *frb,
+                     svn_ra_session_t *ra_session,
+                     apr_pool_t *pool)
+{
+  struct youngest_first_baton yfb;
+  struct rev *invalid_rev;
+  struct blame *tail = NULL;
+  apr_off_t i;
+  svn_error_t *err;
+
+  yfb.frb = frb;
+  yfb.end_filename = NULL;
+  yfb.end_lines = 0;
+  yfb.cur_filename = NULL;
+  yfb.cur_rev = NULL;
+  yfb.cur_map = NULL;
+  yfb.line_revs = apr_array_make(pool, 0, sizeof(const struct rev *));
+  yfb.lastpool = svn_pool_create(pool);
+  yfb.currpool = svn_pool_create(pool);
+
+  /* As in the forward walk, the revision before start_rev tells what was
+     actually changed in start_rev. */
+  err = svn_ra_get_file_revs2(ra_session, "", frb->end_rev,
+                              MAX(0, frb->start_rev - 1), FALSE,
+                              youngest_first_handler, &yfb, pool);
+  if (err && svn_error_find_cause(err, SVN_ERR_CEASE_INVOCATION))
+    svn_error_clear(err);
+  else
+    SVN_ERR(err);
+
+  invalid_rev = apr_pcalloc(pool, sizeof(*invalid_rev));
+  invalid_rev->revision = SVN_INVALID_REVNUM;
+
+  if (!yfb.end_filename)
+    {
+      /* The file has no text in this range; report it as empty. */
+      svn_stream_t *stream;
+
+      SVN_ERR(svn_stream_open_unique(&stream, &frb->last_filename, NULL,
+                                     svn_io_file_del_on_pool_cleanup,
+                                     pool, pool));
+      SVN_ERR(svn_stream_close(stream));
+      frb->chain->blame = blame_create(frb->chain, invalid_rev, 0);
+      return SVN_NO_ERROR;
+    }
+
+  /* Whatever is left came into the file in the oldest revision we saw,
+     unless that one precedes the range. */
+  if (yfb.cur_rev->revision < frb->start_rev)
+    yfb.cur_rev = invalid_rev;
+
+  if (!yfb.cur_map)
+    frb->chain->blame = blame_create(frb->chain, yfb.cur_rev, 0);
+  else
+    {
+      for (i = 0; i < yfb.cur_map->nelts; i++)
+        {
+          apr_off_t line = APR_ARRAY_IDX(yfb.cur_map, i, apr_off_t);
+
+          if (line >= 0)
+            youngest_first_attribute(&yfb, line, yfb.cur_rev);
+        }
+
+      for (i = 0; i < yfb.end_lines; i++)
+        {
+          const struct rev *rev = NULL;
+
+          if (i < yfb.line_revs->nelts)
+            rev = APR_ARRAY_IDX(yfb.line_revs, i, const struct rev *);
+          if (!rev)
+            rev = invalid_rev;
+
+          if (tail && tail->rev == rev)
+            continue;
+
+          if (tail)
+            {
+              tail->next = blame_create(frb->chain, rev, i);
+              tail = tail->next;
+            }
+          else
+            {
+              frb->chain->blame = blame_create(frb->chain, rev, i);
+              tail = frb->chain->blame;
+            }
+        }
+
+      if (!tail)
+        frb->chain->blame = blame_create(frb->chain, invalid_rev, 0);
+    }
+
+  frb->last_filename = yfb.end_filename;
+  svn_pool_destroy(yfb.lastpool);
+  svn_pool_destroy(yfb.currpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Ensure that CHAIN_ORIG and CHAIN_MERGED have the same number of chunks,
    and that for every chunk C, CHAIN_ORIG[C] and CHAIN_MERGED[C] have the
    same starting value.  Both CHAIN_ORIG and CHAIN_MERGED should not be
@@ -784,12 +1264,15 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
   frb.chain = apr_palloc(pool, sizeof(*frb.chain));
   frb.chain->blame = NULL;
   frb.chain->avail = NULL;
+  frb.chain->diffs = svn_diff__file_chain_create(diff_options, pool);
   frb.chain->pool = pool;
   if (include_merged_revisions)
     {
       frb.merged_chain = apr_palloc(pool, sizeof(*frb.merged_chain));
       frb.merged_chain->blame = NULL;
       frb.merged_chain->avail = NULL;
+      frb.merged_chain->diffs = svn_diff__file_chain_create(diff_options,
+                                                            pool);
       frb.merged_chain->pool = pool;
     }
   frb.backwards = (frb.start_rev > frb.end_rev);
@@ -811,16 +1294,44 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
       frb.prevfilepool = svn_pool_create(pool);
     }
 
+  /* Servers that can compute the blame themselves spare us fetching every
+     revision of the file.  They don't track merges or walk backwards. */
+  if (!include_merged_revisions && !frb.backwards)
+    {
+      svn_error_t *err = blame_on_server(&frb, ra_session, pool);
+
+      if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+        svn_error_clear(err);
+      else
+        SVN_ERR(err);
+    }
+
+  /* Otherwise, walking from end_rev towards older revisions lets us stop
+     as soon as every line is attributed, instead of reading the whole
+     history of the file. */
+  if (!frb.last_filename && !include_merged_revisions
+      && start_revnum < end_revnum)
+    {
+      svn_boolean_t has_reverse;
+
+      SVN_ERR(svn_ra_has_capability(ra_session, &has_reverse,
+                                    SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE,
+                                    pool));
+      if (has_reverse)
+        SVN_ERR(blame_youngest_first(&frb, ra_session, pool));
+    }
+
   /* Collect all blame information.
      We need to ensure that we get one revision before the start_rev,
      if available so that we can know what was actually changed in the start
      revision. */
-  SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
-                                frb.backwards ? start_revnum
-                                              : MAX(0, start_revnum-1),
-                                end_revnum,
-                                include_merged_revisions,
-                                file_rev_handler, &frb, pool));
+  if (!frb.last_filename)
+    SVN_ERR(svn_ra_get_file_revs2(ra_session, "",
+                                  frb.backwards ? start_revnum
+                                                : MAX(0, start_revnum-1),
+                                  end_revnum,
+                                  include_merged_revisions,
+                                  file_rev_handler, &frb, pool));
 
   if (end->kind == svn_opt_revision_working)
     {
@@ -875,7 +1386,6 @@ svn_client_blame6(svn_revnum_t *start_revnum_p,
                                    ctx->cancel_baton, pool));
 
           SVN_ERR(add_file_blame(frb.last_filename, temppath, frb.chain, NULL,
-                                 frb.diff_options,
                                  ctx->cancel_func, ctx->cancel_baton, pool));
 
           frb.last_filename = temppath;
@@ -216,6 +216,9 @@ svn_client_cat3(apr_hash_t **returned_props,
 
       SVN_ERR(svn_dirent_get_absolute(&local_abspath, path_or_url,
                                       scratch_pool));
+      if (revision->kind != svn_opt_revision_working)
+        SVN_ERR(svn_client__textbase_sync(local_abspath, svn_depth_empty,
+                                          ctx, scratch_pool));
       SVN_ERR(svn_client__get_normalized_stream(&normal_stream, ctx->wc_ctx,
                                             local_abspath, revision,
                                             expand_keywords, FALSE,
@@ -63,6 +63,13 @@ typedef struct svn_client__private_ctx_t
   /* Total number of bytes transferred over network across all RA sessions. */
   apr_off_t total_progress;
 
+  /* The pool this context was allocated in. */
+  apr_pool_t *pool;
+
+  /* The most recent history log fetched while looking for tree conflict
+     details, or NULL.  See conflicts.c. */
+  struct svn_client__conflict_log_t *conflict_log;
+
   /* The public context. */
   svn_client_ctx_t public_ctx;
 } svn_client__private_ctx_t;
@@ -326,6 +333,20 @@ svn_client__ra_provide_base(svn_stream_t **contents,
                             apr_pool_t *scratch_pool);
 
 
+/* Fetch the pristine texts that the working copy of LOCAL_ABSPATH needs
+   for LOCAL_ABSPATH and its descendants down to DEPTH, but doesn't have
+   because it keeps pristines on demand.  See svn_wc__textbase_sync().
+
+   A session to the repository is only opened if there is something to
+   fetch.  Use CTX for contacting the repository and SCRATCH_POOL for
+   temporary allocations. */
+svn_error_t *
+svn_client__textbase_sync(const char *local_abspath,
+                          svn_depth_t depth,
+                          svn_client_ctx_t *ctx,
+                          apr_pool_t *scratch_pool);
+
+
 svn_error_t *
 svn_client__ra_provide_props(apr_hash_t **props,
                              svn_revnum_t *revision,
@@ -679,6 +700,29 @@ svn_client__get_diff_editor2(const svn_delta_editor_t **editor,
                              void *cancel_baton,
                              apr_pool_t *result_pool);
 
+/* Report a diff summary of the directory at URL between REV1 and the
+   younger REV2 to SUMMARIZE_FUNC with SUMMARIZE_BATON, deriving it from
+   the changed paths of the revisions in between rather than comparing
+   both trees.
+
+   This is only possible if URL is the same node in both revisions and no
+   copies or replacements happened within it.  If it is not, set *HANDLED
+   to FALSE without reporting anything.  Otherwise, set it to TRUE.
+
+   RA_SESSION is an RA session to the repository of URL; it may be
+   reparented.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_client__diff_summarize_from_log(svn_boolean_t *handled,
+                                    svn_ra_session_t *ra_session,
+                                    const char *url,
+                                    svn_revnum_t rev1,
+                                    svn_revnum_t rev2,
+                                    svn_client_diff_summarize_func_t
+                                      summarize_func,
+                                    void *summarize_baton,
+                                    svn_client_ctx_t *ctx,
+                                    apr_pool_t *scratch_pool);
+
 /* ---------------------------------------------------------------- */
 
 
@@ -950,6 +994,10 @@ svn_client__do_commit(const char *base_url,
    If RA_SESSION is NOT NULL, it may be used to avoid creating a new
    session. The session may point to a different URL after returning.
 
+   Up to the externals-jobs configured in CTX directory externals are
+   checked out or updated concurrently, each with a session and a working
+   copy context of its own.
+
    Use POOL for temporary allocation. */
 svn_error_t *
 svn_client__handle_externals(apr_hash_t *externals_new,
@@ -38,6 +38,7 @@
 #include "svn_props.h"
 #include "svn_iter.h"
 #include "svn_hash.h"
+#include "svn_config.h"
 
 #include <assert.h>
 
@@ -1856,6 +1857,47 @@ fixup_error:
                                             err, ctx, pool));
 }
 
+/* Baton for transmit_done(). */
+struct transmit_baton_t
+{
+  struct file_mod_t *mod;
+  const char *base_url;
+  apr_hash_t *sha1_checksums;          /* may be NULL */
+  svn_client_ctx_t *ctx;
+};
+
+/* Implements svn_wc__transmit_done_func_t.  Record the SHA-1 of the text
+ * sent for the file_mod_t in the transmit_baton_t BATON and close its
+ * pool, or translate ERR into a nicer error.
+ */
+static svn_error_t *
+transmit_done(void *baton,
+              const char *local_abspath,
+              const svn_checksum_t *new_text_base_md5_checksum,
+              const svn_checksum_t *new_text_base_sha1_checksum,
+              svn_error_t *err,
+              apr_pool_t *scratch_pool)
+{
+  struct transmit_baton_t *tb = baton;
+  const svn_client_commit_item3_t *item = tb->mod->item;
+
+  if (err)
+    return svn_error_trace(fixup_commit_error(item->path,
+                                              tb->base_url,
+                                              item->session_relpath,
+                                              svn_node_file,
+                                              err, tb->ctx, scratch_pool));
+
+  if (tb->sha1_checksums)
+    svn_hash_sets(tb->sha1_checksums, item->path,
+                  svn_checksum_dup(new_text_base_sha1_checksum,
+                                   apr_hash_pool_get(tb->sha1_checksums)));
+
+  svn_pool_destroy(tb->mod->file_pool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_client__do_commit(const char *base_url,
                       const apr_array_header_t *commit_items,
@@ -1875,6 +1917,16 @@ svn_client__do_commit(const char *base_url,
   struct item_commit_baton cb_baton;
   apr_array_header_t *paths =
     apr_array_make(scratch_pool, commit_items->nelts, sizeof(const char *));
+  svn_wc__transmit_queue_t *transmit_queue;
+  svn_config_t *cfg = ctx->config
+                      ? svn_hash_gets(ctx->config, SVN_CONFIG_CATEGORY_CONFIG)
+                      : NULL;
+  apr_int64_t commit_jobs;
+
+  /* See how many deltas the user wants to compute concurrently. */
+  SVN_ERR(svn_config_get_int64(cfg, &commit_jobs,
+                               SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_COMMIT_JOBS, 1));
 
   /* Ditto for the checksums. */
   if (sha1_checksums)
@@ -1904,16 +1956,19 @@ svn_client__do_commit(const char *base_url,
                                  do_item_commit, &cb_baton, scratch_pool));
 
   /* Transmit outstanding text deltas. */
+  SVN_ERR(svn_wc__transmit_queue_create(&transmit_queue, ctx->wc_ctx,
+                                        editor,
+                                        (int)MIN(commit_jobs, APR_INT32_MAX),
+                                        ctx->cancel_func, ctx->cancel_baton,
+                                        scratch_pool));
   for (hi = apr_hash_first(scratch_pool, file_mods);
        hi;
        hi = apr_hash_next(hi))
     {
       struct file_mod_t *mod = apr_hash_this_val(hi);
       const svn_client_commit_item3_t *item = mod->item;
-      const svn_checksum_t *new_text_base_md5_checksum;
-      const svn_checksum_t *new_text_base_sha1_checksum;
+      struct transmit_baton_t *tb;
       svn_boolean_t fulltext = FALSE;
-      svn_error_t *err;
 
       svn_pool_clear(iterpool);
 
@@ -1937,28 +1992,19 @@ svn_client__do_commit(const char *base_url,
           && ! (item->state_flags & SVN_CLIENT_COMMIT_ITEM_IS_COPY))
         fulltext = TRUE;
 
-      err = svn_wc_transmit_text_deltas3(&new_text_base_md5_checksum,
-                                         &new_text_base_sha1_checksum,
-                                         ctx->wc_ctx, item->path,
-                                         fulltext, editor, mod->file_baton,
-                                         result_pool, iterpool);
+      tb = apr_pcalloc(scratch_pool, sizeof(*tb));
+      tb->mod = mod;
+      tb->base_url = base_url;
+      tb->sha1_checksums = sha1_checksums ? *sha1_checksums : NULL;
+      tb->ctx = ctx;
 
-      if (err)
-        {
-          svn_pool_destroy(iterpool); /* Close tempfiles */
-          return svn_error_trace(fixup_commit_error(item->path,
-                                                    base_url,
-                                                    item->session_relpath,
-                                                    svn_node_file,
-                                                    err, ctx, scratch_pool));
-        }
-
-      if (sha1_checksums)
-        svn_hash_sets(*sha1_checksums, item->path, new_text_base_sha1_checksum);
-
-      svn_pool_destroy(mod->file_pool);
+      SVN_ERR(svn_wc__transmit_queue_add(transmit_queue, item->path,
+                                         fulltext, mod->file_baton,
+                                         transmit_done, tb, iterpool));
     }
 
+  SVN_ERR(svn_wc__transmit_queue_flush(transmit_queue, iterpool));
+
   if (ctx->notify_func2)
     {
       svn_wc_notify_t *notify;
@@ -1557,6 +1557,162 @@ describe_local_dir_node_change(const char **description,
   return SVN_NO_ERROR;
 }
 
+/* The complete log of a repository URL for a revision range, as
+ * received from svn_ra_get_log2() with changed paths and the author
+ * revprop.  Looking up the details of a tree conflict scans the same
+ * history more than once, and conflicts of nodes in the same directory
+ * share it as well, so we keep the most recent log around in the client
+ * context. */
+struct svn_client__conflict_log_t
+{
+  /* Pool holding this structure and all log entries. */
+  apr_pool_t *pool;
+
+  const char *url;
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* The svn_log_entry_t * in the order received. */
+  apr_array_header_t *entries;
+
+  /* The moves found in ENTRIES by find_moves_in_revision_range(), in
+   * its pristine state, or NULL if the log has not been scanned for
+   * moves yet.  See struct find_moves_baton for the layout. */
+  apr_hash_t *moves_table;
+};
+
+/* Return the log of URL from START_REV to END_REV kept in CTX, or NULL
+ * if there is none. */
+static struct svn_client__conflict_log_t *
+lookup_history_log(const char *url,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_client_ctx_t *ctx)
+{
+  svn_client__private_ctx_t *private_ctx = svn_client__get_private_ctx(ctx);
+  struct svn_client__conflict_log_t *log = private_ctx->conflict_log;
+
+  if (log && log->start_rev == start_rev && log->end_rev == end_rev
+      && strcmp(log->url, url) == 0)
+    return log;
+
+  return NULL;
+}
+
+/* Baton for conflict_log_receiver(). */
+struct conflict_log_baton
+{
+  /* The log being recorded. */
+  struct svn_client__conflict_log_t *log;
+
+  /* The receiver to pass the log entries on to. */
+  svn_log_entry_receiver_t receiver;
+  void *receiver_baton;
+};
+
+/* Implements svn_log_entry_receiver_t.  Record LOG_ENTRY and pass it on. */
+static svn_error_t *
+conflict_log_receiver(void *baton,
+                      svn_log_entry_t *log_entry,
+                      apr_pool_t *scratch_pool)
+{
+  struct conflict_log_baton *b = baton;
+
+  APR_ARRAY_PUSH(b->log->entries, svn_log_entry_t *)
+    = svn_log_entry_dup(log_entry, b->log->pool);
+
+  return svn_error_trace(b->receiver(b->receiver_baton, log_entry,
+                                     scratch_pool));
+}
+
+/* Like svn_ra_get_log2() for the root of RA_SESSION, which is URL, from
+ * START_REV to END_REV with changed paths and the author revprop, calling
+ * RECEIVER with RECEIVER_BATON for each log entry.  If the same log has
+ * been fetched just before with CTX, replay it from memory instead of
+ * asking the server again.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+get_history_log(svn_ra_session_t *ra_session,
+                const char *url,
+                svn_revnum_t start_rev,
+                svn_revnum_t end_rev,
+                svn_log_entry_receiver_t receiver,
+                void *receiver_baton,
+                svn_client_ctx_t *ctx,
+                apr_pool_t *scratch_pool)
+{
+  svn_client__private_ctx_t *private_ctx = svn_client__get_private_ctx(ctx);
+  struct svn_client__conflict_log_t *log;
+  struct conflict_log_baton b;
+  apr_array_header_t *paths;
+  apr_array_header_t *revprops;
+  apr_pool_t *log_pool;
+  svn_error_t *err;
+
+  log = lookup_history_log(url, start_rev, end_rev, ctx);
+  if (log)
+    {
+      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      int i;
+
+      for (i = 0; i < log->entries->nelts; i++)
+        {
+          svn_log_entry_t *log_entry
+            = APR_ARRAY_IDX(log->entries, i, svn_log_entry_t *);
+
+          svn_pool_clear(iterpool);
+          SVN_ERR(receiver(receiver_baton, log_entry, iterpool));
+        }
+      svn_pool_destroy(iterpool);
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Only keep one log at a time. */
+  if (private_ctx->conflict_log)
+    {
+      log = private_ctx->conflict_log;
+      private_ctx->conflict_log = NULL;
+      svn_pool_destroy(log->pool);
+    }
+
+  log_pool = svn_pool_create(private_ctx->pool);
+  log = apr_pcalloc(log_pool, sizeof(*log));
+  log->pool = log_pool;
+  log->url = apr_pstrdup(log_pool, url);
+  log->start_rev = start_rev;
+  log->end_rev = end_rev;
+  log->entries = apr_array_make(log_pool, 0, sizeof(svn_log_entry_t *));
+
+  b.log = log;
+  b.receiver = receiver;
+  b.receiver_baton = receiver_baton;
+
+  paths = apr_array_make(scratch_pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(paths, const char *) = "";
+
+  revprops = apr_array_make(scratch_pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(revprops, const char *) = SVN_PROP_REVISION_AUTHOR;
+
+  err = svn_ra_get_log2(ra_session, paths, start_rev, end_rev,
+                        0, /* no limit */
+                        TRUE, /* need the changed paths list */
+                        FALSE, /* need to traverse copies */
+                        FALSE, /* no need for merged revisions */
+                        revprops,
+                        conflict_log_receiver, &b,
+                        scratch_pool);
+
+  /* Don't keep incomplete logs, e.g. if RECEIVER stopped early. */
+  if (err)
+    {
+      svn_pool_destroy(log_pool);
+      return svn_error_trace(err);
+    }
+
+  private_ctx->conflict_log = log;
+  return SVN_NO_ERROR;
+}
+
 struct find_moves_baton
 {
   /* Variables below are arguments provided by the caller of
@@ -1700,9 +1856,107 @@ find_moves(void *baton, svn_log_entry_t *log_entry, apr_pool_t *scratch_pool)
   return SVN_NO_ERROR;
 }
 
+/* Return a deep copy of MOVES_TABLE allocated in RESULT_POOL.  The PREV
+ * and NEXT links of the copied moves refer to the copies. */
+static apr_hash_t *
+dup_moves_table(apr_hash_t *moves_table,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  apr_hash_t *new_table = apr_hash_make(result_pool);
+  apr_hash_t *new_moves_by_move = apr_hash_make(scratch_pool);
+  apr_hash_index_t *hi;
+  int i, j;
+
+  /* Copy the moves themselves and remember which copy belongs to
+   * which original. */
+  for (hi = apr_hash_first(scratch_pool, moves_table);
+       hi != NULL;
+       hi = apr_hash_next(hi))
+    {
+      apr_array_header_t *moves = apr_hash_this_val(hi);
+      apr_array_header_t *new_moves;
+      svn_revnum_t *rev;
+
+      new_moves = apr_array_make(result_pool, moves->nelts,
+                                 sizeof(struct repos_move_info *));
+      for (i = 0; i < moves->nelts; i++)
+        {
+          struct repos_move_info *move;
+          struct repos_move_info *new_move;
+
+          move = APR_ARRAY_IDX(moves, i, struct repos_move_info *);
+          new_move = apr_pmemdup(result_pool, move, sizeof(*move));
+          new_move->rev_author = apr_pstrdup(result_pool, move->rev_author);
+          new_move->moved_from_repos_relpath
+            = apr_pstrdup(result_pool, move->moved_from_repos_relpath);
+          new_move->moved_to_repos_relpath
+            = apr_pstrdup(result_pool, move->moved_to_repos_relpath);
+          apr_hash_set(new_moves_by_move,
+                       apr_pmemdup(scratch_pool, &move, sizeof(move)),
+                       sizeof(move), new_move);
+          APR_ARRAY_PUSH(new_moves, struct repos_move_info *) = new_move;
+        }
+
+      rev = apr_pmemdup(result_pool, apr_hash_this_key(hi),
+                        sizeof(svn_revnum_t));
+      apr_hash_set(new_table, rev, sizeof(*rev), new_moves);
+    }
+
+  /* Relink the copies. */
+  for (hi = apr_hash_first(scratch_pool, new_table);
+       hi != NULL;
+       hi = apr_hash_next(hi))
+    {
+      apr_array_header_t *new_moves = apr_hash_this_val(hi);
+
+      for (i = 0; i < new_moves->nelts; i++)
+        {
+          struct repos_move_info *new_move;
+
+          new_move = APR_ARRAY_IDX(new_moves, i, struct repos_move_info *);
+          if (new_move->prev)
+            {
+              new_move->prev = apr_hash_get(new_moves_by_move,
+                                            &new_move->prev,
+                                            sizeof(new_move->prev));
+            }
+
+          if (new_move->next)
+            {
+              apr_array_header_t *next = new_move->next;
+
+              new_move->next = apr_array_make(result_pool, next->nelts,
+                                              sizeof(struct repos_move_info *));
+              for (j = 0; j < next->nelts; j++)
+                {
+                  struct repos_move_info *next_move;
+
+                  next_move = APR_ARRAY_IDX(next, j,
+                                            struct repos_move_info *);
+                  next_move = apr_hash_get(new_moves_by_move, &next_move,
+                                           sizeof(next_move));
+                  if (next_move)
+                    APR_ARRAY_PUSH(new_move->next,
+                                   struct repos_move_info *) = next_move;
+                }
+
+              if (new_move->next->nelts == 0)
+                new_move->next = NULL;
+            }
+        }
+    }
+
+  return new_table;
+}
+
 /* Find all moves which occurred in repository history starting at
  * REPOS_RELPATH@START_REV until END_REV (where START_REV > END_REV).
- * Return results in *MOVES_TABLE (see struct find_moves_baton for details). */
+ * Return results in *MOVES_TABLE (see struct find_moves_baton for details).
+ *
+ * Scanning the history for moves costs several extra requests per copy,
+ * so the result is kept along with the log in CTX and handed out again
+ * to later callers asking about the same range. */
 static svn_error_t *
 find_moves_in_revision_range(struct apr_hash_t **moves_table,
                              const char *repos_relpath,
@@ -1718,25 +1972,29 @@ find_moves_in_revision_range(struct apr_hash_t **moves_table,
   svn_ra_session_t *ra_session;
   const char *url;
   const char *corrected_url;
-  apr_array_header_t *paths;
-  apr_array_header_t *revprops;
   struct find_moves_baton b = { 0 };
+  struct svn_client__conflict_log_t *log;
 
   SVN_ERR_ASSERT(start_rev > end_rev);
 
   url = svn_path_url_add_component2(repos_root_url, repos_relpath,
                                     scratch_pool);
+
+  /* Callers update the PREV and NEXT links of the moves they trace,
+   * so everybody gets their own copy of the table. */
+  log = lookup_history_log(url, start_rev, end_rev, ctx);
+  if (log && log->moves_table)
+    {
+      *moves_table = dup_moves_table(log->moves_table, result_pool,
+                                     scratch_pool);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(svn_client__open_ra_session_internal(&ra_session, &corrected_url,
                                                url, NULL, NULL, FALSE, FALSE,
                                                ctx, scratch_pool,
                                                scratch_pool));
 
-  paths = apr_array_make(scratch_pool, 1, sizeof(const char *));
-  APR_ARRAY_PUSH(paths, const char *) = "";
-
-  revprops = apr_array_make(scratch_pool, 1, sizeof(const char *));
-  APR_ARRAY_PUSH(revprops, const char *) = SVN_PROP_REVISION_AUTHOR;
-
   b.repos_root_url = repos_root_url;
   b.repos_uuid = repos_uuid;
   b.ctx = ctx;
@@ -1747,14 +2005,13 @@ find_moves_in_revision_range(struct apr_hash_t **moves_table,
   SVN_ERR(svn_ra__dup_session(&b.extra_ra_session, ra_session, NULL,
                               scratch_pool, scratch_pool));
 
-  SVN_ERR(svn_ra_get_log2(ra_session, paths, start_rev, end_rev,
-                          0, /* no limit */
-                          TRUE, /* need the changed paths list */
-                          FALSE, /* need to traverse copies */
-                          FALSE, /* no need for merged revisions */
-                          revprops,
-                          find_moves, &b,
-                          scratch_pool));
+  SVN_ERR(get_history_log(ra_session, url, start_rev, end_rev,
+                          find_moves, &b, ctx, scratch_pool));
+
+  log = lookup_history_log(url, start_rev, end_rev, ctx);
+  if (log)
+    log->moves_table = dup_moves_table(b.moves_table, log->pool,
+                                       scratch_pool);
 
   *moves_table = b.moves_table;
 
@@ -2230,8 +2487,6 @@ find_revision_for_suspected_deletion(svn_revnum_t *deleted_rev,
   svn_ra_session_t *ra_session;
   const char *url;
   const char *corrected_url;
-  apr_array_header_t *paths;
-  apr_array_header_t *revprops;
   const char *repos_root_url;
   const char *repos_uuid;
   struct find_deleted_rev_baton b = { 0 };
@@ -2259,12 +2514,6 @@ find_revision_for_suspected_deletion(svn_revnum_t *deleted_rev,
                                                ctx, scratch_pool,
                                                scratch_pool));
 
-  paths = apr_array_make(scratch_pool, 1, sizeof(const char *));
-  APR_ARRAY_PUSH(paths, const char *) = "";
-
-  revprops = apr_array_make(scratch_pool, 1, sizeof(const char *));
-  APR_ARRAY_PUSH(revprops, const char *) = SVN_PROP_REVISION_AUTHOR;
-
   b.victim_abspath = victim_abspath;
   b.deleted_repos_relpath = svn_relpath_join(parent_repos_relpath,
                                              deleted_basename, scratch_pool);
@@ -2281,14 +2530,8 @@ find_revision_for_suspected_deletion(svn_revnum_t *deleted_rev,
   SVN_ERR(svn_ra__dup_session(&b.extra_ra_session, ra_session, NULL,
                               scratch_pool, scratch_pool));
 
-  err = svn_ra_get_log2(ra_session, paths, start_rev, end_rev,
-                        0, /* no limit */
-                        TRUE, /* need the changed paths list */
-                        FALSE, /* need to traverse copies */
-                        FALSE, /* no need for merged revisions */
-                        revprops,
-                        find_deleted_rev, &b,
-                        scratch_pool);
+  err = get_history_log(ra_session, url, start_rev, end_rev,
+                        find_deleted_rev, &b, ctx, scratch_pool);
   if (err)
     {
       if (err->apr_err == SVN_ERR_CEASE_INVOCATION &&
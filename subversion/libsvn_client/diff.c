@@ -1866,6 +1866,11 @@ diff_wc_wc(const char *path1,
                           "or between the working versions of two paths"
                           )));
 
+  SVN_ERR(svn_client__textbase_sync(abspath1,
+                                    depth == svn_depth_unknown
+                                      ? svn_depth_infinity : depth,
+                                    ctx, scratch_pool));
+
   SVN_ERR(svn_wc__diff7(TRUE,
                         ctx->wc_ctx, abspath1, depth,
                         ignore_ancestry, changelists,
@@ -2135,6 +2140,12 @@ diff_repos_wc(struct diff_driver_info_t *ddi,
 
   SVN_ERR(svn_dirent_get_absolute(&abspath2, path2, scratch_pool));
 
+  /* The changes from the repository apply to the pristine texts. */
+  SVN_ERR(svn_client__textbase_sync(abspath2,
+                                    depth == svn_depth_unknown
+                                      ? svn_depth_infinity : depth,
+                                    ctx, scratch_pool));
+
   /* Check if our diff target is a copied node. */
   SVN_ERR(svn_wc__node_get_origin(&is_copy,
                                   &cf_revision,
@@ -2886,6 +2897,70 @@ svn_client_diff_peg7(const apr_array_header_t *options,
                                  diff_processor, ctx, pool, pool));
 }
 
+/* Try to summarize the differences between two repository versions of
+   the same directory from the changed paths of the revisions in between,
+   which is much cheaper than comparing the trees.  Set *HANDLED to TRUE
+   if that worked, or to FALSE if the caller has to do the full diff.
+   The other parameters are as for svn_client_diff_summarize_peg2(). */
+static svn_error_t *
+summarize_repos_repos_from_log(svn_boolean_t *handled,
+                               const char *path_or_url1,
+                               const char *path_or_url2,
+                               const svn_opt_revision_t *revision1,
+                               const svn_opt_revision_t *revision2,
+                               const svn_opt_revision_t *peg_revision,
+                               svn_depth_t depth,
+                               const apr_array_header_t *changelists,
+                               svn_client_diff_summarize_func_t
+                                 summarize_func,
+                               void *summarize_baton,
+                               svn_client_ctx_t *ctx,
+                               apr_pool_t *scratch_pool)
+{
+  svn_boolean_t is_repos1;
+  svn_boolean_t is_repos2;
+  const char *url1;
+  const char *url2;
+  svn_revnum_t rev1;
+  svn_revnum_t rev2;
+  svn_node_kind_t kind1;
+  svn_node_kind_t kind2;
+  const char *anchor1;
+  const char *anchor2;
+  const char *target1;
+  const char *target2;
+  svn_ra_session_t *ra_session;
+
+  *handled = FALSE;
+
+  if ((depth != svn_depth_infinity && depth != svn_depth_unknown)
+      || (changelists && changelists->nelts))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(check_paths(&is_repos1, &is_repos2, path_or_url1, path_or_url2,
+                      revision1, revision2, peg_revision));
+  if (!is_repos1 || !is_repos2)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(diff_prepare_repos_repos(&url1, &url2, &rev1, &rev2,
+                                   &anchor1, &anchor2, &target1, &target2,
+                                   &kind1, &kind2, &ra_session,
+                                   ctx, path_or_url1, path_or_url2,
+                                   revision1, revision2, peg_revision,
+                                   scratch_pool));
+
+  if (kind1 != svn_node_dir || kind2 != svn_node_dir
+      || strcmp(url1, url2) != 0
+      || rev1 >= rev2)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(
+            svn_client__diff_summarize_from_log(handled, ra_session, url1,
+                                                rev1, rev2, summarize_func,
+                                                summarize_baton, ctx,
+                                                scratch_pool));
+}
+
 svn_error_t *
 svn_client_diff_summarize2(const char *path_or_url1,
                            const svn_opt_revision_t *revision1,
@@ -2902,9 +2977,20 @@ svn_client_diff_summarize2(const char *path_or_url1,
   svn_diff_tree_processor_t *diff_processor;
   svn_opt_revision_t peg_revision;
 
+  svn_boolean_t handled;
+
   /* We will never do a pegged diff from here. */
   peg_revision.kind = svn_opt_revision_unspecified;
 
+  SVN_ERR(summarize_repos_repos_from_log(&handled,
+                                         path_or_url1, path_or_url2,
+                                         revision1, revision2, &peg_revision,
+                                         depth, changelists,
+                                         summarize_func, summarize_baton,
+                                         ctx, pool));
+  if (handled)
+    return SVN_NO_ERROR;
+
   SVN_ERR(svn_client__get_diff_summarize_callbacks(&diff_processor,
                      summarize_func, summarize_baton,
                      pool, pool));
@@ -2932,6 +3018,16 @@ svn_client_diff_summarize_peg2(const char *path_or_url,
                                apr_pool_t *pool)
 {
   svn_diff_tree_processor_t *diff_processor;
+  svn_boolean_t handled;
+
+  SVN_ERR(summarize_repos_repos_from_log(&handled,
+                                         path_or_url, path_or_url,
+                                         start_revision, end_revision,
+                                         peg_revision, depth, changelists,
+                                         summarize_func, summarize_baton,
+                                         ctx, pool));
+  if (handled)
+    return SVN_NO_ERROR;
 
   SVN_ERR(svn_client__get_diff_summarize_callbacks(&diff_processor,
                      summarize_func, summarize_baton,
@@ -28,7 +28,10 @@
 #include "svn_path.h"
 #include "svn_props.h"
 #include "svn_pools.h"
+#include "svn_sorts.h"
 
+#include "private/svn_fspath.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_wc_private.h"
 
 #include "client.h"
@@ -286,6 +289,322 @@ svn_client__get_diff_summarize_callbacks(
   return SVN_NO_ERROR;
 }
 
+/* What happened to a node between the two revisions of a summary
+   derived from the log. */
+typedef struct changed_node_t
+{
+  svn_node_kind_t kind;
+
+  /* The actions ('A', 'M' or 'D') of the first and last revision in
+     which the node was changed. */
+  char first_action;
+  char last_action;
+
+  /* Whether any of the revisions changed the contents or the props. */
+  svn_boolean_t text_modified;
+  svn_boolean_t props_modified;
+} changed_node_t;
+
+/* Baton for collect_changes(). */
+typedef struct log_changes_baton_t
+{
+  /* The repository path of the diff target. */
+  const char *target_fspath;
+
+  /* Maps paths relative to the target to changed_node_t *. */
+  apr_hash_t *changes;
+
+  /* Set when a change was found that we can't summarize from the log. */
+  svn_boolean_t unsupported;
+
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+  apr_pool_t *pool;
+} log_changes_baton_t;
+
+/* Implements svn_log_entry_receiver_t, collecting LOG_ENTRY's changed
+   paths below B->TARGET_FSPATH into B->CHANGES. */
+static svn_error_t *
+collect_changes(void *baton,
+                svn_log_entry_t *log_entry,
+                apr_pool_t *scratch_pool)
+{
+  log_changes_baton_t *b = baton;
+  apr_hash_index_t *hi;
+
+  if (b->cancel_func)
+    SVN_ERR(b->cancel_func(b->cancel_baton));
+
+  if (b->unsupported || !log_entry->changed_paths2)
+    return SVN_NO_ERROR;
+
+  for (hi = apr_hash_first(scratch_pool, log_entry->changed_paths2);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *relpath = svn_fspath__skip_ancestor(b->target_fspath,
+                                                      apr_hash_this_key(hi));
+      svn_log_changed_path2_t *change = apr_hash_this_val(hi);
+      changed_node_t *node;
+
+      if (!relpath)
+        continue;
+
+      /* Copies and replacements need a real tree comparison, as do
+         changes the server can't tell us the details of. */
+      if (change->action == 'R'
+          || change->copyfrom_path
+          || change->node_kind == svn_node_unknown
+          || change->text_modified == svn_tristate_unknown
+          || change->props_modified == svn_tristate_unknown
+          || (*relpath == '\0' && change->action != 'M'))
+        {
+          b->unsupported = TRUE;
+          return SVN_NO_ERROR;
+        }
+
+      node = svn_hash_gets(b->changes, relpath);
+      if (!node)
+        {
+          node = apr_pcalloc(b->pool, sizeof(*node));
+          node->kind = change->node_kind;
+          node->first_action = change->action;
+          svn_hash_sets(b->changes, apr_pstrdup(b->pool, relpath), node);
+        }
+      else if (node->last_action == 'D')
+        {
+          /* Deleted and later re-added: the two nodes are unrelated. */
+          b->unsupported = TRUE;
+          return SVN_NO_ERROR;
+        }
+
+      node->last_action = change->action;
+      if (change->text_modified == svn_tristate_true)
+        node->text_modified = TRUE;
+      if (change->props_modified == svn_tristate_true)
+        node->props_modified = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for collect_deleted(). */
+typedef struct deleted_baton_t
+{
+  const char *target_fspath;
+
+  /* Maps paths relative to the target to svn_node_kind_t *. */
+  apr_hash_t *nodes;
+  apr_pool_t *pool;
+} deleted_baton_t;
+
+/* Implements svn_ra_dirent_receiver_t, remembering every node below
+   B->TARGET_FSPATH in B->NODES. */
+static svn_error_t *
+collect_deleted(const char *rel_path,
+                svn_dirent_t *dirent,
+                void *baton,
+                apr_pool_t *scratch_pool)
+{
+  deleted_baton_t *b = baton;
+  svn_node_kind_t *kind;
+
+  rel_path = svn_fspath__skip_ancestor(b->target_fspath, rel_path);
+  if (!rel_path || !*rel_path)
+    return SVN_NO_ERROR;
+
+  kind = apr_palloc(b->pool, sizeof(*kind));
+  *kind = dirent->kind;
+  svn_hash_sets(b->nodes, apr_pstrdup(b->pool, rel_path), kind);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if any parent of RELPATH was deleted according to
+   CHANGES. */
+static svn_boolean_t
+parent_deleted(apr_hash_t *changes,
+               const char *relpath,
+               apr_pool_t *scratch_pool)
+{
+  while (*relpath)
+    {
+      changed_node_t *node;
+
+      relpath = svn_relpath_dirname(relpath, scratch_pool);
+      node = svn_hash_gets(changes, relpath);
+      if (node && node->last_action == 'D')
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+svn_error_t *
+svn_client__diff_summarize_from_log(svn_boolean_t *handled,
+                                    svn_ra_session_t *ra_session,
+                                    const char *url,
+                                    svn_revnum_t rev1,
+                                    svn_revnum_t rev2,
+                                    svn_client_diff_summarize_func_t
+                                      summarize_func,
+                                    void *summarize_baton,
+                                    svn_client_ctx_t *ctx,
+                                    apr_pool_t *scratch_pool)
+{
+  struct summarize_baton_t sb;
+  log_changes_baton_t lb;
+  deleted_baton_t db;
+  const char *target_relpath;
+  apr_array_header_t *segments;
+  svn_location_segment_t *segment;
+  apr_array_header_t *paths;
+  apr_array_header_t *sorted;
+  apr_pool_t *iterpool;
+  svn_error_t *err;
+  int i;
+
+  *handled = FALSE;
+
+  SVN_ERR(svn_ra_reparent(ra_session, url, scratch_pool));
+  SVN_ERR(svn_ra_get_path_relative_to_root(ra_session, &target_relpath,
+                                           url, scratch_pool));
+
+  /* URL must be the same node throughout the whole range. */
+  SVN_ERR(svn_client__repos_location_segments(&segments, ra_session, url,
+                                              rev2, rev2, rev1, ctx,
+                                              scratch_pool));
+  if (segments->nelts != 1)
+    return SVN_NO_ERROR;
+
+  segment = APR_ARRAY_IDX(segments, 0, svn_location_segment_t *);
+  if (!segment->path
+      || strcmp(svn_relpath_canonicalize(segment->path, scratch_pool),
+                target_relpath)
+      || segment->range_start > rev1)
+    return SVN_NO_ERROR;
+
+  lb.target_fspath = svn_fspath__canonicalize(target_relpath, scratch_pool);
+  lb.changes = apr_hash_make(scratch_pool);
+  lb.unsupported = FALSE;
+  lb.cancel_func = ctx->cancel_func;
+  lb.cancel_baton = ctx->cancel_baton;
+  lb.pool = scratch_pool;
+
+  paths = apr_array_make(scratch_pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(paths, const char *) = "";
+
+  SVN_ERR(svn_ra_get_log2(ra_session, paths, rev1 + 1, rev2, 0,
+                          TRUE /* discover_changed_paths */,
+                          TRUE /* strict_node_history */,
+                          FALSE /* include_merged_revisions */,
+                          apr_array_make(scratch_pool, 0,
+                                         sizeof(const char *)),
+                          collect_changes, &lb, scratch_pool));
+  if (lb.unsupported)
+    return SVN_NO_ERROR;
+
+  /* Deleting a directory deletes everything it contained in REV1.  Find
+     those nodes before reporting anything, so that we can still fall
+     back if the server can't list them. */
+  db.target_fspath = lb.target_fspath;
+  db.nodes = apr_hash_make(scratch_pool);
+  db.pool = scratch_pool;
+
+  iterpool = svn_pool_create(scratch_pool);
+  sorted = svn_sort__hash(lb.changes, svn_sort_compare_items_as_paths,
+                          scratch_pool);
+  for (i = 0; i < sorted->nelts; i++)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i, svn_sort__item_t);
+      const char *relpath = item->key;
+      changed_node_t *node = item->value;
+
+      svn_pool_clear(iterpool);
+
+      if (node->kind != svn_node_dir
+          || node->first_action == 'A'
+          || node->last_action != 'D'
+          || parent_deleted(lb.changes, relpath, iterpool))
+        continue;
+
+      err = svn_ra_list(ra_session, relpath, rev1, NULL, svn_depth_infinity,
+                        SVN_DIRENT_KIND, collect_deleted, &db, iterpool);
+      if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+        {
+          svn_error_clear(err);
+          svn_pool_destroy(iterpool);
+          return SVN_NO_ERROR;
+        }
+      SVN_ERR(err);
+    }
+
+  *handled = TRUE;
+
+  sb.summarize_func = summarize_func;
+  sb.summarize_func_baton = summarize_baton;
+
+  for (i = 0; i < sorted->nelts; i++)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i, svn_sort__item_t);
+      const char *relpath = item->key;
+      changed_node_t *node = item->value;
+
+      svn_pool_clear(iterpool);
+
+      if (ctx->cancel_func)
+        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
+
+      if (parent_deleted(lb.changes, relpath, iterpool))
+        continue;
+
+      if (node->first_action == 'A')
+        {
+          if (node->last_action != 'D')
+            SVN_ERR(send_summary(&sb, relpath,
+                                 svn_client_diff_summarize_kind_added,
+                                 node->props_modified, node->kind,
+                                 iterpool));
+        }
+      else if (node->last_action == 'D')
+        {
+          SVN_ERR(send_summary(&sb, relpath,
+                               svn_client_diff_summarize_kind_deleted,
+                               FALSE, node->kind, iterpool));
+        }
+      else if (node->kind == svn_node_file && node->text_modified)
+        {
+          SVN_ERR(send_summary(&sb, relpath,
+                               svn_client_diff_summarize_kind_modified,
+                               node->props_modified, node->kind, iterpool));
+        }
+      else if (node->props_modified)
+        {
+          SVN_ERR(send_summary(&sb, relpath,
+                               svn_client_diff_summarize_kind_normal,
+                               TRUE, node->kind, iterpool));
+        }
+    }
+
+  /* The descendants of deleted directories follow their parents. */
+  sorted = svn_sort__hash(db.nodes, svn_sort_compare_items_as_paths,
+                          scratch_pool);
+  for (i = 0; i < sorted->nelts; i++)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i, svn_sort__item_t);
+      svn_node_kind_t *kind = item->value;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(send_summary(&sb, item->key,
+                           svn_client_diff_summarize_kind_deleted,
+                           FALSE, *kind, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 svn_client_diff_summarize_t *
 svn_client_diff_summarize_dup(const svn_client_diff_summarize_t *diff,
                               apr_pool_t *pool)
@@ -38,9 +38,13 @@
 #include "svn_path.h"
 #include "svn_props.h"
 #include "svn_config.h"
+#include "svn_sorts.h"
 #include "client.h"
 
 #include "svn_private_config.h"
+#include "private/svn_auth_private.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_pool.h"
 #include "private/svn_wc_private.h"
 
 
@@ -745,6 +749,9 @@ handle_external_item_removal(const svn_client_ctx_t *ctx,
   return svn_error_trace(err);
 }
 
+/* Check out or update the external NEW_ITEM at LOCAL_ABSPATH, defined on
+   PARENT_DIR_ABSPATH.  If FILE_DEFERRED is not NULL, leave file externals
+   alone and set *FILE_DEFERRED to whether NEW_ITEM is one. */
 static svn_error_t *
 handle_external_item_change(svn_client_ctx_t *ctx,
                             const char *repos_root_url,
@@ -755,6 +762,7 @@ handle_external_item_change(svn_client_ctx_t *ctx,
                             const svn_wc_external_item2_t *new_item,
                             svn_ra_session_t *ra_session,
                             svn_boolean_t *timestamp_sleep,
+                            svn_boolean_t *file_deferred,
                             apr_pool_t *scratch_pool)
 {
   svn_client__pathrev_t *new_loc;
@@ -825,6 +833,14 @@ handle_external_item_change(svn_client_ctx_t *ctx,
                                "or a directory"),
                              new_loc->url, new_loc->rev);
 
+  /* File externals are recorded in the defining working copy, which only
+     the caller's context has locked. */
+  if (file_deferred)
+    {
+      *file_deferred = (ext_kind == svn_node_file);
+      if (*file_deferred)
+        return SVN_NO_ERROR;
+    }
 
   /* Not protecting against recursive externals.  Detecting them in
      the global case is hard, and it should be pretty obvious to a
@@ -958,6 +974,410 @@ wrap_external_error(const svn_client_ctx_t *ctx,
   return err;
 }
 
+/* Directory externals being checked out or updated concurrently.  Only
+   defined if APR has threads. */
+typedef struct externals_fetcher_t externals_fetcher_t;
+
+#if APR_HAS_THREADS
+
+/* A directory external to be checked out or updated on a worker thread.
+   Everything but the results is set up before the job is queued. */
+typedef struct external_job_t
+{
+  /* The arguments of handle_external_item_change(). */
+  const char *repos_root_url;
+  const char *parent_dir_abspath;
+  const char *parent_dir_url;
+  const char *target_abspath;
+  const char *old_defining_abspath;
+  svn_wc_external_item2_t *new_item;
+
+  /* A client context with a working copy context and a configuration of
+     its own, whose callbacks are serialized with those of the other
+     jobs. */
+  svn_client_ctx_t *ctx;
+
+  /* Results, written by the worker that ran the job. */
+  svn_boolean_t timestamp_sleep;
+  svn_boolean_t file_deferred;
+  svn_error_t *err;
+
+  /* The job running this on a worker, or NULL if we ran it ourselves. */
+  svn_thread_pool__job_t *job;
+
+  /* A root pool, used by the worker only while it runs the job. */
+  apr_pool_t *pool;
+} external_job_t;
+
+struct externals_fetcher_t
+{
+  /* The context of the caller, only used on its thread or with
+     CALLBACK_MUTEX held. */
+  svn_client_ctx_t *ctx;
+
+  /* The configuration the contexts of the jobs are copied from. */
+  apr_hash_t *config;
+
+  /* external_job_t *, in the order they were queued. */
+  apr_array_header_t *jobs;
+
+  /* Serializes the calls to the callbacks of CTX. */
+  svn_mutex__t *callback_mutex;
+
+  /* The workers running the jobs. */
+  svn_thread_pool__t *thread_pool;
+
+  /* The pool the job pools get cleaned up with. */
+  apr_pool_t *pool;
+};
+
+/* Implements svn_wc_notify_func2_t, for the externals_fetcher_t BATON. */
+static void
+fetcher_notify(void *baton,
+               const svn_wc_notify_t *notify,
+               apr_pool_t *pool)
+{
+  externals_fetcher_t *fetcher = baton;
+  svn_error_t *err = svn_mutex__lock(fetcher->callback_mutex);
+
+  if (err)
+    {
+      svn_error_clear(err);
+      return;
+    }
+
+  fetcher->ctx->notify_func2(fetcher->ctx->notify_baton2, notify, pool);
+  svn_error_clear(svn_mutex__unlock(fetcher->callback_mutex, SVN_NO_ERROR));
+}
+
+/* Implements svn_cancel_func_t, for the externals_fetcher_t BATON. */
+static svn_error_t *
+fetcher_cancel(void *baton)
+{
+  externals_fetcher_t *fetcher = baton;
+
+  SVN_MUTEX__WITH_LOCK(fetcher->callback_mutex,
+                       fetcher->ctx->cancel_func(fetcher->ctx->cancel_baton));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_progress_notify_func_t, for the externals_fetcher_t
+   BATON. */
+static void
+fetcher_progress(apr_off_t progress,
+                 apr_off_t total,
+                 void *baton,
+                 apr_pool_t *pool)
+{
+  externals_fetcher_t *fetcher = baton;
+  svn_error_t *err = svn_mutex__lock(fetcher->callback_mutex);
+
+  if (err)
+    {
+      svn_error_clear(err);
+      return;
+    }
+
+  fetcher->ctx->progress_func(progress, total, fetcher->ctx->progress_baton,
+                              pool);
+  svn_error_clear(svn_mutex__unlock(fetcher->callback_mutex, SVN_NO_ERROR));
+}
+
+/* Implements svn_wc_conflict_resolver_func2_t, for the
+   externals_fetcher_t BATON. */
+static svn_error_t *
+fetcher_resolve_conflict(svn_wc_conflict_result_t **result,
+                         const svn_wc_conflict_description2_t *description,
+                         void *baton,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  externals_fetcher_t *fetcher = baton;
+
+  SVN_MUTEX__WITH_LOCK(fetcher->callback_mutex,
+                       fetcher->ctx->conflict_func2(
+                                            result, description,
+                                            fetcher->ctx->conflict_baton2,
+                                            result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Run the external_job_t given
+   as JOB_BATON and store the results in it. */
+static svn_error_t *
+run_external_job(void *job_baton,
+                 void *worker_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  external_job_t *job = job_baton;
+
+  job->err = handle_external_item_change(job->ctx,
+                                         job->repos_root_url,
+                                         job->parent_dir_abspath,
+                                         job->parent_dir_url,
+                                         job->target_abspath,
+                                         job->old_defining_abspath,
+                                         job->new_item,
+                                         NULL /* ra_session */,
+                                         &job->timestamp_sleep,
+                                         &job->file_deferred,
+                                         job->pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *FETCHER to up to JOBS threads checking out and updating the
+   directory externals of an operation using CTX, allocated in
+   RESULT_POOL.  Set *FETCHER to NULL if there would be less than two. */
+static svn_error_t *
+start_externals_fetcher(externals_fetcher_t **fetcher,
+                        svn_client_ctx_t *ctx,
+                        int jobs,
+                        apr_pool_t *result_pool)
+{
+  externals_fetcher_t *f;
+
+  *fetcher = NULL;
+  if (jobs < 2)
+    return SVN_NO_ERROR;
+
+  f = apr_pcalloc(result_pool, sizeof(*f));
+  f->ctx = ctx;
+  f->jobs = apr_array_make(result_pool, jobs, sizeof(external_job_t *));
+  f->pool = result_pool;
+
+  /* Reading a configuration may change it, so each job gets a copy.
+     Externals of externals are handled serially by their job. */
+  if (ctx->config)
+    {
+      svn_config_t *cfg;
+
+      SVN_ERR(svn_config_copy_config(&f->config, ctx->config, result_pool));
+      cfg = svn_hash_gets(f->config, SVN_CONFIG_CATEGORY_CONFIG);
+      if (cfg)
+        svn_config_set(cfg, SVN_CONFIG_SECTION_MISCELLANY,
+                       SVN_CONFIG_OPTION_EXTERNALS_JOBS, "1");
+    }
+
+  /* The jobs open sessions with the authentication baton of CTX. */
+  if (ctx->auth_baton)
+    SVN_ERR(svn_auth__make_thread_safe(ctx->auth_baton));
+
+  SVN_ERR(svn_mutex__init(&f->callback_mutex, TRUE, result_pool));
+  SVN_ERR(svn_thread_pool__create(&f->thread_pool, jobs, NULL, NULL,
+                                  result_pool));
+
+  *fetcher = f;
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait for the jobs queued in FETCHER to finish, then report their
+   results in the order they were queued, as handle_externals_change()
+   would have.  Handle the file externals they left to us now, using
+   RA_SESSION if not NULL.  Set *TIMESTAMP_SLEEP to TRUE if any job
+   requires a sleep.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+finish_externals(externals_fetcher_t *fetcher,
+                 svn_boolean_t *timestamp_sleep,
+                 svn_ra_session_t *ra_session,
+                 apr_pool_t *scratch_pool)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_pool_t *iterpool;
+  int i;
+
+  /* Any jobs left pending get discarded by stop_externals_fetcher(). */
+  for (i = 0; i < fetcher->jobs->nelts; i++)
+    {
+      external_job_t *job = APR_ARRAY_IDX(fetcher->jobs, i, external_job_t *);
+
+      if (job->job)
+        SVN_ERR(svn_thread_pool__wait(fetcher->thread_pool, job->job,
+                                      NULL, NULL));
+      job->job = NULL;
+    }
+
+  /* All jobs are done now, so we may use CTX freely. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < fetcher->jobs->nelts; i++)
+    {
+      external_job_t *job = APR_ARRAY_IDX(fetcher->jobs, i, external_job_t *);
+      svn_error_t *job_err = job->err;
+
+      svn_pool_clear(iterpool);
+
+      if (job->timestamp_sleep)
+        *timestamp_sleep = TRUE;
+
+      if (!err && !job_err && job->file_deferred)
+        job_err = handle_external_item_change(fetcher->ctx,
+                                              job->repos_root_url,
+                                              job->parent_dir_abspath,
+                                              job->parent_dir_url,
+                                              job->target_abspath,
+                                              job->old_defining_abspath,
+                                              job->new_item, ra_session,
+                                              timestamp_sleep, NULL,
+                                              iterpool);
+
+      if (!err)
+        err = wrap_external_error(fetcher->ctx, job->target_abspath, job_err,
+                                  iterpool);
+      else
+        svn_error_clear(job_err);
+
+      svn_thread_pool__destroy_root_pool(job->pool, fetcher->pool);
+    }
+
+  apr_array_clear(fetcher->jobs);
+
+  svn_pool_destroy(iterpool);
+  return svn_error_trace(err);
+}
+
+/* Queue checking out or updating the external NEW_ITEM at TARGET_ABSPATH,
+   defined on PARENT_DIR_ABSPATH, on the workers of FETCHER; the other
+   arguments are as for handle_external_item_change().  If a queued one
+   is within this one or vice versa, wait for the queued ones to finish
+   first, passing TIMESTAMP_SLEEP and RA_SESSION to finish_externals().
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+queue_external(externals_fetcher_t *fetcher,
+               const char *repos_root_url,
+               const char *parent_dir_abspath,
+               const char *parent_dir_url,
+               const char *target_abspath,
+               const char *old_defining_abspath,
+               const svn_wc_external_item2_t *new_item,
+               svn_boolean_t *timestamp_sleep,
+               svn_ra_session_t *ra_session,
+               apr_pool_t *scratch_pool)
+{
+  external_job_t *job;
+  svn_client_ctx_t *ctx = fetcher->ctx;
+  svn_client_ctx_t *job_ctx;
+  svn_wc_context_t *wc_ctx;
+  apr_hash_t *config = NULL;
+  apr_pool_t *pool;
+  svn_error_t *err;
+  int i;
+
+  for (i = 0; i < fetcher->jobs->nelts; i++)
+    {
+      job = APR_ARRAY_IDX(fetcher->jobs, i, external_job_t *);
+
+      if (svn_dirent_is_ancestor(job->target_abspath, target_abspath)
+          || svn_dirent_is_ancestor(target_abspath, job->target_abspath))
+        {
+          SVN_ERR(finish_externals(fetcher, timestamp_sleep, ra_session,
+                                   scratch_pool));
+          break;
+        }
+    }
+
+  pool = svn_thread_pool__create_root_pool(fetcher->pool);
+
+  job = apr_pcalloc(pool, sizeof(*job));
+  job->pool = pool;
+  job->repos_root_url = apr_pstrdup(pool, repos_root_url);
+  job->parent_dir_abspath = apr_pstrdup(pool, parent_dir_abspath);
+  job->parent_dir_url = apr_pstrdup(pool, parent_dir_url);
+  job->target_abspath = apr_pstrdup(pool, target_abspath);
+  job->old_defining_abspath = apr_pstrdup(pool, old_defining_abspath);
+  job->new_item = svn_wc_external_item2_dup(new_item, pool);
+
+  if (fetcher->config)
+    SVN_ERR(svn_config_copy_config(&config, fetcher->config, pool));
+
+  SVN_ERR(svn_client_create_context2(&job_ctx, config, pool));
+  wc_ctx = job_ctx->wc_ctx;
+  *job_ctx = *ctx;
+  job_ctx->wc_ctx = wc_ctx;
+  job_ctx->config = config;
+
+  job_ctx->notify_func = NULL;
+  job_ctx->notify_baton = NULL;
+  job_ctx->notify_func2 = ctx->notify_func2 ? fetcher_notify : NULL;
+  job_ctx->notify_baton2 = fetcher;
+  job_ctx->cancel_func = ctx->cancel_func ? fetcher_cancel : NULL;
+  job_ctx->cancel_baton = fetcher;
+  job_ctx->progress_func = ctx->progress_func ? fetcher_progress : NULL;
+  job_ctx->progress_baton = fetcher;
+  job_ctx->conflict_func = NULL;
+  job_ctx->conflict_baton = NULL;
+  job_ctx->conflict_func2 = ctx->conflict_func2 ? fetcher_resolve_conflict
+                                                : NULL;
+  job_ctx->conflict_baton2 = fetcher;
+  job->ctx = job_ctx;
+
+  APR_ARRAY_PUSH(fetcher->jobs, external_job_t *) = job;
+
+  /* Run it ourselves if no worker could be started. */
+  err = svn_thread_pool__submit(&job->job, fetcher->thread_pool,
+                                run_external_job, job);
+  if (err)
+    {
+      svn_error_clear(err);
+      job->job = NULL;
+      SVN_ERR(run_external_job(job, NULL, NULL, NULL, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Make the workers of FETCHER terminate once they are done with their
+   current job, and wait for them.  Set *TIMESTAMP_SLEEP to TRUE if any
+   job that ran requires a sleep, and discard the results of all queued
+   jobs. */
+static svn_error_t *
+stop_externals_fetcher(externals_fetcher_t *fetcher,
+                       svn_boolean_t *timestamp_sleep)
+{
+  svn_error_t *err;
+  int i;
+
+  err = svn_thread_pool__join(fetcher->thread_pool, TRUE);
+
+  for (i = 0; i < fetcher->jobs->nelts; i++)
+    {
+      external_job_t *job = APR_ARRAY_IDX(fetcher->jobs, i, external_job_t *);
+
+      if (job->timestamp_sleep)
+        *timestamp_sleep = TRUE;
+      svn_error_clear(job->err);
+    }
+  apr_array_clear(fetcher->jobs);
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* Check for cancellation through CTX, serialized with the callbacks of
+   the externals FETCHER is working on, if not NULL. */
+static svn_error_t *
+check_cancel(svn_client_ctx_t *ctx,
+             externals_fetcher_t *fetcher)
+{
+  if (!ctx->cancel_func)
+    return SVN_NO_ERROR;
+
+#if APR_HAS_THREADS
+  if (fetcher)
+    return svn_error_trace(fetcher_cancel(fetcher));
+#endif
+
+  return svn_error_trace(ctx->cancel_func(ctx->cancel_baton));
+}
+
+/* Handle the changed svn:externals description NEW_DESC_TEXT on
+   LOCAL_ABSPATH.  If FETCHER is not NULL, queue the externals on it
+   instead of handling them right away. */
 static svn_error_t *
 handle_externals_change(svn_client_ctx_t *ctx,
                         const char *repos_root_url,
@@ -968,6 +1388,7 @@ handle_externals_change(svn_client_ctx_t *ctx,
                         svn_depth_t ambient_depth,
                         svn_depth_t requested_depth,
                         svn_ra_session_t *ra_session,
+                        externals_fetcher_t *fetcher,
                         apr_pool_t *scratch_pool)
 {
   apr_array_header_t *new_desc;
@@ -1009,8 +1430,7 @@ handle_externals_change(svn_client_ctx_t *ctx,
 
       svn_pool_clear(iterpool);
 
-      if (ctx->cancel_func)
-        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
+      SVN_ERR(check_cancel(ctx, fetcher));
 
       SVN_ERR(svn_dirent_is_under_root(&under_root, &target_abspath,
                                        local_abspath, new_item->target_dir,
@@ -1029,7 +1449,15 @@ handle_externals_change(svn_client_ctx_t *ctx,
 
       old_defining_abspath = svn_hash_gets(old_externals, target_abspath);
 
-      SVN_ERR(wrap_external_error(
+#if APR_HAS_THREADS
+      if (fetcher)
+        SVN_ERR(queue_external(fetcher, repos_root_url, local_abspath, url,
+                               target_abspath, old_defining_abspath,
+                               new_item, timestamp_sleep, ra_session,
+                               iterpool));
+      else
+#endif
+        SVN_ERR(wrap_external_error(
                       ctx, target_abspath,
                       handle_external_item_change(ctx,
                                                   repos_root_url,
@@ -1037,7 +1465,7 @@ handle_externals_change(svn_client_ctx_t *ctx,
                                                   target_abspath,
                                                   old_defining_abspath,
                                                   new_item, ra_session,
-                                                  timestamp_sleep,
+                                                  timestamp_sleep, NULL,
                                                   iterpool),
                       iterpool));
 
@@ -1066,6 +1494,8 @@ svn_client__handle_externals(apr_hash_t *externals_new,
   apr_hash_t *old_external_defs;
   apr_hash_index_t *hi;
   apr_pool_t *iterpool;
+  externals_fetcher_t *fetcher = NULL;
+  svn_error_t *err = SVN_NO_ERROR;
 
   SVN_ERR_ASSERT(repos_root_url);
 
@@ -1075,8 +1505,29 @@ svn_client__handle_externals(apr_hash_t *externals_new,
                                           ctx->wc_ctx, target_abspath,
                                           scratch_pool, iterpool));
 
+#if APR_HAS_THREADS
+  {
+    svn_config_t *cfg = ctx->config
+                        ? svn_hash_gets(ctx->config,
+                                        SVN_CONFIG_CATEGORY_CONFIG)
+                        : NULL;
+    apr_int64_t externals_jobs;
+
+    /* See how many directory externals the user wants to fetch
+       concurrently. */
+    SVN_ERR(svn_config_get_int64(cfg, &externals_jobs,
+                                 SVN_CONFIG_SECTION_MISCELLANY,
+                                 SVN_CONFIG_OPTION_EXTERNALS_JOBS, 1));
+    if (apr_hash_count(externals_new))
+      SVN_ERR(start_externals_fetcher(&fetcher, ctx,
+                                      (int)MIN(externals_jobs,
+                                               APR_INT32_MAX),
+                                      scratch_pool));
+  }
+#endif
+
   for (hi = apr_hash_first(scratch_pool, externals_new);
-       hi;
+       hi && !err;
        hi = apr_hash_next(hi))
     {
       const char *local_abspath = apr_hash_this_key(hi);
@@ -1094,10 +1545,11 @@ svn_client__handle_externals(apr_hash_t *externals_new,
 
           if (ambient_depth_w == NULL)
             {
-              return svn_error_createf(
+              err = svn_error_createf(
                         SVN_ERR_WC_CORRUPT, NULL,
                         _("Traversal of '%s' found no ambient depth"),
                         svn_dirent_local_style(local_abspath, scratch_pool));
+              break;
             }
           else
             {
@@ -1105,12 +1557,26 @@ svn_client__handle_externals(apr_hash_t *externals_new,
             }
         }
 
-      SVN_ERR(handle_externals_change(ctx, repos_root_url, timestamp_sleep,
-                                      local_abspath,
-                                      desc_text, old_external_defs,
-                                      ambient_depth, requested_depth,
-                                      ra_session, iterpool));
+      err = handle_externals_change(ctx, repos_root_url, timestamp_sleep,
+                                    local_abspath,
+                                    desc_text, old_external_defs,
+                                    ambient_depth, requested_depth,
+                                    ra_session, fetcher, iterpool);
+    }
+
+#if APR_HAS_THREADS
+  if (fetcher)
+    {
+      if (!err)
+        err = finish_externals(fetcher, timestamp_sleep, ra_session,
+                               iterpool);
+
+      err = svn_error_compose_create(err,
+                                     stop_externals_fetcher(fetcher,
+                                                            timestamp_sleep));
     }
+#endif
+  SVN_ERR(err);
 
   /* Remove the remaining externals */
   for (hi = apr_hash_first(scratch_pool, old_external_defs);
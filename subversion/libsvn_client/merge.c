@@ -314,6 +314,10 @@ typedef struct merge_cmd_baton_t {
   const char *diff3_cmd;
   const apr_array_header_t *merge_options;
 
+  /* Queue for the text merges of changed files.  Flushed at the end of
+     each editor drive. */
+  svn_wc__merge_queue_t *merge_queue;
+
   /* Array of file extension patterns to preserve as extensions in
      generated conflict files. */
   const apr_array_header_t *ext_patterns;
@@ -333,6 +337,10 @@ typedef struct merge_cmd_baton_t {
      afterwards to ensure timestamp integrity, or unchanged if not. */
   svn_boolean_t *use_sleep;
 
+  /* Mergeinfo and natural history already fetched from the repository
+     while planning this merge.  Shared by all merge sources. */
+  svn_client__mergeinfo_cache_t *mergeinfo_cache;
+
   /* Pool which has a lifetime limited to one iteration over a given
      merge source, i.e. it is cleared on every call to do_directory_merge()
      or do_file_merge() in do_merge(). */
@@ -2009,6 +2017,63 @@ merge_file_opened(void **new_file_baton,
   return SVN_NO_ERROR;
 }
 
+/* Baton for merge_file_text_done(). */
+typedef struct merge_file_text_baton_t
+{
+  merge_cmd_baton_t *merge_b;
+
+  /* Whether the target had local modifications before the merge. */
+  svn_boolean_t has_local_mods;
+} merge_file_text_baton_t;
+
+/* Implements svn_wc__merge_done_func_t.  Record and notify the outcome of
+ * a text merge queued by merge_file_changed().
+ */
+static svn_error_t *
+merge_file_text_done(void *baton,
+                     const char *local_abspath,
+                     enum svn_wc_merge_outcome_t content_outcome,
+                     svn_wc_notify_state_t property_state,
+                     apr_pool_t *scratch_pool)
+{
+  merge_file_text_baton_t *b = baton;
+  merge_cmd_baton_t *merge_b = b->merge_b;
+  svn_wc_notify_state_t text_state;
+
+  if (content_outcome == svn_wc_merge_conflict
+      || property_state == svn_wc_notify_state_conflicted)
+    {
+      alloc_and_store_path(&merge_b->conflicted_paths, local_abspath,
+                           merge_b->pool);
+    }
+
+  if (content_outcome == svn_wc_merge_conflict)
+    text_state = svn_wc_notify_state_conflicted;
+  else if (b->has_local_mods
+           && content_outcome != svn_wc_merge_unchanged)
+    text_state = svn_wc_notify_state_merged;
+  else if (content_outcome == svn_wc_merge_merged)
+    text_state = svn_wc_notify_state_changed;
+  else if (content_outcome == svn_wc_merge_no_merge)
+    text_state = svn_wc_notify_state_missing;
+  else /* merge_outcome == svn_wc_merge_unchanged */
+    text_state = svn_wc_notify_state_unchanged;
+
+  if (text_state == svn_wc_notify_state_conflicted
+      || text_state == svn_wc_notify_state_merged
+      || text_state == svn_wc_notify_state_changed
+      || property_state == svn_wc_notify_state_conflicted
+      || property_state == svn_wc_notify_state_merged
+      || property_state == svn_wc_notify_state_changed)
+    {
+      SVN_ERR(record_update_update(merge_b, local_abspath, svn_node_file,
+                                   text_state, property_state,
+                                   scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* An svn_diff_tree_processor_t function.
  *
  * Called after merge_file_opened() when a node receives only text and/or
@@ -2038,7 +2103,6 @@ merge_file_changed(const char *relpath,
                                               relpath, scratch_pool);
   const svn_wc_conflict_version_t *left;
   const svn_wc_conflict_version_t *right;
-  svn_wc_notify_state_t text_state;
   svn_wc_notify_state_t property_state;
 
   SVN_ERR_ASSERT(local_abspath && svn_dirent_is_absolute(local_abspath));
@@ -2062,12 +2126,11 @@ merge_file_changed(const char *relpath,
     }
 
   /* This callback is essentially no more than a wrapper around
-     svn_wc_merge5().  Thank goodness that all the
+     svn_wc__merge_queue_add().  Thank goodness that all the
      diff-editor-mechanisms are doing the hard work of getting the
      fulltexts! */
 
   property_state = svn_wc_notify_state_unchanged;
-  text_state = svn_wc_notify_state_unchanged;
 
   SVN_ERR(prepare_merge_props_changed(&prop_changes, local_abspath,
                                       prop_changes, merge_b,
@@ -2103,7 +2166,7 @@ merge_file_changed(const char *relpath,
   else if (left_file)
     {
       svn_boolean_t has_local_mods;
-      enum svn_wc_merge_outcome_t content_outcome;
+      merge_file_text_baton_t *text_baton;
       const char *target_label;
       const char *left_label;
       const char *right_label;
@@ -2138,49 +2201,34 @@ merge_file_changed(const char *relpath,
       SVN_ERR(svn_wc_text_modified_p2(&has_local_mods, ctx->wc_ctx,
                                       local_abspath, FALSE, scratch_pool));
 
+      /* The baton must survive until the merge has been installed. */
+      text_baton = apr_pcalloc(merge_b->pool, sizeof(*text_baton));
+      text_baton->merge_b = merge_b;
+      text_baton->has_local_mods = has_local_mods;
+
       /* Do property merge and text merge in one step so that keyword expansion
          takes into account the new property values. */
-      SVN_ERR(svn_wc_merge5(&content_outcome, &property_state, ctx->wc_ctx,
-                            left_file, right_file, local_abspath,
-                            left_label, right_label, target_label,
-                            left, right,
-                            merge_b->dry_run, merge_b->diff3_cmd,
-                            merge_b->merge_options,
-                            left_props, prop_changes,
-                            NULL, NULL,
-                            ctx->cancel_func,
-                            ctx->cancel_baton,
-                            scratch_pool));
-
-      if (content_outcome == svn_wc_merge_conflict
-          || property_state == svn_wc_notify_state_conflicted)
-        {
-          alloc_and_store_path(&merge_b->conflicted_paths, local_abspath,
-                               merge_b->pool);
-        }
+      SVN_ERR(svn_wc__merge_queue_add(merge_b->merge_queue,
+                                      left_file, right_file, local_abspath,
+                                      left_label, right_label, target_label,
+                                      left, right,
+                                      merge_b->dry_run, merge_b->diff3_cmd,
+                                      merge_b->merge_options,
+                                      left_props, prop_changes,
+                                      TRUE /* merge_props */,
+                                      merge_file_text_done, text_baton,
+                                      scratch_pool));
 
-      if (content_outcome == svn_wc_merge_conflict)
-        text_state = svn_wc_notify_state_conflicted;
-      else if (has_local_mods
-               && content_outcome != svn_wc_merge_unchanged)
-        text_state = svn_wc_notify_state_merged;
-      else if (content_outcome == svn_wc_merge_merged)
-        text_state = svn_wc_notify_state_changed;
-      else if (content_outcome == svn_wc_merge_no_merge)
-        text_state = svn_wc_notify_state_missing;
-      else /* merge_outcome == svn_wc_merge_unchanged */
-        text_state = svn_wc_notify_state_unchanged;
+      return SVN_NO_ERROR;
     }
 
-  if (text_state == svn_wc_notify_state_conflicted
-      || text_state == svn_wc_notify_state_merged
-      || text_state == svn_wc_notify_state_changed
-      || property_state == svn_wc_notify_state_conflicted
+  if (property_state == svn_wc_notify_state_conflicted
       || property_state == svn_wc_notify_state_merged
       || property_state == svn_wc_notify_state_changed)
     {
       SVN_ERR(record_update_update(merge_b, local_abspath, svn_node_file,
-                                   text_state, property_state,
+                                   svn_wc_notify_state_unchanged,
+                                   property_state,
                                    scratch_pool));
     }
 
@@ -4271,6 +4319,7 @@ fix_deleted_subtree_ranges(const merge_source_t *source,
 
    RA_SESSION is an RA session open to the repository in which TARGET_ABSPATH
    lives.  It may be temporarily reparented as needed by this function.
+   If CACHE is not NULL, answer questions for the repository from it.
 
    Allocate *RECORDED_MERGEINFO and *IMPLICIT_MERGEINFO in RESULT_POOL.
    Use SCRATCH_POOL for any temporary allocations. */
@@ -4283,6 +4332,7 @@ get_full_mergeinfo(svn_mergeinfo_t *recorded_mergeinfo,
                    const char *target_abspath,
                    svn_revnum_t start,
                    svn_revnum_t end,
+                   svn_client__mergeinfo_cache_t *cache,
                    svn_client_ctx_t *ctx,
                    apr_pool_t *result_pool,
                    apr_pool_t *scratch_pool)
@@ -4290,13 +4340,10 @@ get_full_mergeinfo(svn_mergeinfo_t *recorded_mergeinfo,
   /* First, we get the real mergeinfo. */
   if (recorded_mergeinfo)
     {
-      SVN_ERR(svn_client__get_wc_or_repos_mergeinfo(recorded_mergeinfo,
-                                                    inherited,
-                                                    NULL /* from_repos */,
-                                                    FALSE,
-                                                    inherit, ra_session,
-                                                    target_abspath,
-                                                    ctx, result_pool));
+      SVN_ERR(svn_client__get_wc_or_repos_mergeinfo_cached(
+                recorded_mergeinfo, inherited, NULL /* from_repos */, FALSE,
+                inherit, cache, ra_session, target_abspath, ctx,
+                result_pool));
     }
 
   if (implicit_mergeinfo)
@@ -4337,11 +4384,9 @@ get_full_mergeinfo(svn_mergeinfo_t *recorded_mergeinfo,
             start = target->rev;
 
           /* Fetch the implicit mergeinfo. */
-          SVN_ERR(svn_client__get_history_as_mergeinfo(implicit_mergeinfo,
-                                                       NULL,
-                                                       target, start, end,
-                                                       ra_session, ctx,
-                                                       result_pool));
+          SVN_ERR(svn_client__get_history_as_mergeinfo_cached(
+                    implicit_mergeinfo, NULL, target, start, end, cache,
+                    ra_session, ctx, result_pool));
         }
     } /*if (implicit_mergeinfo) */
 
@@ -4370,6 +4415,7 @@ inherit_implicit_mergeinfo_from_parent(svn_client__merge_path_t *parent,
                                        svn_revnum_t revision1,
                                        svn_revnum_t revision2,
                                        svn_ra_session_t *ra_session,
+                                       svn_client__mergeinfo_cache_t *cache,
                                        svn_client_ctx_t *ctx,
                                        apr_pool_t *result_pool,
                                        apr_pool_t *scratch_pool)
@@ -4388,7 +4434,7 @@ inherit_implicit_mergeinfo_from_parent(svn_client__merge_path_t *parent,
                                ra_session, child->abspath,
                                MAX(revision1, revision2),
                                MIN(revision1, revision2),
-                               ctx, result_pool, scratch_pool));
+                               cache, ctx, result_pool, scratch_pool));
 
   /* Let CHILD inherit PARENT's implicit mergeinfo. */
 
@@ -4427,6 +4473,7 @@ ensure_implicit_mergeinfo(svn_client__merge_path_t *parent,
                           svn_revnum_t revision1,
                           svn_revnum_t revision2,
                           svn_ra_session_t *ra_session,
+                          svn_client__mergeinfo_cache_t *cache,
                           svn_client_ctx_t *ctx,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool)
@@ -4443,6 +4490,7 @@ ensure_implicit_mergeinfo(svn_client__merge_path_t *parent,
                                                    revision1,
                                                    revision2,
                                                    ra_session,
+                                                   cache,
                                                    ctx,
                                                    result_pool,
                                                    scratch_pool));
@@ -4453,7 +4501,7 @@ ensure_implicit_mergeinfo(svn_client__merge_path_t *parent,
                                ra_session, child->abspath,
                                MAX(revision1, revision2),
                                MIN(revision1, revision2),
-                               ctx, result_pool, scratch_pool));
+                               cache, ctx, result_pool, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -4516,6 +4564,7 @@ filter_merged_revisions(svn_client__merge_path_t *parent,
                         svn_revnum_t revision2,
                         svn_boolean_t child_inherits_implicit,
                         svn_ra_session_t *ra_session,
+                        svn_client__mergeinfo_cache_t *cache,
                         svn_client_ctx_t *ctx,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool)
@@ -4603,6 +4652,7 @@ filter_merged_revisions(svn_client__merge_path_t *parent,
                                             revision1,
                                             revision2,
                                             ra_session,
+                                            cache,
                                             ctx,
                                             result_pool,
                                             scratch_pool));
@@ -4688,6 +4738,7 @@ filter_merged_revisions(svn_client__merge_path_t *parent,
                                             revision1,
                                             revision2,
                                             ra_session,
+                                            cache,
                                             ctx,
                                             result_pool,
                                             scratch_pool));
@@ -4760,6 +4811,7 @@ calculate_remaining_ranges(svn_client__merge_path_t *parent,
                            const apr_array_header_t *implicit_src_gap,
                            svn_boolean_t child_inherits_implicit,
                            svn_ra_session_t *ra_session,
+                           svn_client__mergeinfo_cache_t *cache,
                            svn_client_ctx_t *ctx,
                            apr_pool_t *result_pool,
                            apr_pool_t *scratch_pool)
@@ -4808,7 +4860,7 @@ calculate_remaining_ranges(svn_client__merge_path_t *parent,
                                   target_rangelist,
                                   source->loc1->rev, source->loc2->rev,
                                   child_inherits_implicit,
-                                  ra_session, ctx, result_pool,
+                                  ra_session, cache, ctx, result_pool,
                                   scratch_pool));
 
   /* Issue #2973 -- from the continuing series of "Why, since the advent of
@@ -4918,6 +4970,7 @@ find_gaps_in_merge_source_history(svn_revnum_t *gap_start,
                                   svn_revnum_t *gap_end,
                                   const merge_source_t *source,
                                   svn_ra_session_t *ra_session,
+                                  svn_client__mergeinfo_cache_t *cache,
                                   svn_client_ctx_t *ctx,
                                   apr_pool_t *scratch_pool)
 {
@@ -4939,11 +4992,9 @@ find_gaps_in_merge_source_history(svn_revnum_t *gap_start,
     return SVN_NO_ERROR;
 
   /* Get SOURCE as mergeinfo. */
-  SVN_ERR(svn_client__get_history_as_mergeinfo(&implicit_src_mergeinfo, NULL,
-                                               primary_src,
-                                               primary_src->rev, old_rev,
-                                               ra_session,
-                                               ctx, scratch_pool));
+  SVN_ERR(svn_client__get_history_as_mergeinfo_cached(
+            &implicit_src_mergeinfo, NULL, primary_src, primary_src->rev,
+            old_rev, cache, ra_session, ctx, scratch_pool));
 
   rangelist = svn_hash_gets(implicit_src_mergeinfo, merge_src_fspath);
 
@@ -5093,6 +5144,7 @@ populate_remaining_ranges(apr_array_header_t *children_with_mergeinfo,
                                              source->loc2->rev),
                                          MIN(source->loc1->rev,
                                              source->loc2->rev),
+                                         merge_b->mergeinfo_cache,
                                          merge_b->ctx, result_pool,
                                          iterpool));
             }
@@ -5115,7 +5167,9 @@ populate_remaining_ranges(apr_array_header_t *children_with_mergeinfo,
                                                 child_inherits_implicit,
                                                 source->loc1->rev,
                                                 source->loc2->rev,
-                                                ra_session, merge_b->ctx,
+                                                ra_session,
+                                                merge_b->mergeinfo_cache,
+                                                merge_b->ctx,
                                                 result_pool, iterpool));
             }
 
@@ -5141,9 +5195,9 @@ populate_remaining_ranges(apr_array_header_t *children_with_mergeinfo,
      we will adjust CHILD->REMAINING_RANGES such that we don't describe
      non-existent paths to the editor. */
   SVN_ERR(find_gaps_in_merge_source_history(&gap_start, &gap_end,
-                                            source,
-                                            ra_session, merge_b->ctx,
-                                            iterpool));
+                                            source, ra_session,
+                                            merge_b->mergeinfo_cache,
+                                            merge_b->ctx, iterpool));
 
   /* Stash any gap in the merge command baton, we'll need it later when
      recording mergeinfo describing this merge. */
@@ -5151,6 +5205,23 @@ populate_remaining_ranges(apr_array_header_t *children_with_mergeinfo,
     merge_b->implicit_src_gap = svn_rangelist__initialize(gap_start, gap_end,
                                                           TRUE, result_pool);
 
+  /* Subtrees without mergeinfo of their own in the working copy will have
+     to ask the repository what they inherit.  Let the first of them that
+     does ask for all of them at once, rather than making one round trip
+     per subtree. */
+  for (i = 0; i < children_with_mergeinfo->nelts; i++)
+    {
+      svn_client__merge_path_t *child =
+        APR_ARRAY_IDX(children_with_mergeinfo, i, svn_client__merge_path_t *);
+
+      svn_pool_clear(iterpool);
+      if (!child->absent && !child->pre_merge_mergeinfo)
+        SVN_ERR(svn_client__mergeinfo_cache_expect(merge_b->mergeinfo_cache,
+                                                   child->abspath,
+                                                   merge_b->ctx->wc_ctx,
+                                                   iterpool));
+    }
+
   for (i = 0; i < children_with_mergeinfo->nelts; i++)
     {
       svn_client__merge_path_t *child =
@@ -5196,7 +5267,7 @@ populate_remaining_ranges(apr_array_header_t *children_with_mergeinfo,
         child->abspath,
         MAX(source->loc1->rev, source->loc2->rev),
         MIN(source->loc1->rev, source->loc2->rev),
-        merge_b->ctx, result_pool, iterpool));
+        merge_b->mergeinfo_cache, merge_b->ctx, result_pool, iterpool));
 
       /* If CHILD isn't the merge target find its parent. */
       if (i > 0)
@@ -5222,6 +5293,7 @@ populate_remaining_ranges(apr_array_header_t *children_with_mergeinfo,
                                          merge_b->implicit_src_gap,
                                          child_inherits_implicit,
                                          ra_session,
+                                         merge_b->mergeinfo_cache,
                                          merge_b->ctx, result_pool,
                                          iterpool));
 
@@ -5757,6 +5829,7 @@ drive_merge_report_editor(const char *target_abspath,
   svn_boolean_t honor_mergeinfo = HONOR_MERGEINFO(merge_b);
   const char *old_sess1_url, *old_sess2_url;
   svn_boolean_t is_rollback = source->loc1->rev > source->loc2->rev;
+  svn_error_t *err;
 
   /* Start with a safe default starting revision for the editor and the
      merge target. */
@@ -5939,7 +6012,12 @@ drive_merge_report_editor(const char *target_abspath,
         }
       svn_pool_destroy(iterpool);
     }
-  SVN_ERR(reporter->finish_report(report_baton, scratch_pool));
+  err = reporter->finish_report(report_baton, scratch_pool);
+
+  /* Install the pending text merges, even if the drive failed. */
+  SVN_ERR(svn_error_compose_create(
+            err,
+            svn_wc__merge_queue_flush(merge_b->merge_queue, scratch_pool)));
 
   /* Point the merge baton's RA sessions back where they were. */
   SVN_ERR(svn_ra_reparent(merge_b->ra_session1, old_sess1_url, scratch_pool));
@@ -7563,7 +7641,8 @@ do_file_merge(svn_mergeinfo_catalog_t result_catalog,
                                merge_b->ra_session1, target_abspath,
                                MAX(source->loc1->rev, source->loc2->rev),
                                MIN(source->loc1->rev, source->loc2->rev),
-                               ctx, scratch_pool, iterpool);
+                               merge_b->mergeinfo_cache, ctx,
+                               scratch_pool, iterpool);
 
       if (err)
         {
@@ -7591,6 +7670,7 @@ do_file_merge(svn_mergeinfo_catalog_t result_catalog,
                                              target_mergeinfo,
                                              merge_b->implicit_src_gap, FALSE,
                                              merge_b->ra_session1,
+                                             merge_b->mergeinfo_cache,
                                              ctx, scratch_pool,
                                              iterpool));
           remaining_ranges = merge_target->remaining_ranges;
@@ -7795,6 +7875,8 @@ do_file_merge(svn_mergeinfo_catalog_t result_catalog,
                                               iterpool));
             }
 
+          SVN_ERR(svn_wc__merge_queue_flush(merge_b->merge_queue, iterpool));
+
           if (is_path_conflicted_by_merge(merge_b))
             {
               merge_source_t *remaining_range = NULL;
@@ -7928,6 +8010,20 @@ process_children_with_new_mergeinfo(merge_cmd_baton_t *merge_b,
   a = svn_sort__hash(merge_b->paths_with_new_mergeinfo,
                      svn_sort_compare_items_as_paths, pool);
   iterpool = svn_pool_create(pool);
+
+  /* Any of these paths may have to ask the repository what it would have
+     inherited; let the first one that does ask for all of them. */
+  for (i = 0; i < a->nelts; i++)
+    {
+      svn_sort__item_t *item = &APR_ARRAY_IDX(a, i, svn_sort__item_t);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_client__mergeinfo_cache_expect(merge_b->mergeinfo_cache,
+                                                 item->key,
+                                                 merge_b->ctx->wc_ctx,
+                                                 iterpool));
+    }
+
   for (i = 0; i < a->nelts; i++)
     {
       svn_sort__item_t *item = &APR_ARRAY_IDX(a, i, svn_sort__item_t);
@@ -7958,11 +8054,12 @@ process_children_with_new_mergeinfo(merge_cmd_baton_t *merge_b,
         {
           /* Get the mergeinfo the path would have inherited before
              the merge. */
-          SVN_ERR(svn_client__get_wc_or_repos_mergeinfo(
+          SVN_ERR(svn_client__get_wc_or_repos_mergeinfo_cached(
             &path_inherited_mergeinfo,
             NULL, NULL,
             FALSE,
             svn_mergeinfo_nearest_ancestor, /* We only want inherited MI */
+            merge_b->mergeinfo_cache,
             merge_b->ra_session2,
             abspath_with_new_mergeinfo,
             merge_b->ctx,
@@ -8517,6 +8614,210 @@ flag_subtrees_needing_mergeinfo(svn_boolean_t operative_merge,
   return SVN_NO_ERROR;
 }
 
+/* What one log and one listing of the merge source told us about the
+   history of the subtrees of a merge target, see
+   fetch_subtree_histories(). */
+typedef struct subtree_histories_t
+{
+  /* The youngest and oldest revision of interest. */
+  svn_revnum_t youngest;
+  svn_revnum_t oldest;
+
+  /* Repository fspaths that were added, replaced or deleted in
+     OLDEST+1 through YOUNGEST, mapped to themselves. */
+  apr_hash_t *changed_fspaths;
+
+  /* Repository fspaths of the subtrees we are interested in, mapped to
+     themselves.  Those that exist at YOUNGEST have a non-NULL value in
+     EXISTING_FSPATHS. */
+  apr_hash_t *wanted_fspaths;
+  apr_hash_t *existing_fspaths;
+
+  apr_pool_t *pool;
+} subtree_histories_t;
+
+/* Implements svn_log_entry_receiver_t for fetch_subtree_histories(). */
+static svn_error_t *
+subtree_histories_log_receiver(void *baton,
+                               svn_log_entry_t *log_entry,
+                               apr_pool_t *pool)
+{
+  subtree_histories_t *histories = baton;
+  apr_hash_index_t *hi;
+
+  if (!log_entry->changed_paths2)
+    return SVN_NO_ERROR;
+
+  for (hi = apr_hash_first(pool, log_entry->changed_paths2);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *fspath = apr_hash_this_key(hi);
+      svn_log_changed_path2_t *change = apr_hash_this_val(hi);
+
+      if (change->action != 'M')
+        {
+          fspath = apr_pstrdup(histories->pool, fspath);
+          svn_hash_sets(histories->changed_fspaths, fspath, fspath);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_dirent_receiver_t for fetch_subtree_histories(). */
+static svn_error_t *
+subtree_histories_list_receiver(const char *rel_path,
+                                svn_dirent_t *dirent,
+                                void *baton,
+                                apr_pool_t *scratch_pool)
+{
+  subtree_histories_t *histories = baton;
+  const char *fspath = svn_fspath__canonicalize(rel_path, scratch_pool);
+
+  fspath = svn_hash_gets(histories->wanted_fspaths, fspath);
+  if (fspath)
+    svn_hash_sets(histories->existing_fspaths, fspath, fspath);
+
+  return SVN_NO_ERROR;
+}
+
+/* Helper for record_mergeinfo_for_dir_merge().
+
+   Rather than asking the repository for the natural history of every
+   subtree of CHILDREN_WITH_MERGEINFO that needs mergeinfo recorded,
+   fetch one log of the merge source MERGEINFO_FSPATH over
+   MERGED_RANGE, which must be a forward range, and one listing of the
+   source at MERGED_RANGE->END.  Set *HISTORIES to the result, allocated
+   in RESULT_POOL, and see subtree_history_as_mergeinfo() for how it is
+   used.
+
+   Set *HISTORIES to NULL if there are fewer than two such subtrees, or if
+   the server can't list the source in one go.
+
+   MERGE_B->RA_SESSION2 is temporarily reparented by this function. */
+static svn_error_t *
+fetch_subtree_histories(subtree_histories_t **histories_p,
+                        const svn_merge_range_t *merged_range,
+                        const char *mergeinfo_fspath,
+                        apr_array_header_t *children_with_mergeinfo,
+                        merge_cmd_baton_t *merge_b,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  subtree_histories_t *histories;
+  apr_array_header_t *patterns;
+  const char *old_session_url;
+  svn_error_t *err;
+  int i;
+
+  *histories_p = NULL;
+
+  histories = apr_pcalloc(result_pool, sizeof(*histories));
+  histories->youngest = merged_range->end;
+  histories->oldest = merged_range->start;
+  histories->changed_fspaths = apr_hash_make(result_pool);
+  histories->wanted_fspaths = apr_hash_make(result_pool);
+  histories->existing_fspaths = apr_hash_make(result_pool);
+  histories->pool = result_pool;
+
+  /* We only list the entries named like the subtrees we care about. */
+  patterns = apr_array_make(scratch_pool, 0, sizeof(const char *));
+  for (i = 1; i < children_with_mergeinfo->nelts; i++)
+    {
+      svn_client__merge_path_t *child =
+        APR_ARRAY_IDX(children_with_mergeinfo, i, svn_client__merge_path_t *);
+      const char *child_repos_path;
+      const char *fspath;
+
+      if (!child->record_mergeinfo)
+        continue;
+
+      child_repos_path = svn_dirent_skip_ancestor(merge_b->target->abspath,
+                                                  child->abspath);
+      SVN_ERR_ASSERT(child_repos_path != NULL);
+      fspath = svn_fspath__join(mergeinfo_fspath, child_repos_path,
+                                result_pool);
+      svn_hash_sets(histories->wanted_fspaths, fspath, fspath);
+      APR_ARRAY_PUSH(patterns, const char *) = svn_fspath__basename(fspath,
+                                                                    NULL);
+    }
+
+  /* Two requests can't beat a single one. */
+  if (apr_hash_count(histories->wanted_fspaths) < 2)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_client__ensure_ra_session_url(
+            &old_session_url, merge_b->ra_session2,
+            svn_path_url_add_component2(merge_b->target->loc.repos_root_url,
+                                        mergeinfo_fspath + 1, scratch_pool),
+            scratch_pool));
+
+  err = get_log(merge_b->ra_session2, "", merged_range->end,
+                merged_range->start + 1, TRUE,
+                subtree_histories_log_receiver, histories, scratch_pool);
+  if (!err)
+    err = svn_ra_list(merge_b->ra_session2, "", merged_range->end, patterns,
+                      svn_depth_infinity, SVN_DIRENT_KIND,
+                      subtree_histories_list_receiver, histories,
+                      scratch_pool);
+  err = svn_error_compose_create(
+          err, svn_ra_reparent(merge_b->ra_session2, old_session_url,
+                               scratch_pool));
+  if (err)
+    {
+      if (err->apr_err != SVN_ERR_UNSUPPORTED_FEATURE)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  *histories_p = histories;
+  return SVN_NO_ERROR;
+}
+
+/* Set *MERGEINFO_P to the natural history of the merge source subtree
+   at FSPATH between HISTORIES->oldest and HISTORIES->youngest, exactly
+   as svn_client__get_history_as_mergeinfo() would, if HISTORIES is not
+   NULL and that history follows from it: FSPATH exists at
+   HISTORIES->youngest and neither it nor any of its parents was added,
+   replaced or deleted in the range, so it is one node at one path
+   throughout.  Otherwise set *MERGEINFO_P to NULL. */
+static svn_error_t *
+subtree_history_as_mergeinfo(svn_mergeinfo_t *mergeinfo_p,
+                             const subtree_histories_t *histories,
+                             const char *fspath,
+                             apr_pool_t *result_pool)
+{
+  const char *parent_fspath;
+  svn_location_segment_t *segment;
+  apr_array_header_t *segments;
+
+  *mergeinfo_p = NULL;
+
+  if (!histories || !svn_hash_gets(histories->existing_fspaths, fspath))
+    return SVN_NO_ERROR;
+
+  for (parent_fspath = fspath;
+       !svn_fspath__is_root(parent_fspath, strlen(parent_fspath));
+       parent_fspath = svn_fspath__dirname(parent_fspath, result_pool))
+    {
+      if (svn_hash_gets(histories->changed_fspaths, parent_fspath))
+        return SVN_NO_ERROR;
+    }
+
+  segment = apr_pcalloc(result_pool, sizeof(*segment));
+  segment->range_start = histories->oldest;
+  segment->range_end = histories->youngest;
+  segment->path = fspath + 1;
+  segments = apr_array_make(result_pool, 1, sizeof(segment));
+  APR_ARRAY_PUSH(segments, svn_location_segment_t *) = segment;
+
+  return svn_error_trace(svn_mergeinfo__mergeinfo_from_segments(
+                           mergeinfo_p, segments, result_pool));
+}
+
 /* Helper for do_directory_merge().
 
    If RESULT_CATALOG is NULL then record mergeinfo describing a merge of
@@ -8550,6 +8851,7 @@ record_mergeinfo_for_dir_merge(svn_mergeinfo_catalog_t result_catalog,
   int i;
   svn_boolean_t is_rollback = (merged_range->start > merged_range->end);
   svn_boolean_t operative_merge;
+  subtree_histories_t *subtree_histories = NULL;
 
   /* Update the WC mergeinfo here to account for our new
      merges, minus any unresolved conflicts and skips. */
@@ -8584,6 +8886,15 @@ record_mergeinfo_for_dir_merge(svn_mergeinfo_catalog_t result_catalog,
                                           mergeinfo_fspath, depth,
                                           merge_b, iterpool));
 
+  /* Below we check the natural history of every subtree that needs
+     mergeinfo.  With many such subtrees, learn most of it in bulk. */
+  if ((!merge_b->record_only || merge_b->reintegrate_merge)
+      && (!is_rollback))
+    SVN_ERR(fetch_subtree_histories(&subtree_histories, merged_range,
+                                    mergeinfo_fspath,
+                                    children_with_mergeinfo, merge_b,
+                                    scratch_pool, iterpool));
+
   /* ...and then record it. */
   for (i = 0; i < children_with_mergeinfo->nelts; i++)
     {
@@ -8714,11 +9025,21 @@ record_mergeinfo_for_dir_merge(svn_mergeinfo_catalog_t result_catalog,
                  history. */
               /* We know MERGED_RANGE->END is younger than MERGE_RANGE->START
                  because we only do this for forward merges. */
-              err = svn_client__get_history_as_mergeinfo(
-                &subtree_history_as_mergeinfo, NULL,
-                subtree_mergeinfo_pathrev,
-                merged_range->end, merged_range->start,
-                merge_b->ra_session2, merge_b->ctx, iterpool);
+              if (i > 0)
+                SVN_ERR(subtree_history_as_mergeinfo(
+                          &subtree_history_as_mergeinfo, subtree_histories,
+                          child_merge_src_fspath, iterpool));
+              else
+                subtree_history_as_mergeinfo = NULL;
+
+              if (subtree_history_as_mergeinfo)
+                err = SVN_NO_ERROR;
+              else
+                err = svn_client__get_history_as_mergeinfo(
+                  &subtree_history_as_mergeinfo, NULL,
+                  subtree_mergeinfo_pathrev,
+                  merged_range->end, merged_range->start,
+                  merge_b->ra_session2, merge_b->ctx, iterpool);
 
               /* If CHILD is a subtree it may have been deleted prior to
                  MERGED_RANGE->END so the above call to get its history
@@ -9857,6 +10178,7 @@ do_merge(apr_hash_t **modified_subtrees,
   svn_config_t *cfg;
   const char *diff3_cmd;
   const char *preserved_exts_str;
+  apr_int64_t merge_jobs;
   int i;
   svn_boolean_t checked_mergeinfo_capability = FALSE;
   svn_ra_session_t *ra_session1 = NULL, *ra_session2 = NULL;
@@ -9922,6 +10244,15 @@ do_merge(apr_hash_t **modified_subtrees,
   svn_config_get(cfg, &preserved_exts_str, SVN_CONFIG_SECTION_MISCELLANY,
                  SVN_CONFIG_OPTION_PRESERVED_CF_EXTS, "");
 
+  /* See how many text merges the user wants to run concurrently. */
+  SVN_ERR(svn_config_get_int64(cfg, &merge_jobs, SVN_CONFIG_SECTION_MISCELLANY,
+                               SVN_CONFIG_OPTION_MERGE_JOBS, 1));
+  SVN_ERR(svn_wc__merge_queue_create(&merge_cmd_baton.merge_queue,
+                                     ctx->wc_ctx,
+                                     (int)MIN(merge_jobs, APR_INT32_MAX),
+                                     ctx->cancel_func, ctx->cancel_baton,
+                                     scratch_pool));
+
   /* Build the merge context baton (or at least the parts of it that
      don't need to be reset for each merge source).  */
   merge_cmd_baton.force_delete = force_delete;
@@ -9943,6 +10274,8 @@ do_merge(apr_hash_t **modified_subtrees,
                           : NULL;
 
   merge_cmd_baton.use_sleep = use_sleep;
+  merge_cmd_baton.mergeinfo_cache
+    = svn_client__mergeinfo_cache_create(scratch_pool);
 
   /* Do we already know the specific subtrees with mergeinfo we want
      to record-only mergeinfo on? */
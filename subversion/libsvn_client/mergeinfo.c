@@ -551,6 +551,237 @@ svn_client__get_repos_mergeinfo_catalog(svn_mergeinfo_catalog_t *mergeinfo_cat,
 }
 
 
+/* See svn_client__mergeinfo_cache_t in mergeinfo.h. */
+struct svn_client__mergeinfo_cache_t
+{
+  /* apr_array_header_t * of svn_location_segment_t * describing the
+     whole natural history of a node, keyed by "PEG_REV:URL". */
+  apr_hash_t *histories;
+
+  /* const cached_mergeinfo_t * keyed by "REV:INHERIT:REPOS_RELPATH". */
+  apr_hash_t *mergeinfo;
+
+  /* const svn_revnum_t * keyed by the repository root relative paths that
+     svn_client__mergeinfo_cache_expect() was told about. */
+  apr_hash_t *expected;
+
+  /* Set once the repository turns out not to support mergeinfo. */
+  svn_boolean_t incapable;
+
+  apr_pool_t *pool;
+};
+
+/* Mergeinfo of a path as found in the repository.  MERGEINFO is NULL if
+   the path has no (explicit or inherited) mergeinfo at all. */
+typedef struct cached_mergeinfo_t
+{
+  svn_mergeinfo_t mergeinfo;
+} cached_mergeinfo_t;
+
+svn_client__mergeinfo_cache_t *
+svn_client__mergeinfo_cache_create(apr_pool_t *result_pool)
+{
+  svn_client__mergeinfo_cache_t *cache = apr_pcalloc(result_pool,
+                                                     sizeof(*cache));
+
+  cache->histories = apr_hash_make(result_pool);
+  cache->mergeinfo = apr_hash_make(result_pool);
+  cache->expected = apr_hash_make(result_pool);
+  cache->pool = result_pool;
+
+  return cache;
+}
+
+svn_error_t *
+svn_client__mergeinfo_cache_expect(svn_client__mergeinfo_cache_t *cache,
+                                   const char *local_abspath,
+                                   svn_wc_context_t *wc_ctx,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_revnum_t rev;
+  const char *repos_relpath;
+  svn_revnum_t *revp;
+  svn_error_t *err;
+
+  err = svn_wc__node_get_origin(NULL, &rev, &repos_relpath, NULL,
+                                NULL, NULL, NULL,
+                                wc_ctx, local_abspath, FALSE,
+                                scratch_pool, scratch_pool);
+
+  /* This is only a hint; a node that is not there is simply not
+     looked up in advance. */
+  if (err && err->apr_err == SVN_ERR_WC_PATH_NOT_FOUND)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  if (!repos_relpath || !SVN_IS_VALID_REVNUM(rev))
+    return SVN_NO_ERROR;
+
+  revp = apr_palloc(cache->pool, sizeof(*revp));
+  *revp = rev;
+  svn_hash_sets(cache->expected, apr_pstrdup(cache->pool, repos_relpath),
+                revp);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the key under which CACHE->mergeinfo stores the INHERIT
+   mergeinfo of REPOS_RELPATH@REV. */
+static const char *
+mergeinfo_cache_key(const char *repos_relpath,
+                    svn_revnum_t rev,
+                    svn_mergeinfo_inheritance_t inherit,
+                    apr_pool_t *result_pool)
+{
+  return apr_psprintf(result_pool, "%ld:%d:%s", rev, (int)inherit,
+                      repos_relpath);
+}
+
+/* Fetch the INHERIT mergeinfo of REPOS_RELPATH@REV into CACHE, together
+   with that of every other path expected at REV that CACHE does not know
+   about yet, using a single request on RA_SESSION.  RA_SESSION is
+   temporarily reparented to REPOS_ROOT_URL.
+
+   If the repository does not support mergeinfo, just set
+   CACHE->incapable. */
+static svn_error_t *
+fetch_mergeinfo_in_bulk(svn_client__mergeinfo_cache_t *cache,
+                        svn_ra_session_t *ra_session,
+                        const char *repos_root_url,
+                        const char *repos_relpath,
+                        svn_revnum_t rev,
+                        svn_mergeinfo_inheritance_t inherit,
+                        apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *paths = apr_array_make(scratch_pool, 1,
+                                             sizeof(const char *));
+  svn_mergeinfo_catalog_t catalog;
+  const char *old_session_url;
+  apr_hash_index_t *hi;
+  svn_error_t *err;
+  int i;
+
+  APR_ARRAY_PUSH(paths, const char *) = repos_relpath;
+
+  for (hi = apr_hash_first(scratch_pool, cache->expected);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *relpath = apr_hash_this_key(hi);
+      const svn_revnum_t *revp = apr_hash_this_val(hi);
+
+      if (*revp == rev
+          && strcmp(relpath, repos_relpath) != 0
+          && !svn_hash_gets(cache->mergeinfo,
+                            mergeinfo_cache_key(relpath, rev, inherit,
+                                                scratch_pool)))
+        APR_ARRAY_PUSH(paths, const char *) = relpath;
+    }
+
+  SVN_ERR(svn_client__ensure_ra_session_url(&old_session_url, ra_session,
+                                            repos_root_url, scratch_pool));
+  err = svn_ra_get_mergeinfo(ra_session, &catalog, paths, rev, inherit,
+                             FALSE, scratch_pool);
+  if (err && paths->nelts > 1 && err->apr_err != SVN_ERR_UNSUPPORTED_FEATURE)
+    {
+      /* One of the other paths may not exist at REV.  Ask just for the
+         one we were asked about. */
+      svn_error_clear(err);
+      apr_array_clear(paths);
+      APR_ARRAY_PUSH(paths, const char *) = repos_relpath;
+      err = svn_ra_get_mergeinfo(ra_session, &catalog, paths, rev, inherit,
+                                 FALSE, scratch_pool);
+    }
+  err = svn_error_compose_create(
+          err, svn_ra_reparent(ra_session, old_session_url, scratch_pool));
+  if (err)
+    {
+      if (err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+        {
+          svn_error_clear(err);
+          cache->incapable = TRUE;
+          return SVN_NO_ERROR;
+        }
+      return svn_error_trace(err);
+    }
+
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *relpath = APR_ARRAY_IDX(paths, i, const char *);
+      cached_mergeinfo_t *cached = apr_pcalloc(cache->pool, sizeof(*cached));
+      svn_mergeinfo_t mergeinfo = catalog ? svn_hash_gets(catalog, relpath)
+                                          : NULL;
+
+      if (mergeinfo)
+        cached->mergeinfo = svn_mergeinfo_dup(mergeinfo, cache->pool);
+      svn_hash_sets(cache->mergeinfo,
+                    mergeinfo_cache_key(relpath, rev, inherit, cache->pool),
+                    cached);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Like svn_client__get_repos_mergeinfo_catalog() with SQUELCH_INCAPABLE
+   set and INCLUDE_DESCENDANTS unset, but for REPOS_RELPATH in the
+   repository at REPOS_ROOT_URL, and answered from CACHE where possible. */
+static svn_error_t *
+get_repos_mergeinfo_catalog_cached(svn_mergeinfo_catalog_t *mergeinfo_cat,
+                                   svn_client__mergeinfo_cache_t *cache,
+                                   svn_ra_session_t *ra_session,
+                                   const char *repos_root_url,
+                                   const char *repos_relpath,
+                                   svn_revnum_t rev,
+                                   svn_mergeinfo_inheritance_t inherit,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool)
+{
+  const char *key = mergeinfo_cache_key(repos_relpath, rev, inherit,
+                                        scratch_pool);
+  const cached_mergeinfo_t *cached = svn_hash_gets(cache->mergeinfo, key);
+
+  *mergeinfo_cat = NULL;
+
+  if (!cached && !cache->incapable)
+    {
+      SVN_ERR(fetch_mergeinfo_in_bulk(cache, ra_session, repos_root_url,
+                                      repos_relpath, rev, inherit,
+                                      scratch_pool));
+      cached = svn_hash_gets(cache->mergeinfo, key);
+    }
+
+  if (cached && cached->mergeinfo)
+    {
+      *mergeinfo_cat = apr_hash_make(result_pool);
+      svn_hash_sets(*mergeinfo_cat, apr_pstrdup(result_pool, repos_relpath),
+                    svn_mergeinfo_dup(cached->mergeinfo, result_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Implements svn_client__get_wc_or_repos_mergeinfo_catalog(), answering
+   any repository lookup from CACHE if it is not NULL. */
+static svn_error_t *
+get_wc_or_repos_mergeinfo_catalog(
+  svn_mergeinfo_catalog_t *target_mergeinfo_catalog,
+  svn_boolean_t *inherited_p,
+  svn_boolean_t *from_repos,
+  svn_boolean_t include_descendants,
+  svn_boolean_t repos_only,
+  svn_boolean_t ignore_invalid_mergeinfo,
+  svn_mergeinfo_inheritance_t inherit,
+  svn_client__mergeinfo_cache_t *cache,
+  svn_ra_session_t *ra_session,
+  const char *target_wcpath,
+  svn_client_ctx_t *ctx,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool);
+
 svn_error_t *
 svn_client__get_wc_or_repos_mergeinfo(svn_mergeinfo_t *target_mergeinfo,
                                       svn_boolean_t *inherited,
@@ -561,19 +792,38 @@ svn_client__get_wc_or_repos_mergeinfo(svn_mergeinfo_t *target_mergeinfo,
                                       const char *target_wcpath,
                                       svn_client_ctx_t *ctx,
                                       apr_pool_t *pool)
+{
+  return svn_error_trace(svn_client__get_wc_or_repos_mergeinfo_cached(
+                           target_mergeinfo, inherited, from_repos,
+                           repos_only, inherit, NULL, ra_session,
+                           target_wcpath, ctx, pool));
+}
+
+svn_error_t *
+svn_client__get_wc_or_repos_mergeinfo_cached(
+  svn_mergeinfo_t *target_mergeinfo,
+  svn_boolean_t *inherited,
+  svn_boolean_t *from_repos,
+  svn_boolean_t repos_only,
+  svn_mergeinfo_inheritance_t inherit,
+  svn_client__mergeinfo_cache_t *cache,
+  svn_ra_session_t *ra_session,
+  const char *target_wcpath,
+  svn_client_ctx_t *ctx,
+  apr_pool_t *pool)
 {
   svn_mergeinfo_catalog_t tgt_mergeinfo_cat;
 
   *target_mergeinfo = NULL;
 
-  SVN_ERR(svn_client__get_wc_or_repos_mergeinfo_catalog(&tgt_mergeinfo_cat,
-                                                        inherited, from_repos,
-                                                        FALSE,
-                                                        repos_only,
-                                                        FALSE, inherit,
-                                                        ra_session,
-                                                        target_wcpath, ctx,
-                                                        pool, pool));
+  SVN_ERR(get_wc_or_repos_mergeinfo_catalog(&tgt_mergeinfo_cat,
+                                            inherited, from_repos,
+                                            FALSE,
+                                            repos_only,
+                                            FALSE, inherit, cache,
+                                            ra_session,
+                                            target_wcpath, ctx,
+                                            pool, pool));
   if (tgt_mergeinfo_cat && apr_hash_count(tgt_mergeinfo_cat))
     {
       /* We asked only for the TARGET_WCPATH's mergeinfo, not any of its
@@ -603,6 +853,30 @@ svn_client__get_wc_or_repos_mergeinfo_catalog(
   svn_client_ctx_t *ctx,
   apr_pool_t *result_pool,
   apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(get_wc_or_repos_mergeinfo_catalog(
+                           target_mergeinfo_catalog, inherited_p, from_repos,
+                           include_descendants, repos_only,
+                           ignore_invalid_mergeinfo, inherit, NULL,
+                           ra_session, target_wcpath, ctx,
+                           result_pool, scratch_pool));
+}
+
+static svn_error_t *
+get_wc_or_repos_mergeinfo_catalog(
+  svn_mergeinfo_catalog_t *target_mergeinfo_catalog,
+  svn_boolean_t *inherited_p,
+  svn_boolean_t *from_repos,
+  svn_boolean_t include_descendants,
+  svn_boolean_t repos_only,
+  svn_boolean_t ignore_invalid_mergeinfo,
+  svn_mergeinfo_inheritance_t inherit,
+  svn_client__mergeinfo_cache_t *cache,
+  svn_ra_session_t *ra_session,
+  const char *target_wcpath,
+  svn_client_ctx_t *ctx,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool)
 {
   const char *url;
   svn_revnum_t target_rev;
@@ -689,11 +963,17 @@ svn_client__get_wc_or_repos_mergeinfo_catalog(
                                                       sesspool, sesspool));
                 }
 
-              SVN_ERR(svn_client__get_repos_mergeinfo_catalog(
-                        &target_mergeinfo_cat_repos, ra_session,
-                        url, target_rev, inherit,
-                        TRUE, include_descendants,
-                        result_pool, scratch_pool));
+              if (cache && !include_descendants)
+                SVN_ERR(get_repos_mergeinfo_catalog_cached(
+                          &target_mergeinfo_cat_repos, cache, ra_session,
+                          repos_root, repos_relpath, target_rev, inherit,
+                          result_pool, scratch_pool));
+              else
+                SVN_ERR(svn_client__get_repos_mergeinfo_catalog(
+                          &target_mergeinfo_cat_repos, ra_session,
+                          url, target_rev, inherit,
+                          TRUE, include_descendants,
+                          result_pool, scratch_pool));
 
               if (target_mergeinfo_cat_repos
                   && svn_hash_gets(target_mergeinfo_cat_repos, repos_relpath))
@@ -746,6 +1026,73 @@ svn_client__get_history_as_mergeinfo(svn_mergeinfo_t *mergeinfo_p,
                                       svn_ra_session_t *ra_session,
                                       svn_client_ctx_t *ctx,
                                       apr_pool_t *pool)
+{
+  return svn_error_trace(svn_client__get_history_as_mergeinfo_cached(
+                           mergeinfo_p, has_rev_zero_history, pathrev,
+                           range_youngest, range_oldest, NULL,
+                           ra_session, ctx, pool));
+}
+
+/* Set *SEGMENTS to the location segments of PATHREV between RANGE_YOUNGEST
+   and RANGE_OLDEST, oldest first, as svn_client__repos_location_segments()
+   would.  The whole history of PATHREV is fetched once and kept in CACHE;
+   later requests for the same node are answered by clipping it. */
+static svn_error_t *
+get_location_segments_cached(apr_array_header_t **segments,
+                             svn_client__mergeinfo_cache_t *cache,
+                             const svn_client__pathrev_t *pathrev,
+                             svn_revnum_t range_youngest,
+                             svn_revnum_t range_oldest,
+                             svn_ra_session_t *ra_session,
+                             svn_client_ctx_t *ctx,
+                             apr_pool_t *pool)
+{
+  const char *key = apr_psprintf(pool, "%ld:%s", pathrev->rev, pathrev->url);
+  apr_array_header_t *history = svn_hash_gets(cache->histories, key);
+  int i;
+
+  if (!history)
+    {
+      SVN_ERR(svn_client__repos_location_segments(&history, ra_session,
+                                                  pathrev->url, pathrev->rev,
+                                                  pathrev->rev, 0,
+                                                  ctx, cache->pool));
+      svn_hash_sets(cache->histories, apr_pstrdup(cache->pool, key),
+                    history);
+    }
+
+  *segments = apr_array_make(pool, history->nelts,
+                             sizeof(svn_location_segment_t *));
+  for (i = 0; i < history->nelts; i++)
+    {
+      const svn_location_segment_t *segment
+        = APR_ARRAY_IDX(history, i, svn_location_segment_t *);
+      svn_location_segment_t *clipped;
+
+      if (segment->range_end < range_oldest
+          || segment->range_start > range_youngest)
+        continue;
+
+      clipped = svn_location_segment_dup(segment, pool);
+      clipped->range_start = MAX(clipped->range_start, range_oldest);
+      clipped->range_end = MIN(clipped->range_end, range_youngest);
+      APR_ARRAY_PUSH(*segments, svn_location_segment_t *) = clipped;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_client__get_history_as_mergeinfo_cached(
+  svn_mergeinfo_t *mergeinfo_p,
+  svn_boolean_t *has_rev_zero_history,
+  const svn_client__pathrev_t *pathrev,
+  svn_revnum_t range_youngest,
+  svn_revnum_t range_oldest,
+  svn_client__mergeinfo_cache_t *cache,
+  svn_ra_session_t *ra_session,
+  svn_client_ctx_t *ctx,
+  apr_pool_t *pool)
 {
   apr_array_header_t *segments;
 
@@ -755,10 +1102,18 @@ svn_client__get_history_as_mergeinfo(svn_mergeinfo_t *mergeinfo_p,
   if (! SVN_IS_VALID_REVNUM(range_oldest))
     range_oldest = 0;
 
-  SVN_ERR(svn_client__repos_location_segments(&segments, ra_session,
-                                              pathrev->url, pathrev->rev,
-                                              range_youngest, range_oldest,
-                                              ctx, pool));
+  /* Let the RA layer diagnose requests outside PATHREV's past. */
+  if (cache
+      && range_youngest <= pathrev->rev
+      && range_oldest <= range_youngest)
+    SVN_ERR(get_location_segments_cached(&segments, cache, pathrev,
+                                         range_youngest, range_oldest,
+                                         ra_session, ctx, pool));
+  else
+    SVN_ERR(svn_client__repos_location_segments(&segments, ra_session,
+                                                pathrev->url, pathrev->rev,
+                                                range_youngest, range_oldest,
+                                                ctx, pool));
 
   if (has_rev_zero_history)
     {
@@ -1665,6 +2020,30 @@ svn_client_mergeinfo_get_merged(apr_hash_t **mergeinfo_p,
   return SVN_NO_ERROR;
 }
 
+/* Like svn_mergeinfo_intersect2() but with the second operand given in
+   flat form as FLAT2, such that it can be shared between several
+   intersections. */
+static svn_error_t *
+intersect_with_flat_mergeinfo(svn_mergeinfo_t *mergeinfo,
+                              svn_mergeinfo_t mergeinfo1,
+                              const svn_mergeinfo__flat_t *flat2,
+                              svn_boolean_t consider_inheritance,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  svn_mergeinfo__flat_t *flat1;
+  svn_mergeinfo__flat_t *intersection;
+
+  SVN_ERR(svn_mergeinfo__flat_from_mergeinfo(&flat1, mergeinfo1,
+                                             scratch_pool, scratch_pool));
+  SVN_ERR(svn_mergeinfo__flat_intersect(&intersection, flat1, flat2,
+                                        consider_inheritance, scratch_pool));
+  SVN_ERR(svn_mergeinfo__flat_to_mergeinfo(mergeinfo, intersection,
+                                           result_pool));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_client__mergeinfo_log(svn_boolean_t finding_merged,
                           const char *target_path_or_url,
@@ -1931,6 +2310,7 @@ svn_client__mergeinfo_log(svn_boolean_t finding_merged,
       svn_mergeinfo_t subtree_noninheritable_mergeinfo;
       svn_mergeinfo_t merged_noninheritable;
       svn_mergeinfo_t merged;
+      svn_mergeinfo__flat_t *flat_source_history;
       const char *subtree_path = apr_hash_this_key(hi_catalog);
       svn_boolean_t is_subtree = strcmp(subtree_path,
                                         target_repos_relpath) != 0;
@@ -1960,13 +2340,19 @@ svn_client__mergeinfo_log(svn_boolean_t finding_merged,
             subtree_history = target_history;
         }
 
+      /* SUBTREE_SOURCE_HISTORY is intersected with several mergeinfos
+         below, so convert it only once. */
+      SVN_ERR(svn_mergeinfo__flat_from_mergeinfo(&flat_source_history,
+                                                 subtree_source_history,
+                                                 iterpool, iterpool));
+
       if (!finding_merged)
         {
           svn_mergeinfo_t merged_via_history;
-          SVN_ERR(svn_mergeinfo_intersect2(&merged_via_history,
-                                           subtree_history,
-                                           subtree_source_history, TRUE,
-                                           scratch_pool, iterpool));
+          SVN_ERR(intersect_with_flat_mergeinfo(&merged_via_history,
+                                                subtree_history,
+                                                flat_source_history, TRUE,
+                                                scratch_pool, iterpool));
           SVN_ERR(svn_mergeinfo_merge2(subtree_mergeinfo,
                                        merged_via_history,
                                        scratch_pool, iterpool));
@@ -1990,10 +2376,10 @@ svn_client__mergeinfo_log(svn_boolean_t finding_merged,
          resulting intersections have all inheritable ranges.  To get
          around this we set the inheritance on the result to all
          non-inheritable. */
-      SVN_ERR(svn_mergeinfo_intersect2(&merged_noninheritable,
-                                       subtree_noninheritable_mergeinfo,
-                                       subtree_source_history, FALSE,
-                                       scratch_pool, iterpool));
+      SVN_ERR(intersect_with_flat_mergeinfo(&merged_noninheritable,
+                                            subtree_noninheritable_mergeinfo,
+                                            flat_source_history, FALSE,
+                                            scratch_pool, iterpool));
       svn_mergeinfo__set_inheritance(merged_noninheritable, FALSE,
                                      iterpool);
 
@@ -2005,10 +2391,10 @@ svn_client__mergeinfo_log(svn_boolean_t finding_merged,
 
       /* Find the intersection of the inheritable part of TGT_MERGEINFO
          and SOURCE_HISTORY. */
-      SVN_ERR(svn_mergeinfo_intersect2(&merged,
-                                       subtree_inheritable_mergeinfo,
-                                       subtree_source_history, FALSE,
-                                       scratch_pool, iterpool));
+      SVN_ERR(intersect_with_flat_mergeinfo(&merged,
+                                            subtree_inheritable_mergeinfo,
+                                            flat_source_history, FALSE,
+                                            scratch_pool, iterpool));
 
       /* Keep track of all ranges fully merged to any and all
          subtrees. */
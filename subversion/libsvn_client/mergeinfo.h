@@ -312,6 +312,57 @@ svn_client__get_history_as_mergeinfo(svn_mergeinfo_t *mergeinfo_p,
                                      svn_client_ctx_t *ctx,
                                      apr_pool_t *pool);
 
+/* A cache of the mergeinfo and natural history that one operation, such
+   as a merge, looks up in the repository.  Both are fixed once committed,
+   so entries never go stale; only mergeinfo found in the working copy is
+   looked up afresh each time. */
+typedef struct svn_client__mergeinfo_cache_t svn_client__mergeinfo_cache_t;
+
+/* Return a new, empty mergeinfo cache allocated in RESULT_POOL, which
+   must outlive every use of the cache. */
+svn_client__mergeinfo_cache_t *
+svn_client__mergeinfo_cache_create(apr_pool_t *result_pool);
+
+/* Tell CACHE that the repository mergeinfo of LOCAL_ABSPATH's base node
+   is likely to be asked for.  The first lookup that misses CACHE fetches
+   the mergeinfo of all such nodes at its revision in a single request.
+   Locally added nodes are ignored. */
+svn_error_t *
+svn_client__mergeinfo_cache_expect(svn_client__mergeinfo_cache_t *cache,
+                                   const char *local_abspath,
+                                   svn_wc_context_t *wc_ctx,
+                                   apr_pool_t *scratch_pool);
+
+/* Like svn_client__get_wc_or_repos_mergeinfo(), but answer any question
+   for the repository from CACHE, if it is not NULL. */
+svn_error_t *
+svn_client__get_wc_or_repos_mergeinfo_cached(
+  svn_mergeinfo_t *target_mergeinfo,
+  svn_boolean_t *inherited,
+  svn_boolean_t *from_repos,
+  svn_boolean_t repos_only,
+  svn_mergeinfo_inheritance_t inherit,
+  svn_client__mergeinfo_cache_t *cache,
+  svn_ra_session_t *ra_session,
+  const char *target_wcpath,
+  svn_client_ctx_t *ctx,
+  apr_pool_t *pool);
+
+/* Like svn_client__get_history_as_mergeinfo(), but if CACHE is not NULL
+   fetch the whole history of PATHREV only once and answer this and later
+   requests for it from CACHE. */
+svn_error_t *
+svn_client__get_history_as_mergeinfo_cached(
+  svn_mergeinfo_t *mergeinfo_p,
+  svn_boolean_t *has_rev_zero_history,
+  const svn_client__pathrev_t *pathrev,
+  svn_revnum_t range_youngest,
+  svn_revnum_t range_oldest,
+  svn_client__mergeinfo_cache_t *cache,
+  svn_ra_session_t *ra_session,
+  svn_client_ctx_t *ctx,
+  apr_pool_t *pool);
+
 /* Parse any explicit mergeinfo on LOCAL_ABSPATH and store it in
    *MERGEINFO.  If no record of any mergeinfo exists, set *MERGEINFO to NULL.
    Does not account for inherited mergeinfo.
@@ -68,8 +68,18 @@ typedef struct mtcc_op_t
                                            List of svn_prop_t */
 
   svn_boolean_t performed_stat;         /* Verified kind with repository */
+
+  apr_hash_t *child_index;              /* For directories with many
+                                           children: name -> last child
+                                           op with that name */
+  int indexed_children;                 /* Children covered by CHILD_INDEX */
 } mtcc_op_t;
 
+/* Directories with at least this many child operations get a CHILD_INDEX,
+   to avoid quadratic behavior when a single directory receives very many
+   operations. */
+#define MTCC_CHILD_INDEX_THRESHOLD 32
+
 /* Check if the mtcc doesn't contain any modifications yet */
 #define MTCC_UNMODIFIED(mtcc)                                               \
     ((mtcc->root_op->kind == OP_OPEN_DIR                                    \
@@ -115,6 +125,50 @@ mtcc_op_create(const char *name,
   return op;
 }
 
+/* Return the most recent child operation of directory operation OP that
+   is called NAME, or NULL if there is none.  Unless FIND_DELETES is set,
+   ignore delete operations. */
+static mtcc_op_t *
+mtcc_op_find_child(mtcc_op_t *op,
+                   const char *name,
+                   svn_boolean_t find_deletes)
+{
+  mtcc_op_t *cop;
+  int i;
+
+  if (op->children->nelts >= MTCC_CHILD_INDEX_THRESHOLD)
+    {
+      if (!op->child_index)
+        op->child_index = apr_hash_make(op->children->pool);
+
+      /* Children are only ever appended, so just index the new ones. */
+      for (; op->indexed_children < op->children->nelts;
+           op->indexed_children++)
+        {
+          cop = APR_ARRAY_IDX(op->children, op->indexed_children,
+                              mtcc_op_t *);
+          svn_hash_sets(op->child_index, cop->name, cop);
+        }
+
+      cop = svn_hash_gets(op->child_index, name);
+      if (!cop || find_deletes || cop->kind != OP_DELETE)
+        return cop;
+
+      /* The node was replaced; look for the operation before the delete. */
+    }
+
+  for (i = op->children->nelts-1; i >= 0 ; i--)
+    {
+      cop = APR_ARRAY_IDX(op->children, i, mtcc_op_t *);
+
+      if (! strcmp(cop->name, name)
+          && (find_deletes || cop->kind != OP_DELETE))
+        return cop;
+    }
+
+  return NULL;
+}
+
 static svn_error_t *
 mtcc_op_find(mtcc_op_t **op,
              svn_boolean_t *created,
@@ -128,7 +182,6 @@ mtcc_op_find(mtcc_op_t **op,
 {
   const char *name;
   const char *child;
-  int i;
 
   assert(svn_relpath_is_canonical(relpath));
   if (created)
@@ -168,21 +221,15 @@ mtcc_op_find(mtcc_op_t **op,
                                  name, base_op->name);
     }
 
-  for (i = base_op->children->nelts-1; i >= 0 ; i--)
-    {
-      mtcc_op_t *cop;
-
-      cop = APR_ARRAY_IDX(base_op->children, i, mtcc_op_t *);
+  {
+    mtcc_op_t *cop = mtcc_op_find_child(base_op, name, find_deletes);
 
-      if (! strcmp(cop->name, name)
-          && (find_deletes || cop->kind != OP_DELETE))
-        {
-          return svn_error_trace(
-                        mtcc_op_find(op, created, child ? child : "", cop,
-                                     find_existing, find_deletes, create_file,
-                                     result_pool, scratch_pool));
-        }
-    }
+    if (cop)
+      return svn_error_trace(
+                    mtcc_op_find(op, created, child ? child : "", cop,
+                                 find_existing, find_deletes, create_file,
+                                 result_pool, scratch_pool));
+  }
 
   if (!created)
     {
@@ -246,31 +293,22 @@ get_origin(svn_boolean_t *done,
 
   if (op->children && op->children->nelts)
     {
-      int i;
+      mtcc_op_t *cop = mtcc_op_find_child(op, name, TRUE);
 
-      for (i = op->children->nelts-1; i >= 0; i--)
+      if (cop)
         {
-           mtcc_op_t *cop;
-
-           cop = APR_ARRAY_IDX(op->children, i, mtcc_op_t *);
-
-           if (! strcmp(cop->name, name))
+          if (cop->kind == OP_DELETE)
             {
-              if (cop->kind == OP_DELETE)
-                {
-                  *done = TRUE;
-                  return SVN_NO_ERROR;
-                }
-
-              SVN_ERR(get_origin(done, origin_relpath, rev,
-                                 cop, child ? child : "",
-                                 result_pool, scratch_pool));
+              *done = TRUE;
+              return SVN_NO_ERROR;
+            }
 
-              if (*origin_relpath || *done)
-                return SVN_NO_ERROR;
+          SVN_ERR(get_origin(done, origin_relpath, rev,
+                             cop, child ? child : "",
+                             result_pool, scratch_pool));
 
-              break;
-            }
+          if (*origin_relpath || *done)
+            return SVN_NO_ERROR;
         }
     }
 
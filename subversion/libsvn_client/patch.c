@@ -95,6 +95,15 @@ typedef struct target_content_t {
    * each line in the unpatched content. */
   apr_array_header_t *lines;
 
+  /* An array containing an apr_uint32_t hash of each line of unpatched
+   * content read so far, with all whitespace removed.  Element N belongs
+   * to line N + 1.  Used to quickly rule out locations a hunk can't
+   * match at, see line_hash(). */
+  apr_array_header_t *line_hashes;
+
+  /* True if LINE_HASHES covers all of the unpatched content. */
+  svn_boolean_t all_lines_hashed;
+
   /* An array containing hunk_info_t structures for hunks already matched. */
   apr_array_header_t *hunks;
 
@@ -761,6 +770,7 @@ init_prop_target(prop_patch_target_t **prop_target,
   content->current_line = 1;
   content->eol_style = svn_subst_eol_style_none;
   content->lines = apr_array_make(result_pool, 0, sizeof(apr_off_t));
+  content->line_hashes = apr_array_make(result_pool, 0, sizeof(apr_uint32_t));
   content->hunks = apr_array_make(result_pool, 0, sizeof(hunk_info_t *));
   content->keywords = apr_hash_make(result_pool);
 
@@ -1031,6 +1041,7 @@ init_patch_target(patch_target_t **patch_target,
   content->current_line = 1;
   content->eol_style = svn_subst_eol_style_none;
   content->lines = apr_array_make(result_pool, 0, sizeof(apr_off_t));
+  content->line_hashes = apr_array_make(result_pool, 0, sizeof(apr_uint32_t));
   content->hunks = apr_array_make(result_pool, 0, sizeof(hunk_info_t *));
   content->keywords = apr_hash_make(result_pool);
 
@@ -1445,8 +1456,21 @@ init_patch_target(patch_target_t **patch_target,
   return SVN_NO_ERROR;
 }
 
+/* Return a hash of LINE that ignores all whitespace, so that two lines
+ * which compare equal, with or without --ignore-whitespace, always have
+ * the same hash.  Use SCRATCH_POOL for temporary allocations. */
+static apr_uint32_t
+line_hash(const char *line,
+          apr_pool_t *scratch_pool)
+{
+  char *collapsed = apr_pstrdup(scratch_pool, line);
+
+  apr_collapse_spaces(collapsed, collapsed);
+  return svn__fnv1a_32(collapsed, strlen(collapsed));
+}
+
 /* Read a *LINE from CONTENT. If the line has not been read before
- * mark the line in CONTENT->LINES.
+ * mark the line in CONTENT->LINES and CONTENT->LINE_HASHES.
  * If a line could be read successfully, increase CONTENT->CURRENT_LINE,
  * and allocate *LINE in RESULT_POOL.
  * Do temporary allocations in SCRATCH_POOL.
@@ -1460,6 +1484,7 @@ readline(target_content_t *content,
   svn_stringbuf_t *line_raw;
   const char *eol_str;
   svn_linenum_t max_line = (svn_linenum_t)content->lines->nelts + 1;
+  svn_boolean_t new_line;
 
   if (content->eof || content->readline == NULL)
     {
@@ -1468,7 +1493,8 @@ readline(target_content_t *content,
     }
 
   SVN_ERR_ASSERT(content->current_line <= max_line);
-  if (content->current_line == max_line)
+  new_line = (content->current_line == max_line);
+  if (new_line)
     {
       apr_off_t offset;
 
@@ -1495,7 +1521,13 @@ readline(target_content_t *content,
     *line = "";
 
   if ((line_raw && line_raw->len > 0) || eol_str)
-    content->current_line++;
+    {
+      if (new_line)
+        APR_ARRAY_PUSH(content->line_hashes, apr_uint32_t)
+          = line_hash(*line, scratch_pool);
+
+      content->current_line++;
+    }
 
   SVN_ERR_ASSERT(content->current_line > 0);
 
@@ -1665,6 +1697,151 @@ match_hunk(svn_boolean_t *matched, target_content_t *content,
   return SVN_NO_ERROR;
 }
 
+/* Set *HASHES to an array of the line_hash() values of the lines of the
+ * original text of HUNK, or of its modified text if MATCH_MODIFIED is
+ * TRUE, after contracting the KEYWORDS of the target.
+ * Allocate *HASHES in RESULT_POOL and use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+get_hunk_line_hashes(apr_array_header_t **hashes,
+                     svn_diff_hunk_t *hunk,
+                     svn_boolean_t match_modified,
+                     apr_hash_t *keywords,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  svn_boolean_t hunk_eof;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  *hashes = apr_array_make(result_pool, 0, sizeof(apr_uint32_t));
+
+  if (match_modified)
+    svn_diff_hunk_reset_modified_text(hunk);
+  else
+    svn_diff_hunk_reset_original_text(hunk);
+
+  do
+    {
+      svn_stringbuf_t *hunk_line;
+      const char *hunk_line_translated;
+
+      svn_pool_clear(iterpool);
+
+      if (match_modified)
+        SVN_ERR(svn_diff_hunk_readline_modified_text(hunk, &hunk_line,
+                                                     NULL, &hunk_eof,
+                                                     iterpool, iterpool));
+      else
+        SVN_ERR(svn_diff_hunk_readline_original_text(hunk, &hunk_line,
+                                                     NULL, &hunk_eof,
+                                                     iterpool, iterpool));
+
+      if (hunk_eof && hunk_line->len == 0)
+        break;
+
+      SVN_ERR(svn_subst_translate_cstring2(hunk_line->data,
+                                           &hunk_line_translated,
+                                           NULL, FALSE, keywords, FALSE,
+                                           iterpool));
+      APR_ARRAY_PUSH(*hashes, apr_uint32_t)
+        = line_hash(hunk_line_translated, iterpool);
+    }
+  while (! hunk_eof);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Make sure CONTENT->LINE_HASHES covers all lines of CONTENT.
+ * When this function returns, neither CONTENT->CURRENT_LINE nor
+ * the file offset in the target file will have changed.
+ * Do temporary allocations in SCRATCH_POOL. */
+static svn_error_t *
+hash_all_lines(target_content_t *content,
+               apr_pool_t *scratch_pool)
+{
+  svn_linenum_t saved_line;
+  svn_boolean_t saved_eof;
+  apr_pool_t *iterpool;
+
+  if (content->all_lines_hashed || content->readline == NULL)
+    return SVN_NO_ERROR;
+
+  saved_line = content->current_line;
+  saved_eof = content->eof;
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (! content->eof)
+    {
+      const char *dummy;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(readline(content, &dummy, iterpool, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  content->all_lines_hashed = TRUE;
+
+  SVN_ERR(seek_to_line(content, saved_line, scratch_pool));
+  content->eof = saved_eof;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return FALSE if match_hunk() with HUNK, FUZZ and HUNK_HASHES as returned
+ * by get_hunk_line_hashes() can't possibly match CONTENT at LINE, because
+ * one of the lines that would have to be equal has a different hash.
+ * Otherwise return TRUE. */
+static svn_boolean_t
+hunk_may_match(const target_content_t *content,
+               svn_linenum_t line,
+               svn_diff_hunk_t *hunk,
+               svn_linenum_t fuzz,
+               svn_boolean_t match_modified,
+               const apr_array_header_t *hunk_hashes)
+{
+  svn_linenum_t fuzz_penalty = svn_diff_hunk__get_fuzz_penalty(hunk);
+  svn_linenum_t leading_context = svn_diff_hunk_get_leading_context(hunk);
+  svn_linenum_t trailing_context = svn_diff_hunk_get_trailing_context(hunk);
+  svn_linenum_t hunk_length;
+  svn_linenum_t lines_read;
+
+  if (fuzz_penalty > fuzz)
+    return TRUE;
+  else
+    fuzz -= fuzz_penalty;
+
+  if (match_modified)
+    hunk_length = svn_diff_hunk_get_modified_length(hunk);
+  else
+    hunk_length = svn_diff_hunk_get_original_length(hunk);
+
+  /* Same line numbering as in match_hunk(). */
+  for (lines_read = 1;
+       lines_read <= (svn_linenum_t)hunk_hashes->nelts;
+       lines_read++)
+    {
+      svn_linenum_t target_line = line + lines_read - 1;
+
+      /* We don't know this line, so let match_hunk() decide. */
+      if (target_line > (svn_linenum_t)content->line_hashes->nelts)
+        break;
+
+      /* Leading/trailing fuzzy lines always match. */
+      if ((lines_read <= fuzz && leading_context > fuzz) ||
+          (lines_read > hunk_length - fuzz && trailing_context > fuzz))
+        continue;
+
+      if (APR_ARRAY_IDX(hunk_hashes, lines_read - 1, apr_uint32_t)
+          != APR_ARRAY_IDX(content->line_hashes, target_line - 1,
+                           apr_uint32_t))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 /* Scan lines of CONTENT for a match of the original text of HUNK,
  * up to but not including the specified UPPER_LINE. Use fuzz factor FUZZ.
  * If UPPER_LINE is zero scan until EOF occurs when reading from TARGET.
@@ -1690,8 +1867,16 @@ scan_for_match(svn_linenum_t *matched_line,
                apr_pool_t *pool)
 {
   apr_pool_t *iterpool;
+  apr_array_header_t *hunk_hashes;
 
   *matched_line = 0;
+
+  /* Comparing line hashes in memory is much cheaper than reading both
+     the target and the hunk again for every line we try. */
+  SVN_ERR(hash_all_lines(content, pool));
+  SVN_ERR(get_hunk_line_hashes(&hunk_hashes, hunk, match_modified,
+                               content->keywords, pool, pool));
+
   iterpool = svn_pool_create(pool);
   while ((content->current_line < upper_line || upper_line == 0) &&
          ! content->eof)
@@ -1703,8 +1888,12 @@ scan_for_match(svn_linenum_t *matched_line,
       if (cancel_func)
         SVN_ERR(cancel_func(cancel_baton));
 
-      SVN_ERR(match_hunk(&matched, content, hunk, fuzz, ignore_whitespace,
-                         match_modified, iterpool));
+      if (hunk_may_match(content, content->current_line, hunk, fuzz,
+                         match_modified, hunk_hashes))
+        SVN_ERR(match_hunk(&matched, content, hunk, fuzz, ignore_whitespace,
+                           match_modified, iterpool));
+      else
+        matched = FALSE;
       if (matched)
         {
           svn_boolean_t taken = FALSE;
@@ -23,7 +23,10 @@
 
 
 
+#include <string.h>
+
 #include <apr_pools.h>
+#include <apr_strings.h>
 
 #include "svn_error.h"
 #include "svn_hash.h"
@@ -257,11 +260,12 @@ get_wc_contents(void *baton,
 {
   callback_baton_t *cb = baton;
 
+  /* A checkout has no working copy yet, but may still find the contents
+     in the shared pristine store. */
   if (! cb->wcroot_abspath)
-    {
-      *contents = NULL;
-      return SVN_NO_ERROR;
-    }
+    return svn_error_trace(
+             svn_wc__get_shared_pristine_contents(contents, cb->ctx->wc_ctx,
+                                                  checksum, pool, pool));
 
   return svn_error_trace(
              svn_wc__get_pristine_contents_by_checksum(contents,
@@ -1183,6 +1187,70 @@ svn_client__ra_get_copysrc_kind(svn_node_kind_t *kind,
 }
 
 
+/* The baton of fetch_textbase(). */
+struct textbase_fetch_baton_t
+{
+  svn_client_ctx_t *ctx;
+
+  /* The session opened by the first fetch, for REPOS_ROOT_URL, or NULL. */
+  svn_ra_session_t *ra_session;
+  const char *repos_root_url;
+
+  apr_pool_t *pool;
+};
+
+/* Implements svn_wc__textbase_fetch_cb_t. */
+static svn_error_t *
+fetch_textbase(void *baton,
+               const char *repos_root_url,
+               const char *repos_relpath,
+               svn_revnum_t revision,
+               svn_stream_t *contents,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  struct textbase_fetch_baton_t *b = baton;
+  const char *url = svn_path_url_add_component2(repos_root_url,
+                                                repos_relpath, scratch_pool);
+
+  if (b->ra_session && strcmp(b->repos_root_url, repos_root_url) == 0)
+    SVN_ERR(svn_ra_reparent(b->ra_session, url, scratch_pool));
+  else
+    {
+      SVN_ERR(svn_client__open_ra_session_internal(&b->ra_session, NULL, url,
+                                                   NULL, NULL, FALSE, FALSE,
+                                                   b->ctx, b->pool,
+                                                   scratch_pool));
+      b->repos_root_url = apr_pstrdup(b->pool, repos_root_url);
+    }
+
+  return svn_error_trace(svn_ra_get_file(b->ra_session, "", revision,
+                                         contents, NULL, NULL,
+                                         scratch_pool));
+}
+
+svn_error_t *
+svn_client__textbase_sync(const char *local_abspath,
+                          svn_depth_t depth,
+                          svn_client_ctx_t *ctx,
+                          apr_pool_t *scratch_pool)
+{
+  struct textbase_fetch_baton_t b = { 0 };
+  svn_error_t *err;
+
+  b.ctx = ctx;
+  b.pool = svn_pool_create(scratch_pool);
+
+  err = svn_wc__textbase_sync(ctx->wc_ctx, local_abspath, depth,
+                              fetch_textbase, &b,
+                              ctx->cancel_func, ctx->cancel_baton,
+                              scratch_pool);
+  svn_pool_destroy(b.pool);
+
+  return svn_error_trace(err);
+}
+
 void *
 svn_client__ra_make_cb_baton(svn_wc_context_t *wc_ctx,
                              apr_hash_t *relpath_map,
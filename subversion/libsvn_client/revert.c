@@ -69,17 +69,21 @@ revert(void *baton, apr_pool_t *result_pool, apr_pool_t *scratch_pool)
   struct revert_with_write_lock_baton *b = baton;
   svn_error_t *err;
 
-  err = svn_wc_revert6(b->ctx->wc_ctx,
-                       b->local_abspath,
-                       b->depth,
-                       b->use_commit_times,
-                       b->changelists,
-                       b->clear_changelists,
-                       b->metadata_only,
-                       b->added_keep_local,
-                       b->ctx->cancel_func, b->ctx->cancel_baton,
-                       b->ctx->notify_func2, b->ctx->notify_baton2,
-                       scratch_pool);
+  /* Reverting a modified file installs its pristine text. */
+  err = svn_client__textbase_sync(b->local_abspath, b->depth, b->ctx,
+                                  scratch_pool);
+  if (!err)
+    err = svn_wc_revert6(b->ctx->wc_ctx,
+                         b->local_abspath,
+                         b->depth,
+                         b->use_commit_times,
+                         b->changelists,
+                         b->clear_changelists,
+                         b->metadata_only,
+                         b->added_keep_local,
+                         b->ctx->cancel_func, b->ctx->cancel_baton,
+                         b->ctx->notify_func2, b->ctx->notify_baton2,
+                         scratch_pool);
 
   if (err)
     {
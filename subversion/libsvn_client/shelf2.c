@@ -40,6 +40,7 @@
 #include "client.h"
 #include "private/svn_client_shelf2.h"
 #include "private/svn_client_private.h"
+#include "private/svn_io_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_sorts_private.h"
 #include "svn_private_config.h"
@@ -922,6 +923,47 @@ read_props_from_shelf(apr_hash_t **base_props,
   return SVN_NO_ERROR;
 }
 
+/* Copy the file FROM_ABSPATH to TO_ABSPATH, replacing TO_ABSPATH if it
+ * exists, and copy its permissions.
+ *
+ * Where the file system supports it, make the copy a copy-on-write clone,
+ * so that it takes no time and no disk space until either file changes.
+ */
+static svn_error_t *
+clone_or_copy_file(const char *from_abspath,
+                   const char *to_abspath,
+                   apr_pool_t *scratch_pool)
+{
+  const char *tmp_abspath;
+  svn_error_t *err;
+
+  SVN_ERR(svn_io_open_unique_file3(NULL, &tmp_abspath,
+                                   svn_dirent_dirname(to_abspath,
+                                                      scratch_pool),
+                                   svn_io_file_del_none,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_remove_file2(tmp_abspath, FALSE, scratch_pool));
+
+  err = svn_io__file_clone(from_abspath, tmp_abspath, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+    {
+      svn_error_clear(err);
+      return svn_error_trace(svn_io_copy_file(from_abspath, to_abspath,
+                                              TRUE /*copy_perms*/,
+                                              scratch_pool));
+    }
+  SVN_ERR(err);
+
+  err = svn_io_copy_perms(from_abspath, tmp_abspath, scratch_pool);
+  if (!err)
+    err = svn_io_file_rename2(tmp_abspath, to_abspath, FALSE, scratch_pool);
+  if (err)
+    return svn_error_compose_create(
+             err, svn_io_remove_file2(tmp_abspath, TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Store metadata for any node, and base and working files if it's a file.
  *
  * Copy the WC base and working files at FROM_WC_ABSPATH to the storage
@@ -985,8 +1027,8 @@ store_file(const char *from_wc_abspath,
       SVN_ERR(svn_io_check_path(from_wc_abspath, &work_kind, scratch_pool));
       if (work_kind == svn_node_file)
         {
-          SVN_ERR(svn_io_copy_file(from_wc_abspath, stored_abspath,
-                                   TRUE /*copy_perms*/, scratch_pool));
+          SVN_ERR(clone_or_copy_file(from_wc_abspath, stored_abspath,
+                                     scratch_pool));
         }
     }
   return SVN_NO_ERROR;
@@ -1620,8 +1662,8 @@ apply_file_visitor(void *baton,
       else if (s->kind == svn_node_file)
         {
           SVN_ERR(svn_io_make_dir_recursively(to_dir_abspath, scratch_pool));
-          SVN_ERR(svn_io_copy_file(stored_work_abspath, to_wc_abspath,
-                                   TRUE /*copy_perms*/, scratch_pool));
+          SVN_ERR(clone_or_copy_file(stored_work_abspath, to_wc_abspath,
+                                     scratch_pool));
         }
       SVN_ERR(wc_node_add(to_wc_abspath, work_props, b->ctx, scratch_pool));
       SVN_ERR(send_notification(to_wc_abspath,
@@ -306,6 +306,13 @@ switch_internal(svn_revnum_t *result_rev,
   dfb.anchor_url = anchor_url;
   dfb.target_revision = switch_loc->rev;
 
+  /* Merging incoming changes into modified files needs their pristine
+     texts. */
+  SVN_ERR(svn_client__textbase_sync(local_abspath,
+                                    depth == svn_depth_unknown
+                                      ? svn_depth_infinity : depth,
+                                    ctx, pool));
+
   SVN_ERR(svn_wc__get_switch_editor(&switch_editor, &switch_edit_baton,
                                     &revnum, ctx->wc_ctx, anchor_abspath,
                                     target, switch_loc->url, wcroot_iprops,
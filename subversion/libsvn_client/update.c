@@ -519,6 +519,13 @@ update_internal(svn_revnum_t *result_rev,
                                             revnum, depth, ra_session,
                                             ctx, scratch_pool, scratch_pool));
 
+  /* Merging incoming changes into modified files needs their pristine
+     texts. */
+  SVN_ERR(svn_client__textbase_sync(local_abspath,
+                                    depth == svn_depth_unknown
+                                      ? svn_depth_infinity : depth,
+                                    ctx, scratch_pool));
+
   /* Fetch the update editor.  If REVISION is invalid, that's okay;
      the RA driver will call editor->set_target_revision later on. */
   SVN_ERR(svn_wc__get_update_editor(&update_editor, &update_edit_baton,
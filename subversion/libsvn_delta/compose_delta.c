@@ -30,6 +30,9 @@
 #include "svn_pools.h"
 #include "delta.h"
 
+#include "private/svn_delta_private.h"
+#include "private/svn_stats.h"
+
 /* Define a MIN macro if this platform doesn't already have one. */
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -759,24 +762,32 @@ copy_source_ops(apr_size_t offset, apr_size_t limit,
 /* ==================================================================== */
 /* Bringing it all together. */
 
-
-svn_txdelta_window_t *
-svn_txdelta_compose_windows(const svn_txdelta_window_t *window_A,
-                            const svn_txdelta_window_t *window_B,
-                            apr_pool_t *pool)
+SVN__COUNTER_DEFINE(compose_timer, "delta.compose_windows");
+
+/* Return the composite of WINDOW_A and WINDOW_B as described for
+   svn_txdelta_compose_windows(), allocated in RESULT_POOL.  RANGE_INDEX
+   must be empty and will be empty again upon return.  Use SCRATCH_POOL
+   for temporary allocations. */
+static svn_txdelta_window_t *
+compose_windows(const svn_txdelta_window_t *window_A,
+                const svn_txdelta_window_t *window_B,
+                range_index_t *range_index,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
 {
   svn_txdelta__ops_baton_t build_baton = { 0 };
   svn_txdelta_window_t *composite;
-  apr_pool_t *subpool = svn_pool_create(pool);
-  offset_index_t *offset_index = create_offset_index(window_A, subpool);
-  range_index_t *range_index = create_range_index(subpool);
+  offset_index_t *offset_index = create_offset_index(window_A, scratch_pool);
   apr_size_t target_offset = 0;
+  apr_time_t start;
   int i;
 
+  SVN__TIMER_START(compose_timer, start);
+
   /* Read the description of the delta composition algorithm in
      notes/fs-improvements.txt before going any further.
      You have been warned. */
-  build_baton.new_data = svn_stringbuf_create_empty(pool);
+  build_baton.new_data = svn_stringbuf_create_empty(result_pool);
   for (i = 0; i < window_B->num_ops; ++i)
     {
       const svn_txdelta_op_t *const op = &window_B->ops[i];
@@ -790,7 +801,7 @@ svn_txdelta_compose_windows(const svn_txdelta_window_t *window_A,
              : NULL);
           svn_txdelta__insert_op(&build_baton, op->action_code,
                                  op->offset, op->length,
-                                 new_data, pool);
+                                 new_data, result_pool);
         }
       else
         {
@@ -811,11 +822,11 @@ svn_txdelta_compose_windows(const svn_txdelta_window_t *window_A,
                 svn_txdelta__insert_op(&build_baton, svn_txdelta_target,
                                        range->target_offset,
                                        range->limit - range->offset,
-                                       NULL, pool);
+                                       NULL, result_pool);
               else
                 copy_source_ops(range->offset, range->limit, tgt_off, 0,
                                 &build_baton, window_A, offset_index,
-                                pool);
+                                result_pool);
 
               tgt_off += range->limit - range->offset;
             }
@@ -829,11 +840,146 @@ svn_txdelta_compose_windows(const svn_txdelta_window_t *window_A,
       target_offset += op->length;
     }
 
-  svn_pool_destroy(subpool);
+  /* Return all nodes to the free list for the next caller. */
+  delete_subtree(range_index, range_index->tree);
+  range_index->tree = NULL;
 
-  composite = svn_txdelta__make_window(&build_baton, pool);
+  composite = svn_txdelta__make_window(&build_baton, result_pool);
   composite->sview_offset = window_A->sview_offset;
   composite->sview_len = window_A->sview_len;
   composite->tview_len = window_B->tview_len;
+
+  SVN__TIMER_STOP(compose_timer, start);
+  return composite;
+}
+
+svn_txdelta_window_t *
+svn_txdelta_compose_windows(const svn_txdelta_window_t *window_A,
+                            const svn_txdelta_window_t *window_B,
+                            apr_pool_t *pool)
+{
+  svn_txdelta_window_t *composite;
+  apr_pool_t *subpool = svn_pool_create(pool);
+  range_index_t *range_index = create_range_index(subpool);
+
+  composite = compose_windows(window_A, window_B, range_index, pool,
+                              subpool);
+  svn_pool_destroy(subpool);
+
   return composite;
 }
+
+
+
+/* ==================================================================== */
+/* Folding whole delta chains. */
+
+struct svn_txdelta__composer_t
+{
+  /* The composite of all windows added so far.  NULL before the first
+     window has been added. */
+  svn_txdelta_window_t *composite;
+
+  /* The two pools COMPOSITE gets alternately allocated in.  The pool
+     not holding COMPOSITE is empty. */
+  apr_pool_t *window_pools[2];
+
+  /* Index into WINDOW_POOLS of the pool holding COMPOSITE. */
+  int current;
+
+  /* Range index shared by all compositions.  Its nodes are allocated
+     from the composer's own pool and recycled through the free list,
+     so folding more windows does not allocate any more nodes than the
+     largest single composition needed. */
+  range_index_t *range_index;
+
+  /* For temporary allocations during a single composition. */
+  apr_pool_t *scratch_pool;
+};
+
+svn_txdelta__composer_t *
+svn_txdelta__composer_create(apr_pool_t *result_pool)
+{
+  svn_txdelta__composer_t *composer = apr_pcalloc(result_pool,
+                                                  sizeof(*composer));
+
+  composer->window_pools[0] = svn_pool_create(result_pool);
+  composer->window_pools[1] = svn_pool_create(result_pool);
+  composer->range_index = create_range_index(result_pool);
+  composer->scratch_pool = svn_pool_create(result_pool);
+
+  return composer;
+}
+
+void
+svn_txdelta__composer_add(svn_txdelta__composer_t *composer,
+                          const svn_txdelta_window_t *window)
+{
+  int next = 1 - composer->current;
+  apr_pool_t *window_pool = composer->window_pools[next];
+
+  if (composer->composite == NULL)
+    {
+      composer->composite = svn_txdelta_window_dup(window, window_pool);
+    }
+  else
+    {
+      composer->composite = compose_windows(window, composer->composite,
+                                            composer->range_index,
+                                            window_pool,
+                                            composer->scratch_pool);
+      svn_pool_clear(composer->scratch_pool);
+    }
+
+  svn_pool_clear(composer->window_pools[composer->current]);
+  composer->current = next;
+}
+
+svn_boolean_t
+svn_txdelta__composer_done(const svn_txdelta__composer_t *composer)
+{
+  return composer->composite
+      && (composer->composite->sview_len == 0
+          || composer->composite->src_ops == 0);
+}
+
+svn_txdelta_window_t *
+svn_txdelta__composer_get(const svn_txdelta__composer_t *composer)
+{
+  return composer->composite;
+}
+
+void
+svn_txdelta__composer_reset(svn_txdelta__composer_t *composer)
+{
+  composer->composite = NULL;
+  svn_pool_clear(composer->window_pools[0]);
+  svn_pool_clear(composer->window_pools[1]);
+}
+
+svn_txdelta_window_t *
+svn_txdelta__compose_window_list(const apr_array_header_t *windows,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_txdelta__composer_t *composer;
+  int i;
+
+  if (windows->nelts == 0)
+    return NULL;
+
+  if (windows->nelts == 1)
+    return svn_txdelta_window_dup(APR_ARRAY_IDX(windows, 0,
+                                                svn_txdelta_window_t *),
+                                  result_pool);
+
+  composer = svn_txdelta__composer_create(scratch_pool);
+  for (i = 0; i < windows->nelts && !svn_txdelta__composer_done(composer);
+       ++i)
+    svn_txdelta__composer_add(composer,
+                              APR_ARRAY_IDX(windows, i,
+                                            svn_txdelta_window_t *));
+
+  return svn_txdelta_window_dup(svn_txdelta__composer_get(composer),
+                                result_pool);
+}
@@ -39,13 +39,16 @@
 static const char SVNDIFF_V0[] = { 'S', 'V', 'N', 0 };
 static const char SVNDIFF_V1[] = { 'S', 'V', 'N', 1 };
 static const char SVNDIFF_V2[] = { 'S', 'V', 'N', 2 };
+static const char SVNDIFF_V3[] = { 'S', 'V', 'N', 3 };
 
 #define SVNDIFF_HEADER_SIZE (sizeof(SVNDIFF_V0))
 
 static const char *
 get_svndiff_header(int version)
 {
-  if (version == 2)
+  if (version == 3)
+    return SVNDIFF_V3;
+  else if (version == 2)
     return SVNDIFF_V2;
   else if (version == 1)
     return SVNDIFF_V1;
@@ -198,7 +201,15 @@ encode_window(svn_stringbuf_t **instructions_p,
   append_encoded_int(header, window->sview_offset);
   append_encoded_int(header, window->sview_len);
   append_encoded_int(header, window->tview_len);
-  if (version == 2)
+  if (version == 3)
+    {
+      svn_stringbuf_t *compressed_instructions;
+      compressed_instructions = svn_stringbuf_create_empty(pool);
+      SVN_ERR(svn__compress_zstd(instructions->data, instructions->len,
+                                 compressed_instructions, compression_level));
+      instructions = compressed_instructions;
+    }
+  else if (version == 2)
     {
       svn_stringbuf_t *compressed_instructions;
       compressed_instructions = svn_stringbuf_create_empty(pool);
@@ -217,7 +228,16 @@ encode_window(svn_stringbuf_t **instructions_p,
   append_encoded_int(header, instructions->len);
 
   /* Encode the data. */
-  if (version == 2)
+  if (version == 3)
+    {
+      svn_stringbuf_t *compressed = svn_stringbuf_create_empty(pool);
+
+      SVN_ERR(svn__compress_zstd(window->new_data->data,
+                                 window->new_data->len,
+                                 compressed, compression_level));
+      newdata = svn_stringbuf__morph_into_string(compressed);
+    }
+  else if (version == 2)
     {
       svn_stringbuf_t *compressed = svn_stringbuf_create_empty(pool);
 
@@ -410,13 +430,31 @@ decode_file_offset(svn_filesize_t *val,
 }
 
 /* Same as above, only decode into a size variable. */
-static const unsigned char *
+static APR_INLINE const unsigned char *
 decode_size(apr_size_t *val,
             const unsigned char *p,
             const unsigned char *end)
 {
   apr_uint64_t temp = 0;
-  const unsigned char *result = svn__decode_uint(&temp, p, end);
+  const unsigned char *result;
+
+  /* Instruction lengths and offsets almost always fit into one or two
+     bytes.  Decode those inline. */
+  if (SVN__PREDICT_TRUE(end - p >= 2))
+    {
+      if (p[0] < 0x80)
+        {
+          *val = p[0];
+          return p + 1;
+        }
+      if (p[1] < 0x80)
+        {
+          *val = ((apr_size_t)(p[0] & 0x7f) << 7) | p[1];
+          return p + 2;
+        }
+    }
+
+  result = svn__decode_uint(&temp, p, end);
   if (temp > APR_SIZE_MAX)
     return NULL;
 
@@ -427,7 +465,7 @@ decode_size(apr_size_t *val,
 /* Decode an instruction into OP, returning a pointer to the text
    after the instruction.  Note that if the action code is
    svn_txdelta_new, the offset field of *OP will not be set.  */
-static const unsigned char *
+static APR_INLINE const unsigned char *
 decode_instruction(svn_txdelta_op_t *op,
                    const unsigned char *p,
                    const unsigned char *end)
@@ -468,67 +506,76 @@ decode_instruction(svn_txdelta_op_t *op,
   return p;
 }
 
-/* Count the instructions in the range [P..END-1] and make sure they
-   are valid for the given window lengths.  Return an error if the
-   instructions are invalid; otherwise set *NINST to the number of
-   instructions.  */
+/* Decode the instructions in the range [P..END-1] into OPS and make sure
+   they are valid for the given window lengths.  OPS must have room for
+   MIN(END - P, TVIEW_LEN + 1) instructions: each of them takes at least
+   one byte and each but an invalid last one produces at least one byte
+   of target.
+   Return an error if the instructions are invalid; otherwise set *NINST
+   to the number of instructions and *SRC_OPS to the number of source
+   copy instructions among them.  */
 static svn_error_t *
-count_and_verify_instructions(int *ninst,
-                              const unsigned char *p,
-                              const unsigned char *end,
-                              apr_size_t sview_len,
-                              apr_size_t tview_len,
-                              apr_size_t new_len)
+decode_and_verify_instructions(svn_txdelta_op_t *ops,
+                               int *ninst,
+                               int *src_ops,
+                               const unsigned char *p,
+                               const unsigned char *end,
+                               apr_size_t sview_len,
+                               apr_size_t tview_len,
+                               apr_size_t new_len)
 {
   int n = 0;
-  svn_txdelta_op_t op;
+  svn_txdelta_op_t *op = ops;
   apr_size_t tpos = 0, npos = 0;
 
-  while (p < end)
+  *src_ops = 0;
+  for (; p < end; op++)
     {
-      p = decode_instruction(&op, p, end);
+      p = decode_instruction(op, p, end);
 
       /* Detect any malformed operations from the instruction stream. */
       if (p == NULL)
         return svn_error_createf
           (SVN_ERR_SVNDIFF_INVALID_OPS, NULL,
            _("Invalid diff stream: insn %d cannot be decoded"), n);
-      else if (op.length == 0)
+      else if (op->length == 0)
         return svn_error_createf
           (SVN_ERR_SVNDIFF_INVALID_OPS, NULL,
            _("Invalid diff stream: insn %d has length zero"), n);
-      else if (op.length > tview_len - tpos)
+      else if (op->length > tview_len - tpos)
         return svn_error_createf
           (SVN_ERR_SVNDIFF_INVALID_OPS, NULL,
            _("Invalid diff stream: insn %d overflows the target view"), n);
 
-      switch (op.action_code)
+      switch (op->action_code)
         {
         case svn_txdelta_source:
-          if (op.length > sview_len - op.offset ||
-              op.offset > sview_len)
+          if (op->length > sview_len - op->offset ||
+              op->offset > sview_len)
             return svn_error_createf
               (SVN_ERR_SVNDIFF_INVALID_OPS, NULL,
                _("Invalid diff stream: "
                  "[src] insn %d overflows the source view"), n);
+          ++*src_ops;
           break;
         case svn_txdelta_target:
-          if (op.offset >= tpos)
+          if (op->offset >= tpos)
             return svn_error_createf
               (SVN_ERR_SVNDIFF_INVALID_OPS, NULL,
                _("Invalid diff stream: "
                  "[tgt] insn %d starts beyond the target view position"), n);
           break;
         case svn_txdelta_new:
-          if (op.length > new_len - npos)
+          if (op->length > new_len - npos)
             return svn_error_createf
               (SVN_ERR_SVNDIFF_INVALID_OPS, NULL,
                _("Invalid diff stream: "
                  "[new] insn %d overflows the new data section"), n);
-          npos += op.length;
+          op->offset = npos;
+          npos += op->length;
           break;
         }
-      tpos += op.length;
+      tpos += op->length;
       n++;
     }
   if (tpos != tview_len)
@@ -555,8 +602,8 @@ decode_window(svn_txdelta_window_t *window, svn_filesize_t sview_offset,
 {
   const unsigned char *insend;
   int ninst;
-  apr_size_t npos;
-  svn_txdelta_op_t *ops, *op;
+  apr_size_t max_ops;
+  svn_txdelta_op_t *ops;
   svn_string_t *new_data;
 
   window->sview_offset = sview_offset;
@@ -565,7 +612,23 @@ decode_window(svn_txdelta_window_t *window, svn_filesize_t sview_offset,
 
   insend = data + inslen;
 
-  if (version == 2)
+  if (version == 3)
+    {
+      svn_stringbuf_t *instout = svn_stringbuf_create_empty(pool);
+      svn_stringbuf_t *ndout = svn_stringbuf_create_empty(pool);
+
+      SVN_ERR(svn__decompress_zstd(insend, newlen, ndout,
+                                   SVN_DELTA_WINDOW_SIZE));
+      SVN_ERR(svn__decompress_zstd(data, insend - data, instout,
+                                   MAX_INSTRUCTION_SECTION_LEN));
+
+      newlen = ndout->len;
+      data = (unsigned char *)instout->data;
+      insend = (unsigned char *)instout->data + instout->len;
+
+      new_data = svn_stringbuf__morph_into_string(ndout);
+    }
+  else if (version == 2)
     {
       svn_stringbuf_t *instout = svn_stringbuf_create_empty(pool);
       svn_stringbuf_t *ndout = svn_stringbuf_create_empty(pool);
@@ -604,26 +667,15 @@ decode_window(svn_txdelta_window_t *window, svn_filesize_t sview_offset,
       new_data = svn_string_ncreate((const char*)insend, newlen, pool);
     }
 
-  /* Count the instructions and make sure they are all valid.  */
-  SVN_ERR(count_and_verify_instructions(&ninst, data, insend,
-                                        sview_len, tview_len, newlen));
-
-  /* Allocate a buffer for the instructions and decode them. */
-  ops = apr_palloc(pool, ninst * sizeof(*ops));
-  npos = 0;
-  window->src_ops = 0;
-  for (op = ops; op < ops + ninst; op++)
-    {
-      data = decode_instruction(op, data, insend);
-      if (op->action_code == svn_txdelta_source)
-        ++window->src_ops;
-      else if (op->action_code == svn_txdelta_new)
-        {
-          op->offset = npos;
-          npos += op->length;
-        }
-    }
-  SVN_ERR_ASSERT(data == insend);
+  /* Decode the instructions in a single pass, allocating for the largest
+     number of them that the instruction section can hold. */
+  max_ops = insend - data;
+  if (max_ops > tview_len + 1)
+    max_ops = tview_len + 1;
+  ops = apr_palloc(pool, max_ops * sizeof(*ops));
+  SVN_ERR(decode_and_verify_instructions(ops, &ninst, &window->src_ops,
+                                         data, insend, sview_len, tview_len,
+                                         newlen));
 
   window->ops = ops;
   window->num_ops = ninst;
@@ -653,6 +705,8 @@ write_handler(void *baton,
         db->version = 1;
       else if (memcmp(buffer, SVNDIFF_V2 + db->header_bytes, nheader) == 0)
         db->version = 2;
+      else if (memcmp(buffer, SVNDIFF_V3 + db->header_bytes, nheader) == 0)
+        db->version = 3;
       else
         return svn_error_create(SVN_ERR_SVNDIFF_INVALID_HEADER, NULL,
                                 _("Svndiff has invalid header"));
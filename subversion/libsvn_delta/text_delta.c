@@ -27,13 +27,19 @@
 
 #include <apr_general.h>        /* for APR_INLINE */
 #include <apr_md5.h>            /* for, um...MD5 stuff */
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+#endif
 
 #include "svn_delta.h"
 #include "svn_io.h"
 #include "svn_pools.h"
 #include "svn_checksum.h"
 
+#include "private/svn_stats.h"
+
 #include "delta.h"
+#include "svn_private_config.h"
 
 
 /* Text delta stream descriptor. */
@@ -45,6 +51,29 @@ struct svn_txdelta_stream_t {
   svn_txdelta_md5_digest_fn_t md5_digest;
 };
 
+#if APR_HAS_THREADS
+/* When the delta spans multiple windows, we compute the next window in a
+ * worker thread while the current one is being processed (e.g. encoded
+ * and written) by the caller.  This is the state of one such window.
+ */
+typedef struct window_job_t {
+  /* Source and target data of the window, 2 * SVN_DELTA_WINDOW_SIZE. */
+  char *buf;
+  apr_size_t source_len;
+  apr_size_t target_len;
+  svn_filesize_t source_offset;
+
+  /* The computed window, allocated in POOL. */
+  svn_txdelta_window_t *window;
+
+  /* Root pool used exclusively by the worker while it is running. */
+  apr_pool_t *pool;
+
+  /* The worker thread, NULL if not running. */
+  apr_thread_t *thread;
+} window_job_t;
+#endif
+
 /* Delta stream baton. */
 struct txdelta_baton {
   /* These are copied from parameters passed to svn_txdelta. */
@@ -62,6 +91,12 @@ struct txdelta_baton {
   svn_checksum_t *checksum;     /* If non-NULL, the checksum of TARGET. */
 
   apr_pool_t *result_pool;      /* For results (e.g. checksum) */
+  apr_pool_t *pool;             /* For the internal state */
+
+#if APR_HAS_THREADS
+  window_job_t *jobs;           /* Two slots, NULL until needed. */
+  window_job_t *pending;        /* Job for the next window to return. */
+#endif
 };
 
 
@@ -80,6 +115,12 @@ struct tpush_baton {
   apr_size_t source_len;
   svn_boolean_t source_done;
   apr_size_t target_len;
+
+#if APR_HAS_THREADS
+  window_job_t *jobs;           /* Two slots, NULL until needed. */
+  int current;                  /* Index of the job that owns BUF. */
+  window_job_t *pending;        /* Job of the window to send next. */
+#endif
 };
 
 
@@ -139,6 +180,8 @@ svn_txdelta__make_window(const svn_txdelta__ops_baton_t *build_baton,
 }
 
 
+SVN__COUNTER_DEFINE(compute_timer, "delta.compute_window");
+
 /* Compute and return a delta window using the xdelta algorithm on
    DATA, which contains SOURCE_LEN bytes of source data and TARGET_LEN
    bytes of target data.  SOURCE_OFFSET gives the offset of the source
@@ -149,6 +192,9 @@ compute_window(const char *data, apr_size_t source_len, apr_size_t target_len,
 {
   svn_txdelta__ops_baton_t build_baton = { 0 };
   svn_txdelta_window_t *window;
+  apr_time_t start;
+
+  SVN__TIMER_START(compute_timer, start);
 
   /* Compute the delta operations. */
   build_baton.new_data = svn_stringbuf_create_empty(pool);
@@ -164,9 +210,109 @@ compute_window(const char *data, apr_size_t source_len, apr_size_t target_len,
   window->sview_offset = source_offset;
   window->sview_len = source_len;
   window->tview_len = target_len;
+
+  SVN__TIMER_STOP(compute_timer, start);
   return window;
 }
 
+#if APR_HAS_THREADS
+/* Thread function computing the window of the window_job_t in DATA. */
+static void * APR_THREAD_FUNC
+window_worker(apr_thread_t *thread, void *data)
+{
+  window_job_t *job = data;
+
+  job->window = compute_window(job->buf, job->source_len, job->target_len,
+                               job->source_offset, job->pool);
+
+  /* End thread explicitly to prevent APR_INCOMPLETE return codes in
+     apr_thread_join(). */
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Pool cleanup function for a window_job_t given as DATA.  Wait for
+   any running worker before releasing its memory. */
+static apr_status_t
+cleanup_window_job(void *data)
+{
+  window_job_t *job = data;
+
+  if (job->thread)
+    {
+      apr_status_t retval;
+      apr_thread_join(&retval, job->thread);
+      job->thread = NULL;
+    }
+
+  svn_pool_destroy(job->pool);
+  return APR_SUCCESS;
+}
+
+/* Initialize JOB to use BUF for its data.  Tie the lifetime of its
+   resources to POOL. */
+static void
+init_window_job(window_job_t *job,
+                char *buf,
+                apr_pool_t *pool)
+{
+  job->buf = buf;
+  job->window = NULL;
+  job->thread = NULL;
+  job->pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  apr_pool_cleanup_register(pool, job, cleanup_window_job,
+                            apr_pool_cleanup_null);
+}
+
+/* Begin computing the window described by JOB in a worker thread.  If
+   that is not possible, wait_window_job() will do it later. */
+static void
+start_window_job(window_job_t *job)
+{
+  if (apr_thread_create(&job->thread, NULL, window_worker, job, job->pool))
+    job->thread = NULL;
+}
+
+/* Make sure JOB->WINDOW has been computed. */
+static svn_error_t *
+wait_window_job(window_job_t *job)
+{
+  if (job->thread)
+    {
+      apr_status_t retval;
+      apr_status_t status = apr_thread_join(&retval, job->thread);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't join delta worker"));
+
+      job->thread = NULL;
+    }
+  else
+    {
+      job->window = compute_window(job->buf, job->source_len,
+                                   job->target_len, job->source_offset,
+                                   job->pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait for JOB, reset it and return a copy of its window, allocated in
+   RESULT_POOL, in *WINDOW. */
+static svn_error_t *
+finish_window_job(svn_txdelta_window_t **window,
+                  window_job_t *job,
+                  apr_pool_t *result_pool)
+{
+  SVN_ERR(wait_window_job(job));
+
+  *window = svn_txdelta_window_dup(job->window, result_pool);
+  job->window = NULL;
+  svn_pool_clear(job->pool);
+
+  return SVN_NO_ERROR;
+}
+#endif
+
 
 
 svn_txdelta_window_t *
@@ -353,43 +499,140 @@ svn_txdelta_md5_digest(svn_txdelta_stream_t *stream)
 
 
 
+/* Read the data for the next window of B into BUF and return the
+   amount of source and target data as well as the source offset in
+   *SOURCE_LEN, *TARGET_LEN and *SOURCE_OFFSET, respectively.  Once the
+   target is exhausted, *TARGET_LEN will be 0. */
 static svn_error_t *
-txdelta_next_window(svn_txdelta_window_t **window,
-                    void *baton,
-                    apr_pool_t *pool)
+read_window_data(struct txdelta_baton *b,
+                 char *buf,
+                 apr_size_t *source_len,
+                 apr_size_t *target_len,
+                 svn_filesize_t *source_offset)
 {
-  struct txdelta_baton *b = baton;
-  apr_size_t source_len = SVN_DELTA_WINDOW_SIZE;
-  apr_size_t target_len = SVN_DELTA_WINDOW_SIZE;
+  *source_len = SVN_DELTA_WINDOW_SIZE;
+  *target_len = SVN_DELTA_WINDOW_SIZE;
 
   /* Read the source stream. */
   if (b->more_source)
     {
-      SVN_ERR(svn_stream_read_full(b->source, b->buf, &source_len));
-      b->more_source = (source_len == SVN_DELTA_WINDOW_SIZE);
+      SVN_ERR(svn_stream_read_full(b->source, buf, source_len));
+      b->more_source = (*source_len == SVN_DELTA_WINDOW_SIZE);
     }
   else
-    source_len = 0;
+    *source_len = 0;
 
   /* Read the target stream. */
-  SVN_ERR(svn_stream_read_full(b->target, b->buf + source_len, &target_len));
-  b->pos += source_len;
+  SVN_ERR(svn_stream_read_full(b->target, buf + *source_len, target_len));
+  *source_offset = b->pos;
+  b->pos += *source_len;
 
-  if (target_len == 0)
+  if (*target_len == 0)
     {
-      /* No target data?  We're done; return the final window. */
+      /* No target data?  We're done. */
       if (b->context != NULL)
         SVN_ERR(svn_checksum_final(&b->checksum, b->context, b->result_pool));
+    }
+  else if (b->context != NULL)
+    SVN_ERR(svn_checksum_update(b->context, buf + *source_len, *target_len));
+
+  return SVN_NO_ERROR;
+}
 
+#if APR_HAS_THREADS
+/* Implement txdelta_next_window() for deltas spanning multiple windows.
+   Return the window of CURRENT, or of B->PENDING if CURRENT is NULL, in
+   *WINDOW and start computing the following window in the background. */
+static svn_error_t *
+pipelined_next_window(svn_txdelta_window_t **window,
+                      struct txdelta_baton *b,
+                      window_job_t *current,
+                      apr_pool_t *pool)
+{
+  window_job_t *next;
+
+  if (!current)
+    current = b->pending;
+
+  if (!current)
+    {
+      /* We're done; return the final window. */
       *window = NULL;
       b->more = FALSE;
       return SVN_NO_ERROR;
     }
-  else if (b->context != NULL)
-    SVN_ERR(svn_checksum_update(b->context, b->buf + source_len, target_len));
 
-  *window = compute_window(b->buf, source_len, target_len,
-                           b->pos - source_len, pool);
+  /* Read the data of the following window while CURRENT's window may
+     still be computed. */
+  next = (current == &b->jobs[0]) ? &b->jobs[1] : &b->jobs[0];
+  SVN_ERR(read_window_data(b, next->buf, &next->source_len,
+                           &next->target_len, &next->source_offset));
+
+  b->pending = NULL;
+  SVN_ERR(finish_window_job(window, current, pool));
+
+  /* Let the following window be computed while our caller is busy
+     processing this one. */
+  if (next->target_len)
+    {
+      start_window_job(next);
+      b->pending = next;
+    }
+
+  return SVN_NO_ERROR;
+}
+#endif
+
+static svn_error_t *
+txdelta_next_window(svn_txdelta_window_t **window,
+                    void *baton,
+                    apr_pool_t *pool)
+{
+  struct txdelta_baton *b = baton;
+  apr_size_t source_len;
+  apr_size_t target_len;
+  svn_filesize_t source_offset;
+
+#if APR_HAS_THREADS
+  if (b->jobs)
+    return svn_error_trace(pipelined_next_window(window, b, NULL, pool));
+#endif
+
+  SVN_ERR(read_window_data(b, b->buf, &source_len, &target_len,
+                           &source_offset));
+
+  if (target_len == 0)
+    {
+      /* No target data?  We're done; return the final window. */
+      *window = NULL;
+      b->more = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+#if APR_HAS_THREADS
+  /* A full window suggests that more data is to come.  Switch to
+     computing windows in the background then.  Without source data,
+     e.g. when importing or adding files, compute_window() merely copies
+     the target and a thread per window would only slow us down. */
+  if (target_len == SVN_DELTA_WINDOW_SIZE && source_len > 0)
+    {
+      b->jobs = apr_palloc(b->pool, 2 * sizeof(*b->jobs));
+      init_window_job(&b->jobs[0], b->buf, b->pool);
+      init_window_job(&b->jobs[1],
+                      apr_palloc(b->pool, 2 * SVN_DELTA_WINDOW_SIZE),
+                      b->pool);
+
+      b->jobs[0].source_len = source_len;
+      b->jobs[0].target_len = target_len;
+      b->jobs[0].source_offset = source_offset;
+
+      return svn_error_trace(pipelined_next_window(window, b, &b->jobs[0],
+                                                   pool));
+    }
+#endif
+
+  *window = compute_window(b->buf, source_len, target_len, source_offset,
+                           pool);
 
   /* That's it. */
   return SVN_NO_ERROR;
@@ -437,6 +680,7 @@ svn_txdelta_run(svn_stream_t *source,
   tb.pos = 0;
   tb.buf = apr_palloc(scratch_pool, 2 * SVN_DELTA_WINDOW_SIZE);
   tb.result_pool = result_pool;
+  tb.pool = scratch_pool;
 
   if (checksum != NULL)
     tb.context = svn_checksum_ctx_create(checksum_kind, scratch_pool);
@@ -484,6 +728,7 @@ svn_txdelta2(svn_txdelta_stream_t **stream,
              ? svn_checksum_ctx_create(svn_checksum_md5, pool)
              : NULL;
   b->result_pool = pool;
+  b->pool = pool;
 
   *stream = svn_txdelta_stream_create(b, txdelta_next_window,
                                       txdelta_md5_digest, pool);
@@ -502,6 +747,62 @@ svn_txdelta(svn_txdelta_stream_t **stream,
 
 /* Functions for implementing a "target push" delta. */
 
+#if APR_HAS_THREADS
+/* Send the window of TB->PENDING, if any, to TB's window handler. */
+static svn_error_t *
+tpush_send_pending(struct tpush_baton *tb)
+{
+  window_job_t *job = tb->pending;
+  svn_error_t *err;
+
+  if (!job)
+    return SVN_NO_ERROR;
+
+  tb->pending = NULL;
+  SVN_ERR(wait_window_job(job));
+
+  err = tb->wh(job->window, tb->whb);
+  job->window = NULL;
+  svn_pool_clear(job->pool);
+
+  return svn_error_trace(err);
+}
+
+/* Begin computing the window for the data in TB->BUF in the background,
+   send the previous window and continue with an empty buffer. */
+static svn_error_t *
+tpush_start_window(struct tpush_baton *tb)
+{
+  window_job_t *job;
+
+  if (!tb->jobs)
+    {
+      tb->jobs = apr_palloc(tb->pool, 2 * sizeof(*tb->jobs));
+      init_window_job(&tb->jobs[0], tb->buf, tb->pool);
+      init_window_job(&tb->jobs[1],
+                      apr_palloc(tb->pool, 2 * SVN_DELTA_WINDOW_SIZE),
+                      tb->pool);
+      tb->current = 0;
+    }
+
+  job = &tb->jobs[tb->current];
+  job->source_len = tb->source_len;
+  job->target_len = tb->target_len;
+  job->source_offset = tb->source_offset;
+  start_window_job(job);
+
+  /* The previous window gets written while this one is being computed.
+     Afterwards, its buffer can be reused. */
+  SVN_ERR(tpush_send_pending(tb));
+
+  tb->pending = job;
+  tb->current = 1 - tb->current;
+  tb->buf = tb->jobs[tb->current].buf;
+
+  return SVN_NO_ERROR;
+}
+#endif
+
 /* This is the write handler for a target-push delta stream.  It reads
  * source data, buffers target data, and fires off delta windows when
  * the target data buffer is full. */
@@ -511,7 +812,9 @@ tpush_write_handler(void *baton, const char *data, apr_size_t *len)
   struct tpush_baton *tb = baton;
   apr_size_t chunk_len, data_len = *len;
   apr_pool_t *pool = svn_pool_create(tb->pool);
+#if !APR_HAS_THREADS
   svn_txdelta_window_t *window;
+#endif
 
   while (data_len > 0)
     {
@@ -538,9 +841,13 @@ tpush_write_handler(void *baton, const char *data, apr_size_t *len)
       /* If we're full of target data, compute and fire off a window. */
       if (tb->target_len == SVN_DELTA_WINDOW_SIZE)
         {
+#if APR_HAS_THREADS
+          SVN_ERR(tpush_start_window(tb));
+#else
           window = compute_window(tb->buf, tb->source_len, tb->target_len,
                                   tb->source_offset, pool);
           SVN_ERR(tb->wh(window, tb->whb));
+#endif
           tb->source_offset += tb->source_len;
           tb->source_len = 0;
           tb->target_len = 0;
@@ -561,6 +868,11 @@ tpush_close_handler(void *baton)
   struct tpush_baton *tb = baton;
   svn_txdelta_window_t *window;
 
+#if APR_HAS_THREADS
+  /* Send the window still being computed, if any. */
+  SVN_ERR(tpush_send_pending(tb));
+#endif
+
   /* Send a final window if we have any residual target data. */
   if (tb->target_len > 0)
     {
@@ -593,6 +905,11 @@ svn_txdelta_target_push(svn_txdelta_window_handler_t handler,
   tb->source_len = 0;
   tb->source_done = FALSE;
   tb->target_len = 0;
+#if APR_HAS_THREADS
+  tb->jobs = NULL;
+  tb->current = 0;
+  tb->pending = NULL;
+#endif
 
   /* Create and return writable stream. */
   stream = svn_stream_create(tb, pool);
@@ -628,17 +945,28 @@ size_buffer(char **buf, apr_size_t *buf_size,
 static APR_INLINE char *
 patterning_copy(char *target, const char *source, apr_size_t len)
 {
+  apr_size_t overlap = target - source;
+
+  /* Repeating a single byte is the most common pattern by far. */
+  if (overlap == 1)
+    {
+      memset(target, *source, len);
+      return target + len;
+    }
+
   /* If the source and target overlap, repeat the overlapping pattern
-     in the target buffer. Always copy from the source buffer because
+     in the target buffer.  Everything from SOURCE up to TARGET is a
+     repetition of that pattern, so each copy may be twice as long as
+     the previous one.  Always copy from the source buffer because
      presumably it will be in the L1 cache after the first iteration
      and doing this should avoid pipeline stalls due to write/read
      dependencies. */
-  const apr_size_t overlap = target - source;
   while (len > overlap)
     {
       memcpy(target, source, overlap);
       target += overlap;
       len -= overlap;
+      overlap *= 2;
     }
 
   /* Copy any remaining source pattern. */
@@ -651,12 +979,58 @@ patterning_copy(char *target, const char *source, apr_size_t len)
   return target;
 }
 
+/* Execute the first LEN bytes of instruction OP of WINDOW, writing to
+ * TBUF at TPOS and reading from SBUF as needed.  */
+static APR_INLINE void
+apply_instruction(const svn_txdelta_window_t *window,
+                  const svn_txdelta_op_t *op,
+                  const char *sbuf, char *tbuf,
+                  apr_size_t tpos, apr_size_t len)
+{
+  /* Check some invariants common to all instructions.  */
+  assert(tpos + op->length <= window->tview_len);
+
+  switch (op->action_code)
+    {
+    case svn_txdelta_source:
+      /* Copy from source area.  */
+      assert(sbuf);
+      assert(op->offset + op->length <= window->sview_len);
+      memcpy(tbuf + tpos, sbuf + op->offset, len);
+      break;
+
+    case svn_txdelta_target:
+      /* Copy from target area.  We can't use memcpy() or the like
+       * since we need a specific semantics for overlapping copies:
+       * they must result in repeating patterns.
+       * Note that most copies won't have overlapping source and
+       * target ranges (they are just a result of self-compressed
+       * data) but a small percentage will.  */
+      assert(op->offset < tpos);
+      if (op->offset + len <= tpos)
+        memcpy(tbuf + tpos, tbuf + op->offset, len);
+      else
+        patterning_copy(tbuf + tpos, tbuf + op->offset, len);
+      break;
+
+    case svn_txdelta_new:
+      /* Copy from window new area.  */
+      assert(op->offset + op->length <= window->new_data->len);
+      memcpy(tbuf + tpos, window->new_data->data + op->offset, len);
+      break;
+
+    default:
+      assert(!"Invalid delta instruction code");
+    }
+}
+
 void
 svn_txdelta_apply_instructions(svn_txdelta_window_t *window,
                                const char *sbuf, char *tbuf,
                                apr_size_t *tlen)
 {
   const svn_txdelta_op_t *op;
+  const svn_txdelta_op_t *ops_end = window->ops + window->num_ops;
   apr_size_t tpos = 0;
 
   /* Nothing to do for empty buffers.
@@ -664,45 +1038,28 @@ svn_txdelta_apply_instructions(svn_txdelta_window_t *window,
   if (*tlen == 0)
     return;
 
-  for (op = window->ops; op < window->ops + window->num_ops; op++)
+  /* The usual case: the whole window fits, so no instruction needs to be
+   * truncated. */
+  if (*tlen >= window->tview_len)
     {
-      const apr_size_t buf_len = (op->length < *tlen - tpos
-                                  ? op->length : *tlen - tpos);
-
-      /* Check some invariants common to all instructions.  */
-      assert(tpos + op->length <= window->tview_len);
-
-      switch (op->action_code)
+      for (op = window->ops; op < ops_end; op++)
         {
-        case svn_txdelta_source:
-          /* Copy from source area.  */
-          assert(sbuf);
-          assert(op->offset + op->length <= window->sview_len);
-          memcpy(tbuf + tpos, sbuf + op->offset, buf_len);
-          break;
+          apply_instruction(window, op, sbuf, tbuf, tpos, op->length);
+          tpos += op->length;
+        }
 
-        case svn_txdelta_target:
-          /* Copy from target area.  We can't use memcpy() or the like
-           * since we need a specific semantics for overlapping copies:
-           * they must result in repeating patterns.
-           * Note that most copies won't have overlapping source and
-           * target ranges (they are just a result of self-compressed
-           * data) but a small percentage will.  */
-          assert(op->offset < tpos);
-          patterning_copy(tbuf + tpos, tbuf + op->offset, buf_len);
-          break;
+      /* Check that we produced the right amount of data.  */
+      assert(tpos == window->tview_len);
+      *tlen = tpos;
+      return;
+    }
 
-        case svn_txdelta_new:
-          /* Copy from window new area.  */
-          assert(op->offset + op->length <= window->new_data->len);
-          memcpy(tbuf + tpos,
-                 window->new_data->data + op->offset,
-                 buf_len);
-          break;
+  for (op = window->ops; op < ops_end; op++)
+    {
+      const apr_size_t buf_len = (op->length < *tlen - tpos
+                                  ? op->length : *tlen - tpos);
 
-        default:
-          assert(!"Invalid delta instruction code");
-        }
+      apply_instruction(window, op, sbuf, tbuf, tpos, buf_len);
 
       tpos += op->length;
       if (tpos >= *tlen)
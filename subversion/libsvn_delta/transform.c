@@ -0,0 +1,589 @@
+/*
+ * transform.c:  reversible pre-transforms for text deltas
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <string.h>
+
+#include <apr_strings.h>
+#include <zlib.h>
+
+#include "svn_delta.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+
+#include "private/svn_delta_private.h"
+#include "private/svn_string_private.h"
+#include "private/svn_subr_private.h"
+
+#include "svn_private_config.h"
+
+
+/* ==================================================================== */
+/* Zip archives */
+
+/* Zip based formats (office documents, jars, ...) deflate each member
+ * separately.  A small change to one member changes all of its deflated
+ * data, which leaves xdelta little to match.  So the transformed form
+ * of an archive contains the inflated data of each member instead.
+ *
+ * That only works if the deflated data can be reproduced exactly from
+ * the inflated data.  We check that by deflating it again with zlib at
+ * each compression level, which matches the output of most zip writers
+ * based on zlib.  Members that don't match are kept as they are.
+ *
+ * The transformed form starts with ZIP_MAGIC followed by records, each
+ * of them starting with a tag byte:
+ *
+ *   RAW_RECORD LEN DATA
+ *     LEN bytes of DATA that are copied verbatim.
+ *
+ *   DEFLATED_RECORD LEVEL DEFLATED-LEN DEFLATED-ADLER32 LEN DATA
+ *     LEN bytes of inflated DATA to be deflated again at LEVEL into
+ *     DEFLATED-LEN bytes with the adler32 checksum DEFLATED-ADLER32.
+ *
+ * All numbers are encoded with svn__encode_uint().
+ */
+#define ZIP_MAGIC "SVNzip\1"
+#define ZIP_MAGIC_LEN (sizeof(ZIP_MAGIC) - 1)
+
+#define RAW_RECORD 'R'
+#define DEFLATED_RECORD 'D'
+
+/* Layout of a zip local file header. */
+#define LOCAL_HEADER_SIGNATURE "PK\3\4"
+#define LOCAL_HEADER_SIZE 30
+#define LOCAL_HEADER_FLAGS 6
+#define LOCAL_HEADER_METHOD 8
+#define LOCAL_HEADER_COMPRESSED_SIZE 18
+#define LOCAL_HEADER_SIZE_OFFSET 22
+#define LOCAL_HEADER_NAME_LEN 26
+#define LOCAL_HEADER_EXTRA_LEN 28
+
+/* General purpose flag telling that the sizes follow the data. */
+#define FLAG_DATA_DESCRIPTOR 0x08
+
+/* Compression method "deflate". */
+#define METHOD_DEFLATE 8
+
+/* Don't inflate members larger than this, to keep the memory use of
+ * deltas bounded. */
+#define MAX_INFLATED_SIZE (64 * 1024 * 1024)
+
+/* Return the little-endian 16 bit number at P. */
+static apr_uint32_t
+get_le16(const unsigned char *p)
+{
+  return p[0] | ((apr_uint32_t)p[1] << 8);
+}
+
+/* Return the little-endian 32 bit number at P. */
+static apr_uint32_t
+get_le32(const unsigned char *p)
+{
+  return get_le16(p) | (get_le16(p + 2) << 16);
+}
+
+/* Append VALUE to BUF, encoded by svn__encode_uint(). */
+static void
+append_uint(svn_stringbuf_t *buf,
+            apr_uint64_t value)
+{
+  unsigned char bytes[SVN__MAX_ENCODED_UINT_LEN];
+  unsigned char *end = svn__encode_uint(bytes, value);
+
+  svn_stringbuf_appendbytes(buf, (const char *)bytes, end - bytes);
+}
+
+/* Append a raw record for the LEN bytes at DATA to BUF. */
+static void
+append_raw_record(svn_stringbuf_t *buf,
+                  const char *data,
+                  apr_size_t len)
+{
+  if (len == 0)
+    return;
+
+  svn_stringbuf_appendbyte(buf, RAW_RECORD);
+  append_uint(buf, len);
+  svn_stringbuf_appendbytes(buf, data, len);
+}
+
+/* Inflate the raw deflate stream of DEFLATED_LEN bytes at DEFLATED into
+ * the INFLATED_LEN bytes at INFLATED.  Return FALSE if the stream is
+ * invalid or doesn't have exactly that size. */
+static svn_boolean_t
+inflate_member(unsigned char *inflated,
+               apr_size_t inflated_len,
+               const unsigned char *deflated,
+               apr_size_t deflated_len)
+{
+  z_stream stream = { 0 };
+  unsigned char extra;
+  int zerr;
+
+  if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    return FALSE;
+
+  /* Give zlib room for one more byte, so it can tell us if the stream
+   * is longer than it should be. */
+  stream.next_in = (Bytef *)deflated;
+  stream.avail_in = (uInt)deflated_len;
+  stream.next_out = inflated_len ? inflated : &extra;
+  stream.avail_out = (uInt)inflated_len;
+
+  zerr = inflate(&stream, Z_FINISH);
+  if (zerr == Z_BUF_ERROR && stream.avail_out == 0)
+    {
+      stream.next_out = &extra;
+      stream.avail_out = 1;
+      zerr = inflate(&stream, Z_FINISH);
+    }
+
+  inflateEnd(&stream);
+
+  return zerr == Z_STREAM_END
+      && stream.total_out == inflated_len
+      && stream.avail_in == 0;
+}
+
+/* Deflate the LEN bytes at DATA as a raw deflate stream at LEVEL into
+ * BUFFER of BUFFER_SIZE bytes.  Return the length of the result or 0 if
+ * it doesn't fit. */
+static apr_size_t
+deflate_member(unsigned char *buffer,
+               apr_size_t buffer_size,
+               const unsigned char *data,
+               apr_size_t len,
+               int level)
+{
+  z_stream stream = { 0 };
+  int zerr;
+
+  if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+    return 0;
+
+  stream.next_in = (Bytef *)data;
+  stream.avail_in = (uInt)len;
+  stream.next_out = buffer;
+  stream.avail_out = (uInt)buffer_size;
+
+  zerr = deflate(&stream, Z_FINISH);
+  deflateEnd(&stream);
+
+  return zerr == Z_STREAM_END ? stream.total_out : 0;
+}
+
+/* If deflating the INFLATED_LEN bytes at INFLATED at some compression
+ * level reproduces the DEFLATED_LEN bytes at DEFLATED, return that level.
+ * Otherwise, return -1.  Use SCRATCH_POOL for temporaries. */
+static int
+find_deflate_level(const unsigned char *inflated,
+                   apr_size_t inflated_len,
+                   const unsigned char *deflated,
+                   apr_size_t deflated_len,
+                   apr_pool_t *scratch_pool)
+{
+  /* Most likely levels first; 6 is zlib's default. */
+  static const int levels[] = { 6, 9, 1, 2, 3, 4, 5, 7, 8 };
+  unsigned char *buffer = apr_palloc(scratch_pool, deflated_len + 1);
+  apr_size_t i;
+
+  for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++)
+    if (deflate_member(buffer, deflated_len + 1, inflated, inflated_len,
+                       levels[i]) == deflated_len
+        && memcmp(buffer, deflated, deflated_len) == 0)
+      return levels[i];
+
+  return -1;
+}
+
+/* Implements svn_txdelta__transform_t.encode for zip archives. */
+static svn_error_t *
+zip_encode(svn_stringbuf_t **encoded,
+           const svn_string_t *data,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  const unsigned char *start = (const unsigned char *)data->data;
+  apr_size_t pos = 0;
+  apr_size_t raw_start = 0;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  *encoded = svn_stringbuf_create_ensure(data->len + ZIP_MAGIC_LEN,
+                                         result_pool);
+  svn_stringbuf_appendbytes(*encoded, ZIP_MAGIC, ZIP_MAGIC_LEN);
+
+  /* Walk the local file headers from the start of the archive.  We stop
+   * at the central directory or at anything we don't understand. */
+  while (data->len - pos >= LOCAL_HEADER_SIZE
+         && memcmp(start + pos, LOCAL_HEADER_SIGNATURE, 4) == 0)
+    {
+      const unsigned char *header = start + pos;
+      apr_size_t data_start = pos + LOCAL_HEADER_SIZE
+                            + get_le16(header + LOCAL_HEADER_NAME_LEN)
+                            + get_le16(header + LOCAL_HEADER_EXTRA_LEN);
+      apr_size_t deflated_len = get_le32(header
+                                         + LOCAL_HEADER_COMPRESSED_SIZE);
+      apr_size_t inflated_len = get_le32(header + LOCAL_HEADER_SIZE_OFFSET);
+      unsigned char *inflated;
+      int level;
+
+      /* Without the sizes up front, we'd have to search for the end of
+       * the member. */
+      if (get_le16(header + LOCAL_HEADER_FLAGS) & FLAG_DATA_DESCRIPTOR)
+        break;
+
+      if (data_start > data->len || deflated_len > data->len - data_start)
+        break;
+
+      pos = data_start + deflated_len;
+      if (get_le16(header + LOCAL_HEADER_METHOD) != METHOD_DEFLATE
+          || inflated_len > MAX_INFLATED_SIZE)
+        continue;
+
+      svn_pool_clear(iterpool);
+      inflated = apr_palloc(iterpool, inflated_len + 1);
+      if (!inflate_member(inflated, inflated_len, start + data_start,
+                          deflated_len))
+        continue;
+
+      level = find_deflate_level(inflated, inflated_len, start + data_start,
+                                 deflated_len, iterpool);
+      if (level < 0)
+        continue;
+
+      append_raw_record(*encoded, data->data + raw_start,
+                        data_start - raw_start);
+      svn_stringbuf_appendbyte(*encoded, DEFLATED_RECORD);
+      append_uint(*encoded, level);
+      append_uint(*encoded, deflated_len);
+      append_uint(*encoded, adler32(adler32(0, NULL, 0),
+                                    start + data_start,
+                                    (uInt)deflated_len));
+      append_uint(*encoded, inflated_len);
+      svn_stringbuf_appendbytes(*encoded, (const char *)inflated,
+                                inflated_len);
+      raw_start = pos;
+    }
+
+  append_raw_record(*encoded, data->data + raw_start,
+                    data->len - raw_start);
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return an error about invalid transformed zip data. */
+static svn_error_t *
+invalid_zip_data(void)
+{
+  return svn_error_create(SVN_ERR_SVNDIFF_INVALID_COMPRESSED_DATA, NULL,
+                          _("Invalid transformed zip archive data"));
+}
+
+/* Set *VALUE to the number at *P, which must not reach END, and move *P
+ * behind it. */
+static svn_error_t *
+read_uint(apr_uint64_t *value,
+          const unsigned char **p,
+          const unsigned char *end)
+{
+  *p = svn__decode_uint(value, *p, end);
+  if (*p == NULL)
+    return invalid_zip_data();
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta__transform_t.decode for zip archives. */
+static svn_error_t *
+zip_decode(svn_stringbuf_t **decoded,
+           const svn_string_t *encoded,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  const unsigned char *p = (const unsigned char *)encoded->data;
+  const unsigned char *end = p + encoded->len;
+
+  if (encoded->len < ZIP_MAGIC_LEN
+      || memcmp(p, ZIP_MAGIC, ZIP_MAGIC_LEN) != 0)
+    return invalid_zip_data();
+
+  *decoded = svn_stringbuf_create_ensure(encoded->len, result_pool);
+  for (p += ZIP_MAGIC_LEN; p < end; )
+    {
+      apr_uint64_t level = 1;
+      apr_uint64_t deflated_len = 0;
+      apr_uint64_t checksum = 0;
+      apr_uint64_t len;
+      unsigned char tag = *p++;
+
+      if (tag == DEFLATED_RECORD)
+        {
+          SVN_ERR(read_uint(&level, &p, end));
+          SVN_ERR(read_uint(&deflated_len, &p, end));
+          SVN_ERR(read_uint(&checksum, &p, end));
+        }
+      else if (tag != RAW_RECORD)
+        return invalid_zip_data();
+
+      SVN_ERR(read_uint(&len, &p, end));
+      if (len > (apr_uint64_t)(end - p) || level < 1 || level > 9
+          || deflated_len > APR_SIZE_MAX - (*decoded)->len - 1)
+        return invalid_zip_data();
+
+      if (tag == RAW_RECORD)
+        {
+          svn_stringbuf_appendbytes(*decoded, (const char *)p, len);
+        }
+      else
+        {
+          unsigned char *buffer;
+          apr_size_t old_len = (*decoded)->len;
+
+          /* Deflate directly into *DECODED. */
+          svn_stringbuf_ensure(*decoded, old_len + deflated_len + 1);
+          buffer = (unsigned char *)(*decoded)->data + old_len;
+          if (deflate_member(buffer, deflated_len + 1, p, len,
+                             (int)level)
+                != deflated_len
+              || adler32(adler32(0, NULL, 0), buffer, (uInt)deflated_len)
+                   != checksum)
+            return svn_error_create(SVN_ERR_SVNDIFF_INVALID_COMPRESSED_DATA,
+                                    NULL,
+                                    _("Can't reproduce the compressed data "
+                                      "of a zip archive member"));
+
+          (*decoded)->len += deflated_len;
+          (*decoded)->data[(*decoded)->len] = '\0';
+        }
+
+      p += len;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_txdelta__transform_t zip_transform =
+{
+  "zip",
+  zip_encode,
+  zip_decode
+};
+
+/* MIME types of zip based formats.  Entries ending with '.' match all
+ * subtypes starting with them. */
+static const char * const zip_mime_types[] =
+{
+  "application/zip",
+  "application/x-zip-compressed",
+  "application/java-archive",
+  "application/x-java-archive",
+  "application/epub+zip",
+  "application/vnd.android.package-archive",
+  "application/vnd.openxmlformats-officedocument.",
+  "application/vnd.oasis.opendocument.",
+  NULL
+};
+
+
+/* ==================================================================== */
+/* Public interface */
+
+/* Return TRUE if MIME_TYPE matches one of the entries in TYPES. */
+static svn_boolean_t
+match_mime_type(const char *mime_type,
+                const char * const *types,
+                apr_pool_t *scratch_pool)
+{
+  const char *type;
+
+  /* Ignore parameters like "; charset=...". */
+  type = apr_pstrndup(scratch_pool, mime_type, strcspn(mime_type, "; \t"));
+  for (; *types; types++)
+    {
+      apr_size_t len = strlen(*types);
+
+      if ((*types)[len - 1] == '.'
+          ? strlen(type) > len
+            && svn_cstring_casecmp(apr_pstrndup(scratch_pool, type, len),
+                                   *types) == 0
+          : svn_cstring_casecmp(type, *types) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+const svn_txdelta__transform_t *
+svn_txdelta__transform_for_mime_type(const char *mime_type,
+                                     apr_pool_t *scratch_pool)
+{
+  if (mime_type && match_mime_type(mime_type, zip_mime_types, scratch_pool))
+    return &zip_transform;
+
+  return NULL;
+}
+
+/* Read all of STREAM and return its contents transformed by TRANSFORM
+ * in *DATA. */
+static svn_error_t *
+read_encoded(svn_stringbuf_t **data,
+             svn_stream_t *stream,
+             const svn_txdelta__transform_t *transform,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *contents;
+
+  SVN_ERR(svn_stringbuf_from_stream(&contents, stream, 0, scratch_pool));
+
+  return svn_error_trace(transform->encode(data,
+                                           svn_stringbuf__morph_into_string(
+                                             contents),
+                                           result_pool, scratch_pool));
+}
+
+svn_error_t *
+svn_txdelta__run_transformed(svn_stream_t *source,
+                             svn_stream_t *target,
+                             const svn_txdelta__transform_t *transform,
+                             svn_txdelta_window_handler_t handler,
+                             void *handler_baton,
+                             svn_checksum_kind_t checksum_kind,
+                             svn_checksum_t **checksum,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *encoded_source;
+  svn_stringbuf_t *encoded_target;
+
+  /* The checksum is over the real target, not over the transformed one.
+   * It gets calculated when closing the checksummed stream. */
+  if (checksum)
+    target = svn_stream_checksummed2(svn_stream_disown(target, scratch_pool),
+                                     checksum, NULL, checksum_kind, TRUE,
+                                     result_pool);
+
+  SVN_ERR(read_encoded(&encoded_source, source, transform, scratch_pool,
+                       scratch_pool));
+  SVN_ERR(read_encoded(&encoded_target, target, transform,
+                       scratch_pool, scratch_pool));
+  if (checksum)
+    SVN_ERR(svn_stream_close(target));
+
+  return svn_error_trace(
+           svn_txdelta_run(svn_stream_from_stringbuf(encoded_source,
+                                                     scratch_pool),
+                           svn_stream_from_stringbuf(encoded_target,
+                                                     scratch_pool),
+                           handler, handler_baton,
+                           checksum_kind, NULL,
+                           cancel_func, cancel_baton,
+                           result_pool, scratch_pool));
+}
+
+/* Baton for apply_transformed_window(). */
+typedef struct apply_transformed_baton_t
+{
+  /* Source and target of the untransformed delta. */
+  svn_stream_t *source;
+  svn_stream_t *target;
+
+  const svn_txdelta__transform_t *transform;
+
+  /* Receives the transformed target. */
+  svn_stringbuf_t *encoded_target;
+
+  /* Applies the windows to the transformed source, NULL before the first
+   * window. */
+  svn_txdelta_window_handler_t apply_handler;
+  void *apply_baton;
+
+  apr_pool_t *pool;
+} apply_transformed_baton_t;
+
+/* Implements svn_txdelta_window_handler_t for
+ * svn_txdelta__apply_transformed(). */
+static svn_error_t *
+apply_transformed_window(svn_txdelta_window_t *window,
+                         void *baton)
+{
+  apply_transformed_baton_t *b = baton;
+  svn_stringbuf_t *decoded;
+
+  /* The transformed source can only be produced all at once, so delay
+   * that until it is really needed. */
+  if (b->apply_handler == NULL)
+    {
+      svn_stringbuf_t *encoded_source;
+
+      SVN_ERR(read_encoded(&encoded_source, b->source, b->transform,
+                           b->pool, b->pool));
+      b->encoded_target = svn_stringbuf_create_empty(b->pool);
+      svn_txdelta_apply(svn_stream_from_stringbuf(encoded_source, b->pool),
+                        svn_stream_from_stringbuf(b->encoded_target,
+                                                  b->pool),
+                        NULL, NULL, b->pool,
+                        &b->apply_handler, &b->apply_baton);
+    }
+
+  SVN_ERR(b->apply_handler(window, b->apply_baton));
+  if (window)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(b->transform->decode(&decoded,
+                               svn_stringbuf__morph_into_string(
+                                 b->encoded_target),
+                               b->pool, b->pool));
+  SVN_ERR(svn_stream_write(b->target, decoded->data, &decoded->len));
+  SVN_ERR(svn_stream_close(b->target));
+
+  svn_pool_destroy(b->pool);
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_txdelta__apply_transformed(svn_stream_t *source,
+                               svn_stream_t *target,
+                               const svn_txdelta__transform_t *transform,
+                               apr_pool_t *pool,
+                               svn_txdelta_window_handler_t *handler,
+                               void **handler_baton)
+{
+  apr_pool_t *subpool = svn_pool_create(pool);
+  apply_transformed_baton_t *b = apr_pcalloc(subpool, sizeof(*b));
+
+  b->source = source;
+  b->target = target;
+  b->transform = transform;
+  b->pool = subpool;
+
+  *handler = apply_transformed_window;
+  *handler_baton = b;
+}
@@ -32,15 +32,10 @@
 #include "private/svn_string_private.h"
 #include "delta.h"
 
-/* This is pseudo-adler32. It is adler32 without the prime modulus.
-   The idea is borrowed from monotone, and is a translation of the C++
-   code.  Graydon Hoare, the author of the original code, gave his
-   explicit permission to use it under these terms at 8:02pm on
-   Friday, February 11th, 2005.  */
-
 /* Size of the blocks we compute checksums for. This was chosen out of
    thin air.  Monotone used 64, xdelta1 used 64, rsync uses 128.
-   However, later optimizations assume it to be 256 or less.
+   However, later optimizations assume it to be 256 or less.  The gear
+   hash below also requires it to be exactly 64.
  */
 #define MATCH_BLOCKSIZE 64
 
@@ -53,155 +48,325 @@
  */
 #define FLAGS_COUNT (32 * 1024)
 
+/* Number of slots per bucket in the blocks table.  A bucket fills exactly
+   one 64 byte cache line. */
+#define BUCKET_SIZE 8
+
+/* Required alignment of the bucket array. */
+#define BUCKET_ALIGNMENT 64
+
 /* "no" / "invalid" / "unused" value for positions within the delta windows
  */
 #define NO_POSITION ((apr_uint32_t)-1)
 
-/* Feed C_IN into the adler32 checksum and remove C_OUT at the same time.
- * This function may (and will) only be called for characters that are
- * MATCH_BLOCKSIZE positions apart.
- *
- * Please note that the lower 16 bits cannot overflow in neither direction.
- * Therefore, we don't need to split the value into separate values for
- * sum(char) and sum(sum(char)).
- */
-static APR_INLINE apr_uint32_t
-adler32_replace(apr_uint32_t adler32, const char c_out, const char c_in)
-{
-  adler32 -= (MATCH_BLOCKSIZE * 0x10000u * ((unsigned char) c_out));
-
-  adler32 -= (unsigned char)c_out;
-  adler32 += (unsigned char)c_in;
+/* Random values for the gear hash, one per byte value. */
+static const apr_uint64_t gear_table[256] = {
+  APR_UINT64_C(0x2e6409cf70d6d360), APR_UINT64_C(0x59074f595cc53d5e),
+  APR_UINT64_C(0x9669f2eaf14efad4), APR_UINT64_C(0xd1d223e48d9d8c0c),
+  APR_UINT64_C(0x4940d4aa39a3a999), APR_UINT64_C(0x56f8449e46db82a0),
+  APR_UINT64_C(0xe3155791a743ee59), APR_UINT64_C(0x3ebff46b4f4b9445),
+  APR_UINT64_C(0x4e1cdd733a0cb5cb), APR_UINT64_C(0xb53e974d4f822b01),
+  APR_UINT64_C(0x24ad5c06d168203a), APR_UINT64_C(0x0801afde7a0770be),
+  APR_UINT64_C(0x9fbcf429d3b83b50), APR_UINT64_C(0xc489736731c7a89b),
+  APR_UINT64_C(0xe5227f4de406e655), APR_UINT64_C(0x6c004cc47483a40b),
+  APR_UINT64_C(0x5e6aab90c9120c8f), APR_UINT64_C(0x312862cb9aee5a96),
+  APR_UINT64_C(0xac95f31783ab33d6), APR_UINT64_C(0x720fdb1d09bf944d),
+  APR_UINT64_C(0x6d6ef7ef875d77c3), APR_UINT64_C(0x36ac612e241ee63e),
+  APR_UINT64_C(0x6f31640db52c3f15), APR_UINT64_C(0xde01e87c52183d06),
+  APR_UINT64_C(0xa7e1d2c3452d2060), APR_UINT64_C(0x3664da8eebbb03a0),
+  APR_UINT64_C(0xb086ffebb30b2453), APR_UINT64_C(0x4ccb0d421ef4f7df),
+  APR_UINT64_C(0x96886ff1e2cb2bcf), APR_UINT64_C(0xc3a7875b3b8621b6),
+  APR_UINT64_C(0xf7a73a89cb7a87bf), APR_UINT64_C(0x1686bc17ff4ff776),
+  APR_UINT64_C(0x0c5028f53f77edd5), APR_UINT64_C(0x12976e9256a06dc3),
+  APR_UINT64_C(0xd95469e163a52db8), APR_UINT64_C(0x34ea2087d5564c86),
+  APR_UINT64_C(0x6fc9509b5e13c512), APR_UINT64_C(0x4fe6ea89a3287587),
+  APR_UINT64_C(0x7804a0920c201b0e), APR_UINT64_C(0x8fd2dfc12801779d),
+  APR_UINT64_C(0xec272f5ac2ce653a), APR_UINT64_C(0x72b032234d9ad15f),
+  APR_UINT64_C(0x501c3a8acdc1e152), APR_UINT64_C(0xe95dd2dc82d94e74),
+  APR_UINT64_C(0x03e112850cda83bd), APR_UINT64_C(0xf820f6eb7c02251e),
+  APR_UINT64_C(0xacf8682d964983ab), APR_UINT64_C(0xb492fd6549645f2e),
+  APR_UINT64_C(0xdd7e62504173e07f), APR_UINT64_C(0xa2b1effccea6f2ed),
+  APR_UINT64_C(0x5500cdbeaeac05df), APR_UINT64_C(0x7827c1bc7f9c6766),
+  APR_UINT64_C(0x55d524e69afd31c3), APR_UINT64_C(0xd10733f1ddc06328),
+  APR_UINT64_C(0xbf3bc698e59d22cc), APR_UINT64_C(0x6f74c950fe0a77bd),
+  APR_UINT64_C(0x7c312932a56096b2), APR_UINT64_C(0x17c27e1d6e549327),
+  APR_UINT64_C(0xe1b40e198c606d1d), APR_UINT64_C(0x9939d3f3c81ce72c),
+  APR_UINT64_C(0x09773d8c755f13ec), APR_UINT64_C(0x321ba88eac573bdc),
+  APR_UINT64_C(0xfc0fe1bf986fa7bf), APR_UINT64_C(0xd0baf7f73bb7ce7f),
+  APR_UINT64_C(0xef73ddef84d047ea), APR_UINT64_C(0xaa056ff82aafda58),
+  APR_UINT64_C(0x240a7be16294036f), APR_UINT64_C(0xde0f531692972b43),
+  APR_UINT64_C(0x83104167eab4c58f), APR_UINT64_C(0xbc6cf34da5c3f418),
+  APR_UINT64_C(0x2fb56bcb7068e877), APR_UINT64_C(0xfedd4e536da30092),
+  APR_UINT64_C(0x08ab33cb92e7982b), APR_UINT64_C(0xfee8e6739cec3b32),
+  APR_UINT64_C(0xfbfcb2e0bb4359ff), APR_UINT64_C(0x6a0d9142bdb644bc),
+  APR_UINT64_C(0x7b55d213acccfc80), APR_UINT64_C(0xe884212da0ca9688),
+  APR_UINT64_C(0x6fcdd43eabd2228d), APR_UINT64_C(0x0b7fc12262786d7b),
+  APR_UINT64_C(0xb424d096950cdf6c), APR_UINT64_C(0x2772cf8747b6cf31),
+  APR_UINT64_C(0xb2d2c55861f5a7f1), APR_UINT64_C(0x06828fe9ccb8ff8f),
+  APR_UINT64_C(0xf799eefa3a4ae224), APR_UINT64_C(0x400d4bac9d160fb6),
+  APR_UINT64_C(0x87cc61da09dc8396), APR_UINT64_C(0xbaa6f2366c0232ca),
+  APR_UINT64_C(0x5df4c087d9d2099a), APR_UINT64_C(0x68dfb430da8f177c),
+  APR_UINT64_C(0x7e68cfb1cf980946), APR_UINT64_C(0xcbefb44345b684b6),
+  APR_UINT64_C(0x9f68bf71751b3c28), APR_UINT64_C(0x6cf32dc33897ac12),
+  APR_UINT64_C(0x5e215c74d6be28f2), APR_UINT64_C(0xe18e53770fb34fdb),
+  APR_UINT64_C(0xc5db74ba0fc0a13f), APR_UINT64_C(0x53dffeac561de140),
+  APR_UINT64_C(0x2237751c4c0578de), APR_UINT64_C(0x1d4a9e2042710adb),
+  APR_UINT64_C(0x442999dc6e04296b), APR_UINT64_C(0x1eecf4279dd610ca),
+  APR_UINT64_C(0x3d0e2111458300db), APR_UINT64_C(0x14a642f39bf4be36),
+  APR_UINT64_C(0x47b0f9db35b8a04c), APR_UINT64_C(0xe93d0c1284a12558),
+  APR_UINT64_C(0x89ab8d7206e6137a), APR_UINT64_C(0xa5c651fa29beb478),
+  APR_UINT64_C(0x7815d98413c56c5d), APR_UINT64_C(0x91a1509454af4d8a),
+  APR_UINT64_C(0xb8bc1b95a5e9498a), APR_UINT64_C(0xd08084a0ddaf6057),
+  APR_UINT64_C(0xac236c53d9acbd54), APR_UINT64_C(0x18f9ec9c28bc9430),
+  APR_UINT64_C(0xff584c141b074e12), APR_UINT64_C(0xbba19110b40c2f23),
+  APR_UINT64_C(0x1afdf16034eb19f8), APR_UINT64_C(0xd82d12b3024b77c0),
+  APR_UINT64_C(0x7e7a72515f3d74d5), APR_UINT64_C(0x0d6e4ff19ba8b6fc),
+  APR_UINT64_C(0xde7c448787451e9d), APR_UINT64_C(0x4d8d913d4bfd4d03),
+  APR_UINT64_C(0x01b436195d9d8c00), APR_UINT64_C(0xd772189e8cae1de5),
+  APR_UINT64_C(0x1d93955b48ef0cff), APR_UINT64_C(0x195510eef736d6b9),
+  APR_UINT64_C(0x64a9ca1fd95d7d4f), APR_UINT64_C(0x06ba0d6df3379f77),
+  APR_UINT64_C(0xbc546f437531b8ac), APR_UINT64_C(0xe70c1b8e07d12571),
+  APR_UINT64_C(0x9daf093c0bf9470f), APR_UINT64_C(0x0f1fade19635c8ba),
+  APR_UINT64_C(0xf9feb52cb1227e5d), APR_UINT64_C(0x68997cc2dd000e82),
+  APR_UINT64_C(0xb61208838a8d6deb), APR_UINT64_C(0xe550ed3fd773b851),
+  APR_UINT64_C(0xc9c5c1a71588c4f8), APR_UINT64_C(0x7fbf9fa5ad6507c8),
+  APR_UINT64_C(0x5bbfb8238a9757d6), APR_UINT64_C(0x52736454eca5328a),
+  APR_UINT64_C(0xfd440287673be59f), APR_UINT64_C(0x1e34395e037e4b4e),
+  APR_UINT64_C(0xd8553aa2ef0cd496), APR_UINT64_C(0x34634ad5397f2018),
+  APR_UINT64_C(0x9db3d461725ef559), APR_UINT64_C(0x19b83bc3c9e15cb9),
+  APR_UINT64_C(0xa7195af25cb0e229), APR_UINT64_C(0x08795eb6a69a347b),
+  APR_UINT64_C(0x33c3b4a2f519765b), APR_UINT64_C(0x10df063d1e1dd696),
+  APR_UINT64_C(0xfaada64f0a296663), APR_UINT64_C(0xb6b315aaed2238ac),
+  APR_UINT64_C(0xde80436e1fdda48b), APR_UINT64_C(0x0bf466ffe160a6ff),
+  APR_UINT64_C(0x87ea4e225bb730d2), APR_UINT64_C(0x6f82085a503f26f6),
+  APR_UINT64_C(0xadd4832c4ebf38e1), APR_UINT64_C(0x8d4c0e5defc7a0a4),
+  APR_UINT64_C(0x9ffb48a11366f000), APR_UINT64_C(0x404fb90acd3f58f3),
+  APR_UINT64_C(0xaf14a8ec752c4357), APR_UINT64_C(0xa1f9e1178ee1b6c9),
+  APR_UINT64_C(0xc3c7750cf8695d6b), APR_UINT64_C(0x5f3def87500de435),
+  APR_UINT64_C(0x49740d0ee6ea6b27), APR_UINT64_C(0x7756765a724a5fb3),
+  APR_UINT64_C(0x4ee7ca8c66bc2088), APR_UINT64_C(0xea36f43588dbe4c1),
+  APR_UINT64_C(0xcd18bee4be7c006d), APR_UINT64_C(0x326f18ea8858559c),
+  APR_UINT64_C(0x22a4d93191dd44d8), APR_UINT64_C(0x832b8fc31007a81d),
+  APR_UINT64_C(0x6c3c86735f85702a), APR_UINT64_C(0x7c23994240738df1),
+  APR_UINT64_C(0x858f80f44bd3d5d6), APR_UINT64_C(0xbbdcd8aa21b1be3b),
+  APR_UINT64_C(0xea0a3a5000235c19), APR_UINT64_C(0x1d3275b85779ee8c),
+  APR_UINT64_C(0x3876b981835e3a9b), APR_UINT64_C(0x9770b8a93f46826f),
+  APR_UINT64_C(0x0821bff3d1d9182b), APR_UINT64_C(0x88dc82a2a0f15243),
+  APR_UINT64_C(0xb06ea0b950c0c2b7), APR_UINT64_C(0xf23548de87f79b2e),
+  APR_UINT64_C(0x561d0109012a1a10), APR_UINT64_C(0xb9bcefbd01c6cd2d),
+  APR_UINT64_C(0x8ede573d1772c34b), APR_UINT64_C(0xdfde26f77632cc19),
+  APR_UINT64_C(0x07991e023a8feadc), APR_UINT64_C(0x6587790eb008d25c),
+  APR_UINT64_C(0x44cd7ea0e7cf0bb1), APR_UINT64_C(0xc2433c9a23917eed),
+  APR_UINT64_C(0x31687debdf1c50bd), APR_UINT64_C(0x5db5e86b210250bb),
+  APR_UINT64_C(0xdb39b9d90938ab9d), APR_UINT64_C(0xb57f878e03970cd6),
+  APR_UINT64_C(0x71f251836ed46ac8), APR_UINT64_C(0x89ec7184d12a7915),
+  APR_UINT64_C(0x225508b95038a98c), APR_UINT64_C(0x59f73e13ac1755f4),
+  APR_UINT64_C(0x4140dc1a7959ec10), APR_UINT64_C(0x2d2742df212a474d),
+  APR_UINT64_C(0xa9c3a90e31a144c6), APR_UINT64_C(0x7c15eaf12382bfdd),
+  APR_UINT64_C(0x0664892d23d688bb), APR_UINT64_C(0xb98a5eb88656a35a),
+  APR_UINT64_C(0x520e2b2636e27535), APR_UINT64_C(0xc07ff7bd75620fb3),
+  APR_UINT64_C(0x682dd21de4243501), APR_UINT64_C(0x4d4392e27d5cf278),
+  APR_UINT64_C(0x534765fe5fd9ebf6), APR_UINT64_C(0x7c3a7cfa488c3034),
+  APR_UINT64_C(0xeb1378065c9a03f1), APR_UINT64_C(0x4d5237a799caccec),
+  APR_UINT64_C(0x69fce4131fcb5412), APR_UINT64_C(0x51e5838b4c6148b9),
+  APR_UINT64_C(0x2977ede09d00c058), APR_UINT64_C(0x9488cb89dd24d48d),
+  APR_UINT64_C(0x5ebad0b211be062a), APR_UINT64_C(0x4db6325af9c1a1db),
+  APR_UINT64_C(0x813b30d3019fce78), APR_UINT64_C(0x13446da2e7ea4430),
+  APR_UINT64_C(0xb724f7c8d50b14d4), APR_UINT64_C(0x109b00244d7f14a4),
+  APR_UINT64_C(0x5d13b04d51b5120f), APR_UINT64_C(0x9384c8535bfa39bc),
+  APR_UINT64_C(0x62c56148a9417cb0), APR_UINT64_C(0x9de9f18eb81a341f),
+  APR_UINT64_C(0x81614c41eff82e09), APR_UINT64_C(0x15e9e5d43956b4c3),
+  APR_UINT64_C(0xaec2afb7f076c8c6), APR_UINT64_C(0x8f19ef8d3639c36a),
+  APR_UINT64_C(0x63c08e326c7e467f), APR_UINT64_C(0x3eefad0a170a3433),
+  APR_UINT64_C(0x05fc8dee57ec6044), APR_UINT64_C(0x06a08a0908908071),
+  APR_UINT64_C(0x1f2e22b460b0aa3e), APR_UINT64_C(0x7033582ad5ce79fa),
+  APR_UINT64_C(0x126da8c6c22a795a), APR_UINT64_C(0x9a5f3a73176225ca),
+  APR_UINT64_C(0x7f621378da892150), APR_UINT64_C(0x8f342cc4684ce300),
+  APR_UINT64_C(0xf43c988d58f775af), APR_UINT64_C(0xb07dc8340a8786e9),
+  APR_UINT64_C(0x8cd89c4818836b18), APR_UINT64_C(0x3e20c09a09e23f84),
+  APR_UINT64_C(0xaaed84018bcca19b), APR_UINT64_C(0x3dafb52d5caededa),
+  APR_UINT64_C(0x568f7bf21815e2d2), APR_UINT64_C(0xaaac235fa2d1a6bb),
+  APR_UINT64_C(0xd514ef7b35eef48c), APR_UINT64_C(0x80ad40e32064ddab),
+  APR_UINT64_C(0x967fe4f3bc302454), APR_UINT64_C(0x24269af6f212f8ab),
+  APR_UINT64_C(0xcf145efc605ea149), APR_UINT64_C(0x9d84b4d692b2025d)
+};
 
-  return adler32 + adler32 * 0x10000;
+/* We use a "gear" rolling hash: Feeding the next byte C shifts the hash
+   value by one bit and adds a random value for C.  Because the hash is
+   64 bits wide, any byte fed MATCH_BLOCKSIZE or more steps earlier has
+   been shifted out completely.  Hence, there is no need to explicitly
+   remove the byte leaving the window and rolling costs a shift, an add
+   and a table lookup.
+
+   Note that the bit at position N only depends on the last N+1 bytes.
+   Therefore, we must only ever use the upper bits of the hash value. */
+static APR_INLINE apr_uint64_t
+gear_roll(apr_uint64_t hash, const char c_in)
+{
+  return (hash << 1) + gear_table[(unsigned char)c_in];
 }
 
-/* Calculate an pseudo-adler32 checksum for MATCH_BLOCKSIZE bytes starting
-   at DATA.  Return the checksum value.  */
-
-static APR_INLINE apr_uint32_t
-init_adler32(const char *data)
+/* Calculate the gear hash for MATCH_BLOCKSIZE bytes starting at DATA.
+   Return the hash value.  */
+static APR_INLINE apr_uint64_t
+init_gear(const char *data)
 {
-  const unsigned char *input = (const unsigned char *)data;
-  const unsigned char *last = input + MATCH_BLOCKSIZE;
-
-  apr_uint32_t s1 = 0;
-  apr_uint32_t s2 = 0;
+  const char *last = data + MATCH_BLOCKSIZE;
+  apr_uint64_t hash = 0;
 
-  for (; input < last; input += 8)
+  for (; data < last; data += 4)
     {
-      s1 += input[0]; s2 += s1;
-      s1 += input[1]; s2 += s1;
-      s1 += input[2]; s2 += s1;
-      s1 += input[3]; s2 += s1;
-      s1 += input[4]; s2 += s1;
-      s1 += input[5]; s2 += s1;
-      s1 += input[6]; s2 += s1;
-      s1 += input[7]; s2 += s1;
+      hash = gear_roll(hash, data[0]);
+      hash = gear_roll(hash, data[1]);
+      hash = gear_roll(hash, data[2]);
+      hash = gear_roll(hash, data[3]);
     }
 
-  return s2 * 0x10000 + s1;
+  return hash;
 }
 
-/* Information for a block of the delta source.  The length of the
-   block is the smaller of MATCH_BLOCKSIZE and the difference between
-   the size of the source data and the position of this block. */
-struct block
+/* A group of BUCKET_SIZE slots in the blocks table, filling a full cache
+   line.  Each slot describes a block of the delta source.  The length of
+   the block is the smaller of MATCH_BLOCKSIZE and the difference between
+   the size of the source data and the position of this block.
+
+   Slots get filled from the front, i.e. the first slot with a POS of
+   NO_POSITION ends the list of used slots in this bucket.  If the bucket
+   is full, entries overflow into the next bucket. */
+typedef struct bucket_t
 {
-  apr_uint32_t adlersum;
+  /* Upper 32 bits of the gear hash of the block contents. */
+  apr_uint32_t hashes[BUCKET_SIZE];
 
 /* Even in 64 bit systems, store only 32 bit offsets in our hash table
    (our delta window size much much smaller than 4GB).
-   That reduces the hash table size by 50% from 32to 16KB
-   and makes it easier to fit into the CPU's L1 cache. */
-  apr_uint32_t pos;    /* NO_POSITION -> block is not used */
-};
+   That reduces the hash table size by 50% and makes it easier to fit
+   into the CPU's L1 cache. */
+  apr_uint32_t positions[BUCKET_SIZE];  /* NO_POSITION -> slot is unused */
+} bucket_t;
 
-/* A hash table, using open addressing, of the blocks of the source. */
+/* A hash table, using open addressing with cache line sized buckets, of
+   the blocks of the source. */
 struct blocks
 {
-  /* The largest valid index of slots.
+  /* The largest valid index of BUCKETS.
      This value has an upper bound proportionate to the text delta
      window size, so unless we dramatically increase the window size,
-     it's safe to make this a 32-bit value.  In any case, it has to be
-     the same width as the block position index, (struct
-     block).pos. */
+     it's safe to make this a 32-bit value. */
   apr_uint32_t max;
 
-  /* Source buffer that the positions in SLOTS refer to. */
+  /* Number of bits to shift a gear hash to the right to get the
+     bucket index. */
+  int shift;
+
+  /* Source buffer that the positions in BUCKETS refer to. */
   const char* data;
 
   /* Bit array indicating whether there may be a matching slot for a given
-     adler32 checksum.  Since FLAGS has much more entries than SLOTS, this
-     will indicate most cases of non-matching checksums with a "0" bit, i.e.
-     as "known not to have a match".
-     The mapping of adler32 checksum bits is [0..2][16..27] (LSB -> MSB),
-     i.e. address the byte by the multiplicative part of adler32 and address
-     the bits in that byte by the additive part of adler32. */
+     gear hash.  Since FLAGS has much more entries than there are slots,
+     this will indicate most cases of non-matching checksums with a "0" bit,
+     i.e. as "known not to have a match".
+     We use hash bits [32..46] for that, i.e. a range that does not
+     overlap with the bucket index. */
   char flags[FLAGS_COUNT / 8];
 
-  /* The vector of blocks.  A pos value of NO_POSITION represents an unused
-     slot. */
-  struct block *slots;
+  /* The vector of buckets, aligned to BUCKET_ALIGNMENT. */
+  bucket_t *buckets;
 };
 
 
-/* Return a hash value calculated from the adler32 SUM, suitable for use with
-   our hash table. */
-static apr_uint32_t hash_func(apr_uint32_t sum)
+/* Return the index into BLOCKS->BUCKETS of the first bucket to check for
+   the gear HASH. */
+static APR_INLINE apr_uint32_t
+hash_bucket(const struct blocks *blocks, apr_uint64_t hash)
 {
-  /* Since the adl32 checksum have a bad distribution for the 11th to 16th
-     bits when used for our small block size, we add some bits from the
-     other half of the checksum. */
-  return sum ^ (sum >> 12);
+  return (apr_uint32_t)(hash >> blocks->shift) & blocks->max;
 }
 
-/* Return the offset in BLOCKS.FLAGS for the adler32 SUM. */
-static apr_uint32_t hash_flags(apr_uint32_t sum)
+/* Return the value to store in the bucket slots for the gear HASH. */
+static APR_INLINE apr_uint32_t
+hash_tag(apr_uint64_t hash)
+{
+  return (apr_uint32_t)(hash >> 32);
+}
+
+/* Return the bit index in BLOCKS.FLAGS for the gear HASH. */
+static APR_INLINE apr_uint32_t
+hash_flags(apr_uint64_t hash)
 {
-  /* The upper half of SUM has a wider value range than the lower 16 bit.
-     Also, we want to a different folding than HASH_FUNC to minimize
-     correlation between different hash levels. */
-  return (sum >> 16) & ((FLAGS_COUNT / 8) - 1);
+  return (apr_uint32_t)(hash >> 32) & (FLAGS_COUNT - 1);
 }
 
-/* Insert a block with the checksum ADLERSUM at position POS in the source
+/* Return whether BLOCKS.FLAGS says there may be a block for the gear
+   HASH. */
+static APR_INLINE svn_boolean_t
+may_have_block(const struct blocks *blocks, apr_uint64_t hash)
+{
+  apr_uint32_t bit = hash_flags(hash);
+  return (blocks->flags[bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+/* Insert a block with the gear HASH at position POS in the source
    data into the table BLOCKS.  Ignore true duplicates, i.e. blocks with
    actually the same content. */
 static void
-add_block(struct blocks *blocks, apr_uint32_t adlersum, apr_uint32_t pos)
+add_block(struct blocks *blocks, apr_uint64_t hash, apr_uint32_t pos)
 {
-  apr_uint32_t h = hash_func(adlersum) & blocks->max;
+  apr_uint32_t h = hash_bucket(blocks, hash);
+  apr_uint32_t tag = hash_tag(hash);
+  apr_uint32_t bit = hash_flags(hash);
 
   /* This will terminate, since we know that we will not fill the table. */
-  for (; blocks->slots[h].pos != NO_POSITION; h = (h + 1) & blocks->max)
-    if (blocks->slots[h].adlersum == adlersum)
-      if (memcmp(blocks->data + blocks->slots[h].pos, blocks->data + pos,
-                 MATCH_BLOCKSIZE) == 0)
-        return;
-
-  blocks->slots[h].adlersum = adlersum;
-  blocks->slots[h].pos = pos;
-  blocks->flags[hash_flags(adlersum)] |= 1 << (adlersum & 7);
+  for (; ; h = (h + 1) & blocks->max)
+    {
+      bucket_t *bucket = &blocks->buckets[h];
+      int i;
+
+      for (i = 0; i < BUCKET_SIZE; ++i)
+        {
+          if (bucket->positions[i] == NO_POSITION)
+            {
+              bucket->hashes[i] = tag;
+              bucket->positions[i] = pos;
+              blocks->flags[bit / 8] |= 1 << (bit % 8);
+              return;
+            }
+
+          if (bucket->hashes[i] == tag
+              && memcmp(blocks->data + bucket->positions[i],
+                        blocks->data + pos, MATCH_BLOCKSIZE) == 0)
+            return;
+        }
+    }
 }
 
-/* Find a block in BLOCKS with the checksum ADLERSUM and matching the content
+/* Find a block in BLOCKS with the gear HASH and matching the content
    at DATA, returning its position in the source data.  If there is no such
    block, return NO_POSITION. */
 static apr_uint32_t
 find_block(const struct blocks *blocks,
-           apr_uint32_t adlersum,
+           apr_uint64_t hash,
            const char* data)
 {
-  apr_uint32_t h = hash_func(adlersum) & blocks->max;
+  apr_uint32_t h = hash_bucket(blocks, hash);
+  apr_uint32_t tag = hash_tag(hash);
 
-  for (; blocks->slots[h].pos != NO_POSITION; h = (h + 1) & blocks->max)
-    if (blocks->slots[h].adlersum == adlersum)
-      if (memcmp(blocks->data + blocks->slots[h].pos, data,
-                 MATCH_BLOCKSIZE) == 0)
-        return blocks->slots[h].pos;
+  for (; ; h = (h + 1) & blocks->max)
+    {
+      const bucket_t *bucket = &blocks->buckets[h];
+      int i;
+
+      for (i = 0; i < BUCKET_SIZE; ++i)
+        {
+          if (bucket->positions[i] == NO_POSITION)
+            return NO_POSITION;
 
-  return NO_POSITION;
+          if (bucket->hashes[i] == tag
+              && memcmp(blocks->data + bucket->positions[i], data,
+                        MATCH_BLOCKSIZE) == 0)
+            return bucket->positions[i];
+        }
+    }
 }
 
 /* Initialize the matches table from DATA of size DATALEN.  This goes
@@ -214,47 +379,61 @@ init_blocks_table(const char *data,
                   apr_pool_t *pool)
 {
   apr_size_t nblocks;
-  apr_size_t wnslots = 1;
-  apr_uint32_t nslots;
+  apr_size_t wnbuckets = 1;
+  apr_uint32_t nbuckets;
   apr_uint32_t i;
+  int bits = 0;
+  char *memory;
 
   /* Be pessimistic about the block count. */
   nblocks = datalen / MATCH_BLOCKSIZE + 1;
-  /* Find nearest larger power of two. */
-  while (wnslots <= nblocks)
-    wnslots *= 2;
-  /* Double the number of slots to avoid a too high load. */
-  wnslots *= 2;
-  /* Narrow the number of slots to 32 bits, which is the size of the
+  /* Find nearest larger power of two for the number of buckets such that
+     the table is at most half full. */
+  while (wnbuckets * BUCKET_SIZE <= 2 * nblocks)
+    {
+      wnbuckets *= 2;
+      ++bits;
+    }
+  /* Narrow the number of buckets to 32 bits, which is the size of the
      block position index in the hash table.
      Sanity check: On 64-bit platforms, apr_size_t is likely to be
-     larger than apr_uint32_t. Make sure that the number of slots
-     actually fits into blocks->max.  It's safe to use a hard assert
-     here, because the largest possible value for nslots is
+     larger than apr_uint32_t.  It's safe to use a hard assert
+     here, because the largest possible value for nbuckets is
      proportional to the text delta window size and is therefore much
      smaller than the range of an apr_uint32_t.  If we ever happen to
      increase the window size too much, this assertion will get
      triggered by the test suite. */
-  nslots = (apr_uint32_t) wnslots;
-  SVN_ERR_ASSERT_NO_RETURN(wnslots == nslots);
-  blocks->max = nslots - 1;
+  nbuckets = (apr_uint32_t) wnbuckets;
+  SVN_ERR_ASSERT_NO_RETURN(wnbuckets == nbuckets);
+  blocks->max = nbuckets - 1;
+  blocks->shift = 64 - (bits ? bits : 1);
   blocks->data = data;
-  blocks->slots = apr_palloc(pool, nslots * sizeof(*(blocks->slots)));
-  for (i = 0; i < nslots; ++i)
+
+  /* Align the buckets to cache lines such that every lookup touches as
+     few of them as possible. */
+  memory = apr_palloc(pool, nbuckets * sizeof(bucket_t)
+                            + BUCKET_ALIGNMENT - 1);
+  blocks->buckets = (bucket_t *)APR_ALIGN((apr_uintptr_t)memory,
+                                          BUCKET_ALIGNMENT);
+  for (i = 0; i < nbuckets; ++i)
     {
-      /* Avoid using an indeterminate value in the lookup. */
-      blocks->slots[i].adlersum = 0;
-      blocks->slots[i].pos = NO_POSITION;
+      int k;
+      for (k = 0; k < BUCKET_SIZE; ++k)
+        {
+          /* Avoid using an indeterminate value in the lookup. */
+          blocks->buckets[i].hashes[k] = 0;
+          blocks->buckets[i].positions[k] = NO_POSITION;
+        }
     }
 
-  /* No checksum entries in SLOTS, yet => reset all checksum flags. */
+  /* No checksum entries in BUCKETS, yet => reset all checksum flags. */
   memset(blocks->flags, 0, sizeof(blocks->flags));
 
   /* If there is an odd block at the end of the buffer, we will
      not use that shorter block for deltification (only indirectly
      as an extension of some previous block). */
   for (i = 0; i + MATCH_BLOCKSIZE <= datalen; i += MATCH_BLOCKSIZE)
-    add_block(blocks, init_adler32(data + i), i);
+    add_block(blocks, init_gear(data + i), i);
 }
 
 /* Try to find a match for the target data B in BLOCKS, and then
@@ -268,7 +447,7 @@ init_blocks_table(const char *data,
  */
 static apr_size_t
 find_match(const struct blocks *blocks,
-           const apr_uint32_t rolling,
+           const apr_uint64_t rolling,
            const char *a,
            apr_size_t asize,
            const char *b,
@@ -348,7 +527,7 @@ store_delta_trailer(svn_txdelta__ops_baton_t *build_baton,
    The basic xdelta algorithm is as follows:
 
    1. Go through the source data, checksumming every MATCH_BLOCKSIZE
-      block of bytes using adler32, and inserting the checksum into a
+      block of bytes using a gear hash, and inserting the checksum into a
       match table with the position of the match.
    2. Go through the target byte by byte, seeing if that byte starts a
       match that we have in the match table.
@@ -376,7 +555,7 @@ compute_delta(svn_txdelta__ops_baton_t *build_baton,
               apr_pool_t *pool)
 {
   struct blocks blocks;
-  apr_uint32_t rolling;
+  apr_uint64_t rolling;
   apr_size_t lo = 0, pending_insert_start = 0, upper;
 
   /* Optimization: directly compare window starts. If more than 4
@@ -406,7 +585,7 @@ compute_delta(svn_txdelta__ops_baton_t *build_baton,
   init_blocks_table(a, asize, &blocks, pool);
 
   /* Initialize our rolling checksum.  */
-  rolling = init_adler32(b + lo);
+  rolling = init_gear(b + lo);
   while (lo < upper)
     {
       apr_size_t matchlen;
@@ -414,10 +593,9 @@ compute_delta(svn_txdelta__ops_baton_t *build_baton,
 
       /* Quickly skip positions whose respective ROLLING checksums
          definitely do not match any SLOT in BLOCKS. */
-      while (!(blocks.flags[hash_flags(rolling)] & (1 << (rolling & 7)))
-             && lo < upper)
+      while (!may_have_block(&blocks, rolling) && lo < upper)
         {
-          rolling = adler32_replace(rolling, b[lo], b[lo+MATCH_BLOCKSIZE]);
+          rolling = gear_roll(rolling, b[lo+MATCH_BLOCKSIZE]);
           lo++;
         }
 
@@ -434,7 +612,7 @@ compute_delta(svn_txdelta__ops_baton_t *build_baton,
           /* move block one position forward. Short blocks at the end of
              the buffer cannot be used as the beginning of a new match */
           if (lo + MATCH_BLOCKSIZE < bsize)
-            rolling = adler32_replace(rolling, b[lo], b[lo+MATCH_BLOCKSIZE]);
+            rolling = gear_roll(rolling, b[lo+MATCH_BLOCKSIZE]);
 
           lo++;
         }
@@ -471,7 +649,7 @@ compute_delta(svn_txdelta__ops_baton_t *build_baton,
            * Ignore short buffers at the end of B.
            */
           if (lo + MATCH_BLOCKSIZE <= bsize)
-            rolling = init_adler32(b + lo);
+            rolling = init_gear(b + lo);
         }
     }
 
@@ -126,10 +126,11 @@ svn_diff__diff(svn_diff__lcs_t *lcs,
 
 
 svn_error_t *
-svn_diff_diff_2(svn_diff_t **diff,
-                void *diff_baton,
-                const svn_diff_fns2_t *vtable,
-                apr_pool_t *pool)
+svn_diff__diff_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 svn_diff_file_algorithm_t algorithm,
+                 apr_pool_t *pool)
 {
   svn_diff__tree_t *tree;
   svn_diff__position_t *position_list[2];
@@ -187,7 +188,7 @@ svn_diff_diff_2(svn_diff_t **diff,
   /* Get the lcs */
   lcs = svn_diff__lcs(position_list[0], position_list[1], token_counts[0],
                       token_counts[1], num_tokens, prefix_lines,
-                      suffix_lines, subpool);
+                      suffix_lines, algorithm, subpool);
 
   /* Produce the diff */
   *diff = svn_diff__diff(lcs, 1, 1, TRUE, pool);
@@ -197,3 +198,437 @@ svn_diff_diff_2(svn_diff_t **diff,
 
   return SVN_NO_ERROR;
 }
+
+/* The state of one datasource during svn_diff__diff_2_windowed(). */
+typedef struct window_source_t
+{
+  svn_diff_datasource_e datasource;
+
+  /* The tail of the ring of positions in the current window, or NULL. */
+  svn_diff__position_t *positions;
+
+  /* The number of items in POSITIONS. */
+  apr_off_t count;
+
+  /* The line number of the first line not covered by the diff yet. */
+  apr_off_t start;
+
+  /* The line number of the last token read. */
+  apr_off_t offset;
+
+  /* Whether all tokens have been read. */
+  svn_boolean_t eof;
+} window_source_t;
+
+/* Append a position for TOKEN_INDEX at line OFFSET to the window of
+ * SOURCE.  Allocate it in POOL. */
+static void
+append_position(window_source_t *source,
+                svn_diff__token_index_t token_index,
+                apr_off_t offset,
+                apr_pool_t *pool)
+{
+  svn_diff__position_t *position = apr_palloc(pool, sizeof(*position));
+
+  position->token_index = token_index;
+  position->offset = offset;
+
+  if (source->positions)
+    {
+      position->next = source->positions->next;
+      source->positions->next = position;
+    }
+  else
+    {
+      position->next = position;
+    }
+
+  source->positions = position;
+  source->count++;
+}
+
+/* Rebuild the windows of SOURCES in NEW_TREE, keeping only the positions
+ * from the respective START line on.  OLD_TREE is the tree the current
+ * windows refer to, or NULL if there are none yet.  Discard all tokens of
+ * OLD_TREE that are no longer needed.  Allocate the new positions in
+ * RESULT_POOL and temporaries in SCRATCH_POOL. */
+static svn_error_t *
+carry_over_window(window_source_t sources[2],
+                  svn_diff__tree_t *new_tree,
+                  svn_diff__tree_t *old_tree,
+                  void *diff_baton,
+                  const svn_diff_fns2_t *vtable,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  svn_diff__token_index_t num_tokens;
+  svn_diff__token_index_t *token_map;
+  svn_diff__token_index_t token_index;
+  void **tokens;
+  apr_uint32_t *hashes;
+  int i;
+
+  if (old_tree == NULL)
+    return SVN_NO_ERROR;
+
+  num_tokens = svn_diff__get_node_count(old_tree);
+  svn_diff__tree_get_tokens(&tokens, &hashes, old_tree, scratch_pool);
+  token_map = apr_palloc(scratch_pool, (num_tokens + 1) * sizeof(*token_map));
+  for (token_index = 0; token_index < num_tokens; token_index++)
+    token_map[token_index] = -1;
+
+  for (i = 0; i < 2; i++)
+    {
+      svn_diff__position_t *first;
+      svn_diff__position_t *position;
+
+      if (sources[i].positions == NULL)
+        continue;
+
+      first = sources[i].positions->next;
+      sources[i].positions = NULL;
+      sources[i].count = 0;
+
+      position = first;
+      do
+        {
+          if (position->offset >= sources[i].start)
+            {
+              token_index = position->token_index;
+
+              /* All tokens of OLD_TREE differ, so inserting them won't
+               * discard anything. */
+              if (token_map[token_index] < 0)
+                {
+                  SVN_ERR(svn_diff__tree_insert_token(&token_map[token_index],
+                                                      new_tree,
+                                                      diff_baton, vtable,
+                                                      hashes[token_index],
+                                                      tokens[token_index]));
+                  tokens[token_index] = NULL;
+                }
+
+              append_position(&sources[i], token_map[token_index],
+                              position->offset, result_pool);
+            }
+
+          position = position->next;
+        }
+      while (position != first);
+    }
+
+  if (vtable->token_discard != NULL)
+    for (token_index = 0; token_index < num_tokens; token_index++)
+      if (tokens[token_index])
+        vtable->token_discard(diff_baton, tokens[token_index]);
+
+  return SVN_NO_ERROR;
+}
+
+/* Read tokens into the window of SOURCE until it holds WINDOW_LINES
+ * positions or the end of the datasource has been reached.  Allocate the
+ * positions in POOL. */
+static svn_error_t *
+fill_window(window_source_t *source,
+            svn_diff__tree_t *tree,
+            void *diff_baton,
+            const svn_diff_fns2_t *vtable,
+            apr_off_t window_lines,
+            apr_pool_t *pool)
+{
+  while (!source->eof && source->count < window_lines)
+    {
+      svn_diff__token_index_t token_index;
+      apr_uint32_t hash = 0;
+      void *token;
+
+      SVN_ERR(vtable->datasource_get_next_token(&hash, &token, diff_baton,
+                                                source->datasource));
+      if (token == NULL)
+        {
+          source->eof = TRUE;
+          SVN_ERR(vtable->datasource_close(diff_baton, source->datasource));
+          break;
+        }
+
+      SVN_ERR(svn_diff__tree_insert_token(&token_index, tree, diff_baton,
+                                          vtable, hash, token));
+      append_position(source, token_index, ++source->offset, pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Append the chain of hunks DIFF to the chain ending in *LAST, or to
+ * *HEAD if *LAST is NULL, merging adjacent hunks of the same type.  Set
+ * *LAST to the new end of the chain. */
+static void
+append_hunks(svn_diff_t **head,
+             svn_diff_t **last,
+             svn_diff_t *diff)
+{
+  while (diff)
+    {
+      svn_diff_t *next = diff->next;
+
+      if (*last
+          && (*last)->type == diff->type
+          && (*last)->original_start + (*last)->original_length
+               == diff->original_start
+          && (*last)->modified_start + (*last)->modified_length
+               == diff->modified_start)
+        {
+          (*last)->original_length += diff->original_length;
+          (*last)->modified_length += diff->modified_length;
+        }
+      else
+        {
+          diff->next = NULL;
+          if (*last)
+            (*last)->next = diff;
+          else
+            *head = diff;
+          *last = diff;
+        }
+
+      diff = next;
+    }
+}
+
+/* Append a hunk of TYPE covering the lines from the START of each of
+ * SOURCES to, but excluding, the respective line number in END. */
+static void
+append_range(svn_diff_t **head,
+             svn_diff_t **last,
+             svn_diff__type_e type,
+             const window_source_t sources[2],
+             const apr_off_t end[2],
+             apr_pool_t *pool)
+{
+  svn_diff_t *diff;
+
+  if (end[0] == sources[0].start && end[1] == sources[1].start)
+    return;
+
+  diff = apr_pcalloc(pool, sizeof(*diff));
+  diff->type = type;
+  diff->original_start = sources[0].start - 1;
+  diff->original_length = end[0] - sources[0].start;
+  diff->modified_start = sources[1].start - 1;
+  diff->modified_length = end[1] - sources[1].start;
+
+  append_hunks(head, last, diff);
+}
+
+/* Compare the windows of SOURCES, which must both not be empty, and
+ * append the hunks for a leading part of them to *HEAD / *LAST.  Advance
+ * the START of both SOURCES past that part.  Allocate the hunks in
+ * RESULT_POOL and temporaries in SCRATCH_POOL. */
+static void
+commit_window(svn_diff_t **head,
+              svn_diff_t **last,
+              window_source_t sources[2],
+              svn_diff__token_index_t num_tokens,
+              svn_diff_file_algorithm_t algorithm,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  svn_diff__lcs_t *lcs;
+  svn_diff__lcs_t *chunk;
+  svn_diff__lcs_t *selected = NULL;
+  svn_diff__lcs_t *end_lcs;
+  apr_off_t half[2];
+  apr_off_t end[2];
+  int i;
+
+  lcs = svn_diff__lcs(sources[0].positions, sources[1].positions,
+                      svn_diff__get_token_counts(sources[0].positions,
+                                                 num_tokens, scratch_pool),
+                      svn_diff__get_token_counts(sources[1].positions,
+                                                 num_tokens, scratch_pool),
+                      num_tokens, 0, 0, algorithm, scratch_pool);
+
+  for (i = 0; i < 2; i++)
+    half[i] = sources[i].start + sources[i].count / 2;
+
+  /* Matches close to the end of a window may be spurious, because the
+   * better ones may lie beyond it.  So commit up to the last common chunk
+   * that ends in the first half of both windows, or up to the first one
+   * if there is none such. */
+  for (chunk = lcs; chunk->length > 0; chunk = chunk->next)
+    {
+      if (selected == NULL
+          || (chunk->position[0]->offset + chunk->length <= half[0]
+              && chunk->position[1]->offset + chunk->length <= half[1]))
+        selected = chunk;
+    }
+
+  if (selected == NULL)
+    {
+      /* Nothing in common.  Give up on the first half of both windows. */
+      for (i = 0; i < 2; i++)
+        end[i] = sources[i].start + (sources[i].count + 1) / 2;
+
+      append_range(head, last, svn_diff__type_diff_modified, sources, end,
+                   result_pool);
+    }
+  else
+    {
+      for (i = 0; i < 2; i++)
+        end[i] = selected->position[i]->offset + selected->length;
+
+      /* Terminate the chain after SELECTED with an EOF chunk at END. */
+      end_lcs = apr_pcalloc(scratch_pool, sizeof(*end_lcs));
+      for (i = 0; i < 2; i++)
+        {
+          end_lcs->position[i] = apr_pcalloc(scratch_pool,
+                                             sizeof(*end_lcs->position[i]));
+          end_lcs->position[i]->offset = end[i];
+        }
+      selected->next = end_lcs;
+
+      append_hunks(head, last,
+                   svn_diff__diff(lcs, sources[0].start, sources[1].start,
+                                  TRUE, result_pool));
+    }
+
+  for (i = 0; i < 2; i++)
+    sources[i].start = end[i];
+}
+
+svn_error_t *
+svn_diff__diff_2_windowed(svn_diff_t **diff,
+                          void *diff_baton,
+                          const svn_diff_fns2_t *vtable,
+                          svn_diff_file_algorithm_t algorithm,
+                          apr_off_t window_lines,
+                          apr_pool_t *pool)
+{
+  window_source_t sources[2];
+  svn_diff_datasource_e datasource[] = {svn_diff_datasource_original,
+                                        svn_diff_datasource_modified};
+  svn_diff__tree_t *tree = NULL;
+  apr_pool_t *window_pool = NULL;
+  svn_diff_t *last = NULL;
+  apr_off_t prefix_lines = 0;
+  apr_off_t suffix_lines = 0;
+  apr_off_t end[2];
+  int i;
+
+  SVN_ERR_ASSERT(window_lines > 0);
+
+  *diff = NULL;
+
+  SVN_ERR(vtable->datasources_open(diff_baton, &prefix_lines, &suffix_lines,
+                                   datasource, 2));
+
+  for (i = 0; i < 2; i++)
+    {
+      sources[i].datasource = datasource[i];
+      sources[i].positions = NULL;
+      sources[i].count = 0;
+      sources[i].start = 1;
+      sources[i].offset = prefix_lines;
+      sources[i].eof = FALSE;
+      end[i] = prefix_lines + 1;
+    }
+
+  append_range(diff, &last, svn_diff__type_common, sources, end, pool);
+  for (i = 0; i < 2; i++)
+    sources[i].start = end[i];
+
+  while (1)
+    {
+      apr_pool_t *next_pool = svn_pool_create(pool);
+      svn_diff__tree_t *next_tree;
+
+      /* Move what is left of the previous windows to a fresh tree, so
+       * tokens we are done with don't accumulate. */
+      svn_diff__tree_create(&next_tree, next_pool);
+      SVN_ERR(carry_over_window(sources, next_tree, tree, diff_baton, vtable,
+                                next_pool, window_pool ? window_pool
+                                                       : next_pool));
+      if (window_pool)
+        svn_pool_destroy(window_pool);
+      window_pool = next_pool;
+      tree = next_tree;
+
+      for (i = 0; i < 2; i++)
+        SVN_ERR(fill_window(&sources[i], tree, diff_baton, vtable,
+                            window_lines, window_pool));
+
+      if (sources[0].eof && sources[1].eof)
+        break;
+
+      if (sources[0].count == 0 || sources[1].count == 0)
+        {
+          /* One datasource is exhausted, so the rest of the other one
+           * can only be new. */
+          for (i = 0; i < 2; i++)
+            end[i] = sources[i].offset + 1;
+
+          append_range(diff, &last, svn_diff__type_diff_modified, sources,
+                       end, pool);
+          for (i = 0; i < 2; i++)
+            sources[i].start = end[i];
+        }
+      else
+        {
+          commit_window(diff, &last, sources,
+                        svn_diff__get_node_count(tree), algorithm,
+                        pool, window_pool);
+        }
+    }
+
+  /* The final windows reach up to the identical suffix. */
+  if (sources[0].count && sources[1].count)
+    {
+      svn_diff__token_index_t num_tokens = svn_diff__get_node_count(tree);
+      svn_diff__lcs_t *lcs;
+
+      lcs = svn_diff__lcs(sources[0].positions, sources[1].positions,
+                          svn_diff__get_token_counts(sources[0].positions,
+                                                     num_tokens, window_pool),
+                          svn_diff__get_token_counts(sources[1].positions,
+                                                     num_tokens, window_pool),
+                          num_tokens, 0, suffix_lines, algorithm,
+                          window_pool);
+
+      append_hunks(diff, &last,
+                   svn_diff__diff(lcs, sources[0].start, sources[1].start,
+                                  TRUE, pool));
+    }
+  else
+    {
+      for (i = 0; i < 2; i++)
+        end[i] = sources[i].offset + 1;
+
+      append_range(diff, &last, svn_diff__type_diff_modified, sources, end,
+                   pool);
+      for (i = 0; i < 2; i++)
+        {
+          sources[i].start = end[i];
+          end[i] += suffix_lines;
+        }
+
+      append_range(diff, &last, svn_diff__type_common, sources, end, pool);
+    }
+
+  if (vtable->token_discard_all != NULL)
+    vtable->token_discard_all(diff_baton);
+
+  svn_pool_destroy(window_pool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_diff_diff_2(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                apr_pool_t *pool)
+{
+  return svn_error_trace(svn_diff__diff_2(diff, diff_baton, vtable,
+                                          svn_diff_file_algorithm_myers,
+                                          pool));
+}
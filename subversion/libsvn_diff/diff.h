@@ -101,6 +101,9 @@ typedef enum svn_diff__normalize_state_t
  * equal and be excluded from the comparison process. Similarly, SUFFIX_LINES
  * at the end of both sequences will be skipped.
  *
+ * ALGORITHM selects how the common subsequence is found.  Only the default
+ * algorithm guarantees that it is actually the longest one.
+ *
  * The resulting lcs structure will be the return value of this function.
  * Allocations will be made from POOL.
  */
@@ -112,8 +115,60 @@ svn_diff__lcs(svn_diff__position_t *position_list1, /* pointer to tail (ring) */
               svn_diff__token_index_t num_tokens, /* length of count arrays */
               apr_off_t prefix_lines,
               apr_off_t suffix_lines,
+              svn_diff_file_algorithm_t algorithm,
               apr_pool_t *pool);
 
+/*
+ * Find common chunks between the non-empty position lists POSITION_LIST1
+ * and POSITION_LIST2 using the histogram diff algorithm.  NUM_TOKENS is
+ * the number of different tokens.  Return the chunks in forward order but,
+ * unlike svn_diff__lcs(), without any terminating EOF chunk.  Return NULL
+ * if there are no common chunks.  Allocations will be made from POOL.
+ */
+svn_diff__lcs_t *
+svn_diff__lcs_histogram(svn_diff__position_t *position_list1,
+                        svn_diff__position_t *position_list2,
+                        svn_diff__token_index_t num_tokens,
+                        apr_pool_t *pool);
+
+/* Like svn_diff_diff_2() but use ALGORITHM to compare the datasources. */
+svn_error_t *
+svn_diff__diff_2(svn_diff_t **diff,
+                 void *diff_baton,
+                 const svn_diff_fns2_t *vtable,
+                 svn_diff_file_algorithm_t algorithm,
+                 apr_pool_t *pool);
+
+/* Like svn_diff__diff_2() but look at no more than WINDOW_LINES tokens of
+ * each datasource at a time, after the identical prefix and suffix have
+ * been skipped.  This keeps the memory use bounded for arbitrarily large
+ * datasources.  The result is a valid diff but, since matches are only
+ * looked for within the current window, not necessarily a minimal one.
+ * WINDOW_LINES must be positive. */
+svn_error_t *
+svn_diff__diff_2_windowed(svn_diff_t **diff,
+                          void *diff_baton,
+                          const svn_diff_fns2_t *vtable,
+                          svn_diff_file_algorithm_t algorithm,
+                          apr_off_t window_lines,
+                          apr_pool_t *pool);
+
+/* Like svn_diff_diff3_2() but use ALGORITHM to compare the datasources. */
+svn_error_t *
+svn_diff__diff3(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                svn_diff_file_algorithm_t algorithm,
+                apr_pool_t *pool);
+
+/* Like svn_diff_diff4_2() but use ALGORITHM to compare the datasources. */
+svn_error_t *
+svn_diff__diff4(svn_diff_t **diff,
+                void *diff_baton,
+                const svn_diff_fns2_t *vtable,
+                svn_diff_file_algorithm_t algorithm,
+                apr_pool_t *pool);
+
 
 /*
  * Returns number of tokens in a tree
@@ -128,6 +183,28 @@ void
 svn_diff__tree_create(svn_diff__tree_t **tree, apr_pool_t *pool);
 
 
+/*
+ * Insert TOKEN with HASH into TREE and return the index of its node in
+ * *TOKEN_INDEX.  If TREE already holds an equal token, that one will be
+ * discarded and replaced by TOKEN.
+ */
+svn_error_t *
+svn_diff__tree_insert_token(svn_diff__token_index_t *token_index,
+                            svn_diff__tree_t *tree,
+                            void *diff_baton,
+                            const svn_diff_fns2_t *vtable,
+                            apr_uint32_t hash, void *token);
+
+/*
+ * Return the tokens held by TREE and their hashes in *TOKENS and *HASHES,
+ * both indexed by token index.  Allocations will be made from POOL.
+ */
+void
+svn_diff__tree_get_tokens(void ***tokens,
+                          apr_uint32_t **hashes,
+                          svn_diff__tree_t *tree,
+                          apr_pool_t *pool);
+
 /*
  * Get all tokens from a datasource.  Return the
  * last item in the (circular) list.
@@ -163,6 +240,7 @@ svn_diff__resolve_conflict(svn_diff_t *hunk,
                            svn_diff__position_t **position_list1,
                            svn_diff__position_t **position_list2,
                            svn_diff__token_index_t num_tokens,
+                           svn_diff_file_algorithm_t algorithm,
                            apr_pool_t *pool);
 
 
@@ -184,6 +262,31 @@ svn_diff__normalize_buffer(char **tgt,
                            const char *buf,
                            const svn_diff_file_options_t *opts);
 
+/* Incremental state for hashing the normalized contents of a token.
+ * The result only depends on the bytes fed in, not on how they are
+ * split between calls to svn_diff__hash_update().  Do not access the
+ * members directly. */
+typedef struct svn_diff__hash_t
+{
+  apr_uint64_t value;
+  apr_size_t length;
+  char tail[8];
+} svn_diff__hash_t;
+
+/* Initialize HASH for a new token. */
+void
+svn_diff__hash_init(svn_diff__hash_t *hash);
+
+/* Add the LEN bytes at DATA to HASH. */
+void
+svn_diff__hash_update(svn_diff__hash_t *hash,
+                      const char *data,
+                      apr_size_t len);
+
+/* Return the final 32 bit token hash for HASH. */
+apr_uint32_t
+svn_diff__hash_final(const svn_diff__hash_t *hash);
+
 /* Set *OUT_STR to a newline followed by a "\ No newline at end of file" line.
  *
  * The text will be encoded into HEADER_ENCODING.
@@ -49,7 +49,6 @@
 #include "private/svn_utf_private.h"
 #include "private/svn_eol_private.h"
 #include "private/svn_dep_compat.h"
-#include "private/svn_adler32.h"
 #include "private/svn_diff_private.h"
 
 /* A token, i.e. a line read from a file. */
@@ -863,7 +862,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
   char *eol;
   apr_off_t last_chunk;
   apr_off_t length;
-  apr_uint32_t h = 0;
+  svn_diff__hash_t h;
   /* Did the last chunk end in a CR character? */
   svn_boolean_t had_cr = FALSE;
 
@@ -911,6 +910,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
   file_token->norm_offset = file_token->offset;
   file_token->raw_length = 0;
   file_token->length = 0;
+  svn_diff__hash_init(&h);
 
   while (1)
     {
@@ -950,7 +950,7 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
             file_token->norm_offset += (c - curp);
           }
         file_token->length += length;
-        h = svn__adler32(h, c, length);
+        svn_diff__hash_update(&h, c, (apr_size_t)length);
       }
 
       curp = endp = file->buffer;
@@ -1007,7 +1007,8 @@ datasource_get_next_token(apr_uint32_t *hash, void **token, void *baton,
 
       file_token->length += length;
 
-      *hash = svn__adler32(h, c, length);
+      svn_diff__hash_update(&h, c, (apr_size_t)length);
+      *hash = svn_diff__hash_final(&h);
       *token = file_token;
     }
 
@@ -1181,6 +1182,8 @@ static const svn_diff_fns2_t svn_diff__file_vtable =
 
 /* Id for the --ignore-eol-style option, which doesn't have a short name. */
 #define SVN_DIFF__OPT_IGNORE_EOL_STYLE 256
+#define SVN_DIFF__OPT_HISTOGRAM 257
+#define SVN_DIFF__OPT_WINDOW_LINES 258
 
 /* Options supported by svn_diff_file_options_parse(). */
 static const apr_getopt_option_t diff_options[] =
@@ -1189,6 +1192,8 @@ static const apr_getopt_option_t diff_options[] =
   { "ignore-all-space", 'w', 0, NULL },
   { "ignore-eol-style", SVN_DIFF__OPT_IGNORE_EOL_STYLE, 0, NULL },
   { "show-c-function", 'p', 0, NULL },
+  { "histogram", SVN_DIFF__OPT_HISTOGRAM, 0, NULL },
+  { "window-lines", SVN_DIFF__OPT_WINDOW_LINES, 1, NULL },
   /* ### For compatibility; we don't support the argument to -u, because
    * ### we don't have optional argument support. */
   { "unified", 'u', 0, NULL },
@@ -1295,6 +1300,18 @@ svn_diff_file_options_parse(svn_diff_file_options_t *options,
         case 'p':
           options->show_c_function = TRUE;
           break;
+        case SVN_DIFF__OPT_HISTOGRAM:
+          options->algorithm = svn_diff_file_algorithm_histogram;
+          break;
+        case SVN_DIFF__OPT_WINDOW_LINES:
+          {
+            apr_int64_t window_lines;
+
+            SVN_ERR(svn_cstring_strtoi64(&window_lines, opt_arg,
+                                         0, APR_INT64_MAX, 10));
+            options->window_lines = (apr_off_t)window_lines;
+          }
+          break;
         case 'U':
           SVN_ERR(svn_cstring_atoi(&options->context_size, opt_arg));
           break;
@@ -1326,12 +1343,418 @@ svn_diff_file_diff_2(svn_diff_t **diff,
   baton.files[1].path = modified;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff_2(diff, &baton, &svn_diff__file_vtable, pool));
+  if (options->window_lines > 0)
+    SVN_ERR(svn_diff__diff_2_windowed(diff, &baton, &svn_diff__file_vtable,
+                                      options->algorithm,
+                                      options->window_lines, pool));
+  else
+    SVN_ERR(svn_diff__diff_2(diff, &baton, &svn_diff__file_vtable,
+                             options->algorithm, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
 }
 
+/* Like svn_diff__file_vtable, but never discard tokens, because the
+ * chain diff functions below hold on to them. */
+static const svn_diff_fns2_t chain_vtable =
+{
+  datasources_open,
+  datasource_close,
+  datasource_get_next_token,
+  token_compare,
+  NULL,
+  NULL
+};
+
+/* The tokens of consecutive lines of a file and the indices of their
+ * nodes in a token tree. */
+typedef struct chain_lines_t
+{
+  /* Elements are svn_diff__file_token_t *. */
+  apr_array_header_t *tokens;
+
+  /* Elements are svn_diff__token_index_t. */
+  apr_array_header_t *indices;
+} chain_lines_t;
+
+struct svn_diff__file_chain_t
+{
+  const svn_diff_file_options_t *options;
+
+  /* The file last diffed as "modified", or NULL. */
+  const char *path;
+
+  /* The lines of PATH between the identical prefix and suffix of the last
+   * diff, starting at line number FIRST_LINE.  TREE holds their tokens
+   * and nothing else. */
+  chain_lines_t lines;
+  apr_off_t first_line;
+  svn_diff__tree_t *tree;
+
+  /* Holds all of the above but OPTIONS. */
+  apr_pool_t *cache_pool;
+
+  /* The pool the chain was allocated in. */
+  apr_pool_t *pool;
+};
+
+svn_diff__file_chain_t *
+svn_diff__file_chain_create(const svn_diff_file_options_t *options,
+                            apr_pool_t *result_pool)
+{
+  svn_diff__file_chain_t *chain = apr_pcalloc(result_pool, sizeof(*chain));
+
+  chain->options = options;
+  chain->pool = result_pool;
+
+  return chain;
+}
+
+/* Drop everything cached in CHAIN. */
+static void
+reset_chain(svn_diff__file_chain_t *chain)
+{
+  if (chain->cache_pool)
+    svn_pool_destroy(chain->cache_pool);
+
+  chain->cache_pool = NULL;
+  chain->path = NULL;
+  chain->tree = NULL;
+  chain->lines.tokens = NULL;
+  chain->lines.indices = NULL;
+}
+
+/* Read at most MAX_TOKENS tokens, or all if MAX_TOKENS is negative, from
+ * DATASOURCE of BATON, insert them into TREE and append them to LINES.
+ * Set *AT_SUFFIX if the identical suffix or the end of DATASOURCE has
+ * been reached. */
+static svn_error_t *
+read_chain_tokens(svn_boolean_t *at_suffix,
+                  chain_lines_t *lines,
+                  svn_diff__file_baton_t *baton,
+                  svn_diff__tree_t *tree,
+                  svn_diff_datasource_e datasource,
+                  apr_off_t max_tokens)
+{
+  *at_suffix = FALSE;
+
+  for (; max_tokens != 0; max_tokens--)
+    {
+      svn_diff__token_index_t token_index;
+      apr_uint32_t hash;
+      void *token;
+
+      SVN_ERR(datasource_get_next_token(&hash, &token, baton, datasource));
+      if (token == NULL)
+        {
+          *at_suffix = TRUE;
+          break;
+        }
+
+      SVN_ERR(svn_diff__tree_insert_token(&token_index, tree, baton,
+                                          &chain_vtable, hash, token));
+      APR_ARRAY_PUSH(lines->tokens, svn_diff__file_token_t *) = token;
+      APR_ARRAY_PUSH(lines->indices, svn_diff__token_index_t) = token_index;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Make FILE continue reading at OFFSET. */
+static svn_error_t *
+seek_to_offset(struct file_info *file,
+               apr_off_t offset,
+               apr_pool_t *scratch_pool)
+{
+  apr_off_t last_chunk = offset_to_chunk(file->size);
+  apr_off_t length;
+
+  /* Don't reload the current chunk.  The tokens read from it have been
+   * normalized in place and token_compare() relies on that. */
+  if (offset_to_chunk(offset) != file->chunk)
+    {
+      file->chunk = (int) offset_to_chunk(offset);
+      length = file->chunk == last_chunk ? offset_in_chunk(file->size)
+                                         : CHUNK_SIZE;
+      SVN_ERR(read_chunk(file->file, file->buffer, length,
+                         chunk_to_offset(file->chunk), scratch_pool));
+      file->endp = file->buffer + length;
+    }
+
+  file->curp = file->buffer + offset_in_chunk(offset);
+  file->normalize_state = svn_diff__normalize_state_normal;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a ring of positions for the token INDICES of consecutive lines,
+ * starting at line FIRST_LINE, like svn_diff__get_tokens() does.  Return
+ * NULL if there are no INDICES. */
+static svn_diff__position_t *
+make_position_ring(const apr_array_header_t *indices,
+                   apr_off_t first_line,
+                   apr_pool_t *pool)
+{
+  svn_diff__position_t *positions;
+  int i;
+
+  if (indices->nelts == 0)
+    return NULL;
+
+  positions = apr_palloc(pool, indices->nelts * sizeof(*positions));
+  for (i = 0; i < indices->nelts; i++)
+    {
+      positions[i].next = &positions[(i + 1) % indices->nelts];
+      positions[i].token_index = APR_ARRAY_IDX(indices, i,
+                                               svn_diff__token_index_t);
+      positions[i].offset = first_line + i;
+    }
+
+  return &positions[indices->nelts - 1];
+}
+
+/* Collect the lines of the "original" datasource of BATON between its
+ * identical prefix and suffix in LINES, reusing those cached in CHAIN
+ * where possible.  Return the token tree holding them in *TREE. */
+static svn_error_t *
+read_chain_original(chain_lines_t *lines,
+                    svn_diff__tree_t **tree,
+                    svn_diff__file_chain_t *chain,
+                    svn_diff__file_baton_t *baton,
+                    apr_off_t prefix_lines,
+                    apr_pool_t *scratch_pool)
+{
+  struct file_info *file = &baton->files[0];
+  struct file_info *cached_file = &baton->files[2];
+  apr_off_t line = prefix_lines + 1;
+  apr_off_t cache_end;
+  apr_off_t suffix_offset;
+  svn_boolean_t at_suffix = FALSE;
+  int i;
+
+  if (!chain->path || strcmp(chain->path, file->path) != 0
+      || chain->lines.tokens->nelts == 0)
+    {
+      svn_diff__tree_create(tree, scratch_pool);
+      return svn_error_trace(read_chain_tokens(&at_suffix, lines, baton,
+                                               *tree,
+                                               svn_diff_datasource_original,
+                                               -1));
+    }
+
+  *tree = chain->tree;
+  cache_end = chain->first_line + chain->lines.tokens->nelts;
+  suffix_offset = file->suffix_start_chunk < 0
+                ? file->size
+                : chunk_to_offset(file->suffix_start_chunk)
+                  + file->suffix_offset_in_chunk;
+
+  /* The cached tokens have not been normalized in FILE's buffer like
+   * those read during this diff, so token_compare() must always read
+   * them from disk.  Make them refer to an otherwise unused datasource
+   * that has no chunk in memory. */
+  cached_file->path = file->path;
+  cached_file->file = file->file;
+  cached_file->size = file->size;
+  cached_file->chunk = -1;
+  for (i = 0; i < chain->lines.tokens->nelts; i++)
+    APR_ARRAY_IDX(chain->lines.tokens, i, svn_diff__file_token_t *)
+      ->datasource = svn_diff_datasource_latest;
+
+  /* Read the lines in front of the cached ones. */
+  if (line < chain->first_line)
+    {
+      SVN_ERR(read_chain_tokens(&at_suffix, lines, baton, *tree,
+                                svn_diff_datasource_original,
+                                chain->first_line - line));
+      line += lines->tokens->nelts;
+    }
+
+  /* Reuse the cached lines, up to the identical suffix. */
+  if (!at_suffix && line < cache_end)
+    {
+      apr_off_t offset = chunk_to_offset(file->chunk)
+                         + (file->curp - file->buffer);
+      svn_diff__file_token_t *token;
+
+      i = (int) (line - chain->first_line);
+      token = APR_ARRAY_IDX(chain->lines.tokens, i, svn_diff__file_token_t *);
+
+      /* Only reuse the cached lines if they line up with what we read.
+       * The tokens are left in TREE either way, which doesn't hurt. */
+      if (token->offset == offset)
+        {
+          for (; i < chain->lines.tokens->nelts; i++)
+            {
+              token = APR_ARRAY_IDX(chain->lines.tokens, i,
+                                    svn_diff__file_token_t *);
+              if (token->offset >= suffix_offset)
+                {
+                  at_suffix = TRUE;
+                  break;
+                }
+
+              APR_ARRAY_PUSH(lines->tokens, svn_diff__file_token_t *) = token;
+              APR_ARRAY_PUSH(lines->indices, svn_diff__token_index_t)
+                = APR_ARRAY_IDX(chain->lines.indices, i,
+                                svn_diff__token_index_t);
+            }
+
+          if (!at_suffix)
+            SVN_ERR(seek_to_offset(file, token->offset + token->raw_length,
+                                   scratch_pool));
+        }
+    }
+
+  /* And the ones behind them. */
+  if (!at_suffix)
+    SVN_ERR(read_chain_tokens(&at_suffix, lines, baton, *tree,
+                              svn_diff_datasource_original, -1));
+
+  return SVN_NO_ERROR;
+}
+
+/* Diff the files of BATON for svn_diff__file_chain_diff() and replace the
+ * lines cached in CHAIN by those of the modified file.  Allocate the new
+ * cache in BATON->pool, *DIFF in RESULT_POOL and temporaries in
+ * SCRATCH_POOL. */
+static svn_error_t *
+chain_diff(svn_diff_t **diff,
+           svn_diff__file_chain_t *chain,
+           svn_diff__file_baton_t *baton,
+           apr_pool_t *result_pool,
+           apr_pool_t *scratch_pool)
+{
+  svn_diff_datasource_e datasource[] = {svn_diff_datasource_original,
+                                        svn_diff_datasource_modified};
+  chain_lines_t lines[2];
+  svn_diff__tree_t *tree;
+  svn_diff__tree_t *new_tree;
+  svn_diff__position_t *position_list[2];
+  svn_diff__token_index_t num_tokens;
+  svn_diff__token_index_t token_index;
+  svn_diff__token_index_t *token_map;
+  svn_diff__lcs_t *lcs;
+  apr_off_t prefix_lines = 0;
+  apr_off_t suffix_lines = 0;
+  svn_boolean_t at_suffix;
+  void **tokens;
+  apr_uint32_t *hashes;
+  int i;
+
+  SVN_ERR(datasources_open(baton, &prefix_lines, &suffix_lines,
+                           datasource, 2));
+
+  lines[0].tokens = apr_array_make(scratch_pool, 0,
+                                   sizeof(svn_diff__file_token_t *));
+  lines[0].indices = apr_array_make(scratch_pool, 0,
+                                    sizeof(svn_diff__token_index_t));
+  lines[1].tokens = apr_array_make(baton->pool, 0,
+                                   sizeof(svn_diff__file_token_t *));
+  lines[1].indices = apr_array_make(baton->pool, 0,
+                                    sizeof(svn_diff__token_index_t));
+
+  SVN_ERR(read_chain_original(&lines[0], &tree, chain, baton, prefix_lines,
+                              scratch_pool));
+  SVN_ERR(read_chain_tokens(&at_suffix, &lines[1], baton, tree,
+                            svn_diff_datasource_modified, -1));
+
+  num_tokens = svn_diff__get_node_count(tree);
+  for (i = 0; i < 2; i++)
+    position_list[i] = make_position_ring(lines[i].indices, prefix_lines + 1,
+                                          scratch_pool);
+
+  lcs = svn_diff__lcs(position_list[0], position_list[1],
+                      svn_diff__get_token_counts(position_list[0], num_tokens,
+                                                 scratch_pool),
+                      svn_diff__get_token_counts(position_list[1], num_tokens,
+                                                 scratch_pool),
+                      num_tokens, prefix_lines, suffix_lines,
+                      chain->options->algorithm, scratch_pool);
+  *diff = svn_diff__diff(lcs, 1, 1, TRUE, result_pool);
+
+  /* Move the tokens of the modified file to a tree of their own.  They
+   * are all distinct, so this only compares them on hash collisions. */
+  svn_diff__tree_create(&new_tree, baton->pool);
+  svn_diff__tree_get_tokens(&tokens, &hashes, tree, scratch_pool);
+  token_map = apr_palloc(scratch_pool, (num_tokens + 1) * sizeof(*token_map));
+  for (token_index = 0; token_index < num_tokens; token_index++)
+    token_map[token_index] = -1;
+
+  for (i = 0; i < lines[1].indices->nelts; i++)
+    {
+      svn_diff__token_index_t *index_p
+        = &APR_ARRAY_IDX(lines[1].indices, i, svn_diff__token_index_t);
+
+      if (token_map[*index_p] < 0)
+        SVN_ERR(svn_diff__tree_insert_token(
+                  &token_map[*index_p], new_tree, baton, &chain_vtable,
+                  hashes[*index_p],
+                  APR_ARRAY_IDX(lines[1].tokens, i, svn_diff__file_token_t *)));
+
+      *index_p = token_map[*index_p];
+    }
+
+  chain->lines = lines[1];
+  chain->first_line = prefix_lines + 1;
+  chain->tree = new_tree;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_diff__file_chain_diff(svn_diff_t **diff,
+                          svn_diff__file_chain_t *chain,
+                          const char *original,
+                          const char *modified,
+                          apr_pool_t *pool)
+{
+  svn_diff__file_baton_t baton = { 0 };
+  apr_pool_t *scratch_pool;
+  svn_error_t *err;
+  int i;
+
+  /* The windowed diff doesn't keep all tokens around. */
+  if (chain->options->window_lines > 0)
+    {
+      reset_chain(chain);
+      return svn_error_trace(svn_diff_file_diff_2(diff, original, modified,
+                                                  chain->options, pool));
+    }
+
+  baton.options = chain->options;
+  baton.files[0].path = original;
+  baton.files[1].path = modified;
+  baton.pool = svn_pool_create(chain->pool);
+  scratch_pool = svn_pool_create(pool);
+
+  err = chain_diff(diff, chain, &baton, pool, scratch_pool);
+
+  /* The tokens we keep only need the file offsets.  Close the files now,
+   * so our caller may delete them. */
+  for (i = 0; i < 2; i++)
+    if (baton.files[i].file)
+      err = svn_error_compose_create(err,
+                                     svn_io_file_close(baton.files[i].file,
+                                                       scratch_pool));
+  svn_pool_destroy(scratch_pool);
+
+  if (err)
+    {
+      svn_pool_destroy(baton.pool);
+      reset_chain(chain);
+      return svn_error_trace(err);
+    }
+
+  if (chain->cache_pool)
+    svn_pool_destroy(chain->cache_pool);
+  chain->cache_pool = baton.pool;
+  chain->path = apr_pstrdup(baton.pool, modified);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_diff_file_diff3_2(svn_diff_t **diff,
                       const char *original,
@@ -1348,7 +1771,8 @@ svn_diff_file_diff3_2(svn_diff_t **diff,
   baton.files[2].path = latest;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff3_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff3(diff, &baton, &svn_diff__file_vtable,
+                          options->algorithm, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
@@ -1372,7 +1796,8 @@ svn_diff_file_diff4_2(svn_diff_t **diff,
   baton.files[3].path = ancestor;
   baton.pool = svn_pool_create(pool);
 
-  SVN_ERR(svn_diff_diff4_2(diff, &baton, &svn_diff__file_vtable, pool));
+  SVN_ERR(svn_diff__diff4(diff, &baton, &svn_diff__file_vtable,
+                          options->algorithm, pool));
 
   svn_pool_destroy(baton.pool);
   return SVN_NO_ERROR;
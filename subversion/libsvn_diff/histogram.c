@@ -0,0 +1,448 @@
+/*
+ * histogram.c :  routines for creating an lcs using histogram diff
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <apr.h>
+#include <apr_pools.h>
+#include <apr_general.h>
+#include <apr_tables.h>
+
+#include "svn_pools.h"
+#include "diff.h"
+
+
+/*
+ * Histogram diff, as popularized by JGit, is an extension of patience
+ * diff.  Rather than searching for a minimal edit script, it recursively
+ * splits the sequences at the longest common run that contains the
+ * rarest tokens:
+ *
+ * 1. Strip the common prefix and suffix of the current region.
+ * 2. Count how often each token occurs in the region of the first
+ *    sequence (the "histogram").
+ * 3. For every token in the region of the second sequence that also
+ *    occurs in the first one, extend each of its occurrences to a maximal
+ *    common run.  Prefer the run whose rarest token has the lowest count
+ *    and, for equal counts, the longer one.
+ * 4. Emit that run as a common chunk and process the regions before and
+ *    after it the same way.
+ *
+ * Tokens that occur more than MAX_CHAIN_LENGTH times within a region are
+ * never used to anchor a run.  If a region has only such tokens in
+ * common, we fall back to the regular LCS algorithm for that region.
+ *
+ * The cost is roughly linear in the number of tokens for typical input,
+ * as opposed to O(N * D) for the regular algorithm, where D is the number
+ * of differences.  The result is not always minimal, but changes tend to
+ * be grouped around unique lines, which usually follows the structure of
+ * the text more closely.
+ */
+
+/* Tokens occurring more often than this within a region will not be used
+ * as anchors for common runs. */
+#define MAX_CHAIN_LENGTH 64
+
+/* Kinds of entries in the work stack. */
+typedef enum work_kind_e
+{
+  /* Find the common chunks within a region. */
+  work_region,
+
+  /* Emit a known common chunk. */
+  work_match
+} work_kind_e;
+
+/* An entry in the work stack.  Indexes are relative to the start of the
+ * respective token arrays.  For work_match, the A and B ranges have the
+ * same length. */
+typedef struct work_t
+{
+  work_kind_e kind;
+  svn_diff__token_index_t a_start, a_end;
+  svn_diff__token_index_t b_start, b_end;
+} work_t;
+
+/* State shared by all steps of one histogram diff. */
+typedef struct histogram_t
+{
+  /* Token indexes of both sequences. */
+  svn_diff__token_index_t *tokens[2];
+
+  /* Offset of the first token in each sequence. */
+  apr_off_t base[2];
+
+  /* Number of different tokens. */
+  svn_diff__token_index_t num_tokens;
+
+  /* Per token, the first occurrence within the current region of the
+   * first sequence and the number of occurrences in that region.
+   * Entries in HEAD are only valid if the respective COUNT is not 0. */
+  svn_diff__token_index_t *head;
+  svn_diff__token_index_t *count;
+
+  /* Per position in the first sequence, the next occurrence of the same
+   * token within the current region or -1. */
+  svn_diff__token_index_t *next;
+
+  /* Token counts for the LCS fallback.  Allocated on first use and always
+   * all 0 otherwise. */
+  svn_diff__token_index_t *fallback_counts[2];
+
+  /* Pending work, processed LIFO. */
+  apr_array_header_t *work;
+
+  /* The common chunks found so far, in forward order. */
+  svn_diff__lcs_t *first;
+  svn_diff__lcs_t *last;
+
+  /* For all allocations. */
+  apr_pool_t *pool;
+} histogram_t;
+
+
+/* Push a work item of KIND for the given ranges onto the work stack of H.
+ * Empty ranges will be ignored. */
+static void
+push_work(histogram_t *h,
+          work_kind_e kind,
+          svn_diff__token_index_t a_start,
+          svn_diff__token_index_t a_end,
+          svn_diff__token_index_t b_start,
+          svn_diff__token_index_t b_end)
+{
+  work_t *work;
+
+  if (a_start == a_end && (kind == work_match || b_start == b_end))
+    return;
+
+  work = apr_array_push(h->work);
+  work->kind = kind;
+  work->a_start = a_start;
+  work->a_end = a_end;
+  work->b_start = b_start;
+  work->b_end = b_end;
+}
+
+/* Append a common chunk of LENGTH tokens starting at A_START in the first
+ * and B_START in the second sequence to the result in H.  Merge it with
+ * the previous chunk, if possible. */
+static void
+emit_match(histogram_t *h,
+           apr_off_t a_start,
+           apr_off_t b_start,
+           apr_off_t length)
+{
+  svn_diff__lcs_t *lcs;
+  apr_off_t offset[2];
+
+  offset[0] = h->base[0] + a_start;
+  offset[1] = h->base[1] + b_start;
+
+  if (h->last
+      && h->last->position[0]->offset + h->last->length == offset[0]
+      && h->last->position[1]->offset + h->last->length == offset[1])
+    {
+      h->last->length += length;
+      return;
+    }
+
+  lcs = apr_palloc(h->pool, sizeof(*lcs));
+  lcs->position[0] = apr_pcalloc(h->pool, sizeof(*lcs->position[0]));
+  lcs->position[0]->offset = offset[0];
+  lcs->position[1] = apr_pcalloc(h->pool, sizeof(*lcs->position[1]));
+  lcs->position[1]->offset = offset[1];
+  lcs->length = length;
+  lcs->refcount = 1;
+  lcs->next = NULL;
+
+  if (h->last)
+    h->last->next = lcs;
+  else
+    h->first = lcs;
+
+  h->last = lcs;
+}
+
+/* Use the regular LCS algorithm to find the common chunks between the
+ * ranges [A_START, A_END) and [B_START, B_END) of the sequences in H and
+ * append them to the result. */
+static void
+fallback_lcs(histogram_t *h,
+             svn_diff__token_index_t a_start,
+             svn_diff__token_index_t a_end,
+             svn_diff__token_index_t b_start,
+             svn_diff__token_index_t b_end)
+{
+  apr_pool_t *scratch_pool = svn_pool_create(h->pool);
+  svn_diff__position_t *positions[2];
+  svn_diff__token_index_t start[2], length[2], i;
+  svn_diff__lcs_t *lcs;
+  int k;
+
+  start[0] = a_start;
+  start[1] = b_start;
+  length[0] = a_end - a_start;
+  length[1] = b_end - b_start;
+
+  if (h->fallback_counts[0] == NULL)
+    {
+      h->fallback_counts[0] = apr_pcalloc(h->pool, h->num_tokens
+                                          * sizeof(*h->fallback_counts[0]));
+      h->fallback_counts[1] = apr_pcalloc(h->pool, h->num_tokens
+                                          * sizeof(*h->fallback_counts[1]));
+    }
+
+  /* Build the position rings expected by svn_diff__lcs(). */
+  for (k = 0; k < 2; ++k)
+    {
+      positions[k] = apr_palloc(scratch_pool,
+                                length[k] * sizeof(*positions[k]));
+      for (i = 0; i < length[k]; ++i)
+        {
+          svn_diff__token_index_t token = h->tokens[k][start[k] + i];
+
+          positions[k][i].token_index = token;
+          positions[k][i].offset = h->base[k] + start[k] + i;
+          positions[k][i].next = &positions[k][(i + 1) % length[k]];
+          h->fallback_counts[k][token]++;
+        }
+    }
+
+  lcs = svn_diff__lcs(&positions[0][length[0] - 1],
+                      &positions[1][length[1] - 1],
+                      h->fallback_counts[0], h->fallback_counts[1],
+                      h->num_tokens, 0, 0, svn_diff_file_algorithm_myers,
+                      scratch_pool);
+
+  for (; lcs; lcs = lcs->next)
+    if (lcs->length > 0)
+      emit_match(h, lcs->position[0]->offset - h->base[0],
+                 lcs->position[1]->offset - h->base[1], lcs->length);
+
+  for (k = 0; k < 2; ++k)
+    for (i = 0; i < length[k]; ++i)
+      h->fallback_counts[k][h->tokens[k][start[k] + i]] = 0;
+
+  svn_pool_destroy(scratch_pool);
+}
+
+/* Process the region described by WORK in H, pushing follow-up work onto
+ * the work stack. */
+static void
+process_region(histogram_t *h,
+               const work_t *work)
+{
+  const svn_diff__token_index_t *a = h->tokens[0];
+  const svn_diff__token_index_t *b = h->tokens[1];
+  svn_diff__token_index_t a_start = work->a_start;
+  svn_diff__token_index_t a_end = work->a_end;
+  svn_diff__token_index_t b_start = work->b_start;
+  svn_diff__token_index_t b_end = work->b_end;
+  svn_diff__token_index_t i, bi, suffix;
+  svn_diff__token_index_t best_a = 0, best_b = 0, best_length = 0;
+  svn_diff__token_index_t best_count = MAX_CHAIN_LENGTH + 1;
+  svn_boolean_t have_common = FALSE;
+
+  /* Strip the common prefix.  Everything before it has already been
+   * emitted, hence we can do the same with the prefix. */
+  for (i = 0;
+       a_start + i < a_end && b_start + i < b_end
+       && a[a_start + i] == b[b_start + i];
+       ++i)
+    ;
+  if (i)
+    {
+      emit_match(h, a_start, b_start, i);
+      a_start += i;
+      b_start += i;
+    }
+
+  /* Strip the common suffix.  It must be emitted after the remainder of
+   * this region has been processed. */
+  for (suffix = 0;
+       a_end - suffix > a_start && b_end - suffix > b_start
+       && a[a_end - suffix - 1] == b[b_end - suffix - 1];
+       ++suffix)
+    ;
+  push_work(h, work_match, a_end - suffix, a_end, b_end - suffix, b_end);
+  a_end -= suffix;
+  b_end -= suffix;
+
+  /* Pure insertion or deletion? */
+  if (a_start == a_end || b_start == b_end)
+    return;
+
+  /* Index the region in the first sequence.  Inserting backwards keeps
+   * the occurrence chains in ascending order. */
+  for (i = a_end; i-- > a_start; )
+    {
+      svn_diff__token_index_t token = a[i];
+
+      h->next[i] = h->count[token] ? h->head[token] : -1;
+      h->head[token] = i;
+      h->count[token]++;
+    }
+
+  /* Find the best common run. */
+  for (bi = b_start; bi < b_end; )
+    {
+      svn_diff__token_index_t token = b[bi];
+      svn_diff__token_index_t count = h->count[token];
+      svn_diff__token_index_t next_bi = bi + 1;
+      svn_diff__token_index_t ai;
+
+      if (count == 0)
+        {
+          ++bi;
+          continue;
+        }
+
+      have_common = TRUE;
+      if (count > MAX_CHAIN_LENGTH || count > best_count)
+        {
+          ++bi;
+          continue;
+        }
+
+      for (ai = h->head[token]; ai >= 0; )
+        {
+          svn_diff__token_index_t run_a = ai, run_b = bi;
+          svn_diff__token_index_t run_end_a = ai + 1, run_end_b = bi + 1;
+          svn_diff__token_index_t run_count = count;
+
+          while (run_a > a_start && run_b > b_start
+                 && a[run_a - 1] == b[run_b - 1])
+            {
+              --run_a;
+              --run_b;
+              if (h->count[a[run_a]] < run_count)
+                run_count = h->count[a[run_a]];
+            }
+
+          while (run_end_a < a_end && run_end_b < b_end
+                 && a[run_end_a] == b[run_end_b])
+            {
+              if (h->count[a[run_end_a]] < run_count)
+                run_count = h->count[a[run_end_a]];
+              ++run_end_a;
+              ++run_end_b;
+            }
+
+          if (next_bi < run_end_b)
+            next_bi = run_end_b;
+
+          if (best_length < run_end_b - run_b || run_count < best_count)
+            {
+              best_a = run_a;
+              best_b = run_b;
+              best_length = run_end_b - run_b;
+              best_count = run_count;
+            }
+
+          /* Occurrences within this run would only find the same run. */
+          for (ai = h->next[ai]; ai >= 0 && ai < run_end_a; ai = h->next[ai])
+            ;
+        }
+
+      bi = next_bi;
+    }
+
+  /* Reset the histogram for the next region. */
+  for (i = a_start; i < a_end; ++i)
+    h->count[a[i]] = 0;
+
+  if (best_length > 0)
+    {
+      /* Process the left part first, then the run, then the right part. */
+      push_work(h, work_region, best_a + best_length, a_end,
+                best_b + best_length, b_end);
+      push_work(h, work_match, best_a, best_a + best_length,
+                best_b, best_b + best_length);
+      push_work(h, work_region, a_start, best_a, b_start, best_b);
+    }
+  else if (have_common)
+    {
+      fallback_lcs(h, a_start, a_end, b_start, b_end);
+    }
+}
+
+/* Set *TOKENS to an array of the token indexes in the ring POSITION_LIST,
+ * *BASE to the offset of the first position and *LENGTH to the number of
+ * positions.  Allocate from POOL. */
+static void
+get_tokens(svn_diff__token_index_t **tokens,
+           apr_off_t *base,
+           svn_diff__token_index_t *length,
+           svn_diff__position_t *position_list,
+           apr_pool_t *pool)
+{
+  svn_diff__position_t *position = position_list->next;
+  svn_diff__token_index_t i;
+
+  *base = position->offset;
+  *length = (svn_diff__token_index_t)(position_list->offset - *base + 1);
+  *tokens = apr_palloc(pool, *length * sizeof(**tokens));
+
+  for (i = 0; i < *length; ++i, position = position->next)
+    (*tokens)[i] = position->token_index;
+}
+
+svn_diff__lcs_t *
+svn_diff__lcs_histogram(svn_diff__position_t *position_list1,
+                        svn_diff__position_t *position_list2,
+                        svn_diff__token_index_t num_tokens,
+                        apr_pool_t *pool)
+{
+  histogram_t h = { { 0 } };
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  svn_diff__token_index_t length[2];
+
+  h.num_tokens = num_tokens;
+  h.pool = pool;
+
+  get_tokens(&h.tokens[0], &h.base[0], &length[0], position_list1,
+             scratch_pool);
+  get_tokens(&h.tokens[1], &h.base[1], &length[1], position_list2,
+             scratch_pool);
+
+  h.head = apr_palloc(scratch_pool, num_tokens * sizeof(*h.head));
+  h.count = apr_pcalloc(scratch_pool, num_tokens * sizeof(*h.count));
+  h.next = apr_palloc(scratch_pool, length[0] * sizeof(*h.next));
+  h.work = apr_array_make(scratch_pool, 16, sizeof(work_t));
+
+  push_work(&h, work_region, 0, length[0], 0, length[1]);
+  while (h.work->nelts)
+    {
+      work_t work = *(work_t *)apr_array_pop(h.work);
+
+      if (work.kind == work_match)
+        emit_match(&h, work.a_start, work.b_start,
+                   work.a_end - work.a_start);
+      else
+        process_region(&h, &work);
+    }
+
+  svn_pool_destroy(scratch_pool);
+
+  return h.first;
+}
@@ -142,6 +142,66 @@ tree_insert_token(svn_diff__node_t **node, svn_diff__tree_t *tree,
 }
 
 
+svn_error_t *
+svn_diff__tree_insert_token(svn_diff__token_index_t *token_index,
+                            svn_diff__tree_t *tree,
+                            void *diff_baton,
+                            const svn_diff_fns2_t *vtable,
+                            apr_uint32_t hash, void *token)
+{
+  svn_diff__node_t *node;
+
+  SVN_ERR(tree_insert_token(&node, tree, diff_baton, vtable, hash, token));
+  *token_index = node->index;
+
+  return SVN_NO_ERROR;
+}
+
+
+void
+svn_diff__tree_get_tokens(void ***tokens,
+                          apr_uint32_t **hashes,
+                          svn_diff__tree_t *tree,
+                          apr_pool_t *pool)
+{
+  int i;
+
+  *tokens = apr_palloc(pool, (tree->node_count + 1) * sizeof(**tokens));
+  *hashes = apr_palloc(pool, (tree->node_count + 1) * sizeof(**hashes));
+
+  for (i = 0; i < SVN_DIFF__HASH_SIZE; i++)
+    {
+      svn_diff__node_t *node = tree->root[i];
+
+      /* Walk the tree in pre-order using the parent links, so deep trees
+       * don't exhaust the stack. */
+      while (node != NULL)
+        {
+          (*tokens)[node->index] = node->token;
+          (*hashes)[node->index] = node->hash;
+
+          if (node->left)
+            node = node->left;
+          else if (node->right)
+            node = node->right;
+          else
+            {
+              svn_diff__node_t *parent = node->parent;
+
+              /* Go up until we leave a left subtree with a right sibling. */
+              while (parent && (parent->right == node || !parent->right))
+                {
+                  node = parent;
+                  parent = node->parent;
+                }
+
+              node = parent ? parent->right : NULL;
+            }
+        }
+    }
+}
+
+
 /*
  * Get all tokens from a datasource.  Return the
  * last item in the (circular) list.
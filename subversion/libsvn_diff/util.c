@@ -22,6 +22,8 @@
  */
 
 
+#include <string.h>
+
 #include <apr.h>
 #include <apr_general.h>
 
@@ -171,6 +173,19 @@ svn_diff__normalize_buffer(char **tgt,
       return;
     }
 
+  /* When only ignoring EOL styles, data without any CR is already
+     normalized unless it completes a CRLF.  memchr() is much faster
+     than the loop below. */
+  if (! opts->ignore_space
+      && state != svn_diff__normalize_state_cr
+      && memchr(buf, '\r', (apr_size_t)*lengthp) == NULL)
+    {
+      *tgt = (char *)buf;
+      if (*lengthp > 0)
+        *statep = svn_diff__normalize_state_normal;
+      return;
+    }
+
 
   /* It only took me forever to get this routine right,
      so here my thoughts go:
@@ -348,6 +363,78 @@ svn_diff__normalize_buffer(char **tgt,
 #undef COPY_INCLUDED_SECTION
 }
 
+/* Multiplier used by the token hash. */
+#define HASH_MULTIPLIER APR_UINT64_C(0x9E3779B97F4A7C15)
+
+/* Mix the 8 bytes at DATA into the hash VALUE and return the result. */
+static APR_INLINE apr_uint64_t
+hash_word(apr_uint64_t value, const char *data)
+{
+  apr_uint64_t word;
+
+  /* Compilers turn this into a single, possibly unaligned load. */
+  memcpy(&word, data, sizeof(word));
+
+  value = (value ^ word) * HASH_MULTIPLIER;
+  return value ^ (value >> 32);
+}
+
+void
+svn_diff__hash_init(svn_diff__hash_t *hash)
+{
+  hash->value = 0;
+  hash->length = 0;
+}
+
+void
+svn_diff__hash_update(svn_diff__hash_t *hash,
+                      const char *data,
+                      apr_size_t len)
+{
+  apr_size_t fill = hash->length % sizeof(hash->tail);
+  hash->length += len;
+
+  /* Complete a word left over from the previous call. */
+  if (fill)
+    {
+      apr_size_t count = sizeof(hash->tail) - fill;
+      if (count > len)
+        count = len;
+      memcpy(hash->tail + fill, data, count);
+      if (fill + count < sizeof(hash->tail))
+        return;
+
+      hash->value = hash_word(hash->value, hash->tail);
+      data += count;
+      len -= count;
+    }
+
+  for (; len >= sizeof(hash->tail); len -= sizeof(hash->tail))
+    {
+      hash->value = hash_word(hash->value, data);
+      data += sizeof(hash->tail);
+    }
+
+  memcpy(hash->tail, data, len);
+}
+
+apr_uint32_t
+svn_diff__hash_final(const svn_diff__hash_t *hash)
+{
+  apr_uint64_t value = hash->value;
+  apr_size_t fill = hash->length % sizeof(hash->tail);
+
+  if (fill)
+    {
+      char tail[sizeof(hash->tail)] = { 0 };
+      memcpy(tail, hash->tail, fill);
+      value = hash_word(value, tail);
+    }
+
+  value = (value ^ hash->length) * HASH_MULTIPLIER;
+  return (apr_uint32_t)(value >> 32);
+}
+
 svn_error_t *
 svn_diff__unified_append_no_newline_msg(svn_stringbuf_t *stringbuf,
                                         const char *header_encoding,
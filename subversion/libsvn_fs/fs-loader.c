@@ -595,15 +595,16 @@ verify_fs_warning_func(void *baton, svn_error_t *err)
 }
 
 svn_error_t *
-svn_fs_verify(const char *path,
-              apr_hash_t *fs_config,
-              svn_revnum_t start,
-              svn_revnum_t end,
-              svn_fs_progress_notify_func_t notify_func,
-              void *notify_baton,
-              svn_cancel_func_t cancel_func,
-              void *cancel_baton,
-              apr_pool_t *pool)
+svn_fs_verify2(const char *path,
+               apr_hash_t *fs_config,
+               svn_revnum_t start,
+               svn_revnum_t end,
+               int jobs,
+               svn_fs_progress_notify_func_t notify_func,
+               void *notify_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *pool)
 {
   fs_library_vtable_t *vtable;
   svn_fs_t *fs;
@@ -612,7 +613,7 @@ svn_fs_verify(const char *path,
   fs = fs_new(fs_config, pool);
   svn_fs_set_warning_func(fs, verify_fs_warning_func, NULL);
 
-  SVN_ERR(vtable->verify_fs(fs, path, start, end,
+  SVN_ERR(vtable->verify_fs(fs, path, start, end, MAX(jobs, 1),
                             notify_func, notify_baton,
                             cancel_func, cancel_baton,
                             common_pool_lock,
@@ -710,12 +711,13 @@ svn_fs_hotcopy3(const char *src_path, const char *dst_path,
 }
 
 svn_error_t *
-svn_fs_pack(const char *path,
-            svn_fs_pack_notify_t notify_func,
-            void *notify_baton,
-            svn_cancel_func_t cancel_func,
-            void *cancel_baton,
-            apr_pool_t *pool)
+svn_fs_pack2(const char *path,
+             int jobs,
+             svn_fs_pack_notify_t notify_func,
+             void *notify_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *pool)
 {
   fs_library_vtable_t *vtable;
   svn_fs_t *fs;
@@ -723,7 +725,7 @@ svn_fs_pack(const char *path,
   SVN_ERR(fs_library_vtable(&vtable, path, pool));
   fs = fs_new(NULL, pool);
 
-  SVN_ERR(vtable->pack_fs(fs, path, notify_func, notify_baton,
+  SVN_ERR(vtable->pack_fs(fs, path, MAX(jobs, 1), notify_func, notify_baton,
                           cancel_func, cancel_baton, common_pool_lock,
                           pool, common_pool));
   return SVN_NO_ERROR;
@@ -1216,6 +1218,112 @@ svn_fs_paths_changed3(svn_fs_path_change_iterator_t **iterator,
   return SVN_NO_ERROR;
 }
 
+/* FSAP data structure for iterators that filter the changes reported by
+   another iterator. */
+typedef struct filtered_iterator_data_t
+{
+  /* Iterator to read from. */
+  svn_fs_path_change_iterator_t *inner;
+
+  /* Filter criteria as in svn_fs__path_change_matches(). */
+  const char *path;
+  svn_boolean_t include_parents;
+} filtered_iterator_data_t;
+
+static svn_error_t *
+filtered_changes_iterator_get(svn_fs_path_change3_t **change,
+                              svn_fs_path_change_iterator_t *iterator)
+{
+  filtered_iterator_data_t *data = iterator->fsap_data;
+
+  do
+    SVN_ERR(svn_fs_path_change_get(change, data->inner));
+  while (*change
+         && !svn_fs__path_change_matches(data->path, data->include_parents,
+                                         (*change)->path.data));
+
+  return SVN_NO_ERROR;
+}
+
+static changes_iterator_vtable_t filtered_iterator_vtable =
+{
+  filtered_changes_iterator_get
+};
+
+svn_error_t *
+svn_fs_paths_changed_below(svn_fs_path_change_iterator_t **iterator,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           svn_boolean_t include_parents,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  svn_fs_path_change_iterator_t *result;
+  filtered_iterator_data_t *data;
+
+  path = svn_fs__canonicalize_abspath(path, result_pool);
+  if (root->vtable->report_changes_below && !SVN_FS_EMULATE_REPORT_CHANGES)
+    return svn_error_trace(root->vtable->report_changes_below(
+                             iterator, root, path, include_parents,
+                             result_pool, scratch_pool));
+
+  data = apr_pcalloc(result_pool, sizeof(*data));
+  data->path = path;
+  data->include_parents = include_parents;
+  SVN_ERR(svn_fs_paths_changed3(&data->inner, root, result_pool,
+                                scratch_pool));
+
+  result = apr_pcalloc(result_pool, sizeof(*result));
+  result->fsap_data = data;
+  result->vtable = &filtered_iterator_vtable;
+
+  *iterator = result;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_paths_changed_range(svn_fs_t *fs,
+                           svn_revnum_t start,
+                           svn_revnum_t end,
+                           svn_fs_changes_receiver_t receiver,
+                           void *receiver_baton,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  svn_revnum_t rev;
+  int step = start <= end ? 1 : -1;
+
+  if (fs->vtable->paths_changed_range && !SVN_FS_EMULATE_REPORT_CHANGES)
+    return svn_error_trace(fs->vtable->paths_changed_range(fs, start, end,
+                                                           receiver,
+                                                           receiver_baton,
+                                                           cancel_func,
+                                                           cancel_baton,
+                                                           scratch_pool));
+
+  /* Back-ends without batch support get one revision root at a time. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (rev = start; rev != end + step; rev += step)
+    {
+      svn_fs_root_t *root;
+      svn_fs_path_change_iterator_t *iterator;
+
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev, iterpool));
+      SVN_ERR(svn_fs_paths_changed3(&iterator, root, iterpool, iterpool));
+      SVN_ERR(receiver(receiver_baton, rev, iterator, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_check_path(svn_node_kind_t *kind_p, svn_fs_root_t *root,
                   const char *path, apr_pool_t *pool)
@@ -1475,6 +1583,95 @@ svn_fs_dir_optimal_order(apr_array_header_t **ordered_p,
                                                          scratch_pool));
 }
 
+svn_error_t *
+svn_fs_dir_entries_info(apr_array_header_t **entries_p,
+                        svn_fs_root_t *root,
+                        const char *path,
+                        svn_boolean_t include_props,
+                        svn_boolean_t include_checksums,
+                        svn_checksum_kind_t checksum_kind,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  apr_hash_t *entries;
+  apr_array_header_t *ordered;
+  apr_pool_t *iterpool;
+  int i;
+
+  if (root->vtable->dir_entries_info)
+    return svn_error_trace(root->vtable->dir_entries_info(entries_p, root,
+                                                          path,
+                                                          include_props,
+                                                          include_checksums,
+                                                          checksum_kind,
+                                                          result_pool,
+                                                          scratch_pool));
+
+  /* Generic fallback: query each entry individually. */
+  path = svn_fs__canonicalize_abspath(path, scratch_pool);
+  SVN_ERR(svn_fs_dir_entries(&entries, root, path, scratch_pool));
+  SVN_ERR(svn_fs_dir_optimal_order(&ordered, root, entries, scratch_pool,
+                                   scratch_pool));
+
+  *entries_p = apr_array_make(result_pool, ordered->nelts,
+                              sizeof(svn_fs_dirent_info_t *));
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < ordered->nelts; ++i)
+    {
+      svn_fs_dirent_t *dirent = APR_ARRAY_IDX(ordered, i, svn_fs_dirent_t *);
+      svn_fs_dirent_info_t *info = apr_pcalloc(result_pool, sizeof(*info));
+      const char *entry_path;
+
+      svn_pool_clear(iterpool);
+      entry_path = svn_fspath__join(path, dirent->name, iterpool);
+
+      info->name = apr_pstrdup(result_pool, dirent->name);
+      info->kind = dirent->kind;
+      SVN_ERR(svn_fs_node_created_rev(&info->created_rev, root, entry_path,
+                                      iterpool));
+      SVN_ERR(svn_fs_node_has_props(&info->has_props, root, entry_path,
+                                    iterpool));
+      if (include_props)
+        SVN_ERR(svn_fs_node_proplist(&info->props, root, entry_path,
+                                     result_pool));
+
+      if (dirent->kind == svn_node_file)
+        {
+          SVN_ERR(svn_fs_file_length(&info->size, root, entry_path,
+                                     iterpool));
+          if (include_checksums)
+            SVN_ERR(svn_fs_file_checksum(&info->checksum, checksum_kind,
+                                         root, entry_path, FALSE,
+                                         result_pool));
+        }
+      else
+        {
+          info->size = SVN_INVALID_FILESIZE;
+        }
+
+      APR_ARRAY_PUSH(*entries_p, svn_fs_dirent_info_t *) = info;
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_prefetch_tree(svn_fs_root_t *root,
+                     const char *path,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool)
+{
+  if (!root->vtable->prefetch_tree)
+    return SVN_NO_ERROR;
+
+  path = svn_fs__canonicalize_abspath(path, scratch_pool);
+  return svn_error_trace(root->vtable->prefetch_tree(root, path, cancel_func,
+                                                     cancel_baton,
+                                                     scratch_pool));
+}
+
 svn_error_t *
 svn_fs_make_dir(svn_fs_root_t *root, const char *path, apr_pool_t *pool)
 {
@@ -1564,6 +1761,28 @@ svn_fs_try_process_file_contents(svn_boolean_t *success,
                          processor, baton, pool));
 }
 
+svn_error_t *
+svn_fs_file_contents_range(apr_file_t **file,
+                           apr_off_t *offset,
+                           svn_filesize_t *length,
+                           svn_fs_root_t *root,
+                           const char *path,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool)
+{
+  if (root->vtable->file_contents_range == NULL)
+    {
+      *file = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(root->vtable->file_contents_range(file, offset,
+                                                           length,
+                                                           root, path,
+                                                           result_pool,
+                                                           scratch_pool));
+}
+
 svn_error_t *
 svn_fs_make_file(svn_fs_root_t *root, const char *path, apr_pool_t *pool)
 {
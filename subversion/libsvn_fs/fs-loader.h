@@ -104,6 +104,7 @@ typedef struct fs_library_vtable_t
   svn_error_t *(*verify_fs)(svn_fs_t *fs, const char *path,
                             svn_revnum_t start,
                             svn_revnum_t end,
+                            int jobs,
                             svn_fs_progress_notify_func_t notify_func,
                             void *notify_baton,
                             svn_cancel_func_t cancel_func,
@@ -129,7 +130,7 @@ typedef struct fs_library_vtable_t
   svn_error_t *(*recover)(svn_fs_t *fs,
                           svn_cancel_func_t cancel_func, void *cancel_baton,
                           apr_pool_t *pool);
-  svn_error_t *(*pack_fs)(svn_fs_t *fs, const char *path,
+  svn_error_t *(*pack_fs)(svn_fs_t *fs, const char *path, int jobs,
                           svn_fs_pack_notify_t notify_func, void *notify_baton,
                           svn_cancel_func_t cancel_func, void *cancel_baton,
                           svn_mutex__t *common_pool_lock,
@@ -279,6 +280,15 @@ typedef struct fs_vtable_t
                         void *cancel_baton,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool);
+  /* May be NULL, in which case revision roots will be used. */
+  svn_error_t *(*paths_changed_range)(svn_fs_t *fs,
+                                      svn_revnum_t start,
+                                      svn_revnum_t end,
+                                      svn_fs_changes_receiver_t receiver,
+                                      void *receiver_baton,
+                                      svn_cancel_func_t cancel_func,
+                                      void *cancel_baton,
+                                      apr_pool_t *scratch_pool);
 } fs_vtable_t;
 
 
@@ -440,6 +450,38 @@ typedef struct root_vtable_t
                                 svn_fs_mergeinfo_receiver_t receiver,
                                 void *baton,
                                 apr_pool_t *scratch_pool);
+  /* May be NULL, in which case file contents are never located. */
+  svn_error_t *(*file_contents_range)(apr_file_t **file,
+                                      apr_off_t *offset,
+                                      svn_filesize_t *length,
+                                      svn_fs_root_t *root,
+                                      const char *path,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool);
+  /* May be NULL, in which case the generic per-path implementation
+     is used. */
+  svn_error_t *(*dir_entries_info)(apr_array_header_t **entries_p,
+                                   svn_fs_root_t *root,
+                                   const char *path,
+                                   svn_boolean_t include_props,
+                                   svn_boolean_t include_checksums,
+                                   svn_checksum_kind_t checksum_kind,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool);
+  /* May be NULL, in which case the report_changes result gets filtered. */
+  svn_error_t *(*report_changes_below)(
+                                 svn_fs_path_change_iterator_t **iterator,
+                                 svn_fs_root_t *root,
+                                 const char *path,
+                                 svn_boolean_t include_parents,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+  /* May be NULL, in which case prefetching is a no-op. */
+  svn_error_t *(*prefetch_tree)(svn_fs_root_t *root,
+                                const char *path,
+                                svn_cancel_func_t cancel_func,
+                                void *cancel_baton,
+                                apr_pool_t *scratch_pool);
 } root_vtable_t;
 
 
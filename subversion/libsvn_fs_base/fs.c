@@ -65,6 +65,7 @@
 
 #include "../libsvn_fs/fs-loader.h"
 #include "private/svn_fs_util.h"
+#include "private/svn_subr_private.h"
 
 
 /* Checking for return values, and reporting errors.  */
@@ -163,6 +164,12 @@ cleanup_fs(svn_fs_t *fs)
   if (!bdb)
     return SVN_NO_ERROR;
 
+  /* Trails committed without syncing may still have their log records
+     in memory.  Write them out now, once, for all of them. */
+  if (!bfd->flush_to_disk && !svn_fs_bdb__get_panic(bdb))
+    SVN_ERR(BDB_WRAP(fs, N_("flushing Berkeley DB log"),
+                     bdb->env->log_flush(bdb->env, NULL)));
+
   /* Close the databases.  */
   SVN_ERR(cleanup_fs_db(fs, &bfd->nodes, "nodes"));
   SVN_ERR(cleanup_fs_db(fs, &bfd->revisions, "revisions"));
@@ -574,7 +581,8 @@ static fs_vtable_t fs_vtable = {
   base_bdb_verify_root,
   base_bdb_freeze,
   base_bdb_set_errcall,
-  NULL /* ioctl */
+  NULL /* ioctl */,
+  NULL /* paths_changed_range */
 };
 
 /* Where the format number is stored. */
@@ -599,6 +607,10 @@ open_databases(svn_fs_t *fs,
   /* Initialize the fs's path. */
   fs->path = apr_pstrdup(fs->pool, path);
 
+  bfd->flush_to_disk = !svn_hash__get_bool(fs->config,
+                                           SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
+                                           FALSE);
+
   if (create)
     SVN_ERR(bdb_write_config(fs));
 
@@ -1000,6 +1012,7 @@ static svn_error_t *
 base_verify(svn_fs_t *fs, const char *path,
             svn_revnum_t start,
             svn_revnum_t end,
+            int jobs,
             svn_fs_progress_notify_func_t notify_func,
             void *notify_baton,
             svn_cancel_func_t cancel_func,
@@ -1025,6 +1038,7 @@ base_bdb_recover(svn_fs_t *fs,
 static svn_error_t *
 base_bdb_pack(svn_fs_t *fs,
               const char *path,
+              int jobs,
               svn_fs_pack_notify_t notify_func,
               void *notify_baton,
               svn_cancel_func_t cancel,
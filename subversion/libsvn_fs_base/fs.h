@@ -112,6 +112,11 @@ typedef struct base_fs_data_t
      transaction trail alive. */
   svn_boolean_t in_txn_trail;
 
+  /* Whether committing a trail waits for its log records to reach the
+     disk.  Cleared by SVN_FS_CONFIG_NO_FLUSH_TO_DISK; the log is then
+     flushed once when the filesystem is closed. */
+  svn_boolean_t flush_to_disk;
+
   /* The format number of this FS. */
   int format;
 
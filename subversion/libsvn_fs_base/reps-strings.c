@@ -25,6 +25,8 @@
 #include "svn_fs.h"
 #include "svn_pools.h"
 
+#include "private/svn_delta_private.h"
+
 #include "fs.h"
 #include "err.h"
 #include "trail.h"
@@ -157,8 +159,13 @@ delete_strings(const apr_array_header_t *keys,
 
 struct compose_handler_baton
 {
-  /* The combined window, and the pool it's allocated from. */
+  /* The combined window, owned by COMPOSER. */
   svn_txdelta_window_t *window;
+
+  /* Folds the incoming windows into WINDOW. */
+  svn_txdelta__composer_t *composer;
+
+  /* Pool for buffers needed to expand WINDOW. */
   apr_pool_t *window_pool;
 
   /* If the incoming window was self-compressed, and the combined WINDOW
@@ -218,25 +225,19 @@ compose_handler(svn_txdelta_window_t *window, void *baton)
       else
         {
           /* Combine the incoming window with whatever's in the baton. */
-          apr_pool_t *composite_pool = svn_pool_create(cb->trail->pool);
-          svn_txdelta_window_t *composite;
-
-          composite = svn_txdelta_compose_windows(window, cb->window,
-                                                  composite_pool);
-          svn_pool_destroy(cb->window_pool);
-          cb->window = composite;
-          cb->window_pool = composite_pool;
-          cb->done = (composite->sview_len == 0 || composite->src_ops == 0);
+          svn_txdelta__composer_add(cb->composer, window);
+          cb->window = svn_txdelta__composer_get(cb->composer);
+          cb->done = svn_txdelta__composer_done(cb->composer);
         }
     }
   else if (window)
     {
       /* Copy the (first) window into the baton. */
-      apr_pool_t *window_pool = svn_pool_create(cb->trail->pool);
       SVN_ERR_ASSERT(cb->window_pool == NULL);
-      cb->window = svn_txdelta_window_dup(window, window_pool);
-      cb->window_pool = window_pool;
-      cb->done = (window->sview_len == 0 || window->src_ops == 0);
+      cb->window_pool = svn_pool_create(cb->trail->pool);
+      svn_txdelta__composer_add(cb->composer, window);
+      cb->window = svn_txdelta__composer_get(cb->composer);
+      cb->done = svn_txdelta__composer_done(cb->composer);
     }
   else
     cb->done = TRUE;
@@ -333,6 +334,7 @@ rep_undeltify_range(svn_fs_t *fs,
                     apr_pool_t *pool)
 {
   apr_size_t len_read = 0;
+  svn_txdelta__composer_t *composer = svn_txdelta__composer_create(pool);
 
   do
     {
@@ -342,6 +344,7 @@ rep_undeltify_range(svn_fs_t *fs,
       int cur_rep;
 
       cb.trail = trail;
+      cb.composer = composer;
       cb.done = FALSE;
       for (cur_rep = 0; !cb.done && cur_rep < deltas->nelts; ++cur_rep)
         {
@@ -406,6 +409,7 @@ rep_undeltify_range(svn_fs_t *fs,
         }
       /* Don't need this window any more. */
       svn_pool_destroy(cb.window_pool);
+      svn_txdelta__composer_reset(composer);
 
       len_read += target_len;
       buf += target_len;
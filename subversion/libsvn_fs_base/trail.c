@@ -156,7 +156,14 @@ commit_trail(trail_t *trail)
          An error during txn commit will abort the transaction anyway. */
       bfd->in_txn_trail = FALSE;
       SVN_ERR(BDB_WRAP(fs, N_("committing Berkeley DB transaction"),
-                       trail->db_txn->commit(trail->db_txn, 0)));
+                       trail->db_txn->commit(trail->db_txn,
+                                             bfd->flush_to_disk
+                                               ? 0 : DB_TXN_NOSYNC)));
+    }
+  else
+    {
+      /* Nothing has been written, so there is nothing to checkpoint. */
+      return SVN_NO_ERROR;
     }
 
   /* Do a checkpoint here, if enough has gone on.
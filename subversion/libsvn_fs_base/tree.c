@@ -5542,6 +5542,7 @@ static root_vtable_t root_vtable = {
   base_get_file_delta_stream,
   base_merge,
   base_get_mergeinfo,
+  NULL,
 };
 
 
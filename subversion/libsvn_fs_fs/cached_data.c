@@ -28,6 +28,7 @@
 #include "svn_ctype.h"
 #include "svn_sorts.h"
 #include "private/svn_delta_private.h"
+#include "private/svn_fs_util.h"
 #include "private/svn_io_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_subr_private.h"
@@ -194,16 +195,22 @@ dbg_log_access(svn_fs_t *fs,
 }
 
 /* Convenience wrapper around svn_io_file_aligned_seek, taking filesystem
-   FS instead of a block size. */
+   FS instead of a block size.  Seek in REV_FILE and record in its I/O
+   trace that LEN bytes (0 if not known) will be read for CAUSE. */
 static svn_error_t *
 aligned_seek(svn_fs_t *fs,
-             apr_file_t *file,
+             svn_fs_fs__revision_file_t *rev_file,
              apr_off_t *buffer_start,
              apr_off_t offset,
+             svn_fs_fs__io_cause_t cause,
+             apr_size_t len,
              apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
-  return svn_error_trace(svn_io_file_aligned_seek(file, ffd->block_size,
+
+  svn_fs_fs__trace_read(rev_file, cause, offset, len);
+  return svn_error_trace(svn_io_file_aligned_seek(rev_file->file,
+                                                  ffd->block_size,
                                                   buffer_start, offset,
                                                   pool));
 }
@@ -227,7 +234,8 @@ open_and_seek_revision(svn_fs_fs__revision_file_t **file,
   SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rev_file, rev, NULL, item,
                                  pool));
 
-  SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset, pool));
+  SVN_ERR(aligned_seek(fs, rev_file, NULL, offset, svn_fs_fs__io_rep, 0,
+                       pool));
 
   *file = rev_file;
 
@@ -249,7 +257,7 @@ open_and_seek_transaction(svn_fs_fs__revision_file_t **file,
 
   SVN_ERR(svn_fs_fs__item_offset(&offset, fs, NULL, SVN_INVALID_REVNUM,
                                  &rep->txn_id, rep->item_index, pool));
-  SVN_ERR(aligned_seek(fs, (*file)->file, NULL, offset, pool));
+  SVN_ERR(aligned_seek(fs, *file, NULL, offset, svn_fs_fs__io_rep, 0, pool));
 
   return SVN_NO_ERROR;
 }
@@ -504,6 +512,77 @@ get_node_revision_body(node_revision_t **noderev_p,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__try_get_noderev_scalars(svn_boolean_t *found,
+                                   svn_fs_fs__noderev_scalars_t *scalars,
+                                   svn_fs_t *fs,
+                                   const svn_fs_id_t *id,
+                                   apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const svn_fs_fs__id_part_t *rev_item;
+  pair_cache_key_t key = { 0 };
+  void *dummy;
+
+  if (!ffd->node_revision_cache || svn_fs_fs__id_is_txn(id))
+    {
+      *found = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  rev_item = svn_fs_fs__id_rev_item(id);
+  key.revision = rev_item->revision;
+  key.second = rev_item->number;
+
+  /* The getter returns SCALARS itself and allocates nothing. */
+  SVN_ERR(svn_cache__get_partial(&dummy, found, ffd->node_revision_cache,
+                                 &key, svn_fs_fs__extract_noderev_scalars,
+                                 scalars, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__get_rep_keys(representation_t **prop_rep,
+                        representation_t **data_rep,
+                        svn_fs_t *fs,
+                        const svn_fs_id_t *id,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  node_revision_t *noderev;
+
+  if (ffd->node_revision_cache && !svn_fs_fs__id_is_txn(id))
+    {
+      const svn_fs_fs__id_part_t *rev_item = svn_fs_fs__id_rev_item(id);
+      svn_fs_fs__rep_keys_t *keys;
+      svn_boolean_t is_cached;
+      pair_cache_key_t key = { 0 };
+      key.revision = rev_item->revision;
+      key.second = rev_item->number;
+
+      SVN_ERR(svn_cache__get_partial((void **)&keys, &is_cached,
+                                     ffd->node_revision_cache, &key,
+                                     svn_fs_fs__extract_rep_keys, NULL,
+                                     result_pool));
+      if (is_cached)
+        {
+          *prop_rep = keys->prop_rep;
+          *data_rep = keys->data_rep;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  /* Not cached.  Reading it will put it into the cache. */
+  SVN_ERR(svn_fs_fs__get_node_revision(&noderev, fs, id, result_pool,
+                                       scratch_pool));
+  *prop_rep = noderev->prop_rep;
+  *data_rep = noderev->data_rep;
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__get_node_revision(node_revision_t **noderev_p,
                              svn_fs_t *fs,
@@ -547,7 +626,8 @@ get_fs_id_at_offset(svn_fs_id_t **id_p,
 {
   node_revision_t *noderev;
 
-  SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset, pool));
+  SVN_ERR(aligned_seek(fs, rev_file, NULL, offset, svn_fs_fs__io_noderev, 0,
+                       pool));
   SVN_ERR(svn_fs_fs__read_noderev(&noderev,
                                   rev_file->stream,
                                   pool, pool));
@@ -630,7 +710,8 @@ get_root_changes_offset(apr_off_t *root_offset,
     }
 
   /* Read in this last block, from which we will identify the last line. */
-  SVN_ERR(aligned_seek(fs, rev_file->file, NULL, start, pool));
+  SVN_ERR(aligned_seek(fs, rev_file, NULL, start, svn_fs_fs__io_footer, len,
+                       pool));
   SVN_ERR(svn_io_file_read_full2(rev_file->file, buffer, len, NULL, NULL,
                                  pool));
 
@@ -757,14 +838,19 @@ get_file_offset(apr_off_t *offset,
                                                 pool));
 }
 
-/* Simple wrapper around svn_io_file_aligned_seek to simplify callers. */
+/* Simple wrapper around svn_io_file_aligned_seek to simplify callers.
+   LEN is the number of bytes to read from OFFSET, 0 if not known; it
+   is only used for I/O tracing. */
 static svn_error_t *
 rs_aligned_seek(rep_state_t *rs,
                 apr_off_t *buffer_start,
                 apr_off_t offset,
+                apr_size_t len,
                 apr_pool_t *pool)
 {
   fs_fs_data_t *ffd = rs->sfile->fs->fsap_data;
+
+  svn_fs_fs__trace_read(rs->sfile->rfile, svn_fs_fs__io_rep, offset, len);
   return svn_error_trace(svn_io_file_aligned_seek(rs->sfile->rfile->file,
                                                   ffd->block_size,
                                                   buffer_start, offset,
@@ -808,7 +894,7 @@ auto_read_diff_version(rep_state_t *rs, apr_pool_t *pool)
   if (rs->ver == -1)
     {
       char buf[4];
-      SVN_ERR(rs_aligned_seek(rs, NULL, rs->start, pool));
+      SVN_ERR(rs_aligned_seek(rs, NULL, rs->start, sizeof(buf), pool));
       SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
                                      sizeof(buf), NULL, NULL, pool));
 
@@ -928,7 +1014,7 @@ create_rep_state_body(rep_state_t **rep_state,
           SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rs->sfile->rfile,
                                          rep->revision, NULL, rep->item_index,
                                          scratch_pool));
-          SVN_ERR(rs_aligned_seek(rs, NULL, offset, scratch_pool));
+          SVN_ERR(rs_aligned_seek(rs, NULL, offset, 0, scratch_pool));
         }
       else
         {
@@ -1595,7 +1681,7 @@ read_delta_window(svn_txdelta_window_t **nwin, int this_chunk,
   /* RS->FILE may be shared between RS instances -> make sure we point
    * to the right data. */
   start_offset = rs->start + rs->current;
-  SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, scratch_pool));
+  SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, 0, scratch_pool));
 
   /* Skip windows to reach the current chunk if we aren't there yet. */
   iterpool = svn_pool_create(scratch_pool);
@@ -1647,7 +1733,7 @@ read_plain_window(svn_stringbuf_t **nwin, rep_state_t *rs,
   SVN_ERR(auto_set_start_offset(rs, scratch_pool));
 
   offset = rs->start + rs->current;
-  SVN_ERR(rs_aligned_seek(rs, NULL, offset, scratch_pool));
+  SVN_ERR(rs_aligned_seek(rs, NULL, offset, size, scratch_pool));
 
   /* Read the plain data. */
   *nwin = svn_stringbuf_create_ensure(size, result_pool);
@@ -1839,7 +1925,7 @@ get_contents_from_windows(struct rep_read_baton *rb,
           SVN_ERR(auto_set_start_offset(rs, rb->pool));
 
           offset = rs->start + rs->current;
-          SVN_ERR(rs_aligned_seek(rs, NULL, offset, rb->pool));
+          SVN_ERR(rs_aligned_seek(rs, NULL, offset, copy_len, rb->pool));
           SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, cur,
                                          copy_len, NULL, NULL, rb->pool));
         }
@@ -2296,7 +2382,8 @@ svn_fs_fs__get_contents_from_file(svn_stream_t **contents_p,
   rs->sfile->rfile->stream = svn_stream_from_aprfile2(file, TRUE, pool);
 
   /* Read the rep header. */
-  SVN_ERR(aligned_seek(fs, file, NULL, offset, pool));
+  SVN_ERR(aligned_seek(fs, rs->sfile->rfile, NULL, offset, svn_fs_fs__io_rep,
+                       0, pool));
   SVN_ERR(svn_fs_fs__read_rep_header(&rh, rs->sfile->rfile->stream,
                                      pool, pool));
   SVN_ERR(get_file_offset(&rs->start, rs, pool));
@@ -2418,6 +2505,45 @@ svn_fs_fs__try_process_file_contents(svn_boolean_t *success,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__get_contents_range(apr_file_t **file,
+                              apr_off_t *offset,
+                              svn_filesize_t *length,
+                              svn_fs_t *fs,
+                              representation_t *rep,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  svn_fs_fs__revision_file_t *rev_file;
+  svn_fs_fs__rep_header_t *rh;
+  apr_off_t item_offset;
+
+  *file = NULL;
+
+  /* Empty files and the contents of proto-rev files don't qualify. */
+  if (!rep || svn_fs_fs__id_txn_used(&rep->txn_id))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_fs__ensure_revision_exists(rep->revision, fs,
+                                            scratch_pool));
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&rev_file, fs, rep->revision,
+                                           result_pool, scratch_pool));
+  SVN_ERR(svn_fs_fs__item_offset(&item_offset, fs, rev_file, rep->revision,
+                                 NULL, rep->item_index, scratch_pool));
+  SVN_ERR(aligned_seek(fs, rev_file, NULL, item_offset, svn_fs_fs__io_rep, 0,
+                       scratch_pool));
+  SVN_ERR(svn_fs_fs__read_rep_header(&rh, rev_file->stream,
+                                     scratch_pool, scratch_pool));
+
+  if (rh->type != svn_fs_fs__rep_plain)
+    return svn_error_trace(svn_fs_fs__close_revision_file(rev_file));
+
+  *file = rev_file->file;
+  *offset = item_offset + rh->header_size;
+  *length = rep->size;
+
+  return SVN_NO_ERROR;
+}
 
 /* Baton used when reading delta windows. */
 struct delta_read_baton
@@ -2834,6 +2960,211 @@ locate_dir_cache(svn_fs_t *fs,
     }
 }
 
+/* Directories with at least this many entries that don't fit into the
+ * directory caches get indexed by the FS instance.  See large_dir_t.
+ */
+#define LARGE_DIR_MIN_ENTRIES 1000
+
+/* Name-indexed contents of a directory that is too large for the
+ * directory caches.  Each FS instance keeps the one used most recently,
+ * such that repeated single-entry lookups and in-txn modifications of
+ * that directory don't have to read and parse it again, each time.
+ */
+struct svn_fs_fs__large_dir_t
+{
+  /* Identifies the directory.  See large_dir_key(). */
+  const char *key;
+
+  /* Size of the in-txn children file that ENTRIES corresponds to.
+     SVN_INVALID_FILESIZE for committed directories. */
+  svn_filesize_t txn_filesize;
+
+  /* Maps const char * entry names to svn_fs_dirent_t *. */
+  apr_hash_t *entries;
+
+  /* Pool containing this structure and all of its contents. */
+  apr_pool_t *pool;
+};
+
+/* Return the key that identifies directory NODEREV in a
+ * svn_fs_fs__large_dir_t, allocated in RESULT_POOL.  Return NULL for
+ * empty directories.
+ */
+static const char *
+large_dir_key(node_revision_t *noderev,
+              apr_pool_t *result_pool)
+{
+  if (!noderev->data_rep)
+    return NULL;
+
+  if (svn_fs_fs__id_txn_used(&noderev->data_rep->txn_id))
+    return svn_fs_fs__id_unparse(noderev->id, result_pool)->data;
+
+  return apr_psprintf(result_pool, "%ld/%" APR_UINT64_T_FMT,
+                      noderev->data_rep->revision,
+                      noderev->data_rep->item_index);
+}
+
+/* Return a rough estimate of the serialized size of a directory with
+ * NELTS entries in CACHE of FS.  Committed directories are stored in a
+ * packed format that needs about 50 bytes per entry, while in-txn ones
+ * take about 150 bytes per entry. */
+static apr_size_t
+estimated_dir_size(svn_fs_t *fs,
+                   svn_cache__t *cache,
+                   int nelts)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  return (cache == ffd->dir_cache ? 50 : 150) * (apr_size_t)nelts;
+}
+
+/* Return TRUE if a directory with NELTS entries is too large for CACHE
+ * of FS but still worth indexing. */
+static svn_boolean_t
+is_large_dir(svn_fs_t *fs,
+             svn_cache__t *cache,
+             int nelts)
+{
+  return nelts >= LARGE_DIR_MIN_ENTRIES
+      && !(cache && svn_cache__is_cachable(cache,
+                                           estimated_dir_size(fs, cache,
+                                                              nelts)));
+}
+
+/* Return the large directory index of FS if it describes the directory
+ * NODEREV with its in-txn children file being TXN_FILESIZE bytes in size.
+ * Otherwise, return NULL.  Use SCRATCH_POOL for temporary allocations.
+ */
+static struct svn_fs_fs__large_dir_t *
+get_large_dir(svn_fs_t *fs,
+              node_revision_t *noderev,
+              svn_filesize_t txn_filesize,
+              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *key;
+
+  if (!ffd->large_dir || ffd->large_dir->txn_filesize != txn_filesize)
+    return NULL;
+
+  key = large_dir_key(noderev, scratch_pool);
+  if (!key || strcmp(key, ffd->large_dir->key))
+    return NULL;
+
+  return ffd->large_dir;
+}
+
+/* Return a copy of ENTRY allocated in RESULT_POOL.  ENTRY may be NULL. */
+static svn_fs_dirent_t *
+copy_dir_entry(const svn_fs_dirent_t *entry,
+               apr_pool_t *result_pool)
+{
+  svn_fs_dirent_t *entry_copy;
+
+  if (!entry)
+    return NULL;
+
+  entry_copy = apr_palloc(result_pool, sizeof(*entry_copy));
+  entry_copy->name = apr_pstrdup(result_pool, entry->name);
+  entry_copy->id = svn_fs_fs__id_copy(entry->id, result_pool);
+  entry_copy->kind = entry->kind;
+
+  return entry_copy;
+}
+
+/* Replace the large directory index of FS with ENTRIES of directory
+ * NODEREV with its in-txn children file being TXN_FILESIZE bytes in size.
+ * ENTRIES must be allocated in POOL, which is a sub-pool of FS->POOL and
+ * becomes owned by the index.
+ */
+static void
+set_large_dir(svn_fs_t *fs,
+              node_revision_t *noderev,
+              apr_array_header_t *entries,
+              svn_filesize_t txn_filesize,
+              apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  struct svn_fs_fs__large_dir_t *large_dir
+    = apr_pcalloc(pool, sizeof(*large_dir));
+  int i;
+
+  large_dir->key = large_dir_key(noderev, pool);
+  large_dir->txn_filesize = txn_filesize;
+  large_dir->entries = svn_hash__make(pool);
+  large_dir->pool = pool;
+
+  for (i = 0; i < entries->nelts; ++i)
+    {
+      svn_fs_dirent_t *dirent = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
+      svn_hash_sets(large_dir->entries, dirent->name, dirent);
+    }
+
+  if (ffd->large_dir)
+    svn_pool_destroy(ffd->large_dir->pool);
+  ffd->large_dir = large_dir;
+}
+
+void
+svn_fs_fs__large_dir_set(svn_fs_t *fs,
+                         node_revision_t *noderev,
+                         apr_array_header_t *entries,
+                         svn_filesize_t txn_filesize)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_array_header_t *entries_copy;
+  apr_pool_t *pool;
+  int i;
+
+  if (!is_large_dir(fs, ffd->txn_dir_cache, entries->nelts))
+    return;
+
+  pool = svn_pool_create(fs->pool);
+  entries_copy = apr_array_make(pool, entries->nelts,
+                                sizeof(svn_fs_dirent_t *));
+  for (i = 0; i < entries->nelts; ++i)
+    APR_ARRAY_PUSH(entries_copy, svn_fs_dirent_t *)
+      = copy_dir_entry(APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *), pool);
+
+  set_large_dir(fs, noderev, entries_copy, txn_filesize, pool);
+}
+
+void
+svn_fs_fs__large_dir_set_entry(svn_fs_t *fs,
+                               node_revision_t *parent_noderev,
+                               const char *name,
+                               const svn_fs_id_t *id,
+                               svn_node_kind_t kind,
+                               svn_filesize_t old_filesize,
+                               svn_filesize_t new_filesize,
+                               apr_pool_t *scratch_pool)
+{
+  struct svn_fs_fs__large_dir_t *large_dir
+    = get_large_dir(fs, parent_noderev, old_filesize, scratch_pool);
+
+  /* Indexes of older states of this directory will simply never match
+     again. */
+  if (!large_dir)
+    return;
+
+  if (id)
+    {
+      svn_fs_dirent_t *dirent = apr_palloc(large_dir->pool, sizeof(*dirent));
+      dirent->name = apr_pstrdup(large_dir->pool, name);
+      dirent->id = svn_fs_fs__id_copy(id, large_dir->pool);
+      dirent->kind = kind;
+
+      svn_hash_sets(large_dir->entries, dirent->name, dirent);
+    }
+  else
+    {
+      svn_hash_sets(large_dir->entries, name, NULL);
+    }
+
+  large_dir->txn_filesize = new_filesize;
+}
+
 svn_error_t *
 svn_fs_fs__rep_contents_dir(apr_array_header_t **entries_p,
                             svn_fs_t *fs,
@@ -2878,9 +3209,11 @@ svn_fs_fs__rep_contents_dir(apr_array_header_t **entries_p,
   /* Update the cache, if we are to use one.
    *
    * Don't even attempt to serialize very large directories; it would cause
-   * an unnecessary memory allocation peak.  150 bytes/entry is about right.
+   * an unnecessary memory allocation peak.
    */
-  if (cache && svn_cache__is_cachable(cache, 150 * dir->entries->nelts))
+  if (cache && svn_cache__is_cachable(cache,
+                                      estimated_dir_size(fs, cache,
+                                                         dir->entries->nelts)))
     SVN_ERR(svn_cache__set(cache, key, dir, scratch_pool));
 
   return SVN_NO_ERROR;
@@ -2906,17 +3239,28 @@ svn_fs_fs__rep_contents_dir_entry(svn_fs_dirent_t **dirent,
 {
   extract_dir_entry_baton_t baton;
   svn_boolean_t found = FALSE;
+  svn_filesize_t filesize;
+  struct svn_fs_fs__large_dir_t *large_dir;
 
   /* find the cache we may use */
   pair_cache_key_t pair_key = { 0 };
   const void *key;
   svn_cache__t *cache = locate_dir_cache(fs, &key, &pair_key, noderev,
                                          scratch_pool);
-  if (cache)
+
+  SVN_ERR(get_txn_dir_info(&filesize, fs, noderev, scratch_pool));
+
+  /* Directories too large for the cache may have been indexed. */
+  large_dir = get_large_dir(fs, noderev, filesize, scratch_pool);
+  if (large_dir)
     {
-      svn_filesize_t filesize;
-      SVN_ERR(get_txn_dir_info(&filesize, fs, noderev, scratch_pool));
+      *dirent = copy_dir_entry(svn_hash_gets(large_dir->entries, name),
+                               result_pool);
+      return SVN_NO_ERROR;
+    }
 
+  if (cache)
+    {
       /* Cache lookup. */
       baton.txn_filesize = filesize;
       baton.name = name;
@@ -2932,33 +3276,37 @@ svn_fs_fs__rep_contents_dir_entry(svn_fs_dirent_t **dirent,
   /* fetch data from disk if we did not find it in the cache */
   if (! found || baton.out_of_date)
     {
-      svn_fs_dirent_t *entry;
-      svn_fs_dirent_t *entry_copy = NULL;
       svn_fs_fs__dir_data_t dir;
+      apr_pool_t *dir_pool = svn_pool_create(fs->pool);
 
       /* Read in the directory contents. */
-      SVN_ERR(get_dir_contents(&dir, fs, noderev, scratch_pool,
-                               scratch_pool));
+      SVN_ERR(get_dir_contents(&dir, fs, noderev, dir_pool, scratch_pool));
+
+      /* find desired entry and return a copy in POOL, if found */
+      *dirent = copy_dir_entry(svn_fs_fs__find_dir_entry(dir.entries, name,
+                                                         NULL),
+                               result_pool);
 
       /* Update the cache, if we are to use one.
        *
        * Don't even attempt to serialize very large directories; it would
-       * cause an unnecessary memory allocation peak.  150 bytes / entry is
-       * about right. */
-      if (cache && svn_cache__is_cachable(cache, 150 * dir.entries->nelts))
-        SVN_ERR(svn_cache__set(cache, key, &dir, scratch_pool));
-
-      /* find desired entry and return a copy in POOL, if found */
-      entry = svn_fs_fs__find_dir_entry(dir.entries, name, NULL);
-      if (entry)
+       * cause an unnecessary memory allocation peak.  Keep an index of
+       * those instead. */
+      if (is_large_dir(fs, cache, dir.entries->nelts))
         {
-          entry_copy = apr_palloc(result_pool, sizeof(*entry_copy));
-          entry_copy->name = apr_pstrdup(result_pool, entry->name);
-          entry_copy->id = svn_fs_fs__id_copy(entry->id, result_pool);
-          entry_copy->kind = entry->kind;
+          set_large_dir(fs, noderev, dir.entries, dir.txn_filesize,
+                        dir_pool);
         }
+      else
+        {
+          if (cache && svn_cache__is_cachable(cache,
+                                              estimated_dir_size(
+                                                fs, cache,
+                                                dir.entries->nelts)))
+            SVN_ERR(svn_cache__set(cache, key, &dir, scratch_pool));
 
-      *dirent = entry_copy;
+          svn_pool_destroy(dir_pool);
+        }
     }
 
   return SVN_NO_ERROR;
@@ -3056,6 +3404,72 @@ svn_fs_fs__create_changes_context(svn_fs_fs__changes_context_t **context,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__reset_changes_context(svn_fs_fs__changes_context_t *context,
+                                 svn_revnum_t rev,
+                                 apr_pool_t *rev_file_pool)
+{
+  svn_fs_fs__revision_file_t *file = context->revision_file;
+
+  if (   file
+      && !(   file->is_packed
+           && svn_fs_fs__packed_base_rev(context->fs, rev)
+                == file->start_revision))
+    {
+      SVN_ERR(svn_fs_fs__close_revision_file(file));
+      context->revision_file = NULL;
+      svn_pool_clear(rev_file_pool);
+    }
+
+  context->revision = rev;
+  context->rev_file_pool = rev_file_pool;
+  context->next = 0;
+  context->next_offset = 0;
+  context->eol = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Look up the block of changes for KEY in the changes cache of CONTEXT's
+ * filesystem and return it in *CHANGES_LIST, allocated in RESULT_POOL.
+ * Only return changes that pass CONTEXT's filter.  Set *FOUND to TRUE,
+ * if the block was cached and set *TOTAL_COUNT to the number of changes
+ * in the block before filtering.
+ */
+static svn_error_t *
+get_cached_changes(svn_fs_fs__changes_list_t **changes_list,
+                   int *total_count,
+                   svn_boolean_t *found,
+                   svn_fs_fs__changes_context_t *context,
+                   const pair_cache_key_t *key,
+                   apr_pool_t *result_pool)
+{
+  fs_fs_data_t *ffd = context->fs->fsap_data;
+
+  if (context->filter_path)
+    {
+      svn_fs_fs__extract_changes_baton_t baton;
+      baton.path = context->filter_path;
+      baton.include_parents = context->filter_parents;
+      baton.total_count = 0;
+
+      SVN_ERR(svn_cache__get_partial((void **)changes_list, found,
+                                     ffd->changes_cache, key,
+                                     svn_fs_fs__extract_changes, &baton,
+                                     result_pool));
+      *total_count = baton.total_count;
+    }
+  else
+    {
+      SVN_ERR(svn_cache__get((void **)changes_list, found,
+                             ffd->changes_cache, key, result_pool));
+      if (*found)
+        *total_count = (*changes_list)->count;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_fs__get_changes(apr_array_header_t **changes,
                        svn_fs_fs__changes_context_t *context,
@@ -3066,6 +3480,7 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
   svn_boolean_t found;
   fs_fs_data_t *ffd = context->fs->fsap_data;
   svn_fs_fs__changes_list_t *changes_list;
+  int total_count = 0;
 
   pair_cache_key_t key;
   key.revision = context->revision;
@@ -3075,8 +3490,8 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
 
   if (ffd->changes_cache)
     {
-      SVN_ERR(svn_cache__get((void **)&changes_list, &found,
-                             ffd->changes_cache, &key, result_pool));
+      SVN_ERR(get_cached_changes(&changes_list, &total_count, &found,
+                                 context, &key, result_pool));
     }
   else
     {
@@ -3111,8 +3526,8 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
                              scratch_pool));
 
           /* This may succeed now ... */
-          SVN_ERR(svn_cache__get((void **)&changes_list, &found,
-                                 ffd->changes_cache, &key, result_pool));
+          SVN_ERR(get_cached_changes(&changes_list, &total_count, &found,
+                                     context, &key, result_pool));
         }
 
       /* If we still have no data, read it here. */
@@ -3142,9 +3557,9 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
             }
 
           /* Actual reading and parsing are the same, though. */
-          SVN_ERR(aligned_seek(context->fs, context->revision_file->file,
+          SVN_ERR(aligned_seek(context->fs, context->revision_file,
                                NULL, changes_offset + context->next_offset,
-                               scratch_pool));
+                               svn_fs_fs__io_changes, 0, scratch_pool));
 
           SVN_ERR(svn_fs_fs__read_changes(changes,
                                           context->revision_file->stream,
@@ -3167,6 +3582,23 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
           if (ffd->changes_cache)
             SVN_ERR(svn_cache__set(ffd->changes_cache, &key, changes_list,
                                    scratch_pool));
+
+          /* The cache needs the full block but the caller may not. */
+          total_count = (*changes)->nelts;
+          if (context->filter_path)
+            {
+              int i, count = 0;
+              for (i = 0; i < total_count; ++i)
+                {
+                  change_t *change = APR_ARRAY_IDX(*changes, i, change_t *);
+                  if (svn_fs__path_change_matches(context->filter_path,
+                                                  context->filter_parents,
+                                                  change->path.data))
+                    APR_ARRAY_IDX(*changes, count++, change_t *) = change;
+                }
+
+              (*changes)->nelts = count;
+            }
         }
     }
 
@@ -3180,7 +3612,7 @@ svn_fs_fs__get_changes(apr_array_header_t **changes,
     }
 
   /* Where to look next - if there is more data. */
-  context->next += (*changes)->nelts;
+  context->next += total_count;
   context->next_offset = changes_list->end_offset;
   context->eol = changes_list->eol;
 
@@ -3330,14 +3762,15 @@ cache_windows(svn_fs_t *fs,
           char *buf;
 
           /* navigate to the current window */
-          SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
+          SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, 0, iterpool));
           SVN_ERR(svn_txdelta__read_raw_window_len(&window_len,
                                                    rs->sfile->rfile->stream,
                                                    iterpool));
 
           /* Read the raw window. */
           buf = apr_palloc(iterpool, window_len + 1);
-          SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, iterpool));
+          SVN_ERR(rs_aligned_seek(rs, NULL, start_offset, window_len,
+                                  iterpool));
           SVN_ERR(svn_io_file_read_full2(rs->sfile->rfile->file, buf,
                                          window_len, NULL, NULL, iterpool));
           buf[window_len] = 0;
@@ -3415,7 +3848,8 @@ block_read_windows(svn_fs_fs__rep_header_t *rep_header,
       /* for larger reps, the header may have crossed a block boundary.
        * make sure we still read blocks properly aligned, i.e. don't use
        * plain seek here. */
-      SVN_ERR(aligned_seek(fs, rev_file->file, NULL, offset, scratch_pool));
+      SVN_ERR(aligned_seek(fs, rev_file, NULL, offset, svn_fs_fs__io_rep,
+                           (apr_size_t)rs.size, scratch_pool));
 
       plaintext = svn_stringbuf_create_ensure(rs.size, result_pool);
       SVN_ERR(svn_io_file_read_full2(rev_file->file, plaintext->data,
@@ -3511,15 +3945,33 @@ read_item(svn_stream_t **stream,
   svn_checksum_t *expected, *actual;
   apr_uint32_t plain_digest;
 
-  /* Read item into string buffer. */
-  svn_stringbuf_t *text = svn_stringbuf_create_ensure(entry->size, pool);
-  text->len = entry->size;
-  text->data[text->len] = 0;
-  SVN_ERR(svn_io_file_read_full2(rev_file->file, text->data, text->len,
-                                 NULL, NULL, pool));
+  svn_string_t *text = apr_palloc(pool, sizeof(*text));
+  const char *mapped_data
+    = svn_fs_fs__rev_file_mapped_data(rev_file, entry->offset,
+                                      (apr_size_t)entry->size);
+
+  /* Read item into string buffer - unless we can use the mapped data
+   * directly. */
+  if (mapped_data)
+    {
+      text->data = mapped_data;
+      text->len = (apr_size_t)entry->size;
+    }
+  else
+    {
+      svn_stringbuf_t *buffer
+        = svn_stringbuf_create_ensure(entry->size, pool);
+      buffer->len = entry->size;
+      buffer->data[buffer->len] = 0;
+      SVN_ERR(svn_io_file_read_full2(rev_file->file, buffer->data,
+                                     buffer->len, NULL, NULL, pool));
+
+      text->data = buffer->data;
+      text->len = buffer->len;
+    }
 
   /* Return (construct, calculate) stream and checksum. */
-  *stream = svn_stream_from_stringbuf(text, pool);
+  *stream = svn_stream_from_string(text, pool);
   digest = svn__fnv1a_32x4(text->data, text->len);
 
   /* Checksums will match most of the time. */
@@ -3718,7 +4170,8 @@ block_read(void **result,
                                           ffd->block_size, scratch_pool,
                                           scratch_pool));
 
-      SVN_ERR(aligned_seek(fs, revision_file->file, &block_start, offset,
+      SVN_ERR(aligned_seek(fs, revision_file, &block_start, offset,
+                           svn_fs_fs__io_block, (apr_size_t)ffd->block_size,
                            iterpool));
 
       /* read all items from the block */
@@ -51,6 +51,30 @@ svn_fs_fs__get_node_revision(node_revision_t **noderev_p,
                              apr_pool_t *result_pool,
                              apr_pool_t *scratch_pool);
 
+/* Set *PROP_REP and *DATA_REP to the property and contents
+   representations of the node-revision ID in FS, or to NULL if it has
+   none.  If the node-revision is cached, copy only these two out of the
+   cache instead of the whole node-revision.  Allocate the result in
+   RESULT_POOL and use SCRATCH_POOL for temporaries. */
+svn_error_t *
+svn_fs_fs__get_rep_keys(representation_t **prop_rep,
+                        representation_t **data_rep,
+                        svn_fs_t *fs,
+                        const svn_fs_id_t *id,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool);
+
+/* If the committed node-revision ID in FS is in the node revision cache,
+   fill *SCALARS from it and set *FOUND to TRUE.  Otherwise, set *FOUND
+   to FALSE.  This reads the cached data in place without allocating
+   memory.  SCRATCH_POOL is only used for cache error handling. */
+svn_error_t *
+svn_fs_fs__try_get_noderev_scalars(svn_boolean_t *found,
+                                   svn_fs_fs__noderev_scalars_t *scalars,
+                                   svn_fs_t *fs,
+                                   const svn_fs_id_t *id,
+                                   apr_pool_t *scratch_pool);
+
 /* Set *ROOT_ID to the node-id for the root of revision REV in
    filesystem FS.  Do any allocations in POOL. */
 svn_error_t *
@@ -119,6 +143,20 @@ svn_fs_fs__try_process_file_contents(svn_boolean_t *success,
                                      void* baton,
                                      apr_pool_t *pool);
 
+/* If the representation REP in filesystem FS is stored as PLAIN text in
+   a revision or pack file, open that file in RESULT_POOL and return it
+   in *FILE, together with the OFFSET and LENGTH of the contents within.
+   Otherwise, set *FILE to NULL.  Use SCRATCH_POOL for temporaries.
+ */
+svn_error_t *
+svn_fs_fs__get_contents_range(apr_file_t **file,
+                              apr_off_t *offset,
+                              svn_filesize_t *length,
+                              svn_fs_t *fs,
+                              representation_t *rep,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
 /* Set *STREAM_P to a delta stream turning the contents of the file SOURCE into
    the contents of the file TARGET, allocated in POOL.
    If SOURCE is null, the empty string will be used. */
@@ -161,6 +199,33 @@ svn_fs_fs__rep_contents_dir_entry(svn_fs_dirent_t **dirent,
                                   apr_pool_t *result_pool,
                                   apr_pool_t *scratch_pool);
 
+/* If the ENTRIES of directory NODEREV in FS are too large for the txn
+   directory cache, keep a copy of them indexed by name in FS such that
+   svn_fs_fs__rep_contents_dir_entry() will not need to read them again.
+   TXN_FILESIZE is the current size of the in-txn children file of NODEREV.
+ */
+void
+svn_fs_fs__large_dir_set(svn_fs_t *fs,
+                         node_revision_t *noderev,
+                         apr_array_header_t *entries,
+                         svn_filesize_t txn_filesize);
+
+/* Update the large directory index in FS, if it describes the in-txn
+   directory PARENT_NODEREV with its children file being OLD_FILESIZE
+   bytes in size.  The entry NAME has been set to ID of node KIND or been
+   removed, if ID is NULL.  This grew the children file to NEW_FILESIZE.
+   Use SCRATCH_POOL for temporary allocations.
+ */
+void
+svn_fs_fs__large_dir_set_entry(svn_fs_t *fs,
+                               node_revision_t *parent_noderev,
+                               const char *name,
+                               const svn_fs_id_t *id,
+                               svn_node_kind_t kind,
+                               svn_filesize_t old_filesize,
+                               svn_filesize_t new_filesize,
+                               apr_pool_t *scratch_pool);
+
 /* Set *PROPLIST to be an apr_hash_t containing the property list of
    node-revision NODEREV as seen in filesystem FS.  Use POOL for
    temporary allocations. */
@@ -179,6 +244,16 @@ svn_fs_fs__create_changes_context(svn_fs_fs__changes_context_t **context,
                                   svn_revnum_t rev,
                                   apr_pool_t *result_pool);
 
+/* Make CONTEXT fetch REV's changed paths list from its beginning.  Keep
+ * the revision file open if REV is in the same pack file.  Otherwise,
+ * close it and clear REV_FILE_POOL, which will be used for the next
+ * revision file.  REV_FILE_POOL must not be the pool CONTEXT has been
+ * allocated in. */
+svn_error_t *
+svn_fs_fs__reset_changes_context(svn_fs_fs__changes_context_t *context,
+                                 svn_revnum_t rev,
+                                 apr_pool_t *rev_file_pool);
+
 /* Fetch the block of changes from the CONTEXT and return it in *CHANGES.
  * Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporaries.
  */
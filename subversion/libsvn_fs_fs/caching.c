@@ -276,12 +276,37 @@ init_callbacks(svn_cache__t *cache,
   return SVN_NO_ERROR;
 }
 
+/* Scale membuffer PRIORITY by the SVN_FS_CONFIG_FSFS_CACHE_WEIGHT of FS
+ * and return the result in *SCALED.
+ */
+static svn_error_t *
+weigh_priority(apr_uint32_t *scaled,
+               apr_uint32_t priority,
+               svn_fs_t *fs)
+{
+  const char *value = svn_hash__get_cstring(fs->config,
+                                            SVN_FS_CONFIG_FSFS_CACHE_WEIGHT,
+                                            NULL);
+  apr_int64_t weight;
+
+  *scaled = priority;
+  if (value == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_cstring_strtoi64(&weight, value, 1, 10000, 10));
+  *scaled = (apr_uint32_t)MAX(1, (apr_uint64_t)priority * weight / 100);
+
+  return SVN_NO_ERROR;
+}
+
 /* Sets *CACHE_P to cache instance based on provided options.
- * Creates memcache if MEMCACHE is not NULL. Creates membuffer cache if
+ * Creates memcache if MEMCACHE is not NULL, fronted by a membuffer cache
+ * if MEMBUFFER is not NULL either.  Creates membuffer cache if only
  * MEMBUFFER is not NULL. Fallbacks to inprocess cache if MEMCACHE and
  * MEMBUFFER are NULL and pages is non-zero.  Sets *CACHE_P to NULL
  * otherwise.  Use the given PRIORITY class for the new cache.  If it
- * is 0, then use the default priority class.  HAS_NAMESPACE indicates
+ * is 0, then use the default priority class.  Either way, it gets
+ * weighed according to the configuration of FS.  HAS_NAMESPACE indicates
  * whether we prefixed this cache instance with a namespace.
  *
  * Unless NO_HANDLER is true, register an error handler that reports errors
@@ -320,9 +345,26 @@ create_cache(svn_cache__t **cache_p,
       error_handler = no_handler
                     ? NULL
                     : warn_and_continue_on_cache_errors;
+
+      /* Keep a local copy of what we fetched from memcached, so repeated
+       * reads don't go over the network again. */
+      if (membuffer)
+        {
+          svn_cache__t *front;
+
+          SVN_ERR(weigh_priority(&priority, priority, fs));
+          SVN_ERR(svn_cache__create_membuffer_cache(
+                    &front, membuffer, serializer, deserializer,
+                    klen, prefix, priority, FALSE, has_namespace,
+                    result_pool, scratch_pool));
+          SVN_ERR(svn_cache__create_layered(cache_p, front, *cache_p,
+                                            result_pool));
+        }
     }
   else if (membuffer)
     {
+      SVN_ERR(weigh_priority(&priority, priority, fs));
+
       /* We assume caches with namespaces to be relatively short-lived,
        * i.e. their data will not be needed after a while. */
       SVN_ERR(svn_cache__create_membuffer_cache(
@@ -519,13 +561,13 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   SVN_ERR(create_cache(&(ffd->revprop_cache),
                        NULL,
                        membuffer,
-                       8, 20, /* ~400 bytes / entry, capa for ~2 packs */
+                       16, 64, /* ~400 bytes / entry, capa for ~4 packs */
                        svn_fs_fs__serialize_revprops,
                        svn_fs_fs__deserialize_revprops,
                        sizeof(pair_cache_key_t),
                        apr_pstrcat(pool, prefix, "REVPROP", SVN_VA_NULL),
                        SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
-                       TRUE, /* contents is short-lived */
+                       FALSE, /* keys follow the revprop generation */
                        fs,
                        no_handler,
                        fs->pool, pool));
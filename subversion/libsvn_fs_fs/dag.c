@@ -175,6 +175,31 @@ get_node_revision(node_revision_t **noderev_p,
 }
 
 
+/* Fill *SCALARS for NODE.  Unless NODE's node revision has been read
+   already, try to read the scalars in place from the cache.  Only fetch
+   the full node revision if that fails. */
+static svn_error_t *
+get_noderev_scalars(svn_fs_fs__noderev_scalars_t *scalars,
+                    dag_node_t *node)
+{
+  node_revision_t *noderev;
+
+  if (!node->node_revision)
+    {
+      svn_boolean_t found;
+      SVN_ERR(svn_fs_fs__try_get_noderev_scalars(&found, scalars, node->fs,
+                                                 node->id, node->node_pool));
+      if (found)
+        return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(get_node_revision(&noderev, node));
+  svn_fs_fs__noderev_get_scalars(scalars, noderev);
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_boolean_t svn_fs_fs__dag_check_mutable(const dag_node_t *node)
 {
   return svn_fs_fs__id_is_txn(svn_fs_fs__dag_get_id(node));
@@ -248,10 +273,10 @@ svn_error_t *
 svn_fs_fs__dag_get_predecessor_count(int *count,
                                      dag_node_t *node)
 {
-  node_revision_t *noderev;
+  svn_fs_fs__noderev_scalars_t scalars;
 
-  SVN_ERR(get_node_revision(&noderev, node));
-  *count = noderev->predecessor_count;
+  SVN_ERR(get_noderev_scalars(&scalars, node));
+  *count = scalars.predecessor_count;
   return SVN_NO_ERROR;
 }
 
@@ -259,10 +284,10 @@ svn_error_t *
 svn_fs_fs__dag_get_mergeinfo_count(apr_int64_t *count,
                                    dag_node_t *node)
 {
-  node_revision_t *noderev;
+  svn_fs_fs__noderev_scalars_t scalars;
 
-  SVN_ERR(get_node_revision(&noderev, node));
-  *count = noderev->mergeinfo_count;
+  SVN_ERR(get_noderev_scalars(&scalars, node));
+  *count = scalars.mergeinfo_count;
   return SVN_NO_ERROR;
 }
 
@@ -270,10 +295,10 @@ svn_error_t *
 svn_fs_fs__dag_has_mergeinfo(svn_boolean_t *has_mergeinfo,
                              dag_node_t *node)
 {
-  node_revision_t *noderev;
+  svn_fs_fs__noderev_scalars_t scalars;
 
-  SVN_ERR(get_node_revision(&noderev, node));
-  *has_mergeinfo = noderev->has_mergeinfo;
+  SVN_ERR(get_noderev_scalars(&scalars, node));
+  *has_mergeinfo = scalars.has_mergeinfo;
   return SVN_NO_ERROR;
 }
 
@@ -281,7 +306,7 @@ svn_error_t *
 svn_fs_fs__dag_has_descendants_with_mergeinfo(svn_boolean_t *do_they,
                                               dag_node_t *node)
 {
-  node_revision_t *noderev;
+  svn_fs_fs__noderev_scalars_t scalars;
 
   if (node->kind != svn_node_dir)
     {
@@ -289,10 +314,10 @@ svn_fs_fs__dag_has_descendants_with_mergeinfo(svn_boolean_t *do_they,
       return SVN_NO_ERROR;
     }
 
-  SVN_ERR(get_node_revision(&noderev, node));
-  if (noderev->mergeinfo_count > 1)
+  SVN_ERR(get_noderev_scalars(&scalars, node));
+  if (scalars.mergeinfo_count > 1)
     *do_they = TRUE;
-  else if (noderev->mergeinfo_count == 1 && !noderev->has_mergeinfo)
+  else if (scalars.mergeinfo_count == 1 && !scalars.has_mergeinfo)
     *do_they = TRUE;
   else
     *do_they = FALSE;
@@ -503,21 +528,23 @@ svn_fs_fs__dag_has_props(svn_boolean_t *has_props,
                          dag_node_t *node,
                          apr_pool_t *scratch_pool)
 {
-  node_revision_t *noderev;
+  svn_fs_fs__noderev_scalars_t scalars;
 
-  SVN_ERR(get_node_revision(&noderev, node));
+  SVN_ERR(get_noderev_scalars(&scalars, node));
 
-  if (! noderev->prop_rep)
+  if (! scalars.has_prop_rep)
     {
       *has_props = FALSE; /* Easy out */
       return SVN_NO_ERROR;
     }
 
-  if (svn_fs_fs__id_txn_used(&noderev->prop_rep->txn_id))
+  if (scalars.prop_rep_in_txn)
     {
       /* We are in a commit or something. Check actual properties */
+      node_revision_t *noderev;
       apr_hash_t *proplist;
 
+      SVN_ERR(get_node_revision(&noderev, node));
       SVN_ERR(svn_fs_fs__get_proplist(&proplist, node->fs,
                                       noderev, scratch_pool));
 
@@ -527,7 +554,7 @@ svn_fs_fs__dag_has_props(svn_boolean_t *has_props,
     {
       /* Properties are stored as a standard hash stream,
          always ending with "END\n" (4 bytes) */
-      *has_props = noderev->prop_rep->expanded_size > 4;
+      *has_props = scalars.prop_size > 4;
     }
 
   return SVN_NO_ERROR;
@@ -1020,12 +1047,35 @@ svn_fs_fs__dag_try_process_file_contents(svn_boolean_t *success,
 }
 
 
+svn_error_t *
+svn_fs_fs__dag_file_contents_range(apr_file_t **file,
+                                   apr_off_t *offset,
+                                   svn_filesize_t *length,
+                                   dag_node_t *node,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool)
+{
+  node_revision_t *noderev;
+
+  if (node->kind != svn_node_file)
+    return svn_error_createf
+      (SVN_ERR_FS_NOT_FILE, NULL,
+       "Attempted to locate the contents of a *non*-file node");
+
+  SVN_ERR(get_node_revision(&noderev, node));
+
+  return svn_fs_fs__get_contents_range(file, offset, length, node->fs,
+                                       noderev->data_rep,
+                                       result_pool, scratch_pool);
+}
+
+
 svn_error_t *
 svn_fs_fs__dag_file_length(svn_filesize_t *length,
                            dag_node_t *file,
                            apr_pool_t *pool)
 {
-  node_revision_t *noderev;
+  svn_fs_fs__noderev_scalars_t scalars;
 
   /* Make sure our node is a file. */
   if (file->kind != svn_node_file)
@@ -1033,10 +1083,12 @@ svn_fs_fs__dag_file_length(svn_filesize_t *length,
       (SVN_ERR_FS_NOT_FILE, NULL,
        "Attempted to get length of a *non*-file node");
 
-  /* Go get a fresh node-revision for FILE, and . */
-  SVN_ERR(get_node_revision(&noderev, file));
+  /* Treat "no representation" as "empty file", like
+     svn_fs_fs__file_length() does. */
+  SVN_ERR(get_noderev_scalars(&scalars, file));
+  *length = scalars.data_size;
 
-  return svn_fs_fs__file_length(length, noderev, pool);
+  return SVN_NO_ERROR;
 }
 
 
@@ -1309,6 +1361,39 @@ svn_fs_fs__dag_things_different(svn_boolean_t *props_changed,
   if (! props_changed && ! contents_changed)
     return SVN_NO_ERROR;
 
+  /* The same node revision is never different from itself. */
+  if (svn_fs_fs__id_eq(node1->id, node2->id))
+    {
+      if (props_changed)
+        *props_changed = FALSE;
+      if (contents_changed)
+        *contents_changed = FALSE;
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Comparing representation keys only needs these two out of each
+     node revision.  Don't fetch the full noderevs if we don't have
+     them already. */
+  if (!strict && !node1->node_revision && !node2->node_revision)
+    {
+      representation_t *prop_rep1, *data_rep1, *prop_rep2, *data_rep2;
+
+      SVN_ERR(svn_fs_fs__get_rep_keys(&prop_rep1, &data_rep1, node1->fs,
+                                      node1->id, pool, pool));
+      SVN_ERR(svn_fs_fs__get_rep_keys(&prop_rep2, &data_rep2, node2->fs,
+                                      node2->id, pool, pool));
+
+      if (props_changed != NULL)
+        *props_changed = !svn_fs_fs__noderev_same_rep_key(prop_rep1,
+                                                          prop_rep2);
+      if (contents_changed != NULL)
+        *contents_changed = !svn_fs_fs__noderev_same_rep_key(data_rep1,
+                                                             data_rep2);
+
+      return SVN_NO_ERROR;
+    }
+
   /* The node revision skels for these two nodes. */
   SVN_ERR(get_node_revision(&noderev1, node1));
   SVN_ERR(get_node_revision(&noderev2, node2));
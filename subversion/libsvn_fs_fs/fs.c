@@ -46,6 +46,7 @@
 #include "util.h"
 #include "verify.h"
 #include "svn_private_config.h"
+#include "private/svn_batch_fsync.h"
 #include "private/svn_fs_util.h"
 #include "private/svn_fs_fs_private.h"
 
@@ -57,6 +58,14 @@
 
 
 
+/* Pool cleanup function destroying the root pool given as DATA. */
+static apr_status_t
+destroy_pool(void *data)
+{
+  svn_pool_destroy(data);
+  return APR_SUCCESS;
+}
+
 /* Initialize the part of FS that requires global serialization across all
    instances.  The caller is responsible of ensuring that serialization.
    Use COMMON_POOL for process-wide and POOL for temporary allocations. */
@@ -120,10 +129,27 @@ fs_serialized_init(svn_fs_t *fs, apr_pool_t *common_pool, apr_pool_t *pool)
       SVN_ERR(svn_mutex__init(&ffsd->txn_current_lock,
                               SVN_FS_FS__USE_LOCK_MUTEX, common_pool));
 
+      /* Txn numbers reserved in txn-current get handed out under their
+         own lock, so we don't need to ask for txn-current every time. */
+      SVN_ERR(svn_mutex__init(&ffsd->txn_id_lock, TRUE, common_pool));
+
       /* We also need a mutex for synchronizing access to the active
          transaction list and free transaction pointer. */
       SVN_ERR(svn_mutex__init(&ffsd->txn_list_lock, TRUE, common_pool));
 
+      /* Shared pack file mappings get allocated on demand and outside
+         the global serialization.  So, they need a pool of their own. */
+      SVN_ERR(svn_mutex__init(&ffsd->mappings_lock, TRUE, common_pool));
+      ffsd->mappings_pool
+        = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+      apr_pool_cleanup_register(common_pool, ffsd->mappings_pool,
+                                destroy_pool, apr_pool_cleanup_null);
+      ffsd->packed_mappings = apr_hash_make(ffsd->mappings_pool);
+
+      /* The rep-cache filter gets built on demand, too. */
+      SVN_ERR(svn_mutex__init(&ffsd->rep_cache_filter_lock, TRUE,
+                              common_pool));
+
       key = apr_pstrdup(common_pool, key);
       status = apr_pool_userdata_set(ffsd, key, NULL, common_pool);
       if (status)
@@ -319,6 +345,7 @@ fs_ioctl(svn_fs_t *fs, svn_fs_ioctl_code_t ctlcode,
           SVN_ERR(svn_fs_fs__build_rep_cache(fs,
                                              input->start_rev,
                                              input->end_rev,
+                                             input->jobs,
                                              input->progress_func,
                                              input->progress_baton,
                                              cancel_func,
@@ -358,7 +385,8 @@ static fs_vtable_t fs_vtable = {
   svn_fs_fs__verify_root,
   fs_freeze,
   fs_set_errcall,
-  fs_ioctl
+  fs_ioctl,
+  svn_fs_fs__paths_changed_range
 };
 
 
@@ -525,10 +553,55 @@ fs_upgrade(svn_fs_t *fs,
                             cancel_func, cancel_baton, pool);
 }
 
+#if APR_HAS_THREADS
+
+/* Open COUNT additional instances of the filesystem at PATH, which has
+ * already been opened in FS, and return them in *WORKER_FSS.  Each of
+ * them lives in a separate root pool such that it may be used by some
+ * other thread.  Those pools get destroyed when POOL is being cleaned up.
+ * See fs_open() for COMMON_POOL_LOCK and COMMON_POOL.
+ */
+static svn_error_t *
+open_worker_fss(apr_array_header_t **worker_fss,
+                svn_fs_t *fs,
+                const char *path,
+                int count,
+                svn_mutex__t *common_pool_lock,
+                apr_pool_t *pool,
+                apr_pool_t *common_pool)
+{
+  int i;
+
+  *worker_fss = apr_array_make(pool, count, sizeof(svn_fs_t *));
+  for (i = 0; i < count; ++i)
+    {
+      apr_pool_t *worker_pool
+        = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+      svn_fs_t *worker_fs = apr_pcalloc(worker_pool, sizeof(*worker_fs));
+
+      apr_pool_cleanup_register(pool, worker_pool, destroy_pool,
+                                apr_pool_cleanup_null);
+
+      worker_fs->pool = worker_pool;
+      worker_fs->warning = fs->warning;
+      worker_fs->warning_baton = fs->warning_baton;
+      worker_fs->config = fs->config;
+
+      SVN_ERR(fs_open(worker_fs, path, common_pool_lock, worker_pool,
+                      common_pool));
+      APR_ARRAY_PUSH(*worker_fss, svn_fs_t *) = worker_fs;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#endif
+
 static svn_error_t *
 fs_verify(svn_fs_t *fs, const char *path,
           svn_revnum_t start,
           svn_revnum_t end,
+          int jobs,
           svn_fs_progress_notify_func_t notify_func,
           void *notify_baton,
           svn_cancel_func_t cancel_func,
@@ -537,14 +610,26 @@ fs_verify(svn_fs_t *fs, const char *path,
           apr_pool_t *pool,
           apr_pool_t *common_pool)
 {
+  apr_array_header_t *worker_fss = NULL;
+
   SVN_ERR(fs_open(fs, path, common_pool_lock, pool, common_pool));
-  return svn_fs_fs__verify(fs, start, end, notify_func, notify_baton,
+
+  /* Concurrent verification needs a private FS instance per worker. */
+#if APR_HAS_THREADS
+  if (jobs > 1)
+    SVN_ERR(open_worker_fss(&worker_fss, fs, path, jobs, common_pool_lock,
+                            pool, common_pool));
+#endif
+
+  return svn_fs_fs__verify(fs, start, end, worker_fss,
+                           notify_func, notify_baton,
                            cancel_func, cancel_baton, pool);
 }
 
 static svn_error_t *
 fs_pack(svn_fs_t *fs,
         const char *path,
+        int jobs,
         svn_fs_pack_notify_t notify_func,
         void *notify_baton,
         svn_cancel_func_t cancel_func,
@@ -553,8 +638,18 @@ fs_pack(svn_fs_t *fs,
         apr_pool_t *pool,
         apr_pool_t *common_pool)
 {
+  apr_array_header_t *worker_fss = NULL;
+
   SVN_ERR(fs_open(fs, path, common_pool_lock, pool, common_pool));
-  return svn_fs_fs__pack(fs, 0, notify_func, notify_baton,
+
+  /* Concurrent packing needs a private FS instance per worker thread. */
+#if APR_HAS_THREADS
+  if (jobs > 1)
+    SVN_ERR(open_worker_fss(&worker_fss, fs, path, jobs, common_pool_lock,
+                            pool, common_pool));
+#endif
+
+  return svn_fs_fs__pack(fs, 0, worker_fss, notify_func, notify_baton,
                          cancel_func, cancel_baton, pool);
 }
 
@@ -705,6 +800,8 @@ svn_fs_fs__init(const svn_version_t *loader_version,
                              loader_version->major);
   SVN_ERR(svn_ver_check_list2(fs_version(), checklist, svn_ver_equal));
 
+  SVN_ERR(svn_batch_fsync__init(common_pool));
+
   *vtable = &library_vtable;
   return SVN_NO_ERROR;
 }
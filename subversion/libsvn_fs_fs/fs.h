@@ -53,6 +53,7 @@ extern "C" {
 #define PATH_FORMAT           "format"           /* Contains format number */
 #define PATH_UUID             "uuid"             /* Contains UUID */
 #define PATH_CURRENT          "current"          /* Youngest revision */
+#define PATH_NEXT             "next"             /* Revision being written */
 #define PATH_LOCK_FILE        "write-lock"       /* Revision lock file */
 #define PATH_PACK_LOCK_FILE   "pack-lock"        /* Pack lock file */
 #define PATH_REVS_DIR         "revs"             /* Directory of revisions */
@@ -102,6 +103,14 @@ extern "C" {
 #define CONFIG_OPTION_FAIL_STOP          "fail-stop"
 #define CONFIG_SECTION_REP_SHARING       "rep-sharing"
 #define CONFIG_OPTION_ENABLE_REP_SHARING "enable-rep-sharing"
+#define CONFIG_OPTION_REP_CACHE_FILTER   "rep-cache-filter"
+#define CONFIG_OPTION_REP_CACHE_CACHE_SIZE "rep-cache-cache-size"
+#define CONFIG_OPTION_REP_CACHE_MMAP_SIZE "rep-cache-mmap-size"
+#define CONFIG_OPTION_REP_CACHE_WAL      "rep-cache-wal"
+#define CONFIG_SECTION_MERGEINFO         "mergeinfo"
+#define CONFIG_OPTION_MERGEINFO_INDEX    "mergeinfo-index"
+#define CONFIG_SECTION_LOCKS             "locks"
+#define CONFIG_OPTION_LOCK_INDEX         "lock-index"
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
 #define CONFIG_OPTION_ENABLE_DIR_DELTIFICATION   "enable-dir-deltification"
 #define CONFIG_OPTION_ENABLE_PROPS_DELTIFICATION "enable-props-deltification"
@@ -115,9 +124,13 @@ extern "C" {
 #define CONFIG_OPTION_BLOCK_SIZE         "block-size"
 #define CONFIG_OPTION_L2P_PAGE_SIZE      "l2p-page-size"
 #define CONFIG_OPTION_P2L_PAGE_SIZE      "p2l-page-size"
+#define CONFIG_OPTION_MMAP_PACKED_FILES  "mmap-packed-files"
+#define CONFIG_SECTION_TXNS              "transactions"
+#define CONFIG_OPTION_TXN_ID_BLOCK_SIZE  "txn-id-block-size"
 #define CONFIG_SECTION_DEBUG             "debug"
 #define CONFIG_OPTION_PACK_AFTER_COMMIT  "pack-after-commit"
 #define CONFIG_OPTION_VERIFY_BEFORE_COMMIT "verify-before-commit"
+#define CONFIG_OPTION_IO_TRACE_FILE      "io-trace-file"
 #define CONFIG_OPTION_COMPRESSION        "compression"
 
 /* The format number of this filesystem.
@@ -127,7 +140,7 @@ extern "C" {
    Note: If you bump this, please update the switch statement in
          svn_fs_fs__create() as well.
  */
-#define SVN_FS_FS__FORMAT_NUMBER   8
+#define SVN_FS_FS__FORMAT_NUMBER   9
 
 /* The minimum format number that supports svndiff version 1.  */
 #define SVN_FS_FS__MIN_SVNDIFF1_FORMAT 2
@@ -188,6 +201,12 @@ extern "C" {
 /* The minimum format number that supports svndiff version 2. */
 #define SVN_FS_FS__MIN_SVNDIFF2_FORMAT 8
 
+/* The minimum format number that supports svndiff version 3. */
+#define SVN_FS_FS__MIN_SVNDIFF3_FORMAT 9
+
+/* The Zstandard level used for the plain "zstd" compression setting. */
+#define SVN_FS_FS__ZSTD_DEFAULT_LEVEL 3
+
 /* The minimum format number that supports the special notation ("-")
    for optional values that are not present in the representation strings,
    such as SHA1 or the uniquifier.  For example:
@@ -258,7 +277,15 @@ typedef struct fs_fs_shared_data_t
      declaration here.  Any subset may be acquired and held at any given
      time but their relative acquisition order must not change.
 
-     (lock 'txn-current' before 'pack' before 'write' before 'txn-list') */
+     (lock 'txn-id' before 'txn-current' before 'pack' before 'write'
+      before 'txn-list') */
+
+  /* A lock for intra-process synchronization when allocating txn numbers
+     from the range [NEXT_TXN_NUMBER, END_TXN_NUMBER) that this process
+     reserved in the txn-current file.  The range is empty initially. */
+  svn_mutex__t *txn_id_lock;
+  apr_uint64_t next_txn_number;
+  apr_uint64_t end_txn_number;
 
   /* A lock for intra-process synchronization when accessing the TXNS list. */
   svn_mutex__t *txn_list_lock;
@@ -278,6 +305,23 @@ typedef struct fs_fs_shared_data_t
   /* The common pool, under which this object is allocated, subpools
      of which are used to allocate the transaction objects. */
   apr_pool_t *common_pool;
+
+  /* Read-only memory mappings (apr_mmap_t *) of pack files, keyed by
+     shard number (apr_int64_t).  Both, the hash and the mappings are
+     allocated in MAPPINGS_POOL.  All access is synchronised under
+     MAPPINGS_LOCK, which must not be held while acquiring any other lock.
+     See svn_fs_fs__open_pack_or_rev_file(). */
+  apr_hash_t *packed_mappings;
+  apr_pool_t *mappings_pool;
+  svn_mutex__t *mappings_lock;
+
+  /* Bloom filter over the SHA1 keys in rep-cache.db as seen by this
+     process, NULL if it has not been built yet.  Allocated in its own
+     pool.  All access is synchronised under REP_CACHE_FILTER_LOCK, which
+     must not be held while acquiring any other lock.
+     See rep-cache.c. */
+  struct rep_cache_filter_t *rep_cache_filter;
+  svn_mutex__t *rep_cache_filter_lock;
 } fs_fs_shared_data_t;
 
 /* Data structure for the 1st level DAG node cache. */
@@ -315,9 +359,25 @@ typedef enum compression_type_t
 {
   compression_type_none,
   compression_type_zlib,
-  compression_type_lz4
+  compression_type_lz4,
+  compression_type_zstd
 } compression_type_t;
 
+/* Tracks the index data reads that were caused by cache misses, so we can
+   detect sequential access patterns and read ahead.  See index.c. */
+typedef struct index_readahead_t
+{
+  /* First revision of the rev / pack file whose index got read last. */
+  svn_revnum_t first_revision;
+
+  /* Index offset up to which data has been read last time. */
+  apr_off_t end_offset;
+
+  /* Number of consecutive cache misses that continued reading right where
+     the respective previous one stopped. */
+  int sequential_misses;
+} index_readahead_t;
+
 /* Private (non-shared) FSFS-specific data for each svn_fs_t object.
    Any caches in here may be NULL. */
 typedef struct fs_fs_data_t
@@ -380,8 +440,10 @@ typedef struct fs_fs_data_t
      rep key (revision/offset) to svn_stringbuf_t. */
   svn_cache__t *fulltext_cache;
 
-  /* The current prefix to be used for revprop cache entries.
-     If this is 0, a new unique prefix must be chosen. */
+  /* The current prefix to be used for revprop cache entries.  Even
+     values are derived from the revprop generation and shared by all
+     users of the repository, odd values are unique to this svn_fs_t.
+     If this is 0, the revprop generation must be re-read. */
   apr_uint64_t revprop_prefix;
 
   /* Revision property cache.  Maps from (rev,prefix) to apr_hash_t.
@@ -446,6 +508,10 @@ typedef struct fs_fs_data_t
      Will be NULL for pre-format7 repos */
   svn_cache__t *p2l_page_cache;
 
+  /* Access pattern detection for L2P and P2L index page read-ahead. */
+  index_readahead_t l2p_readahead;
+  index_readahead_t p2l_readahead;
+
   /* TRUE while the we hold a lock on the write lock file. */
   svn_boolean_t has_write_lock;
 
@@ -456,6 +522,11 @@ typedef struct fs_fs_data_t
      unparsed FS ID to ###x.  NULL outside transactions. */
   svn_cache__t *txn_dir_cache;
 
+  /* Name index of the directory last read that was too large for
+     DIR_CACHE and TXN_DIR_CACHE.  NULL if there is none.
+     See cached_data.c. */
+  struct svn_fs_fs__large_dir_t *large_dir;
+
   /* Data shared between all svn_fs_t objects for a given filesystem. */
   fs_fs_shared_data_t *shared;
 
@@ -465,6 +536,25 @@ typedef struct fs_fs_data_t
   /* Thread-safe boolean */
   svn_atomic_t rep_cache_db_opened;
 
+  /* The sqlite database of the mergeinfo index, see mergeinfo-index.h. */
+  svn_sqlite__db_t *mergeinfo_index_db;
+
+  /* Thread-safe boolean */
+  svn_atomic_t mergeinfo_index_db_opened;
+
+  /* Whether mergeinfo queries shall use and fill the mergeinfo index. */
+  svn_boolean_t mergeinfo_index;
+
+  /* The sqlite database of the lock index, see lock-index.h.  NULL until
+     opened. */
+  svn_sqlite__db_t *lock_index_db;
+
+  /* Whether LOCK_INDEX_DB is known to hold all locks. */
+  svn_boolean_t lock_index_complete;
+
+  /* Whether lock queries shall use the lock index. */
+  svn_boolean_t lock_index;
+
   /* The oldest revision not in a pack file.  It also applies to revprops
    * if revprop packing has been enabled by the FSFS format version. */
   svn_revnum_t min_unpacked_rev;
@@ -473,6 +563,18 @@ typedef struct fs_fs_data_t
    * and allowed by the configuration. */
   svn_boolean_t rep_sharing_allowed;
 
+  /* Whether to skip rep-cache.db lookups for keys that a Bloom filter
+   * reports as not present. */
+  svn_boolean_t rep_cache_filter;
+
+  /* SQLite page cache and memory map sizes in kBytes for rep-cache.db.
+   * 0 for SQLite's defaults. */
+  apr_int64_t rep_cache_cache_size;
+  apr_int64_t rep_cache_mmap_size;
+
+  /* Whether rep-cache.db shall use write-ahead logging. */
+  svn_boolean_t rep_cache_wal;
+
   /* File size limit in bytes up to which multiple revprops shall be packed
    * into a single file. */
   apr_int64_t revprop_pack_size;
@@ -502,9 +604,20 @@ typedef struct fs_fs_data_t
   /* Pack after every commit. */
   svn_boolean_t pack_after_commit;
 
+  /* Read pack files through read-only memory mappings shared across
+     all svn_fs_t instances of this repository within the process. */
+  svn_boolean_t mmap_packed_files;
+
   /* Verify each new revision before commit. */
   svn_boolean_t verify_before_commit;
 
+  /* If not NULL, record all reads from rev / pack files here. */
+  struct svn_fs_fs__io_trace_t *io_trace;
+
+  /* Number of txn numbers to reserve in the txn-current file at once.
+     1 means that every new txn updates the txn-current file. */
+  apr_int64_t txn_id_block_size;
+
   /* Per-instance filesystem ID, which provides an additional level of
      uniqueness for filesystems that share the same UUID, but should
      still be distinguishable (e.g. backups produced by svn_fs_hotcopy()
@@ -647,6 +760,26 @@ typedef struct node_revision_t
 
 } node_revision_t;
 
+/* The fixed-size fields of a node revision that are queried frequently.
+   See svn_fs_fs__try_get_noderev_scalars(). */
+typedef struct svn_fs_fs__noderev_scalars_t
+{
+  /* As in node_revision_t. */
+  svn_node_kind_t kind;
+  int predecessor_count;
+  apr_int64_t mergeinfo_count;
+  svn_boolean_t has_mergeinfo;
+
+  /* Is there a property representation?  If so, its expanded size and
+     whether it still lives in a transaction. */
+  svn_boolean_t has_prop_rep;
+  svn_filesize_t prop_size;
+  svn_boolean_t prop_rep_in_txn;
+
+  /* Expanded size of the contents representation.  0 if there is none. */
+  svn_filesize_t data_size;
+} svn_fs_fs__noderev_scalars_t;
+
 
 /*** Change ***/
 typedef struct change_t
@@ -684,6 +817,13 @@ typedef struct svn_fs_fs__changes_context_t
   /* Has the end of the list been reached? */
   svn_boolean_t eol;
 
+  /* If not NULL, return only changes relevant to this canonical path as
+     defined by svn_fs__path_change_matches(). */
+  const char *filter_path;
+
+  /* Also return changes to the parents of FILTER_PATH? */
+  svn_boolean_t filter_parents;
+
 } svn_fs_fs__changes_context_t;
 
 /*** Directory (only used at the cache interface) ***/
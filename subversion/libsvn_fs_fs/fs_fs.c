@@ -46,8 +46,11 @@
 
 #include "private/svn_fs_util.h"
 #include "private/svn_io_private.h"
+#include "private/svn_mutex.h"
+#include "private/svn_stats.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_pool.h"
 #include "../libsvn_fs/fs-loader.h"
 
 /* The default maximum number of files per directory to store in the
@@ -110,6 +113,12 @@ svn_fs_fs__path_current(svn_fs_t *fs, apr_pool_t *pool)
   return svn_dirent_join(fs->path, PATH_CURRENT, pool);
 }
 
+const char *
+svn_fs_fs__path_next(svn_fs_t *fs, apr_pool_t *pool)
+{
+  return svn_dirent_join(fs->path, PATH_NEXT, pool);
+}
+
 
 
 /* Get a lock on empty file LOCK_FILENAME, creating it in POOL. */
@@ -181,8 +190,15 @@ typedef struct with_lock_baton_t
   /* TRUE, iff this is not a nested lock.
      Then responsible for destroying LOCK_POOL. */
   svn_boolean_t is_outer_most_lock;
+
+  /* When we started waiting for the lock, if IS_GLOBAL_LOCK is set and
+     statistics are being collected; 0 otherwise. */
+  apr_time_t wait_start;
 } with_lock_baton_t;
 
+/* Time spent waiting for the repository write lock. */
+SVN__COUNTER_DEFINE(write_lock_wait, "fsfs.write_lock_wait");
+
 /* Obtain a write lock on the file BATON->LOCK_PATH and call BATON->BODY
    with BATON->BATON.  If this is the outermost lock call, release all file
    locks after the body returned.  If BATON->IS_GLOBAL_LOCK is set, set the
@@ -200,6 +216,8 @@ with_some_lock_file(with_lock_baton_t *baton)
 
       if (baton->is_global_lock)
         {
+          SVN__TIMER_STOP(write_lock_wait, baton->wait_start);
+
           /* set the "got the lock" flag and register reset function */
           apr_pool_cleanup_register(pool,
                                     ffd,
@@ -237,6 +255,10 @@ with_lock(void *baton,
           apr_pool_t *pool)
 {
   with_lock_baton_t *lock_baton = baton;
+
+  if (lock_baton->is_global_lock)
+    SVN__TIMER_START(write_lock_wait, lock_baton->wait_start);
+
   SVN_MUTEX__WITH_LOCK(lock_baton->mutex, with_some_lock_file(lock_baton));
 
   return SVN_NO_ERROR;
@@ -693,7 +715,8 @@ parse_compression_option(compression_type_t *compression_type_p,
   int level;
   svn_boolean_t is_valid = TRUE;
 
-  /* compression = none | lz4 | zlib | zlib-1 ... zlib-9 */
+  /* compression = none | lz4 | zlib | zlib-1 ... zlib-9 |
+                   zstd | zstd-1 ... zstd-19 */
   if (strcmp(value, "none") == 0)
     {
       type = compression_type_none;
@@ -723,6 +746,26 @@ parse_compression_option(compression_type_t *compression_type_p,
       else
         is_valid = FALSE;
     }
+  else if (strncmp(value, "zstd", 4) == 0)
+    {
+      const char *p = value + 4;
+
+      /* The level is passed to Zstandard as-is. */
+      type = compression_type_zstd;
+      if (*p == 0)
+        {
+          level = SVN_FS_FS__ZSTD_DEFAULT_LEVEL;
+        }
+      else if (*p == '-')
+        {
+          p++;
+          SVN_ERR(svn_cstring_atoi(&level, p));
+          if (level < 1 || level > 19)
+            is_valid = FALSE;
+        }
+      else
+        is_valid = FALSE;
+    }
   else
     {
       is_valid = FALSE;
@@ -761,6 +804,45 @@ read_config(fs_fs_data_t *ffd,
   else
     ffd->rep_sharing_allowed = FALSE;
 
+  if (ffd->rep_sharing_allowed)
+    SVN_ERR(svn_config_get_bool(config, &ffd->rep_cache_filter,
+                                CONFIG_SECTION_REP_SHARING,
+                                CONFIG_OPTION_REP_CACHE_FILTER, FALSE));
+  else
+    ffd->rep_cache_filter = FALSE;
+
+  if (ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT)
+    {
+      SVN_ERR(svn_config_get_int64(config, &ffd->rep_cache_cache_size,
+                                   CONFIG_SECTION_REP_SHARING,
+                                   CONFIG_OPTION_REP_CACHE_CACHE_SIZE, 0));
+      SVN_ERR(svn_config_get_int64(config, &ffd->rep_cache_mmap_size,
+                                   CONFIG_SECTION_REP_SHARING,
+                                   CONFIG_OPTION_REP_CACHE_MMAP_SIZE, 0));
+      SVN_ERR(svn_config_get_bool(config, &ffd->rep_cache_wal,
+                                  CONFIG_SECTION_REP_SHARING,
+                                  CONFIG_OPTION_REP_CACHE_WAL, FALSE));
+    }
+  else
+    {
+      ffd->rep_cache_cache_size = 0;
+      ffd->rep_cache_mmap_size = 0;
+      ffd->rep_cache_wal = FALSE;
+    }
+
+  /* Initialize ffd->mergeinfo_index. */
+  if (ffd->format >= SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    SVN_ERR(svn_config_get_bool(config, &ffd->mergeinfo_index,
+                                CONFIG_SECTION_MERGEINFO,
+                                CONFIG_OPTION_MERGEINFO_INDEX, FALSE));
+  else
+    ffd->mergeinfo_index = FALSE;
+
+  /* Initialize ffd->lock_index. */
+  SVN_ERR(svn_config_get_bool(config, &ffd->lock_index,
+                              CONFIG_SECTION_LOCKS,
+                              CONFIG_OPTION_LOCK_INDEX, FALSE));
+
   /* Initialize deltification settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
     {
@@ -861,6 +943,18 @@ read_config(fs_fs_data_t *ffd,
       ffd->pack_after_commit = FALSE;
     }
 
+  if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
+    {
+      SVN_ERR(svn_config_get_bool(config, &ffd->mmap_packed_files,
+                                  CONFIG_SECTION_IO,
+                                  CONFIG_OPTION_MMAP_PACKED_FILES,
+                                  FALSE));
+    }
+  else
+    {
+      ffd->mmap_packed_files = FALSE;
+    }
+
   /* Initialize compression settings in ffd. */
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
     {
@@ -891,6 +985,18 @@ read_config(fs_fs_data_t *ffd,
                                       _("Compression type 'lz4' requires "
                                         "filesystem format 8 or higher"));
             }
+          if (ffd->delta_compression_type == compression_type_zstd)
+            {
+              if (ffd->format < SVN_FS_FS__MIN_SVNDIFF3_FORMAT)
+                return svn_error_create(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                        _("Compression type 'zstd' requires "
+                                          "filesystem format 9 or higher"));
+              if (!svn__zstd_supported())
+                return svn_error_create(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                        _("Compression type 'zstd' is not "
+                                          "supported by this build of "
+                                          "Subversion"));
+            }
         }
       else if (compression_level_val)
         {
@@ -938,6 +1044,34 @@ read_config(fs_fs_data_t *ffd,
                               FALSE));
 #endif
 
+  {
+    const char *trace_path;
+
+    svn_config_get(config, &trace_path, CONFIG_SECTION_DEBUG,
+                   CONFIG_OPTION_IO_TRACE_FILE, NULL);
+    if (trace_path && *trace_path)
+      SVN_ERR(svn_fs_fs__io_trace_open(&ffd->io_trace,
+                                       svn_dirent_join(fs_path, trace_path,
+                                                       scratch_pool),
+                                       result_pool));
+    else
+      ffd->io_trace = NULL;
+  }
+
+  if (ffd->format >= SVN_FS_FS__MIN_TXN_CURRENT_FORMAT)
+    {
+      SVN_ERR(svn_config_get_int64(config, &ffd->txn_id_block_size,
+                                   CONFIG_SECTION_TXNS,
+                                   CONFIG_OPTION_TXN_ID_BLOCK_SIZE,
+                                   1));
+      if (ffd->txn_id_block_size < 1)
+        ffd->txn_id_block_size = 1;
+    }
+  else
+    {
+      ffd->txn_id_block_size = 1;
+    }
+
   /* memcached configuration */
   SVN_ERR(svn_cache__make_memcache_from_config(&ffd->memcache, config,
                                                result_pool, scratch_pool));
@@ -994,6 +1128,56 @@ write_config(svn_fs_t *fs,
 "### 'svnadmin verify' will check the rep-cache regardless of this setting." NL
 "### rep-sharing is enabled by default."                                     NL
 "# " CONFIG_OPTION_ENABLE_REP_SHARING " = true"                              NL
+"###"                                                                        NL
+"### Most lookups in the rep-cache fail when adding lots of new contents,"   NL
+"### e.g. during large imports.  The following parameter makes server"       NL
+"### processes keep a compact in-memory summary of the rep-cache and skip"   NL
+"### the database query for contents that are certainly not in there."       NL
+"### The summary gets built from the rep-cache upon first use and takes"     NL
+"### about 2 bytes per entry.  It may miss entries added by other processes" NL
+"### very recently,  causing those contents not to be shared."               NL
+"### rep-cache-filter is false by default."                                  NL
+"# " CONFIG_OPTION_REP_CACHE_FILTER " = false"                               NL
+"###"                                                                        NL
+"### The following parameters tune the SQLite database that holds the"       NL
+"### rep-cache.  rep-cache-cache-size and rep-cache-mmap-size set the"       NL
+"### amount of memory in kBytes that each process uses to cache and to"      NL
+"### memory-map the database, respectively.  0 uses SQLite's defaults."      NL
+"### [New in 1.15]"                                                          NL
+"# " CONFIG_OPTION_REP_CACHE_CACHE_SIZE " = 0"                               NL
+"# " CONFIG_OPTION_REP_CACHE_MMAP_SIZE " = 0"                                NL
+"###"                                                                        NL
+"### With write-ahead logging, lookups in the rep-cache don't have to wait"  NL
+"### for concurrent commits.  This requires that every process accessing"    NL
+"### the repository, including read-only ones, can create files in the"      NL
+"### db directory and that the repository is not on a network file"          NL
+"### system.  Switching it off takes effect once no process uses the"        NL
+"### database."                                                              NL
+"### rep-cache-wal is false by default.  [New in 1.15]"                      NL
+"# " CONFIG_OPTION_REP_CACHE_WAL " = false"                                  NL
+""                                                                           NL
+"[" CONFIG_SECTION_MERGEINFO "]"                                             NL
+"### Answering mergeinfo queries, e.g. for 'svn mergeinfo' and automatic"    NL
+"### merges, means walking up the tree and parsing svn:mergeinfo values."    NL
+"### The following parameter makes the filesystem remember the answers in"   NL
+"### mergeinfo-index.db, so that later queries from any process become a"    NL
+"### single lookup.  Only processes allowed to write to the repository add"  NL
+"### to the index.  It can be switched on and off at will; the index is"     NL
+"### kept consistent with the repository whenever it exists."                NL
+"### mergeinfo-index is false by default."                                   NL
+"# " CONFIG_OPTION_MERGEINFO_INDEX " = false"                                NL
+""                                                                           NL
+"[" CONFIG_SECTION_LOCKS "]"                                                 NL
+"### Locks are stored in a tree of digest files below db/locks.  Listing"    NL
+"### the locks below a directory, e.g. to check a commit, reads one file"    NL
+"### per lock below it.  The following parameter makes the filesystem keep"  NL
+"### a copy of all locks in lock-index.db, where such queries become a"      NL
+"### single indexed lookup.  The index is created by the first lock or"      NL
+"### unlock after enabling it and kept up to date whenever it exists.  The"  NL
+"### digest files remain authoritative.  Older tools don't know about the"   NL
+"### index, so delete lock-index.db after modifying locks with them."        NL
+"### lock-index is false by default.  [New in 1.15]"                         NL
+"# " CONFIG_OPTION_LOCK_INDEX " = false"                                     NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DELTIFICATION "]"                                         NL
 "### To conserve space, the filesystem stores data as differences against"   NL
@@ -1059,19 +1243,26 @@ write_config(svn_fs_t *fs,
 "### After deltification, we compress the data to minimize on-disk size."    NL
 "### This setting controls the compression algorithm, which will be used in" NL
 "### future revisions.  It can be used to either disable compression or to"  NL
-"### select between available algorithms (zlib, lz4).  zlib is a general-"   NL
-"### purpose compression algorithm.  lz4 is a fast compression algorithm"    NL
-"### which should be preferred for repositories with large and, possibly,"   NL
-"### incompressible files.  Note that the compression ratio of lz4 is"       NL
-"### usually lower than the one provided by zlib, but using it can"          NL
+"### select between available algorithms (zlib, lz4, zstd).  zlib is a"      NL
+"### general-purpose compression algorithm.  lz4 is a fast compression"      NL
+"### algorithm which should be preferred for repositories with large and,"   NL
+"### possibly, incompressible files.  Note that the compression ratio of"    NL
+"### lz4 is usually lower than the one provided by zlib, but using it can"   NL
 "### significantly speed up commits as well as reading the data."            NL
 "### lz4 compression algorithm is supported, starting from format 8"         NL
 "### repositories, available in Subversion 1.10 and higher."                 NL
+"### zstd (Zstandard) usually compresses better than zlib while being"       NL
+"### nearly as fast as lz4 to decompress.  It is supported, starting from"   NL
+"### format 9 repositories, available in Subversion 1.15 and higher, but"    NL
+"### only if Subversion has been built with Zstandard support.  Every"       NL
+"### Subversion build that accesses the repository must then support it."   NL
 "### The syntax of this option is:"                                          NL
-"###   " CONFIG_OPTION_COMPRESSION " = none | lz4 | zlib | zlib-1 ... zlib-9" NL
+"###   " CONFIG_OPTION_COMPRESSION " = none | lz4 | zlib | zlib-1 ... zlib-9 |" NL
+"###                 zstd | zstd-1 ... zstd-19"                              NL
 "### Versions prior to Subversion 1.10 will ignore this option."             NL
 "### The default value is 'lz4' if supported by the repository format and"   NL
-"### 'zlib' otherwise.  'zlib' is currently equivalent to 'zlib-5'."         NL
+"### 'zlib' otherwise.  'zlib' is currently equivalent to 'zlib-5' and"      NL
+"### 'zstd' is equivalent to 'zstd-3'."                                      NL
 "# " CONFIG_OPTION_COMPRESSION " = lz4"                                      NL
 "###"                                                                        NL
 "### DEPRECATED: The new '" CONFIG_OPTION_COMPRESSION "' option deprecates previously used" NL
@@ -1148,6 +1339,24 @@ write_config(svn_fs_t *fs,
 "### Must be a power of 2."                                                  NL
 "### p2l-page-size is given in kBytes and with a default of 1024 kBytes."    NL
 "# " CONFIG_OPTION_P2L_PAGE_SIZE " = 1024"                                   NL
+"###"                                                                        NL
+"### Pack files never change once they have been written.  Setting this"     NL
+"### option to true makes server processes access them through read-only"    NL
+"### memory mappings instead of individual read() calls.  The mappings get"  NL
+"### shared by all users of the repository within the same process,  which"  NL
+"### saves system calls and data copies for cold data.  However, it also"    NL
+"### reserves address space for every pack file being accessed.  So, only"   NL
+"### enable this on 64 bit systems.  mmap-packed-files is false by default." NL
+"# " CONFIG_OPTION_MMAP_PACKED_FILES " = false"                              NL
+""                                                                           NL
+"[" CONFIG_SECTION_TXNS "]"                                                  NL
+"### New transactions get unique numbers from the txn-current file,  which"  NL
+"### requires a repository-wide lock.  Servers creating many transactions"   NL
+"### may reserve blocks of numbers instead and hand them out within the"     NL
+"### same process without taking that lock.  Unused numbers get skipped"     NL
+"### when the process ends.  txn-id-block-size is 1 by default,  i.e. no"    NL
+"### numbers get reserved in advance."                                       NL
+"# " CONFIG_OPTION_TXN_ID_BLOCK_SIZE " = 1"                                  NL
 ""                                                                           NL
 "[" CONFIG_SECTION_DEBUG "]"                                                 NL
 "###"                                                                        NL
@@ -1155,6 +1364,13 @@ write_config(svn_fs_t *fs,
 "### the commit.  This is disabled by default except in maintainer-mode"     NL
 "### builds."                                                                NL
 "# " CONFIG_OPTION_VERIFY_BEFORE_COMMIT " = false"                           NL
+"###"                                                                        NL
+"### If set, every read from a revision or pack file gets recorded in the"   NL
+"### given file,  relative to the db directory, with its offset, length"     NL
+"### and purpose.  The tools/dev/fsfs-replay program re-issues the reads"    NL
+"### from such a trace to evaluate I/O settings against real traffic."       NL
+"### Tracing is off by default.  [New in 1.15]"                              NL
+"# " CONFIG_OPTION_IO_TRACE_FILE " = io-trace.log"                           NL
 ;
 #undef NL
   return svn_io_file_create(svn_dirent_join(fs->path, PATH_CONFIG, pool),
@@ -1951,6 +2167,12 @@ svn_fs_fs__create(svn_fs_t *fs,
                   break;
           case 9: format = 7;
                   break;
+          case 10:
+          case 11:
+          case 12:
+          case 13:
+          case 14: format = 8;
+                  break;
 
           default:format = SVN_FS_FS__FORMAT_NUMBER;
         }
@@ -2323,8 +2545,11 @@ svn_fs_fs__info_format(int *fs_format,
     case 8:
       (*supports_version)->minor = 10;
       break;
+    case 9:
+      (*supports_version)->minor = 15;
+      break;
 #ifdef SVN_DEBUG
-# if SVN_FS_FS__FORMAT_NUMBER != 8
+# if SVN_FS_FS__FORMAT_NUMBER != 9
 #  error "Need to add a 'case' statement here"
 # endif
 #endif
@@ -2368,21 +2593,29 @@ ensure_representation_sha1(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
-/* Recursively index (in the rep-cache) the filesystem node with the
+/* Number of rep-cache rows that svn_fs_fs__build_rep_cache() collects
+ * before writing them to the database within a single SQLite transaction.
+ */
+#define BUILD_REP_CACHE_BATCH_SIZE 10000
+
+/* Recursively collect the representations of the filesystem node with the
  * given ID, located in revision REV and its matching REV_FILE (if the
  * node ID cannot be found in this revision, do nothing).
- * Compute the SHA1 checksum of the node's representation and add
- * a corresponding entry to the repository's rep-cache.
+ * Compute the SHA1 checksum of every representation of that node that was
+ * created in REV and append a copy of it, allocated in RESULT_POOL, to REPS.
  * If the node represents a directory this function will recurse and
- * index all children of this directory as well. */
+ * collect all children of this directory as well.
+ * Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
-reindex_node(svn_fs_t *fs,
+reindex_node(apr_array_header_t *reps,
+             svn_fs_t *fs,
              const svn_fs_id_t *id,
              svn_revnum_t rev,
              svn_fs_fs__revision_file_t *rev_file,
              svn_cancel_func_t cancel_func,
              void *cancel_baton,
-             apr_pool_t *pool)
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
 {
   node_revision_t *noderev;
   apr_off_t offset;
@@ -2396,29 +2629,32 @@ reindex_node(svn_fs_t *fs,
     SVN_ERR(cancel_func(cancel_baton));
 
   SVN_ERR(svn_fs_fs__item_offset(&offset, fs, rev_file, rev, NULL,
-                                 svn_fs_fs__id_item(id), pool));
+                                 svn_fs_fs__id_item(id), scratch_pool));
 
-  SVN_ERR(svn_io_file_seek(rev_file->file, APR_SET, &offset, pool));
+  SVN_ERR(svn_io_file_seek(rev_file->file, APR_SET, &offset, scratch_pool));
   SVN_ERR(svn_fs_fs__read_noderev(&noderev, rev_file->stream,
-                                  pool, pool));
+                                  scratch_pool, scratch_pool));
 
   /* Make sure EXPANDED_SIZE has the correct value for every rep. */
-  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->data_rep, pool));
-  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->prop_rep, pool));
+  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->data_rep,
+                                         scratch_pool));
+  SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, noderev->prop_rep,
+                                         scratch_pool));
 
   /* First reindex sub-directory to match write_final_rev() behavior. */
   if (noderev->kind == svn_node_dir)
     {
       apr_array_header_t *entries;
 
-      SVN_ERR(svn_fs_fs__rep_contents_dir(&entries, fs, noderev, pool, pool));
+      SVN_ERR(svn_fs_fs__rep_contents_dir(&entries, fs, noderev,
+                                          scratch_pool, scratch_pool));
 
       if (entries->nelts > 0)
         {
           int i;
           apr_pool_t *iterpool;
 
-          iterpool = svn_pool_create(pool);
+          iterpool = svn_pool_create(scratch_pool);
           for (i = 0; i < entries->nelts; i++)
             {
               const svn_fs_dirent_t *dirent;
@@ -2427,8 +2663,9 @@ reindex_node(svn_fs_t *fs,
 
               dirent = APR_ARRAY_IDX(entries, i, svn_fs_dirent_t *);
 
-              SVN_ERR(reindex_node(fs, dirent->id, rev, rev_file,
-                                   cancel_func, cancel_baton, iterpool));
+              SVN_ERR(reindex_node(reps, fs, dirent->id, rev, rev_file,
+                                   cancel_func, cancel_baton,
+                                   result_pool, iterpool));
             }
           svn_pool_destroy(iterpool);
         }
@@ -2437,23 +2674,300 @@ reindex_node(svn_fs_t *fs,
   if (noderev->data_rep && noderev->data_rep->revision == rev &&
       noderev->kind == svn_node_file)
     {
-      SVN_ERR(ensure_representation_sha1(fs, noderev->data_rep, pool));
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, noderev->data_rep, pool));
+      SVN_ERR(ensure_representation_sha1(fs, noderev->data_rep,
+                                         scratch_pool));
+      APR_ARRAY_PUSH(reps, representation_t *)
+        = svn_fs_fs__rep_copy(noderev->data_rep, result_pool);
     }
 
   if (noderev->prop_rep && noderev->prop_rep->revision == rev)
     {
-      SVN_ERR(ensure_representation_sha1(fs, noderev->prop_rep, pool));
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, noderev->prop_rep, pool));
+      SVN_ERR(ensure_representation_sha1(fs, noderev->prop_rep,
+                                         scratch_pool));
+      APR_ARRAY_PUSH(reps, representation_t *)
+        = svn_fs_fs__rep_copy(noderev->prop_rep, result_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Append all representations in revision REV of FS that belong into the
+ * rep-cache to REPS.  Allocate them in RESULT_POOL.  The optional
+ * CANCEL_FUNC will periodically be called with CANCEL_BATON.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+collect_rev_reps(apr_array_header_t *reps,
+                 svn_fs_t *fs,
+                 svn_revnum_t rev,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  svn_fs_id_t *root_id;
+  svn_fs_fs__revision_file_t *file;
+
+  SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&file, fs, rev,
+                                           scratch_pool, scratch_pool));
+  SVN_ERR(svn_fs_fs__rev_get_root(&root_id, fs, rev,
+                                  scratch_pool, scratch_pool));
+  SVN_ERR(reindex_node(reps, fs, root_id, rev, file, cancel_func,
+                       cancel_baton, result_pool, scratch_pool));
+
+  return svn_error_trace(svn_fs_fs__close_revision_file(file));
+}
+
+/* Rep-cache rows that have been collected but not been written to the
+ * database, yet.  See svn_fs_fs__build_rep_cache().
+ */
+typedef struct rep_batch_t
+{
+  /* The filesystem whose rep-cache we write to. */
+  svn_fs_t *fs;
+
+  /* The representation_t * to write, allocated in POOL. */
+  apr_array_header_t *reps;
+  apr_pool_t *pool;
+
+  /* First revision that has not been reported as processed, yet. */
+  svn_revnum_t first_rev;
+
+  /* Optional progress notification. */
+  svn_fs_progress_notify_func_t progress_func;
+  void *progress_baton;
+} rep_batch_t;
+
+/* Write all rows in BATCH to the rep-cache within a single SQLite
+ * transaction.  Then report all revisions up to and including LAST_REV
+ * as processed.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+flush_rep_batch(rep_batch_t *batch,
+                svn_revnum_t last_rev,
+                apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = batch->fs->fsap_data;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  if (batch->reps->nelts)
+    {
+      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
+      for (i = 0; i < batch->reps->nelts && !err; i++)
+        {
+          svn_pool_clear(iterpool);
+          err = svn_fs_fs__set_rep_reference(batch->fs,
+                                             APR_ARRAY_IDX(batch->reps, i,
+                                                           representation_t *),
+                                             iterpool);
+        }
+      SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db, err));
     }
 
+  /* Only report revisions that are fully covered by the rep-cache now.
+     Interrupted runs may thus be resumed just after the last revision
+     reported. */
+  if (batch->progress_func)
+    for (; batch->first_rev <= last_rev; batch->first_rev++)
+      {
+        svn_pool_clear(iterpool);
+        batch->progress_func(batch->first_rev, batch->progress_baton,
+                             iterpool);
+      }
+
+  batch->first_rev = last_rev + 1;
+  apr_array_clear(batch->reps);
+  svn_pool_clear(batch->pool);
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Add copies of the REPS found in revision REV to BATCH, flushing the
+ * batch to the database once it is large enough.  Revisions must be added
+ * in ascending order.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+add_to_rep_batch(rep_batch_t *batch,
+                 svn_revnum_t rev,
+                 apr_array_header_t *reps,
+                 apr_pool_t *scratch_pool)
+{
+  int i;
+  for (i = 0; i < reps->nelts; i++)
+    APR_ARRAY_PUSH(batch->reps, representation_t *)
+      = svn_fs_fs__rep_copy(APR_ARRAY_IDX(reps, i, representation_t *),
+                            batch->pool);
+
+  if (batch->reps->nelts >= BUILD_REP_CACHE_BATCH_SIZE)
+    SVN_ERR(flush_rep_batch(batch, rev, scratch_pool));
+
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* A single revision to be scanned by one of the workers of a concurrent
+ * rep-cache build.  See build_rep_cache_concurrently().
+ */
+typedef struct rev_scan_job_t
+{
+  /* The revision to scan. */
+  svn_revnum_t rev;
+
+  /* The job in the thread pool that scans REV. */
+  svn_thread_pool__job_t *job;
+
+  /* The representation_t * found in the revision, allocated in POOL.
+     Only valid once JOB has been waited for. */
+  apr_array_header_t *reps;
+
+  /* Root pool owned by whichever thread currently uses this job slot. */
+  apr_pool_t *pool;
+} rev_scan_job_t;
+
+/* Implements svn_thread_pool__worker_init_t.  Open a private instance of
+ * the svn_fs_t given as BATON for each worker.
+ */
+static svn_error_t *
+open_scan_fs(void **worker_baton,
+             void *baton,
+             int worker_index,
+             apr_pool_t *worker_pool)
+{
+  svn_fs_t *fs = baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs_t *worker_fs;
+
+  SVN_ERR(ffd->svn_fs_open_(&worker_fs, fs->path, fs->config,
+                            worker_pool, worker_pool));
+
+  *worker_baton = worker_fs;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Scan the revision of the
+ * rev_scan_job_t given as JOB_BATON, using the svn_fs_t given as
+ * WORKER_BATON.  All database access is left to the main thread.
+ */
+static svn_error_t *
+scan_rev_job(void *job_baton,
+             void *worker_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *scratch_pool)
+{
+  rev_scan_job_t *job = job_baton;
+
+  job->reps = apr_array_make(job->pool, 16, sizeof(representation_t *));
+
+  return svn_error_trace(collect_rev_reps(job->reps, worker_baton, job->rev,
+                                          cancel_func, cancel_baton,
+                                          job->pool, scratch_pool));
+}
+
+/* Feed the rep-cache rows of revisions START_REV through END_REV of FS
+ * into BATCH.  Scan the revisions concurrently, using JOBS separate
+ * threads and FS instances, while all database writes and notifications
+ * as well as the calls to the optional CANCEL_FUNC with CANCEL_BATON
+ * happen in the calling thread.  Rows are still being added to BATCH in
+ * ascending revision order.
+ *
+ * Use POOL for allocations.
+ */
+static svn_error_t *
+build_rep_cache_concurrently(rep_batch_t *batch,
+                             svn_fs_t *fs,
+                             svn_revnum_t start_rev,
+                             svn_revnum_t end_rev,
+                             int jobs,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *pool)
+{
+  svn_thread_pool__t *thread_pool;
+  rev_scan_job_t *slots;
+  int window;
+  int i;
+  svn_revnum_t rev;
+  svn_revnum_t next_rev = start_rev;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  /* More threads than revisions would be pointless. */
+  if (jobs > end_rev - start_rev + 1)
+    jobs = (int)(end_rev - start_rev + 1);
+
+  SVN_ERR(svn_thread_pool__create(&thread_pool, jobs, open_scan_fs, fs,
+                                  pool));
+
+  /* Allow the workers to get some revisions ahead of the main thread
+     but limit the memory being used to buffer their results. */
+  window = 4 * jobs;
+  slots = apr_pcalloc(pool, window * sizeof(*slots));
+  for (i = 0; i < window; ++i)
+    slots[i].pool = svn_thread_pool__create_root_pool(pool);
+
+  /* Consume the scan results strictly in revision order. */
+  iterpool = svn_pool_create(pool);
+  for (rev = start_rev; rev <= end_rev && !err; ++rev)
+    {
+      rev_scan_job_t *job = &slots[(rev - start_rev) % window];
+
+      svn_pool_clear(iterpool);
+
+      /* Refill the window with the revisions that become available. */
+      for (; next_rev <= end_rev && next_rev < rev + window && !err;
+           ++next_rev)
+        {
+          rev_scan_job_t *next = &slots[(next_rev - start_rev) % window];
+
+          next->rev = next_rev;
+          err = svn_thread_pool__submit(&next->job, thread_pool,
+                                        scan_rev_job, next);
+        }
+
+      if (err)
+        break;
+
+      if (cancel_func)
+        {
+          err = cancel_func(cancel_baton);
+          if (err)
+            break;
+        }
+
+      err = svn_thread_pool__wait(thread_pool, job->job,
+                                  cancel_func, cancel_baton);
+      if (err)
+        break;
+
+      err = add_to_rep_batch(batch, rev, job->reps, iterpool);
+
+      /* Release the slot for the next revision to scan. */
+      svn_pool_clear(job->pool);
+      job->reps = NULL;
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Stop all workers that may still be running and wait for them.
+     Results that we did not consume, including the cancellation errors
+     due to our abort, are irrelevant. */
+  err = svn_error_compose_create(err,
+                                 svn_thread_pool__join(thread_pool, TRUE));
+
+  return svn_error_trace(err);
+}
+
+#endif
+
 svn_error_t *
 svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                            svn_revnum_t start_rev,
                            svn_revnum_t end_rev,
+                           int jobs,
                            svn_fs_progress_notify_func_t progress_func,
                            void *progress_baton,
                            svn_cancel_func_t cancel_func,
@@ -2463,6 +2977,7 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
   fs_fs_data_t *ffd = fs->fsap_data;
   apr_pool_t *iterpool;
   svn_revnum_t rev;
+  rep_batch_t batch;
 
   if (ffd->format < SVN_FS_FS__MIN_REP_SHARING_FORMAT)
     {
@@ -2495,30 +3010,45 @@ svn_fs_fs__build_rep_cache(svn_fs_t *fs,
   if (!ffd->rep_cache_db)
     SVN_ERR(svn_fs_fs__open_rep_cache(fs, pool));
 
+  batch.fs = fs;
+  batch.pool = svn_pool_create(pool);
+  batch.reps = apr_array_make(pool, BUILD_REP_CACHE_BATCH_SIZE,
+                              sizeof(representation_t *));
+  batch.first_rev = start_rev;
+  batch.progress_func = progress_func;
+  batch.progress_baton = progress_baton;
+
+#if APR_HAS_THREADS
+  /* Concurrent scanning needs private FS instances for the workers. */
+  if (jobs > 1 && start_rev < end_rev && ffd->svn_fs_open_)
+    {
+      SVN_ERR(build_rep_cache_concurrently(&batch, fs, start_rev, end_rev,
+                                           jobs, cancel_func, cancel_baton,
+                                           pool));
+      SVN_ERR(flush_rep_batch(&batch, end_rev, pool));
+      svn_pool_destroy(batch.pool);
+
+      return SVN_NO_ERROR;
+    }
+#endif
+
   iterpool = svn_pool_create(pool);
   for (rev = start_rev; rev <= end_rev; rev++)
     {
-      svn_fs_id_t *root_id;
-      svn_fs_fs__revision_file_t *file;
-      svn_error_t *err;
+      apr_array_header_t *reps;
 
       svn_pool_clear(iterpool);
 
-      if (progress_func)
-        progress_func(rev, progress_baton, iterpool);
-
-      SVN_ERR(svn_fs_fs__open_pack_or_rev_file(&file, fs, rev,
-                                               iterpool, iterpool));
-      SVN_ERR(svn_fs_fs__rev_get_root(&root_id, fs, rev, iterpool, iterpool));
-
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = reindex_node(fs, root_id, rev, file, cancel_func, cancel_baton, iterpool);
-      SVN_ERR(svn_sqlite__finish_transaction(ffd->rep_cache_db, err));
-
-      SVN_ERR(svn_fs_fs__close_revision_file(file));
+      reps = apr_array_make(iterpool, 16, sizeof(representation_t *));
+      SVN_ERR(collect_rev_reps(reps, fs, rev, cancel_func, cancel_baton,
+                               iterpool, iterpool));
+      SVN_ERR(add_to_rep_batch(&batch, rev, reps, iterpool));
     }
 
+  SVN_ERR(flush_rep_batch(&batch, end_rev, iterpool));
+
   svn_pool_destroy(iterpool);
+  svn_pool_destroy(batch.pool);
 
   return SVN_NO_ERROR;
 }
@@ -174,6 +174,12 @@ svn_error_t *svn_fs_fs__set_uuid(svn_fs_t *fs,
 const char *
 svn_fs_fs__path_current(svn_fs_t *fs, apr_pool_t *pool);
 
+/* Return the path to the 'next' file in FS, i.e. the temporary file that
+   the new contents of 'current' get written to during a commit.
+   Perform allocation in POOL. */
+const char *
+svn_fs_fs__path_next(svn_fs_t *fs, apr_pool_t *pool);
+
 /* Write the format number and maximum number of files per directory
    for FS, possibly expecting to overwrite a previously existing file.
 
@@ -361,14 +367,21 @@ svn_fs_fs__revision_size(apr_off_t *rev_size,
  * SVN_INVALID_REVNUM, start at revision 1; if END_REV is SVN_INVALID_REVNUM,
  * end at the head revision. If the rep-cache does not exist, then create it.
  *
+ * Rows are written in large batches.  If JOBS is larger than 1, scan up to
+ * JOBS revisions concurrently; the rows are still being written in revision
+ * order by the calling thread.
+ *
  * Indicate progress via the optional PROGRESS_FUNC callback using
- * PROGRESS_BATON. The optional CANCEL_FUNC will periodically be called with
+ * PROGRESS_BATON.  A revision is only reported once all of its rows have
+ * been committed to the rep-cache, so an interrupted run may be resumed
+ * right after the last revision reported. The optional CANCEL_FUNC will periodically be called with
  * CANCEL_BATON to allow cancellation. Use POOL for temporary allocations.
  */
 svn_error_t *
 svn_fs_fs__build_rep_cache(svn_fs_t *fs,
                            svn_revnum_t start_rev,
                            svn_revnum_t end_rev,
+                           int jobs,
                            svn_fs_progress_notify_func_t progress_func,
                            void *progress_baton,
                            svn_cancel_func_t cancel_func,
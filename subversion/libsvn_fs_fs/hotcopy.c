@@ -22,9 +22,11 @@
 #include "svn_pools.h"
 #include "svn_path.h"
 #include "svn_dirent_uri.h"
+#include "private/svn_io_private.h"
 
 #include "fs_fs.h"
 #include "hotcopy.h"
+#include "lock-index.h"
 #include "util.h"
 #include "recovery.h"
 #include "revprops.h"
@@ -34,6 +36,48 @@
 
 #include "svn_private_config.h"
 
+/* Copy FILE from SRC_PATH to DST_PATH, replacing any existing copy, and
+ * copy its permissions.  Where the file system supports it, make the
+ * copy a copy-on-write clone of the source, so that copying large pack
+ * files takes neither time nor disk space.  Otherwise, fall back to
+ * svn_io_dir_file_copy().  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+hotcopy_clone_or_copy_file(const char *src_path,
+                           const char *dst_path,
+                           const char *file,
+                           apr_pool_t *scratch_pool)
+{
+  const char *src_target = svn_dirent_join(src_path, file, scratch_pool);
+  const char *dst_target = svn_dirent_join(dst_path, file, scratch_pool);
+  const char *tmp_target;
+  svn_error_t *err;
+
+  /* Clone into a temporary file next to the target, so that the target
+   * gets replaced atomically just like svn_io_copy_file() would do. */
+  SVN_ERR(svn_io_open_unique_file3(NULL, &tmp_target, dst_path,
+                                   svn_io_file_del_none,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_remove_file2(tmp_target, FALSE, scratch_pool));
+
+  err = svn_io__file_clone(src_target, tmp_target, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+    {
+      svn_error_clear(err);
+      return svn_error_trace(svn_io_dir_file_copy(src_path, dst_path, file,
+                                                  scratch_pool));
+    }
+  SVN_ERR(err);
+
+  err = svn_io_copy_perms(src_target, tmp_target, scratch_pool);
+  if (!err)
+    err = svn_io_file_rename2(tmp_target, dst_target, FALSE, scratch_pool);
+  if (err)
+    return svn_error_compose_create(
+             err, svn_io_remove_file2(tmp_target, TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Like svn_io_dir_file_copy(), but doesn't copy files that exist at
  * the destination and do not differ in terms of kind, size, and mtime.
  * Set *SKIPPED_P to FALSE only if the file was copied, do not change
@@ -72,8 +116,8 @@ hotcopy_io_dir_file_copy(svn_boolean_t *skipped_p,
   if (skipped_p)
     *skipped_p = FALSE;
 
-  return svn_error_trace(svn_io_dir_file_copy(src_path, dst_path, file,
-                                              scratch_pool));
+  return svn_error_trace(hotcopy_clone_or_copy_file(src_path, dst_path, file,
+                                                    scratch_pool));
 }
 
 /* Set *NAME_P to the UTF-8 representation of directory entry NAME.
@@ -945,10 +989,17 @@ hotcopy_body(void *baton, apr_pool_t *pool)
                                        src_next_copy_id, pool));
     }
 
+  /* Readers of the destination may have cached revprops that we just
+   * replaced. */
+  SVN_ERR(svn_fs_fs__bump_revprop_generation(dst_fs, pool));
+
   /* Replace the locks tree.
    * This is racy in case readers are currently trying to list locks in
    * the destination. However, we need to get rid of stale locks.
-   * This is the simplest way of doing this, so we accept this small race. */
+   * This is the simplest way of doing this, so we accept this small race.
+   * The lock index of the destination would be stale afterwards; it gets
+   * rebuilt from the new locks tree when next needed. */
+  SVN_ERR(svn_fs_fs__remove_lock_index(dst_fs->path, pool));
   dst_subdir = svn_dirent_join(dst_fs->path, PATH_LOCKS_DIR, pool);
   SVN_ERR(svn_io_remove_dir2(dst_subdir, TRUE, cancel_func, cancel_baton,
                              pool));
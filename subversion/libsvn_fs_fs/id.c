@@ -621,6 +621,25 @@ svn_fs_fs__id_serialize(svn_temp_serializer__context_t *context,
                                 sizeof(fs_fs__id_t));
 }
 
+svn_fs_id_t *
+svn_fs_fs__id_extract(const void *buffer,
+                      const svn_fs_id_t * const *id,
+                      apr_pool_t *result_pool)
+{
+  const fs_fs__id_t *source
+    = svn_temp_deserializer__ptr(buffer, (const void * const *)id);
+  fs_fs__id_t *result;
+
+  if (source == NULL)
+    return NULL;
+
+  result = apr_pmemdup(result_pool, source, sizeof(*source));
+  result->generic_id.vtable = &id_vtable;
+  result->generic_id.fsap_data = result;
+
+  return &result->generic_id;
+}
+
 /* Deserialize an ID inside the BUFFER.
  */
 void
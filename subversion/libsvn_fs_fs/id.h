@@ -149,6 +149,16 @@ void
 svn_fs_fs__id_serialize(struct svn_temp_serializer__context_t *context,
                         const svn_fs_id_t * const *id);
 
+/**
+ * Return a deserialized copy of the serialized id that @a *id refers to
+ * within the read-only @a buffer.  Allocate it in @a result_pool.
+ * Return @c NULL for @c NULL ids.
+ */
+svn_fs_id_t *
+svn_fs_fs__id_extract(const void *buffer,
+                      const svn_fs_id_t * const *id,
+                      apr_pool_t *result_pool);
+
 /**
  * Deserialize an @a id within the @a buffer.
  */
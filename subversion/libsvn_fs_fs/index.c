@@ -186,6 +186,16 @@ struct svn_fs_fs__packed_number_stream_t
   /* underlying data file containing the packed values */
   apr_file_t *file;
 
+  /* revision file that FILE belongs to; used for I/O tracing only */
+  svn_fs_fs__revision_file_t *rev_file;
+
+  /* reason reported for reads from this stream when tracing I/O */
+  svn_fs_fs__io_cause_t cause;
+
+  /* If not NULL, a read-only mapping of FILE covering at least everything
+   * up to STREAM_END.  We will then read from here instead of FILE. */
+  const unsigned char *mapped_data;
+
   /* Offset within FILE at which the stream data starts
    * (i.e. which offset will reported as offset 0 by packed_stream_offset). */
   apr_off_t stream_start;
@@ -264,10 +274,16 @@ packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
   /* packed numbers are usually not aligned to MAX_NUMBER_PREFETCH blocks,
    * i.e. the last number has been incomplete (and not buffered in stream)
    * and need to be re-read.  Therefore, always correct the file pointer.
+   * Mapped data has no file pointer but we still want the same block
+   * alignment heuristics to apply.
    */
-  SVN_ERR(svn_io_file_aligned_seek(stream->file, stream->block_size,
-                                   &block_start, stream->next_offset,
-                                   stream->pool));
+  if (stream->mapped_data)
+    block_start = stream->next_offset
+                - stream->next_offset % stream->block_size;
+  else
+    SVN_ERR(svn_io_file_aligned_seek(stream->file, stream->block_size,
+                                     &block_start, stream->next_offset,
+                                     stream->pool));
 
   /* prefetch at least one number but, if feasible, don't cross block
    * boundaries.  This shall prevent jumping back and forth between two
@@ -283,10 +299,21 @@ packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
   bytes_read = (apr_size_t)MIN(bytes_read,
                                stream->stream_end - stream->next_offset);
 
-  err = apr_file_read(stream->file, buffer, &bytes_read);
-  if (err && !APR_STATUS_IS_EOF(err))
-    return stream_error_create(stream, err,
-      _("Can't read index file '%s' at offset 0x%s"));
+  svn_fs_fs__trace_read(stream->rev_file, stream->cause, stream->next_offset,
+                        bytes_read);
+
+  if (stream->mapped_data)
+    {
+      memcpy(buffer, stream->mapped_data + stream->next_offset, bytes_read);
+      err = APR_SUCCESS;
+    }
+  else
+    {
+      err = apr_file_read(stream->file, buffer, &bytes_read);
+      if (err && !APR_STATUS_IS_EOF(err))
+        return stream_error_create(stream, err,
+          _("Can't read index file '%s' at offset 0x%s"));
+    }
 
   /* if the last number is incomplete, trim it from the buffer */
   while (bytes_read > 0 && buffer[bytes_read-1] >= 0x80)
@@ -344,33 +371,45 @@ packed_stream_read(svn_fs_fs__packed_number_stream_t *stream)
 }
 
 /* Create and open a packed number stream reading from offsets START to
- * END in FILE and return it in *STREAM.  Access the file in chunks of
- * BLOCK_SIZE bytes.  Expect the stream to be prefixed by STREAM_PREFIX.
+ * END in REV_FILE and return it in *STREAM.  Access the file in chunks of
+ * BLOCK_SIZE bytes or use its memory mapping, if available.  Expect the stream to be prefixed by STREAM_PREFIX.
+ * Report reads from the stream as CAUSE when tracing I/O.
  * Allocate *STREAM in RESULT_POOL and use SCRATCH_POOL for temporaries.
  */
 static svn_error_t *
 packed_stream_open(svn_fs_fs__packed_number_stream_t **stream,
-                   apr_file_t *file,
+                   svn_fs_fs__revision_file_t *rev_file,
                    apr_off_t start,
                    apr_off_t end,
                    const char *stream_prefix,
                    apr_size_t block_size,
+                   svn_fs_fs__io_cause_t cause,
                    apr_pool_t *result_pool,
                    apr_pool_t *scratch_pool)
 {
   char buffer[STREAM_PREFIX_LEN + 1] = { 0 };
   apr_size_t len = strlen(stream_prefix);
   svn_fs_fs__packed_number_stream_t *result;
+  const char *mapped_data
+    = svn_fs_fs__rev_file_mapped_data(rev_file, 0, (apr_size_t)end);
 
   /* If this is violated, we forgot to adjust STREAM_PREFIX_LEN after
    * changing the index header prefixes. */
   SVN_ERR_ASSERT(len < sizeof(buffer));
 
   /* Read the header prefix and compare it with the expected prefix */
-  SVN_ERR(svn_io_file_aligned_seek(file, block_size, NULL, start,
-                                   scratch_pool));
-  SVN_ERR(svn_io_file_read_full2(file, buffer, len, NULL, NULL,
-                                 scratch_pool));
+  svn_fs_fs__trace_read(rev_file, cause, start, len);
+  if (mapped_data && start + (apr_off_t)len <= end)
+    {
+      memcpy(buffer, mapped_data + start, len);
+    }
+  else
+    {
+      SVN_ERR(svn_io_file_aligned_seek(rev_file->file, block_size, NULL,
+                                       start, scratch_pool));
+      SVN_ERR(svn_io_file_read_full2(rev_file->file, buffer, len, NULL, NULL,
+                                     scratch_pool));
+    }
 
   if (strncmp(buffer, stream_prefix, len))
     return svn_error_createf(SVN_ERR_FS_INDEX_CORRUPTION, NULL,
@@ -382,7 +421,10 @@ packed_stream_open(svn_fs_fs__packed_number_stream_t **stream,
   result = apr_palloc(result_pool, sizeof(*result));
 
   result->pool = result_pool;
-  result->file = file;
+  result->file = rev_file->file;
+  result->rev_file = rev_file;
+  result->cause = cause;
+  result->mapped_data = (const unsigned char *)mapped_data;
   result->stream_start = start + len;
   result->stream_end = end;
 
@@ -946,11 +988,12 @@ auto_open_l2p_index(svn_fs_fs__revision_file_t *rev_file,
 
       SVN_ERR(svn_fs_fs__auto_read_footer(rev_file));
       SVN_ERR(packed_stream_open(&rev_file->l2p_stream,
-                                 rev_file->file,
+                                 rev_file,
                                  rev_file->l2p_offset,
                                  rev_file->p2l_offset,
                                  L2P_STREAM_PREFIX,
                                  (apr_size_t)ffd->block_size,
+                                 svn_fs_fs__io_l2p_index,
                                  rev_file->pool,
                                  rev_file->pool));
     }
@@ -1521,6 +1564,50 @@ l2p_entry_access_func(void **out,
   return l2p_page_get_entry(baton, page, offsets, result_pool);
 }
 
+/* Number of consecutive sequential index cache misses after which we
+ * start reading ahead of the current block. */
+#define READAHEAD_THRESHOLD 2
+
+/* Upper limit to the number of index blocks to read per cache miss. */
+#define MAX_READAHEAD_BLOCKS 16
+
+/* Record an index cache miss in STATE for the data starting at START_OFFSET
+ * in the index of the rev / pack file beginning with FIRST_REVISION.  The
+ * block containing that data ends at BLOCK_END.  Return the index offset
+ * up to which the caller shall prefetch pages.  BLOCK_SIZE is the FS'
+ * read block size.
+ *
+ * As long as the misses don't continue where the previous ones stopped,
+ * this will simply return BLOCK_END, i.e. only pages that have already
+ * been read from disk get prefetched.  With sequential access patterns,
+ * the read-ahead will double with every further miss up to
+ * MAX_READAHEAD_BLOCKS blocks.
+ */
+static apr_off_t
+readahead_end(index_readahead_t *state,
+              svn_revnum_t first_revision,
+              apr_off_t start_offset,
+              apr_off_t block_end,
+              apr_int64_t block_size)
+{
+  int blocks = 1;
+  svn_boolean_t sequential
+    =    state->first_revision == first_revision
+      && start_offset + block_size > state->end_offset
+      && start_offset < state->end_offset + block_size;
+
+  state->first_revision = first_revision;
+  state->sequential_misses = sequential ? state->sequential_misses + 1 : 0;
+
+  if (state->sequential_misses >= READAHEAD_THRESHOLD)
+    blocks = MIN(1 << MIN(state->sequential_misses - READAHEAD_THRESHOLD + 1,
+                          4),
+                 MAX_READAHEAD_BLOCKS);
+
+  state->end_offset = block_end + (blocks - 1) * block_size;
+  return state->end_offset;
+}
+
 /* Using the log-to-phys indexes in FS, find the absolute offset in the
  * rev file for (REVISION, ITEM_INDEX) and return it in *OFFSET.
  * Use SCRATCH_POOL for temporary allocations.
@@ -1590,6 +1677,12 @@ l2p_index_lookup(apr_off_t *offset,
         {
           apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
+          /* Read further ahead if we are being accessed sequentially. */
+          max_offset = readahead_end(&ffd->l2p_readahead,
+                                     info_baton.first_revision,
+                                     info_baton.entry.offset, max_offset,
+                                     ffd->block_size);
+
           /* prefetch pages from following and preceding revisions */
           pages = apr_array_make(scratch_pool, 16,
                                  sizeof(l2p_page_table_entry_t));
@@ -2138,11 +2231,12 @@ auto_open_p2l_index(svn_fs_fs__revision_file_t *rev_file,
 
       SVN_ERR(svn_fs_fs__auto_read_footer(rev_file));
       SVN_ERR(packed_stream_open(&rev_file->p2l_stream,
-                                 rev_file->file,
+                                 rev_file,
                                  rev_file->p2l_offset,
                                  rev_file->footer_offset,
                                  P2L_STREAM_PREFIX,
                                  (apr_size_t)ffd->block_size,
+                                 svn_fs_fs__io_p2l_index,
                                  rev_file->pool,
                                  rev_file->pool));
     }
@@ -2817,6 +2911,12 @@ p2l_index_lookup(apr_array_header_t *entries,
       /* pre-fetch following pages */
       if (ffd->use_block_read)
         {
+          /* Read further ahead if we are being accessed sequentially. */
+          max_offset = readahead_end(&ffd->p2l_readahead,
+                                     page_info.first_revision,
+                                     page_info.start_offset, max_offset,
+                                     ffd->block_size);
+
           end = FALSE;
           leaking_bucket = 4;
           prefetch_info = page_info;
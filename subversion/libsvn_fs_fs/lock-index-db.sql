@@ -0,0 +1,65 @@
+/* lock-index-db.sql -- schema for use in the FSFS lock index
+ *   This is intended for use with SQLite 3
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+-- STMT_CREATE_SCHEMA
+/* A copy of all locks in the digest files below the locks directory,
+   keyed by the canonical fspath of the locked node.  EXPIRATION_DATE is
+   0 for locks that don't expire.  The schema version is only set once
+   the table has been filled, so an index with version 0 is incomplete. */
+CREATE TABLE locks (
+  path TEXT NOT NULL PRIMARY KEY,
+  token TEXT NOT NULL,
+  owner TEXT NOT NULL,
+  comment TEXT,
+  is_dav_comment INTEGER NOT NULL,
+  creation_date INTEGER NOT NULL,
+  expiration_date INTEGER NOT NULL
+  ) WITHOUT ROWID;
+
+-- STMT_SET_SCHEMA_VERSION
+PRAGMA USER_VERSION = 1;
+
+-- STMT_GET_LOCK
+SELECT path, token, owner, comment, is_dav_comment, creation_date,
+       expiration_date
+FROM locks
+WHERE path = ?1
+
+/* Locks on ?1 and below.  ?2 and ?3 are ?1 with '/' and '0' appended,
+   or just '/' and '0' for the root, such that the range covers exactly
+   the descendants of ?1. */
+-- STMT_GET_LOCKS
+SELECT path, token, owner, comment, is_dav_comment, creation_date,
+       expiration_date
+FROM locks
+WHERE path = ?1 OR (path > ?2 AND path < ?3)
+ORDER BY path
+
+-- STMT_SET_LOCK
+INSERT OR REPLACE INTO locks (path, token, owner, comment, is_dav_comment,
+                              creation_date, expiration_date)
+VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)
+
+-- STMT_DELETE_LOCK
+DELETE FROM locks
+WHERE path = ?1
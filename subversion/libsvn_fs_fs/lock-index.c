@@ -0,0 +1,365 @@
+/* lock-index.c --- the indexed lock storage for fsfs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_dirent_uri.h"
+
+#include "svn_private_config.h"
+
+#include "fs_fs.h"
+#include "fs.h"
+#include "lock-index.h"
+#include "util.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_sqlite.h"
+
+#include "lock-index-db.h"
+
+LOCK_INDEX_DB_SQL_DECLARE_STATEMENTS(statements);
+
+
+
+/** Helper functions. **/
+static APR_INLINE const char *
+path_lock_index_db(const char *fs_path,
+                   apr_pool_t *result_pool)
+{
+  return svn_dirent_join(fs_path, LOCK_INDEX_DB_NAME, result_pool);
+}
+
+/* Open the lock index of FS, if it exists or if CREATE is set, and
+   update FFD->LOCK_INDEX_COMPLETE.  Leave FFD->LOCK_INDEX_DB as NULL
+   if the index does not exist and CREATE is not set.
+   Use POOL for temporary allocations. */
+static svn_error_t *
+open_lock_index(svn_fs_t *fs,
+                svn_boolean_t create,
+                apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  int version;
+
+  if (!ffd->lock_index_db)
+    {
+      const char *db_path = path_lock_index_db(fs->path, pool);
+      svn_sqlite__db_t *sdb;
+      svn_node_kind_t kind;
+
+      SVN_ERR(svn_io_check_path(db_path, &kind, pool));
+      if (kind == svn_node_none)
+        {
+          if (!create)
+            return SVN_NO_ERROR;
+
+#ifndef WIN32
+          {
+            /* Like the rep cache, a new index gets the permissions of the
+               repository as a whole rather than those of our umask. */
+            const char *current = svn_fs_fs__path_current(fs, pool);
+            svn_error_t *err = svn_io_file_create_empty(db_path, pool);
+
+            if (err && !APR_STATUS_IS_EEXIST(err->apr_err))
+              return svn_error_trace(err);
+            else if (err)
+              svn_error_clear(err);
+            else
+              SVN_ERR(svn_io_copy_perms(current, db_path, pool));
+          }
+#endif
+        }
+
+      /* It will be automatically closed when fs->pool is destroyed. */
+      SVN_ERR(svn_sqlite__open(&sdb, db_path,
+                               svn_sqlite__mode_rwcreate, statements,
+                               0, NULL, 0,
+                               fs->pool, pool));
+      ffd->lock_index_db = sdb;
+    }
+
+  /* Another process may have completed the index since we last looked. */
+  if (!ffd->lock_index_complete)
+    {
+      SVN_ERR(svn_sqlite__read_schema_version(&version, ffd->lock_index_db,
+                                              pool));
+      ffd->lock_index_complete = (version >= 1);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Like open_lock_index() but with a helpful error message. */
+static svn_error_t *
+open_lock_index_wrapped(svn_fs_t *fs,
+                        svn_boolean_t create,
+                        apr_pool_t *pool)
+{
+  svn_error_t *err = open_lock_index(fs, create, pool);
+  return svn_error_quick_wrapf(err,
+                               _("Couldn't open lock index '%s'"),
+                               svn_dirent_local_style(
+                                 path_lock_index_db(fs->path, pool),
+                                 pool));
+}
+
+/* Write all svn_lock_t * in LOCKS to SDB.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+set_locks(svn_sqlite__db_t *sdb,
+          const apr_array_header_t *locks,
+          apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < locks->nelts; ++i)
+    {
+      const svn_lock_t *lock = APR_ARRAY_IDX(locks, i, const svn_lock_t *);
+      svn_sqlite__stmt_t *stmt;
+
+      SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_LOCK));
+      SVN_ERR(svn_sqlite__bindf(stmt, "ssssdii",
+                                lock->path, lock->token, lock->owner,
+                                lock->comment, lock->is_dav_comment ? 1 : 0,
+                                (apr_int64_t)lock->creation_date,
+                                (apr_int64_t)lock->expiration_date));
+      SVN_ERR(svn_sqlite__step_done(stmt));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Create the schema of SDB and add the svn_lock_t * in LOCKS to it.
+   Only then mark the index as complete.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+fill_lock_index(svn_sqlite__db_t *sdb,
+                const apr_array_header_t *locks,
+                apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_sqlite__exec_statements(sdb, STMT_CREATE_SCHEMA));
+  SVN_ERR(set_locks(sdb, locks, scratch_pool));
+  SVN_ERR(svn_sqlite__exec_statements(sdb, STMT_SET_SCHEMA_VERSION));
+
+  return SVN_NO_ERROR;
+}
+
+/* Delete the locks on the const char * in PATHS from SDB.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+delete_locks(svn_sqlite__db_t *sdb,
+             const apr_array_header_t *paths,
+             apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_sqlite__stmt_t *stmt;
+
+      SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_DELETE_LOCK));
+      SVN_ERR(svn_sqlite__bindf(stmt, "s", path));
+      SVN_ERR(svn_sqlite__step_done(stmt));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the lock in the current row of STMT, allocated in RESULT_POOL. */
+static svn_lock_t *
+lock_from_row(svn_sqlite__stmt_t *stmt,
+              apr_pool_t *result_pool)
+{
+  svn_lock_t *lock = svn_lock_create(result_pool);
+
+  lock->path = svn_sqlite__column_text(stmt, 0, result_pool);
+  lock->token = svn_sqlite__column_text(stmt, 1, result_pool);
+  lock->owner = svn_sqlite__column_text(stmt, 2, result_pool);
+  lock->comment = svn_sqlite__column_text(stmt, 3, result_pool);
+  lock->is_dav_comment = svn_sqlite__column_boolean(stmt, 4);
+  lock->creation_date = svn_sqlite__column_int64(stmt, 5);
+  lock->expiration_date = svn_sqlite__column_int64(stmt, 6);
+
+  return lock;
+}
+
+
+/** Library-private API's. **/
+
+svn_error_t *
+svn_fs_fs__lock_index_usable(svn_boolean_t *usable,
+                             svn_fs_t *fs,
+                             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err;
+
+  *usable = FALSE;
+  if (!ffd->lock_index)
+    return SVN_NO_ERROR;
+
+  err = open_lock_index(fs, FALSE, scratch_pool);
+  if (err)
+    {
+      /* The digest files will do. */
+      svn_error_clear(err);
+      ffd->lock_index = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  *usable = ffd->lock_index_db && ffd->lock_index_complete;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__open_lock_index(svn_boolean_t *maintained,
+                           svn_boolean_t *needs_fill,
+                           svn_fs_t *fs,
+                           apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  /* Unlike readers, writers must not ignore an existing index or it
+     would get out of sync with the digest files. */
+  SVN_ERR(open_lock_index_wrapped(fs, ffd->lock_index, scratch_pool));
+
+  *maintained = ffd->lock_index_db && ffd->lock_index_complete;
+  *needs_fill = ffd->lock_index_db && !ffd->lock_index_complete
+             && ffd->lock_index;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__fill_lock_index(svn_fs_t *fs,
+                           const apr_array_header_t *locks,
+                           apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  SVN_ERR_ASSERT(ffd->lock_index_db && !ffd->lock_index_complete);
+
+  SVN_SQLITE__WITH_TXN(fill_lock_index(ffd->lock_index_db, locks,
+                                       scratch_pool),
+                       ffd->lock_index_db);
+  ffd->lock_index_complete = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__index_locks(svn_fs_t *fs,
+                       const apr_array_header_t *locks,
+                       apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  SVN_ERR_ASSERT(ffd->lock_index_db && ffd->lock_index_complete);
+
+  SVN_SQLITE__WITH_TXN(set_locks(ffd->lock_index_db, locks, scratch_pool),
+                       ffd->lock_index_db);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__unindex_locks(svn_fs_t *fs,
+                         const apr_array_header_t *paths,
+                         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  SVN_ERR_ASSERT(ffd->lock_index_db && ffd->lock_index_complete);
+
+  SVN_SQLITE__WITH_TXN(delete_locks(ffd->lock_index_db, paths,
+                                    scratch_pool),
+                       ffd->lock_index_db);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__get_indexed_lock(svn_lock_t **lock_p,
+                            svn_fs_t *fs,
+                            const char *path,
+                            apr_pool_t *result_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->lock_index_db,
+                                    STMT_GET_LOCK));
+  SVN_ERR(svn_sqlite__bindf(stmt, "s", path));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  *lock_p = have_row ? lock_from_row(stmt, result_pool) : NULL;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_fs_fs__get_indexed_locks(apr_array_header_t **locks,
+                             svn_fs_t *fs,
+                             const char *path,
+                             apr_pool_t *result_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  const char *below_start, *below_end;
+
+  /* All paths below PATH sort between PATH + "/" and PATH + "0". */
+  if (svn_fspath__is_root(path, strlen(path)))
+    {
+      below_start = "/";
+      below_end = "0";
+    }
+  else
+    {
+      below_start = apr_pstrcat(result_pool, path, "/", SVN_VA_NULL);
+      below_end = apr_pstrcat(result_pool, path, "0", SVN_VA_NULL);
+    }
+
+  *locks = apr_array_make(result_pool, 16, sizeof(svn_lock_t *));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->lock_index_db,
+                                    STMT_GET_LOCKS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "sss", path, below_start, below_end));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      APR_ARRAY_PUSH(*locks, svn_lock_t *) = lock_from_row(stmt,
+                                                           result_pool);
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_fs_fs__remove_lock_index(const char *fs_path,
+                             apr_pool_t *pool)
+{
+  return svn_error_trace(svn_io_remove_file2(path_lock_index_db(fs_path,
+                                                                pool),
+                                             TRUE, pool));
+}
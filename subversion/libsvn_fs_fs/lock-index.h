@@ -0,0 +1,124 @@
+/* lock-index.h : interface to the lock index db functions
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_LOCK_INDEX_H
+#define SVN_LIBSVN_FS_FS_LOCK_INDEX_H
+
+#include "svn_error.h"
+#include "svn_types.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+#define LOCK_INDEX_DB_NAME  "lock-index.db"
+
+/* The lock index is a copy of all locks of the filesystem in a single
+   table keyed by path, such that looking up the locks on and below some
+   path becomes a range query instead of a walk through digest files.
+   The digest files below the locks directory remain authoritative.
+
+   The index is only consulted if enabled in fsfs.conf, but it is kept
+   consistent with the digest files whenever the database file exists.
+   It is created and filled by the first lock or unlock operation after
+   it has been enabled.  All callers of the functions below that modify
+   the index must hold the FS write lock. */
+
+/* Set *USABLE to TRUE if the lock index of FS has been enabled and
+   is complete, i.e. may be used to answer lock queries.  If the index
+   can't be opened, stop using it for FS and set *USABLE to FALSE.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__lock_index_usable(svn_boolean_t *usable,
+                             svn_fs_t *fs,
+                             apr_pool_t *scratch_pool);
+
+/* Prepare the lock index of FS for modification.  Set *MAINTAINED to
+   TRUE if the index exists and is complete and must therefore be kept
+   up to date.  If the index has been enabled but is not complete yet,
+   set *NEEDS_FILL to TRUE; the caller is then expected to call
+   svn_fs_fs__fill_lock_index().  Otherwise set it to FALSE.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__open_lock_index(svn_boolean_t *maintained,
+                           svn_boolean_t *needs_fill,
+                           svn_fs_t *fs,
+                           apr_pool_t *scratch_pool);
+
+/* Initialize the lock index of FS with the svn_lock_t * in LOCKS, which
+   must be all locks of FS, and mark it complete.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__fill_lock_index(svn_fs_t *fs,
+                           const apr_array_header_t *locks,
+                           apr_pool_t *scratch_pool);
+
+/* Add the svn_lock_t * in LOCKS to the lock index of FS, replacing any
+   existing locks on the same paths, in a single SQLite transaction.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__index_locks(svn_fs_t *fs,
+                       const apr_array_header_t *locks,
+                       apr_pool_t *scratch_pool);
+
+/* Remove the locks on the const char * fspaths in PATHS from the lock
+   index of FS in a single SQLite transaction.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__unindex_locks(svn_fs_t *fs,
+                         const apr_array_header_t *paths,
+                         apr_pool_t *scratch_pool);
+
+/* Set *LOCK_P to the lock on the canonical fspath PATH in the lock index
+   of FS, or to NULL if there is none.  Expired locks are returned as well.
+   Allocate *LOCK_P in RESULT_POOL.  The index must be usable, see
+   svn_fs_fs__lock_index_usable(). */
+svn_error_t *
+svn_fs_fs__get_indexed_lock(svn_lock_t **lock_p,
+                            svn_fs_t *fs,
+                            const char *path,
+                            apr_pool_t *result_pool);
+
+/* Set *LOCKS to an array of all svn_lock_t * on and below the canonical
+   fspath PATH in the lock index of FS, sorted by path.  Expired locks are
+   returned as well.  Allocate *LOCKS in RESULT_POOL.  The index must be
+   usable, see svn_fs_fs__lock_index_usable(). */
+svn_error_t *
+svn_fs_fs__get_indexed_locks(apr_array_header_t **locks,
+                             svn_fs_t *fs,
+                             const char *path,
+                             apr_pool_t *result_pool);
+
+/* Remove the lock index of the filesystem at FS_PATH, if it exists.
+   Use POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__remove_lock_index(const char *fs_path,
+                             apr_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_LOCK_INDEX_H */
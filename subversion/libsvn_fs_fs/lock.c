@@ -34,6 +34,7 @@
 #include <apr_file_info.h>
 
 #include "lock.h"
+#include "lock-index.h"
 #include "tree.h"
 #include "fs_fs.h"
 #include "util.h"
@@ -472,15 +473,24 @@ get_lock(svn_lock_t **lock_p,
          apr_pool_t *pool)
 {
   svn_lock_t *lock = NULL;
-  const char *digest_path;
-  svn_node_kind_t kind;
-
-  SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
-  SVN_ERR(svn_io_check_path(digest_path, &kind, pool));
+  svn_boolean_t use_index;
 
   *lock_p = NULL;
-  if (kind != svn_node_none)
-    SVN_ERR(read_digest_file(NULL, &lock, fs->path, digest_path, pool));
+  SVN_ERR(svn_fs_fs__lock_index_usable(&use_index, fs, pool));
+  if (use_index)
+    {
+      SVN_ERR(svn_fs_fs__get_indexed_lock(&lock, fs, path, pool));
+    }
+  else
+    {
+      const char *digest_path;
+      svn_node_kind_t kind;
+
+      SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
+      SVN_ERR(svn_io_check_path(digest_path, &kind, pool));
+      if (kind != svn_node_none)
+        SVN_ERR(read_digest_file(NULL, &lock, fs->path, digest_path, pool));
+    }
 
   if (! lock)
     return must_exist ? SVN_FS__ERR_NO_SUCH_LOCK(fs, path) : SVN_NO_ERROR;
@@ -594,6 +604,167 @@ walk_locks(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+/* Like walk_locks() but use the lock index of FS to find all locks in and
+   under PATH. */
+static svn_error_t *
+walk_indexed_locks(svn_fs_t *fs,
+                   const char *path,
+                   svn_fs_get_locks_callback_t get_locks_func,
+                   void *get_locks_baton,
+                   svn_boolean_t have_write_lock,
+                   apr_pool_t *pool)
+{
+  apr_array_header_t *locks;
+  apr_pool_t *iterpool;
+  int i;
+
+  /* Fetch all locks before invoking any callbacks, as removing expired
+     locks modifies the index. */
+  SVN_ERR(svn_fs_fs__get_indexed_locks(&locks, fs, path, pool));
+
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < locks->nelts; ++i)
+    {
+      svn_lock_t *lock = APR_ARRAY_IDX(locks, i, svn_lock_t *);
+      svn_pool_clear(iterpool);
+
+      if (lock_expired(lock))
+        {
+          /* Only remove the lock if we have the write lock.
+             Read operations shouldn't change the filesystem. */
+          if (have_write_lock)
+            SVN_ERR(unlock_single(fs, lock, iterpool));
+        }
+      else
+        {
+          SVN_ERR(get_locks_func(get_locks_baton, lock, iterpool));
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Call GET_LOCKS_FUNC/GET_LOCKS_BATON for all locks in and under the
+   canonical fspath PATH in FS, using the lock index if possible.
+   HAVE_WRITE_LOCK should be true if the caller (directly or indirectly)
+   has the FS write lock. */
+static svn_error_t *
+find_locks(svn_fs_t *fs,
+           const char *path,
+           svn_fs_get_locks_callback_t get_locks_func,
+           void *get_locks_baton,
+           svn_boolean_t have_write_lock,
+           apr_pool_t *pool)
+{
+  svn_boolean_t use_index;
+  const char *digest_path;
+
+  SVN_ERR(svn_fs_fs__lock_index_usable(&use_index, fs, pool));
+  if (use_index)
+    return svn_error_trace(walk_indexed_locks(fs, path, get_locks_func,
+                                              get_locks_baton,
+                                              have_write_lock, pool));
+
+  /* Get the top digest path in our tree of interest, and then walk it. */
+  SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
+  return svn_error_trace(walk_locks(fs, digest_path, get_locks_func,
+                                    get_locks_baton, have_write_lock, pool));
+}
+
+/* Set *LOCKS to an array of all svn_lock_t * in FS as recorded in the
+   digest files, including expired ones.  Use POOL for all allocations. */
+static svn_error_t *
+read_all_locks(apr_array_header_t **locks,
+               svn_fs_t *fs,
+               apr_pool_t *pool)
+{
+  const char *digest_path;
+  apr_hash_t *children;
+  apr_hash_index_t *hi;
+
+  *locks = apr_array_make(pool, 16, sizeof(svn_lock_t *));
+
+  /* The root digest file lists the digests of all locked paths. */
+  SVN_ERR(digest_path_from_path(&digest_path, fs->path, "/", pool));
+  SVN_ERR(read_digest_file(&children, NULL, fs->path, digest_path, pool));
+  for (hi = apr_hash_first(pool, children); hi; hi = apr_hash_next(hi))
+    {
+      const char *digest = apr_hash_this_key(hi);
+      svn_lock_t *lock;
+
+      SVN_ERR(read_digest_file
+              (NULL, &lock, fs->path,
+               digest_path_from_digest(fs->path, digest, pool), pool));
+      if (lock)
+        APR_ARRAY_PUSH(*locks, svn_lock_t *) = lock;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Prepare the lock index of FS for modification, filling it from the
+   digest files if it has just been enabled.  Set *MAINTAINED to TRUE if
+   the index must be kept up to date.
+
+   This assumes that the write lock is held. */
+static svn_error_t *
+prepare_lock_index(svn_boolean_t *maintained,
+                   svn_fs_t *fs,
+                   apr_pool_t *pool)
+{
+  svn_boolean_t needs_fill;
+
+  SVN_ERR(svn_fs_fs__open_lock_index(maintained, &needs_fill, fs, pool));
+  if (needs_fill)
+    {
+      apr_array_header_t *locks;
+
+      SVN_ERR(read_all_locks(&locks, fs, pool));
+      SVN_ERR(svn_fs_fs__fill_lock_index(fs, locks, pool));
+      *maintained = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Make the lock index entries of FS for the const char * in PATHS match
+   what is in the respective digest files.  Use POOL for allocations.
+
+   This assumes that the write lock is held. */
+static svn_error_t *
+resync_lock_index(svn_fs_t *fs,
+                  const apr_array_header_t *paths,
+                  apr_pool_t *pool)
+{
+  apr_array_header_t *locks = apr_array_make(pool, paths->nelts,
+                                             sizeof(svn_lock_t *));
+  apr_array_header_t *unlocked = apr_array_make(pool, paths->nelts,
+                                                sizeof(const char *));
+  int i;
+
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      const char *digest_path;
+      svn_lock_t *lock;
+
+      SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
+      SVN_ERR(read_digest_file(NULL, &lock, fs->path, digest_path, pool));
+      if (lock)
+        APR_ARRAY_PUSH(locks, svn_lock_t *) = lock;
+      else
+        APR_ARRAY_PUSH(unlocked, const char *) = path;
+    }
+
+  if (locks->nelts)
+    SVN_ERR(svn_fs_fs__index_locks(fs, locks, pool));
+  if (unlocked->nelts)
+    SVN_ERR(svn_fs_fs__unindex_locks(fs, unlocked, pool));
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Utility function:  verify that a lock can be used.  Interesting
    errors returned from this function:
@@ -652,10 +823,8 @@ svn_fs_fs__allow_locked_operation(const char *path,
   if (recurse)
     {
       /* Discover all locks at or below the path. */
-      const char *digest_path;
-      SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
-      SVN_ERR(walk_locks(fs, digest_path, get_locks_callback,
-                         fs, have_write_lock, pool));
+      SVN_ERR(find_locks(fs, path, get_locks_callback, fs, have_write_lock,
+                         pool));
     }
   else
     {
@@ -845,6 +1014,8 @@ lock_body(void *baton, apr_pool_t *pool)
   apr_hash_t *index_updates = apr_hash_make(pool);
   apr_hash_index_t *hi;
   apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_boolean_t update_lock_index;
+  apr_array_header_t *new_locks, *failed_paths;
 
   /* Until we implement directory locks someday, we only allow locks
      on files. */
@@ -877,6 +1048,7 @@ lock_body(void *baton, apr_pool_t *pool)
     }
 
   rev_0_path = svn_fs_fs__path_rev_absolute(lb->fs, 0, pool);
+  SVN_ERR(prepare_lock_index(&update_lock_index, lb->fs, pool));
 
   /* We apply the scheduled index updates before writing the actual locks.
 
@@ -897,6 +1069,7 @@ lock_body(void *baton, apr_pool_t *pool)
                             iterpool));
     }
 
+  new_locks = apr_array_make(pool, lb->infos->nelts, sizeof(svn_lock_t *));
   for (i = 0; i < lb->infos->nelts; ++i)
     {
       struct lock_info_t *info = &APR_ARRAY_IDX(lb->infos, i,
@@ -904,8 +1077,6 @@ lock_body(void *baton, apr_pool_t *pool)
       svn_sort__item_t *item = &APR_ARRAY_IDX(lb->targets, i, svn_sort__item_t);
       svn_fs_lock_target_t *target = item->value;
 
-      svn_pool_clear(iterpool);
-
       if (! info->fs_err)
         {
           info->lock = svn_lock_create(lb->result_pool);
@@ -925,11 +1096,36 @@ lock_body(void *baton, apr_pool_t *pool)
           info->lock->creation_date = apr_time_now();
           info->lock->expiration_date = lb->expiration_date;
 
+          APR_ARRAY_PUSH(new_locks, svn_lock_t *) = info->lock;
+        }
+    }
+
+  /* Like the digest files, the lock index gets updated before the locks
+     are written, in a single transaction for all of them.  Locks that
+     could not be written get their old index entries back. */
+  if (update_lock_index && new_locks->nelts)
+    SVN_ERR(svn_fs_fs__index_locks(lb->fs, new_locks, pool));
+
+  failed_paths = apr_array_make(pool, 0, sizeof(const char *));
+  for (i = 0; i < lb->infos->nelts; ++i)
+    {
+      struct lock_info_t *info = &APR_ARRAY_IDX(lb->infos, i,
+                                                struct lock_info_t);
+
+      svn_pool_clear(iterpool);
+
+      if (info->lock)
+        {
           info->fs_err = set_lock(lb->fs->path, info->lock, rev_0_path,
                                   iterpool);
+          if (info->fs_err)
+            APR_ARRAY_PUSH(failed_paths, const char *) = info->path;
         }
     }
 
+  if (update_lock_index && failed_paths->nelts)
+    SVN_ERR(resync_lock_index(lb->fs, failed_paths, pool));
+
   svn_pool_destroy(iterpool);
   return SVN_NO_ERROR;
 }
@@ -997,6 +1193,8 @@ unlock_body(void *baton, apr_pool_t *pool)
   apr_hash_t *indices_updates = apr_hash_make(pool);
   apr_hash_index_t *hi;
   apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_boolean_t update_lock_index;
+  apr_array_header_t *done_paths;
 
   SVN_ERR(ub->fs->vtable->youngest_rev(&youngest, ub->fs, pool));
   SVN_ERR(ub->fs->vtable->revision_root(&root, ub->fs, youngest, pool));
@@ -1027,10 +1225,12 @@ unlock_body(void *baton, apr_pool_t *pool)
     }
 
   rev_0_path = svn_fs_fs__path_rev_absolute(ub->fs, 0, pool);
+  SVN_ERR(prepare_lock_index(&update_lock_index, ub->fs, pool));
 
   /* Unlike the lock_body(), we need to delete locks *before* we start to
      update indices. */
 
+  done_paths = apr_array_make(pool, ub->infos->nelts, sizeof(const char *));
   for (i = 0; i < ub->infos->nelts; ++i)
     {
       struct unlock_info_t *info = &APR_ARRAY_IDX(ub->infos, i,
@@ -1042,9 +1242,13 @@ unlock_body(void *baton, apr_pool_t *pool)
         {
           SVN_ERR(delete_lock(ub->fs->path, info->path, iterpool));
           info->done = TRUE;
+          APR_ARRAY_PUSH(done_paths, const char *) = info->path;
         }
     }
 
+  if (update_lock_index && done_paths->nelts)
+    SVN_ERR(svn_fs_fs__unindex_locks(ub->fs, done_paths, pool));
+
   for (hi = apr_hash_first(pool, indices_updates); hi; hi = apr_hash_next(hi))
     {
       const char *path = apr_hash_this_key(hi);
@@ -1348,7 +1552,6 @@ svn_fs_fs__get_locks(svn_fs_t *fs,
                      void *get_locks_baton,
                      apr_pool_t *pool)
 {
-  const char *digest_path;
   get_locks_filter_baton_t glfb;
 
   SVN_ERR(svn_fs__check_fs(fs, TRUE));
@@ -1359,9 +1562,6 @@ svn_fs_fs__get_locks(svn_fs_t *fs,
   glfb.get_locks_func = get_locks_func;
   glfb.get_locks_baton = get_locks_baton;
 
-  /* Get the top digest path in our tree of interest, and then walk it. */
-  SVN_ERR(digest_path_from_path(&digest_path, fs->path, path, pool));
-  SVN_ERR(walk_locks(fs, digest_path, get_locks_filter_func, &glfb,
-                     FALSE, pool));
+  SVN_ERR(find_locks(fs, path, get_locks_filter_func, &glfb, FALSE, pool));
   return SVN_NO_ERROR;
 }
@@ -0,0 +1,50 @@
+/* mergeinfo-index-db.sql -- schema for use in the FSFS mergeinfo index
+ *   This is intended for use with SQLite 3
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+-- STMT_CREATE_SCHEMA
+/* A table mapping a path in a revision and the kind of mergeinfo
+   query to the mergeinfo found for it.  MERGEINFO is NULL if there
+   was none.  KIND encodes the svn_mergeinfo_inheritance_t and the
+   adjust_inherited_mergeinfo flag of the query. */
+CREATE TABLE mergeinfo_index (
+  revision INTEGER NOT NULL,
+  path TEXT NOT NULL,
+  kind INTEGER NOT NULL,
+  mergeinfo TEXT,
+  PRIMARY KEY (revision, path, kind)
+  ) WITHOUT ROWID;
+
+PRAGMA USER_VERSION = 1;
+
+-- STMT_GET_MERGEINFO
+SELECT mergeinfo
+FROM mergeinfo_index
+WHERE revision = ?1 AND path = ?2 AND kind = ?3
+
+-- STMT_SET_MERGEINFO
+INSERT OR IGNORE INTO mergeinfo_index (revision, path, kind, mergeinfo)
+VALUES (?1, ?2, ?3, ?4)
+
+-- STMT_DEL_MERGEINFO_YOUNGER_THAN_REV
+DELETE FROM mergeinfo_index
+WHERE revision > ?1
@@ -0,0 +1,256 @@
+/* mergeinfo-index.c --- the persistent mergeinfo index for fsfs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_dirent_uri.h"
+
+#include "svn_private_config.h"
+
+#include "fs_fs.h"
+#include "fs.h"
+#include "mergeinfo-index.h"
+#include "util.h"
+
+#include "private/svn_sqlite.h"
+
+#include "mergeinfo-index-db.h"
+
+MERGEINFO_INDEX_DB_SQL_DECLARE_STATEMENTS(statements);
+
+
+
+/** Helper functions. **/
+static APR_INLINE const char *
+path_mergeinfo_index_db(const char *fs_path,
+                        apr_pool_t *result_pool)
+{
+  return svn_dirent_join(fs_path, MERGEINFO_INDEX_DB_NAME, result_pool);
+}
+
+/* Return the value of the KIND column for a query of the given INHERIT
+   and ADJUST_INHERITED_MERGEINFO. */
+static int
+query_kind(svn_mergeinfo_inheritance_t inherit,
+           svn_boolean_t adjust_inherited_mergeinfo)
+{
+  return (int)inherit * 2 + (adjust_inherited_mergeinfo ? 1 : 0);
+}
+
+/* Body of open_mergeinfo_index().
+   Implements svn_atomic__init_once().init_func.
+ */
+static svn_error_t *
+open_mergeinfo_index_once(void *baton,
+                          apr_pool_t *pool)
+{
+  svn_fs_t *fs = baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__db_t *sdb;
+  const char *db_path;
+  int version;
+
+  /* Open (or create) the sqlite database.  It will be automatically
+     closed when fs->pool is destroyed. */
+  db_path = path_mergeinfo_index_db(fs->path, pool);
+#ifndef WIN32
+  {
+    /* Like the rep cache, a new index gets the permissions of the
+       repository as a whole rather than those of our umask. */
+    svn_node_kind_t kind;
+
+    SVN_ERR(svn_io_check_path(db_path, &kind, pool));
+    if (kind == svn_node_none)
+      {
+        const char *current = svn_fs_fs__path_current(fs, pool);
+        svn_error_t *err = svn_io_file_create_empty(db_path, pool);
+
+        if (err && !APR_STATUS_IS_EEXIST(err->apr_err))
+          return svn_error_trace(err);
+        else if (err)
+          svn_error_clear(err);
+        else
+          SVN_ERR(svn_io_copy_perms(current, db_path, pool));
+      }
+  }
+#endif
+  SVN_ERR(svn_sqlite__open(&sdb, db_path,
+                           svn_sqlite__mode_rwcreate, statements,
+                           0, NULL, 0,
+                           fs->pool, pool));
+
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__read_schema_version(&version, sdb, pool),
+                        sdb);
+  if (version <= 0)
+    SVN_SQLITE__ERR_CLOSE(svn_sqlite__exec_statements(sdb,
+                                                      STMT_CREATE_SCHEMA),
+                          sdb);
+
+  /* This is used as a flag that the database is available so don't
+     set it earlier. */
+  ffd->mergeinfo_index_db = sdb;
+
+  return SVN_NO_ERROR;
+}
+
+/* Open and create, if needed, the mergeinfo index of FS.
+   Use POOL for temporary allocations. */
+static svn_error_t *
+open_mergeinfo_index(svn_fs_t *fs,
+                     apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err = svn_atomic__init_once(&ffd->mergeinfo_index_db_opened,
+                                           open_mergeinfo_index_once, fs,
+                                           pool);
+  return svn_error_quick_wrapf(err,
+                               _("Couldn't open mergeinfo index '%s'"),
+                               svn_dirent_local_style(
+                                 path_mergeinfo_index_db(fs->path, pool),
+                                 pool));
+}
+
+
+/** Library-private API's. **/
+
+svn_error_t *
+svn_fs_fs__get_indexed_mergeinfo(svn_boolean_t *found,
+                                 svn_mergeinfo_t *mergeinfo,
+                                 svn_fs_t *fs,
+                                 svn_revnum_t revision,
+                                 const char *path,
+                                 svn_mergeinfo_inheritance_t inherit,
+                                 svn_boolean_t adjust_inherited_mergeinfo,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_error_t *err;
+
+  *found = FALSE;
+  *mergeinfo = NULL;
+
+  if (!ffd->mergeinfo_index_db)
+    {
+      err = open_mergeinfo_index(fs, scratch_pool);
+      if (err)
+        {
+          /* The index is only an optimization. */
+          svn_error_clear(err);
+          ffd->mergeinfo_index = FALSE;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->mergeinfo_index_db,
+                                    STMT_GET_MERGEINFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "rsd", revision, path,
+                            query_kind(inherit, adjust_inherited_mergeinfo)));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    {
+      *found = TRUE;
+      if (!svn_sqlite__column_is_null(stmt, 0))
+        {
+          err = svn_mergeinfo_parse(mergeinfo,
+                                    svn_sqlite__column_text(stmt, 0, NULL),
+                                    result_pool);
+
+          /* We only ever store valid mergeinfo.  Anything else is
+             garbage; look the mergeinfo up the slow way instead. */
+          if (err)
+            {
+              svn_error_clear(err);
+              *found = FALSE;
+              *mergeinfo = NULL;
+            }
+        }
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_fs_fs__set_indexed_mergeinfo(svn_fs_t *fs,
+                                 svn_revnum_t revision,
+                                 const char *path,
+                                 svn_mergeinfo_inheritance_t inherit,
+                                 svn_boolean_t adjust_inherited_mergeinfo,
+                                 svn_mergeinfo_t mergeinfo,
+                                 apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_string_t *mergeinfo_string = NULL;
+  svn_error_t *err;
+
+  if (!ffd->mergeinfo_index_db)
+    return SVN_NO_ERROR;
+
+  if (mergeinfo)
+    SVN_ERR(svn_mergeinfo_to_string(&mergeinfo_string, mergeinfo,
+                                    scratch_pool));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->mergeinfo_index_db,
+                                    STMT_SET_MERGEINFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "rsds", revision, path,
+                            query_kind(inherit, adjust_inherited_mergeinfo),
+                            mergeinfo_string ? mergeinfo_string->data
+                                             : NULL));
+  err = svn_sqlite__insert(NULL, stmt);
+
+  /* Readers may well not be allowed to write to the repository, and a
+     busy database is no reason to fail a query either. */
+  svn_error_clear(err);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__prune_mergeinfo_index(svn_fs_t *fs,
+                                 svn_revnum_t youngest,
+                                 apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+
+  if (!ffd->mergeinfo_index_db)
+    {
+      svn_node_kind_t kind;
+
+      /* Take care not to create the index if it does not exist. */
+      SVN_ERR(svn_io_check_path(path_mergeinfo_index_db(fs->path, pool),
+                                &kind, pool));
+      if (kind == svn_node_none)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(open_mergeinfo_index(fs, pool));
+    }
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->mergeinfo_index_db,
+                                    STMT_DEL_MERGEINFO_YOUNGER_THAN_REV));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", youngest));
+  SVN_ERR(svn_sqlite__step_done(stmt));
+
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,87 @@
+/* mergeinfo-index.h : interface to the mergeinfo index db functions
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+#define SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H
+
+#include "svn_error.h"
+#include "svn_mergeinfo.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+#define MERGEINFO_INDEX_DB_NAME  "mergeinfo-index.db"
+
+/* The mergeinfo index remembers the answers to mergeinfo queries on
+   revision roots across processes.  Revisions never change once
+   committed, so neither do the answers.  The index is only consulted and
+   filled if enabled in fsfs.conf, but it is kept consistent with the
+   revisions in the repository whenever the database file exists. */
+
+/* Look up the INHERIT mergeinfo of PATH in REVISION of FS, adjusted as
+   per ADJUST_INHERITED_MERGEINFO, in the mergeinfo index.  If it is
+   there, set *FOUND to TRUE and *MERGEINFO to it (NULL if PATH has no
+   mergeinfo), allocated in RESULT_POOL.  Otherwise set *FOUND to FALSE.
+
+   If the index can't be opened, e.g. because the repository is read-only
+   to us, stop using it for FS and set *FOUND to FALSE.  Use SCRATCH_POOL
+   for temporary allocations. */
+svn_error_t *
+svn_fs_fs__get_indexed_mergeinfo(svn_boolean_t *found,
+                                 svn_mergeinfo_t *mergeinfo,
+                                 svn_fs_t *fs,
+                                 svn_revnum_t revision,
+                                 const char *path,
+                                 svn_mergeinfo_inheritance_t inherit,
+                                 svn_boolean_t adjust_inherited_mergeinfo,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
+/* Record MERGEINFO, which may be NULL, as the answer to the query
+   described by REVISION, PATH, INHERIT and ADJUST_INHERITED_MERGEINFO
+   in the mergeinfo index of FS.  Failures to write are silently ignored.
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__set_indexed_mergeinfo(svn_fs_t *fs,
+                                 svn_revnum_t revision,
+                                 const char *path,
+                                 svn_mergeinfo_inheritance_t inherit,
+                                 svn_boolean_t adjust_inherited_mergeinfo,
+                                 svn_mergeinfo_t mergeinfo,
+                                 apr_pool_t *scratch_pool);
+
+/* If FS has a mergeinfo index, delete all its entries for revisions
+   younger than YOUNGEST.  Use POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__prune_mergeinfo_index(svn_fs_t *fs,
+                                 svn_revnum_t youngest,
+                                 apr_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_MERGEINFO_INDEX_H */
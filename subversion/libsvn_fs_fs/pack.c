@@ -30,6 +30,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_thread_pool.h"
 
 #include "fs_fs.h"
 #include "pack.h"
@@ -1866,6 +1867,10 @@ struct pack_baton
   void *cancel_baton;
   size_t max_mem;
 
+  /* Private FS instances to be used by concurrent pack workers.
+     May be NULL. */
+  apr_array_header_t *worker_fss;
+
   /* Additional entries valid when entering pack_shard(). */
   const char *revs_dir;
   const char *revsprops_dir;
@@ -1957,6 +1962,55 @@ synced_pack_shard(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* For SHARD in REVS_DIR, return the path of the pack directory in
+ * *REV_PACK_FILE_DIR and the path of the non-packed shard directory in
+ * *REV_SHARD_PATH.  Allocate both in POOL.
+ */
+static void
+get_shard_paths(const char **rev_pack_file_dir,
+                const char **rev_shard_path,
+                const char *revs_dir,
+                apr_int64_t shard,
+                apr_pool_t *pool)
+{
+  *rev_pack_file_dir = svn_dirent_join(revs_dir,
+                  apr_psprintf(pool,
+                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
+                               shard),
+                  pool);
+  *rev_shard_path = svn_dirent_join(revs_dir,
+                                    apr_psprintf(pool, "%" APR_INT64_T_FMT,
+                                                 shard),
+                                    pool);
+}
+
+/* Switch the shard described by BATON over to its packed representation,
+ * which must have been created in BATON->REVS_DIR before.  Notify the
+ * caller when done.  Use POOL for allocations.
+ */
+static svn_error_t *
+switch_to_packed_shard(struct pack_baton *baton,
+                       apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = baton->fs->fsap_data;
+
+  /* For newer repo formats, we only acquired the pack lock so far.
+     Before modifying the repo state by switching over to the packed
+     data, we need to acquire the global (write) lock. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
+    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
+                                       pool));
+  else
+    SVN_ERR(synced_pack_shard(baton, pool));
+
+  /* Notify caller we're done packing this shard. */
+  if (baton->notify_func)
+    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
+                               svn_fs_pack_notify_end, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Pack the shard described by BATON.
  *
  * If for some reason we detect a partial packing already performed,
@@ -1975,16 +2029,8 @@ pack_shard(struct pack_baton *baton,
                                svn_fs_pack_notify_start, pool));
 
   /* Some useful paths. */
-  rev_pack_file_dir = svn_dirent_join(baton->revs_dir,
-                  apr_psprintf(pool,
-                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
-                               baton->shard),
-                  pool);
-  baton->rev_shard_path = svn_dirent_join(baton->revs_dir,
-                                          apr_psprintf(pool,
-                                                       "%" APR_INT64_T_FMT,
-                                                       baton->shard),
-                                          pool);
+  get_shard_paths(&rev_pack_file_dir, &baton->rev_shard_path,
+                  baton->revs_dir, baton->shard, pool);
 
   /* pack the revision content */
   SVN_ERR(pack_rev_shard(baton->fs, rev_pack_file_dir, baton->rev_shard_path,
@@ -1992,23 +2038,160 @@ pack_shard(struct pack_baton *baton,
                          baton->max_mem, ffd->flush_to_disk,
                          baton->cancel_func, baton->cancel_baton, pool));
 
-  /* For newer repo formats, we only acquired the pack lock so far.
-     Before modifying the repo state by switching over to the packed
-     data, we need to acquire the global (write) lock. */
-  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
-    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
-                                       pool));
-  else
-    SVN_ERR(synced_pack_shard(baton, pool));
+  return svn_error_trace(switch_to_packed_shard(baton, pool));
+}
 
-  /* Notify caller we're starting to pack this shard. */
-  if (baton->notify_func)
-    SVN_ERR(baton->notify_func(baton->notify_baton, baton->shard,
-                               svn_fs_pack_notify_end, pool));
+#if APR_HAS_THREADS
+
+/* A single shard to be packed by one of the workers in a concurrent
+ * pack run.  See pack_concurrently().
+ */
+typedef struct shard_job_t
+{
+  /* The pack baton of the main thread.  Read-only for the workers. */
+  struct pack_baton *pb;
+
+  /* Limit for the in-memory data structures of the worker. */
+  apr_size_t max_mem;
+
+  /* The shard to pack. */
+  apr_int64_t shard;
+
+  /* The job in the thread pool that builds the pack file for SHARD. */
+  svn_thread_pool__job_t *job;
+} shard_job_t;
+
+/* Implements svn_thread_pool__worker_init_t.  Let each worker use its
+ * own FS instance from the pack_baton given as BATON.
+ */
+static svn_error_t *
+get_worker_fs(void **worker_baton,
+              void *baton,
+              int worker_index,
+              apr_pool_t *worker_pool)
+{
+  struct pack_baton *pb = baton;
+  *worker_baton = APR_ARRAY_IDX(pb->worker_fss, worker_index, svn_fs_t *);
 
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_thread_pool__job_func_t.  Build the pack file for the
+ * shard_job_t given as JOB_BATON, using the svn_fs_t given as
+ * WORKER_BATON.  The shard switch-over itself is left to the main thread.
+ */
+static svn_error_t *
+pack_shard_job(void *job_baton,
+               void *worker_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  shard_job_t *job = job_baton;
+  svn_fs_t *fs = worker_baton;
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *rev_pack_file_dir, *rev_shard_path;
+
+  get_shard_paths(&rev_pack_file_dir, &rev_shard_path,
+                  job->pb->revs_dir, job->shard, scratch_pool);
+
+  return svn_error_trace(pack_rev_shard(fs, rev_pack_file_dir,
+                                        rev_shard_path, job->shard,
+                                        ffd->max_files_per_dir, job->max_mem,
+                                        ffd->flush_to_disk,
+                                        cancel_func, cancel_baton,
+                                        scratch_pool));
+}
+
+/* Pack the shards FIRST_SHARD up to but not including END_SHARD as
+ * described by PB.  Build the pack files concurrently, using one thread
+ * per element in PB->WORKER_FSS.  Switch the shards over to the packed
+ * data strictly in ascending order, though, such that min-unpacked-rev
+ * always describes a consistent repository state.  Notifications and
+ * cancellation checks are run in the calling thread only.
+ *
+ * Use POOL for allocations.
+ */
+static svn_error_t *
+pack_concurrently(struct pack_baton *pb,
+                  apr_int64_t first_shard,
+                  apr_int64_t end_shard,
+                  apr_pool_t *pool)
+{
+  svn_thread_pool__t *thread_pool;
+  shard_job_t *jobs;
+  int job_count = (int)(end_shard - first_shard);
+  int i;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  /* More threads than shards would be pointless. */
+  SVN_ERR(svn_thread_pool__create(&thread_pool,
+                                  MIN(pb->worker_fss->nelts, job_count),
+                                  get_worker_fs, pb, pool));
+
+  jobs = apr_pcalloc(pool, job_count * sizeof(*jobs));
+  for (i = 0; i < job_count && !err; ++i)
+    {
+      shard_job_t *job = &jobs[i];
+
+      job->pb = pb;
+      job->max_mem = pb->max_mem / pb->worker_fss->nelts;
+      job->shard = first_shard + i;
+      err = svn_thread_pool__submit(&job->job, thread_pool, pack_shard_job,
+                                    job);
+    }
+
+  /* Switch the shards over as soon as their pack files become available. */
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < job_count && !err; ++i)
+    {
+      shard_job_t *job = &jobs[i];
+      const char *rev_pack_file_dir;
+
+      svn_pool_clear(iterpool);
+
+      if (pb->cancel_func)
+        {
+          err = pb->cancel_func(pb->cancel_baton);
+          if (err)
+            break;
+        }
+
+      /* Notify caller we're starting to pack this shard. */
+      if (pb->notify_func)
+        {
+          err = pb->notify_func(pb->notify_baton, job->shard,
+                                svn_fs_pack_notify_start, iterpool);
+          if (err)
+            break;
+        }
+
+      err = svn_thread_pool__wait(thread_pool, job->job,
+                                  pb->cancel_func, pb->cancel_baton);
+      if (err)
+        break;
+
+      pb->shard = job->shard;
+      get_shard_paths(&rev_pack_file_dir, &pb->rev_shard_path,
+                      pb->revs_dir, job->shard, iterpool);
+      err = switch_to_packed_shard(pb, iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Stop all workers that may still be running and wait for them.
+     Pack files of shards that we did not switch over are simply going
+     to be rebuilt by the next pack run.  Their build results, including
+     the cancellation errors due to our abort, are irrelevant. */
+  err = svn_error_compose_create(err,
+                                 svn_thread_pool__join(thread_pool, TRUE));
+
+  return svn_error_trace(err);
+}
+
+#endif
+
 /* Read the youngest rev and the first non-packed rev info for FS from disk.
    Set *FULLY_PACKED when there is no completed unpacked shard.
    Use SCRATCH_POOL for temporary allocations.
@@ -2080,6 +2263,15 @@ pack_body(void *baton,
     pb->revsprops_dir = svn_dirent_join(pb->fs->path, PATH_REVPROPS_DIR,
                                         pool);
 
+#if APR_HAS_THREADS
+  /* Concurrent packing only makes sense for more than one shard. */
+  if (   pb->worker_fss && pb->worker_fss->nelts > 1
+      && completed_shards - ffd->min_unpacked_rev / ffd->max_files_per_dir > 1)
+    return svn_error_trace(pack_concurrently(pb,
+                             ffd->min_unpacked_rev / ffd->max_files_per_dir,
+                             completed_shards, pool));
+#endif
+
   iterpool = svn_pool_create(pool);
   for (pb->shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
        pb->shard < completed_shards;
@@ -2100,6 +2292,7 @@ pack_body(void *baton,
 svn_error_t *
 svn_fs_fs__pack(svn_fs_t *fs,
                 apr_size_t max_mem,
+                apr_array_header_t *worker_fss,
                 svn_fs_pack_notify_t notify_func,
                 void *notify_baton,
                 svn_cancel_func_t cancel_func,
@@ -2146,6 +2339,7 @@ svn_fs_fs__pack(svn_fs_t *fs,
   pb.cancel_func = cancel_func;
   pb.cancel_baton = cancel_baton;
   pb.max_mem = max_mem ? max_mem : DEFAULT_MAX_MEM;
+  pb.worker_fss = worker_fss;
 
   if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
     {
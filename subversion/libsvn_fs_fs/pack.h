@@ -32,13 +32,22 @@
    MAX_MEM limits the size of in-memory data structures needed for reordering
    items in format 7 repositories.  0 means use the built-in default.
 
+   If WORKER_FSS is not NULL, it is an array of svn_fs_t * instances
+   of the same repository, each one exclusively owned by this call and
+   allocated in its own root pool.  If it contains more than one element,
+   the pack files for that many shards will be built concurrently, each
+   in a separate thread using one of those FS instances.  MAX_MEM will be
+   split evenly between them.
+
    If given, NOTIFY_FUNC will be called with NOTIFY_BATON to report progress.
-   Use optional CANCEL_FUNC/CANCEL_BATON for cancellation support.
+   Use optional CANCEL_FUNC/CANCEL_BATON for cancellation support.  Both
+   callbacks will only be invoked from the calling thread.
 
    Existing filesystem references need not change.  */
 svn_error_t *
 svn_fs_fs__pack(svn_fs_t *fs,
                 apr_size_t max_mem,
+                apr_array_header_t *worker_fss,
                 svn_fs_pack_notify_t notify_func,
                 void *notify_baton,
                 svn_cancel_func_t cancel_func,
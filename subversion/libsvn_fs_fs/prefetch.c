@@ -0,0 +1,243 @@
+/* prefetch.c : reading whole trees in storage order
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+
+#include "private/svn_sorts_private.h"
+
+#include "prefetch.h"
+#include "cached_data.h"
+#include "id.h"
+#include "index.h"
+#include "rev_file.h"
+#include "util.h"
+
+/* An item to read, together with its location on disk. */
+typedef struct prefetch_item_t
+{
+  /* The node revision to read. */
+  const svn_fs_id_t *id;
+
+  /* Its node revision, once it has been read.  Only set for directories
+     in the second phase. */
+  node_revision_t *noderev;
+
+  /* First revision in the rev or pack file that contains the item. */
+  svn_revnum_t file_rev;
+
+  /* Absolute position of the item within that file. */
+  apr_off_t offset;
+} prefetch_item_t;
+
+/* Order prefetch_item_t by file and offset within that file. */
+static int
+compare_items(const void *lhs, const void *rhs)
+{
+  const prefetch_item_t *a = lhs;
+  const prefetch_item_t *b = rhs;
+
+  if (a->file_rev != b->file_rev)
+    return a->file_rev < b->file_rev ? -1 : 1;
+  if (a->offset != b->offset)
+    return a->offset < b->offset ? -1 : 1;
+
+  return 0;
+}
+
+/* Set ITEM->FILE_REV and ITEM->OFFSET to the location of ITEM_INDEX in
+ * REVISION of FS.  *REV_FILE is the rev or pack file that has been used
+ * last or NULL; re-open it in FILE_POOL as needed.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+locate_item(prefetch_item_t *item,
+            svn_fs_fs__revision_file_t **rev_file,
+            svn_fs_t *fs,
+            svn_revnum_t revision,
+            apr_uint64_t item_index,
+            apr_pool_t *file_pool,
+            apr_pool_t *scratch_pool)
+{
+  svn_revnum_t file_rev = svn_fs_fs__is_packed_rev(fs, revision)
+                        ? svn_fs_fs__packed_base_rev(fs, revision)
+                        : revision;
+
+  if (*rev_file && (*rev_file)->start_revision != file_rev)
+    {
+      SVN_ERR(svn_fs_fs__close_revision_file(*rev_file));
+      *rev_file = NULL;
+      svn_pool_clear(file_pool);
+    }
+
+  if (!*rev_file && svn_fs_fs__use_log_addressing(fs))
+    SVN_ERR(svn_fs_fs__open_pack_or_rev_file(rev_file, fs, revision,
+                                             file_pool, scratch_pool));
+
+  item->file_rev = file_rev;
+  return svn_error_trace(svn_fs_fs__item_offset(&item->offset, fs,
+                                                *rev_file, revision, NULL,
+                                                item_index, scratch_pool));
+}
+
+/* Sort the prefetch_item_t in ITEMS by their location on disk in FS.
+ * If BY_DATA_REP is set, use the location of the noderevs' data reps
+ * instead of the noderevs themselves.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+sort_items(apr_array_header_t *items,
+           svn_fs_t *fs,
+           svn_boolean_t by_data_rep,
+           apr_pool_t *scratch_pool)
+{
+  apr_pool_t *file_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_fs_fs__revision_file_t *rev_file = NULL;
+  int i;
+
+  /* Group by revision first, so we open each file only once. */
+  for (i = 0; i < items->nelts; ++i)
+    {
+      prefetch_item_t *item = &APR_ARRAY_IDX(items, i, prefetch_item_t);
+      item->file_rev = by_data_rep ? item->noderev->data_rep->revision
+                                   : svn_fs_fs__id_rev(item->id);
+      item->offset = 0;
+    }
+  svn_sort__array(items, compare_items);
+
+  for (i = 0; i < items->nelts; ++i)
+    {
+      prefetch_item_t *item = &APR_ARRAY_IDX(items, i, prefetch_item_t);
+      svn_revnum_t revision = item->file_rev;
+      apr_uint64_t item_index;
+
+      svn_pool_clear(iterpool);
+      if (by_data_rep)
+        item_index = item->noderev->data_rep->item_index;
+      else
+        item_index = svn_fs_fs__id_item(item->id);
+
+      SVN_ERR(locate_item(item, &rev_file, fs, revision, item_index,
+                          file_pool, iterpool));
+    }
+
+  if (rev_file)
+    SVN_ERR(svn_fs_fs__close_revision_file(rev_file));
+
+  svn_sort__array(items, compare_items);
+
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(file_pool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__prefetch_tree(svn_fs_t *fs,
+                         const svn_fs_id_t *root_id,
+                         apr_size_t max_nodes,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_pool_t *level_pool, *next_pool, *iterpool;
+  apr_array_header_t *level, *dirs;
+  apr_size_t count = 0;
+
+  /* Without caches, there is no place to keep what we read. */
+  if (!ffd->node_revision_cache || svn_fs_fs__id_is_txn(root_id))
+    return SVN_NO_ERROR;
+
+  level_pool = svn_pool_create(scratch_pool);
+  next_pool = svn_pool_create(scratch_pool);
+  iterpool = svn_pool_create(scratch_pool);
+
+  level = apr_array_make(level_pool, 1, sizeof(prefetch_item_t));
+  APR_ARRAY_PUSH(level, prefetch_item_t).id = root_id;
+
+  while (level->nelts && count < max_nodes)
+    {
+      apr_array_header_t *next;
+      apr_pool_t *pool;
+      int i, k;
+
+      /* Read this level's node revisions in storage order. */
+      SVN_ERR(sort_items(level, fs, FALSE, iterpool));
+      dirs = apr_array_make(level_pool, 16, sizeof(prefetch_item_t));
+      for (i = 0; i < level->nelts && count < max_nodes; ++i, ++count)
+        {
+          prefetch_item_t *item = &APR_ARRAY_IDX(level, i, prefetch_item_t);
+          node_revision_t *noderev;
+
+          svn_pool_clear(iterpool);
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          SVN_ERR(svn_fs_fs__get_node_revision(&noderev, fs, item->id,
+                                               level_pool, iterpool));
+          if (noderev->kind == svn_node_dir && noderev->data_rep)
+            {
+              prefetch_item_t *dir = apr_array_push(dirs);
+              *dir = *item;
+              dir->noderev = noderev;
+            }
+        }
+
+      /* Read the directories' contents in storage order as well and
+         collect the next level. */
+      SVN_ERR(sort_items(dirs, fs, TRUE, iterpool));
+      next = apr_array_make(next_pool, 16, sizeof(prefetch_item_t));
+      for (i = 0; i < dirs->nelts; ++i)
+        {
+          prefetch_item_t *dir = &APR_ARRAY_IDX(dirs, i, prefetch_item_t);
+          apr_array_header_t *entries;
+
+          svn_pool_clear(iterpool);
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          SVN_ERR(svn_fs_fs__rep_contents_dir(&entries, fs, dir->noderev,
+                                              iterpool, iterpool));
+          for (k = 0; k < entries->nelts; ++k)
+            {
+              svn_fs_dirent_t *entry
+                = APR_ARRAY_IDX(entries, k, svn_fs_dirent_t *);
+              prefetch_item_t *child = apr_array_push(next);
+
+              child->id = svn_fs_fs__id_copy(entry->id, next_pool);
+              child->noderev = NULL;
+            }
+        }
+
+      /* The next level becomes the current one. */
+      svn_pool_clear(level_pool);
+      pool = level_pool;
+      level_pool = next_pool;
+      next_pool = pool;
+      level = next;
+    }
+
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(next_pool);
+  svn_pool_destroy(level_pool);
+
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,55 @@
+/* prefetch.h : reading whole trees in storage order
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_FS_FS_PREFETCH_H
+#define SVN_LIBSVN_FS_FS_PREFETCH_H
+
+#include "svn_error.h"
+#include "svn_types.h"
+
+#include "fs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Read the node revisions and directory contents of the committed tree
+   rooted at ROOT_ID in FS into the caches, level by level.  Within each
+   level, read the items in the order they are stored in the rev and pack
+   files instead of in path order.  Stop after MAX_NODES node revisions.
+
+   This is a mere performance hint for a subsequent walk of the tree and
+   does nothing if FS has no node revision cache.  Call CANCEL_FUNC with
+   CANCEL_BATON regularly.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_fs__prefetch_tree(svn_fs_t *fs,
+                         const svn_fs_id_t *root_id,
+                         apr_size_t max_nodes,
+                         svn_cancel_func_t cancel_func,
+                         void *cancel_baton,
+                         apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_FS_FS_PREFETCH_H */
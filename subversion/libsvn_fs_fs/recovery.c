@@ -28,6 +28,7 @@
 
 #include "index.h"
 #include "low_level.h"
+#include "mergeinfo-index.h"
 #include "rep-cache.h"
 #include "revprops.h"
 #include "util.h"
@@ -488,6 +489,10 @@ recover_body(void *baton, apr_pool_t *pool)
         SVN_ERR(svn_fs_fs__del_rep_reference(fs, max_rev, pool));
     }
 
+  /* Likewise, forget what the mergeinfo index knows about revisions
+     that are gone. */
+  SVN_ERR(svn_fs_fs__prune_mergeinfo_index(fs, max_rev, pool));
+
   /* Now store the discovered youngest revision, and the next IDs if
      relevant, in a new 'current' file. */
   return svn_fs_fs__write_current(fs, max_rev, next_node_id, next_copy_id,
@@ -70,6 +70,15 @@ SELECT hash, revision, offset, size, expanded_size
 FROM rep_cache
 WHERE revision >= ?1 AND revision <= ?2
 
+-- STMT_GET_HASHES_FOR_RANGE
+SELECT hash
+FROM rep_cache
+WHERE revision >= ?1 AND revision <= ?2
+
+-- STMT_GET_REP_COUNT
+SELECT COUNT(*)
+FROM rep_cache
+
 -- STMT_GET_MAX_REV
 /* Works for both V1 and V2 schemas. */
 SELECT MAX(revision)
@@ -32,11 +32,13 @@
 
 #include "svn_path.h"
 
+#include "private/svn_mutex.h"
 #include "private/svn_sqlite.h"
 
 #include "rep-cache-db.h"
 
 REP_CACHE_DB_SQL_DECLARE_STATEMENTS(statements);
+REP_CACHE_DB_SQL_DECLARE_STATEMENT_INFO(statement_info);
 
 
 
@@ -97,6 +99,13 @@ open_rep_cache(void *baton,
                            0, NULL, 0,
                            fs->pool, pool));
 
+  svn_sqlite__set_statement_info(sdb, statement_info);
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__tune(sdb,
+                                         ffd->rep_cache_cache_size * 1024,
+                                         ffd->rep_cache_mmap_size * 1024,
+                                         ffd->rep_cache_wal, pool),
+                        sdb);
+
   SVN_SQLITE__ERR_CLOSE(svn_sqlite__read_schema_version(&version, sdb, pool),
                         sdb);
   /* If we have an uninitialized database, go ahead and create the schema. */
@@ -257,6 +266,245 @@ svn_fs_fs__walk_rep_reference(svn_fs_t *fs,
 }
 
 
+/** Rep-cache filter.
+ *
+ * A Bloom filter over the SHA1 keys in rep-cache.db.  It never reports
+ * a key as absent that has been added to it, so lookups that it rejects
+ * can skip the database query.  Since SHA1 digests are uniformly
+ * distributed, we simply derive the bit positions from the digest itself.
+ *
+ * The filter learns about new entries in two ways: from this process
+ * through svn_fs_fs__set_rep_reference and from other processes by
+ * re-scanning the rep-cache rows of the latest revisions.  Rows that
+ * other processes add late may be missed.  Those contents just won't be
+ * shared, which is harmless.
+ */
+
+/* Number of bit positions to check per key. */
+enum { FILTER_PROBES = 7 };
+
+/* Number of filter bits per expected entry.  Together with FILTER_PROBES,
+   this gives a false positive rate of about 1%. */
+enum { FILTER_BITS_PER_ENTRY = 10 };
+
+/* Minimum number of entries that we size the filter for. */
+enum { FILTER_MIN_ENTRIES = 0x10000 };
+
+/* When catching up with other processes' commits, re-scan this many
+   revisions that we have seen before. */
+enum { FILTER_RESCAN_REVISIONS = 16 };
+
+struct rep_cache_filter_t
+{
+  /* Pool containing this structure and BITS. */
+  apr_pool_t *pool;
+
+  /* The filter bits.  The number of bits is MASK + 1. */
+  unsigned char *bits;
+  apr_uint64_t mask;
+
+  /* Number of entries added and the number of entries the filter has been
+     sized for.  Once ENTRIES exceeds CAPACITY, we rebuild the filter. */
+  apr_uint64_t entries;
+  apr_uint64_t capacity;
+
+  /* All rep-cache rows up to this revision have been added. */
+  svn_revnum_t revision;
+};
+
+/* Return the bit position of the PROBE-th test for DIGEST in FILTER. */
+static APR_INLINE apr_uint64_t
+filter_bit(const struct rep_cache_filter_t *filter,
+           const unsigned char *digest,
+           int probe)
+{
+  /* Double hashing with two independent 32 bit values from DIGEST. */
+  apr_uint64_t h1 = ((apr_uint64_t)digest[0] << 24) | (digest[1] << 16)
+                  | (digest[2] << 8) | digest[3];
+  apr_uint64_t h2 = ((apr_uint64_t)digest[4] << 24) | (digest[5] << 16)
+                  | (digest[6] << 8) | digest[7];
+
+  return (h1 + probe * (h2 | 1)) & filter->mask;
+}
+
+/* Add the SHA1 DIGEST to FILTER. */
+static void
+filter_add(struct rep_cache_filter_t *filter,
+           const unsigned char *digest)
+{
+  int i;
+  for (i = 0; i < FILTER_PROBES; ++i)
+    {
+      apr_uint64_t bit = filter_bit(filter, digest, i);
+      filter->bits[bit / 8] |= (unsigned char)(1 << (bit % 8));
+    }
+
+  ++filter->entries;
+}
+
+/* Return TRUE, if FILTER may contain the SHA1 DIGEST. */
+static svn_boolean_t
+filter_may_contain(const struct rep_cache_filter_t *filter,
+                   const unsigned char *digest)
+{
+  int i;
+  for (i = 0; i < FILTER_PROBES; ++i)
+    {
+      apr_uint64_t bit = filter_bit(filter, digest, i);
+      if ((filter->bits[bit / 8] & (1 << (bit % 8))) == 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Add the keys of all rep-cache rows in FS for revisions START to END to
+   FILTER.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+filter_add_range(struct rep_cache_filter_t *filter,
+                 svn_fs_t *fs,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_HASHES_FOR_RANGE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "rr", start, end));
+
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  while (have_row)
+    {
+      svn_checksum_t *checksum;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+      err = svn_checksum_parse_hex(&checksum, svn_checksum_sha1,
+                                   svn_sqlite__column_text(stmt, 0, NULL),
+                                   iterpool);
+      if (err)
+        return svn_error_compose_create(err, svn_sqlite__reset(stmt));
+
+      /* All-zero digests get parsed as NULL. */
+      if (checksum)
+        filter_add(filter, checksum->digest);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Create a new filter in FS' shared data and fill it with all keys from
+   rep-cache.db.  Assume that we've seen all revisions up to YOUNGEST.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+filter_build(svn_fs_t *fs,
+             svn_revnum_t youngest,
+             apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_shared_data_t *ffsd = ffd->shared;
+  struct rep_cache_filter_t *filter;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_uint64_t count, bit_count;
+  apr_pool_t *pool;
+  svn_error_t *err;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_REP_COUNT));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+  count = (apr_uint64_t)svn_sqlite__column_int64(stmt, 0);
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  /* Leave room for growth. */
+  count = MAX(2 * count, FILTER_MIN_ENTRIES);
+  for (bit_count = 8; bit_count < count * FILTER_BITS_PER_ENTRY; )
+    bit_count *= 2;
+
+  /* Never let FILTER become an orphan. */
+  pool = svn_pool_create(ffsd->common_pool);
+  filter = apr_pcalloc(pool, sizeof(*filter));
+  filter->pool = pool;
+  filter->bits = apr_pcalloc(pool, (apr_size_t)(bit_count / 8));
+  filter->mask = bit_count - 1;
+  filter->capacity = count;
+  filter->revision = youngest;
+
+  err = filter_add_range(filter, fs, 0, LONG_MAX, scratch_pool);
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  ffsd->rep_cache_filter = filter;
+  return SVN_NO_ERROR;
+}
+
+/* Set *MAYBE to FALSE, if rep-cache.db in FS certainly does not contain
+   an entry for the SHA1 DIGEST, and to TRUE otherwise.  Build or update
+   the filter as necessary.  Use SCRATCH_POOL for temporary allocations.
+
+   The caller must hold the rep-cache filter lock. */
+static svn_error_t *
+filter_lookup(svn_boolean_t *maybe,
+              svn_fs_t *fs,
+              const unsigned char *digest,
+              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_shared_data_t *ffsd = ffd->shared;
+  struct rep_cache_filter_t *filter = ffsd->rep_cache_filter;
+  svn_revnum_t youngest = ffd->youngest_rev_cache;
+
+  /* Overfull filters become inaccurate.  Start over. */
+  if (filter && filter->entries > filter->capacity)
+    {
+      svn_pool_destroy(filter->pool);
+      filter = ffsd->rep_cache_filter = NULL;
+    }
+
+  if (filter == NULL)
+    {
+      SVN_ERR(filter_build(fs, youngest, scratch_pool));
+      filter = ffsd->rep_cache_filter;
+    }
+  else if (filter->revision < youngest)
+    {
+      /* Catch up with other processes' commits. */
+      SVN_ERR(filter_add_range(filter, fs,
+                               MAX(0, filter->revision
+                                        - FILTER_RESCAN_REVISIONS),
+                               youngest, scratch_pool));
+      filter->revision = youngest;
+    }
+
+  *maybe = filter_may_contain(filter, digest);
+  return SVN_NO_ERROR;
+}
+
+/* Add the SHA1 DIGEST to FS' rep-cache filter, if that exists.
+   The caller must hold the rep-cache filter lock. */
+static svn_error_t *
+filter_insert(svn_fs_t *fs,
+              const unsigned char *digest)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  if (ffd->shared->rep_cache_filter)
+    filter_add(ffd->shared->rep_cache_filter, digest);
+
+  return SVN_NO_ERROR;
+}
+
 /* This function's caller ignores most errors it returns.
    If you extend this function, check the callsite to see if you have
    to make it not-ignore additional error codes.  */
@@ -281,6 +529,19 @@ svn_fs_fs__get_rep_reference(representation_t **rep_p,
                             _("Only SHA1 checksums can be used as keys in the "
                               "rep_cache table.\n"));
 
+  /* Most lookups fail for new contents; try to skip the query. */
+  if (ffd->rep_cache_filter)
+    {
+      svn_boolean_t maybe;
+      SVN_MUTEX__WITH_LOCK(ffd->shared->rep_cache_filter_lock,
+                           filter_lookup(&maybe, fs, checksum->digest, pool));
+      if (!maybe)
+        {
+          *rep_p = NULL;
+          return SVN_NO_ERROR;
+        }
+    }
+
   SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db, STMT_GET_REP));
   SVN_ERR(svn_sqlite__bindf(stmt, "s",
                             svn_checksum_to_cstring(checksum, pool)));
@@ -352,6 +613,11 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
 
   SVN_ERR(svn_sqlite__insert(NULL, stmt));
 
+  /* Rows that get rolled back remain in the filter.  That is fine. */
+  if (ffd->rep_cache_filter)
+    SVN_MUTEX__WITH_LOCK(ffd->shared->rep_cache_filter_lock,
+                         filter_insert(fs, rep->sha1_digest));
+
   return SVN_NO_ERROR;
 }
 
@@ -20,6 +20,10 @@
  * ====================================================================
  */
 
+#include <apr_mmap.h>
+
+#include "svn_dirent_uri.h"
+
 #include "rev_file.h"
 #include "fs_fs.h"
 #include "index.h"
@@ -29,6 +33,7 @@
 #include "../libsvn_fs/fs-loader.h"
 
 #include "private/svn_io_private.h"
+#include "private/svn_stats.h"
 #include "svn_private_config.h"
 
 /* Initialize the *FILE structure for REVISION in filesystem FS.  Set its
@@ -46,6 +51,8 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
 
   file->file = NULL;
   file->stream = NULL;
+  file->mapped_data = NULL;
+  file->mapped_size = 0;
   file->p2l_stream = NULL;
   file->l2p_stream = NULL;
   file->block_size = ffd->block_size;
@@ -54,6 +61,8 @@ init_revision_file(svn_fs_fs__revision_file_t *file,
   file->p2l_offset = -1;
   file->p2l_checksum = NULL;
   file->footer_offset = -1;
+  file->trace = ffd->io_trace;
+  file->trace_path = NULL;
   file->pool = pool;
 }
 
@@ -120,10 +129,68 @@ auto_make_writable(const char *path,
   return SVN_NO_ERROR;
 }
 
+/* If enabled in FS, set the mapped data members of the r/o pack FILE to
+ * the process-wide mapping of the respective pack file.  Create that
+ * mapping if necessary.  Mapping failures are not considered fatal; FILE
+ * will then simply be read the traditional way.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+static svn_error_t *
+auto_map_pack_file(svn_fs_fs__revision_file_t *file,
+                   svn_fs_t *fs,
+                   apr_pool_t *scratch_pool)
+{
+#if APR_HAS_MMAP
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_shared_data_t *ffsd = ffd->shared;
+  apr_int64_t shard = file->start_revision / ffd->max_files_per_dir;
+  apr_mmap_t *mapping;
+  svn_filesize_t file_size;
+  apr_status_t status = APR_SUCCESS;
+
+  if (!ffd->mmap_packed_files || !file->is_packed)
+    return SVN_NO_ERROR;
+
+  /* Don't even try to map files that exceed our address space. */
+  SVN_ERR(svn_io_file_size_get(&file_size, file->file, scratch_pool));
+  if (file_size == 0 || (apr_uint64_t)file_size > APR_SIZE_MAX)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(ffsd->mappings_lock));
+
+  /* Pack files only ever change when their indexes get rewritten, e.g. by
+   * 'svnfsfs load-index'.  Discard outdated mappings in that case.  We
+   * cannot unmap them because other readers may still use them, though. */
+  mapping = apr_hash_get(ffsd->packed_mappings, &shard, sizeof(shard));
+  if (!mapping || mapping->size != (apr_size_t)file_size)
+    {
+      status = apr_mmap_create(&mapping, file->file, 0,
+                               (apr_size_t)file_size, APR_MMAP_READ,
+                               ffsd->mappings_pool);
+      if (!status)
+        apr_hash_set(ffsd->packed_mappings,
+                     apr_pmemdup(ffsd->mappings_pool, &shard, sizeof(shard)),
+                     sizeof(shard), mapping);
+    }
+
+  SVN_ERR(svn_mutex__unlock(ffsd->mappings_lock, SVN_NO_ERROR));
+
+  if (!status)
+    {
+      file->mapped_data = mapping->mm;
+      file->mapped_size = mapping->size;
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 /* Core implementation of svn_fs_fs__open_pack_or_rev_file working on an
  * existing, initialized FILE structure.  If WRITABLE is TRUE, give write
  * access to the file - temporarily resetting the r/o state if necessary.
  */
+SVN__COUNTER_DEFINE(rev_file_opens, "fsfs.rev_file_opens");
+
 static svn_error_t *
 open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
                       svn_fs_t *fs,
@@ -155,11 +222,24 @@ open_pack_or_rev_file(svn_fs_fs__revision_file_t *file,
 
       if (!err)
         {
+          SVN__COUNTER_INC(rev_file_opens);
+
           file->file = apr_file;
           file->stream = svn_stream_from_aprfile2(apr_file, TRUE,
                                                   result_pool);
           file->is_packed = svn_fs_fs__is_packed_rev(fs, rev);
 
+          if (file->trace)
+            {
+              const char *relpath = svn_dirent_skip_ancestor(fs->path, path);
+              file->trace_path = apr_pstrdup(result_pool,
+                                             relpath ? relpath : path);
+            }
+
+          /* Pack files opened for modification must not be mapped. */
+          if (!writable)
+            SVN_ERR(auto_map_pack_file(file, fs, scratch_pool));
+
           return SVN_NO_ERROR;
         }
 
@@ -227,10 +307,53 @@ svn_fs_fs__open_pack_or_rev_file_writable(svn_fs_fs__revision_file_t** file,
                                                result_pool, scratch_pool));
 }
 
+const char *
+svn_fs_fs__rev_file_mapped_data(svn_fs_fs__revision_file_t *file,
+                                apr_off_t offset,
+                                apr_size_t len)
+{
+  if (   file->mapped_data
+      && offset >= 0
+      && (apr_uint64_t)offset <= file->mapped_size
+      && len <= file->mapped_size - (apr_size_t)offset)
+    return file->mapped_data + offset;
+
+  return NULL;
+}
+
 svn_error_t *
 svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file)
 {
-  if (file->l2p_offset == -1)
+  if (file->l2p_offset == -1 && file->mapped_data)
+    {
+      apr_off_t filesize = file->mapped_size;
+      unsigned char footer_length;
+      svn_stringbuf_t *footer;
+
+      /* Read the footer straight from the mapping. */
+      svn_fs_fs__trace_read(file, svn_fs_fs__io_footer, filesize - 1, 1);
+      footer_length = (unsigned char)file->mapped_data[filesize - 1];
+      if (footer_length > filesize - 1)
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, NULL,
+                                 _("Invalid footer length %d in pack file "
+                                   "for revision %ld"),
+                                 (int)footer_length, file->start_revision);
+
+      svn_fs_fs__trace_read(file, svn_fs_fs__io_footer,
+                            filesize - 1 - footer_length, footer_length);
+      footer = svn_stringbuf_ncreate(file->mapped_data + filesize - 1
+                                       - footer_length,
+                                     footer_length, file->pool);
+
+      /* Extract index locations. */
+      SVN_ERR(svn_fs_fs__parse_footer(&file->l2p_offset, &file->l2p_checksum,
+                                      &file->p2l_offset, &file->p2l_checksum,
+                                      footer, file->start_revision,
+                                      filesize - footer_length - 1,
+                                      file->pool));
+      file->footer_offset = filesize - footer_length - 1;
+    }
+  else if (file->l2p_offset == -1)
     {
       apr_off_t filesize = 0;
       unsigned char footer_length;
@@ -240,6 +363,7 @@ svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file)
       SVN_ERR(svn_io_file_seek(file->file, APR_END, &filesize, file->pool));
 
       /* Read last byte (containing the length of the footer). */
+      svn_fs_fs__trace_read(file, svn_fs_fs__io_footer, filesize - 1, 1);
       SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
                                        filesize - 1, file->pool));
       SVN_ERR(svn_io_file_read_full2(file->file, &footer_length,
@@ -248,6 +372,8 @@ svn_fs_fs__auto_read_footer(svn_fs_fs__revision_file_t *file)
 
       /* Read footer. */
       footer = svn_stringbuf_create_ensure(footer_length, file->pool);
+      svn_fs_fs__trace_read(file, svn_fs_fs__io_footer,
+                            filesize - 1 - footer_length, footer_length);
       SVN_ERR(svn_io_file_aligned_seek(file->file, file->block_size, NULL,
                                        filesize - 1 - footer_length,
                                        file->pool));
@@ -290,6 +416,91 @@ svn_fs_fs__open_proto_rev_file(svn_fs_fs__revision_file_t **file,
   return SVN_NO_ERROR;
 }
 
+struct svn_fs_fs__io_trace_t
+{
+  /* trace file, opened for appending */
+  apr_file_t *file;
+
+  /* records not written to FILE, yet */
+  svn_stringbuf_t *buffer;
+};
+
+/* Write the buffered records once they exceed this many bytes. */
+#define IO_TRACE_FLUSH_SIZE 0x4000
+
+/* Names of the svn_fs_fs__io_cause_t values as used in the trace file. */
+static const char * const io_cause_names[] =
+  { "footer", "l2p", "p2l", "noderev", "changes", "rep", "block" };
+
+/* Write all records buffered in TRACE to its file.  Errors are ignored. */
+static void
+flush_io_trace(svn_fs_fs__io_trace_t *trace)
+{
+  apr_size_t written;
+
+  if (trace->buffer->len)
+    {
+      apr_file_write_full(trace->file, trace->buffer->data,
+                          trace->buffer->len, &written);
+      svn_stringbuf_setempty(trace->buffer);
+    }
+}
+
+/* APR pool cleanup function flushing the svn_fs_fs__io_trace_t BATON. */
+static apr_status_t
+flush_io_trace_cleanup(void *baton)
+{
+  flush_io_trace(baton);
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_fs_fs__io_trace_open(svn_fs_fs__io_trace_t **trace,
+                         const char *path,
+                         apr_pool_t *result_pool)
+{
+  svn_fs_fs__io_trace_t *result = apr_pcalloc(result_pool, sizeof(*result));
+
+  /* Unbuffered, so that each flush becomes a single append. */
+  SVN_ERR(svn_io_file_open(&result->file, path,
+                           APR_WRITE | APR_CREATE | APR_APPEND,
+                           APR_OS_DEFAULT, result_pool));
+  result->buffer = svn_stringbuf_create_ensure(2 * IO_TRACE_FLUSH_SIZE,
+                                               result_pool);
+
+  /* Registered after opening the file, so this runs before closing it. */
+  apr_pool_cleanup_register(result_pool, result, flush_io_trace_cleanup,
+                            apr_pool_cleanup_null);
+
+  *trace = result;
+
+  return SVN_NO_ERROR;
+}
+
+void
+svn_fs_fs__trace_read(svn_fs_fs__revision_file_t *file,
+                      svn_fs_fs__io_cause_t cause,
+                      apr_off_t offset,
+                      apr_size_t len)
+{
+  svn_fs_fs__io_trace_t *trace = file->trace;
+  char record[128];
+
+  if (trace == NULL || file->trace_path == NULL)
+    return;
+
+  apr_snprintf(record, sizeof(record), "%" APR_TIME_T_FMT " %s ",
+               apr_time_now(), io_cause_names[cause]);
+  svn_stringbuf_appendcstr(trace->buffer, record);
+  svn_stringbuf_appendcstr(trace->buffer, file->trace_path);
+  apr_snprintf(record, sizeof(record), " %" APR_OFF_T_FMT " %"
+               APR_SIZE_T_FMT "\n", offset, len);
+  svn_stringbuf_appendcstr(trace->buffer, record);
+
+  if (trace->buffer->len >= IO_TRACE_FLUSH_SIZE)
+    flush_io_trace(trace);
+}
+
 svn_error_t *
 svn_fs_fs__close_revision_file(svn_fs_fs__revision_file_t *file)
 {
@@ -300,6 +511,8 @@ svn_fs_fs__close_revision_file(svn_fs_fs__revision_file_t *file)
 
   file->file = NULL;
   file->stream = NULL;
+  file->mapped_data = NULL;
+  file->mapped_size = 0;
   file->l2p_stream = NULL;
   file->p2l_stream = NULL;
 
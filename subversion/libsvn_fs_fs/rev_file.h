@@ -38,6 +38,36 @@
 typedef struct svn_fs_fs__packed_number_stream_t
   svn_fs_fs__packed_number_stream_t;
 
+/* Opaque I/O trace type, see svn_fs_fs__io_trace_open().
+ */
+typedef struct svn_fs_fs__io_trace_t svn_fs_fs__io_trace_t;
+
+/* What a read from a rev / pack file is for, as recorded in I/O traces.
+ */
+typedef enum svn_fs_fs__io_cause_t
+{
+  /* the footer, i.e. index locations */
+  svn_fs_fs__io_footer,
+
+  /* log-to-phys index */
+  svn_fs_fs__io_l2p_index,
+
+  /* phys-to-log index */
+  svn_fs_fs__io_p2l_index,
+
+  /* a node revision */
+  svn_fs_fs__io_noderev,
+
+  /* a changed paths list */
+  svn_fs_fs__io_changes,
+
+  /* representation headers and contents */
+  svn_fs_fs__io_rep,
+
+  /* prefetching a whole block */
+  svn_fs_fs__io_block
+} svn_fs_fs__io_cause_t;
+
 /* Data file, including indexes data, and associated properties for
  * START_REVISION.  As the FILE is kept open, background pack operations
  * will not cause access to this file to fail.
@@ -57,6 +87,13 @@ typedef struct svn_fs_fs__revision_file_t
   /* stream based on FILE and not NULL exactly when FILE is not NULL */
   svn_stream_t *stream;
 
+  /* If not NULL, a read-only memory mapping of the first MAPPED_SIZE bytes
+   * of FILE, i.e. of the whole pack file.  Mappings are shared between all
+   * readers of the respective pack file and remain valid for the lifetime
+   * of the FS' shared data, i.e. longer than POOL. */
+  const char *mapped_data;
+  apr_size_t mapped_size;
+
   /* the opened P2L index stream or NULL.  Always NULL for txns. */
   svn_fs_fs__packed_number_stream_t *p2l_stream;
 
@@ -90,6 +127,12 @@ typedef struct svn_fs_fs__revision_file_t
    * been called, yet. */
   apr_off_t footer_offset;
 
+  /* I/O trace to record reads from FILE in.  NULL if not tracing. */
+  svn_fs_fs__io_trace_t *trace;
+
+  /* Path of FILE relative to the FS root.  NULL if TRACE is NULL. */
+  const char *trace_path;
+
   /* pool containing this object */
   apr_pool_t *pool;
 } svn_fs_fs__revision_file_t;
@@ -120,6 +163,15 @@ svn_fs_fs__open_pack_or_rev_file_writable(svn_fs_fs__revision_file_t **file,
                                           apr_pool_t *result_pool,
                                           apr_pool_t *scratch_pool);
 
+/* If FILE is backed by a memory mapping that covers the LEN bytes starting
+ * at OFFSET, return a pointer to the first of these bytes.  Return NULL
+ * otherwise.  The data must not be modified.
+ */
+const char *
+svn_fs_fs__rev_file_mapped_data(svn_fs_fs__revision_file_t *file,
+                                apr_off_t offset,
+                                apr_size_t len);
+
 /* If the footer data in FILE has not been read, yet, do so now.
  * Index locations will only be read upon request as we assume they get
  * cached and the FILE is usually used for REP data access only.
@@ -137,6 +189,34 @@ svn_fs_fs__open_proto_rev_file(svn_fs_fs__revision_file_t **file,
                                apr_pool_t* result_pool,
                                apr_pool_t *scratch_pool);
 
+/* Open the I/O trace file at PATH for appending and return it in *TRACE.
+ * Records get buffered and written in batches of whole lines, so several
+ * processes may share the same trace file.  The buffer is flushed when
+ * RESULT_POOL gets cleaned up.
+ *
+ * Each line of the trace file reads
+ *
+ *     TIME CAUSE FILE OFFSET LENGTH
+ *
+ * with TIME in microseconds since the epoch, FILE relative to the FS root
+ * and LENGTH being 0 if the number of bytes to read was not known, e.g.
+ * when parsing a noderev line by line.
+ */
+svn_error_t *
+svn_fs_fs__io_trace_open(svn_fs_fs__io_trace_t **trace,
+                         const char *path,
+                         apr_pool_t *result_pool);
+
+/* If FILE is being traced, record that LEN bytes are about to be read
+ * at OFFSET for CAUSE.  Never fails; tracing problems must not affect
+ * the actual reads.
+ */
+void
+svn_fs_fs__trace_read(svn_fs_fs__revision_file_t *file,
+                      svn_fs_fs__io_cause_t cause,
+                      apr_off_t offset,
+                      apr_size_t len);
+
 /* Close all files and streams in FILE.
  */
 svn_error_t *
@@ -214,8 +214,127 @@ svn_fs_fs__reset_revprop_cache(svn_fs_t *fs)
   ffd->revprop_prefix = 0;
 }
 
-/* If FS has not a revprop cache prefix set, generate one.
- * Always call this before accessing the revprop cache.
+/* Revprop generation handling.
+ *
+ * Revprops of existing revisions may change at any time, yet we want to
+ * keep them cached across sync barriers, svn_fs_t instances and - with
+ * a shared membuffer cache - processes.  To that end, the revprop cache
+ * keys contain the current "revprop generation" as stored in the
+ * revprop-generation file.  Every revprop change bumps that number
+ * twice: to an odd value before modifying any revprop file and to the
+ * next even value once done.  Readers see the new generation after their
+ * next sync barrier and then no longer hit the old cache entries.
+ *
+ * While a change is in progress (odd generation), readers fall back to
+ * a private cache key that is never shared with anyone else.
+ */
+
+/* Set *GENERATION to the current revprop generation of FS.  A missing
+ * generation file means generation 0.  Use SCRATCH_POOL for temporary
+ * allocations. */
+static svn_error_t *
+read_revprop_generation(apr_int64_t *generation,
+                        svn_fs_t *fs,
+                        apr_pool_t *scratch_pool)
+{
+  const char *path = svn_fs_fs__path_revprop_generation(fs, scratch_pool);
+  svn_stringbuf_t *content = NULL;
+  svn_boolean_t missing = FALSE;
+  svn_error_t *err;
+  int i;
+
+  /* Writers replace the file atomically, so retry on the usual sharing
+   * violations on network file systems. */
+  for (i = 0;
+       i < SVN_FS_FS__RECOVERABLE_RETRY_COUNT && !content && !missing;
+       ++i)
+    SVN_ERR(svn_fs_fs__try_stringbuf_from_file(&content, &missing, path,
+                                i + 1 < SVN_FS_FS__RECOVERABLE_RETRY_COUNT,
+                                scratch_pool));
+
+  if (!content)
+    {
+      *generation = 0;
+      return SVN_NO_ERROR;
+    }
+
+  svn_stringbuf_strip_whitespace(content);
+  err = svn_cstring_atoi64(generation, content->data);
+  if (err || *generation < 0)
+    return svn_error_createf(SVN_ERR_FS_CORRUPT, err,
+                             _("Revprop generation file '%s' is corrupt"),
+                             svn_dirent_local_style(path, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Write GENERATION to the revprop generation file of FS.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_revprop_generation(svn_fs_t *fs,
+                         apr_int64_t generation,
+                         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  const char *content = apr_psprintf(scratch_pool, "%" APR_INT64_T_FMT "\n",
+                                     generation);
+
+  SVN_ERR(svn_io_write_atomic2(svn_fs_fs__path_revprop_generation(fs,
+                                                              scratch_pool),
+                               content, strlen(content),
+                               svn_fs_fs__path_current(fs, scratch_pool),
+                               ffd->flush_to_disk, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Announce that revprops in FS are about to change by switching to a new,
+ * odd revprop generation.  Return it in *GENERATION.  The caller must hold
+ * the FS write lock.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+begin_revprop_change(apr_int64_t *generation,
+                     svn_fs_t *fs,
+                     apr_pool_t *scratch_pool)
+{
+  SVN_ERR(read_revprop_generation(generation, fs, scratch_pool));
+
+  /* An odd value means that a previous change has been interrupted.
+   * Get a new one anyway such that nobody keeps using the old value. */
+  *generation += (*generation % 2) ? 2 : 1;
+  SVN_ERR(write_revprop_generation(fs, *generation, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Finish the revprop change in FS started by begin_revprop_change(),
+ * which returned GENERATION.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+end_revprop_change(svn_fs_t *fs,
+                   apr_int64_t generation,
+                   apr_pool_t *scratch_pool)
+{
+  svn_fs_fs__reset_revprop_cache(fs);
+  SVN_ERR(write_revprop_generation(fs, generation + 1, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__bump_revprop_generation(svn_fs_t *fs,
+                                   apr_pool_t *scratch_pool)
+{
+  apr_int64_t generation;
+
+  SVN_ERR(begin_revprop_change(&generation, fs, scratch_pool));
+  SVN_ERR(end_revprop_change(fs, generation, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* If FS has not a revprop cache prefix set, determine one from the
+ * current revprop generation.  Always call this before accessing the
+ * revprop cache.
  */
 static svn_error_t *
 prepare_revprop_cache(svn_fs_t *fs,
@@ -223,7 +342,23 @@ prepare_revprop_cache(svn_fs_t *fs,
 {
   fs_fs_data_t *ffd = fs->fsap_data;
   if (!ffd->revprop_prefix)
-    SVN_ERR(svn_atomic__unique_counter(&ffd->revprop_prefix));
+    {
+      apr_int64_t generation;
+      SVN_ERR(read_revprop_generation(&generation, fs, scratch_pool));
+
+      /* Stable generations map to even, shared prefixes that are never 0.
+       * During a change, use an odd prefix that is unique to us. */
+      if (generation % 2 == 0)
+        {
+          ffd->revprop_prefix = (apr_uint64_t)generation + 2;
+        }
+      else
+        {
+          apr_uint64_t unique;
+          SVN_ERR(svn_atomic__unique_counter(&unique));
+          ffd->revprop_prefix = unique * 2 + 1;
+        }
+    }
 
   return SVN_NO_ERROR;
 }
@@ -744,10 +879,9 @@ svn_fs_fs__get_revision_proplist(apr_hash_t **proplist_p,
 {
   fs_fs_data_t *ffd = fs->fsap_data;
 
-  /* Only populate the cache if we did not just cross a sync barrier.
-   * This is to eliminate overhead from code that always sets REFRESH.
-   * For callers that want caching, the caching kicks in on read "later". */
-  svn_boolean_t populate_cache = !refresh;
+  /* The cache keys follow the revprop generation, so whatever we read
+   * remains valid across sync barriers. */
+  svn_boolean_t populate_cache = TRUE;
 
   /* not found, yet */
   *proplist_p = NULL;
@@ -755,31 +889,30 @@ svn_fs_fs__get_revision_proplist(apr_hash_t **proplist_p,
   /* should they be available at all? */
   SVN_ERR(svn_fs_fs__ensure_revision_exists(rev, fs, scratch_pool));
 
+  /* Crossing a sync barrier means re-reading the revprop generation.
+   * Cached revprops from before are only used if it did not change. */
   if (refresh)
-    {
-      /* Previous cache contents is invalid now. */
-      svn_fs_fs__reset_revprop_cache(fs);
-    }
-  else
-    {
-      /* Try cache lookup first. */
-      svn_boolean_t is_cached;
-      pair_cache_key_t key;
-
-      /* Auto-alloc prefix and construct the key. */
-      SVN_ERR(prepare_revprop_cache(fs, scratch_pool));
-      key.revision = rev;
-      key.second = ffd->revprop_prefix;
-
-      /* The only way that this might error out is due to parser error. */
-      SVN_ERR_W(svn_cache__get((void **) proplist_p, &is_cached,
-                               ffd->revprop_cache, &key, result_pool),
-                apr_psprintf(scratch_pool,
-                             "Failed to parse revprops for r%ld.",
-                             rev));
-      if (is_cached)
-        return SVN_NO_ERROR;
-    }
+    svn_fs_fs__reset_revprop_cache(fs);
+
+  /* Try cache lookup first. */
+  {
+    svn_boolean_t is_cached;
+    pair_cache_key_t key;
+
+    /* Auto-alloc prefix and construct the key. */
+    SVN_ERR(prepare_revprop_cache(fs, scratch_pool));
+    key.revision = rev;
+    key.second = ffd->revprop_prefix;
+
+    /* The only way that this might error out is due to parser error. */
+    SVN_ERR_W(svn_cache__get((void **) proplist_p, &is_cached,
+                             ffd->revprop_cache, &key, result_pool),
+              apr_psprintf(scratch_pool,
+                           "Failed to parse revprops for r%ld.",
+                           rev));
+    if (is_cached)
+      return SVN_NO_ERROR;
+  }
 
   /* if REV had not been packed when we began, try reading it from the
    * non-packed shard.  If that fails, we will fall through to packed
@@ -1233,6 +1366,8 @@ svn_fs_fs__set_revision_proplist(svn_fs_t *fs,
   const char *tmp_path;
   const char *perms_reference;
   apr_array_header_t *files_to_delete = NULL;
+  apr_int64_t generation;
+  svn_error_t *err;
 
   SVN_ERR(svn_fs_fs__ensure_revision_exists(rev, fs, pool));
 
@@ -1247,9 +1382,6 @@ svn_fs_fs__set_revision_proplist(svn_fs_t *fs,
     SVN_ERR(write_non_packed_revprop(&final_path, &tmp_path,
                                      fs, rev, proplist, pool));
 
-  /* Previous cache contents is invalid now. */
-  svn_fs_fs__reset_revprop_cache(fs);
-
   /* We use the rev file of this revision as the perms reference,
    * because when setting revprops for the first time, the revprop
    * file won't exist and therefore can't serve as its own reference.
@@ -1257,11 +1389,17 @@ svn_fs_fs__set_revision_proplist(svn_fs_t *fs,
    */
   perms_reference = svn_fs_fs__path_rev_absolute(fs, rev, pool);
 
-  /* Now, switch to the new revprop data. */
-  SVN_ERR(switch_to_new_revprop(fs, final_path, tmp_path, perms_reference,
-                                files_to_delete, pool));
-
-  return SVN_NO_ERROR;
+  /* Now, switch to the new revprop data.  Previous cache contents in all
+   * processes becomes invalid with the generation change.  Even if the
+   * switch failed, we don't know which data readers may see now, so
+   * always move on to a new stable generation. */
+  SVN_ERR(begin_revprop_change(&generation, fs, pool));
+  err = switch_to_new_revprop(fs, final_path, tmp_path, perms_reference,
+                              files_to_delete, pool);
+  err = svn_error_compose_create(err, end_revprop_change(fs, generation,
+                                                         pool));
+
+  return svn_error_trace(err);
 }
 
 /* Return TRUE, if for REVISION in FS, we can find the revprop pack file.
@@ -58,10 +58,20 @@ svn_fs_fs__upgrade_cleanup_pack_revprops(svn_fs_t *fs,
                                          void *cancel_baton,
                                          apr_pool_t *scratch_pool);
 
-/* Invalidate the revprop cache in FS. */
+/* Invalidate the revprop cache in FS.  The next access will re-read the
+ * revprop generation. */
 void
 svn_fs_fs__reset_revprop_cache(svn_fs_t *fs);
 
+/* Switch FS to a new revprop generation, such that no process will use
+ * revprops cached before.  Call this after modifying revprop files other
+ * than through svn_fs_fs__set_revision_proplist().  The caller must hold
+ * the FS write lock.  Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_fs__bump_revprop_generation(svn_fs_t *fs,
+                                   apr_pool_t *scratch_pool);
+
 /* Set *PROPS_SIZE_P to the size in bytes on disk of the revprops for
  * revision REV in FS. The size excludes indexes.
  */
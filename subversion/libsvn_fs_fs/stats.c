@@ -22,6 +22,7 @@
 
 #include "svn_dirent_uri.h"
 #include "svn_fs.h"
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_sorts.h"
 
@@ -96,8 +97,30 @@ typedef struct rep_stats_t
   /* length of the delta chain, including this representation,
    * saturated to 255 - if need be */
   apr_byte_t chain_length;
+
+  /* number of shards touched by the delta chain, including the one that
+   * contains this representation, saturated to 255 - if need be */
+  apr_byte_t chain_shards;
+
+  /* sum of SIZE over the whole delta chain, i.e. the number of bytes to
+   * read to reconstruct the fulltext of this representation */
+  apr_uint64_t chain_cost;
 } rep_stats_t;
 
+/* What we know about a file path.
+ */
+typedef struct path_info_t
+{
+  /* text representation of the latest node revision found so far */
+  rep_stats_t *latest;
+
+  /* revision of that node revision */
+  svn_revnum_t revision;
+
+  /* number of node revisions with this path found so far */
+  apr_uint64_t change_count;
+} path_info_t;
+
 /* Represents a link in the rep delta chain.  REVISION + ITEM_INDEX points
  * to BASE_REVISION + BASE_ITEM_INDEX.  We collect this info while scanning
  * a f7 repo in a single pass and resolve it afterwards. */
@@ -189,6 +212,9 @@ typedef struct query_t
    * Used as a dummy base for DELTA reps without base. */
   rep_stats_t *null_base;
 
+  /* created path -> path_info_t * for all file nodes */
+  apr_hash_t *paths;
+
   /* collected statistics */
   svn_fs_fs__stats_t *stats;
 
@@ -419,6 +445,51 @@ find_representation(int *idx,
   return NULL;
 }
 
+/* Return TRUE if revisions REV1 and REV2 in QUERY are in the same shard.
+ */
+static svn_boolean_t
+same_shard(query_t *query,
+           svn_revnum_t rev1,
+           svn_revnum_t rev2)
+{
+  if (query->shard_size == 0)
+    return TRUE;
+
+  return rev1 / query->shard_size == rev2 / query->shard_size;
+}
+
+/* Make REP the next element in the delta chain of BASE, i.e. set its
+ * delta chain length, shard count and reconstruction cost.  BASE is NULL
+ * for PLAIN and self-delta representations.  Count the link in QUERY.
+ */
+static void
+link_to_base(query_t *query,
+             rep_stats_t *rep,
+             const rep_stats_t *base)
+{
+  if (base == NULL)
+    {
+      rep->chain_length = 1;
+      rep->chain_shards = 1;
+      rep->chain_cost = rep->size;
+      return;
+    }
+
+  rep->chain_length = 1 + MIN(base->chain_length, (apr_byte_t)0xfe);
+  rep->chain_cost = rep->size + base->chain_cost;
+
+  query->stats->delta_count++;
+  if (same_shard(query, rep->revision, base->revision))
+    {
+      rep->chain_shards = base->chain_shards;
+    }
+  else
+    {
+      rep->chain_shards = 1 + MIN(base->chain_shards, (apr_byte_t)0xfe);
+      query->stats->cross_shard_delta_count++;
+    }
+}
+
 /* Find / auto-construct the representation stats for REP in QUERY and
  * return it in *REPRESENTATION.
  *
@@ -470,7 +541,7 @@ parse_representation(rep_stats_t **representation,
 
           result->header_size = header->header_size;
 
-          /* Determine length of the delta chain. */
+          /* Determine length and cost of the delta chain. */
           if (header->type == svn_fs_fs__rep_delta)
             {
               int base_idx;
@@ -479,12 +550,11 @@ parse_representation(rep_stats_t **representation,
                                       header->base_revision,
                                       header->base_item_index);
 
-              result->chain_length = 1 + MIN(base_rep->chain_length,
-                                             (apr_byte_t)0xfe);
+              link_to_base(query, result, base_rep);
             }
           else
             {
-              result->chain_length = 1;
+              link_to_base(query, result, NULL);
             }
         }
 
@@ -497,6 +567,33 @@ parse_representation(rep_stats_t **representation,
 }
 
 
+/* Count another change of the file at PATH in REVISION in QUERY.  If it
+ * is the latest one found so far, remember TEXT as its text.
+ */
+static void
+record_path(query_t *query,
+            const char *path,
+            rep_stats_t *text,
+            svn_revnum_t revision)
+{
+  path_info_t *info = svn_hash_gets(query->paths, path);
+  if (info == NULL)
+    {
+      apr_pool_t *pool = apr_hash_pool_get(query->paths);
+      info = apr_pcalloc(pool, sizeof(*info));
+      info->revision = SVN_INVALID_REVNUM;
+      svn_hash_sets(query->paths, apr_pstrdup(pool, path), info);
+    }
+
+  /* Pack files are not necessarily in revision order. */
+  info->change_count++;
+  if (revision >= info->revision)
+    {
+      info->latest = text;
+      info->revision = revision;
+    }
+}
+
 /* forward declaration */
 static svn_error_t *
 read_noderev(query_t *query,
@@ -645,6 +742,11 @@ read_noderev(query_t *query,
                                                     : file_property_rep;
     }
 
+  /* remember the latest text of each file path */
+  if (text && noderev->kind == svn_node_file)
+    record_path(query, noderev->created_path, text,
+                revision_info->revision);
+
   /* record largest changes */
   if (text && text->ref_count == 1)
     add_change(query->stats, text->size, text->expanded_size, text->revision,
@@ -970,7 +1072,7 @@ resolve_representation_refs(query_t *query,
       /* The delta chain got 1 element longer. */
       if (ref->base_revision == SVN_INVALID_REVNUM)
         {
-          rep->chain_length = 1;
+          link_to_base(query, rep, NULL);
         }
       else
         {
@@ -981,7 +1083,7 @@ resolve_representation_refs(query_t *query,
           SVN_ERR_ASSERT(base);
           SVN_ERR_ASSERT(base->chain_length);
 
-          rep->chain_length = 1 + MIN(base->chain_length, (apr_byte_t)0xfe);
+          link_to_base(query, rep, base);
         }
     }
 
@@ -1313,10 +1415,121 @@ aggregate_stats(const apr_array_header_t *revisions,
             }
 
           add_rep_stats(&stats->total_rep_stats, rep);
+          add_to_histogram(&stats->chain_length_histogram,
+                           rep->chain_length);
         }
     }
 }
 
+/* Number of entries in the COSTLY_PATHS and HOT_PATHS lists. */
+#define TOP_PATH_COUNT 16
+
+/* Predicate ordering svn_fs_fs__path_cost_t ** by descending
+ * RECONSTRUCT_SIZE.
+ */
+static int
+compare_reconstruct_size(const void *lhs,
+                         const void *rhs)
+{
+  apr_uint64_t lhs_size
+    = (*(const svn_fs_fs__path_cost_t *const *)lhs)->reconstruct_size;
+  apr_uint64_t rhs_size
+    = (*(const svn_fs_fs__path_cost_t *const *)rhs)->reconstruct_size;
+
+  if (lhs_size > rhs_size)
+    return -1;
+  return (lhs_size < rhs_size ? 1 : 0);
+}
+
+/* Predicate ordering svn_fs_fs__path_cost_t ** by descending
+ * CHANGE_COUNT.
+ */
+static int
+compare_change_count(const void *lhs,
+                     const void *rhs)
+{
+  apr_uint64_t lhs_count
+    = (*(const svn_fs_fs__path_cost_t *const *)lhs)->change_count;
+  apr_uint64_t rhs_count
+    = (*(const svn_fs_fs__path_cost_t *const *)rhs)->change_count;
+
+  if (lhs_count > rhs_count)
+    return -1;
+  return (lhs_count < rhs_count ? 1 : 0);
+}
+
+/* Copy the first TOP_PATH_COUNT entries of COSTS, after sorting it with
+ * COMPARISON_FUNC, into the path cost array TARGET.  Allocate the copies
+ * in RESULT_POOL.
+ */
+static void
+select_top_paths(apr_array_header_t *target,
+                 apr_array_header_t *costs,
+                 int (*comparison_func)(const void *, const void *),
+                 apr_pool_t *result_pool)
+{
+  int i;
+
+  svn_sort__array(costs, comparison_func);
+  for (i = 0; i < MIN(costs->nelts, TOP_PATH_COUNT); ++i)
+    {
+      svn_fs_fs__path_cost_t *cost
+        = apr_pmemdup(result_pool,
+                      APR_ARRAY_IDX(costs, i, svn_fs_fs__path_cost_t *),
+                      sizeof(*cost));
+      cost->path = apr_pstrdup(result_pool, cost->path);
+
+      APR_ARRAY_PUSH(target, svn_fs_fs__path_cost_t *) = cost;
+    }
+}
+
+/* Aggregate the read costs of the latest text of every file path in QUERY
+ * into the respective fields of its STATS.  Allocate the path lists in
+ * RESULT_POOL and use SCRATCH_POOL for temporary allocations.
+ */
+static void
+aggregate_path_stats(query_t *query,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  svn_fs_fs__stats_t *stats = query->stats;
+  apr_array_header_t *costs
+    = apr_array_make(scratch_pool, apr_hash_count(query->paths),
+                     sizeof(svn_fs_fs__path_cost_t *));
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, query->paths);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const path_info_t *info = apr_hash_this_val(hi);
+      svn_fs_fs__path_cost_t *cost = apr_pcalloc(scratch_pool, sizeof(*cost));
+
+      cost->path = apr_hash_this_key(hi);
+      cost->revision = info->revision;
+      cost->change_count = info->change_count;
+      cost->chain_length = info->latest->chain_length;
+      cost->shard_count = info->latest->chain_shards;
+      cost->expanded_size = info->latest->expanded_size;
+      cost->reconstruct_size = info->latest->chain_cost;
+
+      stats->head_expanded_size += cost->expanded_size;
+      stats->head_reconstruct_size += cost->reconstruct_size;
+      add_to_histogram(&stats->head_chain_length_histogram,
+                       cost->chain_length);
+      add_to_histogram(&stats->head_reconstruct_histogram,
+                       cost->reconstruct_size);
+      add_to_histogram(&stats->head_shard_histogram, cost->shard_count);
+
+      APR_ARRAY_PUSH(costs, svn_fs_fs__path_cost_t *) = cost;
+    }
+
+  select_top_paths(stats->costly_paths, costs, compare_reconstruct_size,
+                   result_pool);
+  select_top_paths(stats->hot_paths, costs, compare_change_count,
+                   result_pool);
+}
+
 /* Return a new svn_fs_fs__stats_t instance, allocated in RESULT_POOL.
  */
 static svn_fs_fs__stats_t *
@@ -1326,6 +1539,10 @@ create_stats(apr_pool_t *result_pool)
 
   initialize_largest_changes(stats, 64, result_pool);
   stats->by_extension = apr_hash_make(result_pool);
+  stats->costly_paths = apr_array_make(result_pool, TOP_PATH_COUNT,
+                                       sizeof(svn_fs_fs__path_cost_t *));
+  stats->hot_paths = apr_array_make(result_pool, TOP_PATH_COUNT,
+                                    sizeof(svn_fs_fs__path_cost_t *));
 
   return stats;
 }
@@ -1364,6 +1581,7 @@ create_query(query_t **query,
                                        sizeof(revision_info_t *));
   (*query)->null_base = apr_pcalloc(result_pool,
                                     sizeof(*(*query)->null_base));
+  (*query)->paths = apr_hash_make(result_pool);
 
   /* Store other parameters */
   (*query)->fs = fs;
@@ -1394,6 +1612,7 @@ svn_fs_fs__get_stats(svn_fs_fs__stats_t **stats,
                        scratch_pool));
   SVN_ERR(read_revisions(query, scratch_pool, scratch_pool));
   aggregate_stats(query->revisions, *stats);
+  aggregate_path_stats(query, result_pool, scratch_pool);
 
   return SVN_NO_ERROR;
 }
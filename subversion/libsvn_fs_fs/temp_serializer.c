@@ -173,8 +173,32 @@ typedef struct dir_data_t
   /* size of the serialized entries and don't be too wasteful
    * (needed since the entries are no longer in sequence) */
   apr_uint32_t *lengths;
+
+  /* If set, the entries are stored in the packed format below and
+   * ENTRIES as well as LENGTHS are NULL.  We use it for committed
+   * directories, which never get modified in-place.
+   *
+   * Entries are grouped into blocks of PACKED_DIR_BLOCK_SIZE.  For each
+   * block, BLOCKS holds the offsets of its first entry within NAMES and
+   * IDS, in that order.  The first name of each block is stored in full,
+   * all others as the 7b/8b-encoded length of the prefix shared with the
+   * previous name followed by the remainder.  All names are NUL-terminated.
+   * For each entry, IDS contains the node kind as a single byte followed
+   * by the 7b/8b-encoded node ID, copy ID and rev-item parts of its ID. */
+  svn_boolean_t packed;
+  apr_uint32_t *blocks;
+  char *names;
+  unsigned char *ids;
+
+  /* number of bytes in NAMES and IDS, respectively */
+  apr_size_t names_len;
+  apr_size_t ids_len;
 } dir_data_t;
 
+/* Number of entries per block in packed directories.  Lookups have to
+ * decode up to that many entries sequentially. */
+#define PACKED_DIR_BLOCK_SIZE 16
+
 /* Utility function to serialize the *ENTRY_P into a the given
  * serialization CONTEXT. Return the serialized size of the
  * dir entry in *LENGTH.
@@ -297,6 +321,326 @@ deserialize_dir(void *buffer, dir_data_t *dir_data, apr_pool_t *pool)
   return result;
 }
 
+/* Append the 7b/8b-encoded ID PART to P and return the end of the
+ * encoded data. */
+static unsigned char *
+encode_id_part(unsigned char *p,
+               const svn_fs_fs__id_part_t *part)
+{
+  p = svn__encode_int(p, part->revision);
+  return svn__encode_uint(p, part->number);
+}
+
+/* Decode an ID part from P into *PART and return the position following
+ * it.  END is the end of the encoded data. */
+static const unsigned char *
+decode_id_part(svn_fs_fs__id_part_t *part,
+               const unsigned char *p,
+               const unsigned char *end)
+{
+  apr_int64_t revision;
+
+  p = svn__decode_int(&revision, p, end);
+  part->revision = (svn_revnum_t)revision;
+  return svn__decode_uint(&part->number, p, end);
+}
+
+/* Return TRUE if DIR can be stored in the packed format, i.e. all of its
+ * entries refer to committed nodes. */
+static svn_boolean_t
+is_packable_dir(svn_fs_fs__dir_data_t *dir)
+{
+  int i;
+
+  for (i = 0; i < dir->entries->nelts; ++i)
+    {
+      const svn_fs_dirent_t *entry
+        = APR_ARRAY_IDX(dir->entries, i, const svn_fs_dirent_t *);
+
+      if (svn_fs_fs__id_is_txn(entry->id))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Utility function to serialize DIR in the packed format into a new
+ * serialization context to be returned.  See dir_data_t for the layout.
+ * Allocation will be made form POOL.
+ */
+static svn_temp_serializer__context_t *
+serialize_packed_dir(svn_fs_fs__dir_data_t *dir, apr_pool_t *pool)
+{
+  dir_data_t dir_data = { 0 };
+  apr_array_header_t *entries = dir->entries;
+  int count = entries->nelts;
+  int block_count = (count + PACKED_DIR_BLOCK_SIZE - 1)
+                  / PACKED_DIR_BLOCK_SIZE;
+  apr_size_t blocks_len = 2 * block_count * sizeof(*dir_data.blocks);
+  svn_stringbuf_t *names = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *ids = svn_stringbuf_create_empty(pool);
+  unsigned char buffer[1 + 6 * SVN__MAX_ENCODED_UINT_LEN];
+  const char *previous = "";
+  svn_temp_serializer__context_t *context;
+  int i;
+
+  dir_data.count = count;
+  dir_data.txn_filesize = dir->txn_filesize;
+  dir_data.packed = TRUE;
+  dir_data.blocks = block_count ? apr_palloc(pool, blocks_len) : NULL;
+
+  for (i = 0; i < count; ++i)
+    {
+      const svn_fs_dirent_t *entry
+        = APR_ARRAY_IDX(entries, i, const svn_fs_dirent_t *);
+      const char *name = entry->name;
+      unsigned char *p = buffer;
+
+      if (i % PACKED_DIR_BLOCK_SIZE == 0)
+        {
+          apr_uint32_t *block
+            = &dir_data.blocks[2 * (i / PACKED_DIR_BLOCK_SIZE)];
+          block[0] = (apr_uint32_t)names->len;
+          block[1] = (apr_uint32_t)ids->len;
+        }
+      else
+        {
+          apr_size_t prefix_len = 0;
+          while (name[prefix_len] && name[prefix_len] == previous[prefix_len])
+            ++prefix_len;
+
+          p = svn__encode_uint(p, prefix_len);
+          svn_stringbuf_appendbytes(names, (const char *)buffer, p - buffer);
+          name += prefix_len;
+        }
+
+      svn_stringbuf_appendbytes(names, name, strlen(name) + 1);
+      previous = entry->name;
+
+      p = buffer;
+      *p++ = (unsigned char)entry->kind;
+      p = encode_id_part(p, svn_fs_fs__id_node_id(entry->id));
+      p = encode_id_part(p, svn_fs_fs__id_copy_id(entry->id));
+      p = encode_id_part(p, svn_fs_fs__id_rev_item(entry->id));
+      svn_stringbuf_appendbytes(ids, (const char *)buffer, p - buffer);
+    }
+
+  dir_data.names = names->data;
+  dir_data.names_len = names->len;
+  dir_data.ids = (unsigned char *)ids->data;
+  dir_data.ids_len = ids->len;
+
+  context = svn_temp_serializer__init(&dir_data,
+                                      sizeof(dir_data),
+                                      50 + blocks_len + names->len + ids->len,
+                                      pool);
+  svn_temp_serializer__add_leaf(context,
+                                (const void * const *)&dir_data.blocks,
+                                blocks_len);
+  svn_temp_serializer__add_leaf(context,
+                                (const void * const *)&dir_data.names,
+                                names->len);
+  svn_temp_serializer__add_leaf(context,
+                                (const void * const *)&dir_data.ids,
+                                ids->len);
+
+  return context;
+}
+
+/* Cursor for reading the entries of a packed directory sequentially. */
+typedef struct packed_dir_reader_t
+{
+  /* next name to decode and the end of the NAMES buffer */
+  const char *names;
+  const char *names_end;
+
+  /* next ID to decode and the end of the IDS buffer */
+  const unsigned char *ids;
+  const unsigned char *ids_end;
+
+  /* the name of the entry read last */
+  svn_stringbuf_t *name;
+
+  /* kind and ID parts of the entry read last */
+  svn_node_kind_t kind;
+  svn_fs_fs__id_part_t node_id;
+  svn_fs_fs__id_part_t copy_id;
+  svn_fs_fs__id_part_t rev_item;
+} packed_dir_reader_t;
+
+/* Position READER at the start of block BLOCK in the packed directory
+ * DIR_DATA, whose BLOCKS, NAMES and IDS have been resolved to BLOCKS,
+ * NAMES and IDS, respectively. */
+static void
+seek_packed_block(packed_dir_reader_t *reader,
+                  const dir_data_t *dir_data,
+                  const apr_uint32_t *blocks,
+                  const char *names,
+                  const unsigned char *ids,
+                  int block)
+{
+  reader->names = names + blocks[2 * block];
+  reader->names_end = names + dir_data->names_len;
+  reader->ids = ids + blocks[2 * block + 1];
+  reader->ids_end = ids + dir_data->ids_len;
+  svn_stringbuf_setempty(reader->name);
+}
+
+/* Decode the next entry from READER.  FIRST_IN_BLOCK tells whether this
+ * entry starts a new block, i.e. its name is not prefix-compressed. */
+static void
+read_packed_entry(packed_dir_reader_t *reader,
+                  svn_boolean_t first_in_block)
+{
+  const char *name = reader->names;
+  apr_size_t len;
+
+  if (first_in_block)
+    {
+      svn_stringbuf_setempty(reader->name);
+    }
+  else
+    {
+      apr_uint64_t prefix_len;
+      name = (const char *)svn__decode_uint(&prefix_len,
+                                            (const unsigned char *)name,
+                                            (const unsigned char *)
+                                              reader->names_end);
+      svn_stringbuf_chop(reader->name,
+                         reader->name->len - (apr_size_t)prefix_len);
+    }
+
+  len = strlen(name);
+  svn_stringbuf_appendbytes(reader->name, name, len);
+  reader->names = name + len + 1;
+
+  reader->kind = (svn_node_kind_t)*reader->ids++;
+  reader->ids = decode_id_part(&reader->node_id, reader->ids,
+                               reader->ids_end);
+  reader->ids = decode_id_part(&reader->copy_id, reader->ids,
+                               reader->ids_end);
+  reader->ids = decode_id_part(&reader->rev_item, reader->ids,
+                               reader->ids_end);
+}
+
+/* Return the entry read last by READER as a new directory entry
+ * allocated in POOL. */
+static svn_fs_dirent_t *
+packed_dir_entry(const packed_dir_reader_t *reader,
+                 apr_pool_t *pool)
+{
+  svn_fs_dirent_t *entry = apr_palloc(pool, sizeof(*entry));
+
+  entry->name = apr_pstrmemdup(pool, reader->name->data, reader->name->len);
+  entry->kind = reader->kind;
+  entry->id = svn_fs_fs__id_rev_create(&reader->node_id, &reader->copy_id,
+                                       &reader->rev_item, pool);
+
+  return entry;
+}
+
+/* Utility function to reconstruct a dir entries struct from the packed
+ * format in BUFFER and DIR_DATA. Allocation will be made form POOL.
+ */
+static svn_fs_fs__dir_data_t *
+deserialize_packed_dir(void *buffer, dir_data_t *dir_data, apr_pool_t *pool)
+{
+  svn_fs_fs__dir_data_t *result;
+  packed_dir_reader_t reader = { 0 };
+  int i;
+
+  /* Construct empty directory object. */
+  result = apr_pcalloc(pool, sizeof(*result));
+  result->entries
+    = apr_array_make(pool, dir_data->count, sizeof(svn_fs_dirent_t *));
+  result->txn_filesize = dir_data->txn_filesize;
+
+  if (dir_data->count == 0)
+    return result;
+
+  svn_temp_deserializer__resolve(buffer, (void **)&dir_data->blocks);
+  svn_temp_deserializer__resolve(buffer, (void **)&dir_data->names);
+  svn_temp_deserializer__resolve(buffer, (void **)&dir_data->ids);
+
+  reader.name = svn_stringbuf_create_empty(pool);
+  seek_packed_block(&reader, dir_data, dir_data->blocks, dir_data->names,
+                    dir_data->ids, 0);
+
+  for (i = 0; i < dir_data->count; ++i)
+    {
+      read_packed_entry(&reader, i % PACKED_DIR_BLOCK_SIZE == 0);
+      APR_ARRAY_PUSH(result->entries, svn_fs_dirent_t *)
+        = packed_dir_entry(&reader, pool);
+    }
+
+  return result;
+}
+
+/* Return the entry called NAME in the packed directory DIR_DATA, which
+ * starts at DATA, allocated in POOL.  Return NULL if there is no such
+ * entry.
+ */
+static svn_fs_dirent_t *
+find_packed_entry(const void *data,
+                  const dir_data_t *dir_data,
+                  const char *name,
+                  apr_pool_t *pool)
+{
+  const apr_uint32_t *blocks;
+  const char *names;
+  const unsigned char *ids;
+  packed_dir_reader_t reader = { 0 };
+  int block_count = (dir_data->count + PACKED_DIR_BLOCK_SIZE - 1)
+                  / PACKED_DIR_BLOCK_SIZE;
+  int lower = 0;
+  int upper = block_count;
+  int i, end;
+
+  if (block_count == 0)
+    return NULL;
+
+  blocks = svn_temp_deserializer__ptr(data,
+                                      (const void *const *)&dir_data->blocks);
+  names = svn_temp_deserializer__ptr(data,
+                                     (const void *const *)&dir_data->names);
+  ids = svn_temp_deserializer__ptr(data,
+                                   (const void *const *)&dir_data->ids);
+
+  /* Binary search for the last block whose first name is <= NAME.
+   * Those names are stored in full. */
+  while (lower < upper)
+    {
+      int middle = (lower + upper) / 2;
+      if (strcmp(names + blocks[2 * middle], name) <= 0)
+        lower = middle + 1;
+      else
+        upper = middle;
+    }
+
+  if (lower == 0)
+    return NULL;
+
+  /* Scan that block. */
+  reader.name = svn_stringbuf_create_empty(pool);
+  seek_packed_block(&reader, dir_data, blocks, names, ids, lower - 1);
+
+  i = (lower - 1) * PACKED_DIR_BLOCK_SIZE;
+  end = MIN(i + PACKED_DIR_BLOCK_SIZE, dir_data->count);
+  for (; i < end; ++i)
+    {
+      int diff;
+
+      read_packed_entry(&reader, i % PACKED_DIR_BLOCK_SIZE == 0);
+      diff = strcmp(reader.name->data, name);
+      if (diff == 0)
+        return packed_dir_entry(&reader, pool);
+      if (diff > 0)
+        break;
+    }
+
+  return NULL;
+}
+
 void
 svn_fs_fs__noderev_serialize(svn_temp_serializer__context_t *context,
                              node_revision_t * const *noderev_p)
@@ -787,6 +1131,85 @@ svn_fs_fs__deserialize_node_revision(void **item,
   return SVN_NO_ERROR;
 }
 
+/* Return a copy of the representation *REP within the serialized BUFFER,
+ * allocated in POOL.  Return NULL, if there is no representation. */
+static representation_t *
+extract_representation(const void *buffer,
+                       representation_t * const *rep,
+                       apr_pool_t *pool)
+{
+  const representation_t *source
+    = svn_temp_deserializer__ptr(buffer, (const void * const *)rep);
+
+  return source ? apr_pmemdup(pool, source, sizeof(*source)) : NULL;
+}
+
+/* Fill *SCALARS from NODEREV and its representations PROP_REP and
+ * DATA_REP, which may be NULL. */
+static void
+get_scalars(svn_fs_fs__noderev_scalars_t *scalars,
+            const node_revision_t *noderev,
+            const representation_t *prop_rep,
+            const representation_t *data_rep)
+{
+  scalars->kind = noderev->kind;
+  scalars->predecessor_count = noderev->predecessor_count;
+  scalars->mergeinfo_count = noderev->mergeinfo_count;
+  scalars->has_mergeinfo = noderev->has_mergeinfo;
+
+  scalars->has_prop_rep = prop_rep != NULL;
+  scalars->prop_size = prop_rep ? prop_rep->expanded_size : 0;
+  scalars->prop_rep_in_txn = prop_rep
+                          && svn_fs_fs__id_txn_used(&prop_rep->txn_id);
+
+  scalars->data_size = data_rep ? data_rep->expanded_size : 0;
+}
+
+svn_error_t *
+svn_fs_fs__extract_noderev_scalars(void **out,
+                                   const void *data,
+                                   apr_size_t data_len,
+                                   void *baton,
+                                   apr_pool_t *pool)
+{
+  const node_revision_t *noderev = data;
+  const representation_t *prop_rep
+    = svn_temp_deserializer__ptr(noderev,
+                                 (const void * const *)&noderev->prop_rep);
+  const representation_t *data_rep
+    = svn_temp_deserializer__ptr(noderev,
+                                 (const void * const *)&noderev->data_rep);
+
+  get_scalars(baton, noderev, prop_rep, data_rep);
+
+  *out = baton;
+  return SVN_NO_ERROR;
+}
+
+void
+svn_fs_fs__noderev_get_scalars(svn_fs_fs__noderev_scalars_t *scalars,
+                               const node_revision_t *noderev)
+{
+  get_scalars(scalars, noderev, noderev->prop_rep, noderev->data_rep);
+}
+
+svn_error_t *
+svn_fs_fs__extract_rep_keys(void **out,
+                            const void *data,
+                            apr_size_t data_len,
+                            void *baton,
+                            apr_pool_t *pool)
+{
+  const node_revision_t *noderev = data;
+  svn_fs_fs__rep_keys_t *keys = apr_palloc(pool, sizeof(*keys));
+
+  keys->prop_rep = extract_representation(noderev, &noderev->prop_rep, pool);
+  keys->data_rep = extract_representation(noderev, &noderev->data_rep, pool);
+
+  *out = keys;
+  return SVN_NO_ERROR;
+}
+
 /* Utility function that returns the directory serialized inside CONTEXT
  * to DATA and DATA_LEN.  If OVERPROVISION is set, allocate some extra
  * room for future in-place changes by svn_fs_fs__replace_dir_entry. */
@@ -814,8 +1237,11 @@ svn_fs_fs__serialize_dir_entries(void **data,
   svn_fs_fs__dir_data_t *dir = in;
 
   /* serialize the dir content into a new serialization context
-   * and return the serialized data */
-  return return_serialized_dir_context(serialize_dir(dir, pool),
+   * and return the serialized data.  Committed directories will not
+   * be modified in the cache, so use the more compact format for them. */
+  return return_serialized_dir_context(is_packable_dir(dir)
+                                         ? serialize_packed_dir(dir, pool)
+                                         : serialize_dir(dir, pool),
                                        data,
                                        data_len,
                                        FALSE);
@@ -847,7 +1273,10 @@ svn_fs_fs__deserialize_dir_entries(void **out,
   dir_data_t *dir_data = (dir_data_t *)data;
 
   /* reconstruct the hash from the serialized data */
-  *out = deserialize_dir(dir_data, dir_data, pool);
+  if (dir_data->packed)
+    *out = deserialize_packed_dir(dir_data, dir_data, pool);
+  else
+    *out = deserialize_dir(dir_data, dir_data, pool);
 
   return SVN_NO_ERROR;
 }
@@ -938,6 +1367,18 @@ svn_fs_fs__extract_dir_entry(void **out,
   extract_dir_entry_baton_t *entry_baton = baton;
   svn_boolean_t found;
 
+  if (dir_data->packed)
+    {
+      entry_baton->out_of_date
+        = dir_data->txn_filesize != entry_baton->txn_filesize;
+
+      *out = entry_baton->out_of_date
+           ? NULL
+           : find_packed_entry(data, dir_data, entry_baton->name, pool);
+
+      return SVN_NO_ERROR;
+    }
+
   /* resolve the reference to the entries array */
   const svn_fs_dirent_t * const *entries =
     svn_temp_deserializer__ptr(data, (const void *const *)&dir_data->entries);
@@ -1022,7 +1463,11 @@ slowly_replace_dir_entry(void **data,
         SVN_ERR(svn_sort__array_delete2(entries, idx, 1));
     }
 
-  return svn_fs_fs__serialize_dir_entries(data, data_len, dir, pool);
+  /* Keep the in-place updatable format. */
+  return return_serialized_dir_context(serialize_dir(dir, pool),
+                                       data,
+                                       data_len,
+                                       FALSE);
 }
 
 svn_error_t *
@@ -1050,7 +1495,7 @@ svn_fs_fs__replace_dir_entry(void **data,
   /* after quite a number of operations, let's re-pack everything.
    * This is to limit the number of wasted space as we cannot overwrite
    * existing data but must always append. */
-  if (dir_data->operations > 2 + dir_data->count / 4)
+  if (dir_data->packed || dir_data->operations > 2 + dir_data->count / 4)
     return slowly_replace_dir_entry(data, data_len, baton, pool);
 
   /* resolve the reference to the entries array */
@@ -1282,6 +1727,62 @@ svn_fs_fs__deserialize_changes(void **out,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__extract_changes(void **out,
+                           const void *data,
+                           apr_size_t data_len,
+                           void *baton,
+                           apr_pool_t *pool)
+{
+  svn_fs_fs__extract_changes_baton_t *b = baton;
+  const svn_fs_fs__changes_list_t *changes = data;
+  svn_fs_fs__changes_list_t *result;
+  const change_t * const *entries;
+  int i;
+
+  entries = svn_temp_deserializer__ptr(changes,
+                                       (const void * const *)&changes->changes);
+
+  result = apr_pmemdup(pool, changes, sizeof(*changes));
+  result->changes = apr_palloc(pool, changes->count * sizeof(change_t *));
+  result->count = 0;
+
+  for (i = 0; i < changes->count; ++i)
+    {
+      const change_t *change;
+      const char *path;
+      const char *copyfrom_path;
+      change_t *copy;
+
+      change = svn_temp_deserializer__ptr(entries,
+                                          (const void * const *)&entries[i]);
+      path = svn_temp_deserializer__ptr(change,
+                                        (const void * const *)
+                                          &change->path.data);
+      if (!svn_fs__path_change_matches(b->path, b->include_parents, path))
+        continue;
+
+      copyfrom_path = svn_temp_deserializer__ptr(change,
+                                                 (const void * const *)
+                                                   &change->info.copyfrom_path);
+
+      copy = apr_pmemdup(pool, change, sizeof(*change));
+      copy->path.data = apr_pstrmemdup(pool, path, change->path.len);
+      copy->info.copyfrom_path = copyfrom_path
+                               ? apr_pstrdup(pool, copyfrom_path)
+                               : NULL;
+      copy->info.node_rev_id
+        = svn_fs_fs__id_extract(change, &change->info.node_rev_id, pool);
+
+      result->changes[result->count++] = copy;
+    }
+
+  b->total_count = changes->count;
+  *out = result;
+
+  return SVN_NO_ERROR;
+}
+
 /* Auxiliary structure representing the content of a svn_mergeinfo_t hash.
    This structure is much easier to (de-)serialize than an APR array.
  */
@@ -214,6 +214,51 @@ svn_fs_fs__deserialize_node_revision(void **item,
                                      apr_size_t buffer_size,
                                      apr_pool_t *pool);
 
+/**
+ * The representations of a node revision that decide whether its
+ * properties and contents differ from those of another one.
+ */
+typedef struct svn_fs_fs__rep_keys_t
+{
+  /** Property representation.  May be NULL. */
+  representation_t *prop_rep;
+
+  /** Contents representation.  May be NULL. */
+  representation_t *data_rep;
+} svn_fs_fs__rep_keys_t;
+
+/**
+ * Implements #svn_cache__partial_getter_func_t for #node_revision_t.
+ * Fill the #svn_fs_fs__noderev_scalars_t given as @a baton, reading the
+ * serialized data in place, and return it in @a *out.  This does not
+ * allocate any memory.
+ */
+svn_error_t *
+svn_fs_fs__extract_noderev_scalars(void **out,
+                                   const void *data,
+                                   apr_size_t data_len,
+                                   void *baton,
+                                   apr_pool_t *pool);
+
+/**
+ * Fill @a *scalars from the deserialized @a noderev.
+ */
+void
+svn_fs_fs__noderev_get_scalars(svn_fs_fs__noderev_scalars_t *scalars,
+                               const node_revision_t *noderev);
+
+/**
+ * Implements #svn_cache__partial_getter_func_t for #node_revision_t,
+ * returning a #svn_fs_fs__rep_keys_t without copying the remainder of
+ * the node revision.
+ */
+svn_error_t *
+svn_fs_fs__extract_rep_keys(void **out,
+                            const void *data,
+                            apr_size_t data_len,
+                            void *baton,
+                            apr_pool_t *pool);
+
 /**
  * Implements #svn_cache__serialize_func_t for a #svn_fs_fs__dir_data_t
  */
@@ -406,6 +451,36 @@ svn_fs_fs__deserialize_changes(void **out,
                                apr_size_t data_len,
                                apr_pool_t *pool);
 
+/**
+ * Baton type to be used with svn_fs_fs__extract_changes.
+ */
+typedef struct svn_fs_fs__extract_changes_baton_t
+{
+  /** Only return changes relevant to this path as defined by
+   * svn_fs__path_change_matches(). */
+  const char *path;
+
+  /** Include changes to the parents of PATH? */
+  svn_boolean_t include_parents;
+
+  /** Will be set by the callback to the number of changes in the cached
+   * block, including those that did not pass the filter. */
+  int total_count;
+} svn_fs_fs__extract_changes_baton_t;
+
+/**
+ * Implements #svn_cache__partial_getter_func_t for a
+ * #svn_fs_fs__changes_list_t.  Return only those changes that pass the
+ * filter given in (svn_fs_fs__extract_changes_baton_t *) @a *baton.
+ * Changes that don't are never copied.
+ */
+svn_error_t *
+svn_fs_fs__extract_changes(void **out,
+                           const void *data,
+                           apr_size_t data_len,
+                           void *baton,
+                           apr_pool_t *pool);
+
 /**
  * Implements #svn_cache__serialize_func_t for #svn_mergeinfo_t objects.
  */
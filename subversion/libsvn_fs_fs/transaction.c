@@ -41,8 +41,10 @@
 #include "temp_serializer.h"
 #include "cached_data.h"
 #include "lock.h"
+#include "mergeinfo-index.h"
 #include "rep-cache.h"
 
+#include "private/svn_batch_fsync.h"
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
 #include "private/svn_sorts_private.h"
@@ -1003,12 +1005,14 @@ create_new_txn_noderev_from_rev(svn_fs_t *fs,
 struct get_and_increment_txn_key_baton {
   svn_fs_t *fs;
   apr_uint64_t txn_number;
+  apr_uint64_t count;
   apr_pool_t *pool;
 };
 
 /* Callback used in the implementation of create_txn_dir().  This gets
-   the current base 36 value in PATH_TXN_CURRENT and increments it.
-   It returns the original value by the baton. */
+   the current base 36 value in PATH_TXN_CURRENT and increments it by
+   the COUNT given in the baton.  It returns the original value by the
+   baton. */
 static svn_error_t *
 get_and_increment_txn_key_body(void *baton, apr_pool_t *pool)
 {
@@ -1026,7 +1030,7 @@ get_and_increment_txn_key_body(void *baton, apr_pool_t *pool)
   cb->txn_number = svn__base36toui64(NULL, buf->data);
 
   /* remove trailing newlines */
-  line_length = svn__ui64tobase36(new_id_str, cb->txn_number+1);
+  line_length = svn__ui64tobase36(new_id_str, cb->txn_number + cb->count);
   new_id_str[line_length] = '\n';
 
   /* Increment the key and add a trailing \n to the string so the
@@ -1039,6 +1043,44 @@ get_and_increment_txn_key_body(void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Set *TXN_NUMBER to an unused transaction number in FS.  Take it from
+   the range reserved by this process, if there is one.  Otherwise,
+   reserve a new range in the txn-current file.  Other processes will not
+   use any of the reserved numbers.
+   Use POOL for temporary allocations.
+
+   Note that the caller must hold FS->FFD->SHARED->TXN_ID_LOCK. */
+static svn_error_t *
+allocate_txn_number(apr_uint64_t *txn_number,
+                    svn_fs_t *fs,
+                    apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  fs_fs_shared_data_t *ffsd = ffd->shared;
+
+  if (ffsd->next_txn_number == ffsd->end_txn_number)
+    {
+      /* Get the current transaction sequence value, which is a base-36
+         number, from the txn-current file, and write an incremented
+         value back out to the file. */
+      struct get_and_increment_txn_key_baton cb;
+      cb.pool = pool;
+      cb.fs = fs;
+      cb.count = (apr_uint64_t)ffd->txn_id_block_size;
+      SVN_ERR(svn_fs_fs__with_txn_current_lock(fs,
+                                               get_and_increment_txn_key_body,
+                                               &cb,
+                                               pool));
+
+      ffsd->next_txn_number = cb.txn_number;
+      ffsd->end_txn_number = cb.txn_number + cb.count;
+    }
+
+  *txn_number = ffsd->next_txn_number++;
+
+  return SVN_NO_ERROR;
+}
+
 /* Create a unique directory for a transaction in FS based on revision REV.
    Return the ID for this transaction in *ID_P and *TXN_ID.  Use a sequence
    value in the transaction ID to prevent reuse of transaction IDs. */
@@ -1049,21 +1091,14 @@ create_txn_dir(const char **id_p,
                svn_revnum_t rev,
                apr_pool_t *pool)
 {
-  struct get_and_increment_txn_key_baton cb;
+  fs_fs_data_t *ffd = fs->fsap_data;
   const char *txn_dir;
 
-  /* Get the current transaction sequence value, which is a base-36
-     number, from the txn-current file, and write an
-     incremented value back out to the file.  Place the revision
-     number the transaction is based off into the transaction id. */
-  cb.pool = pool;
-  cb.fs = fs;
-  SVN_ERR(svn_fs_fs__with_txn_current_lock(fs,
-                                           get_and_increment_txn_key_body,
-                                           &cb,
-                                           pool));
+  /* Place the revision number the transaction is based off into the
+     transaction id. */
   txn_id->revision = rev;
-  txn_id->number = cb.txn_number;
+  SVN_MUTEX__WITH_LOCK(ffd->shared->txn_id_lock,
+                       allocate_txn_number(&txn_id->number, fs, pool));
 
   *id_p = svn_fs_fs__id_txn_unparse(txn_id, pool);
   txn_dir = svn_fs_fs__path_txn_dir(fs, txn_id, pool);
@@ -1546,6 +1581,7 @@ svn_fs_fs__set_entry(svn_fs_t *fs,
   apr_file_t *file;
   svn_stream_t *out;
   svn_filesize_t filesize;
+  svn_filesize_t old_filesize = SVN_INVALID_FILESIZE;
   fs_fs_data_t *ffd = fs->fsap_data;
   apr_pool_t *subpool = svn_pool_create(pool);
 
@@ -1572,6 +1608,13 @@ svn_fs_fs__set_entry(svn_fs_t *fs,
       SVN_ERR(svn_fs_fs__put_node_revision(fs, parent_noderev->id,
                                            parent_noderev, FALSE, pool));
 
+      /* Flush APR buffers. */
+      SVN_ERR(svn_io_file_flush(file, subpool));
+
+      /* Obtain final file size to update txn_dir_cache. */
+      SVN_ERR(svn_io_file_size_get(&filesize, file, subpool));
+      old_filesize = filesize;
+
       /* Immediately populate the txn dir cache to avoid re-reading
        * the file we just wrote. */
       if (ffd->txn_dir_cache)
@@ -1580,12 +1623,6 @@ svn_fs_fs__set_entry(svn_fs_t *fs,
             = svn_fs_fs__id_unparse(parent_noderev->id, subpool)->data;
           svn_fs_fs__dir_data_t dir_data;
 
-          /* Flush APR buffers. */
-          SVN_ERR(svn_io_file_flush(file, subpool));
-
-          /* Obtain final file size to update txn_dir_cache. */
-          SVN_ERR(svn_io_file_size_get(&filesize, file, subpool));
-
           /* Store in the cache. */
           dir_data.entries = entries;
           dir_data.txn_filesize = filesize;
@@ -1593,6 +1630,9 @@ svn_fs_fs__set_entry(svn_fs_t *fs,
                                  subpool));
         }
 
+      /* Directories too large for that cache get indexed instead. */
+      svn_fs_fs__large_dir_set(fs, parent_noderev, entries, filesize);
+
       svn_pool_clear(subpool);
     }
   else
@@ -1602,6 +1642,10 @@ svn_fs_fs__set_entry(svn_fs_t *fs,
                                APR_OS_DEFAULT, subpool));
       out = svn_stream_from_aprfile2(file, TRUE, subpool);
 
+      /* The large directory index may refer to the current file size. */
+      if (ffd->large_dir)
+        SVN_ERR(svn_io_file_size_get(&old_filesize, file, subpool));
+
       /* If the cache contents is stale, drop it.
        *
        * Note that the directory file is append-only, i.e. if the size
@@ -1685,6 +1729,10 @@ svn_fs_fs__set_entry(svn_fs_t *fs,
                                      subpool));
     }
 
+  /* Keep the index of a large directory current. */
+  svn_fs_fs__large_dir_set_entry(fs, parent_noderev, name, id, kind,
+                                 old_filesize, filesize, subpool);
+
   svn_pool_destroy(subpool);
   return SVN_NO_ERROR;
 }
@@ -2169,7 +2217,12 @@ txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
   fs_fs_data_t *ffd = fs->fsap_data;
   int svndiff_version;
 
-  if (ffd->delta_compression_type == compression_type_lz4)
+  if (ffd->delta_compression_type == compression_type_zstd)
+    {
+      SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF3_FORMAT);
+      svndiff_version = 3;
+    }
+  else if (ffd->delta_compression_type == compression_type_lz4)
     {
       SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF2_FORMAT);
       svndiff_version = 2;
@@ -3491,33 +3544,82 @@ verify_before_commit(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
-/* Update the 'current' file to hold the correct next node and copy_ids
-   from transaction TXN_ID in filesystem FS.  The current revision is
-   set to REV.  Perform temporary allocations in POOL. */
+/* Write the new contents of the 'current' file, holding the correct next
+   node and copy_ids from transaction TXN_ID in filesystem FS, into FS'
+   'next' file.  The current revision is set to REV.  Schedule the necessary
+   fsyncs in BATCH.  Perform temporary allocations in POOL.
+
+   The caller is expected to move 'next' into place after BATCH has been
+   run, see bump_current(). */
 static svn_error_t *
-write_final_current(svn_fs_t *fs,
-                    const svn_fs_fs__id_part_t *txn_id,
-                    svn_revnum_t rev,
-                    apr_uint64_t start_node_id,
-                    apr_uint64_t start_copy_id,
-                    apr_pool_t *pool)
+write_next_file(svn_fs_t *fs,
+                const svn_fs_fs__id_part_t *txn_id,
+                svn_revnum_t rev,
+                apr_uint64_t start_node_id,
+                apr_uint64_t start_copy_id,
+                svn_batch_fsync__t *batch,
+                apr_pool_t *pool)
 {
-  apr_uint64_t txn_node_id;
-  apr_uint64_t txn_copy_id;
+  apr_file_t *file;
+  const char *path = svn_fs_fs__path_next(fs, pool);
+  const char *perms_path = svn_fs_fs__path_current(fs, pool);
+  const char *buf;
   fs_fs_data_t *ffd = fs->fsap_data;
 
   if (ffd->format >= SVN_FS_FS__MIN_NO_GLOBAL_IDS_FORMAT)
-    return svn_fs_fs__write_current(fs, rev, 0, 0, pool);
+    {
+      start_node_id = 0;
+      start_copy_id = 0;
+    }
+  else
+    {
+      apr_uint64_t txn_node_id;
+      apr_uint64_t txn_copy_id;
+
+      /* To find the next available ids, we add the id that used to be in
+         the 'current' file, to the next ids from the transaction file. */
+      SVN_ERR(read_next_ids(&txn_node_id, &txn_copy_id, fs, txn_id, pool));
+
+      start_node_id += txn_node_id;
+      start_copy_id += txn_copy_id;
+    }
+
+  buf = svn_fs_fs__unparse_current(fs, rev, start_node_id, start_copy_id,
+                                   pool);
 
-  /* To find the next available ids, we add the id that used to be in
-     the 'current' file, to the next ids from the transaction file. */
-  SVN_ERR(read_next_ids(&txn_node_id, &txn_copy_id, fs, txn_id, pool));
+  /* Create / open the 'next' file.  A failed commit may have left an older
+     and potentially longer version of it behind. */
+  SVN_ERR(svn_batch_fsync__open_file(&file, batch, path, pool));
+  SVN_ERR(svn_io_file_trunc(file, 0, pool));
+  SVN_ERR(svn_io_file_write_full(file, buf, strlen(buf), NULL, pool));
 
-  start_node_id += txn_node_id;
-  start_copy_id += txn_copy_id;
+  /* Adjust permissions. */
+  SVN_ERR(svn_io_copy_perms(perms_path, path, pool));
 
-  return svn_fs_fs__write_current(fs, rev, start_node_id, start_copy_id,
-                                  pool);
+  return SVN_NO_ERROR;
+}
+
+/* Make the contents of FS' 'next' file the new 'current' and schedule the
+   necessary fsyncs in BATCH.  Run BATCH before returning, i.e. upon success
+   the new revision will be permanently visible.  Use POOL for temporary
+   allocations. */
+static svn_error_t *
+bump_current(svn_fs_t *fs,
+             svn_batch_fsync__t *batch,
+             apr_pool_t *pool)
+{
+  const char *current_filename = svn_fs_fs__path_current(fs, pool);
+
+  /* Make the revision visible to all processes and threads. */
+  SVN_ERR(svn_fs_fs__move_into_place(svn_fs_fs__path_next(fs, pool),
+                                     current_filename, current_filename,
+                                     FALSE, pool));
+  SVN_ERR(svn_batch_fsync__new_path(batch, current_filename, pool));
+
+  /* Make the new revision permanently visible. */
+  SVN_ERR(svn_batch_fsync__run(batch, pool));
+
+  return SVN_NO_ERROR;
 }
 
 /* Verify that the user registered with FS has all the locks necessary to
@@ -3593,13 +3695,14 @@ verify_locks(svn_fs_t *fs,
 }
 
 /* Writes final revision properties to file PATH applying permissions
-   from file PERMS_REFERENCE. This involves setting svn:date and
-   removing any temporary properties associated with the commit flags. */
+   from file PERMS_REFERENCE and schedule the necessary fsyncs in BATCH.
+   This involves setting svn:date and removing any temporary properties
+   associated with the commit flags. */
 static svn_error_t *
 write_final_revprop(const char *path,
                     const char *perms_reference,
                     svn_fs_txn_t *txn,
-                    svn_boolean_t flush_to_disk,
+                    svn_batch_fsync__t *batch,
                     apr_pool_t *pool)
 {
   apr_hash_t *txnprops;
@@ -3629,20 +3732,16 @@ write_final_revprop(const char *path,
       svn_hash_sets(txnprops, SVN_PROP_REVISION_DATE, &date);
     }
 
-  /* Create new revprops file. Tell OS to truncate existing file,
-     since  file may already exists from failed transaction. */
-  SVN_ERR(svn_io_file_open(&revprop_file, path,
-                           APR_WRITE | APR_CREATE | APR_TRUNCATE
-                           | APR_BUFFERED, APR_OS_DEFAULT, pool));
+  /* Create new revprops file. Truncate any existing file, since file may
+     already exists from failed transaction.  Note that BATCH owns the
+     file handle, so we must not close it. */
+  SVN_ERR(svn_batch_fsync__open_file(&revprop_file, batch, path, pool));
+  SVN_ERR(svn_io_file_trunc(revprop_file, 0, pool));
 
   stream = svn_stream_from_aprfile2(revprop_file, TRUE, pool);
   SVN_ERR(svn_hash_write2(txnprops, stream, SVN_HASH_TERMINATOR, pool));
   SVN_ERR(svn_stream_close(stream));
 
-  if (flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(revprop_file, pool));
-  SVN_ERR(svn_io_file_close(revprop_file, pool));
-
   SVN_ERR(svn_io_copy_perms(perms_reference, path, pool));
 
   return SVN_NO_ERROR;
@@ -3732,6 +3831,9 @@ struct commit_baton {
   apr_array_header_t *reps_to_cache;
   apr_hash_t *reps_hash;
   apr_pool_t *reps_pool;
+
+  /* The txn's changed paths, fetched before taking the write lock. */
+  apr_hash_t *changed_paths;
 };
 
 /* The work-horse for svn_fs_fs__commit, called with the FS write lock.
@@ -3752,7 +3854,9 @@ commit_body(void *baton, apr_pool_t *pool)
   void *proto_file_lockcookie;
   apr_off_t initial_offset, changed_path_offset;
   const svn_fs_fs__id_part_t *txn_id = svn_fs_fs__txn_get_id(cb->txn);
-  apr_hash_t *changed_paths;
+  apr_hash_t *changed_paths = cb->changed_paths;
+  svn_batch_fsync__t *batch;
+  apr_file_t *final_rev_file;
   apr_array_header_t *directory_ids = apr_array_make(pool, 4,
                                                      sizeof(pair_cache_key_t));
 
@@ -3780,16 +3884,12 @@ commit_body(void *baton, apr_pool_t *pool)
   ffd->youngest_rev_cache = old_rev;
 
   /* Check to make sure this transaction is based off the most recent
-     revision. */
+     revision.  svn_fs_fs__commit checked that already but another commit
+     may have completed while we were waiting for the lock. */
   if (cb->txn->base_rev != old_rev)
     return svn_error_create(SVN_ERR_FS_TXN_OUT_OF_DATE, NULL,
                             _("Transaction out of date"));
 
-  /* We need the changes list for verification as well as for writing it
-     to the final rev file. */
-  SVN_ERR(svn_fs_fs__txn_changes_fetch(&changed_paths, cb->fs, txn_id,
-                                       pool));
-
   /* Locks may have been added (or stolen) between the calling of
      previous svn_fs.h functions and svn_fs_commit_txn(), so we need
      to re-examine every changed-path in the txn and re-verify all
@@ -3837,14 +3937,20 @@ commit_body(void *baton, apr_pool_t *pool)
                                      NULL, pool));
     }
 
-  if (ffd->flush_to_disk)
-    SVN_ERR(svn_io_file_flush_to_disk(proto_file, pool));
+  /* The fsync for the revision contents will be scheduled in BATCH once
+     the file has been moved into place. */
   SVN_ERR(svn_io_file_close(proto_file, pool));
 
   /* We don't unlock the prototype revision file immediately to avoid a
      race with another caller writing to the prototype revision file
      before we commit it. */
 
+  /* Use this to force all data to be flushed to physical storage
+     (to the degree our environment will allow).  Any fsyncs that have
+     no dependency on each other get collected here and will be run
+     in parallel. */
+  SVN_ERR(svn_batch_fsync__create(&batch, ffd->flush_to_disk, pool));
+
   /* Create the shard for the rev and revprop file, if we're sharding and
      this is the first revision of a new shard.  We don't care if this
      fails because the shard already existed for some reason. */
@@ -3863,6 +3969,7 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVS_DIR,
                                                     pool),
                                     new_dir, pool));
+          SVN_ERR(svn_batch_fsync__new_path(batch, new_dir, pool));
         }
 
       /* Create the revprops shard. */
@@ -3879,6 +3986,7 @@ commit_body(void *baton, apr_pool_t *pool)
                                                     PATH_REVPROPS_DIR,
                                                     pool),
                                     new_dir, pool));
+          SVN_ERR(svn_batch_fsync__new_path(batch, new_dir, pool));
         }
     }
 
@@ -3890,9 +3998,7 @@ commit_body(void *baton, apr_pool_t *pool)
   old_rev_filename = svn_fs_fs__path_rev_absolute(cb->fs, old_rev, pool);
   rev_filename = svn_fs_fs__path_rev(cb->fs, new_rev, pool);
   proto_filename = svn_fs_fs__path_txn_proto_rev(cb->fs, txn_id, pool);
-  SVN_ERR(svn_fs_fs__move_into_place(proto_filename, rev_filename,
-                                     old_rev_filename, ffd->flush_to_disk,
-                                     pool));
+  SVN_ERR(svn_io_file_rename2(proto_filename, rev_filename, FALSE, pool));
 
   /* Now that we've moved the prototype revision file out of the way,
      we can unlock it (since further attempts to write to the file
@@ -3900,11 +4006,26 @@ commit_body(void *baton, apr_pool_t *pool)
      remove the transaction directory later. */
   SVN_ERR(unlock_proto_rev(cb->fs, txn_id, proto_file_lockcookie, pool));
 
+  /* Schedule the fsyncs for the new file name and its contents.  This
+     must happen before we apply the final, typically read-only,
+     permissions because BATCH needs a writable handle. */
+  SVN_ERR(svn_batch_fsync__new_path(batch, rev_filename, pool));
+  SVN_ERR(svn_batch_fsync__open_file(&final_rev_file, batch, rev_filename,
+                                     pool));
+  SVN_ERR(svn_io_copy_perms(old_rev_filename, rev_filename, pool));
+
   /* Write final revprops file. */
   SVN_ERR_ASSERT(! svn_fs_fs__is_packed_revprop(cb->fs, new_rev));
   revprop_filename = svn_fs_fs__path_revprops(cb->fs, new_rev, pool);
   SVN_ERR(write_final_revprop(revprop_filename, old_rev_filename,
-                              cb->txn, ffd->flush_to_disk, pool));
+                              cb->txn, batch, pool));
+
+  /* Prepare the new contents of 'current'. */
+  SVN_ERR(write_next_file(cb->fs, txn_id, new_rev, start_node_id,
+                          start_copy_id, batch, pool));
+
+  /* Commit all changes to disk. */
+  SVN_ERR(svn_batch_fsync__run(batch, pool));
 
   /* Run paranoia checks. */
   if (ffd->verify_before_commit)
@@ -3912,9 +4033,13 @@ commit_body(void *baton, apr_pool_t *pool)
       SVN_ERR(verify_before_commit(cb->fs, new_rev, pool));
     }
 
+  /* There may be leftovers in the mergeinfo index from a revision of this
+     number that got lost in a restore from backup.  Drop them before
+     anybody can ask about the new revision. */
+  SVN_ERR(svn_fs_fs__prune_mergeinfo_index(cb->fs, old_rev, pool));
+
   /* Update the 'current' file. */
-  SVN_ERR(write_final_current(cb->fs, txn_id, new_rev, start_node_id,
-                              start_copy_id, pool));
+  SVN_ERR(bump_current(cb->fs, batch, pool));
 
   /* At this point the new revision is committed and globally visible
      so let the caller know it succeeded by giving it the new revision
@@ -3963,10 +4088,25 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
   struct commit_baton cb;
   fs_fs_data_t *ffd = fs->fsap_data;
 
+  svn_revnum_t youngest;
+
   cb.new_rev_p = new_rev_p;
   cb.fs = fs;
   cb.txn = txn;
 
+  /* Do as much as possible before queuing up for the write lock.
+     If the txn is already out of date, there is no point in waiting for
+     the lock only to find out then.  The caller will merge and retry. */
+  SVN_ERR(svn_fs_fs__youngest_rev(&youngest, fs, pool));
+  if (txn->base_rev != youngest)
+    return svn_error_create(SVN_ERR_FS_TXN_OUT_OF_DATE, NULL,
+                            _("Transaction out of date"));
+
+  /* We need the changes list for verification as well as for writing it
+     to the final rev file.  It only depends on the txn itself. */
+  SVN_ERR(svn_fs_fs__txn_changes_fetch(&cb.changed_paths, fs,
+                                       svn_fs_fs__txn_get_id(txn), pool));
+
   if (ffd->rep_sharing_allowed)
     {
       cb.reps_to_cache = apr_array_make(pool, 5, sizeof(representation_t *));
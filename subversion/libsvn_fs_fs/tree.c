@@ -50,15 +50,18 @@
 #include "svn_fs.h"
 #include "svn_props.h"
 #include "svn_sorts.h"
+#include "svn_cache_config.h"
 
 #include "fs.h"
 #include "cached_data.h"
 #include "dag.h"
 #include "lock.h"
+#include "mergeinfo-index.h"
 #include "tree.h"
 #include "fs_fs.h"
 #include "id.h"
 #include "pack.h"
+#include "prefetch.h"
 #include "temp_serializer.h"
 #include "transaction.h"
 #include "util.h"
@@ -94,8 +97,19 @@ typedef struct fs_txn_root_data_t
   /* Cache of txn DAG nodes (without their nested noderevs, because
    * it's mutable). Same keys/values as ffd->rev_node_cache. */
   svn_cache__t *txn_node_cache;
+
+  /* Paths mapped to their mutable DAG nodes (dag_node_t *, again without
+   * noderevs).  Edits typically go through the same, already cloned
+   * parent directories again and again.  Keeping those here instead of
+   * in TXN_NODE_CACHE saves (de-)serializing every path component on
+   * every edit.  At most MAX_MUTABLE_NODES entries. */
+  apr_hash_t *mutable_nodes;
 } fs_txn_root_data_t;
 
+/* Upper limit to the number of entries in fs_txn_root_data_t.mutable_nodes.
+ * Beyond that, mutable nodes go into the txn_node_cache like any other. */
+#define MAX_MUTABLE_NODES 100000
+
 /* Declared here to resolve the circular dependencies. */
 static svn_error_t * get_dag(dag_node_t **dag_node_p,
                              svn_fs_root_t *root,
@@ -463,16 +477,25 @@ dag_node_cache_get(dag_node_t **node_p,
     }
   else
     {
-      /* DAG is mutable / may become invalid. Use the TXN-local cache */
-
-      locate_cache(&cache, &key, root, path, pool);
+      /* DAG is mutable / may become invalid. Use the TXN-local caches */
+      fs_txn_root_data_t *frd = root->fsap_data;
 
-      SVN_ERR(svn_cache__get((void **) &node, &found, cache, key, pool));
-      if (found && node)
+      node = svn_hash_gets(frd->mutable_nodes, path);
+      if (node)
         {
-          /* Patch up the FS, since this might have come from an old FS
-           * object. */
-          svn_fs_fs__dag_set_fs(node, root->fs);
+          node = svn_fs_fs__dag_dup(node, pool);
+        }
+      else
+        {
+          locate_cache(&cache, &key, root, path, pool);
+
+          SVN_ERR(svn_cache__get((void **) &node, &found, cache, key, pool));
+          if (found && node)
+            {
+              /* Patch up the FS, since this might have come from an old FS
+               * object. */
+              svn_fs_fs__dag_set_fs(node, root->fs);
+            }
         }
     }
 
@@ -494,6 +517,27 @@ dag_node_cache_set(svn_fs_root_t *root,
 
   SVN_ERR_ASSERT(*path == '/');
 
+  if (root->is_txn_root)
+    {
+      fs_txn_root_data_t *frd = root->fsap_data;
+
+      if (svn_fs_fs__dag_check_mutable(node)
+          && (   apr_hash_count(frd->mutable_nodes) < MAX_MUTABLE_NODES
+              || svn_hash_gets(frd->mutable_nodes, path)))
+        {
+          /* Mutable nodes never change their ID, so there is no need
+           * to update TXN_NODE_CACHE as well. dag_node_cache_get() will
+           * find them here first. */
+          apr_pool_t *hash_pool = apr_hash_pool_get(frd->mutable_nodes);
+          svn_hash_sets(frd->mutable_nodes, apr_pstrdup(hash_pool, path),
+                        svn_fs_fs__dag_dup(node, hash_pool));
+          return SVN_NO_ERROR;
+        }
+
+      /* The path has a different node now. */
+      svn_hash_sets(frd->mutable_nodes, path, NULL);
+    }
+
   locate_cache(&cache, &key, root, path, pool);
   return svn_cache__set(cache, key, node, pool);
 }
@@ -535,6 +579,8 @@ dag_node_cache_invalidate(svn_fs_root_t *root,
   struct fdic_baton b;
   svn_cache__t *cache;
   apr_pool_t *iterpool;
+  apr_hash_index_t *hi;
+  fs_txn_root_data_t *frd;
   int i;
 
   b.path = path;
@@ -544,6 +590,17 @@ dag_node_cache_invalidate(svn_fs_root_t *root,
   SVN_ERR_ASSERT(root->is_txn_root);
   locate_cache(&cache, NULL, root, NULL, b.pool);
 
+  /* Removing the current entry while iterating over an APR hash is safe. */
+  frd = root->fsap_data;
+  for (hi = apr_hash_first(b.pool, frd->mutable_nodes);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *item_path = apr_hash_this_key(hi);
+      if (svn_fspath__skip_ancestor(path, item_path))
+        svn_hash_sets(frd->mutable_nodes, item_path, NULL);
+    }
+
 
   SVN_ERR(svn_cache__iter(NULL, cache, find_descendants_in_cache,
                           &b, b.pool));
@@ -2359,7 +2416,7 @@ svn_fs_fs__commit_txn(const char **conflict_p,
 
   if (ffd->pack_after_commit)
     {
-      SVN_ERR(svn_fs_fs__pack(fs, 0, NULL, NULL, NULL, NULL, pool));
+      SVN_ERR(svn_fs_fs__pack(fs, 0, NULL, NULL, NULL, NULL, NULL, pool));
     }
 
   return SVN_NO_ERROR;
@@ -2489,6 +2546,83 @@ fs_dir_optimal_order(apr_array_header_t **ordered_p,
   return SVN_NO_ERROR;
 }
 
+/* Implement root_vtable_t.dir_entries_info.  Read the child noderevs
+   in storage order so that block-read can serve most of them from the
+   same few blocks. */
+static svn_error_t *
+fs_dir_entries_info(apr_array_header_t **entries_p,
+                    svn_fs_root_t *root,
+                    const char *path,
+                    svn_boolean_t include_props,
+                    svn_boolean_t include_checksums,
+                    svn_checksum_kind_t checksum_kind,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  dag_node_t *node;
+  apr_hash_t *hash = svn_hash__make(scratch_pool);
+  apr_array_header_t *table;
+  apr_array_header_t *ordered;
+  apr_pool_t *iterpool;
+  int i;
+
+  SVN_ERR(get_dag(&node, root, path, scratch_pool));
+  SVN_ERR(svn_fs_fs__dag_dir_entries(&table, node, scratch_pool));
+  for (i = 0; i < table->nelts; ++i)
+    {
+      svn_fs_dirent_t *entry = APR_ARRAY_IDX(table, i, svn_fs_dirent_t *);
+      svn_hash_sets(hash, entry->name, entry);
+    }
+
+  ordered = svn_fs_fs__order_dir_entries(root->fs, hash, scratch_pool,
+                                         scratch_pool);
+
+  *entries_p = apr_array_make(result_pool, ordered->nelts,
+                              sizeof(svn_fs_dirent_info_t *));
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < ordered->nelts; ++i)
+    {
+      svn_fs_dirent_t *entry = APR_ARRAY_IDX(ordered, i, svn_fs_dirent_t *);
+      svn_fs_dirent_info_t *info = apr_pcalloc(result_pool, sizeof(*info));
+      dag_node_t *child;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__dag_get_node(&child, root->fs, entry->id,
+                                      iterpool));
+
+      info->name = apr_pstrdup(result_pool, entry->name);
+      info->kind = entry->kind;
+      SVN_ERR(svn_fs_fs__dag_get_revision(&info->created_rev, child,
+                                          iterpool));
+      SVN_ERR(svn_fs_fs__dag_has_props(&info->has_props, child, iterpool));
+      if (include_props)
+        {
+          SVN_ERR(svn_fs_fs__dag_get_proplist(&info->props, child,
+                                              result_pool));
+          if (!info->props)
+            info->props = apr_hash_make(result_pool);
+        }
+
+      if (entry->kind == svn_node_file)
+        {
+          SVN_ERR(svn_fs_fs__dag_file_length(&info->size, child, iterpool));
+          if (include_checksums)
+            SVN_ERR(svn_fs_fs__dag_file_checksum(&info->checksum, child,
+                                                 checksum_kind,
+                                                 result_pool));
+        }
+      else
+        {
+          info->size = SVN_INVALID_FILESIZE;
+        }
+
+      APR_ARRAY_PUSH(*entries_p, svn_fs_dirent_info_t *) = info;
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Raise an error if PATH contains a newline because FSFS cannot handle
  * such paths. See issue #4340. */
 static svn_error_t *
@@ -2963,6 +3097,27 @@ fs_try_process_file_contents(svn_boolean_t *success,
 /* --- End machinery for svn_fs_try_process_file_contents() ---  */
 
 
+/* --- Machinery for svn_fs_file_contents_range() ---  */
+
+static svn_error_t *
+fs_file_contents_range(apr_file_t **file,
+                       apr_off_t *offset,
+                       svn_filesize_t *length,
+                       svn_fs_root_t *root,
+                       const char *path,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  dag_node_t *node;
+  SVN_ERR(get_dag(&node, root, path, scratch_pool));
+
+  return svn_fs_fs__dag_file_contents_range(file, offset, length, node,
+                                            result_pool, scratch_pool);
+}
+
+/* --- End machinery for svn_fs_file_contents_range() ---  */
+
+
 /* --- Machinery for svn_fs_apply_textdelta() ---  */
 
 
@@ -3351,6 +3506,13 @@ typedef struct fs_txn_changes_iterator_data_t
   /* Current iterator position. */
   apr_hash_index_t *hi;
 
+  /* If not NULL, skip changes not relevant to this path as defined by
+     svn_fs__path_change_matches(). */
+  const char *filter_path;
+
+  /* Also report changes to the parents of FILTER_PATH? */
+  svn_boolean_t filter_parents;
+
   /* For efficiency such that we don't need to dynamically allocate
      yet another copy of that data. */
   svn_fs_path_change3_t change;
@@ -3363,6 +3525,13 @@ fs_txn_changes_iterator_get(svn_fs_path_change3_t **change,
 {
   fs_txn_changes_iterator_data_t *data = iterator->fsap_data;
 
+  while (   data->hi
+         && data->filter_path
+         && !svn_fs__path_change_matches(data->filter_path,
+                                         data->filter_parents,
+                                         apr_hash_this_key(data->hi)))
+    data->hi = apr_hash_next(data->hi);
+
   if (data->hi)
     {
       const void *key;
@@ -3418,8 +3587,9 @@ fs_revision_changes_iterator_get(svn_fs_path_change3_t **change,
   fs_revision_changes_iterator_data_t *data = iterator->fsap_data;
 
   /* If we exhausted our block of changes and did not reach the end of the
-     list, yet, fetch the next block.  Note that that block may be empty. */
-  if ((data->idx >= data->changes->nelts) && !data->context->eol)
+     list, yet, fetch the next block.  Note that that block may be empty,
+     in particular if the changes get filtered. */
+  while ((data->idx >= data->changes->nelts) && !data->context->eol)
     {
       apr_pool_t *changes_pool = data->changes->pool;
 
@@ -3455,11 +3625,17 @@ static changes_iterator_vtable_t rev_changes_iterator_vtable =
   fs_revision_changes_iterator_get
 };
 
+/* Set *ITERATOR to the changes in ROOT.  If FILTER_PATH is not NULL,
+   report only changes relevant to it, including those to its parents if
+   FILTER_PARENTS is set.  Allocate the result in RESULT_POOL and use
+   SCRATCH_POOL for temporaries. */
 static svn_error_t *
-fs_report_changes(svn_fs_path_change_iterator_t **iterator,
-                  svn_fs_root_t *root,
-                  apr_pool_t *result_pool,
-                  apr_pool_t *scratch_pool)
+report_changes(svn_fs_path_change_iterator_t **iterator,
+               svn_fs_root_t *root,
+               const char *filter_path,
+               svn_boolean_t filter_parents,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
 {
   svn_fs_path_change_iterator_t *result = apr_pcalloc(result_pool,
                                                       sizeof(*result));
@@ -3472,6 +3648,8 @@ fs_report_changes(svn_fs_path_change_iterator_t **iterator,
                                            root_txn_id(root), result_pool));
 
       data->hi = apr_hash_first(result_pool, changed_paths);
+      data->filter_path = filter_path;
+      data->filter_parents = filter_parents;
       result->fsap_data = data;
       result->vtable = &txn_changes_iterator_vtable;
     }
@@ -3494,6 +3672,8 @@ fs_report_changes(svn_fs_path_change_iterator_t **iterator,
       SVN_ERR(svn_fs_fs__create_changes_context(&data->context,
                                                 root->fs, root->rev,
                                                 result_pool));
+      data->context->filter_path = filter_path;
+      data->context->filter_parents = filter_parents;
       SVN_ERR(svn_fs_fs__get_changes(&data->changes, data->context,
                                      changes_pool, scratch_pool));
 
@@ -3507,6 +3687,111 @@ fs_report_changes(svn_fs_path_change_iterator_t **iterator,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+fs_report_changes(svn_fs_path_change_iterator_t **iterator,
+                  svn_fs_root_t *root,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(report_changes(iterator, root, NULL, FALSE,
+                                        result_pool, scratch_pool));
+}
+
+static svn_error_t *
+fs_report_changes_below(svn_fs_path_change_iterator_t **iterator,
+                        svn_fs_root_t *root,
+                        const char *path,
+                        svn_boolean_t include_parents,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  /* Everything is at or below the root. */
+  if (svn_fspath__is_root(path, strlen(path)))
+    path = NULL;
+
+  return svn_error_trace(report_changes(iterator, root, path,
+                                        include_parents, result_pool,
+                                        scratch_pool));
+}
+
+static svn_error_t *
+fs_prefetch_tree(svn_fs_root_t *root,
+                 const char *path,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  dag_node_t *node;
+
+  /* Uncommitted trees live in the txn directory and are not cached. */
+  if (root->is_txn_root)
+    return SVN_NO_ERROR;
+
+  /* Don't evict more from the caches than a typical walk could use.
+     An average node revision plus directory entry takes about 1kB. */
+  SVN_ERR(get_dag(&node, root, path, scratch_pool));
+  return svn_error_trace(svn_fs_fs__prefetch_tree(
+                           root->fs, svn_fs_fs__dag_get_id(node),
+                           (apr_size_t)(svn_cache_config_get()->cache_size
+                                        / 1024),
+                           cancel_func, cancel_baton, scratch_pool));
+}
+svn_error_t *
+svn_fs_fs__paths_changed_range(svn_fs_t *fs,
+                               svn_revnum_t start,
+                               svn_revnum_t end,
+                               svn_fs_changes_receiver_t receiver,
+                               void *receiver_baton,
+                               svn_cancel_func_t cancel_func,
+                               void *cancel_baton,
+                               apr_pool_t *scratch_pool)
+{
+  fs_revision_changes_iterator_data_t data = { 0 };
+  svn_fs_path_change_iterator_t iterator;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *changes_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *rev_file_pool = svn_pool_create(scratch_pool);
+  svn_revnum_t rev;
+  int step = start <= end ? 1 : -1;
+
+  /* One context serves all revisions such that the pack file stays open
+     while we read the change lists of the revisions in a shard. */
+  data.scratch_pool = svn_pool_create(scratch_pool);
+  SVN_ERR(svn_fs_fs__create_changes_context(&data.context, fs, start,
+                                            scratch_pool));
+
+  iterator.fsap_data = &data;
+  iterator.vtable = &rev_changes_iterator_vtable;
+
+  for (rev = start; rev != end + step; rev += step)
+    {
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      /* Fetch the first block of changes.  The iterator will fetch
+         the others as needed. */
+      svn_pool_clear(changes_pool);
+      SVN_ERR(svn_fs_fs__reset_changes_context(data.context, rev,
+                                               rev_file_pool));
+      SVN_ERR(svn_fs_fs__get_changes(&data.changes, data.context,
+                                     changes_pool, iterpool));
+      data.idx = 0;
+
+      SVN_ERR(receiver(receiver_baton, rev, &iterator, iterpool));
+    }
+
+  if (data.context->revision_file)
+    SVN_ERR(svn_fs_fs__close_revision_file(data.context->revision_file));
+
+  svn_pool_destroy(rev_file_pool);
+  svn_pool_destroy(changes_pool);
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(data.scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Our coolio opaque history object. */
 typedef struct fs_history_data_t
@@ -4377,7 +4662,9 @@ get_mergeinfo_for_path_internal(svn_mergeinfo_t *mergeinfo,
   return SVN_NO_ERROR;
 }
 
-/* Caching wrapper around get_mergeinfo_for_path_internal().
+/* Caching wrapper around get_mergeinfo_for_path_internal().  Looks into
+   the in-memory caches first and then into the mergeinfo index, if that
+   is enabled.
  */
 static svn_error_t *
 get_mergeinfo_for_path(svn_mergeinfo_t *mergeinfo,
@@ -4410,10 +4697,28 @@ get_mergeinfo_for_path(svn_mergeinfo_t *mergeinfo,
 
   if (! found)
     {
-      SVN_ERR(get_mergeinfo_for_path_internal(mergeinfo, rev_root, path,
-                                              inherit,
-                                              adjust_inherited_mergeinfo,
-                                              result_pool, scratch_pool));
+      svn_boolean_t indexed = FALSE;
+
+      if (ffd->mergeinfo_index)
+        SVN_ERR(svn_fs_fs__get_indexed_mergeinfo(&indexed, mergeinfo,
+                                                 rev_root->fs, rev_root->rev,
+                                                 path, inherit,
+                                                 adjust_inherited_mergeinfo,
+                                                 result_pool, scratch_pool));
+      if (! indexed)
+        {
+          SVN_ERR(get_mergeinfo_for_path_internal(mergeinfo, rev_root, path,
+                                                  inherit,
+                                                  adjust_inherited_mergeinfo,
+                                                  result_pool,
+                                                  scratch_pool));
+          if (ffd->mergeinfo_index)
+            SVN_ERR(svn_fs_fs__set_indexed_mergeinfo(
+                      rev_root->fs, rev_root->rev, path, inherit,
+                      adjust_inherited_mergeinfo, *mergeinfo,
+                      scratch_pool));
+        }
+
       if (ffd->mergeinfo_existence_cache)
         {
           mergeinfo_exists = svn_stringbuf_create(*mergeinfo ? "1" : "0",
@@ -4579,6 +4884,10 @@ static root_vtable_t root_vtable = {
   fs_get_file_delta_stream,
   fs_merge,
   fs_get_mergeinfo,
+  fs_file_contents_range,
+  fs_dir_entries_info,
+  fs_report_changes_below,
+  fs_prefetch_tree,
 };
 
 /* Construct a new root object in FS, allocated from POOL.  */
@@ -4628,6 +4937,7 @@ make_txn_root(svn_fs_root_t **root_p,
   svn_fs_root_t *root = make_root(fs, pool);
   fs_txn_root_data_t *frd = apr_pcalloc(root->pool, sizeof(*frd));
   frd->txn_id = *txn;
+  frd->mutable_nodes = apr_hash_make(root->pool);
 
   root->is_txn_root = TRUE;
   root->txn = svn_fs_fs__id_txn_unparse(txn, root->pool);
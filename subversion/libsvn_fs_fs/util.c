@@ -492,21 +492,18 @@ svn_fs_fs__read_current(svn_revnum_t *rev,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_fs_fs__write_current(svn_fs_t *fs,
-                         svn_revnum_t rev,
-                         apr_uint64_t next_node_id,
-                         apr_uint64_t next_copy_id,
-                         apr_pool_t *pool)
+const char *
+svn_fs_fs__unparse_current(svn_fs_t *fs,
+                           svn_revnum_t rev,
+                           apr_uint64_t next_node_id,
+                           apr_uint64_t next_copy_id,
+                           apr_pool_t *result_pool)
 {
-  char *buf;
-  const char *name;
   fs_fs_data_t *ffd = fs->fsap_data;
 
-  /* Now we can just write out this line. */
   if (ffd->format >= SVN_FS_FS__MIN_NO_GLOBAL_IDS_FORMAT)
     {
-      buf = apr_psprintf(pool, "%ld\n", rev);
+      return apr_psprintf(result_pool, "%ld\n", rev);
     }
   else
     {
@@ -515,9 +512,25 @@ svn_fs_fs__write_current(svn_fs_t *fs,
       svn__ui64tobase36(node_id_str, next_node_id);
       svn__ui64tobase36(copy_id_str, next_copy_id);
 
-      buf = apr_psprintf(pool, "%ld %s %s\n", rev, node_id_str, copy_id_str);
+      return apr_psprintf(result_pool, "%ld %s %s\n", rev, node_id_str,
+                          copy_id_str);
     }
+}
 
+svn_error_t *
+svn_fs_fs__write_current(svn_fs_t *fs,
+                         svn_revnum_t rev,
+                         apr_uint64_t next_node_id,
+                         apr_uint64_t next_copy_id,
+                         apr_pool_t *pool)
+{
+  const char *buf;
+  const char *name;
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  /* Now we can just write out this line. */
+  buf = svn_fs_fs__unparse_current(fs, rev, next_node_id, next_copy_id,
+                                   pool);
   name = svn_fs_fs__path_current(fs, pool);
   SVN_ERR(svn_io_write_atomic2(name, buf, strlen(buf),
                                name /* copy_perms_path */,
@@ -24,6 +24,7 @@
 #include "svn_checksum.h"
 #include "svn_time.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_pool.h"
 
 #include "verify.h"
 #include "fs_fs.h"
@@ -792,6 +793,39 @@ pack_size(svn_fs_t *fs, svn_revnum_t rev)
   return rev < ffd->min_unpacked_rev ? ffd->max_files_per_dir : 1;
 }
 
+/* Run all low-level checks on the COUNT revisions starting at PACK_START
+ * in FS.  PACK_START must be the first revision of a pack or rev file and
+ * COUNT the number of revisions in it.  Use POOL for temporary allocations.
+ */
+static svn_error_t *
+verify_f7_file(svn_fs_t *fs,
+               svn_revnum_t pack_start,
+               svn_revnum_t count,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *pool)
+{
+  /* Check for external corruption to the indexes. */
+  SVN_ERR(verify_index_checksums(fs, pack_start, cancel_func,
+                                 cancel_baton, pool));
+
+  /* two-way index check */
+  SVN_ERR(compare_l2p_to_p2l_index(fs, pack_start, count,
+                                   cancel_func, cancel_baton, pool));
+  SVN_ERR(compare_p2l_to_l2p_index(fs, pack_start, count,
+                                   cancel_func, cancel_baton, pool));
+
+  /* verify in-index checksums and types vs. actual rev / pack files */
+  SVN_ERR(compare_p2l_to_rev(fs, pack_start, count,
+                             cancel_func, cancel_baton, pool));
+
+  /* ensure that revprops are available and accessible */
+  SVN_ERR(verify_revprops(fs, pack_start, pack_start + count,
+                          cancel_func, cancel_baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Verify that on-disk representation has not been tempered with (in a way
  * that leaves the repository in a corrupted state).  This compares log-to-
  * phys with phys-to-log indexes, verifies the low-level checksums and
@@ -828,27 +862,8 @@ verify_f7_metadata_consistency(svn_fs_t *fs,
       if (notify_func && (pack_start % ffd->max_files_per_dir == 0))
         notify_func(pack_start, notify_baton, iterpool);
 
-      /* Check for external corruption to the indexes. */
-      err = verify_index_checksums(fs, pack_start, cancel_func,
-                                   cancel_baton, iterpool);
-
-      /* two-way index check */
-      if (!err)
-        err = compare_l2p_to_p2l_index(fs, pack_start, pack_end - pack_start,
-                                       cancel_func, cancel_baton, iterpool);
-      if (!err)
-        err = compare_p2l_to_l2p_index(fs, pack_start, pack_end - pack_start,
-                                       cancel_func, cancel_baton, iterpool);
-
-      /* verify in-index checksums and types vs. actual rev / pack files */
-      if (!err)
-        err = compare_p2l_to_rev(fs, pack_start, pack_end - pack_start,
-                                 cancel_func, cancel_baton, iterpool);
-
-      /* ensure that revprops are available and accessible */
-      if (!err)
-        err = verify_revprops(fs, pack_start, pack_end,
-                              cancel_func, cancel_baton, iterpool);
+      err = verify_f7_file(fs, pack_start, pack_end - pack_start,
+                           cancel_func, cancel_baton, iterpool);
 
       /* concurrent packing is one of the reasons why verification may fail.
          Make sure, we operate on up-to-date information. */
@@ -884,10 +899,155 @@ verify_f7_metadata_consistency(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* A single pack or rev file to be checked by one of the workers in a
+ * concurrent verification run.  See verify_f7_concurrently().
+ */
+typedef struct verify_job_t
+{
+  /* First revision in the file and number of revisions in it. */
+  svn_revnum_t pack_start;
+  svn_revnum_t count;
+
+  /* The job in the thread pool that checks this file. */
+  svn_thread_pool__job_t *job;
+} verify_job_t;
+
+/* Implements svn_thread_pool__worker_init_t.  Let each worker use its
+ * own FS instance from the array given as BATON.
+ */
+static svn_error_t *
+get_worker_fs(void **worker_baton,
+              void *baton,
+              int worker_index,
+              apr_pool_t *worker_pool)
+{
+  apr_array_header_t *worker_fss = baton;
+  *worker_baton = APR_ARRAY_IDX(worker_fss, worker_index, svn_fs_t *);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Check the file described by
+ * the verify_job_t given as JOB_BATON, using the svn_fs_t given as
+ * WORKER_BATON.
+ */
+static svn_error_t *
+verify_file_job(void *job_baton,
+                void *worker_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
+{
+  verify_job_t *job = job_baton;
+
+  return svn_error_trace(verify_f7_file(worker_baton, job->pack_start,
+                                        job->count, cancel_func,
+                                        cancel_baton, scratch_pool));
+}
+
+/* Same as verify_f7_metadata_consistency but check the individual pack
+ * and rev files concurrently, using one thread per element in WORKER_FSS.
+ * Notifications are sent and failures are reported in ascending revision
+ * order from the calling thread.
+ *
+ * A file that fails the check gets verified once more by the calling
+ * thread, which takes care of shards that got packed concurrently.
+ */
+static svn_error_t *
+verify_f7_concurrently(svn_fs_t *fs,
+                       svn_revnum_t start,
+                       svn_revnum_t end,
+                       apr_array_header_t *worker_fss,
+                       svn_fs_progress_notify_func_t notify_func,
+                       void *notify_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_thread_pool__t *thread_pool;
+  verify_job_t *jobs;
+  int job_count = 0;
+  int i;
+  svn_revnum_t revision;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  /* Split the range into pack and rev files. */
+  jobs = apr_pcalloc(pool, (end - start + 1) * sizeof(*jobs));
+  for (revision = start; revision <= end; ++job_count)
+    {
+      verify_job_t *job = &jobs[job_count];
+      job->pack_start = svn_fs_fs__packed_base_rev(fs, revision);
+      job->count = pack_size(fs, revision);
+      revision = job->pack_start + job->count;
+    }
+
+  /* More threads than files would be pointless. */
+  SVN_ERR(svn_thread_pool__create(&thread_pool,
+                                  MIN(worker_fss->nelts, job_count),
+                                  get_worker_fs, worker_fss, pool));
+
+  for (i = 0; i < job_count && !err; ++i)
+    err = svn_thread_pool__submit(&jobs[i].job, thread_pool,
+                                  verify_file_job, &jobs[i]);
+
+  /* Collect the results in order. */
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < job_count && !err; ++i)
+    {
+      verify_job_t *job = &jobs[i];
+      svn_error_t *job_err;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        {
+          err = cancel_func(cancel_baton);
+          if (err)
+            break;
+        }
+
+      if (notify_func && (job->pack_start % ffd->max_files_per_dir == 0))
+        notify_func(job->pack_start, notify_baton, iterpool);
+
+      /* Double-check failures in this thread.  This also retries files
+         that got packed since we split the range. */
+      job_err = svn_thread_pool__wait(thread_pool, job->job, NULL, NULL);
+      if (job_err)
+        {
+          svn_error_clear(job_err);
+
+          err = verify_f7_metadata_consistency(fs,
+                                               MAX(job->pack_start, start),
+                                               MIN(job->pack_start
+                                                     + job->count - 1,
+                                                   end),
+                                               NULL, NULL,
+                                               cancel_func, cancel_baton,
+                                               iterpool);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Stop all workers that may still be running and wait for them.
+     Results of jobs that we did not process are irrelevant. */
+  err = svn_error_compose_create(err,
+                                 svn_thread_pool__join(thread_pool, TRUE));
+
+  return svn_error_trace(err);
+}
+
+#endif
+
 svn_error_t *
 svn_fs_fs__verify(svn_fs_t *fs,
                   svn_revnum_t start,
                   svn_revnum_t end,
+                  apr_array_header_t *worker_fss,
                   svn_fs_progress_notify_func_t notify_func,
                   void *notify_baton,
                   svn_cancel_func_t cancel_func,
@@ -910,9 +1070,19 @@ svn_fs_fs__verify(svn_fs_t *fs,
   /* log/phys index consistency.  We need to check them first to make
      sure we can access the rev / pack files in format7. */
   if (svn_fs_fs__use_log_addressing(fs))
-    SVN_ERR(verify_f7_metadata_consistency(fs, start, end,
-                                           notify_func, notify_baton,
-                                           cancel_func, cancel_baton, pool));
+    {
+#if APR_HAS_THREADS
+      if (worker_fss && worker_fss->nelts > 1)
+        SVN_ERR(verify_f7_concurrently(fs, start, end, worker_fss,
+                                       notify_func, notify_baton,
+                                       cancel_func, cancel_baton, pool));
+      else
+#endif
+        SVN_ERR(verify_f7_metadata_consistency(fs, start, end,
+                                               notify_func, notify_baton,
+                                               cancel_func, cancel_baton,
+                                               pool));
+    }
 
   /* rep cache consistency */
   if (ffd->format >= SVN_FS_FS__MIN_REP_SHARING_FORMAT)
@@ -29,10 +29,18 @@
  * START to END where possible.  Indicate progress via the optional
  * NOTIFY_FUNC callback using NOTIFY_BATON.  The optional CANCEL_FUNC
  * will periodically be called with CANCEL_BATON to allow for preemption.
+ *
+ * If WORKER_FSS is not NULL and has more than one element, it contains
+ * additional svn_fs_t * instances of the same repository.  The index and
+ * checksum checks of the individual pack and rev files will then be run
+ * concurrently in one thread per instance.  Both callbacks will only be
+ * invoked from the calling thread.
+ *
  * Use POOL for temporary allocations. */
 svn_error_t *svn_fs_fs__verify(svn_fs_t *fs,
                                svn_revnum_t start,
                                svn_revnum_t end,
+                               apr_array_header_t *worker_fss,
                                svn_fs_progress_notify_func_t notify_func,
                                void *notify_baton,
                                svn_cancel_func_t cancel_func,
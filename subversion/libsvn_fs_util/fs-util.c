@@ -227,6 +227,18 @@ svn_fs__path_change_create_internal2(svn_fs_path_change_kind_t change_kind,
   return change;
 }
 
+svn_boolean_t
+svn_fs__path_change_matches(const char *filter_path,
+                            svn_boolean_t include_parents,
+                            const char *changed_path)
+{
+  if (svn_fspath__skip_ancestor(filter_path, changed_path))
+    return TRUE;
+
+  return include_parents
+      && svn_fspath__skip_ancestor(changed_path, filter_path) != NULL;
+}
+
 svn_error_t *
 svn_fs__append_to_merged_froms(svn_mergeinfo_t *output,
                                svn_mergeinfo_t input,
@@ -1142,6 +1142,30 @@ set_cached_combined_window(svn_stringbuf_t *window,
                         scratch_pool);
 }
 
+/* Tell the OS to fetch the on-disk data of all reps in LIST that are
+   stored in revision files.  Reading a delta chain means reading from
+   many different offsets and this allows the OS to do it concurrently
+   instead of one seek at a time. */
+static svn_error_t *
+prefetch_rep_list(apr_array_header_t *list)
+{
+  int i;
+  for (i = 0; i < list->nelts; ++i)
+    {
+      rep_state_t *rs = APR_ARRAY_IDX(list, i, rep_state_t *);
+
+      /* Reps with a cached header, containers and txn data are left
+         alone.  In the first case, the data has been read recently. */
+      if (   rs->start >= 0
+          && rs->sfile->rfile
+          && svn_fs_x__is_revision(rs->rep_id.change_set))
+        SVN_ERR(svn_fs_x__rev_file_prefetch(rs->sfile->rfile, rs->start,
+                                            rs->size));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Build an array of rep_state structures in *LIST giving the delta
    reps from first_rep to a  self-compressed rep.  Set *SRC_STATE to
    the container rep we find at the end of the chain, or to NULL if
@@ -1227,6 +1251,9 @@ build_rep_list(apr_array_header_t **list,
     }
   svn_pool_destroy(iterpool);
 
+  /* Read the deltas of the whole chain in parallel. */
+  SVN_ERR(prefetch_rep_list(*list));
+
   return SVN_NO_ERROR;
 }
 
@@ -2956,6 +2983,7 @@ svn_fs_x__get_changes(apr_array_header_t **changes,
       svn_fs_x__changes_get_list_baton_t baton;
       baton.start = (int)context->next;
       baton.eol = &context->eol;
+      baton.paths_only = context->paths_only;
 
       SVN_ERR(svn_fs_x__item_offset(&offset, &baton.sub_item, context->fs,
                                     context->revision_file,
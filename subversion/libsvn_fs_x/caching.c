@@ -433,6 +433,11 @@ svn_fs_x__initialize_caches(svn_fs_t *fs,
   /* 1st level DAG node cache */
   ffd->dag_node_cache = svn_fs_x__create_dag_cache(fs->pool);
 
+  /* Re-use path lookups of previous FSX sessions, e.g. after restarts. */
+  if (svn_hash__get_bool(fs->config, SVN_FS_CONFIG_FSX_DAG_CACHE_SNAPSHOT,
+                         FALSE))
+    svn_fs_x__dag_cache_enable_snapshot(ffd->dag_node_cache, fs);
+
   /* Very rough estimate: 1K per directory. */
   SVN_ERR(create_cache(&(ffd->dir_cache),
                        NULL,
@@ -271,14 +271,23 @@ svn_fs_x__changes_get_list(apr_array_header_t **list,
       change->node_kind = (svn_node_kind_t)
         ((binary_change->flags & CHANGE_NODE_MASK) >> CHANGE_NODE_SHIFT);
 
-      change->copyfrom_rev = binary_change->copyfrom_rev;
-      change->copyfrom_known = TRUE;
-      if (SVN_IS_VALID_REVNUM(binary_change->copyfrom_rev))
-        change->copyfrom_path
-          = svn_fs_x__string_table_get(changes->paths,
-                                        binary_change->copyfrom_path,
-                                        NULL,
-                                        result_pool);
+      /* Only look up the copy-from path if the caller wants it.
+       * Leaving COPYFROM_KNOWN unset tells the caller explicitly. */
+      if (context->paths_only)
+        {
+          change->copyfrom_rev = SVN_INVALID_REVNUM;
+        }
+      else
+        {
+          change->copyfrom_rev = binary_change->copyfrom_rev;
+          change->copyfrom_known = TRUE;
+          if (SVN_IS_VALID_REVNUM(binary_change->copyfrom_rev))
+            change->copyfrom_path
+              = svn_fs_x__string_table_get(changes->paths,
+                                            binary_change->copyfrom_path,
+                                            NULL,
+                                            result_pool);
+        }
 
       /* add it to the result */
       APR_ARRAY_PUSH(*list, svn_fs_x__change_t*) = change;
@@ -516,14 +525,22 @@ svn_fs_x__changes_get_list_func(void **out,
       change->node_kind = (svn_node_kind_t)
         ((binary_change->flags & CHANGE_NODE_MASK) >> CHANGE_NODE_SHIFT);
 
-      change->copyfrom_rev = binary_change->copyfrom_rev;
-      change->copyfrom_known = TRUE;
-      if (SVN_IS_VALID_REVNUM(binary_change->copyfrom_rev))
-        change->copyfrom_path
-          = svn_fs_x__string_table_get_func(paths,
-                                            binary_change->copyfrom_path,
-                                            NULL,
-                                            pool);
+      /* Only look up the copy-from path if the caller wants it. */
+      if (b->paths_only)
+        {
+          change->copyfrom_rev = SVN_INVALID_REVNUM;
+        }
+      else
+        {
+          change->copyfrom_rev = binary_change->copyfrom_rev;
+          change->copyfrom_known = TRUE;
+          if (SVN_IS_VALID_REVNUM(binary_change->copyfrom_rev))
+            change->copyfrom_path
+              = svn_fs_x__string_table_get_func(paths,
+                                                binary_change->copyfrom_path,
+                                                NULL,
+                                                pool);
+        }
 
       /* add it to the result */
       APR_ARRAY_PUSH(list, svn_fs_x__change_t*) = change;
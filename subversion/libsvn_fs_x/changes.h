@@ -72,8 +72,9 @@ svn_fs_x__changes_estimate_size(const svn_fs_x__changes_t *changes);
 /* Read changes containers. */
 
 /* From CHANGES, access the change list with the given IDX and extract the
- * next entries according to CONTEXT.  Allocate the result in RESULT_POOL
- * and return it in *LIST.
+ * next entries according to CONTEXT.  If CONTEXT->PATHS_ONLY is set, don't
+ * resolve the copy-from paths.  Allocate the result in RESULT_POOL and
+ * return it in *LIST.
  */
 svn_error_t *
 svn_fs_x__changes_get_list(apr_array_header_t **list,
@@ -130,6 +131,9 @@ typedef struct svn_fs_x__changes_get_list_baton_t
   /* To be set by svn_fs_x__changes_get_list_func:
      Did we deliver the last change in that list? */
   svn_boolean_t *eol;
+
+  /* Skip the copy-from info.  See svn_fs_x__changes_context_t. */
+  svn_boolean_t paths_only;
 } svn_fs_x__changes_get_list_baton_t;
 
 /* Implements svn_cache__partial_getter_func_t for svn_fs_x__changes_t,
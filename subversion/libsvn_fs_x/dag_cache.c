@@ -40,6 +40,7 @@
 #include <assert.h>
 #include <apr_pools.h>
 #include <apr_hash.h>
+#include <apr_strings.h>
 
 #include "svn_hash.h"
 #include "svn_private_config.h"
@@ -48,6 +49,7 @@
 #include "svn_path.h"
 #include "svn_mergeinfo.h"
 #include "svn_fs.h"
+#include "svn_io.h"
 #include "svn_props.h"
 #include "svn_sorts.h"
 
@@ -244,6 +246,16 @@ typedef struct cache_entry_t
  */
 enum { BUCKET_COUNT = 256 };
 
+/* Maximum number of path lookups to keep in a DAG cache snapshot.  Each
+   one takes about 100 bytes in memory and on disk.  Once that limit has
+   been reached, we start over with an empty snapshot such that it will
+   follow changing access patterns and HEAD moving on.
+ */
+enum { SNAPSHOT_MAX_ENTRIES = 16384 };
+
+/* Minimum time between two updates of the DAG cache snapshot on disk. */
+#define SNAPSHOT_WRITE_INTERVAL apr_time_from_sec(60)
+
 /* The actual cache structure.  All nodes will be allocated in POOL.
    When the number of INSERTIONS (i.e. objects created form that pool)
    exceeds a certain threshold, the pool will be cleared and the cache
@@ -270,6 +282,22 @@ struct svn_fs_x__dag_cache_t
      This value is a mere hint for optimistic lookup and any value is
      valid (as long as it is < BUCKET_COUNT). */
   apr_size_t last_non_empty;
+
+  /* Filesystem whose path lookups get persisted in the snapshot.
+     NULL if snapshots are disabled. */
+  svn_fs_t *snapshot_fs;
+
+  /* Maps "REVISION PATH" to the svn_fs_x__id_t of the node found there.
+     Keys and values are allocated in SNAPSHOT_POOL.  NULL until the
+     snapshot has been read from disk. */
+  apr_hash_t *snapshot;
+  apr_pool_t *snapshot_pool;
+
+  /* Number of lookups added to SNAPSHOT since it has been written. */
+  apr_size_t snapshot_changes;
+
+  /* Time at which SNAPSHOT has been read or written for the last time. */
+  apr_time_t snapshot_time;
 };
 
 svn_fs_x__dag_cache_t*
@@ -281,6 +309,202 @@ svn_fs_x__create_dag_cache(apr_pool_t *result_pool)
   return result;
 }
 
+void
+svn_fs_x__dag_cache_enable_snapshot(svn_fs_x__dag_cache_t *cache,
+                                    svn_fs_t *fs)
+{
+  cache->snapshot_fs = fs;
+  cache->snapshot_pool = svn_pool_create(fs->pool);
+}
+
+/* Return the key for PATH in CHANGE_SET as used in DAG cache snapshots.
+   Allocate it in RESULT_POOL. */
+static const char *
+snapshot_key(svn_fs_x__change_set_t change_set,
+             const svn_string_t *path,
+             apr_pool_t *result_pool)
+{
+  return apr_psprintf(result_pool, "%ld %.*s",
+                      svn_fs_x__get_revnum(change_set),
+                      (int)path->len, path->data);
+}
+
+/* Read the snapshot of CACHE from disk, unless that already happened.
+   Silently ignore missing or malformed snapshot files as well as entries
+   referring to revisions that have not been committed.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+load_snapshot(svn_fs_x__dag_cache_t *cache,
+              apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = cache->snapshot_fs;
+  svn_stringbuf_t *contents;
+  svn_revnum_t youngest;
+  svn_error_t *err;
+  char *line, *last;
+
+  if (cache->snapshot)
+    return SVN_NO_ERROR;
+
+  cache->snapshot = svn_hash__make(cache->snapshot_pool);
+  cache->snapshot_time = apr_time_now();
+
+  err = svn_stringbuf_from_file2(&contents,
+                                 svn_fs_x__path_dag_cache(fs, scratch_pool),
+                                 scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  SVN_ERR(svn_fs_x__youngest_rev(&youngest, fs, scratch_pool));
+
+  /* Each line reads "NODE-ID REVISION PATH", i.e. the key follows the
+     node ID. */
+  for (line = apr_strtok(contents->data, "\n", &last);
+       line && apr_hash_count(cache->snapshot) < SNAPSHOT_MAX_ENTRIES;
+       line = apr_strtok(NULL, "\n", &last))
+    {
+      svn_fs_x__id_t id;
+      apr_int64_t revision;
+      char *key = strchr(line, ' ');
+      char *path = key ? strchr(key + 1, ' ') : NULL;
+
+      if (path == NULL)
+        break;
+
+      *key = '\0';
+      *path = '\0';
+      err = svn_error_compose_create(svn_fs_x__id_parse(&id, line),
+                                     svn_cstring_atoi64(&revision, key + 1));
+      if (err)
+        {
+          svn_error_clear(err);
+          break;
+        }
+
+      /* The node must exist in REVISION. */
+      if (   revision < 0 || revision > youngest
+          || !svn_fs_x__is_revision(id.change_set)
+          || svn_fs_x__get_revnum(id.change_set) > revision)
+        continue;
+
+      *path = ' ';
+      apr_hash_set(cache->snapshot,
+                   apr_pstrdup(cache->snapshot_pool, key + 1),
+                   APR_HASH_KEY_STRING,
+                   apr_pmemdup(cache->snapshot_pool, &id, sizeof(id)));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* If the snapshot of CACHE knows the node at PATH in CHANGE_SET, set *ID
+   to its ID and *FOUND to TRUE.  Set *FOUND to FALSE otherwise, e.g. if
+   snapshots are disabled.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+snapshot_get(svn_boolean_t *found,
+             svn_fs_x__id_t *id,
+             svn_fs_x__dag_cache_t *cache,
+             svn_fs_x__change_set_t change_set,
+             const svn_string_t *path,
+             apr_pool_t *scratch_pool)
+{
+  const svn_fs_x__id_t *snapshot_id;
+
+  *found = FALSE;
+  if (cache->snapshot_fs == NULL || !svn_fs_x__is_revision(change_set))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(load_snapshot(cache, scratch_pool));
+  snapshot_id = apr_hash_get(cache->snapshot,
+                             snapshot_key(change_set, path, scratch_pool),
+                             APR_HASH_KEY_STRING);
+  if (snapshot_id)
+    {
+      *id = *snapshot_id;
+      *found = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Record in the snapshot of CACHE that PATH in CHANGE_SET refers to the
+   node with the given ID.  This is a no-op if snapshots are disabled. */
+static void
+snapshot_set(svn_fs_x__dag_cache_t *cache,
+             svn_fs_x__change_set_t change_set,
+             const svn_string_t *path,
+             const svn_fs_x__id_t *id)
+{
+  /* The snapshot will have been loaded when looking up the node. */
+  if (cache->snapshot == NULL || !svn_fs_x__is_revision(change_set))
+    return;
+
+  if (apr_hash_count(cache->snapshot) >= SNAPSHOT_MAX_ENTRIES)
+    {
+      svn_pool_clear(cache->snapshot_pool);
+      cache->snapshot = svn_hash__make(cache->snapshot_pool);
+    }
+
+  apr_hash_set(cache->snapshot,
+               snapshot_key(change_set, path, cache->snapshot_pool),
+               APR_HASH_KEY_STRING,
+               apr_pmemdup(cache->snapshot_pool, id, sizeof(*id)));
+  ++cache->snapshot_changes;
+}
+
+/* Write the snapshot of CACHE to disk, replacing the previous version.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_snapshot(svn_fs_x__dag_cache_t *cache,
+               apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *contents;
+  apr_hash_index_t *hi;
+
+  if (cache->snapshot == NULL)
+    return SVN_NO_ERROR;
+
+  contents = svn_stringbuf_create_ensure(apr_hash_count(cache->snapshot)
+                                           * 64,
+                                         scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, cache->snapshot);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const svn_string_t *id
+        = svn_fs_x__id_unparse(apr_hash_this_val(hi), scratch_pool);
+
+      svn_stringbuf_appendbytes(contents, id->data, id->len);
+      svn_stringbuf_appendbyte(contents, ' ');
+      svn_stringbuf_appendcstr(contents, apr_hash_this_key(hi));
+      svn_stringbuf_appendbyte(contents, '\n');
+    }
+
+  /* Concurrent writers simply replace each other's snapshot. */
+  SVN_ERR(svn_io_write_atomic2(svn_fs_x__path_dag_cache(cache->snapshot_fs,
+                                                        scratch_pool),
+                               contents->data, contents->len,
+                               NULL /* copy_perms_path */, FALSE,
+                               scratch_pool));
+
+  cache->snapshot_changes = 0;
+  cache->snapshot_time = apr_time_now();
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_x__dag_cache_write_snapshot(svn_fs_t *fs,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  return svn_error_trace(write_snapshot(ffd->dag_node_cache, scratch_pool));
+}
+
 /* Clears the CACHE at regular intervals (destroying all cached nodes).
  * Return TRUE if the cache got cleared and previously obtained references
  * to cache contents have become invalid.
@@ -291,6 +515,12 @@ auto_clear_dag_cache(svn_fs_x__dag_cache_t* cache)
   if (cache->insertions <= BUCKET_COUNT)
     return FALSE;
 
+  /* Persist recent lookups every once in a while.  This is merely an
+     optimization for future FSX sessions, so ignore any failures. */
+  if (   cache->snapshot_changes
+      && apr_time_now() - cache->snapshot_time > SNAPSHOT_WRITE_INTERVAL)
+    svn_error_clear(write_snapshot(cache, cache->pool));
+
   svn_pool_clear(cache->pool);
 
   memset(cache->buckets, 0, sizeof(cache->buckets));
@@ -557,6 +787,7 @@ dag_step(dag_node_t **child_p,
   svn_fs_x__data_t *ffd = fs->fsap_data;
   cache_entry_t *bucket;
   svn_fs_x__id_t node_id;
+  svn_boolean_t found;
 
   /* Locate the corresponding cache entry.  We may need PARENT to remain
      valid for later use, so don't call auto_clear_dag_cache() here. */
@@ -568,25 +799,34 @@ dag_step(dag_node_t **child_p,
       return SVN_NO_ERROR;
     }
 
-  /* Get the ID of the node we are looking for.  The function call checks
-     for various error conditions such like PARENT not being a directory. */
-  SVN_ERR(svn_fs_x__dir_entry_id(&node_id, parent, name, scratch_pool));
-  if (! svn_fs_x__id_used(&node_id))
+  /* Previous FSX sessions may have told us where to find the node.
+     Otherwise, get the ID of the node we are looking for.  The function
+     call checks for various error conditions such like PARENT not being
+     a directory. */
+  SVN_ERR(snapshot_get(&found, &node_id, ffd->dag_node_cache, change_set,
+                       path, scratch_pool));
+  if (!found)
     {
-      const char *dir;
-
-      /* No such directory entry.  Is a simple NULL result o.k.? */
-      if (allow_empty)
+      SVN_ERR(svn_fs_x__dir_entry_id(&node_id, parent, name, scratch_pool));
+      if (! svn_fs_x__id_used(&node_id))
         {
-          *child_p = NULL;
-          return SVN_NO_ERROR;
-        }
+          const char *dir;
+
+          /* No such directory entry.  Is a simple NULL result o.k.? */
+          if (allow_empty)
+            {
+              *child_p = NULL;
+              return SVN_NO_ERROR;
+            }
+
+          /* Produce an appropriate error message. */
+          dir = apr_pstrmemdup(scratch_pool, path->data, path->len);
+          dir = svn_fs__canonicalize_abspath(dir, scratch_pool);
 
-      /* Produce an appropriate error message. */
-      dir = apr_pstrmemdup(scratch_pool, path->data, path->len);
-      dir = svn_fs__canonicalize_abspath(dir, scratch_pool);
+          return SVN_FS__NOT_FOUND(root, dir);
+        }
 
-      return SVN_FS__NOT_FOUND(root, dir);
+      snapshot_set(ffd->dag_node_cache, change_set, path, &node_id);
     }
 
   /* We are about to add a new entry to the cache.  Periodically clear it.
@@ -638,6 +878,43 @@ get_root_node(dag_node_t **node_p,
   return SVN_NO_ERROR;
 }
 
+/* Try a short-cut for the open_path() function using the DAG cache
+ * snapshot written by previous FSX sessions.  If it knows the node at
+ * PATH in ROOT, return it in *NODE_P.  Set it to NULL otherwise.
+ * Use SCRATCH_POOL for temporary allocations.
+ *
+ * NOTE: *NODE_P will live within the DAG cache and we merely return a
+ * reference to it.  Hence, it will invalid upon the next cache insertion.
+ */
+static svn_error_t *
+try_snapshot(dag_node_t **node_p,
+             svn_fs_root_t *root,
+             const svn_string_t *path,
+             apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = root->fs->fsap_data;
+  svn_fs_x__dag_cache_t *cache = ffd->dag_node_cache;
+  svn_fs_x__change_set_t change_set = svn_fs_x__root_change_set(root);
+  svn_fs_x__id_t node_id;
+  svn_boolean_t found;
+  cache_entry_t *bucket;
+
+  *node_p = NULL;
+  SVN_ERR(snapshot_get(&found, &node_id, cache, change_set, path,
+                       scratch_pool));
+  if (!found)
+    return SVN_NO_ERROR;
+
+  auto_clear_dag_cache(cache);
+  bucket = cache_lookup(cache, change_set, path);
+  if (bucket->node == NULL)
+    SVN_ERR(svn_fs_x__dag_get_node(&bucket->node, root->fs, &node_id,
+                                   cache->pool, scratch_pool));
+
+  *node_p = bucket->node;
+  return SVN_NO_ERROR;
+}
+
 /* Walk the DAG starting at ROOT, following PATH and return a reference to
    the target node in *NODE_P.   Use SCRATCH_POOL for temporary allocations.
 
@@ -704,6 +981,17 @@ walk_dag_path(dag_node_t **node_p,
                                         change_set, FALSE, scratch_pool));
     }
 
+  /* Third attempt: Some previous FSX session may have walked the same
+     path and recorded the result in the DAG cache snapshot. */
+  if (!root->is_txn_root)
+    {
+      SVN_ERR(try_snapshot(node_p, root, path, scratch_pool));
+
+      /* Did the shortcut work? */
+      if (*node_p)
+        return SVN_NO_ERROR;
+    }
+
   /* Now there is something to iterate over. Thus, create the ITERPOOL. */
   iterpool = svn_pool_create(scratch_pool);
 
@@ -33,6 +33,21 @@ extern "C" {
 svn_fs_x__dag_cache_t*
 svn_fs_x__create_dag_cache(apr_pool_t *result_pool);
 
+/* Make CACHE for the filesystem FS use a persistent snapshot of recent
+   path@revision to node lookups.  The snapshot will be read lazily upon
+   the first lookup that misses CACHE and will periodically be updated
+   with the latest lookups. */
+void
+svn_fs_x__dag_cache_enable_snapshot(svn_fs_x__dag_cache_t *cache,
+                                    svn_fs_t *fs);
+
+/* Write the snapshot of FS' DAG cache to disk, replacing any previous
+   one.  This is a no-op if snapshots have not been enabled for FS' DAG
+   cache.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_fs_x__dag_cache_write_snapshot(svn_fs_t *fs,
+                                   apr_pool_t *scratch_pool);
+
 /* Invalidate cache entries for PATH within ROOT and any of its children. */
 void
 svn_fs_x__invalidate_dag_cache(svn_fs_root_t *root,
@@ -32,7 +32,7 @@
 #include "svn_delta.h"
 #include "svn_version.h"
 #include "svn_pools.h"
-#include "batch_fsync.h"
+#include "private/svn_batch_fsync.h"
 #include "fs.h"
 #include "fs_x.h"
 #include "pack.h"
@@ -311,7 +311,8 @@ static fs_vtable_t fs_vtable = {
   svn_fs_x__verify_root,
   x_freeze,
   x_set_errcall,
-  NULL /* ioctl */
+  NULL /* ioctl */,
+  NULL /* paths_changed_range */
 };
 
 
@@ -484,6 +485,7 @@ x_verify(svn_fs_t *fs,
          const char *path,
          svn_revnum_t start,
          svn_revnum_t end,
+         int jobs,
          svn_fs_progress_notify_func_t notify_func,
          void *notify_baton,
          svn_cancel_func_t cancel_func,
@@ -497,9 +499,62 @@ x_verify(svn_fs_t *fs,
                           cancel_func, cancel_baton, scratch_pool);
 }
 
+#if APR_HAS_THREADS
+
+/* Pool cleanup function destroying the root pool given as DATA. */
+static apr_status_t
+destroy_worker_pool(void *data)
+{
+  svn_pool_destroy(data);
+  return APR_SUCCESS;
+}
+
+/* Open COUNT additional instances of the filesystem at PATH, which has
+ * already been opened in FS, and return them in *WORKER_FSS.  Each of
+ * them lives in a separate root pool such that it may be used by some
+ * other thread.  Those pools get destroyed when RESULT_POOL is being
+ * cleaned up.  See x_open() for COMMON_POOL_LOCK and COMMON_POOL.
+ */
+static svn_error_t *
+open_worker_fss(apr_array_header_t **worker_fss,
+                svn_fs_t *fs,
+                const char *path,
+                int count,
+                svn_mutex__t *common_pool_lock,
+                apr_pool_t *result_pool,
+                apr_pool_t *common_pool)
+{
+  int i;
+
+  *worker_fss = apr_array_make(result_pool, count, sizeof(svn_fs_t *));
+  for (i = 0; i < count; ++i)
+    {
+      apr_pool_t *worker_pool
+        = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+      svn_fs_t *worker_fs = apr_pcalloc(worker_pool, sizeof(*worker_fs));
+
+      apr_pool_cleanup_register(result_pool, worker_pool,
+                                destroy_worker_pool, apr_pool_cleanup_null);
+
+      worker_fs->pool = worker_pool;
+      worker_fs->warning = fs->warning;
+      worker_fs->warning_baton = fs->warning_baton;
+      worker_fs->config = fs->config;
+
+      SVN_ERR(x_open(worker_fs, path, common_pool_lock, worker_pool,
+                     common_pool));
+      APR_ARRAY_PUSH(*worker_fss, svn_fs_t *) = worker_fs;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#endif
+
 static svn_error_t *
 x_pack(svn_fs_t *fs,
        const char *path,
+       int jobs,
        svn_fs_pack_notify_t notify_func,
        void *notify_baton,
        svn_cancel_func_t cancel_func,
@@ -508,8 +563,18 @@ x_pack(svn_fs_t *fs,
        apr_pool_t *scratch_pool,
        apr_pool_t *common_pool)
 {
+  apr_array_header_t *worker_fss = NULL;
+
   SVN_ERR(x_open(fs, path, common_pool_lock, scratch_pool, common_pool));
-  return svn_fs_x__pack(fs, 0, notify_func, notify_baton,
+
+  /* Concurrent packing needs a private FS instance per worker thread. */
+#if APR_HAS_THREADS
+  if (jobs > 1)
+    SVN_ERR(open_worker_fss(&worker_fss, fs, path, jobs, common_pool_lock,
+                            scratch_pool, common_pool));
+#endif
+
+  return svn_fs_x__pack(fs, 0, worker_fss, notify_func, notify_baton,
                         cancel_func, cancel_baton, scratch_pool);
 }
 
@@ -667,7 +732,7 @@ svn_fs_x__init(const svn_version_t *loader_version,
                              loader_version->major);
   SVN_ERR(svn_ver_check_list2(x_version(), checklist, svn_ver_equal));
 
-  SVN_ERR(svn_fs_x__batch_fsync_init(common_pool));
+  SVN_ERR(svn_batch_fsync__init(common_pool));
 
   *vtable = &library_vtable;
   return SVN_NO_ERROR;
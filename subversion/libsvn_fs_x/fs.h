@@ -76,6 +76,8 @@ extern "C" {
                                                     to-log index */
 /* If you change this, look at tests/svn_test_fs.c(maybe_install_fsx_conf) */
 #define PATH_CONFIG           "fsx.conf"         /* Configuration */
+#define PATH_DAG_CACHE        "dag-cache"        /* Snapshot of path to
+                                                    node lookups */
 
 /* Names of special files and file extensions for transactions */
 #define PATH_CHANGES       "changes"       /* Records changes made so far */
@@ -554,6 +556,11 @@ typedef struct svn_fs_x__changes_context_t
   /* Has the end of the list been reached? */
   svn_boolean_t eol;
 
+  /* If set, the caller needs only the paths, change and node kinds as well
+     as the modification flags.  Copy-from info may then be reported as
+     unknown which saves us from decoding it from the string tables. */
+  svn_boolean_t paths_only;
+
 } svn_fs_x__changes_context_t;
 
 /*** Directory (only used at the cache interface) ***/
@@ -28,6 +28,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_temp_serializer.h"
+#include "private/svn_thread_pool.h"
 
 #include "fs_x.h"
 #include "pack.h"
@@ -244,7 +245,7 @@ initialize_pack_context(pack_context_t *context,
                         const char *shard_dir,
                         svn_revnum_t shard_rev,
                         int max_items,
-                        svn_fs_x__batch_fsync_t *batch,
+                        svn_batch_fsync__t *batch,
                         svn_cancel_func_t cancel_func,
                         void *cancel_baton,
                         apr_pool_t *pool)
@@ -274,8 +275,8 @@ initialize_pack_context(pack_context_t *context,
   context->pack_file_path
     = svn_dirent_join(pack_file_dir, PATH_PACKED, pool);
 
-  SVN_ERR(svn_fs_x__batch_fsync_open_file(&context->pack_file, batch,
-                                          context->pack_file_path, pool));
+  SVN_ERR(svn_batch_fsync__open_file(&context->pack_file, batch,
+                                     context->pack_file_path, pool));
 
   /* Proto index files */
   SVN_ERR(svn_fs_x__l2p_proto_index_open(
@@ -1919,7 +1920,7 @@ pack_log_addressed(svn_fs_t *fs,
                    const char *shard_dir,
                    svn_revnum_t shard_rev,
                    apr_size_t max_mem,
-                   svn_fs_x__batch_fsync_t *batch,
+                   svn_batch_fsync__t *batch,
                    svn_cancel_func_t cancel_func,
                    void *cancel_baton,
                    apr_pool_t *scratch_pool)
@@ -2019,7 +2020,7 @@ pack_rev_shard(svn_fs_t *fs,
                apr_int64_t shard,
                int max_files_per_dir,
                apr_size_t max_mem,
-               svn_fs_x__batch_fsync_t *batch,
+               svn_batch_fsync__t *batch,
                svn_cancel_func_t cancel_func,
                void *cancel_baton,
                apr_pool_t *scratch_pool)
@@ -2036,7 +2037,7 @@ pack_rev_shard(svn_fs_t *fs,
 
   /* Create the new directory and pack file. */
   SVN_ERR(svn_io_dir_make(pack_file_dir, APR_OS_DEFAULT, scratch_pool));
-  SVN_ERR(svn_fs_x__batch_fsync_new_path(batch, pack_file_dir, scratch_pool));
+  SVN_ERR(svn_batch_fsync__new_path(batch, pack_file_dir, scratch_pool));
 
   /* Index information files */
   SVN_ERR(pack_log_addressed(fs, pack_file_dir, shard_path, shard_rev,
@@ -2049,53 +2050,62 @@ pack_rev_shard(svn_fs_t *fs,
   return SVN_NO_ERROR;
 }
 
-/* In the file system at FS_PATH, pack the SHARD in DIR containing exactly
- * MAX_FILES_PER_DIR revisions, using SCRATCH_POOL temporary for allocations.
- * COMPRESSION_LEVEL and MAX_PACK_SIZE will be ignored in that case.
+/* Set *PACK_FILE_DIR and *SHARD_PATH to the packed and the non-packed
+ * directory of SHARD within DIR, respectively.  Allocate them in POOL.
+ */
+static void
+get_shard_paths(const char **pack_file_dir,
+                const char **shard_path,
+                const char *dir,
+                apr_int64_t shard,
+                apr_pool_t *pool)
+{
+  *pack_file_dir = svn_dirent_join(dir,
+                  apr_psprintf(pool,
+                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
+                               shard),
+                  pool);
+  *shard_path = svn_dirent_join(dir,
+                      apr_psprintf(pool, "%" APR_INT64_T_FMT, shard),
+                      pool);
+}
+
+/* In the file system at FS_PATH, build the packed representation of the
+ * SHARD in DIR containing exactly MAX_FILES_PER_DIR revisions, using
+ * SCRATCH_POOL temporary for allocations.  COMPRESSION_LEVEL and
+ * MAX_PACK_SIZE control how the revprops get packed.
  * An attempt will be made to keep memory usage below MAX_MEM.
  *
- * CANCEL_FUNC and CANCEL_BATON are what you think they are; similarly
- * NOTIFY_FUNC and NOTIFY_BATON.
+ * Upon success, all packed data will have been flushed to disk but the
+ * repository will not have been switched over to it, yet.
+ *
+ * CANCEL_FUNC and CANCEL_BATON are what you think they are.
  *
  * If for some reason we detect a partial packing already performed, we
  * remove the pack file and start again.
  */
 static svn_error_t *
-pack_shard(const char *dir,
-           svn_fs_t *fs,
-           apr_int64_t shard,
-           int max_files_per_dir,
-           apr_off_t max_pack_size,
-           int compression_level,
-           apr_size_t max_mem,
-           svn_fs_pack_notify_t notify_func,
-           void *notify_baton,
-           svn_cancel_func_t cancel_func,
-           void *cancel_baton,
-           apr_pool_t *scratch_pool)
+build_packed_shard(const char *dir,
+                   svn_fs_t *fs,
+                   apr_int64_t shard,
+                   int max_files_per_dir,
+                   apr_off_t max_pack_size,
+                   int compression_level,
+                   apr_size_t max_mem,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *scratch_pool)
 {
   svn_fs_x__data_t *ffd = fs->fsap_data;
   const char *shard_path, *pack_file_dir;
-  svn_fs_x__batch_fsync_t *batch;
-
-  /* Notify caller we're starting to pack this shard. */
-  if (notify_func)
-    SVN_ERR(notify_func(notify_baton, shard, svn_fs_pack_notify_start,
-                        scratch_pool));
+  svn_batch_fsync__t *batch;
 
   /* Perform all fsyncs through this instance. */
-  SVN_ERR(svn_fs_x__batch_fsync_create(&batch, ffd->flush_to_disk,
-                                       scratch_pool));
+  SVN_ERR(svn_batch_fsync__create(&batch, ffd->flush_to_disk,
+                                  scratch_pool));
 
   /* Some useful paths. */
-  pack_file_dir = svn_dirent_join(dir,
-                  apr_psprintf(scratch_pool,
-                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
-                               shard),
-                  scratch_pool);
-  shard_path = svn_dirent_join(dir,
-                      apr_psprintf(scratch_pool, "%" APR_INT64_T_FMT, shard),
-                      scratch_pool);
+  get_shard_paths(&pack_file_dir, &shard_path, dir, shard, scratch_pool);
 
   /* pack the revision content */
   SVN_ERR(pack_rev_shard(fs, pack_file_dir, shard_path,
@@ -2112,20 +2122,47 @@ pack_shard(const char *dir,
                                         cancel_func, cancel_baton,
                                         scratch_pool));
 
+  /* Ensure that packed file is written to disk.*/
+  SVN_ERR(svn_batch_fsync__run(batch, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* In the file system FS, switch the SHARD in DIR containing exactly
+ * MAX_FILES_PER_DIR revisions over to its packed representation, which
+ * must have been created by build_packed_shard() before.  Remove the
+ * non-packed shard afterwards.  Use SCRATCH_POOL temporary allocations.
+ *
+ * CANCEL_FUNC and CANCEL_BATON are what you think they are; similarly
+ * NOTIFY_FUNC and NOTIFY_BATON.
+ */
+static svn_error_t *
+switch_to_packed_shard(const char *dir,
+                       svn_fs_t *fs,
+                       apr_int64_t shard,
+                       int max_files_per_dir,
+                       svn_fs_pack_notify_t notify_func,
+                       void *notify_baton,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  const char *shard_path, *pack_file_dir;
+
+  get_shard_paths(&pack_file_dir, &shard_path, dir, shard, scratch_pool);
+
   /* Update the min-unpacked-rev file to reflect our newly packed shard. */
   SVN_ERR(svn_fs_x__write_min_unpacked_rev(fs,
                           (svn_revnum_t)((shard + 1) * max_files_per_dir),
                           scratch_pool));
   ffd->min_unpacked_rev = (svn_revnum_t)((shard + 1) * max_files_per_dir);
 
-  /* Ensure that packed file is written to disk.*/
-  SVN_ERR(svn_fs_x__batch_fsync_run(batch, scratch_pool));
-
   /* Finally, remove the existing shard directories. */
   SVN_ERR(svn_io_remove_dir2(shard_path, TRUE,
                              cancel_func, cancel_baton, scratch_pool));
 
-  /* Notify caller we're starting to pack this shard. */
+  /* Notify caller we're done packing this shard. */
   if (notify_func)
     SVN_ERR(notify_func(notify_baton, shard, svn_fs_pack_notify_end,
                         scratch_pool));
@@ -2133,6 +2170,47 @@ pack_shard(const char *dir,
   return SVN_NO_ERROR;
 }
 
+/* In the file system at FS_PATH, pack the SHARD in DIR containing exactly
+ * MAX_FILES_PER_DIR revisions, using SCRATCH_POOL temporary for allocations.
+ * COMPRESSION_LEVEL and MAX_PACK_SIZE will be ignored in that case.
+ * An attempt will be made to keep memory usage below MAX_MEM.
+ *
+ * CANCEL_FUNC and CANCEL_BATON are what you think they are; similarly
+ * NOTIFY_FUNC and NOTIFY_BATON.
+ *
+ * If for some reason we detect a partial packing already performed, we
+ * remove the pack file and start again.
+ */
+static svn_error_t *
+pack_shard(const char *dir,
+           svn_fs_t *fs,
+           apr_int64_t shard,
+           int max_files_per_dir,
+           apr_off_t max_pack_size,
+           int compression_level,
+           apr_size_t max_mem,
+           svn_fs_pack_notify_t notify_func,
+           void *notify_baton,
+           svn_cancel_func_t cancel_func,
+           void *cancel_baton,
+           apr_pool_t *scratch_pool)
+{
+  /* Notify caller we're starting to pack this shard. */
+  if (notify_func)
+    SVN_ERR(notify_func(notify_baton, shard, svn_fs_pack_notify_start,
+                        scratch_pool));
+
+  SVN_ERR(build_packed_shard(dir, fs, shard, max_files_per_dir,
+                             max_pack_size, compression_level, max_mem,
+                             cancel_func, cancel_baton, scratch_pool));
+
+  return svn_error_trace(switch_to_packed_shard(dir, fs, shard,
+                                                max_files_per_dir,
+                                                notify_func, notify_baton,
+                                                cancel_func, cancel_baton,
+                                                scratch_pool));
+}
+
 /* Read the youngest rev and the first non-packed rev info for FS from disk.
    Set *FULLY_PACKED when there is no completed unpacked shard.
    Use SCRATCH_POOL for temporary allocations.
@@ -2165,12 +2243,188 @@ typedef struct pack_baton_t
 {
   svn_fs_t *fs;
   apr_size_t max_mem;
+  apr_array_header_t *worker_fss;
   svn_fs_pack_notify_t notify_func;
   void *notify_baton;
   svn_cancel_func_t cancel_func;
   void *cancel_baton;
 } pack_baton_t;
 
+#if APR_HAS_THREADS
+
+/* Parameters shared by all shards of a concurrent pack run.  Read-only
+ * for the workers.
+ */
+typedef struct pack_workers_t
+{
+  /* Directory containing the shards. */
+  const char *data_path;
+
+  /* Pack parameters, see build_packed_shard(). */
+  int max_files_per_dir;
+  apr_off_t max_pack_size;
+  int compression_level;
+
+  /* Limit for the in-memory data structures of each worker. */
+  apr_size_t max_mem;
+} pack_workers_t;
+
+/* A single shard to be packed by one of the workers in a concurrent
+ * pack run.  See pack_concurrently().
+ */
+typedef struct shard_job_t
+{
+  /* The shared parameters. */
+  pack_workers_t *workers;
+
+  /* The shard to pack. */
+  apr_int64_t shard;
+
+  /* The job in the thread pool that builds the packed data for SHARD. */
+  svn_thread_pool__job_t *job;
+} shard_job_t;
+
+/* Implements svn_thread_pool__worker_init_t.  Let each worker use its
+ * own FS instance from the pack_baton_t given as BATON.
+ */
+static svn_error_t *
+get_worker_fs(void **worker_baton,
+              void *baton,
+              int worker_index,
+              apr_pool_t *worker_pool)
+{
+  pack_baton_t *pb = baton;
+  *worker_baton = APR_ARRAY_IDX(pb->worker_fss, worker_index, svn_fs_t *);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Build the packed data for the
+ * shard_job_t given as JOB_BATON, using the svn_fs_t given as
+ * WORKER_BATON.  The shard switch-over itself is left to the main thread.
+ */
+static svn_error_t *
+pack_shard_job(void *job_baton,
+               void *worker_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  shard_job_t *job = job_baton;
+  pack_workers_t *workers = job->workers;
+
+  return svn_error_trace(build_packed_shard(workers->data_path,
+                                            worker_baton, job->shard,
+                                            workers->max_files_per_dir,
+                                            workers->max_pack_size,
+                                            workers->compression_level,
+                                            workers->max_mem,
+                                            cancel_func, cancel_baton,
+                                            scratch_pool));
+}
+
+/* Pack the shards FIRST_SHARD up to but not including END_SHARD in
+ * DATA_PATH as described by PB.  Build the packed data concurrently, using
+ * one thread per element in PB->WORKER_FSS.  Each worker creates whole
+ * shards, so the result is the same as for a sequential pack run.
+ * Switch the shards over to the packed data strictly in ascending order,
+ * though, such that min-unpacked-rev always describes a consistent
+ * repository state.  Notifications and cancellation checks are run in the
+ * calling thread only.
+ *
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+pack_concurrently(pack_baton_t *pb,
+                  const char *data_path,
+                  apr_int64_t first_shard,
+                  apr_int64_t end_shard,
+                  apr_pool_t *scratch_pool)
+{
+  svn_fs_x__data_t *ffd = pb->fs->fsap_data;
+  pack_workers_t workers = { 0 };
+  svn_thread_pool__t *thread_pool;
+  shard_job_t *jobs;
+  int job_count = (int)(end_shard - first_shard);
+  int i;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  workers.data_path = data_path;
+  workers.max_files_per_dir = ffd->max_files_per_dir;
+  workers.max_pack_size = ffd->revprop_pack_size;
+  workers.compression_level = ffd->compress_packed_revprops
+                            ? SVN__COMPRESSION_ZLIB_DEFAULT
+                            : SVN__COMPRESSION_NONE;
+  workers.max_mem = pb->max_mem / pb->worker_fss->nelts;
+
+  /* More threads than shards would be pointless. */
+  SVN_ERR(svn_thread_pool__create(&thread_pool,
+                                  MIN(pb->worker_fss->nelts, job_count),
+                                  get_worker_fs, pb, scratch_pool));
+
+  jobs = apr_pcalloc(scratch_pool, job_count * sizeof(*jobs));
+  for (i = 0; i < job_count && !err; ++i)
+    {
+      shard_job_t *job = &jobs[i];
+
+      job->workers = &workers;
+      job->shard = first_shard + i;
+      err = svn_thread_pool__submit(&job->job, thread_pool, pack_shard_job,
+                                    job);
+    }
+
+  /* Switch the shards over as soon as their packed data becomes
+     available. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < job_count && !err; ++i)
+    {
+      shard_job_t *job = &jobs[i];
+
+      svn_pool_clear(iterpool);
+
+      if (pb->cancel_func)
+        {
+          err = pb->cancel_func(pb->cancel_baton);
+          if (err)
+            break;
+        }
+
+      /* Notify caller we're starting to pack this shard. */
+      if (pb->notify_func)
+        {
+          err = pb->notify_func(pb->notify_baton, job->shard,
+                                svn_fs_pack_notify_start, iterpool);
+          if (err)
+            break;
+        }
+
+      err = svn_thread_pool__wait(thread_pool, job->job,
+                                  pb->cancel_func, pb->cancel_baton);
+      if (err)
+        break;
+
+      err = switch_to_packed_shard(data_path, pb->fs, job->shard,
+                                   ffd->max_files_per_dir,
+                                   pb->notify_func, pb->notify_baton,
+                                   pb->cancel_func, pb->cancel_baton,
+                                   iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Stop all workers that may still be running and wait for them.
+     Packed data of shards that we did not switch over is simply going
+     to be rebuilt by the next pack run.  Their build results, including
+     the cancellation errors due to our abort, are irrelevant. */
+  err = svn_error_compose_create(err,
+                                 svn_thread_pool__join(thread_pool, TRUE));
+
+  return svn_error_trace(err);
+}
+
+#endif
+
 
 /* The work-horse for svn_fs_x__pack, called with the FS write lock.
    This implements the svn_fs_x__with_write_lock() 'body' callback
@@ -2214,6 +2468,15 @@ pack_body(void *baton,
   completed_shards = (ffd->youngest_rev_cache + 1) / ffd->max_files_per_dir;
   data_path = svn_dirent_join(pb->fs->path, PATH_REVS_DIR, scratch_pool);
 
+#if APR_HAS_THREADS
+  /* Concurrent packing only makes sense for more than one shard. */
+  if (   pb->worker_fss && pb->worker_fss->nelts > 1
+      && completed_shards - ffd->min_unpacked_rev / ffd->max_files_per_dir > 1)
+    return svn_error_trace(pack_concurrently(pb, data_path,
+                             ffd->min_unpacked_rev / ffd->max_files_per_dir,
+                             completed_shards, scratch_pool));
+#endif
+
   iterpool = svn_pool_create(scratch_pool);
   for (i = ffd->min_unpacked_rev / ffd->max_files_per_dir;
        i < completed_shards;
@@ -2242,6 +2505,7 @@ pack_body(void *baton,
 svn_error_t *
 svn_fs_x__pack(svn_fs_t *fs,
                apr_size_t max_mem,
+               apr_array_header_t *worker_fss,
                svn_fs_pack_notify_t notify_func,
                void *notify_baton,
                svn_cancel_func_t cancel_func,
@@ -2272,6 +2536,7 @@ svn_fs_x__pack(svn_fs_t *fs,
   pb.cancel_func = cancel_func;
   pb.cancel_baton = cancel_baton;
   pb.max_mem = max_mem ? max_mem : DEFAULT_MAX_MEM;
+  pb.worker_fss = worker_fss;
 
   return svn_fs_x__with_pack_lock(fs, pack_body, &pb, scratch_pool);
 }
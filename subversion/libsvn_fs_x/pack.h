@@ -32,6 +32,15 @@
    MAX_MEM limits the size of in-memory data structures needed for reordering
    items.  0 means use the built-in default.
 
+   WORKER_FSS may be NULL or an array of svn_fs_t * with further instances
+   of the same repository, each one exclusively owned by this call and
+   allocated in its own root pool.  If it contains more than one element,
+   the packed data for that many shards will be built concurrently, each
+   in a separate thread using one of those FS instances.  The result is
+   the same as for a sequential pack.  MAX_MEM will be split evenly
+   between the workers.
+
+   If given, NOTIFY_FUNC will be called with NOTIFY_BATON to report progress.
    Use optional CANCEL_FUNC/CANCEL_BATON for cancellation support.
    Use SCRATCH_POOL for temporary allocations.
 
@@ -39,6 +48,7 @@
 svn_error_t *
 svn_fs_x__pack(svn_fs_t *fs,
                apr_size_t max_mem,
+               apr_array_header_t *worker_fss,
                svn_fs_pack_notify_t notify_func,
                void *notify_baton,
                svn_cancel_func_t cancel_func,
@@ -514,6 +514,17 @@ svn_fs_x__rev_file_read(svn_fs_x__revision_file_t *file,
                                                 NULL, NULL, file->pool));
 }
 
+svn_error_t *
+svn_fs_x__rev_file_prefetch(svn_fs_x__revision_file_t *file,
+                            apr_off_t offset,
+                            apr_off_t length)
+{
+  SVN_ERR(auto_open(file));
+  svn_io__file_prefetch(file->file, offset, length);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_x__close_revision_file(svn_fs_x__revision_file_t *file)
 {
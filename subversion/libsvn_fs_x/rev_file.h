@@ -191,6 +191,12 @@ svn_fs_x__rev_file_read(svn_fs_x__revision_file_t *file,
                         void *buf,
                         apr_size_t nbytes);
 
+/* Convenience wrapper around svn_io__file_prefetch. */
+svn_error_t *
+svn_fs_x__rev_file_prefetch(svn_fs_x__revision_file_t *file,
+                            apr_off_t offset,
+                            apr_off_t length);
+
 /* Close all files and streams in FILE.  They will be reopened automatically
  * by any of the above access functions.
  */
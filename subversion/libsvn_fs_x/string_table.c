@@ -170,6 +170,26 @@ match_length(const svn_string_t *lhs,
   return (apr_uint16_t)svn_cstring__match_length(lhs->data, rhs->data, len);
 }
 
+/* Compare LHS and RHS like strcmp() would.  Path strings tend to share
+ * long prefixes, so skip those chunky with svn_cstring__match_length()
+ * instead of comparing them byte by byte.
+ */
+static int
+compare_strings(const svn_string_t *lhs,
+                const svn_string_t *rhs)
+{
+  apr_size_t len = MIN(lhs->len, rhs->len);
+  apr_size_t pos = svn_cstring__match_length(lhs->data, rhs->data, len);
+
+  /* Short strings never contain NULs, so the terminator of the shorter
+     string will take the place of the first mismatch. */
+  if (pos == len)
+    return lhs->len == rhs->len ? 0 : (lhs->len < rhs->len ? -1 : 1);
+
+  return (int)(unsigned char)lhs->data[pos]
+       - (int)(unsigned char)rhs->data[pos];
+}
+
 static apr_uint16_t
 insert_string(builder_table_t *table,
               builder_string_t **parent,
@@ -177,7 +197,7 @@ insert_string(builder_table_t *table,
 {
   apr_uint16_t result;
   builder_string_t *current = *parent;
-  int diff = strcmp(current->string.data, to_insert->string.data);
+  int diff = compare_strings(&current->string, &to_insert->string);
   if (diff == 0)
     {
       apr_array_pop(table->short_strings);
@@ -1251,7 +1251,7 @@ svn_fs_x__commit_txn(const char **conflict_p,
 
   if (ffd->pack_after_commit)
     {
-      SVN_ERR(svn_fs_x__pack(fs, 0, NULL, NULL, NULL, NULL, pool));
+      SVN_ERR(svn_fs_x__pack(fs, 0, NULL, NULL, NULL, NULL, NULL, pool));
     }
 
   return SVN_NO_ERROR;
@@ -3229,6 +3229,7 @@ static root_vtable_t root_vtable = {
   x_get_file_delta_stream,
   x_merge,
   x_get_mergeinfo,
+  NULL,
 };
 
 /* Construct a new root object in FS, allocated from RESULT_POOL.  */
@@ -25,7 +25,7 @@
 
 #include "svn_fs.h"
 #include "id.h"
-#include "batch_fsync.h"
+#include "private/svn_batch_fsync.h"
 
 /* Functions for dealing with recoverable errors on mutable files
  *
@@ -300,6 +300,13 @@ const char *
 svn_fs_x__path_min_unpacked_rev(svn_fs_t *fs,
                                 apr_pool_t *result_pool);
 
+/* Return the path of the DAG cache snapshot file in FS.
+ * The result will be allocated in RESULT_POOL.
+ */
+const char *
+svn_fs_x__path_dag_cache(svn_fs_t *fs,
+                         apr_pool_t *result_pool);
+
 /* Return the path of the file containing item_index counter for
  * the transaction identified by TXN_ID in FS.
  * The result will be allocated in RESULT_POOL.
@@ -454,7 +461,7 @@ svn_error_t *
 svn_fs_x__move_into_place(const char *old_filename,
                           const char *new_filename,
                           const char *perms_reference,
-                          svn_fs_x__batch_fsync_t *batch,
+                          svn_batch_fsync__t *batch,
                           apr_pool_t *scratch_pool);
 
 #endif
@@ -944,6 +944,48 @@ svn_error_t *svn_ra_stat(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_stat_many(svn_ra_session_t *session,
+                 apr_hash_t **dirents,
+                 const apr_array_header_t *paths,
+                 svn_revnum_t revision,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool;
+  int i;
+
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      SVN_ERR_ASSERT(svn_relpath_is_canonical(path));
+    }
+
+  if (session->vtable->stat_many)
+    return svn_error_trace(session->vtable->stat_many(session, dirents,
+                                                      paths, revision,
+                                                      result_pool,
+                                                      scratch_pool));
+
+  *dirents = apr_hash_make(result_pool);
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_dirent_t *dirent;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_ra_stat(session, path, revision, &dirent, iterpool));
+      if (dirent)
+        svn_hash_sets(*dirents, apr_pstrdup(result_pool, path),
+                      svn_dirent_dup(dirent, result_pool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *svn_ra_get_uuid2(svn_ra_session_t *session,
                               const char **uuid,
                               apr_pool_t *pool)
@@ -1068,6 +1110,34 @@ svn_error_t *svn_ra_get_file_revs2(svn_ra_session_t *session,
   return svn_error_trace(err);
 }
 
+svn_error_t *
+svn_ra_blame(svn_ra_session_t *session,
+             const char *path,
+             svn_revnum_t start,
+             svn_revnum_t end,
+             const svn_diff_file_options_t *diff_options,
+             svn_blame_run_receiver_t receiver,
+             void *receiver_baton,
+             apr_pool_t *scratch_pool)
+{
+  SVN_ERR_ASSERT(svn_relpath_is_canonical(path));
+
+  if (!session->vtable->blame)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL, NULL);
+
+  SVN_ERR(svn_ra__assert_capable_server(session, SVN_RA_CAPABILITY_BLAME,
+                                        NULL, scratch_pool));
+
+  if (SVN_IS_VALID_REVNUM(start) && SVN_IS_VALID_REVNUM(end)
+      && start > end)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL, NULL);
+
+  return svn_error_trace(session->vtable->blame(session, path, start, end,
+                                                diff_options, receiver,
+                                                receiver_baton,
+                                                scratch_pool));
+}
+
 svn_error_t *svn_ra_lock(svn_ra_session_t *session,
                          apr_hash_t *path_revs,
                          const char *comment,
@@ -345,6 +345,26 @@ typedef struct svn_ra__vtable_t {
                        void *receiver_baton,
                        apr_pool_t *scratch_pool);
 
+  /* See svn_ra_stat_many().  If NULL, the RA loader calls stat() for
+     each path instead. */
+  svn_error_t *(*stat_many)(svn_ra_session_t *session,
+                            apr_hash_t **dirents,
+                            const apr_array_header_t *paths,
+                            svn_revnum_t revision,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
+  /* See svn_ra_blame().  May be NULL if the RA layer can't ask the
+     server for it. */
+  svn_error_t *(*blame)(svn_ra_session_t *session,
+                        const char *path,
+                        svn_revnum_t start,
+                        svn_revnum_t end,
+                        const svn_diff_file_options_t *diff_options,
+                        svn_blame_run_receiver_t receiver,
+                        void *receiver_baton,
+                        apr_pool_t *scratch_pool);
+
   /* Experimental support below here */
 
   /* See svn_ra__register_editor_shim_callbacks() */
@@ -734,6 +734,25 @@ svn_ra_local__get_file_revs(svn_ra_session_t *session,
                                   handler, handler_baton, pool);
 }
 
+static svn_error_t *
+svn_ra_local__blame(svn_ra_session_t *session,
+                    const char *path,
+                    svn_revnum_t start,
+                    svn_revnum_t end,
+                    const svn_diff_file_options_t *diff_options,
+                    svn_blame_run_receiver_t receiver,
+                    void *receiver_baton,
+                    apr_pool_t *scratch_pool)
+{
+  svn_ra_local__session_baton_t *sess = session->priv;
+  const char *abs_path = svn_fspath__join(sess->fs_path->data, path,
+                                          scratch_pool);
+  return svn_repos_blame(sess->repos, abs_path, start, end, diff_options,
+                         NULL, NULL, receiver, receiver_baton,
+                         sess->callbacks ? sess->callbacks->cancel_func : NULL,
+                         sess->callback_baton, scratch_pool);
+}
+
 static svn_error_t *
 svn_ra_local__get_dated_revision(svn_ra_session_t *session,
                                  svn_revnum_t *revision,
@@ -1676,6 +1695,7 @@ svn_ra_local__has_capability(svn_ra_session_t *session,
       || strcmp(capability, SVN_RA_CAPABILITY_EPHEMERAL_TXNPROPS) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_LIST) == 0
+      || strcmp(capability, SVN_RA_CAPABILITY_BLAME) == 0
       )
     {
       *has = TRUE;
@@ -1917,6 +1937,8 @@ static const svn_ra__vtable_t ra_local_vtable =
   svn_ra_local__get_inherited_props,
   NULL /* set_svn_ra_open */,
   svn_ra_local__list ,
+  NULL /* stat_many */,
+  svn_ra_local__blame,
   svn_ra_local__register_editor_shim_callbacks,
   svn_ra_local__get_commit_ev2,
   NULL /* replay_range_ev2 */
@@ -64,6 +64,14 @@ typedef struct commit_context_t {
   /* HTTP v2 stuff */
   const char *txn_url;           /* txn URL (!svn/txn/TXN_NAME) */
   const char *txn_root_url;      /* commit anchor txn root URL */
+  const char *txn_name_header;   /* header naming the txn in a POST... */
+  const char *txn_name;          /* ...and its value */
+
+  /* HTTP v2 "apply-txn" POST stuff (only used when 'bulk_pool' is set) */
+  const char *base_relpath;      /* commit anchor, relative to repos root */
+  apr_pool_t *bulk_pool;         /* holds the queued operations */
+  svn_skel_t *bulk_ops;          /* queued operations, or NULL */
+  apr_size_t bulk_size;          /* approximate size of BULK_OPS */
 
   /* HTTP v1 stuff (only valid when 'txn_url' is NULL) */
   const char *activity_url;      /* activity base URL... */
@@ -76,6 +84,12 @@ typedef struct commit_context_t {
 
 #define USING_HTTPV2_COMMIT_SUPPORT(commit_ctx) ((commit_ctx)->txn_url != NULL)
 
+/* Queued file changes are sent to the server in an "apply-txn" POST
+   once they amount to about this many bytes.  Keep this well below
+   mod_dav_svn's default LimitXMLRequestBody, which applies to POST
+   bodies, too. */
+#define BULK_COMMIT_MAX_SIZE (512 * 1024)
+
 /* Structure associated with a PROPPATCH request. */
 typedef struct proppatch_context_t {
   apr_pool_t *pool;
@@ -1178,6 +1192,8 @@ post_headers_iterator_callback(void *baton,
         svn_path_url_add_component2(sess->txn_stub, val, prc_cc->pool);
       prc_cc->txn_root_url =
         svn_path_url_add_component2(sess->txn_root_stub, val, prc_cc->pool);
+      prc_cc->txn_name_header = SVN_DAV_TXN_NAME_HEADER;
+      prc_cc->txn_name = apr_pstrdup(prc_cc->pool, val);
     }
 
   if (svn_cstring_casecmp(key, SVN_DAV_VTXN_NAME_HEADER) == 0)
@@ -1188,6 +1204,8 @@ post_headers_iterator_callback(void *baton,
         svn_path_url_add_component2(sess->vtxn_stub, val, prc_cc->pool);
       prc_cc->txn_root_url =
         svn_path_url_add_component2(sess->vtxn_root_stub, val, prc_cc->pool);
+      prc_cc->txn_name_header = SVN_DAV_VTXN_NAME_HEADER;
+      prc_cc->txn_name = apr_pstrdup(prc_cc->pool, val);
     }
 
   return 0;
@@ -1216,6 +1234,201 @@ post_response_handler(serf_request_t *request,
                                         prc->handler, scratch_pool);
 }
 
+/* Implements svn_ra_serf__request_body_delegate_t */
+static svn_error_t *
+create_apply_txn_body(serf_bucket_t **body_bkt,
+                      void *baton,
+                      serf_bucket_alloc_t *alloc,
+                      apr_pool_t *pool /* request pool */,
+                      apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *skel_str = baton;
+
+  *body_bkt = SERF_BUCKET_SIMPLE_STRING_LEN(skel_str->data, skel_str->len,
+                                            alloc);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_header_delegate_t */
+static svn_error_t *
+setup_apply_txn_headers(serf_bucket_t *headers,
+                        void *baton,
+                        apr_pool_t *pool /* request pool */,
+                        apr_pool_t *scratch_pool)
+{
+  commit_context_t *commit_ctx = baton;
+
+  serf_bucket_headers_set(headers, commit_ctx->txn_name_header,
+                          commit_ctx->txn_name);
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the operations queued in COMMIT_CTX to the server in a single
+   "apply-txn" POST, if there are any. */
+static svn_error_t *
+flush_bulk_ops(commit_context_t *commit_ctx,
+               apr_pool_t *scratch_pool)
+{
+  svn_ra_serf__handler_t *handler;
+  svn_stringbuf_t *skel_str;
+
+  if (! commit_ctx->bulk_ops)
+    return SVN_NO_ERROR;
+
+  svn_skel__prepend_str("apply-txn", commit_ctx->bulk_ops,
+                        commit_ctx->bulk_pool);
+  skel_str = svn_skel__unparse(commit_ctx->bulk_ops, commit_ctx->bulk_pool);
+
+  handler = svn_ra_serf__create_handler(commit_ctx->session, scratch_pool);
+
+  handler->method = "POST";
+  handler->path = commit_ctx->session->me_resource;
+  handler->body_type = SVN_SKEL_MIME_TYPE;
+  handler->body_delegate = create_apply_txn_body;
+  handler->body_delegate_baton = skel_str;
+  handler->header_delegate = setup_apply_txn_headers;
+  handler->header_delegate_baton = commit_ctx;
+
+  handler->response_handler = svn_ra_serf__expect_empty_body;
+  handler->response_baton = handler;
+
+  SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
+
+  if (handler->sline.code != 204)
+    return svn_error_trace(svn_ra_serf__unexpected_status(handler));
+
+  svn_pool_clear(commit_ctx->bulk_pool);
+  commit_ctx->bulk_ops = NULL;
+  commit_ctx->bulk_size = 0;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return an atom holding REVISION, or an empty atom if it is invalid,
+   allocated in POOL. */
+static svn_skel_t *
+revnum_atom(svn_revnum_t revision,
+            apr_pool_t *pool)
+{
+  if (! SVN_IS_VALID_REVNUM(revision))
+    return svn_skel__mem_atom("", 0, pool);
+
+  return svn_skel__str_atom(apr_psprintf(pool, "%ld", revision), pool);
+}
+
+/* Return an atom holding a copy of STR, or an empty atom if STR is NULL,
+   allocated in POOL. */
+static svn_skel_t *
+cstring_atom(const char *str,
+             apr_pool_t *pool)
+{
+  return svn_skel__str_atom(str ? apr_pstrdup(pool, str) : "", pool);
+}
+
+/* Queue the text and property changes of FILE, which has been closed,
+   for an "apply-txn" POST instead of sending a PUT and PROPPATCH.  If
+   PUT_EMPTY_FILE is set, the file has been added without text.  Set
+   *QUEUED to FALSE, and queue nothing, if the changes are too large to
+   be batched. */
+static svn_error_t *
+queue_file_changes(svn_boolean_t *queued,
+                   file_context_t *file,
+                   svn_boolean_t put_empty_file,
+                   apr_pool_t *scratch_pool)
+{
+  commit_context_t *commit_ctx = file->commit_ctx;
+  apr_pool_t *pool = commit_ctx->bulk_pool;
+  const char *svndiff = "";
+  apr_size_t svndiff_len = 0;
+  const char *repos_fspath;
+  svn_skel_t *put_skel = NULL;
+  svn_skel_t *props_skel = NULL;
+  apr_size_t size;
+
+  *queued = FALSE;
+
+  if (file->svndiff
+      && !svn_ra_serf__request_body_get_data(&svndiff, &svndiff_len,
+                                             file->svndiff))
+    return SVN_NO_ERROR;
+
+  /* Flush first, so that this file's changes fit in what is left. */
+  size = svndiff_len + strlen(file->relpath);
+  if (commit_ctx->bulk_ops && commit_ctx->bulk_size + size
+                              > BULK_COMMIT_MAX_SIZE)
+    SVN_ERR(flush_bulk_ops(commit_ctx, scratch_pool));
+
+  repos_fspath = svn_fspath__join("/",
+                                  svn_relpath_join(commit_ctx->base_relpath,
+                                                   file->relpath,
+                                                   scratch_pool),
+                                  pool);
+
+  if (file->svndiff || put_empty_file)
+    {
+      put_skel = svn_skel__make_empty_list(pool);
+      svn_skel__prepend(svn_skel__mem_atom(apr_pmemdup(pool, svndiff,
+                                                       svndiff_len),
+                                           svndiff_len, pool),
+                        put_skel);
+      svn_skel__prepend(cstring_atom(file->result_checksum, pool), put_skel);
+      svn_skel__prepend(cstring_atom(file->base_checksum, pool), put_skel);
+      svn_skel__prepend(revnum_atom(file->base_revision, pool), put_skel);
+      svn_skel__prepend_str(repos_fspath, put_skel, pool);
+      svn_skel__prepend_str("put", put_skel, pool);
+    }
+
+  if (apr_hash_count(file->prop_changes))
+    {
+      apr_hash_t *set_props = apr_hash_make(pool);
+      svn_skel_t *set_skel;
+      svn_skel_t *del_skel = svn_skel__make_empty_list(pool);
+      apr_hash_index_t *hi;
+
+      for (hi = apr_hash_first(scratch_pool, file->prop_changes);
+           hi;
+           hi = apr_hash_next(hi))
+        {
+          const svn_prop_t *prop = apr_hash_this_val(hi);
+          const char *name = apr_pstrdup(pool, prop->name);
+
+          if (prop->value)
+            svn_hash_sets(set_props, name, svn_string_dup(prop->value, pool));
+          else
+            svn_skel__prepend_str(name, del_skel, pool);
+
+          size += strlen(name) + (prop->value ? prop->value->len : 0);
+        }
+
+      SVN_ERR(svn_skel__unparse_proplist(&set_skel, set_props, pool));
+
+      props_skel = svn_skel__make_empty_list(pool);
+      svn_skel__prepend(del_skel, props_skel);
+      svn_skel__prepend(set_skel, props_skel);
+      svn_skel__prepend(revnum_atom(file->base_revision, pool), props_skel);
+      svn_skel__prepend_str(repos_fspath, props_skel, pool);
+      svn_skel__prepend_str("props", props_skel, pool);
+    }
+
+  if (! commit_ctx->bulk_ops)
+    commit_ctx->bulk_ops = svn_skel__make_empty_list(pool);
+
+  /* A new file must exist before its properties can be set. */
+  if (put_skel)
+    svn_skel__append(commit_ctx->bulk_ops, put_skel);
+  if (props_skel)
+    svn_skel__append(commit_ctx->bulk_ops, props_skel);
+
+  commit_ctx->bulk_size += size;
+  *queued = TRUE;
+
+  if (commit_ctx->bulk_size > BULK_COMMIT_MAX_SIZE)
+    SVN_ERR(flush_bulk_ops(commit_ctx, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* Commit baton callbacks */
@@ -1285,6 +1498,14 @@ open_root(void *edit_baton,
                                         commit_ctx->txn_root_url,
                                         rel_path, commit_ctx->pool);
 
+      /* If the server can take many file changes in one POST, batch
+         them.  Lock tokens can only be sent per path, though. */
+      if (svn_hash_gets(commit_ctx->session->supported_posts, "apply-txn")
+          && commit_ctx->txn_name
+          && commit_ctx->base_relpath
+          && !commit_ctx->lock_tokens)
+        commit_ctx->bulk_pool = svn_pool_create(commit_ctx->pool);
+
       /* Build our directory baton. */
       dir = apr_pcalloc(dir_pool, sizeof(*dir));
       dir->pool = dir_pool;
@@ -1873,7 +2094,15 @@ negotiate_put_encoding(int *svndiff_version_p,
   int svndiff_version;
   int compression_level;
 
-  if (session->using_compression == svn_tristate_unknown)
+  if (session->using_compression != svn_tristate_false
+      && session->supports_svndiff3)
+    {
+      /* Svndiff3 is both faster and compresses better than svndiff1,
+       * so use it whenever compression is enabled and the server can
+       * handle it.  SUPPORTS_SVNDIFF3 implies local Zstandard support. */
+      svndiff_version = 3;
+    }
+  else if (session->using_compression == svn_tristate_unknown)
     {
       /* With http-compression=auto, prefer svndiff2 to svndiff1 with a
        * low latency connection (assuming the underlying network has high
@@ -2062,6 +2291,25 @@ apply_textdelta_stream(const svn_delta_editor_t *editor,
   int expected_result;
   svn_error_t *err;
 
+  /* When batching, collect the svndiff like apply_textdelta() does and
+   * leave it to close_file() to queue it, or to PUT it if it is large. */
+  if (ctx->commit_ctx->bulk_pool)
+    {
+      svn_txdelta_stream_t *txdelta_stream;
+      svn_txdelta_window_handler_t window_handler;
+      void *window_baton;
+
+      SVN_ERR(apply_textdelta(file_baton, base_checksum, scratch_pool,
+                              &window_handler, &window_baton));
+      SVN_ERR(open_func(&txdelta_stream, open_baton, scratch_pool,
+                        scratch_pool));
+
+      return svn_error_trace(svn_txdelta_send_txstream(txdelta_stream,
+                                                       window_handler,
+                                                       window_baton,
+                                                       scratch_pool));
+    }
+
   /* Remember that we have sent the svndiff.  A case when we need to
    * perform a zero-byte file PUT (during add_file, close_file editor
    * sequences) is handled in close_file().
@@ -2149,6 +2397,27 @@ close_file(void *file_baton,
   if ((!ctx->svndiff) && ctx->added && (!ctx->copy_path))
     put_empty_file = TRUE;
 
+  if (ctx->svndiff && !ctx->svndiff_sent)
+    SVN_ERR(svn_stream_close(ctx->stream));
+
+  /* Small changes are better batched with those of other files. */
+  if (ctx->commit_ctx->bulk_pool && !ctx->svndiff_sent)
+    {
+      svn_boolean_t queued;
+
+      SVN_ERR(queue_file_changes(&queued, ctx, put_empty_file,
+                                 scratch_pool));
+      if (queued)
+        {
+          if (ctx->svndiff)
+            SVN_ERR(svn_ra_serf__request_body_cleanup(ctx->svndiff,
+                                                      scratch_pool));
+
+          ctx->commit_ctx->open_batons--;
+          return SVN_NO_ERROR;
+        }
+    }
+
   /* If we have a stream of changes, push them to the server... */
   if ((ctx->svndiff || put_empty_file) && !ctx->svndiff_sent)
     {
@@ -2172,8 +2441,6 @@ close_file(void *file_baton,
         }
       else
         {
-          SVN_ERR(svn_stream_close(ctx->stream));
-
           svn_ra_serf__request_body_get_delegate(&handler->body_delegate,
                                                  &handler->body_delegate_baton,
                                                  ctx->svndiff);
@@ -2251,6 +2518,9 @@ close_edit(void *edit_baton,
               SVN_ERR_FS_INCORRECT_EDITOR_COMPLETION, NULL,
               _("Closing editor with directories or files open"));
 
+  if (ctx->bulk_pool)
+    SVN_ERR(flush_bulk_ops(ctx, pool));
+
   /* MERGE our activity */
   SVN_ERR(svn_ra_serf__run_merge(&commit_info,
                                  ctx->session,
@@ -2419,6 +2689,7 @@ svn_ra_serf__get_commit_editor(svn_ra_session_t *ra_session,
   SVN_ERR(svn_ra_serf__get_repos_root(ra_session, &repos_root, pool));
   base_relpath = svn_uri_skip_ancestor(repos_root, session->session_url_str,
                                        pool);
+  ctx->base_relpath = base_relpath;
 
   SVN_ERR(svn_editor__insert_shims(ret_editor, edit_baton, *ret_editor,
                                    *edit_baton, repos_root, base_relpath,
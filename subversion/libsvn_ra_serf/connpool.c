@@ -0,0 +1,278 @@
+/*
+ * connpool.c: keep serf connections open across ra_serf sessions
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_time.h>
+
+#include <serf.h>
+
+#include "svn_pools.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+
+#include "ra_serf.h"
+
+/* Contexts that have been idle for longer than this are not reused;
+   the server has most likely closed their connections by then. */
+#define MAX_PARKED_IDLE apr_time_from_sec(30)
+
+/* The maximum number of contexts kept open at any time. */
+#define MAX_PARKED 8
+
+/* A serf context, and its connections, left behind by a closed session. */
+typedef struct parked_context_t
+{
+  /* The svn_ra_serf__session_t.conn_pool_key of that session. */
+  const char *key;
+
+  /* Owns this structure and everything it refers to. */
+  apr_pool_t *pool;
+
+  serf_context_t *context;
+  svn_ra_serf__connection_t *conns[SVN_RA_SERF__MAX_CONNECTIONS_LIMIT];
+  int num_conns;
+
+  /* When the session was closed. */
+  apr_time_t parked;
+
+  /* The next younger context. */
+  struct parked_context_t *next;
+} parked_context_t;
+
+/* All parked contexts of this process, oldest first, and their number.
+   Access is serialized by PARKED_MUTEX. */
+static parked_context_t *parked_contexts = NULL;
+static int num_parked = 0;
+static svn_mutex__t *parked_mutex = NULL;
+static volatile svn_atomic_t parked_init_state = 0;
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+init_parked(void *baton, apr_pool_t *pool)
+{
+  /* The mutex lives as long as the process does. */
+  SVN_ERR(svn_mutex__init(&parked_mutex, TRUE, svn_pool_create(NULL)));
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove the youngest parked context with KEY from the list and return
+   it in *PARKED, or set *PARKED to NULL if there is none.  Drop parked
+   contexts that have been idle for too long.  Call with PARKED_MUTEX
+   held. */
+static svn_error_t *
+unpark(parked_context_t **parked,
+       const char *key)
+{
+  parked_context_t **prev = &parked_contexts;
+  parked_context_t **match = NULL;
+  apr_time_t now = apr_time_now();
+
+  while (*prev)
+    {
+      parked_context_t *entry = *prev;
+
+      if (now - entry->parked > MAX_PARKED_IDLE)
+        {
+          *prev = entry->next;
+          num_parked--;
+          svn_pool_destroy(entry->pool);
+          continue;
+        }
+
+      if (strcmp(entry->key, key) == 0)
+        match = prev;
+
+      prev = &entry->next;
+    }
+
+  *parked = NULL;
+  if (match)
+    {
+      *parked = *match;
+      *match = (*parked)->next;
+      (*parked)->next = NULL;
+      num_parked--;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Append PARKED to the list, dropping the oldest context if there are
+   too many.  Call with PARKED_MUTEX held. */
+static svn_error_t *
+park(parked_context_t *parked)
+{
+  parked_context_t **prev = &parked_contexts;
+
+  while (*prev)
+    prev = &(*prev)->next;
+  *prev = parked;
+  num_parked++;
+
+  if (num_parked > MAX_PARKED)
+    {
+      parked_context_t *oldest = parked_contexts;
+
+      parked_contexts = oldest->next;
+      num_parked--;
+      svn_pool_destroy(oldest->pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup handler for the pool of session BATON.  Keep its serf
+   context open for later sessions, if its connections are in a state
+   another session can pick up; otherwise close them. */
+static apr_status_t
+park_context(void *baton)
+{
+  svn_ra_serf__session_t *session = baton;
+  svn_boolean_t reusable;
+  int i;
+
+  /* Requests multiplexed over HTTP/2 and requests that didn't complete
+     leave state behind that the next session wouldn't expect. */
+  reusable = (session->num_conns > 0
+              && !session->http20
+              && !session->pending_error);
+  for (i = 0; reusable && i < session->num_conns; i++)
+    if (serf_connection_pending_requests(session->conns[i]->conn))
+      reusable = FALSE;
+
+  if (reusable)
+    {
+      parked_context_t *parked = apr_pcalloc(session->conn_pool,
+                                             sizeof(*parked));
+      svn_error_t *err;
+
+      parked->key = apr_pstrdup(session->conn_pool, session->conn_pool_key);
+      parked->pool = session->conn_pool;
+      parked->context = session->context;
+      parked->num_conns = session->num_conns;
+      for (i = 0; i < session->num_conns; i++)
+        parked->conns[i] = session->conns[i];
+      parked->parked = apr_time_now();
+
+      err = svn_mutex__lock(parked_mutex);
+      if (!err)
+        err = svn_mutex__unlock(parked_mutex, park(parked));
+
+      if (!err)
+        return APR_SUCCESS;
+
+      svn_error_clear(err);
+    }
+
+  svn_pool_destroy(session->conn_pool);
+
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_ra_serf__conn_pool_open(svn_ra_serf__session_t *session,
+                            svn_boolean_t reuse_parked,
+                            apr_pool_t *scratch_pool)
+{
+  parked_context_t *parked = NULL;
+  int i;
+
+  if (session->conn_pool_key)
+    {
+      SVN_ERR(svn_atomic__init_once(&parked_init_state, init_parked, NULL,
+                                    scratch_pool));
+      if (reuse_parked)
+        SVN_MUTEX__WITH_LOCK(parked_mutex,
+                             unpark(&parked, session->conn_pool_key));
+    }
+
+  if (parked)
+    {
+      session->conn_pool = parked->pool;
+      session->context = parked->context;
+      session->num_conns = parked->num_conns;
+      for (i = 0; i < parked->num_conns; i++)
+        {
+          svn_ra_serf__connection_t *conn = parked->conns[i];
+
+          /* The authentication iterations belonged to the old session. */
+          conn->session = session;
+          conn->ssl_client_auth_state = NULL;
+          conn->ssl_client_pw_auth_state = NULL;
+          session->conns[i] = conn;
+        }
+
+      apr_pool_cleanup_register(session->pool, session, park_context,
+                                apr_pool_cleanup_null);
+    }
+  else
+    {
+      apr_status_t status;
+
+      /* Give parkable contexts a root pool of their own, so that they
+         survive the session and can be handed between threads. */
+      if (session->conn_pool_key)
+        {
+          session->conn_pool
+            = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+          session->num_conns = 0;
+          apr_pool_cleanup_register(session->pool, session, park_context,
+                                    apr_pool_cleanup_null);
+        }
+      else
+        session->conn_pool = session->pool;
+
+      session->context = serf_context_create(session->conn_pool);
+
+      session->conns[0] = apr_pcalloc(session->conn_pool,
+                                      sizeof(*session->conns[0]));
+      session->conns[0]->bkt_alloc =
+              serf_bucket_allocator_create(session->conn_pool, NULL, NULL);
+      session->conns[0]->session = session;
+      session->conns[0]->last_status_code = -1;
+
+      /* go ahead and tell serf about the connection. */
+      status =
+        serf_connection_create2(&session->conns[0]->conn,
+                                session->context,
+                                session->session_url,
+                                svn_ra_serf__conn_setup, session->conns[0],
+                                svn_ra_serf__conn_closed, session->conns[0],
+                                session->conn_pool);
+      if (status)
+        return svn_ra_serf__wrap_err(status, NULL);
+
+      session->num_conns = 1;
+    }
+
+  session->cur_conn = 0;
+
+  /* Set the progress callback. */
+  serf_context_set_progress_cb(session->context, svn_ra_serf__progress,
+                               session);
+
+  return SVN_NO_ERROR;
+}
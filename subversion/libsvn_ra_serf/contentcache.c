@@ -0,0 +1,290 @@
+/*
+ * contentcache.c: on-disk cache of file contents, keyed by SHA-1.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+
+#include "svn_dirent_uri.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_sorts.h"
+#include "svn_types.h"
+
+#include "private/svn_sorts_private.h"
+
+#include "contentcache.h"
+
+/* Trim the cache after this fraction of its maximum size was added. */
+#define TRIM_FRACTION 16
+
+struct svn_ra_serf__contentcache_t
+{
+  /* Directory holding the cache entries. */
+  const char *dirpath;
+
+  /* Maximum total size of the cache entries. */
+  apr_int64_t max_size;
+
+  /* Bytes stored since the last trim, and whether we trimmed at all
+     during the lifetime of this object. */
+  apr_int64_t added_size;
+  svn_boolean_t trimmed;
+};
+
+/* Baton for the window handler returned by
+   svn_ra_serf__contentcache_wrap_handler(). */
+typedef struct cache_handler_baton_t
+{
+  svn_ra_serf__contentcache_t *cache;
+  const svn_checksum_t *sha1;
+
+  /* The wrapped handler. */
+  svn_txdelta_window_handler_t inner_handler;
+  void *inner_baton;
+
+  /* Handler producing the fulltext in TEMP_PATH, or NULL if storing the
+     contents failed. */
+  svn_txdelta_window_handler_t apply_handler;
+  void *apply_baton;
+  const char *temp_path;
+  svn_checksum_t *actual_sha1;
+  svn_filesize_t size;
+
+  apr_pool_t *pool;
+} cache_handler_baton_t;
+
+
+/* Return the path of the entry for SHA1 in CACHE. */
+static const char *
+entry_path(svn_ra_serf__contentcache_t *cache,
+           const svn_checksum_t *sha1,
+           apr_pool_t *result_pool)
+{
+  return svn_dirent_join(cache->dirpath,
+                         svn_checksum_to_cstring_display(sha1, result_pool),
+                         result_pool);
+}
+
+/* Sort svn_sort__item_t of svn_io_dirent2_t * by ascending mtime. */
+static int
+compare_mtime(const svn_sort__item_t *a,
+              const svn_sort__item_t *b)
+{
+  const svn_io_dirent2_t *lhs = a->value;
+  const svn_io_dirent2_t *rhs = b->value;
+
+  if (lhs->mtime == rhs->mtime)
+    return 0;
+  return lhs->mtime < rhs->mtime ? -1 : 1;
+}
+
+/* Remove the least recently used entries from CACHE until its total size
+   is below the configured maximum. */
+static svn_error_t *
+trim_cache(svn_ra_serf__contentcache_t *cache,
+           apr_pool_t *scratch_pool)
+{
+  apr_hash_t *dirents;
+  apr_array_header_t *sorted;
+  apr_hash_index_t *hi;
+  apr_int64_t total = 0;
+  apr_pool_t *iterpool;
+  int i;
+
+  cache->added_size = 0;
+  cache->trimmed = TRUE;
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, cache->dirpath, FALSE,
+                              scratch_pool, scratch_pool));
+
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+      if (dirent->kind == svn_node_file)
+        total += dirent->filesize;
+    }
+
+  if (total <= cache->max_size)
+    return SVN_NO_ERROR;
+
+  sorted = svn_sort__hash(dirents, compare_mtime, scratch_pool);
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < sorted->nelts && total > cache->max_size; i++)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i,
+                                                    svn_sort__item_t);
+      const svn_io_dirent2_t *dirent = item->value;
+
+      if (dirent->kind != svn_node_file)
+        continue;
+
+      svn_pool_clear(iterpool);
+
+      /* Another process may be trimming at the same time. */
+      SVN_ERR(svn_io_remove_file2(svn_dirent_join(cache->dirpath, item->key,
+                                                  iterpool),
+                                  TRUE, iterpool));
+      total -= dirent->filesize;
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__contentcache_create(svn_ra_serf__contentcache_t **cache_p,
+                                 const char *dirpath,
+                                 apr_int64_t max_size,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_ra_serf__contentcache_t *cache = apr_pcalloc(result_pool,
+                                                   sizeof(*cache));
+
+  SVN_ERR(svn_io_make_dir_recursively(dirpath, scratch_pool));
+
+  cache->dirpath = apr_pstrdup(result_pool, dirpath);
+  cache->max_size = max_size;
+
+  *cache_p = cache;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__contentcache_get(svn_stream_t **contents,
+                              svn_ra_serf__contentcache_t *cache,
+                              const svn_checksum_t *sha1,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  const char *path = entry_path(cache, sha1, scratch_pool);
+  svn_error_t *err;
+
+  err = svn_stream_open_readonly(contents, path, result_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *contents = NULL;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* Mark the entry as recently used.  Not being able to do so only
+     affects the eviction order. */
+  svn_error_clear(svn_io_set_file_affected_time(apr_time_now(), path,
+                                                scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Move the completed fulltext of B into the cache. */
+static svn_error_t *
+store_entry(cache_handler_baton_t *b)
+{
+  svn_ra_serf__contentcache_t *cache = b->cache;
+
+  /* Don't store anything we wouldn't get back as SHA1. */
+  if (!b->actual_sha1 || !svn_checksum_match(b->sha1, b->actual_sha1))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_io_file_rename2(b->temp_path, entry_path(cache, b->sha1, b->pool),
+                              FALSE, b->pool));
+
+  cache->added_size += b->size;
+  if (!cache->trimmed || cache->added_size > cache->max_size / TRIM_FRACTION)
+    SVN_ERR(trim_cache(cache, b->pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_window_handler_t */
+static svn_error_t *
+cache_window_handler(svn_txdelta_window_t *window,
+                     void *baton)
+{
+  cache_handler_baton_t *b = baton;
+
+  if (b->apply_handler)
+    {
+      svn_error_t *err = b->apply_handler(window, b->apply_baton);
+
+      if (window)
+        b->size += window->tview_len;
+      else if (!err)
+        err = store_entry(b);
+
+      if (err)
+        {
+          svn_error_clear(err);
+          b->apply_handler = NULL;
+        }
+    }
+
+  SVN_ERR(b->inner_handler(window, b->inner_baton));
+
+  if (!window)
+    svn_pool_destroy(b->pool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__contentcache_wrap_handler(svn_txdelta_window_handler_t *handler,
+                                       void **handler_baton,
+                                       svn_ra_serf__contentcache_t *cache,
+                                       const svn_checksum_t *sha1,
+                                       apr_pool_t *result_pool)
+{
+  apr_pool_t *pool = svn_pool_create(result_pool);
+  cache_handler_baton_t *b = apr_pcalloc(result_pool, sizeof(*b));
+  svn_stream_t *target;
+  svn_error_t *err;
+
+  b->cache = cache;
+  b->sha1 = svn_checksum_dup(sha1, result_pool);
+  b->inner_handler = *handler;
+  b->inner_baton = *handler_baton;
+  b->pool = pool;
+
+  err = svn_stream_open_unique(&target, &b->temp_path, cache->dirpath,
+                               svn_io_file_del_on_pool_cleanup, pool, pool);
+  if (err)
+    {
+      /* Just pass the windows through. */
+      svn_error_clear(err);
+    }
+  else
+    {
+      target = svn_stream_checksummed2(target, NULL, &b->actual_sha1,
+                                       svn_checksum_sha1, FALSE, pool);
+      svn_txdelta_apply(svn_stream_empty(pool), target, NULL, NULL, pool,
+                        &b->apply_handler, &b->apply_baton);
+    }
+
+  *handler = cache_window_handler;
+  *handler_baton = b;
+
+  return SVN_NO_ERROR;
+}
@@ -0,0 +1,86 @@
+/*
+ * contentcache.h: on-disk cache of file contents, keyed by SHA-1.
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_RA_SERF_CONTENTCACHE_H
+#define SVN_LIBSVN_RA_SERF_CONTENTCACHE_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_checksum.h"
+#include "svn_delta.h"
+#include "svn_io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* File contents cache.  Stores fulltexts received from the server in a
+ * directory on disk, named by their SHA-1 checksum, so that later
+ * checkouts and exports of the same contents don't have to download
+ * them again.  The contents of a SHA-1 never change, so cache entries
+ * never get stale.  The total size of the cache is kept below a limit
+ * by removing the least recently used entries.
+ */
+typedef struct svn_ra_serf__contentcache_t svn_ra_serf__contentcache_t;
+
+/* Set *CACHE_P to a new cache using the directory DIRPATH, which will be
+ * created if it doesn't exist yet.  Keep the cache below MAX_SIZE bytes.
+ * Allocate the cache in RESULT_POOL.
+ */
+svn_error_t *
+svn_ra_serf__contentcache_create(svn_ra_serf__contentcache_t **cache_p,
+                                 const char *dirpath,
+                                 apr_int64_t max_size,
+                                 apr_pool_t *result_pool,
+                                 apr_pool_t *scratch_pool);
+
+/* Set *CONTENTS to a readable stream of the cached contents with the
+ * checksum SHA1, or to NULL if CACHE doesn't have them.  Allocate
+ * *CONTENTS in RESULT_POOL.
+ */
+svn_error_t *
+svn_ra_serf__contentcache_get(svn_stream_t **contents,
+                              svn_ra_serf__contentcache_t *cache,
+                              const svn_checksum_t *sha1,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
+/* Wrap the window handler *HANDLER / *HANDLER_BATON, which receives a
+ * delta against the empty file that produces contents with the checksum
+ * SHA1, so that the resulting fulltext also gets stored in CACHE.
+ * Failures to store the contents are ignored.  Allocate the new baton
+ * in RESULT_POOL.
+ */
+svn_error_t *
+svn_ra_serf__contentcache_wrap_handler(svn_txdelta_window_handler_t *handler,
+                                       void **handler_baton,
+                                       svn_ra_serf__contentcache_t *cache,
+                                       const svn_checksum_t *sha1,
+                                       apr_pool_t *result_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_RA_SERF_CONTENTCACHE_H*/
@@ -39,6 +39,7 @@
 #include "../libsvn_ra/ra_loader.h"
 #include "svn_private_config.h"
 #include "private/svn_fspath.h"
+#include "private/svn_subr_private.h"
 
 #include "ra_serf.h"
 
@@ -247,10 +248,19 @@ capabilities_headers_iterator_callback(void *baton,
           /* Same for svndiff2. */
           session->supports_svndiff2 = TRUE;
         }
+      if (svn_cstring_match_list(SVN_DAV_NS_DAV_SVN_SVNDIFF3, vals))
+        {
+          /* And svndiff3, which we can only use with Zstandard support. */
+          session->supports_svndiff3 = svn__zstd_supported();
+        }
       if (svn_cstring_match_list(SVN_DAV_NS_DAV_SVN_PUT_RESULT_CHECKSUM, vals))
         {
           session->supports_put_result_checksum = TRUE;
         }
+      if (svn_cstring_match_list(SVN_DAV_NS_DAV_SVN_GET_FILES, vals))
+        {
+          session->supports_get_files = TRUE;
+        }
     }
 
   /* SVN-specific headers -- if present, server supports HTTP protocol v2 */
@@ -396,6 +406,9 @@ options_response_handler(serf_request_t *request,
                     capability_no);
       svn_hash_sets(session->capabilities, SVN_RA_CAPABILITY_LIST,
                     capability_no);
+      /* Blame is only computed by svnserve and ra_local for now. */
+      svn_hash_sets(session->capabilities, SVN_RA_CAPABILITY_BLAME,
+                    capability_no);
 
       /* Then see which ones we can discover. */
       serf_bucket_headers_do(hdrs, capabilities_headers_iterator_callback,
@@ -42,6 +42,7 @@
 #include "private/svn_editor.h"
 
 #include "blncache.h"
+#include "contentcache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -106,6 +107,11 @@ struct svn_ra_serf__session_t {
   /* The current context */
   serf_context_t *context;
 
+  /* Pool owning CONTEXT and CONNS.  The same as POOL, unless they may
+     be kept open for later sessions with the same CONN_POOL_KEY. */
+  apr_pool_t *conn_pool;
+  const char *conn_pool_key;
+
   /* The maximum number of connections we'll use for parallelized
      fetch operations (updates, etc.) */
   apr_int64_t max_connections;
@@ -144,6 +150,9 @@ struct svn_ra_serf__session_t {
      requests may come in any order */
   svn_boolean_t http20;
 
+  /* Should we offer HTTP/2 via ALPN when setting up SSL connections. */
+  svn_boolean_t enable_http2;
+
   /* Should we use Transfer-Encoding: chunked for HTTP/1.1 servers. */
   svn_boolean_t using_chunked_requests;
 
@@ -243,6 +252,9 @@ struct svn_ra_serf__session_t {
 
   svn_ra_serf__blncache_t *blncache;
 
+  /* Cache of file contents by SHA-1, or NULL if not configured. */
+  svn_ra_serf__contentcache_t *contentcache;
+
   /* Trisate flag that indicates user preference for using bulk updates
      (svn_tristate_true) with all the properties and content in the
      update-report response. If svn_tristate_false, request a skelta
@@ -269,10 +281,17 @@ struct svn_ra_serf__session_t {
   /* Indicates whether the server can understand svndiff version 2. */
   svn_boolean_t supports_svndiff2;
 
+  /* Indicates whether the server can understand svndiff version 3. */
+  svn_boolean_t supports_svndiff3;
+
   /* Indicates whether the server sends the result checksum in the response
    * to a successful PUT request. */
   svn_boolean_t supports_put_result_checksum;
 
+  /* Indicates whether the server can deliver many files in a single
+     get-files REPORT. */
+  svn_boolean_t supports_get_files;
+
   apr_interval_time_t conn_latency;
 };
 
@@ -336,6 +355,18 @@ static const svn_ra_serf__dav_props_t type_and_checksum_props[] =
 
 /** Serf utility functions **/
 
+/* Set up SESSION->CONTEXT and its first connection to SESSION->SESSION_URL.
+ *
+ * If SESSION->CONN_POOL_KEY is not NULL, allocate them so that they can
+ * be kept open when SESSION is closed, for use by a later session with
+ * the same key.  If REUSE_PARKED is set, use those of such an earlier
+ * session instead of opening a new connection, if there are any.
+ */
+svn_error_t *
+svn_ra_serf__conn_pool_open(svn_ra_serf__session_t *session,
+                            svn_boolean_t reuse_parked,
+                            apr_pool_t *scratch_pool);
+
 apr_status_t
 svn_ra_serf__conn_setup(apr_socket_t *sock,
                         serf_bucket_t **read_bkt,
@@ -1232,6 +1263,15 @@ svn_ra_serf__stat(svn_ra_session_t *ra_session,
                   svn_dirent_t **dirent,
                   apr_pool_t *pool);
 
+/* Implements svn_ra__vtable_t.stat_many(). */
+svn_error_t *
+svn_ra_serf__stat_many(svn_ra_session_t *ra_session,
+                       apr_hash_t **dirents,
+                       const apr_array_header_t *paths,
+                       svn_revnum_t revision,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool);
+
 /* Implements svn_ra__vtable_t.get_locations(). */
 svn_error_t *
 svn_ra_serf__get_locations(svn_ra_session_t *session,
@@ -1637,6 +1677,14 @@ svn_ra_serf__request_body_get_delegate(svn_ra_serf__request_body_delegate_t *del
                                        void **baton,
                                        svn_ra_serf__request_body_t *body);
 
+/* If the content of BODY, whose stream has been closed, is held in
+   memory, set *DATA and *LEN to it and return TRUE.  Return FALSE if
+   it has been spilled to a temporary file. */
+svn_boolean_t
+svn_ra_serf__request_body_get_data(const char **data,
+                                   apr_size_t *len,
+                                   svn_ra_serf__request_body_t *body);
+
 /* Release intermediate resources associated with BODY.  These resources
    (such as open file handles) will be automatically released when the
    pool used to construct BODY is cleared or destroyed, but this optional
@@ -221,6 +221,20 @@ svn_ra_serf__request_body_get_delegate(svn_ra_serf__request_body_delegate_t *del
   *baton = body;
 }
 
+svn_boolean_t
+svn_ra_serf__request_body_get_data(const char **data,
+                                   apr_size_t *len,
+                                   svn_ra_serf__request_body_t *body)
+{
+  if (body->file || (body->total_bytes && !body->all_data))
+    return FALSE;
+
+  *data = body->total_bytes ? body->all_data : "";
+  *len = body->total_bytes;
+
+  return TRUE;
+}
+
 svn_error_t *
 svn_ra_serf__request_body_cleanup(svn_ra_serf__request_body_t *body,
                                   apr_pool_t *scratch_pool)
@@ -150,9 +150,20 @@ load_http_auth_types(apr_pool_t *pool, svn_config_t *config,
    runtime configuration variable. */
 #define DEFAULT_HTTP_TIMEOUT 600
 
+/* Default for the 'http-enable-http2' runtime configuration variable. */
+#ifdef SVN__SERF_TEST_HTTP2
+#define DEFAULT_ENABLE_HTTP2 TRUE
+#else
+#define DEFAULT_ENABLE_HTTP2 FALSE
+#endif
+
+/* Load the session options from CONFIG_HASH and set up SESSION's serf
+   context and first connection.  If REUSE_PARKED is set, take them from
+   an earlier session to the same server if possible. */
 static svn_error_t *
 load_config(svn_ra_serf__session_t *session,
             apr_hash_t *config_hash,
+            svn_boolean_t reuse_parked,
             apr_pool_t *result_pool,
             apr_pool_t *scratch_pool)
 {
@@ -164,6 +175,9 @@ load_config(svn_ra_serf__session_t *session,
   const char *exceptions;
   apr_port_t proxy_port;
   svn_tristate_t chunked_requests;
+  const char *content_cache_dir;
+  apr_int64_t content_cache_size;
+  svn_boolean_t reuse_connections;
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   apr_int64_t log_components;
   apr_int64_t log_level;
@@ -251,6 +265,26 @@ load_config(svn_ra_serf__session_t *session,
                                   SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                   "auto", svn_tristate_unknown));
 
+  /* Should we offer HTTP/2 during the TLS handshake. */
+  SVN_ERR(svn_config_get_bool(config, &session->enable_http2,
+                              SVN_CONFIG_SECTION_GLOBAL,
+                              SVN_CONFIG_OPTION_HTTP_ENABLE_HTTP2,
+                              DEFAULT_ENABLE_HTTP2));
+
+  /* Where and how large is our cache of file contents. */
+  svn_config_get(config, &content_cache_dir, SVN_CONFIG_SECTION_GLOBAL,
+                 SVN_CONFIG_OPTION_HTTP_CONTENT_CACHE_DIR, NULL);
+  SVN_ERR(svn_config_get_int64(config, &content_cache_size,
+                               SVN_CONFIG_SECTION_GLOBAL,
+                               SVN_CONFIG_OPTION_HTTP_CONTENT_CACHE_SIZE,
+                               SVN_CONFIG_DEFAULT_OPTION_HTTP_CONTENT_CACHE_SIZE));
+
+  /* May we keep our connections open for later sessions. */
+  SVN_ERR(svn_config_get_bool(config, &reuse_connections,
+                              SVN_CONFIG_SECTION_GLOBAL,
+                              SVN_CONFIG_OPTION_HTTP_REUSE_CONNECTIONS,
+                              TRUE));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   SVN_ERR(svn_config_get_int64(config, &log_components,
                                SVN_CONFIG_SECTION_GLOBAL,
@@ -318,6 +352,26 @@ load_config(svn_ra_serf__session_t *session,
                                       SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS,
                                       "auto", chunked_requests));
 
+      /* Should we offer HTTP/2 during the TLS handshake. */
+      SVN_ERR(svn_config_get_bool(config, &session->enable_http2,
+                                  server_group,
+                                  SVN_CONFIG_OPTION_HTTP_ENABLE_HTTP2,
+                                  session->enable_http2));
+
+      /* Where and how large is our cache of file contents. */
+      svn_config_get(config, &content_cache_dir, server_group,
+                     SVN_CONFIG_OPTION_HTTP_CONTENT_CACHE_DIR,
+                     content_cache_dir);
+      SVN_ERR(svn_config_get_int64(config, &content_cache_size,
+                                   server_group,
+                                   SVN_CONFIG_OPTION_HTTP_CONTENT_CACHE_SIZE,
+                                   content_cache_size));
+
+      SVN_ERR(svn_config_get_bool(config, &reuse_connections,
+                                  server_group,
+                                  SVN_CONFIG_OPTION_HTTP_REUSE_CONNECTIONS,
+                                  reuse_connections));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
       SVN_ERR(svn_config_get_int64(config, &log_components,
                                    server_group,
@@ -330,6 +384,32 @@ load_config(svn_ra_serf__session_t *session,
 #endif
     }
 
+#if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
+  /* Logging outputs can't be removed from a context again. */
+  if (log_components != SERF_LOGCOMP_NONE)
+    reuse_connections = FALSE;
+#endif
+
+  /* Connections may only be shared by sessions that would have set them
+     up the same way, including how they authenticate and which server
+     certificates they trust. */
+  session->conn_pool_key = NULL;
+  if (reuse_connections)
+    session->conn_pool_key
+      = apr_psprintf(result_pool, "%s://%s:%u|%s:%s:%s|%s:%d|%d|%p",
+                     session->session_url.scheme,
+                     session->session_url.hostname,
+                     (unsigned int)session->session_url.port,
+                     proxy_host ? proxy_host : "",
+                     port_str ? port_str : "",
+                     session->proxy_username ? session->proxy_username : "",
+                     session->ssl_authorities ? session->ssl_authorities : "",
+                     session->trust_default_ca,
+                     session->enable_http2,
+                     (void *)session->auth_baton);
+
+  SVN_ERR(svn_ra_serf__conn_pool_open(session, reuse_parked, scratch_pool));
+
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   if (log_components != SERF_LOGCOMP_NONE)
     {
@@ -443,6 +523,18 @@ load_config(svn_ra_serf__session_t *session,
   serf_config_credentials_callback(session->context,
                                    svn_ra_serf__credentials_callback);
 
+  /* Open the content cache, if the user wants one. */
+  session->contentcache = NULL;
+  if (content_cache_dir && *content_cache_dir && content_cache_size > 0)
+    {
+      SVN_ERR(svn_ra_serf__contentcache_create(
+                    &session->contentcache,
+                    svn_dirent_internal_style(content_cache_dir,
+                                              scratch_pool),
+                    content_cache_size * 1024 * 1024,
+                    result_pool, scratch_pool));
+    }
+
   return SVN_NO_ERROR;
 }
 #undef DEFAULT_HTTP_TIMEOUT
@@ -485,7 +577,6 @@ svn_ra_serf__open(svn_ra_session_t *session,
                   apr_pool_t *result_pool,
                   apr_pool_t *scratch_pool)
 {
-  apr_status_t status;
   svn_ra_serf__session_t *serf_sess;
   apr_uri_t url;
   const char *client_string = NULL;
@@ -510,9 +601,6 @@ svn_ra_serf__open(svn_ra_session_t *session,
   serf_sess->cancel_func = callbacks->cancel_func;
   serf_sess->cancel_baton = callback_baton;
 
-  /* todo: reuse serf context across sessions */
-  serf_sess->context = serf_context_create(serf_sess->pool);
-
   SVN_ERR(svn_ra_serf__blncache_create(&serf_sess->blncache,
                                        serf_sess->pool));
 
@@ -540,14 +628,8 @@ svn_ra_serf__open(svn_ra_session_t *session,
      this, if we find an intervening proxy does not support chunked requests.  */
   serf_sess->using_chunked_requests = TRUE;
 
-  SVN_ERR(load_config(serf_sess, config, serf_sess->pool, scratch_pool));
-
-  serf_sess->conns[0] = apr_pcalloc(serf_sess->pool,
-                                    sizeof(*serf_sess->conns[0]));
-  serf_sess->conns[0]->bkt_alloc =
-          serf_bucket_allocator_create(serf_sess->pool, NULL, NULL);
-  serf_sess->conns[0]->session = serf_sess;
-  serf_sess->conns[0]->last_status_code = -1;
+  SVN_ERR(load_config(serf_sess, config, TRUE, serf_sess->pool,
+                      scratch_pool));
 
   /* create the user agent string */
   if (callbacks->get_client_string)
@@ -562,23 +644,6 @@ svn_ra_serf__open(svn_ra_session_t *session,
   else
     serf_sess->useragent = get_user_agent_string(result_pool);
 
-  /* go ahead and tell serf about the connection. */
-  status =
-    serf_connection_create2(&serf_sess->conns[0]->conn,
-                            serf_sess->context,
-                            url,
-                            svn_ra_serf__conn_setup, serf_sess->conns[0],
-                            svn_ra_serf__conn_closed, serf_sess->conns[0],
-                            serf_sess->pool);
-  if (status)
-    return svn_ra_serf__wrap_err(status, NULL);
-
-  /* Set the progress callback. */
-  serf_context_set_progress_cb(serf_sess->context, svn_ra_serf__progress,
-                               serf_sess);
-
-  serf_sess->num_conns = 1;
-
   session->priv = serf_sess;
 
   /* The following code explicitly works around a bug in serf <= r2319 / 1.3.8
@@ -632,7 +697,6 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
 {
   svn_ra_serf__session_t *old_sess = old_session->priv;
   svn_ra_serf__session_t *new_sess;
-  apr_status_t status;
 
   new_sess = apr_pmemdup(result_pool, old_sess, sizeof(*new_sess));
 
@@ -762,39 +826,15 @@ ra_serf_dup_session(svn_ra_session_t *new_session,
   /* supports_rev_rsrc_replay */
   /* supports_svndiff1 */
   /* supports_svndiff2 */
+  /* supports_svndiff3 */
   /* supports_put_result_checksum */
   /* conn_latency */
 
-  new_sess->context = serf_context_create(result_pool);
-
-  SVN_ERR(load_config(new_sess, old_sess->config,
+  /* The protocol state copied from OLD_SESS only matches a connection
+     of our own, so don't take one from an earlier session. */
+  SVN_ERR(load_config(new_sess, old_sess->config, FALSE,
                       result_pool, scratch_pool));
 
-  new_sess->conns[0] = apr_pcalloc(result_pool,
-                                   sizeof(*new_sess->conns[0]));
-  new_sess->conns[0]->bkt_alloc =
-          serf_bucket_allocator_create(result_pool, NULL, NULL);
-  new_sess->conns[0]->session = new_sess;
-  new_sess->conns[0]->last_status_code = -1;
-
-  /* go ahead and tell serf about the connection. */
-  status =
-    serf_connection_create2(&new_sess->conns[0]->conn,
-                            new_sess->context,
-                            new_sess->session_url,
-                            svn_ra_serf__conn_setup, new_sess->conns[0],
-                            svn_ra_serf__conn_closed, new_sess->conns[0],
-                            result_pool);
-  if (status)
-    return svn_ra_serf__wrap_err(status, NULL);
-
-  /* Set the progress callback. */
-  serf_context_set_progress_cb(new_sess->context, svn_ra_serf__progress,
-                               new_sess);
-
-  new_sess->num_conns = 1;
-  new_sess->cur_conn = 0;
-
   new_session->priv = new_sess;
 
   return SVN_NO_ERROR;
@@ -1068,6 +1108,8 @@ static const svn_ra__vtable_t serf_vtable = {
   svn_ra_serf__get_inherited_props,
   NULL /* set_svn_ra_open */,
   svn_ra_serf__list,
+  svn_ra_serf__stat_many,
+  NULL /* blame */,
   svn_ra_serf__register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
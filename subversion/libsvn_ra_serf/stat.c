@@ -37,6 +37,7 @@
 #include "svn_hash.h"
 #include "svn_path.h"
 #include "svn_props.h"
+#include "svn_sorts.h"
 #include "svn_time.h"
 #include "svn_version.h"
 
@@ -302,6 +303,150 @@ svn_ra_serf__stat(svn_ra_session_t *ra_session,
   return SVN_NO_ERROR;
 }
 
+/* The number of PROPFIND requests svn_ra_serf__stat_many() has in flight
+   at the same time. */
+#define STAT_MANY_BATCH 64
+
+/* Per request information for svn_ra_serf__stat_many() */
+typedef struct stat_rq_info_t
+{
+  const char *relpath;
+  struct fill_dirent_baton_t fdb;
+  svn_ra_serf__handler_t *handler;
+} stat_rq_info_t;
+
+/* Implements svn_ra__vtable_t.stat_many(). */
+svn_error_t *
+svn_ra_serf__stat_many(svn_ra_session_t *ra_session,
+                       apr_hash_t **dirents,
+                       const apr_array_header_t *paths,
+                       svn_revnum_t revision,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  svn_ra_serf__session_t *session = ra_session->priv;
+  const svn_ra_serf__dav_props_t *props;
+  apr_array_header_t *rq_info;
+  apr_pool_t *iterpool;
+  const char *base_url;
+  int first = 0;
+  int i;
+
+  *dirents = apr_hash_make(result_pool);
+
+  if (paths->nelts == 0)
+    return SVN_NO_ERROR;
+
+  /* Until we know whether the server sends a usable deadprop-count, use
+     the single path code, which knows how to requery. */
+  if (session->supports_deadprop_count == svn_tristate_unknown)
+    {
+      const char *relpath = APR_ARRAY_IDX(paths, 0, const char *);
+      svn_dirent_t *dirent;
+
+      SVN_ERR(svn_ra_serf__stat(ra_session, relpath, revision, &dirent,
+                                result_pool));
+      if (dirent)
+        svn_hash_sets(*dirents, apr_pstrdup(result_pool, relpath), dirent);
+
+      first = 1;
+    }
+
+  base_url = session->session_url.path;
+  if (SVN_IS_VALID_REVNUM(revision))
+    SVN_ERR(svn_ra_serf__get_stable_url(&base_url, NULL /* latest_revnum */,
+                                        session, base_url, revision,
+                                        scratch_pool, scratch_pool));
+
+  props = get_dirent_props(SVN_DIRENT_ALL, session, scratch_pool);
+  rq_info = apr_array_make(scratch_pool, STAT_MANY_BATCH,
+                           sizeof(stat_rq_info_t *));
+  iterpool = svn_pool_create(scratch_pool);
+
+  while (first < paths->nelts)
+    {
+      int last = MIN(first + STAT_MANY_BATCH, paths->nelts);
+      apr_interval_time_t waittime_left = session->timeout;
+
+      svn_pool_clear(iterpool);
+      apr_array_clear(rq_info);
+
+      /* Queue a batch of requests; serf pipelines them over the
+         session's connection. */
+      for (i = first; i < last; i++)
+        {
+          stat_rq_info_t *rq = apr_pcalloc(iterpool, sizeof(*rq));
+          const char *url;
+
+          rq->relpath = APR_ARRAY_IDX(paths, i, const char *);
+          url = svn_path_url_add_component2(base_url, rq->relpath, iterpool);
+
+          rq->fdb.entry = svn_dirent_create(iterpool);
+          rq->fdb.supports_deadprop_count = NULL;
+          rq->fdb.result_pool = iterpool;
+
+          SVN_ERR(svn_ra_serf__create_propfind_handler(&rq->handler, session,
+                                                       url,
+                                                       SVN_INVALID_REVNUM,
+                                                       "0", props,
+                                                       fill_dirent_propfunc,
+                                                       &rq->fdb, iterpool));
+
+          /* A missing path is not an error here. */
+          rq->handler->no_fail_on_http_failure_status = TRUE;
+
+          svn_ra_serf__request_create(rq->handler);
+
+          APR_ARRAY_PUSH(rq_info, stat_rq_info_t *) = rq;
+        }
+
+      while (TRUE)
+        {
+          SVN_ERR(svn_ra_serf__context_run(session, &waittime_left,
+                                           iterpool));
+
+          for (i = 0; i < rq_info->nelts; i++)
+            {
+              stat_rq_info_t *rq = APR_ARRAY_IDX(rq_info, i,
+                                                 stat_rq_info_t *);
+
+              if (!rq->handler->done)
+                break;
+            }
+
+          if (i >= rq_info->nelts)
+            break; /* All requests done */
+        }
+
+      for (i = 0; i < rq_info->nelts; i++)
+        {
+          stat_rq_info_t *rq = APR_ARRAY_IDX(rq_info, i, stat_rq_info_t *);
+
+          if (rq->handler->sline.code == 404)
+            continue;
+
+          if (rq->handler->sline.code != 207)
+            {
+              if (rq->handler->server_error)
+                SVN_ERR(svn_ra_serf__server_error_create(rq->handler,
+                                                         iterpool));
+
+              return svn_error_trace(
+                        svn_ra_serf__unexpected_status(rq->handler));
+            }
+
+          svn_hash_sets(*dirents, apr_pstrdup(result_pool, rq->relpath),
+                        svn_dirent_dup(rq->fdb.entry, result_pool));
+        }
+
+      first = last;
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Baton for get_dir_dirents_cb and get_dir_props_cb */
 struct get_dir_baton_t
 {
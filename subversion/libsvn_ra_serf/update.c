@@ -40,6 +40,7 @@
 #include "svn_path.h"
 #include "svn_base64.h"
 #include "svn_props.h"
+#include "svn_sorts.h"
 
 #include "svn_private_config.h"
 #include "private/svn_dep_compat.h"
@@ -251,9 +252,20 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
    can make the measurements quite imprecise.
 
    We measure outstanding requests as the sum of NUM_ACTIVE_FETCHES and
-   NUM_ACTIVE_PROPFINDS in the report_context_t structure.  */
+   NUM_ACTIVE_PROPFINDS in the report_context_t structure.
+
+   With HTTP/2 all requests are multiplexed as concurrent streams over
+   a single connection, so there is no head-of-line blocking and we can
+   keep many more requests in flight.  */
 #define REQUEST_COUNT_TO_PAUSE 50
 #define REQUEST_COUNT_TO_RESUME 40
+#define HTTP2_REQUEST_COUNT_TO_PAUSE 400
+#define HTTP2_REQUEST_COUNT_TO_RESUME 320
+
+/* Return the number of outstanding requests for SESS below which we
+   resume processing the REPORT response. */
+#define REQUEST_COUNT_TO_RESUME_FOR(sess) \
+  ((sess)->http20 ? HTTP2_REQUEST_COUNT_TO_RESUME : REQUEST_COUNT_TO_RESUME)
 
 #define SPILLBUF_BLOCKSIZE 4096
 #define SPILLBUF_MAXBUFFSIZE 131072
@@ -388,6 +400,9 @@ typedef struct fetch_ctx_t {
   /* The base-rev header  */
   const char *delta_base;
 
+  /* When the GET request was queued.  */
+  apr_time_t start_time;
+
 } fetch_ctx_t;
 
 /*
@@ -453,6 +468,32 @@ struct report_context_t {
 
   /* Did we close the root directory? */
   svn_boolean_t closed_root;
+
+  /* Files waiting for a get-files REPORT, and the REPORTs in progress
+     (struct get_files_ctx_t). */
+  struct get_files_ctx_t *pending_get_files;
+  struct get_files_ctx_t *running_get_files;
+
+  /* Connection scaling state, see adapt_connections(). */
+
+  /* Number of outstanding requests per connection before we open
+     another one. */
+  int reqs_per_conn;
+
+  /* Number of connections we use for fetches; never more than
+     SESS->MAX_CONNECTIONS and never less than 2. */
+  int conn_limit;
+
+  /* Measurements for the current sampling window. */
+  apr_time_t window_start;
+  int window_fetches;
+  apr_off_t window_bytes;
+  apr_interval_time_t window_min_latency;
+
+  /* Results of the previous window. */
+  apr_int64_t last_throughput;
+  apr_int64_t best_throughput;
+  int last_conns;
 };
 
 static svn_error_t *
@@ -544,28 +585,42 @@ create_file_baton(file_baton_t **new_file,
   return SVN_NO_ERROR;
 }
 
-/** Minimum nr. of outstanding requests needed before a new connection is
- *  opened. */
+/** Initial nr. of outstanding requests needed before a new connection is
+ *  opened.  adapt_connections() scales this between REQS_PER_CONN_MIN and
+ *  REQS_PER_CONN_MAX based on the measured latency, relative to
+ *  REFERENCE_LATENCY. */
 #define REQS_PER_CONN 8
+#define REQS_PER_CONN_MIN 2
+#define REQS_PER_CONN_MAX 32
+#define REFERENCE_LATENCY apr_time_from_msec(20)
+
+/** Nr. of completed GET requests per connection scaling decision. */
+#define ADAPT_WINDOW 32
 
 /** This function creates a new connection for this serf session, but only
  * if the number of NUM_ACTIVE_REQS > REQS_PER_CONN or if there currently is
- * only one main connection open.
+ * only one main connection open.  Once HTTP/2 has been negotiated no new
+ * connections are opened, as requests are multiplexed on those we have.
  */
 static svn_error_t *
-open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
+open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs,
+                          int reqs_per_conn)
 {
+  if (sess->http20 && sess->num_conns > 1)
+    return SVN_NO_ERROR;
+
   /* For each REQS_PER_CONN outstanding requests open a new connection, with
    * a minimum of 1 extra connection. */
   if (sess->num_conns == 1 ||
-      ((num_active_reqs / REQS_PER_CONN) > sess->num_conns))
+      ((num_active_reqs / reqs_per_conn) > sess->num_conns))
     {
       int cur = sess->num_conns;
       apr_status_t status;
 
-      sess->conns[cur] = apr_pcalloc(sess->pool, sizeof(*sess->conns[cur]));
-      sess->conns[cur]->bkt_alloc = serf_bucket_allocator_create(sess->pool,
-                                                                 NULL, NULL);
+      sess->conns[cur] = apr_pcalloc(sess->conn_pool,
+                                     sizeof(*sess->conns[cur]));
+      sess->conns[cur]->bkt_alloc
+        = serf_bucket_allocator_create(sess->conn_pool, NULL, NULL);
       sess->conns[cur]->last_status_code = -1;
       sess->conns[cur]->session = sess;
       status = serf_connection_create2(&sess->conns[cur]->conn,
@@ -575,7 +630,7 @@ open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
                                        sess->conns[cur],
                                        svn_ra_serf__conn_closed,
                                        sess->conns[cur],
-                                       sess->pool);
+                                       sess->conn_pool);
       if (status)
         return svn_ra_serf__wrap_err(status, NULL);
 
@@ -585,12 +640,74 @@ open_connection_if_needed(svn_ra_serf__session_t *sess, int num_active_reqs)
   return SVN_NO_ERROR;
 }
 
+/* Record the completion of the GET request of FETCH_CTX in its report
+   context and, at the end of each sampling window, adjust the connection
+   scaling of the report.
+
+   A high latency means we need more requests in flight to use the
+   available bandwidth, so we open connections sooner.  Low latency links
+   are served well by a few connections.  If the last connection we
+   started using didn't improve the throughput, we stop using it again,
+   so that the server's keep-alive timeout can release its worker.  */
+static void
+adapt_connections(fetch_ctx_t *fetch_ctx)
+{
+  report_context_t *ctx = fetch_ctx->file->parent_dir->ctx;
+  svn_ra_serf__session_t *sess = ctx->sess;
+  apr_time_t now = apr_time_now();
+  apr_interval_time_t elapsed;
+  apr_int64_t throughput;
+  apr_int64_t reqs_per_conn;
+  int cur_conns;
+
+  ctx->window_bytes += fetch_ctx->read_size;
+  if (++ctx->window_fetches < ADAPT_WINDOW)
+    return;
+
+  elapsed = now - ctx->window_start;
+  throughput = ctx->window_bytes * APR_USEC_PER_SEC / MAX(elapsed, 1);
+  cur_conns = MIN(sess->num_conns, ctx->conn_limit);
+
+  if (ctx->window_min_latency > 0)
+    {
+      reqs_per_conn = REQS_PER_CONN * REFERENCE_LATENCY
+                      / ctx->window_min_latency;
+      ctx->reqs_per_conn = (int)MAX(REQS_PER_CONN_MIN,
+                                    MIN(reqs_per_conn, REQS_PER_CONN_MAX));
+    }
+
+  if (ctx->last_conns && cur_conns > ctx->last_conns
+      && throughput < ctx->last_throughput + ctx->last_throughput / 10)
+    {
+      /* The additional connection didn't buy us anything. */
+      ctx->conn_limit = MAX(ctx->last_conns, 2);
+      cur_conns = ctx->conn_limit;
+    }
+  else if (ctx->conn_limit < sess->max_connections
+           && throughput < ctx->best_throughput / 2)
+    {
+      /* Conditions changed; allow probing for more connections again. */
+      ctx->conn_limit = (int)sess->max_connections;
+      ctx->best_throughput = 0;
+    }
+
+  ctx->best_throughput = MAX(ctx->best_throughput, throughput);
+  ctx->last_throughput = throughput;
+  ctx->last_conns = cur_conns;
+
+  ctx->window_start = now;
+  ctx->window_fetches = 0;
+  ctx->window_bytes = 0;
+  ctx->window_min_latency = 0;
+}
+
 /* Returns best connection for fetching files/properties. */
 static svn_ra_serf__connection_t *
 get_best_connection(report_context_t *ctx)
 {
   svn_ra_serf__connection_t *conn;
   int first_conn = 1;
+  int num_conns = MIN(ctx->sess->num_conns, ctx->conn_limit);
 
   /* Skip the first connection if the REPORT response hasn't been completely
      received yet or if we're being told to limit our connections to
@@ -604,13 +721,17 @@ get_best_connection(report_context_t *ctx)
      ### drive ordering requirements.
      ###
      ### See https://issues.apache.org/jira/browse/SVN-4116.
+
+     With HTTP/2 the REPORT response is just one of the streams on the
+     connection and doesn't block the others, so use all connections.
   */
-  if (ctx->report_received && (ctx->sess->max_connections > 2))
+  if ((ctx->report_received || ctx->sess->http20)
+      && (ctx->sess->max_connections > 2))
     first_conn = 0;
 
   /* If there's only one available auxiliary connection to use, don't bother
      doing all the cur_conn math -- just return that one connection.  */
-  if (ctx->sess->num_conns - first_conn == 1)
+  if (num_conns - first_conn == 1)
     {
       conn = ctx->sess->conns[first_conn];
     }
@@ -629,7 +750,7 @@ get_best_connection(report_context_t *ctx)
        */
       int i, best_conn = first_conn;
       unsigned int min = INT_MAX;
-      for (i = first_conn; i < ctx->sess->num_conns; i++)
+      for (i = first_conn; i < num_conns; i++)
         {
           serf_connection_t *sc = ctx->sess->conns[i]->conn;
           unsigned int pending = serf_connection_pending_requests(sc);
@@ -645,7 +766,7 @@ get_best_connection(report_context_t *ctx)
        cycle them. */
       conn = ctx->sess->conns[ctx->sess->cur_conn];
       ctx->sess->cur_conn++;
-      if (ctx->sess->cur_conn >= ctx->sess->num_conns)
+      if (ctx->sess->cur_conn >= num_conns)
         ctx->sess->cur_conn = first_conn;
 #endif
     }
@@ -959,9 +1080,18 @@ handle_fetch(serf_request_t *request,
 
   if (!fetch_ctx->read_headers)
     {
+      report_context_t *ctx = file->parent_dir->ctx;
+      apr_interval_time_t latency = apr_time_now() - fetch_ctx->start_time;
       serf_bucket_t *hdrs;
       const char *val;
 
+      /* The smallest time to the response headers within a window
+         approximates the round trip time, without the time spent
+         waiting behind other requests on the connection. */
+      if (latency > 0
+          && (!ctx->window_min_latency || latency < ctx->window_min_latency))
+        ctx->window_min_latency = latency;
+
       /* If the error code wasn't 200, something went wrong. Don't use the
        * returned data as its probably an error message. Just bail out instead.
        */
@@ -1190,6 +1320,7 @@ file_fetch_done(serf_request_t *request,
     return svn_error_trace(svn_ra_serf__unexpected_status(handler));
 
   file->parent_dir->ctx->num_active_fetches--;
+  adapt_connections(fetch_ctx);
 
   file->fetch_file = FALSE;
 
@@ -1205,6 +1336,370 @@ file_fetch_done(serf_request_t *request,
   return svn_error_trace(close_file(file, scratch_pool));
 }
 
+/* Create the GET request for FETCH_CTX on CONN. */
+static void
+schedule_fetch(fetch_ctx_t *fetch_ctx,
+               svn_ra_serf__connection_t *conn)
+{
+  file_baton_t *file = fetch_ctx->file;
+  svn_ra_serf__handler_t *handler;
+
+  handler = svn_ra_serf__create_handler(fetch_ctx->session, file->pool);
+
+  handler->method = "GET";
+  handler->path = file->url;
+
+  handler->conn = conn; /* Explicit scheduling */
+
+  handler->custom_accept_encoding = TRUE;
+  handler->no_dav_headers = TRUE;
+  handler->header_delegate = headers_fetch;
+  handler->header_delegate_baton = fetch_ctx;
+
+  handler->response_handler = handle_fetch;
+  handler->response_baton = fetch_ctx;
+
+  handler->response_error = cancel_fetch;
+  handler->response_error_baton = fetch_ctx;
+
+  handler->done_delegate = file_fetch_done;
+  handler->done_delegate_baton = fetch_ctx;
+
+  fetch_ctx->handler = handler;
+  fetch_ctx->start_time = apr_time_now();
+
+  svn_ra_serf__request_create(handler);
+}
+
+
+/** Routines for fetching many files with a single get-files REPORT */
+
+/* Maximum number of files requested in a single get-files REPORT. */
+#define GET_FILES_BATCH 64
+
+typedef enum get_files_state_e {
+  GET_FILES_INITIAL = XML_STATE_INITIAL,
+  GET_FILES_REPORT,
+  GET_FILES_FILE,
+  GET_FILES_TXDELTA,
+  GET_FILES_FETCH
+} get_files_state_e;
+
+static const svn_ra_serf__xml_transition_t get_files_ttable[] = {
+  { GET_FILES_INITIAL, S_, "get-files-report", GET_FILES_REPORT,
+    FALSE, { NULL }, FALSE },
+
+  { GET_FILES_REPORT, S_, "file", GET_FILES_FILE,
+    FALSE, { "id", NULL }, TRUE },
+
+  { GET_FILES_FILE, S_, "txdelta", GET_FILES_TXDELTA,
+    FALSE, { NULL }, TRUE },
+
+  { GET_FILES_REPORT, S_, "fetch", GET_FILES_FETCH,
+    FALSE, { "id", NULL }, TRUE },
+
+  { 0 }
+};
+
+/* A batch of files fetched with a single get-files REPORT. */
+typedef struct get_files_ctx_t
+{
+  report_context_t *report;
+
+  /* Pool holding this batch and its request. */
+  apr_pool_t *pool;
+
+  /* The fetch_ctx_t * of the requested files, indexed by their id.
+     Entries are reset to NULL once the file has been received. */
+  apr_array_header_t *files;
+
+  /* The file that is currently being received, and the stream that
+     decodes its txdelta. */
+  fetch_ctx_t *cur;
+  svn_stream_t *txdelta_stream;
+
+  svn_ra_serf__handler_t *handler;
+
+  /* Next batch in REPORT->RUNNING_GET_FILES. */
+  struct get_files_ctx_t *next;
+} get_files_ctx_t;
+
+/* Set *FETCH_CTX to the file of GFC identified by ID_STR and mark it as
+   received. */
+static svn_error_t *
+get_files_lookup(fetch_ctx_t **fetch_ctx,
+                 get_files_ctx_t *gfc,
+                 const char *id_str)
+{
+  apr_int64_t id;
+
+  SVN_ERR(svn_cstring_atoi64(&id, id_str));
+  if (id < 0 || id >= gfc->files->nelts
+      || !APR_ARRAY_IDX(gfc->files, id, fetch_ctx_t *))
+    return svn_error_createf(SVN_ERR_RA_DAV_MALFORMED_DATA, NULL,
+                             _("Unexpected file id '%s' in get-files "
+                               "response"), id_str);
+
+  *fetch_ctx = APR_ARRAY_IDX(gfc->files, id, fetch_ctx_t *);
+  APR_ARRAY_IDX(gfc->files, id, fetch_ctx_t *) = NULL;
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_opened_t  */
+static svn_error_t *
+get_files_opened(svn_ra_serf__xml_estate_t *xes,
+                 void *baton,
+                 int entered_state,
+                 const svn_ra_serf__dav_props_t *tag,
+                 apr_pool_t *scratch_pool)
+{
+  get_files_ctx_t *gfc = baton;
+
+  if (entered_state == GET_FILES_FILE)
+    {
+      apr_hash_t *attrs = svn_ra_serf__xml_gather_since(xes, entered_state);
+
+      SVN_ERR(get_files_lookup(&gfc->cur, gfc, svn_hash_gets(attrs, "id")));
+    }
+  else if (entered_state == GET_FILES_TXDELTA)
+    {
+      file_baton_t *file = gfc->cur->file;
+      svn_stream_t *decoder;
+
+      decoder = svn_txdelta_parse_svndiff(file->txdelta,
+                                          file->txdelta_baton,
+                                          TRUE /* error early close*/,
+                                          file->pool);
+
+      gfc->txdelta_stream = svn_base64_decode(decoder, file->pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_closed_t  */
+static svn_error_t *
+get_files_closed(svn_ra_serf__xml_estate_t *xes,
+                 void *baton,
+                 int leaving_state,
+                 const svn_string_t *cdata,
+                 apr_hash_t *attrs,
+                 apr_pool_t *scratch_pool)
+{
+  get_files_ctx_t *gfc = baton;
+  report_context_t *ctx = gfc->report;
+
+  if (leaving_state == GET_FILES_TXDELTA)
+    {
+      SVN_ERR(svn_stream_close(gfc->txdelta_stream));
+      gfc->txdelta_stream = NULL;
+    }
+  else if (leaving_state == GET_FILES_FILE)
+    {
+      file_baton_t *file = gfc->cur->file;
+
+      if (gfc->txdelta_stream)
+        return svn_error_create(SVN_ERR_RA_DAV_MALFORMED_DATA, NULL,
+                                _("Missing txdelta in get-files response"));
+
+      gfc->cur = NULL;
+      ctx->num_active_fetches--;
+      file->fetch_file = FALSE;
+
+      /* See file_fetch_done() */
+      if (!file->fetch_props)
+        SVN_ERR(close_file(file, scratch_pool));
+    }
+  else if (leaving_state == GET_FILES_FETCH)
+    {
+      fetch_ctx_t *fetch_ctx;
+
+      /* The server wants us to GET this one on our own. */
+      SVN_ERR(get_files_lookup(&fetch_ctx, gfc,
+                               svn_hash_gets(attrs, "id")));
+      schedule_fetch(fetch_ctx, get_best_connection(ctx));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_cdata_t  */
+static svn_error_t *
+get_files_cdata(svn_ra_serf__xml_estate_t *xes,
+                void *baton,
+                int current_state,
+                const char *data,
+                apr_size_t len,
+                apr_pool_t *scratch_pool)
+{
+  get_files_ctx_t *gfc = baton;
+
+  if (current_state == GET_FILES_TXDELTA && gfc->txdelta_stream)
+    SVN_ERR(svn_stream_write(gfc->txdelta_stream, data, &len));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_body_delegate_t */
+static svn_error_t *
+create_get_files_body(serf_bucket_t **body_bkt,
+                      void *baton,
+                      serf_bucket_alloc_t *alloc,
+                      apr_pool_t *pool /* request pool */,
+                      apr_pool_t *scratch_pool)
+{
+  get_files_ctx_t *gfc = baton;
+  serf_bucket_t *buckets;
+  int i;
+
+  buckets = serf_bucket_aggregate_create(alloc);
+
+  svn_ra_serf__add_open_tag_buckets(buckets, alloc,
+                                    "S:get-files-report",
+                                    "xmlns:S", SVN_XML_NAMESPACE,
+                                    SVN_VA_NULL);
+
+  for (i = 0; i < gfc->files->nelts; i++)
+    {
+      fetch_ctx_t *fetch_ctx = APR_ARRAY_IDX(gfc->files, i, fetch_ctx_t *);
+      const char *delta_base = NULL;
+
+      if (fetch_ctx->delta_base)
+        delta_base = svn_xml_escape_attr_cstring(fetch_ctx->delta_base, pool);
+
+      svn_ra_serf__add_open_tag_buckets(buckets, alloc, "S:file",
+                                        "id", apr_itoa(pool, i),
+                                        "delta-base", delta_base,
+                                        SVN_VA_NULL);
+      svn_ra_serf__add_cdata_len_buckets(buckets, alloc,
+                                         fetch_ctx->file->url,
+                                         strlen(fetch_ctx->file->url));
+      svn_ra_serf__add_close_tag_buckets(buckets, alloc, "S:file");
+    }
+
+  svn_ra_serf__add_close_tag_buckets(buckets, alloc, "S:get-files-report");
+
+  *body_bkt = buckets;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_header_delegate_t */
+static svn_error_t *
+setup_get_files_headers(serf_bucket_t *headers,
+                        void *baton,
+                        apr_pool_t *pool /* request pool */,
+                        apr_pool_t *scratch_pool)
+{
+  get_files_ctx_t *gfc = baton;
+
+  svn_ra_serf__setup_svndiff_accept_encoding(headers, gfc->report->sess);
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the REPORT for the files queued in CTX->PENDING_GET_FILES, if
+   any. */
+static svn_error_t *
+flush_get_files(report_context_t *ctx,
+                apr_pool_t *scratch_pool)
+{
+  get_files_ctx_t *gfc = ctx->pending_get_files;
+  svn_ra_serf__xml_context_t *xmlctx;
+  const char *report_target;
+
+  if (!gfc)
+    return SVN_NO_ERROR;
+
+  ctx->pending_get_files = NULL;
+
+  SVN_ERR(svn_ra_serf__report_resource(&report_target, ctx->sess,
+                                       scratch_pool));
+
+  xmlctx = svn_ra_serf__xml_context_create(get_files_ttable,
+                                           get_files_opened,
+                                           get_files_closed,
+                                           get_files_cdata,
+                                           gfc, gfc->pool);
+  gfc->handler = svn_ra_serf__create_expat_handler(ctx->sess, xmlctx, NULL,
+                                                   gfc->pool);
+
+  gfc->handler->method = "REPORT";
+  gfc->handler->path = apr_pstrdup(gfc->pool, report_target);
+  gfc->handler->body_type = "text/xml";
+  gfc->handler->body_delegate = create_get_files_body;
+  gfc->handler->body_delegate_baton = gfc;
+  gfc->handler->custom_accept_encoding = TRUE;
+  gfc->handler->header_delegate = setup_get_files_headers;
+  gfc->handler->header_delegate_baton = gfc;
+  gfc->handler->conn = get_best_connection(ctx);
+
+  gfc->next = ctx->running_get_files;
+  ctx->running_get_files = gfc;
+
+  svn_ra_serf__request_create(gfc->handler);
+
+  return SVN_NO_ERROR;
+}
+
+/* Release the get-files REPORTs of CTX that have completed. */
+static svn_error_t *
+reap_get_files(report_context_t *ctx)
+{
+  get_files_ctx_t **gfc_p = &ctx->running_get_files;
+
+  while (*gfc_p)
+    {
+      get_files_ctx_t *gfc = *gfc_p;
+      int i;
+
+      if (!gfc->handler->done)
+        {
+          gfc_p = &gfc->next;
+          continue;
+        }
+
+      if (gfc->handler->sline.code != 200)
+        return svn_error_trace(svn_ra_serf__unexpected_status(gfc->handler));
+
+      for (i = 0; i < gfc->files->nelts; i++)
+        if (APR_ARRAY_IDX(gfc->files, i, fetch_ctx_t *))
+          return svn_error_create(SVN_ERR_RA_DAV_MALFORMED_DATA, NULL,
+                                  _("Incomplete get-files response"));
+
+      *gfc_p = gfc->next;
+      svn_pool_destroy(gfc->pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Queue FETCH_CTX to be retrieved with a get-files REPORT. */
+static svn_error_t *
+queue_get_file(report_context_t *ctx,
+               fetch_ctx_t *fetch_ctx)
+{
+  get_files_ctx_t *gfc = ctx->pending_get_files;
+
+  if (!gfc)
+    {
+      apr_pool_t *pool = svn_pool_create(ctx->pool);
+
+      gfc = apr_pcalloc(pool, sizeof(*gfc));
+      gfc->report = ctx;
+      gfc->pool = pool;
+      gfc->files = apr_array_make(pool, GET_FILES_BATCH,
+                                  sizeof(fetch_ctx_t *));
+      ctx->pending_get_files = gfc;
+    }
+
+  APR_ARRAY_PUSH(gfc->files, fetch_ctx_t *) = fetch_ctx;
+
+  if (gfc->files->nelts >= GET_FILES_BATCH)
+    SVN_ERR(flush_get_files(ctx, gfc->pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Initiates additional requests needed for a file when not in "send-all" mode.
  */
 static svn_error_t *
@@ -1216,9 +1711,10 @@ fetch_for_file(file_baton_t *file,
   svn_ra_serf__handler_t *handler;
 
   /* Open extra connections if we have enough requests to send. */
-  if (ctx->sess->num_conns < ctx->sess->max_connections)
+  if (ctx->sess->num_conns < ctx->conn_limit)
     SVN_ERR(open_connection_if_needed(ctx->sess, ctx->num_active_fetches +
-                                                 ctx->num_active_propfinds));
+                                                 ctx->num_active_propfinds,
+                                      ctx->reqs_per_conn));
 
   /* What connection should we go on? */
   conn = get_best_connection(ctx);
@@ -1266,6 +1762,27 @@ fetch_for_file(file_baton_t *file,
             }
         }
 
+      if (file->fetch_file
+          && file->final_sha1_checksum
+          && ctx->sess->contentcache)
+        {
+          svn_stream_t *cached_contents;
+
+          SVN_ERR(svn_ra_serf__contentcache_get(&cached_contents,
+                                                ctx->sess->contentcache,
+                                                file->final_sha1_checksum,
+                                                scratch_pool, scratch_pool));
+          if (cached_contents)
+            {
+              SVN_ERR(svn_txdelta_send_stream(cached_contents,
+                                              file->txdelta,
+                                              file->txdelta_baton,
+                                              NULL, scratch_pool));
+              SVN_ERR(svn_stream_close(cached_contents));
+              file->fetch_file = FALSE;
+            }
+        }
+
       if (file->fetch_file)
         {
           fetch_ctx_t *fetch_ctx;
@@ -1324,30 +1841,22 @@ fetch_for_file(file_baton_t *file,
                                         : NULL;
             }
 
-          handler = svn_ra_serf__create_handler(ctx->sess, file->pool);
-
-          handler->method = "GET";
-          handler->path = file->url;
-
-          handler->conn = conn; /* Explicit scheduling */
-
-          handler->custom_accept_encoding = TRUE;
-          handler->no_dav_headers = TRUE;
-          handler->header_delegate = headers_fetch;
-          handler->header_delegate_baton = fetch_ctx;
-
-          handler->response_handler = handle_fetch;
-          handler->response_baton = fetch_ctx;
-
-          handler->response_error = cancel_fetch;
-          handler->response_error_baton = fetch_ctx;
-
-          handler->done_delegate = file_fetch_done;
-          handler->done_delegate_baton = fetch_ctx;
-
-          fetch_ctx->handler = handler;
+          /* Remember fulltexts for later checkouts, if configured. */
+          if (!fetch_ctx->delta_base
+              && file->final_sha1_checksum
+              && ctx->sess->contentcache)
+            SVN_ERR(svn_ra_serf__contentcache_wrap_handler(
+                                                &file->txdelta,
+                                                &file->txdelta_baton,
+                                                ctx->sess->contentcache,
+                                                file->final_sha1_checksum,
+                                                file->pool));
 
-          svn_ra_serf__request_create(handler);
+          /* Small files are cheaper to fetch in bulk, if we can. */
+          if (ctx->sess->supports_get_files)
+            SVN_ERR(queue_get_file(ctx, fetch_ctx));
+          else
+            schedule_fetch(fetch_ctx, conn);
 
           ctx->num_active_fetches++;
         }
@@ -1444,9 +1953,10 @@ fetch_for_dir(dir_baton_t *dir,
   svn_ra_serf__connection_t *conn;
 
   /* Open extra connections if we have enough requests to send. */
-  if (ctx->sess->num_conns < ctx->sess->max_connections)
+  if (ctx->sess->num_conns < ctx->conn_limit)
     SVN_ERR(open_connection_if_needed(ctx->sess, ctx->num_active_fetches +
-                                                 ctx->num_active_propfinds));
+                                                 ctx->num_active_propfinds,
+                                      ctx->reqs_per_conn));
 
   /* What connection should we go on? */
   conn = get_best_connection(ctx);
@@ -2251,7 +2761,7 @@ update_delay_handler(serf_request_t *request,
         }
 
       while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-                 < REQUEST_COUNT_TO_RESUME)
+                 < REQUEST_COUNT_TO_RESUME_FOR(udb->report->sess))
         {
           const char *data;
           apr_size_t len;
@@ -2335,7 +2845,7 @@ process_pending(update_delay_baton_t *udb,
   serf_bucket_alloc_t *alloc = NULL;
 
   while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-            < REQUEST_COUNT_TO_RESUME)
+            < REQUEST_COUNT_TO_RESUME_FOR(udb->report->sess))
     {
       const char *data;
       apr_size_t len;
@@ -2407,7 +2917,9 @@ process_editor_report(report_context_t *ctx,
   handler->response_baton = ud;
 
   /* Open the first extra connection. */
-  SVN_ERR(open_connection_if_needed(sess, 0));
+  SVN_ERR(open_connection_if_needed(sess, 0, ctx->reqs_per_conn));
+
+  ctx->window_start = apr_time_now();
 
   sess->cur_conn = 1;
 
@@ -2442,6 +2954,11 @@ process_editor_report(report_context_t *ctx,
       if (ud->spillbuf)
         SVN_ERR(process_pending(ud, iterpool));
 
+      /* Request the files found since the last iteration and release
+         the batches that are complete. */
+      SVN_ERR(flush_get_files(ctx, iterpool));
+      SVN_ERR(reap_get_files(ctx));
+
       /* Debugging purposes only! */
       for (i = 0; i < sess->num_conns; i++)
         {
@@ -2596,6 +3113,8 @@ make_update_reporter(svn_ra_session_t *ra_session,
   report->send_copyfrom_args = send_copyfrom_args;
   report->text_deltas = text_deltas;
   report->switched_paths = apr_hash_make(report->pool);
+  report->reqs_per_conn = REQS_PER_CONN;
+  report->conn_limit = (int)sess->max_connections;
 
   report->source = src_path;
   report->destination = dest_path;
@@ -45,6 +45,8 @@
 #include "private/svn_fspath.h"
 #include "private/svn_auth_private.h"
 #include "private/svn_cert.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_stats.h"
 
 #include "ra_serf.h"
 
@@ -480,7 +482,7 @@ load_authorities(svn_ra_serf__connection_t *conn, const char *authorities,
   return SVN_NO_ERROR;
 }
 
-#if SERF_VERSION_AT_LEAST(1, 4, 0) && defined(SVN__SERF_TEST_HTTP2)
+#if SERF_VERSION_AT_LEAST(1, 4, 0)
 /* Implements serf_ssl_protocol_result_cb_t */
 static apr_status_t
 conn_negotiate_protocol(void *data,
@@ -538,10 +540,10 @@ conn_setup(apr_socket_t *sock,
 
           serf_ssl_client_cert_provider_set(conn->ssl_context,
                                             svn_ra_serf__handle_client_cert,
-                                            conn, conn->session->pool);
+                                            conn, conn->session->conn_pool);
           serf_ssl_client_cert_password_set(conn->ssl_context,
                                             svn_ra_serf__handle_client_cert_pw,
-                                            conn, conn->session->pool);
+                                            conn, conn->session->conn_pool);
           serf_ssl_server_cert_callback_set(conn->ssl_context,
                                             ssl_server_cert_cb,
                                             conn);
@@ -555,10 +557,15 @@ conn_setup(apr_socket_t *sock,
           if (conn->session->ssl_authorities)
             {
               SVN_ERR(load_authorities(conn, conn->session->ssl_authorities,
-                                       conn->session->pool));
+                                       conn->session->conn_pool));
             }
-#if SERF_VERSION_AT_LEAST(1, 4, 0) && defined(SVN__SERF_TEST_HTTP2)
-          if (APR_SUCCESS ==
+#if SERF_VERSION_AT_LEAST(1, 4, 0)
+          /* Offer HTTP/2 only when parallel fetches are allowed: the
+             ordering guarantees that a session limited to two
+             connections relies on don't hold for multiplexed streams. */
+          if (conn->session->enable_http2
+              && conn->session->max_connections > 2
+              && APR_SUCCESS ==
                 serf_ssl_negotiate_protocol(conn->ssl_context, "h2,http/1.1",
                                             conn_negotiate_protocol, conn))
             {
@@ -1652,6 +1659,8 @@ setup_request_cb(serf_request_t *request,
   return save_error(handler->session, err);
 }
 
+SVN__COUNTER_DEFINE(requests_created, "ra_serf.requests");
+
 void
 svn_ra_serf__request_create(svn_ra_serf__handler_t *handler)
 {
@@ -1667,6 +1676,8 @@ svn_ra_serf__request_create(svn_ra_serf__handler_t *handler)
   handler->discard_body = FALSE;
   handler->scheduled = TRUE;
 
+  SVN__COUNTER_INC(requests_created);
+
   /* Keeping track of the returned request object would be nice, but doesn't
      work the way we would expect in ra_serf..
 
@@ -2053,6 +2064,15 @@ svn_ra_serf__setup_svndiff_accept_encoding(serf_bucket_t *headers,
       serf_bucket_headers_setn(
         headers, "Accept-Encoding", "svndiff");
     }
+  else if (svn__zstd_supported())
+    {
+      /* Svndiff3 gives a better compression ratio than svndiff1 at
+         a speed close to svndiff2, so prefer it regardless of the
+         connection latency. */
+      serf_bucket_headers_setn(
+        headers, "Accept-Encoding",
+        "gzip,svndiff3;q=0.95,svndiff1;q=0.9,svndiff2;q=0.8,svndiff;q=0.7");
+    }
   else if (session->using_compression == svn_tristate_unknown &&
            svn_ra_serf__is_low_latency_connection(session))
     {
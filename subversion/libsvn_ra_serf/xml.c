@@ -59,15 +59,28 @@ struct svn_ra_serf__xml_context_t {
   /* The transition table.  */
   const svn_ra_serf__xml_transition_t *ttable;
 
+  /* TTABLE compiled into per-state lists, see compile_ttable().  The
+     transitions from state S are TRANSITIONS[FIRST[S]] up to, but not
+     including, TRANSITIONS[FIRST[S + 1]].  */
+  const svn_ra_serf__xml_transition_t **transitions;
+  int *first;
+  int max_state;
+
   /* The callback information.  */
   svn_ra_serf__xml_opened_t opened_cb;
   svn_ra_serf__xml_closed_t closed_cb;
   svn_ra_serf__xml_cdata_t cdata_cb;
   void *baton;
 
-  /* Linked list of free states.  */
+  /* Linked list of states that can be reused, see estate_t.RECYCLE.  */
   svn_ra_serf__xml_estate_t *free_states;
 
+  /* Pool for allocating recyclable states.  */
+  apr_pool_t *estate_pool;
+
+  /* Has any element been closed yet?  */
+  svn_boolean_t closed_any;
+
 #ifdef SVN_DEBUG
   /* Used to verify we are not re-entering a callback, specifically to
      ensure SCRATCH_POOL is not cleared while an outer callback is
@@ -110,6 +123,10 @@ struct svn_ra_serf__xml_estate_t {
      this tag is closed?  */
   svn_boolean_t custom_close;
 
+  /* Was this state allocated in the context's ESTATE_POOL, so that it can
+     be reused for another element once it is closed?  */
+  svn_boolean_t recycle;
+
   /* A pool may be constructed for this state.  */
   apr_pool_t *state_pool;
 
@@ -483,9 +500,9 @@ svn_ra_serf__xml_context_done(svn_ra_serf__xml_context_t *xmlctx)
                                _("XML stream truncated: closing '%s' missing"),
                                xmlctx->current->tag.name);
     }
-  else if (! xmlctx->free_states)
+  else if (! xmlctx->closed_any)
     {
-      /* If we have no items on the free_states list, we didn't push anything,
+      /* If we never closed an element, we didn't push anything,
          which tells us that we found an empty xml body */
       const svn_ra_serf__xml_transition_t *scan;
       const svn_ra_serf__xml_transition_t *document = NULL;
@@ -519,6 +536,44 @@ svn_ra_serf__xml_context_done(svn_ra_serf__xml_context_t *xmlctx)
   return SVN_NO_ERROR;
 }
 
+/* Group the transitions of XMLCTX->TTABLE by their FROM_STATE, so that
+   we don't have to scan the whole table for every element.  The order of
+   the transitions for each state is kept, as the first match wins.  */
+static void
+compile_ttable(svn_ra_serf__xml_context_t *xmlctx,
+               apr_pool_t *result_pool)
+{
+  const svn_ra_serf__xml_transition_t *scan;
+  int count = 0;
+  int max_state = 0;
+  int *next;
+  int i;
+
+  for (scan = xmlctx->ttable; scan->ns != NULL; ++scan)
+    {
+      count++;
+      if (scan->from_state > max_state)
+        max_state = scan->from_state;
+    }
+
+  xmlctx->max_state = max_state;
+  xmlctx->first = apr_pcalloc(result_pool, (max_state + 2) * sizeof(int));
+  xmlctx->transitions = apr_palloc(result_pool,
+                                   (count + 1) * sizeof(*xmlctx->transitions));
+
+  for (scan = xmlctx->ttable; scan->ns != NULL; ++scan)
+    xmlctx->first[scan->from_state + 1]++;
+  for (i = 1; i <= max_state + 1; i++)
+    xmlctx->first[i] += xmlctx->first[i - 1];
+
+  next = apr_pmemdup(xmlctx->scratch_pool, xmlctx->first,
+                     (max_state + 1) * sizeof(int));
+  for (scan = xmlctx->ttable; scan->ns != NULL; ++scan)
+    xmlctx->transitions[next[scan->from_state]++] = scan;
+
+  svn_pool_clear(xmlctx->scratch_pool);
+}
+
 svn_ra_serf__xml_context_t *
 svn_ra_serf__xml_context_create(
   const svn_ra_serf__xml_transition_t *ttable,
@@ -538,6 +593,9 @@ svn_ra_serf__xml_context_create(
   xmlctx->cdata_cb = cdata_cb;
   xmlctx->baton = baton;
   xmlctx->scratch_pool = svn_pool_create(result_pool);
+  xmlctx->estate_pool = result_pool;
+
+  compile_ttable(xmlctx, result_pool);
 
   xes = apr_pcalloc(result_pool, sizeof(*xes));
   /* XES->STATE == 0  */
@@ -638,7 +696,7 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
 {
   svn_ra_serf__xml_estate_t *current = xmlctx->current;
   svn_ra_serf__dav_props_t elemname;
-  const svn_ra_serf__xml_transition_t *scan;
+  const svn_ra_serf__xml_transition_t *scan = NULL;
   apr_pool_t *new_pool;
   svn_ra_serf__xml_estate_t *new_xes;
 
@@ -656,21 +714,29 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
 
   expand_ns(&elemname, current->ns_list, raw_name);
 
-  for (scan = xmlctx->ttable; scan->ns != NULL; ++scan)
+  if (current->state >= 0 && current->state <= xmlctx->max_state)
     {
-      if (scan->from_state != current->state)
-        continue;
+      int i;
 
-      /* Wildcard tag match.  */
-      if (*scan->name == '*')
-        break;
+      for (i = xmlctx->first[current->state];
+           i < xmlctx->first[current->state + 1];
+           i++)
+        {
+          scan = xmlctx->transitions[i];
 
-      /* Found a specific transition.  */
-      if (strcmp(elemname.name, scan->name) == 0
-          && strcmp(elemname.xmlns, scan->ns) == 0)
-        break;
+          /* Wildcard tag match.  */
+          if (*scan->name == '*')
+            break;
+
+          /* Found a specific transition.  */
+          if (strcmp(elemname.name, scan->name) == 0
+              && strcmp(elemname.xmlns, scan->ns) == 0)
+            break;
+
+          scan = NULL;
+        }
     }
-  if (scan->ns == NULL)
+  if (scan == NULL)
     {
       if (current->state == XML_STATE_INITIAL)
         {
@@ -748,15 +814,30 @@ xml_cb_start(svn_ra_serf__xml_context_t *xmlctx,
     }
   else
     {
-      /* Prep the new state.  */
-      new_xes = apr_pcalloc(new_pool, sizeof(*new_xes));
+      /* Prep the new state.  It doesn't need a pool of its own, so reuse
+         a previously closed state if we can.  */
+      new_xes = xmlctx->free_states;
+      if (new_xes)
+        {
+          xmlctx->free_states = new_xes->prev;
+          memset(new_xes, 0, sizeof(*new_xes));
+        }
+      else
+        new_xes = apr_pcalloc(xmlctx->estate_pool, sizeof(*new_xes));
+
+      new_xes->recycle = TRUE;
       /* STATE_POOL remains NULL.  */
     }
 
-  /* Some basic copies to set up the new estate.  */
+  /* Some basic copies to set up the new estate.  The namespace URL lives
+     in the pool of an outer state, and for specific transitions the name
+     equals the one in the table.  */
   new_xes->state = scan->to_state;
-  new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
-  new_xes->tag.xmlns = apr_pstrdup(new_pool, elemname.xmlns);
+  if (*scan->name == '*')
+    new_xes->tag.name = apr_pstrdup(new_pool, elemname.name);
+  else
+    new_xes->tag.name = scan->name;
+  new_xes->tag.xmlns = elemname.xmlns;
   new_xes->custom_close = scan->custom_close;
 
   /* Start with the parent's namespace set.  */
@@ -819,11 +900,7 @@ xml_cb_end(svn_ra_serf__xml_context_t *xmlctx,
 
   /* Pop the state.  */
   xmlctx->current = xes->prev;
-
-  /* ### not everything should go on the free state list. XES may go
-     ### away with the state pool.  */
-  xes->prev = xmlctx->free_states;
-  xmlctx->free_states = xes;
+  xmlctx->closed_any = TRUE;
 
   /* If there is a STATE_POOL, then toss it. This will get rid of as much
      memory as possible. Potentially the XES (if we didn't create a pool
@@ -831,6 +908,14 @@ xml_cb_end(svn_ra_serf__xml_context_t *xmlctx,
   if (xes->state_pool)
     svn_pool_destroy(xes->state_pool);
 
+  /* States without data of their own survive their pool and can be
+     reused for the next element.  */
+  if (xes->recycle)
+    {
+      xes->prev = xmlctx->free_states;
+      xmlctx->free_states = xes;
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -47,6 +47,7 @@
 #include "svn_mergeinfo.h"
 #include "svn_version.h"
 #include "svn_ctype.h"
+#include "svn_sorts.h"
 
 #include "svn_private_config.h"
 
@@ -604,6 +605,66 @@ static apr_status_t close_tunnel_cleanup(void *baton)
   return APR_SUCCESS; /* ignored */
 }
 
+/* Read the server's greeting from CONN and record its capabilities.
+   Return an error if we can't talk to that server.  Use POOL for
+   allocations. */
+static svn_error_t *
+read_greeting(svn_ra_svn_conn_t *conn,
+              apr_pool_t *pool)
+{
+  apr_uint64_t minver, maxver;
+  svn_ra_svn__list_t *mechlist, *server_caplist;
+
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "nnll", &minver, &maxver,
+                                        &mechlist, &server_caplist));
+
+  /* We support protocol version 2. */
+  if (minver > 2)
+    return svn_error_createf(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
+                             _("Server requires minimum version %d"),
+                             (int) minver);
+  if (maxver < 2)
+    return svn_error_createf(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
+                             _("Server only supports versions up to %d"),
+                             (int) maxver);
+  SVN_ERR(svn_ra_svn__set_capabilities(conn, server_caplist));
+
+  /* All released versions of Subversion support edit-pipeline,
+   * so we do not support servers that do not. */
+  if (! svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_EDIT_PIPELINE))
+    return svn_error_create(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
+                            _("Server does not support edit pipelining"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *USE_TLS to the svn-use-tls setting for the server of SESS.
+   Use POOL for temporary allocations. */
+static svn_error_t *
+get_use_tls(svn_tristate_t *use_tls,
+            svn_ra_svn__session_baton_t *sess,
+            apr_pool_t *pool)
+{
+  svn_config_t *cfg = NULL;
+  const char *server_group = NULL;
+
+  if (sess->config)
+    cfg = svn_hash_gets(sess->config, SVN_CONFIG_CATEGORY_SERVERS);
+  if (cfg)
+    server_group = svn_config_find_group(cfg, sess->hostname,
+                                         SVN_CONFIG_SECTION_GROUPS, pool);
+
+  SVN_ERR(svn_config_get_tristate(cfg, use_tls, SVN_CONFIG_SECTION_GLOBAL,
+                                  SVN_CONFIG_OPTION_SVN_USE_TLS, "auto",
+                                  svn_tristate_unknown));
+  if (server_group)
+    SVN_ERR(svn_config_get_tristate(cfg, use_tls, server_group,
+                                    SVN_CONFIG_OPTION_SVN_USE_TLS, "auto",
+                                    *use_tls));
+
+  return SVN_NO_ERROR;
+}
+
 /* Open a session to URL, returning it in *SESS_P, allocating it in POOL.
    URI is a parsed version of URL.  CALLBACKS and CALLBACKS_BATON
    are provided by the caller of ra_svn_open. If TUNNEL_NAME is not NULL,
@@ -626,8 +687,7 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
   svn_ra_svn__session_baton_t *sess;
   svn_ra_svn_conn_t *conn;
   apr_socket_t *sock;
-  apr_uint64_t minver, maxver;
-  svn_ra_svn__list_t *mechlist, *server_caplist, *repos_caplist;
+  svn_ra_svn__list_t *repos_caplist;
   const char *client_string = NULL;
   apr_pool_t *pool = result_pool;
   svn_ra_svn__parent_t *parent;
@@ -722,32 +782,50 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
   sess->conn = conn;
   conn->session = sess;
 
+  /* Don't burn CPU on compressing commit data for fast networks.  We never
+   * go beyond the default level, though, to keep the load predictable. */
+  svn_ra_svn__tune_compression(conn, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                               SVN_DELTA_COMPRESSION_LEVEL_DEFAULT);
+
   /* Read server's greeting. */
-  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "nnll", &minver, &maxver,
-                                        &mechlist, &server_caplist));
+  SVN_ERR(read_greeting(conn, pool));
 
-  /* We support protocol version 2. */
-  if (minver > 2)
-    return svn_error_createf(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
-                             _("Server requires minimum version %d"),
-                             (int) minver);
-  if (maxver < 2)
-    return svn_error_createf(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
-                             _("Server only supports versions up to %d"),
-                             (int) maxver);
-  SVN_ERR(svn_ra_svn__set_capabilities(conn, server_caplist));
+  /* Switch to TLS before sending the URL and any credentials.  Tunnels
+   * are secured by the tunnel agent already.  The response to the
+   * greeting does not carry the real URL; the server greets us again
+   * once the TLS session is up and we start over from there. */
+  if (!sess->is_tunneled)
+    {
+      svn_tristate_t use_tls;
 
-  /* All released versions of Subversion support edit-pipeline,
-   * so we do not support servers that do not. */
-  if (! svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_EDIT_PIPELINE))
-    return svn_error_create(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
-                            _("Server does not support edit pipelining"));
+      SVN_ERR(get_use_tls(&use_tls, sess, pool));
+      if (use_tls != svn_tristate_false
+          && svn_ra_svn__tls_supported()
+          && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_STARTTLS))
+        {
+          SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(ww)c",
+                                          (apr_uint64_t) 2,
+                                          SVN_RA_SVN_CAP_EDIT_PIPELINE,
+                                          SVN_RA_SVN_CAP_STARTTLS,
+                                          apr_uri_unparse(pool, uri,
+                                                   APR_URI_UNP_OMITUSERINFO
+                                                   | APR_URI_UNP_OMITPATHINFO)));
+          SVN_ERR(svn_ra_svn__tls_connect(sess, pool));
+
+          apr_hash_clear(conn->capabilities);
+          SVN_ERR(read_greeting(conn, pool));
+        }
+      else if (use_tls == svn_tristate_true)
+        return svn_error_createf(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                                 _("Can't use TLS with '%s'"),
+                                 sess->hostname);
+    }
 
   /* In protocol version 2, we send back our protocol version, our
    * capability list, and the URL, and subsequently there is an auth
    * request. */
   /* Client-side capabilities list: */
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww)cc(?c)",
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww?w)cc(?c)",
                                   (apr_uint64_t) 2,
                                   SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                   SVN_RA_SVN_CAP_SVNDIFF1,
@@ -756,6 +834,9 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
                                   SVN_RA_SVN_CAP_DEPTH,
                                   SVN_RA_SVN_CAP_MERGEINFO,
                                   SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                  svn__zstd_supported()
+                                    ? SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED
+                                    : NULL,
                                   url,
                                   SVN_RA_SVN__DEFAULT_USERAGENT,
                                   client_string));
@@ -1593,9 +1674,9 @@ static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
       if (elt->kind != SVN_RA_SVN_LIST)
         return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
                                 _("Dirlist element not a list"));
-      SVN_ERR(svn_ra_svn__parse_tuple(&elt->u.list, "cwnbr(?c)(?c)",
-                                      &name, &kind, &size, &has_props,
-                                      &crev, &cdate, &cauthor));
+      SVN_ERR(svn_ra_svn__read_data_dir_entry(&elt->u.list,
+                                              &name, &kind, &size, &has_props,
+                                              &crev, &cdate, &cauthor));
 
       /* Nothing to sanitize here.  Any multi-segment path is simply
          illegal in the hash returned by svn_ra_get_dir2. */
@@ -1919,7 +2000,7 @@ perform_ra_svn_log(svn_error_t **outer_error,
       apr_uint64_t has_children_param, invalid_revnum_param;
       apr_uint64_t has_subtractive_merge_param;
       svn_string_t *author, *date, *message;
-      svn_ra_svn__list_t *cplist, *rplist;
+      const svn_ra_svn__list_t *cplist, *rplist;
       svn_log_entry_t *log_entry;
       svn_boolean_t has_children;
       svn_boolean_t subtractive_merge = FALSE;
@@ -1935,13 +2016,12 @@ perform_ra_svn_log(svn_error_t **outer_error,
       if (item->kind != SVN_RA_SVN_LIST)
         return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
                                 _("Log entry not a list"));
-      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list,
-                                      "lr(?s)(?s)(?s)?BBnl?B",
-                                      &cplist, &rev, &author, &date,
-                                      &message, &has_children_param,
-                                      &invalid_revnum_param,
-                                      &revprop_count, &rplist,
-                                      &has_subtractive_merge_param));
+      SVN_ERR(svn_ra_svn__read_data_log_entry(&item->u.list,
+                                              &cplist, &rev, &author, &date,
+                                              &message, &has_children_param,
+                                              &invalid_revnum_param,
+                                              &revprop_count, &rplist,
+                                              &has_subtractive_merge_param));
       if (want_custom_revprops && rplist == NULL)
         {
           /* Caller asked for custom revprops, but server is too old. */
@@ -2136,17 +2216,17 @@ static svn_error_t *handle_unsupported_cmd(svn_error_t *err,
 }
 
 
-static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
-                                const char *path, svn_revnum_t rev,
-                                svn_dirent_t **dirent, apr_pool_t *pool)
+/* Read the response to a "stat" command from SESS_BATON's connection
+   and return the dirent it describes, or NULL, in *DIRENT.  Allocate it
+   in POOL. */
+static svn_error_t *read_stat_response(svn_dirent_t **dirent,
+                                       svn_ra_svn__session_baton_t *sess_baton,
+                                       apr_pool_t *pool)
 {
-  svn_ra_svn__session_baton_t *sess_baton = session->priv;
   svn_ra_svn_conn_t *conn = sess_baton->conn;
   svn_ra_svn__list_t *list = NULL;
   svn_dirent_t *the_dirent;
 
-  path = reparent_path(session, path, pool);
-  SVN_ERR(svn_ra_svn__write_cmd_stat(conn, pool, path, rev));
   SVN_ERR(handle_unsupported_cmd(handle_auth_request(sess_baton, pool),
                                  N_("'stat' not implemented")));
   SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "(?l)", &list));
@@ -2180,6 +2260,93 @@ static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *ra_svn_stat(svn_ra_session_t *session,
+                                const char *path, svn_revnum_t rev,
+                                svn_dirent_t **dirent, apr_pool_t *pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+
+  path = reparent_path(session, path, pool);
+  SVN_ERR(svn_ra_svn__write_cmd_stat(conn, pool, path, rev));
+
+  return svn_error_trace(read_stat_response(dirent, sess_baton, pool));
+}
+
+/* The maximum number of "stat" commands sent in one batch.  The server
+   reads a whole batch before it responds, so this limits its memory use
+   rather than the number of round trips saved. */
+#define STAT_BATCH_SIZE 64
+
+static svn_error_t *ra_svn_stat_many(svn_ra_session_t *session,
+                                     apr_hash_t **dirents,
+                                     const apr_array_header_t *paths,
+                                     svn_revnum_t rev,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_boolean_t use_batch
+    = svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_COMMAND_BATCH);
+  svn_error_t *err = SVN_NO_ERROR;
+  int first, last, i;
+
+  *dirents = apr_hash_make(result_pool);
+  for (first = 0; first < paths->nelts && !err; first = last)
+    {
+      /* Older servers get one command at a time. */
+      if (use_batch)
+        last = MIN(first + STAT_BATCH_SIZE, paths->nelts);
+      else
+        last = first + 1;
+
+      svn_pool_clear(iterpool);
+
+      if (use_batch)
+        SVN_ERR(svn_ra_svn__write_cmd_batch_start(conn, iterpool));
+      for (i = first; i < last; i++)
+        {
+          const char *path = APR_ARRAY_IDX(paths, i, const char *);
+
+          SVN_ERR(svn_ra_svn__write_cmd_stat(conn, iterpool,
+                                             reparent_path(session, path,
+                                                           iterpool),
+                                             rev));
+        }
+      if (use_batch)
+        SVN_ERR(svn_ra_svn__write_cmd_batch_end(conn, iterpool));
+
+      /* The server responds to every command of the batch, even after
+         one of them failed.  Read all of the responses to stay in sync
+         and report the first error. */
+      for (i = first; i < last; i++)
+        {
+          const char *path = APR_ARRAY_IDX(paths, i, const char *);
+          svn_dirent_t *dirent;
+          svn_error_t *stat_err;
+
+          stat_err = read_stat_response(&dirent, sess_baton, iterpool);
+          if (stat_err)
+            {
+              if (err)
+                svn_error_clear(stat_err);
+              else
+                err = stat_err;
+            }
+          else if (dirent && !err)
+            {
+              svn_hash_sets(*dirents, apr_pstrdup(result_pool, path),
+                            svn_dirent_dup(dirent, result_pool));
+            }
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(err);
+}
+
 
 static svn_error_t *ra_svn_get_locations(svn_ra_session_t *session,
                                          apr_hash_t **locations,
@@ -2358,6 +2525,7 @@ static svn_error_t *ra_svn_get_file_revs(svn_ra_session_t *session,
   apr_pool_t *rev_pool, *chunk_pool;
   svn_boolean_t has_txdelta;
   svn_boolean_t had_revision = FALSE;
+  svn_error_t *outer_error = SVN_NO_ERROR;
 
   /* One sub-pool for each revision and one for each txdelta chunk.
      Note that the rev_pool must live during the following txdelta. */
@@ -2415,9 +2583,23 @@ static svn_error_t *ra_svn_get_file_revs(svn_ra_session_t *session,
                                 _("Text delta chunk not a string"));
       has_txdelta = item->u.string.len > 0;
 
-      SVN_ERR(handler(handler_baton, p, rev, rev_props, merged_rev,
-                      has_txdelta ? &d_handler : NULL, &d_baton,
-                      props, rev_pool));
+      /* Once the handler asked us to stop, just consume the rest of the
+         response such that the connection remains usable. */
+      d_handler = NULL;
+      if (!outer_error)
+        {
+          svn_error_t *err = handler(handler_baton, p, rev, rev_props,
+                                     merged_rev,
+                                     has_txdelta ? &d_handler : NULL,
+                                     &d_baton, props, rev_pool);
+          if (svn_error_find_cause(err, SVN_ERR_CEASE_INVOCATION))
+            {
+              outer_error = err;
+              d_handler = NULL;
+            }
+          else
+            SVN_ERR(err);
+        }
 
       /* Process the text delta if any. */
       if (has_txdelta)
@@ -2435,7 +2617,18 @@ static svn_error_t *ra_svn_get_file_revs(svn_ra_session_t *session,
 
               size = item->u.string.len;
               if (stream)
-                SVN_ERR(svn_stream_write(stream, item->u.string.data, &size));
+                {
+                  svn_error_t *err = svn_stream_write(stream,
+                                                      item->u.string.data,
+                                                      &size);
+                  if (svn_error_find_cause(err, SVN_ERR_CEASE_INVOCATION))
+                    {
+                      outer_error = err;
+                      stream = NULL;
+                    }
+                  else
+                    SVN_ERR(err);
+                }
               svn_pool_clear(chunk_pool);
 
               SVN_ERR(svn_ra_svn__read_item(sess_baton->conn, chunk_pool,
@@ -2445,11 +2638,19 @@ static svn_error_t *ra_svn_get_file_revs(svn_ra_session_t *session,
                                         _("Text delta chunk not a string"));
             }
           if (stream)
-            SVN_ERR(svn_stream_close(stream));
+            {
+              svn_error_t *err = svn_stream_close(stream);
+              if (svn_error_find_cause(err, SVN_ERR_CEASE_INVOCATION))
+                outer_error = err;
+              else
+                SVN_ERR(err);
+            }
         }
     }
 
-  SVN_ERR(svn_ra_svn__read_cmd_response(sess_baton->conn, pool, ""));
+  SVN_ERR(svn_error_compose_create(
+            svn_ra_svn__read_cmd_response(sess_baton->conn, pool, ""),
+            outer_error));
 
   /* Return error if we didn't get any revisions. */
   if (!had_revision)
@@ -2463,6 +2664,70 @@ static svn_error_t *ra_svn_get_file_revs(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *ra_svn_blame(svn_ra_session_t *session,
+                                 const char *path,
+                                 svn_revnum_t start, svn_revnum_t end,
+                                 const svn_diff_file_options_t *diff_options,
+                                 svn_blame_run_receiver_t receiver,
+                                 void *receiver_baton,
+                                 apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  const char *ignore_space = "none";
+  svn_boolean_t ignore_eol_style = FALSE;
+
+  if (diff_options)
+    {
+      if (diff_options->ignore_space == svn_diff_file_ignore_space_change)
+        ignore_space = "change";
+      else if (diff_options->ignore_space == svn_diff_file_ignore_space_all)
+        ignore_space = "all";
+      ignore_eol_style = diff_options->ignore_eol_style;
+    }
+
+  path = reparent_path(session, path, scratch_pool);
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w(c(?r)(?r)wb)",
+                                  "blame", path, start, end, ignore_space,
+                                  ignore_eol_style));
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Read the runs of lines until "done". */
+  while (1)
+    {
+      svn_ra_svn__item_t *item;
+      svn_ra_svn__list_t *rev_proplist;
+      apr_uint64_t start_line, line_count;
+      svn_revnum_t rev;
+      apr_hash_t *rev_props = NULL;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
+      if (is_done_response(item))
+        break;
+      if (item->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Blame entry not a list"));
+
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "nn(?r)l",
+                                      &start_line, &line_count, &rev,
+                                      &rev_proplist));
+      if (SVN_IS_VALID_REVNUM(rev))
+        SVN_ERR(svn_ra_svn__parse_proplist(rev_proplist, iterpool,
+                                           &rev_props));
+
+      SVN_ERR(receiver(receiver_baton, (apr_int64_t)start_line,
+                       (apr_int64_t)line_count, rev, rev_props, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_ra_svn__read_cmd_response(conn, scratch_pool,
+                                                       ""));
+}
+
 /* For each path in PATH_REVS, send a 'lock' command to the server.
    Used with 1.2.x series servers which support locking, but of only
    one path at a time.  ra_svn_lock(), which supports 'lock-many'
@@ -3076,6 +3341,7 @@ ra_svn_has_capability(svn_ra_session_t *session,
       {SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE,
                                        SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE},
       {SVN_RA_CAPABILITY_LIST, SVN_RA_SVN_CAP_LIST},
+      {SVN_RA_CAPABILITY_BLAME, SVN_RA_SVN_CAP_BLAME},
 
       {NULL, NULL} /* End of list marker */
   };
@@ -3298,6 +3564,8 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   ra_svn_get_inherited_props,
   NULL /* ra_set_svn_ra_open */,
   ra_svn_list,
+  ra_svn_stat_many,
+  ra_svn_blame,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -42,6 +42,7 @@
 #include "svn_ctype.h"
 #include "svn_sorts.h"
 #include "svn_time.h"
+#include "svn_io.h"
 
 #include "ra_svn.h"
 
@@ -49,6 +50,7 @@
 #include "private/svn_dep_compat.h"
 #include "private/svn_error_private.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_stats.h"
 
 #define svn_iswhitespace(c) ((c) == ' ' || (c) == '\n')
 
@@ -195,10 +197,11 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
 
   assert((sock && !in_stream && !out_stream)
          || (!sock && in_stream && out_stream));
-#ifdef SVN_HAVE_SASL
   conn->sock = sock;
+#ifdef SVN_HAVE_SASL
   conn->encrypted = FALSE;
 #endif
+  conn->tls = FALSE;
   conn->session = NULL;
   conn->read_ptr = conn->read_buf;
   conn->read_end = conn->read_buf;
@@ -210,11 +213,13 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
   conn->current_in = 0;
   conn->max_out = max_out;
   conn->current_out = 0;
+  conn->command_start = 0;
   conn->block_handler = NULL;
   conn->block_baton = NULL;
   conn->capabilities = apr_hash_make(result_pool);
   conn->compression_level = compression_level;
   conn->zero_copy_limit = zero_copy_limit;
+  conn->tune_compression = FALSE;
   conn->pool = result_pool;
 
   if (sock != NULL)
@@ -273,13 +278,24 @@ svn_ra_svn__svndiff_version(svn_ra_svn_conn_t *conn)
   if (svn_ra_svn_compression_level(conn) <= 0)
     return 0;
 
-  /* Prefer SVNDIFF2 over SVNDIFF1. */
+  /* When CPU time is what limits the throughput, the fast LZ4 of SVNDIFF2
+   * is preferable to stronger compression. */
+  if (conn->tune_compression
+      && conn->compression_level < SVN_DELTA_COMPRESSION_LEVEL_DEFAULT
+      && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED))
+    return 2;
+
+  /* Prefer SVNDIFF3 over SVNDIFF2 over SVNDIFF1.  We can only produce
+   * svndiff3 if we have been built with Zstandard support. */
+  if (svn__zstd_supported()
+      && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED))
+    return 3;
   if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED))
     return 2;
   if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF1))
     return 1;
 
-  /* The connection does not support SVNDIFF1/2; default to "version 0". */
+  /* The connection does not support SVNDIFF1/2/3; default to "version 0". */
   return 0;
 }
 
@@ -309,6 +325,22 @@ svn_ra_svn_compression_level(svn_ra_svn_conn_t *conn)
   return conn->compression_level;
 }
 
+void
+svn_ra_svn__tune_compression(svn_ra_svn_conn_t *conn,
+                             int min_level,
+                             int max_level)
+{
+  conn->tune_compression = TRUE;
+  conn->min_compression_level = min_level;
+  conn->max_compression_level = max_level;
+  conn->compression_level = MAX(min_level,
+                                MIN(max_level, conn->compression_level));
+  conn->tuning_start = apr_time_now();
+  conn->write_time = 0;
+  conn->read_time = 0;
+  conn->tuning_bytes = 0;
+}
+
 apr_size_t
 svn_ra_svn_zero_copy_limit(svn_ra_svn_conn_t *conn)
 {
@@ -336,6 +368,12 @@ svn_error_t *svn_ra_svn__data_available(svn_ra_svn_conn_t *conn,
   return svn_ra_svn__stream_data_available(conn->stream, data_available);
 }
 
+apr_time_t
+svn_ra_svn__command_start_time(svn_ra_svn_conn_t *conn)
+{
+  return conn->command_start;
+}
+
 void
 svn_ra_svn__reset_command_io_counters(svn_ra_svn_conn_t *conn)
 {
@@ -363,6 +401,43 @@ check_io_limits(svn_ra_svn_conn_t *conn)
   return SVN_NO_ERROR;
 }
 
+/* Account for LEN bytes having been sent by CONN, the last of them at
+ * NOW.  Once enough data has been sent, adapt the compression level:
+ * If most of the busy time went into waiting for the network, spend more
+ * CPU on compression.  If the network was hardly ever the bottleneck,
+ * spend less. */
+static void
+tune_compression(svn_ra_svn_conn_t *conn,
+                 apr_size_t len,
+                 apr_time_t now)
+{
+  apr_time_t busy_time;
+
+  conn->tuning_bytes += len;
+  if (conn->tuning_bytes < SVN_RA_SVN__TUNING_SAMPLE_SIZE)
+    return;
+
+  busy_time = now - conn->tuning_start - conn->read_time;
+  if (busy_time > 0)
+    {
+      if (conn->write_time > busy_time / 2)
+        conn->compression_level = MIN(conn->compression_level + 1,
+                                      conn->max_compression_level);
+      else if (conn->write_time < busy_time / 10)
+        conn->compression_level = MAX(conn->compression_level - 1,
+                                      conn->min_compression_level);
+    }
+
+  conn->tuning_start = now;
+  conn->write_time = 0;
+  conn->read_time = 0;
+  conn->tuning_bytes = 0;
+}
+
+/* Bytes written to the network and time spent doing so. */
+SVN__COUNTER_DEFINE(bytes_sent, "ra_svn.bytes_sent");
+SVN__COUNTER_DEFINE(write_timer, "ra_svn.write_wait");
+
 /* Write data to socket or output file as appropriate. */
 static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                     const char *data, apr_size_t len)
@@ -371,6 +446,8 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   apr_size_t count;
   apr_pool_t *subpool = NULL;
   svn_ra_svn__session_baton_t *session = conn->session;
+  apr_time_t start = conn->tune_compression ? apr_time_now() : 0;
+  apr_time_t write_start;
 
   /* Limit the size of the response, if a limit has been configured.
    * This is to limit the server load in case users e.g. accidentally ran
@@ -378,6 +455,8 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
   conn->current_out += len;
   SVN_ERR(check_io_limits(conn));
 
+  SVN__COUNTER_ADD(bytes_sent, len);
+  SVN__TIMER_START(write_timer, write_start);
   while (data < end)
     {
       count = end - data;
@@ -406,11 +485,19 @@ static svn_error_t *writebuf_output(svn_ra_svn_conn_t *conn, apr_pool_t *pool,
                                 -1, cb->progress_baton, subpool);
         }
     }
+  SVN__TIMER_STOP(write_timer, write_start);
 
   conn->written_since_error_check += len;
   conn->may_check_for_error
     = conn->written_since_error_check >= conn->error_check_interval;
 
+  if (conn->tune_compression)
+    {
+      apr_time_t now = apr_time_now();
+      conn->write_time += now - start;
+      tune_compression(conn, len, now);
+    }
+
   if (subpool)
     svn_pool_destroy(subpool);
   return SVN_NO_ERROR;
@@ -490,6 +577,8 @@ static char *readbuf_drain(svn_ra_svn_conn_t *conn, char *data, char *end)
   return data + copylen;
 }
 
+SVN__COUNTER_DEFINE(bytes_received, "ra_svn.bytes_received");
+
 /* Read data from socket or input file as appropriate. */
 static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
                                   apr_size_t *len, apr_pool_t *pool)
@@ -505,10 +594,19 @@ static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
   SVN_ERR(check_io_limits(conn));
 
   /* Actually fill the buffer. */
-  SVN_ERR(svn_ra_svn__stream_read(conn->stream, data, len));
+  if (conn->tune_compression)
+    {
+      apr_time_t start = apr_time_now();
+      SVN_ERR(svn_ra_svn__stream_read(conn->stream, data, len));
+      conn->read_time += apr_time_now() - start;
+    }
+  else
+    SVN_ERR(svn_ra_svn__stream_read(conn->stream, data, len));
+
   if (*len == 0)
     return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
   conn->current_in += *len;
+  SVN__COUNTER_ADD(bytes_received, *len);
 
   if (session)
     {
@@ -762,6 +860,94 @@ svn_ra_svn__write_string(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Send LEN bytes at OFFSET in FILE over CONN as the contents of a string
+ * whose length prefix has already been written.  Use BUF, of at least
+ * LEN bytes, for copying if the data can't be handed to the kernel
+ * directly.
+ */
+static svn_error_t *
+writebuf_write_file(svn_ra_svn_conn_t *conn,
+                    apr_pool_t *pool,
+                    apr_file_t *file,
+                    apr_off_t offset,
+                    apr_size_t len,
+                    char *buf)
+{
+#if APR_HAS_SENDFILE
+  /* Only plain sockets can be fed from files.  Encrypted connections
+   * and those with a block handler need to go through CONN->STREAM. */
+  if (conn->sock && !conn->block_handler && !conn->tls
+#ifdef SVN_HAVE_SASL
+      && !conn->encrypted
+#endif
+     )
+    {
+      apr_size_t remaining = len;
+      apr_time_t write_start;
+
+      SVN_ERR(writebuf_flush(conn, pool));
+
+      conn->current_out += len;
+      SVN_ERR(check_io_limits(conn));
+
+      SVN__COUNTER_ADD(bytes_sent, len);
+      SVN__TIMER_START(write_timer, write_start);
+      while (remaining > 0)
+        {
+          apr_off_t pos = offset;
+          apr_size_t count = remaining;
+          apr_status_t status = apr_socket_sendfile(conn->sock, file, NULL,
+                                                    &pos, &count, 0);
+          if (status && !(APR_STATUS_IS_EAGAIN(status) && count > 0))
+            return svn_error_wrap_apr(status,
+                                      _("Can't write to connection"));
+
+          offset += count;
+          remaining -= count;
+        }
+      SVN__TIMER_STOP(write_timer, write_start);
+
+      conn->written_since_error_check += len;
+      conn->may_check_for_error
+        = conn->written_since_error_check >= conn->error_check_interval;
+
+      return SVN_NO_ERROR;
+    }
+#endif
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, pool));
+  SVN_ERR(svn_io_file_read_full2(file, buf, len, NULL, NULL, pool));
+
+  return svn_error_trace(writebuf_write(conn, pool, buf, len));
+}
+
+svn_error_t *
+svn_ra_svn__write_file_range(svn_ra_svn_conn_t *conn,
+                             apr_pool_t *pool,
+                             apr_file_t *file,
+                             apr_off_t offset,
+                             svn_filesize_t length)
+{
+  char *buf = NULL;
+
+  while (length > 0)
+    {
+      apr_size_t len = (apr_size_t)MIN(length, SVN_RA_SVN__FILE_CHUNK_SIZE);
+
+      if (!buf)
+        buf = apr_palloc(pool, SVN_RA_SVN__FILE_CHUNK_SIZE);
+
+      SVN_ERR(write_number(conn, pool, len, ':'));
+      SVN_ERR(writebuf_write_file(conn, pool, file, offset, len, buf));
+      SVN_ERR(writebuf_writechar(conn, pool, ' '));
+
+      offset += len;
+      length -= len;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__write_cstring(svn_ra_svn_conn_t *conn,
                           apr_pool_t *pool,
@@ -1025,6 +1211,22 @@ write_tuple_string_opt_list(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Optimized sending code for the "(?c)" pattern. */
+static svn_error_t *
+write_tuple_cstring_opt_list(svn_ra_svn_conn_t *conn,
+                             apr_pool_t *pool,
+                             const char *cstr)
+{
+  svn_string_t str;
+
+  if (!cstr)
+    return write_tuple_string_opt_list(conn, pool, NULL);
+
+  str.data = cstr;
+  str.len = strlen(cstr);
+  return write_tuple_string_opt_list(conn, pool, &str);
+}
+
 static svn_error_t *
 write_tuple_start_list(svn_ra_svn_conn_t *conn,
                        apr_pool_t *pool)
@@ -1593,6 +1795,131 @@ svn_ra_svn__has_item(svn_boolean_t *has_item,
   return SVN_NO_ERROR;
 }
 
+/* Set *COMPLETE to TRUE if the data in [BEGIN, END) starts with a full
+   top-level tuple, i.e. a whole command.  Data that can't be the start
+   of a command counts as complete as well, so that the regular parser
+   gets to report it.  Leading whitespace must have been skipped.
+ */
+static void
+scan_for_tuple(svn_boolean_t *complete,
+               const char *begin,
+               const char *end)
+{
+  const char *p = begin;
+  int depth = 0;
+
+  *complete = TRUE;
+  if (*p != '(')
+    return;
+
+  while (p < end)
+    {
+      char c = *p;
+
+      if (svn_iswhitespace(c))
+        {
+          ++p;
+        }
+      else if (c == '(')
+        {
+          ++depth;
+          ++p;
+        }
+      else if (c == ')')
+        {
+          if (--depth == 0)
+            return;
+          ++p;
+        }
+      else if (svn_ctype_isdigit(c))
+        {
+          apr_uint64_t len = 0;
+
+          while (p < end && svn_ctype_isdigit(*p))
+            {
+              len = 10 * len + (*p - '0');
+              if (len > SVN_RA_SVN__READBUF_SIZE)
+                return;
+              ++p;
+            }
+
+          /* A string: skip its contents. */
+          if (p < end && *p == ':')
+            {
+              if ((apr_uint64_t)(end - p - 1) < len)
+                break;
+              p += 1 + len;
+            }
+        }
+      else if (svn_ctype_isalpha(c))
+        {
+          while (p < end && (svn_ctype_isalnum(*p) || *p == '-'))
+            ++p;
+        }
+      else
+        {
+          return;
+        }
+    }
+
+  *complete = FALSE;
+}
+
+/* Like svn_ra_svn__has_item but set *HAS_COMMAND only if the receive
+   buffer of CONN contains a whole command, reading more data as long
+   as it is available without blocking.  A command too large for the
+   buffer counts as complete.
+ */
+static svn_error_t *
+has_complete_command(svn_boolean_t *has_command,
+                     svn_ra_svn_conn_t *conn,
+                     apr_pool_t *pool)
+{
+  SVN_ERR(svn_ra_svn__has_item(has_command, conn, pool));
+  while (*has_command)
+    {
+      svn_boolean_t available;
+      apr_size_t len;
+
+      scan_for_tuple(has_command, conn->read_ptr, conn->read_end);
+      if (*has_command)
+        break;
+
+      /* Move the partial command to the front of the buffer and append
+         whatever else has arrived, so parsing can resume where the
+         client's data ended. */
+      if (conn->read_ptr != conn->read_buf)
+        {
+          len = conn->read_end - conn->read_ptr;
+          memmove(conn->read_buf, conn->read_ptr, len);
+          conn->read_ptr = conn->read_buf;
+          conn->read_end = conn->read_buf + len;
+        }
+
+      if (conn->read_end == conn->read_buf + sizeof(conn->read_buf))
+        {
+          *has_command = TRUE;
+          break;
+        }
+
+      /* The client may be waiting for our response before it sends
+         the rest. */
+      if (conn->write_pos)
+        SVN_ERR(writebuf_flush(conn, pool));
+
+      SVN_ERR(svn_ra_svn__data_available(conn, &available));
+      if (!available)
+        break;
+
+      len = conn->read_buf + sizeof(conn->read_buf) - conn->read_end;
+      SVN_ERR(readbuf_input(conn, conn->read_end, &len, pool));
+      conn->read_end += len;
+      *has_command = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__skip_leading_garbage(svn_ra_svn_conn_t *conn,
                                  apr_pool_t *pool)
@@ -1852,6 +2179,9 @@ svn_ra_svn__handle_failure_status(const svn_ra_svn__list_t *params)
   return err;
 }
 
+/* Each command response marks the end of one client round-trip. */
+SVN__COUNTER_DEFINE(round_trips, "ra_svn.round_trips");
+
 svn_error_t *
 svn_ra_svn__read_cmd_response(svn_ra_svn_conn_t *conn,
                               apr_pool_t *pool,
@@ -1863,6 +2193,7 @@ svn_ra_svn__read_cmd_response(svn_ra_svn_conn_t *conn,
   svn_error_t *err;
 
   SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "wl", &status, &params));
+  SVN__COUNTER_INC(round_trips);
   if (strcmp(status, "success") == 0)
     {
       va_start(ap, fmt);
@@ -1903,6 +2234,116 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
   return svn_error_trace(err);
 }
 
+svn_error_t *
+svn_ra_svn__has_complete_command(svn_boolean_t *has_command,
+                                 svn_boolean_t *terminated,
+                                 svn_ra_svn_conn_t *conn,
+                                 apr_pool_t *pool)
+{
+  svn_error_t *err;
+
+  svn_ra_svn__reset_command_io_counters(conn);
+
+  err = has_complete_command(has_command, conn, pool);
+  if (err && err->apr_err == SVN_ERR_RA_SVN_CONNECTION_CLOSED)
+    {
+      *terminated = TRUE;
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  *terminated = FALSE;
+  return svn_error_trace(err);
+}
+
+const char *
+svn_ra_svn__peek_command(svn_ra_svn_conn_t *conn,
+                         apr_pool_t *pool)
+{
+  const char *p = conn->read_ptr;
+  const char *end = conn->read_end;
+  const char *start;
+
+  /* Skip to the first word within the command tuple. */
+  while (p < end && svn_iswhitespace(*p))
+    ++p;
+  if (p == end || *p != '(')
+    return NULL;
+
+  for (++p; p < end && svn_iswhitespace(*p); ++p)
+    ;
+  if (p == end || !svn_ctype_isalpha(*p))
+    return NULL;
+
+  /* The word must be followed by whitespace within the buffer. */
+  for (start = p; p < end && (svn_ctype_isalnum(*p) || *p == '-'); ++p)
+    ;
+  if (p == end || !svn_iswhitespace(*p))
+    return NULL;
+
+  return apr_pstrmemdup(pool, start, p - start);
+}
+
+svn_error_t *
+svn_ra_svn__handle_batch(svn_ra_svn_conn_t *conn,
+                         apr_pool_t *pool,
+                         const svn_ra_svn__list_t *params,
+                         const svn_ra_svn__cmd_entry_t *commands,
+                         void *baton)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < params->nelts; i++)
+    {
+      const svn_ra_svn__item_t *item = &SVN_RA_SVN__LIST_ITEM(params, i);
+      const svn_ra_svn__cmd_entry_t *command;
+      const char *cmdname;
+      svn_ra_svn__list_t *cmd_params;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      if (item->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Malformed batch command"));
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "wl",
+                                      &cmdname, &cmd_params));
+
+      /* Only commands listed in COMMANDS may be batched. */
+      for (command = commands; command->cmdname; command++)
+        if (strcmp(command->cmdname, cmdname) == 0)
+          break;
+
+      if (command->cmdname && command->handler && !command->terminate)
+        err = (*command->handler)(conn, iterpool, cmd_params, baton);
+      else
+        err = svn_error_create(SVN_ERR_RA_SVN_CMD_ERR,
+                               svn_error_createf(SVN_ERR_RA_SVN_UNKNOWN_CMD,
+                                                 NULL,
+                                                 _("Unknown command '%s' "
+                                                   "in batch"), cmdname),
+                               NULL);
+
+      err = svn_error_compose_create(check_io_limits(conn), err);
+      if (err && err->apr_err == SVN_ERR_RA_SVN_CMD_ERR)
+        {
+          svn_error_t *write_err = svn_ra_svn__write_cmd_failure(
+                                     conn, iterpool,
+                                     svn_ra_svn__locate_real_error_child(err));
+          svn_error_clear(err);
+          SVN_ERR(write_err);
+        }
+      else if (err)
+        {
+          return svn_error_trace(err);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__handle_command(svn_boolean_t *terminate,
                            apr_hash_t *cmd_hash,
@@ -1934,6 +2375,7 @@ svn_ra_svn__handle_command(svn_boolean_t *terminate,
       return err;
     }
 
+  conn->command_start = apr_time_now();
   command = svn_hash_gets(cmd_hash, cmdname);
   if (command)
     {
@@ -2567,6 +3009,20 @@ svn_ra_svn__write_cmd_check_path(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_svn__write_cmd_batch_start(svn_ra_svn_conn_t *conn,
+                                  apr_pool_t *pool)
+{
+  return svn_error_trace(writebuf_write_literal(conn, pool, "( batch ( "));
+}
+
+svn_error_t *
+svn_ra_svn__write_cmd_batch_end(svn_ra_svn_conn_t *conn,
+                                apr_pool_t *pool)
+{
+  return svn_error_trace(writebuf_write_literal(conn, pool, ") ) "));
+}
+
 svn_error_t *
 svn_ra_svn__write_cmd_stat(svn_ra_svn_conn_t *conn,
                            apr_pool_t *pool,
@@ -2992,6 +3448,32 @@ svn_ra_svn__write_dirent(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_ra_svn__write_data_dir_entry(svn_ra_svn_conn_t *conn,
+                                 apr_pool_t *pool,
+                                 const char *name,
+                                 svn_node_kind_t kind,
+                                 svn_filesize_t size,
+                                 svn_boolean_t has_props,
+                                 svn_revnum_t created_rev,
+                                 const char *cdate,
+                                 const char *last_author)
+{
+  const char *kind_word = svn_node_kind_to_word(kind);
+
+  SVN_ERR(write_tuple_start_list(conn, pool));
+  SVN_ERR(write_tuple_cstring(conn, pool, name));
+  SVN_ERR(svn_ra_svn__write_word(conn, pool, kind_word));
+  SVN_ERR(svn_ra_svn__write_number(conn, pool, (apr_uint64_t)size));
+  SVN_ERR(write_tuple_boolean(conn, pool, has_props));
+  SVN_ERR(write_tuple_revision(conn, pool, created_rev));
+  SVN_ERR(write_tuple_cstring_opt_list(conn, pool, cdate));
+  SVN_ERR(write_tuple_cstring_opt_list(conn, pool, last_author));
+  SVN_ERR(write_tuple_end_list(conn, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* If condition COND is not met, return a "malformed network data" error.
  */
 #define CHECK_PROTOCOL_COND(cond)\
@@ -3074,6 +3556,20 @@ svn_ra_svn__read_boolean(const svn_ra_svn__list_t *items,
   return SVN_NO_ERROR;
 }
 
+/* In *RESULT, return the number at index IDX in tuple ITEMS.
+ */
+static svn_error_t *
+svn_ra_svn__read_number(const svn_ra_svn__list_t *items,
+                        int idx,
+                        apr_uint64_t *result)
+{
+  svn_ra_svn__item_t *elt = &SVN_RA_SVN__LIST_ITEM(items, idx);
+  CHECK_PROTOCOL_COND(elt->kind == SVN_RA_SVN_NUMBER);
+  *result = elt->u.number;
+
+  return SVN_NO_ERROR;
+}
+
 /* In *RESULT, return the tuple at index IDX in tuple ITEMS.
  */
 static svn_error_t *
@@ -3099,6 +3595,97 @@ svn_ra_svn__read_check_array_size(const svn_ra_svn__list_t *items,
   return SVN_NO_ERROR;
 }
 
+/* In *RESULT, return the string in the optional tuple at index IDX in
+ * tuple ITEMS, i.e. the "(?s)" pattern, or NULL if it is empty.
+ */
+static svn_error_t *
+svn_ra_svn__read_string_opt_list(const svn_ra_svn__list_t *items,
+                                 int idx,
+                                 svn_string_t **result)
+{
+  const svn_ra_svn__list_t *sub_items;
+
+  SVN_ERR(svn_ra_svn__read_list(items, idx, &sub_items));
+  if (sub_items->nelts)
+    SVN_ERR(svn_ra_svn__read_string(sub_items, 0, result));
+  else
+    *result = NULL;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_svn__read_data_dir_entry(const svn_ra_svn__list_t *items,
+                                const char **name,
+                                const char **kind_word,
+                                apr_uint64_t *size,
+                                svn_boolean_t *has_props,
+                                svn_revnum_t *created_rev,
+                                const char **cdate,
+                                const char **last_author)
+{
+  apr_uint64_t props;
+  svn_string_t *str;
+
+  SVN_ERR(svn_ra_svn__read_check_array_size(items, 7, INT_MAX));
+  SVN_ERR(svn_ra_svn__read_cstring(items, 0, name));
+  SVN_ERR(svn_ra_svn__read_word(items, 1, kind_word));
+  SVN_ERR(svn_ra_svn__read_number(items, 2, size));
+  SVN_ERR(svn_ra_svn__read_boolean(items, 3, &props));
+  SVN_ERR(svn_ra_svn__read_revision(items, 4, created_rev));
+
+  SVN_ERR(svn_ra_svn__read_string_opt_list(items, 5, &str));
+  *cdate = str ? str->data : NULL;
+  SVN_ERR(svn_ra_svn__read_string_opt_list(items, 6, &str));
+  *last_author = str ? str->data : NULL;
+
+  *has_props = (svn_boolean_t)props;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_svn__read_data_log_entry(const svn_ra_svn__list_t *items,
+                                const svn_ra_svn__list_t **changed_paths,
+                                svn_revnum_t *revision,
+                                svn_string_t **author,
+                                svn_string_t **date,
+                                svn_string_t **message,
+                                apr_uint64_t *has_children,
+                                apr_uint64_t *invalid_revnum,
+                                apr_uint64_t *revprop_count,
+                                const svn_ra_svn__list_t **revprops,
+                                apr_uint64_t *subtractive_merge)
+{
+  /* initialize optional values */
+  *has_children = SVN_RA_SVN_UNSPECIFIED_NUMBER;
+  *invalid_revnum = SVN_RA_SVN_UNSPECIFIED_NUMBER;
+  *revprop_count = SVN_RA_SVN_UNSPECIFIED_NUMBER;
+  *revprops = NULL;
+  *subtractive_merge = SVN_RA_SVN_UNSPECIFIED_NUMBER;
+
+  /* top-level elements (mandatory) */
+  SVN_ERR(svn_ra_svn__read_check_array_size(items, 5, INT_MAX));
+  SVN_ERR(svn_ra_svn__read_list(items, 0, changed_paths));
+  SVN_ERR(svn_ra_svn__read_revision(items, 1, revision));
+  SVN_ERR(svn_ra_svn__read_string_opt_list(items, 2, author));
+  SVN_ERR(svn_ra_svn__read_string_opt_list(items, 3, date));
+  SVN_ERR(svn_ra_svn__read_string_opt_list(items, 4, message));
+
+  /* elements added in later protocol versions (optional) */
+  if (items->nelts > 5)
+    SVN_ERR(svn_ra_svn__read_boolean(items, 5, has_children));
+  if (items->nelts > 6)
+    SVN_ERR(svn_ra_svn__read_boolean(items, 6, invalid_revnum));
+  if (items->nelts > 7)
+    SVN_ERR(svn_ra_svn__read_number(items, 7, revprop_count));
+  if (items->nelts > 8)
+    SVN_ERR(svn_ra_svn__read_list(items, 8, revprops));
+  if (items->nelts > 9)
+    SVN_ERR(svn_ra_svn__read_boolean(items, 9, subtractive_merge));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__read_data_log_changed_entry(const svn_ra_svn__list_t *items,
                                         svn_string_t **cpath,
@@ -67,6 +67,14 @@ typedef svn_error_t *(*ra_svn_block_handler_t)(svn_ra_svn_conn_t *conn,
 #define SVN_RA_SVN__READBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 #define SVN_RA_SVN__WRITEBUF_SIZE (4 * SVN_RA_SVN__PAGE_SIZE)
 
+/* The maximum size of the strings that svn_ra_svn__write_file_range()
+   splits file contents into.  The receiver buffers each one in full. */
+#define SVN_RA_SVN__FILE_CHUNK_SIZE (16 * SVN_RA_SVN__PAGE_SIZE)
+
+/* When tuning the compression level, reconsider it whenever this many
+   bytes have been sent. */
+#define SVN_RA_SVN__TUNING_SAMPLE_SIZE (1024 * 1024)
+
 /* Create forward reference */
 typedef struct svn_ra_svn__session_baton_t svn_ra_svn__session_baton_t;
 
@@ -83,14 +91,19 @@ struct svn_ra_svn_conn_st {
 
   svn_ra_svn__stream_t *stream;
   svn_ra_svn__session_baton_t *session;
-#ifdef SVN_HAVE_SASL
+
   /* Although all reads and writes go through the svn_ra_svn__stream_t
      interface, SASL still needs direct access to the underlying socket
-     for stuff like IP addresses and port numbers. */
+     for stuff like IP addresses and port numbers.  Sending file contents
+     with sendfile() needs it as well.  NULL for tunnel connections. */
   apr_socket_t *sock;
+#ifdef SVN_HAVE_SASL
   svn_boolean_t encrypted;
 #endif
 
+  /* TRUE once all traffic goes through TLS. */
+  svn_boolean_t tls;
+
   /* abortion check control */
   apr_size_t written_since_error_check;
   apr_size_t error_check_interval;
@@ -102,6 +115,9 @@ struct svn_ra_svn_conn_st {
   apr_uint64_t max_out;
   apr_uint64_t current_out;
 
+  /* when svn_ra_svn__handle_command() finished reading the last command */
+  apr_time_t command_start;
+
   /* repository info */
   const char *uuid;
   const char *repos_root;
@@ -115,6 +131,20 @@ struct svn_ra_svn_conn_st {
   int compression_level;
   apr_size_t zero_copy_limit;
 
+  /* compression level tuning.  Disabled, if TUNE_COMPRESSION is FALSE.
+     Otherwise, COMPRESSION_LEVEL gets adapted within MIN_COMPRESSION_LEVEL
+     and MAX_COMPRESSION_LEVEL depending on how much of the time since
+     TUNING_START has been spent waiting for writes to complete
+     (WRITE_TIME) as opposed to preparing the data.  Time spent waiting
+     for the other side (READ_TIME) does not count at all. */
+  svn_boolean_t tune_compression;
+  int min_compression_level;
+  int max_compression_level;
+  apr_time_t tuning_start;
+  apr_time_t write_time;
+  apr_time_t read_time;
+  apr_size_t tuning_bytes;
+
   /* who's on the other side of the connection? */
   char *remote_ip;
 
@@ -275,6 +305,15 @@ svn_boolean_t svn_ra_svn__find_mech(const svn_ra_svn__list_t *mechlist,
 /* Initialize the SASL library. */
 svn_error_t *svn_ra_svn__sasl_init(void);
 
+/* Perform the client side of the TLS handshake on SESS->CONN and send
+ * all further traffic through TLS.  Verify the server's certificate
+ * against the SSL settings in SESS->CONFIG, asking SESS->AUTH_BATON
+ * whether to accept it anyway if that fails.  Resume a previous TLS
+ * session with the same server, if possible. */
+svn_error_t *
+svn_ra_svn__tls_connect(svn_ra_svn__session_baton_t *sess,
+                        apr_pool_t *pool);
+
 
 #ifdef __cplusplus
 }
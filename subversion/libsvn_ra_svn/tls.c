@@ -0,0 +1,916 @@
+/*
+ * tls.c :  TLS encrypted ra_svn connections, using OpenSSL
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_private_config.h"
+
+#include <apr_strings.h>
+
+#include "svn_types.h"
+#include "svn_string.h"
+#include "svn_error.h"
+#include "svn_pools.h"
+#include "svn_hash.h"
+#include "svn_auth.h"
+#include "svn_base64.h"
+#include "svn_config.h"
+#include "svn_dirent_uri.h"
+#include "svn_path.h"
+#include "svn_ra_svn.h"
+#include "svn_sorts.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
+
+#include "ra_svn.h"
+
+#ifdef SVN_HAVE_OPENSSL
+
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+
+struct svn_ra_svn__tls_server_t
+{
+  SSL_CTX *ctx;
+};
+
+/* Baton for a TLS encrypted svn_ra_svn__stream_t. */
+typedef struct tls_baton_t
+{
+  svn_ra_svn__stream_t *stream; /* Inherited stream. */
+  SSL *ssl;                     /* The TLS state of this connection. */
+  svn_error_t *err;             /* Error of the last I/O on STREAM. */
+  apr_interval_time_t timeout;  /* Timeout last set for STREAM. */
+} tls_baton_t;
+
+/* The BIO type that connects OpenSSL to the inherited stream. */
+static BIO_METHOD *stream_bio_method = NULL;
+
+/* The context shared by all client connections of this process. */
+static SSL_CTX *client_ctx = NULL;
+
+/* Resumable client sessions, SSL_SESSION * keyed by the realm prefix
+   (host and port) of the server that issued them.  The keys and the hash
+   live as long as the process does.  Access is serialized by
+   CLIENT_SESSIONS_MUTEX. */
+static apr_hash_t *client_sessions = NULL;
+static svn_mutex__t *client_sessions_mutex = NULL;
+
+static volatile svn_atomic_t tls_init_state = 0;
+
+/* Return an error for the OpenSSL failure that left SSL_ERR as the error
+   state of B->SSL, using MESSAGE as the outer error message.  If the
+   failure was caused by the inherited stream, return that error. */
+static svn_error_t *
+tls_error(tls_baton_t *b,
+          int ssl_err,
+          const char *message)
+{
+  svn_error_t *err;
+  unsigned long code;
+
+  if (b->err)
+    {
+      err = b->err;
+      b->err = NULL;
+      return err;
+    }
+
+  code = ERR_get_error();
+  if (code)
+    {
+      char buffer[256];
+
+      ERR_error_string_n(code, buffer, sizeof(buffer));
+      err = svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL, buffer);
+    }
+  else if (ssl_err == SSL_ERROR_SYSCALL)
+    err = svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
+  else
+    err = svn_error_createf(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                            _("OpenSSL error %d"), ssl_err);
+
+  ERR_clear_error();
+
+  return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, err, message);
+}
+
+/* Functions to implement the BIO that carries the encrypted data. */
+
+static int
+stream_bio_create(BIO *bio)
+{
+  BIO_set_init(bio, 1);
+  return 1;
+}
+
+static int
+stream_bio_read(BIO *bio, char *buffer, int len)
+{
+  tls_baton_t *b = BIO_get_data(bio);
+  apr_size_t count = len;
+
+  BIO_clear_retry_flags(bio);
+
+  svn_error_clear(b->err);
+  b->err = svn_ra_svn__stream_read(b->stream, buffer, &count);
+  if (b->err)
+    return -1;
+
+  return (int) count;
+}
+
+static int
+stream_bio_write(BIO *bio, const char *buffer, int len)
+{
+  tls_baton_t *b = BIO_get_data(bio);
+  apr_size_t count = len;
+  svn_error_t *err;
+
+  BIO_clear_retry_flags(bio);
+
+  /* Writes fail to make progress while a block handler is installed
+     and the socket is full.  Let OpenSSL repeat them later. */
+  err = svn_ra_svn__stream_write(b->stream, buffer, &count);
+  if (err && APR_STATUS_IS_EAGAIN(err->apr_err))
+    {
+      svn_error_clear(err);
+      count = 0;
+    }
+  else if (err)
+    {
+      svn_error_clear(b->err);
+      b->err = err;
+      return -1;
+    }
+
+  if (count == 0)
+    {
+      BIO_set_retry_write(bio);
+      return -1;
+    }
+
+  return (int) count;
+}
+
+static long
+stream_bio_ctrl(BIO *bio, int cmd, long num, void *ptr)
+{
+  /* Our writes are never buffered. */
+  return cmd == BIO_CTRL_FLUSH ? 1 : 0;
+}
+
+/* Functions to implement a TLS encrypted svn_ra_svn__stream_t. */
+
+/* Implements svn_read_fn_t. */
+static svn_error_t *
+tls_read_cb(void *baton, char *buffer, apr_size_t *len)
+{
+  tls_baton_t *b = baton;
+  svn_boolean_t blocking = FALSE;
+  int result, ssl_err;
+
+  while (TRUE)
+    {
+      ERR_clear_error();
+      result = SSL_read(b->ssl, buffer, (int) MIN(*len, APR_INT32_MAX));
+      if (result > 0)
+        break;
+
+      ssl_err = SSL_get_error(b->ssl, result);
+
+      /* OpenSSL has to send something before it can continue reading,
+         but the socket was full while a block handler made writes
+         non-blocking.  Retrying right away would spin until the peer
+         drains the socket.  Reads block anyway, so let the pending
+         write wait for the socket, too. */
+      if (ssl_err == SSL_ERROR_WANT_WRITE && !blocking)
+        {
+          svn_ra_svn__stream_timeout(b->stream, -1);
+          blocking = TRUE;
+        }
+      else if (ssl_err != SSL_ERROR_WANT_READ
+               && ssl_err != SSL_ERROR_WANT_WRITE)
+        break;
+    }
+
+  if (blocking)
+    svn_ra_svn__stream_timeout(b->stream, b->timeout);
+
+  if (result > 0)
+    {
+      *len = result;
+      return SVN_NO_ERROR;
+    }
+
+  /* The other side closed the TLS session. */
+  if (ssl_err == SSL_ERROR_ZERO_RETURN)
+    {
+      *len = 0;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(tls_error(b, ssl_err,
+                                   _("Can't read from connection")));
+}
+
+/* Implements svn_write_fn_t. */
+static svn_error_t *
+tls_write_cb(void *baton, const char *buffer, apr_size_t *len)
+{
+  tls_baton_t *b = baton;
+  int result, ssl_err;
+
+  ERR_clear_error();
+  result = SSL_write(b->ssl, buffer, (int) MIN(*len, APR_INT32_MAX));
+  if (result > 0)
+    {
+      *len = result;
+      return SVN_NO_ERROR;
+    }
+
+  /* The caller will call us again with the same data, which is what
+     OpenSSL expects. */
+  ssl_err = SSL_get_error(b->ssl, result);
+  if (ssl_err == SSL_ERROR_WANT_WRITE)
+    {
+      *len = 0;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(tls_error(b, ssl_err,
+                                   _("Can't write to connection")));
+}
+
+/* Implements ra_svn_timeout_fn_t. */
+static void
+tls_timeout_cb(void *baton, apr_interval_time_t interval)
+{
+  tls_baton_t *b = baton;
+
+  b->timeout = interval;
+  svn_ra_svn__stream_timeout(b->stream, interval);
+}
+
+/* Implements svn_stream_data_available_fn_t. */
+static svn_error_t *
+tls_data_available_cb(void *baton, svn_boolean_t *data_available)
+{
+  tls_baton_t *b = baton;
+
+  if (SSL_pending(b->ssl) > 0)
+    {
+      *data_available = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(svn_ra_svn__stream_data_available(b->stream,
+                                                           data_available));
+}
+
+/* Pool cleanup handler for the tls_baton_t BATON. */
+static apr_status_t
+cleanup_tls(void *baton)
+{
+  tls_baton_t *b = baton;
+
+  SSL_free(b->ssl);
+  svn_error_clear(b->err);
+
+  return APR_SUCCESS;
+}
+
+/* Store SESSION for the server in SSL's app data.
+   Implements the new session callback of the client context. */
+static int
+new_client_session(SSL *ssl, SSL_SESSION *session)
+{
+  const char *key = SSL_get_app_data(ssl);
+  SSL_SESSION *old_session;
+  svn_error_t *err;
+
+  err = svn_mutex__lock(client_sessions_mutex);
+  if (err)
+    {
+      svn_error_clear(err);
+      return 0;
+    }
+
+  old_session = svn_hash_gets(client_sessions, key);
+  if (old_session)
+    SSL_SESSION_free(old_session);
+  else
+    key = apr_pstrdup(apr_hash_pool_get(client_sessions), key);
+  svn_hash_sets(client_sessions, key, session);
+
+  svn_error_clear(svn_mutex__unlock(client_sessions_mutex, SVN_NO_ERROR));
+
+  /* We took ownership of SESSION. */
+  return 1;
+}
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+init_tls(void *baton, apr_pool_t *pool)
+{
+  /* These live as long as the process does. */
+  apr_pool_t *global_pool = svn_pool_create(NULL);
+
+  if (!OPENSSL_init_ssl(0, NULL))
+    return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                            _("Could not initialize OpenSSL"));
+
+  stream_bio_method = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK,
+                                   "svn_ra_svn__stream_t");
+  BIO_meth_set_create(stream_bio_method, stream_bio_create);
+  BIO_meth_set_read(stream_bio_method, stream_bio_read);
+  BIO_meth_set_write(stream_bio_method, stream_bio_write);
+  BIO_meth_set_ctrl(stream_bio_method, stream_bio_ctrl);
+
+  /* We verify the server certificate ourselves, after the handshake. */
+  client_ctx = SSL_CTX_new(TLS_client_method());
+  if (!client_ctx)
+    return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                            _("Could not create the TLS client context"));
+  SSL_CTX_set_min_proto_version(client_ctx, TLS1_2_VERSION);
+  SSL_CTX_set_session_cache_mode(client_ctx,
+                                 SSL_SESS_CACHE_CLIENT
+                                 | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(client_ctx, new_client_session);
+
+  client_sessions = apr_hash_make(global_pool);
+  SVN_ERR(svn_mutex__init(&client_sessions_mutex, TRUE, global_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Perform the TLS handshake for SSL, as server if SERVER is set, on CONN
+   and wrap CONN's stream.  SSL will be freed together with CONN. */
+static svn_error_t *
+enable_tls(svn_ra_svn_conn_t *conn,
+           SSL *ssl,
+           svn_boolean_t server,
+           apr_pool_t *scratch_pool)
+{
+  tls_baton_t *b;
+  BIO *bio;
+  int result;
+
+  /* Flush the connection, as we're about to replace its stream. */
+  SVN_ERR(svn_ra_svn__flush(conn, scratch_pool));
+
+  b = apr_pcalloc(conn->pool, sizeof(*b));
+  b->ssl = ssl;
+  b->stream = conn->stream;
+  b->timeout = conn->block_handler ? 0 : -1;
+  apr_pool_cleanup_register(conn->pool, b, cleanup_tls,
+                            apr_pool_cleanup_null);
+
+  /* Neither side sends anything after starttls but the handshake. */
+  if (conn->read_end > conn->read_ptr)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Unexpected data before the TLS handshake"));
+
+  bio = BIO_new(stream_bio_method);
+  if (!bio)
+    return svn_error_trace(tls_error(b, SSL_ERROR_SSL,
+                                     _("TLS handshake failed")));
+  BIO_set_data(bio, b);
+  SSL_set_bio(ssl, bio, bio);
+
+  /* Let tls_write_cb report partial writes and retry them with the
+     remainder of the write buffer. */
+  SSL_set_mode(ssl, SSL_MODE_ENABLE_PARTIAL_WRITE
+                    | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+  ERR_clear_error();
+  result = server ? SSL_accept(ssl) : SSL_connect(ssl);
+  if (result != 1)
+    return svn_error_trace(tls_error(b, SSL_get_error(ssl, result),
+                                     _("TLS handshake failed")));
+
+  {
+    svn_stream_t *tls_in = svn_stream_create(b, conn->pool);
+    svn_stream_t *tls_out = svn_stream_create(b, conn->pool);
+
+    svn_stream_set_read2(tls_in, tls_read_cb, NULL /* use default */);
+    svn_stream_set_data_available(tls_in, tls_data_available_cb);
+    svn_stream_set_write(tls_out, tls_write_cb);
+
+    conn->stream = svn_ra_svn__stream_create(tls_in, tls_out, b,
+                                             tls_timeout_cb, conn->pool);
+  }
+  conn->tls = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** Server side ***/
+
+/* Pool cleanup handler for the svn_ra_svn__tls_server_t BATON. */
+static apr_status_t
+cleanup_server(void *baton)
+{
+  svn_ra_svn__tls_server_t *server = baton;
+
+  SSL_CTX_free(server->ctx);
+
+  return APR_SUCCESS;
+}
+
+svn_boolean_t
+svn_ra_svn__tls_supported(void)
+{
+  return TRUE;
+}
+
+svn_error_t *
+svn_ra_svn__tls_server_create(svn_ra_svn__tls_server_t **server,
+                              const char *cert_file,
+                              const char *key_file,
+                              apr_pool_t *result_pool)
+{
+  svn_ra_svn__tls_server_t *result;
+  const char *cert_file_apr, *key_file_apr;
+  /* Sessions issued by one svnserve instance are all alike. */
+  static const unsigned char session_context[] = "svnserve";
+
+  SVN_ERR(svn_atomic__init_once(&tls_init_state, init_tls, NULL,
+                                result_pool));
+
+  SVN_ERR(svn_path_cstring_from_utf8(&cert_file_apr,
+                                     svn_dirent_local_style(cert_file,
+                                                            result_pool),
+                                     result_pool));
+  SVN_ERR(svn_path_cstring_from_utf8(&key_file_apr,
+                                     svn_dirent_local_style(key_file,
+                                                            result_pool),
+                                     result_pool));
+
+  result = apr_pcalloc(result_pool, sizeof(*result));
+  result->ctx = SSL_CTX_new(TLS_server_method());
+  if (!result->ctx)
+    return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                            _("Could not create the TLS server context"));
+  apr_pool_cleanup_register(result_pool, result, cleanup_server,
+                            apr_pool_cleanup_null);
+
+  SSL_CTX_set_min_proto_version(result->ctx, TLS1_2_VERSION);
+
+  if (SSL_CTX_use_certificate_chain_file(result->ctx, cert_file_apr) != 1)
+    return svn_error_createf(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                             _("Can't load the TLS certificate '%s': %s"),
+                             svn_dirent_local_style(cert_file, result_pool),
+                             ERR_reason_error_string(ERR_get_error()));
+  if (SSL_CTX_use_PrivateKey_file(result->ctx, key_file_apr,
+                                  SSL_FILETYPE_PEM) != 1
+      || SSL_CTX_check_private_key(result->ctx) != 1)
+    return svn_error_createf(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                             _("Can't load the TLS private key '%s': %s"),
+                             svn_dirent_local_style(key_file, result_pool),
+                             ERR_reason_error_string(ERR_get_error()));
+
+  /* Clients may resume their sessions from the server side cache, when
+     they return to the same process, and from session tickets, which
+     also work across the processes forked for each connection. */
+  SSL_CTX_set_session_cache_mode(result->ctx, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_set_session_id_context(result->ctx, session_context,
+                                 sizeof(session_context) - 1);
+
+  *server = result;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_svn__tls_accept(svn_ra_svn_conn_t *conn,
+                       svn_ra_svn__tls_server_t *server,
+                       apr_pool_t *scratch_pool)
+{
+  SSL *ssl = SSL_new(server->ctx);
+
+  if (!ssl)
+    return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                            _("Could not create the TLS connection"));
+
+  return svn_error_trace(enable_tls(conn, ssl, TRUE, scratch_pool));
+}
+
+
+/*** Client side ***/
+
+/* Return the contents of the memory BIO BIO, allocated in POOL, and free
+   BIO. */
+static const char *
+bio_to_cstring(BIO *bio,
+               apr_pool_t *pool)
+{
+  char *data;
+  long len = BIO_get_mem_data(bio, &data);
+  const char *result = apr_pstrndup(pool, data, len);
+
+  BIO_free(bio);
+
+  return result;
+}
+
+/* Return the ASN.1 time TIME as a string allocated in POOL. */
+static const char *
+time_to_cstring(const ASN1_TIME *time,
+                apr_pool_t *pool)
+{
+  BIO *bio = BIO_new(BIO_s_mem());
+
+  if (!ASN1_TIME_print(bio, time))
+    {
+      BIO_free(bio);
+      return apr_pstrdup(pool, "[invalid date]");
+    }
+
+  return bio_to_cstring(bio, pool);
+}
+
+/* Fill *CERT_INFO with the details of CERT, allocated in POOL. */
+static void
+get_cert_info(svn_auth_ssl_server_cert_info_t *cert_info,
+              X509 *cert,
+              apr_pool_t *pool)
+{
+  unsigned char md[EVP_MAX_MD_SIZE];
+  unsigned int md_len, i;
+  char buffer[256];
+  BIO *bio;
+  int der_len;
+
+  if (X509_NAME_get_text_by_NID(X509_get_subject_name(cert),
+                                NID_commonName,
+                                buffer, sizeof(buffer)) >= 0)
+    cert_info->hostname = apr_pstrdup(pool, buffer);
+  else
+    cert_info->hostname = NULL;
+
+  if (X509_digest(cert, EVP_sha1(), md, &md_len))
+    {
+      svn_stringbuf_t *fingerprint = svn_stringbuf_create_empty(pool);
+
+      for (i = 0; i < md_len; i++)
+        svn_stringbuf_appendcstr(fingerprint,
+                                 apr_psprintf(pool, i ? ":%02X" : "%02X",
+                                              md[i]));
+      cert_info->fingerprint = fingerprint->data;
+    }
+  else
+    cert_info->fingerprint = apr_pstrdup(pool, "<unknown>");
+
+  cert_info->valid_from = time_to_cstring(X509_get0_notBefore(cert), pool);
+  cert_info->valid_until = time_to_cstring(X509_get0_notAfter(cert), pool);
+
+  bio = BIO_new(BIO_s_mem());
+  X509_NAME_print_ex(bio, X509_get_issuer_name(cert), 0,
+                     XN_FLAG_ONELINE & ~ASN1_STRFLGS_ESC_MSB);
+  cert_info->issuer_dname = bio_to_cstring(bio, pool);
+
+  der_len = i2d_X509(cert, NULL);
+  if (der_len > 0)
+    {
+      unsigned char *der = apr_palloc(pool, der_len);
+      unsigned char *p = der;
+      svn_string_t der_str;
+
+      i2d_X509(cert, &p);
+      der_str.data = (const char *) der;
+      der_str.len = der_len;
+      cert_info->ascii_cert
+        = svn_base64_encode_string2(&der_str, FALSE, pool)->data;
+    }
+  else
+    cert_info->ascii_cert = "";
+}
+
+/* Return the SVN_AUTH_SSL_* failure for the X509_V_ERR_* ERROR. */
+static apr_uint32_t
+convert_verify_error(int error)
+{
+  switch (error)
+    {
+      case X509_V_ERR_CERT_NOT_YET_VALID:
+        return SVN_AUTH_SSL_NOTYETVALID;
+
+      case X509_V_ERR_CERT_HAS_EXPIRED:
+        return SVN_AUTH_SSL_EXPIRED;
+
+      case X509_V_ERR_DEPTH_ZERO_SELF_SIGNED_CERT:
+      case X509_V_ERR_SELF_SIGNED_CERT_IN_CHAIN:
+      case X509_V_ERR_UNABLE_TO_GET_ISSUER_CERT:
+      case X509_V_ERR_UNABLE_TO_GET_ISSUER_CERT_LOCALLY:
+      case X509_V_ERR_UNABLE_TO_VERIFY_LEAF_SIGNATURE:
+        return SVN_AUTH_SSL_UNKNOWNCA;
+
+      default:
+        return SVN_AUTH_SSL_OTHER;
+    }
+}
+
+/* Collect all verification failures instead of stopping at the first.
+   Implements the X509_STORE_CTX verify callback. */
+static int
+collect_verify_failures(int ok, X509_STORE_CTX *store_ctx)
+{
+  apr_uint32_t *failures = X509_STORE_CTX_get_app_data(store_ctx);
+
+  if (!ok)
+    *failures |= convert_verify_error(X509_STORE_CTX_get_error(store_ctx));
+
+  return 1;
+}
+
+/* Append REASON to ERRMSG, counting the REASONS so far. */
+static void
+append_reason(svn_stringbuf_t *errmsg,
+              const char *reason,
+              int *reasons)
+{
+  if (*reasons < 1)
+    svn_stringbuf_appendcstr(errmsg, _(": "));
+  else
+    svn_stringbuf_appendcstr(errmsg, _(", "));
+  svn_stringbuf_appendcstr(errmsg, reason);
+  (*reasons)++;
+}
+
+/* Set *FAILURES to the SVN_AUTH_SSL_* failures of the certificate chain
+   that the server presented on SSL, validated against the authorities
+   configured for SESS. */
+static svn_error_t *
+verify_chain(apr_uint32_t *failures,
+             svn_ra_svn__session_baton_t *sess,
+             SSL *ssl,
+             X509 *cert,
+             apr_pool_t *pool)
+{
+  svn_config_t *cfg = sess->config
+                    ? svn_hash_gets(sess->config, SVN_CONFIG_CATEGORY_SERVERS)
+                    : NULL;
+  const char *server_group = NULL;
+  const char *authorities;
+  svn_boolean_t trust_default_ca;
+  X509_STORE *store;
+  X509_STORE_CTX *store_ctx;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  if (cfg)
+    server_group = svn_config_find_group(cfg, sess->hostname,
+                                         SVN_CONFIG_SECTION_GROUPS, pool);
+  SVN_ERR(svn_config_get_server_setting_bool(
+            cfg, &trust_default_ca, server_group,
+            SVN_CONFIG_OPTION_SSL_TRUST_DEFAULT_CA, TRUE));
+  authorities = svn_config_get_server_setting(
+                  cfg, server_group, SVN_CONFIG_OPTION_SSL_AUTHORITY_FILES,
+                  NULL);
+
+  store = X509_STORE_new();
+  store_ctx = X509_STORE_CTX_new();
+  if (!store || !store_ctx)
+    {
+      X509_STORE_free(store);
+      X509_STORE_CTX_free(store_ctx);
+      return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                              _("Could not verify the server certificate"));
+    }
+
+  if (trust_default_ca)
+    X509_STORE_set_default_paths(store);
+
+  if (authorities)
+    {
+      apr_array_header_t *files = svn_cstring_split(authorities, ";",
+                                                    TRUE, pool);
+      int i;
+
+      for (i = 0; i < files->nelts && !err; i++)
+        {
+          const char *file = APR_ARRAY_IDX(files, i, const char *);
+          const char *file_apr;
+
+          err = svn_path_cstring_from_utf8(&file_apr, file, pool);
+          if (!err && X509_STORE_load_locations(store, file_apr, NULL) != 1)
+            err = svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                    _("Invalid config: unable to load "
+                                      "certificate file '%s'"),
+                                    svn_dirent_local_style(file, pool));
+        }
+    }
+
+  if (!err)
+    {
+      *failures = 0;
+      if (X509_STORE_CTX_init(store_ctx, store, cert,
+                              SSL_get_peer_cert_chain(ssl)) == 1)
+        {
+          X509_STORE_CTX_set_purpose(store_ctx, X509_PURPOSE_SSL_SERVER);
+          X509_STORE_CTX_set_app_data(store_ctx, failures);
+          X509_STORE_CTX_set_verify_cb(store_ctx, collect_verify_failures);
+          if (X509_verify_cert(store_ctx) != 1)
+            *failures |= SVN_AUTH_SSL_OTHER;
+        }
+      else
+        *failures |= SVN_AUTH_SSL_OTHER;
+
+      if (X509_check_host(cert, sess->hostname, 0, 0, NULL) != 1
+          && X509_check_ip_asc(cert, sess->hostname, 0) != 1)
+        *failures |= SVN_AUTH_SSL_CNMISMATCH;
+    }
+
+  X509_STORE_CTX_free(store_ctx);
+  X509_STORE_free(store);
+
+  return svn_error_trace(err);
+}
+
+/* Verify the server certificate of the TLS session SSL of SESS.  If it
+   fails validation, ask SESS->AUTH_BATON whether to trust it anyway. */
+static svn_error_t *
+verify_server(svn_ra_svn__session_baton_t *sess,
+              SSL *ssl,
+              apr_pool_t *pool)
+{
+  X509 *cert = SSL_get_peer_certificate(ssl);
+  svn_auth_ssl_server_cert_info_t cert_info;
+  svn_auth_iterstate_t *state;
+  apr_uint32_t failures;
+  svn_error_t *err;
+  void *creds;
+
+  if (!cert)
+    return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                            _("Server did not present a certificate"));
+
+  err = verify_chain(&failures, sess, ssl, cert, pool);
+  if (!err && failures)
+    get_cert_info(&cert_info, cert, pool);
+  X509_free(cert);
+  SVN_ERR(err);
+
+  if (!failures)
+    return SVN_NO_ERROR;
+
+  if (sess->auth_baton)
+    {
+      svn_auth_set_parameter(sess->auth_baton,
+                             SVN_AUTH_PARAM_SSL_SERVER_FAILURES, &failures);
+      svn_auth_set_parameter(sess->auth_baton,
+                             SVN_AUTH_PARAM_SSL_SERVER_CERT_INFO, &cert_info);
+
+      err = svn_auth_first_credentials(&creds, &state,
+                                       SVN_AUTH_CRED_SSL_SERVER_TRUST,
+                                       sess->realm_prefix, sess->auth_baton,
+                                       pool);
+      while (!err && creds)
+        {
+          const svn_auth_cred_ssl_server_trust_t *server_creds = creds;
+
+          failures &= ~server_creds->accepted_failures;
+          if (!failures)
+            {
+              err = svn_auth_save_credentials(state, pool);
+              break;
+            }
+
+          err = svn_auth_next_credentials(&creds, state, pool);
+        }
+
+      svn_auth_set_parameter(sess->auth_baton,
+                             SVN_AUTH_PARAM_SSL_SERVER_FAILURES, NULL);
+      svn_auth_set_parameter(sess->auth_baton,
+                             SVN_AUTH_PARAM_SSL_SERVER_CERT_INFO, NULL);
+      SVN_ERR(err);
+    }
+
+  if (failures)
+    {
+      svn_stringbuf_t *errmsg;
+      int reasons = 0;
+
+      errmsg = svn_stringbuf_create(
+                 _("Server TLS certificate verification failed"), pool);
+
+      if (failures & SVN_AUTH_SSL_NOTYETVALID)
+        append_reason(errmsg, _("certificate is not yet valid"), &reasons);
+
+      if (failures & SVN_AUTH_SSL_EXPIRED)
+        append_reason(errmsg, _("certificate has expired"), &reasons);
+
+      if (failures & SVN_AUTH_SSL_CNMISMATCH)
+        append_reason(errmsg,
+                      _("certificate issued for a different hostname"),
+                      &reasons);
+
+      if (failures & SVN_AUTH_SSL_UNKNOWNCA)
+        append_reason(errmsg, _("issuer is not trusted"), &reasons);
+
+      if (failures & SVN_AUTH_SSL_OTHER)
+        append_reason(errmsg, _("and other reason(s)"), &reasons);
+
+      return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL, errmsg->data);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Let SSL resume the session that we had with the server at KEY, if
+   there is one.  Call with CLIENT_SESSIONS_MUTEX held. */
+static svn_error_t *
+resume_session(SSL *ssl,
+               const char *key)
+{
+  SSL_SESSION *session = svn_hash_gets(client_sessions, key);
+
+  if (session)
+    SSL_set_session(ssl, session);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_svn__tls_connect(svn_ra_svn__session_baton_t *sess,
+                        apr_pool_t *pool)
+{
+  SSL *ssl;
+
+  SVN_ERR(svn_atomic__init_once(&tls_init_state, init_tls, NULL, pool));
+
+  ssl = SSL_new(client_ctx);
+  if (!ssl)
+    return svn_error_create(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                            _("Could not create the TLS connection"));
+
+  /* Let new_client_session() know where the session belongs to. */
+  SSL_set_app_data(ssl, (void *) sess->realm_prefix);
+  SSL_set_tlsext_host_name(ssl, sess->hostname);
+
+  SVN_MUTEX__WITH_LOCK(client_sessions_mutex,
+                       resume_session(ssl, sess->realm_prefix));
+
+  SVN_ERR(enable_tls(sess->conn, ssl, FALSE, pool));
+
+  return svn_error_trace(verify_server(sess, ssl, pool));
+}
+
+#else /* !SVN_HAVE_OPENSSL */
+
+svn_boolean_t
+svn_ra_svn__tls_supported(void)
+{
+  return FALSE;
+}
+
+svn_error_t *
+svn_ra_svn__tls_server_create(svn_ra_svn__tls_server_t **server,
+                              const char *cert_file,
+                              const char *key_file,
+                              apr_pool_t *result_pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Subversion was built without TLS support"));
+}
+
+svn_error_t *
+svn_ra_svn__tls_accept(svn_ra_svn_conn_t *conn,
+                       svn_ra_svn__tls_server_t *server,
+                       apr_pool_t *scratch_pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Subversion was built without TLS support"));
+}
+
+svn_error_t *
+svn_ra_svn__tls_connect(svn_ra_svn__session_baton_t *sess,
+                        apr_pool_t *pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Subversion was built without TLS support"));
+}
+
+#endif /* SVN_HAVE_OPENSSL */
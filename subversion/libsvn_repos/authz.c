@@ -37,9 +37,12 @@
 #include "svn_ctype.h"
 #include "private/svn_atomic.h"
 #include "private/svn_fspath.h"
+#include "private/svn_mutex.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_stats.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_thread_pool.h"
 #include "repos.h"
 #include "authz.h"
 #include "config_file.h"
@@ -1394,6 +1397,120 @@ lookup(lookup_state_t *state,
 
 
 
+/*** Decision cache. ***/
+
+/* Once a filtered tree has reached this number of cached decisions,
+ * start over with an empty cache. */
+#define MAX_CACHED_DECISIONS 10000
+
+/* A filtered path rule tree, as created by create_user_authz(), together
+ * with the access decisions already made using it.  Instances may be
+ * shared between threads through FILTERED_POOL.
+ */
+typedef struct filtered_tree_t
+{
+  /* Root of the path rule tree.  Immutable. */
+  node_t *root;
+
+  /* Maps keys constructed by set_decision_key() to either GRANTED or
+   * DENIED.  Allocated in DECISIONS_POOL.  Access is serialized by MUTEX.
+   */
+  apr_hash_t *decisions;
+  apr_pool_t *decisions_pool;
+  svn_mutex__t *mutex;
+} filtered_tree_t;
+
+/* Values in filtered_tree_t.decisions. */
+static const svn_boolean_t granted = TRUE;
+static const svn_boolean_t denied = FALSE;
+
+/* Return the filtered tree for USER accessing REPOS_NAME in AUTHZ,
+ * allocated in RESULT_POOL.  Set MULTI_THREADED if the result is to be
+ * shared between threads.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+create_filtered_tree(filtered_tree_t **tree,
+                     authz_full_t *authz,
+                     const char *repos_name,
+                     const char *user,
+                     svn_boolean_t multi_threaded,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  filtered_tree_t *result = apr_pcalloc(result_pool, sizeof(*result));
+
+  result->root = create_user_authz(authz, repos_name, user, result_pool,
+                                   scratch_pool);
+
+  /* RESULT_POOL may be in use by other threads while we are adding
+   * decisions, so give them a root pool of their own. */
+  result->decisions_pool = svn_thread_pool__create_root_pool(result_pool);
+  result->decisions = svn_hash__make(result->decisions_pool);
+
+  SVN_ERR(svn_mutex__init(&result->mutex, multi_threaded, result_pool));
+
+  *tree = result;
+  return SVN_NO_ERROR;
+}
+
+/* Set KEY to the decision cache key for checking REQUIRED access on PATH,
+ * recursively if RECURSIVE is set.
+ */
+static void
+set_decision_key(svn_stringbuf_t *key,
+                 const char *path,
+                 authz_access_t required,
+                 svn_boolean_t recursive)
+{
+  svn_stringbuf_set(key, path);
+  svn_stringbuf_appendbyte(key, (char)(required | (recursive ? 1 : 0)));
+}
+
+/* Look up KEY in TREE's decision cache.  If found, set *FOUND and return
+ * the decision in *ACCESS_GRANTED.  Otherwise, set *FOUND to FALSE.
+ */
+static svn_error_t *
+get_decision(svn_boolean_t *found,
+             svn_boolean_t *access_granted,
+             filtered_tree_t *tree,
+             const svn_stringbuf_t *key)
+{
+  const svn_boolean_t *decision;
+
+  SVN_ERR(svn_mutex__lock(tree->mutex));
+  decision = apr_hash_get(tree->decisions, key->data, key->len);
+  SVN_ERR(svn_mutex__unlock(tree->mutex, SVN_NO_ERROR));
+
+  *found = (decision != NULL);
+  if (decision)
+    *access_granted = *decision;
+
+  return SVN_NO_ERROR;
+}
+
+/* Add ACCESS_GRANTED as the decision for KEY to TREE's decision cache.
+ * Call with TREE->MUTEX held.
+ */
+static svn_error_t *
+add_decision(filtered_tree_t *tree,
+             const svn_stringbuf_t *key,
+             svn_boolean_t access_granted)
+{
+  if (apr_hash_count(tree->decisions) >= MAX_CACHED_DECISIONS)
+    {
+      svn_pool_clear(tree->decisions_pool);
+      tree->decisions = svn_hash__make(tree->decisions_pool);
+    }
+
+  apr_hash_set(tree->decisions,
+               apr_pmemdup(tree->decisions_pool, key->data, key->len),
+               key->len, access_granted ? &granted : &denied);
+
+  return SVN_NO_ERROR;
+}
+
+
+
 /*** The authz data structure. ***/
 
 /* An entry in svn_authz_t's USER_RULES cache.  All members must be
@@ -1413,13 +1530,16 @@ struct authz_user_rules_t
   /* The combined min/max rights USER has on REPOSITORY. */
   authz_rights_t global_rights;
 
-  /* Root of the filtered path rule tree.
+  /* The filtered path rule tree.
    * Will remain NULL until the first usage. */
-  node_t *root;
+  filtered_tree_t *tree;
 
   /* Reusable lookup state instance. */
   lookup_state_t *lookup_state;
 
+  /* Reusable buffer for decision cache keys. */
+  svn_stringbuf_t *decision_key;
+
   /* Pool from which all data within this struct got allocated.
    * Can be destroyed or cleaned up with no further side-effects. */
   apr_pool_t *pool;
@@ -1478,7 +1598,8 @@ get_user_rules(svn_authz_t *authz,
   authz->filtered->repository = apr_pstrdup(pool, repos_name);
   authz->filtered->user = user ? apr_pstrdup(pool, user) : NULL;
   authz->filtered->lookup_state = create_lookup_state(pool);
-  authz->filtered->root = NULL;
+  authz->filtered->decision_key = svn_stringbuf_create_ensure(200, pool);
+  authz->filtered->tree = NULL;
 
   svn_authz__get_global_rights(&authz->filtered->global_rights,
                                authz->full, user, repos_name);
@@ -1496,7 +1617,7 @@ filter_tree(svn_authz_t *authz,
   apr_pool_t *pool = authz->filtered->pool;
   const char *repos_name = authz->filtered->repository;
   const char *user = authz->filtered->user;
-  node_t *root;
+  filtered_tree_t *tree;
 
   if (filtered_pool)
     {
@@ -1505,10 +1626,10 @@ filter_tree(svn_authz_t *authz,
                                                  scratch_pool);
 
       /* Cache lookup. */
-      SVN_ERR(svn_object_pool__lookup((void **)&root, filtered_pool, key,
+      SVN_ERR(svn_object_pool__lookup((void **)&tree, filtered_pool, key,
                                       pool));
 
-      if (!root)
+      if (!tree)
         {
           apr_pool_t *item_pool = svn_object_pool__new_item_pool(authz_pool);
           authz_full_t *add_ref = NULL;
@@ -1526,22 +1647,23 @@ filter_tree(svn_authz_t *authz,
                                                   item_pool));
           SVN_ERR_ASSERT(add_ref == authz->full);
 
-          /* Now construct the new filtered tree and cache it. */
-          root = create_user_authz(authz->full, repos_name, user, item_pool,
-                                   scratch_pool);
-          svn_error_clear(svn_object_pool__insert((void **)&root,
-                                                  filtered_pool, key, root,
+          /* Now construct the new filtered tree and cache it.  Its
+           * decision cache will be shared by all users of FILTERED_POOL. */
+          SVN_ERR(create_filtered_tree(&tree, authz->full, repos_name, user,
+                                       TRUE, item_pool, scratch_pool));
+          svn_error_clear(svn_object_pool__insert((void **)&tree,
+                                                  filtered_pool, key, tree,
                                                   item_pool, pool));
         }
      }
   else
     {
-      root = create_user_authz(authz->full, repos_name, user, pool,
-                               scratch_pool);
+      SVN_ERR(create_filtered_tree(&tree, authz->full, repos_name, user,
+                                   FALSE, pool, scratch_pool));
     }
 
   /* Write a new entry. */
-  authz->filtered->root = root;
+  authz->filtered->tree = tree;
 
   return SVN_NO_ERROR;
 }
@@ -1693,16 +1815,22 @@ svn_repos_authz_parse2(svn_authz_t **authz_p,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
-                             const char *path, const char *user,
-                             svn_repos_authz_access_t required_access,
-                             svn_boolean_t *access_granted,
-                             apr_pool_t *pool)
+/* Time spent deciding path-based access. */
+SVN__COUNTER_DEFINE(check_access_timer, "repos.authz_check");
+
+/* The actual implementation of svn_repos_authz_check_access(). */
+static svn_error_t *
+check_access(svn_authz_t *authz, const char *repos_name,
+             const char *path, const char *user,
+             svn_repos_authz_access_t required_access,
+             svn_boolean_t *access_granted,
+             apr_pool_t *pool)
 {
   const authz_access_t required =
     ((required_access & svn_authz_read ? authz_access_read_flag : 0)
      | (required_access & svn_authz_write ? authz_access_write_flag : 0));
+  const svn_boolean_t recursive = !!(required_access & svn_authz_recursive);
+  svn_boolean_t found;
 
   /* Pick or create the suitable pre-filtered path rule tree. */
   authz_user_rules_t *rules = get_user_rules(
@@ -1738,20 +1866,118 @@ svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
   /* Rules tree lookup */
 
   /* Did we already filter the data model? */
-  if (!rules->root)
+  if (!rules->tree)
     SVN_ERR(filter_tree(authz, pool));
 
+  /* Maybe, we or somebody else using the same filtered tree already had
+   * to decide this. */
+  set_decision_key(rules->decision_key, path, required, recursive);
+  SVN_ERR(get_decision(&found, access_granted, rules->tree,
+                       rules->decision_key));
+  if (found)
+    return SVN_NO_ERROR;
+
   /* Re-use previous lookup results, if possible. */
   path = init_lockup_state(authz->filtered->lookup_state,
-                           authz->filtered->root, path);
+                           authz->filtered->tree->root, path);
 
   /* Sanity check. */
   SVN_ERR_ASSERT(path[0] == '/');
 
   /* Determine the granted access for the requested path.
    * PATH does not need to be normalized for lockup(). */
-  *access_granted = lookup(rules->lookup_state, path, required,
-                           !!(required_access & svn_authz_recursive), pool);
+  *access_granted = lookup(rules->lookup_state, path, required, recursive,
+                           pool);
+
+  SVN_MUTEX__WITH_LOCK(rules->tree->mutex,
+                       add_decision(rules->tree, rules->decision_key,
+                                    *access_granted));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_authz_check_access(svn_authz_t *authz, const char *repos_name,
+                             const char *path, const char *user,
+                             svn_repos_authz_access_t required_access,
+                             svn_boolean_t *access_granted,
+                             apr_pool_t *pool)
+{
+  svn_error_t *err;
+  apr_time_t start;
+
+  SVN__TIMER_START(check_access_timer, start);
+  err = check_access(authz, repos_name, path, user, required_access,
+                     access_granted, pool);
+  SVN__TIMER_STOP(check_access_timer, start);
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svn_repos_authz_check_access_many(svn_authz_t *authz,
+                                  const char *repos_name,
+                                  const apr_array_header_t *paths,
+                                  const char *user,
+                                  svn_repos_authz_access_t required_access,
+                                  svn_boolean_t *access_granted,
+                                  apr_pool_t *scratch_pool)
+{
+  const char *ancestor = NULL;
+  svn_boolean_t all_granted = FALSE;
+  apr_pool_t *iterpool;
+  int i;
+
+  if (paths->nelts == 0)
+    return SVN_NO_ERROR;
+
+  /* Find the longest common ancestor.  Non-canonical paths are fine for
+   * svn_repos_authz_check_access() but we would have to normalize them
+   * here; simply don't use the shortcut for them. */
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+
+      if (!svn_fspath__is_canonical(path))
+        {
+          ancestor = NULL;
+          break;
+        }
+
+      ancestor = ancestor
+               ? svn_fspath__get_longest_ancestor(ancestor, path,
+                                                  scratch_pool)
+               : path;
+    }
+
+  /* Recursive access to the ancestor covers all paths below it.  This
+   * also takes care of users having uniform access to the repository. */
+  if (ancestor)
+    SVN_ERR(svn_repos_authz_check_access(authz, repos_name, ancestor, user,
+                                         required_access
+                                           | svn_authz_recursive,
+                                         &all_granted, scratch_pool));
+
+  if (all_granted)
+    {
+      for (i = 0; i < paths->nelts; ++i)
+        access_granted[i] = TRUE;
+
+      return SVN_NO_ERROR;
+    }
+
+  /* Consecutive lookups re-use the tree walk of their common parent. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_repos_authz_check_access(authz, repos_name,
+                                           APR_ARRAY_IDX(paths, i,
+                                                         const char *),
+                                           user, required_access,
+                                           &access_granted[i], iterpool));
+    }
+  svn_pool_destroy(iterpool);
 
   return SVN_NO_ERROR;
 }
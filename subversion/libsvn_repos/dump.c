@@ -42,9 +42,11 @@
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_subr_private.h"
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_thread_pool.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
@@ -2021,9 +2023,555 @@ dump_filter_authz_func(svn_boolean_t *allowed,
 
 
 
+/* Dump the node changes of revision REV in FS, which must not be 0, to
+ * writable STREAM.  START_REV is the first revision being dumped and
+ * INCREMENTAL, USE_DELTAS, AUTHZ_FUNC and AUTHZ_BATON are as in
+ * svn_repos_dump_fs5().  Send warnings through NOTIFY_FUNC and
+ * NOTIFY_BATON and set *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO if
+ * any of them referred to revisions older than START_REV.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+dump_one_revision(svn_fs_t *fs,
+                  svn_revnum_t rev,
+                  svn_stream_t *stream,
+                  svn_revnum_t start_rev,
+                  svn_boolean_t incremental,
+                  svn_boolean_t use_deltas,
+                  svn_boolean_t *found_old_reference,
+                  svn_boolean_t *found_old_mergeinfo,
+                  svn_repos_notify_func_t notify_func,
+                  void *notify_baton,
+                  svn_repos_authz_func_t authz_func,
+                  void *authz_baton,
+                  apr_pool_t *scratch_pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton;
+  svn_fs_root_t *to_root;
+  svn_boolean_t use_deltas_for_rev;
+
+  /* Fetch the editor which dumps nodes to a file.  Regardless of
+     what we've been told, don't use deltas for the first rev of a
+     non-incremental dump. */
+  use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
+  SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
+                          "", stream, found_old_reference,
+                          found_old_mergeinfo, NULL,
+                          notify_func, notify_baton,
+                          start_rev, use_deltas_for_rev, FALSE, FALSE,
+                          scratch_pool));
+
+  /* Drive the editor in one way or another. */
+  SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, scratch_pool));
+
+  /* If this is the first revision of a non-incremental dump,
+     we're in for a full tree dump.  Otherwise, we want to simply
+     replay the revision.  */
+  if ((rev == start_rev) && (! incremental))
+    {
+      /* Compare against revision 0, so everything appears to be added. */
+      svn_fs_root_t *from_root;
+      SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, scratch_pool));
+      SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
+                                   to_root, "",
+                                   dump_editor, dump_edit_baton,
+                                   authz_func, authz_baton,
+                                   FALSE, /* don't send text-deltas */
+                                   svn_depth_infinity,
+                                   FALSE, /* don't send entry props */
+                                   FALSE, /* don't ignore ancestry */
+                                   scratch_pool));
+    }
+  else
+    {
+      /* The normal case: compare consecutive revs. */
+      SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
+                                dump_editor, dump_edit_baton,
+                                authz_func, authz_baton, scratch_pool));
+
+      /* While our editor close_edit implementation is a no-op, we still
+         do this for completeness. */
+      SVN_ERR(dump_editor->close_edit(dump_edit_baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* How many revisions each worker of a concurrent dump or verify run may
+ * be ahead of the reporting on average.  See start_rev_workers(). */
+#define REV_SLOTS_PER_WORKER 4
+
+/* How many bytes of dump data per revision a concurrent dump run keeps
+ * in memory before spilling them to a temporary file. */
+#define DUMP_SPILL_SIZE (1024 * 1024)
+
+typedef struct rev_workers_t rev_workers_t;
+
+/* A revision being processed by one of the workers of a concurrent dump
+ * or verify run.  See start_rev_workers().
+ */
+typedef struct rev_job_t
+{
+  /* The run that this job belongs to. */
+  rev_workers_t *workers;
+
+  /* The revision to process. */
+  svn_revnum_t rev;
+
+  /* The job in the thread pool while REV is being processed. */
+  svn_thread_pool__job_t *job;
+
+  /* Notifications (svn_repos_notify_t *) that the processing of this
+     revision produced, in the order they were sent.  Allocated in POOL. */
+  apr_array_header_t *notifications;
+
+  /* Outcome of the revision processing.  Only valid once JOB has been
+     waited for. */
+  svn_error_t *err;
+
+  /* Dump data of this revision's node changes or NULL if there are none.
+     Only used by dump runs. */
+  svn_stream_t *dump_stream;
+
+  /* Whether the dump of this revision referred to revisions older than
+     the first dumped revision.  Only used by dump runs. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+
+  /* Owned by whichever thread currently processes this job. */
+  apr_pool_t *pool;
+} rev_job_t;
+
+/* Process revision REV of FS on behalf of JOB, using the job specific
+ * BATON.  Send notifications through NOTIFY_FUNC and NOTIFY_BATON and
+ * check for cancellation using CANCEL_FUNC and CANCEL_BATON.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+typedef svn_error_t *(*rev_job_func_t)(rev_job_t *job,
+                                       svn_fs_t *fs,
+                                       svn_revnum_t rev,
+                                       void *baton,
+                                       svn_repos_notify_func_t notify_func,
+                                       void *notify_baton,
+                                       svn_cancel_func_t cancel_func,
+                                       void *cancel_baton,
+                                       apr_pool_t *scratch_pool);
+
+/* State of a concurrent dump or verify run.  Only used by the main
+ * thread, except for the read-only parameters.
+ */
+struct rev_workers_t
+{
+  /* Parameters of the run.  Read-only for the workers. */
+  svn_fs_t *fs;
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+  svn_boolean_t notify;
+  rev_job_func_t job_func;
+  void *job_baton;
+
+  /* Ring buffer of JOB_COUNT jobs.  Revision REV is being handled by
+     element (REV - START_REV) % JOB_COUNT. */
+  rev_job_t *jobs;
+  int job_count;
+
+  /* Next revision to be submitted to the workers. */
+  svn_revnum_t next_rev;
+
+  /* Oldest revision that has not been reported by the main thread, yet. */
+  svn_revnum_t next_report;
+
+  /* Runs the jobs. */
+  svn_thread_pool__t *thread_pool;
+};
+
+/* Return the job in WORKERS that handles revision REV. */
+static rev_job_t *
+get_rev_job(rev_workers_t *workers,
+            svn_revnum_t rev)
+{
+  return &workers->jobs[(rev - workers->start_rev) % workers->job_count];
+}
+
+/* Implements svn_repos_notify_func_t.  Append a copy of NOTIFY to the
+ * notifications of the rev_job_t given as BATON.
+ */
+static void
+collect_job_notification(void *baton,
+                         const svn_repos_notify_t *notify,
+                         apr_pool_t *scratch_pool)
+{
+  rev_job_t *job = baton;
+  svn_repos_notify_t *copy = apr_pmemdup(job->pool, notify, sizeof(*notify));
+
+  if (notify->warning_str)
+    copy->warning_str = apr_pstrdup(job->pool, notify->warning_str);
+  if (notify->path)
+    copy->path = apr_pstrdup(job->pool, notify->path);
+
+  APR_ARRAY_PUSH(job->notifications, svn_repos_notify_t *) = copy;
+}
+
+/* Implements svn_thread_pool__worker_init_t.  Open a private instance of
+ * the FS of the rev_workers_t given as BATON.
+ */
+static svn_error_t *
+open_worker_fs(void **worker_baton,
+               void *baton,
+               int worker_index,
+               apr_pool_t *worker_pool)
+{
+  rev_workers_t *workers = baton;
+  svn_fs_t *fs;
+
+  SVN_ERR(svn_fs_open2(&fs, svn_fs_path(workers->fs, worker_pool),
+                       svn_fs_config(workers->fs, worker_pool),
+                       worker_pool, worker_pool));
+
+  *worker_baton = fs;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Process the rev_job_t given
+ * as JOB_BATON, using the svn_fs_t given as WORKER_BATON.  The outcome
+ * gets handed back to the main thread through the rev_job_t.
+ */
+static svn_error_t *
+run_rev_job(void *job_baton,
+            void *worker_baton,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *scratch_pool)
+{
+  rev_job_t *job = job_baton;
+  rev_workers_t *workers = job->workers;
+
+  job->err = workers->job_func(job, worker_baton, job->rev,
+                               workers->job_baton,
+                               workers->notify
+                                 ? collect_job_notification
+                                 : NULL,
+                               job, cancel_func, cancel_baton,
+                               scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Submit jobs to WORKERS for as many of the remaining revisions as the
+ * ring buffer allows.
+ */
+static svn_error_t *
+submit_rev_jobs(rev_workers_t *workers)
+{
+  while (   workers->next_rev <= workers->end_rev
+         && workers->next_rev - workers->next_report < workers->job_count)
+    {
+      rev_job_t *job = get_rev_job(workers, workers->next_rev);
+
+      job->rev = workers->next_rev;
+      SVN_ERR(svn_thread_pool__submit(&job->job, workers->thread_pool,
+                                      run_rev_job, job));
+
+      workers->next_rev++;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait until some worker in WORKERS finished processing JOB.  Check for
+ * cancellation using CANCEL_FUNC and CANCEL_BATON in regular intervals.
+ */
+static svn_error_t *
+wait_for_rev_job(rev_workers_t *workers,
+                 rev_job_t *job,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton)
+{
+  return svn_error_trace(svn_thread_pool__wait(workers->thread_pool,
+                                               job->job,
+                                               cancel_func, cancel_baton));
+}
+
+/* Make the job in WORKERS that handled the oldest unreported revision
+ * available for the next revision and submit that.
+ */
+static svn_error_t *
+release_rev_job(rev_workers_t *workers)
+{
+  rev_job_t *job = get_rev_job(workers, workers->next_report);
+
+  svn_pool_clear(job->pool);
+  job->notifications = apr_array_make(job->pool, 0,
+                                      sizeof(svn_repos_notify_t *));
+  job->job = NULL;
+  job->dump_stream = NULL;
+  job->found_old_reference = FALSE;
+  job->found_old_mergeinfo = FALSE;
+
+  workers->next_report++;
+
+  return svn_error_trace(submit_rev_jobs(workers));
+}
+
+/* Stop all workers in WORKERS that may still be running, wait for them
+ * and clear the results that have not been reported.  Return ERR combined
+ * with any error that occurred while doing so.
+ */
+static svn_error_t *
+stop_rev_workers(rev_workers_t *workers,
+                 svn_error_t *err)
+{
+  int i;
+
+  err = svn_error_compose_create(err,
+                                 svn_thread_pool__join(workers->thread_pool,
+                                                       TRUE));
+
+  /* Results of revisions that we did not report, including the
+     cancellation errors due to our abort, are irrelevant. */
+  for (i = 0; i < workers->job_count; ++i)
+    svn_error_clear(workers->jobs[i].err);
+
+  return svn_error_trace(err);
+}
+
+/* Initialize WORKERS and let up to JOBS worker threads, each with its
+ * private instance of FS, call JOB_FUNC with JOB_BATON for every revision
+ * from START_REV to END_REV in ascending order.  Workers collect
+ * notifications for the main thread only if NOTIFY is set.
+ *
+ * The main thread is expected to fetch the results with wait_for_rev_job()
+ * and release_rev_job() in revision order and to finally call
+ * stop_rev_workers().  Allocate everything in SCRATCH_POOL.
+ */
+static svn_error_t *
+start_rev_workers(rev_workers_t *workers,
+                  svn_fs_t *fs,
+                  svn_revnum_t start_rev,
+                  svn_revnum_t end_rev,
+                  int jobs,
+                  svn_boolean_t notify,
+                  rev_job_func_t job_func,
+                  void *job_baton,
+                  apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+  int i;
+
+  /* More threads than revisions would be pointless. */
+  if (jobs > end_rev - start_rev + 1)
+    jobs = (int)(end_rev - start_rev + 1);
+
+  memset(workers, 0, sizeof(*workers));
+  workers->fs = fs;
+  workers->start_rev = start_rev;
+  workers->end_rev = end_rev;
+  workers->notify = notify;
+  workers->job_func = job_func;
+  workers->job_baton = job_baton;
+  workers->next_rev = start_rev;
+  workers->next_report = start_rev;
+  workers->job_count = jobs * REV_SLOTS_PER_WORKER;
+  workers->jobs = apr_pcalloc(scratch_pool,
+                              workers->job_count * sizeof(*workers->jobs));
+  for (i = 0; i < workers->job_count; ++i)
+    {
+      rev_job_t *job = &workers->jobs[i];
+      job->workers = workers;
+      job->pool = svn_thread_pool__create_root_pool(scratch_pool);
+      job->notifications = apr_array_make(job->pool, 0,
+                                          sizeof(svn_repos_notify_t *));
+    }
+
+  SVN_ERR(svn_thread_pool__create(&workers->thread_pool, jobs,
+                                  open_worker_fs, workers, scratch_pool));
+
+  /* Don't leave the threads started so far behind. */
+  err = submit_rev_jobs(workers);
+  if (err)
+    return svn_error_trace(stop_rev_workers(workers, err));
+
+  return SVN_NO_ERROR;
+}
+
+/* Parameters of a concurrent dump run that are shared by all jobs. */
+typedef struct dump_job_baton_t
+{
+  svn_revnum_t start_rev;
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  svn_repos_authz_func_t authz_func;
+  void *authz_baton;
+} dump_job_baton_t;
+
+/* Implements rev_job_func_t.  Dump the node changes of REV into a new
+ * spill buffer in JOB.  BATON is a dump_job_baton_t.
+ */
+static svn_error_t *
+dump_job(rev_job_t *job,
+         svn_fs_t *fs,
+         svn_revnum_t rev,
+         void *baton,
+         svn_repos_notify_func_t notify_func,
+         void *notify_baton,
+         svn_cancel_func_t cancel_func,
+         void *cancel_baton,
+         apr_pool_t *scratch_pool)
+{
+  dump_job_baton_t *b = baton;
+
+  /* Revision 0 has no changes to dump. */
+  if (rev == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(cancel_func(cancel_baton));
+
+  job->dump_stream
+    = svn_stream__from_spillbuf(svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                                     DUMP_SPILL_SIZE,
+                                                     job->pool),
+                                job->pool);
+
+  return svn_error_trace(dump_one_revision(fs, rev, job->dump_stream,
+                                           b->start_rev, b->incremental,
+                                           b->use_deltas,
+                                           &job->found_old_reference,
+                                           &job->found_old_mergeinfo,
+                                           notify_func, notify_baton,
+                                           b->authz_func, b->authz_baton,
+                                           scratch_pool));
+}
+
+/* Like the revision loop in svn_repos_dump_fs5() with INCLUDE_CHANGES set
+ * but let up to JOBS worker threads produce the node changes of the
+ * revisions in REPOS concurrently, using a separate FS instance each.
+ * The dump data is written to STREAM by the calling thread in revision
+ * order, so the result is the same as that of a sequential run.  The
+ * same applies to all notifications and cancellation checks.
+ *
+ * Set *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO if the respective
+ * warnings were issued for any revision.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+dump_concurrently(svn_repos_t *repos,
+                  svn_stream_t *stream,
+                  svn_revnum_t start_rev,
+                  svn_revnum_t end_rev,
+                  int jobs,
+                  svn_boolean_t incremental,
+                  svn_boolean_t use_deltas,
+                  svn_boolean_t include_revprops,
+                  svn_boolean_t *found_old_reference,
+                  svn_boolean_t *found_old_mergeinfo,
+                  svn_repos_notify_func_t notify_func,
+                  void *notify_baton,
+                  svn_repos_authz_func_t authz_func,
+                  void *authz_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  rev_workers_t workers;
+  dump_job_baton_t job_baton;
+  svn_revnum_t rev;
+  svn_repos_notify_t *notify = NULL;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  job_baton.start_rev = start_rev;
+  job_baton.incremental = incremental;
+  job_baton.use_deltas = use_deltas;
+  job_baton.authz_func = authz_func;
+  job_baton.authz_baton = authz_baton;
+
+  SVN_ERR(start_rev_workers(&workers, svn_repos_fs(repos),
+                            start_rev, end_rev, jobs,
+                            notify_func != NULL, dump_job, &job_baton,
+                            scratch_pool));
+
+  if (notify_func)
+    notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                     scratch_pool);
+
+  /* Write the revisions in order as soon as they become available. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (rev = start_rev; rev <= end_rev && !err; rev++)
+    {
+      rev_job_t *job = get_rev_job(&workers, rev);
+
+      svn_pool_clear(iterpool);
+
+      /* Check for cancellation. */
+      if (cancel_func)
+        {
+          err = cancel_func(cancel_baton);
+          if (err)
+            break;
+        }
+
+      /* Write the revision record while the workers are busy. */
+      err = write_revision_record(stream, repos, rev, include_revprops,
+                                  authz_func, authz_baton, iterpool);
+      if (err)
+        break;
+
+      err = wait_for_rev_job(&workers, job, cancel_func, cancel_baton);
+      if (err)
+        break;
+
+      /* Replay the notifications sent while dumping the changes. */
+      if (notify_func)
+        for (i = 0; i < job->notifications->nelts; ++i)
+          notify_func(notify_baton,
+                      APR_ARRAY_IDX(job->notifications, i,
+                                    svn_repos_notify_t *),
+                      iterpool);
+
+      /* Take ownership of the worker's result. */
+      err = job->err;
+      job->err = SVN_NO_ERROR;
+      if (err)
+        break;
+
+      if (job->dump_stream)
+        {
+          err = svn_stream_copy3(job->dump_stream,
+                                 svn_stream_disown(stream, iterpool),
+                                 NULL, NULL, iterpool);
+          if (err)
+            break;
+        }
+
+      if (job->found_old_reference)
+        *found_old_reference = TRUE;
+      if (job->found_old_mergeinfo)
+        *found_old_mergeinfo = TRUE;
+
+      if (notify_func)
+        {
+          notify->revision = rev;
+          notify_func(notify_baton, notify, iterpool);
+        }
+
+      err = release_rev_job(&workers);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(stop_rev_workers(&workers, err));
+}
+
+#endif
+
+
 /* The main dumper. */
 svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
+svn_repos_dump_fs5(svn_repos_t *repos,
                    svn_stream_t *stream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
@@ -2031,6 +2579,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    svn_boolean_t use_deltas,
                    svn_boolean_t include_revprops,
                    svn_boolean_t include_changes,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_repos_dump_filter_func_t filter_func,
@@ -2039,8 +2588,6 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    void *cancel_baton,
                    apr_pool_t *pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
   svn_revnum_t rev;
   svn_fs_t *fs = svn_repos_fs(repos);
   apr_pool_t *iterpool = svn_pool_create(pool);
@@ -2052,6 +2599,9 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   svn_repos_notify_t *notify;
   svn_repos_authz_func_t authz_func;
   dump_filter_baton_t authz_baton = {0};
+#if APR_HAS_THREADS
+  svn_boolean_t concurrent = FALSE;
+#endif
 
   /* Make sure we catch up on the latest revprop changes.  This is the only
    * time we will refresh the revprop data in this query. */
@@ -2108,84 +2658,63 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   SVN_ERR(svn_repos__dump_magic_header_record(stream, version, pool));
   SVN_ERR(svn_repos__dump_uuid_header_record(stream, uuid, pool));
 
-  /* Create a notify object that we can reuse in the loop. */
-  if (notify_func)
-    notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
-                                     pool);
-
-  /* Main loop:  we're going to dump revision REV.  */
-  for (rev = start_rev; rev <= end_rev; rev++)
+#if APR_HAS_THREADS
+  /* Concurrent dumps only make sense for more than one revision with
+     changes.  BDB does not support multiple FS instances per process and
+     thread. */
+  if (include_changes && jobs > 1 && end_rev > start_rev)
     {
-      svn_fs_root_t *to_root;
-      svn_boolean_t use_deltas_for_rev;
-
-      svn_pool_clear(iterpool);
-
-      /* Check for cancellation. */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* Write the revision record. */
-      SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
+      const char *fs_type;
+      SVN_ERR(svn_fs_type(&fs_type, svn_fs_path(fs, pool), pool));
+      concurrent = strcmp(fs_type, SVN_FS_TYPE_BDB) != 0;
+    }
 
-      /* When dumping revision 0, we just write out the revision record.
-         The parser might want to use its properties.
-         If we don't want revision changes at all, skip in any case. */
-      if (rev == 0 || !include_changes)
-        goto loop_end;
-
-      /* Fetch the editor which dumps nodes to a file.  Regardless of
-         what we've been told, don't use deltas for the first rev of a
-         non-incremental dump. */
-      use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
-      SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
+  if (concurrent)
+    SVN_ERR(dump_concurrently(repos, stream, start_rev, end_rev, jobs,
+                              incremental, use_deltas, include_revprops,
+                              &found_old_reference, &found_old_mergeinfo,
                               notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
+                              authz_func, &authz_baton,
+                              cancel_func, cancel_baton, pool));
+  else
+#endif
+  {
+    /* Create a notify object that we can reuse in the loop. */
+    if (notify_func)
+      notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                       pool);
 
-      /* Drive the editor in one way or another. */
-      SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
+    /* Main loop:  we're going to dump revision REV.  */
+    for (rev = start_rev; rev <= end_rev; rev++)
+      {
+        svn_pool_clear(iterpool);
 
-      /* If this is the first revision of a non-incremental dump,
-         we're in for a full tree dump.  Otherwise, we want to simply
-         replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
-        {
-          /* Compare against revision 0, so everything appears to be added. */
-          svn_fs_root_t *from_root;
-          SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, iterpool));
-          SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
-                                       to_root, "",
-                                       dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
-                                       FALSE, /* don't send text-deltas */
-                                       svn_depth_infinity,
-                                       FALSE, /* don't send entry props */
-                                       FALSE, /* don't ignore ancestry */
-                                       iterpool));
-        }
-      else
-        {
-          /* The normal case: compare consecutive revs. */
-          SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
-                                    dump_editor, dump_edit_baton,
+        /* Check for cancellation. */
+        if (cancel_func)
+          SVN_ERR(cancel_func(cancel_baton));
+
+        /* Write the revision record. */
+        SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
+                                      authz_func, &authz_baton, iterpool));
+
+        /* When dumping revision 0, we just write out the revision record.
+           The parser might want to use its properties.
+           If we don't want revision changes at all, skip in any case. */
+        if (rev != 0 && include_changes)
+          SVN_ERR(dump_one_revision(fs, rev, stream, start_rev,
+                                    incremental, use_deltas,
+                                    &found_old_reference,
+                                    &found_old_mergeinfo,
+                                    notify_func, notify_baton,
                                     authz_func, &authz_baton, iterpool));
 
-          /* While our editor close_edit implementation is a no-op, we still
-             do this for completeness. */
-          SVN_ERR(dump_editor->close_edit(dump_edit_baton, iterpool));
-        }
-
-    loop_end:
-      if (notify_func)
-        {
-          notify->revision = rev;
-          notify_func(notify_baton, notify, iterpool);
-        }
-    }
+        if (notify_func)
+          {
+            notify->revision = rev;
+            notify_func(notify_baton, notify, iterpool);
+          }
+      }
+  }
 
   if (notify_func)
     {
@@ -2459,12 +2988,139 @@ report_error(svn_revnum_t revision,
     }
 }
 
+#if APR_HAS_THREADS
+
+/* Parameters of a concurrent verify run that are shared by all jobs. */
+typedef struct verify_job_baton_t
+{
+  svn_revnum_t start_rev;
+  svn_boolean_t check_normalization;
+} verify_job_baton_t;
+
+/* Implements rev_job_func_t.  Verify REV.  BATON is a verify_job_baton_t.
+ */
+static svn_error_t *
+verify_job(rev_job_t *job,
+           svn_fs_t *fs,
+           svn_revnum_t rev,
+           void *baton,
+           svn_repos_notify_func_t notify_func,
+           void *notify_baton,
+           svn_cancel_func_t cancel_func,
+           void *cancel_baton,
+           apr_pool_t *scratch_pool)
+{
+  verify_job_baton_t *b = baton;
+
+  return svn_error_trace(verify_one_revision(fs, rev,
+                                             notify_func, notify_baton,
+                                             b->start_rev,
+                                             b->check_normalization,
+                                             cancel_func, cancel_baton,
+                                             scratch_pool));
+}
+
+/* Like the revision loop in svn_repos_verify_fs4() but verify up to JOBS
+ * revisions of FS concurrently, using a separate FS instance per worker
+ * thread.  All notifications, callback invocations and cancellation checks
+ * happen in the calling thread and in the same order as for a sequential
+ * run.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+verify_concurrently(svn_fs_t *fs,
+                    svn_revnum_t start_rev,
+                    svn_revnum_t end_rev,
+                    int jobs,
+                    svn_boolean_t check_normalization,
+                    svn_repos_notify_func_t notify_func,
+                    void *notify_baton,
+                    svn_repos_verify_callback_t verify_callback,
+                    void *verify_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  rev_workers_t workers;
+  verify_job_baton_t job_baton;
+  int i;
+  svn_revnum_t rev;
+  svn_repos_notify_t *notify = NULL;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  job_baton.start_rev = start_rev;
+  job_baton.check_normalization = check_normalization;
+
+  SVN_ERR(start_rev_workers(&workers, fs, start_rev, end_rev, jobs,
+                            notify_func != NULL, verify_job, &job_baton,
+                            scratch_pool));
+
+  if (notify_func)
+    notify = svn_repos_notify_create(svn_repos_notify_verify_rev_end,
+                                     scratch_pool);
+
+  /* Report the results in revision order as soon as they become
+     available. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (rev = start_rev; rev <= end_rev && !err; rev++)
+    {
+      rev_job_t *job = get_rev_job(&workers, rev);
+      svn_error_t *verify_err;
+
+      svn_pool_clear(iterpool);
+
+      err = wait_for_rev_job(&workers, job, cancel_func, cancel_baton);
+      if (err)
+        break;
+
+      /* Replay the notifications sent during the verification. */
+      if (notify_func)
+        for (i = 0; i < job->notifications->nelts; ++i)
+          notify_func(notify_baton,
+                      APR_ARRAY_IDX(job->notifications, i,
+                                    svn_repos_notify_t *),
+                      iterpool);
+
+      /* Take ownership of the worker's result. */
+      verify_err = job->err;
+      job->err = SVN_NO_ERROR;
+
+      if (verify_err && verify_err->apr_err == SVN_ERR_CANCELLED)
+        {
+          err = verify_err;
+          break;
+        }
+      else if (verify_err)
+        {
+          err = report_error(rev, verify_err, verify_callback, verify_baton,
+                             iterpool);
+          if (err)
+            break;
+        }
+      else if (notify_func)
+        {
+          /* Tell the caller that we're done with this revision. */
+          notify->revision = rev;
+          notify_func(notify_baton, notify, iterpool);
+        }
+
+      err = release_rev_job(&workers);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(stop_rev_workers(&workers, err));
+}
+
+#endif
+
 svn_error_t *
-svn_repos_verify_fs3(svn_repos_t *repos,
+svn_repos_verify_fs4(svn_repos_t *repos,
                      svn_revnum_t start_rev,
                      svn_revnum_t end_rev,
                      svn_boolean_t check_normalization,
                      svn_boolean_t metadata_only,
+                     int jobs,
                      svn_repos_notify_func_t notify_func,
                      void *notify_baton,
                      svn_repos_verify_callback_t verify_callback,
@@ -2481,6 +3137,9 @@ svn_repos_verify_fs3(svn_repos_t *repos,
   svn_fs_progress_notify_func_t verify_notify = NULL;
   struct verify_fs_notify_func_baton_t *verify_notify_baton = NULL;
   svn_error_t *err;
+#if APR_HAS_THREADS
+  svn_boolean_t concurrent = FALSE;
+#endif
 
   /* Make sure we catch up on the latest revprop changes.  This is the only
    * time we will refresh the revprop data in this query. */
@@ -2508,7 +3167,7 @@ svn_repos_verify_fs3(svn_repos_t *repos,
                              end_rev, youngest);
 
   /* Create a notify object that we can reuse within the loop and a
-     forwarding structure for notifications from inside svn_fs_verify(). */
+     forwarding structure for notifications from inside svn_fs_verify2(). */
   if (notify_func)
     {
       notify = svn_repos_notify_create(svn_repos_notify_verify_rev_end, pool);
@@ -2522,10 +3181,10 @@ svn_repos_verify_fs3(svn_repos_t *repos,
     }
 
   /* Verify global metadata and backend-specific data first. */
-  err = svn_fs_verify(svn_fs_path(fs, pool), svn_fs_config(fs, pool),
-                      start_rev, end_rev,
-                      verify_notify, verify_notify_baton,
-                      cancel_func, cancel_baton, pool);
+  err = svn_fs_verify2(svn_fs_path(fs, pool), svn_fs_config(fs, pool),
+                       start_rev, end_rev, jobs,
+                       verify_notify, verify_notify_baton,
+                       cancel_func, cancel_baton, pool);
 
   if (err && err->apr_err == SVN_ERR_CANCELLED)
     {
@@ -2537,6 +3196,24 @@ svn_repos_verify_fs3(svn_repos_t *repos,
                            verify_baton, iterpool));
     }
 
+#if APR_HAS_THREADS
+  /* Concurrent verification only makes sense for more than one revision.
+     BDB does not support multiple FS instances per process and thread. */
+  if (!metadata_only && jobs > 1 && end_rev > start_rev)
+    {
+      const char *fs_type;
+      SVN_ERR(svn_fs_type(&fs_type, svn_fs_path(fs, pool), pool));
+      concurrent = strcmp(fs_type, SVN_FS_TYPE_BDB) != 0;
+    }
+
+  if (concurrent)
+    SVN_ERR(verify_concurrently(fs, start_rev, end_rev, jobs,
+                                check_normalization,
+                                notify_func, notify_baton,
+                                verify_callback, verify_baton,
+                                cancel_func, cancel_baton, pool));
+  else
+#endif
   if (!metadata_only)
     for (rev = start_rev; rev <= end_rev; rev++)
       {
@@ -30,9 +30,13 @@
 #include "svn_dirent_uri.h"
 
 #include "private/svn_repos_private.h"
+#include "private/svn_subr_private.h"
 
 #include <assert.h>
 
+/* Keep text deltas up to this size in memory. */
+#define DELTA_SPILL_SIZE (1024 * 1024)
+
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
 
@@ -154,11 +158,10 @@ struct dump_edit_baton {
   /* Pool for per-revision allocations */
   apr_pool_t *pool;
 
-  /* Temporary file used for textdelta application along with its
-     absolute path; these two variables should be allocated in the
-     per-edit-session pool */
-  const char *delta_abspath;
-  apr_file_t *delta_file;
+  /* Buffer used for textdelta application, to measure the
+     Text-content-length before dumping the delta; allocated in the
+     per-edit-session pool.  Small deltas never touch the disk. */
+  svn_spillbuf_t *delta_buf;
 
   /* The baton of the directory node whose block of
      dump stream data has not been fully completed; NULL if there's no
@@ -880,14 +883,14 @@ apply_textdelta(void *file_baton, const char *base_checksum,
 {
   struct file_baton *fb = file_baton;
   struct dump_edit_baton *eb = fb->eb;
-  svn_stream_t *delta_filestream;
+  svn_stream_t *delta_stream;
 
-  /* Use a temporary file to measure the Text-content-length */
-  delta_filestream = svn_stream_from_aprfile2(eb->delta_file, TRUE, pool);
+  /* Buffer the delta to measure the Text-content-length */
+  delta_stream = svn_stream__from_spillbuf(eb->delta_buf, pool);
 
-  /* Prepare to write the delta to the delta_filestream */
+  /* Prepare to write the delta to the delta_stream */
   svn_txdelta_to_svndiff3(handler, handler_baton,
-                          delta_filestream, 0,
+                          delta_stream, 0,
                           SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, pool);
 
   /* Record that there's text to be dumped, and its base checksum. */
@@ -932,8 +935,7 @@ close_file(void *file_baton,
       svn_repos__dumpfile_header_push(
         headers, SVN_REPOS_DUMPFILE_TEXT_DELTA, "true");
 
-      SVN_ERR(svn_io_file_size_get(&text_content_length, eb->delta_file,
-                                   pool));
+      text_content_length = svn_spillbuf__get_size(eb->delta_buf);
 
       if (fb->base_checksum)
         /* Text-delta-base-md5: */
@@ -962,23 +964,13 @@ close_file(void *file_baton,
   /* Dump the text */
   if (fb->dump_text)
     {
-      /* Seek to the beginning of the delta file, map it to a stream,
-         and copy the stream to eb->stream. Then close the stream and
-         truncate the file so we can reuse it for the next textdelta
-         application. Note that the file isn't created, opened or
-         closed here */
-      svn_stream_t *delta_filestream;
-      apr_off_t offset = 0;
-
-      SVN_ERR(svn_io_file_seek(eb->delta_file, APR_SET, &offset, pool));
-      delta_filestream = svn_stream_from_aprfile2(eb->delta_file, TRUE, pool);
-      SVN_ERR(svn_stream_copy3(delta_filestream,
+      /* Copy the buffered delta to eb->stream.  Reading it drains
+         the buffer, so it is ready for the next textdelta
+         application. */
+      SVN_ERR(svn_stream_copy3(svn_stream__from_spillbuf(eb->delta_buf,
+                                                         pool),
                                svn_stream_disown(eb->stream, pool),
                                NULL, NULL, pool));
-
-      /* Cleanup */
-      SVN_ERR(svn_stream_close(delta_filestream));
-      SVN_ERR(svn_io_file_trunc(eb->delta_file, 0, pool));
     }
 
   /* Write a couple of blank lines for matching output with `svnadmin
@@ -1012,11 +1004,11 @@ svn_repos__get_dump_editor(const svn_delta_editor_t **editor,
   /* Create a special per-revision pool */
   eb->pool = svn_pool_create(pool);
 
-  /* Open a unique temporary file for all textdelta applications in
-     this edit session. The file is automatically closed and cleaned
-     up when the edit session is done. */
-  SVN_ERR(svn_io_open_unique_file3(&(eb->delta_file), &(eb->delta_abspath),
-                                   NULL, svn_io_file_del_on_close, pool, pool));
+  /* Buffer all textdelta applications in this edit session.  svnrdump
+     creates one edit session per revision, so only spill deltas to a
+     temporary file once they get large. */
+  eb->delta_buf = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                       DELTA_SPILL_SIZE, pool);
 
   de = svn_delta_default_editor(pool);
   de->open_root = open_root;
@@ -1033,7 +1033,8 @@ pack_notify_func(void *baton,
 }
 
 svn_error_t *
-svn_repos_fs_pack2(svn_repos_t *repos,
+svn_repos_fs_pack3(svn_repos_t *repos,
+                   int jobs,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -1045,10 +1046,82 @@ svn_repos_fs_pack2(svn_repos_t *repos,
   pnb.notify_func = notify_func;
   pnb.notify_baton = notify_baton;
 
-  return svn_fs_pack(repos->db_path,
-                     notify_func ? pack_notify_func : NULL,
-                     notify_func ? &pnb : NULL,
-                     cancel_func, cancel_baton, pool);
+  return svn_fs_pack2(repos->db_path, jobs,
+                      notify_func ? pack_notify_func : NULL,
+                      notify_func ? &pnb : NULL,
+                      cancel_func, cancel_baton, pool);
+}
+
+/* Sleep for PAUSE, if given, and then check for cancellation. */
+static svn_error_t *
+warm_cache_throttle(apr_interval_time_t pause,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton)
+{
+  if (pause > 0)
+    apr_sleep(pause);
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_warm_cache(svn_repos_t *repos,
+                     const apr_array_header_t *paths,
+                     int recent_revisions,
+                     apr_interval_time_t pause,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = repos->fs;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_revnum_t youngest, rev, oldest;
+  svn_fs_root_t *root;
+  int i;
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest, fs, scratch_pool));
+  oldest = MAX(0, youngest - MAX(recent_revisions, 0) + 1);
+
+  /* Revprops and root directories of the latest revisions, newest first.
+     Reading them also loads the respective index pages. */
+  for (rev = youngest; rev >= oldest; --rev)
+    {
+      apr_hash_t *props, *entries;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(warm_cache_throttle(pause, cancel_func, cancel_baton));
+
+      SVN_ERR(svn_fs_revision_proplist2(&props, fs, rev, FALSE, iterpool,
+                                        iterpool));
+      SVN_ERR(svn_fs_revision_root(&root, fs, rev, iterpool));
+      SVN_ERR(svn_fs_dir_entries(&entries, root, "/", iterpool));
+    }
+
+  /* The HEAD trees of the given paths. */
+  SVN_ERR(svn_fs_revision_root(&root, fs, youngest, scratch_pool));
+  for (i = 0; paths && i < paths->nelts; ++i)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_node_kind_t kind;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(warm_cache_throttle(pause, cancel_func, cancel_baton));
+
+      /* Profiles may be outdated; silently skip paths that are gone. */
+      SVN_ERR(svn_fs_check_path(&kind, root, path, iterpool));
+      if (kind == svn_node_none)
+        continue;
+
+      SVN_ERR(svn_fs_prefetch_tree(root, path, cancel_func, cancel_baton,
+                                   iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
 }
 
 svn_error_t *
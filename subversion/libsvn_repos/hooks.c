@@ -26,18 +26,24 @@
 
 #include <apr_pools.h>
 #include <apr_file_io.h>
+#include <apr_thread_cond.h>
+#include <apr_thread_proc.h>
 
 #include "svn_config.h"
+#include "svn_ctype.h"
 #include "svn_hash.h"
 #include "svn_error.h"
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 #include "svn_pools.h"
+#include "svn_props.h"
 #include "svn_repos.h"
 #include "svn_utf.h"
 #include "repos.h"
 #include "svn_private_config.h"
+#include "private/svn_atomic.h"
 #include "private/svn_fs_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_string_private.h"
 
@@ -193,31 +199,44 @@ env_from_env_hash(apr_hash_t *env_hash,
   return env;
 }
 
-/* NAME, CMD and ARGS are the name, path to and arguments for the hook
-   program that is to be run.  The hook's exit status will be checked,
-   and if an error occurred the hook's stderr output will be added to
-   the returned error.
+/* Return the environment variables that HOOKS_ENV defines for the hook
+ * NAME, falling back to those of the default section.  Return NULL if
+ * the hook shall run in an empty environment. */
+static apr_hash_t *
+get_hook_env(apr_hash_t *hooks_env,
+             const char *name)
+{
+  apr_hash_t *hook_env = NULL;
 
-   If STDIN_HANDLE is non-null, pass it as the hook's stdin, else pass
-   no stdin to the hook.
+  /* Check if a custom environment is defined for this hook, or else
+   * whether a default environment is defined. */
+  if (hooks_env)
+    {
+      hook_env = svn_hash_gets(hooks_env, name);
+      if (hook_env == NULL)
+        hook_env = svn_hash_gets(hooks_env,
+                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
+    }
 
-   If RESULT is non-null, set *RESULT to the stdout of the hook or to
-   a zero-length string if the hook generates no output on stdout. */
+  return hook_env;
+}
+
+/* Like run_hook_cmd() but run the hook program with the environment
+   ENV, as created by env_from_env_hash(). */
 static svn_error_t *
-run_hook_cmd(svn_string_t **result,
-             const char *name,
-             const char *cmd,
-             const char **args,
-             apr_hash_t *hooks_env,
-             apr_file_t *stdin_handle,
-             apr_pool_t *pool)
+run_hook_cmd_with_env(svn_string_t **result,
+                      const char *name,
+                      const char *cmd,
+                      const char **args,
+                      const char **env,
+                      apr_file_t *stdin_handle,
+                      apr_pool_t *pool)
 {
   apr_file_t *null_handle;
   apr_status_t apr_err;
   svn_error_t *err;
   apr_proc_t cmd_proc = {0};
   apr_pool_t *cmd_pool;
-  apr_hash_t *hook_env = NULL;
 
   if (result)
     {
@@ -237,18 +256,7 @@ run_hook_cmd(svn_string_t **result,
    * destroy in order to clean up the stderr pipe opened for the process. */
   cmd_pool = svn_pool_create(pool);
 
-  /* Check if a custom environment is defined for this hook, or else
-   * whether a default environment is defined. */
-  if (hooks_env)
-    {
-      hook_env = svn_hash_gets(hooks_env, name);
-      if (hook_env == NULL)
-        hook_env = svn_hash_gets(hooks_env,
-                                 SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION);
-    }
-
-  err = svn_io_start_cmd3(&cmd_proc, ".", cmd, args,
-                          env_from_env_hash(hook_env, pool, pool),
+  err = svn_io_start_cmd3(&cmd_proc, ".", cmd, args, env,
                           FALSE, FALSE, stdin_handle, result != NULL,
                           null_handle, TRUE, NULL, cmd_pool);
   if (!err)
@@ -285,6 +293,32 @@ run_hook_cmd(svn_string_t **result,
   return svn_error_trace(err);
 }
 
+/* NAME, CMD and ARGS are the name, path to and arguments for the hook
+   program that is to be run.  The hook's exit status will be checked,
+   and if an error occurred the hook's stderr output will be added to
+   the returned error.
+
+   If STDIN_HANDLE is non-null, pass it as the hook's stdin, else pass
+   no stdin to the hook.
+
+   If RESULT is non-null, set *RESULT to the stdout of the hook or to
+   a zero-length string if the hook generates no output on stdout. */
+static svn_error_t *
+run_hook_cmd(svn_string_t **result,
+             const char *name,
+             const char *cmd,
+             const char **args,
+             apr_hash_t *hooks_env,
+             apr_file_t *stdin_handle,
+             apr_pool_t *pool)
+{
+  const char **env = env_from_env_hash(get_hook_env(hooks_env, name),
+                                       pool, pool);
+
+  return svn_error_trace(run_hook_cmd_with_env(result, name, cmd, args, env,
+                                               stdin_handle, pool));
+}
+
 
 /* Create a temporary file F that will automatically be deleted when the
    pool is cleaned up.  Fill it with VALUE, and leave it open and rewound,
@@ -302,6 +336,313 @@ create_temp_file(apr_file_t **f, const svn_string_t *value, apr_pool_t *pool)
 }
 
 
+/*** Running hooks in the background. ***/
+
+/* The hooks-env option in SVN_REPOS__HOOKS_ENV_ASYNC_SECTION that sets how
+   often a background hook is run again after it failed. */
+#define ASYNC_HOOK_RETRIES_OPTION "retries"
+
+/* Time to wait before the first retry of a failed background hook.  Every
+   further retry waits this much longer than the one before. */
+#define ASYNC_HOOK_RETRY_DELAY apr_time_from_sec(1)
+
+#if APR_HAS_THREADS
+
+/* A hook run waiting in the background hook queue. */
+typedef struct async_hook_t
+{
+  /* Name, program, arguments and environment, as for
+     run_hook_cmd_with_env(). */
+  const char *name;
+  const char *cmd;
+  const char **args;
+  const char **env;
+
+  /* Contents to pass to the hook's stdin, or NULL for no stdin. */
+  svn_string_t *stdin_value;
+
+  /* How often to run the hook again if it fails. */
+  int retries;
+
+  /* The next hook to run, in queue order. */
+  struct async_hook_t *next;
+
+  /* Root pool holding this structure. */
+  apr_pool_t *pool;
+} async_hook_t;
+
+/* The process-wide queue of hooks that run in the background.  A single
+   thread runs them one at a time, in the order in which they were queued.
+ */
+typedef struct async_hook_queue_t
+{
+  /* Serializes access to all members below. */
+  svn_mutex__t *mutex;
+
+  /* Signalled whenever a hook gets queued or the queue stops. */
+  apr_thread_cond_t *cond;
+
+  /* The queued hooks, oldest first. */
+  async_hook_t *first;
+  async_hook_t *last;
+
+  /* Set when the process shuts down.  The thread then terminates once
+     all queued hooks have run. */
+  svn_boolean_t stopping;
+
+  /* The thread running the hooks and the root pool it lives in. */
+  apr_thread_t *thread;
+  apr_pool_t *thread_pool;
+} async_hook_queue_t;
+
+/* The background hook queue, started on first use. */
+static async_hook_queue_t *async_hook_queue = NULL;
+static volatile svn_atomic_t async_hook_queue_init_state = 0;
+
+/* Run HOOK, retrying as often as it asks for if it fails.  There is nobody
+   left to report a failure to, so the last error is simply dropped. */
+static void
+run_async_hook(async_hook_t *hook)
+{
+  apr_pool_t *iterpool = svn_pool_create(hook->pool);
+  int attempt;
+
+  for (attempt = 0; attempt <= hook->retries; ++attempt)
+    {
+      apr_file_t *stdin_handle = NULL;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+      if (attempt)
+        apr_sleep(ASYNC_HOOK_RETRY_DELAY * attempt);
+
+      if (hook->stdin_value)
+        err = create_temp_file(&stdin_handle, hook->stdin_value, iterpool);
+      if (!err)
+        err = run_hook_cmd_with_env(NULL, hook->name, hook->cmd, hook->args,
+                                    hook->env, stdin_handle, iterpool);
+      if (!err)
+        break;
+
+      svn_error_clear(err);
+    }
+
+  svn_pool_destroy(iterpool);
+}
+
+/* Wait for the next hook in QUEUE and take it out of the queue.  Set *HOOK
+   to NULL once the queue is stopping and empty. */
+static svn_error_t *
+claim_async_hook(async_hook_t **hook,
+                 async_hook_queue_t *queue)
+{
+  apr_thread_mutex_t *mutex = svn_mutex__get(queue->mutex);
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(queue->mutex));
+
+  /* This loop implicitly handles spurious wake-ups. */
+  while (!err && !queue->first && !queue->stopping)
+    {
+      apr_status_t status = apr_thread_cond_wait(queue->cond, mutex);
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't wait for queued hooks"));
+    }
+
+  *hook = NULL;
+  if (!err && queue->first)
+    {
+      *hook = queue->first;
+      queue->first = queue->first->next;
+      if (!queue->first)
+        queue->last = NULL;
+    }
+
+  return svn_error_trace(svn_mutex__unlock(queue->mutex, err));
+}
+
+/* The thread main function of the background hook runner.  DATA is the
+   async_hook_queue_t. */
+static void * APR_THREAD_FUNC
+async_hook_runner(apr_thread_t *thread, void *data)
+{
+  async_hook_queue_t *queue = data;
+
+  while (TRUE)
+    {
+      async_hook_t *hook;
+
+      /* There is no way to report synchronization failures from here. */
+      svn_error_t *err = claim_async_hook(&hook, queue);
+      if (err || !hook)
+        {
+          svn_error_clear(err);
+          break;
+        }
+
+      run_async_hook(hook);
+      svn_pool_destroy(hook->pool);
+    }
+
+  /* End thread explicitly to prevent APR_INCOMPLETE return codes in
+     apr_thread_join(). */
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Pool cleanup handler for the pool of the async_hook_queue_t in DATA.
+   Let the runner thread finish all queued hooks and wait for it, so that
+   no hook gets lost when the process exits normally. */
+static apr_status_t
+stop_async_hook_queue(void *data)
+{
+  async_hook_queue_t *queue = data;
+  apr_status_t thread_status;
+
+  svn_error_clear(svn_mutex__lock(queue->mutex));
+  queue->stopping = TRUE;
+  apr_thread_cond_broadcast(queue->cond);
+  svn_error_clear(svn_mutex__unlock(queue->mutex, SVN_NO_ERROR));
+
+  apr_thread_join(&thread_status, queue->thread);
+  svn_pool_destroy(queue->thread_pool);
+  async_hook_queue = NULL;
+
+  return APR_SUCCESS;
+}
+
+/* Implements svn_atomic__err_init_func_t.  Create the background hook
+   queue and start its runner thread. */
+static svn_error_t *
+init_async_hook_queue(void *baton,
+                      apr_pool_t *scratch_pool)
+{
+  /* The queue lives until the process terminates. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+  async_hook_queue_t *queue = apr_pcalloc(pool, sizeof(*queue));
+  apr_status_t status;
+
+  SVN_ERR(svn_mutex__init(&queue->mutex, TRUE, pool));
+  status = apr_thread_cond_create(&queue->cond, pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create condition variable"));
+
+  /* Give the thread a root pool of its own.  It must still exist while
+     POOL gets cleaned up and the thread finishes the queue. */
+  queue->thread_pool
+    = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  status = apr_thread_create(&queue->thread, NULL, async_hook_runner, queue,
+                             queue->thread_pool);
+  if (status)
+    {
+      svn_pool_destroy(queue->thread_pool);
+      return svn_error_wrap_apr(status, _("Can't create hook runner thread"));
+    }
+
+  apr_pool_cleanup_register(pool, queue, stop_async_hook_queue,
+                            apr_pool_cleanup_null);
+  async_hook_queue = queue;
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* If the [async-hooks] section of HOOKS_ENV enables the hook NAME to run in
+   the background, queue the hook program CMD with ARGS for the background
+   hook runner and set *QUEUED to TRUE.  Pass a copy of STDIN_VALUE as the
+   hook's stdin, unless that is NULL.  Otherwise, set *QUEUED to FALSE and
+   leave it to the caller to run the hook.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+queue_async_hook(svn_boolean_t *queued,
+                 const char *name,
+                 const char *cmd,
+                 const char **args,
+                 apr_hash_t *hooks_env,
+                 const svn_string_t *stdin_value,
+                 apr_pool_t *scratch_pool)
+{
+  apr_hash_t *settings = NULL;
+  const char *value = NULL;
+  int retries = 0;
+  svn_error_t *err;
+#if APR_HAS_THREADS
+  async_hook_t *hook;
+  apr_pool_t *pool;
+  int i;
+#endif
+
+  *queued = FALSE;
+
+  if (hooks_env)
+    settings = svn_hash_gets(hooks_env, SVN_REPOS__HOOKS_ENV_ASYNC_SECTION);
+  if (settings)
+    value = svn_hash_gets(settings, name);
+  if (!value || svn_tristate__from_word(value) != svn_tristate_true)
+    return SVN_NO_ERROR;
+
+  value = svn_hash_gets(settings, ASYNC_HOOK_RETRIES_OPTION);
+  if (value)
+    {
+      err = svn_cstring_atoi(&retries, value);
+      if (err || retries < 0)
+        return svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, err,
+                                 _("Invalid value '%s' for option '%s' in "
+                                   "section '%s' of the hooks environment"),
+                                 value, ASYNC_HOOK_RETRIES_OPTION,
+                                 SVN_REPOS__HOOKS_ENV_ASYNC_SECTION);
+    }
+
+#if APR_HAS_THREADS
+  /* Without a runner thread, fall back to running the hook right away. */
+  err = svn_atomic__init_once(&async_hook_queue_init_state,
+                              init_async_hook_queue, NULL, scratch_pool);
+  if (err || !async_hook_queue)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  hook = apr_pcalloc(pool, sizeof(*hook));
+  hook->name = apr_pstrdup(pool, name);
+  hook->cmd = apr_pstrdup(pool, cmd);
+  hook->env = env_from_env_hash(get_hook_env(hooks_env, name), pool,
+                                scratch_pool);
+  hook->stdin_value = stdin_value ? svn_string_dup(stdin_value, pool) : NULL;
+  hook->retries = retries;
+  hook->pool = pool;
+
+  for (i = 0; args[i]; ++i)
+    ;
+  hook->args = apr_pcalloc(pool, (i + 1) * sizeof(*hook->args));
+  for (i = 0; args[i]; ++i)
+    hook->args[i] = apr_pstrdup(pool, args[i]);
+
+  err = svn_mutex__lock(async_hook_queue->mutex);
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  if (async_hook_queue->last)
+    async_hook_queue->last->next = hook;
+  else
+    async_hook_queue->first = hook;
+  async_hook_queue->last = hook;
+  apr_thread_cond_signal(async_hook_queue->cond);
+
+  SVN_ERR(svn_mutex__unlock(async_hook_queue->mutex, SVN_NO_ERROR));
+  *queued = TRUE;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Check if the HOOK program exists and is a file or a symbolic link, using
    POOL for temporary allocations.
 
@@ -541,6 +882,175 @@ lock_token_content(apr_file_t **handle, apr_hash_t *lock_tokens,
 
 
 
+/* Options of the SVN_REPOS__HOOKS_ENV_PRE_COMMIT_CHECKS_SECTION in the
+   hooks-env file. */
+#define PRE_COMMIT_CHECK_MAX_FILE_SIZE "max-file-size"
+#define PRE_COMMIT_CHECK_REJECT_PATHS "reject-paths"
+#define PRE_COMMIT_CHECK_REJECT_PROPERTIES "reject-properties"
+#define PRE_COMMIT_CHECK_REQUIRE_LOG_MESSAGE "require-log-message"
+
+/* Return the error that blocks a commit rejected by the in-process
+   pre-commit checks because of REASON. */
+static svn_error_t *
+pre_commit_check_failure(const char *reason)
+{
+  return svn_error_createf(SVN_ERR_REPOS_HOOK_FAILURE, NULL,
+                           _("Commit blocked by pre-commit checks:\n%s"),
+                           reason);
+}
+
+/* Return the error for the invalid VALUE of the pre-commit check OPTION,
+   wrapping ERR. */
+static svn_error_t *
+pre_commit_check_bad_value(svn_error_t *err,
+                           const char *option,
+                           const char *value)
+{
+  return svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, err,
+                           _("Invalid value '%s' for option '%s' in "
+                             "section '%s' of the hooks environment"),
+                           value, option,
+                           SVN_REPOS__HOOKS_ENV_PRE_COMMIT_CHECKS_SECTION);
+}
+
+/* Run the checks that the [pre-commit-checks] section of HOOKS_ENV
+   configures against the transaction TXN_NAME in REPOS.  These run
+   within the current process, before the pre-commit hook program, and
+   work on the already open filesystem of REPOS.
+
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+run_pre_commit_checks(svn_repos_t *repos,
+                      apr_hash_t *hooks_env,
+                      const char *txn_name,
+                      apr_pool_t *scratch_pool)
+{
+  apr_hash_t *settings = NULL;
+  const char *value;
+  apr_int64_t max_file_size = -1;
+  apr_array_header_t *reject_paths = NULL;
+  apr_array_header_t *reject_props = NULL;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_fs_path_change_iterator_t *iterator;
+  svn_fs_path_change3_t *change;
+  apr_pool_t *iterpool;
+  svn_error_t *err;
+
+  if (hooks_env)
+    settings = svn_hash_gets(hooks_env,
+                             SVN_REPOS__HOOKS_ENV_PRE_COMMIT_CHECKS_SECTION);
+  if (!settings)
+    return SVN_NO_ERROR;
+
+  value = svn_hash_gets(settings, PRE_COMMIT_CHECK_MAX_FILE_SIZE);
+  if (value)
+    {
+      err = svn_cstring_atoi64(&max_file_size, value);
+      if (err || max_file_size < 0)
+        return pre_commit_check_bad_value(err, PRE_COMMIT_CHECK_MAX_FILE_SIZE,
+                                          value);
+    }
+
+  value = svn_hash_gets(settings, PRE_COMMIT_CHECK_REJECT_PATHS);
+  if (value)
+    reject_paths = svn_cstring_split(value, " \t,", TRUE, scratch_pool);
+
+  value = svn_hash_gets(settings, PRE_COMMIT_CHECK_REJECT_PROPERTIES);
+  if (value)
+    reject_props = svn_cstring_split(value, " \t,", TRUE, scratch_pool);
+
+  SVN_ERR(svn_fs_open_txn(&txn, repos->fs, txn_name, scratch_pool));
+
+  value = svn_hash_gets(settings, PRE_COMMIT_CHECK_REQUIRE_LOG_MESSAGE);
+  if (value && svn_tristate__from_word(value) == svn_tristate_true)
+    {
+      svn_string_t *log_msg;
+      const char *c = NULL;
+
+      SVN_ERR(svn_fs_txn_prop(&log_msg, txn, SVN_PROP_REVISION_LOG,
+                              scratch_pool));
+      if (log_msg)
+        for (c = log_msg->data; svn_ctype_isspace(*c); ++c)
+          ;
+
+      if (!c || !*c)
+        return pre_commit_check_failure(_("A log message is required"));
+    }
+
+  if (max_file_size < 0 && !reject_paths && !reject_props)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_txn_root(&root, txn, scratch_pool));
+  SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
+  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (change)
+    {
+      const char *path = change->path.data;
+      svn_node_kind_t kind = change->node_kind;
+      int i;
+
+      svn_pool_clear(iterpool);
+
+      if (change->change_kind == svn_fs_path_change_delete)
+        {
+          SVN_ERR(svn_fs_path_change_get(&change, iterator));
+          continue;
+        }
+
+      if (reject_paths && svn_cstring_match_glob_list(path, reject_paths))
+        return pre_commit_check_failure(
+                 apr_psprintf(scratch_pool,
+                              _("Path '%s' is not allowed in the "
+                                "repository"), path));
+
+      if (kind == svn_node_unknown)
+        SVN_ERR(svn_fs_check_path(&kind, root, path, iterpool));
+
+      if (max_file_size >= 0 && kind == svn_node_file
+          && (change->text_mod
+              || change->change_kind != svn_fs_path_change_modify))
+        {
+          svn_filesize_t length;
+
+          SVN_ERR(svn_fs_file_length(&length, root, path, iterpool));
+          if (length > max_file_size)
+            return pre_commit_check_failure(
+                     apr_psprintf(scratch_pool,
+                                  _("File '%s' is %s bytes long, which "
+                                    "exceeds the limit of %s bytes"),
+                                  path,
+                                  apr_psprintf(scratch_pool,
+                                               "%" SVN_FILESIZE_T_FMT,
+                                               length),
+                                  apr_psprintf(scratch_pool,
+                                               "%" APR_INT64_T_FMT,
+                                               max_file_size)));
+        }
+
+      if (reject_props && change->prop_mod)
+        for (i = 0; i < reject_props->nelts; ++i)
+          {
+            const char *name = APR_ARRAY_IDX(reject_props, i, const char *);
+            svn_string_t *propval;
+
+            SVN_ERR(svn_fs_node_prop(&propval, root, path, name, iterpool));
+            if (propval)
+              return pre_commit_check_failure(
+                       apr_psprintf(scratch_pool,
+                                    _("Property '%s' is not allowed on "
+                                      "'%s'"), name, path));
+          }
+
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t  *
 svn_repos__hooks_pre_commit(svn_repos_t *repos,
                             apr_hash_t *hooks_env,
@@ -550,6 +1060,8 @@ svn_repos__hooks_pre_commit(svn_repos_t *repos,
   const char *hook = svn_repos_pre_commit_hook(repos, pool);
   svn_boolean_t broken_link;
 
+  SVN_ERR(run_pre_commit_checks(repos, hooks_env, txn_name, pool));
+
   if ((hook = check_hook_cmd(hook, &broken_link, pool)) && broken_link)
     {
       return hook_symlink_error(hook);
@@ -603,6 +1115,7 @@ svn_repos__hooks_post_commit(svn_repos_t *repos,
   else if (hook)
     {
       const char *args[5];
+      svn_boolean_t queued;
 
       args[0] = hook;
       args[1] = svn_dirent_local_style(svn_repos_path(repos, pool), pool);
@@ -610,8 +1123,11 @@ svn_repos__hooks_post_commit(svn_repos_t *repos,
       args[3] = txn_name;
       args[4] = NULL;
 
-      SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_COMMIT, hook, args,
-                           hooks_env, NULL, pool));
+      SVN_ERR(queue_async_hook(&queued, SVN_REPOS__HOOK_POST_COMMIT, hook,
+                               args, hooks_env, NULL, pool));
+      if (!queued)
+        SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_COMMIT, hook, args,
+                             hooks_env, NULL, pool));
     }
 
   return SVN_NO_ERROR;
@@ -703,13 +1219,7 @@ svn_repos__hooks_post_revprop_change(svn_repos_t *repos,
       const char *args[7];
       apr_file_t *stdin_handle = NULL;
       char action_string[2];
-
-      /* Pass the old value as stdin to hook */
-      if (old_value)
-        SVN_ERR(create_temp_file(&stdin_handle, old_value, pool));
-      else
-        SVN_ERR(svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
-                                 APR_READ, APR_OS_DEFAULT, pool));
+      svn_boolean_t queued;
 
       action_string[0] = action;
       action_string[1] = '\0';
@@ -722,6 +1232,21 @@ svn_repos__hooks_post_revprop_change(svn_repos_t *repos,
       args[5] = action_string;
       args[6] = NULL;
 
+      /* Pass the old value as stdin to hook */
+      SVN_ERR(queue_async_hook(&queued, SVN_REPOS__HOOK_POST_REVPROP_CHANGE,
+                               hook, args, hooks_env,
+                               old_value ? old_value
+                                         : svn_string_create_empty(pool),
+                               pool));
+      if (queued)
+        return SVN_NO_ERROR;
+
+      if (old_value)
+        SVN_ERR(create_temp_file(&stdin_handle, old_value, pool));
+      else
+        SVN_ERR(svn_io_file_open(&stdin_handle, SVN_NULL_DEVICE_NAME,
+                                 APR_READ, APR_OS_DEFAULT, pool));
+
       SVN_ERR(run_hook_cmd(NULL, SVN_REPOS__HOOK_POST_REVPROP_CHANGE, hook,
                            args, hooks_env, stdin_handle, pool));
 
@@ -23,7 +23,9 @@
 #include <apr_pools.h>
 #include <apr_fnmatch.h>
 
+#include "svn_hash.h"
 #include "svn_pools.h"
+#include "svn_props.h"
 #include "svn_error.h"
 #include "svn_dirent_uri.h"
 #include "svn_time.h"
@@ -37,29 +39,107 @@
 
 
 
+/* Date and author of a revision, as remembered by fill_dirent(). */
+typedef struct committed_info_t
+{
+  const char *date;
+  const char *author;
+} committed_info_t;
+
+/* Set *DATE and *AUTHOR to the respective revision properties of
+ * revision REV in the fs of ROOT.  If COMMITTED_INFO is not NULL, use it to
+ * look them up and remember them: it maps svn_revnum_t to
+ * committed_info_t * allocated in the hash's pool.  Otherwise, allocate the
+ * results in SCRATCH_POOL.
+ */
+static svn_error_t *
+get_committed_info(const char **date,
+                   const char **author,
+                   svn_fs_root_t *root,
+                   svn_revnum_t rev,
+                   apr_hash_t *committed_info,
+                   apr_pool_t *scratch_pool)
+{
+  committed_info_t *info = NULL;
+  apr_pool_t *result_pool = scratch_pool;
+  apr_hash_t *revprops;
+  svn_string_t *value;
+
+  if (committed_info)
+    {
+      info = apr_hash_get(committed_info, &rev, sizeof(rev));
+      if (info)
+        {
+          *date = info->date;
+          *author = info->author;
+          return SVN_NO_ERROR;
+        }
+
+      result_pool = apr_hash_pool_get(committed_info);
+    }
+
+  SVN_ERR(svn_fs_revision_proplist2(&revprops, svn_fs_root_fs(root), rev,
+                                    TRUE, scratch_pool, scratch_pool));
+  value = svn_hash_gets(revprops, SVN_PROP_REVISION_DATE);
+  *date = value ? apr_pstrmemdup(result_pool, value->data, value->len)
+                : NULL;
+  value = svn_hash_gets(revprops, SVN_PROP_REVISION_AUTHOR);
+  *author = value ? apr_pstrmemdup(result_pool, value->data, value->len)
+                  : NULL;
+
+  if (committed_info)
+    {
+      svn_revnum_t *key = apr_pmemdup(result_pool, &rev, sizeof(rev));
+
+      info = apr_palloc(result_pool, sizeof(*info));
+      info->date = *date;
+      info->author = *author;
+      apr_hash_set(committed_info, key, sizeof(*key), info);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Utility function.  Given DIRENT->KIND, set all other elements of *DIRENT
  * with the values retrieved for PATH under ROOT.  Allocate them in POOL.
+ * COMMITTED_INFO is as for get_committed_info().  If INFO is not NULL,
+ * take the node data from there instead of querying ROOT again.
  */
 static svn_error_t *
 fill_dirent(svn_dirent_t *dirent,
             svn_fs_root_t *root,
             const char *path,
+            const svn_fs_dirent_info_t *info,
+            apr_hash_t *committed_info,
             apr_pool_t *scratch_pool)
 {
   const char *datestring;
 
-  if (dirent->kind == svn_node_file)
-    SVN_ERR(svn_fs_file_length(&(dirent->size), root, path, scratch_pool));
+  if (info)
+    {
+      dirent->size = info->size;
+      dirent->has_props = info->has_props;
+      dirent->created_rev = info->created_rev;
+    }
   else
-    dirent->size = SVN_INVALID_FILESIZE;
-
-  SVN_ERR(svn_fs_node_has_props(&dirent->has_props, root, path,
-                                scratch_pool));
+    {
+      if (dirent->kind == svn_node_file)
+        SVN_ERR(svn_fs_file_length(&(dirent->size), root, path,
+                                   scratch_pool));
+      else
+        dirent->size = SVN_INVALID_FILESIZE;
+
+      SVN_ERR(svn_fs_node_has_props(&dirent->has_props, root, path,
+                                    scratch_pool));
+      SVN_ERR(svn_fs_node_created_rev(&dirent->created_rev, root, path,
+                                      scratch_pool));
+    }
 
-  SVN_ERR(svn_repos_get_committed_info(&(dirent->created_rev),
-                                       &datestring,
-                                       &(dirent->last_author),
-                                       root, path, scratch_pool));
+  /* Many entries in a tree share their last commit, so remember what
+   * we read from the revision properties. */
+  SVN_ERR(get_committed_info(&datestring, &dirent->last_author, root,
+                             dirent->created_rev, committed_info,
+                             scratch_pool));
   if (datestring)
     SVN_ERR(svn_time_from_cstring(&(dirent->time), datestring,
                                   scratch_pool));
@@ -87,7 +167,7 @@ svn_repos_stat(svn_dirent_t **dirent,
   ent = svn_dirent_create(pool);
   ent->kind = kind;
 
-  SVN_ERR(fill_dirent(ent, root, path, pool));
+  SVN_ERR(fill_dirent(ent, root, path, NULL, NULL, pool));
 
   *dirent = ent;
   return SVN_NO_ERROR;
@@ -109,8 +189,8 @@ matches_any(const char *dirname,
 /* Utility to prevent code duplication.
  *
  * Construct a svn_dirent_t for PATH of type KIND under ROOT and, if
- * PATH_INFO_ONLY is not set, fill it.  Call RECEIVER with the result
- * and RECEIVER_BATON.
+ * PATH_INFO_ONLY is not set, fill it using INFO and COMMITTED_INFO as in
+ * fill_dirent().  Call RECEIVER with the result and RECEIVER_BATON.
  *
  * Use SCRATCH_POOL for temporary allocations.
  */
@@ -119,6 +199,8 @@ report_dirent(svn_fs_root_t *root,
               const char *path,
               svn_node_kind_t kind,
               svn_boolean_t path_info_only,
+              const svn_fs_dirent_info_t *info,
+              apr_hash_t *committed_info,
               svn_repos_dirent_receiver_t receiver,
               void *receiver_baton,
               apr_pool_t *scratch_pool)
@@ -128,7 +210,8 @@ report_dirent(svn_fs_root_t *root,
   /* Fetch the details to report - if required. */
   dirent.kind = kind;
   if (!path_info_only)
-    SVN_ERR(fill_dirent(&dirent, root, path, scratch_pool));
+    SVN_ERR(fill_dirent(&dirent, root, path, info, committed_info,
+                        scratch_pool));
 
   /* Report the entry. */
   SVN_ERR(receiver(path, &dirent, receiver_baton, scratch_pool));
@@ -163,7 +246,8 @@ compare_filtered_dirent(const void *lhs,
  * However, DEPTH is not svn_depth_empty and PATH has already been reported.
  * Therefore, we can call this recursively.
  *
- * Uses SCRATCH_BUFFER for temporary string contents.
+ * Uses SCRATCH_BUFFER for temporary string contents and COMMITTED_INFO as
+ * for fill_dirent().
  */
 static svn_error_t *
 do_list(svn_fs_root_t *root,
@@ -178,9 +262,11 @@ do_list(svn_fs_root_t *root,
         svn_cancel_func_t cancel_func,
         void *cancel_baton,
         svn_membuf_t *scratch_buffer,
+        apr_hash_t *committed_info,
         apr_pool_t *scratch_pool)
 {
   apr_hash_t *entries;
+  apr_hash_t *infos = NULL;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_hash_index_t *hi;
   apr_array_header_t *sorted;
@@ -219,6 +305,24 @@ do_list(svn_fs_root_t *root,
 
   svn_sort__array(sorted, compare_filtered_dirent);
 
+  /* Without patterns, we need the details of every entry.  Fetch them in
+   * one go, which allows the backend to read them in storage order. */
+  if (!path_info_only && !patterns && sorted->nelts)
+    {
+      apr_array_header_t *info_list;
+
+      SVN_ERR(svn_fs_dir_entries_info(&info_list, root, path, FALSE, FALSE,
+                                      svn_checksum_md5, scratch_pool,
+                                      iterpool));
+      infos = apr_hash_make(scratch_pool);
+      for (i = 0; i < info_list->nelts; ++i)
+        {
+          svn_fs_dirent_info_t *info
+            = APR_ARRAY_IDX(info_list, i, svn_fs_dirent_info_t *);
+          svn_hash_sets(infos, info->name, info);
+        }
+    }
+
   /* Iterate over all remaining directory entries and report them.
    * Recurse into sub-directories if requested. */
   for (i = 0; i < sorted->nelts; ++i)
@@ -246,7 +350,10 @@ do_list(svn_fs_root_t *root,
       /* Report entry, if it passed the filter. */
       if (filtered->is_match)
         SVN_ERR(report_dirent(root, sub_path, dirent->kind, path_info_only,
-                              receiver, receiver_baton, iterpool));
+                              infos ? svn_hash_gets(infos, dirent->name)
+                                    : NULL,
+                              committed_info, receiver, receiver_baton,
+                              iterpool));
 
       /* Check for cancellation before recursing down.  This should be
        * slightly more responsive for deep trees. */
@@ -258,7 +365,8 @@ do_list(svn_fs_root_t *root,
         SVN_ERR(do_list(root, sub_path, patterns, svn_depth_infinity,
                         path_info_only, authz_read_func, authz_read_baton,
                         receiver, receiver_baton, cancel_func,
-                        cancel_baton, scratch_buffer, iterpool));
+                        cancel_baton, scratch_buffer, committed_info,
+                        iterpool));
     }
 
   svn_pool_destroy(iterpool);
@@ -281,6 +389,9 @@ svn_repos_list(svn_fs_root_t *root,
                apr_pool_t *scratch_pool)
 {
   svn_membuf_t scratch_buffer;
+  apr_hash_t *committed_info = path_info_only
+                             ? NULL
+                             : apr_hash_make(scratch_pool);
 
   /* Parameter check. */
   svn_node_kind_t kind;
@@ -326,15 +437,16 @@ svn_repos_list(svn_fs_root_t *root,
   /* Actually report PATH, if it passes the filters. */
   if (matches_any(svn_dirent_basename(path, scratch_pool), patterns,
                   &scratch_buffer))
-    SVN_ERR(report_dirent(root, path, kind, path_info_only,
-                          receiver, receiver_baton, scratch_pool));
+    SVN_ERR(report_dirent(root, path, kind, path_info_only, NULL,
+                          committed_info, receiver, receiver_baton,
+                          scratch_pool));
 
   /* Report directory contents if requested. */
   if (depth > svn_depth_empty)
     SVN_ERR(do_list(root, path, patterns, depth,
                     path_info_only, authz_read_func, authz_read_baton,
                     receiver, receiver_baton, cancel_func, cancel_baton,
-                    &scratch_buffer, scratch_pool));
+                    &scratch_buffer, committed_info, scratch_pool));
 
   return SVN_NO_ERROR;
 }
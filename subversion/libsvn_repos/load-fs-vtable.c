@@ -40,6 +40,7 @@
 
 #include "private/svn_fspath.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_io_private.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_repos_private.h"
 
@@ -1270,6 +1271,36 @@ svn_repos_get_fs_build_parser6(const svn_repos_parse_fns3_t **callbacks,
   return SVN_NO_ERROR;
 }
 
+/* Like svn_repos_parse_dumpstream3() with DELTAS_ARE_TEXT set to FALSE.
+   If READ_AHEAD is set and DUMPSTREAM reads from a file, read that file
+   on a separate thread ahead of the parser, so that reading the input
+   overlaps with building and committing the revisions read so far.
+
+   Callers that ignore most of the node contents should not set
+   READ_AHEAD, as the parser would otherwise seek past them. */
+static svn_error_t *
+parse_dumpstream(svn_stream_t *dumpstream,
+                 svn_boolean_t read_ahead,
+                 const svn_repos_parse_fns3_t *parser,
+                 void *parse_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *pool)
+{
+  apr_file_t *file = read_ahead ? svn_stream__aprfile(dumpstream) : NULL;
+  svn_error_t *err;
+
+  if (file)
+    SVN_ERR(svn_stream__create_read_ahead(&dumpstream, file, pool));
+
+  err = svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
+                                    cancel_func, cancel_baton, pool);
+
+  if (file)
+    err = svn_error_compose_create(err, svn_stream_close(dumpstream));
+
+  return svn_error_trace(err);
+}
 
 svn_error_t *
 svn_repos_load_fs6(svn_repos_t *repos,
@@ -1309,8 +1340,11 @@ svn_repos_load_fs6(svn_repos_t *repos,
                                          notify_baton,
                                          pool));
 
-  return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
-                                     cancel_func, cancel_baton, pool);
+  /* Revisions outside the requested range will be skipped. */
+  return svn_error_trace(parse_dumpstream(dumpstream,
+                                          !SVN_IS_VALID_REVNUM(start_rev),
+                                          parser, parse_baton,
+                                          cancel_func, cancel_baton, pool));
 }
 
 /*----------------------------------------------------------------------*/
@@ -1532,6 +1566,9 @@ svn_repos_load_fs_revprops(svn_repos_t *repos,
                                notify_baton,
                                scratch_pool));
 
-  return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
-                                     cancel_func, cancel_baton, scratch_pool);
+  /* All node contents will be skipped. */
+  return svn_error_trace(parse_dumpstream(dumpstream, FALSE,
+                                          parser, parse_baton,
+                                          cancel_func, cancel_baton,
+                                          scratch_pool));
 }
@@ -283,6 +283,40 @@ parse_property_block(svn_stream_t *stream,
 }
 
 
+/* Skip the next LENGTH bytes of STREAM, using BUFFER as scratch space.
+   Streams that support it seek past the data instead of reading it,
+   which makes e.g. loading a revision range from a large dumpfile much
+   cheaper.  A seek does not detect truncated input, so the last byte is
+   always read to make sure that the content is complete. */
+static svn_error_t *
+skip_content(svn_stream_t *stream,
+             svn_filesize_t length,
+             char *buffer)
+{
+  apr_size_t len;
+
+  if (length == 0)
+    return SVN_NO_ERROR;
+
+  while (length > 1)
+    {
+      if ((apr_uint64_t)(length - 1) > APR_SIZE_MAX)
+        len = APR_SIZE_MAX;
+      else
+        len = (apr_size_t) (length - 1);
+
+      SVN_ERR(svn_stream_skip(stream, len));
+      length -= len;
+    }
+
+  len = 1;
+  SVN_ERR(svn_stream_read_full(stream, buffer, &len));
+  if (len != 1)
+    return stream_ran_dry();
+
+  return SVN_NO_ERROR;
+}
+
 /* Read CONTENT_LENGTH bytes from STREAM. If IS_DELTA is true, use
    PARSE_FNS->apply_textdelta to push a text delta, otherwise use
    PARSE_FNS->set_fulltext to push those bytes as replace fulltext for
@@ -317,8 +351,10 @@ parse_text_block(svn_stream_t *stream,
       SVN_ERR(parse_fns->set_fulltext(&text_stream, record_baton));
     }
 
-  /* Regardless of whether or not we have a sink for our data, we
-     need to read it. */
+  /* Without a sink for our data, we only need to get past it. */
+  if (!text_stream)
+    return svn_error_trace(skip_content(stream, content_length, buffer));
+
   while (content_length)
     {
       if (content_length >= (svn_filesize_t)buflen)
@@ -332,23 +368,19 @@ parse_text_block(svn_stream_t *stream,
       if (rlen != num_to_read)
         return stream_ran_dry();
 
-      if (text_stream)
+      /* write however many bytes you read. */
+      wlen = rlen;
+      SVN_ERR(svn_stream_write(text_stream, buffer, &wlen));
+      if (wlen != rlen)
         {
-          /* write however many bytes you read. */
-          wlen = rlen;
-          SVN_ERR(svn_stream_write(text_stream, buffer, &wlen));
-          if (wlen != rlen)
-            {
-              /* Uh oh, didn't write as many bytes as we read. */
-              return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
-                                      _("Unexpected EOF writing contents"));
-            }
+          /* Uh oh, didn't write as many bytes as we read. */
+          return svn_error_create(SVN_ERR_STREAM_UNEXPECTED_EOF, NULL,
+                                  _("Unexpected EOF writing contents"));
         }
     }
 
-  /* If we opened a stream, we must close it. */
-  if (text_stream)
-    SVN_ERR(svn_stream_close(text_stream));
+  /* We opened a stream, so we must close it. */
+  SVN_ERR(svn_stream_close(text_stream));
 
   return SVN_NO_ERROR;
 }
@@ -783,7 +815,6 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
       */
       if (content_length && ! old_v1_with_cl)
         {
-          apr_size_t rlen, num_to_read;
           svn_filesize_t remaining =
             svn__atoui64(content_length) -
             (prop_cl ? svn__atoui64(prop_cl) : 0) -
@@ -796,19 +827,7 @@ svn_repos_parse_dumpstream3(svn_stream_t *stream,
                                       "total block content length"));
 
           /* Consume remaining bytes in this content block */
-          while (remaining > 0)
-            {
-              if (remaining >= (svn_filesize_t)buflen)
-                rlen = buflen;
-              else
-                rlen = (apr_size_t) remaining;
-
-              num_to_read = rlen;
-              SVN_ERR(svn_stream_read_full(stream, buffer, &rlen));
-              remaining -= rlen;
-              if (rlen != num_to_read)
-                return stream_ran_dry();
-            }
+          SVN_ERR(skip_content(stream, remaining, buffer));
         }
 
       /* If we just finished processing a node record, we need to
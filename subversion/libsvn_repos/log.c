@@ -41,6 +41,7 @@
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_mergeinfo_private.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_sorts_private.h"
 #include "private/svn_string_private.h"
@@ -56,6 +57,13 @@ typedef struct log_callbacks_t
   void *revision_receiver_baton;
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
+
+  /* Optional recursive variant of AUTHZ_READ_FUNC, called with the same
+     baton.  See svn_repos__get_logs(). */
+  svn_repos_authz_callback_t authz_subtree_func;
+
+  /* The repository's svn_repos_t.change_scopes.  May be NULL. */
+  svn_cache__t *change_scopes;
 } log_callbacks_t;
 
 
@@ -221,6 +229,28 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
 }
 
 
+/* Shorten SCOPE to the longest common ancestor of SCOPE and PATH.
+ * Both must be canonical fspaths.
+ */
+static void
+narrow_change_scope(svn_stringbuf_t *scope,
+                    const char *path)
+{
+  apr_size_t common = 0;
+  apr_size_t i;
+
+  for (i = 0; i < scope->len && path[i] == scope->data[i]; ++i)
+    if (scope->data[i] == '/')
+      common = i;
+
+  /* Already an ancestor of PATH or PATH itself? */
+  if (i == scope->len && (path[i] == '\0' || path[i] == '/'))
+    return;
+
+  /* Keep at least the root. */
+  svn_stringbuf_chop(scope, scope->len - MAX(common, 1));
+}
+
 /* Find all significant changes under ROOT and, if not NULL, report them
  * to the CALLBACKS->PATH_CHANGE_RECEIVER.  "Significant" means that the
  * text or properties of the node were changed, or that the node was added
@@ -243,22 +273,53 @@ svn_repos_check_revision_access(svn_repos_revision_access_level_t *access_level,
  *     *ACCESS_LEVEL to svn_repos_revision_access_none.  (This is
  *     to distinguish a revision which truly has no changed paths
  *     from a revision in which all paths are unreadable.)
+ *
+ * If ITERATOR is not NULL, it lists the changes in ROOT and will be used
+ * instead of fetching them from ROOT.
  */
 static svn_error_t *
 detect_changed(svn_repos_revision_access_level_t *access_level,
                svn_fs_root_t *root,
                svn_fs_t *fs,
+               svn_fs_path_change_iterator_t *iterator,
                const log_callbacks_t *callbacks,
                apr_pool_t *scratch_pool)
 {
-  svn_fs_path_change_iterator_t *iterator;
   svn_fs_path_change3_t *change;
   apr_pool_t *iterpool;
   svn_boolean_t found_readable = FALSE;
   svn_boolean_t found_unreadable = FALSE;
+  svn_boolean_t all_readable = FALSE;
+  svn_revnum_t revision = svn_fs_revision_root_revision(root);
+  svn_stringbuf_t *scope = NULL;
+  svn_stringbuf_t *new_scope = NULL;
+
+  /* If we already know which sub-tree this revision's changes are in,
+     a single check may tell us that all of them are readable. */
+  if (   callbacks->authz_read_func
+      && callbacks->authz_subtree_func
+      && callbacks->change_scopes)
+    {
+      svn_boolean_t found;
+
+      SVN_ERR(svn_cache__get((void **)&scope, &found,
+                             callbacks->change_scopes, &revision,
+                             scratch_pool));
+      if (scope)
+        SVN_ERR(callbacks->authz_subtree_func(svn_authz_read
+                                                | svn_authz_recursive,
+                                              &all_readable, root,
+                                              scope->data,
+                                              callbacks->authz_read_baton,
+                                              scratch_pool));
+      else
+        new_scope = svn_stringbuf_create_empty(scratch_pool);
+    }
 
   /* Retrieve the first change in the list. */
-  SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
+  if (!iterator)
+    SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool,
+                                  scratch_pool));
   SVN_ERR(svn_fs_path_change_get(&change, iterator));
 
   if (!change)
@@ -278,8 +339,14 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
       const char *path = change->path.data;
       svn_pool_clear(iterpool);
 
+      /* Remember the scope for the next time. */
+      if (new_scope && new_scope->len)
+        narrow_change_scope(new_scope, path);
+      else if (new_scope)
+        svn_stringbuf_set(new_scope, path);
+
       /* Skip path if unreadable. */
-      if (callbacks->authz_read_func)
+      if (callbacks->authz_read_func && !all_readable)
         {
           svn_boolean_t readable;
           SVN_ERR(callbacks->authz_read_func(&readable, root, path,
@@ -389,6 +456,10 @@ detect_changed(svn_repos_revision_access_level_t *access_level,
 
   svn_pool_destroy(iterpool);
 
+  if (new_scope && new_scope->len)
+    SVN_ERR(svn_cache__set(callbacks->change_scopes, &revision, new_scope,
+                           scratch_pool));
+
   if (! found_readable)
     {
       /* Every changed-path was unreadable. */
@@ -1095,12 +1166,14 @@ get_combined_mergeinfo_changes(svn_mergeinfo_t *added_mergeinfo,
 }
 
 
-/* Fill LOG_ENTRY with history information in FS at REV. */
+/* Fill LOG_ENTRY with history information in FS at REV.
+   If CHANGES is not NULL, it lists the changed paths in REV. */
 static svn_error_t *
 fill_log_entry(svn_repos_log_entry_t *log_entry,
                svn_revnum_t rev,
                svn_fs_t *fs,
                const apr_array_header_t *revprops,
+               svn_fs_path_change_iterator_t *changes,
                const log_callbacks_t *callbacks,
                apr_pool_t *pool)
 {
@@ -1117,7 +1190,8 @@ fill_log_entry(svn_repos_log_entry_t *log_entry,
       svn_repos_revision_access_level_t access_level;
 
       SVN_ERR(svn_fs_revision_root(&newroot, fs, rev, pool));
-      SVN_ERR(detect_changed(&access_level, newroot, fs, callbacks, pool));
+      SVN_ERR(detect_changed(&access_level, newroot, fs, changes, callbacks,
+                             pool));
 
       if (access_level == svn_repos_revision_access_none)
         {
@@ -1301,7 +1375,10 @@ interesting_merge(void *baton,
    If HANDLING_MERGED_REVISIONS is FALSE then ignore NESTED_MERGES.  Otherwise
    if NESTED_MERGES is not NULL and REV is contained in it, then don't send
    the log for REV, otherwise send it normally and add REV to
-   NESTED_MERGES. */
+   NESTED_MERGES.
+
+   If CHANGES is not NULL, it lists the changed paths in REV and will be
+   used instead of fetching them from FS. */
 static svn_error_t *
 send_log(svn_revnum_t rev,
          svn_fs_t *fs,
@@ -1311,6 +1388,7 @@ send_log(svn_revnum_t rev,
          svn_boolean_t handling_merged_revision,
          const apr_array_header_t *revprops,
          svn_boolean_t has_children,
+         svn_fs_path_change_iterator_t *changes,
          const log_callbacks_t *callbacks,
          apr_pool_t *pool)
 {
@@ -1343,7 +1421,8 @@ send_log(svn_revnum_t rev,
       baton.found_rev_of_interest = TRUE;
     }
 
-  SVN_ERR(fill_log_entry(&log_entry, rev, fs, revprops, callbacks, pool));
+  SVN_ERR(fill_log_entry(&log_entry, rev, fs, revprops, changes, callbacks,
+                         pool));
   log_entry.has_children = has_children;
   log_entry.subtractive_merge = subtractive_merge;
 
@@ -1381,6 +1460,34 @@ send_log(svn_revnum_t rev,
   return SVN_NO_ERROR;
 }
 
+/* Baton type for send_log_with_changes(). */
+typedef struct send_logs_baton_t
+{
+  /* The repository's filesystem. */
+  svn_fs_t *fs;
+
+  /* Revision properties to send, as per send_log(). */
+  const apr_array_header_t *revprops;
+
+  /* The callbacks to invoke. */
+  const log_callbacks_t *callbacks;
+} send_logs_baton_t;
+
+/* Implements svn_fs_changes_receiver_t.  Send the log for REVISION with
+   the changed paths listed by ITERATOR.  BATON is a send_logs_baton_t. */
+static svn_error_t *
+send_log_with_changes(void *baton,
+                      svn_revnum_t revision,
+                      svn_fs_path_change_iterator_t *iterator,
+                      apr_pool_t *scratch_pool)
+{
+  send_logs_baton_t *b = baton;
+
+  return svn_error_trace(send_log(revision, b->fs, NULL, NULL,
+                                  FALSE, FALSE, b->revprops, FALSE,
+                                  iterator, b->callbacks, scratch_pool));
+}
+
 /* This controls how many history objects we keep open.  For any targets
    over this number we have to open and close their histories as needed,
    which is CPU intensive, but keeps us from using an unbounded amount of
@@ -1389,12 +1496,16 @@ send_log(svn_revnum_t rev,
 
 /* Get the histories for PATHS, and store them in *HISTORIES.
 
+   Start each history at HIST_END, or, if PATH_REVS is not NULL, at the
+   svn_revnum_t in PATH_REVS with the same index as the path.
+
    If IGNORE_MISSING_LOCATIONS is set, don't treat requests for bogus
    repository locations as fatal -- just ignore them.  */
 static svn_error_t *
 get_path_histories(apr_array_header_t **histories,
                    svn_fs_t *fs,
                    const apr_array_header_t *paths,
+                   const apr_array_header_t *path_revs,
                    svn_revnum_t hist_start,
                    svn_revnum_t hist_end,
                    svn_boolean_t strict_node_history,
@@ -1425,10 +1536,18 @@ get_path_histories(apr_array_header_t **histories,
   for (i = 0; i < paths->nelts; i++)
     {
       const char *this_path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_revnum_t this_rev = hist_end;
       struct path_info *info = apr_palloc(pool,
                                           sizeof(struct path_info));
       svn_pool_clear(iterpool);
 
+      if (path_revs)
+        {
+          this_rev = APR_ARRAY_IDX(path_revs, i, svn_revnum_t);
+          if (svn_fs_revision_root_revision(root) != this_rev)
+            SVN_ERR(svn_fs_revision_root(&root, fs, this_rev, pool));
+        }
+
       if (authz_read_func)
         {
           svn_boolean_t readable;
@@ -1440,7 +1559,7 @@ get_path_histories(apr_array_header_t **histories,
 
       info->path = svn_stringbuf_create(this_path, pool);
       info->done = FALSE;
-      info->history_rev = hist_end;
+      info->history_rev = this_rev;
       info->first_time = TRUE;
 
       if (i < MAX_OPEN_HISTORIES)
@@ -2012,7 +2131,8 @@ do_logs(svn_fs_t *fs,
      about all the revisions in the range -- only the ones in which
      one of our paths was changed.  So let's go figure out which
      revisions contain real changes to at least one of our paths.  */
-  SVN_ERR(get_path_histories(&histories, fs, paths, hist_start, hist_end,
+  SVN_ERR(get_path_histories(&histories, fs, paths, NULL,
+                             hist_start, hist_end,
                              strict_node_history, ignore_missing_locations,
                              callbacks->authz_read_func,
                              callbacks->authz_read_baton, pool));
@@ -2090,7 +2210,8 @@ do_logs(svn_fs_t *fs,
               SVN_ERR(send_log(current, fs,
                                log_target_history_as_mergeinfo, nested_merges,
                                subtractive_merge, handling_merged_revisions,
-                               revprops, has_children, callbacks, iterpool));
+                               revprops, has_children, NULL, callbacks,
+                               iterpool));
 
               if (has_children) /* Implies include_merged_revisions == TRUE */
                 {
@@ -2189,7 +2310,8 @@ do_logs(svn_fs_t *fs,
           SVN_ERR(send_log(current, fs,
                            log_target_history_as_mergeinfo, nested_merges,
                            subtractive_merge, handling_merged_revisions,
-                           revprops, has_children, callbacks, iterpool));
+                           revprops, has_children, NULL, callbacks,
+                           iterpool));
           if (has_children)
             {
               if (!nested_merges)
@@ -2257,6 +2379,9 @@ get_paths_history_as_mergeinfo(svn_mergeinfo_t *paths_history_mergeinfo,
 {
   int i;
   svn_mergeinfo_t path_history_mergeinfo;
+  svn_mergeinfo__flat_t *history;
+  apr_pool_t *history_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *next_history_pool = svn_pool_create(scratch_pool);
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
   SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(start_rev));
@@ -2272,12 +2397,17 @@ get_paths_history_as_mergeinfo(svn_mergeinfo_t *paths_history_mergeinfo,
       end_rev = tmp_rev;
     }
 
-  *paths_history_mergeinfo = svn_hash__make(result_pool);
+  /* Accumulate the history in flat form, which turns each step into a
+     linear merge.  The accumulated result alternates between two pools. */
+  SVN_ERR(svn_mergeinfo__flat_from_mergeinfo(&history, NULL, history_pool,
+                                             scratch_pool));
 
   for (i = 0; i < paths->nelts; i++)
     {
       const char *this_path = APR_ARRAY_IDX(paths, i, const char *);
       struct location_segment_baton loc_seg_baton;
+      svn_mergeinfo__flat_t *path_history;
+      apr_pool_t *tmp_pool;
 
       svn_pool_clear(iterpool);
       loc_seg_baton.pool = scratch_pool;
@@ -2292,17 +2422,51 @@ get_paths_history_as_mergeinfo(svn_mergeinfo_t *paths_history_mergeinfo,
                                                authz_read_baton,
                                                iterpool));
 
+      /* The flat representation references the paths of this mergeinfo,
+         so it must live as long as HISTORY. */
       SVN_ERR(svn_mergeinfo__mergeinfo_from_segments(
-        &path_history_mergeinfo, loc_seg_baton.history_segments, iterpool));
-      SVN_ERR(svn_mergeinfo_merge2(*paths_history_mergeinfo,
-                                   svn_mergeinfo_dup(path_history_mergeinfo,
-                                                     result_pool),
-                                   result_pool, iterpool));
+        &path_history_mergeinfo, loc_seg_baton.history_segments,
+        scratch_pool));
+      SVN_ERR(svn_mergeinfo__flat_from_mergeinfo(&path_history,
+                                                 path_history_mergeinfo,
+                                                 iterpool, iterpool));
+
+      svn_pool_clear(next_history_pool);
+      SVN_ERR(svn_mergeinfo__flat_merge(&history, history, path_history,
+                                        next_history_pool));
+
+      tmp_pool = history_pool;
+      history_pool = next_history_pool;
+      next_history_pool = tmp_pool;
     }
+
+  SVN_ERR(svn_mergeinfo__flat_to_mergeinfo(paths_history_mergeinfo, history,
+                                           result_pool));
+
   svn_pool_destroy(iterpool);
+  svn_pool_destroy(history_pool);
+  svn_pool_destroy(next_history_pool);
   return SVN_NO_ERROR;
 }
 
+/* Return a copy of REVPROPS, an array of const char * revprop names, as
+   an array of svn_string_t *, allocated in RESULT_POOL. */
+static apr_array_header_t *
+revprop_names_as_strings(const apr_array_header_t *revprops,
+                         apr_pool_t *result_pool)
+{
+  int i;
+  apr_array_header_t *new_revprops
+    = apr_array_make(result_pool, revprops->nelts, sizeof(svn_string_t *));
+
+  for (i = 0; i < revprops->nelts; ++i)
+    APR_ARRAY_PUSH(new_revprops, svn_string_t *)
+      = svn_string_create(APR_ARRAY_IDX(revprops, i, const char *),
+                          result_pool);
+
+  return new_revprops;
+}
+
 svn_error_t *
 svn_repos_get_logs5(svn_repos_t *repos,
                     const apr_array_header_t *paths,
@@ -2319,6 +2483,36 @@ svn_repos_get_logs5(svn_repos_t *repos,
                     svn_repos_log_entry_receiver_t revision_receiver,
                     void *revision_receiver_baton,
                     apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(svn_repos__get_logs(repos, paths, start, end, limit,
+                                             strict_node_history,
+                                             include_merged_revisions,
+                                             revprops, authz_read_func, NULL,
+                                             authz_read_baton,
+                                             path_change_receiver,
+                                             path_change_receiver_baton,
+                                             revision_receiver,
+                                             revision_receiver_baton,
+                                             scratch_pool));
+}
+
+svn_error_t *
+svn_repos__get_logs(svn_repos_t *repos,
+                    const apr_array_header_t *paths,
+                    svn_revnum_t start,
+                    svn_revnum_t end,
+                    int limit,
+                    svn_boolean_t strict_node_history,
+                    svn_boolean_t include_merged_revisions,
+                    const apr_array_header_t *revprops,
+                    svn_repos_authz_func_t authz_read_func,
+                    svn_repos_authz_callback_t authz_subtree_func,
+                    void *authz_read_baton,
+                    svn_repos_path_change_receiver_t path_change_receiver,
+                    void *path_change_receiver_baton,
+                    svn_repos_log_entry_receiver_t revision_receiver,
+                    void *revision_receiver_baton,
+                    apr_pool_t *scratch_pool)
 {
   svn_revnum_t head = SVN_INVALID_REVNUM;
   svn_fs_t *fs = repos->fs;
@@ -2332,21 +2526,11 @@ svn_repos_get_logs5(svn_repos_t *repos,
   callbacks.revision_receiver_baton = revision_receiver_baton;
   callbacks.authz_read_func = authz_read_func;
   callbacks.authz_read_baton = authz_read_baton;
+  callbacks.authz_subtree_func = authz_subtree_func;
+  callbacks.change_scopes = repos->change_scopes;
 
   if (revprops)
-    {
-      int i;
-      apr_array_header_t *new_revprops
-        = apr_array_make(scratch_pool, revprops->nelts,
-                         sizeof(svn_string_t *));
-
-      for (i = 0; i < revprops->nelts; ++i)
-        APR_ARRAY_PUSH(new_revprops, svn_string_t *)
-          = svn_string_create(APR_ARRAY_IDX(revprops, i, const char *),
-                              scratch_pool);
-
-      revprops = new_revprops;
-    }
+    revprops = revprop_names_as_strings(revprops, scratch_pool);
 
   /* Make sure we catch up on the latest revprop changes.  This is the only
    * time we will refresh the revprop data in this query. */
@@ -2424,19 +2608,42 @@ svn_repos_get_logs5(svn_repos_t *repos,
       send_count = end - start + 1;
       if (limit > 0 && send_count > limit)
         send_count = limit;
-      for (i = 0; i < send_count; ++i)
+
+      /* If we need the changed paths, let the FS read them for the whole
+         range at once.  Many back-ends can do that much more efficiently
+         than opening one revision root after another. */
+      if (callbacks.authz_read_func || callbacks.path_change_receiver)
+        {
+          send_logs_baton_t baton;
+          svn_revnum_t last = descending_order
+                            ? end - (svn_revnum_t)send_count + 1
+                            : start + (svn_revnum_t)send_count - 1;
+
+          baton.fs = fs;
+          baton.revprops = revprops;
+          baton.callbacks = &callbacks;
+
+          SVN_ERR(svn_fs_paths_changed_range(fs,
+                                             descending_order ? end : start,
+                                             last, send_log_with_changes,
+                                             &baton, NULL, NULL, iterpool));
+        }
+      else
         {
-          svn_revnum_t rev;
+          for (i = 0; i < send_count; ++i)
+            {
+              svn_revnum_t rev;
 
-          svn_pool_clear(iterpool);
+              svn_pool_clear(iterpool);
 
-          if (descending_order)
-            rev = end - i;
-          else
-            rev = start + i;
-          SVN_ERR(send_log(rev, fs, NULL, NULL,
-                           FALSE, FALSE, revprops, FALSE,
-                           &callbacks, iterpool));
+              if (descending_order)
+                rev = end - i;
+              else
+                rev = start + i;
+              SVN_ERR(send_log(rev, fs, NULL, NULL,
+                               FALSE, FALSE, revprops, FALSE, NULL,
+                               &callbacks, iterpool));
+            }
         }
       svn_pool_destroy(iterpool);
 
@@ -2465,3 +2672,222 @@ svn_repos_get_logs5(svn_repos_t *repos,
                  include_merged_revisions, FALSE, FALSE, FALSE,
                  revprops, descending_order, &callbacks, scratch_pool);
 }
+
+/* Parse CURSOR, as produced by make_log_cursor(), into *PATHS and the
+   matching *PATH_REVS.  Return an error if it is malformed or refers to
+   revisions younger than HEAD. */
+static svn_error_t *
+parse_log_cursor(apr_array_header_t **paths,
+                 apr_array_header_t **path_revs,
+                 const char *cursor,
+                 svn_revnum_t head,
+                 apr_pool_t *pool)
+{
+  apr_array_header_t *lines = svn_cstring_split(cursor, "\n", FALSE, pool);
+  int i;
+
+  *paths = apr_array_make(pool, lines->nelts, sizeof(const char *));
+  *path_revs = apr_array_make(pool, lines->nelts, sizeof(svn_revnum_t));
+
+  for (i = 0; i < lines->nelts; i++)
+    {
+      const char *line = APR_ARRAY_IDX(lines, i, const char *);
+      const char *path;
+      svn_revnum_t rev;
+      svn_error_t *err;
+
+      if (!*line)
+        continue;
+
+      err = svn_revnum_parse(&rev, line, &path);
+      if (err
+          || *path != ' '
+          || rev > head
+          || !svn_fspath__is_canonical(path + 1))
+        return svn_error_createf(SVN_ERR_INCORRECT_PARAMS, err,
+                                 _("Invalid log cursor '%s'"), cursor);
+
+      APR_ARRAY_PUSH(*paths, const char *) = path + 1;
+      APR_ARRAY_PUSH(*path_revs, svn_revnum_t) = rev;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a cursor, allocated in RESULT_POOL, that records where the walk
+   through HISTORIES stopped, or NULL if all of them are done.  The cursor
+   has one "REV PATH" line per pending history. */
+static const char *
+make_log_cursor(const apr_array_header_t *histories,
+                apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *cursor = NULL;
+  int i;
+
+  for (i = 0; i < histories->nelts; i++)
+    {
+      struct path_info *info = APR_ARRAY_IDX(histories, i,
+                                             struct path_info *);
+      if (info->done)
+        continue;
+
+      if (!cursor)
+        cursor = svn_stringbuf_create_empty(result_pool);
+
+      svn_stringbuf_appendcstr(cursor,
+                               apr_psprintf(result_pool, "%ld %s\n",
+                                            info->history_rev,
+                                            info->path->data));
+    }
+
+  return cursor ? cursor->data : NULL;
+}
+
+svn_error_t *
+svn_repos_get_logs_page(const char **next_cursor,
+                        svn_repos_t *repos,
+                        const apr_array_header_t *paths,
+                        svn_revnum_t start,
+                        svn_revnum_t end,
+                        int limit,
+                        const char *cursor,
+                        svn_boolean_t strict_node_history,
+                        const apr_array_header_t *revprops,
+                        svn_repos_authz_func_t authz_read_func,
+                        void *authz_read_baton,
+                        svn_repos_path_change_receiver_t path_change_receiver,
+                        void *path_change_receiver_baton,
+                        svn_repos_log_entry_receiver_t revision_receiver,
+                        void *revision_receiver_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  svn_revnum_t head;
+  svn_fs_t *fs = repos->fs;
+  apr_array_header_t *path_revs = NULL;
+  apr_array_header_t *histories;
+  svn_boolean_t any_histories_left = TRUE;
+  log_callbacks_t callbacks;
+  apr_pool_t *iterpool, *iterpool2;
+  svn_revnum_t current;
+  int send_count = 0;
+  int i;
+
+  *next_cursor = NULL;
+
+  SVN_ERR_ASSERT(limit > 0);
+
+  callbacks.path_change_receiver = path_change_receiver;
+  callbacks.path_change_receiver_baton = path_change_receiver_baton;
+  callbacks.revision_receiver = revision_receiver;
+  callbacks.revision_receiver_baton = revision_receiver_baton;
+  callbacks.authz_read_func = authz_read_func;
+  callbacks.authz_read_baton = authz_read_baton;
+  callbacks.authz_subtree_func = NULL;
+  callbacks.change_scopes = NULL;
+
+  SVN_ERR(svn_fs_refresh_revision_props(fs, scratch_pool));
+  SVN_ERR(svn_fs_youngest_rev(&head, fs, scratch_pool));
+
+  if (! SVN_IS_VALID_REVNUM(start))
+    start = head;
+
+  if (! SVN_IS_VALID_REVNUM(end))
+    end = head;
+
+  if (start > head)
+    return svn_error_createf
+      (SVN_ERR_FS_NO_SUCH_REVISION, 0,
+       _("No such revision %ld"), start);
+  if (end > head)
+    return svn_error_createf
+      (SVN_ERR_FS_NO_SUCH_REVISION, 0,
+       _("No such revision %ld"), end);
+  if (start < end)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            _("Log pages must be fetched in descending "
+                              "revision order"));
+
+  if (cursor)
+    SVN_ERR(parse_log_cursor(&paths, &path_revs, cursor, head,
+                             scratch_pool));
+  else if (! paths || ! paths->nelts)
+    {
+      paths = apr_array_make(scratch_pool, 1, sizeof(const char *));
+      APR_ARRAY_PUSH(paths, const char *) = "/";
+    }
+
+  if (! paths->nelts)
+    return SVN_NO_ERROR;
+
+  /* The root changes in every revision, so its pages need no history
+     walk; the cursor only has to remember where to continue. */
+  if (paths->nelts == 1
+      && (svn_path_is_empty(APR_ARRAY_IDX(paths, 0, const char *))
+          || strcmp(APR_ARRAY_IDX(paths, 0, const char *), "/") == 0))
+    {
+      if (path_revs)
+        start = APR_ARRAY_IDX(path_revs, 0, svn_revnum_t);
+      if (start < end)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(svn_repos_get_logs5(repos, paths, start, end, limit,
+                                  strict_node_history, FALSE, revprops,
+                                  authz_read_func, authz_read_baton,
+                                  path_change_receiver,
+                                  path_change_receiver_baton,
+                                  revision_receiver, revision_receiver_baton,
+                                  scratch_pool));
+
+      if (start - limit >= end)
+        *next_cursor = apr_psprintf(result_pool, "%ld /\n", start - limit);
+
+      return SVN_NO_ERROR;
+    }
+
+  if (revprops)
+    revprops = revprop_names_as_strings(revprops, scratch_pool);
+
+  SVN_ERR(get_path_histories(&histories, fs, paths, path_revs, end, start,
+                             strict_node_history, FALSE,
+                             authz_read_func, authz_read_baton,
+                             scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  iterpool2 = svn_pool_create(scratch_pool);
+  for (current = next_history_rev(histories);
+       any_histories_left && send_count < limit;
+       current = next_history_rev(histories))
+    {
+      svn_boolean_t changed = FALSE;
+      any_histories_left = FALSE;
+      svn_pool_clear(iterpool);
+
+      for (i = 0; i < histories->nelts; i++)
+        {
+          struct path_info *info = APR_ARRAY_IDX(histories, i,
+                                                 struct path_info *);
+
+          svn_pool_clear(iterpool2);
+          SVN_ERR(check_history(&changed, info, fs, current,
+                                strict_node_history,
+                                authz_read_func, authz_read_baton,
+                                end, scratch_pool, iterpool2));
+          if (! info->done)
+            any_histories_left = TRUE;
+        }
+
+      if (changed)
+        {
+          SVN_ERR(send_log(current, fs, NULL, NULL, FALSE, FALSE,
+                           revprops, FALSE, NULL, &callbacks, iterpool));
+          ++send_count;
+        }
+    }
+  svn_pool_destroy(iterpool2);
+  svn_pool_destroy(iterpool);
+
+  *next_cursor = make_log_cursor(histories, result_pool);
+
+  return SVN_NO_ERROR;
+}
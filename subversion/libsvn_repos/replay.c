@@ -863,8 +863,10 @@ get_relevant_changes(apr_hash_t **changed_paths,
   svn_fs_path_change3_t *change;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
-  /* Fetch the paths changed under ROOT. */
-  SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool, scratch_pool));
+  /* Fetch the paths changed under ROOT.  Let the backend skip what is
+     neither below BASE_RELPATH nor one of its parents. */
+  SVN_ERR(svn_fs_paths_changed_below(&iterator, root, base_relpath, TRUE,
+                                     scratch_pool, scratch_pool));
   SVN_ERR(svn_fs_path_change_get(&change, iterator));
 
   /* Make an array from the keys of our CHANGED_PATHS hash, and copy
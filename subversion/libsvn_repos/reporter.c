@@ -21,6 +21,7 @@
  * ====================================================================
  */
 
+#include "svn_cache_config.h"
 #include "svn_dirent_uri.h"
 #include "svn_hash.h"
 #include "svn_path.h"
@@ -38,6 +39,7 @@
 #include "private/svn_fspath.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
+#include "private/svn_thread_pool.h"
 
 #define NUM_CACHED_SOURCE_ROOTS 4
 
@@ -100,6 +102,10 @@ typedef struct revision_info_t
   svn_string_t* author;        /* name of the revisions' author */
 } revision_info_t;
 
+/* Worker threads computing file deltas ahead of the editor drive.
+   See start_prefetch(). */
+typedef struct prefetch_t prefetch_t;
+
 /* A structure used by the routines within the `reporter' vtable,
    driven by the client as it describes its working copy revisions. */
 typedef struct report_baton_t
@@ -143,6 +149,12 @@ typedef struct report_baton_t
 
   /* This will not change. So, fetch it once and reuse it. */
   svn_string_t *repos_uuid;
+
+  /* Delta prefetching, NULL if not active.  PREFETCH_TRIED will be set
+     once we attempted to start it. */
+  prefetch_t *prefetch;
+  svn_boolean_t prefetch_tried;
+
   apr_pool_t *pool;
 } report_baton_t;
 
@@ -661,6 +673,350 @@ send_zero_copy_delta(const unsigned char *contents,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* Number of worker threads computing file deltas for a report. */
+#define PREFETCH_WORKERS 4
+
+/* Maximum number of file deltas being computed or waiting to be sent
+   at any time. */
+#define PREFETCH_SLOTS 16
+
+/* Don't prefetch within directories with fewer modified files than this;
+   it would not be worth the worker setup. */
+#define PREFETCH_MIN_FILES 4
+
+/* Files larger than this are not prefetched, so the memory held by the
+   precomputed deltas stays bounded. */
+#define PREFETCH_MAX_FILE_SIZE (512 * 1024)
+
+/* The delta between S_PATH@S_REV and T_PATH in the target revision,
+ * computed by some worker of a prefetch_t.
+ */
+typedef struct prefetch_job_t
+{
+  /* The prefetching that this job belongs to. */
+  prefetch_t *prefetch;
+
+  svn_revnum_t s_rev;
+  const char *s_path;
+  const char *t_path;
+
+  /* The delta windows (svn_txdelta_window_t *) in the order produced by
+     the delta stream, without the final NULL window.  NULL if the delta
+     has not been computed, e.g. because the file is too large. */
+  apr_array_header_t *windows;
+
+  /* The job submitted to the thread pool.  NULL if this slot is free. */
+  svn_thread_pool__job_t *job;
+
+  /* Owned by whichever thread currently processes this job. */
+  apr_pool_t *pool;
+} prefetch_job_t;
+
+/* State of the delta prefetching of a report.  Only used by the main
+ * thread.
+ */
+struct prefetch_t
+{
+  /* The report's repository and target revision. */
+  svn_fs_t *fs;
+  svn_revnum_t t_rev;
+
+  /* PREFETCH_SLOTS jobs. */
+  prefetch_job_t jobs[PREFETCH_SLOTS];
+
+  /* Maps the T_PATH of all jobs that have been scheduled but not yet
+     been released to their job. */
+  apr_hash_t *pending;
+
+  /* The workers computing the deltas. */
+  svn_thread_pool__t *thread_pool;
+};
+
+/* State of a single prefetch worker. */
+typedef struct prefetch_worker_baton_t
+{
+  /* FS instance exclusively used by this worker and its target root,
+     the latter being opened on demand. */
+  svn_fs_t *fs;
+  svn_fs_root_t *t_root;
+
+  /* Pool that FS has been allocated in. */
+  apr_pool_t *pool;
+} prefetch_worker_baton_t;
+
+/* Implements svn_thread_pool__worker_init_t.  Open a private FS instance
+ * for the repository of the prefetch_t given as BATON.
+ */
+static svn_error_t *
+open_prefetch_fs(void **worker_baton,
+                 void *baton,
+                 int worker_index,
+                 apr_pool_t *worker_pool)
+{
+  prefetch_t *prefetch = baton;
+  prefetch_worker_baton_t *result = apr_pcalloc(worker_pool,
+                                                sizeof(*result));
+
+  result->pool = worker_pool;
+  SVN_ERR(svn_fs_open2(&result->fs, svn_fs_path(prefetch->fs, worker_pool),
+                       svn_fs_config(prefetch->fs, worker_pool),
+                       worker_pool, worker_pool));
+
+  *worker_baton = result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Compute the delta described by
+ * the prefetch_job_t in JOB_BATON using the FS instance in WORKER_BATON
+ * and store its windows in that job.  Leave its WINDOWS untouched if the
+ * target file is too large.
+ */
+static svn_error_t *
+compute_prefetch_job(void *job_baton,
+                     void *worker_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool)
+{
+  prefetch_job_t *job = job_baton;
+  prefetch_worker_baton_t *baton = worker_baton;
+  svn_fs_root_t *s_root;
+  svn_filesize_t length;
+  svn_txdelta_stream_t *dstream;
+  apr_array_header_t *windows;
+  apr_pool_t *iterpool;
+
+  if (!baton->t_root)
+    SVN_ERR(svn_fs_revision_root(&baton->t_root, baton->fs,
+                                 job->prefetch->t_rev, baton->pool));
+
+  SVN_ERR(svn_fs_file_length(&length, baton->t_root, job->t_path,
+                             scratch_pool));
+  if (length > PREFETCH_MAX_FILE_SIZE)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_revision_root(&s_root, baton->fs, job->s_rev,
+                               scratch_pool));
+  SVN_ERR(svn_fs_get_file_delta_stream(&dstream, s_root, job->s_path,
+                                       baton->t_root, job->t_path,
+                                       scratch_pool));
+
+  windows = apr_array_make(job->pool, 1, sizeof(svn_txdelta_window_t *));
+  iterpool = svn_pool_create(scratch_pool);
+  while (TRUE)
+    {
+      svn_txdelta_window_t *window;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(svn_txdelta_next_window(&window, dstream, iterpool));
+      if (!window)
+        break;
+
+      APR_ARRAY_PUSH(windows, svn_txdelta_window_t *)
+        = svn_txdelta_window_dup(window, job->pool);
+    }
+  svn_pool_destroy(iterpool);
+
+  job->windows = windows;
+
+  return SVN_NO_ERROR;
+}
+
+/* Start the delta prefetching for report B, unless it would not be safe
+ * for this repository or process.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+start_prefetch(report_baton_t *b,
+               apr_pool_t *scratch_pool)
+{
+  svn_fs_t *fs = b->repos->fs;
+  const char *fs_type;
+  prefetch_t *prefetch;
+  int i;
+
+  b->prefetch_tried = TRUE;
+
+  /* The workers share the FS caches, which must be thread-safe for that.
+     BDB does not support multiple FS instances per process and thread. */
+  if (svn_cache_config2_get()->single_threaded)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_type(&fs_type, svn_fs_path(fs, scratch_pool),
+                      scratch_pool));
+  if (strcmp(fs_type, SVN_FS_TYPE_BDB) == 0)
+    return SVN_NO_ERROR;
+
+  prefetch = apr_pcalloc(b->pool, sizeof(*prefetch));
+  prefetch->fs = fs;
+  prefetch->t_rev = b->t_rev;
+  prefetch->pending = apr_hash_make(b->pool);
+  for (i = 0; i < PREFETCH_SLOTS; ++i)
+    {
+      prefetch->jobs[i].prefetch = prefetch;
+      prefetch->jobs[i].pool = svn_thread_pool__create_root_pool(b->pool);
+    }
+
+  /* The workers get aborted before the job pools get destroyed. */
+  SVN_ERR(svn_thread_pool__create(&prefetch->thread_pool, PREFETCH_WORKERS,
+                                  open_prefetch_fs, prefetch, b->pool));
+
+  b->prefetch = prefetch;
+
+  return SVN_NO_ERROR;
+}
+
+/* Schedule the computation of the delta between S_PATH@S_REV and T_PATH
+ * in PREFETCH.  Set *SCHEDULED to FALSE if all slots are in use or the
+ * workers could not be started.
+ */
+static svn_error_t *
+schedule_prefetch(svn_boolean_t *scheduled,
+                  prefetch_t *prefetch,
+                  svn_revnum_t s_rev,
+                  const char *s_path,
+                  const char *t_path)
+{
+  prefetch_job_t *job = NULL;
+  svn_error_t *err;
+  int i;
+
+  /* Links in the report may make the same path show up twice. */
+  if (svn_hash_gets(prefetch->pending, t_path))
+    {
+      *scheduled = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  for (i = 0; i < PREFETCH_SLOTS && !job; ++i)
+    if (!prefetch->jobs[i].job)
+      job = &prefetch->jobs[i];
+
+  *scheduled = FALSE;
+  if (!job)
+    return SVN_NO_ERROR;
+
+  job->s_rev = s_rev;
+  job->s_path = apr_pstrdup(job->pool, s_path);
+  job->t_path = apr_pstrdup(job->pool, t_path);
+
+  /* Failing to prefetch is not fatal; we'll compute the delta ourselves
+     in that case. */
+  err = svn_thread_pool__submit(&job->job, prefetch->thread_pool,
+                                compute_prefetch_job, job);
+  if (err)
+    {
+      svn_error_clear(err);
+      job->job = NULL;
+      svn_pool_clear(job->pool);
+      return SVN_NO_ERROR;
+    }
+
+  svn_hash_sets(prefetch->pending, job->t_path, job);
+  *scheduled = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Wait for PREFETCH to finish JOB and make its slot available for
+ * scheduling again.  If CANCEL is set, tell the workers that we are not
+ * interested in the result.  Return the error that the computation
+ * returned.
+ */
+static svn_error_t *
+wait_for_prefetch(prefetch_t *prefetch,
+                  prefetch_job_t *job,
+                  svn_boolean_t cancel)
+{
+  svn_error_t *err;
+
+  if (cancel)
+    SVN_ERR(svn_thread_pool__cancel_job(prefetch->thread_pool, job->job));
+
+  err = svn_thread_pool__wait(prefetch->thread_pool, job->job, NULL, NULL);
+  job->job = NULL;
+
+  return svn_error_trace(err);
+}
+
+/* Make the finished JOB in PREFETCH available for scheduling again. */
+static void
+release_prefetch(prefetch_t *prefetch,
+                 prefetch_job_t *job)
+{
+  svn_hash_sets(prefetch->pending, job->t_path, NULL);
+
+  job->windows = NULL;
+  svn_pool_clear(job->pool);
+}
+
+/* Drop the job for T_PATH from PREFETCH, if there is one. */
+static svn_error_t *
+discard_prefetch(prefetch_t *prefetch,
+                 const char *t_path)
+{
+  prefetch_job_t *job = svn_hash_gets(prefetch->pending, t_path);
+  if (!job)
+    return SVN_NO_ERROR;
+
+  svn_error_clear(wait_for_prefetch(prefetch, job, TRUE));
+  release_prefetch(prefetch, job);
+
+  return SVN_NO_ERROR;
+}
+
+/* If B has prefetched the delta between S_PATH@S_REV and T_PATH, send it
+ * to DHANDLER / DBATON and set *SENT.  Otherwise, set *SENT to FALSE and
+ * leave it to the caller to compute the delta.
+ */
+static svn_error_t *
+send_prefetched_delta(svn_boolean_t *sent,
+                      report_baton_t *b,
+                      svn_revnum_t s_rev,
+                      const char *s_path,
+                      const char *t_path,
+                      svn_txdelta_window_handler_t dhandler,
+                      void *dbaton)
+{
+  prefetch_job_t *job = svn_hash_gets(b->prefetch->pending, t_path);
+  svn_error_t *job_err;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  *sent = FALSE;
+  if (!job)
+    return SVN_NO_ERROR;
+
+  if (job->s_rev != s_rev || strcmp(job->s_path, s_path) != 0)
+    return svn_error_trace(discard_prefetch(b->prefetch, t_path));
+
+  job_err = wait_for_prefetch(b->prefetch, job, FALSE);
+
+  /* Failed or skipped jobs will simply be redone by the caller, which
+     also takes care of reporting any errors. */
+  if (!job_err && job->windows)
+    {
+      for (i = 0; i < job->windows->nelts && !err; ++i)
+        err = dhandler(APR_ARRAY_IDX(job->windows, i, svn_txdelta_window_t *),
+                       dbaton);
+      if (!err)
+        err = dhandler(NULL, dbaton);
+
+      *sent = TRUE;
+    }
+
+  svn_error_clear(job_err);
+  release_prefetch(b->prefetch, job);
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
 
 /* Make the appropriate edits on FILE_BATON to change its contents and
    properties from those in S_REV/S_PATH to those in B->t_root/T_PATH,
@@ -732,6 +1088,18 @@ delta_files(report_baton_t *b, void *file_baton, svn_revnum_t s_rev,
                 return SVN_NO_ERROR;
             }
 
+#if APR_HAS_THREADS
+          if (b->prefetch && s_path)
+            {
+              svn_boolean_t sent;
+
+              SVN_ERR(send_prefetched_delta(&sent, b, s_rev, s_path, t_path,
+                                            dhandler, dbaton));
+              if (sent)
+                return SVN_NO_ERROR;
+            }
+#endif
+
           SVN_ERR(svn_fs_get_file_delta_stream(&dstream, s_root, s_path,
                                                b->t_root, t_path, pool));
           SVN_ERR(svn_txdelta_send_txstream(dstream, dhandler, dbaton, pool));
@@ -1099,6 +1467,137 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
 #define DEPTH_BELOW_HERE(depth) ((depth) == svn_depth_immediates) ? \
                                  svn_depth_empty : (depth)
 
+#if APR_HAS_THREADS
+
+/* A file whose delta delta_dirs() will likely send. */
+typedef struct prefetch_candidate_t
+{
+  const char *s_path;
+  const char *t_path;
+} prefetch_candidate_t;
+
+/* Return in *CANDIDATES the files among T_ORDERED_ENTRIES that the
+   target loop of delta_dirs() will send as modifications of the same
+   file in S_ENTRIES, in the order they will be sent.  S_REV, S_PATH,
+   T_PATH, WC_DEPTH and REQUESTED_DEPTH are as in delta_dirs().  Start
+   the prefetching in B if there are enough candidates to make it
+   worthwhile.  Set *CANDIDATES to NULL if B does not prefetch.
+
+   Whether the contents actually differ will only be checked when the
+   delta is needed; computing it in vain merely wastes some cycles. */
+static svn_error_t *
+get_prefetch_candidates(apr_array_header_t **candidates,
+                        report_baton_t *b,
+                        const char *s_path,
+                        const char *t_path,
+                        apr_hash_t *s_entries,
+                        apr_array_header_t *t_ordered_entries,
+                        svn_depth_t wc_depth,
+                        svn_depth_t requested_depth,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *result;
+  int i;
+
+  *candidates = NULL;
+  if (!b->text_deltas || !s_entries || (b->prefetch_tried && !b->prefetch))
+    return SVN_NO_ERROR;
+
+  /* Mirror the checks of the target loop in delta_dirs(). */
+  if (   is_depth_upgrade(wc_depth, requested_depth, svn_node_file)
+      || (requested_depth == svn_depth_unknown && wc_depth < svn_depth_files))
+    return SVN_NO_ERROR;
+
+  result = apr_array_make(result_pool, 0, sizeof(prefetch_candidate_t));
+  for (i = 0; i < t_ordered_entries->nelts; ++i)
+    {
+      const svn_fs_dirent_t *t_entry
+         = APR_ARRAY_IDX(t_ordered_entries, i, svn_fs_dirent_t *);
+      const svn_fs_dirent_t *s_entry;
+      prefetch_candidate_t *candidate;
+      int distance;
+
+      if (t_entry->kind != svn_node_file)
+        continue;
+
+      s_entry = svn_hash_gets(s_entries, t_entry->name);
+      if (!s_entry || s_entry->kind != svn_node_file)
+        continue;
+
+      /* Unchanged and replaced files get no delta against S_ENTRY. */
+      distance = svn_fs_compare_ids(s_entry->id, t_entry->id);
+      if (distance == 0 || (distance == -1 && !b->ignore_ancestry))
+        continue;
+
+      candidate = apr_array_push(result);
+      candidate->s_path = svn_fspath__join(s_path, t_entry->name,
+                                           result_pool);
+      candidate->t_path = svn_fspath__join(t_path, t_entry->name,
+                                           result_pool);
+    }
+
+  if (result->nelts < PREFETCH_MIN_FILES)
+    return SVN_NO_ERROR;
+
+  if (!b->prefetch_tried)
+    {
+      /* Failing to prefetch is not fatal; we'll compute the deltas
+         ourselves in that case. */
+      svn_error_clear(start_prefetch(b, scratch_pool));
+      if (!b->prefetch)
+        return SVN_NO_ERROR;
+    }
+
+  *candidates = result;
+
+  return SVN_NO_ERROR;
+}
+
+/* Schedule prefetching the deltas for the CANDIDATES of directory S_REV,
+   starting at *NEXT, for as long as B has free job slots left.  Update
+   *NEXT to the first candidate that has not been scheduled. */
+static svn_error_t *
+schedule_prefetches(report_baton_t *b,
+                    svn_revnum_t s_rev,
+                    apr_array_header_t *candidates,
+                    int *next)
+{
+  svn_boolean_t scheduled = TRUE;
+
+  while (*next < candidates->nelts && scheduled)
+    {
+      const prefetch_candidate_t *candidate
+        = &APR_ARRAY_IDX(candidates, *next, prefetch_candidate_t);
+
+      SVN_ERR(schedule_prefetch(&scheduled, b->prefetch, s_rev,
+                                candidate->s_path, candidate->t_path));
+      if (scheduled)
+        ++*next;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Drop any of the first COUNT CANDIDATES whose deltas B prefetched but
+   did not send. */
+static svn_error_t *
+discard_prefetches(report_baton_t *b,
+                   apr_array_header_t *candidates,
+                   int count)
+{
+  int i;
+
+  for (i = 0; i < count; ++i)
+    SVN_ERR(discard_prefetch(b->prefetch,
+                             APR_ARRAY_IDX(candidates, i,
+                                           prefetch_candidate_t).t_path));
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
 /* Emit edits within directory DIR_BATON (with corresponding path
    E_PATH) with the changes from the directory S_REV/S_PATH to the
    directory B->t_rev/T_PATH.  S_PATH may be NULL if the entry does
@@ -1164,6 +1663,10 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
   apr_hash_index_t *hi;
   apr_pool_t *subpool = svn_pool_create(pool);
   apr_array_header_t *t_ordered_entries = NULL;
+#if APR_HAS_THREADS
+  apr_array_header_t *prefetch_candidates = NULL;
+  int prefetch_next = 0;
+#endif
   int i;
 
   /* Compare the property lists.  If we're starting empty, pass a NULL
@@ -1304,6 +1807,16 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
       /* Loop over the dirents in the target. */
       SVN_ERR(svn_fs_dir_optimal_order(&t_ordered_entries, b->t_root,
                                        t_entries, subpool, iterpool));
+
+#if APR_HAS_THREADS
+      /* Let the workers compute the file deltas ahead of us.  They will
+         be sent in the same order as without prefetching. */
+      SVN_ERR(get_prefetch_candidates(&prefetch_candidates, b, s_path,
+                                      t_path, s_entries, t_ordered_entries,
+                                      wc_depth, requested_depth,
+                                      subpool, iterpool));
+#endif
+
       for (i = 0; i < t_ordered_entries->nelts; ++i)
         {
           const svn_fs_dirent_t *t_entry
@@ -1343,6 +1856,12 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
           e_fullpath = svn_relpath_join(e_path, t_entry->name, iterpool);
           t_fullpath = svn_fspath__join(t_path, t_entry->name, iterpool);
 
+#if APR_HAS_THREADS
+          if (prefetch_candidates)
+            SVN_ERR(schedule_prefetches(b, s_rev, prefetch_candidates,
+                                        &prefetch_next));
+#endif
+
           SVN_ERR(update_entry(b, s_rev, s_fullpath, s_entry, t_fullpath,
                                t_entry, dir_baton, e_fullpath, NULL,
                                DEPTH_BELOW_HERE(wc_depth),
@@ -1350,6 +1869,11 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                                iterpool));
         }
 
+#if APR_HAS_THREADS
+      if (prefetch_candidates)
+        SVN_ERR(discard_prefetches(b, prefetch_candidates, prefetch_next));
+#endif
+
       /* iterpool is destroyed by destroying its parent (subpool) below */
     }
 
@@ -1402,6 +1926,15 @@ drive(report_baton_t *b, svn_revnum_t s_rev, path_info_t *info,
     return svn_error_create(SVN_ERR_FS_PATH_SYNTAX, NULL,
                             _("Cannot replace a directory from within"));
 
+  /* A fresh checkout or export will send the whole target tree.  Let the
+     FS read it in storage order up-front instead of path by path. */
+  if (info->start_empty && !b->lookahead && t_entry
+      && t_entry->kind == svn_node_dir
+      && (b->requested_depth == svn_depth_infinity
+          || (b->requested_depth == svn_depth_unknown
+              && info->depth == svn_depth_infinity)))
+    SVN_ERR(svn_fs_prefetch_tree(b->t_root, b->t_path, NULL, NULL, pool));
+
   SVN_ERR(b->editor->set_target_revision(b->edit_baton, b->t_rev, pool));
   SVN_ERR(b->editor->open_root(b->edit_baton, s_rev, pool, &root_baton));
 
@@ -1634,6 +2167,8 @@ svn_repos_begin_report3(void **report_baton,
                                           1000000 /* maxsize */,
                                           pool);
   b->repos_uuid = svn_string_create(uuid, pool);
+  b->prefetch = NULL;
+  b->prefetch_tried = FALSE;
 
   /* Hand reporter back to client. */
   *report_baton = b;
@@ -979,7 +979,37 @@ create_conf(svn_repos_t *repos, apr_pool_t *pool)
 ""                                                                           NL
 "### This sets the PATH environment variable for the pre-commit hook."       NL
 "[pre-commit]"                                                               NL
-"PATH = /usr/local/bin:/usr/bin:/usr/sbin"                                   NL;
+"PATH = /usr/local/bin:/usr/bin:/usr/sbin"                                   NL
+""                                                                           NL
+"### The [async-hooks] section does not define environment variables."      NL
+"### Instead, it lets the post-commit and post-revprop-change hooks run"     NL
+"### in the background, so that clients don't wait for them to finish."     NL
+"### Background hooks run one at a time, in the order in which they were"    NL
+"### triggered, within the server process.  Hooks still queued when the"    NL
+"### process terminates normally get run before it exits.  A failed hook"   NL
+"### is run again up to 'retries' times; its failure is not reported to"    NL
+"### the client.  [New in 1.15]"                                             NL
+"# [async-hooks]"                                                            NL
+"# post-commit = yes"                                                        NL
+"# post-revprop-change = yes"                                                NL
+"# retries = 2"                                                              NL
+""                                                                           NL
+"### The [pre-commit-checks] section does not define environment variables"  NL
+"### either.  It configures common commit checks that run inside the"        NL
+"### server process before the pre-commit hook, without starting a program" NL
+"### that has to open the repository again:"                                NL
+"###   max-file-size        Largest size in bytes of a file that gets"       NL
+"###                        added or changed."                               NL
+"###   reject-paths         Whitespace or comma separated list of patterns"  NL
+"###                        like '*.exe' or '/trunk/tmp/*'; paths matching"  NL
+"###                        any of them can't be added or changed."          NL
+"###   reject-properties    List of node properties that can't be set."     NL
+"###   require-log-message  Whether commits need a non-empty log message."   NL
+"### [New in 1.15]"                                                          NL
+"# [pre-commit-checks]"                                                      NL
+"# max-file-size = 104857600"                                                NL
+"# reject-paths = *.exe *.dll"                                               NL
+"# require-log-message = yes"                                                NL;
 
     SVN_ERR_W(svn_io_file_create(svn_dirent_join(repos->conf_path,
                                                  SVN_REPOS__CONF_HOOKS_ENV \
@@ -1308,8 +1338,22 @@ get_repos(svn_repos_t **repos_p,
 
   /* Open up the filesystem only after obtaining the lock. */
   if (open_fs)
-    SVN_ERR(svn_fs_open2(&repos->fs, repos->db_path, fs_config,
-                         result_pool, scratch_pool));
+    {
+      SVN_ERR(svn_fs_open2(&repos->fs, repos->db_path, fs_config,
+                           result_pool, scratch_pool));
+
+      /* Revisions never change, so the cache needs no invalidation.
+         It may be shared by threads using the same repository object. */
+      SVN_ERR(svn_cache__create_inprocess(&repos->change_scopes,
+                                          NULL, NULL,
+                                          sizeof(svn_revnum_t),
+                                          16, 1024, TRUE,
+                                          apr_pstrcat(scratch_pool,
+                                                      "change-scopes:",
+                                                      repos->path,
+                                                      SVN_VA_NULL),
+                                          result_pool));
+    }
 
 #ifdef SVN_DEBUG_CRASH_AT_REPOS_OPEN
   /* If $PATH/config/debug-abort exists, crash the server here.
@@ -29,6 +29,8 @@
 #include "svn_fs.h"
 #include "svn_config.h"
 
+#include "private/svn_cache.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -92,6 +94,12 @@ extern "C" {
 #define SVN_REPOS__CONF_HOOKS_ENV "hooks-env"
 /* The name of the default section in the hooks-env config file. */
 #define SVN_REPOS__HOOKS_ENV_DEFAULT_SECTION "default"
+/* The name of the section in the hooks-env config file that selects the
+ * hooks to run in the background. */
+#define SVN_REPOS__HOOKS_ENV_ASYNC_SECTION "async-hooks"
+/* The name of the section in the hooks-env config file that configures
+ * the checks to run in-process before the pre-commit hook. */
+#define SVN_REPOS__HOOKS_ENV_PRE_COMMIT_CHECKS_SECTION "pre-commit-checks"
 
 /* The configuration file for svnserve, in the repository conf directory. */
 #define SVN_REPOS__CONF_SVNSERVE_CONF "svnserve.conf"
@@ -153,6 +161,12 @@ struct svn_repos_t
      those constants' addresses, therefore). */
   apr_hash_t *repository_capabilities;
 
+  /* Maps revision numbers (svn_revnum_t) to the longest common ancestor
+     of all paths changed in that revision (svn_stringbuf_t *).  Used to
+     check whole revisions at once during authz-filtered log operations.
+     May be NULL. */
+  svn_cache__t *change_scopes;
+
   /* Pool from which this structure was allocated.  Also used for
      auxiliary repository-related data that requires a matching
      lifespan.  (As the svn_repos_t structure tends to be relatively
@@ -0,0 +1,154 @@
+/*
+ * repos_pool.c :  pool of repository objects
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+
+
+#include <apr_strings.h>
+
+#include "svn_dirent_uri.h"
+#include "svn_fs.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_repos.h"
+
+#include "private/svn_repos_private.h"
+
+#include "svn_private_config.h"
+
+#include "repos.h"
+
+
+/* Return a string allocated in POOL that identifies the current
+ * incarnation of the file at PATH, or "-" if it does not exist.
+ */
+static svn_error_t *
+file_identity(const char **identity,
+              const char *path,
+              apr_pool_t *pool)
+{
+  apr_finfo_t finfo;
+  svn_error_t *err = svn_io_stat(&finfo, path,
+                                 APR_FINFO_INODE | APR_FINFO_MTIME, pool);
+
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *identity = "-";
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  *identity = apr_psprintf(pool, "%" APR_UINT64_T_FMT ":%" APR_TIME_T_FMT,
+                           (apr_uint64_t)finfo.inode, finfo.mtime);
+  return SVN_NO_ERROR;
+}
+
+/* Return a memory buffer structure allocated in POOL that identifies the
+ * repository at PATH.  Besides the path, the key contains the identity
+ * of the repository's format file and of the filesystem's UUID file, so
+ * that a repository that has been replaced, upgraded or got a new UUID
+ * gets a different key.  All of these files are being replaced, not
+ * modified in-place, in these cases.
+ */
+static svn_error_t *
+repos_key(svn_membuf_t **key,
+          const char *path,
+          apr_pool_t *pool)
+{
+  svn_membuf_t *result = apr_pcalloc(pool, sizeof(*result));
+  const char *format_id, *uuid_id;
+  const char *key_str;
+  apr_size_t size;
+
+  SVN_ERR(file_identity(&format_id,
+                        svn_dirent_join(path, SVN_REPOS__FORMAT, pool),
+                        pool));
+  SVN_ERR(file_identity(&uuid_id,
+                        svn_dirent_join_many(pool, path, SVN_REPOS__DB_DIR,
+                                             "uuid", SVN_VA_NULL),
+                        pool));
+  key_str = apr_pstrcat(pool, format_id, " ", uuid_id, " ", path,
+                        SVN_VA_NULL);
+
+  size = strlen(key_str);
+  svn_membuf__create(result, size, pool);
+  result->size = size; /* exact length is required! */
+  memcpy(result->data, key_str, size);
+
+  *key = result;
+  return SVN_NO_ERROR;
+}
+
+/* API implementation */
+
+svn_error_t *
+svn_repos__repos_pool_create(svn_repos__repos_pool_t **repos_pool,
+                             svn_boolean_t thread_safe,
+                             apr_pool_t *pool)
+{
+  return svn_error_trace(svn_object_pool__create_exclusive(repos_pool,
+                                                           thread_safe,
+                                                           pool));
+}
+
+svn_error_t *
+svn_repos__repos_pool_get(svn_repos_t **repos_p,
+                          svn_repos__repos_pool_t *repos_pool,
+                          const char *path,
+                          apr_hash_t *fs_config,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_membuf_t *key;
+  svn_repos_t *repos;
+
+  SVN_ERR(repos_key(&key, path, scratch_pool));
+  SVN_ERR(svn_object_pool__lookup((void **)&repos, repos_pool, key,
+                                  result_pool));
+
+  if (repos)
+    {
+      /* Don't let the previous user's lock tokens leak to the next one. */
+      SVN_ERR(svn_fs_set_access(svn_repos_fs(repos), NULL));
+    }
+  else
+    {
+      /* The instance lives in its own pool, so it survives RESULT_POOL. */
+      apr_pool_t *repos_item_pool
+        = svn_object_pool__new_item_pool(repos_pool);
+      svn_error_t *err = svn_repos_open3(&repos, path, fs_config,
+                                         repos_item_pool, scratch_pool);
+      if (err)
+        {
+          svn_pool_destroy(repos_item_pool);
+          return svn_error_trace(err);
+        }
+
+      SVN_ERR(svn_object_pool__insert((void **)&repos, repos_pool, key,
+                                      repos, repos_item_pool, result_pool));
+    }
+
+  *repos_p = repos;
+  return SVN_NO_ERROR;
+}
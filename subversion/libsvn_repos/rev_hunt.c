@@ -36,7 +36,9 @@
 #include "svn_sorts.h"
 #include "svn_props.h"
 #include "svn_mergeinfo.h"
+#include "svn_diff.h"
 #include "repos.h"
+#include "private/svn_diff_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
@@ -757,31 +759,26 @@ svn_repos_trace_node_locations(svn_fs_t *fs,
 
   /* There are no copies relevant to path@revision.  So any remaining
      revisions either predate the creation of path@revision or have
-     the node existing at the same path.  We will look up path@lrev
-     for each remaining location-revision and make sure it is related
-     to path@revision. */
-  SVN_ERR(svn_fs_revision_root(&root, fs, revision, lastpool));
-  while (revision_ptr < revision_ptr_end)
+     the node existing at the same path.  Without a copy, the node got
+     added at PATH and stayed there ever since, so a single lookup of
+     its origin revision tells us which of the remaining location-
+     revisions it existed in.  The back-ends answer that from their
+     node-origins index instead of visiting every revision. */
+  if (revision_ptr < revision_ptr_end)
     {
-      svn_node_kind_t kind;
-      svn_fs_node_relation_t node_relation;
-      svn_fs_root_t *cur_rev_root;
+      svn_revnum_t origin_rev;
 
-      svn_pool_clear(currpool);
-      SVN_ERR(svn_fs_revision_root(&cur_rev_root, fs, *revision_ptr,
-                                   currpool));
-      SVN_ERR(svn_fs_check_path(&kind, cur_rev_root, path, currpool));
-      if (kind == svn_node_none)
-        break;
-      SVN_ERR(svn_fs_node_relation(&node_relation, root, path,
-                                   cur_rev_root, path, currpool));
-      if (node_relation == svn_fs_node_unrelated)
-        break;
+      SVN_ERR(svn_fs_revision_root(&root, fs, revision, lastpool));
+      SVN_ERR(svn_fs_node_origin_rev(&origin_rev, root, path, lastpool));
 
-      /* The node exists at the same path; record that and advance. */
-      apr_hash_set(*locations, revision_ptr, sizeof(*revision_ptr),
-                   apr_pstrdup(pool, path));
-      revision_ptr++;
+      while ((revision_ptr < revision_ptr_end)
+             && (*revision_ptr >= origin_rev))
+        {
+          /* The node exists at the same path; record that and advance. */
+          apr_hash_set(*locations, revision_ptr, sizeof(*revision_ptr),
+                       apr_pstrdup(pool, path));
+          revision_ptr++;
+        }
     }
 
   /* Ignore any remaining location-revisions; they predate the
@@ -1745,3 +1742,241 @@ svn_repos_get_file_revs2(svn_repos_t *repos,
 
   return SVN_NO_ERROR;
 }
+
+
+/* The state of svn_repos_blame() while it walks the file's revisions. */
+struct blame_baton
+{
+  svn_repos_t *repos;
+  svn_revnum_t start;
+
+  /* The revision each line of LAST_FILE was last changed in, an array of
+     svn_revnum_t. */
+  apr_array_header_t *lines;
+
+  /* The revision properties of the revisions in LINES.
+     svn_revnum_t -> apr_hash_t * */
+  apr_hash_t *rev_props;
+
+  /* Diffs each text against the previous one. */
+  svn_diff__file_chain_t *diffs;
+
+  /* The text of the previous interesting revision, or an empty file. */
+  const char *last_file;
+
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  apr_pool_t *pool;       /* lives during the whole operation */
+  apr_pool_t *last_pool;  /* holds LAST_FILE */
+  apr_pool_t *curr_pool;  /* holds the file of the current revision */
+};
+
+/* The baton for blame_output_modified(). */
+struct blame_diff_baton
+{
+  apr_array_header_t *lines;
+  svn_revnum_t revision;
+};
+
+/* Implements svn_diff_output_fns_t.output_diff_modified.  Replace the
+   revisions of the ORIGINAL_LENGTH lines that were changed into the
+   MODIFIED_LENGTH lines at MODIFIED_START with the revision in BATON. */
+static svn_error_t *
+blame_output_modified(void *baton,
+                      apr_off_t original_start,
+                      apr_off_t original_length,
+                      apr_off_t modified_start,
+                      apr_off_t modified_length,
+                      apr_off_t latest_start,
+                      apr_off_t latest_length)
+{
+  struct blame_diff_baton *db = baton;
+  apr_array_header_t *lines = db->lines;
+  int tail = lines->nelts - (int)(modified_start + original_length);
+  svn_revnum_t *revs;
+  int i;
+
+  /* Hunks arrive in order, so LINES already is in modified coordinates up
+     to MODIFIED_START and in original ones after it. */
+  for (i = (int)original_length; i < modified_length; i++)
+    APR_ARRAY_PUSH(lines, svn_revnum_t) = SVN_INVALID_REVNUM;
+
+  revs = (svn_revnum_t *)lines->elts;
+  memmove(revs + modified_start + modified_length,
+          revs + modified_start + original_length,
+          tail * sizeof(*revs));
+  lines->nelts = (int)(modified_start + modified_length) + tail;
+
+  for (i = 0; i < modified_length; i++)
+    revs[modified_start + i] = db->revision;
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_output_fns_t blame_output_fns =
+{
+  NULL,
+  blame_output_modified
+};
+
+/* Implements svn_file_rev_handler_t.  Update the blame of BATON, a
+   struct blame_baton, for the text of PATH in REVNUM. */
+static svn_error_t *
+blame_file_rev_handler(void *baton,
+                       const char *path,
+                       svn_revnum_t revnum,
+                       apr_hash_t *rev_props,
+                       svn_boolean_t result_of_merge,
+                       svn_txdelta_window_handler_t *delta_handler,
+                       void **delta_baton,
+                       apr_array_header_t *prop_diffs,
+                       apr_pool_t *pool)
+{
+  struct blame_baton *bb = baton;
+  struct blame_diff_baton db;
+  svn_fs_root_t *root;
+  svn_stream_t *contents;
+  svn_stream_t *file;
+  const char *filename;
+  svn_diff_t *diff;
+  apr_pool_t *tmp_pool;
+
+  if (bb->cancel_func)
+    SVN_ERR(bb->cancel_func(bb->cancel_baton));
+
+  /* Property changes don't change the blame. */
+  if (!delta_handler)
+    return SVN_NO_ERROR;
+
+  /* We read the whole text from the revision instead, which is cheaper
+     than applying a delta to the previous one. */
+  *delta_handler = svn_delta_noop_window_handler;
+  *delta_baton = NULL;
+
+  svn_pool_clear(bb->curr_pool);
+
+  SVN_ERR(svn_fs_revision_root(&root, bb->repos->fs, revnum, pool));
+  SVN_ERR(svn_fs_file_contents(&contents, root, path, pool));
+  SVN_ERR(svn_stream_open_unique(&file, &filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 bb->curr_pool, pool));
+  SVN_ERR(svn_stream_copy3(contents, file, bb->cancel_func,
+                           bb->cancel_baton, pool));
+
+  /* The revision before START only tells what START changed. */
+  db.lines = bb->lines;
+  if (revnum >= bb->start)
+    {
+      db.revision = revnum;
+      apr_hash_set(bb->rev_props,
+                   apr_pmemdup(bb->pool, &revnum, sizeof(revnum)),
+                   sizeof(revnum),
+                   svn_prop_hash_dup(rev_props, bb->pool));
+    }
+  else
+    db.revision = SVN_INVALID_REVNUM;
+
+  SVN_ERR(svn_diff__file_chain_diff(&diff, bb->diffs, bb->last_file,
+                                    filename, pool));
+  SVN_ERR(svn_diff_output2(diff, &db, &blame_output_fns,
+                           bb->cancel_func, bb->cancel_baton));
+
+  bb->last_file = filename;
+
+  tmp_pool = bb->last_pool;
+  bb->last_pool = bb->curr_pool;
+  bb->curr_pool = tmp_pool;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_blame(svn_repos_t *repos,
+                const char *path,
+                svn_revnum_t start,
+                svn_revnum_t end,
+                const svn_diff_file_options_t *diff_options,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_blame_run_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
+{
+  struct blame_baton bb;
+  svn_stream_t *empty;
+  apr_pool_t *iterpool;
+  int i, j;
+
+  if (!SVN_IS_VALID_REVNUM(start)
+      || !SVN_IS_VALID_REVNUM(end))
+    {
+      svn_revnum_t youngest_rev;
+      SVN_ERR(svn_fs_youngest_rev(&youngest_rev, repos->fs, scratch_pool));
+
+      if (!SVN_IS_VALID_REVNUM(start))
+        start = youngest_rev;
+      if (!SVN_IS_VALID_REVNUM(end))
+        end = youngest_rev;
+    }
+
+  if (end < start)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            _("Blame can only be computed from older to "
+                              "younger revisions"));
+
+  if (!diff_options)
+    diff_options = svn_diff_file_options_create(scratch_pool);
+
+  bb.repos = repos;
+  bb.start = start;
+  bb.lines = apr_array_make(scratch_pool, 256, sizeof(svn_revnum_t));
+  bb.rev_props = apr_hash_make(scratch_pool);
+  bb.diffs = svn_diff__file_chain_create(diff_options, scratch_pool);
+  bb.cancel_func = cancel_func;
+  bb.cancel_baton = cancel_baton;
+  bb.pool = scratch_pool;
+  bb.last_pool = svn_pool_create(scratch_pool);
+  bb.curr_pool = svn_pool_create(scratch_pool);
+
+  /* The first text is diffed against the empty file. */
+  SVN_ERR(svn_stream_open_unique(&empty, &bb.last_file, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 scratch_pool, scratch_pool));
+  SVN_ERR(svn_stream_close(empty));
+
+  /* Like a client would, also get the revision before START to know
+     what START itself changed. */
+  SVN_ERR(svn_repos_get_file_revs2(repos, path, MAX(0, start - 1), end,
+                                   FALSE, authz_read_func, authz_read_baton,
+                                   blame_file_rev_handler, &bb,
+                                   scratch_pool));
+
+  /* Report runs of lines last changed in the same revision. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < bb.lines->nelts; i = j)
+    {
+      svn_revnum_t revision = APR_ARRAY_IDX(bb.lines, i, svn_revnum_t);
+      apr_hash_t *rev_props = NULL;
+
+      svn_pool_clear(iterpool);
+
+      for (j = i + 1; j < bb.lines->nelts; j++)
+        if (APR_ARRAY_IDX(bb.lines, j, svn_revnum_t) != revision)
+          break;
+
+      if (SVN_IS_VALID_REVNUM(revision))
+        rev_props = apr_hash_get(bb.rev_props, &revision, sizeof(revision));
+
+      SVN_ERR(receiver(receiver_baton, i, j - i, revision, rev_props,
+                       iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  svn_pool_destroy(bb.last_pool);
+  svn_pool_destroy(bb.curr_pool);
+
+  return SVN_NO_ERROR;
+}
@@ -37,6 +37,7 @@
 #include "svn_version.h"
 #include "private/svn_auth_private.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_mutex.h"
 
 #include "auth.h"
 
@@ -113,6 +114,10 @@ struct svn_auth_baton_t
 
   /* run-time credentials cache. */
   apr_hash_t *creds_cache;
+
+  /* Serializes the use of the providers and of CREDS_CACHE, which all
+     copies of this baton share, or NULL. */
+  svn_mutex__t *mutex;
 };
 
 /* Abstracted iteration baton */
@@ -223,13 +228,15 @@ make_cache_key(const char *cred_kind,
   return apr_pstrcat(pool, cred_kind, ":", realmstring, SVN_VA_NULL);
 }
 
-svn_error_t *
-svn_auth_first_credentials(void **credentials,
-                           svn_auth_iterstate_t **state,
-                           const char *cred_kind,
-                           const char *realmstring,
-                           svn_auth_baton_t *auth_baton,
-                           apr_pool_t *pool)
+/* The guts of svn_auth_first_credentials(), called with the mutex of
+   AUTH_BATON held. */
+static svn_error_t *
+first_credentials(void **credentials,
+                  svn_auth_iterstate_t **state,
+                  const char *cred_kind,
+                  const char *realmstring,
+                  svn_auth_baton_t *auth_baton,
+                  apr_pool_t *pool)
 {
   int i = 0;
   provider_set_t *table;
@@ -241,10 +248,6 @@ svn_auth_first_credentials(void **credentials,
   const char *cache_key;
   apr_hash_t *parameters;
 
-  if (! auth_baton)
-    return svn_error_create(SVN_ERR_AUTHN_NO_PROVIDER, NULL,
-                            _("No authentication providers registered"));
-
   /* Get the appropriate table of providers for CRED_KIND. */
   table = svn_hash_gets(auth_baton->tables, cred_kind);
   if (! table)
@@ -330,11 +333,32 @@ svn_auth_first_credentials(void **credentials,
   return SVN_NO_ERROR;
 }
 
-
 svn_error_t *
-svn_auth_next_credentials(void **credentials,
-                          svn_auth_iterstate_t *state,
-                          apr_pool_t *pool)
+svn_auth_first_credentials(void **credentials,
+                           svn_auth_iterstate_t **state,
+                           const char *cred_kind,
+                           const char *realmstring,
+                           svn_auth_baton_t *auth_baton,
+                           apr_pool_t *pool)
+{
+  if (! auth_baton)
+    return svn_error_create(SVN_ERR_AUTHN_NO_PROVIDER, NULL,
+                            _("No authentication providers registered"));
+
+  SVN_MUTEX__WITH_LOCK(auth_baton->mutex,
+                       first_credentials(credentials, state, cred_kind,
+                                         realmstring, auth_baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
+
+/* The guts of svn_auth_next_credentials(), called with the mutex of
+   STATE's auth baton held. */
+static svn_error_t *
+next_credentials(void **credentials,
+                 svn_auth_iterstate_t *state,
+                 apr_pool_t *pool)
 {
   svn_auth_baton_t *auth_baton = state->auth_baton;
   svn_auth_provider_object_t *provider;
@@ -384,10 +408,23 @@ svn_auth_next_credentials(void **credentials,
   return SVN_NO_ERROR;
 }
 
-
 svn_error_t *
-svn_auth_save_credentials(svn_auth_iterstate_t *state,
+svn_auth_next_credentials(void **credentials,
+                          svn_auth_iterstate_t *state,
                           apr_pool_t *pool)
+{
+  SVN_MUTEX__WITH_LOCK(state->auth_baton->mutex,
+                       next_credentials(credentials, state, pool));
+
+  return SVN_NO_ERROR;
+}
+
+
+/* The guts of svn_auth_save_credentials(), called with the mutex of
+   STATE's auth baton held. */
+static svn_error_t *
+save_credentials(svn_auth_iterstate_t *state,
+                 apr_pool_t *pool)
 {
   int i;
   svn_auth_provider_object_t *provider;
@@ -446,6 +483,19 @@ svn_auth_save_credentials(svn_auth_iterstate_t *state,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_auth_save_credentials(svn_auth_iterstate_t *state,
+                          apr_pool_t *pool)
+{
+  if (! state)
+    return SVN_NO_ERROR;
+
+  SVN_MUTEX__WITH_LOCK(state->auth_baton->mutex,
+                       save_credentials(state, pool));
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_auth_forget_credentials(svn_auth_baton_t *auth_baton,
@@ -455,6 +505,8 @@ svn_auth_forget_credentials(svn_auth_baton_t *auth_baton,
 {
   SVN_ERR_ASSERT((cred_kind && realmstring) || (!cred_kind && !realmstring));
 
+  SVN_ERR(svn_mutex__lock(auth_baton->mutex));
+
   /* If we have a CRED_KIND and REALMSTRING, we clear out just the
      cached item (if any).  Otherwise, empty the whole hash. */
   if (cred_kind)
@@ -468,6 +520,16 @@ svn_auth_forget_credentials(svn_auth_baton_t *auth_baton,
       apr_hash_clear(auth_baton->creds_cache);
     }
 
+  return svn_error_trace(svn_mutex__unlock(auth_baton->mutex,
+                                           SVN_NO_ERROR));
+}
+
+svn_error_t *
+svn_auth__make_thread_safe(svn_auth_baton_t *auth_baton)
+{
+  if (!auth_baton->mutex)
+    SVN_ERR(svn_mutex__init(&auth_baton->mutex, TRUE, auth_baton->pool));
+
   return SVN_NO_ERROR;
 }
 
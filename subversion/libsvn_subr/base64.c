@@ -33,9 +33,14 @@
 #include "svn_io.h"
 #include "svn_error.h"
 #include "svn_base64.h"
+#include "private/svn_eol_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 
+#ifdef SVN__HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 /* When asked to format the base64-encoded output as multiple lines,
    we put this many chars in each line (plus one new line char) unless
    we run out of data.
@@ -85,6 +90,64 @@ encode_group(const unsigned char *in, char *out)
   out[3] = base64tab[part2 & 0x3f];
 }
 
+#ifdef SVN__HAVE_SSE2
+
+/* Return a vector with one 0xff byte for every byte in V that is in the
+   range LOWER..UPPER.  All values must be in the range 0..127. */
+static APR_INLINE __m128i
+bytes_in_range(__m128i v, char lower, char upper)
+{
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)(lower - 1))),
+                       _mm_cmplt_epi8(v, _mm_set1_epi8((char)(upper + 1))));
+}
+
+/* Base64-encode the 12 bytes at IN into the 16 chars at OUT. */
+static APR_INLINE void
+encode_block_sse2(const unsigned char *in, char *out)
+{
+  const __m128i mask = _mm_set1_epi32(0x3f);
+  __m128i lanes, values, offsets;
+
+  /* Gather each three-byte group into a 32 bit lane, first byte on top.
+     SSE2 has no byte shuffle that would make this cheaper. */
+  lanes = _mm_set_epi32((in[9] << 16) | (in[10] << 8) | in[11],
+                        (in[6] << 16) | (in[7] << 8) | in[8],
+                        (in[3] << 16) | (in[4] << 8) | in[5],
+                        (in[0] << 16) | (in[1] << 8) | in[2]);
+
+  /* Spread the four six-bit units of each lane over its four bytes,
+     in output order. */
+  values = _mm_and_si128(_mm_srli_epi32(lanes, 18), mask);
+  values = _mm_or_si128(values,
+             _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(lanes, 12), mask),
+                            8));
+  values = _mm_or_si128(values,
+             _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(lanes, 6), mask),
+                            16));
+  values = _mm_or_si128(values,
+                        _mm_slli_epi32(_mm_and_si128(lanes, mask), 24));
+
+  /* Map 0..63 to base64tab without a table: start with the offset for
+     'A'..'Z' and correct it for the other ranges. */
+  offsets = _mm_set1_epi8('A');
+  offsets = _mm_add_epi8(offsets,
+              _mm_and_si128(_mm_cmpgt_epi8(values, _mm_set1_epi8(25)),
+                            _mm_set1_epi8('a' - 26 - 'A')));
+  offsets = _mm_sub_epi8(offsets,
+              _mm_and_si128(_mm_cmpgt_epi8(values, _mm_set1_epi8(51)),
+                            _mm_set1_epi8('a' - 26 - '0' + 52)));
+  offsets = _mm_sub_epi8(offsets,
+              _mm_and_si128(_mm_cmpeq_epi8(values, _mm_set1_epi8(62)),
+                            _mm_set1_epi8('0' - 52 - '+' + 62)));
+  offsets = _mm_sub_epi8(offsets,
+              _mm_and_si128(_mm_cmpeq_epi8(values, _mm_set1_epi8(63)),
+                            _mm_set1_epi8('0' - 52 - '/' + 63)));
+
+  _mm_storeu_si128((__m128i *)out, _mm_add_epi8(values, offsets));
+}
+
+#endif
+
 /* Base64-encode a line, i.e. BYTES_PER_LINE bytes from DATA into
    BASE64_LINELEN chars and append it to STR.  It does not assume that
    a new line char will be appended, though.
@@ -101,6 +164,12 @@ encode_line(svn_stringbuf_t *str, const char *data)
   char *out = str->data + str->len;
   char *end = out + BASE64_LINELEN;
 
+#ifdef SVN__HAVE_SSE2
+  /* Encode 12 bytes at a time and leave the rest to the loop below. */
+  for ( ; end - out >= 16; in += 12, out += 16)
+    encode_block_sse2(in, out);
+#endif
+
   /* We assume that BYTES_PER_LINE is a multiple of 3 and BASE64_LINELEN
      a multiple of 4. */
   for ( ; out != end; in += 3, out += 4)
@@ -361,6 +430,66 @@ decode_group_directly(const unsigned char *in, char *out)
   return (part0 | part1 | part2 | part3) != (unsigned char)(-1);
 }
 
+#ifdef SVN__HAVE_SSE2
+
+/* Base64-decode the 16 chars at IN into the 12 bytes at OUT.  Return FALSE
+   without writing anything if there is a non-base64 char (e.g. '=' or new
+   line) among them. */
+static APR_INLINE svn_boolean_t
+decode_block_sse2(const unsigned char *in, char *out)
+{
+  __m128i chars = _mm_loadu_si128((const __m128i *)in);
+  __m128i upper = bytes_in_range(chars, 'A', 'Z');
+  __m128i lower = bytes_in_range(chars, 'a', 'z');
+  __m128i digit = bytes_in_range(chars, '0', '9');
+  __m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+  __m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+  __m128i values, pairs;
+  apr_uint32_t groups[4];
+  int i;
+
+  /* Chars >= 0x80 are negative and thus in none of the ranges. */
+  if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(upper, lower),
+                                     _mm_or_si128(_mm_or_si128(digit, plus),
+                                                  slash))) != 0xffff)
+    return FALSE;
+
+  /* Translate the chars to their six-bit values. */
+  values = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  values = _mm_or_si128(values,
+                        _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  values = _mm_or_si128(values,
+                        _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+  values = _mm_or_si128(values,
+                        _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+  values = _mm_or_si128(values,
+                        _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+  values = _mm_add_epi8(chars, values);
+
+  /* Paste pairs of six-bit values into 12 bits per 16 bit word and pairs
+     of those into 24 bits per 32 bit lane. */
+  pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values,
+                                                    _mm_set1_epi16(0xff)),
+                                      6),
+                       _mm_srli_epi16(values, 8));
+  pairs = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pairs,
+                                                    _mm_set1_epi32(0xffff)),
+                                      12),
+                       _mm_srli_epi32(pairs, 16));
+  _mm_storeu_si128((__m128i *)groups, pairs);
+
+  for (i = 0; i < 4; i++, out += 3)
+    {
+      out[0] = (char)(groups[i] >> 16);
+      out[1] = (char)(groups[i] >> 8);
+      out[2] = (char)groups[i];
+    }
+
+  return TRUE;
+}
+
+#endif
+
 /* Base64-encode up to BASE64_LINELEN chars from *DATA and append it to
    STR.  After the function returns, *DATA will point to the first char
    that has not been translated, yet.  Returns TRUE if all BASE64_LINELEN
@@ -379,6 +508,14 @@ decode_line(svn_stringbuf_t *str, const char **data)
   char *out = str->data + str->len;
   char *end = out + BYTES_PER_LINE;
 
+#ifdef SVN__HAVE_SSE2
+  /* Decode 16 chars at a time until we run out of full blocks or hit a
+     special char.  The loop below takes care of the rest. */
+  for (; end - out >= 12; p += 16, out += 12)
+    if (!decode_block_sse2(p, out))
+      break;
+#endif
+
   /* We assume that BYTES_PER_LINE is a multiple of 3 and BASE64_LINELEN
      a multiple of 4.  Stop translation as soon as we encounter a special
      char.  Leave the entire group untouched in that case. */
@@ -0,0 +1,216 @@
+/*
+ * cache-layered.c: a local cache in front of a shared one
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+
+#include "svn_private_config.h"
+#include "private/svn_cache.h"
+
+#include "cache.h"
+
+/* The (internal) cache object.  Both tiers are complete svn_cache__t
+ * instances with the same key and value types.  We access them through
+ * the public svn_cache__* functions, so their own error handlers and
+ * statistics keep working.
+ */
+typedef struct layered_cache_t
+{
+  /* Fast, local cache that gets checked first. */
+  svn_cache__t *front;
+
+  /* Slower, usually shared cache that holds the authoritative copy. */
+  svn_cache__t *back;
+} layered_cache_t;
+
+
+static svn_error_t *
+layered_cache_get(void **value_p,
+                  svn_boolean_t *found,
+                  void *cache_void,
+                  const void *key,
+                  apr_pool_t *result_pool)
+{
+  layered_cache_t *cache = cache_void;
+
+  SVN_ERR(svn_cache__get(value_p, found, cache->front, key, result_pool));
+  if (*found)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_cache__get(value_p, found, cache->back, key, result_pool));
+
+  /* Keep the next lookup local. */
+  if (*found)
+    SVN_ERR(svn_cache__set(cache->front, key, *value_p, result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+layered_cache_has_key(svn_boolean_t *found,
+                      void *cache_void,
+                      const void *key,
+                      apr_pool_t *scratch_pool)
+{
+  layered_cache_t *cache = cache_void;
+
+  SVN_ERR(svn_cache__has_key(found, cache->front, key, scratch_pool));
+  if (! *found)
+    SVN_ERR(svn_cache__has_key(found, cache->back, key, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+layered_cache_set(void *cache_void,
+                  const void *key,
+                  void *value,
+                  apr_pool_t *scratch_pool)
+{
+  layered_cache_t *cache = cache_void;
+
+  SVN_ERR(svn_cache__set(cache->back, key, value, scratch_pool));
+  SVN_ERR(svn_cache__set(cache->front, key, value, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+layered_cache_iter(svn_boolean_t *completed,
+                   void *cache_void,
+                   svn_iter_apr_hash_cb_t user_cb,
+                   void *user_baton,
+                   apr_pool_t *scratch_pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Can't iterate a layered cache"));
+}
+
+static svn_error_t *
+layered_cache_get_partial(void **value_p,
+                          svn_boolean_t *found,
+                          void *cache_void,
+                          const void *key,
+                          svn_cache__partial_getter_func_t func,
+                          void *baton,
+                          apr_pool_t *result_pool)
+{
+  layered_cache_t *cache = cache_void;
+  void *value;
+
+  SVN_ERR(svn_cache__get_partial(value_p, found, cache->front, key,
+                                 func, baton, result_pool));
+  if (*found)
+    return SVN_NO_ERROR;
+
+  /* Partial getters are often called repeatedly for the same entry,
+   * e.g. when streaming a fulltext chunk by chunk.  Fetch the complete
+   * value once and serve the rest from the front cache. */
+  SVN_ERR(svn_cache__get(&value, found, cache->back, key, result_pool));
+  if (! *found)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_cache__set(cache->front, key, value, result_pool));
+  SVN_ERR(svn_cache__get_partial(value_p, found, cache->front, key,
+                                 func, baton, result_pool));
+
+  /* The front cache may have rejected VALUE. */
+  if (! *found)
+    SVN_ERR(svn_cache__get_partial(value_p, found, cache->back, key,
+                                   func, baton, result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+layered_cache_set_partial(void *cache_void,
+                          const void *key,
+                          svn_cache__partial_setter_func_t func,
+                          void *baton,
+                          apr_pool_t *scratch_pool)
+{
+  layered_cache_t *cache = cache_void;
+
+  SVN_ERR(svn_cache__set_partial(cache->back, key, func, baton,
+                                 scratch_pool));
+  SVN_ERR(svn_cache__set_partial(cache->front, key, func, baton,
+                                 scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_boolean_t
+layered_cache_is_cachable(void *cache_void,
+                          apr_size_t size)
+{
+  layered_cache_t *cache = cache_void;
+
+  return svn_cache__is_cachable(cache->back, size)
+      || svn_cache__is_cachable(cache->front, size);
+}
+
+static svn_error_t *
+layered_cache_get_info(void *cache_void,
+                       svn_cache__info_t *info,
+                       svn_boolean_t reset,
+                       apr_pool_t *result_pool)
+{
+  layered_cache_t *cache = cache_void;
+
+  /* The front cache is the one local memory is spent on. */
+  return svn_error_trace(cache->front->vtable->get_info(
+                           cache->front->cache_internal, info, reset,
+                           result_pool));
+}
+
+static svn_cache__vtable_t layered_cache_vtable = {
+  layered_cache_get,
+  layered_cache_has_key,
+  layered_cache_set,
+  layered_cache_iter,
+  layered_cache_is_cachable,
+  layered_cache_get_partial,
+  layered_cache_set_partial,
+  layered_cache_get_info
+};
+
+svn_error_t *
+svn_cache__create_layered(svn_cache__t **cache_p,
+                          svn_cache__t *front,
+                          svn_cache__t *back,
+                          apr_pool_t *result_pool)
+{
+  svn_cache__t *wrapper = apr_pcalloc(result_pool, sizeof(*wrapper));
+  layered_cache_t *cache = apr_pcalloc(result_pool, sizeof(*cache));
+
+  cache->front = front;
+  cache->back = back;
+
+  wrapper->vtable = &layered_cache_vtable;
+  wrapper->cache_internal = cache;
+  wrapper->error_handler = 0;
+  wrapper->error_baton = 0;
+  wrapper->pretend_empty = FALSE;
+
+  *cache_p = wrapper;
+  return SVN_NO_ERROR;
+}
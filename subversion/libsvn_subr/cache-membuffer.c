@@ -24,6 +24,8 @@
 #include <assert.h>
 #include <apr_md5.h>
 #include <apr_thread_rwlock.h>
+#include <apr_shm.h>
+#include <apr_global_mutex.h>
 
 #include "svn_pools.h"
 #include "svn_checksum.h"
@@ -63,8 +65,14 @@
  * Only the start address of these two data parts are given as a native
  * pointer. All other references are expressed as offsets to these pointers.
  * With that design, it is relatively easy to share the same data structure
- * between different processes and / or to persist them on disk. These
- * out-of-process features have not been implemented, yet.
+ * between different processes and / or to persist them on disk.
+ *
+ * Sharing between processes is implemented for pre-forking servers: the
+ * whole cache, including the prefix pool, may be allocated in anonymous
+ * shared memory.  Because that gets mapped to the same address in all
+ * processes forked afterwards, even the few native pointers stay valid.
+ * Segment locks are then replaced by cross-process locks.  Persisting the
+ * cache on disk has not been implemented, yet.
  *
  * Superficially, cache levels are being used as usual: insertion happens
  * into L1 and evictions will promote items to L2.  But their whole point
@@ -125,10 +133,16 @@
  * is then unique, too, and can never conflict.  No full key construction,
  * storage and comparison is needed in that case.
  *
- * All access to the cached data needs to be serialized. Because we want
- * to scale well despite that bottleneck, we simply segment the cache into
- * a number of independent caches (segments). Items will be multiplexed based
- * on their hash key.
+ * All modifications of the cached data need to be serialized. Because we
+ * want to scale well despite that bottleneck, we simply segment the cache
+ * into a number of independent caches (segments). Items will be multiplexed
+ * based on their hash key.
+ *
+ * Lookups usually don't take any lock.  Every segment has a write sequence
+ * counter that writers increment before and after modifying it, i.e. it is
+ * odd while a write is in progress.  Readers copy the item data out of the
+ * segment and only accept the result if the counter has been even and
+ * unchanged throughout the read.  Otherwise, they retry under the read lock.
  */
 
 /* APR's read-write lock implementation on Windows is horribly inefficient.
@@ -146,6 +160,41 @@
 #  define USE_SIMPLE_MUTEX 0
 #endif
 
+/* Caches shared between processes need anonymous shared memory that gets
+ * inherited by forked processes as well as a cross-process lock that
+ * keeps working in those without being re-initialized.  Depending on the
+ * lock mechanism, apr_global_mutex_child_init() would need to be called in
+ * each child but the cache does not know when it has been forked.
+ */
+#if APR_HAS_SHARED_MEMORY && APR_HAS_FORK && APR_HAS_PROC_PTHREAD_SERIALIZE
+#  define SUPPORT_SHARED_MEMORY 1
+#  define SHARED_LOCK_MECHANISM APR_LOCK_PROC_PTHREAD
+#elif APR_HAS_SHARED_MEMORY && APR_HAS_FORK && APR_HAS_SYSVSEM_SERIALIZE
+#  define SUPPORT_SHARED_MEMORY 1
+#  define SHARED_LOCK_MECHANISM APR_LOCK_SYSVSEM
+#else
+#  define SUPPORT_SHARED_MEMORY 0
+#endif
+
+/* Lock-free lookups need a full memory barrier to order the reads of the
+ * write sequence counter against the reads of the cached data.  Where we
+ * don't know how to emit one, all lookups will use the segment lock.
+ *
+ * The debug tag checks are not prepared to see inconsistent states, so we
+ * don't do lock-free lookups in that configuration either.
+ */
+#if defined(SVN_DEBUG_CACHE_MEMBUFFER)
+#  define USE_OPTIMISTIC_READS 0
+#elif defined(__GNUC__)
+#  define USE_OPTIMISTIC_READS 1
+#  define MEMORY_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#  define USE_OPTIMISTIC_READS 1
+#  define MEMORY_BARRIER() MemoryBarrier()
+#else
+#  define USE_OPTIMISTIC_READS 0
+#endif
+
 /* For more efficient copy operations, let's align all data items properly.
  * Since we can't portably align pointers, this is rather the item size
  * granularity which ensures *relative* alignment within the cache - still
@@ -240,13 +289,98 @@ typedef struct full_key_t
   svn_membuf_t full_key;
 } full_key_t;
 
+/* A region of anonymous shared memory that a cross-process membuffer
+ * cache gets allocated from.  Memory is being handed out sequentially and
+ * never returned.
+ *
+ * This header and thus USED are private to each process.  Hence, all
+ * allocations from it must happen in the process that created the cache,
+ * before any worker process gets forked.  Data that grows afterwards, i.e.
+ * the prefix strings, must come from storage reserved up-front and be
+ * tracked inside the shared region itself, see prefix_pool_t.
+ */
+typedef struct membuffer_shm_t
+{
+  /* The APR shared memory object. */
+  apr_shm_t *shm;
+
+  /* First byte of the region. */
+  unsigned char *base;
+
+  /* Size of the region in bytes. */
+  apr_size_t size;
+
+  /* Number of bytes already handed out. */
+  apr_size_t used;
+} membuffer_shm_t;
+
+/* Return a buffer of SIZE bytes allocated from SHM or, if that is NULL,
+ * from POOL.  Zero the buffer if CLEAR is set.  Return NULL if SHM has
+ * been exhausted or POOL has been created without an abort function and
+ * we are OOM.
+ */
+static void *
+membuffer_alloc(apr_pool_t *pool,
+                membuffer_shm_t *shm,
+                apr_size_t size,
+                svn_boolean_t clear)
+{
+  void *result;
+
+  if (shm == NULL)
+    return clear ? apr_pcalloc(pool, size) : apr_palloc(pool, size);
+
+  /* Fresh anonymous shared memory is zero-filled, i.e. always "clear". */
+  size = APR_ALIGN(size, ITEM_ALIGNMENT);
+  if (shm->size - shm->used < size)
+    return NULL;
+
+  result = shm->base + shm->used;
+  shm->used += size;
+
+  return result;
+}
+
+#if SUPPORT_SHARED_MEMORY
+
+/* Acquire the cross-process LOCK.
+ */
+static svn_error_t *
+lock_shared(apr_global_mutex_t *lock)
+{
+  apr_status_t status = apr_global_mutex_lock(lock);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't lock cache mutex"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Release the cross-process LOCK.  Return ERR upon success.
+ */
+static svn_error_t *
+unlock_shared(apr_global_mutex_t *lock,
+              svn_error_t *err)
+{
+  apr_status_t status = apr_global_mutex_unlock(lock);
+  if (err)
+    return err;
+
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't unlock cache mutex"));
+
+  return SVN_NO_ERROR;
+}
+
+#endif
+
 /* A limited capacity, thread-safe pool of unique C strings.  Operations on
  * this data structure are defined by prefix_pool_* functions.  The only
  * "public" member is VALUES (r/o access only).
  */
 typedef struct prefix_pool_t
 {
-  /* Map C string to a pointer into VALUES with the same contents. */
+  /* Map C string to a pointer into VALUES with the same contents.
+   * NULL if this pool lives in SHM.  Lookups will then be linear. */
   apr_hash_t *map;
 
   /* Pointer to an array of strings. These are the contents of this pool
@@ -269,16 +403,38 @@ typedef struct prefix_pool_t
 
   /* The serialization object. */
   svn_mutex__t *mutex;
+
+  /* Shared memory region that this pool got allocated from.
+   * NULL for pools private to this process. */
+  membuffer_shm_t *shm;
+
+  /* Storage for the strings in VALUES if this pool lives in SHM, reserved
+   * when the pool gets created.  STRINGS_USED bytes of its STRINGS_SIZE
+   * bytes have been handed out.  Since this struct is part of SHM, all
+   * processes share the cursor; it must only be advanced while holding
+   * SHARED_MUTEX.  NULL for pools private to this process. */
+  char *strings;
+  apr_size_t strings_size;
+  apr_size_t strings_used;
+
+#if SUPPORT_SHARED_MEMORY
+  /* Cross-process lock used instead of MUTEX if SHM is not NULL. */
+  apr_global_mutex_t *shared_mutex;
+#endif
 } prefix_pool_t;
 
 /* Set *PREFIX_POOL to a new instance that tries to limit allocation to
  * BYTES_MAX bytes.  If MUTEX_REQUIRED is set and multi-threading is
  * supported, serialize all access to the new instance.  Allocate the
- * object from *RESULT_POOL. */
+ * object from *RESULT_POOL.
+ *
+ * If SHM is not NULL, allocate the instance and all its values from it
+ * and serialize access across processes. */
 static svn_error_t *
 prefix_pool_create(prefix_pool_t **prefix_pool,
                    apr_size_t bytes_max,
                    svn_boolean_t mutex_required,
+                   membuffer_shm_t *shm,
                    apr_pool_t *result_pool)
 {
   enum
@@ -295,19 +451,53 @@ prefix_pool_create(prefix_pool_t **prefix_pool,
                             bytes_max / ESTIMATED_BYTES_PER_ENTRY);
 
   /* Construct the result struct. */
-  prefix_pool_t *result = apr_pcalloc(result_pool, sizeof(*result));
-  result->map = svn_hash__make(result_pool);
+  prefix_pool_t *result = membuffer_alloc(result_pool, shm, sizeof(*result),
+                                          TRUE);
+  if (result == NULL)
+    return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
+  result->map = shm ? NULL : svn_hash__make(result_pool);
 
   result->values = capacity
-                 ? apr_pcalloc(result_pool, capacity * sizeof(const char *))
+                 ? membuffer_alloc(result_pool, shm,
+                                   capacity * sizeof(const char *), TRUE)
                  : NULL;
-  result->values_max = (apr_uint32_t)capacity;
+  result->values_max = result->values ? (apr_uint32_t)capacity : 0;
   result->values_used = 0;
 
   result->bytes_max = bytes_max;
   result->bytes_used = capacity * sizeof(svn_membuf_t);
+  result->shm = shm;
+
+  /* Later processes must not allocate from SHM, so set aside the space
+   * for the strings right now. */
+  result->strings = NULL;
+  result->strings_size = 0;
+  result->strings_used = 0;
+  if (shm && bytes_max > capacity * sizeof(const char *))
+    {
+      result->strings_size = bytes_max - capacity * sizeof(const char *);
+      result->strings = membuffer_alloc(result_pool, shm,
+                                        result->strings_size, FALSE);
+      if (result->strings == NULL)
+        return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+    }
 
-  SVN_ERR(svn_mutex__init(&result->mutex, mutex_required, result_pool));
+  SVN_ERR(svn_mutex__init(&result->mutex, mutex_required && !shm,
+                          result_pool));
+
+#if SUPPORT_SHARED_MEMORY
+  result->shared_mutex = NULL;
+  if (shm)
+    {
+      apr_status_t status = apr_global_mutex_create(&result->shared_mutex,
+                                                    NULL,
+                                                    SHARED_LOCK_MECHANISM,
+                                                    result_pool);
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't create cache mutex"));
+    }
+#endif
 
   /* Done. */
   *prefix_pool = result;
@@ -334,13 +524,28 @@ prefix_pool_get_internal(apr_uint32_t *prefix_idx,
       OVERHEAD = 40 + 8
     };
 
-  const char **value;
+  const char **value = NULL;
   apr_size_t prefix_len = strlen(prefix);
   apr_size_t bytes_needed;
-  apr_pool_t *pool;
 
-  /* Lookup.  If we already know that prefix, return its index. */
-  value = apr_hash_get(prefix_pool->map, prefix, prefix_len);
+  /* Lookup.  If we already know that prefix, return its index.
+   * Pools without a hash are only queried when cache front-ends get
+   * created, so a linear search is good enough there. */
+  if (prefix_pool->map)
+    {
+      value = apr_hash_get(prefix_pool->map, prefix, prefix_len);
+    }
+  else
+    {
+      apr_uint32_t i;
+      for (i = 0; i < prefix_pool->values_used; ++i)
+        if (strcmp(prefix_pool->values[i], prefix) == 0)
+          {
+            value = &prefix_pool->values[i];
+            break;
+          }
+    }
+
   if (value != NULL)
     {
       const apr_size_t idx = value - prefix_pool->values;
@@ -365,11 +570,30 @@ prefix_pool_get_internal(apr_uint32_t *prefix_idx,
     }
 
   /* Add new entry. */
-  pool = apr_hash_pool_get(prefix_pool->map);
-
   value = &prefix_pool->values[prefix_pool->values_used];
-  *value = apr_pstrndup(pool, prefix, prefix_len + 1);
-  apr_hash_set(prefix_pool->map, *value, prefix_len, value);
+  if (prefix_pool->map)
+    {
+      apr_pool_t *pool = apr_hash_pool_get(prefix_pool->map);
+      *value = apr_pstrndup(pool, prefix, prefix_len + 1);
+      apr_hash_set(prefix_pool->map, *value, prefix_len, value);
+    }
+  else
+    {
+      /* We hold the SHARED_MUTEX, so no other process moves the cursor. */
+      char *copy;
+      if (prefix_pool->strings_size - prefix_pool->strings_used
+          < prefix_len + 1)
+        {
+          *prefix_idx = NO_INDEX;
+          return SVN_NO_ERROR;
+        }
+
+      copy = prefix_pool->strings + prefix_pool->strings_used;
+      prefix_pool->strings_used += prefix_len + 1;
+
+      memcpy(copy, prefix, prefix_len + 1);
+      *value = copy;
+    }
 
   *prefix_idx = prefix_pool->values_used;
   ++prefix_pool->values_used;
@@ -384,6 +608,16 @@ prefix_pool_get(apr_uint32_t *prefix_idx,
                 prefix_pool_t *prefix_pool,
                 const char *prefix)
 {
+#if SUPPORT_SHARED_MEMORY
+  if (prefix_pool->shared_mutex)
+    {
+      SVN_ERR(lock_shared(prefix_pool->shared_mutex));
+      return unlock_shared(prefix_pool->shared_mutex,
+                           prefix_pool_get_internal(prefix_idx, prefix_pool,
+                                                    prefix));
+    }
+#endif
+
   SVN_MUTEX__WITH_LOCK(prefix_pool->mutex,
                        prefix_pool_get_internal(prefix_idx, prefix_pool,
                                                 prefix));
@@ -566,6 +800,8 @@ typedef struct entry_t
   apr_size_t size;
 
   /* Number of (read) hits for this entry. Will be reset upon write.
+   * Lock-free readers modify it concurrently with writers.  Therefore,
+   * all updates must be atomic.
    * Only valid for used entries.
    */
   svn_atomic_t hit_count;
@@ -692,6 +928,113 @@ typedef struct cache_level_t
 
 } cache_level_t;
 
+/* Number of rows in a frequency_sketch_t.  Each row uses a different
+ * hash function.
+ */
+#define SKETCH_DEPTH 4
+
+/* The counters in a frequency_sketch_t saturate at this value.
+ */
+#define SKETCH_MAX_COUNT 15
+
+/* Count-min sketch that approximates how often keys have recently been
+ * requested from a cache segment.  It is used to implement a TinyLFU-style
+ * admission filter.
+ *
+ * Lookups record their requests without holding the segment lock.  The
+ * sketch is approximate by design and the races on COUNTERS are intended:
+ * lost or duplicated increments merely reduce the precision of the
+ * estimates.  ADDITIONS, however, is updated atomically such that only a
+ * single thread ages the counters whenever SAMPLE_SIZE gets reached.
+ */
+typedef struct frequency_sketch_t
+{
+  /* SKETCH_DEPTH rows with WIDTH_MASK+1 counters each. */
+  unsigned char *counters;
+
+  /* Number of counters per row minus 1.  The width is a power of 2. */
+  apr_uint32_t width_mask;
+
+  /* Number of accesses recorded since the counters were last aged. */
+  volatile svn_atomic_t additions;
+
+  /* Once ADDITIONS reaches this value, all counters get halved. */
+  apr_uint32_t sample_size;
+} frequency_sketch_t;
+
+/* Keys are sampled for the size estimates if the lower bits of their hash
+ * are below size_estimator_t.THRESHOLD.  This is the range of those bits.
+ */
+#define ESTIMATOR_SAMPLE_RANGE 0x1000000
+
+/* Maximum number of shadow tags in a size_estimator_t.
+ */
+#define ESTIMATOR_MAX_TAGS 0x4000
+
+/* Halve the estimator's counts after this many sampled requests such that
+ * the estimates follow the current workload.
+ */
+#define ESTIMATOR_AGING_PERIOD 100000
+
+/* Shadow tag of a sampled key in a size_estimator_t.
+ */
+typedef struct shadow_tag_t
+{
+  /* Hash of the key.  See estimator_hash(). */
+  apr_uint64_t hash;
+
+  /* Size of the serialized item as of the last write, 0 if unknown. */
+  apr_uint32_t size;
+
+  /* Neighbors in the recency list.  NO_INDEX at either end. */
+  apr_uint32_t previous;
+  apr_uint32_t next;
+
+  /* Next tag in the same hash bucket or NO_INDEX. */
+  apr_uint32_t chain;
+} shadow_tag_t;
+
+/* Spatially sampled (SHARDS-style) LRU simulation over the key stream of
+ * a membuffer cache.  For a small, hash-selected subset of all keys, we
+ * keep shadow tags in recency order, independent of whether the items are
+ * in the cache.  The summed sizes of the tags accessed since the previous
+ * request for the same key, scaled by the sample rate, give the smallest
+ * LRU cache that would have had a hit.  From those reuse distances, we get
+ * the hit ratio at other cache sizes without simulating the full cache.
+ *
+ * The estimator is shared by all segments and has its own lock, taken
+ * only for sampled keys.
+ */
+typedef struct size_estimator_t
+{
+  /* Serializes all access to the members below. */
+  svn_mutex__t *mutex;
+
+  /* CAPACITY shadow tags, the first COUNT of them in use. */
+  shadow_tag_t *tags;
+  apr_uint32_t capacity;
+  apr_uint32_t count;
+
+  /* Heads of the hash bucket chains, BUCKET_MASK+1 of them. */
+  apr_uint32_t *buckets;
+  apr_uint32_t bucket_mask;
+
+  /* Most and least recently requested tags or NO_INDEX. */
+  apr_uint32_t first;
+  apr_uint32_t last;
+
+  /* Sample keys whose hash & (ESTIMATOR_SAMPLE_RANGE-1) is below this. */
+  apr_uint32_t threshold;
+
+  /* Cache data sizes in bytes to give estimates for. */
+  apr_uint64_t sizes[SVN_CACHE__SIZE_ESTIMATES];
+
+  /* Number of sampled requests and how many of them would have been hits
+   * with a cache of SIZES[i]. */
+  apr_uint64_t requests;
+  apr_uint64_t hits[SVN_CACHE__SIZE_ESTIMATES];
+} size_estimator_t;
+
 /* The cache header structure.
  */
 struct svn_membuffer_t
@@ -777,8 +1120,7 @@ struct svn_membuffer_t
 
   /* Total number of calls to membuffer_cache_get.
    * Purely statistical information that may be used for profiling only.
-   * Updates are not synchronized and values may be nonsensicle on some
-   * platforms.
+   * Lock-free readers update it, too.  Use increment_stat() to modify it.
    */
   apr_uint64_t total_reads;
 
@@ -790,11 +1132,39 @@ struct svn_membuffer_t
   apr_uint64_t total_writes;
 
   /* Total number of hits since the cache's creation.
+   * Purely statistical information that may be used for profiling only.
+   * Lock-free readers update it, too.  Use increment_stat() to modify it.
+   */
+  apr_uint64_t total_hits;
+
+  /* Total number of new items not admitted by the admission filter.
    * Purely statistical information that may be used for profiling only.
    * Updates are not synchronized and values may be nonsensicle on some
    * platforms.
    */
-  apr_uint64_t total_hits;
+  apr_uint64_t admission_rejects;
+
+  /* Access frequency estimates used by the admission filter.
+   * NULL if the filter is disabled, i.e. all new items will be admitted.
+   */
+  frequency_sketch_t *sketch;
+
+  /* Cache size estimator shared by all segments.
+   * NULL if disabled.
+   */
+  size_estimator_t *estimator;
+
+  /* The shared memory region this segment has been allocated from.
+   * NULL for caches private to the current process.
+   */
+  membuffer_shm_t *shm;
+
+#if SUPPORT_SHARED_MEMORY
+  /* A lock for cross-process synchronization to the cache.  It is used
+   * instead of LOCK if SHM is not NULL.  NULL otherwise.
+   */
+  apr_global_mutex_t *shared_lock;
+#endif
 
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   /* A lock for intra-process synchronization to the cache, or NULL if
@@ -817,6 +1187,11 @@ struct svn_membuffer_t
    * This one is only used in debug assertions to verify that you used
    * the correct multi-threading settings. */
   svn_atomic_t write_lock_count;
+
+  /* Incremented by writers right after acquiring the write lock and
+   * right before releasing it.  Odd values indicate that a modification
+   * is in progress.  Lock-free readers use this to detect changes. */
+  volatile svn_atomic_t write_sequence;
 };
 
 /* Align integer VALUE to the next ITEM_ALIGNMENT boundary.
@@ -828,6 +1203,11 @@ struct svn_membuffer_t
 static svn_error_t *
 read_lock_cache(svn_membuffer_t *cache)
 {
+#if SUPPORT_SHARED_MEMORY
+  if (cache->shared_lock)
+    return lock_shared(cache->shared_lock);
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -846,11 +1226,17 @@ read_lock_cache(svn_membuffer_t *cache)
 
 /* If locking is supported for CACHE, acquire a write lock for it.
  * Set *SUCCESS to FALSE, if we couldn't acquire the write lock;
- * leave it untouched otherwise.
+ * leave it untouched otherwise.  Writes to caches shared between
+ * processes always block.
  */
 static svn_error_t *
 write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 {
+#if SUPPORT_SHARED_MEMORY
+  if (cache->shared_lock)
+    return lock_shared(cache->shared_lock);
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -888,6 +1274,11 @@ write_lock_cache(svn_membuffer_t *cache, svn_boolean_t *success)
 static svn_error_t *
 force_write_lock_cache(svn_membuffer_t *cache)
 {
+#if SUPPORT_SHARED_MEMORY
+  if (cache->shared_lock)
+    return lock_shared(cache->shared_lock);
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__lock(cache->lock);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -908,6 +1299,11 @@ force_write_lock_cache(svn_membuffer_t *cache)
 static svn_error_t *
 unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 {
+#if SUPPORT_SHARED_MEMORY
+  if (cache->shared_lock)
+    return unlock_shared(cache->shared_lock, err);
+#endif
+
 #if (APR_HAS_THREADS && USE_SIMPLE_MUTEX)
   return svn_mutex__unlock(cache->lock, err);
 #elif (APR_HAS_THREADS && !USE_SIMPLE_MUTEX)
@@ -927,6 +1323,25 @@ unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 #endif
 }
 
+/* Announce the start of a modification of CACHE to lock-free readers.
+ * The caller must hold the write lock.
+ */
+static APR_INLINE void
+start_write(svn_membuffer_t *cache)
+{
+  svn_atomic_inc(&cache->write_sequence);
+}
+
+/* Announce that the latest modification of CACHE has been completed.
+ * The caller must still hold the write lock.  Return ERR.
+ */
+static APR_INLINE svn_error_t *
+finish_write(svn_membuffer_t *cache, svn_error_t *err)
+{
+  svn_atomic_inc(&cache->write_sequence);
+  return err;
+}
+
 /* If supported, guard the execution of EXPR with a read lock to CACHE.
  * The macro has been modeled after SVN_MUTEX__WITH_LOCK.
  */
@@ -959,7 +1374,8 @@ do {                                                            \
       else                                                      \
         break;                                                  \
     }                                                           \
-  SVN_ERR(unlock_cache(cache, (expr)));                         \
+  start_write(cache);                                           \
+  SVN_ERR(unlock_cache(cache, finish_write(cache, (expr))));    \
 } while (0)
 
 /* Returns 0 if the entry group identified by GROUP_INDEX in CACHE has not
@@ -1314,37 +1730,396 @@ insert_entry(svn_membuffer_t *cache, entry_t *entry)
    */
   cache->used_entries++;
   cache->data_used += entry->size;
-  entry->hit_count = 0;
+  svn_atomic_set(&entry->hit_count, 0);
   group->header.used++;
 
-  /* update entry chain
-   */
-  chain_entry(cache, level, entry, idx);
+  /* update entry chain
+   */
+  chain_entry(cache, level, entry, idx);
+
+  /* The current insertion position must never point outside our
+   * data buffer.
+   */
+  assert(level->current_data <= level->start_offset + level->size);
+}
+
+/* Map a KEY of 16 bytes to the CACHE and group that shall contain the
+ * respective item.
+ */
+static apr_uint32_t
+get_group_index(svn_membuffer_t **cache,
+                const entry_key_t *key)
+{
+  svn_membuffer_t *segment0 = *cache;
+  apr_uint64_t key0 = key->fingerprint[0];
+  apr_uint64_t key1 = key->fingerprint[1];
+
+  /* select the cache segment to use. they have all the same group_count.
+   * Since key may not be well-distributed, pre-fold it to a smaller but
+   * "denser" ranger.  The modulus is a prime larger than the largest
+   * counts. */
+  *cache = &segment0[(key1 % APR_UINT64_C(2809637) + (key0 / 37))
+                     & (segment0->segment_count - 1)];
+  return (key0 % APR_UINT64_C(5030895599)) % segment0->group_count;
+}
+
+/* Return the index of the counter for KEY in row ROW of SKETCH.
+ */
+static APR_INLINE apr_size_t
+sketch_index(const frequency_sketch_t *sketch,
+             const entry_key_t *key,
+             int row)
+{
+  /* Short keys usually differ in FINGERPRINT[0] only.  So, spread those
+   * bits over the whole hash value before deriving the per-row hashes. */
+  apr_uint64_t hash = key->fingerprint[0] * APR_UINT64_C(0x9e3779b97f4a7c15)
+                    ^ key->fingerprint[1]
+                    ^ key->prefix_idx;
+
+  hash ^= (apr_uint64_t)row * APR_UINT64_C(0x632be59bd9b4e019);
+  hash = (hash ^ (hash >> 31)) * APR_UINT64_C(0xbf58476d1ce4e5b9);
+
+  return (apr_size_t)row * ((apr_size_t)sketch->width_mask + 1)
+       + (apr_size_t)((hash >> 32) & sketch->width_mask);
+}
+
+/* Record a request for KEY in SKETCH.  This may be called concurrently
+ * from multiple threads.
+ */
+static void
+sketch_record(frequency_sketch_t *sketch,
+              const entry_key_t *key)
+{
+  int row;
+
+  /* Unsynchronized on purpose.  See frequency_sketch_t. */
+  for (row = 0; row < SKETCH_DEPTH; ++row)
+    {
+      unsigned char *counter = &sketch->counters[sketch_index(sketch, key,
+                                                              row)];
+      if (*counter < SKETCH_MAX_COUNT)
+        ++*counter;
+    }
+
+  /* Let old requests fade out such that the sketch adapts to changing
+   * access patterns.  svn_atomic_inc returns the previous value, i.e.
+   * exactly one thread will see SAMPLE_SIZE being reached and only that
+   * one will age the counters.  Requests recorded in the meantime are
+   * kept in ADDITIONS. */
+  if (svn_atomic_inc(&sketch->additions) + 1 == sketch->sample_size)
+    {
+      apr_size_t i;
+      apr_size_t count = ((apr_size_t)sketch->width_mask + 1) * SKETCH_DEPTH;
+
+      for (i = 0; i < count; ++i)
+        sketch->counters[i] >>= 1;
+
+      apr_atomic_sub32(&sketch->additions, sketch->sample_size / 2);
+    }
+}
+
+/* Return the estimated number of recent requests for KEY in SKETCH.
+ */
+static apr_uint32_t
+sketch_estimate(const frequency_sketch_t *sketch,
+                const entry_key_t *key)
+{
+  apr_uint32_t result = SKETCH_MAX_COUNT;
+  int row;
+
+  for (row = 0; row < SKETCH_DEPTH; ++row)
+    result = MIN(result, sketch->counters[sketch_index(sketch, key, row)]);
+
+  return result;
+}
+
+/* If CACHE uses an admission filter, record a request for KEY.
+ */
+static APR_INLINE void
+record_request(svn_membuffer_t *cache,
+               const entry_key_t *key)
+{
+  if (cache->sketch)
+    sketch_record(cache->sketch, key);
+}
+
+/* Return TRUE if the admission filter of CACHE allows a new item with
+ * KEY and SIZE to be added to L1.  If the item fits into the free part of
+ * the insertion window, it is always admitted.  Otherwise, KEY must have
+ * been requested more often than the item that would be evicted next.
+ *
+ * Items too large for L1 are already subject to their priority checks.
+ */
+static svn_boolean_t
+admit_item(svn_membuffer_t *cache,
+           const entry_key_t *key,
+           apr_size_t size)
+{
+  entry_t *victim;
+
+  if (!cache->sketch || size > cache->max_entry_size)
+    return TRUE;
+
+  if (cache->l1.next == NO_INDEX)
+    {
+      /* Free space at the end of the L1 buffer? */
+      if (cache->l1.start_offset + cache->l1.size - cache->l1.current_data
+          >= size)
+        return TRUE;
+
+      /* We will wrap around and evict the first L1 entry. */
+      if (cache->l1.first == NO_INDEX)
+        return TRUE;
+
+      victim = get_entry(cache, cache->l1.first);
+    }
+  else
+    {
+      /* Free space before the next L1 entry? */
+      victim = get_entry(cache, cache->l1.next);
+      if (victim->offset - cache->l1.current_data >= size)
+        return TRUE;
+    }
+
+  return sketch_estimate(cache->sketch, key)
+       > sketch_estimate(cache->sketch, &victim->key);
+}
+
+/* Return the hash of KEY used by the size estimator.  Unlike the group
+ * index, it does not depend on the number of segments.
+ */
+static APR_INLINE apr_uint64_t
+estimator_hash(const entry_key_t *key)
+{
+  apr_uint64_t hash = key->fingerprint[0] * APR_UINT64_C(0x9e3779b97f4a7c15)
+                    ^ key->fingerprint[1]
+                    ^ key->prefix_idx;
+
+  hash = (hash ^ (hash >> 31)) * APR_UINT64_C(0xbf58476d1ce4e5b9);
+  return hash ^ (hash >> 29);
+}
+
+/* Return the index of the tag for HASH in ESTIMATOR or NO_INDEX.
+ */
+static apr_uint32_t
+find_shadow_tag(size_estimator_t *estimator,
+                apr_uint64_t hash)
+{
+  apr_uint32_t idx = estimator->buckets[(hash >> 32) & estimator->bucket_mask];
+  while (idx != NO_INDEX && estimator->tags[idx].hash != hash)
+    idx = estimator->tags[idx].chain;
+
+  return idx;
+}
+
+/* Remove tag IDX from ESTIMATOR's recency list.
+ */
+static void
+unlink_shadow_tag(size_estimator_t *estimator,
+                  apr_uint32_t idx)
+{
+  shadow_tag_t *tag = &estimator->tags[idx];
+
+  if (tag->previous == NO_INDEX)
+    estimator->first = tag->next;
+  else
+    estimator->tags[tag->previous].next = tag->next;
+
+  if (tag->next == NO_INDEX)
+    estimator->last = tag->previous;
+  else
+    estimator->tags[tag->next].previous = tag->previous;
+}
+
+/* Make tag IDX the most recently used one in ESTIMATOR.
+ */
+static void
+push_shadow_tag(size_estimator_t *estimator,
+                apr_uint32_t idx)
+{
+  shadow_tag_t *tag = &estimator->tags[idx];
+
+  tag->previous = NO_INDEX;
+  tag->next = estimator->first;
+  if (estimator->first == NO_INDEX)
+    estimator->last = idx;
+  else
+    estimator->tags[estimator->first].previous = idx;
+
+  estimator->first = idx;
+}
+
+/* Add a most recently used tag for HASH to ESTIMATOR, recycling the least
+ * recently used one if all are in use.  Return its index.
+ */
+static apr_uint32_t
+add_shadow_tag(size_estimator_t *estimator,
+               apr_uint64_t hash)
+{
+  apr_uint32_t idx;
+  apr_uint32_t *bucket;
+
+  if (estimator->count < estimator->capacity)
+    {
+      idx = estimator->count++;
+    }
+  else
+    {
+      /* Its next request will be counted as a miss at all sizes, which is
+       * correct as long as the tags cover the largest size. */
+      idx = estimator->last;
+      unlink_shadow_tag(estimator, idx);
+
+      bucket = &estimator->buckets[(estimator->tags[idx].hash >> 32)
+                                   & estimator->bucket_mask];
+      while (*bucket != idx)
+        bucket = &estimator->tags[*bucket].chain;
+      *bucket = estimator->tags[idx].chain;
+    }
+
+  bucket = &estimator->buckets[(hash >> 32) & estimator->bucket_mask];
+  estimator->tags[idx].hash = hash;
+  estimator->tags[idx].size = 0;
+  estimator->tags[idx].chain = *bucket;
+  *bucket = idx;
+
+  push_shadow_tag(estimator, idx);
+  return idx;
+}
+
+/* Record a request for the sampled key with HASH in ESTIMATOR.
+ */
+static svn_error_t *
+estimate_request(size_estimator_t *estimator,
+                 apr_uint64_t hash)
+{
+  apr_uint32_t idx = find_shadow_tag(estimator, hash);
+  int i;
+
+  if (idx == NO_INDEX)
+    {
+      add_shadow_tag(estimator, hash);
+    }
+  else
+    {
+      /* The sampled data requested since the last request of this key
+       * plus the item itself must fit into the cache. */
+      apr_uint64_t distance = estimator->tags[idx].size;
+      apr_uint32_t k;
+
+      for (k = estimator->first; k != idx; k = estimator->tags[k].next)
+        distance += estimator->tags[k].size;
+
+      distance = distance * ESTIMATOR_SAMPLE_RANGE / estimator->threshold;
+      for (i = 0; i < SVN_CACHE__SIZE_ESTIMATES; ++i)
+        if (distance <= estimator->sizes[i])
+          estimator->hits[i]++;
+
+      unlink_shadow_tag(estimator, idx);
+      push_shadow_tag(estimator, idx);
+    }
+
+  if (++estimator->requests >= ESTIMATOR_AGING_PERIOD)
+    {
+      estimator->requests /= 2;
+      for (i = 0; i < SVN_CACHE__SIZE_ESTIMATES; ++i)
+        estimator->hits[i] /= 2;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Record that the sampled key with HASH got an item of SIZE bytes
+ * in ESTIMATOR.
+ */
+static svn_error_t *
+estimate_write(size_estimator_t *estimator,
+               apr_uint64_t hash,
+               apr_size_t size)
+{
+  apr_uint32_t idx = find_shadow_tag(estimator, hash);
+  if (idx == NO_INDEX)
+    idx = add_shadow_tag(estimator, hash);
+
+  estimator->tags[idx].size = (apr_uint32_t)MIN(size, APR_UINT32_MAX);
+  return SVN_NO_ERROR;
+}
+
+/* If CACHE estimates hit ratios at other sizes and KEY is sampled,
+ * record a request for KEY.
+ */
+static APR_INLINE svn_error_t *
+sample_request(svn_membuffer_t *cache,
+               const entry_key_t *key)
+{
+  size_estimator_t *estimator = cache->estimator;
+  apr_uint64_t hash;
+
+  if (!estimator)
+    return SVN_NO_ERROR;
+
+  hash = estimator_hash(key);
+  if ((hash & (ESTIMATOR_SAMPLE_RANGE - 1)) >= estimator->threshold)
+    return SVN_NO_ERROR;
+
+  SVN_MUTEX__WITH_LOCK(estimator->mutex, estimate_request(estimator, hash));
+  return SVN_NO_ERROR;
+}
+
+/* If CACHE estimates hit ratios at other sizes and KEY is sampled,
+ * record that KEY got an item of SIZE bytes.
+ */
+static APR_INLINE svn_error_t *
+sample_write(svn_membuffer_t *cache,
+             const entry_key_t *key,
+             apr_size_t size)
+{
+  size_estimator_t *estimator = cache->estimator;
+  apr_uint64_t hash;
+
+  if (!estimator)
+    return SVN_NO_ERROR;
+
+  hash = estimator_hash(key);
+  if ((hash & (ESTIMATOR_SAMPLE_RANGE - 1)) >= estimator->threshold)
+    return SVN_NO_ERROR;
+
+  SVN_MUTEX__WITH_LOCK(estimator->mutex,
+                       estimate_write(estimator, hash, size));
+  return SVN_NO_ERROR;
+}
 
-  /* The current insertion position must never point outside our
-   * data buffer.
-   */
-  assert(level->current_data <= level->start_offset + level->size);
+/* Copy the estimates from ESTIMATOR to INFO.
+ */
+static svn_error_t *
+get_size_estimates(size_estimator_t *estimator,
+                   svn_cache__info_t *info)
+{
+  int i;
+
+  for (i = 0; i < SVN_CACHE__SIZE_ESTIMATES; ++i)
+    {
+      info->estimate_sizes[i] = estimator->sizes[i];
+      info->estimated_hit_ratios[i]
+        = estimator->requests
+        ? (double)estimator->hits[i] / (double)estimator->requests
+        : 0.0;
+    }
+
+  return SVN_NO_ERROR;
 }
 
-/* Map a KEY of 16 bytes to the CACHE and group that shall contain the
- * respective item.
+/* If CACHE estimates hit ratios at other sizes, add them to INFO.
  */
-static apr_uint32_t
-get_group_index(svn_membuffer_t **cache,
-                const entry_key_t *key)
+static svn_error_t *
+add_size_estimates(svn_membuffer_t *cache,
+                   svn_cache__info_t *info)
 {
-  svn_membuffer_t *segment0 = *cache;
-  apr_uint64_t key0 = key->fingerprint[0];
-  apr_uint64_t key1 = key->fingerprint[1];
+  if (cache->estimator)
+    SVN_MUTEX__WITH_LOCK(cache->estimator->mutex,
+                         get_size_estimates(cache->estimator, info));
 
-  /* select the cache segment to use. they have all the same group_count.
-   * Since key may not be well-distributed, pre-fold it to a smaller but
-   * "denser" ranger.  The modulus is a prime larger than the largest
-   * counts. */
-  *cache = &segment0[(key1 % APR_UINT64_C(2809637) + (key0 / 37))
-                     & (segment0->segment_count - 1)];
-  return (key0 % APR_UINT64_C(5030895599)) % segment0->group_count;
+  return SVN_NO_ERROR;
 }
 
 /* Reduce the hit count of ENTRY and update the accumulated hit info
@@ -1353,11 +2128,12 @@ get_group_index(svn_membuffer_t **cache,
 static APR_INLINE void
 let_entry_age(svn_membuffer_t *cache, entry_t *entry)
 {
-  apr_uint32_t hits_removed = (entry->hit_count + 1) >> 1;
+  apr_uint32_t hits_removed = (svn_atomic_read(&entry->hit_count) + 1) >> 1;
 
   if (hits_removed)
     {
-      entry->hit_count -= hits_removed;
+      /* Lock-free readers may increment the counter concurrently. */
+      apr_atomic_sub32(&entry->hit_count, hits_removed);
     }
   else
     {
@@ -1832,17 +2608,62 @@ ensure_data_insertable_l1(svn_membuffer_t *cache, apr_size_t size)
    * right answer. */
 }
 
-svn_error_t *
-svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
-                                  apr_size_t total_size,
-                                  apr_size_t directory_size,
-                                  apr_size_t segment_count,
-                                  svn_boolean_t thread_safe,
-                                  svn_boolean_t allow_blocking_writes,
-                                  apr_pool_t *pool)
+/* Return the number of counters per row that the admission filter
+ * should use for cache segments with GROUP_COUNT entry groups.
+ */
+static apr_uint32_t
+get_sketch_width(apr_uint32_t group_count)
+{
+  /* Use about one counter per entry and row. */
+  apr_uint64_t entry_count = (apr_uint64_t)group_count * GROUP_SIZE;
+  apr_uint32_t width = 1;
+  while (width < entry_count && width < (apr_uint32_t)0x80000000)
+    width *= 2;
+
+  return width;
+}
+
+/* Create the anonymous shared memory region *SHM with at least SIZE bytes.
+ * Allocate the APR structures in POOL.
+ */
+static svn_error_t *
+create_shm(membuffer_shm_t **shm,
+           apr_size_t size,
+           apr_pool_t *pool)
+{
+  membuffer_shm_t *result = apr_pcalloc(pool, sizeof(*result));
+  apr_status_t status = apr_shm_create(&result->shm, size, NULL, pool);
+  if (status)
+    return svn_error_wrap_apr(status,
+                              _("Can't create shared memory for the cache"));
+
+  result->base = apr_shm_baseaddr_get(result->shm);
+  result->size = apr_shm_size_get(result->shm);
+  result->used = 0;
+
+  *shm = result;
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_cache__membuffer_cache_create() and
+ * svn_cache__membuffer_cache_create_shared().  If SHARED is set, allocate
+ * everything but the APR lock objects in anonymous shared memory and make
+ * room for the admission filter if ADMISSION_FILTER is set.
+ */
+static svn_error_t *
+membuffer_cache_create(svn_membuffer_t **cache,
+                       apr_size_t total_size,
+                       apr_size_t directory_size,
+                       apr_size_t segment_count,
+                       svn_boolean_t thread_safe,
+                       svn_boolean_t allow_blocking_writes,
+                       svn_boolean_t shared,
+                       svn_boolean_t admission_filter,
+                       apr_pool_t *pool)
 {
   svn_membuffer_t *c;
   prefix_pool_t *prefix_pool;
+  membuffer_shm_t *shm = NULL;
 
   apr_uint32_t seg;
   apr_uint32_t group_count;
@@ -1854,9 +2675,8 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
 
   /* Allocate 1% of the cache capacity to the prefix string pool.
    */
-  SVN_ERR(prefix_pool_create(&prefix_pool, total_size / 100, thread_safe,
-                             pool));
-  total_size -= total_size / 100;
+  apr_size_t prefix_pool_size = total_size / 100;
+  total_size -= prefix_pool_size;
 
   /* Limit the total size (only relevant if we can address > 4GB)
    */
@@ -1910,9 +2730,6 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
          && segment_count < MAX_SEGMENT_COUNT)
     segment_count *= 2;
 
-  /* allocate cache as an array of segments / cache objects */
-  c = apr_palloc(pool, segment_count * sizeof(*c));
-
   /* Split total cache size into segments of equal size
    */
   total_size /= segment_count;
@@ -1963,6 +2780,45 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
   assert(spare_group_count > 0 && main_group_count > 0);
 
   group_init_size = 1 + group_count / (8 * GROUP_INIT_GRANULARITY);
+
+  /* A shared cache gets allocated in one go.  Sum up the (aligned) sizes
+   * of all the structures allocated below.
+   */
+  if (shared)
+    {
+      apr_uint64_t segment_size
+        = APR_ALIGN(sizeof(*c), ITEM_ALIGNMENT)
+        + APR_ALIGN((apr_uint64_t)group_count * sizeof(entry_group_t),
+                    ITEM_ALIGNMENT)
+        + APR_ALIGN(group_init_size, ITEM_ALIGNMENT)
+        + ALIGN_VALUE(data_size);
+      apr_uint64_t shm_size;
+
+      if (admission_filter)
+        segment_size += APR_ALIGN(sizeof(frequency_sketch_t), ITEM_ALIGNMENT)
+                      + APR_ALIGN((apr_uint64_t)get_sketch_width(
+                                                  main_group_count)
+                                    * SKETCH_DEPTH,
+                                  ITEM_ALIGNMENT);
+
+      shm_size = segment_count * segment_size
+               + APR_ALIGN(sizeof(*prefix_pool), ITEM_ALIGNMENT)
+               + APR_ALIGN(prefix_pool_size, ITEM_ALIGNMENT)
+               + 2 * ITEM_ALIGNMENT; /* prefix values & strings alignment */
+      if (shm_size > APR_SIZE_MAX)
+        return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
+      SVN_ERR(create_shm(&shm, (apr_size_t)shm_size, pool));
+    }
+
+  SVN_ERR(prefix_pool_create(&prefix_pool, prefix_pool_size, thread_safe,
+                             shm, pool));
+
+  /* allocate cache as an array of segments / cache objects */
+  c = membuffer_alloc(pool, shm, segment_count * sizeof(*c), FALSE);
+  if (c == NULL)
+    return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
   for (seg = 0; seg < segment_count; ++seg)
     {
       /* allocate buffers and initialize cache members
@@ -1978,12 +2834,14 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       /* Allocate but don't clear / zero the directory because it would add
          significantly to the server start-up time if the caches are large.
          Group initialization will take care of that in stead. */
-      c[seg].directory = apr_palloc(pool,
-                                    group_count * sizeof(entry_group_t));
+      c[seg].directory = membuffer_alloc(pool, shm,
+                                         group_count * sizeof(entry_group_t),
+                                         FALSE);
 
       /* Allocate and initialize directory entries as "not initialized",
          hence "unused" */
-      c[seg].group_initialized = apr_pcalloc(pool, group_init_size);
+      c[seg].group_initialized = membuffer_alloc(pool, shm, group_init_size,
+                                                 TRUE);
 
       /* Allocate 1/4th of the data buffer to L1
        */
@@ -2004,7 +2862,9 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       c[seg].l2.current_data = c[seg].l2.start_offset;
 
       /* This cast is safe because DATA_SIZE <= MAX_SEGMENT_SIZE. */
-      c[seg].data = apr_palloc(pool, (apr_size_t)ALIGN_VALUE(data_size));
+      c[seg].data = membuffer_alloc(pool, shm,
+                                    (apr_size_t)ALIGN_VALUE(data_size),
+                                    FALSE);
       c[seg].data_used = 0;
       c[seg].max_entry_size = max_entry_size;
 
@@ -2012,11 +2872,17 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
       c[seg].total_reads = 0;
       c[seg].total_writes = 0;
       c[seg].total_hits = 0;
+      c[seg].admission_rejects = 0;
+      c[seg].sketch = NULL;
+      c[seg].estimator = NULL;
+      c[seg].shm = shm;
 
       /* were allocations successful?
        * If not, initialize a minimal cache structure.
        */
-      if (c[seg].data == NULL || c[seg].directory == NULL)
+      if (   c[seg].data == NULL
+          || c[seg].directory == NULL
+          || c[seg].group_initialized == NULL)
         {
           /* We are OOM. There is no need to proceed with "half a cache".
            */
@@ -2044,13 +2910,156 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
        */
       c[seg].allow_blocking_writes = allow_blocking_writes;
 #endif
+
+#if SUPPORT_SHARED_MEMORY
+      /* Shared caches use a cross-process lock in stead. */
+      c[seg].shared_lock = NULL;
+      if (shm)
+        {
+          apr_status_t status
+            = apr_global_mutex_create(&c[seg].shared_lock, NULL,
+                                      SHARED_LOCK_MECHANISM, pool);
+          if (status)
+            return svn_error_wrap_apr(status, _("Can't create cache mutex"));
+        }
+#endif
+
       /* No writers at the moment. */
       c[seg].write_lock_count = 0;
+      c[seg].write_sequence = 0;
     }
 
   /* done here
    */
   *cache = c;
+
+  if (admission_filter)
+    SVN_ERR(svn_cache__membuffer_enable_admission_filter(c, pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
+                                  apr_size_t total_size,
+                                  apr_size_t directory_size,
+                                  apr_size_t segment_count,
+                                  svn_boolean_t thread_safe,
+                                  svn_boolean_t allow_blocking_writes,
+                                  apr_pool_t *pool)
+{
+  return svn_error_trace(membuffer_cache_create(cache, total_size,
+                                                directory_size,
+                                                segment_count,
+                                                thread_safe,
+                                                allow_blocking_writes,
+                                                FALSE, FALSE, pool));
+}
+
+svn_error_t *
+svn_cache__membuffer_cache_create_shared(svn_membuffer_t **cache,
+                                         apr_size_t total_size,
+                                         apr_size_t directory_size,
+                                         apr_size_t segment_count,
+                                         svn_boolean_t admission_filter,
+                                         apr_pool_t *pool)
+{
+#if SUPPORT_SHARED_MEMORY
+  return svn_error_trace(membuffer_cache_create(cache, total_size,
+                                                directory_size,
+                                                segment_count,
+                                                FALSE, TRUE, TRUE,
+                                                admission_filter, pool));
+#else
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Caches shared between processes are not "
+                            "supported on this platform"));
+#endif
+}
+
+svn_error_t *
+svn_cache__membuffer_enable_admission_filter(svn_membuffer_t *cache,
+                                             apr_pool_t *result_pool)
+{
+  apr_uint32_t seg;
+  apr_uint32_t width = get_sketch_width(cache->group_count);
+
+  for (seg = 0; seg < cache->segment_count; ++seg)
+    {
+      frequency_sketch_t *sketch = membuffer_alloc(result_pool, cache->shm,
+                                                   sizeof(*sketch), TRUE);
+      if (sketch)
+        sketch->counters = membuffer_alloc(result_pool, cache->shm,
+                                           (apr_size_t)width * SKETCH_DEPTH,
+                                           TRUE);
+
+      /* The pool may have been created without an abort function. */
+      if (sketch == NULL || sketch->counters == NULL)
+        return svn_error_wrap_apr(APR_ENOMEM, "OOM");
+
+      /* Age the counters after about 10 requests per entry. */
+      sketch->width_mask = width - 1;
+      sketch->sample_size = width <= APR_UINT32_MAX / 10
+                          ? width * 10
+                          : APR_UINT32_MAX;
+
+      cache[seg].sketch = sketch;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cache__membuffer_enable_size_estimates(svn_membuffer_t *cache,
+                                           apr_pool_t *result_pool)
+{
+  size_estimator_t *estimator;
+  apr_uint64_t total_entries
+    = (apr_uint64_t)cache->group_count * GROUP_SIZE * cache->segment_count;
+  apr_uint64_t data_size
+    = (cache->l1.size + cache->l2.size) * cache->segment_count;
+  apr_uint64_t threshold;
+  apr_uint32_t bucket_count;
+  apr_uint32_t seg;
+  int i;
+
+  if (cache->shm)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            _("Size estimates are not supported for "
+                              "caches shared between processes"));
+
+  estimator = apr_pcalloc(result_pool, sizeof(*estimator));
+  SVN_ERR(svn_mutex__init(&estimator->mutex, TRUE, result_pool));
+
+  /* The largest size we estimate for is 8 times the current one.  Sample
+   * such that the tags will cover about as many items. */
+  estimator->capacity = (apr_uint32_t)MIN(ESTIMATOR_MAX_TAGS,
+                                          MAX(total_entries / 8, 64));
+  threshold = (apr_uint64_t)ESTIMATOR_SAMPLE_RANGE * estimator->capacity
+            / (8 * total_entries);
+  estimator->threshold
+    = (apr_uint32_t)MAX(1, MIN(threshold, ESTIMATOR_SAMPLE_RANGE));
+
+  bucket_count = 1;
+  while (bucket_count < estimator->capacity)
+    bucket_count *= 2;
+
+  estimator->tags = apr_palloc(result_pool,
+                               estimator->capacity * sizeof(shadow_tag_t));
+  estimator->buckets = apr_palloc(result_pool,
+                                  bucket_count * sizeof(apr_uint32_t));
+  estimator->bucket_mask = bucket_count - 1;
+  memset(estimator->buckets, 0xff, bucket_count * sizeof(apr_uint32_t));
+  estimator->first = NO_INDEX;
+  estimator->last = NO_INDEX;
+
+  /* Sizes from 1/8th to 8 times the current data size. */
+  for (i = 0; i < SVN_CACHE__SIZE_ESTIMATES; ++i)
+    estimator->sizes[i] = (data_size << i) / 8;
+
+  for (seg = 0; seg < cache->segment_count; ++seg)
+    cache[seg].estimator = estimator;
+
   return SVN_NO_ERROR;
 }
 
@@ -2078,6 +3087,7 @@ svn_cache__membuffer_clear(svn_membuffer_t *cache)
     {
       /* Unconditionally acquire the write lock. */
       SVN_ERR(force_write_lock_cache(&cache[seg]));
+      start_write(&cache[seg]);
 
       /* Mark all groups as "not initialized", which implies "empty". */
       cache[seg].first_spare_group = NO_INDEX;
@@ -2102,7 +3112,8 @@ svn_cache__membuffer_clear(svn_membuffer_t *cache)
       cache[seg].used_entries = 0;
 
       /* Segment may be used again. */
-      SVN_ERR(unlock_cache(&cache[seg], SVN_NO_ERROR));
+      SVN_ERR(unlock_cache(&cache[seg],
+                           finish_write(&cache[seg], SVN_NO_ERROR)));
     }
 
   /* done here */
@@ -2219,6 +3230,13 @@ membuffer_cache_set_internal(svn_membuffer_t *cache,
       buffer = NULL;
     }
 
+  /* Don't let new, rarely requested items replace more popular ones. */
+  if (!entry && buffer && !admit_item(cache, &to_find->entry_key, size))
+    {
+      cache->admission_rejects++;
+      buffer = NULL;
+    }
+
   /* if there is an old version of that entry and the new data fits into
    * the old spot, just re-use that space. */
   if (entry && buffer && ALIGN_VALUE(entry->size) >= size)
@@ -2341,6 +3359,8 @@ membuffer_cache_set(svn_membuffer_t *cache,
   if (item)
     SVN_ERR(serializer(&buffer, &size, item, scratch_pool));
 
+  SVN_ERR(sample_write(cache, &key->entry_key, size));
+
   /* The actual cache data access needs to sync'ed
    */
   WITH_WRITE_LOCK(cache,
@@ -2355,6 +3375,20 @@ membuffer_cache_set(svn_membuffer_t *cache,
   return SVN_NO_ERROR;
 }
 
+/* Increment the statistics COUNTER of some cache segment.  Lock-free
+ * readers update these counters concurrently with other readers and with
+ * writers.  With older APR versions, some of these updates may get lost.
+ */
+static APR_INLINE void
+increment_stat(apr_uint64_t *counter)
+{
+#if APR_VERSION_AT_LEAST(1,7,0)
+  apr_atomic_inc64(counter);
+#else
+  ++*counter;
+#endif
+}
+
 /* Count a hit in ENTRY within CACHE.
  */
 static void
@@ -2367,9 +3401,191 @@ increment_hit_counters(svn_membuffer_t *cache, entry_t *entry)
   svn_atomic_inc(&entry->hit_count);
 
   /* That one is for stats only. */
-  cache->total_hits++;
+  increment_stat(&cache->total_hits);
+}
+
+#if USE_OPTIMISTIC_READS
+
+/* Read the value of VAR exactly once, i.e. prevent the compiler from
+ * re-reading it later.  TYPE must be the type of VAR.
+ */
+#define READ_ONCE(type, var) (*(const volatile type *)&(var))
+
+/* Lock-free variant of find_entry(CACHE, GROUP_INDEX, TO_FIND, FALSE).
+ *
+ * Writers may modify CACHE while we look for the entry.  Therefore, all
+ * indexes, sizes and offsets read from the directory get validated before
+ * use, i.e. we never access memory outside the CACHE's buffers.  The result
+ * is only valid if CACHE->WRITE_SEQUENCE did not change in the meantime.
+ */
+static entry_t *
+find_entry_optimistic(svn_membuffer_t *cache,
+                      apr_uint32_t group_index,
+                      const full_key_t *to_find)
+{
+  apr_uint32_t total_groups = cache->group_count + cache->spare_group_count;
+  apr_uint64_t data_size = cache->l2.start_offset + cache->l2.size;
+  apr_size_t key_len = to_find->entry_key.key_len;
+  entry_group_t *group = &cache->directory[group_index];
+  apr_uint32_t chain_length;
+
+  if (! is_group_initialized(cache, group_index))
+    return NULL;
+
+  for (chain_length = 0;
+       chain_length < MAX_GROUP_CHAIN_LENGTH;
+       ++chain_length)
+    {
+      apr_uint32_t used = READ_ONCE(apr_uint32_t, group->header.used);
+      apr_uint32_t next = READ_ONCE(apr_uint32_t, group->header.next);
+      apr_uint32_t i;
+
+      if (used > GROUP_SIZE)
+        return NULL;
+
+      for (i = 0; i < used; ++i)
+        if (entry_keys_match(&group->entries[i].key, &to_find->entry_key))
+          {
+            entry_t *entry = &group->entries[i];
+            apr_uint64_t offset;
+
+            /* Short keys are fully defined by the entry key. */
+            if (!key_len)
+              return entry;
+
+            /* Compare the full key.  Key conflicts mean "not cached". */
+            offset = READ_ONCE(apr_uint64_t, entry->offset);
+            if (offset > data_size || data_size - offset < key_len)
+              return NULL;
+
+            return memcmp(to_find->full_key.data, cache->data + offset,
+                          key_len) == 0
+                 ? entry
+                 : NULL;
+          }
+
+      /* end of chain? */
+      if (next == NO_INDEX || next >= total_groups)
+        break;
+
+      group = &cache->directory[next];
+    }
+
+  return NULL;
+}
+
+/* Try to do what membuffer_cache_get_internal does but without holding
+ * any lock on CACHE.  Return TRUE if that succeeded, i.e. *BUFFER and
+ * *ITEM_SIZE have been set.  If CACHE got modified during the lookup,
+ * return FALSE and leave the outputs undefined; the caller should then
+ * retry with a read lock.
+ *
+ * Hits are still being counted.  We only do that after validating the
+ * lookup against CACHE->WRITE_SEQUENCE and all counters involved are
+ * updated atomically, by readers as well as by writers.  A writer may
+ * still have started to reuse or move ENTRY's slot right after the
+ * validation.  The hit may then be credited to a different entry or get
+ * lost.  That only affects the eviction order, never memory safety, and
+ * is cheaper than skipping the hit accounting for most lookups.
+ */
+static svn_boolean_t
+optimistic_cache_get(svn_membuffer_t *cache,
+                     apr_uint32_t group_index,
+                     const full_key_t *to_find,
+                     char **buffer,
+                     apr_size_t *item_size,
+                     apr_pool_t *result_pool)
+{
+  apr_uint64_t data_size = cache->l2.start_offset + cache->l2.size;
+  apr_size_t key_len = to_find->entry_key.key_len;
+  apr_size_t size = 0;
+  apr_uint32_t sequence = cache->write_sequence;
+  entry_t *entry;
+
+  /* Modification in progress? */
+  if (sequence & 1)
+    return FALSE;
+
+  MEMORY_BARRIER();
+
+  *buffer = NULL;
+  entry = find_entry_optimistic(cache, group_index, to_find);
+  if (entry)
+    {
+      apr_uint64_t offset = READ_ONCE(apr_uint64_t, entry->offset);
+      apr_size_t aligned_size;
+      size = READ_ONCE(apr_size_t, entry->size);
+
+      /* Sanity checks that protect us from reading inconsistent data. */
+      if (size > MAX_ITEM_SIZE || size < key_len)
+        return FALSE;
+
+      aligned_size = ALIGN_VALUE(size);
+      if (offset > data_size || data_size - offset < aligned_size)
+        return FALSE;
+
+      *buffer = apr_palloc(result_pool, aligned_size - key_len);
+      memcpy(*buffer, cache->data + offset + key_len,
+             aligned_size - key_len);
+    }
+
+  MEMORY_BARRIER();
+
+  /* Has there been any concurrent modification? */
+  if (cache->write_sequence != sequence)
+    return FALSE;
+
+  increment_stat(&cache->total_reads);
+  if (entry)
+    increment_hit_counters(cache, entry);
+
+  *item_size = entry ? size - key_len : 0;
+  return TRUE;
+}
+
+/* Try to do what membuffer_cache_has_key_internal does but without holding
+ * any lock on CACHE.  Return TRUE if that succeeded, i.e. *FOUND has been
+ * set.  Return FALSE if CACHE got modified during the lookup.
+ *
+ * Hits get counted the same way as in optimistic_cache_get.
+ */
+static svn_boolean_t
+optimistic_cache_has_key(svn_membuffer_t *cache,
+                         apr_uint32_t group_index,
+                         const full_key_t *to_find,
+                         svn_boolean_t *found)
+{
+  apr_uint32_t sequence = cache->write_sequence;
+  entry_t *entry;
+
+  /* Modification in progress? */
+  if (sequence & 1)
+    return FALSE;
+
+  MEMORY_BARRIER();
+  entry = find_entry_optimistic(cache, group_index, to_find);
+  MEMORY_BARRIER();
+
+  /* Has there been any concurrent modification? */
+  if (cache->write_sequence != sequence)
+    return FALSE;
+
+  if (entry)
+    increment_hit_counters(cache, entry);
+
+  *found = entry != NULL;
+  return TRUE;
 }
 
+#else
+
+/* Lock-free lookups are not supported.  Always use the locked path. */
+#define optimistic_cache_get(cache, group_index, to_find, buffer, \
+                             item_size, result_pool) FALSE
+#define optimistic_cache_has_key(cache, group_index, to_find, found) FALSE
+
+#endif
+
 /* Look for the cache entry in group GROUP_INDEX of CACHE, identified
  * by the hash value TO_FIND. If no item has been stored for KEY,
  * *BUFFER will be NULL. Otherwise, return a copy of the serialized
@@ -2394,7 +3610,7 @@ membuffer_cache_get_internal(svn_membuffer_t *cache,
   /* The actual cache data access needs to sync'ed
    */
   entry = find_entry(cache, group_index, to_find, FALSE);
-  cache->total_reads++;
+  increment_stat(&cache->total_reads);
   if (entry == NULL)
     {
       /* no such entry found.
@@ -2453,14 +3669,19 @@ membuffer_cache_get(svn_membuffer_t *cache,
   /* find the entry group that will hold the key.
    */
   group_index = get_group_index(&cache, &key->entry_key);
-  WITH_READ_LOCK(cache,
-                 membuffer_cache_get_internal(cache,
-                                              group_index,
-                                              key,
-                                              &buffer,
-                                              &size,
-                                              DEBUG_CACHE_MEMBUFFER_TAG
-                                              result_pool));
+  record_request(cache, &key->entry_key);
+  SVN_ERR(sample_request(cache, &key->entry_key));
+
+  if (!optimistic_cache_get(cache, group_index, key, &buffer, &size,
+                            result_pool))
+    WITH_READ_LOCK(cache,
+                   membuffer_cache_get_internal(cache,
+                                                group_index,
+                                                key,
+                                                &buffer,
+                                                &size,
+                                                DEBUG_CACHE_MEMBUFFER_TAG
+                                                result_pool));
 
   /* re-construct the original data object from its serialized form.
    */
@@ -2515,13 +3736,15 @@ membuffer_cache_has_key(svn_membuffer_t *cache,
   /* find the entry group that will hold the key.
    */
   apr_uint32_t group_index = get_group_index(&cache, &key->entry_key);
-  cache->total_reads++;
+  increment_stat(&cache->total_reads);
+  record_request(cache, &key->entry_key);
 
-  WITH_READ_LOCK(cache,
-                 membuffer_cache_has_key_internal(cache,
-                                                  group_index,
-                                                  key,
-                                                  found));
+  if (!optimistic_cache_has_key(cache, group_index, key, found))
+    WITH_READ_LOCK(cache,
+                   membuffer_cache_has_key_internal(cache,
+                                                    group_index,
+                                                    key,
+                                                    found));
 
   return SVN_NO_ERROR;
 }
@@ -2549,7 +3772,7 @@ membuffer_cache_get_partial_internal(svn_membuffer_t *cache,
                                      apr_pool_t *result_pool)
 {
   entry_t *entry = find_entry(cache, group_index, to_find, FALSE);
-  cache->total_reads++;
+  increment_stat(&cache->total_reads);
   if (entry == NULL)
     {
       *item = NULL;
@@ -2600,6 +3823,8 @@ membuffer_cache_get_partial(svn_membuffer_t *cache,
                             apr_pool_t *result_pool)
 {
   apr_uint32_t group_index = get_group_index(&cache, &key->entry_key);
+  record_request(cache, &key->entry_key);
+  SVN_ERR(sample_request(cache, &key->entry_key));
 
   WITH_READ_LOCK(cache,
                  membuffer_cache_get_partial_internal
@@ -2632,7 +3857,7 @@ membuffer_cache_set_partial_internal(svn_membuffer_t *cache,
   /* cache item lookup
    */
   entry_t *entry = find_entry(cache, group_index, to_find, FALSE);
-  cache->total_reads++;
+  increment_stat(&cache->total_reads);
 
   /* this function is a no-op if the item is not in cache
    */
@@ -2858,24 +4083,19 @@ combine_long_key(svn_membuffer_cache_t *cache,
     ^= cache->prefix.fingerprint[1];
 }
 
-/* Basically calculate a hash value for KEY of length KEY_LEN, combine it
- * with the CACHE->PREFIX and write the result in CACHE->COMBINED_KEY.
+/* For caches with a shared prefix, i.e. CACHE->PREFIX.PREFIX_IDX is not
+ * NO_INDEX, combine KEY of length KEY_LEN with the CACHE->PREFIX and write
+ * the result to *COMBINED_KEY.  This does not modify CACHE.
  */
 static void
-combine_key(svn_membuffer_cache_t *cache,
-            const void *key,
-            apr_ssize_t key_len)
+combine_short_key(full_key_t *combined_key,
+                  const svn_membuffer_cache_t *cache,
+                  const void *key,
+                  apr_ssize_t key_len)
 {
   /* copy of *key, padded with 0 */
   apr_uint64_t data[2];
 
-  /* Do we have to compare full keys? */
-  if (cache->prefix.prefix_idx == NO_INDEX)
-    {
-      combine_long_key(cache, key, key_len);
-      return;
-    }
-
   /* short, fixed-size keys are the most common case */
   if (key_len == 16)
     {
@@ -2911,12 +4131,27 @@ combine_key(svn_membuffer_cache_t *cache,
    * knowing entry_key.prefix_id, we can still reconstruct KEY (and the
    * prefix key).
    */
-  cache->combined_key.entry_key.fingerprint[0]
+  combined_key->entry_key.fingerprint[0]
     = data[0] ^ cache->prefix.fingerprint[0];
-  cache->combined_key.entry_key.fingerprint[1]
+  combined_key->entry_key.fingerprint[1]
     = data[1] ^ cache->prefix.fingerprint[1];
 }
 
+/* Basically calculate a hash value for KEY of length KEY_LEN, combine it
+ * with the CACHE->PREFIX and write the result in CACHE->COMBINED_KEY.
+ */
+static void
+combine_key(svn_membuffer_cache_t *cache,
+            const void *key,
+            apr_ssize_t key_len)
+{
+  /* Do we have to compare full keys? */
+  if (cache->prefix.prefix_idx == NO_INDEX)
+    combine_long_key(cache, key, key_len);
+  else
+    combine_short_key(&cache->combined_key, cache, key, key_len);
+}
+
 /* Implement svn_cache__vtable_t.get (not thread-safe)
  */
 static svn_error_t *
@@ -3131,6 +4366,7 @@ svn_membuffer_get_segment_info(svn_membuffer_t *segment,
 
   info->used_entries += segment->used_entries;
   info->total_entries += segment->group_count * GROUP_SIZE;
+  info->admission_rejects += segment->admission_rejects;
 
   if (include_histogram)
     for (i = 0; i < segment->group_count; ++i)
@@ -3172,6 +4408,8 @@ svn_membuffer_cache_get_info(void *cache_void,
                      svn_membuffer_get_segment_info(segment, info, FALSE));
     }
 
+  SVN_ERR(add_size_estimates(cache->membuffer, info));
+
   return SVN_NO_ERROR;
 }
 
@@ -3199,6 +4437,28 @@ svn_membuffer_cache_get_synced(void **value_p,
                                apr_pool_t *result_pool)
 {
   svn_membuffer_cache_t *cache = cache_void;
+
+  /* Short keys can be combined on the stack.  Constructing the full key
+   * is then the only access to CACHE and we don't need to serialize. */
+  if (key && cache->prefix.prefix_idx != NO_INDEX)
+    {
+      full_key_t combined_key;
+      DEBUG_CACHE_MEMBUFFER_INIT_TAG(result_pool)
+
+      combined_key.entry_key.prefix_idx = cache->prefix.prefix_idx;
+      combined_key.entry_key.key_len = 0;
+      combine_short_key(&combined_key, cache, key, cache->key_len);
+      SVN_ERR(membuffer_cache_get(cache->membuffer,
+                                  &combined_key,
+                                  value_p,
+                                  cache->deserializer,
+                                  DEBUG_CACHE_MEMBUFFER_TAG
+                                  result_pool));
+      *found = *value_p != NULL;
+
+      return SVN_NO_ERROR;
+    }
+
   SVN_MUTEX__WITH_LOCK(cache->mutex,
                        svn_membuffer_cache_get(value_p,
                                                found,
@@ -3218,6 +4478,20 @@ svn_membuffer_cache_has_key_synced(svn_boolean_t *found,
                                    apr_pool_t *result_pool)
 {
   svn_membuffer_cache_t *cache = cache_void;
+
+  /* Same lock-free shortcut as in svn_membuffer_cache_get_synced. */
+  if (key && cache->prefix.prefix_idx != NO_INDEX)
+    {
+      full_key_t combined_key;
+
+      combined_key.entry_key.prefix_idx = cache->prefix.prefix_idx;
+      combined_key.entry_key.key_len = 0;
+      combine_short_key(&combined_key, cache, key, cache->key_len);
+      return svn_error_trace(membuffer_cache_has_key(cache->membuffer,
+                                                     &combined_key,
+                                                     found));
+    }
+
   SVN_MUTEX__WITH_LOCK(cache->mutex,
                        svn_membuffer_cache_has_key(found,
                                                    cache_void,
@@ -3476,5 +4750,33 @@ svn_cache__membuffer_get_global_info(apr_pool_t *pool)
     svn_error_clear(svn_membuffer_get_global_segment_info(membuffer + i,
                                                           info));
 
+  svn_error_clear(add_size_estimates(membuffer, info));
+
   return info;
 }
+
+apr_array_header_t *
+svn_cache__membuffer_get_global_segment_infos(apr_pool_t *pool)
+{
+  apr_uint32_t i;
+
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+  apr_array_header_t *infos;
+
+  if (!membuffer)
+    return apr_array_make(pool, 0, sizeof(svn_cache__info_t *));
+
+  infos = apr_array_make(pool, membuffer->segment_count,
+                         sizeof(svn_cache__info_t *));
+  for (i = 0; i < membuffer->segment_count; ++i)
+    {
+      svn_cache__info_t *info = apr_pcalloc(pool, sizeof(*info));
+
+      info->id = apr_psprintf(pool, "%u", (unsigned)i);
+      svn_error_clear(svn_membuffer_get_global_segment_info(membuffer + i,
+                                                            info));
+      APR_ARRAY_PUSH(infos, svn_cache__info_t *) = info;
+    }
+
+  return infos;
+}
@@ -23,6 +23,12 @@
 
 #include "cache.h"
 
+#include "private/svn_stats.h"
+
+/* Process-wide hit / miss statistics over all caches. */
+SVN__COUNTER_DEFINE(cache_hits, "cache.hits");
+SVN__COUNTER_DEFINE(cache_misses, "cache.misses");
+
 svn_error_t *
 svn_cache__set_error_handler(svn_cache__t *cache,
                              svn_cache__error_handler_t handler,
@@ -90,7 +96,14 @@ svn_cache__get(void **value_p,
                      result_pool);
 
   if (*found)
-    cache->hits++;
+    {
+      cache->hits++;
+      SVN__COUNTER_INC(cache_hits);
+    }
+  else
+    {
+      SVN__COUNTER_INC(cache_misses);
+    }
 
   return err;
 }
@@ -182,7 +195,14 @@ svn_cache__get_partial(void **value,
                      result_pool);
 
   if (*found)
-    cache->hits++;
+    {
+      cache->hits++;
+      SVN__COUNTER_INC(cache_hits);
+    }
+  else
+    {
+      SVN__COUNTER_INC(cache_misses);
+    }
 
   return err;
 }
@@ -275,6 +295,22 @@ svn_cache__format_info(const svn_cache__info_t *info,
                                        text->data, info->histogram[i], i);
 
       histogram = text->data;
+
+      /* Prepend the estimates for other cache sizes, if available. */
+      if (info->estimate_sizes[0])
+        {
+          for (i = SVN_CACHE__SIZE_ESTIMATES - 1; i >= 0; --i)
+            text = svn_stringbuf_createf(result_pool,
+                                         "estimate: %5.2f%% hits with %"
+                                         APR_UINT64_T_FMT
+                                         " MB data cache\n%s",
+                                         100.0
+                                           * info->estimated_hit_ratios[i],
+                                         info->estimate_sizes[i] / _1MB,
+                                         text->data);
+
+          histogram = text->data;
+        }
     }
 
   return access_only
@@ -296,6 +332,7 @@ svn_cache__format_info(const svn_cache__info_t *info,
                             "sets    : %" APR_UINT64_T_FMT
                             " (%5.2f%% of misses)\n"
                             "failures: %" APR_UINT64_T_FMT "\n"
+                            "rejects : %" APR_UINT64_T_FMT "\n"
                             "used    : %" APR_UINT64_T_FMT " MB (%5.2f%%)"
                             " of %" APR_UINT64_T_FMT " MB data cache"
                             " / %" APR_UINT64_T_FMT " MB total cache memory\n"
@@ -308,6 +345,7 @@ svn_cache__format_info(const svn_cache__info_t *info,
                             info->hits, hit_rate,
                             info->sets, write_rate,
                             info->failures,
+                            info->admission_rejects,
 
                             info->used_size / _1MB, data_usage_rate,
                             info->data_size / _1MB,
@@ -30,9 +30,17 @@
 #include "svn_sorts.h"
 
 /* The cache settings as a process-wide singleton.
+ *
+ * svn_cache_config_t and svn_cache_config2_t share the same initial
+ * sequence of members.  Storing them in a union allows us to hand out
+ * pointers to both versions of the struct.
  */
-static svn_cache_config_t cache_settings =
-  {
+static union
+{
+  svn_cache_config2_t v2;
+  svn_cache_config_t v1;
+} cache_settings =
+  { {
     /* default configuration:
      *
      * Please note that the resources listed below will be allocated
@@ -55,20 +63,34 @@ static svn_cache_config_t cache_settings =
                   * value (< 100) may be more suitable.
                   */
 #if APR_HAS_THREADS
-    FALSE        /* assume multi-threaded operation.
+    FALSE,       /* assume multi-threaded operation.
                   * Because this simply activates proper synchronization
                   * between threads, it is a safe default.
                   */
 #else
-    TRUE         /* single-threaded is the only supported mode of operation */
+    TRUE,        /* single-threaded is the only supported mode of operation */
 #endif
-};
+    FALSE,       /* admit all new items.
+                  * The admission filter only pays off for caches that
+                  * get regularly flushed by large scans.
+                  */
+    FALSE        /* keep the cache private to the process.
+                  * Sharing it requires the application to allocate it
+                  * before forking worker processes.
+                  */
+  } };
 
 /* Get the current FSFS cache configuration. */
 const svn_cache_config_t *
 svn_cache_config_get(void)
 {
-  return &cache_settings;
+  return &cache_settings.v1;
+}
+
+const svn_cache_config2_t *
+svn_cache_config2_get(void)
+{
+  return &cache_settings.v2;
 }
 
 /* Initializer function as required by svn_atomic__init_once.  Allocate
@@ -84,7 +106,7 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
   /* Limit the cache size to about half the available address space
    * (typ. 1G under 32 bits).
    */
-  apr_uint64_t cache_size = MIN(cache_settings.cache_size,
+  apr_uint64_t cache_size = MIN(cache_settings.v2.cache_size,
                                 (apr_uint64_t)SVN_MAX_OBJECT_SIZE / 2);
 
   /* Create caches at all? */
@@ -120,14 +142,44 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
         return SVN_NO_ERROR;
       apr_allocator_owner_set(allocator, pool);
 
-      err = svn_cache__membuffer_cache_create(
-          &cache,
-          (apr_size_t)cache_size,
-          (apr_size_t)(cache_size / 5),
-          0,
-          ! svn_cache_config_get()->single_threaded,
-          FALSE,
-          pool);
+      err = SVN_NO_ERROR;
+      if (cache_settings.v2.shared_memory)
+        {
+          err = svn_cache__membuffer_cache_create_shared(
+              &cache,
+              (apr_size_t)cache_size,
+              (apr_size_t)(cache_size / 5),
+              0,
+              cache_settings.v2.admission_filter,
+              pool);
+
+          /* Fall back to a process-local cache. */
+          if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+            {
+              svn_error_clear(err);
+              err = SVN_NO_ERROR;
+              cache = NULL;
+            }
+        }
+
+      if (!err && !cache)
+        {
+          err = svn_cache__membuffer_cache_create(
+              &cache,
+              (apr_size_t)cache_size,
+              (apr_size_t)(cache_size / 5),
+              0,
+              ! cache_settings.v2.single_threaded,
+              FALSE,
+              pool);
+
+          if (!err && cache_settings.v2.admission_filter)
+            err = svn_cache__membuffer_enable_admission_filter(cache, pool);
+
+          /* Let operators see how large the cache should be. */
+          if (!err)
+            err = svn_cache__membuffer_enable_size_estimates(cache, pool);
+        }
 
       /* Some error occurred. Most likely it's an OOM error but we don't
        * really care. Simply release all cache memory and disable caching
@@ -138,7 +190,7 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
           svn_pool_destroy(pool);
 
           /* Document that we actually don't have a cache. */
-          cache_settings.cache_size = 0;
+          cache_settings.v2.cache_size = 0;
 
           return svn_error_trace(err);
         }
@@ -176,6 +228,21 @@ svn_cache__get_global_membuffer_cache(void)
 void
 svn_cache_config_set(const svn_cache_config_t *settings)
 {
-  cache_settings = *settings;
+  /* Don't overwrite the svn_cache_config2_t-only members. */
+  cache_settings.v2.cache_size = settings->cache_size;
+  cache_settings.v2.file_handle_count = settings->file_handle_count;
+  cache_settings.v2.single_threaded = settings->single_threaded;
+}
+
+void
+svn_cache_config2_set(const svn_cache_config2_t *settings)
+{
+  cache_settings.v2 = *settings;
+}
+
+void
+svn_cache_config_preallocate(void)
+{
+  svn_cache__get_global_membuffer_cache();
 }
 
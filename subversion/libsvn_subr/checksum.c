@@ -35,7 +35,9 @@
 
 #include "checksum.h"
 #include "fnv1a.h"
+#include "sha1.h"
 
+#include "private/svn_stats.h"
 #include "private/svn_subr_private.h"
 
 #include "svn_private_config.h"
@@ -96,6 +98,10 @@ static const char *ckind_str[] = {
 /* Largest supported digest size */
 #define MAX_DIGESTSIZE (MAX(APR_MD5_DIGESTSIZE,APR_SHA1_DIGESTSIZE))
 
+/* svn_checksum__update2() feeds data to both contexts in chunks of this
+   size, such that the second pass over each chunk hits the CPU cache. */
+#define UPDATE2_CHUNK_SIZE 0x2000
+
 const unsigned char *
 svn__empty_string_digest(svn_checksum_kind_t kind)
 {
@@ -468,6 +474,9 @@ svn_checksum_dup(const svn_checksum_t *checksum,
     }
 }
 
+/* Time spent calculating checksums. */
+SVN__COUNTER_DEFINE(checksum_timer, "checksum.compute");
+
 svn_error_t *
 svn_checksum(svn_checksum_t **checksum,
              svn_checksum_kind_t kind,
@@ -476,10 +485,13 @@ svn_checksum(svn_checksum_t **checksum,
              apr_pool_t *pool)
 {
   apr_sha1_ctx_t sha1_ctx;
+  apr_time_t start;
 
   SVN_ERR(validate_kind(kind));
   *checksum = svn_checksum_create(kind, pool);
 
+  SVN__TIMER_START(checksum_timer, start);
+
   switch (kind)
     {
       case svn_checksum_md5:
@@ -487,9 +499,19 @@ svn_checksum(svn_checksum_t **checksum,
         break;
 
       case svn_checksum_sha1:
-        apr_sha1_init(&sha1_ctx);
-        apr_sha1_update(&sha1_ctx, data, (unsigned int)len);
-        apr_sha1_final((unsigned char *)(*checksum)->digest, &sha1_ctx);
+        if (svn_sha1__accelerated())
+          {
+            svn_sha1__context_t *context = svn_sha1__context_create(pool);
+            svn_sha1__update(context, data, len);
+            svn_sha1__finalize((unsigned char *)(*checksum)->digest,
+                               context);
+          }
+        else
+          {
+            apr_sha1_init(&sha1_ctx);
+            apr_sha1_update(&sha1_ctx, data, (unsigned int)len);
+            apr_sha1_final((unsigned char *)(*checksum)->digest, &sha1_ctx);
+          }
         break;
 
       case svn_checksum_fnv1a_32:
@@ -507,6 +529,7 @@ svn_checksum(svn_checksum_t **checksum,
         return svn_error_create(SVN_ERR_BAD_CHECKSUM_KIND, NULL, NULL);
     }
 
+  SVN__TIMER_STOP(checksum_timer, start);
   return SVN_NO_ERROR;
 }
 
@@ -533,6 +556,10 @@ struct svn_checksum_ctx_t
 {
   void *apr_ctx;
   svn_checksum_kind_t kind;
+
+  /* For svn_checksum_sha1, APR_CTX is a svn_sha1__context_t instead of
+     an apr_sha1_ctx_t if this is set. */
+  svn_boolean_t accelerated;
 };
 
 svn_checksum_ctx_t *
@@ -542,6 +569,7 @@ svn_checksum_ctx_create(svn_checksum_kind_t kind,
   svn_checksum_ctx_t *ctx = apr_palloc(pool, sizeof(*ctx));
 
   ctx->kind = kind;
+  ctx->accelerated = FALSE;
   switch (kind)
     {
       case svn_checksum_md5:
@@ -550,8 +578,16 @@ svn_checksum_ctx_create(svn_checksum_kind_t kind,
         break;
 
       case svn_checksum_sha1:
-        ctx->apr_ctx = apr_palloc(pool, sizeof(apr_sha1_ctx_t));
-        apr_sha1_init(ctx->apr_ctx);
+        if (svn_sha1__accelerated())
+          {
+            ctx->apr_ctx = svn_sha1__context_create(pool);
+            ctx->accelerated = TRUE;
+          }
+        else
+          {
+            ctx->apr_ctx = apr_palloc(pool, sizeof(apr_sha1_ctx_t));
+            apr_sha1_init(ctx->apr_ctx);
+          }
         break;
 
       case svn_checksum_fnv1a_32:
@@ -580,8 +616,15 @@ svn_checksum_ctx_reset(svn_checksum_ctx_t *ctx)
         break;
 
       case svn_checksum_sha1:
-        memset(ctx->apr_ctx, 0, sizeof(apr_sha1_ctx_t));
-        apr_sha1_init(ctx->apr_ctx);
+        if (ctx->accelerated)
+          {
+            svn_sha1__context_reset(ctx->apr_ctx);
+          }
+        else
+          {
+            memset(ctx->apr_ctx, 0, sizeof(apr_sha1_ctx_t));
+            apr_sha1_init(ctx->apr_ctx);
+          }
         break;
 
       case svn_checksum_fnv1a_32:
@@ -604,6 +647,9 @@ svn_checksum_update(svn_checksum_ctx_t *ctx,
                     const void *data,
                     apr_size_t len)
 {
+  apr_time_t start;
+
+  SVN__TIMER_START(checksum_timer, start);
   switch (ctx->kind)
     {
       case svn_checksum_md5:
@@ -611,7 +657,10 @@ svn_checksum_update(svn_checksum_ctx_t *ctx,
         break;
 
       case svn_checksum_sha1:
-        apr_sha1_update(ctx->apr_ctx, data, (unsigned int)len);
+        if (ctx->accelerated)
+          svn_sha1__update(ctx->apr_ctx, data, len);
+        else
+          apr_sha1_update(ctx->apr_ctx, data, (unsigned int)len);
         break;
 
       case svn_checksum_fnv1a_32:
@@ -627,6 +676,36 @@ svn_checksum_update(svn_checksum_ctx_t *ctx,
         return svn_error_create(SVN_ERR_BAD_CHECKSUM_KIND, NULL, NULL);
     }
 
+  SVN__TIMER_STOP(checksum_timer, start);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_checksum__update2(svn_checksum_ctx_t *ctx1,
+                      svn_checksum_ctx_t *ctx2,
+                      const void *data,
+                      apr_size_t len)
+{
+  const char *chunk = data;
+
+  if (ctx1 == NULL || ctx2 == NULL)
+    {
+      svn_checksum_ctx_t *ctx = ctx1 ? ctx1 : ctx2;
+      return ctx ? svn_error_trace(svn_checksum_update(ctx, data, len))
+                 : SVN_NO_ERROR;
+    }
+
+  while (len > 0)
+    {
+      apr_size_t chunk_len = MIN(len, UPDATE2_CHUNK_SIZE);
+
+      SVN_ERR(svn_checksum_update(ctx1, chunk, chunk_len));
+      SVN_ERR(svn_checksum_update(ctx2, chunk, chunk_len));
+
+      chunk += chunk_len;
+      len -= chunk_len;
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -644,7 +723,11 @@ svn_checksum_final(svn_checksum_t **checksum,
         break;
 
       case svn_checksum_sha1:
-        apr_sha1_final((unsigned char *)(*checksum)->digest, ctx->apr_ctx);
+        if (ctx->accelerated)
+          svn_sha1__finalize((unsigned char *)(*checksum)->digest,
+                             ctx->apr_ctx);
+        else
+          apr_sha1_final((unsigned char *)(*checksum)->digest, ctx->apr_ctx);
         break;
 
       case svn_checksum_fnv1a_32:
@@ -23,6 +23,9 @@
 
 
 #include <zlib.h>
+#ifdef SVN_HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
 
 #include "private/svn_subr_private.h"
 #include "private/svn_error_private.h"
@@ -55,6 +58,86 @@ svn_zlib__runtime_version(void)
    be compressed using zlib as a secondary compressor.  */
 #define MIN_COMPRESS_SIZE 512
 
+/* Compress the SRC_LEN bytes at SRC as a single zlib stream into DST using
+   COMPRESSION_LEVEL.  *DST_LEN is the capacity of DST on input and the
+   length of the compressed data on output.  If the result does not fit
+   into DST, set *DST_LEN to at least SRC_LEN.
+
+   With libdeflate available, use its one-shot API; its output is a
+   standard zlib stream, too, just produced much faster. */
+static svn_error_t *
+compress_window(unsigned char *dst,
+                unsigned long *dst_len,
+                const unsigned char *src,
+                apr_size_t src_len,
+                int compression_level)
+{
+#ifdef SVN_HAVE_LIBDEFLATE
+  struct libdeflate_compressor *compressor;
+  size_t result;
+
+  compressor = libdeflate_alloc_compressor(compression_level);
+  if (compressor == NULL)
+    return svn_error_trace(svn_error__wrap_zlib(
+                             Z_MEM_ERROR, "libdeflate_alloc_compressor",
+                             _("Compression of svndiff data failed")));
+
+  result = libdeflate_zlib_compress(compressor, src, src_len, dst, *dst_len);
+  libdeflate_free_compressor(compressor);
+
+  /* Zero means the compressed data did not fit. */
+  *dst_len = result ? (unsigned long)result : (unsigned long)src_len;
+#else
+  int zerr = compress2(dst, dst_len, src, src_len, compression_level);
+  if (zerr != Z_OK)
+    return svn_error_trace(svn_error__wrap_zlib(
+                             zerr, "compress2",
+                             _("Compression of svndiff data failed")));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Decompress the zlib stream of SRC_LEN bytes at SRC into DST.  *DST_LEN
+   is the capacity of DST on input and the length of the decompressed
+   data on output. */
+static svn_error_t *
+decompress_window(unsigned char *dst,
+                  unsigned long *dst_len,
+                  const unsigned char *src,
+                  apr_size_t src_len)
+{
+#ifdef SVN_HAVE_LIBDEFLATE
+  struct libdeflate_decompressor *decompressor;
+  enum libdeflate_result result;
+  size_t actual_len;
+
+  decompressor = libdeflate_alloc_decompressor();
+  if (decompressor == NULL)
+    return svn_error_trace(svn_error__wrap_zlib(
+                             Z_MEM_ERROR, "libdeflate_alloc_decompressor",
+                             _("Decompression of svndiff data failed")));
+
+  result = libdeflate_zlib_decompress(decompressor, src, src_len,
+                                      dst, *dst_len, &actual_len);
+  libdeflate_free_decompressor(decompressor);
+
+  if (result != LIBDEFLATE_SUCCESS)
+    return svn_error_create(SVN_ERR_SVNDIFF_INVALID_COMPRESSED_DATA, NULL,
+                            _("Decompression of svndiff data failed"));
+
+  *dst_len = (unsigned long)actual_len;
+#else
+  int zerr = uncompress(dst, dst_len, src, src_len);
+  if (zerr != Z_OK)
+    return svn_error_trace(svn_error__wrap_zlib(
+                             zerr, "uncompress",
+                             _("Decompression of svndiff data failed")));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 /* If IN is a string that is >= MIN_COMPRESS_SIZE and the COMPRESSION_LEVEL
    is not SVN_DELTA_COMPRESSION_LEVEL_NONE, zlib compress it and places the
    result in OUT, with an integer prepended specifying the original size.
@@ -88,18 +171,12 @@ zlib_encode(const char *data,
     }
   else
     {
-      int zerr;
-
       svn_stringbuf_ensure(out, svnCompressBound(len) + intlen);
-      endlen = out->blocksize;
+      endlen = out->blocksize - intlen - 1;
 
-      zerr = compress2((unsigned char *)out->data + intlen, &endlen,
-                       (const unsigned char *)data, len,
-                       compression_level);
-      if (zerr != Z_OK)
-        return svn_error_trace(svn_error__wrap_zlib(
-                                 zerr, "compress2",
-                                 _("Compression of svndiff data failed")));
+      SVN_ERR(compress_window((unsigned char *)out->data + intlen, &endlen,
+                              (const unsigned char *)data, len,
+                              compression_level));
 
       /* Compression didn't help :(, just append the original text */
       if (endlen >= len)
@@ -156,14 +233,10 @@ zlib_decode(const unsigned char *in, apr_size_t inLen, svn_stringbuf_t *out,
   else
     {
       unsigned long zlen = len;
-      int zerr;
 
       svn_stringbuf_ensure(out, len);
-      zerr = uncompress((unsigned char *)out->data, &zlen, in, inLen);
-      if (zerr != Z_OK)
-        return svn_error_trace(svn_error__wrap_zlib(
-                                 zerr, "uncompress",
-                                 _("Decompression of svndiff data failed")));
+      SVN_ERR(decompress_window((unsigned char *)out->data, &zlen, in,
+                                inLen));
 
       /* Zlib should not produce something that has a different size than the
          original length we stored. */
@@ -464,6 +464,32 @@ make_hash_key(char *key)
   return key;
 }
 
+/* Return TRUE if KEY is already canonical for hashing, i.e. it doesn't
+   contain upper case chars. */
+static APR_INLINE svn_boolean_t
+is_hash_key(const char *key)
+{
+  const char *p;
+  for (p = key; *p != 0; ++p)
+    if (apr_tolower(*p) != *p)
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Return the hash key for NAME, which has been allocated in POOL.  NAME
+   itself will be returned if it already is canonical, which is the case
+   for most section and option names. */
+static const char *
+get_hash_key(const char *name,
+             apr_pool_t *pool)
+{
+  if (is_hash_key(name))
+    return name;
+
+  return make_hash_key(apr_pstrdup(pool, name));
+}
+
 /* Return the value for KEY in HASH.  If CASE_SENSITIVE is FALSE,
    BUFFER will be used to construct the normalized hash key. */
 static void *
@@ -473,11 +499,16 @@ get_hash_value(apr_hash_t *hash,
                svn_boolean_t case_sensitive)
 {
   apr_size_t i;
-  apr_size_t len = strlen(key);
+  apr_size_t len;
 
   if (case_sensitive)
-    return apr_hash_get(hash, key, len);
+    return apr_hash_get(hash, key, APR_HASH_KEY_STRING);
+
+  /* Only copy KEY if it needs to be normalized. */
+  if (is_hash_key(key))
+    return apr_hash_get(hash, key, APR_HASH_KEY_STRING);
 
+  len = strlen(key);
   svn_stringbuf_ensure(buffer, len);
   for (i = 0; i < len; ++i)
     buffer->data[i] = (char)apr_tolower(key[i]);
@@ -709,7 +740,7 @@ svn_config_addsection(svn_config_t *cfg,
   if(cfg->section_names_case_sensitive)
     hash_key = s->name;
   else
-    hash_key = make_hash_key(apr_pstrdup(cfg->pool, section));
+    hash_key = get_hash_key(s->name, cfg->pool);
   s->options = svn_hash__make(cfg->pool);
 
   svn_hash_sets(cfg->sections, hash_key, s);
@@ -731,7 +762,7 @@ svn_config_create_option(cfg_option_t **opt,
   if(option_names_case_sensitive)
     o->hash_key = o->name;
   else
-    o->hash_key = make_hash_key(apr_pstrdup(pool, option));
+    o->hash_key = get_hash_key(o->name, pool);
 
   o->value = apr_pstrdup(pool, value);
   o->x_value = NULL;
@@ -1155,6 +1155,16 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###                              HTTP operation."                   NL
         "###   http-chunked-requests      Whether to use chunked transfer"   NL
         "###                              encoding for HTTP requests body."  NL
+        "###   http-enable-http2          Whether to negotiate HTTP/2 with"  NL
+        "###                              https:// servers that support it." NL
+        "###   http-content-cache-dir     Directory for caching the contents"NL
+        "###                              of fetched files (default: none)." NL
+        "###   http-content-cache-size    Maximum size of the content cache" NL
+        "###                              in megabytes (default: 1024)."     NL
+        "###   http-reuse-connections     Whether to keep connections open"  NL
+        "###                              for later sessions (default: yes)."NL
+        "###   svn-use-tls                Whether to encrypt svn:// sessions"NL
+        "###                              with TLS (yes/no/auto)."           NL
         "###   http-auth-types            List of HTTP authentication types."NL
         "###   ssl-authority-files        List of files, each of a trusted CA"
                                                                              NL
@@ -1301,6 +1311,11 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### each pointing to a PEM-encoded Certificate Authority (CA) "     NL
         "### SSL certificate.  See details above for overriding security "   NL
         "### due to SSL."                                                    NL
+        "###"                                                                NL
+        "### 'svn-use-tls' controls TLS for svn:// URLs.  With 'auto', TLS"  NL
+        "### is used whenever the server offers it; 'yes' refuses servers"   NL
+        "### that don't.  The server certificate is verified the same way"   NL
+        "### as for https:// URLs."                                          NL
         "[global]"                                                           NL
         "# http-proxy-exceptions = *.exception.com, www.internal-site.org"   NL
         "# http-proxy-host = defaultproxy.whatever.com"                      NL
@@ -1310,6 +1325,7 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "# http-compression = auto"                                          NL
         "# No http-timeout, so just use the builtin default."                NL
         "# ssl-authority-files = /path/to/CAcert.pem;/path/to/CAcert2.pem"   NL
+        "# svn-use-tls = auto"                                               NL
         "#"                                                                  NL
         "# Password / passphrase caching parameters:"                        NL
         "# store-passwords = no"                                             NL
@@ -1511,6 +1527,19 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### to show meaningful differences for binary file formats.  [New"  NL
         "### in 1.9]"                                                        NL
         "# diff-ignore-content-type = no"                                    NL
+        "### Set merge-jobs to the number of file contents merges that"      NL
+        "### 'svn merge' may compute concurrently.  The results are still"   NL
+        "### recorded in the working copy one after another.  [New in 1.15]" NL
+        "# merge-jobs = 1"                                                   NL
+        "### Set externals-jobs to the number of directory externals that"   NL
+        "### 'svn checkout', 'svn update' and 'svn switch' may check out or" NL
+        "### update concurrently, each over its own connection.  File"       NL
+        "### externals are still handled one after another.  [New in 1.15]"  NL
+        "# externals-jobs = 1"                                               NL
+        "### Set commit-jobs to the number of files whose changes 'svn"      NL
+        "### commit' may compute concurrently while sending earlier ones."   NL
+        "### The changes are still sent one after another.  [New in 1.15]"   NL
+        "# commit-jobs = 1"                                                  NL
         ""                                                                   NL
         "### Section for configuring automatic properties."                  NL
         "[auto-props]"                                                       NL
@@ -1552,6 +1581,56 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### returning an error.  The default is 10000, i.e. 10 seconds."    NL
         "### Longer values may be useful when exclusive locking is enabled." NL
         "# busy-timeout = 10000"                                             NL
+        "### Set install-jobs to the number of files whose working copy"     NL
+        "### form may be prepared concurrently, e.g. during checkout,"       NL
+        "### update and cleanup.  Files that don't depend on the work"       NL
+        "### done before them are also put in place concurrently."           NL
+        "### [New in 1.15]"                                                  NL
+        "# install-jobs = 1"                                                 NL
+        "### Set fsmonitor to a program that tracks changes on disk, e.g."   NL
+        "### a wrapper around a file system watcher.  'svn status' then"     NL
+        "### only examines the files the program reports as changed.  It"   NL
+        "### is run in the root of the working copy with that path and a"   NL
+        "### token as arguments, and must print a new token followed by"    NL
+        "### the paths (relative to the root, '/' separated, a trailing"    NL
+        "### '/' for a whole directory or just '/' for everything) that"    NL
+        "### may have changed since the given token, each terminated by a"  NL
+        "### NUL character.  [New in 1.15]"                                 NL
+        "# fsmonitor ="                                                      NL
+        "### Set status-jobs to the number of files whose size and"         NL
+        "### timestamp 'svn status' may look up concurrently.  This helps"  NL
+        "### most on network file systems and fast SSDs.  [New in 1.15]"    NL
+        "# status-jobs = 1"                                                  NL
+        "### Set compress-pristines to 'yes' to make new checkouts store"    NL
+        "### their pristine copies of files zlib compressed.  This saves"    NL
+        "### disk space at the cost of some CPU time.  The choice is"        NL
+        "### recorded in each working copy; existing and upgraded working"   NL
+        "### copies are not affected.  [New in 1.15]"                        NL
+        "# compress-pristines = no"                                          NL
+        "### Set shared-pristines to a directory that working copies on"     NL
+        "### the same file system share their pristine copies of files in."  NL
+        "### Working copies hard link the copies they need from there"       NL
+        "### instead of downloading and storing them again, and 'svn"        NL
+        "### cleanup' removes the copies no working copy links to.  Only"    NL
+        "### users you trust should be able to write to the directory."      NL
+        "### Compressed pristines are not shared.  [New in 1.15]"            NL
+        "# shared-pristines ="                                               NL
+        "### Set pristines-on-demand to 'yes' to make new checkouts not"     NL
+        "### keep pristine copies of files that are unmodified.  They are"   NL
+        "### recreated from the working file, or fetched from the"           NL
+        "### repository if the file was modified, when an operation such"    NL
+        "### as 'svn diff' or 'svn revert' needs them.  This saves the disk" NL
+        "### space of a second copy of every file at the cost of network"    NL
+        "### access for those operations.  The choice is recorded in each"   NL
+        "### working copy; existing and upgraded working copies are not"     NL
+        "### affected.  [New in 1.15]"                                       NL
+        "# pristines-on-demand = no"                                         NL
+        "### Set checksum-cache to 'yes' to remember the checksum of files"  NL
+        "### whose timestamp changed but whose content didn't, together"    NL
+        "### with their size, timestamps and inode number.  Until one of"   NL
+        "### those changes again, 'svn status' then doesn't need to read"   NL
+        "### such a file to tell it is unmodified.  [New in 1.15]"          NL
+        "# checksum-cache = no"                                              NL
         ;
 
       err = svn_io_file_open(&f, path,
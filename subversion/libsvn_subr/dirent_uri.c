@@ -2640,15 +2640,36 @@ svn_fspath__is_canonical(const char *fspath)
 }
 
 
+/* Return "/" followed by the first LEN bytes of RELPATH, allocated in
+ * POOL.  This takes a single allocation, unlike the apr_pstrcat() of a
+ * separately allocated relpath result. */
+static char *
+fspath_from_relpath(const char *relpath, apr_size_t len, apr_pool_t *pool)
+{
+  char *result = apr_palloc(pool, len + 2);
+
+  result[0] = '/';
+  memcpy(result + 1, relpath, len);
+  result[len + 1] = '\0';
+
+  return result;
+}
+
 const char *
 svn_fspath__canonicalize(const char *fspath,
                          apr_pool_t *pool)
 {
+  const char *relpath;
+
   if ((fspath[0] == '/') && (fspath[1] == '\0'))
     return "/";
 
-  return apr_pstrcat(pool, "/", svn_relpath_canonicalize(fspath, pool),
-                     SVN_VA_NULL);
+  /* Most callers pass paths that are canonical already. */
+  if (svn_fspath__is_canonical(fspath))
+    return apr_pstrdup(pool, fspath);
+
+  relpath = svn_relpath_canonicalize(fspath, pool);
+  return fspath_from_relpath(relpath, strlen(relpath), pool);
 }
 
 
@@ -2680,8 +2701,10 @@ svn_fspath__dirname(const char *fspath,
   if (fspath[0] == '/' && fspath[1] == '\0')
     return apr_pstrdup(pool, fspath);
   else
-    return apr_pstrcat(pool, "/", svn_relpath_dirname(fspath + 1, pool),
-                       SVN_VA_NULL);
+    return fspath_from_relpath(fspath + 1,
+                               relpath_previous_segment(fspath + 1,
+                                                        strlen(fspath + 1)),
+                               pool);
 }
 
 
@@ -2719,15 +2742,22 @@ svn_fspath__join(const char *fspath,
                  apr_pool_t *result_pool)
 {
   char *result;
+  apr_size_t flen = strlen(fspath);
+  apr_size_t rlen = strlen(relpath);
   assert(svn_fspath__is_canonical(fspath));
   assert(svn_relpath_is_canonical(relpath));
 
-  if (relpath[0] == '\0')
-    result = apr_pstrdup(result_pool, fspath);
-  else if (fspath[1] == '\0')
-    result = apr_pstrcat(result_pool, "/", relpath, SVN_VA_NULL);
-  else
-    result = apr_pstrcat(result_pool, fspath, "/", relpath, SVN_VA_NULL);
+  if (rlen == 0)
+    return apr_pmemdup(result_pool, fspath, flen + 1);
+
+  /* Don't duplicate the separator when FSPATH is the root. */
+  if (flen == 1)
+    flen = 0;
+
+  result = apr_palloc(result_pool, flen + 1 + rlen + 1);
+  memcpy(result, fspath, flen);
+  result[flen] = '/';
+  memcpy(result + flen + 1, relpath, rlen + 1);
 
   assert(svn_fspath__is_canonical(result));
   return result;
@@ -2742,11 +2772,12 @@ svn_fspath__get_longest_ancestor(const char *fspath1,
   assert(svn_fspath__is_canonical(fspath1));
   assert(svn_fspath__is_canonical(fspath2));
 
-  result = apr_pstrcat(result_pool, "/",
-                       svn_relpath_get_longest_ancestor(fspath1 + 1,
-                                                        fspath2 + 1,
-                                                        result_pool),
-                       SVN_VA_NULL);
+  result = fspath_from_relpath(fspath1 + 1,
+                               get_longest_ancestor_length(type_relpath,
+                                                           fspath1 + 1,
+                                                           fspath2 + 1,
+                                                           result_pool),
+                               result_pool);
 
   assert(svn_fspath__is_canonical(result));
   return result;
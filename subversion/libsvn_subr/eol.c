@@ -30,10 +30,32 @@
 #include "private/svn_eol_private.h"
 #include "private/svn_dep_compat.h"
 
+#ifdef SVN__HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 char *
 svn_eol__find_eol_start(char *buf, apr_size_t len)
 {
-#if SVN_UNALIGNED_ACCESS_IS_OK
+#ifdef SVN__HAVE_SSE2
+
+  /* Scan the input 16 bytes at a time. */
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+
+  for (; len >= sizeof(__m128i)
+       ; buf += sizeof(__m128i), len -= sizeof(__m128i))
+    {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)buf);
+      __m128i found = _mm_or_si128(_mm_cmpeq_epi8(chunk, cr),
+                                   _mm_cmpeq_epi8(chunk, lf));
+
+      /* The exact position will be found by the naive loop below. */
+      if (_mm_movemask_epi8(found))
+        break;
+    }
+
+#elif SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Scan the input one machine word at a time. */
   for (; len > sizeof(apr_uintptr_t)
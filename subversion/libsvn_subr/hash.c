@@ -24,6 +24,7 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include <apr_version.h>
@@ -666,3 +667,290 @@ svn_hash__make(apr_pool_t *pool)
 {
   return apr_hash_make_custom(pool, hashfunc_compatible);
 }
+
+
+
+/*** Open addressing hash tables ***/
+
+/* Control byte values.  Any control byte below 0x80 marks a used slot
+ * and holds 7 bits of the respective key's hash value. */
+#define CTRL_EMPTY   ((unsigned char)0x80)
+#define CTRL_DELETED ((unsigned char)0xfe)
+
+/* Minimum number of slots in a non-empty table.  Must be a power of 2. */
+#define MIN_TABLE_CAPACITY 16
+
+/* A used slot in svn_hash__table_t. */
+typedef struct table_slot_t
+{
+  const char *key;
+  apr_size_t klen;
+  apr_uint32_t hash;
+  void *value;
+} table_slot_t;
+
+struct svn_hash__table_t
+{
+  /* CAPACITY control bytes, one per slot.  Probing scans these first and
+   * only touches SLOTS for likely matches. */
+  unsigned char *ctrl;
+
+  /* CAPACITY slots.  Contents are undefined unless the respective control
+   * byte marks the slot as used. */
+  table_slot_t *slots;
+
+  /* Number of slots.  Always 0 or a power of 2. */
+  apr_size_t capacity;
+
+  /* Number of used slots. */
+  apr_size_t count;
+
+  /* Number of slots that are not CTRL_EMPTY, i.e. COUNT plus the number
+   * of deleted slots. */
+  apr_size_t occupied;
+
+  /* Pool to allocate the slot arrays from. */
+  apr_pool_t *pool;
+};
+
+/* Return the scrambled hash value of the key at KEY with length *KLEN.
+ * Resolve APR_HASH_KEY_STRING in *KLEN. */
+static apr_uint32_t
+table_hash(const char *key, apr_ssize_t *klen)
+{
+  /* The multiplication spreads the entropy of the low order bits, where
+   * hashfunc_compatible() collects most of it, over the whole value. */
+  return (apr_uint32_t)hashfunc_compatible(key, klen) * 0x9e3779b1;
+}
+
+/* Return the control byte tag for scrambled HASH. */
+static unsigned char
+hash_tag(apr_uint32_t hash)
+{
+  return (unsigned char)(hash >> 25);
+}
+
+/* Return the first slot index to probe for scrambled HASH in TABLE. */
+static apr_size_t
+hash_index(const svn_hash__table_t *table, apr_uint32_t hash)
+{
+  return (hash ^ (hash >> 16)) & (table->capacity - 1);
+}
+
+/* Return the index of the slot in TABLE holding KEY of length KLEN and
+ * scrambled hash value HASH.  Return TABLE->CAPACITY if not found. */
+static apr_size_t
+table_find(const svn_hash__table_t *table,
+           const char *key,
+           apr_size_t klen,
+           apr_uint32_t hash)
+{
+  apr_size_t mask = table->capacity - 1;
+  apr_size_t idx;
+  unsigned char tag = hash_tag(hash);
+
+  if (table->capacity == 0)
+    return table->capacity;
+
+  /* The table always contains at least one empty slot. */
+  for (idx = hash_index(table, hash);
+       table->ctrl[idx] != CTRL_EMPTY;
+       idx = (idx + 1) & mask)
+    {
+      const table_slot_t *slot = &table->slots[idx];
+      if (   table->ctrl[idx] == tag
+          && slot->hash == hash
+          && slot->klen == klen
+          && memcmp(slot->key, key, klen) == 0)
+        return idx;
+    }
+
+  return table->capacity;
+}
+
+/* Put KEY, KLEN, HASH and VALUE into the first free slot of TABLE along
+ * the probe sequence.  KEY must not be in TABLE yet and TABLE must have
+ * enough room for another entry. */
+static void
+table_insert(svn_hash__table_t *table,
+             const char *key,
+             apr_size_t klen,
+             apr_uint32_t hash,
+             void *value)
+{
+  apr_size_t mask = table->capacity - 1;
+  apr_size_t idx = hash_index(table, hash);
+  table_slot_t *slot;
+
+  while (table->ctrl[idx] < CTRL_EMPTY)
+    idx = (idx + 1) & mask;
+
+  if (table->ctrl[idx] == CTRL_EMPTY)
+    table->occupied++;
+
+  table->ctrl[idx] = hash_tag(hash);
+  slot = &table->slots[idx];
+  slot->key = key;
+  slot->klen = klen;
+  slot->hash = hash;
+  slot->value = value;
+  table->count++;
+}
+
+/* Re-allocate TABLE's slot arrays such that they can hold at least
+ * MIN_COUNT entries while staying at most 7/8 full, and re-insert all
+ * current entries.  This also drops all deleted slots. */
+static void
+table_resize(svn_hash__table_t *table,
+             apr_size_t min_count)
+{
+  unsigned char *old_ctrl = table->ctrl;
+  table_slot_t *old_slots = table->slots;
+  apr_size_t old_capacity = table->capacity;
+  apr_size_t capacity = MIN_TABLE_CAPACITY;
+  apr_size_t i;
+
+  while (capacity - capacity / 8 <= min_count)
+    capacity *= 2;
+
+  table->ctrl = apr_palloc(table->pool, capacity);
+  memset(table->ctrl, CTRL_EMPTY, capacity);
+  table->slots = apr_palloc(table->pool, capacity * sizeof(*table->slots));
+  table->capacity = capacity;
+  table->count = 0;
+  table->occupied = 0;
+
+  for (i = 0; i < old_capacity; i++)
+    if (old_ctrl[i] < CTRL_EMPTY)
+      table_insert(table, old_slots[i].key, old_slots[i].klen,
+                   old_slots[i].hash, old_slots[i].value);
+}
+
+svn_hash__table_t *
+svn_hash__table_create(apr_size_t size_hint,
+                       apr_pool_t *pool)
+{
+  svn_hash__table_t *table = apr_pcalloc(pool, sizeof(*table));
+  table->pool = pool;
+
+  if (size_hint)
+    table_resize(table, size_hint);
+
+  return table;
+}
+
+apr_size_t
+svn_hash__table_count(const svn_hash__table_t *table)
+{
+  return table->count;
+}
+
+void *
+svn_hash__table_get(const svn_hash__table_t *table,
+                    const char *key,
+                    apr_ssize_t klen)
+{
+  apr_uint32_t hash = table_hash(key, &klen);
+  apr_size_t idx = table_find(table, key, klen, hash);
+
+  return idx < table->capacity ? table->slots[idx].value : NULL;
+}
+
+void
+svn_hash__table_set(svn_hash__table_t *table,
+                    const char *key,
+                    apr_ssize_t klen,
+                    void *value)
+{
+  apr_uint32_t hash = table_hash(key, &klen);
+  apr_size_t idx = table_find(table, key, klen, hash);
+
+  if (idx < table->capacity)
+    {
+      if (value)
+        {
+          table->slots[idx].value = value;
+        }
+      else
+        {
+          table->ctrl[idx] = CTRL_DELETED;
+          table->count--;
+        }
+
+      return;
+    }
+
+  if (value == NULL)
+    return;
+
+  /* Keep at least 1/8 of all slots empty to terminate probe sequences
+   * early.  Many deleted slots will simply be purged during resize. */
+  if (table->occupied + 1 > table->capacity - table->capacity / 8)
+    table_resize(table, table->count + 1);
+
+  table_insert(table, key, klen, hash, value);
+}
+
+svn_boolean_t
+svn_hash__table_next(const svn_hash__table_t *table,
+                     apr_size_t *iter,
+                     const char **key,
+                     apr_size_t *klen,
+                     void **value)
+{
+  apr_size_t idx;
+
+  for (idx = *iter; idx < table->capacity; idx++)
+    if (table->ctrl[idx] < CTRL_EMPTY)
+      {
+        const table_slot_t *slot = &table->slots[idx];
+        if (key)
+          *key = slot->key;
+        if (klen)
+          *klen = slot->klen;
+        if (value)
+          *value = slot->value;
+
+        *iter = idx + 1;
+        return TRUE;
+      }
+
+  *iter = table->capacity;
+  return FALSE;
+}
+
+svn_hash__table_t *
+svn_hash__table_from_apr(apr_hash_t *hash,
+                         apr_pool_t *pool)
+{
+  svn_hash__table_t *table
+    = svn_hash__table_create(apr_hash_count(hash), pool);
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(pool, hash); hi; hi = apr_hash_next(hi))
+    {
+      const void *key;
+      apr_ssize_t klen;
+      void *value;
+
+      apr_hash_this(hi, &key, &klen, &value);
+      svn_hash__table_set(table, key, klen, value);
+    }
+
+  return table;
+}
+
+apr_hash_t *
+svn_hash__table_to_apr(const svn_hash__table_t *table,
+                       apr_pool_t *pool)
+{
+  apr_hash_t *hash = svn_hash__make(pool);
+  apr_size_t idx;
+
+  for (idx = 0; idx < table->capacity; idx++)
+    if (table->ctrl[idx] < CTRL_EMPTY)
+      apr_hash_set(hash, table->slots[idx].key, table->slots[idx].klen,
+                   table->slots[idx].value);
+
+  return hash;
+}
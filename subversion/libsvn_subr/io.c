@@ -51,6 +51,13 @@
 #include <fcntl.h>
 #endif
 
+#if defined(HAVE_LINUX_FS_H)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#elif defined(HAVE_SYS_CLONEFILE_H)
+#include <sys/clonefile.h>
+#endif
+
 #include "svn_hash.h"
 #include "svn_types.h"
 #include "svn_dirent_uri.h"
@@ -66,6 +73,7 @@
 
 #include "private/svn_atomic.h"
 #include "private/svn_io_private.h"
+#include "private/svn_stats.h"
 #include "private/svn_utf_private.h"
 #include "private/svn_dep_compat.h"
 
@@ -2696,6 +2704,104 @@ svn_io__file_lock_autocreate(const char *lock_file,
   return svn_error_trace(err);
 }
 
+void
+svn_io__file_prefetch(apr_file_t *file,
+                      apr_off_t offset,
+                      apr_off_t length)
+{
+#if defined(POSIX_FADV_WILLNEED)
+  apr_os_file_t fd;
+
+  if (apr_os_file_get(&fd, file) == APR_SUCCESS)
+    (void)posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED);
+#endif
+}
+
+svn_error_t *
+svn_io__file_link(const char *from_path,
+                  const char *to_path,
+                  apr_pool_t *pool)
+{
+  apr_status_t status;
+  const char *from_path_apr, *to_path_apr;
+
+  SVN_ERR(cstring_from_utf8(&from_path_apr, from_path, pool));
+  SVN_ERR(cstring_from_utf8(&to_path_apr, to_path, pool));
+
+  status = apr_file_link(from_path_apr, to_path_apr);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't link '%s' to '%s'"),
+                              svn_dirent_local_style(to_path, pool),
+                              svn_dirent_local_style(from_path, pool));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_io__file_clone(const char *from_path,
+                   const char *to_path,
+                   apr_pool_t *pool)
+{
+#if (defined(HAVE_LINUX_FS_H) && defined(FICLONE)) \
+    || defined(HAVE_SYS_CLONEFILE_H)
+  const char *from_path_apr, *to_path_apr;
+  int result;
+
+  SVN_ERR(cstring_from_utf8(&from_path_apr, from_path, pool));
+  SVN_ERR(cstring_from_utf8(&to_path_apr, to_path, pool));
+
+#if defined(HAVE_LINUX_FS_H)
+  {
+    int from_fd, to_fd;
+
+    from_fd = open(from_path_apr, O_RDONLY);
+    if (from_fd < 0)
+      return svn_error_wrap_apr(apr_get_os_error(), _("Can't open '%s'"),
+                                svn_dirent_local_style(from_path, pool));
+
+    to_fd = open(to_path_apr, O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (to_fd < 0)
+      {
+        apr_status_t status = apr_get_os_error();
+
+        close(from_fd);
+        return svn_error_wrap_apr(status, _("Can't create '%s'"),
+                                  svn_dirent_local_style(to_path, pool));
+      }
+
+    result = ioctl(to_fd, FICLONE, from_fd);
+    if (result < 0)
+      {
+        apr_status_t status = apr_get_os_error();
+
+        close(to_fd);
+        close(from_fd);
+        unlink(to_path_apr);
+        return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE,
+                                svn_error_wrap_apr(status, NULL),
+                                _("Can't clone files on this file system"));
+      }
+
+    close(from_fd);
+    if (close(to_fd) < 0)
+      return svn_error_wrap_apr(apr_get_os_error(), _("Can't close '%s'"),
+                                svn_dirent_local_style(to_path, pool));
+  }
+#else
+  result = clonefile(from_path_apr, to_path_apr, CLONE_NOFOLLOW);
+  if (result < 0)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE,
+                            svn_error_wrap_apr(apr_get_os_error(), NULL),
+                            _("Can't clone files on this file system"));
+#endif
+
+  return SVN_NO_ERROR;
+#else
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Can't clone files on this platform"));
+#endif
+}
+
 
 
 /* Data consistency/coherency operations. */
@@ -4006,11 +4112,21 @@ svn_io_file_get_offset(apr_off_t *offset_p,
   return SVN_NO_ERROR;
 }
 
+/* Time spent in APR file reads. */
+SVN__COUNTER_DEFINE(file_read_timer, "io.file_read");
+
 svn_error_t *
 svn_io_file_read(apr_file_t *file, void *buf,
                  apr_size_t *nbytes, apr_pool_t *pool)
 {
-  return do_io_file_wrapper_cleanup(file, apr_file_read(file, buf, nbytes),
+  apr_status_t status;
+  apr_time_t start;
+
+  SVN__TIMER_START(file_read_timer, start);
+  status = apr_file_read(file, buf, nbytes);
+  SVN__TIMER_STOP(file_read_timer, start);
+
+  return do_io_file_wrapper_cleanup(file, status,
                                     N_("Can't read file '%s'"),
                                     N_("Can't read stream"),
                                     pool);
@@ -4023,7 +4139,13 @@ svn_io_file_read_full2(apr_file_t *file, void *buf,
                        svn_boolean_t *hit_eof,
                        apr_pool_t *pool)
 {
-  apr_status_t status = apr_file_read_full(file, buf, nbytes, bytes_read);
+  apr_status_t status;
+  apr_time_t start;
+
+  SVN__TIMER_START(file_read_timer, start);
+  status = apr_file_read_full(file, buf, nbytes, bytes_read);
+  SVN__TIMER_STOP(file_read_timer, start);
+
   if (hit_eof)
     {
       if (APR_STATUS_IS_EOF(status))
@@ -4117,11 +4239,14 @@ svn_io_file_aligned_seek(apr_file_t *file,
     {
       char dummy;
       apr_status_t status;
+      apr_time_t start;
 
       /* seek to the start of the block and cause APR to read 1 block */
       SVN_ERR(svn_io_file_seek(file, APR_SET, &aligned_offset,
                                scratch_pool));
+      SVN__TIMER_START(file_read_timer, start);
       status = apr_file_getc(&dummy, file);
+      SVN__TIMER_STOP(file_read_timer, start);
 
       /* read may fail if we seek to or behind EOF.  That's ok then. */
       if (status != APR_SUCCESS && !APR_STATUS_IS_EOF(status))
@@ -4148,12 +4273,22 @@ svn_io_file_aligned_seek(apr_file_t *file,
 }
 
 
+/* Time spent in APR file writes. */
+SVN__COUNTER_DEFINE(file_write_timer, "io.file_write");
+
 svn_error_t *
 svn_io_file_write(apr_file_t *file, const void *buf,
                   apr_size_t *nbytes, apr_pool_t *pool)
 {
+  apr_status_t status;
+  apr_time_t start;
+
+  SVN__TIMER_START(file_write_timer, start);
+  status = apr_file_write(file, buf, nbytes);
+  SVN__TIMER_STOP(file_write_timer, start);
+
   return svn_error_trace(do_io_file_wrapper_cleanup(
-     file, apr_file_write(file, buf, nbytes),
+     file, status,
      N_("Can't write to file '%s'"),
      N_("Can't write to stream"),
      pool));
@@ -4175,12 +4310,14 @@ svn_io_file_write_full(apr_file_t *file, const void *buf,
                        apr_size_t nbytes, apr_size_t *bytes_written,
                        apr_pool_t *pool)
 {
+  apr_time_t start;
 #ifdef WIN32
 #define MAXBUFSIZE 30*1024
   apr_size_t bw = nbytes;
   apr_size_t to_write = nbytes;
   apr_status_t rv;
 
+  SVN__TIMER_START(file_write_timer, start);
   rv = apr_file_write_full(file, buf, nbytes, &bw);
   buf = (char *)buf + bw;
   to_write -= bw;
@@ -4205,8 +4342,12 @@ svn_io_file_write_full(apr_file_t *file, const void *buf,
     *bytes_written = nbytes - to_write;
 #undef MAXBUFSIZE
 #else
-  apr_status_t rv = apr_file_write_full(file, buf, nbytes, bytes_written);
+  apr_status_t rv;
+
+  SVN__TIMER_START(file_write_timer, start);
+  rv = apr_file_write_full(file, buf, nbytes, bytes_written);
 #endif
+  SVN__TIMER_STOP(file_write_timer, start);
 
   return svn_error_trace(do_io_file_wrapper_cleanup(
      file, rv,
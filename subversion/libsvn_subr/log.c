@@ -39,6 +39,7 @@
 #include "svn_hash.h"
 
 #include "private/svn_log.h"
+#include "private/svn_stats.h"
 
 
 static const char *
@@ -306,6 +307,14 @@ svn_log__get_file_revs(const char *path, svn_revnum_t start, svn_revnum_t end,
                       log_include_merged_revisions(include_merged_revisions));
 }
 
+const char *
+svn_log__blame(const char *path, svn_revnum_t start, svn_revnum_t end,
+               apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "blame %s r%ld:%ld",
+                      svn_path_uri_encode(path, pool), start, end);
+}
+
 const char *
 svn_log__lock(apr_hash_t *targets,
               svn_boolean_t steal, apr_pool_t *pool)
@@ -427,3 +436,74 @@ svn_log__list(const char *path, svn_revnum_t revision,
   return apr_psprintf(pool, "list %s r%ld%s%s", log_path, revision,
                       log_depth(depth, pool), pattern_text->data);
 }
+
+/* Maps svn_stats counters to the fields reported by svn_log__stats(). */
+typedef struct stats_field_t
+{
+  /* svn_stats counter name */
+  const char *counter;
+
+  /* index into FIELD_NAMES */
+  int field;
+
+  /* report the counter's event count instead of its total */
+  svn_boolean_t use_count;
+} stats_field_t;
+
+static const char *field_names[] =
+{
+  "fs-read", "cache-hits", "cache-misses", "authz", "delta", "sent",
+  "net-wait"
+};
+
+static const stats_field_t stats_fields[] =
+{
+  { "io.file_read",          0, FALSE },
+  { "cache.hits",            1, TRUE  },
+  { "cache.misses",          2, TRUE  },
+  { "repos.authz_check",     3, FALSE },
+  { "delta.compute_window",  4, FALSE },
+  { "delta.compose_windows", 4, FALSE },
+  { "ra_svn.bytes_sent",     5, FALSE },
+  { "dav_svn.bytes_sent",    5, FALSE },
+  { "ra_svn.write_wait",     6, FALSE },
+  { "dav_svn.write_wait",    6, FALSE }
+};
+
+const char *
+svn_log__stats(apr_interval_time_t elapsed,
+               const apr_array_header_t *changes,
+               apr_pool_t *pool)
+{
+  enum { FIELD_COUNT = sizeof(field_names) / sizeof(field_names[0]) };
+  apr_uint64_t values[FIELD_COUNT] = { 0 };
+  svn_boolean_t present[FIELD_COUNT] = { FALSE };
+  svn_stringbuf_t *result;
+  int i, k;
+
+  result = svn_stringbuf_createf(pool, "time=%" APR_TIME_T_FMT, elapsed);
+  for (i = 0; changes && i < changes->nelts; ++i)
+    {
+      const svn_stats__info_t *info
+        = APR_ARRAY_IDX(changes, i, const svn_stats__info_t *);
+
+      for (k = 0; k < (int)(sizeof(stats_fields) / sizeof(stats_fields[0]));
+           ++k)
+        if (strcmp(info->name, stats_fields[k].counter) == 0)
+          {
+            const stats_field_t *field = &stats_fields[k];
+
+            values[field->field] += field->use_count ? info->count
+                                                     : info->total;
+            present[field->field] = TRUE;
+          }
+    }
+
+  for (i = 0; i < FIELD_COUNT; ++i)
+    if (present[i])
+      svn_stringbuf_appendcstr(result,
+                               apr_psprintf(pool, " %s=%" APR_UINT64_T_FMT,
+                                            field_names[i], values[i]));
+
+  return result->data;
+}
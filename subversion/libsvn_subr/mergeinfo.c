@@ -2539,9 +2539,18 @@ svn_mergeinfo__mergeinfo_from_segments(svn_mergeinfo_t *mergeinfo_p,
                                        const apr_array_header_t *segments,
                                        apr_pool_t *pool)
 {
-  svn_mergeinfo_t mergeinfo = apr_hash_make(pool);
+  svn_mergeinfo_t mergeinfo;
+  svn_hash__table_t *ranges_by_path;
+  const char *path;
+  void *value;
+  apr_size_t iter = 0;
   int i;
 
+  /* Collect the ranges per path in a temporary table keyed by the
+     segment paths.  Long histories will typically have many segments
+     for the same few paths. */
+  ranges_by_path = svn_hash__table_create(0, pool);
+
   /* Translate location segments into merge sources and ranges. */
   for (i = 0; i < segments->nelts; i++)
     {
@@ -2549,37 +2558,42 @@ svn_mergeinfo__mergeinfo_from_segments(svn_mergeinfo_t *mergeinfo_p,
         APR_ARRAY_IDX(segments, i, svn_location_segment_t *);
       svn_rangelist_t *path_ranges;
       svn_merge_range_t *range;
-      const char *source_path;
 
       /* No path segment?  Skip it. */
       if (! segment->path)
         continue;
 
-      /* Prepend a leading slash to our path. */
-      source_path = apr_pstrcat(pool, "/", segment->path, SVN_VA_NULL);
-
-      /* See if we already stored ranges for this path.  If not, make
-         a new list.  */
-      path_ranges = svn_hash_gets(mergeinfo, source_path);
-      if (! path_ranges)
-        path_ranges = apr_array_make(pool, 1, sizeof(range));
-
       /* A svn_location_segment_t may have legitimately describe only
          revision 0, but there is no corresponding representation for
          this in a svn_merge_range_t. */
       if (segment->range_start == 0 && segment->range_end == 0)
         continue;
 
-      /* Build a merge range, push it onto the list of ranges, and for
-         good measure, (re)store it in the hash. */
+      /* See if we already stored ranges for this path.  If not, make
+         a new list.  */
+      path_ranges = svn_hash__table_get(ranges_by_path, segment->path,
+                                        APR_HASH_KEY_STRING);
+      if (! path_ranges)
+        {
+          path_ranges = apr_array_make(pool, 1, sizeof(range));
+          svn_hash__table_set(ranges_by_path, segment->path,
+                              APR_HASH_KEY_STRING, path_ranges);
+        }
+
+      /* Build a merge range and push it onto the list of ranges. */
       range = apr_pcalloc(pool, sizeof(*range));
       range->start = MAX(segment->range_start - 1, 0);
       range->end = segment->range_end;
       range->inheritable = TRUE;
       APR_ARRAY_PUSH(path_ranges, svn_merge_range_t *) = range;
-      svn_hash_sets(mergeinfo, source_path, path_ranges);
     }
 
+  /* Prepend a leading slash to our paths. */
+  mergeinfo = apr_hash_make(pool);
+  while (svn_hash__table_next(ranges_by_path, &iter, &path, NULL, &value))
+    svn_hash_sets(mergeinfo, apr_pstrcat(pool, "/", path, SVN_VA_NULL),
+                  value);
+
   *mergeinfo_p = mergeinfo;
   return SVN_NO_ERROR;
 }
@@ -2634,3 +2648,358 @@ svn_inheritance_from_word(const char *word)
     return svn_mergeinfo_nearest_ancestor;
   return svn_mergeinfo_explicit;
 }
+
+
+/*** Flat mergeinfo ***/
+
+/* Append RANGE to the N ranges of a single path in RANGES and update N.  If RANGE adjoins
+   the last range in RANGES and has the same inheritability, extend that
+   range instead.  If ANY_INHERITANCE is set, do so regardless of the
+   inheritability, making the combined range inheritable if either one
+   was -- this mirrors combine_with_lastrange(). */
+static void
+flat_append_range(svn_merge_range_t *ranges,
+                  int *n,
+                  const svn_merge_range_t *range,
+                  svn_boolean_t any_inheritance)
+{
+  svn_merge_range_t *last = *n ? &ranges[*n - 1] : NULL;
+
+  if (last && last->end == range->start
+      && (any_inheritance || last->inheritable == range->inheritable))
+    {
+      last->end = range->end;
+      last->inheritable = last->inheritable || range->inheritable;
+    }
+  else
+    {
+      ranges[(*n)++] = *range;
+    }
+}
+
+/* Add the union of the N1 ranges at RANGES1 and the N2 ranges at RANGES2
+   to the N ranges of a single path in OUT, updating N.  Both inputs must be canonical.
+   OUT must have room for 2 * (N1 + N2) additional ranges. */
+static void
+flat_merge_ranges(svn_merge_range_t *out,
+                  int *n,
+                  const svn_merge_range_t *ranges1,
+                  int n1,
+                  const svn_merge_range_t *ranges2,
+                  int n2)
+{
+  int i1 = 0, i2 = 0;
+  svn_merge_range_t r1 = { 0 }, r2 = { 0 };
+
+  /* R1 and R2 are the yet unprocessed remainders of RANGES1[I1] and
+     RANGES2[I2], respectively. */
+  if (n1)
+    r1 = ranges1[0];
+  if (n2)
+    r2 = ranges2[0];
+
+  while (i1 < n1 || i2 < n2)
+    {
+      svn_merge_range_t range;
+
+      if (i2 == n2 || (i1 < n1 && r1.end <= r2.start))
+        {
+          flat_append_range(out, n, &r1, FALSE);
+          if (++i1 < n1)
+            r1 = ranges1[i1];
+          continue;
+        }
+
+      if (i1 == n1 || r2.end <= r1.start)
+        {
+          flat_append_range(out, n, &r2, FALSE);
+          if (++i2 < n2)
+            r2 = ranges2[i2];
+          continue;
+        }
+
+      /* The ranges overlap.  Emit any leading part unique to one side
+         and then the common part, which is inheritable if either side
+         is. */
+      if (r1.start < r2.start)
+        {
+          range.start = r1.start;
+          range.end = r2.start;
+          range.inheritable = r1.inheritable;
+          flat_append_range(out, n, &range, FALSE);
+          r1.start = r2.start;
+        }
+      else if (r2.start < r1.start)
+        {
+          range.start = r2.start;
+          range.end = r1.start;
+          range.inheritable = r2.inheritable;
+          flat_append_range(out, n, &range, FALSE);
+          r2.start = r1.start;
+        }
+
+      range.start = r1.start;
+      range.end = MIN(r1.end, r2.end);
+      range.inheritable = r1.inheritable || r2.inheritable;
+      flat_append_range(out, n, &range, FALSE);
+
+      r1.start = range.end;
+      r2.start = range.end;
+      if (r1.start == r1.end && ++i1 < n1)
+        r1 = ranges1[i1];
+      if (r2.start == r2.end && ++i2 < n2)
+        r2 = ranges2[i2];
+    }
+}
+
+/* Add the intersection of the N1 ranges at RANGES1 and the N2 ranges at
+   RANGES2 to the N ranges of a single path in OUT, updating N.  Both inputs must be
+   canonical.  OUT must have room for N1 + N2 additional ranges.
+   CONSIDER_INHERITANCE is as for svn_rangelist_intersect(). */
+static void
+flat_intersect_ranges(svn_merge_range_t *out,
+                      int *n,
+                      const svn_merge_range_t *ranges1,
+                      int n1,
+                      const svn_merge_range_t *ranges2,
+                      int n2,
+                      svn_boolean_t consider_inheritance)
+{
+  int i1 = 0, i2 = 0;
+
+  while (i1 < n1 && i2 < n2)
+    {
+      const svn_merge_range_t *r1 = &ranges1[i1];
+      const svn_merge_range_t *r2 = &ranges2[i2];
+      svn_merge_range_t range;
+
+      range.start = MAX(r1->start, r2->start);
+      range.end = MIN(r1->end, r2->end);
+      range.inheritable = r1->inheritable || r2->inheritable;
+
+      if (range.start < range.end
+          && (!consider_inheritance || r1->inheritable == r2->inheritable))
+        flat_append_range(out, n, &range, !consider_inheritance);
+
+      if (r1->end <= r2->end)
+        i1++;
+      if (r2->end <= r1->end)
+        i2++;
+    }
+}
+
+/* Return an empty flat mergeinfo with room for MAX_PATHS paths and
+   MAX_RANGES ranges, allocated in RESULT_POOL. */
+static svn_mergeinfo__flat_t *
+flat_create(int max_paths,
+            int max_ranges,
+            apr_pool_t *result_pool)
+{
+  svn_mergeinfo__flat_t *flat = apr_palloc(result_pool, sizeof(*flat));
+
+  flat->nelts = 0;
+  flat->paths = apr_palloc(result_pool, max_paths * sizeof(*flat->paths));
+  flat->offsets = apr_palloc(result_pool,
+                             (max_paths + 1) * sizeof(*flat->offsets));
+  flat->ranges = apr_palloc(result_pool,
+                            MAX(max_ranges, 1) * sizeof(*flat->ranges));
+  flat->offsets[0] = 0;
+
+  return flat;
+}
+
+/* Return the number of ranges of the I-th path in FLAT. */
+static int
+flat_range_count(const svn_mergeinfo__flat_t *flat,
+                 int i)
+{
+  return flat->offsets[i + 1] - flat->offsets[i];
+}
+
+svn_error_t *
+svn_mergeinfo__flat_from_mergeinfo(svn_mergeinfo__flat_t **flat,
+                                   svn_mergeinfo_t mergeinfo,
+                                   apr_pool_t *result_pool,
+                                   apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *sorted;
+  int range_count = 0;
+  int i, j;
+
+  if (! mergeinfo)
+    {
+      *flat = flat_create(0, 0, result_pool);
+      return SVN_NO_ERROR;
+    }
+
+  sorted = svn_sort__hash(mergeinfo, svn_sort_compare_items_lexically,
+                          scratch_pool);
+  for (i = 0; i < sorted->nelts; i++)
+    {
+      svn_rangelist_t *rangelist
+        = APR_ARRAY_IDX(sorted, i, svn_sort__item_t).value;
+      range_count += rangelist->nelts;
+    }
+
+  *flat = flat_create(sorted->nelts, range_count, result_pool);
+  for (i = 0; i < sorted->nelts; i++)
+    {
+      const svn_sort__item_t *item = &APR_ARRAY_IDX(sorted, i,
+                                                    svn_sort__item_t);
+      svn_rangelist_t *rangelist = item->value;
+      int first = (*flat)->offsets[i];
+      int n = 0;
+
+      for (j = 0; j < rangelist->nelts; j++)
+        flat_append_range((*flat)->ranges + first, &n,
+                          APR_ARRAY_IDX(rangelist, j, svn_merge_range_t *),
+                          FALSE);
+
+      (*flat)->paths[i] = item->key;
+      (*flat)->offsets[i + 1] = first + n;
+    }
+
+  (*flat)->nelts = sorted->nelts;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_mergeinfo__flat_to_mergeinfo(svn_mergeinfo_t *mergeinfo,
+                                 const svn_mergeinfo__flat_t *flat,
+                                 apr_pool_t *result_pool)
+{
+  int i, j;
+
+  *mergeinfo = svn_hash__make(result_pool);
+  for (i = 0; i < flat->nelts; i++)
+    {
+      int count = flat_range_count(flat, i);
+      svn_rangelist_t *rangelist
+        = apr_array_make(result_pool, count, sizeof(svn_merge_range_t *));
+      svn_merge_range_t *ranges
+        = apr_pmemdup(result_pool, flat->ranges + flat->offsets[i],
+                      count * sizeof(*ranges));
+
+      for (j = 0; j < count; j++)
+        APR_ARRAY_PUSH(rangelist, svn_merge_range_t *) = &ranges[j];
+
+      svn_hash_sets(*mergeinfo, apr_pstrdup(result_pool, flat->paths[i]),
+                    rangelist);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_mergeinfo__flat_merge(svn_mergeinfo__flat_t **result,
+                          const svn_mergeinfo__flat_t *flat1,
+                          const svn_mergeinfo__flat_t *flat2,
+                          apr_pool_t *result_pool)
+{
+  svn_mergeinfo__flat_t *flat;
+  int i1 = 0, i2 = 0;
+
+  flat = flat_create(flat1->nelts + flat2->nelts,
+                     2 * (flat1->offsets[flat1->nelts]
+                          + flat2->offsets[flat2->nelts]),
+                     result_pool);
+
+  while (i1 < flat1->nelts || i2 < flat2->nelts)
+    {
+      int first = flat->offsets[flat->nelts];
+      int n = 0;
+      int diff;
+
+      if (i1 == flat1->nelts)
+        diff = 1;
+      else if (i2 == flat2->nelts)
+        diff = -1;
+      else
+        diff = strcmp(flat1->paths[i1], flat2->paths[i2]);
+
+      if (diff < 0)
+        {
+          flat_merge_ranges(flat->ranges + first, &n,
+                            flat1->ranges + flat1->offsets[i1],
+                            flat_range_count(flat1, i1), NULL, 0);
+          flat->paths[flat->nelts] = flat1->paths[i1++];
+        }
+      else if (diff > 0)
+        {
+          flat_merge_ranges(flat->ranges + first, &n, NULL, 0,
+                            flat2->ranges + flat2->offsets[i2],
+                            flat_range_count(flat2, i2));
+          flat->paths[flat->nelts] = flat2->paths[i2++];
+        }
+      else
+        {
+          flat_merge_ranges(flat->ranges + first, &n,
+                            flat1->ranges + flat1->offsets[i1],
+                            flat_range_count(flat1, i1),
+                            flat2->ranges + flat2->offsets[i2],
+                            flat_range_count(flat2, i2));
+          flat->paths[flat->nelts] = flat1->paths[i1++];
+          i2++;
+        }
+
+      flat->offsets[++flat->nelts] = first + n;
+    }
+
+  *result = flat;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_mergeinfo__flat_intersect(svn_mergeinfo__flat_t **result,
+                              const svn_mergeinfo__flat_t *flat1,
+                              const svn_mergeinfo__flat_t *flat2,
+                              svn_boolean_t consider_inheritance,
+                              apr_pool_t *result_pool)
+{
+  svn_mergeinfo__flat_t *flat;
+  int i1 = 0, i2 = 0;
+
+  flat = flat_create(MIN(flat1->nelts, flat2->nelts),
+                     flat1->offsets[flat1->nelts]
+                     + flat2->offsets[flat2->nelts],
+                     result_pool);
+
+  while (i1 < flat1->nelts && i2 < flat2->nelts)
+    {
+      int diff = strcmp(flat1->paths[i1], flat2->paths[i2]);
+
+      if (diff < 0)
+        {
+          i1++;
+        }
+      else if (diff > 0)
+        {
+          i2++;
+        }
+      else
+        {
+          int first = flat->offsets[flat->nelts];
+          int n = 0;
+
+          flat_intersect_ranges(flat->ranges + first, &n,
+                                flat1->ranges + flat1->offsets[i1],
+                                flat_range_count(flat1, i1),
+                                flat2->ranges + flat2->offsets[i2],
+                                flat_range_count(flat2, i2),
+                                consider_inheritance);
+
+          /* Like svn_mergeinfo_intersect2(), drop empty intersections. */
+          if (n > 0)
+            {
+              flat->paths[flat->nelts] = flat1->paths[i1];
+              flat->offsets[++flat->nelts] = first + n;
+            }
+
+          i1++;
+          i2++;
+        }
+    }
+
+  *result = flat;
+  return SVN_NO_ERROR;
+}
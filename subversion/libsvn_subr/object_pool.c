@@ -33,8 +33,17 @@
 #include "private/svn_atomic.h"
 #include "private/svn_object_pool.h"
 #include "private/svn_subr_private.h"
+#include "private/svn_sorts_private.h"
 #include "private/svn_dep_compat.h"
 
+/* In shared object mode, we start removing unused objects once there are
+ * more than this many above the number of objects in use. */
+#define UNUSED_OBJECT_SLACK 16
+
+/* Unused objects released longer ago than this many seconds will be
+ * removed during the next cleanup, regardless of how many there are. */
+#define UNUSED_OBJECT_TTL 300
+
 
 
 /* A reference counting wrapper around the user-provided object.
@@ -57,6 +66,13 @@ typedef struct object_ref_t
 
   /* Number of references to this data struct */
   volatile svn_atomic_t ref_count;
+
+  /* Time in seconds when REF_COUNT dropped to 0 the last time, modulo
+   * the range of svn_atomic_t. */
+  volatile svn_atomic_t last_used;
+
+  /* In exclusive mode, the next unused entry with the same KEY. */
+  struct object_ref_t *next;
 } object_ref_t;
 
 
@@ -83,6 +99,9 @@ struct svn_object_pool__t
      Hence we must not strictly depend on it. */
   volatile svn_atomic_t unused_count;
 
+  /* If set, hand out every object to at most one user at a time. */
+  svn_boolean_t exclusive;
+
   /* the root pool owning this structure */
   apr_pool_t *pool;
 };
@@ -102,7 +121,65 @@ object_pool_cleanup(void *baton)
   return APR_SUCCESS;
 }
 
+/* Return the current time as to be stored in object_ref_t.LAST_USED. */
+static svn_atomic_t
+now_in_seconds(void)
+{
+  return (svn_atomic_t)apr_time_sec(apr_time_now());
+}
+
+/* Sort callback for svn_sort__array, putting the most recently used
+ * object_ref_t * first.  The time stamps only need to be within half
+ * the range of svn_atomic_t from each other. */
+static int
+compare_last_used(const void *lhs,
+                  const void *rhs)
+{
+  object_ref_t *lhs_ref = *(object_ref_t * const *)lhs;
+  object_ref_t *rhs_ref = *(object_ref_t * const *)rhs;
+  apr_int32_t diff = (apr_int32_t)(  svn_atomic_read(&lhs_ref->last_used)
+                                   - svn_atomic_read(&rhs_ref->last_used));
+
+  if (diff == 0)
+    return 0;
+
+  return diff > 0 ? -1 : 1;
+}
+
+/* Return the number of objects in OBJECT_POOL that are in use.
+ * This is only an estimate, see svn_object_pool__t.UNUSED_COUNT. */
+static svn_atomic_t
+used_count(svn_object_pool__t *object_pool)
+{
+  svn_atomic_t object_count = svn_atomic_read(&object_pool->object_count);
+  svn_atomic_t unused_count = svn_atomic_read(&object_pool->unused_count);
+
+  return object_count > unused_count ? object_count - unused_count : 0;
+}
+
+/* Remove the unused OBJECT_REF from OBJECT_POOL in shared object mode.
+ *
+ * Requires external serialization on OBJECT_POOL.
+ */
+static void
+remove_object(svn_object_pool__t *object_pool,
+              object_ref_t *object_ref)
+{
+  apr_hash_set(object_pool->objects, object_ref->key.data,
+               object_ref->key.size, NULL);
+  svn_atomic_dec(&object_pool->object_count);
+  svn_atomic_dec(&object_pool->unused_count);
+
+  svn_pool_destroy(object_ref->pool);
+}
+
 /* Remove entries from OBJECTS in OBJECT_POOL that have a ref-count of 0.
+ *
+ * In shared object mode, keep the most recently used ones, as long as
+ * they are not older than UNUSED_OBJECT_TTL.  Frequently requested
+ * objects, e.g. the authz or config data of busy repositories, tend to
+ * be unused for a short time only and would be recreated soon if we
+ * removed them here.
  *
  * Requires external serialization on OBJECT_POOL.
  */
@@ -110,6 +187,11 @@ static void
 remove_unused_objects(svn_object_pool__t *object_pool)
 {
   apr_pool_t *subpool = svn_pool_create(object_pool->pool);
+  apr_array_header_t *unused
+    = apr_array_make(subpool, 0, sizeof(object_ref_t *));
+  int keep = (int)(used_count(object_pool) + UNUSED_OBJECT_SLACK) / 2;
+  svn_atomic_t now = now_in_seconds();
+  int i;
 
   /* process all hash buckets */
   apr_hash_index_t *hi;
@@ -119,22 +201,68 @@ remove_unused_objects(svn_object_pool__t *object_pool)
     {
       object_ref_t *object_ref = apr_hash_this_val(hi);
 
-      /* note that we won't hand out new references while access
-         to the hash is serialized */
-      if (svn_atomic_read(&object_ref->ref_count) == 0)
+      /* In exclusive mode, all entries in the hash are unused. */
+      if (object_pool->exclusive)
         {
           apr_hash_set(object_pool->objects, object_ref->key.data,
                        object_ref->key.size, NULL);
-          svn_atomic_dec(&object_pool->object_count);
-          svn_atomic_dec(&object_pool->unused_count);
+          while (object_ref)
+            {
+              object_ref_t *next = object_ref->next;
 
-          svn_pool_destroy(object_ref->pool);
+              svn_atomic_dec(&object_pool->object_count);
+              svn_atomic_dec(&object_pool->unused_count);
+              svn_pool_destroy(object_ref->pool);
+
+              object_ref = next;
+            }
+        }
+
+      /* note that we won't hand out new references while access
+         to the hash is serialized */
+      else if (svn_atomic_read(&object_ref->ref_count) == 0)
+        {
+          APR_ARRAY_PUSH(unused, object_ref_t *) = object_ref;
         }
     }
 
+  /* Remove all but the most recently used objects. */
+  svn_sort__array(unused, compare_last_used);
+  for (i = 0; i < unused->nelts; ++i)
+    {
+      object_ref_t *object_ref = APR_ARRAY_IDX(unused, i, object_ref_t *);
+
+      if (   i < keep
+          && now - svn_atomic_read(&object_ref->last_used)
+             <= UNUSED_OBJECT_TTL)
+        continue;
+
+      remove_object(object_pool, object_ref);
+    }
+
   svn_pool_destroy(subpool);
 }
 
+/* Make the unused OBJECT_REF available to the next lookup.
+ *
+ * Requires external serialization on OBJECT_REF->OBJECT_POOL.
+ */
+static svn_error_t *
+return_exclusive_ref(object_ref_t *object_ref)
+{
+  apr_hash_t *objects = object_ref->object_pool->objects;
+
+  object_ref->next = apr_hash_get(objects, object_ref->key.data,
+                                  object_ref->key.size);
+  if (object_ref->next)
+    apr_hash_set(objects, object_ref->next->key.data,
+                 object_ref->next->key.size, NULL);
+  apr_hash_set(objects, object_ref->key.data, object_ref->key.size,
+               object_ref);
+
+  return SVN_NO_ERROR;
+}
+
 /* Cleanup function called when an object_ref_t gets released.
  */
 static apr_status_t
@@ -153,7 +281,21 @@ object_ref_cleanup(void *baton)
      all threads left the racy sections.
    */
   if (svn_atomic_dec(&object->ref_count) == 0)
-    svn_atomic_inc(&object_pool->unused_count);
+    {
+      /* If we can't put it back, the object will simply never be used
+         again and go away with the object pool. */
+      if (object_pool->exclusive)
+        {
+          svn_error_t *err = svn_mutex__lock(object_pool->mutex);
+          if (!err)
+            err = svn_mutex__unlock(object_pool->mutex,
+                                    return_exclusive_ref(object));
+          svn_error_clear(err);
+        }
+
+      svn_atomic_set(&object->last_used, now_in_seconds());
+      svn_atomic_inc(&object_pool->unused_count);
+    }
 
   return APR_SUCCESS;
 }
@@ -192,6 +334,17 @@ lookup(void **object,
   object_ref_t *object_ref
     = apr_hash_get(object_pool->objects, key->data, key->size);
 
+  /* In exclusive mode, take the entry out of the hash until its user
+     releases it again. */
+  if (object_ref && object_pool->exclusive)
+    {
+      apr_hash_set(object_pool->objects, key->data, key->size, NULL);
+      if (object_ref->next)
+        apr_hash_set(object_pool->objects, object_ref->next->key.data,
+                     object_ref->next->key.size, object_ref->next);
+      object_ref->next = NULL;
+    }
+
   if (object_ref)
     {
       *object = object_ref->object;
@@ -218,7 +371,9 @@ insert(void **object,
        apr_pool_t *result_pool)
 {
   object_ref_t *object_ref
-    = apr_hash_get(object_pool->objects, key->data, key->size);
+    = object_pool->exclusive
+    ? NULL
+    : apr_hash_get(object_pool->objects, key->data, key->size);
   if (object_ref)
     {
       /* Destroy the new one and return a reference to the existing one
@@ -233,13 +388,16 @@ insert(void **object,
       object_ref->object_pool = object_pool;
       object_ref->object = item;
       object_ref->pool = item_pool;
+      object_ref->last_used = now_in_seconds();
 
       svn_membuf__create(&object_ref->key, key->size, item_pool);
       object_ref->key.size = key->size;
       memcpy(object_ref->key.data, key->data, key->size);
 
-      apr_hash_set(object_pool->objects, object_ref->key.data,
-                   object_ref->key.size, object_ref);
+      /* In exclusive mode, the hash only contains unused entries. */
+      if (!object_pool->exclusive)
+        apr_hash_set(object_pool->objects, object_ref->key.data,
+                     object_ref->key.size, object_ref);
       svn_atomic_inc(&object_pool->object_count);
 
       /* the new entry is *not* in use yet.
@@ -253,8 +411,11 @@ insert(void **object,
   add_object_ref(object_ref, result_pool);
 
   /* limit memory usage */
-  if (svn_atomic_read(&object_pool->unused_count) * 2
-      > apr_hash_count(object_pool->objects) + 2)
+  if (object_pool->exclusive
+      ? (  svn_atomic_read(&object_pool->unused_count) * 2
+         > svn_atomic_read(&object_pool->object_count) + 2)
+      : (  svn_atomic_read(&object_pool->unused_count)
+         > used_count(object_pool) + UNUSED_OBJECT_SLACK))
     remove_unused_objects(object_pool);
 
   return SVN_NO_ERROR;
@@ -293,6 +454,17 @@ svn_object_pool__create(svn_object_pool__t **object_pool,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_object_pool__create_exclusive(svn_object_pool__t **object_pool,
+                                  svn_boolean_t thread_safe,
+                                  apr_pool_t *pool)
+{
+  SVN_ERR(svn_object_pool__create(object_pool, thread_safe, pool));
+  (*object_pool)->exclusive = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
 apr_pool_t *
 svn_object_pool__new_item_pool(svn_object_pool__t *object_pool)
 {
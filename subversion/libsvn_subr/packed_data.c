@@ -27,6 +27,7 @@
 #include "private/svn_string_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_delta_private.h"
+#include "private/svn_eol_private.h"
 #include "private/svn_packed_data.h"
 
 #include "svn_private_config.h"
@@ -823,8 +824,29 @@ svn_packed__data_fill_buffer(svn_packed__int_stream_t *stream)
 
       /* unpack numbers */
       start = p;
-      for (i = end; i > 0; --i)
-        p = read_packed_uint_body(p, &stream->buffer[i-1]);
+      for (i = end; i > 0; )
+        {
+#if SVN_UNALIGNED_ACCESS_IS_OK
+          /* Most values are small.  If the next machine word of input
+             consists of single-byte values only, decode all of them at
+             once.  The input always covers one byte per value to read,
+             so this won't read beyond the data that the loop would
+             process anyway. */
+          if (   i >= sizeof(apr_uintptr_t)
+              && !(*(const apr_uintptr_t *)p & SVN__BIT_7_SET))
+            {
+              apr_size_t k;
+              for (k = 0; k < sizeof(apr_uintptr_t); ++k)
+                stream->buffer[i - 1 - k] = p[k];
+
+              p += sizeof(apr_uintptr_t);
+              i -= sizeof(apr_uintptr_t);
+              continue;
+            }
+#endif
+          --i;
+          p = read_packed_uint_body(p, &stream->buffer[i]);
+        }
 
       /* adjust remaining packed data buffer */
       packed_read = p - start;
@@ -0,0 +1,281 @@
+/*
+ * sha1.c :  hardware-accelerated SHA1 checksum routines
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+#include <apr.h>
+
+#include "sha1.h"
+
+/* We use the x86 SHA extensions (SHA-NI) where the compiler lets us
+ * enable them for individual functions.  Everything else falls back to
+ * APR's portable implementation, see svn_sha1__accelerated().
+ */
+#if (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#  define SVN_SHA1_SHANI
+#  include <cpuid.h>
+#  include <immintrin.h>
+#endif
+
+/* SHA1 processes its input in blocks of this size. */
+#define SHA1_BLOCK_SIZE 64
+
+struct svn_sha1__context_t
+{
+  /* The intermediate hash value H0 .. H4. */
+  apr_uint32_t state[5];
+
+  /* Total number of bytes fed into this context. */
+  apr_uint64_t length;
+
+  /* Input not yet processed because it does not form a full block. */
+  unsigned char buffer[SHA1_BLOCK_SIZE];
+};
+
+#ifdef SVN_SHA1_SHANI
+
+#ifndef bit_SHA
+#  define bit_SHA (1 << 29)
+#endif
+
+/* Return TRUE if the CPU supports SHA-NI and the SSE extensions that
+ * sha1_blocks() requires. */
+static svn_boolean_t
+detect_shani(void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return FALSE;
+  if (!(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1))
+    return FALSE;
+
+  if (__get_cpuid_max(0, NULL) < 7)
+    return FALSE;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+  return (ebx & bit_SHA) != 0;
+}
+
+/* Run 4 SHA1 rounds using round function F on ABCD and the E value EA,
+ * which gets combined with message words M0.  Advance the message
+ * schedule in M1 .. M3 and save the current ABCD in EB.
+ */
+#define SHA1_ROUNDS4(EA, EB, M0, M1, M2, M3, F) \
+  do {                                          \
+    EA = _mm_sha1nexte_epu32(EA, M0);           \
+    EB = abcd;                                  \
+    M1 = _mm_sha1msg2_epu32(M1, M0);            \
+    abcd = _mm_sha1rnds4_epu32(abcd, EA, F);    \
+    M3 = _mm_sha1msg1_epu32(M3, M0);            \
+    M2 = _mm_xor_si128(M2, M0);                 \
+  } while (0)
+
+/* Update STATE with the COUNT blocks of 64 bytes each in DATA. */
+__attribute__((target("sha,ssse3,sse4.1")))
+static void
+sha1_blocks(apr_uint32_t state[5],
+            const unsigned char *data,
+            apr_size_t count)
+{
+  const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+                                      0x08090a0b0c0d0e0fULL);
+  __m128i abcd, abcd_save, e0, e0_save, e1;
+  __m128i msg0, msg1, msg2, msg3;
+
+  abcd = _mm_loadu_si128((const __m128i *)state);
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+  e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+  for (; count; --count, data += SHA1_BLOCK_SIZE)
+    {
+      abcd_save = abcd;
+      e0_save = e0;
+
+      /* Rounds 0 - 15 consume the message block itself. */
+      msg0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), mask);
+      e0 = _mm_add_epi32(e0, msg0);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+      msg1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)),
+                              mask);
+      e1 = _mm_sha1nexte_epu32(e1, msg1);
+      e0 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+      msg2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)),
+                              mask);
+      e0 = _mm_sha1nexte_epu32(e0, msg2);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+      msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+      msg0 = _mm_xor_si128(msg0, msg2);
+
+      msg3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)),
+                              mask);
+      e1 = _mm_sha1nexte_epu32(e1, msg3);
+      e0 = abcd;
+      msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+      abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+      msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+      msg1 = _mm_xor_si128(msg1, msg3);
+
+      /* Rounds 16 - 79 use the expanded message schedule. */
+      SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 0);
+      SHA1_ROUNDS4(e1, e0, msg1, msg2, msg3, msg0, 1);
+      SHA1_ROUNDS4(e0, e1, msg2, msg3, msg0, msg1, 1);
+      SHA1_ROUNDS4(e1, e0, msg3, msg0, msg1, msg2, 1);
+      SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 1);
+      SHA1_ROUNDS4(e1, e0, msg1, msg2, msg3, msg0, 1);
+      SHA1_ROUNDS4(e0, e1, msg2, msg3, msg0, msg1, 2);
+      SHA1_ROUNDS4(e1, e0, msg3, msg0, msg1, msg2, 2);
+      SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 2);
+      SHA1_ROUNDS4(e1, e0, msg1, msg2, msg3, msg0, 2);
+      SHA1_ROUNDS4(e0, e1, msg2, msg3, msg0, msg1, 2);
+      SHA1_ROUNDS4(e1, e0, msg3, msg0, msg1, msg2, 3);
+      SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 3);
+      SHA1_ROUNDS4(e1, e0, msg1, msg2, msg3, msg0, 3);
+      SHA1_ROUNDS4(e0, e1, msg2, msg3, msg0, msg1, 3);
+      SHA1_ROUNDS4(e1, e0, msg3, msg0, msg1, msg2, 3);
+
+      /* Add this block's result to the intermediate hash value. */
+      e0 = _mm_sha1nexte_epu32(e0, e0_save);
+      abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+  abcd = _mm_shuffle_epi32(abcd, 0x1b);
+  _mm_storeu_si128((__m128i *)state, abcd);
+  state[4] = (apr_uint32_t)_mm_extract_epi32(e0, 3);
+}
+
+#endif /* SVN_SHA1_SHANI */
+
+svn_boolean_t
+svn_sha1__accelerated(void)
+{
+#ifdef SVN_SHA1_SHANI
+  /* 0 = not checked, yet, 1 = supported, 2 = not supported.
+   * Concurrent first calls will simply yield the same result. */
+  static volatile int supported = 0;
+  if (supported == 0)
+    supported = detect_shani() ? 1 : 2;
+
+  return supported == 1;
+#else
+  return FALSE;
+#endif
+}
+
+svn_sha1__context_t *
+svn_sha1__context_create(apr_pool_t *pool)
+{
+  svn_sha1__context_t *context = apr_palloc(pool, sizeof(*context));
+  svn_sha1__context_reset(context);
+
+  return context;
+}
+
+void
+svn_sha1__context_reset(svn_sha1__context_t *context)
+{
+  context->state[0] = 0x67452301;
+  context->state[1] = 0xefcdab89;
+  context->state[2] = 0x98badcfe;
+  context->state[3] = 0x10325476;
+  context->state[4] = 0xc3d2e1f0;
+  context->length = 0;
+}
+
+void
+svn_sha1__update(svn_sha1__context_t *context,
+                 const void *data,
+                 apr_size_t len)
+{
+#ifdef SVN_SHA1_SHANI
+  const unsigned char *input = data;
+  apr_size_t buffered = (apr_size_t)(context->length % SHA1_BLOCK_SIZE);
+  apr_size_t count;
+
+  context->length += len;
+
+  /* Complete a partially filled block first. */
+  if (buffered)
+    {
+      apr_size_t to_copy = SHA1_BLOCK_SIZE - buffered;
+      if (to_copy > len)
+        to_copy = len;
+
+      memcpy(context->buffer + buffered, input, to_copy);
+      input += to_copy;
+      len -= to_copy;
+
+      if (buffered + to_copy < SHA1_BLOCK_SIZE)
+        return;
+
+      sha1_blocks(context->state, context->buffer, 1);
+    }
+
+  /* Process all full blocks directly from the input. */
+  count = len / SHA1_BLOCK_SIZE;
+  if (count)
+    {
+      sha1_blocks(context->state, input, count);
+      input += count * SHA1_BLOCK_SIZE;
+      len -= count * SHA1_BLOCK_SIZE;
+    }
+
+  /* Keep the remainder for later. */
+  memcpy(context->buffer, input, len);
+#endif
+}
+
+void
+svn_sha1__finalize(unsigned char digest[APR_SHA1_DIGESTSIZE],
+                   svn_sha1__context_t *context)
+{
+  unsigned char padding[2 * SHA1_BLOCK_SIZE] = { 0x80 };
+  apr_uint64_t bits = context->length * 8;
+  apr_size_t buffered = (apr_size_t)(context->length % SHA1_BLOCK_SIZE);
+  apr_size_t pad_len;
+  int i;
+
+  /* Append 0x80, zeros and the 64 bit big-endian message length such
+   * that the total length becomes a multiple of the block size. */
+  pad_len = (buffered < SHA1_BLOCK_SIZE - 8)
+          ? SHA1_BLOCK_SIZE - 8 - buffered
+          : 2 * SHA1_BLOCK_SIZE - 8 - buffered;
+  for (i = 0; i < 8; ++i)
+    padding[pad_len + i] = (unsigned char)(bits >> (56 - 8 * i));
+
+  svn_sha1__update(context, padding, pad_len + 8);
+
+  for (i = 0; i < 5; ++i)
+    {
+      digest[4 * i]     = (unsigned char)(context->state[i] >> 24);
+      digest[4 * i + 1] = (unsigned char)(context->state[i] >> 16);
+      digest[4 * i + 2] = (unsigned char)(context->state[i] >> 8);
+      digest[4 * i + 3] = (unsigned char)(context->state[i]);
+    }
+}
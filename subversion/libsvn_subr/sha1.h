@@ -0,0 +1,75 @@
+/*
+ * sha1.h :  hardware-accelerated SHA1 checksum routines
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_LIBSVN_SUBR_SHA1_H
+#define SVN_LIBSVN_SUBR_SHA1_H
+
+#include <apr_pools.h>
+#include <apr_sha1.h>
+
+#include "svn_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Return TRUE if the CPU we are running on supports the SHA instructions
+ * used by svn_sha1__context_t.  If this returns FALSE, none of the other
+ * functions in this header may be called; use APR's implementation then.
+ */
+svn_boolean_t
+svn_sha1__accelerated(void);
+
+/* Opaque hardware-accelerated SHA1 checksum creation context type.
+ */
+typedef struct svn_sha1__context_t svn_sha1__context_t;
+
+/* Return a new SHA1 checksum creation context allocated in POOL.
+ */
+svn_sha1__context_t *
+svn_sha1__context_create(apr_pool_t *pool);
+
+/* Reset the SHA1 checksum CONTEXT to initial state.
+ */
+void
+svn_sha1__context_reset(svn_sha1__context_t *context);
+
+/* Feed LEN bytes from DATA into the SHA1 checksum creation CONTEXT.
+ */
+void
+svn_sha1__update(svn_sha1__context_t *context,
+                 const void *data,
+                 apr_size_t len);
+
+/* Write the SHA1 checksum over all data fed into CONTEXT to DIGEST.
+ * CONTEXT must be reset before it can be used again.
+ */
+void
+svn_sha1__finalize(unsigned char digest[APR_SHA1_DIGESTSIZE],
+                   svn_sha1__context_t *context);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_SUBR_SHA1_H */
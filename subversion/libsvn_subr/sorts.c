@@ -396,6 +396,12 @@ svn_sort__array_reverse(apr_array_header_t *array,
     }
 }
 
+/* Number of children per heap node.  A wider heap is shallower, so
+ * elements get moved fewer times while the number of comparisons per
+ * push or pop stays about the same as for a binary heap.
+ */
+#define HEAP_ARITY 4
+
 /* Our priority queue data structure:
  * Simply remember the constructor parameters.
  */
@@ -406,42 +412,18 @@ struct svn_priority_queue__t
 
   /* predicate used to order the heap */
   int (*compare_func)(const void *, const void *);
-};
-
-/* Return TRUE, if heap element number LHS in QUEUE is smaller than element
- * number RHS according to QUEUE->COMPARE_FUNC
- */
-static int
-heap_is_less(svn_priority_queue__t *queue,
-             apr_size_t lhs,
-             apr_size_t rhs)
-{
-  char *lhs_value = queue->elements->elts + lhs * queue->elements->elt_size;
-  char *rhs_value = queue->elements->elts + rhs * queue->elements->elt_size;
 
-  /* nelts is never negative */
-  assert(lhs < (apr_size_t)queue->elements->nelts);
-  assert(rhs < (apr_size_t)queue->elements->nelts);
-  return queue->compare_func(lhs_value, rhs_value) < 0;
-}
+  /* buffer of ELEMENTS->ELT_SIZE bytes holding the element being moved */
+  char *temp;
+};
 
-/* Exchange elements number LHS and RHS in QUEUE.
+/* Return a pointer to heap element number IDX in QUEUE.
  */
-static void
-heap_swap(svn_priority_queue__t *queue,
-          apr_size_t lhs,
-          apr_size_t rhs)
+static APR_INLINE char *
+heap_element(svn_priority_queue__t *queue,
+             int idx)
 {
-  int i;
-  char *lhs_value = queue->elements->elts + lhs * queue->elements->elt_size;
-  char *rhs_value = queue->elements->elts + rhs * queue->elements->elt_size;
-
-  for (i = 0; i < queue->elements->elt_size; ++i)
-    {
-      char temp = lhs_value[i];
-      lhs_value[i] = rhs_value[i];
-      rhs_value[i] = temp;
-    }
+  return queue->elements->elts + (apr_size_t)idx * queue->elements->elt_size;
 }
 
 /* Move element number IDX to lower indexes until the heap criterion is
@@ -451,11 +433,25 @@ static void
 heap_bubble_down(svn_priority_queue__t *queue,
                  int idx)
 {
-  while (idx > 0 && heap_is_less(queue, idx, (idx - 1) / 2))
+  apr_size_t elt_size = queue->elements->elt_size;
+
+  if (idx == 0)
+    return;
+
+  /* Move parents up into the gap instead of swapping element by element
+   * and only store the element once we found its final position. */
+  memcpy(queue->temp, heap_element(queue, idx), elt_size);
+  while (idx > 0)
     {
-      heap_swap(queue, idx, (idx - 1) / 2);
-      idx = (idx - 1) / 2;
+      int parent = (idx - 1) / HEAP_ARITY;
+      if (queue->compare_func(queue->temp, heap_element(queue, parent)) >= 0)
+        break;
+
+      memcpy(heap_element(queue, idx), heap_element(queue, parent), elt_size);
+      idx = parent;
     }
+
+  memcpy(heap_element(queue, idx), queue->temp, elt_size);
 }
 
 /* Move element number IDX to higher indexes until the heap criterion is
@@ -465,22 +461,40 @@ static void
 heap_bubble_up(svn_priority_queue__t *queue,
                int idx)
 {
-  while (2 * idx + 2 < queue->elements->nelts)
-    {
-      int child = heap_is_less(queue, 2 * idx + 1, 2 * idx + 2)
-                ? 2 * idx + 1
-                : 2 * idx + 2;
+  apr_size_t elt_size = queue->elements->elt_size;
+  int count = queue->elements->nelts;
 
-      if (heap_is_less(queue, idx, child))
-        return;
+  /* Leaves (and empty queues) need no reordering. */
+  if (idx * HEAP_ARITY + 1 >= count)
+    return;
 
-      heap_swap(queue, idx, child);
+  memcpy(queue->temp, heap_element(queue, idx), elt_size);
+  for (;;)
+    {
+      int first = idx * HEAP_ARITY + 1;
+      int last = first + HEAP_ARITY;
+      int child = first;
+      int i;
+
+      if (first >= count)
+        break;
+      if (last > count)
+        last = count;
+
+      /* Find the smallest child. */
+      for (i = first + 1; i < last; ++i)
+        if (queue->compare_func(heap_element(queue, i),
+                                heap_element(queue, child)) < 0)
+          child = i;
+
+      if (queue->compare_func(heap_element(queue, child), queue->temp) >= 0)
+        break;
+
+      memcpy(heap_element(queue, idx), heap_element(queue, child), elt_size);
       idx = child;
     }
 
-  if (   2 * idx + 1 < queue->elements->nelts
-      && heap_is_less(queue, 2 * idx + 1, idx))
-    heap_swap(queue, 2 * idx + 1, idx);
+  memcpy(heap_element(queue, idx), queue->temp, elt_size);
 }
 
 svn_priority_queue__t *
@@ -492,8 +506,9 @@ svn_priority_queue__create(apr_array_header_t *elements,
   svn_priority_queue__t *queue = apr_pcalloc(elements->pool, sizeof(*queue));
   queue->elements = elements;
   queue->compare_func = compare_func;
+  queue->temp = apr_palloc(elements->pool, elements->elt_size);
 
-  for (i = elements->nelts / 2; i >= 0; --i)
+  for (i = elements->nelts / HEAP_ARITY; i >= 0; --i)
     heap_bubble_up(queue, i);
 
   return queue;
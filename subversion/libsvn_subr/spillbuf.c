@@ -26,6 +26,7 @@
 #include "svn_io.h"
 #include "svn_pools.h"
 
+#include "private/svn_io_private.h"
 #include "private/svn_subr_private.h"
 
 
@@ -74,6 +75,12 @@ struct svn_spillbuf_t {
   /* How much content remains in SPILL.  */
   svn_filesize_t spill_size;
 
+  /* When true, the file pointer of SPILL is at SPILL_START, ready for
+     the next read.  Otherwise, it is at the end of the file, ready for
+     the next write.  This saves us from seeking (and flushing the file
+     buffer) for every single write or read.  */
+  svn_boolean_t spill_reading;
+
   /* When false, do not delete the spill file when it is closed. */
   svn_boolean_t delete_on_close;
 
@@ -278,13 +285,17 @@ svn_spillbuf__write(svn_spillbuf_t *buf,
      in memory.  */
   if (buf->spill != NULL)
     {
-      apr_off_t output_unused = 0;  /* ### stupid API  */
+      /* Seek to the end of the spill file, if a read has occurred since
+         our last write and moved the file position.  */
+      if (buf->spill_reading)
+        {
+          apr_off_t output_unused = 0;  /* ### stupid API  */
 
-      /* Seek to the end of the spill file. We don't know if a read has
-         occurred since our last write, and moved the file position.  */
-      SVN_ERR(svn_io_file_seek(buf->spill,
-                               APR_END, &output_unused,
-                               scratch_pool));
+          SVN_ERR(svn_io_file_seek(buf->spill,
+                                   APR_END, &output_unused,
+                                   scratch_pool));
+          buf->spill_reading = FALSE;
+        }
 
       SVN_ERR(svn_io_file_write_full(buf->spill, data, len,
                                      NULL, scratch_pool));
@@ -409,6 +420,7 @@ read_data(struct memblock_t **mem,
       SVN_ERR(svn_io_file_close(buf->spill, scratch_pool));
       buf->spill = NULL;
       buf->spill_start = 0;
+      buf->spill_reading = FALSE;
     }
 
   /* *mem has been initialized. Done.  */
@@ -417,13 +429,12 @@ read_data(struct memblock_t **mem,
 
 
 /* If the next read would consume data from the file, then seek to the
-   correct position.  */
+   correct position, unless we are there already.  */
 static svn_error_t *
-maybe_seek(svn_boolean_t *seeked,
-           const svn_spillbuf_t *buf,
+maybe_seek(svn_spillbuf_t *buf,
            apr_pool_t *scratch_pool)
 {
-  if (buf->head == NULL && buf->spill != NULL)
+  if (buf->head == NULL && buf->spill != NULL && !buf->spill_reading)
     {
       apr_off_t output_unused;
 
@@ -432,12 +443,7 @@ maybe_seek(svn_boolean_t *seeked,
       SVN_ERR(svn_io_file_seek(buf->spill,
                                APR_SET, &output_unused,
                                scratch_pool));
-      if (seeked != NULL)
-        *seeked = TRUE;
-    }
-  else if (seeked != NULL)
-    {
-      *seeked = FALSE;
+      buf->spill_reading = TRUE;
     }
 
   return SVN_NO_ERROR;
@@ -453,7 +459,7 @@ svn_spillbuf__read(const char **data,
   struct memblock_t *mem;
 
   /* Possibly seek... */
-  SVN_ERR(maybe_seek(NULL, buf, scratch_pool));
+  SVN_ERR(maybe_seek(buf, scratch_pool));
 
   SVN_ERR(read_data(&mem, buf, scratch_pool));
   if (mem == NULL)
@@ -485,7 +491,6 @@ svn_spillbuf__process(svn_boolean_t *exhausted,
                       void *read_baton,
                       apr_pool_t *scratch_pool)
 {
-  svn_boolean_t has_seeked = FALSE;
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
 
   *exhausted = FALSE;
@@ -498,10 +503,10 @@ svn_spillbuf__process(svn_boolean_t *exhausted,
 
       svn_pool_clear(iterpool);
 
-      /* If this call to read_data() will read from the spill file, and we
-         have not seek'd the file... then do it now.  */
-      if (!has_seeked)
-        SVN_ERR(maybe_seek(&has_seeked, buf, iterpool));
+      /* If this call to read_data() will read from the spill file, make
+         sure we read from the right position.  READ_FUNC may have added
+         content in the meantime.  */
+      SVN_ERR(maybe_seek(buf, iterpool));
 
       /* Get some content to pass to the read callback.  */
       SVN_ERR(read_data(&mem, buf, iterpool));
@@ -671,6 +676,53 @@ read_handler_spillbuf(void *baton, char *buffer, apr_size_t *len)
 }
 
 
+static svn_error_t *
+read_borrowed_handler_spillbuf(void *baton, const char **data,
+                               apr_size_t *len)
+{
+  struct spillbuf_baton *sb = baton;
+  svn_spillbuf_reader_t *reader = sb->reader;
+
+  if (reader->save_len > 0)
+    {
+      /* Hand out the saved content first.  */
+      if (*len > reader->save_len)
+        *len = reader->save_len;
+
+      *data = reader->save_ptr + reader->save_pos;
+      reader->save_pos += *len;
+      reader->save_len -= *len;
+
+      return SVN_NO_ERROR;
+    }
+
+  if (reader->sb_len == 0)
+    {
+      SVN_ERR(svn_spillbuf__read(&reader->sb_ptr, &reader->sb_len,
+                                 reader->buf, sb->scratch_pool));
+      svn_pool_clear(sb->scratch_pool);
+
+      if (reader->sb_ptr == NULL)
+        {
+          reader->sb_len = 0;
+          *len = 0;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  /* Lend the spillbuf's block directly.  It stays valid until the next
+     svn_spillbuf__read() or write.  */
+  if (*len > reader->sb_len)
+    *len = reader->sb_len;
+
+  *data = reader->sb_ptr;
+  reader->sb_ptr += *len;
+  reader->sb_len -= *len;
+
+  return SVN_NO_ERROR;
+}
+
+
 static svn_error_t *
 write_handler_spillbuf(void *baton, const char *data, apr_size_t *len)
 {
@@ -700,6 +752,7 @@ svn_stream__from_spillbuf(svn_spillbuf_t *buf,
   svn_stream_set_read2(stream, NULL /* only full read support */,
                        read_handler_spillbuf);
   svn_stream_set_write(stream, write_handler_spillbuf);
+  svn_stream__set_read_borrowed(stream, read_borrowed_handler_spillbuf);
 
   return stream;
 }
@@ -21,6 +21,7 @@
  */
 
 #include <apr_pools.h>
+#include <apr_strings.h>
 
 #include "svn_types.h"
 #include "svn_error.h"
@@ -36,6 +37,7 @@
 #include "private/svn_dep_compat.h"
 #include "private/svn_atomic.h"
 #include "private/svn_skel.h"
+#include "private/svn_stats.h"
 #include "private/svn_token.h"
 #ifdef WIN32
 #include "private/svn_io_private.h"
@@ -142,6 +144,17 @@ struct svn_sqlite__db_t
   svn_sqlite__stmt_t **prepared_stmts;
   apr_pool_t *state_pool;
 
+  /* Names of STATEMENT_STRINGS for statistics, may be NULL.  See
+     svn_sqlite__set_statement_info(). */
+  const char * const (*statement_info)[2];
+
+  /* Set while a batch is open, see svn_sqlite__begin_batch(). */
+  svn_boolean_t batch;
+
+  /* The number of transactions and savepoints rolled back in DB, see
+     svn_sqlite__change_stamp(). */
+  apr_int64_t rollbacks;
+
 #ifdef SVN_UNICODE_NORMALIZATION_FIXES
   /* Buffers for SQLite extensoins. */
   svn_membuf_t sqlext_buf1;
@@ -155,6 +168,12 @@ struct svn_sqlite__stmt_t
   sqlite3_stmt *s3stmt;
   svn_sqlite__db_t *db;
   svn_boolean_t needs_reset;
+
+  /* Per-statement step timer or NULL. */
+  svn_stats__counter_t *timer;
+
+  /* Per-statement full table scan step counter or NULL. */
+  svn_stats__counter_t *scans;
 };
 
 struct svn_sqlite__context_t
@@ -250,6 +269,8 @@ prepare_statement(svn_sqlite__stmt_t **stmt, svn_sqlite__db_t *db,
   *stmt = apr_palloc(result_pool, sizeof(**stmt));
   (*stmt)->db = db;
   (*stmt)->needs_reset = FALSE;
+  (*stmt)->timer = NULL;
+  (*stmt)->scans = NULL;
 
   SQLITE_ERR(sqlite3_prepare_v2(db->db3, text, -1, &(*stmt)->s3stmt, NULL), db);
 
@@ -257,6 +278,73 @@ prepare_statement(svn_sqlite__stmt_t **stmt, svn_sqlite__db_t *db,
 }
 
 
+void
+svn_sqlite__set_statement_info(svn_sqlite__db_t *db,
+                               const char * const statement_info[][2])
+{
+  db->statement_info = statement_info;
+}
+
+/* Set *WAL to whether DB uses write-ahead logging. */
+static svn_error_t *
+get_wal_mode(svn_boolean_t *wal,
+             svn_sqlite__db_t *db,
+             apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  const char *mode;
+
+  SVN_ERR(prepare_statement(&stmt, db, "PRAGMA journal_mode;", scratch_pool));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+
+  mode = svn_sqlite__column_text(stmt, 0, NULL);
+  *wal = mode && svn_cstring_casecmp(mode, "wal") == 0;
+
+  return svn_error_trace(svn_sqlite__finalize(stmt));
+}
+
+svn_error_t *
+svn_sqlite__tune(svn_sqlite__db_t *db,
+                 apr_int64_t cache_size,
+                 apr_int64_t mmap_size,
+                 svn_boolean_t use_wal,
+                 apr_pool_t *scratch_pool)
+{
+  /* A negative cache_size is interpreted by SQLite as a size in kBytes
+     rather than a number of pages, making it independent of the page
+     size of this particular database. */
+  if (cache_size > 0)
+    SVN_ERR(exec_sql(db, apr_psprintf(scratch_pool,
+                                      "PRAGMA cache_size = -%" APR_INT64_T_FMT
+                                      ";", cache_size / 1024 + 1)));
+
+  /* Silently ignored if the platform or SQLite build doesn't support it. */
+  if (mmap_size > 0)
+    SVN_ERR(exec_sql(db, apr_psprintf(scratch_pool,
+                                      "PRAGMA mmap_size = %" APR_INT64_T_FMT
+                                      ";", mmap_size)));
+
+  /* The journal mode is stored in the database file.  SQLite keeps the
+     previous mode if the VFS does not support WAL.  Leaving WAL mode
+     requires exclusive access, so we merely try and will try again the
+     next time someone opens the database. */
+  if (use_wal)
+    {
+      SVN_ERR(exec_sql(db, "PRAGMA journal_mode = WAL;"));
+    }
+  else
+    {
+      svn_boolean_t wal;
+
+      SVN_ERR(get_wal_mode(&wal, db, scratch_pool));
+      if (wal)
+        SVN_ERR(exec_sql2(db, "PRAGMA journal_mode = TRUNCATE;",
+                          SQLITE_BUSY));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_sqlite__exec_statements(svn_sqlite__db_t *db, int stmt_idx)
 {
@@ -273,9 +361,24 @@ svn_sqlite__get_statement(svn_sqlite__stmt_t **stmt, svn_sqlite__db_t *db,
   SVN_ERR_ASSERT(stmt_idx < db->nbr_statements);
 
   if (db->prepared_stmts[stmt_idx] == NULL)
-    SVN_ERR(prepare_statement(&db->prepared_stmts[stmt_idx], db,
-                              db->statement_strings[stmt_idx],
-                              db->state_pool));
+    {
+      SVN_ERR(prepare_statement(&db->prepared_stmts[stmt_idx], db,
+                                db->statement_strings[stmt_idx],
+                                db->state_pool));
+
+      if (db->statement_info && svn_stats__enabled())
+        {
+          char name[128];
+
+          apr_snprintf(name, sizeof(name), "sqlite.%s",
+                       db->statement_info[stmt_idx][0]);
+          db->prepared_stmts[stmt_idx]->timer = svn_stats__get_counter(name);
+
+          apr_snprintf(name, sizeof(name), "sqlite.%s.fullscan_steps",
+                       db->statement_info[stmt_idx][0]);
+          db->prepared_stmts[stmt_idx]->scans = svn_stats__get_counter(name);
+        }
+    }
 
   *stmt = db->prepared_stmts[stmt_idx];
 
@@ -341,10 +444,19 @@ svn_sqlite__step_row(svn_sqlite__stmt_t *stmt)
 }
 
 
+SVN__COUNTER_DEFINE(step_timer, "sqlite.step");
+
 svn_error_t *
 svn_sqlite__step(svn_boolean_t *got_row, svn_sqlite__stmt_t *stmt)
 {
-  int sqlite_result = sqlite3_step(stmt->s3stmt);
+  int sqlite_result;
+  apr_time_t start;
+
+  SVN__TIMER_START(step_timer, start);
+  sqlite_result = sqlite3_step(stmt->s3stmt);
+  SVN__TIMER_STOP(step_timer, start);
+  if (stmt->timer)
+    SVN__TIMER_STOP(*stmt->timer, start);
 
   if (sqlite_result != SQLITE_DONE && sqlite_result != SQLITE_ROW)
     {
@@ -737,9 +849,56 @@ svn_sqlite__column_bytes(svn_sqlite__stmt_t *stmt, int column)
   return sqlite3_column_bytes(stmt->s3stmt, column);
 }
 
+SVN__COUNTER_DEFINE(fullscan_counter, "sqlite.fullscan_steps");
+SVN__COUNTER_DEFINE(sort_counter, "sqlite.sorts");
+SVN__COUNTER_DEFINE(autoindex_counter, "sqlite.autoindexes");
+#ifdef SQLITE_STMTSTATUS_VM_STEP
+SVN__COUNTER_DEFINE(vm_step_counter, "sqlite.vm_steps");
+#endif
+
+/* Add the query plan statistics that SQLite gathered for STMT since its
+   last reset to our counters and clear them in STMT. */
+static void
+record_stmt_status(svn_sqlite__stmt_t *stmt)
+{
+  int fullscan_steps, sorts, autoindexes;
+
+  if (!svn_stats__enabled())
+    return;
+
+  /* Full scans and sorts on every execution are what make individual
+     statements slow on large working copies. */
+  fullscan_steps = sqlite3_stmt_status(stmt->s3stmt,
+                                       SQLITE_STMTSTATUS_FULLSCAN_STEP, TRUE);
+  sorts = sqlite3_stmt_status(stmt->s3stmt, SQLITE_STMTSTATUS_SORT, TRUE);
+  autoindexes = sqlite3_stmt_status(stmt->s3stmt,
+                                    SQLITE_STMTSTATUS_AUTOINDEX, TRUE);
+
+  if (fullscan_steps)
+    {
+      SVN__COUNTER_ADD(fullscan_counter, fullscan_steps);
+      if (stmt->scans)
+        svn_stats__counter_add(stmt->scans, fullscan_steps);
+    }
+  if (sorts)
+    SVN__COUNTER_ADD(sort_counter, sorts);
+  if (autoindexes)
+    SVN__COUNTER_ADD(autoindex_counter, autoindexes);
+
+#ifdef SQLITE_STMTSTATUS_VM_STEP
+  {
+    int vm_steps = sqlite3_stmt_status(stmt->s3stmt,
+                                       SQLITE_STMTSTATUS_VM_STEP, TRUE);
+    if (vm_steps)
+      SVN__COUNTER_ADD(vm_step_counter, vm_steps);
+  }
+#endif
+}
+
 svn_error_t *
 svn_sqlite__finalize(svn_sqlite__stmt_t *stmt)
 {
+  record_stmt_status(stmt);
   SQLITE_ERR(sqlite3_finalize(stmt->s3stmt), stmt->db);
   return SVN_NO_ERROR;
 }
@@ -760,6 +919,7 @@ svn_sqlite__reset(svn_sqlite__stmt_t *stmt)
      (In this case the statement is also properly reset).
 
      See the sqlite3_reset() documentation for more details. */
+  record_stmt_status(stmt);
   SQLITE_ERR(sqlite3_reset(stmt->s3stmt), stmt->db);
   return SVN_NO_ERROR;
 }
@@ -1164,11 +1324,21 @@ svn_sqlite__open(svn_sqlite__db_t **db, const char *path,
                  affects application(read: Subversion) performance/behavior. */
               "PRAGMA foreign_keys=OFF;"      /* SQLITE_DEFAULT_FOREIGN_KEYS*/
               "PRAGMA locking_mode = NORMAL;" /* SQLITE_DEFAULT_LOCKING_MODE */
-              /* Testing shows TRUNCATE is faster than DELETE on Windows. */
-              "PRAGMA journal_mode = TRUNCATE;"
               ),
                 *db);
 
+  /* Testing shows TRUNCATE is faster than DELETE on Windows.  Databases
+     that svn_sqlite__tune() switched to WAL mode stay in that mode, as
+     leaving it would fail while other connections use the database. */
+  {
+    svn_boolean_t wal;
+
+    SVN_SQLITE__ERR_CLOSE(get_wal_mode(&wal, *db, scratch_pool), *db);
+    if (!wal)
+      SVN_SQLITE__ERR_CLOSE(exec_sql(*db, "PRAGMA journal_mode = TRUNCATE;"),
+                            *db);
+  }
+
 #if defined(SVN_DEBUG)
   /* When running in debug mode, enable the checking of foreign key
      constraints.  This has possible performance implications, so we don't
@@ -1293,6 +1463,8 @@ rollback_transaction(svn_sqlite__db_t *db,
         }
     }
 
+  db->rollbacks++;
+
   if (err)
     {
       /* Rollback failed, use a specific error code. */
@@ -1307,6 +1479,9 @@ svn_sqlite__begin_transaction(svn_sqlite__db_t *db)
 {
   svn_sqlite__stmt_t *stmt;
 
+  if (db->batch)
+    return svn_error_trace(svn_sqlite__begin_savepoint(db));
+
   SVN_ERR(get_internal_statement(&stmt, db,
                                  STMT_INTERNAL_BEGIN_TRANSACTION));
   SVN_ERR(svn_sqlite__step_done(stmt));
@@ -1318,6 +1493,10 @@ svn_sqlite__begin_immediate_transaction(svn_sqlite__db_t *db)
 {
   svn_sqlite__stmt_t *stmt;
 
+  /* The batch already holds the 'RESERVED' lock. */
+  if (db->batch)
+    return svn_error_trace(svn_sqlite__begin_savepoint(db));
+
   SVN_ERR(get_internal_statement(&stmt, db,
                                  STMT_INTERNAL_BEGIN_IMMEDIATE_TRANSACTION));
   SVN_ERR(svn_sqlite__step_done(stmt));
@@ -1341,6 +1520,9 @@ svn_sqlite__finish_transaction(svn_sqlite__db_t *db,
 {
   svn_sqlite__stmt_t *stmt;
 
+  if (db->batch)
+    return svn_error_trace(svn_sqlite__finish_savepoint(db, err));
+
   /* Commit or rollback the sqlite transaction. */
   if (err)
     {
@@ -1409,6 +1591,7 @@ svn_sqlite__finish_savepoint(svn_sqlite__db_t *db,
             }
         }
 
+      db->rollbacks++;
       err = svn_error_compose_create(err, err2);
       err2 = get_internal_statement(&stmt, db,
                                     STMT_INTERNAL_RELEASE_SAVEPOINT_SVN);
@@ -1427,6 +1610,42 @@ svn_sqlite__finish_savepoint(svn_sqlite__db_t *db,
   return svn_error_trace(svn_sqlite__step_done(stmt));
 }
 
+svn_error_t *
+svn_sqlite__begin_batch(svn_sqlite__db_t *db)
+{
+  if (db->batch)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__begin_immediate_transaction(db));
+  db->batch = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_sqlite__finish_batch(svn_sqlite__db_t *db,
+                         svn_error_t *err)
+{
+  if (!db->batch)
+    return svn_error_trace(err);
+
+  db->batch = FALSE;
+  return svn_error_trace(svn_sqlite__finish_transaction(db, err));
+}
+
+svn_boolean_t
+svn_sqlite__in_batch(svn_sqlite__db_t *db)
+{
+  return db->batch;
+}
+
+apr_int64_t
+svn_sqlite__change_stamp(svn_sqlite__db_t *db)
+{
+  /* Both only ever grow, so their sum changes whenever either does. */
+  return (apr_int64_t)sqlite3_total_changes(db->db3) + db->rollbacks;
+}
+
 svn_error_t *
 svn_sqlite__with_transaction(svn_sqlite__db_t *db,
                              svn_sqlite__transaction_callback_t cb_func,
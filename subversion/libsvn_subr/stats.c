@@ -0,0 +1,333 @@
+/*
+ * stats.c :  lightweight process-wide counters and timers
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <apr_atomic.h>
+
+#include "svn_string.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_sorts_private.h"
+#include "private/svn_stats.h"
+
+/* Values of ENABLED_OVERRIDE. */
+#define OVERRIDE_NONE    0
+#define OVERRIDE_OFF     1
+#define OVERRIDE_ON      2
+
+/* Set by svn_stats__set_enabled(). */
+static volatile svn_atomic_t enabled_override = OVERRIDE_NONE;
+
+/* Whether collection has been enabled by the environment. */
+static svn_boolean_t env_enabled = FALSE;
+static volatile svn_atomic_t env_init_state = 0;
+
+/* Whether we registered the exit time report. */
+static volatile svn_atomic_t report_registered = FALSE;
+
+/* Head of the list of registered counters.  Only ever grows. */
+static volatile void *counters = NULL;
+
+/* Return the head of the COUNTERS list. */
+static svn_stats__counter_t *
+first_counter(void)
+{
+  return apr_atomic_casptr(&counters, NULL, NULL);
+}
+
+/* Implements svn_atomic__str_init_func_t.  Read SVN_STATS. */
+static const char *
+init_env_enabled(void *baton)
+{
+  const char *value = getenv("SVN_STATS");
+
+  env_enabled = value && *value && strcmp(value, "0") != 0;
+  return NULL;
+}
+
+/* Write all non-empty counters to stderr.  This runs from atexit() and
+   must not rely on APR. */
+static void
+report_at_exit(void)
+{
+  svn_stats__counter_t *counter;
+
+  for (counter = first_counter();
+       counter;
+       counter = counter->next)
+    if (counter->count)
+      fprintf(stderr, "svn-stats: %s: %" APR_UINT64_T_FMT " events, total %"
+              APR_UINT64_T_FMT "\n",
+              counter->name, counter->count, counter->total);
+}
+
+/* Return whether new counters should collect data. */
+static svn_boolean_t
+collection_enabled(void)
+{
+  switch (svn_atomic_cas(&enabled_override, OVERRIDE_NONE, OVERRIDE_NONE))
+    {
+      case OVERRIDE_OFF:
+        return FALSE;
+      case OVERRIDE_ON:
+        return TRUE;
+      default:
+        svn_atomic__init_once_no_error(&env_init_state, init_env_enabled,
+                                       NULL);
+        if (env_enabled
+            && svn_atomic_cas(&report_registered, TRUE, FALSE) == FALSE)
+          atexit(report_at_exit);
+        return env_enabled;
+    }
+}
+
+/* Decide whether COUNTER is enabled and register it if it is.
+   Return the new state. */
+static svn_atomic_t
+init_counter(svn_stats__counter_t *counter)
+{
+  void *head;
+
+  if (!collection_enabled())
+    {
+      svn_atomic_cas(&counter->state, SVN_STATS__DISABLED,
+                     SVN_STATS__UNINITIALIZED);
+      return SVN_STATS__DISABLED;
+    }
+
+  /* Only one thread may link COUNTER into the list.  Concurrent updates
+     simply proceed while this is in progress. */
+  if (svn_atomic_cas(&counter->state, SVN_STATS__REGISTERING,
+                     SVN_STATS__UNINITIALIZED) != SVN_STATS__UNINITIALIZED)
+    return SVN_STATS__ENABLED;
+
+  do
+    {
+      head = first_counter();
+      counter->next = head;
+    }
+  while (apr_atomic_casptr(&counters, counter, head) != head);
+
+  svn_atomic_cas(&counter->state, SVN_STATS__ENABLED, SVN_STATS__REGISTERING);
+  return SVN_STATS__ENABLED;
+}
+
+void
+svn_stats__counter_add(svn_stats__counter_t *counter,
+                       apr_uint64_t amount)
+{
+  if (counter->state == SVN_STATS__UNINITIALIZED
+      && init_counter(counter) == SVN_STATS__DISABLED)
+    return;
+
+  /* With older APR versions, concurrent updates may get lost.  That is
+     acceptable for what is only meant as diagnostic data. */
+#if APR_VERSION_AT_LEAST(1,7,0)
+  apr_atomic_inc64(&counter->count);
+  apr_atomic_add64(&counter->total, amount);
+#else
+  counter->count++;
+  counter->total += amount;
+#endif
+}
+
+apr_time_t
+svn_stats__timer_start(svn_stats__counter_t *counter)
+{
+  if (counter->state == SVN_STATS__UNINITIALIZED
+      && init_counter(counter) == SVN_STATS__DISABLED)
+    return 0;
+
+  return apr_time_now();
+}
+
+void
+svn_stats__set_enabled(svn_boolean_t enabled)
+{
+  svn_atomic_t current = svn_atomic_cas(&enabled_override, OVERRIDE_NONE,
+                                        OVERRIDE_NONE);
+
+  svn_atomic_cas(&enabled_override, enabled ? OVERRIDE_ON : OVERRIDE_OFF,
+                 current);
+}
+
+svn_boolean_t
+svn_stats__enabled(void)
+{
+  return collection_enabled();
+}
+
+/* Serializes svn_stats__get_counter() calls. */
+static volatile svn_atomic_t get_counter_lock = FALSE;
+
+svn_stats__counter_t *
+svn_stats__get_counter(const char *name)
+{
+  svn_stats__counter_t *counter;
+
+  if (!collection_enabled())
+    return NULL;
+
+  /* Creating counters is rare and quick, so spinning is fine. */
+  while (svn_atomic_cas(&get_counter_lock, TRUE, FALSE) != FALSE)
+    ;
+
+  for (counter = first_counter(); counter; counter = counter->next)
+    if (strcmp(counter->name, name) == 0)
+      break;
+
+  if (counter == NULL)
+    {
+      char *counter_name = malloc(strlen(name) + 1);
+      counter = calloc(1, sizeof(*counter));
+      if (counter && counter_name)
+        {
+          strcpy(counter_name, name);
+          counter->name = counter_name;
+          counter->state = SVN_STATS__UNINITIALIZED;
+          init_counter(counter);
+        }
+      else
+        {
+          free(counter);
+          free(counter_name);
+          counter = NULL;
+        }
+    }
+
+  svn_atomic_cas(&get_counter_lock, FALSE, TRUE);
+  return counter;
+}
+
+/* Sort svn_stats__info_t * by name. */
+static int
+compare_info_names(const void *a, const void *b)
+{
+  const svn_stats__info_t *lhs = *(const svn_stats__info_t * const *)a;
+  const svn_stats__info_t *rhs = *(const svn_stats__info_t * const *)b;
+
+  return strcmp(lhs->name, rhs->name);
+}
+
+svn_error_t *
+svn_stats__get_info(apr_array_header_t **infos,
+                    apr_pool_t *result_pool)
+{
+  svn_stats__counter_t *counter;
+
+  *infos = apr_array_make(result_pool, 16, sizeof(svn_stats__info_t *));
+  for (counter = first_counter();
+       counter;
+       counter = counter->next)
+    {
+      svn_stats__info_t *info = apr_palloc(result_pool, sizeof(*info));
+
+      info->name = counter->name;
+      info->count = counter->count;
+      info->total = counter->total;
+      APR_ARRAY_PUSH(*infos, svn_stats__info_t *) = info;
+    }
+
+  svn_sort__array(*infos, compare_info_names);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_stats__get_changes(apr_array_header_t **changes,
+                       const apr_array_header_t *before,
+                       const apr_array_header_t *after,
+                       apr_pool_t *result_pool)
+{
+  int i, k = 0;
+
+  *changes = apr_array_make(result_pool, after->nelts,
+                            sizeof(svn_stats__info_t *));
+
+  /* Both arrays are sorted by name and BEFORE is a subset of AFTER. */
+  for (i = 0; i < after->nelts; ++i)
+    {
+      const svn_stats__info_t *new_info
+        = APR_ARRAY_IDX(after, i, const svn_stats__info_t *);
+      const svn_stats__info_t *old_info = NULL;
+      svn_stats__info_t *change;
+
+      while (k < before->nelts)
+        {
+          const svn_stats__info_t *info
+            = APR_ARRAY_IDX(before, k, const svn_stats__info_t *);
+          int diff = strcmp(info->name, new_info->name);
+
+          if (diff > 0)
+            break;
+
+          ++k;
+          if (diff == 0)
+            {
+              old_info = info;
+              break;
+            }
+        }
+
+      if (old_info && old_info->count >= new_info->count)
+        continue;
+
+      change = apr_palloc(result_pool, sizeof(*change));
+      change->name = new_info->name;
+      change->count = new_info->count - (old_info ? old_info->count : 0);
+      change->total = new_info->total - (old_info ? old_info->total : 0);
+      APR_ARRAY_PUSH(*changes, svn_stats__info_t *) = change;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_string_t *
+svn_stats__format_info(const svn_stats__info_t *info,
+                       apr_pool_t *result_pool)
+{
+  apr_uint64_t average = info->count ? info->total / info->count : 0;
+
+  return svn_string_createf(result_pool,
+                            "%s: %" APR_UINT64_T_FMT " events"
+                            ", total %" APR_UINT64_T_FMT
+                            ", average %" APR_UINT64_T_FMT,
+                            info->name, info->count, info->total, average);
+}
+
+void
+svn_stats__reset(void)
+{
+  svn_stats__counter_t *counter;
+
+  for (counter = first_counter();
+       counter;
+       counter = counter->next)
+    {
+      counter->count = 0;
+      counter->total = 0;
+    }
+}
@@ -31,6 +31,8 @@
 #include <apr_errno.h>
 #include <apr_poll.h>
 #include <apr_portable.h>
+#include <apr_thread_cond.h>
+#include <apr_thread_proc.h>
 
 #include <zlib.h>
 
@@ -47,6 +49,7 @@
 #include "private/svn_error_private.h"
 #include "private/svn_eol_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_mutex.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_utf_private.h"
 
@@ -62,6 +65,7 @@ struct svn_stream_t {
   svn_stream_seek_fn_t seek_fn;
   svn_stream_data_available_fn_t data_available_fn;
   svn_stream_readline_fn_t readline_fn;
+  svn_stream__read_borrowed_fn_t read_borrowed_fn;
   apr_file_t *file; /* Maybe NULL */
 };
 
@@ -145,6 +149,13 @@ svn_stream_set_readline(svn_stream_t *stream,
   stream->readline_fn = readline_fn;
 }
 
+void
+svn_stream__set_read_borrowed(svn_stream_t *stream,
+                              svn_stream__read_borrowed_fn_t read_borrowed_fn)
+{
+  stream->read_borrowed_fn = read_borrowed_fn;
+}
+
 /* Standard implementation for svn_stream_read_full() based on
    multiple svn_stream_read2() calls (in separate function to make
    it more likely for svn_stream_read_full to be inlined) */
@@ -194,6 +205,23 @@ svn_stream_read_full(svn_stream_t *stream, char *buffer, apr_size_t *len)
   return svn_error_trace(stream->read_full_fn(stream->baton, buffer, len));
 }
 
+svn_boolean_t
+svn_stream__supports_read_borrowed(svn_stream_t *stream)
+{
+  return stream->read_borrowed_fn != NULL;
+}
+
+svn_error_t *
+svn_stream__read_borrowed(svn_stream_t *stream,
+                          const char **data,
+                          apr_size_t *len)
+{
+  if (stream->read_borrowed_fn == NULL)
+    return svn_error_create(SVN_ERR_STREAM_NOT_SUPPORTED, NULL, NULL);
+
+  return svn_error_trace(stream->read_borrowed_fn(stream->baton, data, len));
+}
+
 svn_error_t *
 svn_stream_skip(svn_stream_t *stream, apr_size_t len)
 {
@@ -402,10 +430,43 @@ svn_error_t *svn_stream_copy3(svn_stream_t *from, svn_stream_t *to,
                               void *cancel_baton,
                               apr_pool_t *scratch_pool)
 {
-  char *buf = apr_palloc(scratch_pool, SVN__STREAM_CHUNK_SIZE);
-  svn_error_t *err;
+  char *buf;
+  svn_error_t *err = SVN_NO_ERROR;
   svn_error_t *err2;
 
+  /* If the source can lend us its buffers, write them out directly
+     instead of copying them into our own buffer first. */
+  if (from->read_borrowed_fn)
+    {
+      while (1)
+        {
+          const char *data;
+          apr_size_t len = SVN__STREAM_CHUNK_SIZE;
+
+          if (cancel_func)
+            {
+              err = cancel_func(cancel_baton);
+              if (err)
+                break;
+            }
+
+          err = from->read_borrowed_fn(from->baton, &data, &len);
+          if (err || len == 0)
+            break;
+
+          err = svn_stream_write(to, data, &len);
+          if (err)
+            break;
+        }
+
+      err2 = svn_error_compose_create(svn_stream_close(from),
+                                      svn_stream_close(to));
+
+      return svn_error_compose_create(err, err2);
+    }
+
+  buf = apr_palloc(scratch_pool, SVN__STREAM_CHUNK_SIZE);
+
   /* Read and write chunks until we get a short read, indicating the
      end of the stream.  (We can't get a short write without an
      associated error.) */
@@ -613,6 +674,12 @@ read_full_handler_disown(void *baton, char *buffer, apr_size_t *len)
   return svn_error_trace(svn_stream_read_full(baton, buffer, len));
 }
 
+static svn_error_t *
+read_borrowed_handler_disown(void *baton, const char **data, apr_size_t *len)
+{
+  return svn_error_trace(svn_stream__read_borrowed(baton, data, len));
+}
+
 static svn_error_t *
 skip_handler_disown(void *baton, apr_size_t len)
 {
@@ -666,6 +733,8 @@ svn_stream_disown(svn_stream_t *stream, apr_pool_t *pool)
   svn_stream_set_seek(s, seek_handler_disown);
   svn_stream_set_data_available(s, data_available_disown);
   svn_stream_set_readline(s, readline_handler_disown);
+  if (svn_stream__supports_read_borrowed(stream))
+    svn_stream__set_read_borrowed(s, read_borrowed_handler_disown);
 
   return s;
 }
@@ -1125,6 +1194,402 @@ svn_stream__aprfile(svn_stream_t *stream)
   return stream->file;
 }
 
+
+/* Read-ahead stream support */
+
+#if APR_HAS_THREADS
+
+/* Size of each read-ahead buffer and the number of those buffers. */
+#define READ_AHEAD_CHUNK_SIZE (4 * SVN__STREAM_CHUNK_SIZE)
+#define READ_AHEAD_CHUNKS 16
+
+struct read_ahead_baton_t {
+  /* The file we read from.  Only the reader thread accesses it. */
+  apr_file_t *file;
+
+  /* A ring of READ_AHEAD_CHUNKS buffers.  The FILLED ones starting at
+     FIRST contain data not yet consumed by the reader of the stream.
+     All other buffers belong to the reader thread. */
+  char *data[READ_AHEAD_CHUNKS];
+  apr_size_t len[READ_AHEAD_CHUNKS];
+  int first;
+  int filled;
+
+  /* Offset of the next unconsumed byte in DATA[FIRST]. */
+  apr_size_t offset;
+
+  /* Set by the reader thread when it reached EOF or failed with ERR. */
+  svn_boolean_t eof;
+  svn_error_t *err;
+
+  /* Set to make the reader thread terminate. */
+  svn_boolean_t stopping;
+
+  /* Serializes access to FIRST, FILLED, EOF, ERR and STOPPING.  COND gets
+     signaled whenever one of those changes. */
+  svn_mutex__t *mutex;
+  apr_thread_cond_t *cond;
+
+  /* The reader thread and the root pool it owns, or NULL after the thread
+     has been joined. */
+  apr_thread_t *thread;
+  apr_pool_t *thread_pool;
+
+  /* The pool the stream is allocated in. */
+  apr_pool_t *pool;
+};
+
+/* Thread function filling the buffers of the read_ahead_baton_t given
+ * as DATA from its file until EOF, an error or termination.
+ */
+static void * APR_THREAD_FUNC
+read_ahead_thread(apr_thread_t *thread,
+                  void *data)
+{
+  struct read_ahead_baton_t *btn = data;
+  svn_boolean_t done = FALSE;
+
+  while (!done)
+    {
+      apr_thread_mutex_t *mutex = svn_mutex__get(btn->mutex);
+      svn_boolean_t hit_eof;
+      apr_size_t len = READ_AHEAD_CHUNK_SIZE;
+      svn_error_t *err;
+      int next;
+
+      /* There is no way to report synchronization failures from here. */
+      svn_error_clear(svn_mutex__lock(btn->mutex));
+      while (!btn->stopping && btn->filled == READ_AHEAD_CHUNKS)
+        apr_thread_cond_wait(btn->cond, mutex);
+      done = btn->stopping;
+      next = (btn->first + btn->filled) % READ_AHEAD_CHUNKS;
+      svn_error_clear(svn_mutex__unlock(btn->mutex, SVN_NO_ERROR));
+
+      if (done)
+        break;
+
+      err = svn_io_file_read_full2(btn->file, btn->data[next], len, &len,
+                                   &hit_eof, btn->thread_pool);
+
+      svn_error_clear(svn_mutex__lock(btn->mutex));
+      btn->len[next] = len;
+      if (len && !err)
+        btn->filled++;
+      if (err || hit_eof)
+        {
+          btn->err = err;
+          btn->eof = TRUE;
+          done = TRUE;
+        }
+      apr_thread_cond_broadcast(btn->cond);
+      svn_error_clear(svn_mutex__unlock(btn->mutex, SVN_NO_ERROR));
+    }
+
+  /* End thread explicitly to prevent APR_INCOMPLETE return codes in
+     apr_thread_join(). */
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Set *DATA and *LEN to the unconsumed part of the oldest buffer of BTN,
+ * waiting for the reader thread to fill one if necessary.  Set *LEN to 0
+ * at the end of the file.
+ */
+static svn_error_t *
+read_ahead_peek(struct read_ahead_baton_t *btn,
+                const char **data,
+                apr_size_t *len)
+{
+  apr_thread_mutex_t *mutex = svn_mutex__get(btn->mutex);
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(btn->mutex));
+
+  /* This loop implicitly handles spurious wake-ups. */
+  while (!btn->filled && !btn->eof && !err)
+    {
+      apr_status_t status = apr_thread_cond_wait(btn->cond, mutex);
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't wait for read-ahead data"));
+    }
+
+  if (err || btn->filled)
+    {
+      *data = btn->data[btn->first] + btn->offset;
+      *len = btn->len[btn->first] - btn->offset;
+    }
+  else
+    {
+      /* Report a read error only once all data before it is consumed. */
+      err = btn->err;
+      btn->err = SVN_NO_ERROR;
+      *data = NULL;
+      *len = 0;
+    }
+
+  return svn_error_trace(svn_mutex__unlock(btn->mutex, err));
+}
+
+/* Mark the first LEN bytes returned by the last read_ahead_peek() on BTN
+ * as consumed.
+ */
+static svn_error_t *
+read_ahead_consume(struct read_ahead_baton_t *btn,
+                   apr_size_t len)
+{
+  if (len == 0)
+    return SVN_NO_ERROR;
+
+  btn->offset += len;
+  if (btn->offset < btn->len[btn->first])
+    return SVN_NO_ERROR;
+
+  /* Hand the buffer back to the reader thread. */
+  SVN_ERR(svn_mutex__lock(btn->mutex));
+  btn->first = (btn->first + 1) % READ_AHEAD_CHUNKS;
+  btn->filled--;
+  btn->offset = 0;
+  apr_thread_cond_broadcast(btn->cond);
+  SVN_ERR(svn_mutex__unlock(btn->mutex, SVN_NO_ERROR));
+
+  return SVN_NO_ERROR;
+}
+
+/* Make the reader thread of BTN terminate and wait for it. */
+static svn_error_t *
+read_ahead_stop(struct read_ahead_baton_t *btn)
+{
+  apr_status_t thread_status;
+  apr_status_t status;
+  svn_error_t *err;
+
+  if (!btn->thread)
+    return SVN_NO_ERROR;
+
+  err = svn_mutex__lock(btn->mutex);
+  if (!err)
+    {
+      btn->stopping = TRUE;
+      apr_thread_cond_broadcast(btn->cond);
+      err = svn_mutex__unlock(btn->mutex, SVN_NO_ERROR);
+    }
+
+  status = apr_thread_join(&thread_status, btn->thread);
+  if (status)
+    err = svn_error_compose_create(err,
+            svn_error_wrap_apr(status, _("Can't join read-ahead thread")));
+
+  btn->thread = NULL;
+  svn_error_clear(btn->err);
+  btn->err = SVN_NO_ERROR;
+  svn_pool_destroy(btn->thread_pool);
+
+  return svn_error_trace(err);
+}
+
+/* Pool cleanup function stopping the reader thread of the
+ * read_ahead_baton_t given as DATA. */
+static apr_status_t
+read_ahead_cleanup(void *data)
+{
+  svn_error_clear(read_ahead_stop(data));
+  return APR_SUCCESS;
+}
+
+/* Implements svn_read_fn_t */
+static svn_error_t *
+read_handler_read_ahead(void *baton, char *buffer, apr_size_t *len)
+{
+  struct read_ahead_baton_t *btn = baton;
+  const char *data;
+  apr_size_t available;
+
+  SVN_ERR(read_ahead_peek(btn, &data, &available));
+  if (available < *len)
+    *len = available;
+
+  memcpy(buffer, data, *len);
+  return svn_error_trace(read_ahead_consume(btn, *len));
+}
+
+/* Implements svn_read_fn_t */
+static svn_error_t *
+read_full_handler_read_ahead(void *baton, char *buffer, apr_size_t *len)
+{
+  apr_size_t total = 0;
+
+  while (total < *len)
+    {
+      apr_size_t chunk = *len - total;
+
+      SVN_ERR(read_handler_read_ahead(baton, buffer + total, &chunk));
+      if (chunk == 0)
+        break;
+
+      total += chunk;
+    }
+
+  *len = total;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_stream__read_borrowed_fn_t */
+static svn_error_t *
+read_borrowed_handler_read_ahead(void *baton,
+                                 const char **data,
+                                 apr_size_t *len)
+{
+  struct read_ahead_baton_t *btn = baton;
+  apr_size_t available;
+
+  SVN_ERR(read_ahead_peek(btn, data, &available));
+  if (available < *len)
+    *len = available;
+
+  return svn_error_trace(read_ahead_consume(btn, *len));
+}
+
+/* Return TRUE if the EOL_LEN bytes of EOL are the last bytes of the
+ * concatenation of STR and the first LEN bytes of DATA. */
+static svn_boolean_t
+ends_with_eol(const svn_stringbuf_t *str,
+              const char *data,
+              apr_size_t len,
+              const char *eol,
+              apr_size_t eol_len)
+{
+  apr_size_t i;
+
+  if (str->len + len < eol_len)
+    return FALSE;
+
+  for (i = 0; i < eol_len; i++)
+    {
+      /* Position of the I-th EOL byte relative to the end of STR. */
+      apr_off_t pos = (apr_off_t)(len + i) - (apr_off_t)eol_len;
+      char c = pos < 0 ? str->data[str->len + pos] : data[pos];
+
+      if (c != eol[i])
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Implements svn_stream_readline_fn_t.  Like readline_apr_generic(),
+ * returns the data up to the first occurrence of EOL. */
+static svn_error_t *
+readline_handler_read_ahead(void *baton,
+                            svn_stringbuf_t **stringbuf,
+                            const char *eol,
+                            svn_boolean_t *eof,
+                            apr_pool_t *pool)
+{
+  struct read_ahead_baton_t *btn = baton;
+  svn_stringbuf_t *str = svn_stringbuf_create_ensure(SVN__LINE_CHUNK_SIZE,
+                                                     pool);
+  apr_size_t eol_len = strlen(eol);
+  char last = eol[eol_len - 1];
+
+  while (TRUE)
+    {
+      const char *data;
+      const char *found;
+      apr_size_t available;
+      apr_size_t i = 0;
+
+      SVN_ERR(read_ahead_peek(btn, &data, &available));
+      if (available == 0)
+        {
+          *eof = TRUE;
+          *stringbuf = str;
+          return SVN_NO_ERROR;
+        }
+
+      /* Look at every occurrence of the last EOL byte. */
+      while ((found = memchr(data + i, last, available - i)))
+        {
+          i = found - data + 1;
+          if (ends_with_eol(str, data, i, eol, eol_len))
+            {
+              svn_stringbuf_appendbytes(str, data, i);
+              SVN_ERR(read_ahead_consume(btn, i));
+              svn_stringbuf_chop(str, eol_len);
+
+              *eof = FALSE;
+              *stringbuf = str;
+              return SVN_NO_ERROR;
+            }
+        }
+
+      svn_stringbuf_appendbytes(str, data, available);
+      SVN_ERR(read_ahead_consume(btn, available));
+    }
+}
+
+/* Implements svn_close_fn_t */
+static svn_error_t *
+close_handler_read_ahead(void *baton)
+{
+  struct read_ahead_baton_t *btn = baton;
+
+  apr_pool_cleanup_kill(btn->pool, btn, read_ahead_cleanup);
+  return svn_error_trace(read_ahead_stop(btn));
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_error_t *
+svn_stream__create_read_ahead(svn_stream_t **stream,
+                              apr_file_t *file,
+                              apr_pool_t *result_pool)
+{
+#if APR_HAS_THREADS
+  struct read_ahead_baton_t *btn = apr_pcalloc(result_pool, sizeof(*btn));
+  apr_status_t status;
+  int i;
+
+  btn->file = file;
+  btn->pool = result_pool;
+
+  SVN_ERR(svn_mutex__init(&btn->mutex, TRUE, result_pool));
+  status = apr_thread_cond_create(&btn->cond, result_pool);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create condition variable"));
+
+  /* The buffers must outlive RESULT_POOL's cleanups, so they live in
+     the thread's root pool. */
+  btn->thread_pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+  for (i = 0; i < READ_AHEAD_CHUNKS; i++)
+    btn->data[i] = apr_palloc(btn->thread_pool, READ_AHEAD_CHUNK_SIZE);
+
+  status = apr_thread_create(&btn->thread, NULL, read_ahead_thread, btn,
+                             btn->thread_pool);
+  if (status)
+    {
+      /* Simply read the file directly. */
+      btn->thread = NULL;
+      svn_pool_destroy(btn->thread_pool);
+      *stream = svn_stream_from_aprfile2(file, TRUE, result_pool);
+      return SVN_NO_ERROR;
+    }
+
+  apr_pool_cleanup_register(result_pool, btn, read_ahead_cleanup,
+                            apr_pool_cleanup_null);
+
+  *stream = svn_stream_create(btn, result_pool);
+  svn_stream_set_read2(*stream, read_handler_read_ahead,
+                       read_full_handler_read_ahead);
+  svn_stream__set_read_borrowed(*stream, read_borrowed_handler_read_ahead);
+  svn_stream_set_readline(*stream, readline_handler_read_ahead);
+  svn_stream_set_close(*stream, close_handler_read_ahead);
+#else
+  *stream = svn_stream_from_aprfile2(file, TRUE, result_pool);
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Compressed stream support */
 
@@ -1366,6 +1831,12 @@ struct checksum_stream_baton
   svn_checksum_ctx_t *read_ctx, *write_ctx;
   svn_checksum_t **read_checksum;  /* Output value. */
   svn_checksum_t **write_checksum;  /* Output value. */
+
+  /* Optional second checksum, calculated in the same pass as the first. */
+  svn_checksum_ctx_t *read_ctx2, *write_ctx2;
+  svn_checksum_t **read_checksum2;  /* Output value. */
+  svn_checksum_t **write_checksum2;  /* Output value. */
+
   svn_stream_t *proxy;
 
   /* True if more data should be read when closing the stream. */
@@ -1382,8 +1853,7 @@ read_handler_checksum(void *baton, char *buffer, apr_size_t *len)
 
   SVN_ERR(svn_stream_read2(btn->proxy, buffer, len));
 
-  if (btn->read_checksum)
-    SVN_ERR(svn_checksum_update(btn->read_ctx, buffer, *len));
+  SVN_ERR(svn_checksum__update2(btn->read_ctx, btn->read_ctx2, buffer, *len));
 
   return SVN_NO_ERROR;
 }
@@ -1396,8 +1866,7 @@ read_full_handler_checksum(void *baton, char *buffer, apr_size_t *len)
 
   SVN_ERR(svn_stream_read_full(btn->proxy, buffer, len));
 
-  if (btn->read_checksum)
-    SVN_ERR(svn_checksum_update(btn->read_ctx, buffer, *len));
+  SVN_ERR(svn_checksum__update2(btn->read_ctx, btn->read_ctx2, buffer, *len));
 
   if (saved_len != *len)
     btn->read_more = FALSE;
@@ -1405,14 +1874,31 @@ read_full_handler_checksum(void *baton, char *buffer, apr_size_t *len)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+read_borrowed_handler_checksum(void *baton, const char **data,
+                               apr_size_t *len)
+{
+  struct checksum_stream_baton *btn = baton;
+
+  SVN_ERR(svn_stream__read_borrowed(btn->proxy, data, len));
+
+  SVN_ERR(svn_checksum__update2(btn->read_ctx, btn->read_ctx2, *data, *len));
+
+  if (*len == 0)
+    btn->read_more = FALSE;
+
+  return SVN_NO_ERROR;
+}
+
 
 static svn_error_t *
 write_handler_checksum(void *baton, const char *buffer, apr_size_t *len)
 {
   struct checksum_stream_baton *btn = baton;
 
-  if (btn->write_checksum && *len > 0)
-    SVN_ERR(svn_checksum_update(btn->write_ctx, buffer, *len));
+  if (*len > 0)
+    SVN_ERR(svn_checksum__update2(btn->write_ctx, btn->write_ctx2,
+                                  buffer, *len));
 
   return svn_error_trace(svn_stream_write(btn->proxy, buffer, len));
 }
@@ -1451,6 +1937,14 @@ close_handler_checksum(void *baton)
   if (btn->write_ctx)
     SVN_ERR(svn_checksum_final(btn->write_checksum, btn->write_ctx, btn->pool));
 
+  if (btn->read_ctx2)
+    SVN_ERR(svn_checksum_final(btn->read_checksum2, btn->read_ctx2,
+                               btn->pool));
+
+  if (btn->write_ctx2)
+    SVN_ERR(svn_checksum_final(btn->write_checksum2, btn->write_ctx2,
+                               btn->pool));
+
   return svn_error_trace(svn_stream_close(btn->proxy));
 }
 
@@ -1473,6 +1967,12 @@ seek_handler_checksum(void *baton, const svn_stream_mark_t *mark)
       if (btn->write_ctx)
         SVN_ERR(svn_checksum_ctx_reset(btn->write_ctx));
 
+      if (btn->read_ctx2)
+        SVN_ERR(svn_checksum_ctx_reset(btn->read_ctx2));
+
+      if (btn->write_ctx2)
+        SVN_ERR(svn_checksum_ctx_reset(btn->write_ctx2));
+
       SVN_ERR(svn_stream_reset(btn->proxy));
     }
 
@@ -1481,32 +1981,40 @@ seek_handler_checksum(void *baton, const svn_stream_mark_t *mark)
 
 
 svn_stream_t *
-svn_stream_checksummed2(svn_stream_t *stream,
+svn_stream__checksummed(svn_stream_t *stream,
                         svn_checksum_t **read_checksum,
+                        svn_checksum_t **read_checksum2,
                         svn_checksum_t **write_checksum,
+                        svn_checksum_t **write_checksum2,
                         svn_checksum_kind_t checksum_kind,
+                        svn_checksum_kind_t checksum_kind2,
                         svn_boolean_t read_all,
                         apr_pool_t *pool)
 {
   svn_stream_t *s;
   struct checksum_stream_baton *baton;
 
-  if (read_checksum == NULL && write_checksum == NULL)
+  if (   read_checksum == NULL && write_checksum == NULL
+      && read_checksum2 == NULL && write_checksum2 == NULL)
     return stream;
 
-  baton = apr_palloc(pool, sizeof(*baton));
+  baton = apr_pcalloc(pool, sizeof(*baton));
   if (read_checksum)
     baton->read_ctx = svn_checksum_ctx_create(checksum_kind, pool);
-  else
-    baton->read_ctx = NULL;
 
   if (write_checksum)
     baton->write_ctx = svn_checksum_ctx_create(checksum_kind, pool);
-  else
-    baton->write_ctx = NULL;
+
+  if (read_checksum2)
+    baton->read_ctx2 = svn_checksum_ctx_create(checksum_kind2, pool);
+
+  if (write_checksum2)
+    baton->write_ctx2 = svn_checksum_ctx_create(checksum_kind2, pool);
 
   baton->read_checksum = read_checksum;
   baton->write_checksum = write_checksum;
+  baton->read_checksum2 = read_checksum2;
+  baton->write_checksum2 = write_checksum2;
   baton->proxy = stream;
   baton->read_more = read_all;
   baton->pool = pool;
@@ -1518,9 +2026,25 @@ svn_stream_checksummed2(svn_stream_t *stream,
   svn_stream_set_close(s, close_handler_checksum);
   if (svn_stream_supports_reset(stream))
     svn_stream_set_seek(s, seek_handler_checksum);
+  if (svn_stream__supports_read_borrowed(stream))
+    svn_stream__set_read_borrowed(s, read_borrowed_handler_checksum);
   return s;
 }
 
+svn_stream_t *
+svn_stream_checksummed2(svn_stream_t *stream,
+                        svn_checksum_t **read_checksum,
+                        svn_checksum_t **write_checksum,
+                        svn_checksum_kind_t checksum_kind,
+                        svn_boolean_t read_all,
+                        apr_pool_t *pool)
+{
+  return svn_stream__checksummed(stream, read_checksum, NULL,
+                                 write_checksum, NULL,
+                                 checksum_kind, checksum_kind,
+                                 read_all, pool);
+}
+
 /* Helper for svn_stream_contents_checksum() to compute checksum of
  * KIND of STREAM. This function doesn't close source stream. */
 static svn_error_t *
@@ -1633,6 +2157,18 @@ read_handler_stringbuf(void *baton, char *buffer, apr_size_t *len)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+read_borrowed_handler_stringbuf(void *baton, const char **data, apr_size_t *len)
+{
+  struct stringbuf_stream_baton *btn = baton;
+  apr_size_t left_to_read = btn->str->len - btn->amt_read;
+
+  *len = (*len > left_to_read) ? left_to_read : *len;
+  *data = btn->str->data + btn->amt_read;
+  btn->amt_read += *len;
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 skip_handler_stringbuf(void *baton, apr_size_t len)
 {
@@ -1740,6 +2276,7 @@ svn_stream_from_stringbuf(svn_stringbuf_t *str,
   baton->amt_read = 0;
   stream = svn_stream_create(baton, pool);
   svn_stream_set_read2(stream, read_handler_stringbuf, read_handler_stringbuf);
+  svn_stream__set_read_borrowed(stream, read_borrowed_handler_stringbuf);
   svn_stream_set_skip(stream, skip_handler_stringbuf);
   svn_stream_set_write(stream, write_handler_stringbuf);
   svn_stream_set_mark(stream, mark_handler_stringbuf);
@@ -1772,6 +2309,18 @@ read_handler_string(void *baton, char *buffer, apr_size_t *len)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+read_borrowed_handler_string(void *baton, const char **data, apr_size_t *len)
+{
+  struct string_stream_baton *btn = baton;
+  apr_size_t left_to_read = btn->str->len - btn->amt_read;
+
+  *len = (*len > left_to_read) ? left_to_read : *len;
+  *data = btn->str->data + btn->amt_read;
+  btn->amt_read += *len;
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 mark_handler_string(void *baton, svn_stream_mark_t **mark, apr_pool_t *pool)
 {
@@ -1870,6 +2419,7 @@ svn_stream_from_string(const svn_string_t *str,
   baton->amt_read = 0;
   stream = svn_stream_create(baton, pool);
   svn_stream_set_read2(stream, read_handler_string, read_handler_string);
+  svn_stream__set_read_borrowed(stream, read_borrowed_handler_string);
   svn_stream_set_mark(stream, mark_handler_string);
   svn_stream_set_seek(stream, seek_handler_string);
   svn_stream_set_skip(stream, skip_handler_string);
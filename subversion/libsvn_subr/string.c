@@ -33,8 +33,13 @@
 #include "svn_string.h"  /* loads "svn_types.h" and <apr_pools.h> */
 #include "svn_ctype.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_eol_private.h"
 #include "private/svn_string_private.h"
 
+#ifdef SVN__HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "svn_private_config.h"
 
 
@@ -1508,6 +1513,20 @@ svn_cstring__match_length(const char *a,
 {
   apr_size_t pos = 0;
 
+#ifdef SVN__HAVE_SSE2
+
+  /* Compare 16 bytes at a time.  Unaligned loads are fine with SSE2.
+   * The chunky loop below will then locate the mismatch. */
+  for (; max_len - pos >= sizeof(__m128i); pos += sizeof(__m128i))
+    {
+      __m128i lhs = _mm_loadu_si128((const __m128i *)(a + pos));
+      __m128i rhs = _mm_loadu_si128((const __m128i *)(b + pos));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)) != 0xffff)
+        break;
+    }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Chunky processing is so much faster ...
@@ -46,12 +46,17 @@
 #include "svn_subst.h"
 #include "svn_pools.h"
 #include "private/svn_io_private.h"
+#include "private/svn_stats.h"
 
 #include "svn_private_config.h"
 
 #include "private/svn_string_private.h"
 #include "private/svn_eol_private.h"
 
+#ifdef SVN__HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 /**
  * The textual elements of a detranslated special file.  One of these
  * strings must appear as the first element of any special file as it
@@ -981,6 +986,62 @@ eol_unchanged(struct translation_baton *b,
 }
 
 
+/* Return the offset of the first char in P[START .. LEN-1] that is marked
+ * in the INTERESTING table, or LEN if there is none.  INTERESTING must
+ * only mark a subset of '$', '\r' and '\n'. */
+static apr_size_t
+find_interesting_char(const char *interesting,
+                      const char *p,
+                      apr_size_t start,
+                      apr_size_t len)
+{
+#ifdef SVN__HAVE_SSE2
+  const __m128i dollar = _mm_set1_epi8('$');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+
+  /* Skip 16 bytes at a time as long as none of them is a candidate.
+     Candidates that are not actually interesting (e.g. EOLs when only
+     keywords are being expanded) are filtered out by the table lookup. */
+  while (len - start >= sizeof(__m128i))
+    {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)(p + start));
+      __m128i found = _mm_or_si128(_mm_cmpeq_epi8(chunk, dollar),
+                                   _mm_or_si128(_mm_cmpeq_epi8(chunk, cr),
+                                                _mm_cmpeq_epi8(chunk, lf)));
+      if (_mm_movemask_epi8(found))
+        {
+          apr_size_t i;
+          for (i = start; i < start + sizeof(__m128i); ++i)
+            if (interesting[(unsigned char)p[i]])
+              return i;
+        }
+
+      start += sizeof(__m128i);
+    }
+#else
+  /* Check 4 bytes at once to allow for efficient pipelining
+     and to reduce loop condition overhead. */
+  while (len - start >= 4)
+    {
+      if (interesting[(unsigned char)p[start]]
+          || interesting[(unsigned char)p[start+1]]
+          || interesting[(unsigned char)p[start+2]]
+          || interesting[(unsigned char)p[start+3]])
+        break;
+
+      start += 4;
+    }
+#endif
+
+  /* Found an interesting char or EOF in the next few bytes.
+     Find its exact position. */
+  while (start < len && !interesting[(unsigned char)p[start]])
+    ++start;
+
+  return start;
+}
+
 /* Translate eols and keywords of a 'chunk' of characters BUF of size BUFLEN
  * according to the settings and state stored in baton B.
  *
@@ -995,11 +1056,11 @@ eol_unchanged(struct translation_baton *b,
  * Use POOL for temporary allocations.
  */
 static svn_error_t *
-translate_chunk(svn_stream_t *dst,
-                struct translation_baton *b,
-                const char *buf,
-                apr_size_t buflen,
-                apr_pool_t *pool)
+translate_chunk_body(svn_stream_t *dst,
+                     struct translation_baton *b,
+                     const char *buf,
+                     apr_size_t buflen,
+                     apr_pool_t *pool)
 {
   const char *p;
   apr_size_t len;
@@ -1125,24 +1186,8 @@ translate_chunk(svn_stream_t *dst,
 
               if (b->keywords)
                 {
-                  /* Check 4 bytes at once to allow for efficient pipelining
-                    and to reduce loop condition overhead. */
-                  while ((end - p) >= (len + 4))
-                    {
-                      if (interesting[(unsigned char)p[len]]
-                          || interesting[(unsigned char)p[len+1]]
-                          || interesting[(unsigned char)p[len+2]]
-                          || interesting[(unsigned char)p[len+3]])
-                        break;
-
-                      len += 4;
-                    }
-
-                  /* Found an interesting char or EOF in the next 4 bytes.
-                     Find its exact position. */
-                  while ((p + len) < end
-                         && !interesting[(unsigned char)p[len]])
-                    ++len;
+                  len = find_interesting_char(interesting, p, len,
+                                              (apr_size_t)(end - p));
                 }
               else
                 {
@@ -1218,6 +1263,27 @@ translate_chunk(svn_stream_t *dst,
   return SVN_NO_ERROR;
 }
 
+/* Time spent translating, including writing the translated data. */
+SVN__COUNTER_DEFINE(translate_timer, "subst.translate");
+
+/* Wrapper around translate_chunk_body(), recording the time spent. */
+static svn_error_t *
+translate_chunk(svn_stream_t *dst,
+                struct translation_baton *b,
+                const char *buf,
+                apr_size_t buflen,
+                apr_pool_t *pool)
+{
+  svn_error_t *err;
+  apr_time_t start;
+
+  SVN__TIMER_START(translate_timer, start);
+  err = translate_chunk_body(dst, b, buf, buflen, pool);
+  SVN__TIMER_STOP(translate_timer, start);
+
+  return svn_error_trace(err);
+}
+
 /* Baton for use with translated stream callbacks. */
 struct translated_stream_baton
 {
@@ -1248,6 +1314,34 @@ struct translated_stream_baton
 };
 
 
+/* Refill B's empty read buffer with the translation of the next chunk
+   of the underlying stream.  Set *READLEN to the number of untranslated
+   bytes consumed; a value less than SVN__STREAM_CHUNK_SIZE indicates
+   that the underlying stream has been exhausted. */
+static svn_error_t *
+fill_translated_readbuf(struct translated_stream_baton *b,
+                        apr_size_t *readlen)
+{
+  svn_stream_t *buf_stream;
+
+  svn_pool_clear(b->iterpool);
+  svn_stringbuf_setempty(b->readbuf);
+  b->readbuf_off = 0;
+
+  *readlen = SVN__STREAM_CHUNK_SIZE;
+  SVN_ERR(svn_stream_read_full(b->stream, b->buf, readlen));
+  buf_stream = svn_stream_from_stringbuf(b->readbuf, b->iterpool);
+
+  SVN_ERR(translate_chunk(buf_stream, b->in_baton, b->buf,
+                          *readlen, b->iterpool));
+
+  if (*readlen != SVN__STREAM_CHUNK_SIZE)
+    SVN_ERR(translate_chunk(buf_stream, b->in_baton, NULL, 0,
+                            b->iterpool));
+
+  return svn_error_trace(svn_stream_close(buf_stream));
+}
+
 /* Implements svn_read_fn_t. */
 static svn_error_t *
 translated_stream_read(void *baton,
@@ -1283,26 +1377,9 @@ translated_stream_read(void *baton,
       apr_size_t to_copy;
       apr_size_t buffer_remainder;
 
-      svn_pool_clear(b->iterpool);
       /* fill read buffer, if necessary */
       if (! (b->readbuf_off < b->readbuf->len))
-        {
-          svn_stream_t *buf_stream;
-
-          svn_stringbuf_setempty(b->readbuf);
-          b->readbuf_off = 0;
-          SVN_ERR(svn_stream_read_full(b->stream, b->buf, &readlen));
-          buf_stream = svn_stream_from_stringbuf(b->readbuf, b->iterpool);
-
-          SVN_ERR(translate_chunk(buf_stream, b->in_baton, b->buf,
-                                  readlen, b->iterpool));
-
-          if (readlen != SVN__STREAM_CHUNK_SIZE)
-            SVN_ERR(translate_chunk(buf_stream, b->in_baton, NULL, 0,
-                                    b->iterpool));
-
-          SVN_ERR(svn_stream_close(buf_stream));
-        }
+        SVN_ERR(fill_translated_readbuf(b, &readlen));
 
       /* Satisfy from the read buffer */
       buffer_remainder = b->readbuf->len - b->readbuf_off;
@@ -1319,6 +1396,40 @@ translated_stream_read(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_stream__read_borrowed_fn_t by lending out the
+   translated read buffer. */
+static svn_error_t *
+translated_stream_read_borrowed(void *baton,
+                                const char **data,
+                                apr_size_t *len)
+{
+  struct translated_stream_baton *b = baton;
+  apr_size_t buffer_remainder;
+
+  /* A chunk may translate to nothing, e.g. while a keyword is still
+     being collected, hence the loop. */
+  while (! (b->readbuf_off < b->readbuf->len))
+    {
+      apr_size_t readlen;
+
+      SVN_ERR(fill_translated_readbuf(b, &readlen));
+      if (readlen != SVN__STREAM_CHUNK_SIZE && b->readbuf->len == 0)
+        {
+          *len = 0;
+          return SVN_NO_ERROR;
+        }
+    }
+
+  buffer_remainder = b->readbuf->len - b->readbuf_off;
+  if (*len > buffer_remainder)
+    *len = buffer_remainder;
+
+  *data = b->readbuf->data + b->readbuf_off;
+  b->readbuf_off += *len;
+
+  return SVN_NO_ERROR;
+}
+
 /* Implements svn_write_fn_t. */
 static svn_error_t *
 translated_stream_write(void *baton,
@@ -1536,6 +1647,7 @@ stream_translated(svn_stream_t *stream,
   /* Setup the stream methods */
   svn_stream_set_read2(s, NULL /* only full read support */,
                        translated_stream_read);
+  svn_stream__set_read_borrowed(s, translated_stream_read_borrowed);
   svn_stream_set_write(s, translated_stream_write);
   svn_stream_set_close(s, translated_stream_close);
   if (svn_stream_supports_mark(stream))
@@ -191,6 +191,20 @@ svn_sysinfo__linked_libs(apr_pool_t *pool)
                                       (lz4_version / 100) % 100,
                                       lz4_version % 100);
 
+#ifdef SVN_HAVE_ZSTD
+  {
+    int zstd_version = svn_zstd__runtime_version();
+
+    lib = &APR_ARRAY_PUSH(array, svn_version_ext_linked_lib_t);
+    lib->name = "Zstd";
+    lib->compiled_version = apr_pstrdup(pool, svn_zstd__compiled_version());
+    lib->runtime_version = apr_psprintf(pool, "%d.%d.%d",
+                                        zstd_version / 100 / 100,
+                                        (zstd_version / 100) % 100,
+                                        zstd_version % 100);
+  }
+#endif
+
   return array;
 }
 
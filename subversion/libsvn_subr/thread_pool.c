@@ -0,0 +1,652 @@
+/* thread_pool.c --- worker threads running jobs for a single owner thread
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_thread_proc.h>
+#include <apr_thread_cond.h>
+
+#include "svn_pools.h"
+#include "svn_sorts.h"
+#include "svn_private_config.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_thread_pool.h"
+
+/* Upper limit for the time in microseconds that the owner waits for a job
+ * before calling its cancellation function again. */
+#define CANCEL_CHECK_INTERVAL 100000
+
+/* The life cycle of a svn_thread_pool__job_t. */
+typedef enum job_state_t
+{
+  /* Waiting to be claimed by a worker. */
+  job_queued,
+
+  /* Claimed by a worker. */
+  job_running,
+
+  /* The result is available to the owner. */
+  job_done
+} job_state_t;
+
+struct svn_thread_pool__job_t
+{
+  /* The thread pool this job has been submitted to. */
+  svn_thread_pool__t *thread_pool;
+
+  /* What to run. */
+  svn_thread_pool__job_func_t func;
+  void *baton;
+
+  /* Progress and outcome of the job.  Protected by the thread pool's
+     mutex. */
+  job_state_t state;
+  svn_error_t *err;
+
+  /* Set by the owner if the result of this job is not needed anymore. */
+  volatile svn_atomic_t cancelled;
+
+  /* Next job in the queue of unclaimed jobs or in the free list. */
+  svn_thread_pool__job_t *next;
+
+  /* Neighbors in the list of jobs that have not been waited for.  Only
+     used by the owner. */
+  svn_thread_pool__job_t *prev_pending;
+  svn_thread_pool__job_t *next_pending;
+};
+
+/* A single worker of a svn_thread_pool__t. */
+typedef struct worker_t
+{
+  /* The thread pool this worker belongs to. */
+  svn_thread_pool__t *thread_pool;
+
+  /* As returned by the thread pool's init function.  Valid if
+     INITIALIZED is set. */
+  void *baton;
+  svn_boolean_t initialized;
+
+  /* Root pool exclusively used by this worker. */
+  apr_pool_t *pool;
+
+#if APR_HAS_THREADS
+  /* The thread running this worker, if it has been started. */
+  apr_thread_t *thread;
+#endif
+} worker_t;
+
+struct svn_thread_pool__t
+{
+  /* WORKER_COUNT workers, of which the first RUNNING have their threads
+     started.  RUNNING is only used by the owner. */
+  worker_t *workers;
+  int worker_count;
+  int running;
+
+  /* Creates the workers' batons.  May be NULL. */
+  svn_thread_pool__worker_init_t init_func;
+  void *init_baton;
+
+  /* Jobs that no worker has claimed, yet, in the order they have been
+     submitted.  Protected by MUTEX. */
+  svn_thread_pool__job_t *first_queued;
+  svn_thread_pool__job_t *last_queued;
+
+  /* Jobs that have not been waited for, in the order they have been
+     submitted.  Only used by the owner. */
+  svn_thread_pool__job_t *first_pending;
+  svn_thread_pool__job_t *last_pending;
+
+  /* Jobs that may be reused.  Only used by the owner. */
+  svn_thread_pool__job_t *free_jobs;
+
+  /* Set to make the workers terminate once there are no more queued
+     jobs.  Protected by MUTEX. */
+  svn_boolean_t stopping;
+
+  /* Set to make the workers terminate as soon as possible. */
+  volatile svn_atomic_t aborted;
+
+  /* Serializes access to the shared members above and the jobs.  COND
+     gets signaled whenever one of those changes.  Both get created when
+     the workers are being started for the first time. */
+  svn_mutex__t *mutex;
+#if APR_HAS_THREADS
+  apr_thread_cond_t *cond;
+#endif
+
+  /* The pool that everything above has been allocated in. */
+  apr_pool_t *pool;
+};
+
+/* Pool cleanup function destroying the root pool given as DATA. */
+static apr_status_t
+destroy_root_pool(void *data)
+{
+  svn_pool_destroy(data);
+  return APR_SUCCESS;
+}
+
+apr_pool_t *
+svn_thread_pool__create_root_pool(apr_pool_t *owner)
+{
+  apr_pool_t *result
+    = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+
+  if (owner)
+    svn_thread_pool__attach_root_pool(result, owner);
+
+  return result;
+}
+
+void
+svn_thread_pool__attach_root_pool(apr_pool_t *root_pool,
+                                  apr_pool_t *owner)
+{
+  apr_pool_cleanup_register(owner, root_pool, destroy_root_pool,
+                            apr_pool_cleanup_null);
+}
+
+void
+svn_thread_pool__destroy_root_pool(apr_pool_t *root_pool,
+                                   apr_pool_t *owner)
+{
+  if (owner)
+    apr_pool_cleanup_run(owner, root_pool, destroy_root_pool);
+  else
+    svn_pool_destroy(root_pool);
+}
+
+/* Implements svn_cancel_func_t.  Return SVN_ERR_CANCELLED once the
+ * svn_thread_pool__job_t given as BATON or its thread pool has been
+ * cancelled.
+ */
+static svn_error_t *
+check_job_cancelled(void *baton)
+{
+  svn_thread_pool__job_t *job = baton;
+
+  if (   svn_atomic_read(&job->cancelled)
+      || svn_atomic_read(&job->thread_pool->aborted))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* Make sure that WORKER in THREAD_POOL has its root pool and baton.
+ * WORKER_INDEX is the index of WORKER.
+ */
+static svn_error_t *
+init_worker(svn_thread_pool__t *thread_pool,
+            worker_t *worker,
+            int worker_index)
+{
+  if (worker->initialized)
+    return SVN_NO_ERROR;
+
+  worker->thread_pool = thread_pool;
+  if (!worker->pool)
+    worker->pool = svn_thread_pool__create_root_pool(thread_pool->pool);
+
+  if (thread_pool->init_func)
+    SVN_ERR(thread_pool->init_func(&worker->baton, thread_pool->init_baton,
+                                   worker_index, worker->pool));
+
+  worker->initialized = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a new job in THREAD_POOL, running FUNC with BATON, and append
+ * it to the list of jobs that have not been waited for.
+ */
+static svn_thread_pool__job_t *
+alloc_job(svn_thread_pool__t *thread_pool,
+          svn_thread_pool__job_func_t func,
+          void *baton)
+{
+  svn_thread_pool__job_t *job = thread_pool->free_jobs;
+
+  if (job)
+    thread_pool->free_jobs = job->next;
+  else
+    job = apr_palloc(thread_pool->pool, sizeof(*job));
+
+  job->thread_pool = thread_pool;
+  job->func = func;
+  job->baton = baton;
+  job->state = job_queued;
+  job->err = SVN_NO_ERROR;
+  job->cancelled = FALSE;
+  job->next = NULL;
+
+  job->next_pending = NULL;
+  job->prev_pending = thread_pool->last_pending;
+  if (thread_pool->last_pending)
+    thread_pool->last_pending->next_pending = job;
+  else
+    thread_pool->first_pending = job;
+  thread_pool->last_pending = job;
+
+  return job;
+}
+
+/* Remove JOB from the list of jobs in THREAD_POOL that have not been
+ * waited for and make it available for reuse.
+ */
+static void
+release_job(svn_thread_pool__t *thread_pool,
+            svn_thread_pool__job_t *job)
+{
+  if (job->prev_pending)
+    job->prev_pending->next_pending = job->next_pending;
+  else
+    thread_pool->first_pending = job->next_pending;
+
+  if (job->next_pending)
+    job->next_pending->prev_pending = job->prev_pending;
+  else
+    thread_pool->last_pending = job->prev_pending;
+
+  job->next = thread_pool->free_jobs;
+  thread_pool->free_jobs = job;
+}
+
+#if APR_HAS_THREADS
+
+/* Wait for the next unclaimed job in THREAD_POOL, claim it and return it
+ * in *JOB.  Set *JOB to NULL if the worker shall terminate.
+ */
+static svn_error_t *
+claim_job(svn_thread_pool__job_t **job,
+          svn_thread_pool__t *thread_pool)
+{
+  apr_thread_mutex_t *mutex = svn_mutex__get(thread_pool->mutex);
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(thread_pool->mutex));
+
+  /* This loop implicitly handles spurious wake-ups. */
+  while (   !err
+         && !svn_atomic_read(&thread_pool->aborted)
+         && !thread_pool->first_queued
+         && !thread_pool->stopping)
+    {
+      apr_status_t status = apr_thread_cond_wait(thread_pool->cond, mutex);
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't wait for queued jobs"));
+    }
+
+  if (   !err
+      && !svn_atomic_read(&thread_pool->aborted)
+      && thread_pool->first_queued)
+    {
+      *job = thread_pool->first_queued;
+      thread_pool->first_queued = (*job)->next;
+      if (!thread_pool->first_queued)
+        thread_pool->last_queued = NULL;
+
+      (*job)->state = job_running;
+    }
+  else
+    {
+      *job = NULL;
+    }
+
+  return svn_error_trace(svn_mutex__unlock(thread_pool->mutex, err));
+}
+
+/* Thread function running all jobs that it can claim from the thread
+ * pool of the worker_t given as DATA.
+ */
+static void * APR_THREAD_FUNC
+worker_thread(apr_thread_t *thread,
+              void *data)
+{
+  worker_t *worker = data;
+  svn_thread_pool__t *thread_pool = worker->thread_pool;
+  apr_pool_t *iterpool = svn_pool_create(worker->pool);
+
+  while (TRUE)
+    {
+      svn_thread_pool__job_t *job;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      /* There is no way to report synchronization failures from here. */
+      err = claim_job(&job, thread_pool);
+      if (err || !job)
+        {
+          svn_error_clear(err);
+          break;
+        }
+
+      err = check_job_cancelled(job);
+      if (!err)
+        err = job->func(job->baton, worker->baton, check_job_cancelled, job,
+                        iterpool);
+
+      /* Hand the result over to the owner. */
+      svn_error_clear(svn_mutex__lock(thread_pool->mutex));
+      job->err = err;
+      job->state = job_done;
+      apr_thread_cond_broadcast(thread_pool->cond);
+      svn_error_clear(svn_mutex__unlock(thread_pool->mutex, SVN_NO_ERROR));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* End thread explicitly to prevent APR_INCOMPLETE return codes in
+     apr_thread_join(). */
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+/* Make sure that THREAD_POOL has its worker threads running.
+ */
+static svn_error_t *
+start_workers(svn_thread_pool__t *thread_pool)
+{
+  apr_status_t status = APR_SUCCESS;
+  int i;
+
+  if (thread_pool->running)
+    return SVN_NO_ERROR;
+
+  if (!thread_pool->mutex)
+    {
+      SVN_ERR(svn_mutex__init(&thread_pool->mutex, TRUE, thread_pool->pool));
+      status = apr_thread_cond_create(&thread_pool->cond, thread_pool->pool);
+      if (status)
+        return svn_error_wrap_apr(status,
+                                  _("Can't create condition variable"));
+    }
+
+  thread_pool->stopping = FALSE;
+  for (i = 0; i < thread_pool->worker_count; ++i)
+    {
+      worker_t *worker = &thread_pool->workers[i];
+      svn_error_t *err = init_worker(thread_pool, worker, i);
+
+      /* Don't leave the threads started so far behind. */
+      if (err)
+        return svn_error_compose_create(err,
+                                        svn_thread_pool__join(thread_pool,
+                                                              TRUE));
+
+      status = apr_thread_create(&worker->thread, NULL, worker_thread,
+                                 worker, worker->pool);
+      if (status)
+        break;
+
+      ++thread_pool->running;
+    }
+
+  /* Be content with fewer workers than planned. */
+  if (thread_pool->running == 0)
+    return svn_error_wrap_apr(status, _("Can't create worker thread"));
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* Pool cleanup function aborting the thread pool given as DATA. */
+static apr_status_t
+abort_thread_pool(void *data)
+{
+  svn_error_clear(svn_thread_pool__join(data, TRUE));
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_thread_pool__create(svn_thread_pool__t **thread_pool,
+                        int thread_count,
+                        svn_thread_pool__worker_init_t init_func,
+                        void *init_baton,
+                        apr_pool_t *result_pool)
+{
+  svn_thread_pool__t *result = apr_pcalloc(result_pool, sizeof(*result));
+
+#if !APR_HAS_THREADS
+  /* The owner runs all jobs itself. */
+  thread_count = 1;
+#endif
+
+  result->worker_count = MAX(thread_count, 1);
+  result->workers = apr_pcalloc(result_pool,
+                                result->worker_count
+                                * sizeof(*result->workers));
+  result->init_func = init_func;
+  result->init_baton = init_baton;
+  result->pool = result_pool;
+
+  /* This must happen before the pools that the workers use get
+     destroyed. */
+  apr_pool_pre_cleanup_register(result_pool, result, abort_thread_pool);
+
+  *thread_pool = result;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_thread_pool__submit(svn_thread_pool__job_t **job,
+                        svn_thread_pool__t *thread_pool,
+                        svn_thread_pool__job_func_t func,
+                        void *job_baton)
+{
+  svn_thread_pool__job_t *result;
+
+#if APR_HAS_THREADS
+  SVN_ERR(start_workers(thread_pool));
+
+  result = alloc_job(thread_pool, func, job_baton);
+
+  SVN_ERR(svn_mutex__lock(thread_pool->mutex));
+  if (thread_pool->last_queued)
+    thread_pool->last_queued->next = result;
+  else
+    thread_pool->first_queued = result;
+  thread_pool->last_queued = result;
+
+  /* Both, the workers and the owner wait for COND. */
+  apr_thread_cond_broadcast(thread_pool->cond);
+  SVN_ERR(svn_mutex__unlock(thread_pool->mutex, SVN_NO_ERROR));
+#else
+  worker_t *worker = &thread_pool->workers[0];
+  apr_pool_t *scratch_pool;
+
+  SVN_ERR(init_worker(thread_pool, worker, 0));
+
+  result = alloc_job(thread_pool, func, job_baton);
+
+  scratch_pool = svn_pool_create(worker->pool);
+  result->err = func(job_baton, worker->baton, check_job_cancelled, result,
+                     scratch_pool);
+  result->state = job_done;
+  svn_pool_destroy(scratch_pool);
+#endif
+
+  *job = result;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_thread_pool__wait(svn_thread_pool__t *thread_pool,
+                      svn_thread_pool__job_t *job,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+#if APR_HAS_THREADS
+  if (thread_pool->mutex)
+    {
+      apr_thread_mutex_t *mutex = svn_mutex__get(thread_pool->mutex);
+
+      SVN_ERR(svn_mutex__lock(thread_pool->mutex));
+
+      /* This loop implicitly handles spurious wake-ups. */
+      while (!err && job->state != job_done)
+        {
+          apr_status_t status;
+
+          if (cancel_func)
+            {
+              status = apr_thread_cond_timedwait(thread_pool->cond, mutex,
+                                                 CANCEL_CHECK_INTERVAL);
+              if (status && !APR_STATUS_IS_TIMEUP(status))
+                err = svn_error_wrap_apr(status,
+                                         _("Can't wait for queued jobs"));
+              else
+                err = cancel_func(cancel_baton);
+            }
+          else
+            {
+              status = apr_thread_cond_wait(thread_pool->cond, mutex);
+              if (status)
+                err = svn_error_wrap_apr(status,
+                                         _("Can't wait for queued jobs"));
+            }
+        }
+
+      SVN_ERR(svn_mutex__unlock(thread_pool->mutex, err));
+    }
+#endif
+
+  SVN_ERR_ASSERT(job->state == job_done);
+
+  /* Take ownership of the job's result. */
+  err = job->err;
+  job->err = SVN_NO_ERROR;
+  release_job(thread_pool, job);
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svn_thread_pool__cancel_job(svn_thread_pool__t *thread_pool,
+                            svn_thread_pool__job_t *job)
+{
+#if APR_HAS_THREADS
+  if (thread_pool->mutex)
+    {
+      SVN_ERR(svn_mutex__lock(thread_pool->mutex));
+
+      if (job->state == job_queued)
+        {
+          /* Take it out of the queue, so nobody will ever claim it. */
+          svn_thread_pool__job_t *prev = NULL;
+          svn_thread_pool__job_t *current = thread_pool->first_queued;
+
+          while (current != job)
+            {
+              prev = current;
+              current = current->next;
+            }
+
+          if (prev)
+            prev->next = job->next;
+          else
+            thread_pool->first_queued = job->next;
+
+          if (thread_pool->last_queued == job)
+            thread_pool->last_queued = prev;
+
+          job->state = job_done;
+        }
+      else
+        {
+          svn_atomic_set(&job->cancelled, TRUE);
+        }
+
+      SVN_ERR(svn_mutex__unlock(thread_pool->mutex, SVN_NO_ERROR));
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_thread_pool__join(svn_thread_pool__t *thread_pool,
+                      svn_boolean_t abort)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+#if APR_HAS_THREADS
+  if (thread_pool->running)
+    {
+      int i;
+
+      if (abort)
+        svn_atomic_set(&thread_pool->aborted, TRUE);
+
+      err = svn_mutex__lock(thread_pool->mutex);
+      if (!err)
+        {
+          thread_pool->stopping = TRUE;
+          apr_thread_cond_broadcast(thread_pool->cond);
+          err = svn_mutex__unlock(thread_pool->mutex, SVN_NO_ERROR);
+        }
+
+      for (i = 0; i < thread_pool->running; ++i)
+        {
+          apr_status_t thread_status;
+          apr_status_t status
+            = apr_thread_join(&thread_status,
+                              thread_pool->workers[i].thread);
+          if (status)
+            err = svn_error_compose_create(err,
+                    svn_error_wrap_apr(status,
+                                       _("Can't join worker thread")));
+        }
+
+      thread_pool->running = 0;
+
+      /* No other thread touches the jobs anymore.  If we aborted, there
+         may still be some that no worker claimed. */
+      while (thread_pool->first_queued)
+        {
+          thread_pool->first_queued->state = job_done;
+          thread_pool->first_queued = thread_pool->first_queued->next;
+        }
+
+      thread_pool->last_queued = NULL;
+      svn_atomic_set(&thread_pool->aborted, FALSE);
+    }
+#endif
+
+  /* Results that the owner did not wait for, including the cancellation
+     errors due to our abort, are irrelevant then. */
+  if (abort)
+    while (thread_pool->first_pending)
+      {
+        svn_thread_pool__job_t *job = thread_pool->first_pending;
+
+        svn_error_clear(job->err);
+        job->err = SVN_NO_ERROR;
+        release_job(thread_pool, job);
+      }
+
+  return svn_error_trace(err);
+}
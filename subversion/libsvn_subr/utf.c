@@ -30,7 +30,10 @@
 #include <apr_strings.h>
 #include <apr_lib.h>
 #include <apr_xlate.h>
-#include <apr_atomic.h>
+#include <apr_portable.h>
+#if APR_HAS_THREADS
+#include <apr_thread_proc.h>
+#endif
 
 #include "svn_hash.h"
 #include "svn_string.h"
@@ -59,6 +62,23 @@ static const char *SVN_APR_UTF8_CHARSET = "UTF-8";
 static svn_mutex__t *xlate_handle_mutex = NULL;
 static svn_boolean_t assume_native_charset_is_utf8 = FALSE;
 
+/* Native encodings for which conversion from and to UTF-8 is a mere
+   validation of the data. */
+typedef enum native_charset_t
+{
+  /* Unknown or some other encoding; use xlate handles. */
+  native_charset_other = 0,
+
+  /* The native encoding is UTF-8. */
+  native_charset_utf8,
+
+  /* The native encoding is 7-bit ASCII, e.g. in the "C" locale. */
+  native_charset_ascii
+} native_charset_t;
+
+/* Set by svn_utf_initialize2(). */
+static native_charset_t native_charset = native_charset_other;
+
 #if defined(WIN32)
 typedef svn_subr__win32_xlate_t xlate_handle_t;
 #else
@@ -94,12 +114,24 @@ typedef struct xlate_handle_node_t {
    memory leak. */
 static apr_hash_t *xlate_handle_hash = NULL;
 
-/* "1st level cache" to standard conversion maps. We may access these
- * using atomic xchange ops, i.e. without further thread synchronization.
- * If the respective item is NULL, fallback to hash lookup.
+/* "1st level cache" to standard conversion maps.  With threads, every
+ * thread has its own pair of handles, so they can be used without any
+ * synchronization.  If the respective item is NULL, fallback to hash
+ * lookup.
  */
-static void * volatile xlat_ntou_static_handle = NULL;
-static void * volatile xlat_uton_static_handle = NULL;
+#if APR_HAS_THREADS
+typedef struct thread_cache_t
+{
+  xlate_handle_node_t *ntou;
+  xlate_handle_node_t *uton;
+} thread_cache_t;
+
+/* Thread-local thread_cache_t *, allocated with malloc(). */
+static apr_threadkey_t *xlate_thread_key = NULL;
+#else
+static xlate_handle_node_t *xlat_ntou_static_handle = NULL;
+static xlate_handle_node_t *xlat_uton_static_handle = NULL;
+#endif
 
 /* Clean up the xlate handle cache. */
 static apr_status_t
@@ -110,8 +142,16 @@ xlate_cleanup(void *arg)
   xlate_handle_hash = NULL;
 
   /* ensure no stale objects get accessed */
+#if APR_HAS_THREADS
+  if (xlate_thread_key)
+    {
+      apr_threadkey_private_delete(xlate_thread_key);
+      xlate_thread_key = NULL;
+    }
+#else
   xlat_ntou_static_handle = NULL;
   xlat_uton_static_handle = NULL;
+#endif
 
   return APR_SUCCESS;
 }
@@ -126,6 +166,72 @@ xlate_handle_node_cleanup(void *arg)
   return APR_SUCCESS;
 }
 
+#if APR_HAS_THREADS
+/* Forward declaration. */
+static svn_error_t *
+put_xlate_handle_node_internal(xlate_handle_node_t *node,
+                               const char *userdata_key);
+
+/* Return the handles in CACHE to the global cache. */
+static svn_error_t *
+release_thread_cache(thread_cache_t *cache)
+{
+  if (cache->ntou && cache->ntou->valid)
+    SVN_ERR(put_xlate_handle_node_internal(cache->ntou,
+                                           SVN_UTF_NTOU_XLATE_HANDLE));
+  if (cache->uton && cache->uton->valid)
+    SVN_ERR(put_xlate_handle_node_internal(cache->uton,
+                                           SVN_UTF_UTON_XLATE_HANDLE));
+
+  return SVN_NO_ERROR;
+}
+
+/* Thread exit handler for xlate_thread_key.  Make the handles cached by
+   the exiting thread available to other threads. */
+static void
+xlate_thread_cache_cleanup(void *data)
+{
+  thread_cache_t *cache = data;
+
+  if (xlate_handle_hash)
+    {
+      svn_error_t *err;
+
+      err = svn_mutex__lock(xlate_handle_mutex);
+      if (!err)
+        err = svn_mutex__unlock(xlate_handle_mutex,
+                                release_thread_cache(cache));
+      svn_error_clear(err);
+    }
+
+  free(cache);
+}
+#endif
+
+/* Classify the native encoding as returned by apr_os_locale_encoding(). */
+static native_charset_t
+classify_native_charset(apr_pool_t *pool)
+{
+  const char *name = apr_os_locale_encoding(pool);
+
+  if (!name)
+    return native_charset_other;
+
+  if (!svn_cstring_casecmp(name, "UTF-8")
+      || !svn_cstring_casecmp(name, "UTF8")
+      || !svn_cstring_casecmp(name, "CP65001"))
+    return native_charset_utf8;
+
+  if (!svn_cstring_casecmp(name, "ANSI_X3.4-1968")
+      || !svn_cstring_casecmp(name, "US-ASCII")
+      || !svn_cstring_casecmp(name, "ASCII")
+      || !svn_cstring_casecmp(name, "646")
+      || !svn_cstring_casecmp(name, "CP20127"))
+    return native_charset_ascii;
+
+  return native_charset_other;
+}
+
 void
 svn_utf_initialize2(svn_boolean_t assume_native_utf8,
                     apr_pool_t *pool)
@@ -145,8 +251,18 @@ svn_utf_initialize2(svn_boolean_t assume_native_utf8,
           return;
         }
 
+#if APR_HAS_THREADS
+      {
+        apr_threadkey_t *key;
+        if (apr_threadkey_private_create(&key, xlate_thread_cache_cleanup,
+                                         subpool) == APR_SUCCESS)
+          xlate_thread_key = key;
+      }
+#endif
+
       xlate_handle_mutex = mutex;
       xlate_handle_hash = apr_hash_make(subpool);
+      native_charset = classify_native_charset(subpool);
 
       apr_pool_cleanup_register(subpool, NULL, xlate_cleanup,
                                 apr_pool_cleanup_null);
@@ -154,6 +270,9 @@ svn_utf_initialize2(svn_boolean_t assume_native_utf8,
 
     if (!assume_native_charset_is_utf8)
       assume_native_charset_is_utf8 = assume_native_utf8;
+
+    if (assume_native_charset_is_utf8)
+      native_charset = native_charset_utf8;
 }
 
 /* Return a unique string key based on TOPAGE and FROMPAGE.  TOPAGE and
@@ -181,21 +300,50 @@ get_xlate_key(const char *topage,
                      "-xlate-handle", SVN_VA_NULL);
 }
 
-/* Atomically replace the content in *MEM with NEW_VALUE and return
- * the previous content of *MEM. If atomicy cannot be guaranteed,
- * *MEM will not be modified and NEW_VALUE is simply returned to
- * the caller.
+/* Return the location of the 1st level cache entry for USERDATA_KEY in
+ * the current thread.  Return NULL if there is none.
  */
-static APR_INLINE void*
-atomic_swap(void * volatile * mem, void *new_value)
+static xlate_handle_node_t **
+get_first_level_slot(const char *userdata_key)
 {
 #if APR_HAS_THREADS
-   return svn_atomic_xchgptr(mem, new_value);
+  thread_cache_t *cache;
+  void *p;
+
+  if (   userdata_key != SVN_UTF_NTOU_XLATE_HANDLE
+      && userdata_key != SVN_UTF_UTON_XLATE_HANDLE)
+    return NULL;
+
+  if (!xlate_thread_key
+      || apr_threadkey_private_get(&p, xlate_thread_key) != APR_SUCCESS)
+    return NULL;
+
+  cache = p;
+  if (!cache)
+    {
+      /* We can't use pools here as the cache lives as long as the
+         thread does. */
+      cache = calloc(1, sizeof(*cache));
+      if (!cache)
+        return NULL;
+
+      if (apr_threadkey_private_set(cache, xlate_thread_key) != APR_SUCCESS)
+        {
+          free(cache);
+          return NULL;
+        }
+    }
+
+  return userdata_key == SVN_UTF_NTOU_XLATE_HANDLE ? &cache->ntou
+                                                   : &cache->uton;
 #else
-   /* no threads - no sync. necessary */
-   void *old_value = (void*)*mem;
-   *mem = new_value;
-   return old_value;
+  /* no threads - no sync. necessary */
+  if (userdata_key == SVN_UTF_NTOU_XLATE_HANDLE)
+    return &xlat_ntou_static_handle;
+  if (userdata_key == SVN_UTF_UTON_XLATE_HANDLE)
+    return &xlat_uton_static_handle;
+
+  return NULL;
 #endif
 }
 
@@ -350,11 +498,13 @@ get_xlate_handle_node(xlate_handle_node_t **ret,
     {
       if (xlate_handle_hash)
         {
-          /* 1st level: global, static items */
-          if (userdata_key == SVN_UTF_NTOU_XLATE_HANDLE)
-            old_node = atomic_swap(&xlat_ntou_static_handle, NULL);
-          else if (userdata_key == SVN_UTF_UTON_XLATE_HANDLE)
-            old_node = atomic_swap(&xlat_uton_static_handle, NULL);
+          /* 1st level: thread-local, static items */
+          xlate_handle_node_t **slot = get_first_level_slot(userdata_key);
+          if (slot)
+            {
+              old_node = *slot;
+              *slot = NULL;
+            }
 
           if (old_node && old_node->valid)
             {
@@ -428,11 +578,14 @@ put_xlate_handle_node(xlate_handle_node_t *node,
   /* push previous global node to the hash */
   if (xlate_handle_hash)
     {
-      /* 1st level: global, static items */
-      if (userdata_key == SVN_UTF_NTOU_XLATE_HANDLE)
-        node = atomic_swap(&xlat_ntou_static_handle, node);
-      else if (userdata_key == SVN_UTF_UTON_XLATE_HANDLE)
-        node = atomic_swap(&xlat_uton_static_handle, node);
+      /* 1st level: thread-local, static items */
+      xlate_handle_node_t **slot = get_first_level_slot(userdata_key);
+      if (slot)
+        {
+          xlate_handle_node_t *old_node = *slot;
+          *slot = node;
+          node = old_node;
+        }
       if (node == NULL)
         return SVN_NO_ERROR;
 
@@ -675,6 +828,38 @@ check_cstring_utf8(const char *data, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* If converting between the native encoding and UTF-8 is known to leave
+   the LEN bytes at DATA unchanged, set *IDENTITY to TRUE and return an
+   error with code APR_EINVAL if DATA is not valid in that encoding.
+   Otherwise, set *IDENTITY to FALSE.  This allows us to skip the xlate
+   handle lookup altogether for the most common locales. */
+static svn_error_t *
+check_native_identity(svn_boolean_t *identity,
+                      const char *data,
+                      apr_size_t len,
+                      apr_pool_t *pool)
+{
+  apr_size_t i;
+
+  switch (native_charset)
+    {
+      case native_charset_utf8:
+        *identity = TRUE;
+        return check_utf8(data, len, pool);
+
+      case native_charset_ascii:
+        *identity = TRUE;
+        for (i = 0; i < len; ++i)
+          if (! svn_ctype_isascii(data[i]))
+            return check_non_ascii(data, len, pool);
+        return SVN_NO_ERROR;
+
+      default:
+        *identity = FALSE;
+        return SVN_NO_ERROR;
+    }
+}
+
 
 svn_error_t *
 svn_utf_stringbuf_to_utf8(svn_stringbuf_t **dest,
@@ -682,8 +867,16 @@ svn_utf_stringbuf_to_utf8(svn_stringbuf_t **dest,
                           apr_pool_t *pool)
 {
   xlate_handle_node_t *node;
+  svn_boolean_t identity;
   svn_error_t *err;
 
+  SVN_ERR(check_native_identity(&identity, src->data, src->len, pool));
+  if (identity)
+    {
+      *dest = svn_stringbuf_dup(src, pool);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(get_ntou_xlate_handle_node(&node, pool));
 
   if (node->handle)
@@ -714,8 +907,16 @@ svn_utf_string_to_utf8(const svn_string_t **dest,
 {
   svn_stringbuf_t *destbuf;
   xlate_handle_node_t *node;
+  svn_boolean_t identity;
   svn_error_t *err;
 
+  SVN_ERR(check_native_identity(&identity, src->data, src->len, pool));
+  if (identity)
+    {
+      *dest = svn_string_dup(src, pool);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(get_ntou_xlate_handle_node(&node, pool));
 
   if (node->handle)
@@ -774,8 +975,17 @@ svn_utf_cstring_to_utf8(const char **dest,
                         apr_pool_t *pool)
 {
   xlate_handle_node_t *node;
+  svn_boolean_t identity;
+  apr_size_t len = strlen(src);
   svn_error_t *err;
 
+  SVN_ERR(check_native_identity(&identity, src, len, pool));
+  if (identity)
+    {
+      *dest = apr_pstrmemdup(pool, src, len);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(get_ntou_xlate_handle_node(&node, pool));
   err = convert_cstring(dest, src, node, pool);
   SVN_ERR(svn_error_compose_create(err,
@@ -804,7 +1014,7 @@ svn_utf_cstring_to_utf8_ex2(const char **dest,
   SVN_ERR(svn_error_compose_create(err,
                                    put_xlate_handle_node
                                       (node,
-                                       SVN_UTF_NTOU_XLATE_HANDLE,
+                                       convset_key,
                                        pool)));
 
   return check_cstring_utf8(*dest, pool);
@@ -828,8 +1038,16 @@ svn_utf_stringbuf_from_utf8(svn_stringbuf_t **dest,
                             apr_pool_t *pool)
 {
   xlate_handle_node_t *node;
+  svn_boolean_t identity;
   svn_error_t *err;
 
+  SVN_ERR(check_native_identity(&identity, src->data, src->len, pool));
+  if (identity)
+    {
+      *dest = svn_stringbuf_dup(src, pool);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(get_uton_xlate_handle_node(&node, pool));
 
   if (node->handle)
@@ -859,8 +1077,16 @@ svn_utf_string_from_utf8(const svn_string_t **dest,
                          apr_pool_t *pool)
 {
   xlate_handle_node_t *node;
+  svn_boolean_t identity;
   svn_error_t *err;
 
+  SVN_ERR(check_native_identity(&identity, src->data, src->len, pool));
+  if (identity)
+    {
+      *dest = svn_string_dup(src, pool);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(get_uton_xlate_handle_node(&node, pool));
 
   if (node->handle)
@@ -898,8 +1124,17 @@ svn_utf_cstring_from_utf8(const char **dest,
                           apr_pool_t *pool)
 {
   xlate_handle_node_t *node;
+  svn_boolean_t identity;
+  apr_size_t len = strlen(src);
   svn_error_t *err;
 
+  SVN_ERR(check_native_identity(&identity, src, len, pool));
+  if (identity)
+    {
+      *dest = apr_pstrmemdup(pool, src, len);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(check_cstring_utf8(src, pool));
 
   SVN_ERR(get_uton_xlate_handle_node(&node, pool));
@@ -994,8 +1229,16 @@ svn_utf_cstring_from_utf8_string(const char **dest,
                                  apr_pool_t *pool)
 {
   xlate_handle_node_t *node;
+  svn_boolean_t identity;
   svn_error_t *err;
 
+  SVN_ERR(check_native_identity(&identity, src->data, src->len, pool));
+  if (identity)
+    {
+      *dest = apr_pstrmemdup(pool, src->data, src->len);
+      return SVN_NO_ERROR;
+    }
+
   SVN_ERR(get_uton_xlate_handle_node(&node, pool));
 
   if (node->handle)
@@ -60,6 +60,10 @@
 #include "private/svn_eol_private.h"
 #include "private/svn_dep_compat.h"
 
+#ifdef SVN__HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 /* Lookup table to categorise each octet in the string. */
 static const char octet_category[256] = {
   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, /* 0x00-0x7f */
@@ -258,7 +262,16 @@ static const char machine [9][14] = {
 static const char *
 first_non_fsm_start_char(const char *data, apr_size_t max_len)
 {
-#if SVN_UNALIGNED_ACCESS_IS_OK
+#ifdef SVN__HAVE_SSE2
+
+  /* Scan the input 16 bytes at a time.  MOVEMASK collects the top bit
+   * of every byte, so any non-zero result indicates a non-ASCII char. */
+  for (; max_len >= sizeof(__m128i)
+       ; data += sizeof(__m128i), max_len -= sizeof(__m128i))
+    if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)data)))
+      break;
+
+#elif SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Scan the input one machine word at a time. */
   for (; max_len > sizeof(apr_uintptr_t)
@@ -33,9 +33,14 @@
 #include "svn_error.h"
 #include "svn_ctype.h"
 
+#include "private/svn_eol_private.h"
 #include "private/svn_utf_private.h"
 #include "private/svn_subr_private.h"
 
+#ifdef SVN__HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 #ifdef SVN_HAVE_OLD_EXPAT
 #include <xmlparse.h>
 #else
@@ -132,81 +137,137 @@ svn_xml_is_xml_safe(const char *data, apr_size_t len)
 
 /*** XML escaping. ***/
 
-/* ### ...?
- *
- * If *OUTSTR is @c NULL, set *OUTSTR to a new stringbuf allocated
- * in POOL, else append to the existing stringbuf there.
- */
-static void
-xml_escape_cdata(svn_stringbuf_t **outstr,
-                 const char *data,
-                 apr_size_t len,
-                 apr_pool_t *pool)
+/* Bits in xml_escape_class[]. */
+#define ESCAPE_CDATA 1   /* Needs escaping in character data */
+#define ESCAPE_ATTR  2   /* Needs escaping in attribute values */
+
+/* For each char, which contexts it needs to be escaped in.
+
+   Strictly speaking, '>' only needs to be quoted if it follows "]]",
+   but it's easier to quote it all the time.
+
+   So, why are we escaping '\r' here?  Well, according to the XML spec,
+   '\r\n' gets converted to '\n' during XML parsing.  Also, any '\r' not
+   followed by '\n' is converted to '\n'.  By golly, if we say we want to
+   escape a '\r', we want to make sure it remains a '\r'!
+
+   Attribute values additionally need whitespace and quote characters
+   to be escaped. */
+static const unsigned char xml_escape_class[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 0, 0, 3, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 2, 0, 0, 0, 3, 2, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 3, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* Return the entity reference for C, which must need escaping. */
+static const char *
+xml_entity(char c)
 {
-  const char *end = data + len;
-  const char *p = data, *q;
+  switch (c)
+    {
+      case '&':  return "&amp;";
+      case '<':  return "&lt;";
+      case '>':  return "&gt;";
+      case '"':  return "&quot;";
+      case '\'': return "&apos;";
+      case '\r': return "&#13;";
+      case '\n': return "&#10;";
+      default:   return "&#9;";
+    }
+}
 
-  if (*outstr == NULL)
-    *outstr = svn_stringbuf_create_empty(pool);
+/* Return a pointer to the first char between DATA and END that needs
+   escaping in contexts CONTEXT (ESCAPE_CDATA or ESCAPE_ATTR), or END. */
+static const char *
+xml_find_special(const char *data,
+                 const char *end,
+                 unsigned char context)
+{
+  const unsigned char *p = (const unsigned char *)data;
 
-  while (1)
-    {
-      /* Find a character which needs to be quoted and append bytes up
-         to that point.  Strictly speaking, '>' only needs to be
-         quoted if it follows "]]", but it's easier to quote it all
-         the time.
-
-         So, why are we escaping '\r' here?  Well, according to the
-         XML spec, '\r\n' gets converted to '\n' during XML parsing.
-         Also, any '\r' not followed by '\n' is converted to '\n'.  By
-         golly, if we say we want to escape a '\r', we want to make
-         sure it remains a '\r'!  */
-      q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>' && *q != '\r')
-        q++;
-      svn_stringbuf_appendbytes(*outstr, p, q - p);
+#ifdef SVN__HAVE_SSE2
 
-      /* We may already be a winner.  */
-      if (q == end)
+  /* Skip 16 byte blocks that don't need escaping at all. */
+  for (; end - (const char *)p >= (apr_ssize_t)sizeof(__m128i);
+       p += sizeof(__m128i))
+    {
+      __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+      __m128i found
+        = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk,
+                                                   _mm_set1_epi8('&')),
+                                    _mm_cmpeq_epi8(chunk,
+                                                   _mm_set1_epi8('<'))),
+                       _mm_or_si128(_mm_cmpeq_epi8(chunk,
+                                                   _mm_set1_epi8('>')),
+                                    _mm_cmpeq_epi8(chunk,
+                                                   _mm_set1_epi8('\r'))));
+
+      if (context == ESCAPE_ATTR)
+        found
+          = _mm_or_si128(found,
+              _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk,
+                                                       _mm_set1_epi8('"')),
+                                        _mm_cmpeq_epi8(chunk,
+                                                       _mm_set1_epi8('\''))),
+                           _mm_or_si128(_mm_cmpeq_epi8(chunk,
+                                                       _mm_set1_epi8('\n')),
+                                        _mm_cmpeq_epi8(chunk,
+                                                       _mm_set1_epi8('\t')))));
+
+      /* The exact position will be found by the loop below. */
+      if (_mm_movemask_epi8(found))
         break;
+    }
 
-      /* Append the entity reference for the character.  */
-      if (*q == '&')
-        svn_stringbuf_appendcstr(*outstr, "&amp;");
-      else if (*q == '<')
-        svn_stringbuf_appendcstr(*outstr, "&lt;");
-      else if (*q == '>')
-        svn_stringbuf_appendcstr(*outstr, "&gt;");
-      else if (*q == '\r')
-        svn_stringbuf_appendcstr(*outstr, "&#13;");
+#endif
 
-      p = q + 1;
-    }
+  while ((const char *)p < end && !(xml_escape_class[*p] & context))
+    p++;
+
+  return (const char *)p;
 }
 
-/* Essentially the same as xml_escape_cdata, with the addition of
-   whitespace and quote characters. */
+/* Append LEN bytes of DATA to *OUTSTR, escaping all chars that need to
+   be escaped in CONTEXT (ESCAPE_CDATA or ESCAPE_ATTR).
+
+   If *OUTSTR is @c NULL, set *OUTSTR to a new stringbuf allocated
+   in POOL, else append to the existing stringbuf there.
+ */
 static void
-xml_escape_attr(svn_stringbuf_t **outstr,
-                const char *data,
-                apr_size_t len,
-                apr_pool_t *pool)
+xml_escape(svn_stringbuf_t **outstr,
+           const char *data,
+           apr_size_t len,
+           unsigned char context,
+           apr_pool_t *pool)
 {
   const char *end = data + len;
   const char *p = data, *q;
 
+  /* Most data needs few if any escapes, so make room for all of it
+     in one go. */
   if (*outstr == NULL)
     *outstr = svn_stringbuf_create_ensure(len, pool);
+  else
+    svn_stringbuf_ensure(*outstr, (*outstr)->len + len);
 
   while (1)
     {
       /* Find a character which needs to be quoted and append bytes up
          to that point. */
-      q = p;
-      while (q < end && *q != '&' && *q != '<' && *q != '>'
-             && *q != '"' && *q != '\'' && *q != '\r'
-             && *q != '\n' && *q != '\t')
-        q++;
+      q = xml_find_special(p, end, context);
       svn_stringbuf_appendbytes(*outstr, p, q - p);
 
       /* We may already be a winner.  */
@@ -214,27 +275,33 @@ xml_escape_attr(svn_stringbuf_t **outstr,
         break;
 
       /* Append the entity reference for the character.  */
-      if (*q == '&')
-        svn_stringbuf_appendcstr(*outstr, "&amp;");
-      else if (*q == '<')
-        svn_stringbuf_appendcstr(*outstr, "&lt;");
-      else if (*q == '>')
-        svn_stringbuf_appendcstr(*outstr, "&gt;");
-      else if (*q == '"')
-        svn_stringbuf_appendcstr(*outstr, "&quot;");
-      else if (*q == '\'')
-        svn_stringbuf_appendcstr(*outstr, "&apos;");
-      else if (*q == '\r')
-        svn_stringbuf_appendcstr(*outstr, "&#13;");
-      else if (*q == '\n')
-        svn_stringbuf_appendcstr(*outstr, "&#10;");
-      else if (*q == '\t')
-        svn_stringbuf_appendcstr(*outstr, "&#9;");
+      svn_stringbuf_appendcstr(*outstr, xml_entity(*q));
 
       p = q + 1;
     }
 }
 
+/* Escape character data. */
+static void
+xml_escape_cdata(svn_stringbuf_t **outstr,
+                 const char *data,
+                 apr_size_t len,
+                 apr_pool_t *pool)
+{
+  xml_escape(outstr, data, len, ESCAPE_CDATA, pool);
+}
+
+/* Essentially the same as xml_escape_cdata, with the addition of
+   whitespace and quote characters. */
+static void
+xml_escape_attr(svn_stringbuf_t **outstr,
+                const char *data,
+                apr_size_t len,
+                apr_pool_t *pool)
+{
+  xml_escape(outstr, data, len, ESCAPE_ATTR, pool);
+}
+
 
 void
 svn_xml_escape_cdata_stringbuf(svn_stringbuf_t **outstr,
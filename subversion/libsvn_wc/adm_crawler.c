@@ -39,6 +39,8 @@
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 
+#include "private/svn_subr_private.h"
+#include "private/svn_thread_pool.h"
 #include "private/svn_wc_private.h"
 
 #include "wc.h"
@@ -1051,33 +1053,61 @@ open_txdelta_stream(svn_txdelta_stream_t **txdelta_stream_p,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
-                                      const svn_checksum_t **new_text_base_md5_checksum,
-                                      const svn_checksum_t **new_text_base_sha1_checksum,
-                                      svn_wc__db_t *db,
-                                      const char *local_abspath,
-                                      svn_boolean_t fulltext,
-                                      const svn_delta_editor_t *editor,
-                                      void *file_baton,
-                                      apr_pool_t *result_pool,
-                                      apr_pool_t *scratch_pool)
+/* State of a text transmission as performed by svn_wc_transmit_text_deltas3().
+ * The transmission is split into the preparation by begin_transmit(), the
+ * reading of the texts, which does not access the working copy database,
+ * and finish_transmit(), which installs the new pristine and closes the
+ * file baton.  That allows svn_wc__transmit_queue_t to compute the deltas
+ * of several files concurrently.
+ */
+typedef struct transmit_job_t
+{
+  /* The file being transmitted. */
+  const char *local_abspath;
+
+  /* Delta source and target: the pristine text and LOCAL_ABSPATH
+     translated to normal form. */
+  svn_stream_t *base_stream;
+  svn_stream_t *local_stream;
+
+  /* Recorded MD5 of BASE_STREAM and the one calculated while reading it.
+     Both are NULL if a fulltext gets sent. */
+  const svn_checksum_t *expected_md5_checksum;
+  svn_checksum_t *verify_checksum;
+
+  /* Calculated while reading LOCAL_STREAM. */
+  svn_checksum_t *local_md5_checksum;
+  svn_checksum_t *local_sha1_checksum;
+
+  /* Where the new pristine text goes, if one is being installed. */
+  svn_wc__db_install_data_t *install_data;
+} transmit_job_t;
+
+/* Prepare JOB for transmitting the text of LOCAL_ABSPATH in DB, against an
+ * empty base if FULLTEXT is set.  Copy the text in normal form to
+ * TEMPSTREAM unless that is NULL and prepare installing it as the new
+ * pristine if INSTALL_PRISTINE is set.  Allocate the streams in
+ * RESULT_POOL.
+ */
+static svn_error_t *
+begin_transmit(transmit_job_t *job,
+               svn_stream_t *tempstream,
+               svn_wc__db_t *db,
+               const char *local_abspath,
+               svn_boolean_t fulltext,
+               svn_boolean_t install_pristine,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
 {
-  const svn_checksum_t *expected_md5_checksum;  /* recorded MD5 of BASE_S. */
-  svn_checksum_t *verify_checksum;  /* calc'd MD5 of BASE_STREAM */
-  svn_checksum_t *local_md5_checksum;  /* calc'd MD5 of LOCAL_STREAM */
-  svn_checksum_t *local_sha1_checksum;  /* calc'd SHA1 of LOCAL_STREAM */
-  svn_wc__db_install_data_t *install_data = NULL;
   svn_error_t *err;
-  svn_error_t *err2;
-  svn_stream_t *base_stream;  /* delta source */
-  svn_stream_t *local_stream;  /* delta target: LOCAL_ABSPATH transl. to NF */
+
+  job->local_abspath = local_abspath;
 
   /* Translated input */
-  SVN_ERR(svn_wc__internal_translated_stream(&local_stream, db,
+  SVN_ERR(svn_wc__internal_translated_stream(&job->local_stream, db,
                                              local_abspath, local_abspath,
                                              SVN_WC_TRANSLATE_TO_NF,
-                                             scratch_pool, scratch_pool));
+                                             result_pool, scratch_pool));
 
   /* If the caller wants a copy of the working file translated to
    * repository-normal form, make the copy by tee-ing the TEMPSTREAM.
@@ -1091,19 +1121,20 @@ svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
          translated contents into the new text base file as we read from it.
          Note that the new text base file will be closed when the new stream
          is closed. */
-      local_stream = copying_stream(local_stream, tempstream, scratch_pool);
+      job->local_stream = copying_stream(job->local_stream, tempstream,
+                                         result_pool);
     }
-  if (new_text_base_sha1_checksum)
+  if (install_pristine)
     {
       svn_stream_t *new_pristine_stream;
 
       SVN_ERR(svn_wc__db_pristine_prepare_install(&new_pristine_stream,
-                                                  &install_data,
-                                                  &local_sha1_checksum, NULL,
-                                                  db, local_abspath,
-                                                  scratch_pool, scratch_pool));
-      local_stream = copying_stream(local_stream, new_pristine_stream,
-                                    scratch_pool);
+                                                  &job->install_data,
+                                                  &job->local_sha1_checksum,
+                                                  NULL, db, local_abspath,
+                                                  result_pool, scratch_pool));
+      job->local_stream = copying_stream(job->local_stream,
+                                         new_pristine_stream, result_pool);
     }
 
   /* If sending a full text is requested, or if there is no pristine text
@@ -1112,69 +1143,88 @@ svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
    *
    * Otherwise, set BASE_STREAM to a stream providing the base (source) text
    * for the delta, set EXPECTED_MD5_CHECKSUM to its stored MD5 checksum,
-   * and arrange for its VERIFY_CHECKSUM to be calculated later. */
+   * and arrange for its VERIFY_CHECKSUM to be calculated later.  A
+   * dehydrated pristine text of a modified file is not worth fetching
+   * just to send a delta, so send a full text instead. */
   if (! fulltext)
     {
       /* We will be computing a delta against the pristine contents */
       /* We need the expected checksum to be an MD-5 checksum rather than a
        * SHA-1 because we want to pass it to apply_textdelta(). */
-      SVN_ERR(read_and_checksum_pristine_text(&base_stream,
-                                              &expected_md5_checksum,
-                                              &verify_checksum,
-                                              db, local_abspath,
-                                              scratch_pool, scratch_pool));
+      err = read_and_checksum_pristine_text(&job->base_stream,
+                                            &job->expected_md5_checksum,
+                                            &job->verify_checksum,
+                                            db, local_abspath,
+                                            result_pool, scratch_pool);
+      if (err && err->apr_err == SVN_ERR_WC_PRISTINE_DEHYDRATED)
+        {
+          svn_error_clear(err);
+          fulltext = TRUE;
+        }
+      else
+        SVN_ERR(err);
     }
-  else
+
+  if (fulltext)
     {
       /* Send a fulltext. */
-      base_stream = svn_stream_empty(scratch_pool);
-      expected_md5_checksum = NULL;
-      verify_checksum = NULL;
+      job->base_stream = svn_stream_empty(result_pool);
+      job->expected_md5_checksum = NULL;
+      job->verify_checksum = NULL;
     }
 
   /* Arrange the stream to calculate the resulting MD5. */
-  local_stream = svn_stream_checksummed2(local_stream, &local_md5_checksum,
-                                         NULL, svn_checksum_md5, TRUE,
-                                         scratch_pool);
+  job->local_stream = svn_stream_checksummed2(job->local_stream,
+                                              &job->local_md5_checksum,
+                                              NULL, svn_checksum_md5, TRUE,
+                                              result_pool);
 
-  /* Tell the editor to apply a textdelta stream to the file baton. */
-  {
-    open_txdelta_stream_baton_t baton = { 0 };
-
-    /* apply_textdelta_stream() is working against a base with this checksum */
-    const char *base_digest_hex = NULL;
-
-    if (expected_md5_checksum)
-      /* ### Why '..._display()'?  expected_md5_checksum should never be all-
-       * zero, but if it is, we would want to pass NULL not an all-zero
-       * digest to apply_textdelta_stream(), wouldn't we? */
-      base_digest_hex = svn_checksum_to_cstring_display(expected_md5_checksum,
-                                                        scratch_pool);
-
-    baton.need_reset = FALSE;
-    baton.base_stream = svn_stream_disown(base_stream, scratch_pool);
-    baton.local_stream = svn_stream_disown(local_stream, scratch_pool);
-    err = editor->apply_textdelta_stream(editor, file_baton, base_digest_hex,
-                                         open_txdelta_stream, &baton,
-                                         scratch_pool);
-  }
+  return SVN_NO_ERROR;
+}
+
+/* Return the hex digest of the text that JOB's delta applies to, or NULL
+ * for a fulltext. */
+static const char *
+base_digest_hex(const transmit_job_t *job,
+                apr_pool_t *result_pool)
+{
+  /* ### Why '..._display()'?  expected_md5_checksum should never be all-
+   * zero, but if it is, we would want to pass NULL not an all-zero
+   * digest to apply_textdelta_stream(), wouldn't we? */
+  return job->expected_md5_checksum
+       ? svn_checksum_to_cstring_display(job->expected_md5_checksum,
+                                         result_pool)
+       : NULL;
+}
+
+/* Close the streams of JOB after ERR, the error of reading them, if any,
+ * and verify the pristine text that has been read.  Return the resulting
+ * error.
+ */
+static svn_error_t *
+end_transmit(transmit_job_t *job,
+             svn_error_t *err,
+             apr_pool_t *scratch_pool)
+{
+  svn_error_t *err2;
 
   /* Close the two streams to force writing the digest */
-  err2 = svn_stream_close(base_stream);
+  err2 = svn_stream_close(job->base_stream);
   if (err2)
     {
       /* Set verify_checksum to NULL if svn_stream_close() returns error
          because checksum will be uninitialized in this case. */
-      verify_checksum = NULL;
+      job->verify_checksum = NULL;
       err = svn_error_compose_create(err, err2);
     }
 
-  err = svn_error_compose_create(err, svn_stream_close(local_stream));
+  err = svn_error_compose_create(err, svn_stream_close(job->local_stream));
 
   /* If we have an error, it may be caused by a corrupt text base,
      so check the checksum. */
-  if (expected_md5_checksum && verify_checksum
-      && !svn_checksum_match(expected_md5_checksum, verify_checksum))
+  if (job->expected_md5_checksum && job->verify_checksum
+      && !svn_checksum_match(job->expected_md5_checksum,
+                             job->verify_checksum))
     {
       /* The entry checksum does not match the actual text
          base checksum.  Extreme badness. Of course,
@@ -1189,10 +1239,11 @@ svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
          too, such as `svn diff'.  */
 
       err = svn_error_compose_create(
-              svn_checksum_mismatch_err(expected_md5_checksum, verify_checksum,
+              svn_checksum_mismatch_err(job->expected_md5_checksum,
+                                        job->verify_checksum,
                             scratch_pool,
                             _("Checksum mismatch for text base of '%s'"),
-                            svn_dirent_local_style(local_abspath,
+                            svn_dirent_local_style(job->local_abspath,
                                                    scratch_pool)),
               err);
 
@@ -1203,30 +1254,83 @@ svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
      thinking about it after this point. */
   SVN_ERR_W(err, apr_psprintf(scratch_pool,
                               _("While preparing '%s' for commit"),
-                              svn_dirent_local_style(local_abspath,
+                              svn_dirent_local_style(job->local_abspath,
                                                      scratch_pool)));
 
+  return SVN_NO_ERROR;
+}
+
+/* Install the new pristine text of the completely read JOB, if requested,
+ * and close FILE_BATON of EDITOR.  Set *NEW_TEXT_BASE_MD5_CHECKSUM and
+ * *NEW_TEXT_BASE_SHA1_CHECKSUM as svn_wc_transmit_text_deltas3() does.
+ */
+static svn_error_t *
+finish_transmit(const svn_checksum_t **new_text_base_md5_checksum,
+                const svn_checksum_t **new_text_base_sha1_checksum,
+                transmit_job_t *job,
+                const svn_delta_editor_t *editor,
+                void *file_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
   if (new_text_base_md5_checksum)
-    *new_text_base_md5_checksum = svn_checksum_dup(local_md5_checksum,
+    *new_text_base_md5_checksum = svn_checksum_dup(job->local_md5_checksum,
                                                    result_pool);
+  if (job->install_data)
+    SVN_ERR(svn_wc__db_pristine_install(job->install_data,
+                                        job->local_sha1_checksum,
+                                        job->local_md5_checksum,
+                                        scratch_pool));
   if (new_text_base_sha1_checksum)
-    {
-      SVN_ERR(svn_wc__db_pristine_install(install_data,
-                                          local_sha1_checksum,
-                                          local_md5_checksum,
-                                          scratch_pool));
-      *new_text_base_sha1_checksum = svn_checksum_dup(local_sha1_checksum,
-                                                      result_pool);
-    }
+    *new_text_base_sha1_checksum = svn_checksum_dup(job->local_sha1_checksum,
+                                                    result_pool);
 
   /* Close the file baton, and get outta here. */
   return svn_error_trace(
              editor->close_file(file_baton,
-                                svn_checksum_to_cstring(local_md5_checksum,
-                                                        scratch_pool),
+                                svn_checksum_to_cstring(
+                                                job->local_md5_checksum,
+                                                scratch_pool),
                                 scratch_pool));
 }
 
+svn_error_t *
+svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
+                                      const svn_checksum_t **new_text_base_md5_checksum,
+                                      const svn_checksum_t **new_text_base_sha1_checksum,
+                                      svn_wc__db_t *db,
+                                      const char *local_abspath,
+                                      svn_boolean_t fulltext,
+                                      const svn_delta_editor_t *editor,
+                                      void *file_baton,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool)
+{
+  transmit_job_t job = { 0 };
+  open_txdelta_stream_baton_t baton = { 0 };
+  svn_error_t *err;
+
+  SVN_ERR(begin_transmit(&job, tempstream, db, local_abspath, fulltext,
+                         new_text_base_sha1_checksum != NULL,
+                         scratch_pool, scratch_pool));
+
+  /* Tell the editor to apply a textdelta stream to the file baton. */
+  baton.need_reset = FALSE;
+  baton.base_stream = svn_stream_disown(job.base_stream, scratch_pool);
+  baton.local_stream = svn_stream_disown(job.local_stream, scratch_pool);
+  err = editor->apply_textdelta_stream(editor, file_baton,
+                                       base_digest_hex(&job, scratch_pool),
+                                       open_txdelta_stream, &baton,
+                                       scratch_pool);
+
+  SVN_ERR(end_transmit(&job, err, scratch_pool));
+
+  return svn_error_trace(finish_transmit(new_text_base_md5_checksum,
+                                         new_text_base_sha1_checksum,
+                                         &job, editor, file_baton,
+                                         result_pool, scratch_pool));
+}
+
 svn_error_t *
 svn_wc_transmit_text_deltas3(const svn_checksum_t **new_text_base_md5_checksum,
                              const svn_checksum_t **new_text_base_sha1_checksum,
@@ -1247,6 +1351,375 @@ svn_wc_transmit_text_deltas3(const svn_checksum_t **new_text_base_md5_checksum,
                                                scratch_pool);
 }
 
+
+/*** Queued text transmissions. ***/
+
+/* How many transmissions per worker thread may be pending in a transmit
+ * queue before svn_wc__transmit_queue_add() sends the oldest one. */
+#define TRANSMIT_QUEUE_SLOTS_PER_WORKER 4
+
+/* How much of a queued delta may be buffered in memory before the rest
+ * spills to a temporary file. */
+#define TRANSMIT_QUEUE_SPILL_SIZE (1024 * 1024)
+
+/* A transmission waiting in a svn_wc__transmit_queue_t. */
+typedef struct queued_transmit_t
+{
+  /* The transmission itself. */
+  transmit_job_t job;
+
+  /* The svndiff encoded delta of JOB, once computed. */
+  svn_spillbuf_t *delta;
+
+  /* Where to send the text to and whom to tell afterwards. */
+  void *file_baton;
+  svn_wc__transmit_done_func_t done_func;
+  void *done_baton;
+
+  /* The delta computation running in the queue's thread pool or NULL if
+     it has been waited for already. */
+  svn_thread_pool__job_t *delta_job;
+
+  /* Outcome of the delta computation. */
+  svn_error_t *err;
+
+  /* Next transmission in the queue. */
+  struct queued_transmit_t *next;
+
+  /* Root pool holding all data of this transmission, including its
+     streams.  Only used by the thread that computes the delta until it
+     is done, otherwise only by the thread that owns the queue. */
+  apr_pool_t *pool;
+} queued_transmit_t;
+
+struct svn_wc__transmit_queue_t
+{
+  /* The working copy to transmit from and the editor to transmit to. */
+  svn_wc_context_t *wc_ctx;
+  const svn_delta_editor_t *editor;
+
+  /* Maximum number of concurrent delta computations. */
+  int jobs;
+
+  /* Cancellation callback used while sending and waiting for deltas. */
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Pending transmissions in the order they were added.  Send them from
+     the head of the list. */
+  queued_transmit_t *first;
+  queued_transmit_t *last;
+  int pending;
+
+  /* Computes the queued deltas.  NULL if JOBS is 1. */
+  svn_thread_pool__t *thread_pool;
+
+  /* The pool used for the queue itself and the checksums it returns. */
+  apr_pool_t *pool;
+};
+
+/* Read the texts of the prepared transmission T and write their svndiff
+ * encoded delta into T->DELTA.  Use SCRATCH_POOL for temporary
+ * allocations.
+ */
+static svn_error_t *
+compute_queued_delta(queued_transmit_t *t,
+                     apr_pool_t *scratch_pool)
+{
+  svn_txdelta_stream_t *txdelta_stream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_error_t *err;
+
+  /* The delta only lives until it gets sent, so don't bother compressing
+     it.  The editor will encode it the way the server wants it. */
+  t->delta = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                  TRANSMIT_QUEUE_SPILL_SIZE, t->pool);
+  svn_txdelta2(&txdelta_stream,
+               svn_stream_disown(t->job.base_stream, scratch_pool),
+               svn_stream_disown(t->job.local_stream, scratch_pool),
+               FALSE, scratch_pool);
+  svn_txdelta_to_svndiff3(&handler, &handler_baton,
+                          svn_stream__from_spillbuf(t->delta, t->pool),
+                          0, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                          scratch_pool);
+  err = svn_txdelta_send_txstream(txdelta_stream, handler, handler_baton,
+                                  scratch_pool);
+
+  return svn_error_trace(end_transmit(&t->job, err, scratch_pool));
+}
+
+/* Send the computed delta of T through the editor of QUEUE and close the
+ * file baton.  Set the checksums as for svn_wc_transmit_text_deltas3(),
+ * allocated in RESULT_POOL.
+ */
+static svn_error_t *
+send_queued_delta(const svn_checksum_t **new_text_base_md5_checksum,
+                  const svn_checksum_t **new_text_base_sha1_checksum,
+                  svn_wc__transmit_queue_t *queue,
+                  queued_transmit_t *t,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  const svn_delta_editor_t *editor = queue->editor;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_error_t *err;
+
+  err = editor->apply_textdelta(t->file_baton,
+                                base_digest_hex(&t->job, scratch_pool),
+                                scratch_pool, &handler, &handler_baton);
+  if (!err)
+    err = svn_stream_copy3(svn_stream__from_spillbuf(t->delta, scratch_pool),
+                           svn_txdelta_parse_svndiff(handler, handler_baton,
+                                                     TRUE, scratch_pool),
+                           queue->cancel_func, queue->cancel_baton,
+                           scratch_pool);
+
+  SVN_ERR_W(err, apr_psprintf(scratch_pool,
+                              _("While preparing '%s' for commit"),
+                              svn_dirent_local_style(t->job.local_abspath,
+                                                     scratch_pool)));
+
+  return svn_error_trace(finish_transmit(new_text_base_md5_checksum,
+                                         new_text_base_sha1_checksum,
+                                         &t->job, editor, t->file_baton,
+                                         result_pool, scratch_pool));
+}
+
+/* Implements svn_thread_pool__job_func_t.  Compute the delta of the
+ * queued_transmit_t given as JOB_BATON and store the outcome in it.
+ */
+static svn_error_t *
+compute_delta_job(void *job_baton,
+                  void *worker_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  queued_transmit_t *t = job_baton;
+
+  t->err = compute_queued_delta(t, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Stop the workers of QUEUE and discard all pending transmissions. */
+static void
+discard_queued_transmits(svn_wc__transmit_queue_t *queue)
+{
+  if (queue->thread_pool)
+    svn_error_clear(svn_thread_pool__join(queue->thread_pool, TRUE));
+
+  while (queue->first)
+    {
+      queued_transmit_t *t = queue->first;
+
+      queue->first = t->next;
+      svn_error_clear(t->err);
+      svn_pool_destroy(t->pool);
+    }
+
+  queue->last = NULL;
+  queue->pending = 0;
+}
+
+/* Pool cleanup function discarding everything pending in the transmit
+ * queue given as DATA. */
+static apr_status_t
+abort_transmit_queue(void *data)
+{
+  discard_queued_transmits(data);
+  return APR_SUCCESS;
+}
+
+/* Remove the oldest transmission from QUEUE, wait for its delta to be
+ * computed and send it.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+send_queued_transmit(svn_wc__transmit_queue_t *queue,
+                     apr_pool_t *scratch_pool)
+{
+  queued_transmit_t *t = queue->first;
+  const svn_checksum_t *md5_checksum = NULL;
+  const svn_checksum_t *sha1_checksum = NULL;
+  svn_error_t *err;
+
+  SVN_ERR_ASSERT(t);
+
+  /* If we can't get the delta, none of the pending transmissions may be
+     sent anymore. */
+  if (t->delta_job)
+    {
+      err = svn_thread_pool__wait(queue->thread_pool, t->delta_job,
+                                  queue->cancel_func, queue->cancel_baton);
+      t->delta_job = NULL;
+      if (err)
+        {
+          discard_queued_transmits(queue);
+          return svn_error_trace(err);
+        }
+    }
+
+  queue->first = t->next;
+  if (!queue->first)
+    queue->last = NULL;
+
+  --queue->pending;
+
+  err = t->err;
+  if (!err)
+    err = send_queued_delta(&md5_checksum, &sha1_checksum, queue, t,
+                            queue->pool, scratch_pool);
+  if (err)
+    md5_checksum = sha1_checksum = NULL;
+
+  err = t->done_func(t->done_baton, t->job.local_abspath,
+                     md5_checksum, sha1_checksum, err, scratch_pool);
+
+  svn_pool_destroy(t->pool);
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svn_wc__transmit_queue_create(svn_wc__transmit_queue_t **queue,
+                              svn_wc_context_t *wc_ctx,
+                              const svn_delta_editor_t *editor,
+                              int jobs,
+                              svn_cancel_func_t cancel_func,
+                              void *cancel_baton,
+                              apr_pool_t *result_pool)
+{
+  svn_wc__transmit_queue_t *result = apr_pcalloc(result_pool,
+                                                 sizeof(*result));
+
+#if !APR_HAS_THREADS
+  jobs = 1;
+#endif
+
+  result->wc_ctx = wc_ctx;
+  result->editor = editor;
+  result->jobs = jobs > 1 ? jobs : 1;
+  result->cancel_func = cancel_func;
+  result->cancel_baton = cancel_baton;
+  result->pool = result_pool;
+
+  /* Don't leave threads or temporary files behind in case of errors.
+     The threads only get started once there are deltas to compute. */
+  if (result->jobs > 1)
+    {
+      SVN_ERR(svn_thread_pool__create(&result->thread_pool, result->jobs,
+                                      NULL, NULL, result_pool));
+      apr_pool_pre_cleanup_register(result_pool, result,
+                                    abort_transmit_queue);
+    }
+
+  *queue = result;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__transmit_queue_add(svn_wc__transmit_queue_t *queue,
+                           const char *local_abspath,
+                           svn_boolean_t fulltext,
+                           void *file_baton,
+                           svn_wc__transmit_done_func_t done_func,
+                           void *done_baton,
+                           apr_pool_t *scratch_pool)
+{
+  apr_pool_t *pool;
+  queued_transmit_t *t;
+  svn_error_t *err;
+
+  /* Without concurrency, there is nothing to gain from queueing. */
+  if (queue->jobs == 1)
+    {
+      const svn_checksum_t *md5_checksum;
+      const svn_checksum_t *sha1_checksum;
+
+      err = svn_wc__internal_transmit_text_deltas(NULL, &md5_checksum,
+                                                  &sha1_checksum,
+                                                  queue->wc_ctx->db,
+                                                  local_abspath, fulltext,
+                                                  queue->editor, file_baton,
+                                                  queue->pool, scratch_pool);
+      if (err)
+        md5_checksum = sha1_checksum = NULL;
+
+      return svn_error_trace(done_func(done_baton, local_abspath,
+                                       md5_checksum, sha1_checksum, err,
+                                       scratch_pool));
+    }
+
+  /* Limit the number of pending deltas and temporary files. */
+  if (queue->pending >= queue->jobs * TRANSMIT_QUEUE_SLOTS_PER_WORKER)
+    SVN_ERR(send_queued_transmit(queue, scratch_pool));
+
+  /* The worker that computes the delta reads the streams, which allocate
+     from their pool, so that must not be shared with this thread. */
+  pool = svn_thread_pool__create_root_pool(NULL);
+  t = apr_pcalloc(pool, sizeof(*t));
+  t->pool = pool;
+  t->file_baton = file_baton;
+  t->done_func = done_func;
+  t->done_baton = done_baton;
+
+  err = begin_transmit(&t->job, NULL, queue->wc_ctx->db,
+                       apr_pstrdup(pool, local_abspath), fulltext, TRUE,
+                       pool, scratch_pool);
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(done_func(done_baton, local_abspath,
+                                       NULL, NULL, err, scratch_pool));
+    }
+
+  err = svn_thread_pool__submit(&t->delta_job, queue->thread_pool,
+                                compute_delta_job, t);
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  ++queue->pending;
+
+  if (queue->last)
+    queue->last->next = t;
+  else
+    queue->first = t;
+  queue->last = t;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__transmit_queue_flush(svn_wc__transmit_queue_t *queue,
+                             apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+
+  while (queue->first && !err)
+    {
+      svn_pool_clear(iterpool);
+      err = send_queued_transmit(queue, iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Don't keep idle threads around. */
+  if (!err && queue->thread_pool)
+    err = svn_thread_pool__join(queue->thread_pool, FALSE);
+
+  /* After an error, discard all transmissions that have not been sent. */
+  if (err)
+    discard_queued_transmits(queue);
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *
 svn_wc__internal_transmit_prop_deltas(svn_wc__db_t *db,
                                      const char *local_abspath,
@@ -43,6 +43,7 @@
 #include "adm_files.h"
 #include "entries.h"
 #include "lock.h"
+#include "textbase.h"
 
 #include "svn_private_config.h"
 #include "private/svn_wc_private.h"
@@ -209,6 +210,8 @@ svn_wc__text_base_path_to_read(const char **result_abspath,
                              _("Node '%s' has no pristine text"),
                              svn_dirent_local_style(local_abspath,
                                                     scratch_pool));
+  SVN_ERR(svn_wc__textbase_restore(NULL, db, local_abspath, checksum,
+                                   scratch_pool));
   SVN_ERR(svn_wc__db_pristine_get_path(result_abspath, db, local_abspath,
                                        checksum,
                                        result_pool, scratch_pool));
@@ -266,9 +269,13 @@ svn_wc__get_pristine_contents(svn_stream_t **contents,
                              svn_dirent_local_style(local_abspath,
                                                     scratch_pool));
   if (sha1_checksum)
-    SVN_ERR(svn_wc__db_pristine_read(contents, size, db, local_abspath,
-                                     sha1_checksum,
-                                     result_pool, scratch_pool));
+    {
+      SVN_ERR(svn_wc__textbase_restore(NULL, db, local_abspath,
+                                       sha1_checksum, scratch_pool));
+      SVN_ERR(svn_wc__db_pristine_read(contents, size, db, local_abspath,
+                                       sha1_checksum,
+                                       result_pool, scratch_pool));
+    }
   else
     *contents = NULL;
 
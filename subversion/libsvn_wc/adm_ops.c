@@ -875,10 +875,27 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
       *contents = svn_stream_lazyopen_create(get_pristine_lazyopen_func,
                                              gpl_baton, FALSE, result_pool);
     }
+  else
+    SVN_ERR(svn_wc__db_pristine_read_shared(contents, wc_ctx->db, checksum,
+                                            result_pool, scratch_pool));
 
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__get_shared_pristine_contents(svn_stream_t **contents,
+                                     svn_wc_context_t *wc_ctx,
+                                     const svn_checksum_t *checksum,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(svn_wc__db_pristine_read_shared(contents,
+                                                         wc_ctx->db,
+                                                         checksum,
+                                                         result_pool,
+                                                         scratch_pool));
+}
+
 
 
 svn_error_t *
@@ -4784,13 +4784,31 @@ svn_wc_revision_status(svn_wc_revision_status_t **result_p,
   SVN_ERR(svn_dirent_get_absolute(&local_abspath, wc_path, pool));
   SVN_ERR(svn_wc_context_create(&wc_ctx, NULL /* config */, pool, pool));
 
-  SVN_ERR(svn_wc_revision_status2(result_p, wc_ctx, local_abspath, trail_url,
-                                  committed, cancel_func, cancel_baton, pool,
-                                  pool));
+  SVN_ERR(svn_wc_revision_status3(result_p, wc_ctx, local_abspath, trail_url,
+                                  committed, FALSE, cancel_func, cancel_baton,
+                                  pool, pool));
 
   return svn_error_trace(svn_wc_context_destroy(wc_ctx));
 }
 
+svn_error_t *
+svn_wc_revision_status2(svn_wc_revision_status_t **result_p,
+                        svn_wc_context_t *wc_ctx,
+                        const char *local_abspath,
+                        const char *trail_url,
+                        svn_boolean_t committed,
+                        svn_cancel_func_t cancel_func,
+                        void *cancel_baton,
+                        apr_pool_t *result_pool,
+                        apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(svn_wc_revision_status3(result_p, wc_ctx,
+                                                 local_abspath, trail_url,
+                                                 committed, FALSE,
+                                                 cancel_func, cancel_baton,
+                                                 result_pool, scratch_pool));
+}
+
 /*** From crop.c ***/
 svn_error_t *
 svn_wc_crop_tree(svn_wc_adm_access_t *anchor,
@@ -0,0 +1,334 @@
+/*
+ * fsmonitor.c :  asking a file system monitor which files changed
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* The monitor is an external program, typically a thin wrapper around
+ * a file system watcher such as inotify, FSEvents or Watchman.  It is
+ * run in the root of the working copy as
+ *
+ *     PROGRAM WCROOT TOKEN
+ *
+ * and prints a new TOKEN followed by the paths that may have changed
+ * since the TOKEN it was given, each terminated by a NUL character.
+ * Paths are relative to WCROOT and '/' separated; a trailing '/' stands
+ * for everything below a directory and a single "/" for the whole
+ * working copy, which is also what an unknown TOKEN should produce.
+ *
+ * The monitor's answer alone is not enough, as a file may have been
+ * modified long before the last TOKEN.  So after a walk, we store the
+ * new TOKEN together with the files that did *not* match their recorded
+ * size and timestamp in SVN_WC__ADM_FSMONITOR, in the same format.  The
+ * files the next walk has to check are then the union of those files
+ * and the changed paths the monitor reports. */
+
+
+#include <string.h>
+
+#include <apr_pools.h>
+#include <apr_hash.h>
+#include <apr_strings.h>
+
+#include "svn_pools.h"
+#include "svn_types.h"
+#include "svn_error.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_hash.h"
+
+#include "svn_private_config.h"
+
+#include "wc.h"
+#include "adm_files.h"
+#include "fsmonitor.h"
+
+
+struct svn_wc__fsmonitor_t
+{
+  const char *wcroot_abspath;
+
+  /* The token returned by the monitor. */
+  const char *token;
+
+  /* Files that have to be checked on disk, and directories all of whose
+     files have to be.  The keys are relpaths below WCROOT_ABSPATH, with
+     "" in DIRS standing for the whole working copy. */
+  apr_hash_t *files;
+  apr_hash_t *dirs;
+
+  /* The files found not to match their recorded information by this
+     walk. */
+  apr_hash_t *mismatched;
+
+  apr_pool_t *pool;
+};
+
+/* Parse the DATA of LEN bytes, in the format described at the top of
+   this file, into *TOKEN and the FILES and DIRS hashes.  Allocate
+   everything in RESULT_POOL. */
+static svn_error_t *
+parse_paths(const char **token,
+            apr_hash_t *files,
+            apr_hash_t *dirs,
+            const char *data,
+            apr_size_t len,
+            apr_pool_t *result_pool)
+{
+  const char *end = data + len;
+  const char *item = data;
+
+  while (item < end)
+    {
+      const char *next = memchr(item, '\0', end - item);
+      apr_size_t item_len;
+      const char *relpath;
+      svn_boolean_t is_dir = FALSE;
+
+      /* An unterminated path was cut short. */
+      if (!next)
+        break;
+
+      item_len = next - item;
+      if (item == data)
+        {
+          *token = apr_pstrmemdup(result_pool, item, item_len);
+          item = next + 1;
+          continue;
+        }
+
+      if (item_len && item[item_len - 1] == '/')
+        {
+          is_dir = TRUE;
+          item_len--;
+        }
+
+      relpath = apr_pstrmemdup(result_pool, item, item_len);
+      if (!svn_relpath_is_canonical(relpath))
+        relpath = svn_relpath_canonicalize(relpath, result_pool);
+
+      if (is_dir)
+        svn_hash_sets(dirs, relpath, "");
+      else if (*relpath)
+        svn_hash_sets(files, relpath, "");
+
+      item = next + 1;
+    }
+
+  if (item == data)
+    return svn_error_create(SVN_ERR_EXTERNAL_PROGRAM, NULL,
+                            _("File system monitor returned no token"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Run the monitor program CMD for the working copy at WCROOT_ABSPATH,
+   passing it TOKEN, and set *OUTPUT to what it prints.  Allocate *OUTPUT
+   in POOL. */
+static svn_error_t *
+run_monitor(svn_stringbuf_t **output,
+            const char *cmd,
+            const char *wcroot_abspath,
+            const char *token,
+            apr_pool_t *pool)
+{
+  const char *args[4];
+  apr_proc_t cmd_proc = { 0 };
+  svn_error_t *err;
+
+  args[0] = cmd;
+  args[1] = svn_dirent_local_style(wcroot_abspath, pool);
+  args[2] = token;
+  args[3] = NULL;
+
+  SVN_ERR(svn_io_start_cmd3(&cmd_proc, args[1], cmd, args, NULL, TRUE,
+                            FALSE, NULL, TRUE, NULL, FALSE, NULL, pool));
+
+  /* Read everything before waiting, so a large answer can't block the
+     monitor on a full pipe. */
+  err = svn_stringbuf_from_aprfile(output, cmd_proc.out, pool);
+  err = svn_error_compose_create(
+          err, svn_io_wait_for_cmd(&cmd_proc, cmd, NULL, NULL, pool));
+  err = svn_error_compose_create(
+          err, svn_io_file_close(cmd_proc.out, pool));
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svn_wc__fsmonitor_open(svn_wc__fsmonitor_t **monitor,
+                       svn_wc__db_t *db,
+                       const char *local_abspath,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  const char *cmd = svn_wc__db_get_fsmonitor(db);
+  svn_wc__fsmonitor_t *m;
+  svn_stringbuf_t *state;
+  svn_stringbuf_t *output;
+  const char *old_token = "";
+  svn_error_t *err;
+
+  *monitor = NULL;
+  if (!cmd)
+    return SVN_NO_ERROR;
+
+  m = apr_pcalloc(result_pool, sizeof(*m));
+  m->pool = result_pool;
+  m->files = apr_hash_make(result_pool);
+  m->dirs = apr_hash_make(result_pool);
+  m->mismatched = apr_hash_make(result_pool);
+  SVN_ERR(svn_wc__db_get_wcroot(&m->wcroot_abspath, db, local_abspath,
+                                result_pool, scratch_pool));
+
+  /* Without usable state from a previous walk, everything is suspect. */
+  err = svn_stringbuf_from_file2(&state,
+                                 svn_wc__adm_child(m->wcroot_abspath,
+                                                   SVN_WC__ADM_FSMONITOR,
+                                                   scratch_pool),
+                                 scratch_pool);
+  if (!err)
+    err = parse_paths(&old_token, m->files, m->dirs, state->data, state->len,
+                      result_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      old_token = "";
+      apr_hash_clear(m->files);
+      svn_hash_sets(m->dirs, "", "");
+    }
+
+  /* A monitor that doesn't answer is no reason to fail the walk; it
+     just can't make it faster. */
+  err = run_monitor(&output, cmd, m->wcroot_abspath, old_token,
+                    scratch_pool);
+  if (!err)
+    err = parse_paths(&m->token, m->files, m->dirs, output->data,
+                      output->len, result_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  *monitor = m;
+  return SVN_NO_ERROR;
+}
+
+svn_boolean_t
+svn_wc__fsmonitor_changed(const svn_wc__fsmonitor_t *monitor,
+                          const char *local_abspath)
+{
+  const char *relpath = svn_dirent_skip_ancestor(monitor->wcroot_abspath,
+                                                 local_abspath);
+  apr_ssize_t i;
+
+  if (!relpath || !*relpath)
+    return TRUE;
+
+  if (apr_hash_get(monitor->files, relpath, APR_HASH_KEY_STRING))
+    return TRUE;
+
+  /* Look up all parent directories without copying RELPATH. */
+  if (apr_hash_get(monitor->dirs, "", 0))
+    return TRUE;
+  for (i = 0; relpath[i]; i++)
+    if (relpath[i] == '/' && apr_hash_get(monitor->dirs, relpath, i))
+      return TRUE;
+
+  return FALSE;
+}
+
+void
+svn_wc__fsmonitor_checked(svn_wc__fsmonitor_t *monitor,
+                          const char *local_abspath,
+                          svn_boolean_t match)
+{
+  const char *relpath = svn_dirent_skip_ancestor(monitor->wcroot_abspath,
+                                                 local_abspath);
+
+  if (!relpath || !*relpath)
+    return;
+
+  if (match)
+    {
+      svn_hash_sets(monitor->files, relpath, NULL);
+      svn_hash_sets(monitor->mismatched, relpath, NULL);
+    }
+  else
+    {
+      relpath = apr_pstrdup(monitor->pool, relpath);
+      svn_hash_sets(monitor->files, relpath, "");
+      svn_hash_sets(monitor->mismatched, relpath, "");
+    }
+}
+
+/* Append the keys of PATHS to BUF, each with SUFFIX and a NUL. */
+static void
+append_paths(svn_stringbuf_t *buf,
+             apr_hash_t *paths,
+             const char *suffix,
+             apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, paths); hi; hi = apr_hash_next(hi))
+    {
+      const char *relpath = apr_hash_this_key(hi);
+
+      svn_stringbuf_appendcstr(buf, relpath);
+      svn_stringbuf_appendcstr(buf, suffix);
+      svn_stringbuf_appendbyte(buf, '\0');
+    }
+}
+
+svn_error_t *
+svn_wc__fsmonitor_close(svn_wc__fsmonitor_t *monitor,
+                        svn_boolean_t complete,
+                        apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *buf = svn_stringbuf_create(monitor->token, scratch_pool);
+
+  svn_stringbuf_appendbyte(buf, '\0');
+
+  /* After a complete walk, what didn't match is all there is to check;
+     otherwise the parts not walked still need what we knew before. */
+  if (complete)
+    append_paths(buf, monitor->mismatched, "", scratch_pool);
+  else
+    {
+      append_paths(buf, monitor->files, "", scratch_pool);
+      if (apr_hash_get(monitor->dirs, "", 0))
+        {
+          svn_stringbuf_appendcstr(buf, "/");
+          svn_stringbuf_appendbyte(buf, '\0');
+        }
+      svn_hash_sets(monitor->dirs, "", NULL);
+      append_paths(buf, monitor->dirs, "/", scratch_pool);
+    }
+
+  return svn_error_trace(
+           svn_io_write_atomic2(svn_wc__adm_child(monitor->wcroot_abspath,
+                                                  SVN_WC__ADM_FSMONITOR,
+                                                  scratch_pool),
+                                buf->data, buf->len,
+                                NULL /* copy_perms_path */,
+                                FALSE, scratch_pool));
+}
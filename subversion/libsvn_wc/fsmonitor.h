@@ -0,0 +1,87 @@
+/*
+ * fsmonitor.h :  asking a file system monitor which files changed
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#ifndef SVN_LIBSVN_WC_FSMONITOR_H
+#define SVN_LIBSVN_WC_FSMONITOR_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+
+#include "wc_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+/* The answer of the file system monitor configured with
+   SVN_CONFIG_OPTION_FSMONITOR for one working copy, combined with what
+   the previous walks of that working copy found.
+
+   A file that matched its recorded size and timestamp the last time it
+   was looked at, and hasn't been reported as changed since, is known to
+   still match them.  Everything else has to be checked on disk. */
+typedef struct svn_wc__fsmonitor_t svn_wc__fsmonitor_t;
+
+/* Ask the file system monitor configured for DB about the working copy
+   that contains the versioned LOCAL_ABSPATH and set *MONITOR to its
+   answer.  Set *MONITOR to NULL if no monitor is configured, or if it
+   failed to answer.  Allocate *MONITOR in RESULT_POOL. */
+svn_error_t *
+svn_wc__fsmonitor_open(svn_wc__fsmonitor_t **monitor,
+                       svn_wc__db_t *db,
+                       const char *local_abspath,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool);
+
+/* Return FALSE if the file LOCAL_ABSPATH is known to match the size and
+   timestamp recorded for it, according to MONITOR; TRUE otherwise. */
+svn_boolean_t
+svn_wc__fsmonitor_changed(const svn_wc__fsmonitor_t *monitor,
+                          const char *local_abspath);
+
+/* Tell MONITOR whether the file LOCAL_ABSPATH was found to MATCH its
+   recorded size and timestamp on disk. */
+void
+svn_wc__fsmonitor_checked(svn_wc__fsmonitor_t *monitor,
+                          const char *local_abspath,
+                          svn_boolean_t match);
+
+/* Store what MONITOR knows in the administrative area, so that the next
+   walk only has to check what changed from now on.  COMPLETE says that
+   every versioned file of the working copy was passed to
+   svn_wc__fsmonitor_changed() since MONITOR was opened. */
+svn_error_t *
+svn_wc__fsmonitor_close(svn_wc__fsmonitor_t *monitor,
+                        svn_boolean_t complete,
+                        apr_pool_t *scratch_pool);
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_WC_FSMONITOR_H */
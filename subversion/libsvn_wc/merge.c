@@ -21,9 +21,12 @@
  * ====================================================================
  */
 
+#include <string.h>
+
 #include "svn_wc.h"
 #include "svn_diff.h"
 #include "svn_dirent_uri.h"
+#include "svn_hash.h"
 #include "svn_path.h"
 #include "svn_pools.h"
 #include "svn_props.h"
@@ -35,6 +38,7 @@
 #include "workqueue.h"
 
 #include "private/svn_skel.h"
+#include "private/svn_thread_pool.h"
 
 #include "svn_private_config.h"
 
@@ -792,68 +796,30 @@ merge_file_trivial(svn_skel_t **work_items,
 }
 
 
-/* Handle a non-trivial merge of 'text' files.  (Assume that a trivial
- * merge was not possible.)
- *
- * Set *WORK_ITEMS, *CONFLICT_SKEL and *MERGE_OUTCOME according to the
- * result -- to install the merged file, or to indicate a conflict.
- *
- * On successful merge, leave the result in a temporary file and set
- * *WORK_ITEMS to hold work items that will translate and install that
- * file into its proper form and place (unless DRY_RUN) and delete the
- * temporary file (in any case).  Set *MERGE_OUTCOME to 'merged' or
- * 'unchanged'.
+/* Run the external or internal merge, as requested by MT, of the files
+ * LEFT_ABSPATH, RIGHT_ABSPATH and DETRANSLATED_TARGET_ABSPATH and write
+ * the result to RESULT_F.  Set *CONTAINS_CONFLICTS to whether the result
+ * contains conflicts.
  *
- * If a conflict occurs, set *MERGE_OUTCOME to 'conflicted', and (unless
- * DRY_RUN) set *WORK_ITEMS and *CONFLICT_SKEL to record the conflict
- * and copies of the pre-merge files.  See preserve_pre_merge_files()
- * for details.
- *
- * On entry, all of the output pointers must be non-null and *CONFLICT_SKEL
- * must either point to an existing conflict skel or be NULL.
+ * This does not access the working copy database.  Use SCRATCH_POOL for
+ * temporary allocations.
  */
-static svn_error_t*
-merge_text_file(svn_skel_t **work_items,
-                svn_skel_t **conflict_skel,
-                enum svn_wc_merge_outcome_t *merge_outcome,
-                const merge_target_t *mt,
-                const char *left_abspath,
-                const char *right_abspath,
-                const char *left_label,
-                const char *right_label,
-                const char *target_label,
-                svn_boolean_t dry_run,
-                const char *detranslated_target_abspath,
-                svn_cancel_func_t cancel_func,
-                void *cancel_baton,
-                apr_pool_t *result_pool,
-                apr_pool_t *scratch_pool)
+static svn_error_t *
+run_text_merge(svn_boolean_t *contains_conflicts,
+               apr_file_t *result_f,
+               const merge_target_t *mt,
+               const char *left_abspath,
+               const char *right_abspath,
+               const char *left_label,
+               const char *right_label,
+               const char *target_label,
+               const char *detranslated_target_abspath,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
 {
-  apr_pool_t *pool = scratch_pool;  /* ### temporary rename  */
-  svn_boolean_t contains_conflicts;
-  apr_file_t *result_f;
-  const char *result_target;
-  const char *base_name;
-  const char *temp_dir;
-  svn_skel_t *work_item;
-
-  *work_items = NULL;
-
-  base_name = svn_dirent_basename(mt->local_abspath, scratch_pool);
-
-  /* Open a second temporary file for writing; this is where diff3
-     will write the merged results.  We want to use a tempfile
-     with a name that reflects the original, in case this
-     ultimately winds up in a conflict resolution editor.  */
-  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir, mt->db, mt->wri_abspath,
-                                         pool, pool));
-  SVN_ERR(svn_io_open_uniquely_named(&result_f, &result_target,
-                                     temp_dir, base_name, ".tmp",
-                                     svn_io_file_del_none, pool, pool));
-
-  /* Run the external or internal merge, as requested. */
   if (mt->diff3_cmd)
-      SVN_ERR(do_text_merge_external(&contains_conflicts,
+      SVN_ERR(do_text_merge_external(contains_conflicts,
                                      result_f,
                                      mt->diff3_cmd,
                                      mt->merge_options,
@@ -863,9 +829,9 @@ merge_text_file(svn_skel_t **work_items,
                                      target_label,
                                      left_label,
                                      right_label,
-                                     pool));
+                                     scratch_pool));
   else /* Use internal merge. */
-    SVN_ERR(do_text_merge(&contains_conflicts,
+    SVN_ERR(do_text_merge(contains_conflicts,
                           result_f,
                           mt->merge_options,
                           detranslated_target_abspath,
@@ -875,9 +841,38 @@ merge_text_file(svn_skel_t **work_items,
                           left_label,
                           right_label,
                           cancel_func, cancel_baton,
-                          pool));
+                          scratch_pool));
 
-  SVN_ERR(svn_io_file_close(result_f, pool));
+  return SVN_NO_ERROR;
+}
+
+/* Second half of merge_text_file(): given the merge result RESULT_TARGET
+ * and whether it CONTAINS_CONFLICTS, set *WORK_ITEMS, *CONFLICT_SKEL and
+ * *MERGE_OUTCOME as described for merge_text_file().
+ */
+static svn_error_t *
+finish_text_merge(svn_skel_t **work_items,
+                  svn_skel_t **conflict_skel,
+                  enum svn_wc_merge_outcome_t *merge_outcome,
+                  const merge_target_t *mt,
+                  const char *left_abspath,
+                  const char *right_abspath,
+                  const char *left_label,
+                  const char *right_label,
+                  const char *target_label,
+                  svn_boolean_t dry_run,
+                  const char *detranslated_target_abspath,
+                  svn_boolean_t contains_conflicts,
+                  const char *result_target,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  apr_pool_t *pool = scratch_pool;  /* ### temporary rename  */
+  svn_skel_t *work_item;
+
+  *work_items = NULL;
 
   /* Determine the MERGE_OUTCOME, and record any conflict. */
   if (contains_conflicts)
@@ -956,6 +951,81 @@ merge_text_file(svn_skel_t **work_items,
   return SVN_NO_ERROR;
 }
 
+/* Handle a non-trivial merge of 'text' files.  (Assume that a trivial
+ * merge was not possible.)
+ *
+ * Set *WORK_ITEMS, *CONFLICT_SKEL and *MERGE_OUTCOME according to the
+ * result -- to install the merged file, or to indicate a conflict.
+ *
+ * On successful merge, leave the result in a temporary file and set
+ * *WORK_ITEMS to hold work items that will translate and install that
+ * file into its proper form and place (unless DRY_RUN) and delete the
+ * temporary file (in any case).  Set *MERGE_OUTCOME to 'merged' or
+ * 'unchanged'.
+ *
+ * If a conflict occurs, set *MERGE_OUTCOME to 'conflicted', and (unless
+ * DRY_RUN) set *WORK_ITEMS and *CONFLICT_SKEL to record the conflict
+ * and copies of the pre-merge files.  See preserve_pre_merge_files()
+ * for details.
+ *
+ * On entry, all of the output pointers must be non-null and *CONFLICT_SKEL
+ * must either point to an existing conflict skel or be NULL.
+ */
+static svn_error_t*
+merge_text_file(svn_skel_t **work_items,
+                svn_skel_t **conflict_skel,
+                enum svn_wc_merge_outcome_t *merge_outcome,
+                const merge_target_t *mt,
+                const char *left_abspath,
+                const char *right_abspath,
+                const char *left_label,
+                const char *right_label,
+                const char *target_label,
+                svn_boolean_t dry_run,
+                const char *detranslated_target_abspath,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_boolean_t contains_conflicts;
+  apr_file_t *result_f;
+  const char *result_target;
+  const char *base_name;
+  const char *temp_dir;
+
+  base_name = svn_dirent_basename(mt->local_abspath, scratch_pool);
+
+  /* Open a second temporary file for writing; this is where diff3
+     will write the merged results.  We want to use a tempfile
+     with a name that reflects the original, in case this
+     ultimately winds up in a conflict resolution editor.  */
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir, mt->db, mt->wri_abspath,
+                                         scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_open_uniquely_named(&result_f, &result_target,
+                                     temp_dir, base_name, ".tmp",
+                                     svn_io_file_del_none,
+                                     scratch_pool, scratch_pool));
+
+  SVN_ERR(run_text_merge(&contains_conflicts, result_f, mt,
+                         left_abspath, right_abspath,
+                         left_label, right_label, target_label,
+                         detranslated_target_abspath,
+                         cancel_func, cancel_baton, scratch_pool));
+
+  SVN_ERR(svn_io_file_close(result_f, scratch_pool));
+
+  return svn_error_trace(finish_text_merge(work_items, conflict_skel,
+                                           merge_outcome, mt,
+                                           left_abspath, right_abspath,
+                                           left_label, right_label,
+                                           target_label, dry_run,
+                                           detranslated_target_abspath,
+                                           contains_conflicts, result_target,
+                                           cancel_func, cancel_baton,
+                                           result_pool, scratch_pool));
+}
+
 /* Handle a non-trivial merge of 'binary' files: don't actually merge, just
  * flag a conflict.  (Assume that a trivial merge was not possible.)
  *
@@ -1074,78 +1144,97 @@ merge_binary_file(svn_skel_t **work_items,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_wc__internal_merge(svn_skel_t **work_items,
-                       svn_skel_t **conflict_skel,
-                       enum svn_wc_merge_outcome_t *merge_outcome,
-                       svn_wc__db_t *db,
-                       const char *left_abspath,
-                       const char *right_abspath,
-                       const char *target_abspath,
-                       const char *wri_abspath,
-                       const char *left_label,
-                       const char *right_label,
-                       const char *target_label,
-                       apr_hash_t *old_actual_props,
-                       svn_boolean_t dry_run,
-                       const char *diff3_cmd,
-                       const apr_array_header_t *merge_options,
-                       const apr_array_header_t *prop_diff,
-                       svn_cancel_func_t cancel_func,
-                       void *cancel_baton,
-                       apr_pool_t *result_pool,
-                       apr_pool_t *scratch_pool)
+/* Fill in *MT for a merge into TARGET_ABSPATH, see svn_wc__internal_merge()
+ * for the meaning of the other arguments. */
+static void
+init_merge_target(merge_target_t *mt,
+                  svn_wc__db_t *db,
+                  const char *target_abspath,
+                  const char *wri_abspath,
+                  apr_hash_t *old_actual_props,
+                  const char *diff3_cmd,
+                  const apr_array_header_t *merge_options,
+                  const apr_array_header_t *prop_diff)
+{
+  mt->db = db;
+  mt->local_abspath = target_abspath;
+  mt->wri_abspath = wri_abspath;
+  mt->old_actual_props = old_actual_props;
+  mt->prop_diff = prop_diff;
+  mt->diff3_cmd = diff3_cmd;
+  mt->merge_options = merge_options;
+}
+
+/* The first part of svn_wc__internal_merge(), merging into the target
+ * described by MT.  Handle trivial merges and merges of 'binary' files.
+ *
+ * If a non-trivial merge of 'text' files remains to be done, set
+ * *TEXT_MERGE to TRUE and set *LEFT_ABSPATH and *DETRANSLATED_TARGET_ABSPATH
+ * to the files which merge_text_file() shall use.  Temporary files which
+ * these may refer to are deleted when SCRATCH_POOL gets cleaned up.
+ * Otherwise, set *TEXT_MERGE to FALSE.
+ *
+ * The other arguments are as for svn_wc__internal_merge().
+ */
+static svn_error_t *
+begin_internal_merge(svn_boolean_t *text_merge,
+                     const char **left_abspath,
+                     const char **detranslated_target_abspath,
+                     svn_skel_t **work_items,
+                     svn_skel_t **conflict_skel,
+                     enum svn_wc_merge_outcome_t *merge_outcome,
+                     const merge_target_t *mt,
+                     const char *right_abspath,
+                     const char *left_label,
+                     const char *right_label,
+                     const char *target_label,
+                     svn_boolean_t dry_run,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
 {
-  const char *detranslated_target_abspath;
   svn_boolean_t is_binary = FALSE;
   const svn_prop_t *mimeprop;
-  svn_skel_t *work_item;
-  merge_target_t mt;
 
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(left_abspath));
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(*left_abspath));
   SVN_ERR_ASSERT(svn_dirent_is_absolute(right_abspath));
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(target_abspath));
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(mt->local_abspath));
 
   *work_items = NULL;
-
-  /* Fill the merge target baton */
-  mt.db = db;
-  mt.local_abspath = target_abspath;
-  mt.wri_abspath = wri_abspath;
-  mt.old_actual_props = old_actual_props;
-  mt.prop_diff = prop_diff;
-  mt.diff3_cmd = diff3_cmd;
-  mt.merge_options = merge_options;
+  *text_merge = FALSE;
 
   /* Decide if the merge target is a text or binary file. */
-  if ((mimeprop = get_prop(prop_diff, SVN_PROP_MIME_TYPE))
+  if ((mimeprop = get_prop(mt->prop_diff, SVN_PROP_MIME_TYPE))
       && mimeprop->value)
     is_binary = svn_mime_type_is_binary(mimeprop->value->data);
   else
     {
-      const char *value = svn_prop_get_value(mt.old_actual_props,
+      const char *value = svn_prop_get_value(mt->old_actual_props,
                                              SVN_PROP_MIME_TYPE);
 
       is_binary = value && svn_mime_type_is_binary(value);
     }
 
-  SVN_ERR(detranslate_wc_file(&detranslated_target_abspath, &mt,
-                              (! is_binary) && diff3_cmd != NULL,
-                              target_abspath,
+  SVN_ERR(detranslate_wc_file(detranslated_target_abspath, mt,
+                              (! is_binary) && mt->diff3_cmd != NULL,
+                              mt->local_abspath,
                               cancel_func, cancel_baton,
                               scratch_pool, scratch_pool));
 
   /* We cannot depend on the left file to contain the same eols as the
      right file. If the merge target has mods, this will mark the entire
      file as conflicted, so we need to compensate. */
-  SVN_ERR(maybe_update_target_eols(&left_abspath, prop_diff, left_abspath,
+  SVN_ERR(maybe_update_target_eols(left_abspath, mt->prop_diff,
+                                   *left_abspath,
                                    cancel_func, cancel_baton,
                                    scratch_pool, scratch_pool));
 
   SVN_ERR(merge_file_trivial(work_items, merge_outcome,
-                             left_abspath, right_abspath,
-                             target_abspath, detranslated_target_abspath,
-                             dry_run, db, cancel_func, cancel_baton,
+                             *left_abspath, right_abspath,
+                             mt->local_abspath,
+                             *detranslated_target_abspath,
+                             dry_run, mt->db, cancel_func, cancel_baton,
                              result_pool, scratch_pool));
   if (*merge_outcome == svn_wc_merge_no_merge)
     {
@@ -1158,41 +1247,44 @@ svn_wc__internal_merge(svn_skel_t **work_items,
           SVN_ERR(merge_binary_file(work_items,
                                     conflict_skel,
                                     merge_outcome,
-                                    &mt,
-                                    left_abspath,
+                                    mt,
+                                    *left_abspath,
                                     right_abspath,
                                     left_label,
                                     right_label,
                                     target_label,
                                     dry_run,
-                                    detranslated_target_abspath,
+                                    *detranslated_target_abspath,
                                     result_pool, scratch_pool));
         }
       else
         {
-          SVN_ERR(merge_text_file(work_items,
-                                  conflict_skel,
-                                  merge_outcome,
-                                  &mt,
-                                  left_abspath,
-                                  right_abspath,
-                                  left_label,
-                                  right_label,
-                                  target_label,
-                                  dry_run,
-                                  detranslated_target_abspath,
-                                  cancel_func, cancel_baton,
-                                  result_pool, scratch_pool));
+          *text_merge = TRUE;
         }
     }
 
+  return SVN_NO_ERROR;
+}
+
+/* The last part of svn_wc__internal_merge(), merging into the target
+ * described by MT.  Append the final items to *WORK_ITEMS.
+ */
+static svn_error_t *
+end_internal_merge(svn_skel_t **work_items,
+                   const merge_target_t *mt,
+                   svn_boolean_t dry_run,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  svn_skel_t *work_item;
+
   /* Merging is complete.  Regardless of text or binariness, we might
      need to tweak the executable bit on the new working file, and
      possibly make it read-only. */
   if (! dry_run)
     {
-      SVN_ERR(svn_wc__wq_build_sync_file_flags(&work_item, db,
-                                               target_abspath,
+      SVN_ERR(svn_wc__wq_build_sync_file_flags(&work_item, mt->db,
+                                               mt->local_abspath,
                                                result_pool, scratch_pool));
       *work_items = svn_wc__wq_merge(*work_items, work_item, result_pool);
     }
@@ -1200,45 +1292,172 @@ svn_wc__internal_merge(svn_skel_t **work_items,
   return SVN_NO_ERROR;
 }
 
-
 svn_error_t *
-svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
-              enum svn_wc_notify_state_t *merge_props_outcome,
-              svn_wc_context_t *wc_ctx,
-              const char *left_abspath,
-              const char *right_abspath,
-              const char *target_abspath,
-              const char *left_label,
-              const char *right_label,
-              const char *target_label,
-              const svn_wc_conflict_version_t *left_version,
-              const svn_wc_conflict_version_t *right_version,
-              svn_boolean_t dry_run,
-              const char *diff3_cmd,
-              const apr_array_header_t *merge_options,
-              apr_hash_t *original_props,
-              const apr_array_header_t *prop_diff,
-              svn_wc_conflict_resolver_func2_t conflict_func,
-              void *conflict_baton,
-              svn_cancel_func_t cancel_func,
-              void *cancel_baton,
-              apr_pool_t *scratch_pool)
+svn_wc__internal_merge(svn_skel_t **work_items,
+                       svn_skel_t **conflict_skel,
+                       enum svn_wc_merge_outcome_t *merge_outcome,
+                       svn_wc__db_t *db,
+                       const char *left_abspath,
+                       const char *right_abspath,
+                       const char *target_abspath,
+                       const char *wri_abspath,
+                       const char *left_label,
+                       const char *right_label,
+                       const char *target_label,
+                       apr_hash_t *old_actual_props,
+                       svn_boolean_t dry_run,
+                       const char *diff3_cmd,
+                       const apr_array_header_t *merge_options,
+                       const apr_array_header_t *prop_diff,
+                       svn_cancel_func_t cancel_func,
+                       void *cancel_baton,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
 {
-  const char *dir_abspath = svn_dirent_dirname(target_abspath, scratch_pool);
+  const char *detranslated_target_abspath;
+  svn_boolean_t text_merge;
+  merge_target_t mt;
+
+  /* Fill the merge target baton */
+  init_merge_target(&mt, db, target_abspath, wri_abspath, old_actual_props,
+                    diff3_cmd, merge_options, prop_diff);
+
+  SVN_ERR(begin_internal_merge(&text_merge, &left_abspath,
+                               &detranslated_target_abspath,
+                               work_items, conflict_skel, merge_outcome,
+                               &mt, right_abspath,
+                               left_label, right_label, target_label,
+                               dry_run, cancel_func, cancel_baton,
+                               result_pool, scratch_pool));
+
+  if (text_merge)
+    SVN_ERR(merge_text_file(work_items,
+                            conflict_skel,
+                            merge_outcome,
+                            &mt,
+                            left_abspath,
+                            right_abspath,
+                            left_label,
+                            right_label,
+                            target_label,
+                            dry_run,
+                            detranslated_target_abspath,
+                            cancel_func, cancel_baton,
+                            result_pool, scratch_pool));
+
+  return svn_error_trace(end_internal_merge(work_items, &mt, dry_run,
+                                            result_pool, scratch_pool));
+}
+
+
+/* State of a merge as performed by svn_wc_merge5().  The merge is split
+ * into the preparation by begin_merge(), the text merge itself, which does
+ * not access the working copy database, and end_merge(), which records the
+ * result in the working copy.  That allows svn_wc__merge_queue_t to run
+ * the text merges of several files concurrently.
+ */
+typedef struct merge_job_t
+{
+  /* Parameters as passed to svn_wc_merge5(). */
+  const char *left_abspath;
+  const char *right_abspath;
+  const char *left_label;
+  const char *right_label;
+  const char *target_label;
+  const svn_wc_conflict_version_t *left_version;
+  const svn_wc_conflict_version_t *right_version;
+  svn_boolean_t dry_run;
+  const apr_array_header_t *merge_options;
+
+  /* The merge target. */
+  merge_target_t mt;
+
+  /* Node kind of the target. */
+  svn_node_kind_t kind;
+
+  /* If set, there is nothing to merge and CONTENT_OUTCOME and
+     PROPS_OUTCOME are final. */
+  svn_boolean_t skip;
+
+  /* Whether properties get merged at all. */
+  svn_boolean_t merge_props;
+
+  /* Intermediate results to be installed by end_merge(). */
+  apr_hash_t *new_actual_props;
+  svn_skel_t *conflict_skel;
+  svn_skel_t *work_items;
+
+  /* Whether a non-trivial merge of 'text' files is required.  If set,
+     the merge shall read DETRANSLATED_TARGET_ABSPATH, which may differ
+     from the target, and write to the existing file RESULT_TARGET. */
+  svn_boolean_t text_merge;
+  const char *detranslated_target_abspath;
+  const char *result_target;
+
+  /* Outcome of the text merge.  Only valid if TEXT_MERGE is set and the
+     text merge has been run. */
+  svn_boolean_t contains_conflicts;
+
+  /* Outcomes as returned by svn_wc_merge5(). */
+  enum svn_wc_merge_outcome_t content_outcome;
+  svn_wc_notify_state_t props_outcome;
+} merge_job_t;
+
+/* Do all of svn_wc_merge5() for JOB that needs to happen before the text
+ * merge.  Use DB to access the working copy and set MERGE_PROPS if there
+ * is a properties merge to be performed.  All other arguments are as for
+ * svn_wc_merge5().
+ *
+ * Allocate all of JOB's data in POOL.  Temporary files referred to by JOB
+ * will be deleted when POOL gets cleaned up.
+ */
+static svn_error_t *
+begin_merge(merge_job_t *job,
+            svn_wc__db_t *db,
+            const char *left_abspath,
+            const char *right_abspath,
+            const char *target_abspath,
+            const char *left_label,
+            const char *right_label,
+            const char *target_label,
+            const svn_wc_conflict_version_t *left_version,
+            const svn_wc_conflict_version_t *right_version,
+            svn_boolean_t dry_run,
+            const char *diff3_cmd,
+            const apr_array_header_t *merge_options,
+            apr_hash_t *original_props,
+            const apr_array_header_t *prop_diff,
+            svn_boolean_t merge_props,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *pool)
+{
+  const char *dir_abspath = svn_dirent_dirname(target_abspath, pool);
   svn_skel_t *work_items;
-  svn_skel_t *conflict_skel = NULL;
   apr_hash_t *pristine_props = NULL;
   apr_hash_t *old_actual_props;
-  apr_hash_t *new_actual_props = NULL;
-  svn_node_kind_t kind;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(left_abspath));
   SVN_ERR_ASSERT(svn_dirent_is_absolute(right_abspath));
   SVN_ERR_ASSERT(svn_dirent_is_absolute(target_abspath));
 
+  memset(job, 0, sizeof(*job));
+  job->left_abspath = left_abspath;
+  job->right_abspath = right_abspath;
+  job->left_label = left_label;
+  job->right_label = right_label;
+  job->target_label = target_label;
+  job->left_version = left_version;
+  job->right_version = right_version;
+  job->dry_run = dry_run;
+  job->merge_options = merge_options;
+  job->merge_props = merge_props;
+  job->content_outcome = svn_wc_merge_no_merge;
+  job->props_outcome = svn_wc_notify_state_unchanged;
+
   /* Before we do any work, make sure we hold a write lock.  */
   if (!dry_run)
-    SVN_ERR(svn_wc__write_check(wc_ctx->db, dir_abspath, scratch_pool));
+    SVN_ERR(svn_wc__write_check(db, dir_abspath, pool));
 
   /* Sanity check:  the merge target must be a file under revision control */
   {
@@ -1247,20 +1466,19 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
     svn_boolean_t props_mod;
     svn_boolean_t conflicted;
 
-    SVN_ERR(svn_wc__db_read_info(&status, &kind, NULL, NULL, NULL, NULL, NULL,
+    SVN_ERR(svn_wc__db_read_info(&status, &job->kind, NULL, NULL, NULL, NULL,
+                                 NULL, NULL, NULL, NULL, NULL, NULL, NULL,
                                  NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                                 NULL, NULL, NULL, NULL, NULL, NULL,
                                  &conflicted, NULL, &had_props, &props_mod,
                                  NULL, NULL, NULL,
-                                 wc_ctx->db, target_abspath,
-                                 scratch_pool, scratch_pool));
+                                 db, target_abspath,
+                                 pool, pool));
 
-    if (kind != svn_node_file || (status != svn_wc__db_status_normal
-                                  && status != svn_wc__db_status_added))
+    if (job->kind != svn_node_file
+        || (status != svn_wc__db_status_normal
+            && status != svn_wc__db_status_added))
       {
-        *merge_content_outcome = svn_wc_merge_no_merge;
-        if (merge_props_outcome)
-          *merge_props_outcome = svn_wc_notify_state_unchanged;
+        job->skip = TRUE;
         return SVN_NO_ERROR;
       }
 
@@ -1273,8 +1491,8 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
         SVN_ERR(svn_wc__internal_conflicted_p(&text_conflicted,
                                               &prop_conflicted,
                                               &tree_conflicted,
-                                              wc_ctx->db, target_abspath,
-                                              scratch_pool));
+                                              db, target_abspath,
+                                              pool));
 
         /* We can't install two prop conflicts on a single node, so
            avoid even checking that we have to merge it */
@@ -1284,35 +1502,35 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
                             SVN_ERR_WC_PATH_UNEXPECTED_STATUS, NULL,
                             _("Can't merge into conflicted node '%s'"),
                             svn_dirent_local_style(target_abspath,
-                                                   scratch_pool));
+                                                   pool));
           }
         /* else: Conflict was resolved by removing markers */
       }
 
-    if (merge_props_outcome && had_props)
+    if (merge_props && had_props)
       {
         SVN_ERR(svn_wc__db_read_pristine_props(&pristine_props,
-                                               wc_ctx->db, target_abspath,
-                                               scratch_pool, scratch_pool));
+                                               db, target_abspath,
+                                               pool, pool));
       }
-    else if (merge_props_outcome)
-      pristine_props = apr_hash_make(scratch_pool);
+    else if (merge_props)
+      pristine_props = apr_hash_make(pool);
 
     if (props_mod)
       {
         SVN_ERR(svn_wc__db_read_props(&old_actual_props,
-                                      wc_ctx->db, target_abspath,
-                                      scratch_pool, scratch_pool));
+                                      db, target_abspath,
+                                      pool, pool));
       }
     else if (pristine_props)
       old_actual_props = pristine_props;
     else
-      old_actual_props = apr_hash_make(scratch_pool);
+      old_actual_props = apr_hash_make(pool);
   }
 
   /* Merge the properties, if requested.  We merge the properties first
    * because the properties can affect the text (EOL style, keywords). */
-  if (merge_props_outcome)
+  if (merge_props)
     {
       int i;
 
@@ -1329,84 +1547,173 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
                                        "into '%s'."),
                                      change->name,
                                      svn_dirent_local_style(target_abspath,
-                                                            scratch_pool));
+                                                            pool));
         }
 
-      SVN_ERR(svn_wc__merge_props(&conflict_skel,
-                                  merge_props_outcome,
-                                  &new_actual_props,
-                                  wc_ctx->db, target_abspath,
-                                  original_props, pristine_props, old_actual_props,
+      SVN_ERR(svn_wc__merge_props(&job->conflict_skel,
+                                  &job->props_outcome,
+                                  &job->new_actual_props,
+                                  db, target_abspath,
+                                  original_props, pristine_props,
+                                  old_actual_props,
                                   prop_diff,
-                                  scratch_pool, scratch_pool));
+                                  pool, pool));
+    }
+
+  /* Prepare merging the text. */
+  init_merge_target(&job->mt, db, target_abspath, target_abspath,
+                    old_actual_props, diff3_cmd, merge_options, prop_diff);
+
+  SVN_ERR(begin_internal_merge(&job->text_merge, &job->left_abspath,
+                               &job->detranslated_target_abspath,
+                               &work_items, &job->conflict_skel,
+                               &job->content_outcome, &job->mt,
+                               right_abspath,
+                               left_label, right_label, target_label,
+                               dry_run, cancel_func, cancel_baton,
+                               pool, pool));
+  job->work_items = work_items;
+
+  /* Create the file that will receive the text merge result. */
+  if (job->text_merge)
+    {
+      const char *temp_dir;
+
+      SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir, db, target_abspath,
+                                             pool, pool));
+      SVN_ERR(svn_io_open_uniquely_named(NULL, &job->result_target,
+                                         temp_dir,
+                                         svn_dirent_basename(target_abspath,
+                                                             NULL),
+                                         ".tmp", svn_io_file_del_none,
+                                         pool, pool));
     }
 
-  /* Merge the text. */
-  SVN_ERR(svn_wc__internal_merge(&work_items,
-                                 &conflict_skel,
-                                 merge_content_outcome,
-                                 wc_ctx->db,
-                                 left_abspath,
-                                 right_abspath,
-                                 target_abspath,
-                                 target_abspath,
-                                 left_label, right_label, target_label,
-                                 old_actual_props,
-                                 dry_run,
-                                 diff3_cmd,
-                                 merge_options,
-                                 prop_diff,
-                                 cancel_func, cancel_baton,
-                                 scratch_pool, scratch_pool));
+  return SVN_NO_ERROR;
+}
+
+/* Perform the text merge required by JOB, i.e. write the result to
+ * JOB->RESULT_TARGET and set JOB->CONTAINS_CONFLICTS.  This does not
+ * access the working copy database nor does it allocate from any of
+ * JOB's pools.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+perform_text_merge(merge_job_t *job,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *scratch_pool)
+{
+  apr_file_t *result_f;
+
+  SVN_ERR(svn_io_file_open(&result_f, job->result_target,
+                           APR_WRITE | APR_TRUNCATE | APR_BUFFERED,
+                           APR_OS_DEFAULT, scratch_pool));
+
+  SVN_ERR(run_text_merge(&job->contains_conflicts, result_f, &job->mt,
+                         job->left_abspath, job->right_abspath,
+                         job->left_label, job->right_label,
+                         job->target_label,
+                         job->detranslated_target_abspath,
+                         cancel_func, cancel_baton, scratch_pool));
+
+  return svn_error_trace(svn_io_file_close(result_f, scratch_pool));
+}
+
+/* Do all of svn_wc_merge5() for JOB that needs to happen after the text
+ * merge, i.e. update the working copy DB, run the work items and call the
+ * conflict resolver callback CONFLICT_FUNC with CONFLICT_BATON.  All other
+ * arguments are as for svn_wc_merge5().
+ */
+static svn_error_t *
+end_merge(merge_job_t *job,
+          svn_wc_conflict_resolver_func2_t conflict_func,
+          void *conflict_baton,
+          svn_cancel_func_t cancel_func,
+          void *cancel_baton,
+          apr_pool_t *scratch_pool)
+{
+  svn_wc__db_t *db = job->mt.db;
+  const char *target_abspath = job->mt.local_abspath;
+  svn_skel_t *work_items = job->work_items;
+
+  if (job->skip)
+    return SVN_NO_ERROR;
+
+  if (job->text_merge)
+    {
+      svn_skel_t *text_work_items;
+
+      SVN_ERR(finish_text_merge(&text_work_items,
+                                &job->conflict_skel,
+                                &job->content_outcome,
+                                &job->mt,
+                                job->left_abspath,
+                                job->right_abspath,
+                                job->left_label,
+                                job->right_label,
+                                job->target_label,
+                                job->dry_run,
+                                job->detranslated_target_abspath,
+                                job->contains_conflicts,
+                                job->result_target,
+                                cancel_func, cancel_baton,
+                                scratch_pool, scratch_pool));
+      work_items = svn_wc__wq_merge(work_items, text_work_items,
+                                    scratch_pool);
+    }
+
+  SVN_ERR(end_internal_merge(&work_items, &job->mt, job->dry_run,
+                             scratch_pool, scratch_pool));
 
   /* If this isn't a dry run, then update the DB, run the work, and
    * call the conflict resolver callback.  */
-  if (!dry_run)
+  if (!job->dry_run)
     {
-      if (conflict_skel)
+      if (job->conflict_skel)
         {
           svn_skel_t *work_item;
 
-          SVN_ERR(svn_wc__conflict_skel_set_op_merge(conflict_skel,
-                                                     left_version,
-                                                     right_version,
+          SVN_ERR(svn_wc__conflict_skel_set_op_merge(job->conflict_skel,
+                                                     job->left_version,
+                                                     job->right_version,
                                                      scratch_pool,
                                                      scratch_pool));
 
           SVN_ERR(svn_wc__conflict_create_markers(&work_item,
-                                                  wc_ctx->db, target_abspath,
-                                                  conflict_skel,
+                                                  db, target_abspath,
+                                                  job->conflict_skel,
                                                   scratch_pool, scratch_pool));
 
           work_items = svn_wc__wq_merge(work_items, work_item, scratch_pool);
         }
 
-      if (new_actual_props)
-        SVN_ERR(svn_wc__db_op_set_props(wc_ctx->db, target_abspath,
-                                        new_actual_props,
-                                        svn_wc__has_magic_property(prop_diff),
-                                        conflict_skel, work_items,
+      if (job->new_actual_props)
+        SVN_ERR(svn_wc__db_op_set_props(db, target_abspath,
+                                        job->new_actual_props,
+                                        svn_wc__has_magic_property(
+                                          job->mt.prop_diff),
+                                        job->conflict_skel, work_items,
                                         scratch_pool));
-      else if (conflict_skel)
-        SVN_ERR(svn_wc__db_op_mark_conflict(wc_ctx->db, target_abspath,
-                                            conflict_skel, work_items,
+      else if (job->conflict_skel)
+        SVN_ERR(svn_wc__db_op_mark_conflict(db, target_abspath,
+                                            job->conflict_skel, work_items,
                                             scratch_pool));
       else if (work_items)
-        SVN_ERR(svn_wc__db_wq_add(wc_ctx->db, target_abspath, work_items,
+        SVN_ERR(svn_wc__db_wq_add(db, target_abspath, work_items,
                                   scratch_pool));
 
       if (work_items)
-        SVN_ERR(svn_wc__wq_run(wc_ctx->db, target_abspath,
+        SVN_ERR(svn_wc__wq_run(db, target_abspath,
                                cancel_func, cancel_baton,
                                scratch_pool));
 
-      if (conflict_skel && conflict_func)
+      if (job->conflict_skel && conflict_func)
         {
           svn_boolean_t text_conflicted, prop_conflicted;
 
           SVN_ERR(svn_wc__conflict_invoke_resolver(
-                    wc_ctx->db, target_abspath, kind,
-                    conflict_skel, merge_options,
+                    db, target_abspath, job->kind,
+                    job->conflict_skel, job->merge_options,
                     conflict_func, conflict_baton,
                     cancel_func, cancel_baton,
                     scratch_pool));
@@ -1414,15 +1721,421 @@ svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
           /* Reset *MERGE_CONTENT_OUTCOME etc. if a conflict was resolved. */
           SVN_ERR(svn_wc__internal_conflicted_p(
                     &text_conflicted, &prop_conflicted, NULL,
-                    wc_ctx->db, target_abspath, scratch_pool));
-          if (*merge_props_outcome == svn_wc_notify_state_conflicted
+                    db, target_abspath, scratch_pool));
+          if (job->props_outcome == svn_wc_notify_state_conflicted
               && ! prop_conflicted)
-            *merge_props_outcome = svn_wc_notify_state_merged;
-          if (*merge_content_outcome == svn_wc_merge_conflict
+            job->props_outcome = svn_wc_notify_state_merged;
+          if (job->content_outcome == svn_wc_merge_conflict
               && ! text_conflicted)
-            *merge_content_outcome = svn_wc_merge_merged;
+            job->content_outcome = svn_wc_merge_merged;
         }
     }
 
   return SVN_NO_ERROR;
 }
+
+svn_error_t *
+svn_wc_merge5(enum svn_wc_merge_outcome_t *merge_content_outcome,
+              enum svn_wc_notify_state_t *merge_props_outcome,
+              svn_wc_context_t *wc_ctx,
+              const char *left_abspath,
+              const char *right_abspath,
+              const char *target_abspath,
+              const char *left_label,
+              const char *right_label,
+              const char *target_label,
+              const svn_wc_conflict_version_t *left_version,
+              const svn_wc_conflict_version_t *right_version,
+              svn_boolean_t dry_run,
+              const char *diff3_cmd,
+              const apr_array_header_t *merge_options,
+              apr_hash_t *original_props,
+              const apr_array_header_t *prop_diff,
+              svn_wc_conflict_resolver_func2_t conflict_func,
+              void *conflict_baton,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *scratch_pool)
+{
+  merge_job_t job;
+
+  SVN_ERR(begin_merge(&job, wc_ctx->db, left_abspath, right_abspath,
+                      target_abspath, left_label, right_label, target_label,
+                      left_version, right_version, dry_run, diff3_cmd,
+                      merge_options, original_props, prop_diff,
+                      merge_props_outcome != NULL,
+                      cancel_func, cancel_baton, scratch_pool));
+
+  if (job.text_merge)
+    SVN_ERR(perform_text_merge(&job, cancel_func, cancel_baton,
+                               scratch_pool));
+
+  SVN_ERR(end_merge(&job, conflict_func, conflict_baton,
+                    cancel_func, cancel_baton, scratch_pool));
+
+  *merge_content_outcome = job.content_outcome;
+  if (merge_props_outcome)
+    *merge_props_outcome = job.props_outcome;
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** Queued merges. ***/
+
+/* How many merges per worker thread may be pending in a merge queue
+ * before svn_wc__merge_queue_add() installs the oldest one. */
+#define MERGE_QUEUE_SLOTS_PER_WORKER 4
+
+/* A merge waiting in a svn_wc__merge_queue_t. */
+typedef struct queued_merge_t
+{
+  /* The merge itself. */
+  merge_job_t job;
+
+  /* Callback to invoke once the merge has been installed. */
+  svn_wc__merge_done_func_t done_func;
+  void *done_baton;
+
+  /* The text merge running in the queue's thread pool or NULL if there
+     is none or it has been run already. */
+  svn_thread_pool__job_t *text_merge_job;
+
+  /* Outcome of a text merge that has been run right away. */
+  svn_error_t *err;
+
+  /* Next merge in the queue. */
+  struct queued_merge_t *next;
+
+  /* Holds all data of this merge and its temporary files.  Only accessed
+     by the thread that owns the queue. */
+  apr_pool_t *pool;
+} queued_merge_t;
+
+struct svn_wc__merge_queue_t
+{
+  /* The working copy to merge into. */
+  svn_wc_context_t *wc_ctx;
+
+  /* Maximum number of concurrent text merges. */
+  int jobs;
+
+  /* Cancellation callback used while waiting for text merges. */
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  /* Pending merges in the order they were added.  Install them from the
+     head of the list. */
+  queued_merge_t *first;
+  queued_merge_t *last;
+  int pending;
+
+  /* Targets (const char *) of all pending merges, mapped to themselves. */
+  apr_hash_t *targets;
+
+  /* Directory for the copies of the merge sources. */
+  const char *temp_dir;
+
+  /* Runs the deferred text merges.  NULL if JOBS is 1. */
+  svn_thread_pool__t *thread_pool;
+
+  /* The pool used for the queue itself. */
+  apr_pool_t *pool;
+};
+
+/* Implements svn_thread_pool__job_func_t.  Run the text merge of the
+ * queued_merge_t given as JOB_BATON.
+ */
+static svn_error_t *
+run_text_merge(void *job_baton,
+               void *worker_baton,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  queued_merge_t *merge = job_baton;
+
+  return svn_error_trace(perform_text_merge(&merge->job,
+                                            cancel_func, cancel_baton,
+                                            scratch_pool));
+}
+
+/* Abort all text merges running in QUEUE and discard all merges that have
+ * not been installed.  Return ERR combined with any error that occurred
+ * while doing so.
+ */
+static svn_error_t *
+abort_queued_merges(svn_wc__merge_queue_t *queue,
+                    svn_error_t *err)
+{
+  if (queue->thread_pool)
+    err = svn_error_compose_create(err,
+                                   svn_thread_pool__join(queue->thread_pool,
+                                                         TRUE));
+
+  while (queue->first)
+    {
+      queued_merge_t *merge = queue->first;
+
+      queue->first = merge->next;
+      svn_error_clear(merge->err);
+      svn_pool_destroy(merge->pool);
+    }
+
+  queue->last = NULL;
+  queue->pending = 0;
+  apr_hash_clear(queue->targets);
+
+  return svn_error_trace(err);
+}
+
+/* Remove the oldest merge from QUEUE, wait for its text merge to complete
+ * and install the result in the working copy.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+static svn_error_t *
+install_queued_merge(svn_wc__merge_queue_t *queue,
+                     apr_pool_t *scratch_pool)
+{
+  queued_merge_t *merge = queue->first;
+  svn_error_t *err;
+
+  SVN_ERR_ASSERT(merge);
+
+  /* If we can't get the text merge result, none of the pending merges
+     may be installed anymore. */
+  if (merge->text_merge_job)
+    {
+      err = svn_thread_pool__wait(queue->thread_pool, merge->text_merge_job,
+                                  queue->cancel_func, queue->cancel_baton);
+      merge->text_merge_job = NULL;
+      if (err)
+        return svn_error_trace(abort_queued_merges(queue, err));
+    }
+
+  queue->first = merge->next;
+  if (!queue->first)
+    queue->last = NULL;
+
+  --queue->pending;
+  svn_hash_sets(queue->targets, merge->job.mt.local_abspath, NULL);
+
+  err = merge->err;
+  if (!err)
+    err = end_merge(&merge->job, NULL, NULL,
+                    queue->cancel_func, queue->cancel_baton, scratch_pool);
+  if (!err && merge->done_func)
+    err = merge->done_func(merge->done_baton, merge->job.mt.local_abspath,
+                           merge->job.content_outcome,
+                           merge->job.props_outcome, scratch_pool);
+
+  svn_pool_destroy(merge->pool);
+
+  return svn_error_trace(err);
+}
+
+svn_error_t *
+svn_wc__merge_queue_create(svn_wc__merge_queue_t **queue,
+                           svn_wc_context_t *wc_ctx,
+                           int jobs,
+                           svn_cancel_func_t cancel_func,
+                           void *cancel_baton,
+                           apr_pool_t *result_pool)
+{
+  svn_wc__merge_queue_t *result = apr_pcalloc(result_pool, sizeof(*result));
+
+#if !APR_HAS_THREADS
+  jobs = 1;
+#endif
+
+  result->wc_ctx = wc_ctx;
+  result->jobs = jobs > 1 ? jobs : 1;
+  result->cancel_func = cancel_func;
+  result->cancel_baton = cancel_baton;
+  result->targets = apr_hash_make(result_pool);
+  result->pool = result_pool;
+
+  SVN_ERR(svn_io_temp_dir(&result->temp_dir, result_pool));
+
+  /* The threads only get started once there are text merges to run. */
+  if (result->jobs > 1)
+    SVN_ERR(svn_thread_pool__create(&result->thread_pool, result->jobs,
+                                    NULL, NULL, result_pool));
+
+  *queue = result;
+  return SVN_NO_ERROR;
+}
+
+/* Copy SOURCE_ABSPATH to a new temporary file in QUEUE's temp dir that
+ * will be deleted when POOL gets cleaned up and return its path in
+ * *COPY_ABSPATH.
+ */
+static svn_error_t *
+copy_merge_source(const char **copy_abspath,
+                  svn_wc__merge_queue_t *queue,
+                  const char *source_abspath,
+                  apr_pool_t *pool)
+{
+  SVN_ERR(svn_io_open_unique_file3(NULL, copy_abspath, queue->temp_dir,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   pool, pool));
+  return svn_error_trace(svn_io_copy_file(source_abspath, *copy_abspath,
+                                          FALSE, pool));
+}
+
+svn_error_t *
+svn_wc__merge_queue_add(svn_wc__merge_queue_t *queue,
+                        const char *left_abspath,
+                        const char *right_abspath,
+                        const char *target_abspath,
+                        const char *left_label,
+                        const char *right_label,
+                        const char *target_label,
+                        const svn_wc_conflict_version_t *left_version,
+                        const svn_wc_conflict_version_t *right_version,
+                        svn_boolean_t dry_run,
+                        const char *diff3_cmd,
+                        const apr_array_header_t *merge_options,
+                        apr_hash_t *original_props,
+                        const apr_array_header_t *prop_diff,
+                        svn_boolean_t merge_props,
+                        svn_wc__merge_done_func_t done_func,
+                        void *done_baton,
+                        apr_pool_t *scratch_pool)
+{
+  apr_pool_t *pool;
+  queued_merge_t *merge;
+  svn_error_t *err;
+
+  /* Without concurrency, there is nothing to gain from queueing. */
+  if (queue->jobs == 1)
+    {
+      enum svn_wc_merge_outcome_t content_outcome;
+      svn_wc_notify_state_t props_outcome;
+
+      SVN_ERR(svn_wc_merge5(&content_outcome,
+                            merge_props ? &props_outcome : NULL,
+                            queue->wc_ctx,
+                            left_abspath, right_abspath, target_abspath,
+                            left_label, right_label, target_label,
+                            left_version, right_version, dry_run,
+                            diff3_cmd, merge_options,
+                            original_props, prop_diff,
+                            NULL, NULL,
+                            queue->cancel_func, queue->cancel_baton,
+                            scratch_pool));
+      if (!merge_props)
+        props_outcome = svn_wc_notify_state_unchanged;
+
+      return done_func
+        ? svn_error_trace(done_func(done_baton, target_abspath,
+                                    content_outcome, props_outcome,
+                                    scratch_pool))
+        : SVN_NO_ERROR;
+    }
+
+  /* We must not merge into a file that has a merge pending into it. */
+  if (svn_hash_gets(queue->targets, target_abspath))
+    SVN_ERR(svn_wc__merge_queue_flush(queue, scratch_pool));
+
+  /* Limit the number of pending merges and temporary files. */
+  if (queue->pending >= queue->jobs * MERGE_QUEUE_SLOTS_PER_WORKER)
+    SVN_ERR(install_queued_merge(queue, scratch_pool));
+
+  pool = svn_pool_create(queue->pool);
+  merge = apr_pcalloc(pool, sizeof(*merge));
+  merge->pool = pool;
+  merge->done_func = done_func;
+  merge->done_baton = done_baton;
+
+  /* The caller's data may be gone by the time we install the merge. */
+  err = begin_merge(&merge->job, queue->wc_ctx->db,
+                      left_abspath, right_abspath,
+                      apr_pstrdup(pool, target_abspath),
+                      apr_pstrdup(pool, left_label),
+                      apr_pstrdup(pool, right_label),
+                      apr_pstrdup(pool, target_label),
+                      left_version ? svn_wc_conflict_version_dup(left_version,
+                                                                 pool)
+                                   : NULL,
+                      right_version ? svn_wc_conflict_version_dup(
+                                        right_version, pool)
+                                    : NULL,
+                      dry_run,
+                      apr_pstrdup(pool, diff3_cmd),
+                      merge_options
+                        ? apr_array_copy(pool, merge_options)
+                        : NULL,
+                      original_props
+                        ? svn_prop_hash_dup(original_props, pool)
+                        : NULL,
+                      prop_diff ? svn_prop_array_dup(prop_diff, pool) : NULL,
+                      merge_props,
+                      queue->cancel_func, queue->cancel_baton,
+                      pool);
+  if (err)
+    {
+      svn_pool_destroy(pool);
+      return svn_error_trace(err);
+    }
+
+  /* Only internal text merges are worth deferring.  Do everything else
+     right away but still install the result in order. */
+  if (merge->job.text_merge && diff3_cmd)
+    {
+      merge->err = perform_text_merge(&merge->job,
+                                      queue->cancel_func, queue->cancel_baton,
+                                      scratch_pool);
+    }
+  else if (merge->job.text_merge)
+    {
+      /* Our sources may be temporary files that the caller deletes once
+         we return. */
+      if (strcmp(merge->job.left_abspath, left_abspath) == 0)
+        SVN_ERR(copy_merge_source(&merge->job.left_abspath, queue,
+                                  left_abspath, pool));
+      SVN_ERR(copy_merge_source(&merge->job.right_abspath, queue,
+                                right_abspath, pool));
+
+      SVN_ERR(svn_thread_pool__submit(&merge->text_merge_job,
+                                      queue->thread_pool, run_text_merge,
+                                      merge));
+    }
+
+  ++queue->pending;
+  svn_hash_sets(queue->targets, merge->job.mt.local_abspath,
+                merge->job.mt.local_abspath);
+
+  if (queue->last)
+    queue->last->next = merge;
+  else
+    queue->first = merge;
+  queue->last = merge;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__merge_queue_flush(svn_wc__merge_queue_t *queue,
+                          apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err = SVN_NO_ERROR;
+
+  while (queue->first && !err)
+    {
+      svn_pool_clear(iterpool);
+      err = install_queued_merge(queue, iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* After an error, discard all merges that have not been installed.
+     Otherwise, don't keep idle threads around. */
+  if (err)
+    err = abort_queued_merges(queue, err);
+  else if (queue->thread_pool)
+    err = svn_thread_pool__join(queue->thread_pool, FALSE);
+
+  return svn_error_trace(err);
+}
@@ -38,6 +38,7 @@
 #include "svn_time.h"
 #include "svn_io.h"
 #include "svn_props.h"
+#include "svn_sorts.h"
 
 #include "wc.h"
 #include "conflicts.h"
@@ -206,6 +207,96 @@ compare_and_verify(svn_boolean_t *modified_p,
   return SVN_NO_ERROR;
 }
 
+/* Set *MODIFIED_P to TRUE if VERSIONED_FILE_ABSPATH, translated to
+ * repository-normal form according to its properties, doesn't have the
+ * SHA-1 checksum PRISTINE_CHECKSUM, else to FALSE.  This is how we compare
+ * files whose pristine text is dehydrated.  Set *ACTUAL_CHECKSUM to the
+ * checksum the file does have, allocated in RESULT_POOL.
+ *
+ * DB is a wc_db; use SCRATCH_POOL for temporary allocation.
+ */
+static svn_error_t *
+compare_with_checksum(svn_boolean_t *modified_p,
+                      const svn_checksum_t **actual_checksum,
+                      svn_wc__db_t *db,
+                      const char *versioned_file_abspath,
+                      const svn_checksum_t *pristine_checksum,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  svn_stream_t *v_stream;
+  svn_checksum_t *checksum;
+
+  SVN_ERR(svn_wc__internal_translated_stream(&v_stream, db,
+                                             versioned_file_abspath,
+                                             versioned_file_abspath,
+                                             SVN_WC_TRANSLATE_TO_NF,
+                                             scratch_pool, scratch_pool));
+  SVN_ERR(svn_stream_contents_checksum(&checksum, v_stream,
+                                       svn_checksum_sha1,
+                                       result_pool, scratch_pool));
+
+  *modified_p = !svn_checksum_match(checksum, pristine_checksum);
+  *actual_checksum = checksum;
+
+  return SVN_NO_ERROR;
+}
+
+/* What identifies the content of a working file for the checksum cache,
+   see svn_wc__db_checksum_cache_get(). */
+typedef struct file_signature_t
+{
+  svn_filesize_t size;
+  apr_time_t mtime;
+  apr_time_t ctime;
+  apr_int64_t inode;
+
+  /* Whether the file's timestamps are old enough that a write in the
+     same timestamp tick can't go unnoticed, so checksums may be stored. */
+  svn_boolean_t settled;
+} file_signature_t;
+
+/* Read the signature of LOCAL_ABSPATH into *SIGNATURE.  Set *USABLE to
+   FALSE if the platform can't tell enough about the file to use the
+   checksum cache. */
+static svn_error_t *
+read_file_signature(file_signature_t *signature,
+                    svn_boolean_t *usable,
+                    const char *local_abspath,
+                    apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+  svn_error_t *err;
+
+  err = svn_io_stat(&finfo, local_abspath,
+                    APR_FINFO_SIZE | APR_FINFO_MTIME | APR_FINFO_CTIME
+                    | APR_FINFO_INODE,
+                    scratch_pool);
+
+  /* Not every platform has inode numbers; use what there is. */
+  if (err && APR_STATUS_IS_INCOMPLETE(err->apr_err))
+    svn_error_clear(err);
+  else
+    SVN_ERR(err);
+
+  *usable = ((finfo.valid & APR_FINFO_SIZE)
+             && (finfo.valid & APR_FINFO_MTIME));
+  if (! *usable)
+    return SVN_NO_ERROR;
+
+  signature->size = finfo.size;
+  signature->mtime = finfo.mtime;
+  signature->ctime = (finfo.valid & APR_FINFO_CTIME) ? finfo.ctime : 0;
+  signature->inode = (finfo.valid & APR_FINFO_INODE) ? finfo.inode : 0;
+
+  /* FAT has a 2 second timestamp granularity. */
+  signature->settled = (apr_time_now() - MAX(signature->mtime,
+                                             signature->ctime)
+                        > apr_time_from_sec(2));
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
                                  svn_wc__db_t *db,
@@ -302,26 +393,84 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
     }
 
  compare_them:
-  SVN_ERR(svn_wc__db_pristine_read(&pristine_stream, &pristine_size,
-                                   db, local_abspath, checksum,
-                                   scratch_pool, scratch_pool));
-
-  /* Check all bytes, and verify checksum if requested. */
   {
-    svn_error_t *err;
-    err = compare_and_verify(modified_p, db,
-                             local_abspath, dirent->filesize,
-                             pristine_stream, pristine_size,
-                             has_props, props_mod,
-                             exact_comparison,
-                             scratch_pool);
-
-    /* At this point we already opened the pristine file, so we know that
-       the access denied applies to the working copy path */
-    if (err && APR_STATUS_IS_EACCES(err->apr_err))
-      return svn_error_create(SVN_ERR_WC_PATH_ACCESS_DENIED, err, NULL);
+    file_signature_t signature;
+    svn_boolean_t use_cache = FALSE;
+    const svn_checksum_t *actual_checksum = NULL;
+
+    /* A checksum remembered for exactly this file tells us as much as
+       reading it would.  Changed properties change the normal form, so
+       don't trust it then. */
+    if (! exact_comparison && ! props_mod
+        && svn_wc__db_get_checksum_cache(db))
+      {
+        SVN_ERR(read_file_signature(&signature, &use_cache, local_abspath,
+                                    scratch_pool));
+        if (use_cache)
+          SVN_ERR(svn_wc__db_checksum_cache_get(&actual_checksum, db,
+                                                local_abspath,
+                                                signature.size,
+                                                signature.mtime,
+                                                signature.ctime,
+                                                signature.inode,
+                                                scratch_pool, scratch_pool));
+      }
+
+    if (actual_checksum)
+      {
+        *modified_p = !svn_checksum_match(actual_checksum, checksum);
+        use_cache = FALSE;
+      }
     else
-      SVN_ERR(err);
+      {
+        svn_error_t *err;
+
+        err = svn_wc__db_pristine_read(&pristine_stream, &pristine_size,
+                                       db, local_abspath, checksum,
+                                       scratch_pool, scratch_pool);
+        if (err && err->apr_err == SVN_ERR_WC_PRISTINE_DEHYDRATED)
+          {
+            svn_error_clear(err);
+            pristine_stream = NULL;
+          }
+        else
+          SVN_ERR(err);
+
+        /* Check all bytes, and verify checksum if requested.
+           Without the text there's only its checksum to compare with. */
+        if (!pristine_stream)
+          err = compare_with_checksum(modified_p, &actual_checksum,
+                                      db, local_abspath, checksum,
+                                      scratch_pool, scratch_pool);
+        else
+          err = compare_and_verify(modified_p, db,
+                                   local_abspath, dirent->filesize,
+                                   pristine_stream, pristine_size,
+                                   has_props, props_mod,
+                                   exact_comparison,
+                                   scratch_pool);
+
+        /* At this point we already opened the pristine file, so we know
+           that the access denied applies to the working copy path */
+        if (err && APR_STATUS_IS_EACCES(err->apr_err))
+          return svn_error_create(SVN_ERR_WC_PATH_ACCESS_DENIED, err, NULL);
+        else
+          SVN_ERR(err);
+
+        if (!*modified_p)
+          actual_checksum = checksum;
+      }
+
+    /* Remember what we found, unless the file was just written.  This is
+       only an optimization, so a read-only or busy wc.db doesn't matter. */
+    if (use_cache && signature.settled && actual_checksum)
+      svn_error_clear(svn_wc__db_checksum_cache_set(db, local_abspath,
+                                                    signature.size,
+                                                    signature.mtime,
+                                                    signature.ctime,
+                                                    signature.inode,
+                                                    actual_checksum,
+                                                    scratch_pool));
   }
 
   if (!*modified_p)
@@ -32,17 +32,20 @@
 #include "svn_private_config.h"
 
 svn_error_t *
-svn_wc_revision_status2(svn_wc_revision_status_t **result_p,
+svn_wc_revision_status3(svn_wc_revision_status_t **result_p,
                         svn_wc_context_t *wc_ctx,
                         const char *local_abspath,
                         const char *trail_url,
                         svn_boolean_t committed,
+                        svn_boolean_t skip_content_check,
                         svn_cancel_func_t cancel_func,
                         void *cancel_baton,
                         apr_pool_t *result_pool,
                         apr_pool_t *scratch_pool)
 {
   svn_wc_revision_status_t *result = apr_pcalloc(result_pool, sizeof(*result));
+  apr_array_header_t *candidates;
+  int i;
 
   *result_p = result;
 
@@ -62,12 +65,37 @@ svn_wc_revision_status2(svn_wc_revision_status_t **result_p,
                                      wc_ctx->db, local_abspath, trail_url,
                                      committed,
                                      scratch_pool));
+  if (result->modified)
+    return SVN_NO_ERROR;
 
-  if (!result->modified)
-    SVN_ERR(svn_wc__node_has_local_mods(&result->modified, NULL,
-                                        wc_ctx->db, local_abspath, TRUE,
-                                        cancel_func, cancel_baton,
-                                        scratch_pool));
+  /* Without any WORKING nodes or property changes, only the BASE files
+     themselves may be modified.  Check them in a single pass over the
+     database instead of a full status walk. */
+  SVN_ERR(svn_wc__db_check_base_files(&result->modified, &candidates,
+                                      wc_ctx->db, local_abspath,
+                                      cancel_func, cancel_baton,
+                                      scratch_pool, scratch_pool));
+  if (result->modified || !candidates->nelts)
+    return SVN_NO_ERROR;
+
+  if (skip_content_check)
+    {
+      result->modified = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  /* Compare the contents of the files whose timestamps don't match. */
+  for (i = 0; i < candidates->nelts && !result->modified; ++i)
+    {
+      const char *file_abspath = APR_ARRAY_IDX(candidates, i, const char *);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(svn_wc__internal_file_modified_p(&result->modified,
+                                               wc_ctx->db, file_abspath,
+                                               FALSE, scratch_pool));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -46,11 +46,13 @@
 
 #include "wc.h"
 #include "props.h"
+#include "fsmonitor.h"
 
 #include "private/svn_sorts_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_editor.h"
+#include "private/svn_thread_pool.h"
 
 
 /* The file internal variant of svn_wc_status3_t, with slightly more
@@ -94,6 +96,14 @@ struct walk_status_baton
   /* Externals info harvested during the status run. */
   apr_hash_t *externals;
 
+  /* The file system monitor telling which files have to be checked on
+     disk, or NULL to check all of them. */
+  svn_wc__fsmonitor_t *fsmonitor;
+
+  /* The threads reading file information for directories, or NULL to
+     read it while listing them. */
+  struct stat_workers_t *stat_workers;
+
   /*** Repository lock handling ***/
   /* The repository root URL, if set. */
   const char *repos_root;
@@ -1188,6 +1198,267 @@ one_child_status(const struct walk_status_baton *wb,
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+
+/* Directories with fewer files than this are stat()ed by the walk
+   itself, as waking up the workers would cost more than it saves. */
+#define STAT_BATCH_MIN 8
+
+/* The files of a single directory that are being stat()ed.  Everything
+   but the results is set up before the batch is handed to the workers. */
+typedef struct stat_batch_t
+{
+  const char **abspaths;
+  int count;
+
+  /* Results, written by whoever stat()s the respective index. */
+  svn_io_dirent2_t *dirents;
+  svn_error_t **errors;
+} stat_batch_t;
+
+/* A range of entries of a stat_batch_t that is stat()ed by one thread. */
+typedef struct stat_chunk_t
+{
+  stat_batch_t *batch;
+  int start;
+  int end;
+
+  /* The job stat()ing this chunk, if it has been submitted. */
+  svn_thread_pool__job_t *job;
+} stat_chunk_t;
+
+/* Threads helping a status walk to stat() the files of its directories.
+ */
+typedef struct stat_workers_t
+{
+  /* Number of worker threads. */
+  int jobs;
+
+  svn_thread_pool__t *thread_pool;
+} stat_workers_t;
+
+/* Implements svn_thread_pool__job_func_t.  Stat() the entries of the
+   stat_chunk_t given as JOB_BATON and store the results in its batch. */
+static svn_error_t *
+stat_chunk(void *job_baton,
+           void *worker_baton,
+           svn_cancel_func_t cancel_func,
+           void *cancel_baton,
+           apr_pool_t *scratch_pool)
+{
+  stat_chunk_t *chunk = job_baton;
+  stat_batch_t *batch = chunk->batch;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = chunk->start; i < chunk->end; i++)
+    {
+      const svn_io_dirent2_t *dirent;
+
+      svn_pool_clear(iterpool);
+      batch->errors[i] = svn_io_stat_dirent2(&dirent, batch->abspaths[i],
+                                             FALSE /* verify_truename */,
+                                             TRUE /* ignore_enoent */,
+                                             iterpool, iterpool);
+      if (!batch->errors[i])
+        batch->dirents[i] = *dirent;
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *WORKERS to JOBS - 1 (the walk itself being the last one) threads
+   stat()ing files, allocated in RESULT_POOL.  Set *WORKERS to NULL if
+   there would be none. */
+static svn_error_t *
+start_stat_workers(stat_workers_t **workers,
+                   int jobs,
+                   apr_pool_t *result_pool)
+{
+  stat_workers_t *w;
+
+  *workers = NULL;
+  if (jobs < 2)
+    return SVN_NO_ERROR;
+
+  w = apr_pcalloc(result_pool, sizeof(*w));
+  w->jobs = jobs - 1;
+  SVN_ERR(svn_thread_pool__create(&w->thread_pool, w->jobs, NULL, NULL,
+                                  result_pool));
+
+  *workers = w;
+
+  return SVN_NO_ERROR;
+}
+
+/* Make WORKERS terminate and wait for them. */
+static svn_error_t *
+stop_stat_workers(stat_workers_t *workers)
+{
+  return svn_error_trace(svn_thread_pool__join(workers->thread_pool,
+                                               FALSE));
+}
+
+/* Replace the type-only entries of files and symlinks in DIRENTS, the
+   listing of directory LOCAL_ABSPATH, with the full result of stat()ing
+   them, using WORKERS.  Remove the ones that vanished in between.
+   Allocate the new entries in RESULT_POOL. */
+static svn_error_t *
+stat_dirents(apr_hash_t *dirents,
+             stat_workers_t *workers,
+             const char *local_abspath,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  stat_batch_t batch = { 0 };
+  stat_chunk_t *chunks;
+  int chunk_count;
+  int submitted;
+  const char **names;
+  apr_hash_index_t *hi;
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  names = apr_palloc(scratch_pool, apr_hash_count(dirents) * sizeof(*names));
+  batch.abspaths = apr_palloc(scratch_pool,
+                              apr_hash_count(dirents)
+                              * sizeof(*batch.abspaths));
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+      /* Status only needs the kind of anything but files. */
+      if (dirent->kind != svn_node_file && !dirent->special)
+        continue;
+
+      names[batch.count] = apr_hash_this_key(hi);
+      batch.abspaths[batch.count] = svn_dirent_join(local_abspath,
+                                                    names[batch.count],
+                                                    scratch_pool);
+      batch.count++;
+    }
+
+  if (!batch.count)
+    return SVN_NO_ERROR;
+
+  batch.dirents = apr_pcalloc(scratch_pool,
+                              batch.count * sizeof(*batch.dirents));
+  batch.errors = apr_pcalloc(scratch_pool,
+                             batch.count * sizeof(*batch.errors));
+
+  /* One chunk per worker plus one for the walk itself. */
+  chunk_count = batch.count < STAT_BATCH_MIN ? 1 : workers->jobs + 1;
+  chunks = apr_pcalloc(scratch_pool, chunk_count * sizeof(*chunks));
+  for (i = 0; i < chunk_count; i++)
+    {
+      chunks[i].batch = &batch;
+      chunks[i].start = batch.count * i / chunk_count;
+      chunks[i].end = batch.count * (i + 1) / chunk_count;
+    }
+
+  for (submitted = 1; submitted < chunk_count; submitted++)
+    {
+      err = svn_thread_pool__submit(&chunks[submitted].job,
+                                    workers->thread_pool, stat_chunk,
+                                    &chunks[submitted]);
+
+      /* Do it all ourselves if no worker could be started. */
+      if (err)
+        {
+          svn_error_clear(err);
+          err = SVN_NO_ERROR;
+          break;
+        }
+    }
+
+  SVN_ERR(stat_chunk(&chunks[0], NULL, NULL, NULL, scratch_pool));
+  for (i = submitted; i < chunk_count; i++)
+    SVN_ERR(stat_chunk(&chunks[i], NULL, NULL, NULL, scratch_pool));
+
+  for (i = 1; i < submitted && !err; i++)
+    err = svn_thread_pool__wait(workers->thread_pool, chunks[i].job,
+                                NULL, NULL);
+
+  /* The remaining jobs must not touch BATCH after we returned. */
+  if (err)
+    return svn_error_compose_create(
+             err, svn_thread_pool__join(workers->thread_pool, TRUE));
+
+  for (i = 0; i < batch.count; i++)
+    {
+      if (batch.errors[i])
+        err = svn_error_compose_create(err, batch.errors[i]);
+      else if (batch.dirents[i].kind == svn_node_none)
+        svn_hash_sets(dirents, names[i], NULL);
+      else
+        svn_hash_sets(dirents, names[i],
+                      svn_io_dirent2_dup(&batch.dirents[i], result_pool));
+    }
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* Complete the type-only *DIRENT read for the child LOCAL_ABSPATH with
+   INFO, for a walk using WB->FSMONITOR.  Files the monitor knows to be
+   unchanged get their recorded size and timestamp, unversioned files an
+   unknown size and everything else is stat()ed.  Allocate a new *DIRENT in RESULT_POOL. */
+static svn_error_t *
+complete_fsmonitor_dirent(svn_io_dirent2_t **dirent,
+                          const struct walk_status_baton *wb,
+                          const char *local_abspath,
+                          const struct svn_wc__db_info_t *info,
+                          apr_pool_t *result_pool)
+{
+  const svn_io_dirent2_t *new_dirent;
+
+  /* Status only needs the kind of anything but files. */
+  if (!*dirent || ((*dirent)->kind != svn_node_file && !(*dirent)->special))
+    return SVN_NO_ERROR;
+
+  /* Nor is anything compared for unversioned files. */
+  if (!info)
+    {
+      *dirent = svn_io_dirent2_dup(*dirent, result_pool);
+      (*dirent)->filesize = SVN_INVALID_FILESIZE;
+      return SVN_NO_ERROR;
+    }
+
+  if (info->kind == svn_node_file
+      && info->status == svn_wc__db_status_normal
+      && !info->special && !(*dirent)->special
+      && info->recorded_size != SVN_INVALID_FILESIZE
+      && info->recorded_time != 0
+      && !svn_wc__fsmonitor_changed(wb->fsmonitor, local_abspath))
+    {
+      *dirent = svn_io_dirent2_dup(*dirent, result_pool);
+      (*dirent)->filesize = info->recorded_size;
+      (*dirent)->mtime = info->recorded_time;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_io_stat_dirent2(&new_dirent, local_abspath,
+                              FALSE /* verify_truename */,
+                              TRUE /* ignore_enoent */,
+                              result_pool, result_pool));
+
+  if (info->kind == svn_node_file)
+    svn_wc__fsmonitor_checked(wb->fsmonitor, local_abspath,
+                              new_dirent->kind == svn_node_file
+                              && new_dirent->filesize == info->recorded_size
+                              && new_dirent->mtime == info->recorded_time);
+
+  if (new_dirent->kind == svn_node_none)
+    *dirent = NULL;
+  else
+    *dirent = svn_io_dirent2_dup(new_dirent, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
 /* Send svn_wc_status3_t * structures for the directory LOCAL_ABSPATH and
    for all its child nodes (according to DEPTH) through STATUS_FUNC /
    STATUS_BATON.
@@ -1248,7 +1519,8 @@ get_dir_status(const struct walk_status_baton *wb,
   if (wb->check_working_copy)
     {
       err = svn_io_get_dirents3(&dirents, local_abspath,
-                                wb->ignore_text_mods /* only_check_type*/,
+                                wb->ignore_text_mods || wb->fsmonitor
+                                || wb->stat_workers /* only_check_type*/,
                                 scratch_pool, iterpool);
       if (err
           && (APR_STATUS_IS_ENOENT(err->apr_err)
@@ -1259,6 +1531,12 @@ get_dir_status(const struct walk_status_baton *wb,
         }
       else
         SVN_ERR(err);
+
+#if APR_HAS_THREADS
+      if (wb->stat_workers)
+        SVN_ERR(stat_dirents(dirents, wb->stat_workers, local_abspath,
+                             scratch_pool, iterpool));
+#endif
     }
   else
     dirents = apr_hash_make(scratch_pool);
@@ -1359,6 +1637,10 @@ get_dir_status(const struct walk_status_baton *wb,
       child_dirent = apr_hash_get(dirents, key, klen);
       child_info = apr_hash_get(nodes, key, klen);
 
+      if (wb->fsmonitor)
+        SVN_ERR(complete_fsmonitor_dirent(&child_dirent, wb, child_abspath,
+                                          child_info, iterpool));
+
       SVN_ERR(one_child_status(wb,
                                child_abspath,
                                local_abspath,
@@ -2642,6 +2924,8 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
   wb.target_abspath = local_abspath;
   wb.ignore_text_mods = ignore_text_mods;
   wb.check_working_copy = TRUE;
+  wb.fsmonitor = NULL;
+  wb.stat_workers = NULL;
   wb.repos_root = NULL;
   wb.repos_locks = NULL;
 
@@ -2690,19 +2974,55 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
       && info->status != svn_wc__db_status_excluded
       && info->status != svn_wc__db_status_server_excluded)
     {
-      SVN_ERR(get_dir_status(&wb,
-                             local_abspath,
-                             FALSE /* skip_root */,
-                             NULL, NULL, NULL,
-                             info,
-                             dirent,
-                             ignore_patterns,
-                             depth,
-                             get_all,
-                             no_ignore,
-                             status_func, status_baton,
-                             cancel_func, cancel_baton,
-                             scratch_pool));
+      if (!ignore_text_mods)
+        SVN_ERR(svn_wc__fsmonitor_open(&wb.fsmonitor, db, local_abspath,
+                                       scratch_pool, scratch_pool));
+
+#if APR_HAS_THREADS
+      /* A monitor already keeps most files from being stat()ed. */
+      if (!ignore_text_mods && !wb.fsmonitor)
+        SVN_ERR(start_stat_workers(&wb.stat_workers,
+                                   svn_wc__db_get_status_jobs(db),
+                                   scratch_pool));
+#endif
+
+      err = get_dir_status(&wb,
+                           local_abspath,
+                           FALSE /* skip_root */,
+                           NULL, NULL, NULL,
+                           info,
+                           dirent,
+                           ignore_patterns,
+                           depth,
+                           get_all,
+                           no_ignore,
+                           status_func, status_baton,
+                           cancel_func, cancel_baton,
+                           scratch_pool);
+
+#if APR_HAS_THREADS
+      if (wb.stat_workers)
+        err = svn_error_compose_create(err,
+                                       stop_stat_workers(wb.stat_workers));
+#endif
+      SVN_ERR(err);
+
+      if (wb.fsmonitor)
+        {
+          const char *wcroot_abspath;
+          svn_boolean_t complete;
+
+          SVN_ERR(svn_wc__db_get_wcroot(&wcroot_abspath, db, local_abspath,
+                                        scratch_pool, scratch_pool));
+          complete = (strcmp(wcroot_abspath, local_abspath) == 0
+                      && (depth == svn_depth_infinity
+                          || depth == svn_depth_unknown));
+
+          /* The status is complete without this; a working copy we can't
+             write to just doesn't get any faster. */
+          svn_error_clear(svn_wc__fsmonitor_close(wb.fsmonitor, complete,
+                                                  scratch_pool));
+        }
     }
   else
     {
@@ -0,0 +1,327 @@
+/*
+ * textbase.c :  keeping pristine texts only where they are needed
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#include <apr_pools.h>
+
+#include "svn_pools.h"
+#include "svn_types.h"
+#include "svn_error.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_checksum.h"
+
+#include "svn_private_config.h"
+#include "private/svn_wc_private.h"
+
+#include "wc.h"
+#include "translate.h"
+#include "textbase.h"
+
+
+/* Return the error for the dehydrated text SHA1_CHECKSUM of LOCAL_ABSPATH,
+   wrapping CHILD. */
+static svn_error_t *
+dehydrated_error(svn_error_t *child,
+                 const char *local_abspath,
+                 const svn_checksum_t *sha1_checksum,
+                 apr_pool_t *scratch_pool)
+{
+  return svn_error_createf(SVN_ERR_WC_PRISTINE_DEHYDRATED, child,
+                           _("Pristine text '%s' of '%s' is not stored in "
+                             "the working copy and can't be restored from "
+                             "the working file"),
+                           svn_checksum_to_cstring_display(sha1_checksum,
+                                                           scratch_pool),
+                           svn_dirent_local_style(local_abspath,
+                                                  scratch_pool));
+}
+
+svn_error_t *
+svn_wc__textbase_restore(svn_boolean_t *restored,
+                         svn_wc__db_t *db,
+                         const char *local_abspath,
+                         const svn_checksum_t *sha1_checksum,
+                         apr_pool_t *scratch_pool)
+{
+  svn_boolean_t present;
+  svn_stream_t *src_stream;
+  svn_stream_t *dst_stream;
+  svn_wc__db_install_data_t *install_data;
+  svn_checksum_t *actual_sha1_checksum;
+  svn_checksum_t *actual_md5_checksum;
+  svn_error_t *err;
+
+  if (restored)
+    *restored = FALSE;
+
+  SVN_ERR(svn_wc__db_pristine_check(&present, db, local_abspath,
+                                    sha1_checksum, scratch_pool));
+  if (present)
+    return SVN_NO_ERROR;
+
+  /* Only put back what wc_db still knows; this fails if it doesn't. */
+  SVN_ERR(svn_wc__db_pristine_read(NULL, NULL, db, local_abspath,
+                                   sha1_checksum, scratch_pool,
+                                   scratch_pool));
+
+  err = svn_wc__internal_translated_stream(&src_stream, db, local_abspath,
+                                           local_abspath,
+                                           SVN_WC_TRANSLATE_TO_NF,
+                                           scratch_pool, scratch_pool);
+  if (err && (APR_STATUS_IS_ENOENT(err->apr_err)
+              || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    return svn_error_trace(dehydrated_error(err, local_abspath,
+                                            sha1_checksum, scratch_pool));
+  SVN_ERR(err);
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&dst_stream, &install_data,
+                                              &actual_sha1_checksum,
+                                              &actual_md5_checksum,
+                                              db, local_abspath,
+                                              scratch_pool, scratch_pool));
+  err = svn_stream_copy3(src_stream, dst_stream, NULL, NULL, scratch_pool);
+
+  if (!err && !svn_checksum_match(actual_sha1_checksum, sha1_checksum))
+    err = dehydrated_error(NULL, local_abspath, sha1_checksum, scratch_pool);
+
+  if (err)
+    return svn_error_compose_create(
+             err,
+             svn_wc__db_pristine_install_abort(install_data, scratch_pool));
+
+  SVN_ERR(svn_wc__db_pristine_install(install_data, actual_sha1_checksum,
+                                      actual_md5_checksum, scratch_pool));
+  if (restored)
+    *restored = TRUE;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__textbase_dehydrate(svn_wc__db_t *db,
+                           const char *local_abspath,
+                           const svn_checksum_t *sha1_checksum,
+                           apr_pool_t *scratch_pool)
+{
+  svn_boolean_t pristines_on_demand;
+
+  SVN_ERR(svn_wc__db_get_pristines_on_demand(&pristines_on_demand, db,
+                                             local_abspath, scratch_pool));
+  if (!pristines_on_demand)
+    return SVN_NO_ERROR;
+
+  return svn_error_trace(svn_wc__db_pristine_dehydrate(db, local_abspath,
+                                                       sha1_checksum,
+                                                       scratch_pool));
+}
+
+
+/* The baton of sync_node(). */
+struct sync_baton_t
+{
+  svn_wc__db_t *db;
+  svn_wc__textbase_fetch_cb_t fetch_func;
+  void *fetch_baton;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+};
+
+/* Fetch the dehydrated pristine text SHA1_CHECKSUM of LOCAL_ABSPATH, which
+   is REPOS_RELPATH at REVISION in the repository REPOS_ROOT_URL, with the
+   fetch callback of SB and put it back into the pristine store. */
+static svn_error_t *
+fetch_text(struct sync_baton_t *sb,
+           const char *local_abspath,
+           const svn_checksum_t *sha1_checksum,
+           const char *repos_root_url,
+           const char *repos_relpath,
+           svn_revnum_t revision,
+           apr_pool_t *scratch_pool)
+{
+  svn_stream_t *stream;
+  svn_wc__db_install_data_t *install_data;
+  svn_checksum_t *actual_sha1_checksum;
+  svn_checksum_t *actual_md5_checksum;
+  svn_error_t *err;
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&stream, &install_data,
+                                              &actual_sha1_checksum,
+                                              &actual_md5_checksum,
+                                              sb->db, local_abspath,
+                                              scratch_pool, scratch_pool));
+
+  err = sb->fetch_func(sb->fetch_baton, repos_root_url, repos_relpath,
+                       revision, stream, sb->cancel_func, sb->cancel_baton,
+                       scratch_pool);
+  if (!err)
+    err = svn_stream_close(stream);
+
+  if (!err && !svn_checksum_match(actual_sha1_checksum, sha1_checksum))
+    err = svn_checksum_mismatch_err(sha1_checksum, actual_sha1_checksum,
+                                    scratch_pool,
+                                    _("Checksum mismatch for pristine text "
+                                      "of '%s' fetched from the repository"),
+                                    svn_dirent_local_style(local_abspath,
+                                                           scratch_pool));
+  if (err)
+    return svn_error_compose_create(
+             err,
+             svn_wc__db_pristine_install_abort(install_data, scratch_pool));
+
+  return svn_error_trace(svn_wc__db_pristine_install(install_data,
+                                                     actual_sha1_checksum,
+                                                     actual_md5_checksum,
+                                                     scratch_pool));
+}
+
+/* Implements svn_wc__node_found_func_t, fetching the dehydrated pristine
+   texts of LOCAL_ABSPATH that can't be restored from its working file. */
+static svn_error_t *
+sync_node(const char *local_abspath,
+          svn_node_kind_t kind,
+          void *walk_baton,
+          apr_pool_t *scratch_pool)
+{
+  struct sync_baton_t *sb = walk_baton;
+  svn_wc__db_status_t status;
+  const svn_checksum_t *checksum;
+  svn_boolean_t have_base;
+  svn_boolean_t present;
+
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_wc__db_read_info(&status, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, &checksum, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, &have_base, NULL, NULL,
+                               sb->db, local_abspath,
+                               scratch_pool, scratch_pool));
+
+  /* The text of the node, unless the working file still holds it. */
+  if (checksum
+      && (status == svn_wc__db_status_normal
+          || status == svn_wc__db_status_added))
+    {
+      SVN_ERR(svn_wc__db_pristine_check(&present, sb->db, local_abspath,
+                                        checksum, scratch_pool));
+      if (!present)
+        {
+          svn_boolean_t modified;
+          svn_revnum_t revision;
+          const char *repos_relpath;
+          const char *repos_root_url;
+
+          SVN_ERR(svn_wc__internal_file_modified_p(&modified, sb->db,
+                                                   local_abspath, FALSE,
+                                                   scratch_pool));
+          SVN_ERR(svn_wc__internal_get_origin(NULL, &revision,
+                                              &repos_relpath,
+                                              &repos_root_url, NULL, NULL,
+                                              NULL, sb->db, local_abspath,
+                                              FALSE, scratch_pool,
+                                              scratch_pool));
+
+          /* A missing file is not modified, but can't restore the text
+             either. */
+          if (!modified)
+            {
+              svn_node_kind_t disk_kind;
+
+              SVN_ERR(svn_io_check_path(local_abspath, &disk_kind,
+                                        scratch_pool));
+              modified = (disk_kind != svn_node_file);
+            }
+
+          if (modified && repos_relpath)
+            SVN_ERR(fetch_text(sb, local_abspath, checksum, repos_root_url,
+                               repos_relpath, revision, scratch_pool));
+        }
+    }
+
+  /* The text of a deleted or replaced BASE node, which reverting brings
+     back. */
+  if (have_base && status != svn_wc__db_status_normal)
+    {
+      svn_wc__db_status_t base_status;
+      svn_node_kind_t base_kind;
+      svn_revnum_t revision;
+      const char *repos_relpath;
+      const char *repos_root_url;
+      const svn_checksum_t *base_checksum;
+
+      SVN_ERR(svn_wc__db_base_get_info(&base_status, &base_kind, &revision,
+                                       &repos_relpath, &repos_root_url,
+                                       NULL, NULL, NULL, NULL, NULL,
+                                       &base_checksum, NULL, NULL, NULL, NULL,
+                                       NULL, sb->db, local_abspath,
+                                       scratch_pool, scratch_pool));
+
+      if (base_status == svn_wc__db_status_normal
+          && base_kind == svn_node_file && base_checksum
+          && !(checksum && svn_checksum_match(checksum, base_checksum)))
+        {
+          SVN_ERR(svn_wc__db_pristine_check(&present, sb->db, local_abspath,
+                                            base_checksum, scratch_pool));
+          if (!present)
+            SVN_ERR(fetch_text(sb, local_abspath, base_checksum,
+                               repos_root_url, repos_relpath, revision,
+                               scratch_pool));
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__textbase_sync(svn_wc_context_t *wc_ctx,
+                      const char *local_abspath,
+                      svn_depth_t depth,
+                      svn_wc__textbase_fetch_cb_t fetch_func,
+                      void *fetch_baton,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool)
+{
+  struct sync_baton_t sb;
+  svn_boolean_t pristines_on_demand;
+
+  /* Without dehydration, all texts are there already. */
+  SVN_ERR(svn_wc__db_get_pristines_on_demand(&pristines_on_demand,
+                                             wc_ctx->db, local_abspath,
+                                             scratch_pool));
+  if (!pristines_on_demand)
+    return SVN_NO_ERROR;
+
+  sb.db = wc_ctx->db;
+  sb.fetch_func = fetch_func;
+  sb.fetch_baton = fetch_baton;
+  sb.cancel_func = cancel_func;
+  sb.cancel_baton = cancel_baton;
+
+  return svn_error_trace(svn_wc__internal_walk_children(
+                           wc_ctx->db, local_abspath, FALSE, NULL,
+                           sync_node, &sb, depth,
+                           cancel_func, cancel_baton, scratch_pool));
+}
@@ -0,0 +1,80 @@
+/*
+ * textbase.h :  keeping pristine texts only where they are needed
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+#ifndef SVN_LIBSVN_WC_TEXTBASE_H
+#define SVN_LIBSVN_WC_TEXTBASE_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+#include "svn_checksum.h"
+
+#include "wc_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+/* A working copy that keeps pristines on demand, as recorded in its
+   SETTINGS table (see svn_wc__db_get_pristines_on_demand()), drops the
+   pristine text of a file from its store once the file is installed from
+   it.  The text's row and references stay, so the text is "dehydrated":
+   wc_db knows it but can't read it.
+
+   As long as the working file is unmodified, it holds the text in
+   working copy form, and svn_wc__textbase_restore() puts it back from
+   there.  Texts of modified files have to be fetched from the repository
+   with svn_wc__textbase_sync() before an operation that needs them. */
+
+/* If the pristine text SHA1_CHECKSUM of the file LOCAL_ABSPATH in DB is
+   dehydrated, put it back into the pristine store from the working file.
+   Return SVN_ERR_WC_PRISTINE_DEHYDRATED if the working file is missing or
+   doesn't hold that text.
+
+   If RESTORED is not NULL, set *RESTORED to whether the text had to be
+   put back.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__textbase_restore(svn_boolean_t *restored,
+                         svn_wc__db_t *db,
+                         const char *local_abspath,
+                         const svn_checksum_t *sha1_checksum,
+                         apr_pool_t *scratch_pool);
+
+/* If DB keeps pristines on demand, dehydrate the pristine text
+   SHA1_CHECKSUM of the file LOCAL_ABSPATH, which was just installed from
+   it.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__textbase_dehydrate(svn_wc__db_t *db,
+                           const char *local_abspath,
+                           const svn_checksum_t *sha1_checksum,
+                           apr_pool_t *scratch_pool);
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_LIBSVN_WC_TEXTBASE_H */
@@ -46,6 +46,7 @@
 #include "wc.h"
 #include "adm_files.h"
 #include "conflicts.h"
+#include "textbase.h"
 #include "translate.h"
 #include "workqueue.h"
 
@@ -261,9 +262,37 @@ struct edit_baton
   /* After closing the root directory a copy of its edited value */
   svn_boolean_t edited;
 
+  /* The number of files recorded in the current batch of database
+     changes, see batch_file(). */
+  int batched_files;
+
   apr_pool_t *pool;
 };
 
+/* The maximum number of files whose changes are committed to the
+   database together. */
+#define MAX_BATCHED_FILES 1000
+
+/* Make recording the file that is being closed in edit EB part of a batch
+   of database changes, see svn_wc__db_begin_batch().  The batch is
+   committed before the work queue is run, or when it gets too large. */
+static svn_error_t *
+batch_file(struct edit_baton *eb,
+           apr_pool_t *scratch_pool)
+{
+  if (eb->batched_files >= MAX_BATCHED_FILES)
+    {
+      SVN_ERR(svn_wc__db_finish_batch(eb->db, eb->wcroot_abspath,
+                                      scratch_pool));
+      eb->batched_files = 0;
+    }
+
+  SVN_ERR(svn_wc__db_begin_batch(eb->db, eb->wcroot_abspath, scratch_pool));
+  eb->batched_files++;
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Record in the edit baton EB that LOCAL_ABSPATH's base version is not being
  * updated.
@@ -2187,7 +2216,9 @@ add_directory(const char *path,
                                      scratch_pool));
 
   /* Make sure there is a real directory at LOCAL_ABSPATH, unless we are just
-     updating the DB */
+     updating the DB, and that the DB knows about it first. */
+  SVN_ERR(svn_wc__db_finish_batch(eb->db, eb->wcroot_abspath, scratch_pool));
+  eb->batched_files = 0;
   if (!db->shadowed)
     SVN_ERR(svn_wc__ensure_directory(db->local_abspath, scratch_pool));
 
@@ -3569,6 +3600,10 @@ lazy_open_source(svn_stream_t **stream,
 {
   struct file_baton *fb = baton;
 
+  /* An unmodified file can stand in for its dehydrated text. */
+  SVN_ERR(svn_wc__textbase_restore(NULL, fb->edit_baton->db,
+                                   fb->local_abspath,
+                                   fb->original_checksum, scratch_pool));
   SVN_ERR(svn_wc__db_pristine_read(stream, NULL, fb->edit_baton->db,
                                    fb->local_abspath,
                                    fb->original_checksum,
@@ -4558,6 +4593,7 @@ close_file(void *file_baton,
         svn_hash_sets(eb->wcroot_iprops, fb->local_abspath, NULL);
     }
 
+  SVN_ERR(batch_file(eb, scratch_pool));
   SVN_ERR(svn_wc__db_base_add_file(eb->db, fb->local_abspath,
                                    eb->wcroot_abspath,
                                    fb->new_repos_relpath,
@@ -43,6 +43,7 @@
 #include "private/svn_wc_private.h"
 #include "private/svn_sqlite.h"
 #include "private/svn_token.h"
+#include "private/svn_io_private.h"
 
 /* WC-1.0 administrative area extensions */
 #define SVN_WC__BASE_EXT      ".svn-base" /* for text and prop bases */
@@ -1057,12 +1058,11 @@ migrate_text_bases(apr_hash_t **text_bases_info,
         SVN_ERR(svn_stream_open_readonly(&read_stream, text_base_path,
                                            iterpool, iterpool));
 
-        read_stream = svn_stream_checksummed2(read_stream, &md5_checksum,
-                                              NULL, svn_checksum_md5,
-                                              TRUE, iterpool);
-
-        read_stream = svn_stream_checksummed2(read_stream, &sha1_checksum,
-                                              NULL, svn_checksum_sha1,
+        read_stream = svn_stream__checksummed(read_stream,
+                                              &md5_checksum, &sha1_checksum,
+                                              NULL, NULL,
+                                              svn_checksum_md5,
+                                              svn_checksum_sha1,
                                               TRUE, iterpool);
 
         /* This calculates the hash, creates a copy and closes the stream */
@@ -1425,6 +1425,28 @@ bump_to_31(void *baton,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+bump_to_32(void *baton,
+           svn_sqlite__db_t *sdb,
+           apr_pool_t *scratch_pool)
+{
+  /* Record that the working copy keeps storing its pristines verbatim. */
+  SVN_ERR(svn_sqlite__exec_statements(sdb, STMT_UPGRADE_TO_32));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+bump_to_33(void *baton,
+           svn_sqlite__db_t *sdb,
+           apr_pool_t *scratch_pool)
+{
+  /* Record that the working copy keeps all its pristines. */
+  SVN_ERR(svn_sqlite__exec_statements(sdb, STMT_UPGRADE_TO_33));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 upgrade_apply_dav_cache(svn_sqlite__db_t *sdb,
                         const char *dir_relpath,
@@ -1686,6 +1708,18 @@ svn_wc__upgrade_sdb(int *result_format,
                                              scratch_pool));
         *result_format = 31;
         /* FALLTHROUGH  */
+
+      case 31:
+        SVN_ERR(svn_sqlite__with_transaction(sdb, bump_to_32, &bb,
+                                             scratch_pool));
+        *result_format = 32;
+        /* FALLTHROUGH  */
+
+      case 32:
+        SVN_ERR(svn_sqlite__with_transaction(sdb, bump_to_33, &bb,
+                                             scratch_pool));
+        *result_format = 33;
+        /* FALLTHROUGH  */
       /* ### future bumps go here.  */
 #if 0
       case XXX-1:
@@ -80,7 +80,8 @@ CREATE UNIQUE INDEX I_LOCAL_ABSPATH ON WCROOT (local_abspath);
    derived from the 'checksum' column.  Each pristine text is referenced by
    any number of rows in the NODES and ACTUAL_NODE tables.
 
-   In future, the pristine text file may be compressed.
+   The pristine text file may be compressed, see the 'compression' column
+   and SETTINGS.compress_pristines.
  */
 CREATE TABLE PRISTINE (
   /* The SHA-1 checksum of the pristine text. This is a unique key. The
@@ -88,12 +89,15 @@ CREATE TABLE PRISTINE (
      pristine texts referenced from this database. */
   checksum  TEXT NOT NULL PRIMARY KEY,
 
-  /* Enumerated values specifying type of compression. The only value
-     supported so far is NULL, meaning that no compression has been applied
-     and the pristine text is stored verbatim in the file. */
+  /* Enumerated values specifying type of compression.  NULL (or 0) means
+     that no compression has been applied and the pristine text is stored
+     verbatim in the file.  1 means that the file holds the text as zlib
+     data, as written by svn_stream_compressed(), and is named with the
+     extension '.svn-zbase' instead of '.svn-base'. (since 1.15) */
   compression  INTEGER,
 
-  /* The size in bytes of the file in which the pristine text is stored.
+  /* The size in bytes of the pristine text, which is also the size of the
+     file in which it is stored unless that is compressed.
      Used to verify the pristine file is "proper". */
   size  INTEGER NOT NULL,
 
@@ -563,6 +567,25 @@ CREATE UNIQUE INDEX I_EXTERNALS_DEFINED ON EXTERNALS (wc_id,
                                                       local_relpath);
 
 
+/* ------------------------------------------------------------------------- */
+
+/* The SETTINGS table records how a working copy stores its data.  The
+   choices are made when the working copy is created or upgraded, and
+   hold for all clients using it.  (since format 32) */
+CREATE TABLE SETTINGS (
+  wc_id  INTEGER NOT NULL PRIMARY KEY REFERENCES WCROOT (id),
+
+  /* Whether new pristine texts are stored compressed (1) or verbatim (0).
+     Existing texts keep their storage, see PRISTINE.compression. */
+  compress_pristines  INTEGER NOT NULL DEFAULT 0,
+
+  /* Whether the pristine texts of unmodified files are dropped from the
+     store once the files are installed (1), or always kept (0).  A dropped
+     text keeps its PRISTINE row but has no file.  (since format 33) */
+  pristines_on_demand  INTEGER NOT NULL DEFAULT 0
+  );
+
+
 PRAGMA user_version =
 -- define: SVN_WC__VERSION
 ;
@@ -699,9 +722,27 @@ WHERE l.op_depth = 0
 
 
 /* ------------------------------------------------------------------------- */
-/* Format 32 ....  */
-/* -- STMT_UPGRADE_TO_32
-PRAGMA user_version = 32; */
+/* Format 32 adds the SETTINGS table.  Upgraded working copies keep storing
+   their pristine texts verbatim. */
+-- STMT_UPGRADE_TO_32
+CREATE TABLE SETTINGS (
+  wc_id  INTEGER NOT NULL PRIMARY KEY REFERENCES WCROOT (id),
+  compress_pristines  INTEGER NOT NULL DEFAULT 0
+  );
+
+INSERT INTO SETTINGS (wc_id, compress_pristines)
+SELECT id, 0 FROM WCROOT;
+
+PRAGMA user_version = 32;
+
+
+/* ------------------------------------------------------------------------- */
+/* Format 33 records whether pristines are kept on demand.  Upgraded working
+   copies keep all their pristine texts. */
+-- STMT_UPGRADE_TO_33
+ALTER TABLE SETTINGS ADD COLUMN pristines_on_demand INTEGER NOT NULL DEFAULT 0;
+
+PRAGMA user_version = 33;
 
 
 /* ------------------------------------------------------------------------- */
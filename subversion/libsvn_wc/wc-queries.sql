@@ -466,6 +466,22 @@ WHERE wc_id = ?1 AND op_depth = 0
 INSERT INTO wcroot (local_abspath)
 VALUES (?1)
 
+-- STMT_INSERT_SETTINGS
+INSERT INTO settings (wc_id, compress_pristines, pristines_on_demand)
+VALUES (?1, ?2, ?3)
+
+-- STMT_SELECT_SETTINGS
+SELECT compress_pristines, pristines_on_demand FROM settings
+WHERE wc_id = ?1
+
+-- STMT_UPDATE_SETTINGS_COMPRESS_PRISTINES
+UPDATE settings SET compress_pristines = ?2
+WHERE wc_id = ?1
+
+-- STMT_UPDATE_SETTINGS_PRISTINES_ON_DEMAND
+UPDATE settings SET pristines_on_demand = ?2
+WHERE wc_id = ?1
+
 -- STMT_UPDATE_BASE_NODE_DAV_CACHE
 UPDATE nodes SET dav_cache = ?3
 WHERE wc_id = ?1 AND local_relpath = ?2 AND op_depth = 0
@@ -883,13 +899,17 @@ SELECT id, work FROM work_queue ORDER BY id LIMIT 1
 -- STMT_DELETE_WORK_ITEM
 DELETE FROM work_queue WHERE id = ?1
 
+-- STMT_SELECT_WORK_ITEMS_AFTER
+SELECT id, work FROM work_queue WHERE id > ?1 ORDER BY id LIMIT ?2
+
 -- STMT_INSERT_OR_IGNORE_PRISTINE
-INSERT OR IGNORE INTO pristine (checksum, md5_checksum, size, refcount)
-VALUES (?1, ?2, ?3, 0)
+INSERT OR IGNORE INTO pristine (checksum, md5_checksum, size, compression,
+                                refcount)
+VALUES (?1, ?2, ?3, ?4, 0)
 
 -- STMT_INSERT_PRISTINE
-INSERT INTO pristine (checksum, md5_checksum, size, refcount)
-VALUES (?1, ?2, ?3, 0)
+INSERT INTO pristine (checksum, md5_checksum, size, compression, refcount)
+VALUES (?1, ?2, ?3, ?4, 0)
 
 -- STMT_SELECT_PRISTINE
 SELECT md5_checksum
@@ -897,10 +917,14 @@ FROM pristine
 WHERE checksum = ?1
 
 -- STMT_SELECT_PRISTINE_SIZE
-SELECT size
+SELECT size, compression
 FROM pristine
 WHERE checksum = ?1 LIMIT 1
 
+-- STMT_UPDATE_PRISTINE_COMPRESSION
+UPDATE pristine SET compression = ?2
+WHERE checksum = ?1
+
 -- STMT_SELECT_PRISTINE_BY_MD5
 SELECT checksum
 FROM pristine
@@ -917,7 +941,7 @@ WHERE checksum = ?1 AND refcount = 0
 
 -- STMT_SELECT_COPY_PRISTINES
 /* For the root itself */
-SELECT n.checksum, md5_checksum, size
+SELECT n.checksum, md5_checksum, size, compression
 FROM nodes_current n
 LEFT JOIN pristine p ON n.checksum = p.checksum
 WHERE wc_id = ?1
@@ -925,7 +949,7 @@ WHERE wc_id = ?1
   AND n.checksum IS NOT NULL
 UNION ALL
 /* And all descendants */
-SELECT n.checksum, md5_checksum, size
+SELECT n.checksum, md5_checksum, size, compression
 FROM nodes n
 LEFT JOIN pristine p ON n.checksum = p.checksum
 WHERE wc_id = ?1
@@ -1598,6 +1622,23 @@ WHERE wc_id = ?1
   AND properties IS NOT NULL
 LIMIT 1
 
+-- STMT_SUBTREE_HAS_CONFLICTS
+SELECT 1 FROM actual_node
+WHERE wc_id = ?1
+  AND (local_relpath = ?2
+       OR IS_STRICT_DESCENDANT_OF(local_relpath, ?2))
+  AND conflict_data IS NOT NULL
+LIMIT 1
+
+-- STMT_SELECT_BASE_PRESENT_RECURSIVE
+SELECT local_relpath, kind, translated_size, last_mod_time
+FROM nodes
+WHERE wc_id = ?1
+  AND (local_relpath = ?2
+       OR IS_STRICT_DESCENDANT_OF(local_relpath, ?2))
+  AND op_depth = 0
+  AND presence = MAP_NORMAL
+
 -- STMT_HAS_SWITCHED
 SELECT 1
 FROM nodes
@@ -1807,6 +1848,39 @@ WHERE wc_id = ?1 AND repos_path = ?2 AND kind = ?3
                     AND w.local_relpath = n.local_relpath)
 ORDER BY local_relpath ASC
 
+/* The checksum cache remembers the SHA-1 checksum of the repository-normal
+   form of a working file, as last computed for the file with the given
+   size, timestamps and inode number.  It is created when first used and
+   not versioned with the schema: rows are only trusted when all of these
+   still match, and only tell whether the file matches its pristine. */
+-- STMT_CREATE_CHECKSUM_CACHE
+CREATE TABLE IF NOT EXISTS CHECKSUM_CACHE (
+  wc_id  INTEGER NOT NULL REFERENCES WCROOT (id),
+  local_relpath  TEXT NOT NULL,
+  size  INTEGER NOT NULL,
+  mtime  INTEGER NOT NULL,
+  ctime  INTEGER NOT NULL,
+  inode  INTEGER NOT NULL,
+  checksum  TEXT NOT NULL,
+  PRIMARY KEY (wc_id, local_relpath)
+  )
+
+-- STMT_SELECT_CHECKSUM_CACHE
+SELECT checksum FROM checksum_cache
+WHERE wc_id = ?1 AND local_relpath = ?2
+  AND size = ?3 AND mtime = ?4 AND ctime = ?5 AND inode = ?6
+
+-- STMT_INSERT_CHECKSUM_CACHE
+INSERT OR REPLACE INTO checksum_cache (wc_id, local_relpath, size, mtime,
+                                       ctime, inode, checksum)
+VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)
+
+-- STMT_DELETE_CHECKSUM_CACHE_ORPHANS
+DELETE FROM checksum_cache
+WHERE NOT EXISTS (SELECT 1 FROM nodes n
+                  WHERE n.wc_id = checksum_cache.wc_id
+                    AND n.local_relpath = checksum_cache.local_relpath)
+
 /* ------------------------------------------------------------------------- */
 
 /* Grab all the statements related to the schema.  */
@@ -161,10 +161,16 @@ extern "C" {
  * == 1.9.x shipped with format 31
  * == 1.10.x shipped with format 31
  *
+ * The bump to 32 added the SETTINGS table, which records whether new
+ * pristine texts are stored compressed.
+ *
+ * The bump to 33 added SETTINGS.pristines_on_demand, which records whether
+ * the pristine texts of unmodified files may be dropped.
+ *
  * Please document any further format changes here.
  */
 
-#define SVN_WC__VERSION 31
+#define SVN_WC__VERSION 33
 
 
 /* Formats <= this have no concept of "revert text-base/props".  */
@@ -196,6 +202,12 @@ extern "C" {
    sqlite_stat1 table on opening */
 #define SVN_WC__ENSURE_STAT1_TABLE 31
 
+/* A version < this has no SETTINGS table.  */
+#define SVN_WC__HAS_SETTINGS 32
+
+/* A version < this never drops pristine texts.  */
+#define SVN_WC__HAS_PRISTINES_ON_DEMAND 33
+
 /* Return a string indicating the released version (or versions) of
  * Subversion that used WC format number WC_FORMAT, or some other
  * suitable string if no released version used WC_FORMAT.
@@ -290,6 +302,7 @@ struct svn_wc_traversal_info_t
 #define SVN_WC__ADM_PRISTINE            "pristine"
 #define SVN_WC__ADM_NONEXISTENT_PATH    "nonexistent-path"
 #define SVN_WC__ADM_EXPERIMENTAL        "experimental"
+#define SVN_WC__ADM_FSMONITOR           "fsmonitor"
 
 /* The basename of the ".prej" file, if a directory ever has property
    conflicts.  This .prej file will appear *within* the conflicted
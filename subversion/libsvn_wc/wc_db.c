@@ -1365,6 +1365,8 @@ init_db(/* output values */
         const char *root_node_repos_relpath,
         svn_revnum_t root_node_revision,
         svn_depth_t root_node_depth,
+        svn_boolean_t compress_pristines,
+        svn_boolean_t pristines_on_demand,
         apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
@@ -1383,6 +1385,12 @@ init_db(/* output values */
   SVN_ERR(svn_sqlite__get_statement(&stmt, db, STMT_INSERT_WCROOT));
   SVN_ERR(svn_sqlite__insert(wc_id, stmt));
 
+  /* Record how this working copy stores its data. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, db, STMT_INSERT_SETTINGS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "idd", *wc_id, compress_pristines,
+                            pristines_on_demand));
+  SVN_ERR(svn_sqlite__insert(NULL, stmt));
+
   if (root_node_repos_relpath)
     {
       svn_wc__db_status_t status = svn_wc__db_status_normal;
@@ -1430,6 +1438,8 @@ create_db(svn_sqlite__db_t **sdb,
           const char *root_node_repos_relpath,
           svn_revnum_t root_node_revision,
           svn_depth_t root_node_depth,
+          svn_boolean_t compress_pristines,
+          svn_boolean_t pristines_on_demand,
           svn_boolean_t exclusive,
           apr_int32_t timeout,
           apr_pool_t *result_pool,
@@ -1444,7 +1454,8 @@ create_db(svn_sqlite__db_t **sdb,
   SVN_SQLITE__WITH_LOCK(init_db(repos_id, wc_id,
                                 *sdb, repos_root_url, repos_uuid,
                                 root_node_repos_relpath, root_node_revision,
-                                root_node_depth, scratch_pool),
+                                root_node_depth, compress_pristines,
+                                pristines_on_demand, scratch_pool),
                         *sdb);
 
   return SVN_NO_ERROR;
@@ -1486,7 +1497,9 @@ svn_wc__db_init(svn_wc__db_t *db,
   /* Create the SDB and insert the basic rows.  */
   SVN_ERR(create_db(&sdb, &repos_id, &wc_id, local_abspath, repos_root_url,
                     repos_uuid, SDB_FILE,
-                    repos_relpath, initial_rev, depth, sqlite_exclusive,
+                    repos_relpath, initial_rev, depth,
+                    db->compress_pristines, db->pristines_on_demand,
+                    sqlite_exclusive,
                     sqlite_timeout,
                     db->state_pool, scratch_pool));
 
@@ -6094,6 +6107,118 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
   return SVN_NO_ERROR;
 }
 
+/* Set *AVAILABLE to whether the CHECKSUM_CACHE table can be used in
+   WCROOT, creating it on first use.  A table that can't be created, e.g.
+   because the wc.db is read-only, just disables the cache. */
+static void
+ensure_checksum_cache(svn_boolean_t *available,
+                      svn_wc__db_wcroot_t *wcroot)
+{
+  if (wcroot->checksum_cache_table == svn_tristate_unknown)
+    {
+      svn_error_t *err;
+
+      err = svn_sqlite__exec_statements(wcroot->sdb,
+                                        STMT_CREATE_CHECKSUM_CACHE);
+      if (err)
+        {
+          svn_error_clear(err);
+          wcroot->checksum_cache_table = svn_tristate_false;
+        }
+      else
+        wcroot->checksum_cache_table = svn_tristate_true;
+    }
+
+  *available = (wcroot->checksum_cache_table == svn_tristate_true);
+}
+
+svn_error_t *
+svn_wc__db_checksum_cache_get(const svn_checksum_t **sha1_checksum,
+                              svn_wc__db_t *db,
+                              const char *local_abspath,
+                              svn_filesize_t size,
+                              apr_time_t mtime,
+                              apr_time_t ctime,
+                              apr_int64_t inode,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t available;
+  svn_boolean_t have_row;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  *sha1_checksum = NULL;
+
+  if (!db->checksum_cache)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  ensure_checksum_cache(&available, wcroot);
+  if (!available)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_CHECKSUM_CACHE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "isiiii", wcroot->wc_id, local_relpath,
+                            size, mtime, ctime, inode));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    {
+      svn_error_t *err = svn_sqlite__column_checksum(sha1_checksum, stmt, 0,
+                                                     result_pool);
+
+      if (err)
+        return svn_error_compose_create(err, svn_sqlite__reset(stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_checksum_cache_set(svn_wc__db_t *db,
+                              const char *local_abspath,
+                              svn_filesize_t size,
+                              apr_time_t mtime,
+                              apr_time_t ctime,
+                              apr_int64_t inode,
+                              const svn_checksum_t *sha1_checksum,
+                              apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t available;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+  SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
+
+  if (!db->checksum_cache)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  ensure_checksum_cache(&available, wcroot);
+  if (!available)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_INSERT_CHECKSUM_CACHE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "isiiii", wcroot->wc_id, local_relpath,
+                            size, mtime, ctime, inode));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 7, sha1_checksum, scratch_pool));
+
+  return svn_error_trace(svn_sqlite__step_done(stmt));
+}
+
 
 /* Set the ACTUAL_NODE properties column for (WC_ID, LOCAL_RELPATH) to
  * PROPS.
@@ -9170,6 +9295,313 @@ svn_wc__db_read_info_internal(svn_wc__db_status_t *status,
                      wcroot, local_relpath, result_pool, scratch_pool));
 }
 
+/* The node cache of a wcroot, see svn_wc__db_wcroot_t.
+
+   svn_wc__db_read_children_info() records what it reads about every child
+   here, in the shape read_info() returns it, so that the single node reads
+   which typically follow the bulk read of a directory (by info, diff,
+   conflict resolution, ...) don't have to query the database again.
+
+   Any write through the wcroot's database connection and any roll back of
+   a transaction or savepoint in it invalidates the whole cache.  Like the
+   rest of the state of an svn_wc__db_t it doesn't notice changes made
+   through other connections. */
+struct svn_wc__db_node_cache_t
+{
+  /* The pool everything below is allocated in; cleared on invalidation. */
+  apr_pool_t *pool;
+
+  /* const char *local_relpath -> struct node_cache_entry_t * */
+  apr_hash_t *nodes;
+
+  /* apr_int64_t repos_id -> struct node_cache_repos_t * */
+  apr_hash_t *repos;
+
+  /* The svn_sqlite__change_stamp() of the wcroot's database that the
+     above reflect. */
+  apr_int64_t stamp;
+};
+
+/* The number of nodes a node cache may grow to, before it is emptied by the
+   next bulk read.  This bounds its memory use on recursive operations on
+   large trees. */
+#define NODE_CACHE_MAX_NODES 16384
+
+/* What read_info() would return for a node, less the REPOS_ID
+   translation. */
+struct node_cache_entry_t
+{
+  /* The op-depth of the topmost layer of the node; all of the following
+     up to LOCK are read from that layer. */
+  int op_depth;
+
+  svn_wc__db_status_t status;
+  svn_node_kind_t kind;
+  apr_int64_t repos_id;
+  svn_revnum_t revision;
+  const char *repos_relpath;
+  svn_revnum_t changed_rev;
+  apr_time_t changed_date;
+  const char *changed_author;
+  svn_depth_t depth;
+  const svn_checksum_t *checksum;
+  const char *target;
+  svn_filesize_t recorded_size;
+  apr_time_t recorded_time;
+  svn_boolean_t had_props;
+
+  /* The lock of the node, if its topmost layer is BASE. */
+  svn_wc__db_lock_t *lock;
+
+  /* Whether there is a BASE layer and the number of WORKING layers. */
+  svn_boolean_t have_base;
+  int nr_layers;
+
+  /* From ACTUAL_NODE. */
+  const char *changelist;
+  svn_boolean_t props_mod;
+  svn_boolean_t conflicted;
+};
+
+/* A REPOSITORY row, as cached in a node cache. */
+struct node_cache_repos_t
+{
+  const char *repos_root_url;
+  const char *repos_uuid;
+};
+
+/* Return the node cache of WCROOT, after emptying it if it is out of date.
+   If WCROOT has no node cache, return NULL if CREATE is FALSE, or create
+   one in STATE_POOL otherwise.  If CREATE is TRUE, also empty the cache
+   if it is full. */
+static struct svn_wc__db_node_cache_t *
+node_cache_get(svn_wc__db_wcroot_t *wcroot,
+               svn_boolean_t create,
+               apr_pool_t *state_pool)
+{
+  struct svn_wc__db_node_cache_t *cache = wcroot->node_cache;
+  apr_int64_t stamp = svn_sqlite__change_stamp(wcroot->sdb);
+
+  if (!cache)
+    {
+      if (!create)
+        return NULL;
+
+      cache = apr_pcalloc(state_pool, sizeof(*cache));
+      cache->pool = svn_pool_create(state_pool);
+      wcroot->node_cache = cache;
+    }
+  else if (cache->stamp == stamp
+           && (!create || apr_hash_count(cache->nodes) < NODE_CACHE_MAX_NODES))
+    return cache;
+  else
+    svn_pool_clear(cache->pool);
+
+  cache->nodes = apr_hash_make(cache->pool);
+  cache->repos = apr_hash_make(cache->pool);
+  cache->stamp = stamp;
+
+  return cache;
+}
+
+/* Create *ENTRY in RESULT_POOL from the topmost row of a node as returned by
+   STMT_SELECT_NODE_CHILDREN_INFO in STMT.  OP_DEPTH, STATUS and KIND are
+   read from that row already. */
+static svn_error_t *
+node_cache_entry_from_row(struct node_cache_entry_t **entry,
+                          svn_sqlite__stmt_t *stmt,
+                          int op_depth,
+                          svn_wc__db_status_t status,
+                          svn_node_kind_t kind,
+                          apr_pool_t *result_pool)
+{
+  struct node_cache_entry_t *ce = apr_pcalloc(result_pool, sizeof(*ce));
+
+  ce->op_depth = op_depth;
+  ce->status = status;
+  ce->kind = kind;
+  repos_location_from_columns(&ce->repos_id, &ce->revision,
+                              &ce->repos_relpath, stmt, 1, 5, 2, result_pool);
+  ce->changed_rev = svn_sqlite__column_revnum(stmt, 8);
+  ce->changed_date = svn_sqlite__column_int64(stmt, 9);
+  ce->changed_author = svn_sqlite__column_text(stmt, 10, result_pool);
+
+  if (kind == svn_node_dir)
+    ce->depth = svn_sqlite__column_token_null(stmt, 11, depth_map,
+                                              svn_depth_unknown);
+  else
+    ce->depth = svn_depth_unknown;
+
+  if (kind == svn_node_file)
+    SVN_ERR(svn_sqlite__column_checksum(&ce->checksum, stmt, 6,
+                                        result_pool));
+
+  if (kind == svn_node_symlink)
+    ce->target = svn_sqlite__column_text(stmt, 12, result_pool);
+
+  ce->recorded_size = get_recorded_size(stmt, 7);
+  ce->recorded_time = svn_sqlite__column_int64(stmt, 13);
+  ce->had_props = SQLITE_PROPERTIES_AVAILABLE(stmt, 14);
+
+  if (op_depth == 0)
+    ce->lock = lock_from_columns(stmt, 15, 16, 17, 18, result_pool);
+
+  *entry = ce;
+  return SVN_NO_ERROR;
+}
+
+/* Like svn_wc__db_fetch_repos_info(), but looking in CACHE first and
+   recording what it had to read from WCROOT there. */
+static svn_error_t *
+node_cache_fetch_repos_info(const char **repos_root_url,
+                            const char **repos_uuid,
+                            struct svn_wc__db_node_cache_t *cache,
+                            svn_wc__db_wcroot_t *wcroot,
+                            apr_int64_t repos_id,
+                            apr_pool_t *result_pool)
+{
+  struct node_cache_repos_t *repos;
+
+  if ((!repos_root_url && !repos_uuid) || repos_id == INVALID_REPOS_ID)
+    return svn_error_trace(svn_wc__db_fetch_repos_info(repos_root_url,
+                                                       repos_uuid, wcroot,
+                                                       repos_id,
+                                                       result_pool));
+
+  repos = apr_hash_get(cache->repos, &repos_id, sizeof(repos_id));
+  if (!repos)
+    {
+      apr_int64_t *key = apr_pmemdup(cache->pool, &repos_id, sizeof(*key));
+
+      repos = apr_pcalloc(cache->pool, sizeof(*repos));
+      SVN_ERR(svn_wc__db_fetch_repos_info(&repos->repos_root_url,
+                                          &repos->repos_uuid, wcroot,
+                                          repos_id, cache->pool));
+      apr_hash_set(cache->repos, key, sizeof(*key), repos);
+    }
+
+  if (repos_root_url)
+    *repos_root_url = apr_pstrdup(result_pool, repos->repos_root_url);
+  if (repos_uuid)
+    *repos_uuid = apr_pstrdup(result_pool, repos->repos_uuid);
+
+  return SVN_NO_ERROR;
+}
+
+/* Like svn_wc__db_read_info(), but answering from ENTRY, found for
+   LOCAL_RELPATH in the node cache CACHE of WCROOT. */
+static svn_error_t *
+read_info_from_cache(svn_wc__db_status_t *status,
+                     svn_node_kind_t *kind,
+                     svn_revnum_t *revision,
+                     const char **repos_relpath,
+                     const char **repos_root_url,
+                     const char **repos_uuid,
+                     svn_revnum_t *changed_rev,
+                     apr_time_t *changed_date,
+                     const char **changed_author,
+                     svn_depth_t *depth,
+                     const svn_checksum_t **checksum,
+                     const char **target,
+                     const char **original_repos_relpath,
+                     const char **original_root_url,
+                     const char **original_uuid,
+                     svn_revnum_t *original_revision,
+                     svn_wc__db_lock_t **lock,
+                     svn_filesize_t *recorded_size,
+                     apr_time_t *recorded_time,
+                     const char **changelist,
+                     svn_boolean_t *conflicted,
+                     svn_boolean_t *op_root,
+                     svn_boolean_t *have_props,
+                     svn_boolean_t *props_mod,
+                     svn_boolean_t *have_base,
+                     svn_boolean_t *have_more_work,
+                     svn_boolean_t *have_work,
+                     const struct node_cache_entry_t *entry,
+                     struct svn_wc__db_node_cache_t *cache,
+                     svn_wc__db_wcroot_t *wcroot,
+                     const char *local_relpath,
+                     apr_pool_t *result_pool)
+{
+  svn_boolean_t is_working = (entry->op_depth != 0);
+
+  if (status)
+    *status = entry->status;
+  if (kind)
+    *kind = entry->kind;
+  if (revision)
+    *revision = is_working ? SVN_INVALID_REVNUM : entry->revision;
+  if (repos_relpath)
+    *repos_relpath = is_working ? NULL
+                                : apr_pstrdup(result_pool,
+                                              entry->repos_relpath);
+  SVN_ERR(node_cache_fetch_repos_info(repos_root_url, repos_uuid, cache,
+                                      wcroot,
+                                      is_working ? INVALID_REPOS_ID
+                                                 : entry->repos_id,
+                                      result_pool));
+  if (changed_rev)
+    *changed_rev = entry->changed_rev;
+  if (changed_date)
+    *changed_date = entry->changed_date;
+  if (changed_author)
+    *changed_author = apr_pstrdup(result_pool, entry->changed_author);
+  if (depth)
+    *depth = entry->depth;
+  if (checksum)
+    *checksum = svn_checksum_dup(entry->checksum, result_pool);
+  if (target)
+    *target = apr_pstrdup(result_pool, entry->target);
+  if (original_repos_relpath)
+    *original_repos_relpath = is_working
+                                ? apr_pstrdup(result_pool,
+                                              entry->repos_relpath)
+                                : NULL;
+  SVN_ERR(node_cache_fetch_repos_info(original_root_url, original_uuid,
+                                      cache, wcroot,
+                                      is_working ? entry->repos_id
+                                                 : INVALID_REPOS_ID,
+                                      result_pool));
+  if (original_revision)
+    *original_revision = is_working ? entry->revision : SVN_INVALID_REVNUM;
+  if (lock)
+    {
+      if (entry->lock && !is_working)
+        {
+          *lock = apr_pmemdup(result_pool, entry->lock, sizeof(**lock));
+          (*lock)->token = apr_pstrdup(result_pool, entry->lock->token);
+          (*lock)->owner = apr_pstrdup(result_pool, entry->lock->owner);
+          (*lock)->comment = apr_pstrdup(result_pool, entry->lock->comment);
+        }
+      else
+        *lock = NULL;
+    }
+  if (recorded_size)
+    *recorded_size = entry->recorded_size;
+  if (recorded_time)
+    *recorded_time = entry->recorded_time;
+  if (changelist)
+    *changelist = apr_pstrdup(result_pool, entry->changelist);
+  if (conflicted)
+    *conflicted = entry->conflicted;
+  if (op_root)
+    *op_root = (is_working
+                && entry->op_depth == relpath_depth(local_relpath));
+  if (have_props)
+    *have_props = entry->had_props;
+  if (props_mod)
+    *props_mod = entry->props_mod;
+  if (have_base)
+    *have_base = entry->have_base;
+  if (have_more_work)
+    *have_more_work = (entry->nr_layers > 1);
+  if (have_work)
+    *have_work = is_working;
+
+  return SVN_NO_ERROR;
+}
+
 
 svn_error_t *
 svn_wc__db_read_info(svn_wc__db_status_t *status,
@@ -9214,6 +9646,25 @@ svn_wc__db_read_info(svn_wc__db_status_t *status,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  if (wcroot->node_cache)
+    {
+      struct svn_wc__db_node_cache_t *cache = node_cache_get(wcroot, FALSE,
+                                                             NULL);
+      const struct node_cache_entry_t *entry = svn_hash_gets(cache->nodes,
+                                                             local_relpath);
+
+      if (entry)
+        return svn_error_trace(read_info_from_cache(
+                    status, kind, revision, repos_relpath, repos_root_url,
+                    repos_uuid, changed_rev, changed_date, changed_author,
+                    depth, checksum, target, original_repos_relpath,
+                    original_root_url, original_uuid, original_revision,
+                    lock, recorded_size, recorded_time, changelist,
+                    conflicted, op_root, have_props, props_mod, have_base,
+                    have_more_work, have_work,
+                    entry, cache, wcroot, local_relpath, result_pool));
+    }
+
   SVN_WC__DB_WITH_TXN4(
           read_info(status, kind, revision, repos_relpath, &repos_id,
                     changed_rev, changed_date, changed_author,
@@ -9269,15 +9720,23 @@ struct read_children_info_item_t
   int op_depth;
   int nr_layers;
   svn_boolean_t was_dir;
+
+  /* What we store about the node in the node cache, or NULL. */
+  struct node_cache_entry_t *cached;
 };
 
-/* Implementation of svn_wc__db_read_children_info */
+/* Implementation of svn_wc__db_read_children_info.
+
+   If CACHE_NODES is not NULL, also add a node cache entry allocated in
+   CACHE_POOL for every child node to it, keyed by its local_relpath. */
 static svn_error_t *
 read_children_info(svn_wc__db_wcroot_t *wcroot,
                    const char *dir_relpath,
                    apr_hash_t *conflicts,
                    apr_hash_t *nodes,
                    svn_boolean_t base_tree_only,
+                   apr_hash_t *cache_nodes,
+                   apr_pool_t *cache_pool,
                    apr_pool_t *result_pool,
                    apr_pool_t *scratch_pool)
 {
@@ -9440,6 +9899,19 @@ read_children_info(svn_wc__db_wcroot_t *wcroot,
           if (op_depth && child->op_root)
             child_item->info.moved_here = svn_sqlite__column_boolean(stmt, 20);
 
+          if (cache_nodes)
+            {
+              err = node_cache_entry_from_row(&child_item->cached, stmt,
+                                              op_depth, child->status,
+                                              child->kind, cache_pool);
+              if (err)
+                SVN_ERR(svn_error_compose_create(err, svn_sqlite__reset(stmt)));
+
+              svn_hash_sets(cache_nodes,
+                            apr_pstrdup(cache_pool, child_relpath),
+                            child_item->cached);
+            }
+
           if (new_child)
             svn_hash_sets(nodes, apr_pstrdup(result_pool, name), child);
         }
@@ -9466,6 +9938,9 @@ read_children_info(svn_wc__db_wcroot_t *wcroot,
           /* FILE_EXTERNAL flag only on op_depth 0. */
           child_item->info.file_external = svn_sqlite__column_boolean(stmt,
                                                                       22);
+
+          if (child_item->cached)
+            child_item->cached->have_base = TRUE;
         }
       else
         {
@@ -9474,6 +9949,9 @@ read_children_info(svn_wc__db_wcroot_t *wcroot,
           child_item->nr_layers++;
           child_item->info.have_more_work = (child_item->nr_layers > 1);
 
+          if (child_item->cached)
+            child_item->cached->nr_layers = child_item->nr_layers;
+
 
           /* A local_relpath can be moved multiple times at different op
              depths and it really depends on the caller what is interesting.
@@ -9559,6 +10037,14 @@ read_children_info(svn_wc__db_wcroot_t *wcroot,
           /* conflict */
           child->conflicted = !svn_sqlite__column_is_null(stmt, 3);
 
+          if (child_item->cached)
+            {
+              child_item->cached->changelist = apr_pstrdup(cache_pool,
+                                                           child->changelist);
+              child_item->cached->props_mod = child->props_mod;
+              child_item->cached->conflicted = child->conflicted;
+            }
+
           if (child->conflicted)
             svn_hash_sets(conflicts, apr_pstrdup(result_pool, name), "");
 
@@ -9582,6 +10068,8 @@ svn_wc__db_read_children_info(apr_hash_t **nodes,
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *dir_relpath;
+  struct svn_wc__db_node_cache_t *cache = NULL;
+  apr_hash_t *cache_nodes = NULL;
 
   *conflicts = apr_hash_make(result_pool);
   *nodes = apr_hash_make(result_pool);
@@ -9592,11 +10080,31 @@ svn_wc__db_read_children_info(apr_hash_t **nodes,
                                                 scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  if (!base_tree_only)
+    {
+      cache = node_cache_get(wcroot, TRUE, db->state_pool);
+      cache_nodes = apr_hash_make(scratch_pool);
+    }
+
   SVN_WC__DB_WITH_TXN(
     read_children_info(wcroot, dir_relpath, *conflicts, *nodes,
-                       base_tree_only, result_pool, scratch_pool),
+                       base_tree_only, cache_nodes,
+                       cache ? cache->pool : NULL,
+                       result_pool, scratch_pool),
     wcroot);
 
+  /* Only keep what we read if it is still current. */
+  if (cache && cache->stamp == svn_sqlite__change_stamp(wcroot->sdb))
+    {
+      apr_hash_index_t *hi;
+
+      for (hi = apr_hash_first(scratch_pool, cache_nodes);
+           hi;
+           hi = apr_hash_next(hi))
+        svn_hash_sets(cache->nodes, apr_hash_this_key(hi),
+                      apr_hash_this_val(hi));
+    }
+
   return SVN_NO_ERROR;
 }
 
@@ -13332,6 +13840,8 @@ svn_wc__db_upgrade_begin(svn_sqlite__db_t **sdb,
                     repos_root_url, repos_uuid,
                     SDB_FILE,
                     NULL, SVN_INVALID_REVNUM, svn_depth_unknown,
+                    FALSE /* compress_pristines */,
+                    FALSE /* pristines_on_demand */,
                     TRUE /* exclusive */,
                     0 /* timeout */,
                     wc_db->state_pool, scratch_pool));
@@ -13533,6 +14043,183 @@ svn_wc__db_wq_fetch_next(apr_uint64_t *id,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__db_wq_peek(apr_array_header_t **items,
+                   svn_wc__db_t *db,
+                   const char *wri_abspath,
+                   apr_uint64_t after_id,
+                   int limit,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  *items = apr_array_make(result_pool, limit,
+                          sizeof(svn_wc__db_wq_item_t *));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_WORK_ITEMS_AFTER));
+  SVN_ERR(svn_sqlite__bindf(stmt, "id", (apr_int64_t)after_id, limit));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      svn_wc__db_wq_item_t *item = apr_palloc(result_pool, sizeof(*item));
+      apr_size_t len;
+      const void *val;
+
+      item->id = svn_sqlite__column_int64(stmt, 0);
+      val = svn_sqlite__column_blob(stmt, 1, &len, result_pool);
+      item->work_item = svn_skel__parse(val, len, result_pool);
+
+      APR_ARRAY_PUSH(*items, svn_wc__db_wq_item_t *) = item;
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_begin_batch(svn_wc__db_t *db,
+                       const char *wri_abspath,
+                       apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  return svn_error_trace(svn_sqlite__begin_batch(wcroot->sdb));
+}
+
+svn_error_t *
+svn_wc__db_finish_batch(svn_wc__db_t *db,
+                        const char *wri_abspath,
+                        apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  return svn_error_trace(svn_sqlite__finish_batch(wcroot->sdb,
+                                                  SVN_NO_ERROR));
+}
+
+int
+svn_wc__db_get_install_jobs(svn_wc__db_t *db)
+{
+  return db->install_jobs;
+}
+
+int
+svn_wc__db_get_status_jobs(svn_wc__db_t *db)
+{
+  return db->status_jobs;
+}
+
+const char *
+svn_wc__db_get_fsmonitor(svn_wc__db_t *db)
+{
+  return db->fsmonitor;
+}
+
+svn_error_t *
+svn_wc__db_set_compress_pristines(svn_wc__db_t *db,
+                                  const char *wri_abspath,
+                                  svn_boolean_t compress_pristines,
+                                  apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_UPDATE_SETTINGS_COMPRESS_PRISTINES));
+  SVN_ERR(svn_sqlite__bindf(stmt, "id", wcroot->wc_id, compress_pristines));
+  SVN_ERR(svn_sqlite__update(NULL, stmt));
+
+  wcroot->compress_pristines = compress_pristines;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_get_pristines_on_demand(svn_boolean_t *pristines_on_demand,
+                                   svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  *pristines_on_demand = wcroot->pristines_on_demand;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_set_pristines_on_demand(svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   svn_boolean_t pristines_on_demand,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_UPDATE_SETTINGS_PRISTINES_ON_DEMAND));
+  SVN_ERR(svn_sqlite__bindf(stmt, "id", wcroot->wc_id, pristines_on_demand));
+  SVN_ERR(svn_sqlite__update(NULL, stmt));
+
+  wcroot->pristines_on_demand = pristines_on_demand;
+
+  return SVN_NO_ERROR;
+}
+
+svn_boolean_t
+svn_wc__db_get_checksum_cache(svn_wc__db_t *db)
+{
+  return db->checksum_cache;
+}
+
 /* Records timestamp and date for one or more files in wcroot */
 static svn_error_t *
 wq_record(svn_wc__db_wcroot_t *wcroot,
@@ -15679,6 +16366,103 @@ svn_wc__db_has_db_mods(svn_boolean_t *is_modified,
 }
 
 
+svn_error_t *
+svn_wc__db_check_base_files(svn_boolean_t *is_modified,
+                            apr_array_header_t **candidates,
+                            svn_wc__db_t *db,
+                            const char *local_abspath,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath,
+                                                db, local_abspath,
+                                                scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  *candidates = apr_array_make(result_pool, 0, sizeof(const char *));
+
+  /* Conflicts count as modifications, just like in status. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SUBTREE_HAS_CONFLICTS));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step(is_modified, stmt));
+  SVN_ERR(svn_sqlite__reset(stmt));
+  if (*is_modified)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_BASE_PRESENT_RECURSIVE));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, local_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  iterpool = svn_pool_create(scratch_pool);
+  while (have_row && !*is_modified)
+    {
+      const char *node_relpath;
+      const char *node_abspath;
+      svn_node_kind_t kind;
+      const svn_io_dirent2_t *dirent;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        {
+          err = cancel_func(cancel_baton);
+          if (err)
+            break;
+        }
+
+      node_relpath = svn_sqlite__column_text(stmt, 0, NULL);
+      kind = svn_sqlite__column_token(stmt, 1, kind_map);
+      node_abspath = svn_dirent_join(wcroot->abspath, node_relpath,
+                                     iterpool);
+
+      err = svn_io_stat_dirent2(&dirent, node_abspath, FALSE, TRUE,
+                                iterpool, iterpool);
+      if (err)
+        break;
+
+      if (kind == svn_node_dir)
+        {
+          if (dirent->kind != svn_node_dir)
+            *is_modified = TRUE;
+        }
+      else if (dirent->kind != svn_node_file)
+        {
+          /* Missing or obstructed. */
+          *is_modified = TRUE;
+        }
+      else if (dirent->special
+               || svn_sqlite__column_is_null(stmt, 3)
+               || get_recorded_size(stmt, 2) != dirent->filesize
+               || svn_sqlite__column_int64(stmt, 3) != dirent->mtime)
+        {
+          APR_ARRAY_PUSH(*candidates, const char *)
+            = apr_pstrdup(result_pool, node_abspath);
+        }
+
+      err = svn_sqlite__step(&have_row, stmt);
+      if (err)
+        break;
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_error_compose_create(err,
+                                                  svn_sqlite__reset(stmt)));
+}
+
+
 /* The body of svn_wc__db_revision_status().
  */
 static svn_error_t *
@@ -16071,6 +16855,18 @@ svn_wc__db_vacuum(svn_wc__db_t *db,
   SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath,
                                                 db, local_abspath,
                                                 scratch_pool, scratch_pool));
+
+  /* Drop the remembered checksums of nodes that no longer exist. */
+  if (db->checksum_cache)
+    {
+      svn_boolean_t available;
+
+      ensure_checksum_cache(&available, wcroot);
+      if (available)
+        SVN_ERR(svn_sqlite__exec_statements(
+                  wcroot->sdb, STMT_DELETE_CHECKSUM_CACHE_ORPHANS));
+    }
+
   SVN_ERR(svn_sqlite__exec_statements(wcroot->sdb, STMT_VACUUM));
 
   return SVN_NO_ERROR;
@@ -905,6 +905,9 @@ svn_wc__db_base_get_lock_tokens_recursive(apr_hash_t **lock_tokens,
    ### This is temporary - callers should not be looking at the file
    directly.
 
+   If the text is stored compressed, the path is that of an uncompressed
+   copy, which is removed when RESULT_POOL is cleared.
+
    Allocate the path in RESULT_POOL. */
 svn_error_t *
 svn_wc__db_pristine_get_path(const char **pristine_abspath,
@@ -915,8 +918,8 @@ svn_wc__db_pristine_get_path(const char **pristine_abspath,
                              apr_pool_t *scratch_pool);
 
 /* Set *PRISTINE_ABSPATH to the path under WCROOT_ABSPATH that will be
-   used by the pristine text identified by SHA1_CHECKSUM.  The file
-   need not exist.
+   used by the pristine text identified by SHA1_CHECKSUM, if stored
+   uncompressed.  The file need not exist.
  */
 svn_error_t *
 svn_wc__db_pristine_get_future_path(const char **pristine_abspath,
@@ -925,6 +928,22 @@ svn_wc__db_pristine_get_future_path(const char **pristine_abspath,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* Set *PRISTINE_ABSPATH to the file that stores the pristine text
+   identified by SHA1_CHECKSUM in the WC of WRI_ABSPATH, and *COMPRESSED
+   to whether that file holds it as written by svn_stream_compressed().
+   If the text is not in the store, set both as for an uncompressed copy,
+   like svn_wc__db_pristine_get_future_path().  The file need not exist.
+
+   Allocate *PRISTINE_ABSPATH in RESULT_POOL. */
+svn_error_t *
+svn_wc__db_pristine_get_storage(const char **pristine_abspath,
+                                svn_boolean_t *compressed,
+                                svn_wc__db_t *db,
+                                const char *wri_abspath,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
 
 /* If requested set *CONTENTS to a readable stream that will yield the pristine
    text identified by SHA1_CHECKSUM (must be a SHA-1 checksum) within the WC
@@ -945,6 +964,19 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/* Set *CONTENTS to a readable stream of the pristine text identified by
+   SHA1_CHECKSUM in the shared pristine store configured for DB, or to NULL
+   if there is no such store or it doesn't have that text.  No working
+   copy is involved, so this works before one exists.
+
+   Allocate the stream in RESULT_POOL. */
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
 /* Baton for svn_wc__db_pristine_install */
 typedef struct svn_wc__db_install_data_t
                svn_wc__db_install_data_t;
@@ -1039,6 +1071,16 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
                            const svn_checksum_t *sha1_checksum,
                            apr_pool_t *scratch_pool);
 
+/* Remove the file of the pristine text with SHA-1 checksum SHA1_CHECKSUM
+ * from the pristine store for WRI_ABSPATH in DB, but keep the text's row
+ * and references.  Reading the text then fails with
+ * SVN_ERR_WC_PRISTINE_DEHYDRATED until it is installed again. */
+svn_error_t *
+svn_wc__db_pristine_dehydrate(svn_wc__db_t *db,
+                              const char *wri_abspath,
+                              const svn_checksum_t *sha1_checksum,
+                              apr_pool_t *scratch_pool);
+
 
 /* Remove all unreferenced pristines in the WC of WRI_ABSPATH in DB. */
 svn_error_t *
@@ -1048,7 +1090,8 @@ svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
 
 
 /* Set *PRESENT to true if the pristine store for WRI_ABSPATH in DB contains
-   a pristine text with SHA-1 checksum SHA1_CHECKSUM, and to false otherwise.
+   a pristine text with SHA-1 checksum SHA1_CHECKSUM, and to false otherwise,
+   which includes a dehydrated text.
 */
 svn_error_t *
 svn_wc__db_pristine_check(svn_boolean_t *present,
@@ -2662,6 +2705,39 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
                                   apr_time_t recorded_time,
                                   apr_pool_t *scratch_pool);
 
+/* Set *SHA1_CHECKSUM to the SHA-1 checksum of the repository-normal form
+   of the working file LOCAL_ABSPATH last stored with
+   svn_wc__db_checksum_cache_set() for exactly the same SIZE, MTIME, CTIME
+   and INODE, or to NULL if there is none or DB doesn't cache checksums.
+   Allocate *SHA1_CHECKSUM in RESULT_POOL.
+
+   Unlike the recorded fileinfo, a cached checksum stays valid when the
+   file's timestamp changes without its content: it then only has to be
+   read once to tell it still matches its pristine. */
+svn_error_t *
+svn_wc__db_checksum_cache_get(const svn_checksum_t **sha1_checksum,
+                              svn_wc__db_t *db,
+                              const char *local_abspath,
+                              svn_filesize_t size,
+                              apr_time_t mtime,
+                              apr_time_t ctime,
+                              apr_int64_t inode,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
+/* Remember SHA1_CHECKSUM as the checksum of the repository-normal form of
+   the working file LOCAL_ABSPATH while it has SIZE, MTIME, CTIME and
+   INODE.  Does nothing if DB doesn't cache checksums. */
+svn_error_t *
+svn_wc__db_checksum_cache_set(svn_wc__db_t *db,
+                              const char *local_abspath,
+                              svn_filesize_t size,
+                              apr_time_t mtime,
+                              apr_time_t ctime,
+                              apr_int64_t inode,
+                              const svn_checksum_t *sha1_checksum,
+                              apr_pool_t *scratch_pool);
+
 
 /* ### post-commit handling.
    ### maybe multiple phases?
@@ -3028,6 +3104,106 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* A work item as returned by svn_wc__db_wq_peek(). */
+typedef struct svn_wc__db_wq_item_t
+{
+  apr_uint64_t id;
+  svn_skel_t *work_item;
+} svn_wc__db_wq_item_t;
+
+/* Set *ITEMS to an array of up to LIMIT svn_wc__db_wq_item_t * for the
+   work items in the queue of the working copy at WRI_ABSPATH that follow
+   the item AFTER_ID, in the order in which they will be run.  The items
+   stay in the queue.
+
+   This allows callers to prepare upcoming work before it is their turn.
+
+   RESULT_POOL will be used to allocate *ITEMS, and SCRATCH_POOL
+   will be used for all temporary allocations.  */
+svn_error_t *
+svn_wc__db_wq_peek(apr_array_header_t **items,
+                   svn_wc__db_t *db,
+                   const char *wri_abspath,
+                   apr_uint64_t after_id,
+                   int limit,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool);
+
+/* Make the following changes of DB to the working copy containing
+   WRI_ABSPATH part of a batch, that only becomes durable once it is
+   finished by svn_wc__db_finish_batch(); see svn_sqlite__begin_batch().
+   Do nothing if a batch is open already.
+
+   Nothing may be done on disk on account of changes made in the batch
+   before it is finished.  svn_wc__wq_run() finishes the batch itself. */
+svn_error_t *
+svn_wc__db_begin_batch(svn_wc__db_t *db,
+                       const char *wri_abspath,
+                       apr_pool_t *scratch_pool);
+
+/* Commit the batch of changes of DB to the working copy containing
+   WRI_ABSPATH, if one is open. */
+svn_error_t *
+svn_wc__db_finish_batch(svn_wc__db_t *db,
+                        const char *wri_abspath,
+                        apr_pool_t *scratch_pool);
+
+/* Return the number of concurrent jobs that svn_wc__wq_run() may use
+   to prepare file installs in DB, as configured in the working-copy
+   section of its config. */
+int
+svn_wc__db_get_install_jobs(svn_wc__db_t *db);
+
+/* Return the number of concurrent jobs that status walks may use to
+   read file information in DB, as configured in the working-copy section
+   of its config. */
+int
+svn_wc__db_get_status_jobs(svn_wc__db_t *db);
+
+/* Return the file system monitor command configured in the working-copy
+   section of the config of DB, or NULL if there is none. */
+const char *
+svn_wc__db_get_fsmonitor(svn_wc__db_t *db);
+
+/* Record in the working copy containing WRI_ABSPATH whether new pristine
+   texts are stored compressed.  Pristines already in the store keep their
+   storage.
+
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__db_set_compress_pristines(svn_wc__db_t *db,
+                                  const char *wri_abspath,
+                                  svn_boolean_t compress_pristines,
+                                  apr_pool_t *scratch_pool);
+
+/* Set *PRISTINES_ON_DEMAND to whether the working copy containing
+   WRI_ABSPATH drops the pristine texts of files that match them once the
+   files are installed.
+
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__db_get_pristines_on_demand(svn_boolean_t *pristines_on_demand,
+                                   svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   apr_pool_t *scratch_pool);
+
+/* Record in the working copy containing WRI_ABSPATH whether it drops the
+   pristine texts of files that match them once the files are installed.
+   Texts already dropped stay dropped until they are fetched again.
+
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__db_set_pristines_on_demand(svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   svn_boolean_t pristines_on_demand,
+                                   apr_pool_t *scratch_pool);
+
+/* Return whether DB remembers the checksums of working files that turned
+   out to match their pristine, as configured in the working-copy section
+   of its config.  See svn_wc__db_checksum_cache_get(). */
+svn_boolean_t
+svn_wc__db_get_checksum_cache(svn_wc__db_t *db);
+
 
 /* @} */
 
@@ -3363,6 +3539,28 @@ svn_wc__db_has_db_mods(svn_boolean_t *is_modified,
                        const char *local_abspath,
                        apr_pool_t *scratch_pool);
 
+/* Compare the on-disk state of all present BASE nodes at or below
+ * LOCAL_ABSPATH in DB with their recorded sizes and timestamps, without
+ * reading any file contents.  Set *IS_MODIFIED if any of them is in
+ * conflict, missing or of a different kind on disk.  Otherwise, set
+ * *CANDIDATES to the absolute paths (const char *) of all files whose
+ * size or timestamp differs from the recorded values or that are special
+ * on disk, allocated in RESULT_POOL.
+ *
+ * This is only meaningful if svn_wc__db_has_db_mods() reported no changes
+ * for LOCAL_ABSPATH, i.e. if there are no WORKING nodes.  Unversioned
+ * nodes are ignored.  Call CANCEL_FUNC with CANCEL_BATON regularly.
+ * Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__db_check_base_files(svn_boolean_t *is_modified,
+                            apr_array_header_t **candidates,
+                            svn_wc__db_t *db,
+                            const char *local_abspath,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
 
 /* Verify the consistency of metadata concerning the WC that contains
  * WRI_ABSPATH, in DB.  Return an error if any problem is found. */
@@ -37,22 +37,31 @@
 #include "wc_db_private.h"
 
 #define PRISTINE_STORAGE_EXT ".svn-base"
+#define PRISTINE_COMPRESSED_EXT ".svn-zbase"
 #define PRISTINE_STORAGE_RELPATH "pristine"
 #define PRISTINE_TEMPDIR_RELPATH "tmp"
 
+/* The values of the PRISTINE.compression column.  A compressed pristine
+   text is stored as written by svn_stream_compressed(), in a file with
+   PRISTINE_COMPRESSED_EXT so that clients which don't know about it find
+   the text missing instead of reading garbage. */
+#define PRISTINE_COMPRESSION_NONE 0
+#define PRISTINE_COMPRESSION_ZLIB 1
 
 
 /* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
    holding the local absolute path to the file location that is dedicated
    to hold CHECKSUM's pristine file, relating to the pristine store
-   configured for the working copy indicated by PDH. The returned path
-   does not necessarily currently exist.
+   configured for the working copy indicated by PDH.  COMPRESSED says
+   whether that file holds the text compressed.  The returned path does
+   not necessarily currently exist.
 
    Any other allocations are made in SCRATCH_POOL. */
 static svn_error_t *
 get_pristine_fname(const char **pristine_abspath,
                    const char *wcroot_abspath,
                    const svn_checksum_t *sha1_checksum,
+                   svn_boolean_t compressed,
                    apr_pool_t *result_pool,
                    apr_pool_t *scratch_pool)
 {
@@ -80,7 +89,9 @@ get_pristine_fname(const char **pristine_abspath,
   subdir[1] = hexdigest[1];
   subdir[2] = '\0';
 
-  hexdigest = apr_pstrcat(scratch_pool, hexdigest, PRISTINE_STORAGE_EXT,
+  hexdigest = apr_pstrcat(scratch_pool, hexdigest,
+                          compressed ? PRISTINE_COMPRESSED_EXT
+                                     : PRISTINE_STORAGE_EXT,
                           SVN_VA_NULL);
 
   /* The file is located at DIR/.svn/pristine/XX/XXYYZZ...svn-base */
@@ -93,6 +104,113 @@ get_pristine_fname(const char **pristine_abspath,
 }
 
 
+/* Return the absolute path to the temporary directory for pristine text
+   files within WCROOT. */
+static char *
+pristine_get_tempdir(svn_wc__db_wcroot_t *wcroot,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  return svn_dirent_join_many(result_pool, wcroot->abspath,
+                              svn_wc_get_adm_dir(scratch_pool),
+                              PRISTINE_TEMPDIR_RELPATH, SVN_VA_NULL);
+}
+
+/* Set *COMPRESSED to whether the pristine text SHA1_CHECKSUM, whose
+   PRISTINE.compression value is in COLUMN of the current row of STMT,
+   is stored compressed. */
+static svn_error_t *
+column_compressed(svn_boolean_t *compressed,
+                  svn_sqlite__stmt_t *stmt,
+                  int column,
+                  const svn_checksum_t *sha1_checksum,
+                  apr_pool_t *scratch_pool)
+{
+  /* NULL, as written by older clients, reads as 0. */
+  int compression = svn_sqlite__column_int(stmt, column);
+
+  if (compression != PRISTINE_COMPRESSION_NONE
+      && compression != PRISTINE_COMPRESSION_ZLIB)
+    return svn_error_createf(SVN_ERR_WC_CORRUPT_TEXT_BASE, NULL,
+                             _("Pristine text '%s' uses unknown "
+                               "compression %d"),
+                             svn_checksum_to_cstring_display(sha1_checksum,
+                                                             scratch_pool),
+                             compression);
+
+  *compressed = (compression == PRISTINE_COMPRESSION_ZLIB);
+  return SVN_NO_ERROR;
+}
+
+/* Return the path of the pristine text SHA1_CHECKSUM in the shared
+   pristine store in SHARED_DIR, which is laid out like the pristine store
+   of a working copy.  Allocate the path in RESULT_POOL. */
+static const char *
+get_shared_fname(const char *shared_dir,
+                 const svn_checksum_t *sha1_checksum,
+                 apr_pool_t *result_pool)
+{
+  const char *hexdigest = svn_checksum_to_cstring(sha1_checksum,
+                                                  result_pool);
+
+  return svn_dirent_join_many(result_pool, shared_dir,
+                              apr_pstrmemdup(result_pool, hexdigest, 2),
+                              apr_pstrcat(result_pool, hexdigest,
+                                          PRISTINE_STORAGE_EXT, SVN_VA_NULL),
+                              SVN_VA_NULL);
+}
+
+/* Make TO_ABSPATH a hard link to the pristine text file FROM_ABSPATH,
+   creating the parent directory of TO_ABSPATH if needed.  If REPLACE,
+   remove an existing TO_ABSPATH first. */
+static svn_error_t *
+link_pristine(const char *from_abspath,
+              const char *to_abspath,
+              svn_boolean_t replace,
+              apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(to_abspath,
+                                                         scratch_pool),
+                                      scratch_pool));
+  if (replace)
+    SVN_ERR(svn_io_remove_file2(to_abspath, TRUE, scratch_pool));
+
+  return svn_error_trace(svn_io__file_link(from_abspath, to_abspath,
+                                           scratch_pool));
+}
+
+/* Set *STORAGE_ABSPATH to the file in the pristine store of WCROOT that
+   holds the pristine text SHA1_CHECKSUM, and *COMPRESSED to whether it
+   holds it compressed.  If the text is not in the store, set them for an
+   uncompressed copy.  Allocate *STORAGE_ABSPATH in RESULT_POOL. */
+static svn_error_t *
+get_pristine_storage(const char **storage_abspath,
+                     svn_boolean_t *compressed,
+                     svn_wc__db_wcroot_t *wcroot,
+                     const svn_checksum_t *sha1_checksum,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_PRISTINE_SIZE));
+  SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  *compressed = FALSE;
+  if (have_row)
+    err = column_compressed(compressed, stmt, 1, sha1_checksum, scratch_pool);
+  SVN_ERR(svn_error_compose_create(err, svn_sqlite__reset(stmt)));
+
+  return svn_error_trace(get_pristine_fname(storage_abspath, wcroot->abspath,
+                                            sha1_checksum, *compressed,
+                                            result_pool, scratch_pool));
+}
+
+
 svn_error_t *
 svn_wc__db_pristine_get_path(const char **pristine_abspath,
                              svn_wc__db_t *db,
@@ -104,6 +222,10 @@ svn_wc__db_pristine_get_path(const char **pristine_abspath,
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
   svn_boolean_t present;
+  const char *storage_abspath;
+  svn_boolean_t compressed;
+  svn_stream_t *src_stream;
+  svn_stream_t *dst_stream;
 
   SVN_ERR_ASSERT(pristine_abspath != NULL);
   SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
@@ -123,6 +245,25 @@ svn_wc__db_pristine_get_path(const char **pristine_abspath,
 
   SVN_ERR(svn_wc__db_pristine_check(&present, db, wri_abspath, sha1_checksum,
                                     scratch_pool));
+  if (! present)
+    {
+      svn_sqlite__stmt_t *stmt;
+      svn_boolean_t have_row;
+
+      SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                        STMT_SELECT_PRISTINE));
+      SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum,
+                                        scratch_pool));
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+      SVN_ERR(svn_sqlite__reset(stmt));
+
+      if (have_row)
+        return svn_error_createf(SVN_ERR_WC_PRISTINE_DEHYDRATED, NULL,
+                                 _("The pristine text with checksum '%s' "
+                                   "is not stored in the working copy"),
+                                 svn_checksum_to_cstring_display(
+                                   sha1_checksum, scratch_pool));
+    }
   if (! present)
     return svn_error_createf(SVN_ERR_WC_DB_ERROR, NULL,
                              _("The pristine text with checksum '%s' was "
@@ -130,13 +271,55 @@ svn_wc__db_pristine_get_path(const char **pristine_abspath,
                              svn_checksum_to_cstring_display(sha1_checksum,
                                                              scratch_pool));
 
-  SVN_ERR(get_pristine_fname(pristine_abspath, wcroot->abspath,
-                             sha1_checksum,
-                             result_pool, scratch_pool));
+  SVN_ERR(get_pristine_storage(&storage_abspath, &compressed, wcroot,
+                               sha1_checksum, result_pool, scratch_pool));
+  if (!compressed)
+    {
+      *pristine_abspath = storage_abspath;
+      return SVN_NO_ERROR;
+    }
+
+  /* Our callers hand the file to diff and merge code that can't read it
+     compressed, so give them a copy that lives as long as RESULT_POOL. */
+  SVN_ERR(svn_stream_open_readonly(&src_stream, storage_abspath,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(svn_stream_open_unique(&dst_stream, pristine_abspath,
+                                 pristine_get_tempdir(wcroot, scratch_pool,
+                                                      scratch_pool),
+                                 svn_io_file_del_on_pool_cleanup,
+                                 result_pool, scratch_pool));
+  SVN_ERR(svn_stream_copy3(svn_stream_compressed(src_stream, scratch_pool),
+                           dst_stream, NULL, NULL, scratch_pool));
 
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__db_pristine_get_storage(const char **pristine_abspath,
+                                svn_boolean_t *compressed,
+                                svn_wc__db_t *db,
+                                const char *wri_abspath,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+  SVN_ERR_ASSERT(sha1_checksum != NULL);
+  SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath,
+                                                db, wri_abspath,
+                                                scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  return svn_error_trace(get_pristine_storage(pristine_abspath, compressed,
+                                              wcroot, sha1_checksum,
+                                              result_pool, scratch_pool));
+}
+
 svn_error_t *
 svn_wc__db_pristine_get_future_path(const char **pristine_abspath,
                                     const char *wcroot_abspath,
@@ -145,16 +328,17 @@ svn_wc__db_pristine_get_future_path(const char **pristine_abspath,
                                     apr_pool_t *scratch_pool)
 {
   SVN_ERR(get_pristine_fname(pristine_abspath, wcroot_abspath,
-                             sha1_checksum,
+                             sha1_checksum, FALSE,
                              result_pool, scratch_pool));
   return SVN_NO_ERROR;
 }
 
 /* Set *CONTENTS to a readable stream from which the pristine text
- * identified by SHA1_CHECKSUM and PRISTINE_ABSPATH can be read from the
+ * identified by SHA1_CHECKSUM can be read from the
  * pristine store of WCROOT.  If SIZE is not null, set *SIZE to the size
  * in bytes of that text. If that text is not in the pristine store,
- * return an error.
+ * return an error; SVN_ERR_WC_PRISTINE_DEHYDRATED if only its file is
+ * missing.
  *
  * Even if the pristine text is removed from the store while it is being
  * read, the stream will remain valid and readable until it is closed.
@@ -170,12 +354,13 @@ pristine_read_txn(svn_stream_t **contents,
                   svn_filesize_t *size,
                   svn_wc__db_wcroot_t *wcroot,
                   const svn_checksum_t *sha1_checksum,
-                  const char *pristine_abspath,
                   apr_pool_t *result_pool,
                   apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
   svn_boolean_t have_row;
+  svn_boolean_t compressed = FALSE;
+  svn_error_t *err = SVN_NO_ERROR;
 
   /* Check that this pristine text is present in the store.  (The presence
    * of the file is not sufficient.) */
@@ -186,8 +371,11 @@ pristine_read_txn(svn_stream_t **contents,
 
   if (size)
     *size = svn_sqlite__column_int64(stmt, 0);
+  if (have_row)
+    err = column_compressed(&compressed, stmt, 1, sha1_checksum,
+                            scratch_pool);
 
-  SVN_ERR(svn_sqlite__reset(stmt));
+  SVN_ERR(svn_error_compose_create(err, svn_sqlite__reset(stmt)));
   if (! have_row)
     {
       return svn_error_createf(SVN_ERR_WC_PATH_NOT_FOUND, NULL,
@@ -205,10 +393,24 @@ pristine_read_txn(svn_stream_t **contents,
    * buffers. */
   if (contents)
     {
+      const char *pristine_abspath;
       apr_file_t *file;
-      SVN_ERR(svn_io_file_open(&file, pristine_abspath, APR_READ,
-                               APR_OS_DEFAULT, result_pool));
+
+      SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                                 sha1_checksum, compressed,
+                                 scratch_pool, scratch_pool));
+      err = svn_io_file_open(&file, pristine_abspath, APR_READ,
+                             APR_OS_DEFAULT, result_pool);
+      if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+        return svn_error_createf(SVN_ERR_WC_PRISTINE_DEHYDRATED, err,
+                                 _("Pristine text '%s' is not stored in the "
+                                   "working copy"),
+                                 svn_checksum_to_cstring_display(
+                                   sha1_checksum, scratch_pool));
+      SVN_ERR(err);
       *contents = svn_stream_from_aprfile2(file, FALSE, result_pool);
+      if (compressed)
+        *contents = svn_stream_compressed(*contents, result_pool);
     }
 
   return SVN_NO_ERROR;
@@ -225,7 +427,6 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
-  const char *pristine_abspath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
 
@@ -243,34 +444,48 @@ svn_wc__db_pristine_read(svn_stream_t **contents,
                               wri_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
-  SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                             sha1_checksum,
-                             scratch_pool, scratch_pool));
   SVN_WC__DB_WITH_TXN(
     pristine_read_txn(contents, size,
-                      wcroot, sha1_checksum, pristine_abspath,
+                      wcroot, sha1_checksum,
                       result_pool, scratch_pool),
     wcroot);
 
   return SVN_NO_ERROR;
 }
 
-
-/* Return the absolute path to the temporary directory for pristine text
-   files within WCROOT. */
-static char *
-pristine_get_tempdir(svn_wc__db_wcroot_t *wcroot,
-                     apr_pool_t *result_pool,
-                     apr_pool_t *scratch_pool)
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
 {
-  return svn_dirent_join_many(result_pool, wcroot->abspath,
-                              svn_wc_get_adm_dir(scratch_pool),
-                              PRISTINE_TEMPDIR_RELPATH, SVN_VA_NULL);
+  svn_error_t *err;
+
+  *contents = NULL;
+  if (!db->shared_pristines || sha1_checksum->kind != svn_checksum_sha1)
+    return SVN_NO_ERROR;
+
+  err = svn_stream_open_readonly(contents,
+                                 get_shared_fname(db->shared_pristines,
+                                                  sha1_checksum,
+                                                  scratch_pool),
+                                 result_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *contents = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(err);
 }
 
+
 /* Install the pristine text described by BATON into the pristine store of
- * SDB.  If it is already stored then just delete the new file
- * BATON->tempfile_abspath.
+ * WCROOT.  If it is already stored then just delete the new file
+ * BATON->tempfile_abspath.  If only its row is there because the text was
+ * dehydrated, put the file back.
  *
  * This function expects to be executed inside a SQLite txn that has already
  * acquired a 'RESERVED' lock.
@@ -278,7 +493,7 @@ pristine_get_tempdir(svn_wc__db_wcroot_t *wcroot,
  * Implements 'notes/wc-ng/pristine-store' section A-3(a).
  */
 static svn_error_t *
-pristine_install_txn(svn_sqlite__db_t *sdb,
+pristine_install_txn(svn_wc__db_wcroot_t *wcroot,
                      /* The path to the source file that is to be moved into place. */
                      svn_stream_t *install_stream,
                      /* The target path for the file (within the pristine store). */
@@ -287,41 +502,63 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
                      const svn_checksum_t *sha1_checksum,
                      /* The pristine text's MD-5 checksum. */
                      const svn_checksum_t *md5_checksum,
+                     /* Whether the file holds the text compressed. */
+                     svn_boolean_t compressed,
+                     /* The size of the text, which is not the size of the
+                        file if COMPRESSED. */
+                     svn_filesize_t size,
+                     /* The path of the text in the shared pristine store,
+                        or NULL if it is not to be shared. */
+                     const char *shared_abspath,
                      apr_pool_t *scratch_pool)
 {
+  svn_sqlite__db_t *sdb = wcroot->sdb;
   svn_sqlite__stmt_t *stmt;
   svn_boolean_t have_row;
+  svn_filesize_t stored_size;
+  svn_boolean_t dehydrated = FALSE;
+  svn_error_t *err = SVN_NO_ERROR;
 
   /* If this pristine text is already present in the store, just keep it:
-   * delete the new one and return. */
-  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SELECT_PRISTINE));
+   * delete the new one and return.  It doesn't matter whether the stored
+   * copy is compressed or not. */
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SELECT_PRISTINE_SIZE));
   SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
   SVN_ERR(svn_sqlite__step(&have_row, stmt));
-  SVN_ERR(svn_sqlite__reset(stmt));
-
+  stored_size = have_row ? svn_sqlite__column_int64(stmt, 0) : 0;
   if (have_row)
     {
+      svn_boolean_t stored_compressed;
+      const char *stored_abspath;
+      svn_node_kind_t kind;
+
+      err = column_compressed(&stored_compressed, stmt, 1, sha1_checksum,
+                              scratch_pool);
+      if (!err)
+        err = get_pristine_fname(&stored_abspath, wcroot->abspath,
+                                 sha1_checksum, stored_compressed,
+                                 scratch_pool, scratch_pool);
+      if (!err)
+        err = svn_io_check_path(stored_abspath, &kind, scratch_pool);
+      if (!err)
+        dehydrated = (kind == svn_node_none);
+    }
+  SVN_ERR(svn_error_compose_create(err, svn_sqlite__reset(stmt)));
+
+  if (have_row && !dehydrated)
+    {
 #ifdef SVN_DEBUG
-      /* Consistency checks.  Verify both files exist and match.
+      /* Consistency checks.  Verify both texts match.
        * ### We could check much more. */
-      {
-        apr_finfo_t finfo1, finfo2;
-
-        SVN_ERR(svn_stream__install_get_info(&finfo1, install_stream, APR_FINFO_SIZE,
-                                             scratch_pool));
-
-        SVN_ERR(svn_io_stat(&finfo2, pristine_abspath, APR_FINFO_SIZE,
-                            scratch_pool));
-        if (finfo1.size != finfo2.size)
-          {
-            return svn_error_createf(
-              SVN_ERR_WC_CORRUPT_TEXT_BASE, NULL,
-              _("New pristine text '%s' has different size: %s versus %s"),
-              svn_checksum_to_cstring_display(sha1_checksum, scratch_pool),
-              apr_off_t_toa(scratch_pool, finfo1.size),
-              apr_off_t_toa(scratch_pool, finfo2.size));
-          }
-      }
+      if (size != stored_size)
+        {
+          return svn_error_createf(
+            SVN_ERR_WC_CORRUPT_TEXT_BASE, NULL,
+            _("New pristine text '%s' has different size: %s versus %s"),
+            svn_checksum_to_cstring_display(sha1_checksum, scratch_pool),
+            apr_off_t_toa(scratch_pool, size),
+            apr_off_t_toa(scratch_pool, stored_size));
+        }
 #endif
 
       /* Remove the temp file: it's already there */
@@ -329,24 +566,79 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
       return SVN_NO_ERROR;
     }
 
+  /* Link the copy that other working copies share, if there is one.  As
+   * the store is content addressed, a copy of the right size is taken to
+   * be the text, like the copy in our own store would. */
+  if (shared_abspath)
+    {
+      apr_finfo_t finfo;
+      svn_error_t *err;
+
+      err = svn_io_stat(&finfo, shared_abspath, APR_FINFO_SIZE,
+                        scratch_pool);
+      if (!err && finfo.size != size)
+        {
+          /* Not the text; leave it alone. */
+          shared_abspath = NULL;
+        }
+      else if (!err)
+        {
+          err = link_pristine(shared_abspath, pristine_abspath, TRUE,
+                              scratch_pool);
+          if (!err)
+            {
+              SVN_ERR(svn_stream__install_delete(install_stream,
+                                                 scratch_pool));
+              install_stream = NULL;
+            }
+        }
+      svn_error_clear(err);
+    }
+
   /* Move the file to its target location.  (If it is already there, it is
    * an orphan file and it doesn't matter if we overwrite it.) */
   {
-    apr_finfo_t finfo;
-    SVN_ERR(svn_stream__install_get_info(&finfo, install_stream,
-                                         APR_FINFO_SIZE, scratch_pool));
-    SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
-                                       TRUE, scratch_pool));
-
-    SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_INSERT_PRISTINE));
-    SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
-    SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
-    SVN_ERR(svn_sqlite__bind_int64(stmt, 3, finfo.size));
-    SVN_ERR(svn_sqlite__insert(NULL, stmt));
-
-    SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE, scratch_pool));
+    if (install_stream)
+      SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
+                                         TRUE, scratch_pool));
+
+    if (dehydrated)
+      {
+        /* The row stays, but the file may not be stored the way it was. */
+        SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
+                                          STMT_UPDATE_PRISTINE_COMPRESSION));
+        SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum,
+                                          scratch_pool));
+        SVN_ERR(svn_sqlite__bind_int(stmt, 2,
+                                     compressed ? PRISTINE_COMPRESSION_ZLIB
+                                                : PRISTINE_COMPRESSION_NONE));
+        SVN_ERR(svn_sqlite__update(NULL, stmt));
+      }
+    else
+      {
+        SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_INSERT_PRISTINE));
+        SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum,
+                                          scratch_pool));
+        SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum,
+                                          scratch_pool));
+        SVN_ERR(svn_sqlite__bind_int64(stmt, 3, size));
+        if (compressed)
+          SVN_ERR(svn_sqlite__bind_int(stmt, 4, PRISTINE_COMPRESSION_ZLIB));
+        SVN_ERR(svn_sqlite__insert(NULL, stmt));
+      }
+
+    if (install_stream)
+      SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE,
+                                        scratch_pool));
   }
 
+  /* Offer a new text to the other working copies.  Another one may have
+   * been faster, and the store may be on another file system; either way
+   * we just keep our own copy. */
+  if (install_stream && shared_abspath)
+    svn_error_clear(link_pristine(pristine_abspath, shared_abspath, FALSE,
+                                  scratch_pool));
+
   return SVN_NO_ERROR;
 }
 
@@ -354,8 +646,29 @@ struct svn_wc__db_install_data_t
 {
   svn_wc__db_wcroot_t *wcroot;
   svn_stream_t *inner_stream;
+
+  /* Whether INNER_STREAM receives the text compressed, and if so, the
+     size of the text written so far. */
+  svn_boolean_t compressed;
+  svn_filesize_t size;
+
+  /* The directory of the shared pristine store, or NULL. */
+  const char *shared_dir;
 };
 
+/* Implements svn_write_fn_t for the text of a compressed pristine install,
+   counting its size in the svn_wc__db_install_data_t BATON. */
+static svn_error_t *
+count_install_write(void *baton,
+                    const char *data,
+                    apr_size_t *len)
+{
+  svn_wc__db_install_data_t *install_data = baton;
+
+  install_data->size += *len;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
                                     svn_wc__db_install_data_t **install_data,
@@ -388,12 +701,24 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   (*install_data)->inner_stream = *stream;
 
-  if (md5_checksum)
-    *stream = svn_stream_checksummed2(*stream, NULL, md5_checksum,
-                                      svn_checksum_md5, FALSE, result_pool);
-  if (sha1_checksum)
-    *stream = svn_stream_checksummed2(*stream, NULL, sha1_checksum,
-                                      svn_checksum_sha1, FALSE, result_pool);
+  (*install_data)->shared_dir = db->shared_pristines;
+
+  if (wcroot->compress_pristines)
+    {
+      svn_stream_t *counter = svn_stream_create(*install_data, result_pool);
+
+      svn_stream_set_write(counter, count_install_write);
+      (*install_data)->compressed = TRUE;
+      *stream = svn_stream_tee(counter,
+                               svn_stream_compressed(*stream, result_pool),
+                               result_pool);
+    }
+
+  /* Calculate both checksums in a single pass. */
+  *stream = svn_stream__checksummed(*stream, NULL, NULL,
+                                    md5_checksum, sha1_checksum,
+                                    svn_checksum_md5, svn_checksum_sha1,
+                                    FALSE, result_pool);
 
   return SVN_NO_ERROR;
 }
@@ -406,6 +731,8 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
 {
   svn_wc__db_wcroot_t *wcroot = install_data->wcroot;
   const char *pristine_abspath;
+  const char *shared_abspath = NULL;
+  svn_filesize_t size = install_data->size;
 
   SVN_ERR_ASSERT(sha1_checksum != NULL);
   SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
@@ -413,15 +740,29 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
   SVN_ERR_ASSERT(md5_checksum->kind == svn_checksum_md5);
 
   SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                             sha1_checksum,
+                             sha1_checksum, install_data->compressed,
                              scratch_pool, scratch_pool));
 
+  if (!install_data->compressed)
+    {
+      apr_finfo_t finfo;
+
+      SVN_ERR(svn_stream__install_get_info(&finfo, install_data->inner_stream,
+                                           APR_FINFO_SIZE, scratch_pool));
+      size = finfo.size;
+
+      if (install_data->shared_dir)
+        shared_abspath = get_shared_fname(install_data->shared_dir,
+                                          sha1_checksum, scratch_pool);
+    }
+
   /* Ensure the SQL txn has at least a 'RESERVED' lock before we start looking
    * at the disk, to ensure no concurrent pristine install/delete txn. */
   SVN_SQLITE__WITH_IMMEDIATE_TXN(
-    pristine_install_txn(wcroot->sdb,
+    pristine_install_txn(wcroot,
                          install_data->inner_stream, pristine_abspath,
                          sha1_checksum, md5_checksum,
+                         install_data->compressed, size, shared_abspath,
                          scratch_pool),
     wcroot->sdb);
 
@@ -514,13 +855,15 @@ svn_wc__db_pristine_get_sha1(const svn_checksum_t **sha1_checksum,
 }
 
 /* Handle the moving of a pristine from SRC_WCROOT to DST_WCROOT. The existing
-   pristine in SRC_WCROOT is described by CHECKSUM, MD5_CHECKSUM and SIZE */
+   pristine in SRC_WCROOT is described by CHECKSUM, MD5_CHECKSUM, SIZE and
+   COMPRESSED.  The file is copied as it is, so it keeps its compression. */
 static svn_error_t *
 maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
                             svn_wc__db_wcroot_t *dst_wcroot,
                             const svn_checksum_t *checksum,
                             const svn_checksum_t *md5_checksum,
                             apr_int64_t size,
+                            svn_boolean_t compressed,
                             svn_cancel_func_t cancel_func,
                             void *cancel_baton,
                             apr_pool_t *scratch_pool)
@@ -539,6 +882,8 @@ maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
   SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, checksum, scratch_pool));
   SVN_ERR(svn_sqlite__bind_checksum(stmt, 2, md5_checksum, scratch_pool));
   SVN_ERR(svn_sqlite__bind_int64(stmt, 3, size));
+  if (compressed)
+    SVN_ERR(svn_sqlite__bind_int(stmt, 4, PRISTINE_COMPRESSION_ZLIB));
 
   SVN_ERR(svn_sqlite__update(&affected_rows, stmt));
 
@@ -553,10 +898,17 @@ maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
                                  scratch_pool, scratch_pool));
 
   SVN_ERR(get_pristine_fname(&src_abspath, src_wcroot->abspath, checksum,
-                             scratch_pool, scratch_pool));
+                             compressed, scratch_pool, scratch_pool));
 
-  SVN_ERR(svn_stream_open_readonly(&src_stream, src_abspath,
-                                   scratch_pool, scratch_pool));
+  /* A dehydrated text stays dehydrated in DST_WCROOT; its row is enough. */
+  err = svn_stream_open_readonly(&src_stream, src_abspath,
+                                 scratch_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return svn_error_trace(svn_stream_close(dst_stream));
+    }
+  SVN_ERR(err);
 
   /* ### Should we verify the SHA1 or MD5 here, or is that too expensive? */
   SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
@@ -564,7 +916,7 @@ maybe_transfer_one_pristine(svn_wc__db_wcroot_t *src_wcroot,
                            scratch_pool));
 
   SVN_ERR(get_pristine_fname(&pristine_abspath, dst_wcroot->abspath, checksum,
-                             scratch_pool, scratch_pool));
+                             compressed, scratch_pool, scratch_pool));
 
   /* Move the file to its target location.  (If it is already there, it is
    * an orphan file and it doesn't matter if we overwrite it.) */
@@ -623,6 +975,7 @@ pristine_transfer_txn(svn_wc__db_wcroot_t *src_wcroot,
       const svn_checksum_t *checksum;
       const svn_checksum_t *md5_checksum;
       apr_int64_t size;
+      svn_boolean_t compressed;
       svn_error_t *err;
 
       svn_pool_clear(iterpool);
@@ -631,10 +984,13 @@ pristine_transfer_txn(svn_wc__db_wcroot_t *src_wcroot,
       SVN_ERR(svn_sqlite__column_checksum(&md5_checksum, stmt, 1, iterpool));
       size = svn_sqlite__column_int64(stmt, 2);
 
-      err = maybe_transfer_one_pristine(src_wcroot, dst_wcroot,
-                                        checksum, md5_checksum, size,
-                                        cancel_func, cancel_baton,
-                                        iterpool);
+      err = column_compressed(&compressed, stmt, 3, checksum, iterpool);
+      if (!err)
+        err = maybe_transfer_one_pristine(src_wcroot, dst_wcroot,
+                                          checksum, md5_checksum, size,
+                                          compressed,
+                                          cancel_func, cancel_baton,
+                                          iterpool);
 
       if (err)
         return svn_error_trace(svn_error_compose_create(
@@ -687,9 +1043,9 @@ svn_wc__db_pristine_transfer(svn_wc__db_t *db,
 
 
 
-/* If the pristine text referenced by SHA1_CHECKSUM in WCROOT/SDB, whose path
- * within the pristine store is PRISTINE_ABSPATH, has a reference count of
- * zero, delete it (both the database row and the disk file).
+/* If the pristine text referenced by SHA1_CHECKSUM in WCROOT/SDB has a
+ * reference count of zero, delete it (both the database row and the disk
+ * file).
  *
  * This function expects to be executed inside a SQLite txn that has already
  * acquired a 'RESERVED' lock.
@@ -698,11 +1054,16 @@ static svn_error_t *
 pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
                                     svn_wc__db_wcroot_t *wcroot,
                                     const svn_checksum_t *sha1_checksum,
-                                    const char *pristine_abspath,
                                     apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
   int affected_rows;
+  const char *pristine_abspath;
+  svn_boolean_t compressed;
+
+  /* Find out which file holds the text while we still have its row. */
+  SVN_ERR(get_pristine_storage(&pristine_abspath, &compressed, wcroot,
+                               sha1_checksum, scratch_pool, scratch_pool));
 
   /* Remove the DB row, if refcount is 0. */
   SVN_ERR(svn_sqlite__get_statement(&stmt, sdb,
@@ -713,17 +1074,10 @@ pristine_remove_if_unreferenced_txn(svn_sqlite__db_t *sdb,
   /* If we removed the DB row, then remove the file. */
   if (affected_rows > 0)
     {
-      /* If the file is not present, something has gone wrong, but at this
-       * point it no longer matters.  In a debug build, raise an error, but
-       * in a release build, it is more helpful to ignore it and continue. */
-#ifdef SVN_DEBUG
-      svn_boolean_t ignore_enoent = FALSE;
-#else
-      svn_boolean_t ignore_enoent = TRUE;
-#endif
-
-      SVN_ERR(svn_io_remove_file2(pristine_abspath, ignore_enoent,
-                                  scratch_pool));
+      /* The file of a dehydrated text is not present, and neither is
+       * the file of a text lost some other way, which at this point no
+       * longer matters. */
+      SVN_ERR(svn_io_remove_file2(pristine_abspath, TRUE, scratch_pool));
     }
 
   return SVN_NO_ERROR;
@@ -739,16 +1093,16 @@ pristine_remove_if_unreferenced(svn_wc__db_wcroot_t *wcroot,
                                 const svn_checksum_t *sha1_checksum,
                                 apr_pool_t *scratch_pool)
 {
-  const char *pristine_abspath;
-
-  SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                             sha1_checksum, scratch_pool, scratch_pool));
+  /* Within a batch, the references that are gone may still come back by
+     rolling it back.  Leave the text for a later cleanup. */
+  if (svn_sqlite__in_batch(wcroot->sdb))
+    return SVN_NO_ERROR;
 
   /* Ensure the SQL txn has at least a 'RESERVED' lock before we start looking
    * at the disk, to ensure no concurrent pristine install/delete txn. */
   SVN_SQLITE__WITH_IMMEDIATE_TXN(
     pristine_remove_if_unreferenced_txn(
-      wcroot->sdb, wcroot, sha1_checksum, pristine_abspath, scratch_pool),
+      wcroot->sdb, wcroot, sha1_checksum, scratch_pool),
     wcroot->sdb);
 
   return SVN_NO_ERROR;
@@ -797,6 +1151,57 @@ svn_wc__db_pristine_remove(svn_wc__db_t *db,
   return SVN_NO_ERROR;
 }
 
+/* Remove the file of the pristine text SHA1_CHECKSUM from the store of
+ * WCROOT, keeping its row.
+ *
+ * This function expects to be executed inside a SQLite txn that has already
+ * acquired a 'RESERVED' lock.
+ */
+static svn_error_t *
+pristine_dehydrate_txn(svn_wc__db_wcroot_t *wcroot,
+                       const svn_checksum_t *sha1_checksum,
+                       apr_pool_t *scratch_pool)
+{
+  const char *pristine_abspath;
+  svn_boolean_t compressed;
+
+  SVN_ERR(get_pristine_storage(&pristine_abspath, &compressed, wcroot,
+                               sha1_checksum, scratch_pool, scratch_pool));
+
+  return svn_error_trace(svn_io_remove_file2(pristine_abspath, TRUE,
+                                             scratch_pool));
+}
+
+svn_error_t *
+svn_wc__db_pristine_dehydrate(svn_wc__db_t *db,
+                              const char *wri_abspath,
+                              const svn_checksum_t *sha1_checksum,
+                              apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+  SVN_ERR_ASSERT(sha1_checksum != NULL);
+  SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  /* Only working copies that keep pristines on demand can fetch a
+     dropped text again. */
+  SVN_ERR_ASSERT(wcroot->pristines_on_demand);
+
+  /* Ensure the SQL txn has at least a 'RESERVED' lock before we start looking
+   * at the disk, to ensure no concurrent pristine install/delete txn. */
+  SVN_SQLITE__WITH_IMMEDIATE_TXN(
+    pristine_dehydrate_txn(wcroot, sha1_checksum, scratch_pool),
+    wcroot->sdb);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Remove all unreferenced pristines in the WC DB in WCROOT.
  *
@@ -863,6 +1268,70 @@ pristine_cleanup_wcroot(svn_wc__db_wcroot_t *wcroot,
       svn_error_compose_create(err, svn_sqlite__reset(stmt)));
 }
 
+/* Remove the texts in the shared pristine store in SHARED_DIR that no
+ * working copy links to any more, i.e. whose files have a link count of
+ * one.  Files whose link count the platform doesn't tell are kept.
+ */
+static svn_error_t *
+pristine_cleanup_shared(const char *shared_dir,
+                        apr_pool_t *scratch_pool)
+{
+  apr_hash_t *subdirs;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_error_t *err;
+
+  err = svn_io_get_dirents3(&subdirs, shared_dir, TRUE,
+                            scratch_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  for (hi = apr_hash_first(scratch_pool, subdirs); hi; hi = apr_hash_next(hi))
+    {
+      const char *subdir_abspath;
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+      apr_hash_t *files;
+      apr_hash_index_t *fi;
+
+      if (dirent->kind != svn_node_dir)
+        continue;
+
+      svn_pool_clear(iterpool);
+      subdir_abspath = svn_dirent_join(shared_dir, apr_hash_this_key(hi),
+                                       iterpool);
+      SVN_ERR(svn_io_get_dirents3(&files, subdir_abspath, TRUE,
+                                  iterpool, iterpool));
+
+      for (fi = apr_hash_first(iterpool, files); fi; fi = apr_hash_next(fi))
+        {
+          const char *file_abspath = svn_dirent_join(subdir_abspath,
+                                                     apr_hash_this_key(fi),
+                                                     iterpool);
+          apr_finfo_t finfo;
+
+          /* Working copies may be linking and unlinking concurrently, so
+             a file that went away already is fine. */
+          err = svn_io_stat(&finfo, file_abspath,
+                            APR_FINFO_TYPE | APR_FINFO_NLINK, iterpool);
+          if (!err && finfo.filetype == APR_REG && finfo.nlink == 1)
+            err = svn_io_remove_file2(file_abspath, TRUE, iterpool);
+
+          if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+            svn_error_clear(err);
+          else
+            SVN_ERR(err);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
                             const char *wri_abspath,
@@ -879,6 +1348,9 @@ svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
 
   SVN_ERR(pristine_cleanup_wcroot(wcroot, scratch_pool));
 
+  if (db->shared_pristines)
+    SVN_ERR(pristine_cleanup_shared(db->shared_pristines, scratch_pool));
+
   return SVN_NO_ERROR;
 }
 
@@ -917,8 +1389,19 @@ svn_wc__db_pristine_check(svn_boolean_t *present,
     svn_error_t *err;
 
     SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
-                               sha1_checksum, scratch_pool, scratch_pool));
+                               sha1_checksum, FALSE,
+                               scratch_pool, scratch_pool));
     err = svn_io_check_path(pristine_abspath, &kind_on_disk, scratch_pool);
+
+    /* The text may be stored compressed instead. */
+    if (!err && kind_on_disk == svn_node_none)
+      {
+        SVN_ERR(get_pristine_fname(&pristine_abspath, wcroot->abspath,
+                                   sha1_checksum, TRUE,
+                                   scratch_pool, scratch_pool));
+        err = svn_io_check_path(pristine_abspath, &kind_on_disk,
+                                scratch_pool);
+      }
 #ifdef WIN32
     if (err && err->apr_err == APR_FROM_OS_ERROR(ERROR_ACCESS_DENIED))
       {
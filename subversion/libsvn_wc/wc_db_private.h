@@ -52,6 +52,35 @@ struct svn_wc__db_t {
   /* Busy timeout in ms., 0 for the libsvn_subr default. */
   apr_int32_t timeout;
 
+  /* Number of concurrent jobs preparing file installs, see
+     svn_wc__db_get_install_jobs(). */
+  int install_jobs;
+
+  /* Number of concurrent jobs reading file information for status
+     walks, see svn_wc__db_get_status_jobs(). */
+  int status_jobs;
+
+  /* The file system monitor command, see svn_wc__db_get_fsmonitor(),
+     or NULL. */
+  const char *fsmonitor;
+
+  /* Whether working copies created through this db store new pristine
+     texts compressed.  Existing working copies use their own setting,
+     see svn_wc__db_wcroot_t. */
+  svn_boolean_t compress_pristines;
+
+  /* The directory of the shared pristine store, or NULL. */
+  const char *shared_pristines;
+
+  /* Whether working copies created through this db drop the pristine
+     texts of unmodified files.  Existing working copies use their own
+     setting, see svn_wc__db_wcroot_t. */
+  svn_boolean_t pristines_on_demand;
+
+  /* Whether checksums of unchanged files are remembered, see
+     svn_wc__db_get_checksum_cache(). */
+  svn_boolean_t checksum_cache;
+
   /* Map a given working copy directory to its relevant data.
      const char *local_abspath -> svn_wc__db_wcroot_t *wcroot  */
   apr_hash_t *dir_data;
@@ -107,6 +136,23 @@ typedef struct svn_wc__db_wcroot_t {
      const char *local_abspath -> svn_wc_adm_access_t *adm_access */
   apr_hash_t *access_cache;
 
+  /* Node rows read in bulk by svn_wc__db_read_children_info(), kept to
+     answer svn_wc__db_read_info() without querying SDB again.  NULL
+     until the first bulk read.  See wc_db.c.  */
+  struct svn_wc__db_node_cache_t *node_cache;
+
+  /* Whether the CHECKSUM_CACHE table exists in SDB: unknown until the
+     first use tries to create it, false if that failed.  */
+  svn_tristate_t checksum_cache_table;
+
+  /* Whether new pristine texts are stored compressed, as recorded in the
+     SETTINGS table when this working copy was created.  */
+  svn_boolean_t compress_pristines;
+
+  /* Whether the pristine texts of unmodified files are dropped, as recorded
+     in the SETTINGS table when this working copy was created.  */
+  svn_boolean_t pristines_on_demand;
+
 } svn_wc__db_wcroot_t;
 
 
@@ -48,6 +48,7 @@
 #include "svn_private_config.h"
 
 WC_QUERIES_SQL_DECLARE_STATEMENTS(statements);
+WC_QUERIES_SQL_DECLARE_STATEMENT_INFO(statement_info);
 
 
 
@@ -141,6 +142,8 @@ svn_wc__db_util_open_db(svn_sqlite__db_t **sdb,
   SVN_ERR(svn_sqlite__open(sdb, sdb_abspath, smode,
                            my_statements ? my_statements : statements,
                            0, NULL, timeout, result_pool, scratch_pool));
+  if (!my_statements)
+    svn_sqlite__set_statement_info(*sdb, statement_info);
 
   if (exclusive)
     SVN_ERR(svn_sqlite__exec_statements(*sdb, STMT_PRAGMA_LOCKING_MODE));
@@ -232,6 +232,8 @@ svn_wc__db_open(svn_wc__db_t **db,
   (*db)->verify_format = !open_without_upgrade;
   (*db)->enforce_empty_wq = enforce_empty_wq;
   (*db)->dir_data = apr_hash_make(result_pool);
+  (*db)->install_jobs = 1;
+  (*db)->status_jobs = 1;
 
   (*db)->state_pool = result_pool;
 
@@ -240,7 +242,13 @@ svn_wc__db_open(svn_wc__db_t **db,
     {
       svn_error_t *err;
       svn_boolean_t sqlite_exclusive = FALSE;
+      svn_boolean_t compress_pristines = FALSE;
+      svn_boolean_t pristines_on_demand = FALSE;
+      svn_boolean_t checksum_cache = FALSE;
+      const char *shared_pristines;
       apr_int64_t timeout;
+      apr_int64_t install_jobs;
+      apr_int64_t status_jobs;
 
       err = svn_config_get_bool(config, &sqlite_exclusive,
                                 SVN_CONFIG_SECTION_WORKING_COPY,
@@ -261,6 +269,75 @@ svn_wc__db_open(svn_wc__db_t **db,
         svn_error_clear(err);
       else
         (*db)->timeout = (apr_int32_t)timeout;
+
+      err = svn_config_get_int64(config, &install_jobs,
+                                 SVN_CONFIG_SECTION_WORKING_COPY,
+                                 SVN_CONFIG_OPTION_INSTALL_JOBS,
+                                 1);
+      if (err || install_jobs < 1 || install_jobs > 64)
+        svn_error_clear(err);
+      else
+        (*db)->install_jobs = (int)install_jobs;
+
+      err = svn_config_get_int64(config, &status_jobs,
+                                 SVN_CONFIG_SECTION_WORKING_COPY,
+                                 SVN_CONFIG_OPTION_STATUS_JOBS,
+                                 1);
+      if (err || status_jobs < 1 || status_jobs > 64)
+        svn_error_clear(err);
+      else
+        (*db)->status_jobs = (int)status_jobs;
+
+      svn_config_get(config, &(*db)->fsmonitor,
+                     SVN_CONFIG_SECTION_WORKING_COPY,
+                     SVN_CONFIG_OPTION_FSMONITOR, NULL);
+      if ((*db)->fsmonitor && !*(*db)->fsmonitor)
+        (*db)->fsmonitor = NULL;
+      else if ((*db)->fsmonitor)
+        (*db)->fsmonitor = apr_pstrdup(result_pool, (*db)->fsmonitor);
+
+      err = svn_config_get_bool(config, &compress_pristines,
+                                SVN_CONFIG_SECTION_WORKING_COPY,
+                                SVN_CONFIG_OPTION_COMPRESS_PRISTINES,
+                                FALSE);
+      if (err)
+        svn_error_clear(err);
+      else
+        (*db)->compress_pristines = compress_pristines;
+
+      svn_config_get(config, &shared_pristines,
+                     SVN_CONFIG_SECTION_WORKING_COPY,
+                     SVN_CONFIG_OPTION_SHARED_PRISTINES, NULL);
+      if (shared_pristines && *shared_pristines)
+        {
+          err = svn_dirent_get_absolute(&(*db)->shared_pristines,
+                                        svn_dirent_internal_style(
+                                          shared_pristines, scratch_pool),
+                                        result_pool);
+          if (err)
+            {
+              svn_error_clear(err);
+              (*db)->shared_pristines = NULL;
+            }
+        }
+
+      err = svn_config_get_bool(config, &pristines_on_demand,
+                                SVN_CONFIG_SECTION_WORKING_COPY,
+                                SVN_CONFIG_OPTION_PRISTINES_ON_DEMAND,
+                                FALSE);
+      if (err)
+        svn_error_clear(err);
+      else
+        (*db)->pristines_on_demand = pristines_on_demand;
+
+      err = svn_config_get_bool(config, &checksum_cache,
+                                SVN_CONFIG_SECTION_WORKING_COPY,
+                                SVN_CONFIG_OPTION_CHECKSUM_CACHE,
+                                FALSE);
+      if (err)
+        svn_error_clear(err);
+      else
+        (*db)->checksum_cache = checksum_cache;
     }
 
   return SVN_NO_ERROR;
@@ -294,6 +371,41 @@ svn_wc__db_close(svn_wc__db_t *db)
 }
 
 
+/* Set *COMPRESS_PRISTINES and *PRISTINES_ON_DEMAND to the settings
+   recorded for WC_ID in SDB, which has the given FORMAT.  Working copies
+   without recorded settings store all their pristine texts verbatim.
+
+   Older formats lack some settings, but their working copies must be
+   upgraded before any pristine text is stored anyway. */
+static svn_error_t *
+read_settings(svn_boolean_t *compress_pristines,
+              svn_boolean_t *pristines_on_demand,
+              svn_sqlite__db_t *sdb,
+              apr_int64_t wc_id,
+              int format,
+              apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  *compress_pristines = FALSE;
+  *pristines_on_demand = FALSE;
+
+  if (format < SVN_WC__HAS_PRISTINES_ON_DEMAND)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SELECT_SETTINGS));
+  SVN_ERR(svn_sqlite__bind_int64(stmt, 1, wc_id));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  if (have_row)
+    {
+      *compress_pristines = svn_sqlite__column_boolean(stmt, 0);
+      *pristines_on_demand = svn_sqlite__column_boolean(stmt, 1);
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
 svn_error_t *
 svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
                              const char *wcroot_abspath,
@@ -377,6 +489,15 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
   (*wcroot)->owned_locks = apr_array_make(result_pool, 8,
                                           sizeof(svn_wc__db_wclock_t));
   (*wcroot)->access_cache = apr_hash_make(result_pool);
+  (*wcroot)->node_cache = NULL;
+  (*wcroot)->checksum_cache_table = svn_tristate_unknown;
+  (*wcroot)->compress_pristines = FALSE;
+  (*wcroot)->pristines_on_demand = FALSE;
+
+  if (sdb != NULL)
+    SVN_ERR(read_settings(&(*wcroot)->compress_pristines,
+                          &(*wcroot)->pristines_on_demand,
+                          sdb, wc_id, format, scratch_pool));
 
   /* SDB will be NULL for pre-NG working copies. We only need to run a
      cleanup when the SDB is present.  */
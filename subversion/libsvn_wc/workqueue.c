@@ -30,16 +30,22 @@
 #include "svn_subst.h"
 #include "svn_hash.h"
 #include "svn_io.h"
+#include "svn_sorts.h"
 
 #include "wc.h"
 #include "wc_db.h"
 #include "workqueue.h"
 #include "adm_files.h"
 #include "conflicts.h"
+#include "textbase.h"
 #include "translate.h"
 
 #include "private/svn_io_private.h"
 #include "private/svn_skel.h"
+#include "private/svn_stats.h"
+#include "private/svn_string_private.h"
+#include "private/svn_thread_pool.h"
+#include "private/svn_utf_private.h"
 
 
 /* Workqueue operation names.  */
@@ -66,6 +72,37 @@
 
 typedef struct work_item_baton_t work_item_baton_t;
 
+#if APR_HAS_THREADS
+typedef struct install_prefetch_t install_prefetch_t;
+#endif
+
+struct work_item_baton_t
+{
+  apr_pool_t *result_pool; /* Pool to allocate result in */
+
+  svn_boolean_t used; /* needs reset */
+
+  apr_hash_t *record_map; /* const char * -> svn_io_dirent2_t map */
+
+  apr_uint64_t id; /* id of the work item being run */
+
+  svn_boolean_t no_clone; /* don't try to install files as clones */
+
+  /* The id of the last of the independent work items in the batch that is
+     being run, or 0 if not running a batch.  See find_independent_items().
+   */
+  apr_uint64_t batch_last_id;
+
+  /* const char *local_abspath -> const svn_checksum_t *sha1_checksum of
+     the pristines to dehydrate once the queue is done, or NULL if they are
+     kept.  See textbase.h. */
+  apr_hash_t *dehydrate_map;
+
+#if APR_HAS_THREADS
+  install_prefetch_t *prefetch; /* NULL if not preparing installs */
+#endif
+};
+
 struct work_item_dispatch {
   const char *name;
   svn_error_t *(*func)(work_item_baton_t *wqb,
@@ -77,13 +114,26 @@ struct work_item_dispatch {
                        apr_pool_t *scratch_pool);
 };
 
-/* Forward definition */
+/* Forward definitions */
 static svn_error_t *
 get_and_record_fileinfo(work_item_baton_t *wqb,
                         const char *local_abspath,
                         svn_boolean_t ignore_enoent,
                         apr_pool_t *scratch_pool);
 
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent);
+
+static svn_error_t *
+take_prepared_install(svn_stream_t **dst_stream,
+                      svn_boolean_t *installed,
+                      work_item_baton_t *wqb,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool);
+
 /* ------------------------------------------------------------------------ */
 /* OP_REMOVE_BASE  */
 
@@ -445,60 +495,80 @@ svn_wc__wq_build_postupgrade(svn_skel_t **work_item,
 
 /* OP_FILE_INSTALL */
 
-/* Process the OP_FILE_INSTALL work item WORK_ITEM.
- * See svn_wc__wq_build_file_install() which generates this work item.
- * Implements (struct work_item_dispatch).func. */
-static svn_error_t *
-run_file_install(work_item_baton_t *wqb,
-                 svn_wc__db_t *db,
-                 const svn_skel_t *work_item,
-                 const char *wri_abspath,
-                 svn_cancel_func_t cancel_func,
-                 void *cancel_baton,
-                 apr_pool_t *scratch_pool)
+/* What we need to know to install a file, as read from an OP_FILE_INSTALL
+   work item and the node that it refers to. */
+typedef struct file_install_info_t
 {
-  const svn_skel_t *arg1 = work_item->children->next;
-  const svn_skel_t *arg4 = arg1->next->next->next;
-  const char *local_relpath;
   const char *local_abspath;
   svn_boolean_t use_commit_times;
   svn_boolean_t record_fileinfo;
-  svn_boolean_t special;
-  svn_stream_t *src_stream;
-  svn_subst_eol_style_t style;
-  const char *eol;
-  apr_hash_t *keywords;
-  const char *temp_dir_abspath;
-  svn_stream_t *dst_stream;
-  apr_int64_t val;
   const char *wcroot_abspath;
+
+  /* The file to install: the pristine, or the file named in the work
+     item if FROM_WORK_ITEM is set.  SOURCE_COMPRESSED says whether it
+     holds a compressed pristine text. */
   const char *source_abspath;
+  svn_boolean_t source_compressed;
+  svn_boolean_t from_work_item;
+
+  /* The SHA-1 checksum of the pristine, or NULL if FROM_WORK_ITEM. */
   const svn_checksum_t *checksum;
+
+  /* The pristine properties and last changed date of the node. */
   apr_hash_t *props;
   apr_time_t changed_date;
 
+  /* How to translate SOURCE_ABSPATH into its working copy form. */
+  svn_boolean_t special;
+  svn_boolean_t translate;
+  const char *eol;
+  apr_hash_t *keywords;
+} file_install_info_t;
+
+/* Fill *INFO for the OP_FILE_INSTALL work item WORK_ITEM, allocated in
+ * RESULT_POOL.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+read_file_install_info(file_install_info_t *info,
+                       svn_wc__db_t *db,
+                       const svn_skel_t *work_item,
+                       const char *wri_abspath,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  const svn_skel_t *arg1 = work_item->children->next;
+  const svn_skel_t *arg4 = arg1->next->next->next;
+  const char *local_relpath;
+  apr_int64_t val;
+  const svn_checksum_t *checksum;
+  svn_subst_eol_style_t style;
+
   local_relpath = apr_pstrmemdup(scratch_pool, arg1->data, arg1->len);
-  SVN_ERR(svn_wc__db_from_relpath(&local_abspath, db, wri_abspath,
-                                  local_relpath, scratch_pool, scratch_pool));
+  SVN_ERR(svn_wc__db_from_relpath(&info->local_abspath, db, wri_abspath,
+                                  local_relpath, result_pool, scratch_pool));
 
   SVN_ERR(svn_skel__parse_int(&val, arg1->next, scratch_pool));
-  use_commit_times = (val != 0);
+  info->use_commit_times = (val != 0);
   SVN_ERR(svn_skel__parse_int(&val, arg1->next->next, scratch_pool));
-  record_fileinfo = (val != 0);
-
-  SVN_ERR(svn_wc__db_read_node_install_info(&wcroot_abspath,
-                                            &checksum, &props,
-                                            &changed_date,
-                                            db, local_abspath, wri_abspath,
-                                            scratch_pool, scratch_pool));
-
+  info->record_fileinfo = (val != 0);
+
+  SVN_ERR(svn_wc__db_read_node_install_info(&info->wcroot_abspath,
+                                            &checksum, &info->props,
+                                            &info->changed_date,
+                                            db, info->local_abspath,
+                                            wri_abspath,
+                                            result_pool, scratch_pool));
+
+  info->from_work_item = (arg4 != NULL);
+  info->source_compressed = FALSE;
+  info->checksum = NULL;
   if (arg4 != NULL)
     {
       /* Use the provided path for the source.  */
       local_relpath = apr_pstrmemdup(scratch_pool, arg4->data, arg4->len);
-      SVN_ERR(svn_wc__db_from_relpath(&source_abspath, db, wri_abspath,
+      SVN_ERR(svn_wc__db_from_relpath(&info->source_abspath, db, wri_abspath,
                                       local_relpath,
-                                      scratch_pool, scratch_pool));
+                                      result_pool, scratch_pool));
     }
   else if (! checksum)
     {
@@ -513,119 +583,369 @@ run_file_install(work_item_baton_t *wqb,
                                _("Can't install '%s' from pristine store, "
                                  "because no checksum is recorded for this "
                                  "file"),
-                               svn_dirent_local_style(local_abspath,
+                               svn_dirent_local_style(info->local_abspath,
                                                       scratch_pool));
     }
   else
     {
-      SVN_ERR(svn_wc__db_pristine_get_future_path(&source_abspath,
-                                                  wcroot_abspath,
-                                                  checksum,
-                                                  scratch_pool, scratch_pool));
+      info->checksum = checksum;
+      SVN_ERR(svn_wc__db_pristine_get_storage(&info->source_abspath,
+                                              &info->source_compressed,
+                                              db, wri_abspath, checksum,
+                                              result_pool, scratch_pool));
     }
 
-  SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
-                                   scratch_pool, scratch_pool));
-
   /* Fetch all the translation bits.  */
-  SVN_ERR(svn_wc__get_translate_info(&style, &eol,
-                                     &keywords,
-                                     &special, db, local_abspath,
-                                     props, FALSE,
-                                     scratch_pool, scratch_pool));
-  if (special)
-    {
-      /* When this stream is closed, the resulting special file will
-         atomically be created/moved into place at LOCAL_ABSPATH.  */
-      SVN_ERR(svn_subst_create_specialfile(&dst_stream, local_abspath,
-                                           scratch_pool, scratch_pool));
+  SVN_ERR(svn_wc__get_translate_info(&style, &info->eol,
+                                     &info->keywords,
+                                     &info->special, db, info->local_abspath,
+                                     info->props, FALSE,
+                                     result_pool, scratch_pool));
 
-      /* Copy the "repository normal" form of the special file into the
-         special stream.  */
-      SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
-                               cancel_func, cancel_baton,
-                               scratch_pool));
+  info->translate = svn_subst_translation_required(style, info->eol,
+                                                   info->keywords,
+                                                   FALSE /* special */,
+                                                   TRUE /* force_eol_check */);
 
-      /* No need to set exec or read-only flags on special files.  */
+  return SVN_NO_ERROR;
+}
 
-      /* ### Shouldn't this record a timestamp and size, etc.? */
-      return SVN_NO_ERROR;
-    }
+/* Set *STREAM to a readable stream of the untranslated text of the file
+ * described by INFO, allocated in RESULT_POOL.
+ */
+static svn_error_t *
+open_install_source(svn_stream_t **stream,
+                    const file_install_info_t *info,
+                    apr_pool_t *result_pool,
+                    apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_stream_open_readonly(stream, info->source_abspath,
+                                   result_pool, scratch_pool));
+  if (info->source_compressed)
+    *stream = svn_stream_compressed(*stream, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Translate INFO->SOURCE_ABSPATH into a new install stream in
+ * TEMP_DIR_ABSPATH and return that stream, allocated in RESULT_POOL,
+ * in *DST_STREAM.  This touches neither the working copy nor its database,
+ * so it may run on any thread.  Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+translate_for_install(svn_stream_t **dst_stream,
+                      const file_install_info_t *info,
+                      const char *temp_dir_abspath,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  svn_stream_t *src_stream;
+
+  SVN_ERR(open_install_source(&src_stream, info, scratch_pool, scratch_pool));
 
-  if (svn_subst_translation_required(style, eol, keywords,
-                                     FALSE /* special */,
-                                     TRUE /* force_eol_check */))
+  if (info->translate)
     {
       /* Wrap it in a translating (expanding) stream.  */
-      src_stream = svn_subst_stream_translated(src_stream, eol,
+      src_stream = svn_subst_stream_translated(src_stream, info->eol,
                                                TRUE /* repair */,
-                                               keywords,
+                                               info->keywords,
                                                TRUE /* expand */,
                                                scratch_pool);
     }
 
-  /* Where is the Right Place to put a temp file in this working copy?  */
-  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
-                                         db, wcroot_abspath,
-                                         scratch_pool, scratch_pool));
-
   /* Translate to a temporary file. We don't want the user seeing a partial
      file, nor let them muck with it while we translate. We may also need to
      get its TRANSLATED_SIZE before the user can monkey it.  */
-  SVN_ERR(svn_stream__create_for_install(&dst_stream, temp_dir_abspath,
-                                         scratch_pool, scratch_pool));
+  SVN_ERR(svn_stream__create_for_install(dst_stream, temp_dir_abspath,
+                                         result_pool, scratch_pool));
 
   /* Copy from the source to the dest, translating as we go. This will also
      close both streams.  */
-  SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
-                           cancel_func, cancel_baton,
-                           scratch_pool));
+  return svn_error_trace(svn_stream_copy3(src_stream, *dst_stream,
+                                          cancel_func, cancel_baton,
+                                          scratch_pool));
+}
+
+/* Return TRUE if the file described by INFO is installed exactly as its
+ * source file is stored, so that a copy-on-write clone of that will do.
+ */
+static svn_boolean_t
+can_install_clone(const file_install_info_t *info)
+{
+  return !info->special && !info->translate && !info->source_compressed;
+}
+
+/* Try to install the file described by INFO as a copy-on-write clone of
+ * its source, which makes installing large files nearly free.  Set
+ * *CLONED to whether that worked; if it didn't because the file system
+ * can't clone files, leave everything as it was.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+static svn_error_t *
+install_clone(svn_boolean_t *cloned,
+              const file_install_info_t *info,
+              svn_wc__db_t *db,
+              apr_pool_t *scratch_pool)
+{
+  const char *temp_dir_abspath;
+  const char *tmp_abspath;
+  svn_error_t *err;
+
+  *cloned = FALSE;
+
+  /* Clone next to the working copy first, so that the user never sees a
+     partial file. */
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
+                                         db, info->wcroot_abspath,
+                                         scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_open_unique_file3(NULL, &tmp_abspath, temp_dir_abspath,
+                                   svn_io_file_del_none,
+                                   scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_remove_file2(tmp_abspath, FALSE, scratch_pool));
+
+  err = svn_io__file_clone(info->source_abspath, tmp_abspath, scratch_pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* A clone may have taken over the read-only mode of the pristine. */
+  err = svn_io_set_file_read_write(tmp_abspath, FALSE, scratch_pool);
+
+  /* With a single db we might want to install files in a missing
+     directory, see run_file_install(). */
+  if (!err)
+    err = svn_io_file_rename2(tmp_abspath, info->local_abspath, FALSE,
+                              scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      err = svn_io_make_dir_recursively(
+              svn_dirent_dirname(info->local_abspath, scratch_pool),
+              scratch_pool);
+      if (!err)
+        err = svn_io_file_rename2(tmp_abspath, info->local_abspath, FALSE,
+                                  scratch_pool);
+    }
+  if (err)
+    return svn_error_compose_create(
+             err, svn_io_remove_file2(tmp_abspath, TRUE, scratch_pool));
+
+  *cloned = TRUE;
+  return SVN_NO_ERROR;
+}
+
+/* Set *READ_ONLY to whether the file described by INFO has to be made
+ * read-only after installing it, reading its lock from DB.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+install_read_only(svn_boolean_t *read_only,
+                  const file_install_info_t *info,
+                  svn_wc__db_t *db,
+                  apr_pool_t *scratch_pool)
+{
+  svn_wc__db_status_t status;
+  svn_wc__db_lock_t *lock;
+
+  /* Note that this explicitly checks the pristine properties, to make sure
+     that when the lock is locally set (=modification) it is not read only */
+  if (!info->props || !svn_hash_gets(info->props, SVN_PROP_NEEDS_LOCK))
+    {
+      *read_only = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_wc__db_read_info(&status, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, &lock, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL,
+                               db, info->local_abspath,
+                               scratch_pool, scratch_pool));
+
+  *read_only = (!lock && status != svn_wc__db_status_added);
+  return SVN_NO_ERROR;
+}
+
+/* Move DST_STREAM, if not NULL, into place as the file described by INFO
+ * and tweak that file according to its properties, making it read-only if
+ * READ_ONLY.  Set *DIRENT to the installed file as recorded in the working
+ * copy, allocated in RESULT_POOL, or to NULL if INFO says not to record it.
+ * This doesn't touch the database, so it may run on any thread.  Use
+ * SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+finish_install(const svn_io_dirent2_t **dirent,
+               const file_install_info_t *info,
+               svn_boolean_t read_only,
+               svn_stream_t *dst_stream,
+               apr_pool_t *result_pool,
+               apr_pool_t *scratch_pool)
+{
+  const char *local_abspath = info->local_abspath;
+
+  *dirent = NULL;
 
   /* All done. Move the file into place.  */
-  /* With a single db we might want to install files in a missing directory.
-     Simply trying this scenario on error won't do any harm and at least
-     one user reported this problem on IRC. */
-  SVN_ERR(svn_stream__install_stream(dst_stream, local_abspath,
-                                     TRUE /* make_parents*/, scratch_pool));
+  /* With a single db we might want to install files in a missing
+     directory.  Simply trying this scenario on error won't do any
+     harm and at least one user reported this problem on IRC. */
+  if (dst_stream)
+    SVN_ERR(svn_stream__install_stream(dst_stream, local_abspath,
+                                       TRUE /* make_parents*/,
+                                       scratch_pool));
 
   /* Tweak the on-disk file according to its properties.  */
 #ifndef WIN32
-  if (props && svn_hash_gets(props, SVN_PROP_EXECUTABLE))
+  if (info->props && svn_hash_gets(info->props, SVN_PROP_EXECUTABLE))
     SVN_ERR(svn_io_set_file_executable(local_abspath, TRUE, FALSE,
                                        scratch_pool));
 #endif
 
-  /* Note that this explicitly checks the pristine properties, to make sure
-     that when the lock is locally set (=modification) it is not read only */
-  if (props && svn_hash_gets(props, SVN_PROP_NEEDS_LOCK))
-    {
-      svn_wc__db_status_t status;
-      svn_wc__db_lock_t *lock;
-      SVN_ERR(svn_wc__db_read_info(&status, NULL, NULL, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, &lock, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, NULL, NULL, NULL, NULL,
-                                   db, local_abspath,
-                                   scratch_pool, scratch_pool));
+  if (read_only)
+    SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
 
-      if (!lock && status != svn_wc__db_status_added)
-        SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
-    }
-
-  if (use_commit_times)
+  if (info->use_commit_times)
     {
-      if (changed_date)
-        SVN_ERR(svn_io_set_file_affected_time(changed_date,
+      if (info->changed_date)
+        SVN_ERR(svn_io_set_file_affected_time(info->changed_date,
                                               local_abspath,
                                               scratch_pool));
     }
 
   /* ### this should happen before we rename the file into place.  */
-  if (record_fileinfo)
+  if (info->record_fileinfo)
+    SVN_ERR(svn_io_stat_dirent2(dirent, local_abspath, FALSE, FALSE,
+                                result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Process the OP_FILE_INSTALL work item WORK_ITEM.
+ * See svn_wc__wq_build_file_install() which generates this work item.
+ * Implements (struct work_item_dispatch).func. */
+static svn_error_t *
+run_file_install(work_item_baton_t *wqb,
+                 svn_wc__db_t *db,
+                 const svn_skel_t *work_item,
+                 const char *wri_abspath,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  file_install_info_t info;
+  const char *local_abspath;
+  svn_stream_t *dst_stream = NULL;
+  svn_boolean_t cloned = FALSE;
+  svn_boolean_t restored = FALSE;
+  svn_boolean_t read_only;
+  const svn_io_dirent2_t *dirent;
+  svn_error_t *err;
+
+  SVN_ERR(read_file_install_info(&info, db, work_item, wri_abspath,
+                                 scratch_pool, scratch_pool));
+  local_abspath = info.local_abspath;
+
+  /* A pristine dehydrated by an earlier run has to be put back first. */
+  if (wqb->dehydrate_map && !info.from_work_item)
+    {
+      SVN_ERR(svn_wc__textbase_restore(&restored, db, local_abspath,
+                                       info.checksum, scratch_pool));
+      if (restored)
+        SVN_ERR(svn_wc__db_pristine_get_storage(&info.source_abspath,
+                                                &info.source_compressed,
+                                                db, wri_abspath,
+                                                info.checksum,
+                                                scratch_pool, scratch_pool));
+    }
+
+  if (info.special)
+    {
+      svn_stream_t *src_stream;
+
+      SVN_ERR(open_install_source(&src_stream, &info,
+                                  scratch_pool, scratch_pool));
+
+      /* When this stream is closed, the resulting special file will
+         atomically be created/moved into place at LOCAL_ABSPATH.  */
+      SVN_ERR(svn_subst_create_specialfile(&dst_stream, local_abspath,
+                                           scratch_pool, scratch_pool));
+
+      /* Copy the "repository normal" form of the special file into the
+         special stream.  */
+      SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
+                               cancel_func, cancel_baton,
+                               scratch_pool));
+
+      /* No need to set exec or read-only flags on special files.  */
+
+      /* ### Shouldn't this record a timestamp and size, etc.? */
+      return SVN_NO_ERROR;
+    }
+
+  /* Once cloning failed, don't bother trying for the other files.  */
+  if (!wqb->no_clone && can_install_clone(&info))
     {
-      SVN_ERR(get_and_record_fileinfo(wqb, local_abspath,
-                                      FALSE /* ignore_enoent */,
-                                      scratch_pool));
+      SVN_ERR(install_clone(&cloned, &info, db, scratch_pool));
+      wqb->no_clone = !cloned;
+    }
+
+  if (!cloned)
+    {
+      svn_boolean_t installed;
+
+      /* A worker may already have done the translation for us, unless
+         it had no source to translate, or even the whole install.  */
+      err = take_prepared_install(&dst_stream, &installed, wqb,
+                                  cancel_func, cancel_baton,
+                                  scratch_pool);
+      if (restored)
+        {
+          svn_error_clear(err);
+          dst_stream = NULL;
+        }
+      else
+        SVN_ERR(err);
+
+      if (installed)
+        return SVN_NO_ERROR;
+
+      if (!dst_stream)
+        {
+          const char *temp_dir_abspath;
+
+          /* Where is the Right Place to put a temp file in this working
+             copy?  */
+          SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
+                                                 db, info.wcroot_abspath,
+                                                 scratch_pool,
+                                                 scratch_pool));
+
+          SVN_ERR(translate_for_install(&dst_stream, &info, temp_dir_abspath,
+                                        cancel_func, cancel_baton,
+                                        scratch_pool, scratch_pool));
+        }
+    }
+
+  SVN_ERR(install_read_only(&read_only, &info, db, scratch_pool));
+  SVN_ERR(finish_install(&dirent, &info, read_only, dst_stream,
+                         wqb->result_pool, scratch_pool));
+  if (dirent)
+    record_fileinfo(wqb, local_abspath, dirent);
+
+  /* The file holds the pristine now, but other files may still be
+     installed from it.  */
+  if (wqb->dehydrate_map && !info.from_work_item)
+    {
+      apr_pool_t *map_pool = apr_hash_pool_get(wqb->dehydrate_map);
+
+      svn_hash_sets(wqb->dehydrate_map,
+                    apr_pstrdup(map_pool, local_abspath),
+                    svn_checksum_dup(info.checksum, map_pool));
     }
 
   return SVN_NO_ERROR;
@@ -1408,15 +1728,276 @@ static const struct work_item_dispatch dispatch_table[] = {
   { NULL }
 };
 
-struct work_item_baton_t
+
+#if APR_HAS_THREADS
+
+/* Number of upcoming file installs per worker that get prepared before
+   it is their turn to be run. */
+#define INSTALL_PREFETCH_PER_WORKER 4
+
+/* An OP_FILE_INSTALL work item whose translated file is being prepared
+   by a worker thread. */
+typedef struct prepared_install_t
 {
-  apr_pool_t *result_pool; /* Pool to allocate result in */
+  /* The id of the work item. */
+  apr_uint64_t id;
 
-  svn_boolean_t used; /* needs reset */
+  /* The job in the prefetch's thread pool that prepares this install. */
+  svn_thread_pool__job_t *job;
 
-  apr_hash_t *record_map; /* const char * -> svn_io_dirent2_t map */
+  /* Root pool that only the thread currently owning this job uses. */
+  apr_pool_t *pool;
+
+  file_install_info_t info;
+  const char *temp_dir_abspath;
+
+  /* Set if the worker also moves the file into place, as the work item is
+     independent of all that are run before it, and whether to make it
+     read-only then. */
+  svn_boolean_t complete;
+  svn_boolean_t read_only;
+
+  /* Results.  Only valid once JOB has been waited for.  DST_STREAM is NULL
+     and DIRENT the fileinfo to record, if any, for a COMPLETE job. */
+  svn_stream_t *dst_stream;
+  const svn_io_dirent2_t *dirent;
+
+  struct prepared_install_t *next;
+} prepared_install_t;
+
+/* The workers preparing file installs for a single svn_wc__wq_run(). */
+struct install_prefetch_t
+{
+  /* Maximum number of worker threads. */
+  int jobs;
+
+  /* The prepared installs that have not been run yet, in work queue
+     order. */
+  prepared_install_t *first;
+  prepared_install_t *last;
+  int pending;
+
+  /* The highest work item id that we looked at. */
+  apr_uint64_t last_peeked_id;
+
+  /* Runs the jobs preparing the installs. */
+  svn_thread_pool__t *thread_pool;
+
+  apr_pool_t *pool;
 };
 
+/* Implements svn_thread_pool__job_func_t.  Translate the file of the
+ * prepared_install_t given as JOB_BATON and also install it if that
+ * may be completed.
+ */
+static svn_error_t *
+prepare_install(void *job_baton,
+                void *worker_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
+{
+  prepared_install_t *install = job_baton;
+  svn_stream_t *dst_stream;
+
+  SVN_ERR(translate_for_install(&dst_stream, &install->info,
+                                install->temp_dir_abspath,
+                                cancel_func, cancel_baton,
+                                install->pool, scratch_pool));
+
+  if (install->complete)
+    return svn_error_trace(finish_install(&install->dirent, &install->info,
+                                          install->read_only, dst_stream,
+                                          install->pool, scratch_pool));
+
+  install->dst_stream = dst_stream;
+  return SVN_NO_ERROR;
+}
+
+/* Tell the worker threads of PREFETCH to terminate as soon as possible,
+ * wait for them to finish and throw away all installs that have been
+ * prepared but not run.
+ */
+static svn_error_t *
+stop_install_workers(install_prefetch_t *prefetch)
+{
+  svn_error_t *err = svn_thread_pool__join(prefetch->thread_pool, TRUE);
+
+  /* No thread touches the remaining installs any more. */
+  while (prefetch->first)
+    {
+      prepared_install_t *install = prefetch->first;
+
+      prefetch->first = install->next;
+      if (install->dst_stream)
+        svn_error_clear(svn_stream__install_delete(install->dst_stream,
+                                                   install->pool));
+      svn_pool_destroy(install->pool);
+    }
+
+  prefetch->last = NULL;
+  prefetch->pending = 0;
+
+  return svn_error_trace(err);
+}
+
+/* Look at the work items following the one with id CURRENT_ID in the work
+ * queue of DB for WRI_ABSPATH and hand the file installs among them to the
+ * workers of PREFETCH, until enough of them are pending.  If SKIP_CLONES,
+ * leave out the installs that will be done by cloning.  Let the workers
+ * complete the installs up to the one with id COMPLETE_LAST_ID, which
+ * don't depend on any item that runs before them.  Use SCRATCH_POOL for
+ * temporary allocations.
+ */
+static svn_error_t *
+prefetch_installs(install_prefetch_t *prefetch,
+                  svn_wc__db_t *db,
+                  const char *wri_abspath,
+                  apr_uint64_t current_id,
+                  svn_boolean_t skip_clones,
+                  apr_uint64_t complete_last_id,
+                  apr_pool_t *scratch_pool)
+{
+  int max_pending = prefetch->jobs * INSTALL_PREFETCH_PER_WORKER;
+  apr_array_header_t *items;
+  apr_pool_t *iterpool;
+  int i;
+
+  /* Refill only when half of the pipeline has drained. */
+  if (prefetch->pending > max_pending / 2)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_wc__db_wq_peek(&items, db, wri_abspath,
+                             MAX(prefetch->last_peeked_id, current_id),
+                             max_pending, scratch_pool, scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (i = 0; i < items->nelts && prefetch->pending < max_pending; i++)
+    {
+      const svn_wc__db_wq_item_t *item
+        = APR_ARRAY_IDX(items, i, const svn_wc__db_wq_item_t *);
+      prepared_install_t *install;
+      apr_pool_t *pool;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+      prefetch->last_peeked_id = item->id;
+
+      if (!svn_skel__matches_atom(item->work_item->children, OP_FILE_INSTALL))
+        continue;
+
+      pool = svn_thread_pool__create_root_pool(NULL);
+      install = apr_pcalloc(pool, sizeof(*install));
+      install->id = item->id;
+      install->pool = pool;
+
+      /* Any problem will be reported when the work item itself is run. */
+      err = read_file_install_info(&install->info, db, item->work_item,
+                                   wri_abspath, pool, iterpool);
+      if (!err)
+        err = svn_wc__db_temp_wcroot_tempdir(&install->temp_dir_abspath, db,
+                                             install->info.wcroot_abspath,
+                                             pool, iterpool);
+
+      /* Special files are created in place and a source named in the work
+         item may be the result of a work item that has not run yet.
+         Preparing a file that gets cloned would be wasted effort. */
+      if (err || install->info.special || install->info.from_work_item
+          || (skip_clones && can_install_clone(&install->info)))
+        {
+          svn_error_clear(err);
+          svn_pool_destroy(pool);
+          continue;
+        }
+
+      if (install->id <= complete_last_id)
+        {
+          /* Reading the lock has to happen on this thread. */
+          err = install_read_only(&install->read_only, &install->info, db,
+                                  iterpool);
+          install->complete = !err;
+          svn_error_clear(err);
+        }
+
+      err = svn_thread_pool__submit(&install->job, prefetch->thread_pool,
+                                    prepare_install, install);
+      if (err)
+        {
+          svn_pool_destroy(pool);
+          return svn_error_trace(err);
+        }
+
+      if (prefetch->last)
+        prefetch->last->next = install;
+      else
+        prefetch->first = install;
+      prefetch->last = install;
+      ++prefetch->pending;
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+#endif /* APR_HAS_THREADS */
+
+/* If the work item currently run by WQB has been prepared by a worker,
+ * wait for the worker to finish and return its install stream in
+ * *DST_STREAM.  Otherwise, set *DST_STREAM to NULL.  The stream gets
+ * cleaned up together with SCRATCH_POOL.  Set *INSTALLED to whether the
+ * worker installed the file, too; its fileinfo is recorded in WQB then.
+ */
+static svn_error_t *
+take_prepared_install(svn_stream_t **dst_stream,
+                      svn_boolean_t *installed,
+                      work_item_baton_t *wqb,
+                      svn_cancel_func_t cancel_func,
+                      void *cancel_baton,
+                      apr_pool_t *scratch_pool)
+{
+#if APR_HAS_THREADS
+  install_prefetch_t *prefetch = wqb->prefetch;
+  prepared_install_t *install;
+
+  *dst_stream = NULL;
+  *installed = FALSE;
+  if (!prefetch || !prefetch->first || prefetch->first->id != wqb->id)
+    return SVN_NO_ERROR;
+
+  /* Upon failure, stop_install_workers() will clean up behind the job. */
+  install = prefetch->first;
+  SVN_ERR(svn_thread_pool__wait(prefetch->thread_pool, install->job,
+                                cancel_func, cancel_baton));
+
+  prefetch->first = install->next;
+  if (!prefetch->first)
+    prefetch->last = NULL;
+  --prefetch->pending;
+
+  /* The install is ours now. */
+  svn_thread_pool__attach_root_pool(install->pool, scratch_pool);
+
+  if (install->complete)
+    {
+      if (install->dirent)
+        record_fileinfo(wqb, install->info.local_abspath,
+                        svn_io_dirent2_dup(install->dirent,
+                                           wqb->result_pool));
+      *installed = TRUE;
+    }
+  else
+    *dst_stream = install->dst_stream;
+#else
+  *dst_stream = NULL;
+  *installed = FALSE;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Number of work items run and the time that took. */
+SVN__COUNTER_DEFINE(work_item_timer, "wc.workqueue_items");
 
 static svn_error_t *
 dispatch_work_item(work_item_baton_t *wqb,
@@ -1434,13 +2015,16 @@ dispatch_work_item(work_item_baton_t *wqb,
     {
       if (svn_skel__matches_atom(work_item->children, scan->name))
         {
+          apr_time_t start;
 
 #ifdef SVN_DEBUG_WORK_QUEUE
           SVN_DBG(("dispatch: operation='%s'\n", scan->name));
 #endif
+          SVN__TIMER_START(work_item_timer, start);
           SVN_ERR((*scan->func)(wqb, db, work_item, wri_abspath,
                                 cancel_func, cancel_baton,
                                 scratch_pool));
+          SVN__TIMER_STOP(work_item_timer, start);
 
 #ifdef SVN_RUN_WORK_QUEUE_TWICE
 #ifdef SVN_DEBUG_WORK_QUEUE
@@ -1474,8 +2058,151 @@ dispatch_work_item(work_item_baton_t *wqb,
 }
 
 
-svn_error_t *
-svn_wc__wq_run(svn_wc__db_t *db,
+/* The maximum number of work items completed in a single wc.db
+   transaction. */
+#define WQ_BATCH_MAX_ITEMS 1000
+
+/* Add the key that LOCAL_RELPATH is compared by to PATHS, and those of its
+ * ancestors to ANCESTORS, and return TRUE.  Return FALSE instead,
+ * leaving both unchanged, if LOCAL_RELPATH, or one of its ancestors, is
+ * in PATHS already or LOCAL_RELPATH is in ANCESTORS.  Use BUF for the
+ * comparison keys.
+ *
+ * The keys ignore case and differences in Unicode normalization, as
+ * paths that differ only in those may still be the same file.
+ */
+static svn_boolean_t
+add_independent_path(apr_hash_t *paths,
+                     apr_hash_t *ancestors,
+                     const char *local_relpath,
+                     svn_membuf_t *buf)
+{
+  apr_pool_t *pool = apr_hash_pool_get(paths);
+  const char *key;
+  const char *parent_key;
+  svn_error_t *err;
+
+  /* Play safe with paths we can't compare. */
+  err = svn_utf__xfrm(&key, local_relpath, SVN_UTF__UNKNOWN_LENGTH,
+                      TRUE, FALSE, buf);
+  if (err)
+    {
+      svn_error_clear(err);
+      return FALSE;
+    }
+  key = apr_pstrdup(pool, key);
+
+  if (svn_hash_gets(paths, key) || svn_hash_gets(ancestors, key))
+    return FALSE;
+
+  for (parent_key = svn_relpath_dirname(key, pool);
+       *parent_key;
+       parent_key = svn_relpath_dirname(parent_key, pool))
+    if (svn_hash_gets(paths, parent_key))
+      return FALSE;
+
+  svn_hash_sets(paths, key, key);
+
+  for (parent_key = svn_relpath_dirname(key, pool);
+       *parent_key;
+       parent_key = svn_relpath_dirname(parent_key, pool))
+    svn_hash_sets(ancestors, parent_key, parent_key);
+
+  return TRUE;
+}
+
+/* Return the local_relpath that WORK_ITEM acts on, allocated in
+ * RESULT_POOL, if is an item that may run in any order with other such
+ * items on unrelated paths, and be run again after them.  That is true
+ * for removing files and for installing pristine files, which don't
+ * change the database.  Otherwise return NULL.
+ */
+static const char *
+independent_item_relpath(const svn_skel_t *work_item,
+                         apr_pool_t *result_pool)
+{
+  const svn_skel_t *arg1 = work_item->children->next;
+
+  if (svn_skel__matches_atom(work_item->children, OP_FILE_INSTALL))
+    {
+      /* A source named in the work item may be the result of another
+         work item. */
+      if (arg1->next->next->next != NULL)
+        return NULL;
+    }
+  else if (!svn_skel__matches_atom(work_item->children, OP_FILE_REMOVE))
+    return NULL;
+
+  return apr_pstrmemdup(result_pool, arg1->data, arg1->len);
+}
+
+/* Set *LAST_ID to the id of the last of the work items that follow
+ * WORK_ITEM with id ID in the queue of DB for WRI_ABSPATH, which are,
+ * together with WORK_ITEM, independent of each other, or to ID if there
+ * are none.  See independent_item_relpath().  Use SCRATCH_POOL for
+ * temporary allocations.
+ *
+ * These items may run in parallel, and be completed in a single
+ * transaction: if that doesn't get committed, running all of them again
+ * gives the same result.
+ */
+static svn_error_t *
+find_independent_items(apr_uint64_t *last_id,
+                       svn_wc__db_t *db,
+                       const char *wri_abspath,
+                       apr_uint64_t id,
+                       const svn_skel_t *work_item,
+                       apr_pool_t *scratch_pool)
+{
+  const char *local_relpath;
+  apr_array_header_t *items;
+  apr_hash_t *paths;
+  apr_hash_t *ancestors;
+  svn_membuf_t buf;
+  int i;
+
+  *last_id = id;
+
+  local_relpath = independent_item_relpath(work_item, scratch_pool);
+  if (!local_relpath)
+    return SVN_NO_ERROR;
+
+  paths = apr_hash_make(scratch_pool);
+  ancestors = apr_hash_make(scratch_pool);
+  svn_membuf__create(&buf, 0, scratch_pool);
+  if (!add_independent_path(paths, ancestors, local_relpath, &buf))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_wc__db_wq_peek(&items, db, wri_abspath, id,
+                             WQ_BATCH_MAX_ITEMS - 1,
+                             scratch_pool, scratch_pool));
+
+  for (i = 0; i < items->nelts; i++)
+    {
+      const svn_wc__db_wq_item_t *item
+        = APR_ARRAY_IDX(items, i, const svn_wc__db_wq_item_t *);
+
+      local_relpath = independent_item_relpath(item->work_item, scratch_pool);
+      if (!local_relpath
+          || !add_independent_path(paths, ancestors, local_relpath, &buf))
+        break;
+
+      *last_id = item->id;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Run the work queue of DB for WRI_ABSPATH, as described for
+ * svn_wc__wq_run(), using WIB for the state shared between work items.
+ *
+ * Runs of independent work items are completed in a single wc.db batch,
+ * and the file installs among them are completed by the install workers
+ * of WIB, if any, ahead of their turn.
+ */
+static svn_error_t *
+run_work_queue(work_item_baton_t *wib,
+               svn_wc__db_t *db,
                const char *wri_abspath,
                svn_cancel_func_t cancel_func,
                void *cancel_baton,
@@ -1483,78 +2210,112 @@ svn_wc__wq_run(svn_wc__db_t *db,
 {
   apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_uint64_t last_id = 0;
-  work_item_baton_t wib = { 0 };
-  wib.result_pool = svn_pool_create(scratch_pool);
-
-#ifdef SVN_DEBUG_WORK_QUEUE
-  SVN_DBG(("wq_run: wri='%s'\n", wri_abspath));
-  {
-    static int count = 0;
-    const char *count_env_var = getenv("SVN_DEBUG_WORK_QUEUE");
-    int count_env_val;
-
-    SVN_ERR(svn_cstring_atoi(&count_env_val, count_env_var));
-
-    if (count_env_var && ++count == count_env_val)
-      return svn_error_create(SVN_ERR_CANCELLED, NULL, "fake cancel");
-  }
-#endif
+  svn_error_t *err = SVN_NO_ERROR;
 
   while (TRUE)
     {
       apr_uint64_t id;
       svn_skel_t *work_item;
-      svn_error_t *err;
 
       svn_pool_clear(iterpool);
 
-      if (! wib.used)
+      if (! wib->used)
         {
           /* Make sure to do this *early* in the loop iteration. There may
              be a LAST_ID that needs to be marked as completed, *before* we
              start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_fetch_next(&id, &work_item, db, wri_abspath,
-                                           last_id, iterpool, iterpool));
+          err = svn_wc__db_wq_fetch_next(&id, &work_item, db, wri_abspath,
+                                         last_id, iterpool, iterpool);
         }
       else
         {
           /* Make sure to do this *early* in the loop iteration. There may
              be a LAST_ID that needs to be marked as completed, *before* we
              start worrying about anything else.  */
-          SVN_ERR(svn_wc__db_wq_record_and_fetch_next(&id, &work_item,
-                                                      db, wri_abspath,
-                                                      last_id, wib.record_map,
-                                                      iterpool,
-                                                      wib.result_pool));
-
-          svn_pool_clear(wib.result_pool);
-          wib.record_map = NULL;
-          wib.used = FALSE;
+          err = svn_wc__db_wq_record_and_fetch_next(&id, &work_item,
+                                                    db, wri_abspath,
+                                                    last_id, wib->record_map,
+                                                    iterpool,
+                                                    wib->result_pool);
+
+          svn_pool_clear(wib->result_pool);
+          wib->record_map = NULL;
+          wib->used = FALSE;
+        }
+      if (err)
+        break;
+
+      /* Commit the batch once all of its items are completed. */
+      if (wib->batch_last_id && (!work_item || id > wib->batch_last_id))
+        {
+          wib->batch_last_id = 0;
+          err = svn_wc__db_finish_batch(db, wri_abspath, iterpool);
+          if (err)
+            break;
         }
 
       /* Stop work queue processing, if requested. A future 'svn cleanup'
          should be able to continue the processing. Note that we may
          have WORK_ITEM, but we'll just skip its processing for now.  */
       if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
+        {
+          err = cancel_func(cancel_baton);
+          if (err)
+            break;
+        }
 
       /* If we have a WORK_ITEM, then process the sucker. Otherwise,
          we're done.  */
       if (work_item == NULL)
         break;
 
-      err = dispatch_work_item(&wib, db, wri_abspath, work_item,
+      /* Complete this item and the independent ones following it
+         together.  Nothing on disk depends on what the batch changes: the
+         completion of the items and the fileinfo they record.  Restoring
+         dehydrated pristines does change more, so don't batch then. */
+      if (!wib->batch_last_id && !wib->dehydrate_map)
+        {
+          apr_uint64_t batch_last_id;
+
+          err = find_independent_items(&batch_last_id, db, wri_abspath,
+                                       id, work_item, iterpool);
+          if (!err && batch_last_id > id)
+            {
+              err = svn_wc__db_begin_batch(db, wri_abspath, iterpool);
+              wib->batch_last_id = batch_last_id;
+            }
+          if (err)
+            break;
+        }
+
+#if APR_HAS_THREADS
+      /* Let the workers translate the next few files while we are busy
+         with this item, and install those that are independent of it. */
+      if (wib->prefetch)
+        {
+          err = prefetch_installs(wib->prefetch, db, wri_abspath, id,
+                                  !wib->no_clone,
+                                  wib->batch_last_id,
+                                  iterpool);
+          if (err)
+            break;
+        }
+#endif
+
+      wib->id = id;
+      err = dispatch_work_item(wib, db, wri_abspath, work_item,
                                cancel_func, cancel_baton, iterpool);
       if (err)
         {
           const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
 
-          return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
-                                   _("Failed to run the WC DB work queue "
-                                     "associated with '%s', work item %d %s"),
-                                   svn_dirent_local_style(wri_abspath,
-                                                          scratch_pool),
-                                   (int)id, skel);
+          err = svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
+                                  _("Failed to run the WC DB work queue "
+                                    "associated with '%s', work item %d %s"),
+                                  svn_dirent_local_style(wri_abspath,
+                                                         scratch_pool),
+                                  (int)id, skel);
+          break;
         }
 
       /* The work item finished without error. Mark it completed
@@ -1562,10 +2323,98 @@ svn_wc__wq_run(svn_wc__db_t *db,
       last_id = id;
     }
 
+  /* Keep the items of the batch that did complete completed. */
+  if (wib->batch_last_id)
+    {
+      wib->batch_last_id = 0;
+      err = svn_error_compose_create(err,
+                                     svn_wc__db_finish_batch(db, wri_abspath,
+                                                             iterpool));
+    }
+
   svn_pool_destroy(iterpool);
-  return SVN_NO_ERROR;
+  return svn_error_trace(err);
 }
 
+svn_error_t *
+svn_wc__wq_run(svn_wc__db_t *db,
+               const char *wri_abspath,
+               svn_cancel_func_t cancel_func,
+               void *cancel_baton,
+               apr_pool_t *scratch_pool)
+{
+  work_item_baton_t wib = { 0 };
+  svn_boolean_t pristines_on_demand;
+  svn_error_t *err;
+  wib.result_pool = svn_pool_create(scratch_pool);
+
+  /* The work items act on the disk, so what they are based on has to be
+     committed first. */
+  SVN_ERR(svn_wc__db_finish_batch(db, wri_abspath, scratch_pool));
+
+  SVN_ERR(svn_wc__db_get_pristines_on_demand(&pristines_on_demand, db,
+                                             wri_abspath, scratch_pool));
+  if (pristines_on_demand)
+    wib.dehydrate_map = apr_hash_make(scratch_pool);
+
+#ifdef SVN_DEBUG_WORK_QUEUE
+  SVN_DBG(("wq_run: wri='%s'\n", wri_abspath));
+  {
+    static int count = 0;
+    const char *count_env_var = getenv("SVN_DEBUG_WORK_QUEUE");
+    int count_env_val;
+
+    SVN_ERR(svn_cstring_atoi(&count_env_val, count_env_var));
+
+    if (count_env_var && ++count == count_env_val)
+      return svn_error_create(SVN_ERR_CANCELLED, NULL, "fake cancel");
+  }
+#endif
+
+#if APR_HAS_THREADS
+  if (svn_wc__db_get_install_jobs(db) > 1)
+    {
+      wib.prefetch = apr_pcalloc(scratch_pool, sizeof(*wib.prefetch));
+      wib.prefetch->jobs = svn_wc__db_get_install_jobs(db);
+      wib.prefetch->pool = svn_pool_create(scratch_pool);
+      SVN_ERR(svn_thread_pool__create(&wib.prefetch->thread_pool,
+                                      wib.prefetch->jobs, NULL, NULL,
+                                      wib.prefetch->pool));
+    }
+#endif
+
+  err = run_work_queue(&wib, db, wri_abspath, cancel_func, cancel_baton,
+                       scratch_pool);
+
+#if APR_HAS_THREADS
+  if (wib.prefetch)
+    {
+      err = svn_error_compose_create(err,
+                                     stop_install_workers(wib.prefetch));
+      svn_pool_destroy(wib.prefetch->pool);
+    }
+#endif
+
+  /* Only now no work item can need the pristines of the installed files
+     any more; their working files stand in for them from here on. */
+  if (!err && wib.dehydrate_map)
+    {
+      apr_hash_index_t *hi;
+      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+      for (hi = apr_hash_first(scratch_pool, wib.dehydrate_map);
+           hi && !err;
+           hi = apr_hash_next(hi))
+        {
+          svn_pool_clear(iterpool);
+          err = svn_wc__textbase_dehydrate(db, apr_hash_this_key(hi),
+                                           apr_hash_this_val(hi), iterpool);
+        }
+      svn_pool_destroy(iterpool);
+    }
+
+  return svn_error_trace(err);
+}
 
 svn_skel_t *
 svn_wc__wq_merge(svn_skel_t *work_item1,
@@ -1626,8 +2475,20 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
   SVN_ERR(svn_io_stat_dirent2(&dirent, local_abspath, FALSE, ignore_enoent,
                               wqb->result_pool, scratch_pool));
 
+  record_fileinfo(wqb, local_abspath, dirent);
+
+  return SVN_NO_ERROR;
+}
+
+/* Record DIRENT, allocated in WQB->RESULT_POOL, as the fileinfo of
+   LOCAL_ABSPATH once the current work item completes, if it is a file. */
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent)
+{
   if (dirent->kind != svn_node_file)
-    return SVN_NO_ERROR;
+    return;
 
   wqb->used = TRUE;
 
@@ -1636,6 +2497,4 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
 
   svn_hash_sets(wqb->record_map, apr_pstrdup(wqb->result_pool, local_abspath),
                 dirent);
-
-  return SVN_NO_ERROR;
 }
@@ -307,3 +307,49 @@ dav_svn__abort_txn(const dav_svn_repos *repos,
     }
   return NULL;
 }
+
+
+dav_error *
+dav_svn__check_txn_author(svn_fs_txn_t *txn,
+                          const dav_svn_repos *repos,
+                          apr_pool_t *pool)
+{
+  svn_error_t *serr;
+  svn_string_t *current_author;
+  svn_string_t request_author;
+
+  if (! repos->username)
+    return NULL;
+
+  serr = svn_fs_txn_prop(&current_author, txn, SVN_PROP_REVISION_AUTHOR,
+                         pool);
+  if (serr != NULL)
+    {
+      return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+               "Failed to retrieve author of the SVN FS transaction "
+               "corresponding to the specified activity.",
+               pool);
+    }
+
+  request_author.data = repos->username;
+  request_author.len = strlen(request_author.data);
+  if (!current_author)
+    {
+      serr = svn_fs_change_txn_prop(txn, SVN_PROP_REVISION_AUTHOR,
+                                    &request_author, pool);
+      if (serr != NULL)
+        {
+          return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                   "Failed to set the author of the SVN FS transaction "
+                   "corresponding to the specified activity.",
+                   pool);
+        }
+    }
+  else if (!svn_string_compare(current_author, &request_author))
+    {
+      return dav_svn__new_error(pool, HTTP_NOT_IMPLEMENTED, 0, 0,
+                                "Multi-author commits not supported.");
+    }
+
+  return NULL;
+}
@@ -98,6 +98,43 @@ dav_svn__allow_read(request_rec *r,
 }
 
 
+svn_boolean_t
+dav_svn__allow_write(request_rec *r,
+                     const dav_svn_repos *repos,
+                     const char *path,
+                     apr_pool_t *pool)
+{
+  const char *uri;
+  request_rec *subreq;
+  svn_boolean_t allowed = FALSE;
+
+  /* Unlike reads, writes are not exempted by 'SVNPathAuthz Off': the
+     authz modules would have checked the PUT or PROPPATCH this stands in
+     for no matter what that directive says. */
+
+  if (path && path[0] != '/')
+    path = apr_pstrcat(pool, "/", path, SVN_VA_NULL);
+
+  /* Build a Public Resource uri representing PATH. */
+  uri = dav_svn__build_uri(repos, DAV_SVN__BUILD_URI_PUBLIC,
+                           SVN_INVALID_REVNUM, path, FALSE /* add_href */,
+                           pool);
+
+  /* Check if PUT would work against this uri. */
+  subreq = ap_sub_req_method_uri("PUT", uri, r, r->output_filters);
+
+  if (subreq)
+    {
+      if (subreq->status == HTTP_OK)
+        allowed = TRUE;
+
+      ap_destroy_sub_req(subreq);
+    }
+
+  return allowed;
+}
+
+
 svn_boolean_t
 dav_svn__allow_list_repos(request_rec *r,
                           const char *repos_name,
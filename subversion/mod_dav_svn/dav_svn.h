@@ -234,6 +234,24 @@ typedef struct dav_svn_root {
 } dav_svn_root;
 
 
+/* Data shared by the members of a collection while a depth-1 walk (such
+   as a PROPFIND) visits them, so that what they have in common is looked
+   up only once.  Lives in the walk's scratch pool. */
+typedef struct dav_svn__walk_cache_t
+{
+  /* The created revision of the member currently being visited, or
+     SVN_INVALID_REVNUM if not yet known.  Reset for every member. */
+  svn_revnum_t created_rev;
+
+  /* Maps svn_revnum_t to the (unfiltered) apr_hash_t revprops of that
+     revision, for the revisions seen so far. */
+  apr_hash_t *revprops;
+
+  /* Where to allocate the above. */
+  apr_pool_t *pool;
+} dav_svn__walk_cache_t;
+
+
 /* internal structure to hold information about this resource */
 struct dav_resource_private {
   /* Path from the SVN repository root to this resource. This value has
@@ -306,6 +324,9 @@ struct dav_resource_private {
 
   /* resource is accessed by 'public' uri (not under "!svn") */
   svn_boolean_t is_public_uri;
+
+  /* set while this resource is a member visited by a depth-1 walk */
+  dav_svn__walk_cache_t *walk_cache;
 };
 
 
@@ -347,6 +368,28 @@ dav_svn__get_nodeprop_cache_flag(request_rec *r);
  * request? */
 svn_boolean_t dav_svn__get_block_read_flag(request_rec *r);
 
+/* for the repository referred to by this request, shall FSX persist its
+ * DAG cache lookups across server restarts? */
+svn_boolean_t dav_svn__get_dag_cache_snapshot_flag(request_rec *r);
+
+/* for the repository referred to by this request, shall encoded svndiff
+ * deltas be cached for reuse by other requests? */
+svn_boolean_t dav_svn__get_svndiff_cache_flag(request_rec *r);
+
+/* for the repository referred to by this request, what weight does its
+ * data have in the shared cache?  A decimal percentage, or NULL for the
+ * default. */
+const char *dav_svn__get_cache_weight(request_rec *r);
+
+/* Return the FS configuration hash to open the repository referred to
+   by this request with, as derived from the caching and block-read
+   directives above.  Allocate the result in POOL. */
+apr_hash_t *dav_svn__get_fs_config(request_rec *r, apr_pool_t *pool);
+
+/* for the repository referred to by this request, shall update reports
+ * be spooled before they are sent to the client? */
+svn_boolean_t dav_svn__get_spool_update_reports_flag(request_rec *r);
+
 /* for the repository referred to by this request, are subrequests bypassed?
  * A function pointer if yes, NULL if not.
  */
@@ -411,6 +454,12 @@ const char *dav_svn__get_xslt_uri(request_rec *r);
 /* ### Is this assumed to be URI-encoded? */
 const char *dav_svn__get_master_uri(request_rec *r);
 
+/* Return how long a slave server should wait for a revision that has
+   been committed through it to arrive from the master, before proxying
+   reads of that revision to the master instead.
+   Comes from the <SVNMasterSyncWait> directive. */
+apr_interval_time_t dav_svn__get_master_sync_wait(request_rec *r);
+
 /* Return the version of the master server (used for mirroring) iff a
    master URI is in place for this location; otherwise, return NULL.
    Comes from the <SVNMasterVersion> directive. */
@@ -490,6 +539,23 @@ svn_error_t *
 dav_svn__output_pass_brigade(dav_svn__output *output,
                              apr_bucket_brigade *bb);
 
+/* Until the next dav_svn__output_unspool(), collect everything written to
+   OUTPUT in a spill buffer allocated in POOL instead of sending it.  This
+   lets the producer finish, and release its resources, independent of
+   how fast the client reads the response.  The spill buffer keeps a
+   bounded amount of data in memory and the remainder in a temporary
+   file. */
+svn_error_t *
+dav_svn__output_spool(dav_svn__output *output,
+                      apr_pool_t *pool);
+
+/* Send everything collected since dav_svn__output_spool() down OUTPUT's
+   filter stack and stop collecting.  Do nothing if OUTPUT is not
+   spooling.  Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+dav_svn__output_unspool(dav_svn__output *output,
+                        apr_pool_t *scratch_pool);
+
 
 /*** activity.c ***/
 
@@ -514,6 +580,19 @@ dav_svn__abort_txn(const dav_svn_repos *repos,
                    const char *txn_name,
                    apr_pool_t *pool);
 
+/* Protect against multi-author commits:  If REPOS has an authenticated
+   user, set the svn:author property of TXN to that user's name unless
+   it has already been set.  Return an HTTP_NOT_IMPLEMENTED error if the
+   txn author differs from that user.  Use POOL for allocations.
+
+   Anonymous requests are not treated as a change in author, because the
+   commit may touch areas of the repository that are anonymous writeable
+   as well as areas that are not.  */
+dav_error *
+dav_svn__check_txn_author(svn_fs_txn_t *txn,
+                          const dav_svn_repos *repos,
+                          apr_pool_t *pool);
+
 /* Functions for looking up, storing, and deleting ACTIVITY->TXN mappings.  */
 const char *
 dav_svn__get_txn(const dav_svn_repos *repos, const char *activity_id);
@@ -533,12 +612,41 @@ int dav_svn__method_post(request_rec *r);
 /* Request handler to GET Subversion internal status (FSFS cache). */
 int dav_svn__status(request_rec *r);
 
+/* Request handler to GET the FSFS cache stats, the statistics counters
+   and the REPORT latencies of this process, and the number of active
+   transactions of the repository configured with SVNPath, if any, in
+   the Prometheus text exposition format. */
+int dav_svn__metrics(request_rec *r);
+
+/* Record that the REPORT called NAME took DURATION to deliver, for
+   dav_svn__metrics().  Unknown report names are ignored. */
+void dav_svn__record_report_duration(const char *name,
+                                     apr_interval_time_t duration);
+
 /*** repos.c ***/
 
 /* generate an ETag for RESOURCE and return it, allocated in POOL. */
 const char *
 dav_svn__getetag(const dav_resource *resource, apr_pool_t *pool);
 
+/* Set *CREATED_REV to the created revision of RESOURCE's repos_path
+   within its root, using the walk cache of RESOURCE if it has one.
+   Use POOL for temporary allocations. */
+svn_error_t *
+dav_svn__get_created_rev(svn_revnum_t *created_rev,
+                         const dav_resource *resource,
+                         apr_pool_t *pool);
+
+/* Set *PROPVAL to the value of revision property PROPNAME of REV in
+   RESOURCE's repository, without any authz checks, using the walk cache
+   of RESOURCE if it has one.  Allocate *PROPVAL in POOL. */
+svn_error_t *
+dav_svn__get_revprop(svn_string_t **propval,
+                     const dav_resource *resource,
+                     svn_revnum_t rev,
+                     const char *propname,
+                     apr_pool_t *pool);
+
 /*
   Construct a working resource for a given resource.
 
@@ -705,6 +813,7 @@ static const dav_report_elem dav_svn__reports_list[] = {
   { SVN_XML_NAMESPACE, SVN_DAV__MERGEINFO_REPORT },
   { SVN_XML_NAMESPACE, SVN_DAV__INHERITED_PROPS_REPORT },
   { SVN_XML_NAMESPACE, "list-report" },
+  { SVN_XML_NAMESPACE, "get-files-report" },
   { NULL, NULL },
 };
 
@@ -762,6 +871,11 @@ dav_svn__list_report(const dav_resource *resource,
                      const apr_xml_doc *doc,
                      dav_svn__output *output);
 
+dav_error *
+dav_svn__get_files_report(const dav_resource *resource,
+                          const apr_xml_doc *doc,
+                          dav_svn__output *output);
+
 /*** posts/ ***/
 
 /* The various POST handlers, defined in posts/, and used by repos.c.  */
@@ -773,6 +887,10 @@ dav_error *
 dav_svn__post_create_txn_with_props(const dav_resource *resource,
                                     svn_skel_t *request_skel,
                                     dav_svn__output *output);
+dav_error *
+dav_svn__post_apply_txn(const dav_resource *resource,
+                        svn_skel_t *request_skel,
+                        dav_svn__output *output);
 
 /*** authz.c ***/
 
@@ -802,6 +920,17 @@ dav_svn__allow_read(request_rec *r,
                     svn_revnum_t rev,
                     apr_pool_t *pool);
 
+/* Return TRUE iff the current user (as determined by Apache's
+   authentication system) has permission to write PATH in REPOS, as
+   judged by the authz modules loaded into Apache for a PUT to PATH's
+   public URI.  Use POOL for any temporary allocation.
+*/
+svn_boolean_t
+dav_svn__allow_write(request_rec *r,
+                     const dav_svn_repos *repos,
+                     const char *path,
+                     apr_pool_t *pool);
+
 /* Return TRUE iff the current user (as determined by Apache's
    authentication system) has permission to read RESOURCE in REV
    (where an invalid REV means "HEAD").  This will invoke any authz
@@ -1040,6 +1169,22 @@ dav_svn__make_base64_output_stream(apr_bucket_brigade *bb,
                                    dav_svn__output *output,
                                    apr_pool_t *pool);
 
+/* Write the svndiff of the file at TGT_ROOT:TGT_PATH against the file at
+   SRC_ROOT:SRC_PATH, or against the empty file if SRC_ROOT is NULL, to
+   STREAM and close it.  Encode it in SVNDIFF_VERSION at COMPRESSION_LEVEL.
+   If USE_CACHE is set, reuse the encoded svndiff from a process-wide
+   cache and remember it there.  Use POOL for all allocations. */
+svn_error_t *
+dav_svn__send_file_delta(svn_stream_t *stream,
+                         svn_fs_root_t *src_root,
+                         const char *src_path,
+                         svn_fs_root_t *tgt_root,
+                         const char *tgt_path,
+                         int svndiff_version,
+                         int compression_level,
+                         svn_boolean_t use_cache,
+                         apr_pool_t *pool);
+
 /* In INFO->r->subprocess_env set "SVN-ACTION" to LINE, "SVN-REPOS" to
  * INFO->repos->fs_path, and "SVN-REPOS-NAME" to INFO->repos->repo_basename. */
 void
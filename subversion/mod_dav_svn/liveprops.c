@@ -155,11 +155,8 @@ get_path_revprop(svn_string_t **propval,
 
   /* Get the property of the created revision. The authz is already
      performed, so we don't need to do it here too. */
-  return svn_repos_fs_revision_prop(propval,
-                                    resource->info->repos->repos,
-                                    committed_rev,
-                                    propname,
-                                    NULL, NULL, pool);
+  return dav_svn__get_revprop(propval, resource, committed_rev, propname,
+                              pool);
 }
 
 
@@ -201,9 +198,7 @@ get_last_modified_time(const char **datestring,
            || resource->type == DAV_RESOURCE_TYPE_WORKING
            || resource->type == DAV_RESOURCE_TYPE_VERSION)
     {
-      serr = svn_fs_node_created_rev(&committed_rev,
-                                     resource->info->root.root,
-                                     resource->info->repos_path, pool);
+      serr = dav_svn__get_created_rev(&committed_rev, resource, pool);
       if (serr != NULL)
         {
           svn_error_clear(serr);
@@ -380,10 +375,8 @@ insert_prop_internal(const dav_resource *resource,
           {
             /* Get the CR field out of the node's skel.  Notice that the
                root object might be an ID root -or- a revision root. */
-            serr = svn_fs_node_created_rev(&committed_rev,
-                                           resource->info->root.root,
-                                           resource->info->repos_path,
-                                           scratch_pool);
+            serr = dav_svn__get_created_rev(&committed_rev, resource,
+                                            scratch_pool);
             if (serr != NULL)
               {
                 ap_log_rerror(APLOG_MARK, APLOG_ERR, serr->apr_err,
@@ -644,10 +637,8 @@ insert_prop_internal(const dav_resource *resource,
 
           /* Get the CR field out of the node's skel.  Notice that the
              root object might be an ID root -or- a revision root. */
-          serr = svn_fs_node_created_rev(&committed_rev,
-                                         resource->info->root.root,
-                                         resource->info->repos_path,
-                                         scratch_pool);
+          serr = dav_svn__get_created_rev(&committed_rev, resource,
+                                          scratch_pool);
           if (serr != NULL)
             {
               ap_log_rerror(APLOG_MARK, APLOG_ERR, serr->apr_err,
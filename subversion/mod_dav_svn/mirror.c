@@ -24,14 +24,24 @@
 #include <assert.h>
 
 #include <apr_strmatch.h>
+#include <apr_time.h>
 
 #include <httpd.h>
 #include <http_core.h>
 
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_pools.h"
+#include "svn_repos.h"
+
 #include "private/svn_fspath.h"
 
+#include "mod_dav_svn.h"
 #include "dav_svn.h"
 
+/* How often to look for a revision to arrive while waiting for it. */
+#define SYNC_POLL_INTERVAL apr_time_from_msec(50)
+
 
 /* Tweak the request record R, and add the necessary filters, so that
    the request is ready to be proxied away.  MASTER_URI is the URI
@@ -76,6 +86,118 @@ static int proxy_request_fixup(request_rec *r,
 }
 
 
+/* Return the revision that URI_SEGMENT (as in proxy_request_fixup())
+   refers to explicitly, i.e. through one of the revision-pinned special
+   URIs below SPECIAL_URI, or SVN_INVALID_REVNUM if there is none. */
+static svn_revnum_t get_pinned_revision(const char *uri_segment,
+                                        const char *special_uri,
+                                        apr_pool_t *pool)
+{
+    static const char *const pinned_types[]
+      = { "rev/", "rvr/", "bc/", "ver/", "bln/", NULL };
+    const char *p;
+    int i;
+
+    p = ap_strstr_c(uri_segment, apr_pstrcat(pool, "/", special_uri, "/",
+                                             SVN_VA_NULL));
+    if (!p)
+        return SVN_INVALID_REVNUM;
+
+    p += strlen(special_uri) + 2;
+    for (i = 0; pinned_types[i]; i++) {
+        apr_size_t len = strlen(pinned_types[i]);
+
+        if (strncmp(p, pinned_types[i], len) == 0) {
+            svn_revnum_t rev;
+            const char *end;
+            svn_error_t *err = svn_revnum_parse(&rev, p + len, &end);
+
+            if (err || (*end != '\0' && *end != '/')) {
+                svn_error_clear(err);
+                return SVN_INVALID_REVNUM;
+            }
+
+            return rev;
+        }
+    }
+
+    return SVN_INVALID_REVNUM;
+}
+
+/* Set *YOUNGEST to the youngest revision of the repository at REPOS_PATH
+   as recorded in its db/current file, i.e. without opening the repository.
+   FSFS and FSX replace that file atomically upon commit, so it must be
+   re-opened for every read.  Return an error if the file does not exist
+   or can't be parsed, e.g. for BDB repositories. */
+static svn_error_t *read_youngest(svn_revnum_t *youngest,
+                                  const char *repos_path,
+                                  apr_pool_t *pool)
+{
+    svn_stringbuf_t *content;
+
+    SVN_ERR(svn_stringbuf_from_file2(&content,
+                                     svn_dirent_join_many(pool, repos_path,
+                                                          "db", "current",
+                                                          SVN_VA_NULL),
+                                     pool));
+    return svn_error_trace(svn_revnum_parse(youngest, content->data, NULL));
+}
+
+/* Return TRUE if the local repository of request R has revision REV or
+   gets it within the configured SVNMasterSyncWait.  This gives clients
+   that commit through a slave server a consistent view of their own
+   changes without waiting for them in their next request.
+
+   This runs for every revision-pinned read, so usually just look at the
+   repository's db/current file.  Only if that isn't available, open the
+   repository the way the regular request processing does. */
+static svn_boolean_t wait_for_revision(request_rec *r,
+                                       svn_revnum_t rev)
+{
+    apr_time_t deadline = apr_time_now() + dav_svn__get_master_sync_wait(r);
+    apr_pool_t *pool = svn_pool_create(r->pool);
+    const char *repos_path;
+    svn_repos_t *repos = NULL;
+    svn_revnum_t youngest = SVN_INVALID_REVNUM;
+    svn_error_t *err;
+    dav_error *derr;
+
+    derr = dav_svn_get_repos_path2(r, dav_svn__get_root_dir(r),
+                                   &repos_path, pool);
+    if (derr) {
+        svn_pool_destroy(pool);
+        return TRUE;
+    }
+
+    err = read_youngest(&youngest, repos_path, pool);
+    if (err) {
+        svn_error_clear(err);
+        err = svn_repos_open3(&repos, repos_path,
+                              dav_svn__get_fs_config(r, pool), pool, pool);
+        if (!err)
+            err = svn_fs_youngest_rev(&youngest, svn_repos_fs(repos), pool);
+    }
+
+    while (!err && youngest < rev && apr_time_now() < deadline) {
+        apr_sleep(SYNC_POLL_INTERVAL);
+
+        if (repos)
+            err = svn_fs_youngest_rev(&youngest, svn_repos_fs(repos), pool);
+        else
+            err = read_youngest(&youngest, repos_path, pool);
+    }
+
+    svn_pool_destroy(pool);
+
+    /* Let the regular request processing report any errors. */
+    if (err) {
+        svn_error_clear(err);
+        return TRUE;
+    }
+
+    return youngest >= rev;
+}
+
 int dav_svn__proxy_request_fixup(request_rec *r)
 {
     const char *root_dir, *master_uri, *special_uri;
@@ -112,6 +234,20 @@ int dav_svn__proxy_request_fixup(request_rec *r)
                     rv = proxy_request_fixup(r, master_uri, seg);
                     if (rv) return rv;
                 }
+                else {
+                    /* Revisions that haven't been synced yet, typically
+                       those just committed through us, are only known to
+                       the master. */
+                    svn_revnum_t rev;
+
+                    seg += strlen(root_dir);
+                    rev = get_pinned_revision(seg, special_uri, r->pool);
+                    if (SVN_IS_VALID_REVNUM(rev)
+                        && !wait_for_revision(r, rev)) {
+                        int rv = proxy_request_fixup(r, master_uri, seg);
+                        if (rv) return rv;
+                    }
+                }
             }
             return OK;
         }
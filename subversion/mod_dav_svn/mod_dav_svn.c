@@ -43,6 +43,8 @@
 #include "mod_dav_svn.h"
 
 #include "private/svn_fspath.h"
+#include "private/svn_log.h"
+#include "private/svn_stats.h"
 #include "private/svn_subr_private.h"
 
 #include "dav_svn.h"
@@ -101,12 +103,17 @@ typedef struct dir_conf_t {
   const char *root_dir;              /* our top-level directory */
   const char *master_uri;            /* URI to the master SVN repos */
   svn_version_t *master_version;     /* version of master server */
+  int master_sync_wait;              /* msecs to wait for svnsync; -1=unset */
   const char *activities_db;         /* path to activities database(s) */
   enum conf_flag txdelta_cache;      /* whether to enable txdelta caching */
   enum conf_flag fulltext_cache;     /* whether to enable fulltext caching */
   enum conf_flag revprop_cache;      /* whether to enable revprop caching */
   enum conf_flag nodeprop_cache;     /* whether to enable nodeprop caching */
   enum conf_flag block_read;         /* whether to enable block read mode */
+  enum conf_flag dag_cache_snapshot; /* whether to persist FSX dag lookups */
+  enum conf_flag svndiff_cache;      /* whether to cache encoded deltas */
+  enum conf_flag spool_updates;      /* whether to spool update reports */
+  const char *cache_weight;          /* repository's weight in the cache */
   const char *hooks_env;             /* path to hook script env config file */
 } dir_conf_t;
 
@@ -150,6 +157,11 @@ init(apr_pool_t *p, apr_pool_t *plog, apr_pool_t *ptemp, server_rec *s)
   conf = ap_get_module_config(s->module_config, &dav_svn_module);
   svn_utf_initialize2(conf->use_utf8, p);
 
+  /* A cache shared by all worker processes must exist before they get
+     forked off this one. */
+  if (svn_cache_config2_get()->shared_memory)
+    svn_cache_config_preallocate();
+
   return OK;
 }
 
@@ -254,6 +266,7 @@ create_dir_config(apr_pool_t *p, char *dir)
   conf->hooks_env = NULL;
   conf->txdelta_cache = CONF_FLAG_DEFAULT;
   conf->nodeprop_cache = CONF_FLAG_DEFAULT;
+  conf->master_sync_wait = -1;
 
   return conf;
 }
@@ -272,6 +285,9 @@ merge_dir_config(apr_pool_t *p, void *base, void *overrides)
   newconf->fs_path = INHERIT_VALUE(parent, child, fs_path);
   newconf->master_uri = INHERIT_VALUE(parent, child, master_uri);
   newconf->master_version = INHERIT_VALUE(parent, child, master_version);
+  newconf->master_sync_wait = child->master_sync_wait >= 0
+                            ? child->master_sync_wait
+                            : parent->master_sync_wait;
   newconf->activities_db = INHERIT_VALUE(parent, child, activities_db);
   newconf->repo_name = INHERIT_VALUE(parent, child, repo_name);
   newconf->xslt_uri = INHERIT_VALUE(parent, child, xslt_uri);
@@ -286,6 +302,11 @@ merge_dir_config(apr_pool_t *p, void *base, void *overrides)
   newconf->revprop_cache = INHERIT_VALUE(parent, child, revprop_cache);
   newconf->nodeprop_cache = INHERIT_VALUE(parent, child, nodeprop_cache);
   newconf->block_read = INHERIT_VALUE(parent, child, block_read);
+  newconf->dag_cache_snapshot = INHERIT_VALUE(parent, child,
+                                              dag_cache_snapshot);
+  newconf->svndiff_cache = INHERIT_VALUE(parent, child, svndiff_cache);
+  newconf->spool_updates = INHERIT_VALUE(parent, child, spool_updates);
+  newconf->cache_weight = INHERIT_VALUE(parent, child, cache_weight);
   newconf->root_dir = INHERIT_VALUE(parent, child, root_dir);
   newconf->hooks_env = INHERIT_VALUE(parent, child, hooks_env);
 
@@ -345,6 +366,26 @@ SVNMasterURI_cmd(cmd_parms *cmd, void *config, const char *arg1)
 }
 
 
+static const char *
+SVNMasterSyncWait_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  dir_conf_t *conf = config;
+  int value = 0;
+  svn_error_t *err = svn_cstring_atoi(&value, arg1);
+
+  if (err || value < 0)
+    {
+      svn_error_clear(err);
+      return "SVNMasterSyncWait requires a non-negative number of "
+             "milliseconds.";
+    }
+
+  conf->master_sync_wait = value;
+
+  return NULL;
+}
+
+
 static const char *
 SVNMasterVersion_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -611,6 +652,63 @@ SVNBlockRead_cmd(cmd_parms *cmd, void *config, int arg)
   return NULL;
 }
 
+static const char *
+SVNDagCacheSnapshot_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->dag_cache_snapshot = CONF_FLAG_ON;
+  else
+    conf->dag_cache_snapshot = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
+static const char *
+SVNCacheEncodedDeltas_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->svndiff_cache = CONF_FLAG_ON;
+  else
+    conf->svndiff_cache = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
+static const char *
+SVNCacheWeight_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  dir_conf_t *conf = config;
+  apr_int64_t value;
+  svn_error_t *err = svn_cstring_strtoi64(&value, arg1, 1, 10000, 10);
+
+  if (err)
+    {
+      svn_error_clear(err);
+      return "SVNCacheWeight requires a percentage between 1 and 10000.";
+    }
+
+  conf->cache_weight = apr_psprintf(cmd->pool, "%" APR_INT64_T_FMT, value);
+
+  return NULL;
+}
+
+static const char *
+SVNSpoolUpdateReports_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  dir_conf_t *conf = config;
+
+  if (arg)
+    conf->spool_updates = CONF_FLAG_ON;
+  else
+    conf->spool_updates = CONF_FLAG_OFF;
+
+  return NULL;
+}
+
 static const char *
 SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -631,6 +729,28 @@ SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNInMemoryCacheShared_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  svn_cache_config2_t settings = *svn_cache_config2_get();
+
+  settings.shared_memory = arg;
+
+  svn_cache_config2_set(&settings);
+
+  return NULL;
+}
+
+static const char *
+SVNCollectStats_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  /* Counters decide at their first use whether to collect data, which
+     happens only after the configuration has been read. */
+  svn_stats__set_enabled(arg);
+
+  return NULL;
+}
+
 static const char *
 SVNCompressionLevel_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -797,6 +917,21 @@ dav_svn__get_master_uri(request_rec *r)
 }
 
 
+apr_interval_time_t
+dav_svn__get_master_sync_wait(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* don't wait by default. */
+  if (conf->master_sync_wait < 0)
+    return 0;
+
+  return apr_time_from_msec(conf->master_sync_wait);
+}
+
+
 svn_version_t *
 dav_svn__get_master_version(request_rec *r)
 {
@@ -1034,6 +1169,72 @@ dav_svn__get_block_read_flag(request_rec *r)
   return get_conf_flag(conf->block_read, FALSE);
 }
 
+svn_boolean_t
+dav_svn__get_dag_cache_snapshot_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* DAG cache snapshots are disabled by default. */
+  return get_conf_flag(conf->dag_cache_snapshot, FALSE);
+}
+
+svn_boolean_t
+dav_svn__get_svndiff_cache_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* caching encoded deltas is disabled by default. */
+  return get_conf_flag(conf->svndiff_cache, FALSE);
+}
+
+const char *
+dav_svn__get_cache_weight(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+  return conf->cache_weight;
+}
+
+apr_hash_t *
+dav_svn__get_fs_config(request_rec *r, apr_pool_t *pool)
+{
+  apr_hash_t *fs_config = apr_hash_make(pool);
+
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_DELTAS,
+                dav_svn__get_txdelta_cache_flag(r) ? "1" :"0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_FULLTEXTS,
+                dav_svn__get_fulltext_cache_flag(r) ? "1" :"0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_REVPROPS,
+                dav_svn__get_revprop_cache_flag(r) ? "2" :"0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NODEPROPS,
+                dav_svn__get_nodeprop_cache_flag(r) ? "1" :"0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ,
+                dav_svn__get_block_read_flag(r) ? "1" :"0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSX_DAG_CACHE_SNAPSHOT,
+                dav_svn__get_dag_cache_snapshot_flag(r) ? "1" :"0");
+  if (dav_svn__get_cache_weight(r))
+    svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_WEIGHT,
+                  dav_svn__get_cache_weight(r));
+
+  return fs_config;
+}
+
+svn_boolean_t
+dav_svn__get_spool_update_reports_flag(request_rec *r)
+{
+  dir_conf_t *conf;
+
+  conf = ap_get_module_config(r->per_dir_config, &dav_svn_module);
+
+  /* spooling update reports is disabled by default. */
+  return get_conf_flag(conf->spool_updates, FALSE);
+}
+
 int
 dav_svn__get_compression_level(request_rec *r)
 {
@@ -1329,6 +1530,14 @@ static const command_rec cmds[] =
   AP_INIT_TAKE1("SVNMasterURI", SVNMasterURI_cmd, NULL, ACCESS_CONF,
                 "specifies a URI to access a master Subversion repository"),
 
+  /* per directory/location */
+  AP_INIT_TAKE1("SVNMasterSyncWait", SVNMasterSyncWait_cmd, NULL,
+                ACCESS_CONF,
+                "specifies how many milliseconds a slave server waits for "
+                "a revision it doesn't have yet to be synced from the "
+                "master, before letting the master serve the request "
+                "(default is 0)."),
+
   /* per directory/location */
   AP_INIT_TAKE1("SVNMasterVersion", SVNMasterVersion_cmd, NULL, ACCESS_CONF,
                 "specifies the Subversion release version of a master "
@@ -1389,6 +1598,34 @@ static const command_rec cmds[] =
                "caches (see SVNInMemoryCacheSize) have been configured."
                "(default is Off)."),
 
+  /* per directory/location */
+  AP_INIT_FLAG("SVNDagCacheSnapshot", SVNDagCacheSnapshot_cmd, NULL,
+               ACCESS_CONF|RSRC_CONF,
+               "speeds up the first requests to FSX repositories after "
+               "server restarts by persisting path lookups "
+               "(default is Off)."),
+
+  /* per directory/location */
+  AP_INIT_FLAG("SVNCacheEncodedDeltas", SVNCacheEncodedDeltas_cmd, NULL,
+               ACCESS_CONF|RSRC_CONF,
+               "speeds up many clients updating to the same revision by "
+               "keeping encoded deltas in the in-memory cache "
+               "(see SVNInMemoryCacheSize; default is Off)."),
+
+  /* per directory/location */
+  AP_INIT_TAKE1("SVNCacheWeight", SVNCacheWeight_cmd, NULL,
+                ACCESS_CONF|RSRC_CONF,
+                "specifies the weight, in percent, of the repository's data "
+                "in the in-memory cache shared by all repositories; lower it "
+                "for rarely used repositories (default is 100)."),
+
+  /* per directory/location */
+  AP_INIT_FLAG("SVNSpoolUpdateReports", SVNSpoolUpdateReports_cmd, NULL,
+               ACCESS_CONF|RSRC_CONF,
+               "collects update responses in a temporary buffer, so the "
+               "repository work completes quickly even for slow clients "
+               "(default is Off)."),
+
   /* per server */
   AP_INIT_TAKE1("SVNInMemoryCacheSize", SVNInMemoryCacheSize_cmd, NULL,
                 RSRC_CONF,
@@ -1396,6 +1633,19 @@ static const command_rec cmds[] =
                 "in-memory object cache (default value is 16384; 0 switches "
                 "to dynamically sized caches)."),
   /* per server */
+  AP_INIT_FLAG("SVNInMemoryCacheShared", SVNInMemoryCacheShared_cmd, NULL,
+               RSRC_CONF,
+               "enables or disables sharing Subversion's in-memory object "
+               "cache between all worker processes.  SVNInMemoryCacheSize "
+               "then applies to the whole server (default is Off)."),
+  /* per server */
+  AP_INIT_FLAG("SVNCollectStats", SVNCollectStats_cmd, NULL,
+               RSRC_CONF,
+               "enables or disables collecting Subversion's internal "
+               "statistics counters, such as FSFS lock wait times, for "
+               "the svn-metrics handler and the per-request SVN-STATS "
+               "log variable (default is Off)."),
+  /* per server */
   AP_INIT_TAKE1("SVNCompressionLevel", SVNCompressionLevel_cmd, NULL,
                 RSRC_CONF,
                 "specifies the compression level used before sending file "
@@ -1419,6 +1669,60 @@ static const command_rec cmds[] =
 };
 
 
+/* Implements the #post_read_request hook.  If statistics get collected,
+ * take a snapshot of the counters, so that log_request_stats() can
+ * report the costs of this request. */
+static int
+snapshot_request_stats(request_rec *r)
+{
+  apr_array_header_t *infos;
+  svn_error_t *err;
+
+  if (!svn_stats__enabled())
+    return DECLINED;
+
+  err = svn_stats__get_info(&infos, r->pool);
+  if (err)
+    svn_error_clear(err);
+  else
+    ap_set_module_config(r->request_config, &dav_svn_module, infos);
+
+  return DECLINED;
+}
+
+/* Implements the #log_transaction hook.  For requests that set an
+ * operational log entry (SVN-ACTION), set SVN-STATS to the costs of the
+ * request as described for svn_log__stats().  This runs before
+ * mod_log_config writes the log entries. */
+static int
+log_request_stats(request_rec *r)
+{
+  apr_array_header_t *before
+    = ap_get_module_config(r->request_config, &dav_svn_module);
+  apr_array_header_t *after, *changes = NULL;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  if (!apr_table_get(r->subprocess_env, "SVN-ACTION"))
+    return DECLINED;
+
+  if (before)
+    {
+      err = svn_stats__get_info(&after, r->pool);
+      if (!err)
+        err = svn_stats__get_changes(&changes, before, after, r->pool);
+    }
+
+  if (err)
+    svn_error_clear(err);
+  else
+    apr_table_set(r->subprocess_env, "SVN-STATS",
+                  svn_log__stats(apr_time_now() - r->request_time, changes,
+                                 r->pool));
+
+  return DECLINED;
+}
+
+
 static dav_provider provider =
 {
   &dav_svn__hooks_repository,
@@ -1452,6 +1756,14 @@ register_hooks(apr_pool_t *pconf)
   /* Handler to GET Subversion's FSFS cache stats, a bit like mod_status. */
   ap_hook_handler(dav_svn__status, NULL, NULL, APR_HOOK_MIDDLE);
 
+  /* The same and more, for monitoring systems. */
+  ap_hook_handler(dav_svn__metrics, NULL, NULL, APR_HOOK_MIDDLE);
+
+  /* Per-request costs for the operational log. */
+  ap_hook_post_read_request(snapshot_request_stats, NULL, NULL,
+                            APR_HOOK_MIDDLE);
+  ap_hook_log_transaction(log_request_stats, NULL, NULL, APR_HOOK_FIRST);
+
   /* live property handling */
   dav_hook_gather_propsets(dav_svn__gather_propsets, NULL, NULL,
                            APR_HOOK_MIDDLE);
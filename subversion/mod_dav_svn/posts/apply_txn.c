@@ -0,0 +1,344 @@
+/*
+ * apply_txn.c: mod_dav_svn POST handler for applying many changes to a
+ *              commit transaction at once
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_strings.h>
+
+#include <httpd.h>
+#include <mod_dav.h>
+
+#include "svn_dav.h"
+#include "svn_delta.h"
+#include "svn_fs.h"
+#include "svn_pools.h"
+#include "svn_repos.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_skel.h"
+
+#include "../dav_svn.h"
+
+/* Return the contents of atom SKEL as a NUL-terminated string allocated
+   in POOL, or NULL if SKEL is an empty atom.  Return NULL as well if SKEL
+   is not an atom, but set *MALFORMED in that case. */
+static const char *
+atom_cstring(svn_boolean_t *malformed,
+             const svn_skel_t *skel,
+             apr_pool_t *pool)
+{
+  if (!skel || !skel->is_atom)
+    {
+      *malformed = TRUE;
+      return NULL;
+    }
+
+  if (skel->len == 0)
+    return NULL;
+
+  return apr_pstrmemdup(pool, skel->data, skel->len);
+}
+
+/* Set *REPOS_PATH to the canonical repository path named by atom SKEL,
+   after verifying that the user may write to it. */
+static svn_error_t *
+get_writable_path(const char **repos_path,
+                  const dav_resource *resource,
+                  const svn_skel_t *skel,
+                  apr_pool_t *pool)
+{
+  svn_boolean_t malformed = FALSE;
+  const char *path = atom_cstring(&malformed, skel, pool);
+
+  if (malformed || !path)
+    return svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                            "Missing path in apply-txn operation");
+
+  *repos_path = svn_fspath__canonicalize(path, pool);
+
+  /* These changes bypass the per-URI checks a PUT or PROPPATCH would
+     get, so ask the authz modules the same question they would ask. */
+  if (!dav_svn__allow_write(resource->info->r, resource->info->repos,
+                            *repos_path, pool))
+    return svn_error_createf(SVN_ERR_AUTHZ_UNWRITABLE, NULL,
+                             "Access to '%s' forbidden", *repos_path);
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that the file at REPOS_PATH in TXN_ROOT has not been changed
+   since the BASE_REV named by atom SKEL, the way do_out_of_date_check()
+   in repos.c does for a PUT with an X-SVN-Version-Name header. */
+static svn_error_t *
+check_out_of_date(svn_fs_root_t *txn_root,
+                  const char *repos_path,
+                  const svn_skel_t *skel,
+                  apr_pool_t *pool)
+{
+  svn_boolean_t malformed = FALSE;
+  const char *base_rev_str = atom_cstring(&malformed, skel, pool);
+  svn_revnum_t base_rev;
+  svn_revnum_t created_rev;
+
+  if (malformed)
+    return svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                            "Malformed base revision in apply-txn operation");
+
+  if (!base_rev_str)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_revnum_parse(&base_rev, base_rev_str, NULL));
+  SVN_ERR(svn_fs_node_created_rev(&created_rev, txn_root, repos_path, pool));
+
+  if (! SVN_IS_VALID_REVNUM(created_rev))
+    return SVN_NO_ERROR;
+
+  if (base_rev < created_rev)
+    return svn_error_createf(SVN_ERR_RA_OUT_OF_DATE, NULL,
+                             "File '%s' is out of date", repos_path);
+
+  if (base_rev > svn_fs_txn_root_base_revision(txn_root))
+    return svn_error_createf(SVN_ERR_FS_NO_SUCH_REVISION, NULL,
+                             "No such revision %ld", base_rev);
+
+  return SVN_NO_ERROR;
+}
+
+/* Apply a "put" operation OP_SKEL to TXN_ROOT.
+ *
+ * Syntax:  ( put PATH BASE-REV BASE-MD5 RESULT-MD5 SVNDIFF )
+ *
+ * Any of BASE-REV, BASE-MD5 and RESULT-MD5 may be empty atoms.  Like a
+ * PUT, this creates the file if it doesn't exist yet; an empty SVNDIFF
+ * leaves it empty, like a PUT of a zero-byte plain text body.
+ */
+static svn_error_t *
+apply_put(const dav_resource *resource,
+          svn_fs_root_t *txn_root,
+          const svn_skel_t *op_skel,
+          apr_pool_t *pool)
+{
+  const svn_skel_t *path_skel = op_skel->children->next;
+  const svn_skel_t *svndiff_skel;
+  const char *repos_path;
+  const char *base_checksum;
+  const char *result_checksum;
+  svn_boolean_t malformed = FALSE;
+  svn_node_kind_t kind;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_stream_t *stream;
+  apr_size_t len;
+
+  if (svn_skel__list_length(op_skel) != 6)
+    return svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                            "Malformed apply-txn 'put' operation");
+
+  base_checksum = atom_cstring(&malformed, path_skel->next->next, pool);
+  result_checksum = atom_cstring(&malformed, path_skel->next->next->next,
+                                 pool);
+  svndiff_skel = path_skel->next->next->next->next;
+  if (malformed || !svndiff_skel->is_atom)
+    return svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                            "Malformed apply-txn 'put' operation");
+
+  SVN_ERR(get_writable_path(&repos_path, resource, path_skel, pool));
+  SVN_ERR(check_out_of_date(txn_root, repos_path, path_skel->next, pool));
+
+  SVN_ERR(svn_fs_check_path(&kind, txn_root, repos_path, pool));
+  if (kind == svn_node_none)
+    SVN_ERR(svn_fs_make_file(txn_root, repos_path, pool));
+
+  SVN_ERR(svn_fs_apply_textdelta(&handler, &handler_baton, txn_root,
+                                 repos_path, base_checksum, result_checksum,
+                                 pool));
+
+  if (svndiff_skel->len == 0)
+    return svn_error_trace(handler(NULL, handler_baton));
+
+  stream = svn_txdelta_parse_svndiff(handler, handler_baton, TRUE, pool);
+  len = svndiff_skel->len;
+  SVN_ERR(svn_stream_write(stream, svndiff_skel->data, &len));
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+/* Apply a "props" operation OP_SKEL to TXN_ROOT.
+ *
+ * Syntax:  ( props PATH BASE-REV ( PROPNAME PROPVAL ... ) ( PROPNAME ... ) )
+ *
+ * The first list holds the properties to set, the second those to
+ * delete.  BASE-REV may be an empty atom.
+ */
+static svn_error_t *
+apply_props(const dav_resource *resource,
+            svn_fs_root_t *txn_root,
+            const svn_skel_t *op_skel,
+            apr_pool_t *pool)
+{
+  const svn_skel_t *path_skel = op_skel->children->next;
+  const svn_skel_t *set_skel;
+  const svn_skel_t *del_skel;
+  const svn_skel_t *elt;
+  const char *repos_path;
+  apr_hash_t *props;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool;
+
+  if (svn_skel__list_length(op_skel) != 5)
+    return svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                            "Malformed apply-txn 'props' operation");
+
+  set_skel = path_skel->next->next;
+  del_skel = set_skel->next;
+  if (del_skel->is_atom)
+    return svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                            "Malformed apply-txn 'props' operation");
+
+  SVN_ERR(svn_skel__parse_proplist(&props, set_skel, pool));
+  SVN_ERR(get_writable_path(&repos_path, resource, path_skel, pool));
+  SVN_ERR(check_out_of_date(txn_root, repos_path, path_skel->next, pool));
+
+  iterpool = svn_pool_create(pool);
+  for (hi = apr_hash_first(pool, props); hi; hi = apr_hash_next(hi))
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_repos_fs_change_node_prop(txn_root, repos_path,
+                                            apr_hash_this_key(hi),
+                                            apr_hash_this_val(hi),
+                                            iterpool));
+    }
+
+  for (elt = del_skel->children; elt; elt = elt->next)
+    {
+      if (!elt->is_atom)
+        return svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                                "Malformed apply-txn 'props' operation");
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_repos_fs_change_node_prop(txn_root, repos_path,
+                                            apr_pstrmemdup(iterpool,
+                                                           elt->data,
+                                                           elt->len),
+                                            NULL, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Respond to an "apply-txn" POST request.
+ *
+ * Syntax:  ( apply-txn OP ... )
+ *
+ * where each OP is one of the operations described at apply_put() and
+ * apply_props().  The transaction is named by the SVN_DAV_TXN_NAME_HEADER
+ * or SVN_DAV_VTXN_NAME_HEADER request header.  Paths are repository
+ * paths.  The operations are applied in order; if one fails, the
+ * previous ones stay in the transaction and the client is expected to
+ * abort the commit.
+ */
+dav_error *
+dav_svn__post_apply_txn(const dav_resource *resource,
+                        svn_skel_t *request_skel,
+                        dav_svn__output *output)
+{
+  request_rec *r = resource->info->r;
+  const char *txn_name;
+  const char *vtxn_name;
+  const svn_skel_t *op_skel;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_error_t *serr;
+  dav_error *derr;
+  apr_pool_t *iterpool;
+
+  txn_name = apr_table_get(r->headers_in, SVN_DAV_TXN_NAME_HEADER);
+  vtxn_name = apr_table_get(r->headers_in, SVN_DAV_VTXN_NAME_HEADER);
+  if (vtxn_name && vtxn_name[0])
+    txn_name = dav_svn__get_txn(resource->info->repos, vtxn_name);
+
+  if (!txn_name || !txn_name[0])
+    return dav_svn__new_error(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                              "An unknown txn name was specified in the "
+                              "request.");
+
+  if ((serr = svn_fs_open_txn(&txn, resource->info->repos->fs, txn_name,
+                              resource->pool)))
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Could not open the transaction.",
+                                resource->pool);
+
+  /* A PUT or PROPPATCH to the txn would run the same check. */
+  derr = dav_svn__check_txn_author(txn, resource->info->repos,
+                                   resource->pool);
+  if (derr)
+    return derr;
+
+  if ((serr = svn_fs_txn_root(&txn_root, txn, resource->pool)))
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Could not open the transaction root.",
+                                resource->pool);
+
+  iterpool = svn_pool_create(resource->pool);
+  for (op_skel = request_skel->children->next;
+       op_skel && !serr;
+       op_skel = op_skel->next)
+    {
+      svn_pool_clear(iterpool);
+
+      if (svn_skel__list_length(op_skel) < 2)
+        serr = svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                                "Malformed apply-txn operation");
+      else if (svn_skel__matches_atom(op_skel->children, "put"))
+        serr = apply_put(resource, txn_root, op_skel, iterpool);
+      else if (svn_skel__matches_atom(op_skel->children, "props"))
+        serr = apply_props(resource, txn_root, op_skel, iterpool);
+      else
+        serr = svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                                "Unsupported apply-txn operation");
+    }
+  svn_pool_destroy(iterpool);
+
+  if (serr)
+    {
+      int status;
+
+      if (serr->apr_err == SVN_ERR_DAV_MALFORMED_DATA)
+        status = HTTP_BAD_REQUEST;
+      else if (serr->apr_err == SVN_ERR_AUTHZ_UNWRITABLE)
+        status = HTTP_FORBIDDEN;
+      else if (serr->apr_err == SVN_ERR_RA_OUT_OF_DATE)
+        status = HTTP_CONFLICT;
+      else
+        status = HTTP_INTERNAL_SERVER_ERROR;
+
+      return dav_svn__convert_err(serr, status,
+                                  "Could not apply the changes to the "
+                                  "transaction.",
+                                  resource->pool);
+    }
+
+  r->status = HTTP_NO_CONTENT;
+
+  return NULL;
+}
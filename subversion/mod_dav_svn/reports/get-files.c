@@ -0,0 +1,272 @@
+/*
+ * get-files.c: mod_dav_svn REPORT handler for fetching many files at once
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_xml.h>
+
+#include <mod_dav.h>
+
+#include "svn_repos.h"
+#include "svn_fs.h"
+#include "svn_types.h"
+#include "svn_xml.h"
+#include "svn_dav.h"
+#include "svn_delta.h"
+#include "svn_pools.h"
+
+#include "../dav_svn.h"
+
+/* Files larger than this are not sent inline; the client is told to GET
+   them separately, so that they stay cacheable by HTTP proxies. */
+#define MAX_INLINE_FILE_SIZE (64 * 1024)
+
+/* State of a single get-files REPORT. */
+typedef struct get_files_baton_t
+{
+  const dav_resource *resource;
+
+  /* this buffers the output for a bit and is automatically flushed,
+     at appropriate times, by the Apache filter system. */
+  apr_bucket_brigade *bb;
+
+  /* where to deliver the output */
+  dav_svn__output *output;
+
+  /* The root of the most recently used revision, cached because
+     consecutive files often come from the same revision. */
+  svn_fs_root_t *root;
+  svn_revnum_t root_rev;
+  apr_pool_t *root_pool;
+
+  int svndiff_version;
+  int compression_level;
+  svn_boolean_t use_svndiff_cache;
+} get_files_baton_t;
+
+
+/* Set *ROOT to the root of revision REV, using the cache in GFB. */
+static svn_error_t *
+get_root(svn_fs_root_t **root,
+         get_files_baton_t *gfb,
+         svn_revnum_t rev)
+{
+  if (!gfb->root || gfb->root_rev != rev)
+    {
+      svn_pool_clear(gfb->root_pool);
+      gfb->root = NULL;
+      SVN_ERR(svn_fs_revision_root(&gfb->root,
+                                   gfb->resource->info->repos->fs,
+                                   rev, gfb->root_pool));
+      gfb->root_rev = rev;
+    }
+
+  *root = gfb->root;
+  return SVN_NO_ERROR;
+}
+
+/* Parse HREF, which was taken from an update report response, into
+   INFO.  Return an error if it doesn't identify a path in a revision. */
+static svn_error_t *
+parse_href(dav_svn__uri_info *info,
+           get_files_baton_t *gfb,
+           const char *href,
+           apr_pool_t *pool)
+{
+  SVN_ERR(dav_svn__simple_parse_uri(info, gfb->resource, href, pool));
+
+  if (!SVN_IS_VALID_REVNUM(info->rev) || !info->repos_path)
+    return svn_error_createf(SVN_ERR_APMOD_MALFORMED_URI, NULL,
+                             "'%s' does not refer to a revision of a file",
+                             href);
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the contents of the file at HREF as an svndiff against the file
+   at DELTA_BASE, or against the empty file if DELTA_BASE is NULL.  If
+   the file is too large, or its base can't be read, tell the client to
+   fetch it on its own instead.  ID is the client's identifier of the
+   file. */
+static svn_error_t *
+send_file(get_files_baton_t *gfb,
+          const char *id,
+          const char *href,
+          const char *delta_base,
+          apr_pool_t *pool)
+{
+  request_rec *r = gfb->resource->info->r;
+  const dav_svn_repos *repos = gfb->resource->info->repos;
+  dav_svn__uri_info info;
+  dav_svn__uri_info base_info;
+  svn_fs_root_t *root;
+  svn_fs_root_t *base_root = NULL;
+  svn_filesize_t length;
+  svn_stream_t *base64_stream;
+
+  SVN_ERR(parse_href(&info, gfb, href, pool));
+
+  /* Let the client's GET handle authz failures and large files. */
+  if (!dav_svn__allow_read(r, repos, info.repos_path, info.rev, pool))
+    return dav_svn__brigade_printf(gfb->bb, gfb->output,
+                                   "<S:fetch id=\"%s\"/>" DEBUG_CR, id);
+
+  SVN_ERR(get_root(&root, gfb, info.rev));
+  SVN_ERR(svn_fs_file_length(&length, root, info.repos_path, pool));
+  if (length > MAX_INLINE_FILE_SIZE)
+    return dav_svn__brigade_printf(gfb->bb, gfb->output,
+                                   "<S:fetch id=\"%s\"/>" DEBUG_CR, id);
+
+  if (delta_base)
+    {
+      SVN_ERR(parse_href(&base_info, gfb, delta_base, pool));
+
+      if (!dav_svn__allow_read(r, repos, base_info.repos_path, base_info.rev,
+                               pool))
+        return dav_svn__brigade_printf(gfb->bb, gfb->output,
+                                       "<S:fetch id=\"%s\"/>" DEBUG_CR, id);
+
+      SVN_ERR(svn_fs_revision_root(&base_root, repos->fs, base_info.rev,
+                                   pool));
+    }
+
+  SVN_ERR(dav_svn__brigade_printf(gfb->bb, gfb->output,
+                                  "<S:file id=\"%s\"><S:txdelta>", id));
+
+  base64_stream = dav_svn__make_base64_output_stream(gfb->bb, gfb->output,
+                                                     pool);
+  SVN_ERR(dav_svn__send_file_delta(base64_stream,
+                                   base_root,
+                                   base_root ? base_info.repos_path : NULL,
+                                   root, info.repos_path,
+                                   gfb->svndiff_version,
+                                   gfb->compression_level,
+                                   gfb->use_svndiff_cache, pool));
+
+  return dav_svn__brigade_puts(gfb->bb, gfb->output,
+                               "</S:txdelta></S:file>" DEBUG_CR);
+}
+
+dav_error *
+dav_svn__get_files_report(const dav_resource *resource,
+                          const apr_xml_doc *doc,
+                          dav_svn__output *output)
+{
+  svn_error_t *serr = NULL;
+  dav_error *derr = NULL;
+  apr_xml_elem *child;
+  get_files_baton_t gfb = { 0 };
+  apr_pool_t *iterpool;
+  int ns;
+
+  ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
+  if (ns == -1)
+    {
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "The request does not contain the 'svn:' "
+                                    "namespace, so it is not going to have "
+                                    "certain required elements");
+    }
+
+  gfb.resource = resource;
+  gfb.output = output;
+  gfb.bb = apr_brigade_create(resource->pool,
+                              dav_svn__output_get_bucket_alloc(output));
+  gfb.root_rev = SVN_INVALID_REVNUM;
+  gfb.root_pool = svn_pool_create(resource->pool);
+  gfb.svndiff_version = resource->info->svndiff_version;
+  gfb.compression_level = dav_svn__get_compression_level(resource->info->r);
+  gfb.use_svndiff_cache = dav_svn__get_svndiff_cache_flag(resource->info->r);
+
+  serr = dav_svn__brigade_puts(gfb.bb, gfb.output,
+                               DAV_XML_HEADER DEBUG_CR
+                               "<S:get-files-report xmlns:S=\""
+                               SVN_XML_NAMESPACE "\" "
+                               "xmlns:D=\"DAV:\">" DEBUG_CR);
+  if (serr)
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error beginning REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  iterpool = svn_pool_create(resource->pool);
+  for (child = doc->root->first_child; child != NULL; child = child->next)
+    {
+      apr_xml_attr *attr;
+      const char *id = NULL;
+      const char *delta_base = NULL;
+      const char *href;
+
+      /* if this element isn't one of ours, then skip it */
+      if (child->ns != ns || strcmp(child->name, "file") != 0)
+        continue;
+
+      svn_pool_clear(iterpool);
+
+      for (attr = child->attr; attr; attr = attr->next)
+        {
+          if (strcmp(attr->name, "id") == 0)
+            id = apr_xml_quote_string(iterpool, attr->value, 1);
+          else if (strcmp(attr->name, "delta-base") == 0)
+            delta_base = attr->value;
+        }
+
+      href = dav_xml_get_cdata(child, iterpool, 1);
+      if (!id || !*href)
+        {
+          serr = svn_error_create(SVN_ERR_DAV_MALFORMED_DATA, NULL,
+                                  "The 'file' element requires an 'id' "
+                                  "attribute and an href");
+          break;
+        }
+
+      serr = send_file(&gfb, id, href, delta_base, iterpool);
+      if (serr)
+        break;
+    }
+  svn_pool_destroy(iterpool);
+
+  if (serr)
+    {
+      derr = dav_svn__convert_err(serr, HTTP_BAD_REQUEST, NULL,
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = dav_svn__brigade_puts(gfb.bb, gfb.output,
+                                    "</S:get-files-report>" DEBUG_CR)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error ending REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+ cleanup:
+  svn_pool_destroy(gfb.root_pool);
+
+  return dav_svn__final_flush_or_error(resource->info->r, gfb.bb, output,
+                                       derr, resource->pool);
+}
@@ -366,6 +366,9 @@ dav_svn__log_report(const dav_resource *resource,
   dav_svn__authz_read_baton arb;
   const dav_svn_repos *repos = resource->info->repos;
   const char *target = NULL;
+  const char *cursor = NULL;
+  const char *next_cursor = NULL;
+  svn_boolean_t use_cursor = FALSE;
   int limit = 0;
   int ns;
   svn_boolean_t seen_revprop_element;
@@ -423,6 +426,17 @@ dav_svn__log_report(const dav_resource *resource,
                                           "\"limit\"", resource->pool);
             }
         }
+      else if (strcmp(child->name, "cursor") == 0)
+        {
+          /* presence asks for a cursor; CDATA resumes from one */
+          const char *cdata = dav_xml_get_cdata(child, resource->pool, 1);
+
+          use_cursor = TRUE;
+          if (*cdata)
+            cursor = svn_base64_decode_string(
+                       svn_string_create(cdata, resource->pool),
+                       resource->pool)->data;
+        }
       else if (strcmp(child->name, "discover-changed-paths") == 0)
         discover_changed_paths = TRUE; /* presence indicates positivity */
       else if (strcmp(child->name, "strict-node-history") == 0)
@@ -505,22 +519,50 @@ dav_svn__log_report(const dav_resource *resource,
      flag in our log_receiver_baton structure). */
 
   /* Send zero or more log items. */
-  serr = svn_repos_get_logs5(repos->repos,
-                             paths,
-                             start,
-                             end,
-                             limit,
-                             strict_node_history,
-                             include_merged_revisions,
-                             revprops,
-                             dav_svn__authz_read_func(&arb),
-                             &arb,
-                             discover_changed_paths ? log_change_receiver
-                                                    : NULL,
-                             &lrb,
-                             log_revision_receiver,
-                             &lrb,
-                             resource->pool);
+  if (use_cursor)
+    {
+      if (limit <= 0 || include_merged_revisions)
+        return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                      "Log cursors require a limit and "
+                                      "can't be combined with merged "
+                                      "revisions");
+
+      serr = svn_repos_get_logs_page(&next_cursor,
+                                     repos->repos,
+                                     paths,
+                                     start,
+                                     end,
+                                     limit,
+                                     cursor,
+                                     strict_node_history,
+                                     revprops,
+                                     dav_svn__authz_read_func(&arb),
+                                     &arb,
+                                     discover_changed_paths
+                                       ? log_change_receiver : NULL,
+                                     &lrb,
+                                     log_revision_receiver,
+                                     &lrb,
+                                     resource->pool,
+                                     resource->pool);
+    }
+  else
+    serr = svn_repos_get_logs5(repos->repos,
+                               paths,
+                               start,
+                               end,
+                               limit,
+                               strict_node_history,
+                               include_merged_revisions,
+                               revprops,
+                               dav_svn__authz_read_func(&arb),
+                               &arb,
+                               discover_changed_paths ? log_change_receiver
+                                                      : NULL,
+                               &lrb,
+                               log_revision_receiver,
+                               &lrb,
+                               resource->pool);
   if (serr)
     {
       derr = dav_svn__convert_err(serr, HTTP_BAD_REQUEST, NULL,
@@ -536,6 +578,25 @@ dav_svn__log_report(const dav_resource *resource,
       goto cleanup;
     }
 
+  /* Tell the client where to continue, if there is more to come. */
+  if (next_cursor)
+    {
+      const svn_string_t *encoded
+        = svn_base64_encode_string2(svn_string_create(next_cursor,
+                                                      resource->pool),
+                                    FALSE, resource->pool);
+
+      if ((serr = dav_svn__brigade_printf(lrb.bb, lrb.output,
+                                          "<S:cursor>%s</S:cursor>" DEBUG_CR,
+                                          encoded->data)))
+        {
+          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                      "Error ending REPORT response.",
+                                      resource->pool);
+          goto cleanup;
+        }
+    }
+
   if ((serr = dav_svn__brigade_puts(lrb.bb, lrb.output,
                                     "</S:log-report>" DEBUG_CR)))
     {
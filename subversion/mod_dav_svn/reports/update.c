@@ -1444,6 +1444,20 @@ dav_svn__update_report(const dav_resource *resource,
     dav_svn__operational_log(resource->info, action);
   }
 
+  /* Let the report run to completion without waiting for the client to
+     catch up, so that the repository is released early. */
+  if (dav_svn__get_spool_update_reports_flag(resource->info->r))
+    {
+      serr = dav_svn__output_spool(uc.output, resource->pool);
+      if (serr)
+        {
+          derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                      "Could not create the response spool",
+                                      resource->pool);
+          goto cleanup;
+        }
+    }
+
   /* this will complete the report, and then drive our editor to generate
      the response to the client. */
   serr = svn_repos_finish_report(rbaton, resource->pool);
@@ -1568,6 +1582,15 @@ dav_svn__update_report(const dav_resource *resource,
   /* Destroy our subpool. */
   svn_pool_destroy(subpool);
 
+  /* Now send whatever the report produced while we were spooling. */
+  serr = dav_svn__output_unspool(uc.output, resource->pool);
+  if (serr && !derr)
+    derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Unable to send update report.",
+                                resource->pool);
+  else
+    svn_error_clear(serr);
+
   return dav_svn__final_flush_or_error(resource->info->r, uc.bb, output,
                                        derr, resource->pool);
 }
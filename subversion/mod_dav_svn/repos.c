@@ -57,6 +57,7 @@
 #include "private/svn_fspath.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_subr_private.h"
 
 #include "dav_svn.h"
 
@@ -998,49 +999,12 @@ prep_working(dav_resource_combined *comb)
       return NULL;
     }
 
-  /* Set the txn author if not previously set.  Protect against multi-author
-   * commits by verifying authenticated user associated with the current
-   * request is the same as the txn author.
-   * Note that anonymous requests are being excluded as being a change
-   * in author, because the commit may touch areas of the repository
-   * that are anonymous writeable as well as areas that are not.
-   */
-  if (comb->priv.repos->username)
-    {
-      svn_string_t *current_author;
-      svn_string_t request_author;
-
-      serr = svn_fs_txn_prop(&current_author, comb->priv.root.txn,
-                             SVN_PROP_REVISION_AUTHOR, pool);
-      if (serr != NULL)
-        {
-          return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                   "Failed to retrieve author of the SVN FS transaction "
-                   "corresponding to the specified activity.",
-                   pool);
-        }
-
-      request_author.data = comb->priv.repos->username;
-      request_author.len = strlen(request_author.data);
-      if (!current_author)
-        {
-          serr = svn_fs_change_txn_prop(comb->priv.root.txn,
-                                        SVN_PROP_REVISION_AUTHOR,
-                                        &request_author, pool);
-          if (serr != NULL)
-            {
-              return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                       "Failed to set the author of the SVN FS transaction "
-                       "corresponding to the specified activity.",
-                       pool);
-            }
-        }
-      else if (!svn_string_compare(current_author, &request_author))
-        {
-          return dav_svn__new_error(pool, HTTP_NOT_IMPLEMENTED, 0, 0,
-                                    "Multi-author commits not supported.");
-        }
-    }
+  /* Set the txn author if not previously set and reject multi-author
+   * commits. */
+  derr = dav_svn__check_txn_author(comb->priv.root.txn, comb->priv.repos,
+                                   pool);
+  if (derr != NULL)
+    return derr;
 
   /* get the root of the tree */
   serr = svn_fs_txn_root(&comb->priv.root.root, comb->priv.root.txn, pool);
@@ -1771,7 +1735,9 @@ static int sort_encoding_pref(const void *accept_rec1, const void *accept_rec2)
 
 static int get_svndiff_version(const struct accept_rec *rec)
 {
-  if (strcmp(rec->name, "svndiff2") == 0)
+  if (strcmp(rec->name, "svndiff3") == 0)
+    return svn__zstd_supported() ? 3 : -1;
+  else if (strcmp(rec->name, "svndiff2") == 0)
     return 2;
   else if (strcmp(rec->name, "svndiff1") == 0)
     return 1;
@@ -2433,17 +2399,7 @@ get_resource(request_rec *r,
       const char *fs_type;
 
       /* construct FS configuration parameters */
-      fs_config = apr_hash_make(r->connection->pool);
-      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_DELTAS,
-                    dav_svn__get_txdelta_cache_flag(r) ? "1" :"0");
-      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_FULLTEXTS,
-                    dav_svn__get_fulltext_cache_flag(r) ? "1" :"0");
-      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_REVPROPS,
-                    dav_svn__get_revprop_cache_flag(r) ? "2" :"0");
-      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NODEPROPS,
-                    dav_svn__get_nodeprop_cache_flag(r) ? "1" :"0");
-      svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ,
-                    dav_svn__get_block_read_flag(r) ? "1" :"0");
+      fs_config = dav_svn__get_fs_config(r, r->connection->pool);
 
       /* Disallow BDB/event until issue 4157 is fixed. */
       if (!strcmp(ap_show_mpm(), "event"))
@@ -3144,6 +3100,63 @@ seek_stream(dav_stream *stream, apr_off_t abs_position)
        && resource->baselined))
 
 
+svn_error_t *
+dav_svn__get_created_rev(svn_revnum_t *created_rev,
+                         const dav_resource *resource,
+                         apr_pool_t *pool)
+{
+  dav_svn__walk_cache_t *cache = resource->info->walk_cache;
+
+  if (cache && SVN_IS_VALID_REVNUM(cache->created_rev))
+    {
+      *created_rev = cache->created_rev;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_fs_node_created_rev(created_rev, resource->info->root.root,
+                                  resource->info->repos_path, pool));
+  if (cache)
+    cache->created_rev = *created_rev;
+
+  return SVN_NO_ERROR;
+}
+
+
+svn_error_t *
+dav_svn__get_revprop(svn_string_t **propval,
+                     const dav_resource *resource,
+                     svn_revnum_t rev,
+                     const char *propname,
+                     apr_pool_t *pool)
+{
+  dav_svn__walk_cache_t *cache = resource->info->walk_cache;
+  apr_hash_t *revprops;
+
+  if (!cache)
+    return svn_error_trace(
+             svn_repos_fs_revision_prop(propval, resource->info->repos->repos,
+                                        rev, propname, NULL, NULL, pool));
+
+  /* Members of a collection tend to share their created revisions. */
+  revprops = apr_hash_get(cache->revprops, &rev, sizeof(rev));
+  if (!revprops)
+    {
+      svn_revnum_t *key = apr_pmemdup(cache->pool, &rev, sizeof(rev));
+
+      SVN_ERR(svn_repos_fs_revision_proplist(&revprops,
+                                             resource->info->repos->repos,
+                                             rev, NULL, NULL, cache->pool));
+      apr_hash_set(cache->revprops, key, sizeof(*key), revprops);
+    }
+
+  *propval = svn_hash_gets(revprops, propname);
+  if (*propval)
+    *propval = svn_string_dup(*propval, pool);
+
+  return SVN_NO_ERROR;
+}
+
+
 const char *
 dav_svn__getetag(const dav_resource *resource, apr_pool_t *pool)
 {
@@ -3155,9 +3168,27 @@ dav_svn__getetag(const dav_resource *resource, apr_pool_t *pool)
 
   /* ### what kind of etag to return for activities, etc.? */
 
-  if ((serr = svn_fs_node_created_rev(&created_rev, resource->info->root.root,
-                                      resource->info->repos_path,
-                                      pool)))
+  /* The content behind a URL that pins the revision never changes, so
+     the node revision is a strong validator for it, and one that stays
+     the same across the different URLs of that node revision.  Deltas
+     have a representation per base, though. */
+  if (resource->info->idempotent
+      && !resource->collection
+      && !resource->info->delta_base
+      && !resource->info->keyword_subst)
+    {
+      const svn_fs_id_t *id;
+
+      serr = svn_fs_node_id(&id, resource->info->root.root,
+                            resource->info->repos_path, pool);
+      if (!serr)
+        return apr_psprintf(pool, "\"%s\"",
+                            svn_fs_unparse_id(id, pool)->data);
+
+      svn_error_clear(serr);
+    }
+
+  if ((serr = dav_svn__get_created_rev(&created_rev, resource, pool)))
     {
       /* ### what to do? */
       svn_error_clear(serr);
@@ -3213,11 +3244,14 @@ set_headers(request_rec *r, const dav_resource *resource)
   svn_error_t *serr;
   svn_filesize_t length;
   const char *mimetype = NULL;
-
-  /* As version resources don't change, encourage caching. */
-  if (is_cacheable(r, resource))
-    /* Cache resource for one week (specified in seconds). */
-    apr_table_setn(r->headers_out, "Cache-Control", "max-age=604800");
+  svn_boolean_t cacheable = is_cacheable(r, resource);
+
+  /* As version resources don't change, encourage caching.  They will
+     never become stale, so tell caches not to bother revalidating. */
+  if (cacheable)
+    /* Cache resource for one year (specified in seconds). */
+    apr_table_setn(r->headers_out, "Cache-Control",
+                   "max-age=31536000, immutable");
   else
     apr_table_setn(r->headers_out, "Cache-Control", "max-age=0");
 
@@ -3225,7 +3259,7 @@ set_headers(request_rec *r, const dav_resource *resource)
     return NULL;
 
   if ((resource->type == DAV_RESOURCE_TYPE_REGULAR)
-      && resource->info->is_public_uri)
+      && (resource->info->is_public_uri || cacheable))
     {
       /* Include Last-Modified header for 'external' GET or HEAD requests
          (i.e. requests to URI's not under /!svn), to support usage of an
@@ -3267,6 +3301,16 @@ set_headers(request_rec *r, const dav_resource *resource)
   apr_table_setn(r->headers_out, "ETag",
                  dav_svn__getetag(resource, resource->pool));
 
+  /* Let caches revalidate their copies of content that never changes
+     without making us send it again.  mod_dav sends no body for
+     header-only requests, and we don't want an error logged. */
+  if (cacheable && ap_meets_conditions(r) == HTTP_NOT_MODIFIED)
+    {
+      r->status = HTTP_NOT_MODIFIED;
+      r->header_only = 1;
+      return NULL;
+    }
+
   /* we accept byte-ranges */
   apr_table_setn(r->headers_out, "Accept-Ranges", "bytes");
 
@@ -3853,10 +3897,7 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
       dav_svn__uri_info info;
       svn_fs_root_t *root;
       svn_boolean_t is_file;
-      svn_txdelta_stream_t *txd_stream;
       svn_stream_t *o_stream;
-      svn_txdelta_window_handler_t handler;
-      void * h_baton;
       diff_ctx_t dc = { 0 };
 
       /* First order of business is to parse it. */
@@ -3891,17 +3932,6 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
                                       "to a file in revision %ld",
                                       info.repos_path, info.rev));
 
-          /* Okay. Let's open up a delta stream for the client to read. */
-          serr = svn_fs_get_file_delta_stream(&txd_stream,
-                                              root, info.repos_path,
-                                              resource->info->root.root,
-                                              resource->info->repos_path,
-                                              resource->pool);
-          if (serr != NULL)
-            return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
-                                        "could not prepare to read a delta",
-                                        resource->pool);
-
           bb = apr_brigade_create(resource->pool,
                                   dav_svn__output_get_bucket_alloc(output));
 
@@ -3913,17 +3943,16 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
           svn_stream_set_write(o_stream, write_to_filter);
           svn_stream_set_close(o_stream, close_filter);
 
-          /* get a handler/baton for writing into the output stream */
-          svn_txdelta_to_svndiff3(&handler, &h_baton,
-                                  o_stream, resource->info->svndiff_version,
-                                  dav_svn__get_compression_level(resource->info->r),
-                                  resource->pool);
-
-          /* got everything set up. read in delta windows and shove them into
-             the handler, which pushes data into the output stream, which goes
-             to the network. */
-          serr = svn_txdelta_send_txstream(txd_stream, handler, h_baton,
-                                           resource->pool);
+          /* compute the delta, or take it from the cache, and shove it
+             into the output stream, which goes to the network. */
+          serr = dav_svn__send_file_delta(o_stream,
+                                          root, info.repos_path,
+                                          resource->info->root.root,
+                                          resource->info->repos_path,
+                                          resource->info->svndiff_version,
+                                          dav_svn__get_compression_level(resource->info->r),
+                                          dav_svn__get_svndiff_cache_flag(resource->info->r),
+                                          resource->pool);
           apr_brigade_destroy(bb);
 
           if (serr != NULL)
@@ -4488,12 +4517,14 @@ do_walk(walker_ctx_t *ctx,
   int isdir = ctx->res.collection;
   dav_error *err;
   svn_error_t *serr;
-  apr_hash_index_t *hi;
   apr_size_t path_len;
   apr_size_t uri_len;
   apr_size_t repos_len;
   apr_hash_t *children;
+  apr_array_header_t *ordered;
+  dav_svn__walk_cache_t *cache = NULL;
   apr_pool_t *iterpool;
+  int i;
 
   /* The current resource is a collection (possibly here thru recursion)
      and this is the invocation for the collection. Alternatively, this is
@@ -4568,20 +4599,36 @@ do_walk(walker_ctx_t *ctx,
                                 "could not fetch collection members",
                                 params->pool);
 
+  /* visit the children in the order they are stored in, so that large
+     listings read the repository sequentially */
+  serr = svn_fs_dir_optimal_order(&ordered, ctx->info.root.root, children,
+                                  scratch_pool, scratch_pool);
+  if (serr != NULL)
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "could not fetch collection members",
+                                params->pool);
+
+  /* the members of a depth-1 walk share what they have in common */
+  if (walk_root && depth == 1)
+    {
+      cache = apr_pcalloc(scratch_pool, sizeof(*cache));
+      cache->revprops = apr_hash_make(scratch_pool);
+      cache->pool = scratch_pool;
+      ctx->info.walk_cache = cache;
+    }
+
   /* iterate over the children in this collection */
   iterpool = svn_pool_create(scratch_pool);
-  for (hi = apr_hash_first(scratch_pool, children); hi; hi = apr_hash_next(hi))
+  for (i = 0; i < ordered->nelts; i++)
     {
-      const void *key;
-      apr_ssize_t klen;
-      void *val;
-      svn_fs_dirent_t *dirent;
+      svn_fs_dirent_t *dirent = APR_ARRAY_IDX(ordered, i, svn_fs_dirent_t *);
+      const char *key = dirent->name;
+      apr_size_t klen = strlen(key);
 
       svn_pool_clear(iterpool);
 
-      /* fetch one of the children */
-      apr_hash_this(hi, &key, &klen, &val);
-      dirent = val;
+      if (cache)
+        cache->created_rev = SVN_INVALID_REVNUM;
 
       /* authorize access to this resource, if applicable */
       if (params->walk_type & DAV_WALKTYPE_AUTH)
@@ -4612,6 +4659,7 @@ do_walk(walker_ctx_t *ctx,
           err = (*params->func)(&ctx->wres, DAV_CALLTYPE_MEMBER);
           if (err != NULL)
             {
+              ctx->info.walk_cache = NULL;
               svn_pool_destroy(iterpool);
               return err;
             }
@@ -4629,6 +4677,7 @@ do_walk(walker_ctx_t *ctx,
           err = do_walk(ctx, depth - 1, FALSE, iterpool);
           if (err != NULL)
             {
+              ctx->info.walk_cache = NULL;
               svn_pool_destroy(iterpool);
               return err;
             }
@@ -4643,6 +4692,7 @@ do_walk(walker_ctx_t *ctx,
       ctx->repos_path->len = repos_len;
     }
 
+  ctx->info.walk_cache = NULL;
   svn_pool_destroy(iterpool);
 
   return NULL;
@@ -4889,6 +4939,10 @@ handle_post_request(request_rec *r,
       return dav_svn__post_create_txn_with_props(resource,
                                                  request_skel, output);
     }
+  else if (svn_skel__matches_atom(post_skel, "apply-txn"))
+    {
+      return dav_svn__post_apply_txn(resource, request_skel, output);
+    }
 
   return dav_svn__new_error(pool, HTTP_BAD_REQUEST, 0, 0,
                             "Unsupported skel POST request flavor.");
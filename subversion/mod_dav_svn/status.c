@@ -24,10 +24,18 @@
 #include <http_config.h>
 #include <http_request.h>
 #include <http_protocol.h>
+#include <http_log.h>
+
+#include <apr_version.h>
+
+#include "svn_pools.h"
+#include "svn_repos.h"
 
 #include "dav_svn.h"
+#include "private/svn_atomic.h"
 #include "private/svn_cache.h"
 #include "private/svn_fs_private.h"
+#include "private/svn_stats.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>   /* For getpid() */
@@ -117,3 +125,337 @@ int dav_svn__status(request_rec *r)
 
   return 0;
 }
+
+
+/* Upper bounds of the REPORT latency histogram buckets, in usec.  Larger
+   durations go into an extra bucket. */
+static const apr_interval_time_t report_buckets[] = {
+  5000, 10000, 50000, 100000, 500000,
+  1000000, 5000000, 10000000, 30000000, 60000000
+};
+
+#define NUM_BUCKETS (sizeof(report_buckets) / sizeof(report_buckets[0]))
+
+/* The number of entries in dav_svn__reports_list, not counting the
+   terminating NULL entry. */
+#define NUM_REPORTS (sizeof(dav_svn__reports_list) \
+                     / sizeof(dav_svn__reports_list[0]) - 1)
+
+/* Latency histogram of one REPORT.  The buckets are not cumulative. */
+typedef struct report_stats_t
+{
+  volatile svn_atomic_t buckets[NUM_BUCKETS + 1];
+  volatile apr_uint64_t total;
+} report_stats_t;
+
+/* Indexed like dav_svn__reports_list. */
+static report_stats_t report_stats[NUM_REPORTS];
+
+void
+dav_svn__record_report_duration(const char *name,
+                                apr_interval_time_t duration)
+{
+  apr_size_t i;
+  apr_size_t bucket;
+
+  for (i = 0; i < NUM_REPORTS; ++i)
+    if (strcmp(dav_svn__reports_list[i].name, name) == 0)
+      break;
+
+  if (i == NUM_REPORTS)
+    return;
+
+  for (bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+    if (duration <= report_buckets[bucket])
+      break;
+
+  svn_atomic_inc(&report_stats[i].buckets[bucket]);
+
+  /* As in svn_stats__counter_add(), losing the odd concurrent update with
+     older APR versions is acceptable. */
+#if APR_VERSION_AT_LEAST(1,7,0)
+  apr_atomic_add64(&report_stats[i].total, duration);
+#else
+  report_stats[i].total += duration;
+#endif
+}
+
+/* Return VALUE escaped for use as a Prometheus label value, allocated in
+   POOL. */
+static const char *
+escape_label(const char *value,
+             apr_pool_t *pool)
+{
+  svn_stringbuf_t *escaped = svn_stringbuf_create_empty(pool);
+
+  for (; *value; ++value)
+    if (*value == '\\' || *value == '"')
+      {
+        svn_stringbuf_appendbyte(escaped, '\\');
+        svn_stringbuf_appendbyte(escaped, *value);
+      }
+    else if (*value == '\n')
+      svn_stringbuf_appendcstr(escaped, "\\n");
+    else
+      svn_stringbuf_appendbyte(escaped, *value);
+
+  return escaped->data;
+}
+
+/* Write the HELP and TYPE lines of metric NAME to R. */
+static void
+metric_header(request_rec *r,
+              const char *name,
+              const char *type,
+              const char *help)
+{
+  ap_rprintf(r, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/* Write the per-segment membuffer cache metrics to R. */
+static void
+write_cache_metrics(request_rec *r)
+{
+  apr_array_header_t *infos
+    = svn_cache__membuffer_get_global_segment_infos(r->pool);
+  int i;
+
+  metric_header(r, "svn_cache_gets_total", "counter",
+                "Lookups in the membuffer cache segment.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+      ap_rprintf(r, "svn_cache_gets_total{segment=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n", info->id, info->gets);
+    }
+
+  metric_header(r, "svn_cache_hits_total", "counter",
+                "Successful lookups in the membuffer cache segment.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+      ap_rprintf(r, "svn_cache_hits_total{segment=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n", info->id, info->hits);
+    }
+
+  metric_header(r, "svn_cache_hit_ratio", "gauge",
+                "Share of successful lookups in the membuffer cache "
+                "segment since the process started.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+      ap_rprintf(r, "svn_cache_hit_ratio{segment=\"%s\"} %.4f\n",
+                 info->id,
+                 info->gets ? (double)info->hits / (double)info->gets : 0.0);
+    }
+
+  metric_header(r, "svn_cache_sets_total", "counter",
+                "Insertions into the membuffer cache segment.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+      ap_rprintf(r, "svn_cache_sets_total{segment=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n", info->id, info->sets);
+    }
+
+  metric_header(r, "svn_cache_used_bytes", "gauge",
+                "Size of the data in the membuffer cache segment.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+      ap_rprintf(r, "svn_cache_used_bytes{segment=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n", info->id, info->used_size);
+    }
+
+  metric_header(r, "svn_cache_size_bytes", "gauge",
+                "Memory allocated to the membuffer cache segment.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+      ap_rprintf(r, "svn_cache_size_bytes{segment=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n", info->id, info->total_size);
+    }
+
+  metric_header(r, "svn_cache_entries", "gauge",
+                "Entries in the membuffer cache segment.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+      ap_rprintf(r, "svn_cache_entries{segment=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n", info->id, info->used_entries);
+    }
+}
+
+/* Write the hit ratios that the membuffer cache estimates for other
+   sizes to R, if it provides them. */
+static void
+write_cache_estimate_metrics(request_rec *r)
+{
+  svn_cache__info_t *info;
+  int i;
+
+  if (!svn_cache__get_global_membuffer_cache())
+    return;
+
+  info = svn_cache__membuffer_get_global_info(r->pool);
+  if (!info->estimate_sizes[0])
+    return;
+
+  metric_header(r, "svn_cache_estimated_hit_ratio", "gauge",
+                "Hit ratio that the membuffer cache estimates for recent "
+                "requests if its data size was size_bytes; see "
+                "SVNInMemoryCacheSize.");
+  for (i = 0; i < SVN_CACHE__SIZE_ESTIMATES; ++i)
+    ap_rprintf(r, "svn_cache_estimated_hit_ratio{size_bytes=\"%"
+               APR_UINT64_T_FMT "\"} %.4f\n",
+               info->estimate_sizes[i], info->estimated_hit_ratios[i]);
+}
+
+/* Write the svn_stats counters, such as the FSFS write lock wait time
+   and the number of revision files opened, to R. */
+static void
+write_stats_metrics(request_rec *r)
+{
+  apr_array_header_t *infos;
+  svn_error_t *err;
+  int i;
+
+  err = svn_stats__get_info(&infos, r->pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      return;
+    }
+
+  metric_header(r, "svn_stats_events_total", "counter",
+                "Events recorded by the statistics counter; see "
+                "SVNCollectStats.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_stats__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_stats__info_t *);
+      ap_rprintf(r, "svn_stats_events_total{counter=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n",
+                 escape_label(info->name, r->pool), info->count);
+    }
+
+  metric_header(r, "svn_stats_amount_total", "counter",
+                "Sum of the amounts recorded by the statistics counter, "
+                "in microseconds for timers.");
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_stats__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_stats__info_t *);
+      ap_rprintf(r, "svn_stats_amount_total{counter=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n",
+                 escape_label(info->name, r->pool), info->total);
+    }
+}
+
+/* Write the REPORT latency histograms to R. */
+static void
+write_report_metrics(request_rec *r)
+{
+  apr_size_t i;
+  apr_size_t bucket;
+
+  metric_header(r, "svn_report_duration_seconds", "histogram",
+                "Time taken to deliver REPORT responses.");
+  for (i = 0; i < NUM_REPORTS; ++i)
+    {
+      const char *name = dav_svn__reports_list[i].name;
+      apr_uint64_t count = 0;
+
+      for (bucket = 0; bucket <= NUM_BUCKETS; ++bucket)
+        {
+          count += report_stats[i].buckets[bucket];
+          if (bucket < NUM_BUCKETS)
+            ap_rprintf(r, "svn_report_duration_seconds_bucket"
+                       "{report=\"%s\",le=\"%g\"} %" APR_UINT64_T_FMT "\n",
+                       name, report_buckets[bucket] / 1e6, count);
+          else
+            ap_rprintf(r, "svn_report_duration_seconds_bucket"
+                       "{report=\"%s\",le=\"+Inf\"} %" APR_UINT64_T_FMT "\n",
+                       name, count);
+        }
+
+      ap_rprintf(r, "svn_report_duration_seconds_sum{report=\"%s\"} %.6f\n",
+                 name, report_stats[i].total / 1e6);
+      ap_rprintf(r, "svn_report_duration_seconds_count{report=\"%s\"} %"
+                 APR_UINT64_T_FMT "\n", name, count);
+    }
+}
+
+/* If this location is configured with SVNPath, write the number of
+   transactions in that repository to R. */
+static void
+write_txn_metrics(request_rec *r)
+{
+  const char *fs_path = dav_svn__get_fs_path(r);
+  apr_pool_t *pool;
+  svn_repos_t *repos;
+  apr_array_header_t *txns;
+  svn_error_t *err;
+
+  if (!fs_path)
+    return;
+
+  pool = svn_pool_create(r->pool);
+  err = svn_repos_open3(&repos, fs_path, NULL, pool, pool);
+  if (!err)
+    err = svn_fs_list_transactions(&txns, svn_repos_fs(repos), pool);
+
+  if (err)
+    {
+      ap_log_rerror(APLOG_MARK, APLOG_WARNING, err->apr_err, r,
+                    "Could not list the transactions of '%s'", fs_path);
+      svn_error_clear(err);
+    }
+  else
+    {
+      metric_header(r, "svn_active_txns", "gauge",
+                    "Uncommitted transactions in the repository.");
+      ap_rprintf(r, "svn_active_txns{repository=\"%s\"} %d\n",
+                 escape_label(fs_path, pool), txns->nelts);
+    }
+
+  svn_pool_destroy(pool);
+}
+
+/* Like dav_svn__status() but for monitoring systems:
+
+     <Location /svn-metrics>
+       SetHandler svn-metrics
+     </Location>
+
+  Like the status page, this covers only the process that handles the
+  request, so scrapers should expect to see several of them.
+*/
+int dav_svn__metrics(request_rec *r)
+{
+  if (r->method_number != M_GET || strcmp(r->handler, "svn-metrics"))
+    return DECLINED;
+
+  ap_set_content_type(r, "text/plain; version=0.0.4; charset=utf-8");
+
+#if defined(WIN32) || (defined(HAVE_UNISTD_H) && defined(HAVE_GETPID))
+  metric_header(r, "svn_process_id", "gauge",
+                "Id of the server process that produced these metrics.");
+  ap_rprintf(r, "svn_process_id %d\n", (int)getpid());
+#endif
+
+  write_cache_metrics(r);
+  write_cache_estimate_metrics(r);
+  write_stats_metrics(r);
+  write_report_metrics(r);
+  write_txn_metrics(r);
+
+  return 0;
+}
@@ -38,10 +38,17 @@
 #include "svn_dav.h"
 #include "svn_base64.h"
 #include "svn_ctype.h"
+#include "svn_checksum.h"
+#include "svn_delta.h"
+#include "svn_pools.h"
 
 #include "dav_svn.h"
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
+#include "private/svn_stats.h"
 #include "private/svn_string_private.h"
+#include "private/svn_subr_private.h"
 
 dav_error *
 dav_svn__new_error(apr_pool_t *pool,
@@ -470,9 +477,19 @@ dav_svn__find_ns(const apr_array_header_t *namespaces, const char *uri)
 /*** Output helpers ***/
 
 
+/* Block size and in-memory size of the spool of a dav_svn__output.
+   Anything beyond the latter goes to a temporary file. */
+#define SPOOL_BLOCKSIZE SVN__STREAM_CHUNK_SIZE
+#define SPOOL_MEMSIZE (4 * 1024 * 1024)
+
 struct dav_svn__output
 {
   request_rec *r;
+
+  /* While not NULL, output is collected here instead of being passed
+     to the filters of R. */
+  svn_spillbuf_t *spool;
+  apr_pool_t *spool_pool;
 };
 
 dav_svn__output *
@@ -490,13 +507,133 @@ dav_svn__output_get_bucket_alloc(dav_svn__output *output)
   return output->r->connection->bucket_alloc;
 }
 
+/* Append the data buckets of BB to the spool of OUTPUT and empty BB. */
+static apr_status_t
+spool_brigade(dav_svn__output *output,
+              apr_bucket_brigade *bb)
+{
+  apr_bucket *e;
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_status_t status = APR_SUCCESS;
+
+  for (e = APR_BRIGADE_FIRST(bb);
+       e != APR_BRIGADE_SENTINEL(bb);
+       e = APR_BUCKET_NEXT(e))
+    {
+      const char *data;
+      apr_size_t len;
+
+      if (APR_BUCKET_IS_METADATA(e))
+        continue;
+
+      status = apr_bucket_read(e, &data, &len, APR_BLOCK_READ);
+      if (status)
+        break;
+
+      err = svn_spillbuf__write(output->spool, data, len, output->spool_pool);
+      if (err)
+        {
+          status = err->apr_err;
+          svn_error_clear(err);
+          break;
+        }
+    }
+
+  apr_brigade_cleanup(bb);
+  return status;
+}
+
+/* Flush BB to the output BATON.  Implements apr_brigade_flush. */
+static apr_status_t
+flush_output(apr_bucket_brigade *bb,
+             void *baton)
+{
+  dav_svn__output *output = baton;
+
+  if (output->spool)
+    return spool_brigade(output, bb);
+
+  return ap_filter_flush(bb, output->r->output_filters);
+}
+
+svn_error_t *
+dav_svn__output_spool(dav_svn__output *output,
+                      apr_pool_t *pool)
+{
+  SVN_ERR_ASSERT(output->spool == NULL);
+
+  output->spool = svn_spillbuf__create(SPOOL_BLOCKSIZE, SPOOL_MEMSIZE, pool);
+  output->spool_pool = pool;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+dav_svn__output_unspool(dav_svn__output *output,
+                        apr_pool_t *scratch_pool)
+{
+  svn_spillbuf_t *spool = output->spool;
+  apr_bucket_brigade *bb;
+  apr_status_t status;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  if (!spool)
+    return SVN_NO_ERROR;
+
+  /* From now on, write directly to the network again. */
+  output->spool = NULL;
+
+  bb = apr_brigade_create(scratch_pool,
+                          dav_svn__output_get_bucket_alloc(output));
+  while (!err)
+    {
+      const char *data;
+      apr_size_t len;
+
+      err = svn_spillbuf__read(&data, &len, spool, scratch_pool);
+      if (err || data == NULL)
+        break;
+
+      /* DATA only lives until the next read, so pass it on right away. */
+      status = apr_brigade_write(bb, NULL, NULL, data, len);
+      if (status)
+        err = svn_error_wrap_apr(status, "Error sending spooled output");
+      else
+        err = dav_svn__output_pass_brigade(output, bb);
+    }
+
+  apr_brigade_destroy(bb);
+  return svn_error_trace(err);
+}
+
+/* Bytes passed to the output filters and time spent doing so. */
+SVN__COUNTER_DEFINE(bytes_sent, "dav_svn.bytes_sent");
+SVN__COUNTER_DEFINE(write_timer, "dav_svn.write_wait");
+
 svn_error_t *
 dav_svn__output_pass_brigade(dav_svn__output *output,
                              apr_bucket_brigade *bb)
 {
   apr_status_t status;
+  apr_off_t len = 0;
+  apr_time_t start;
+
+  if (output->spool)
+    {
+      status = spool_brigade(output, bb);
+      if (status)
+        return svn_error_create(status, NULL, "Could not spool output");
 
+      return SVN_NO_ERROR;
+    }
+
+  /* Buckets of unknown length don't count. */
+  if (apr_brigade_length(bb, FALSE, &len) == APR_SUCCESS && len > 0)
+    SVN__COUNTER_ADD(bytes_sent, len);
+
+  SVN__TIMER_START(write_timer, start);
   status = ap_pass_brigade(output->r->output_filters, bb);
+  SVN__TIMER_STOP(write_timer, start);
   /* Empty the brigade here, as required by ap_pass_brigade(). */
   apr_brigade_cleanup(bb);
   if (status)
@@ -520,8 +657,7 @@ dav_svn__brigade_write(apr_bucket_brigade *bb,
                        apr_size_t len)
 {
   apr_status_t apr_err;
-  apr_err = apr_brigade_write(bb, ap_filter_flush,
-                              output->r->output_filters, data, len);
+  apr_err = apr_brigade_write(bb, flush_output, output, data, len);
   if (apr_err)
     return svn_error_create(apr_err, 0, NULL);
   /* Check for an aborted connection, since the brigade functions don't
@@ -538,8 +674,7 @@ dav_svn__brigade_puts(apr_bucket_brigade *bb,
                       const char *str)
 {
   apr_status_t apr_err;
-  apr_err = apr_brigade_puts(bb, ap_filter_flush,
-                             output->r->output_filters, str);
+  apr_err = apr_brigade_puts(bb, flush_output, output, str);
   if (apr_err)
     return svn_error_create(apr_err, 0, NULL);
   /* Check for an aborted connection, since the brigade functions don't
@@ -560,8 +695,7 @@ dav_svn__brigade_printf(apr_bucket_brigade *bb,
   va_list ap;
 
   va_start(ap, fmt);
-  apr_err = apr_brigade_vprintf(bb, ap_filter_flush,
-                                output->r->output_filters, fmt, ap);
+  apr_err = apr_brigade_vprintf(bb, flush_output, output, fmt, ap);
   va_end(ap);
   if (apr_err)
     return svn_error_create(apr_err, 0, NULL);
@@ -582,8 +716,7 @@ dav_svn__brigade_putstrs(apr_bucket_brigade *bb,
   va_list ap;
 
   va_start(ap, output);
-  apr_err = apr_brigade_vputstrs(bb, ap_filter_flush,
-                                 output->r->output_filters, ap);
+  apr_err = apr_brigade_vputstrs(bb, flush_output, output, ap);
   va_end(ap);
   if (apr_err)
     return svn_error_create(apr_err, NULL, NULL);
@@ -667,8 +800,7 @@ brigade_write_fn(void *baton, const char *data, apr_size_t *len)
   struct brigade_write_baton *wb = baton;
   apr_status_t apr_err;
 
-  apr_err = apr_brigade_write(wb->bb, ap_filter_flush,
-                              wb->output->r->output_filters, data, *len);
+  apr_err = apr_brigade_write(wb->bb, flush_output, wb->output, data, *len);
 
   if (apr_err != APR_SUCCESS)
     return svn_error_wrap_apr(apr_err, "Error writing base64 data");
@@ -692,6 +824,165 @@ dav_svn__make_base64_output_stream(apr_bucket_brigade *bb,
   return svn_base64_encode2(stream, FALSE, pool);
 }
 
+
+/* Encoded svndiffs larger than this are not worth keeping in the cache. */
+#define MAX_CACHED_SVNDIFF_SIZE (256 * 1024)
+
+/* Process-wide cache of encoded svndiffs, keyed by the SHA-1 checksums
+   of their source and target contents and their encoding parameters.
+   NULL if there is no membuffer cache to put it in. */
+static svn_cache__t *svndiff_cache = NULL;
+static volatile svn_atomic_t svndiff_cache_init_state = 0;
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+init_svndiff_cache(void *baton, apr_pool_t *pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  /* The cache lives as long as the process does. */
+  if (membuffer)
+    {
+      apr_pool_t *cache_pool = svn_pool_create(NULL);
+
+      SVN_ERR(svn_cache__create_membuffer_cache(&svndiff_cache, membuffer,
+                                                NULL, NULL,
+                                                APR_HASH_KEY_STRING,
+                                                "mod_dav_svn:svndiff:",
+                                                SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                                TRUE, FALSE,
+                                                cache_pool, pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for capture_write_fn. */
+struct capture_baton
+{
+  svn_stringbuf_t *buffer;   /* NULL once the data exceeded the limit */
+};
+
+/* Implements svn_write_fn_t.  Append the data to BATON's buffer until it
+   grows beyond MAX_CACHED_SVNDIFF_SIZE. */
+static svn_error_t *
+capture_write_fn(void *baton, const char *data, apr_size_t *len)
+{
+  struct capture_baton *cb = baton;
+
+  if (cb->buffer)
+    {
+      if (cb->buffer->len + *len > MAX_CACHED_SVNDIFF_SIZE)
+        cb->buffer = NULL;
+      else
+        svn_stringbuf_appendbytes(cb->buffer, data, *len);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *KEY to the cache key of the delta from SRC_ROOT:SRC_PATH to
+   TGT_ROOT:TGT_PATH, or to NULL if the contents don't have known SHA-1
+   checksums. */
+static svn_error_t *
+make_svndiff_key(const char **key,
+                 svn_fs_root_t *src_root,
+                 const char *src_path,
+                 svn_fs_root_t *tgt_root,
+                 const char *tgt_path,
+                 int svndiff_version,
+                 int compression_level,
+                 apr_pool_t *pool)
+{
+  svn_checksum_t *src_sha1 = NULL;
+  svn_checksum_t *tgt_sha1;
+
+  *key = NULL;
+
+  SVN_ERR(svn_fs_file_checksum(&tgt_sha1, svn_checksum_sha1, tgt_root,
+                               tgt_path, FALSE, pool));
+  if (!tgt_sha1)
+    return SVN_NO_ERROR;
+
+  if (src_root)
+    {
+      SVN_ERR(svn_fs_file_checksum(&src_sha1, svn_checksum_sha1, src_root,
+                                   src_path, FALSE, pool));
+      if (!src_sha1)
+        return SVN_NO_ERROR;
+    }
+
+  *key = apr_psprintf(pool, "%s:%s:%d:%d",
+                      src_sha1 ? svn_checksum_to_cstring(src_sha1, pool) : "",
+                      svn_checksum_to_cstring(tgt_sha1, pool),
+                      svndiff_version, compression_level);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+dav_svn__send_file_delta(svn_stream_t *stream,
+                         svn_fs_root_t *src_root,
+                         const char *src_path,
+                         svn_fs_root_t *tgt_root,
+                         const char *tgt_path,
+                         int svndiff_version,
+                         int compression_level,
+                         svn_boolean_t use_cache,
+                         apr_pool_t *pool)
+{
+  svn_txdelta_stream_t *txd_stream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  const char *key = NULL;
+  struct capture_baton cb = { NULL };
+  svn_stream_t *capture;
+
+  if (use_cache)
+    {
+      SVN_ERR(svn_atomic__init_once(&svndiff_cache_init_state,
+                                    init_svndiff_cache, NULL, pool));
+      if (svndiff_cache)
+        SVN_ERR(make_svndiff_key(&key, src_root, src_path, tgt_root,
+                                 tgt_path, svndiff_version,
+                                 compression_level, pool));
+    }
+
+  if (key)
+    {
+      svn_stringbuf_t *cached;
+      svn_boolean_t found;
+
+      SVN_ERR(svn_cache__get((void **)&cached, &found, svndiff_cache, key,
+                             pool));
+      if (found)
+        {
+          SVN_ERR(svn_stream_write(stream, cached->data, &cached->len));
+          return svn_error_trace(svn_stream_close(stream));
+        }
+
+      /* Keep a copy of what we send, so the next request for the same
+         delta can skip computing and encoding it. */
+      cb.buffer = svn_stringbuf_create_empty(pool);
+      capture = svn_stream_create(&cb, pool);
+      svn_stream_set_write(capture, capture_write_fn);
+      stream = svn_stream_tee(stream, capture, pool);
+    }
+
+  SVN_ERR(svn_fs_get_file_delta_stream(&txd_stream, src_root, src_path,
+                                       tgt_root, tgt_path, pool));
+  svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                          svndiff_version, compression_level, pool);
+  SVN_ERR(svn_txdelta_send_txstream(txd_stream, handler, handler_baton,
+                                    pool));
+
+  /* Failing to cache the delta is no reason to fail the request. */
+  if (cb.buffer)
+    svn_error_clear(svn_cache__set(svndiff_cache, key, cb.buffer, pool));
+
+  return SVN_NO_ERROR;
+}
+
 void
 dav_svn__operational_log(struct dav_resource_private *info, const char *line)
 {
@@ -153,6 +153,8 @@ get_vsn_options(apr_pool_t *p, apr_text_header *phdr)
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_INLINE_PROPS);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_REVERSE_FILE_REVS);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_LIST);
+  apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_GET_FILES);
+  apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_LOG_CURSOR);
   /* Mergeinfo is a special case: here we merely say that the server
    * knows how to handle mergeinfo -- whether the repository does too
    * is a separate matter.
@@ -197,6 +199,7 @@ get_option(const dav_resource *resource,
     { SVN_DAV_NS_DAV_SVN_EPHEMERAL_TXNPROPS,  { 1,  8, 0, ""} },
     { SVN_DAV_NS_DAV_SVN_SVNDIFF1,            { 1, 10, 0, ""} },
     { SVN_DAV_NS_DAV_SVN_SVNDIFF2,            { 1, 10, 0, ""} },
+    { SVN_DAV_NS_DAV_SVN_SVNDIFF3,            { 1, 15, 0, ""} },
     { SVN_DAV_NS_DAV_SVN_PUT_RESULT_CHECKSUM, { 1, 10, 0, ""} },
   };
 
@@ -300,6 +303,7 @@ get_option(const dav_resource *resource,
       } posts_versions[] = {
         { "create-txn",             { 1, 7, 0, "" } },
         { "create-txn-with-props",  { 1, 8, 0, "" } },
+        { "apply-txn",              { 1, 15, 0, "" } },
       };
 
       /* Add the header which indicates that this server can handle
@@ -366,6 +370,12 @@ get_option(const dav_resource *resource,
                                      capabilities[i].min_version.patch)))
         continue;
 
+      /* We can only decode svndiff3 if built with Zstandard support. */
+      if (!svn__zstd_supported()
+          && strcmp(capabilities[i].capability_name,
+                    SVN_DAV_NS_DAV_SVN_SVNDIFF3) == 0)
+        continue;
+
       apr_table_addn(r->headers_out, "DAV",
                      apr_pstrdup(r->pool, capabilities[i].capability_name));
     }
@@ -1117,10 +1127,8 @@ report_label_header_allowed(const apr_xml_doc *doc)
 
 
 static dav_error *
-deliver_report(request_rec *r,
-               const dav_resource *resource,
-               const apr_xml_doc *doc,
-               ap_filter_t *unused)
+dispatch_report(const dav_resource *resource,
+                const apr_xml_doc *doc)
 {
   int ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
 
@@ -1180,6 +1188,10 @@ deliver_report(request_rec *r,
         {
           return dav_svn__list_report(resource, doc, output);
         }
+      else if (strcmp(doc->root->name, "get-files-report") == 0)
+        {
+          return dav_svn__get_files_report(resource, doc, output);
+        }
       /* NOTE: if you add a report, don't forget to add it to the
        *       dav_svn__reports_list[] array.
        */
@@ -1192,6 +1204,21 @@ deliver_report(request_rec *r,
 }
 
 
+static dav_error *
+deliver_report(request_rec *r,
+               const dav_resource *resource,
+               const apr_xml_doc *doc,
+               ap_filter_t *unused)
+{
+  apr_time_t start = apr_time_now();
+  dav_error *derr = dispatch_report(resource, doc);
+
+  dav_svn__record_report_duration(doc->root->name, apr_time_now() - start);
+
+  return derr;
+}
+
+
 static int
 can_be_activity(const dav_resource *resource)
 {
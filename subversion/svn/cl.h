@@ -275,6 +275,7 @@ typedef struct svn_cl__opt_state_t
       svn_cl__viewspec_classic,
       svn_cl__viewspec_svn11
   } viewspec;                     /* value of --x-viewspec */
+  svn_boolean_t profile;          /* print performance counters at exit */
 } svn_cl__opt_state_t;
 
 /* Conflict stats for operations such as update and merge. */
@@ -374,6 +375,7 @@ typedef enum svn_cl__longopt_t {
   opt_vacuum_pristines,
   opt_drop,
   opt_viewspec,
+  opt_profile,
 } svn_cl__longopt_t;
 
 /* Options for giving a log message.  (Some of these also have other uses.)
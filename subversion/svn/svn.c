@@ -57,6 +57,7 @@
 
 #include "private/svn_opt_private.h"
 #include "private/svn_cmdline_private.h"
+#include "private/svn_stats.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_utf_private.h"
 
@@ -140,7 +141,13 @@ const apr_getopt_option_t svn_cl__options[] =
                        "                             "
                        "  -U ARG, --context ARG: Show ARG lines of context\n"
                        "                             "
-                       "  -p, --show-c-function: Show C function name")},
+                       "  -p, --show-c-function: Show C function name\n"
+                       "                             "
+                       "  --histogram: Use the histogram diff algorithm\n"
+                       "                             "
+                       "  --window-lines ARG: Compare large files ARG lines\n"
+                       "                             "
+                       "    at a time")},
   {"targets",       opt_targets, 1,
                     N_("pass contents of file ARG as additional args")},
   {"depth",         opt_depth, 1,
@@ -212,6 +219,12 @@ const apr_getopt_option_t svn_cl__options[] =
                        "For example:\n"
                        "                             "
                        "    servers:global:http-library=serf")},
+  {"profile",       opt_profile, 0,
+                    N_("print timings and counts of internal operations,\n"
+                       "                             "
+                       "such as network round-trips, working copy database\n"
+                       "                             "
+                       "statements and file I/O, to stderr when done")},
   {"auto-props",    opt_autoprops, 0, N_("enable automatic properties")},
   {"no-auto-props", opt_no_autoprops, 0, N_("disable automatic properties")},
   {"native-eol",    opt_native_eol, 1,
@@ -442,7 +455,7 @@ const int svn_cl__global_options[] =
   opt_no_auth_cache, opt_non_interactive,
   opt_force_interactive, opt_trust_server_cert,
   opt_trust_server_cert_failures,
-  opt_config_dir, opt_config_options, 0
+  opt_config_dir, opt_config_options, opt_profile, 0
 };
 
 static const svn_opt_subcommand_desc3_t
@@ -2013,6 +2026,31 @@ add_commands(const svn_opt_subcommand_desc3_t *cmds_add,
 
 /*** Main. ***/
 
+/* Write all svn_stats counters to stderr, as requested by --profile.
+ * Use POOL for temporary allocations. */
+static svn_error_t *
+print_profile(apr_pool_t *pool)
+{
+  apr_array_header_t *infos;
+  int i;
+
+  SVN_ERR(svn_stats__get_info(&infos, pool));
+  SVN_ERR(svn_cmdline_fputs(_("\nProfile (timer totals in microseconds):\n"),
+                            stderr, pool));
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_stats__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_stats__info_t *);
+
+      if (info->count)
+        SVN_ERR(svn_cmdline_fprintf(stderr, pool, "  %s\n",
+                                    svn_stats__format_info(info,
+                                                           pool)->data));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /*
  * On success, leave *EXIT_CODE untouched and return SVN_NO_ERROR. On error,
  * either return an error to be displayed, or set *EXIT_CODE to non-zero and
@@ -2458,6 +2496,12 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
         SVN_ERR(svn_cmdline__parse_config_option(opt_state.config_options,
                                                  utf8_opt_arg, "svn: ", pool));
         break;
+      case opt_profile:
+        /* Counters decide at their first use whether to collect data,
+           so this needs to happen before any real work is done. */
+        opt_state.profile = TRUE;
+        svn_stats__set_enabled(TRUE);
+        break;
       case opt_autoprops:
         opt_state.autoprops = TRUE;
         break;
@@ -3238,6 +3282,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
   /* And now we finally run the subcommand. */
   err = (*subcommand->cmd_func)(os, &command_baton, pool);
+  if (opt_state.profile)
+    svn_error_clear(print_profile(pool));
   if (err)
     {
       /* For argument-related problems, suggest using the 'help'
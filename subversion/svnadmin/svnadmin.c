@@ -159,7 +159,8 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__jobs
   };
 
 /* Option codes and descriptions.
@@ -298,6 +299,10 @@ static const apr_getopt_option_t options_table[] =
         "                             Character '/' is not treated specially, so\n"
         "                             pattern /*/foo matches paths /a/foo and /a/b/foo.") },
 
+    {"jobs", svnadmin__jobs, 1,
+     N_("process up to ARG shards or revisions\n"
+        "                             concurrently [default: 1]")},
+
     {NULL}
   };
 
@@ -314,8 +319,12 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "at REPOS_PATH. Process data in revisions LOWER through UPPER.\n"
     "If no revision arguments are given, process all revisions. If only\n"
     "LOWER revision argument is given, process only that single revision.\n"
+    "\n"
+    "Revisions are reported once their entries have been committed to the\n"
+    "cache.  An interrupted run may be resumed by passing the revision\n"
+    "after the last one reported as LOWER.\n"
    )},
-   {'r', 'q', 'M'} },
+   {'r', 'q', 'M', svnadmin__jobs} },
 
   {"crashtest", subcommand_crashtest, {0}, {N_(
     "usage: svnadmin crashtest REPOS_PATH\n"
@@ -381,9 +390,12 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Using --exclude or --include gives results equivalent to authz-based\n"
     "path exclusions. In particular, when the source of a copy is\n"
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"
+    "\n"
+    "Using --jobs prepares several revisions concurrently.  The dumpfile\n"
+    "is the same as without that option.\n"
    )},
   {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
+   svnadmin__exclude, svnadmin__include, svnadmin__glob, svnadmin__jobs },
   {{'F', N_("write to file ARG instead of stdout")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, {N_(
@@ -520,7 +532,7 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Possibly compact the repository into a more efficient storage model.\n"
     "This may not apply to all repositories, in which case, exit.\n"
    )},
-   {'q', 'M'} },
+   {'q', 'M', svnadmin__jobs} },
 
   {"recover", subcommand_recover, {0}, {N_(
     "usage: svnadmin recover REPOS_PATH\n"
@@ -630,7 +642,8 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
     "Verify the data stored in the repository.\n"
    )},
    {'t', 'r', 'q', svnadmin__keep_going, 'M',
-    svnadmin__check_normalization, svnadmin__metadata_only} },
+    svnadmin__check_normalization, svnadmin__metadata_only,
+    svnadmin__jobs} },
 
   { NULL, NULL, {0}, {NULL}, {0} }
 };
@@ -673,6 +686,7 @@ struct svnadmin_opt_state
   apr_array_header_t *exclude;                      /* --exclude */
   apr_array_header_t *include;                      /* --include */
   svn_boolean_t glob;                               /* --pattern */
+  int jobs;                                         /* --jobs */
 
   const char *config_dir;    /* Overriding Configuration Directory */
 };
@@ -1015,7 +1029,7 @@ struct repos_verify_callback_baton
 };
 
 /* Implementation of svn_repos_verify_callback_t to handle errors coming
-   from svn_repos_verify_fs3(). */
+   from svn_repos_verify_fs4(). */
 static svn_error_t *
 repos_verify_callback(void *baton,
                       svn_revnum_t revision,
@@ -1476,9 +1490,9 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
                              opt_state->incremental, opt_state->use_deltas,
-                             TRUE, TRUE,
+                             TRUE, TRUE, opt_state->jobs,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream,
                              filter_baton.prefixes ? dump_filter_func : NULL,
@@ -1522,8 +1536,8 @@ subcommand_dump_revprops(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   if (! opt_state->quiet)
     feedback_stream = recode_stream_create(stderr, pool);
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
-                             FALSE, FALSE, TRUE, FALSE,
+  SVN_ERR(svn_repos_dump_fs5(repos, out_stream, lower, upper,
+                             FALSE, FALSE, TRUE, FALSE, 1,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream, NULL, NULL,
                              check_cancel, NULL, pool));
@@ -2206,7 +2220,8 @@ subcommand_pack(apr_getopt_t *os, void *baton, apr_pool_t *pool)
     feedback_stream = recode_stream_create(stdout, pool);
 
   return svn_error_trace(
-    svn_repos_fs_pack2(repos, !opt_state->quiet ? repos_notify_handler : NULL,
+    svn_repos_fs_pack3(repos, opt_state->jobs,
+                       !opt_state->quiet ? repos_notify_handler : NULL,
                        feedback_stream, check_cancel, NULL, pool));
 }
 
@@ -2272,9 +2287,10 @@ subcommand_verify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
     apr_array_make(pool, 0, sizeof(struct verification_error *));
   verify_baton.result_pool = pool;
 
-  SVN_ERR(svn_repos_verify_fs3(repos, lower, upper,
+  SVN_ERR(svn_repos_verify_fs4(repos, lower, upper,
                                opt_state->check_normalization,
                                opt_state->metadata_only,
+                               opt_state->jobs,
                                !opt_state->quiet
                                  ? repos_notify_handler : NULL,
                                feedback_stream,
@@ -2956,6 +2972,7 @@ build_rep_cache(svn_fs_t *fs,
 
   input.start_rev = start_rev;
   input.end_rev = end_rev;
+  input.jobs = opt_state->jobs;
 
   if (opt_state->quiet)
     {
@@ -3076,6 +3093,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.jobs = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -3290,6 +3308,16 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case svnadmin__glob:
         opt_state.glob = TRUE;
         break;
+      case svnadmin__jobs:
+        SVN_ERR(svn_utf_cstring_to_utf8(&utf8_opt_arg, opt_arg, pool));
+        err = svn_cstring_atoi(&opt_state.jobs, utf8_opt_arg);
+        if (err)
+          return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, err,
+                                  _("Non-numeric jobs argument given"));
+        if (opt_state.jobs <= 0)
+          return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                                  _("Argument to --jobs must be positive"));
+        break;
       default:
         {
           SVN_ERR(subcommand_help(NULL, NULL, pool));
@@ -96,6 +96,8 @@ typedef struct svn_cl__opt_state_t
   svn_boolean_t trust_server_cert_not_yet_valid;
   svn_boolean_t trust_server_cert_other_failure;
   apr_array_header_t* search_patterns; /* pattern arguments for --search */
+  int clients;                   /* concurrent clients for 'load' */
+  int duration;                  /* seconds to run 'load' for */
 } svn_cl__opt_state_t;
 
 
@@ -109,11 +111,16 @@ typedef struct svn_cl__cmd_baton_t
 /* Declare all the command procedures */
 svn_opt_subcommand_t
   svn_cl__help,
+  svn_cl__load,
   svn_cl__null_blame,
+  svn_cl__null_checkout,
+  svn_cl__null_diff,
   svn_cl__null_export,
   svn_cl__null_list,
   svn_cl__null_log,
-  svn_cl__null_info;
+  svn_cl__null_info,
+  svn_cl__null_status,
+  svn_cl__null_update;
 
 
 /* See definition in main.c for documentation. */
@@ -196,6 +203,54 @@ svn_cl__local_style_skip_ancestor(const char *parent_path,
                                   const char *path,
                                   apr_pool_t *pool);
 
+/* What a counting editor, as returned by svn_cl__get_counting_editor(),
+ * has seen of an editor drive. */
+typedef struct svn_cl__editor_stats_t
+{
+  apr_int64_t dir_count;        /* directories added or opened */
+  apr_int64_t file_count;       /* files added or opened */
+  apr_int64_t delete_count;     /* entries deleted */
+  apr_int64_t window_count;     /* text delta windows */
+  apr_int64_t byte_count;       /* bytes of fulltext the windows produce */
+  apr_int64_t new_data_count;   /* bytes of new data sent in the windows */
+  apr_int64_t prop_count;       /* property changes */
+  apr_int64_t prop_byte_count;  /* bytes in changed property values */
+} svn_cl__editor_stats_t;
+
+/* Set *EDITOR and *EDIT_BATON to an editor that does nothing but
+ * count what it is driven with into STATS.  The editor checks for
+ * cancellation through CTX.  Allocate the result in POOL.
+ */
+svn_error_t *
+svn_cl__get_counting_editor(const svn_delta_editor_t **editor,
+                            void **edit_baton,
+                            svn_cl__editor_stats_t *stats,
+                            svn_client_ctx_t *ctx,
+                            apr_pool_t *pool);
+
+/* Print STATS to stdout, in the style of the null-export summary. */
+svn_error_t *
+svn_cl__print_editor_stats(const svn_cl__editor_stats_t *stats,
+                           apr_pool_t *pool);
+
+/* Open *RA_SESSION to the single target in OS (or OPT_STATE->TARGETS)
+ * for the update-like null-* commands, which compare two revisions of
+ * the target on the server.
+ *
+ * Set *TARGET_REV to the revision the editor drive should end at: the
+ * end of the -r range, or the peg revision, or HEAD.  Set *BASE_REV to
+ * the revision a client would report having: the start of the -r
+ * range, or SVN_INVALID_REVNUM if no -r option was given.
+ */
+svn_error_t *
+svn_cl__null_open_session(svn_ra_session_t **ra_session,
+                          svn_revnum_t *base_rev,
+                          svn_revnum_t *target_rev,
+                          apr_getopt_t *os,
+                          svn_cl__opt_state_t *opt_state,
+                          svn_client_ctx_t *ctx,
+                          apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,601 @@
+/*
+ * load-cmd.c -- Run a mixed workload from several concurrent clients
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ==================================================================== */
+
+
+
+/*** Includes. ***/
+
+#include <stdlib.h>
+
+#include <apr_thread_proc.h>
+
+#include "svn_client.h"
+#include "svn_cmdline.h"
+#include "svn_config.h"
+#include "svn_delta.h"
+#include "svn_dirent_uri.h"
+#include "svn_error.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_path.h"
+#include "svn_pools.h"
+#include "svn_props.h"
+#include "svn_ra.h"
+#include "svn_string.h"
+#include "cl.h"
+
+#include "svn_private_config.h"
+
+
+/*** The scenario. ***/
+
+/* The kinds of operation a scenario can contain. */
+typedef enum load_op_kind_t
+{
+  load_op_log,
+  load_op_list,
+  load_op_export,
+  load_op_update,
+  load_op_commit
+} load_op_kind_t;
+
+/* Names of the operations, indexed by load_op_kind_t. */
+static const char * const load_op_names[] =
+  { "log", "list", "export", "update", "commit" };
+
+#define LOAD_OP_KIND_COUNT \
+  (sizeof(load_op_names) / sizeof(load_op_names[0]))
+
+/* One line of the scenario file. */
+typedef struct load_op_t
+{
+  load_op_kind_t kind;
+
+  /* How often, relative to the other lines, this line gets picked. */
+  int weight;
+
+  /* The URL to work on. */
+  const char *url;
+
+  /* 'log': the number of entries to fetch; 'update': the revision to
+     update from. */
+  svn_revnum_t arg;
+} load_op_t;
+
+/* Parse the scenario in the file PATH into *OPS, an array of
+ * load_op_t, and set *TOTAL_WEIGHT to the sum of their weights.
+ *
+ * Each non-empty line that does not start with '#' has the form
+ *
+ *     WEIGHT OPERATION URL [ARG]
+ *
+ * where OPERATION is one of 'log' (ARG: entries, default 100),
+ * 'list', 'export', 'update' (ARG: the revision to update from) or
+ * 'commit', which adds a small file to the directory at URL.
+ */
+static svn_error_t *
+parse_scenario(apr_array_header_t **ops,
+               int *total_weight,
+               const char *path,
+               apr_pool_t *pool)
+{
+  svn_stringbuf_t *contents;
+  apr_array_header_t *lines;
+  int i;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, path, pool));
+  lines = svn_cstring_split(contents->data, "\r\n", TRUE, pool);
+
+  *ops = apr_array_make(pool, lines->nelts, sizeof(load_op_t));
+  *total_weight = 0;
+
+  for (i = 0; i < lines->nelts; ++i)
+    {
+      const char *line = APR_ARRAY_IDX(lines, i, const char *);
+      apr_array_header_t *words;
+      load_op_t *op;
+      apr_size_t k;
+
+      if (line[0] == '#' || line[0] == '\0')
+        continue;
+
+      words = svn_cstring_split(line, " \t", TRUE, pool);
+      if (words->nelts < 3 || words->nelts > 4)
+        return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                 _("Syntax error in scenario line '%s'"),
+                                 line);
+
+      op = apr_array_push(*ops);
+      SVN_ERR(svn_cstring_atoi(&op->weight,
+                               APR_ARRAY_IDX(words, 0, const char *)));
+      if (op->weight <= 0)
+        return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                 _("Weight must be positive in scenario "
+                                   "line '%s'"), line);
+
+      for (k = 0; k < LOAD_OP_KIND_COUNT; ++k)
+        if (strcmp(APR_ARRAY_IDX(words, 1, const char *),
+                   load_op_names[k]) == 0)
+          break;
+      if (k == LOAD_OP_KIND_COUNT)
+        return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                 _("Unknown operation in scenario line '%s'"),
+                                 line);
+      op->kind = (load_op_kind_t)k;
+
+      op->url = APR_ARRAY_IDX(words, 2, const char *);
+      if (! svn_path_is_url(op->url))
+        return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                 _("'%s' is not a URL"), op->url);
+
+      if (words->nelts == 4)
+        SVN_ERR(svn_revnum_parse(&op->arg,
+                                 APR_ARRAY_IDX(words, 3, const char *),
+                                 NULL));
+      else if (op->kind == load_op_log)
+        op->arg = 100;
+      else if (op->kind == load_op_update)
+        return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                 _("'update' needs a revision in scenario "
+                                   "line '%s'"), line);
+      else
+        op->arg = SVN_INVALID_REVNUM;
+
+      *total_weight += op->weight;
+    }
+
+  if (*total_weight == 0)
+    return svn_error_createf(SVN_ERR_CL_INSUFFICIENT_ARGS, NULL,
+                             _("Scenario '%s' contains no operations"),
+                             svn_dirent_local_style(path, pool));
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** The clients. ***/
+
+/* The state of one simulated client.  Everything in here belongs to
+ * the client's thread until that thread has been joined. */
+typedef struct load_client_t
+{
+  /* Our index, used to name committed files and to seed RANDOM. */
+  int id;
+
+  /* A private pool with its own allocator. */
+  apr_pool_t *pool;
+
+  /* A private client context with its own config and auth baton. */
+  svn_client_ctx_t *ctx;
+
+  /* The scenario, shared read-only by all clients. */
+  const apr_array_header_t *ops;
+  int total_weight;
+
+  /* When to stop. */
+  apr_time_t deadline;
+
+  /* One RA session per scenario line, opened on first use. */
+  svn_ra_session_t **sessions;
+
+  /* State of our pseudo-random number generator. */
+  apr_uint32_t random;
+
+  /* Latencies in microseconds, one apr_int64_t array per op kind. */
+  apr_array_header_t *latencies[LOAD_OP_KIND_COUNT];
+
+  /* Failed operations per op kind. */
+  int errors[LOAD_OP_KIND_COUNT];
+
+  /* The first error we saw, if any. */
+  svn_error_t *first_error;
+
+  /* How many files we committed so far. */
+  int commits;
+} load_client_t;
+
+/* Implements svn_log_entry_receiver_t, discarding the entry. */
+static svn_error_t *
+null_log_receiver(void *baton,
+                  svn_log_entry_t *log_entry,
+                  apr_pool_t *pool)
+{
+  return SVN_NO_ERROR;
+}
+
+/* Run OP once on SESSION for CLIENT, using SCRATCH_POOL. */
+static svn_error_t *
+run_op(load_client_t *client,
+       const load_op_t *op,
+       svn_ra_session_t *session,
+       apr_pool_t *scratch_pool)
+{
+  svn_cl__editor_stats_t stats = { 0 };
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  const svn_ra_reporter3_t *reporter;
+  void *report_baton;
+  svn_revnum_t head;
+
+  SVN_ERR(svn_ra_get_latest_revnum(session, &head, scratch_pool));
+
+  switch (op->kind)
+    {
+      case load_op_log:
+        {
+          apr_array_header_t *paths = apr_array_make(scratch_pool, 1,
+                                                     sizeof(const char *));
+          APR_ARRAY_PUSH(paths, const char *) = "";
+          SVN_ERR(svn_ra_get_log2(session, paths, head, 0, (int)op->arg,
+                                  FALSE, FALSE, FALSE, NULL,
+                                  null_log_receiver, NULL, scratch_pool));
+          break;
+        }
+
+      case load_op_list:
+        {
+          apr_hash_t *dirents;
+          SVN_ERR(svn_ra_get_dir2(session, &dirents, NULL, NULL, "", head,
+                                  SVN_DIRENT_ALL, scratch_pool));
+          break;
+        }
+
+      case load_op_export:
+      case load_op_update:
+        {
+          svn_boolean_t start_empty = (op->kind == load_op_export);
+
+          SVN_ERR(svn_cl__get_counting_editor(&editor, &edit_baton, &stats,
+                                              client->ctx, scratch_pool));
+          SVN_ERR(svn_ra_do_update3(session, &reporter, &report_baton,
+                                    head, "", svn_depth_infinity,
+                                    FALSE, FALSE, editor, edit_baton,
+                                    scratch_pool, scratch_pool));
+          SVN_ERR(reporter->set_path(report_baton, "",
+                                     start_empty ? head : op->arg,
+                                     svn_depth_infinity, start_empty,
+                                     NULL, scratch_pool));
+          SVN_ERR(reporter->finish_report(report_baton, scratch_pool));
+          break;
+        }
+
+      case load_op_commit:
+        {
+          apr_hash_t *revprops = apr_hash_make(scratch_pool);
+          svn_stringbuf_t *text;
+          void *root_baton;
+          void *file_baton;
+          svn_txdelta_window_handler_t handler;
+          void *handler_baton;
+          const char *name;
+
+          name = apr_psprintf(scratch_pool, "svnbench-load-%d-%d-%"
+                              APR_TIME_T_FMT, client->id, client->commits++,
+                              apr_time_now());
+          text = svn_stringbuf_createf(scratch_pool,
+                                       "Written by svnbench load.\n%s\n",
+                                       name);
+          svn_hash_sets(revprops, SVN_PROP_REVISION_LOG,
+                        svn_string_create("svnbench load", scratch_pool));
+
+          SVN_ERR(svn_ra_get_commit_editor3(session, &editor, &edit_baton,
+                                            revprops, NULL, NULL, NULL,
+                                            FALSE, scratch_pool));
+          SVN_ERR(editor->open_root(edit_baton, head, scratch_pool,
+                                    &root_baton));
+          SVN_ERR(editor->add_file(name, root_baton, NULL,
+                                   SVN_INVALID_REVNUM, scratch_pool,
+                                   &file_baton));
+          SVN_ERR(editor->apply_textdelta(file_baton, NULL, scratch_pool,
+                                          &handler, &handler_baton));
+          SVN_ERR(svn_txdelta_send_string(svn_string_create_from_buf(
+                                            text, scratch_pool),
+                                          handler, handler_baton,
+                                          scratch_pool));
+          SVN_ERR(editor->close_file(file_baton, NULL, scratch_pool));
+          SVN_ERR(editor->close_directory(root_baton, scratch_pool));
+          SVN_ERR(editor->close_edit(edit_baton, scratch_pool));
+          break;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a pseudo-random number in [0, LIMIT) from CLIENT's generator.
+ * Quality does not matter much here; independence between clients
+ * and not needing a lock do. */
+static int
+next_random(load_client_t *client, int limit)
+{
+  client->random = client->random * 1103515245 + 12345;
+  return (int)((client->random >> 8) % (apr_uint32_t)limit);
+}
+
+/* Pick the next scenario line for CLIENT, honouring the weights. */
+static int
+pick_op(load_client_t *client)
+{
+  int pick = next_random(client, client->total_weight);
+  int i;
+
+  for (i = 0; i < client->ops->nelts - 1; ++i)
+    {
+      const load_op_t *op = &APR_ARRAY_IDX(client->ops, i, load_op_t);
+      if (pick < op->weight)
+        break;
+      pick -= op->weight;
+    }
+
+  return i;
+}
+
+/* The main function of a client thread; DATA is its load_client_t. */
+static void * APR_THREAD_FUNC
+client_thread(apr_thread_t *thread, void *data)
+{
+  load_client_t *client = data;
+  apr_pool_t *iterpool = svn_pool_create(client->pool);
+
+  while (apr_time_now() < client->deadline)
+    {
+      int index = pick_op(client);
+      const load_op_t *op = &APR_ARRAY_IDX(client->ops, index, load_op_t);
+      apr_time_t start;
+      svn_error_t *err = SVN_NO_ERROR;
+
+      svn_pool_clear(iterpool);
+
+      /* Opening the session is not part of the measured operation. */
+      if (client->sessions[index] == NULL)
+        err = svn_client_open_ra_session2(&client->sessions[index], op->url,
+                                          NULL, client->ctx, client->pool,
+                                          iterpool);
+
+      start = apr_time_now();
+      if (!err)
+        err = run_op(client, op, client->sessions[index], iterpool);
+
+      if (err)
+        {
+          client->errors[op->kind]++;
+          if (client->first_error == NULL)
+            client->first_error = err;
+          else
+            svn_error_clear(err);
+
+          if (client->first_error->apr_err == SVN_ERR_CANCELLED)
+            break;
+          continue;
+        }
+
+      APR_ARRAY_PUSH(client->latencies[op->kind], apr_int64_t)
+        = apr_time_now() - start;
+    }
+
+  svn_pool_destroy(iterpool);
+  apr_thread_exit(thread, APR_SUCCESS);
+  return NULL;
+}
+
+
+/*** Reporting. ***/
+
+/* qsort() comparison function for apr_int64_t. */
+static int
+compare_latency(const void *a, const void *b)
+{
+  apr_int64_t x = *(const apr_int64_t *)a;
+  apr_int64_t y = *(const apr_int64_t *)b;
+
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Return the PERCENT-th percentile of the sorted LATENCIES, in
+ * milliseconds, using the nearest-rank method. */
+static double
+percentile(const apr_array_header_t *latencies, int percent)
+{
+  int rank = (int)(((apr_int64_t)latencies->nelts * percent + 99) / 100);
+  if (rank < 1)
+    rank = 1;
+
+  return APR_ARRAY_IDX(latencies, rank - 1, apr_int64_t) / 1.0e3;
+}
+
+
+/*** Code. ***/
+
+/* This implements the `svn_opt_subcommand_t' interface. */
+svn_error_t *
+svn_cl__load(apr_getopt_t *os,
+             void *baton,
+             apr_pool_t *pool)
+{
+  svn_cl__opt_state_t *opt_state = ((svn_cl__cmd_baton_t *) baton)->opt_state;
+  svn_client_ctx_t *ctx = ((svn_cl__cmd_baton_t *) baton)->ctx;
+#if APR_HAS_THREADS
+  apr_array_header_t *targets;
+  apr_array_header_t *ops;
+  int total_weight;
+  load_client_t *clients;
+  apr_thread_t **threads;
+  apr_time_t start_time, elapsed;
+  svn_error_t *err = SVN_NO_ERROR;
+  int clients_started;
+  apr_size_t k;
+  int i;
+
+  SVN_ERR(svn_cl__args_to_target_array_print_reserved(&targets, os,
+                                                      opt_state->targets,
+                                                      ctx, FALSE, pool));
+  if (targets->nelts < 1)
+    return svn_error_create(SVN_ERR_CL_INSUFFICIENT_ARGS, 0, NULL);
+  if (targets->nelts > 1)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, 0, NULL);
+
+  SVN_ERR(parse_scenario(&ops, &total_weight,
+                         APR_ARRAY_IDX(targets, 0, const char *), pool));
+
+  clients = apr_pcalloc(pool, opt_state->clients * sizeof(*clients));
+  threads = apr_pcalloc(pool, opt_state->clients * sizeof(*threads));
+
+  /* Give every client its own pool, config and auth baton.  None of
+     these may be shared between threads. */
+  for (i = 0; i < opt_state->clients; ++i)
+    {
+      load_client_t *client = &clients[i];
+      apr_hash_t *config;
+      svn_config_t *cfg_config;
+
+      client->id = i;
+      client->pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+      client->ops = ops;
+      client->total_weight = total_weight;
+      client->random = (apr_uint32_t)(i * 2654435761u
+                                      ^ (apr_uint32_t)apr_time_now());
+      client->sessions = apr_pcalloc(client->pool,
+                                     ops->nelts * sizeof(*client->sessions));
+      for (k = 0; k < LOAD_OP_KIND_COUNT; ++k)
+        client->latencies[k] = apr_array_make(client->pool, 1024,
+                                              sizeof(apr_int64_t));
+
+      SVN_ERR(svn_config_copy_config(&config, ctx->config, client->pool));
+      cfg_config = svn_hash_gets(config, SVN_CONFIG_CATEGORY_CONFIG);
+
+      SVN_ERR(svn_client_create_context2(&client->ctx, config, client->pool));
+      client->ctx->cancel_func = ctx->cancel_func;
+      client->ctx->cancel_baton = ctx->cancel_baton;
+
+      /* There is no sensible way to prompt from many threads at once. */
+      SVN_ERR(svn_cmdline_create_auth_baton2(
+                &client->ctx->auth_baton,
+                TRUE /* non_interactive */,
+                opt_state->auth_username,
+                opt_state->auth_password,
+                opt_state->config_dir,
+                opt_state->no_auth_cache,
+                opt_state->trust_server_cert_unknown_ca,
+                opt_state->trust_server_cert_cn_mismatch,
+                opt_state->trust_server_cert_expired,
+                opt_state->trust_server_cert_not_yet_valid,
+                opt_state->trust_server_cert_other_failure,
+                cfg_config,
+                ctx->cancel_func,
+                ctx->cancel_baton,
+                client->pool));
+    }
+
+  start_time = apr_time_now();
+  for (clients_started = 0;
+       clients_started < opt_state->clients;
+       ++clients_started)
+    {
+      apr_status_t status;
+      load_client_t *client = &clients[clients_started];
+
+      client->deadline = start_time
+                       + apr_time_from_sec(opt_state->duration);
+      status = apr_thread_create(&threads[clients_started], NULL,
+                                 client_thread, client, pool);
+      if (status)
+        {
+          err = svn_error_wrap_apr(status, _("Can't create thread"));
+          break;
+        }
+    }
+
+  for (i = 0; i < clients_started; ++i)
+    {
+      apr_status_t thread_status;
+      apr_thread_join(&thread_status, threads[i]);
+    }
+  elapsed = apr_time_now() - start_time;
+
+  /* Merge and report the results. */
+  if (!err && !opt_state->quiet)
+    SVN_ERR(svn_cmdline_printf(pool,
+                               _("%d clients for %.3f seconds\n"
+                                 "%-8s %10s %10s %10s %10s %10s %8s\n"),
+                               clients_started, elapsed / 1.0e6,
+                               _("op"), _("count"), _("ops/s"),
+                               _("p50 ms"), _("p95 ms"), _("p99 ms"),
+                               _("errors")));
+
+  for (k = 0; k < LOAD_OP_KIND_COUNT; ++k)
+    {
+      apr_array_header_t *latencies = apr_array_make(pool, 0,
+                                                     sizeof(apr_int64_t));
+      int errors = 0;
+
+      for (i = 0; i < opt_state->clients; ++i)
+        {
+          apr_array_cat(latencies, clients[i].latencies[k]);
+          errors += clients[i].errors[k];
+        }
+
+      if (err || opt_state->quiet || (latencies->nelts == 0 && errors == 0))
+        continue;
+
+      if (latencies->nelts == 0)
+        {
+          SVN_ERR(svn_cmdline_printf(pool, "%-8s %10d %10s %10s %10s %10s "
+                                     "%8d\n", load_op_names[k], 0, "-",
+                                     "-", "-", "-", errors));
+          continue;
+        }
+
+      qsort(latencies->elts, latencies->nelts, latencies->elt_size,
+            compare_latency);
+      SVN_ERR(svn_cmdline_printf(pool, "%-8s %10d %10.2f %10.3f %10.3f "
+                                 "%10.3f %8d\n",
+                                 load_op_names[k], latencies->nelts,
+                                 latencies->nelts / (elapsed / 1.0e6),
+                                 percentile(latencies, 50),
+                                 percentile(latencies, 95),
+                                 percentile(latencies, 99),
+                                 errors));
+    }
+
+  /* Show the first error of each client so failures are visible. */
+  for (i = 0; i < opt_state->clients; ++i)
+    {
+      if (clients[i].first_error)
+        {
+          if (!err && !opt_state->quiet)
+            svn_handle_warning2(stderr, clients[i].first_error,
+                                "svnbench: ");
+          svn_error_clear(clients[i].first_error);
+        }
+      svn_pool_destroy(clients[i].pool);
+    }
+
+  return svn_error_trace(err);
+#else
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("The load command needs thread support "
+                            "in APR"));
+#endif
+}
@@ -0,0 +1,93 @@
+/*
+ * null-diff-cmd.c -- Subversion null-diff command
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ==================================================================== */
+
+
+
+/*** Includes. ***/
+
+#include "svn_client.h"
+#include "svn_error.h"
+#include "svn_ra.h"
+#include "cl.h"
+
+#include "svn_private_config.h"
+
+
+/*** Code. ***/
+
+/* This implements the `svn_opt_subcommand_t' interface. */
+svn_error_t *
+svn_cl__null_diff(apr_getopt_t *os,
+                  void *baton,
+                  apr_pool_t *pool)
+{
+  svn_cl__opt_state_t *opt_state = ((svn_cl__cmd_baton_t *) baton)->opt_state;
+  svn_client_ctx_t *ctx = ((svn_cl__cmd_baton_t *) baton)->ctx;
+  svn_cl__editor_stats_t stats = { 0 };
+  svn_ra_session_t *ra_session;
+  svn_revnum_t base_rev;
+  svn_revnum_t target_rev;
+  const char *session_url;
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  const svn_ra_reporter3_t *reporter;
+  void *report_baton;
+
+  SVN_ERR(svn_cl__null_open_session(&ra_session, &base_rev, &target_rev,
+                                    os, opt_state, ctx, pool));
+
+  if (! SVN_IS_VALID_REVNUM(base_rev))
+    return svn_error_create(SVN_ERR_CL_INSUFFICIENT_ARGS, NULL,
+                            _("null-diff needs a revision range "
+                              "given with -r"));
+
+  if (opt_state->depth == svn_depth_unknown)
+    opt_state->depth = svn_depth_infinity;
+
+  SVN_ERR(svn_cl__get_counting_editor(&editor, &edit_baton, &stats, ctx,
+                                      pool));
+  SVN_ERR(svn_ra_get_session_url(ra_session, &session_url, pool));
+
+  /* Compare the target with itself, like 'svn diff -rN:M URL' does. */
+  SVN_ERR(svn_ra_do_diff3(ra_session,
+                          &reporter, &report_baton,
+                          target_rev,
+                          "", /* no sub-target */
+                          opt_state->depth,
+                          FALSE, /* don't ignore ancestry */
+                          TRUE, /* text deltas */
+                          session_url,
+                          editor, edit_baton,
+                          pool));
+
+  SVN_ERR(reporter->set_path(report_baton, "", base_rev,
+                             svn_depth_infinity, FALSE, NULL, pool));
+  SVN_ERR(reporter->finish_report(report_baton, pool));
+
+  if (!opt_state->quiet)
+    SVN_ERR(svn_cl__print_editor_stats(&stats, pool));
+
+  return SVN_NO_ERROR;
+}
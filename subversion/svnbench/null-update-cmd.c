@@ -0,0 +1,148 @@
+/*
+ * null-update-cmd.c -- Subversion null-checkout and null-update commands
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ==================================================================== */
+
+
+
+/*** Includes. ***/
+
+#include "svn_client.h"
+#include "svn_error.h"
+#include "svn_ra.h"
+#include "cl.h"
+
+#include "svn_private_config.h"
+
+
+/*** Code. ***/
+
+/* Drive an update of the session target to TARGET_REV, limited to
+ * DEPTH, into a counting editor and print what it has seen unless
+ * QUIET is set.  If BASE_REV is valid, report the target as complete
+ * at that revision, else report it as empty, like a checkout does.
+ */
+static svn_error_t *
+bench_null_update(svn_ra_session_t *ra_session,
+                  svn_revnum_t base_rev,
+                  svn_revnum_t target_rev,
+                  svn_depth_t depth,
+                  svn_boolean_t quiet,
+                  svn_client_ctx_t *ctx,
+                  apr_pool_t *pool)
+{
+  svn_cl__editor_stats_t stats = { 0 };
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  const svn_ra_reporter3_t *reporter;
+  void *report_baton;
+  svn_boolean_t start_empty = ! SVN_IS_VALID_REVNUM(base_rev);
+
+  SVN_ERR(svn_cl__get_counting_editor(&editor, &edit_baton, &stats, ctx,
+                                      pool));
+
+  SVN_ERR(svn_ra_do_update3(ra_session,
+                            &reporter, &report_baton,
+                            target_rev,
+                            "", /* no sub-target */
+                            depth,
+                            FALSE, /* don't want copyfrom-args */
+                            FALSE, /* don't want ignore_ancestry */
+                            editor, edit_baton,
+                            pool, pool));
+
+  /* A checkout claims to have an empty directory; an update claims to
+     have the whole tree at BASE_REV. */
+  SVN_ERR(reporter->set_path(report_baton, "",
+                             start_empty ? target_rev : base_rev,
+                             svn_depth_infinity, start_empty,
+                             NULL, pool));
+
+  SVN_ERR(reporter->finish_report(report_baton, pool));
+
+  if (!quiet)
+    SVN_ERR(svn_cl__print_editor_stats(&stats, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* This implements the `svn_opt_subcommand_t' interface. */
+svn_error_t *
+svn_cl__null_checkout(apr_getopt_t *os,
+                      void *baton,
+                      apr_pool_t *pool)
+{
+  svn_cl__opt_state_t *opt_state = ((svn_cl__cmd_baton_t *) baton)->opt_state;
+  svn_client_ctx_t *ctx = ((svn_cl__cmd_baton_t *) baton)->ctx;
+  svn_ra_session_t *ra_session;
+  svn_revnum_t base_rev;
+  svn_revnum_t target_rev;
+
+  /* A checkout has no base; -r REV only selects the target. */
+  if (opt_state->end_revision.kind != svn_opt_revision_unspecified)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("null-checkout takes a single revision"));
+
+  opt_state->end_revision = opt_state->start_revision;
+  opt_state->start_revision.kind = svn_opt_revision_unspecified;
+
+  SVN_ERR(svn_cl__null_open_session(&ra_session, &base_rev, &target_rev,
+                                    os, opt_state, ctx, pool));
+
+  if (opt_state->depth == svn_depth_unknown)
+    opt_state->depth = svn_depth_infinity;
+
+  return svn_error_trace(bench_null_update(ra_session, SVN_INVALID_REVNUM,
+                                           target_rev, opt_state->depth,
+                                           opt_state->quiet, ctx, pool));
+}
+
+/* This implements the `svn_opt_subcommand_t' interface. */
+svn_error_t *
+svn_cl__null_update(apr_getopt_t *os,
+                    void *baton,
+                    apr_pool_t *pool)
+{
+  svn_cl__opt_state_t *opt_state = ((svn_cl__cmd_baton_t *) baton)->opt_state;
+  svn_client_ctx_t *ctx = ((svn_cl__cmd_baton_t *) baton)->ctx;
+  svn_ra_session_t *ra_session;
+  svn_revnum_t base_rev;
+  svn_revnum_t target_rev;
+
+  SVN_ERR(svn_cl__null_open_session(&ra_session, &base_rev, &target_rev,
+                                    os, opt_state, ctx, pool));
+
+  if (! SVN_IS_VALID_REVNUM(base_rev))
+    return svn_error_create(SVN_ERR_CL_INSUFFICIENT_ARGS, NULL,
+                            _("null-update needs the base revision "
+                              "given with -r"));
+
+  /* Unlike 'svn update', an explicit --depth is not sticky here; it
+     simply limits the update to that depth. */
+  if (opt_state->depth == svn_depth_unknown)
+    opt_state->depth = svn_depth_infinity;
+
+  return svn_error_trace(bench_null_update(ra_session, base_rev, target_rev,
+                                           opt_state->depth,
+                                           opt_state->quiet, ctx, pool));
+}
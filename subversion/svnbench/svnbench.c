@@ -29,6 +29,7 @@
 
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 
 #include "svn_cmdline.h"
 #include "svn_dirent_uri.h"
@@ -70,7 +71,9 @@ typedef enum svn_cl__longopt_t {
   opt_trust_server_cert,
   opt_trust_server_cert_failures,
   opt_changelist,
-  opt_search
+  opt_search,
+  opt_clients,
+  opt_duration
 } svn_cl__longopt_t;
 
 
@@ -171,6 +174,10 @@ const apr_getopt_option_t svn_cl__options[] =
                        "history")},
   {"search", opt_search, 1,
                        N_("use ARG as search pattern (glob syntax)")},
+  {"clients",       opt_clients, 1,
+                    N_("run ARG concurrent clients (default: 1)")},
+  {"duration",      opt_duration, 1,
+                    N_("run for ARG seconds (default: 10)")},
 
   /* Long-opt Aliases
    *
@@ -215,6 +222,30 @@ const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
     {0} },
   /* This command is also invoked if we see option "--help", "-h" or "-?". */
 
+  { "load", svn_cl__load, {0}, {N_(
+     "Run a mixed workload against one or more servers.\n"
+     "usage: load [--clients N] [--duration T] SCENARIO\n"
+     "\n"), N_(
+     "  Starts N client threads, each with its own connections, that keep\n"
+     "  running operations picked at random from the file SCENARIO for T\n"
+     "  seconds, then prints throughput and latency percentiles for each\n"
+     "  kind of operation.\n"
+     "\n"), N_(
+     "  Each line of SCENARIO reads 'WEIGHT OPERATION URL [ARG]', where\n"
+     "  OPERATION is one of:\n"
+     "\n"), N_(
+     "    log      fetch the ARG (default: 100) latest log entries of URL\n"
+     "    list     list the directory URL at HEAD\n"
+     "    export   fetch the whole tree at URL at HEAD\n"
+     "    update   update the tree at URL from revision ARG to HEAD\n"
+     "    commit   add a small file to the directory URL\n"
+     "\n"), N_(
+     "  Lines are picked in proportion to their WEIGHT.  Empty lines and\n"
+     "  lines starting with '#' are ignored.  Authentication prompts are\n"
+     "  never shown while the clients run.\n"
+    )},
+    {opt_clients, opt_duration, 'q'} },
+
   { "null-blame", svn_cl__null_blame, {0}, {N_(
      "Fetch all versions of a file in a batch.\n"
      "usage: null-blame [-rM:N] TARGET[@REV]...\n"
@@ -236,6 +267,27 @@ const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
     )},
     {'r', 'g'} },
 
+  { "null-checkout", svn_cl__null_checkout, {"null-co"}, {N_(
+     "Drive a checkout of a tree without writing a working copy.\n"
+     "usage: null-checkout [-r REV] URL[@PEGREV]\n"
+     "\n"), N_(
+     "  Runs the update report of a checkout of URL, at revision REV if it\n"
+     "  is given, otherwise at HEAD, and counts what the server sends.\n"
+     "\n"), N_(
+     "  If specified, PEGREV determines in which revision the target is first\n"
+     "  looked up.\n"
+    )},
+    {'r', 'q', 'N', opt_depth} },
+
+  { "null-diff", svn_cl__null_diff, {0}, {N_(
+     "Drive a diff between two revisions of a tree on the server.\n"
+     "usage: null-diff -r N[:M] URL[@PEGREV]\n"
+     "\n"), N_(
+     "  Runs the diff report from revision N to revision M (default: PEGREV,\n"
+     "  or HEAD) of URL, with text deltas, and counts what the server sends.\n"
+    )},
+    {'r', 'q', 'N', opt_depth} },
+
   { "null-export", svn_cl__null_export, {0}, {N_(
      "Create an unversioned copy of a tree.\n"
      "usage: null-export [-r REV] URL[@PEGREV]\n"
@@ -316,6 +368,25 @@ const svn_opt_subcommand_desc3_t svn_cl__cmd_table[] =
     {'r', 'R', opt_depth, opt_targets, opt_changelist}
   },
 
+  { "null-status", svn_cl__null_status, {"null-st"}, {N_(
+     "Drive the server half of 'status -u' on a tree.\n"
+     "usage: null-status -r N URL[@PEGREV]\n"
+     "\n"), N_(
+     "  Reports URL as a working copy at revision N and counts the changes\n"
+     "  up to PEGREV (default: HEAD) that the server sends back.\n"
+    )},
+    {'r', 'q', 'N', opt_depth} },
+
+  { "null-update", svn_cl__null_update, {"null-up"}, {N_(
+     "Drive an update of a tree without a working copy.\n"
+     "usage: null-update -r N[:M] URL[@PEGREV]\n"
+     "\n"), N_(
+     "  Reports URL as a working copy at revision N, runs the update report\n"
+     "  to revision M (default: PEGREV, or HEAD) and counts what the server\n"
+     "  sends.  With --depth, the update is limited to that depth.\n"
+    )},
+    {'r', 'q', 'N', opt_depth} },
+
   { NULL, NULL, {0}, {NULL}, {0} }
 };
 
@@ -402,6 +473,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_boolean_t descend = TRUE;
   svn_boolean_t use_notifier = TRUE;
   apr_time_t start_time, time_taken;
+  clock_t start_clock, cpu_taken;
   ra_progress_baton_t ra_progress_baton = {0};
   svn_membuf_t buf;
   svn_boolean_t read_pass_from_stdin = FALSE;
@@ -431,6 +503,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.revision_ranges =
     apr_array_make(pool, 0, sizeof(svn_opt_revision_range_t *));
   opt_state.depth = svn_depth_unknown;
+  opt_state.clients = 1;
+  opt_state.duration = 10;
 
   /* No args?  Show usage. */
   if (argc <= 1)
@@ -480,6 +554,26 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
             }
         }
         break;
+      case opt_clients:
+        err = svn_cstring_atoi(&opt_state.clients, opt_arg);
+        if (err)
+          return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, err,
+                                  _("Non-numeric clients argument given"));
+        if (opt_state.clients <= 0)
+          return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                                  _("Argument to --clients must be "
+                                    "positive"));
+        break;
+      case opt_duration:
+        err = svn_cstring_atoi(&opt_state.duration, opt_arg);
+        if (err)
+          return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, err,
+                                  _("Non-numeric duration argument given"));
+        if (opt_state.duration <= 0)
+          return svn_error_create(SVN_ERR_INCORRECT_PARAMS, NULL,
+                                  _("Argument to --duration must be "
+                                    "positive"));
+        break;
       case 'c':
         {
           apr_array_header_t *change_revs =
@@ -986,7 +1080,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
   /* And now we finally run the subcommand. */
   start_time = apr_time_now();
+  start_clock = clock();
   err = (*subcommand->cmd_func)(os, &command_baton, pool);
+  cpu_taken = clock() - start_clock;
   time_taken = apr_time_now() - start_time;
 
   if (err)
@@ -1025,6 +1121,13 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                                 _("%15.6f seconds taken\n"),
                                 time_taken / 1.0e6));
 
+      /* CPU time spent on the client side, so that server-side cost
+         can be told apart from local processing. */
+      if (start_clock != (clock_t)-1 && cpu_taken >= 0)
+        SVN_ERR(svn_cmdline_printf(pool,
+                                   _("%15.6f seconds of client CPU time\n"),
+                                   (double)cpu_taken / CLOCKS_PER_SEC));
+
       /* Report how many bytes transferred over network if RA layer provided
          this information. */
       if (ra_progress_baton.bytes_transferred > 0)
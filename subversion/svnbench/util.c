@@ -36,9 +36,15 @@
 #include "svn_private_config.h"
 #include "svn_error.h"
 #include "svn_path.h"
+#include "svn_cmdline.h"
+#include "svn_delta.h"
+#include "svn_ra.h"
 
 #include "cl.h"
 
+#include "private/svn_string_private.h"
+#include "private/svn_client_private.h"
+
 
 
 svn_error_t *
@@ -90,3 +96,232 @@ svn_cl__local_style_skip_ancestor(const char *parent_path,
   return svn_dirent_local_style(relpath ? relpath : path, pool);
 }
 
+
+/*** The counting editor. ***/
+
+static svn_error_t *
+count_open_root(void *edit_baton,
+                svn_revnum_t base_revision,
+                apr_pool_t *pool,
+                void **root_baton)
+{
+  svn_cl__editor_stats_t *stats = edit_baton;
+  stats->dir_count++;
+
+  *root_baton = edit_baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_delete_entry(const char *path,
+                   svn_revnum_t revision,
+                   void *parent_baton,
+                   apr_pool_t *pool)
+{
+  svn_cl__editor_stats_t *stats = parent_baton;
+  stats->delete_count++;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_add_directory(const char *path,
+                    void *parent_baton,
+                    const char *copyfrom_path,
+                    svn_revnum_t copyfrom_revision,
+                    apr_pool_t *pool,
+                    void **baton)
+{
+  svn_cl__editor_stats_t *stats = parent_baton;
+  stats->dir_count++;
+
+  *baton = parent_baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_open_directory(const char *path,
+                     void *parent_baton,
+                     svn_revnum_t base_revision,
+                     apr_pool_t *pool,
+                     void **baton)
+{
+  svn_cl__editor_stats_t *stats = parent_baton;
+  stats->dir_count++;
+
+  *baton = parent_baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_add_file(const char *path,
+               void *parent_baton,
+               const char *copyfrom_path,
+               svn_revnum_t copyfrom_revision,
+               apr_pool_t *pool,
+               void **baton)
+{
+  svn_cl__editor_stats_t *stats = parent_baton;
+  stats->file_count++;
+
+  *baton = parent_baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_open_file(const char *path,
+                void *parent_baton,
+                svn_revnum_t base_revision,
+                apr_pool_t *pool,
+                void **baton)
+{
+  svn_cl__editor_stats_t *stats = parent_baton;
+  stats->file_count++;
+
+  *baton = parent_baton;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_window(svn_txdelta_window_t *window, void *baton)
+{
+  svn_cl__editor_stats_t *stats = baton;
+  if (window != NULL)
+    {
+      stats->window_count++;
+      stats->byte_count += window->tview_len;
+      if (window->new_data)
+        stats->new_data_count += window->new_data->len;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_apply_textdelta(void *file_baton,
+                      const char *base_checksum,
+                      apr_pool_t *pool,
+                      svn_txdelta_window_handler_t *handler,
+                      void **handler_baton)
+{
+  *handler_baton = file_baton;
+  *handler = count_window;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+count_change_prop(void *baton,
+                  const char *name,
+                  const svn_string_t *value,
+                  apr_pool_t *pool)
+{
+  svn_cl__editor_stats_t *stats = baton;
+  stats->prop_count++;
+  if (value)
+    stats->prop_byte_count += value->len;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_cl__get_counting_editor(const svn_delta_editor_t **editor,
+                            void **edit_baton,
+                            svn_cl__editor_stats_t *stats,
+                            svn_client_ctx_t *ctx,
+                            apr_pool_t *pool)
+{
+  svn_delta_editor_t *counter = svn_delta_default_editor(pool);
+
+  counter->open_root = count_open_root;
+  counter->delete_entry = count_delete_entry;
+  counter->add_directory = count_add_directory;
+  counter->open_directory = count_open_directory;
+  counter->change_dir_prop = count_change_prop;
+  counter->add_file = count_add_file;
+  counter->open_file = count_open_file;
+  counter->apply_textdelta = count_apply_textdelta;
+  counter->change_file_prop = count_change_prop;
+
+  return svn_error_trace(svn_delta_get_cancellation_editor(ctx->cancel_func,
+                                                           ctx->cancel_baton,
+                                                           counter, stats,
+                                                           editor, edit_baton,
+                                                           pool));
+}
+
+svn_error_t *
+svn_cl__print_editor_stats(const svn_cl__editor_stats_t *stats,
+                           apr_pool_t *pool)
+{
+  return svn_error_trace(svn_cmdline_printf(pool,
+                           _("%15s directories\n"
+                             "%15s files\n"
+                             "%15s deletions\n"
+                             "%15s text delta windows\n"
+                             "%15s bytes in files\n"
+                             "%15s bytes of new data in deltas\n"
+                             "%15s properties\n"
+                             "%15s bytes in properties\n"),
+                           svn__ui64toa_sep(stats->dir_count, ',', pool),
+                           svn__ui64toa_sep(stats->file_count, ',', pool),
+                           svn__ui64toa_sep(stats->delete_count, ',', pool),
+                           svn__ui64toa_sep(stats->window_count, ',', pool),
+                           svn__ui64toa_sep(stats->byte_count, ',', pool),
+                           svn__ui64toa_sep(stats->new_data_count, ',', pool),
+                           svn__ui64toa_sep(stats->prop_count, ',', pool),
+                           svn__ui64toa_sep(stats->prop_byte_count, ',',
+                                            pool)));
+}
+
+svn_error_t *
+svn_cl__null_open_session(svn_ra_session_t **ra_session,
+                          svn_revnum_t *base_rev,
+                          svn_revnum_t *target_rev,
+                          apr_getopt_t *os,
+                          svn_cl__opt_state_t *opt_state,
+                          svn_client_ctx_t *ctx,
+                          apr_pool_t *pool)
+{
+  apr_array_header_t *targets;
+  const char *truepath;
+  svn_opt_revision_t peg_revision;
+  svn_opt_revision_t revision;
+  svn_client__pathrev_t *loc;
+
+  SVN_ERR(svn_cl__args_to_target_array_print_reserved(&targets, os,
+                                                      opt_state->targets,
+                                                      ctx, FALSE, pool));
+
+  /* We want exactly 1 target for these subcommands. */
+  if (targets->nelts < 1)
+    return svn_error_create(SVN_ERR_CL_INSUFFICIENT_ARGS, 0, NULL);
+  if (targets->nelts > 1)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, 0, NULL);
+
+  SVN_ERR(svn_opt_parse_path(&peg_revision, &truepath,
+                             APR_ARRAY_IDX(targets, 0, const char *), pool));
+  if (peg_revision.kind == svn_opt_revision_unspecified)
+    peg_revision.kind = svn_opt_revision_head;
+
+  /* -rN:M drives the editor from N to M; -rN from N to the peg. */
+  if (opt_state->end_revision.kind != svn_opt_revision_unspecified)
+    revision = opt_state->end_revision;
+  else
+    revision = peg_revision;
+
+  SVN_ERR(svn_client__ra_session_from_path2(ra_session, &loc, truepath, NULL,
+                                            &peg_revision, &revision,
+                                            ctx, pool));
+  *target_rev = loc->rev;
+
+  if (opt_state->start_revision.kind != svn_opt_revision_unspecified)
+    SVN_ERR(svn_client__get_revision_number(base_rev, NULL, ctx->wc_ctx,
+                                            NULL, *ra_session,
+                                            &opt_state->start_revision,
+                                            pool));
+  else
+    *base_rev = SVN_INVALID_REVNUM;
+
+  return SVN_NO_ERROR;
+}
@@ -106,51 +106,100 @@ write_propdel_to_stringbuf(svn_stringbuf_t **strbuf,
 }
 
 
-/* Compare the node-path PATH with the (const char *) prefixes in PFXLIST.
- * Return TRUE if any prefix is a prefix of PATH (matching whole path
- * components); FALSE otherwise.
- * PATH starts with a '/', as do the (const char *) paths in PREFIXES. */
-/* This function is a duplicate of svnadmin.c:ary_prefix_match(). */
-static svn_boolean_t
-ary_prefix_match(const apr_array_header_t *pfxlist, const char *path)
+/* The prefixes or glob patterns to filter by, prepared such that a path
+   can be matched against thousands of them without comparing it to each
+   one of them. */
+typedef struct prefix_matcher_t
+{
+  /* Prefixes respectively patterns without any glob special characters.
+     Maps const char * to the same string. */
+  apr_hash_t *literals;
+
+  /* Set if a single-character prefix, i.e. "/", matches every path. */
+  svn_boolean_t match_all;
+
+  /* The remaining (const char *) glob patterns. */
+  apr_array_header_t *patterns;
+
+  /* Whether the PREFIXES given to create_prefix_matcher() were patterns. */
+  svn_boolean_t glob;
+} prefix_matcher_t;
+
+/* Return a new matcher for the (const char *) elements of PREFIXES,
+   allocated in POOL.  If GLOB is set, they are file glob patterns and
+   paths must match them as a whole.  Otherwise, they are path prefixes.
+   Each of them starts with a '/'. */
+static prefix_matcher_t *
+create_prefix_matcher(const apr_array_header_t *prefixes,
+                      svn_boolean_t glob,
+                      apr_pool_t *pool)
 {
+  prefix_matcher_t *matcher = apr_pcalloc(pool, sizeof(*matcher));
   int i;
-  size_t path_len = strlen(path);
 
-  for (i = 0; i < pfxlist->nelts; i++)
+  matcher->literals = apr_hash_make(pool);
+  matcher->patterns = apr_array_make(pool, 0, sizeof(const char *));
+  matcher->glob = glob;
+
+  for (i = 0; i < prefixes->nelts; i++)
     {
-      const char *pfx = APR_ARRAY_IDX(pfxlist, i, const char *);
-      size_t pfx_len = strlen(pfx);
+      const char *pfx = APR_ARRAY_IDX(prefixes, i, const char *);
 
-      if (path_len < pfx_len)
-        continue;
-      if (strncmp(path, pfx, pfx_len) == 0
-          && (pfx_len == 1 || path[pfx_len] == '\0' || path[pfx_len] == '/'))
-        return TRUE;
+      if (glob && strpbrk(pfx, "*?[\\"))
+        APR_ARRAY_PUSH(matcher->patterns, const char *) = pfx;
+      else if (!glob && strlen(pfx) == 1)
+        matcher->match_all = TRUE;
+      else
+        svn_hash_sets(matcher->literals, pfx, pfx);
     }
 
+  return matcher;
+}
+
+/* Return TRUE if PATH matches any of the prefixes or patterns in MATCHER.
+   A prefix matches if it is PATH itself or one of its ancestors, i.e.
+   if it matches whole path components.
+   PATH starts with a '/', as do the prefixes in MATCHER. */
+static svn_boolean_t
+prefix_match(const prefix_matcher_t *matcher, const char *path)
+{
+  apr_ssize_t path_len = strlen(path);
+  apr_ssize_t len;
+
+  if (matcher->match_all)
+    return TRUE;
+
+  if (apr_hash_get(matcher->literals, path, path_len))
+    return TRUE;
+
+  if (matcher->glob)
+    return svn_cstring_match_glob_list(path, matcher->patterns);
+
+  /* Look up every parent path.  Their number is bound by the depth of
+     PATH rather than by the number of prefixes. */
+  for (len = path_len - 1; len > 0; len--)
+    if (path[len] == '/' && apr_hash_get(matcher->literals, path, len))
+      return TRUE;
+
   return FALSE;
 }
 
 
 /* Check whether we need to skip this PATH based on its presence in
-   the PREFIXES list, and the DO_EXCLUDE option.
-   PATH starts with a '/', as do the (const char *) paths in PREFIXES. */
+   the prefixes of MATCHER, and the DO_EXCLUDE option.
+   PATH starts with a '/', as do the prefixes in MATCHER. */
 static APR_INLINE svn_boolean_t
-skip_path(const char *path, const apr_array_header_t *prefixes,
-          svn_boolean_t do_exclude, svn_boolean_t glob)
+skip_path(const char *path, const prefix_matcher_t *matcher,
+          svn_boolean_t do_exclude)
 {
-  const svn_boolean_t matches =
-    (glob
-     ? svn_cstring_match_glob_list(path, prefixes)
-     : ary_prefix_match(prefixes, path));
+  const svn_boolean_t matches = prefix_match(matcher, path);
 
   /* NXOR */
   return (matches ? do_exclude : !do_exclude);
 }
 
 
-
+
 /* Note: the input stream parser calls us with events.
    Output of the filtered dump occurs for the most part streamily with the
    event callbacks, to avoid caching large quantities of data in memory.
@@ -179,14 +228,13 @@ struct parse_baton_t
   /* Command-line options values. */
   svn_boolean_t do_exclude;
   svn_boolean_t quiet;
-  svn_boolean_t glob;
   svn_boolean_t drop_empty_revs;
   svn_boolean_t drop_all_empty_revs;
   svn_boolean_t do_renumber_revs;
   svn_boolean_t preserve_revprops;
   svn_boolean_t skip_missing_merge_sources;
   svn_boolean_t allow_deltas;
-  apr_array_header_t *prefixes;
+  prefix_matcher_t *matcher;
 
   /* Input and output streams. */
   svn_stream_t *in_stream;
@@ -479,8 +527,7 @@ new_node_record(void **node_baton,
   if (copyfrom_path && copyfrom_path[0] != '/')
     copyfrom_path = apr_pstrcat(pool, "/", copyfrom_path, SVN_VA_NULL);
 
-  nb->do_skip = skip_path(node_path, pb->prefixes,
-                          pb->do_exclude, pb->glob);
+  nb->do_skip = skip_path(node_path, pb->matcher, pb->do_exclude);
 
   /* If we're skipping the node, take note of path, discarding the
      rest.  */
@@ -501,7 +548,7 @@ new_node_record(void **node_baton,
 
       /* Test if this node was copied from dropped source. */
       if (copyfrom_path &&
-          skip_path(copyfrom_path, pb->prefixes, pb->do_exclude, pb->glob))
+          skip_path(copyfrom_path, pb->matcher, pb->do_exclude))
         {
           /* This node was copied from a dropped source.
              We have a problem, since we did not want to drop this node too.
@@ -674,7 +721,7 @@ adjust_mergeinfo(svn_string_t **final_val, const svn_string_t *initial_val,
       struct parse_baton_t *pb = rb->pb;
 
       /* Determine whether the merge_source is a part of the prefix. */
-      if (skip_path(merge_source, pb->prefixes, pb->do_exclude, pb->glob))
+      if (skip_path(merge_source, pb->matcher, pb->do_exclude))
         {
           if (pb->skip_missing_merge_sources)
             continue;
@@ -1056,8 +1103,8 @@ parse_baton_initialize(struct parse_baton_t **pb,
   baton->drop_all_empty_revs = opt_state->drop_all_empty_revs;
   baton->preserve_revprops = opt_state->preserve_revprops;
   baton->quiet = opt_state->quiet;
-  baton->glob = opt_state->glob;
-  baton->prefixes = opt_state->prefixes;
+  baton->matcher = create_prefix_matcher(opt_state->prefixes,
+                                         opt_state->glob, pool);
   baton->skip_missing_merge_sources = opt_state->skip_missing_merge_sources;
   baton->rev_drop_count = 0; /* used to shift revnums while filtering */
   baton->dropped_nodes = apr_hash_make(pool);
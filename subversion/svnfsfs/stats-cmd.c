@@ -129,6 +129,196 @@ print_histogram(svn_fs_fs__histogram_t *histogram,
            (int)(histogram->lines[i].count * 100 / histogram->total.count));
 }
 
+/* Print the delta chain length HISTOGRAM to the console.
+ * Use POOL for allocations.
+ */
+static void
+print_chain_length_histogram(svn_fs_fs__histogram_t *histogram,
+                             apr_pool_t *pool)
+{
+  int first = 0;
+  int last = 63;
+  int i;
+
+  /* identify non-zero range */
+  while (last > 0 && histogram->lines[last].count == 0)
+    --last;
+
+  while (first <= last && histogram->lines[first].count == 0)
+    ++first;
+
+  /* display histogram lines */
+  for (i = last; i >= first; --i)
+    printf(_("  %4s .. < %-4s deltas in %12s (%2d%%) representations\n"),
+           print_two_power(i-1, pool), print_two_power(i, pool),
+           svn__ui64toa_sep(histogram->lines[i].count, ',', pool),
+           (int)(histogram->lines[i].count * 100 / histogram->total.count));
+}
+
+/* Calculate a percentage, handling edge cases. */
+static int
+get_percentage(apr_uint64_t part,
+               apr_uint64_t total)
+{
+  /* This include total == 0. */
+  if (part >= total)
+    return 100;
+
+  /* Standard case. */
+  return (int)(part * 100.0 / total);
+}
+
+/* Print the shard count HISTOGRAM to the console.
+ * Use POOL for allocations.
+ */
+static void
+print_shard_count_histogram(svn_fs_fs__histogram_t *histogram,
+                            apr_pool_t *pool)
+{
+  int first = 0;
+  int last = 63;
+  int i;
+
+  /* identify non-zero range */
+  while (last > 0 && histogram->lines[last].count == 0)
+    --last;
+
+  while (first <= last && histogram->lines[first].count == 0)
+    ++first;
+
+  /* display histogram lines */
+  for (i = last; i >= first; --i)
+    printf(_("  %4s .. < %-4s shards for %12s (%2d%%) files\n"),
+           print_two_power(i-1, pool), print_two_power(i, pool),
+           svn__ui64toa_sep(histogram->lines[i].count, ',', pool),
+           (int)(histogram->lines[i].count * 100 / histogram->total.count));
+}
+
+/* Return the ratio of bytes read to reconstruct the file in COST and
+ * its fulltext size. */
+static double
+get_amplification(const svn_fs_fs__path_cost_t *cost)
+{
+  return cost->reconstruct_size / MAX(1.0, (double)cost->expanded_size);
+}
+
+/* Print the path cost entries in the svn_fs_fs__path_cost_t * array PATHS.
+ * Use POOL for allocations.
+ */
+static void
+print_path_costs(apr_array_header_t *paths,
+                 apr_pool_t *pool)
+{
+  int i;
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      svn_fs_fs__path_cost_t *cost
+        = APR_ARRAY_IDX(paths, i, svn_fs_fs__path_cost_t *);
+
+      printf(_("%12s bytes read (%6.1fx) %6s changes %4s deltas "
+               "%3s shards r%-8ld %s\n"),
+             svn__ui64toa_sep(cost->reconstruct_size, ',', pool),
+             get_amplification(cost),
+             svn__ui64toa_sep(cost->change_count, ',', pool),
+             svn__ui64toa_sep(cost->chain_length, ',', pool),
+             svn__ui64toa_sep(cost->shard_count, ',', pool),
+             cost->revision, cost->path);
+    }
+}
+
+/* Reading the latest text of a file should not need to read more than
+ * this many times its size ... */
+#define MAX_READ_AMPLIFICATION 4.0
+
+/* ... nor involve more than this many shards.  */
+#define MAX_SHARD_COUNT 2
+
+/* Print a recommendation for each path in the svn_fs_fs__path_cost_t *
+ * array PATHS that exceeds our limits and is not in the path cost array
+ * SKIP.  Return the number of recommendations printed.
+ * Use POOL for allocations.
+ */
+static int
+print_recommendations(apr_array_header_t *paths,
+                      apr_array_header_t *skip,
+                      apr_pool_t *pool)
+{
+  int count = 0;
+  int i, k;
+
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      svn_fs_fs__path_cost_t *cost
+        = APR_ARRAY_IDX(paths, i, svn_fs_fs__path_cost_t *);
+
+      for (k = 0; skip && k < skip->nelts; ++k)
+        if (strcmp(cost->path,
+                   APR_ARRAY_IDX(skip, k, svn_fs_fs__path_cost_t *)->path)
+            == 0)
+          break;
+      if (skip && k < skip->nelts)
+        continue;
+
+      if (   get_amplification(cost) > MAX_READ_AMPLIFICATION
+          && cost->chain_length > 1)
+        {
+          printf(_("  %s: reads %.1f times its size through %s deltas; "
+                   "re-deltify it, e.g. by dump / load with a lower "
+                   "max-linear-deltification\n"),
+                 cost->path, get_amplification(cost),
+                 svn__ui64toa_sep(cost->chain_length, ',', pool));
+          ++count;
+        }
+
+      if (cost->shard_count > MAX_SHARD_COUNT)
+        {
+          printf(_("  %s: its delta chain spans %s shards; rebalance it "
+                   "in pack so that reading it opens fewer pack files\n"),
+                 cost->path, svn__ui64toa_sep(cost->shard_count, ',', pool));
+          ++count;
+        }
+    }
+
+  return count;
+}
+
+/* Print delta chain costs and locality of the latest file contents in
+ * STATS and recommend what to do about the worst paths.
+ * Use POOL for allocations.
+ */
+static void
+print_read_costs(svn_fs_fs__stats_t *stats,
+                 apr_pool_t *pool)
+{
+  printf("\nRead costs of the latest file contents:\n");
+  printf(_("%20s bytes in %12s files\n"
+           "%20s bytes read to reconstruct them\n"
+           "%20.3f read amplification\n"
+           "%20s deltas (%2d%%) with their base in a different shard\n"),
+         svn__ui64toa_sep(stats->head_expanded_size, ',', pool),
+         svn__ui64toa_sep(stats->head_chain_length_histogram.total.count,
+                          ',', pool),
+         svn__ui64toa_sep(stats->head_reconstruct_size, ',', pool),
+         stats->head_reconstruct_size
+            / MAX(1.0, (double)stats->head_expanded_size),
+         svn__ui64toa_sep(stats->cross_shard_delta_count, ',', pool),
+         stats->delta_count
+            ? get_percentage(stats->cross_shard_delta_count,
+                             stats->delta_count)
+            : 0);
+
+  printf("\nFiles most expensive to read:\n");
+  print_path_costs(stats->costly_paths, pool);
+  printf("\nMost frequently changed files:\n");
+  print_path_costs(stats->hot_paths, pool);
+
+  printf("\nRecommendations:\n");
+  if (  print_recommendations(stats->costly_paths, NULL, pool)
+      + print_recommendations(stats->hot_paths, stats->costly_paths, pool)
+      == 0)
+    printf(_("  none\n"));
+}
+
 /* COMPARISON_FUNC for svn_sort__hash.
  * Sort extension_info_t values by total count in descending order.
  */
@@ -262,19 +452,6 @@ print_extensions_by_changes(svn_fs_fs__stats_t *stats,
     }
 }
 
-/* Calculate a percentage, handling edge cases. */
-static int
-get_percentage(apr_uint64_t part,
-               apr_uint64_t total)
-{
-  /* This include total == 0. */
-  if (part >= total)
-    return 100;
-
-  /* Standard case. */
-  return (int)(part * 100.0 / total);
-}
-
 /* Print the (up to) 16 extensions in STATS with the largest total size of
  * changed file content.  Use POOL for allocations.
  */
@@ -479,6 +656,19 @@ print_stats(svn_fs_fs__stats_t *stats,
   print_histogram(&stats->dir_prop_histogram, pool);
   printf("\nHistogram of directory property representation sizes:\n");
   print_histogram(&stats->dir_prop_rep_histogram, pool);
+  printf("\nHistogram of representation delta chain lengths:\n");
+  print_chain_length_histogram(&stats->chain_length_histogram, pool);
+  printf("\nHistogram of delta chain lengths of the latest file contents:\n");
+  print_chain_length_histogram(&stats->head_chain_length_histogram, pool);
+  printf("\nHistogram of bytes read to reconstruct the latest file "
+         "contents:\n");
+  if (stats->head_reconstruct_histogram.total.sum)
+    print_histogram(&stats->head_reconstruct_histogram, pool);
+  printf("\nHistogram of shards touched to reconstruct the latest file "
+         "contents:\n");
+  print_shard_count_histogram(&stats->head_shard_histogram, pool);
+
+  print_read_costs(stats, pool);
 
   print_histograms_by_extension(stats, pool);
 }
@@ -70,6 +70,7 @@
 
 static svn_opt_subcommand_t
   subcommand_author,
+  subcommand_batch,
   subcommand_cat,
   subcommand_changed,
   subcommand_date,
@@ -221,6 +222,34 @@ static const svn_opt_subcommand_desc3_t cmd_table[] =
    )},
    {'r', 't'} },
 
+  {"batch", subcommand_batch, {0}, {N_(
+      "usage: svnlook batch REPOS_PATH [QUERY_FILE]\n"
+      "\n"), N_(
+      "Run several queries against the same revision or transaction while\n"
+      "opening the repository only once, e.g. from a hook script.\n"
+      "\n"
+      "Each line of QUERY_FILE (standard input if omitted or '-') holds a\n"
+      "subcommand and its arguments without REPOS_PATH, for example\n"
+      "'propget svn:mime-type trunk/logo.png'.  The last argument extends\n"
+      "to the end of the line, so it may contain spaces.  'propget' and\n"
+      "'proplist' accept '--revprop' before their arguments.  Empty lines\n"
+      "and lines starting with '#' are ignored.  Options given to 'batch'\n"
+      "apply to all queries.\n"
+      "\n"
+      "The output of each query is preceded by the line\n"
+      "  svnlook-batch: begin QUERY\n"
+      "and followed by one of the lines\n"
+      "  svnlook-batch: end ok\n"
+      "  svnlook-batch: end error\n"
+      "Errors are reported on stderr.  Output that does not end with a\n"
+      "newline, e.g. of 'cat', is directly followed by the end line.\n"
+   )},
+   {'r', 't', 'v', 'N', 'l', 'x', svnlook__copy_info, svnlook__show_ids,
+    svnlook__full_paths, svnlook__xml_opt, svnlook__show_inherited_props,
+    svnlook__no_diff_deleted, svnlook__no_diff_added,
+    svnlook__diff_copy_from, svnlook__diff_cmd, svnlook__ignore_properties,
+    svnlook__properties_only, svnlook__no_newline, 'M'} },
+
   {"cat", subcommand_cat, {0}, {N_(
       "usage: svnlook cat REPOS_PATH FILE_PATH\n"
       "\n"), N_(
@@ -382,6 +411,7 @@ struct svnlook_opt_state
   svn_boolean_t show_inherited_props; /*  --show-inherited-props */
   svn_boolean_t no_newline;       /* --no-newline */
   apr_uint64_t memory_cache_size; /* --memory-cache-size */
+  struct svnlook_ctxt_t *ctxt;    /* already opened context ('batch') */
 };
 
 
@@ -2097,8 +2127,16 @@ get_ctxt_baton(svnlook_ctxt_t **baton_p,
                struct svnlook_opt_state *opt_state,
                apr_pool_t *pool)
 {
-  svnlook_ctxt_t *baton = apr_pcalloc(pool, sizeof(*baton));
+  svnlook_ctxt_t *baton;
+
+  /* All queries of a batch share the same context. */
+  if (opt_state->ctxt)
+    {
+      *baton_p = opt_state->ctxt;
+      return SVN_NO_ERROR;
+    }
 
+  baton = apr_pcalloc(pool, sizeof(*baton));
   SVN_ERR(svn_repos_open3(&(baton->repos), opt_state->repos_path, NULL,
                           pool, pool));
   baton->fs = svn_repos_fs(baton->repos);
@@ -2148,6 +2186,147 @@ subcommand_author(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Split the batch query line QUERY into the subcommand name *NAME_P and
+   up to two arguments, stored in QUERY_STATE->ARG1 and ->ARG2.  The last
+   argument extends to the end of the line.  Allocate in POOL. */
+static svn_error_t *
+parse_batch_query(const char **name_p,
+                  struct svnlook_opt_state *query_state,
+                  const char *query,
+                  apr_pool_t *pool)
+{
+  const char *args[2] = { NULL, NULL };
+  const char *p = query;
+  int i;
+
+  *name_p = apr_pstrndup(pool, p, strcspn(p, " \t"));
+  p += strlen(*name_p);
+
+  /* Allow revprop queries within the batch. */
+  p += strspn(p, " \t");
+  if (strncmp(p, "--revprop", 9) == 0 && (p[9] == ' ' || p[9] == '\t'
+                                          || p[9] == '\0'))
+    {
+      query_state->revprop = TRUE;
+      p += 9;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      p += strspn(p, " \t");
+      if (!*p)
+        break;
+
+      /* The second argument is the rest of the line.  To be able to tell
+         "propget NAME PATH" from "cat PATH WITH SPACES", only the first
+         argument of two-argument subcommands stops at whitespace. */
+      if (i == 0 && (strcmp(*name_p, "propget") == 0
+                     || strcmp(*name_p, "pget") == 0
+                     || strcmp(*name_p, "pg") == 0))
+        {
+          args[i] = apr_pstrndup(pool, p, strcspn(p, " \t"));
+          p += strlen(args[i]);
+        }
+      else
+        {
+          args[i] = apr_pstrdup(pool, p);
+          p += strlen(p);
+        }
+
+      args[i] = svn_dirent_internal_style(args[i], pool);
+    }
+
+  query_state->arg1 = args[0];
+  query_state->arg2 = args[1];
+
+  return SVN_NO_ERROR;
+}
+
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_batch(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  struct svnlook_opt_state *opt_state = baton;
+  svnlook_ctxt_t *c;
+  svn_stream_t *queries;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int failed = 0;
+  svn_boolean_t eof = FALSE;
+
+  if (opt_state->arg2 != NULL || os->ind < os->argc)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("Too many arguments given"));
+
+  if (opt_state->arg1 == NULL || strcmp(opt_state->arg1, "-") == 0)
+    SVN_ERR(svn_stream_for_stdin2(&queries, TRUE, pool));
+  else
+    SVN_ERR(svn_stream_open_readonly(&queries, opt_state->arg1, pool, pool));
+
+  SVN_ERR(get_ctxt_baton(&c, opt_state, pool));
+
+  while (!eof)
+    {
+      struct svnlook_opt_state query_state = *opt_state;
+      const svn_opt_subcommand_desc3_t *subcommand;
+      svn_stringbuf_t *line;
+      const char *query, *name;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+      if (check_cancel)
+        SVN_ERR(check_cancel(NULL));
+
+      SVN_ERR(svn_stream_readline(queries, &line, "\n", &eof, iterpool));
+      svn_stringbuf_strip_whitespace(line);
+      if (line->len == 0 || line->data[0] == '#')
+        continue;
+
+      SVN_ERR(svn_utf_cstring_to_utf8(&query, line->data, iterpool));
+      SVN_ERR(parse_batch_query(&name, &query_state, query, iterpool));
+      query_state.ctxt = c;
+
+      SVN_ERR(svn_cmdline_printf(iterpool, "svnlook-batch: begin %s\n",
+                                 query));
+
+      subcommand = svn_opt_get_canonical_subcommand3(cmd_table, name);
+      if (subcommand == NULL
+          || subcommand->cmd_func == subcommand_help
+          || subcommand->cmd_func == subcommand_batch)
+        err = svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                _("'%s' is not a valid batch query"), name);
+      else if (opt_state->txn
+               && svn_opt_subcommand_takes_option4(subcommand, 'r', NULL)
+               && !svn_opt_subcommand_takes_option4(subcommand, 't', NULL))
+        err = svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                _("'%s' cannot be used with a transaction"),
+                                subcommand->name);
+      else
+        err = subcommand->cmd_func(os, &query_state, iterpool);
+
+      /* Make sure our output precedes the error message on stderr. */
+      err = svn_error_compose_create(err, svn_cmdline_fflush(stdout));
+      if (err)
+        {
+          svn_handle_error2(err, stderr, FALSE, "svnlook: ");
+          svn_error_clear(err);
+          ++failed;
+          SVN_ERR(svn_cmdline_printf(iterpool, "svnlook-batch: end error\n"));
+        }
+      else
+        SVN_ERR(svn_cmdline_printf(iterpool, "svnlook-batch: end ok\n"));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  if (failed)
+    return svn_error_createf(SVN_ERR_ILLEGAL_TARGET, NULL,
+                             Q_("%d query failed", "%d queries failed",
+                                failed),
+                             failed);
+
+  return SVN_NO_ERROR;
+}
+
 /* This implements `svn_opt_subcommand_t'. */
 static svn_error_t *
 subcommand_cat(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -0,0 +1,239 @@
+/*
+ * admission.c : Implementation of svnserve's admission control
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+
+#include <apr_strings.h>
+#include <apr_time.h>
+
+#include "svn_error.h"
+#include "svn_hash.h"
+#include "svn_pools.h"
+#include "svn_sorts.h"
+
+#include "private/svn_mutex.h"
+
+#include "svn_private_config.h"
+#include "admission.h"
+
+/* Once there are this many clients known, forget about those without
+ * open connections. */
+#define MAX_IDLE_CLIENTS 1024
+
+struct admission_client_t
+{
+  /* the table this entry belongs to */
+  admission_t *admission;
+
+  /* client IP address; key in ADMISSION->CLIENTS */
+  const char *remote_ip;
+
+  /* number of open connections */
+  int connections;
+
+  /* token bucket for the command rate: number of commands that may be
+   * executed now and when we last updated that number */
+  double tokens;
+  apr_time_t last_update;
+
+  /* owns this structure */
+  apr_pool_t *pool;
+};
+
+struct admission_t
+{
+  /* limits, 0 if unlimited */
+  int max_connections;
+  int max_rate;
+
+  /* const char * remote IP -> admission_client_t * */
+  apr_hash_t *clients;
+
+  /* mutex used to serialize access to this structure */
+  svn_mutex__t *mutex;
+
+  /* root of all client entry pools; has its own thread-safe allocator */
+  apr_pool_t *pool;
+};
+
+/* Drop all entries in ADMISSION that don't have open connections.
+ * Requires serialization on ADMISSION->MUTEX. */
+static void
+remove_idle_clients(admission_t *admission,
+                    apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  for (hi = apr_hash_first(scratch_pool, admission->clients);
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      admission_client_t *client = apr_hash_this_val(hi);
+      if (client->connections == 0)
+        {
+          svn_hash_sets(admission->clients, client->remote_ip, NULL);
+          svn_pool_destroy(client->pool);
+        }
+    }
+}
+
+/* Implements admission__enter().
+ * Requires serialization on ADMISSION->MUTEX. */
+static svn_error_t *
+enter(admission_client_t **client,
+      admission_t *admission,
+      const char *remote_ip,
+      apr_pool_t *scratch_pool)
+{
+  admission_client_t *entry = svn_hash_gets(admission->clients, remote_ip);
+
+  *client = NULL;
+  if (!entry)
+    {
+      apr_pool_t *pool;
+
+      if (apr_hash_count(admission->clients) >= MAX_IDLE_CLIENTS)
+        remove_idle_clients(admission, scratch_pool);
+
+      pool = svn_pool_create(admission->pool);
+      entry = apr_pcalloc(pool, sizeof(*entry));
+      entry->admission = admission;
+      entry->remote_ip = apr_pstrdup(pool, remote_ip);
+      entry->tokens = admission->max_rate;
+      entry->last_update = apr_time_now();
+      entry->pool = pool;
+
+      svn_hash_sets(admission->clients, entry->remote_ip, entry);
+    }
+
+  if (admission->max_connections
+      && entry->connections >= admission->max_connections)
+    return svn_error_createf(SVN_ERR_RA_SVN_SERVER_BUSY, NULL,
+                             _("Client %s already has %d connections"),
+                             remote_ip, entry->connections);
+
+  entry->connections++;
+  *client = entry;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements admission__throttle() and returns the result in *DELAY.
+ * Requires serialization on CLIENT->ADMISSION->MUTEX. */
+static svn_error_t *
+throttle(apr_interval_time_t *delay,
+         admission_client_t *client)
+{
+  int max_rate = client->admission->max_rate;
+  apr_time_t now = apr_time_now();
+
+  /* Refill the bucket.  It holds up to one second worth of commands. */
+  client->tokens += (double)(now - client->last_update) * max_rate
+                  / APR_USEC_PER_SEC;
+  client->tokens = MIN(client->tokens, max_rate);
+  client->last_update = now;
+
+  if (client->tokens >= 1.0)
+    {
+      client->tokens -= 1.0;
+      *delay = 0;
+    }
+  else
+    {
+      *delay = (apr_interval_time_t)((1.0 - client->tokens)
+                                     * APR_USEC_PER_SEC / max_rate) + 1;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements admission__leave().
+ * Requires serialization on CLIENT->ADMISSION->MUTEX. */
+static svn_error_t *
+leave(admission_client_t *client)
+{
+  client->connections--;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+admission__create(admission_t **admission,
+                  int max_connections,
+                  int max_rate,
+                  apr_pool_t *pool)
+{
+  admission_t *result = apr_pcalloc(pool, sizeof(*result));
+
+  result->max_connections = MAX(max_connections, 0);
+  result->max_rate = MAX(max_rate, 0);
+  result->pool = apr_allocator_owner_get(svn_pool_create_allocator(TRUE));
+  result->clients = svn_hash__make(result->pool);
+  SVN_ERR(svn_mutex__init(&result->mutex, TRUE, pool));
+
+  *admission = result;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+admission__enter(admission_client_t **client,
+                 admission_t *admission,
+                 const char *remote_ip,
+                 apr_pool_t *scratch_pool)
+{
+  *client = NULL;
+  SVN_MUTEX__WITH_LOCK(admission->mutex,
+                       enter(client, admission,
+                             remote_ip ? remote_ip : "", scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+void
+admission__leave(admission_client_t *client)
+{
+  svn_error_t *err = svn_mutex__lock(client->admission->mutex);
+  if (!err)
+    err = svn_mutex__unlock(client->admission->mutex, leave(client));
+
+  svn_error_clear(err);
+}
+
+apr_interval_time_t
+admission__throttle(admission_client_t *client)
+{
+  apr_interval_time_t delay = 0;
+  svn_error_t *err;
+
+  if (client->admission->max_rate == 0)
+    return 0;
+
+  err = svn_mutex__lock(client->admission->mutex);
+  if (!err)
+    err = svn_mutex__unlock(client->admission->mutex,
+                            throttle(&delay, client));
+
+  /* Don't hold up the client just because we can't tell. */
+  svn_error_clear(err);
+
+  return delay;
+}
@@ -0,0 +1,80 @@
+/*
+ * admission.h : Public definitions for svnserve's admission control
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "server.h"
+
+
+
+/* Opaque table of per-client limits and usage.  Clients are identified
+ * by their IP address.  Access will be serialized among threads within
+ * the same process.
+ */
+typedef struct admission_t admission_t;
+
+/* In POOL, create an admission table that allows for at most
+ * MAX_CONNECTIONS concurrent connections and MAX_RATE commands per
+ * second per client and return it in *ADMISSION.  0 means "unlimited"
+ * for either value.
+ */
+svn_error_t *
+admission__create(admission_t **admission,
+                  int max_connections,
+                  int max_rate,
+                  apr_pool_t *pool);
+
+/* Register a new connection from REMOTE_IP in ADMISSION and return the
+ * client's entry in *CLIENT.  If the client already has the maximum
+ * number of connections, return SVN_ERR_RA_SVN_SERVER_BUSY and set
+ * *CLIENT to NULL.  Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+admission__enter(admission_client_t **client,
+                 admission_t *admission,
+                 const char *remote_ip,
+                 apr_pool_t *scratch_pool);
+
+/* Release the connection registered with admission__enter() for CLIENT.
+ */
+void
+admission__leave(admission_client_t *client);
+
+/* Account for a command to be executed for CLIENT.  Return 0 if it may
+ * be executed right away.  If the client exceeded its rate limit, return
+ * the time to wait before asking again, without accounting for the
+ * command.
+ */
+apr_interval_time_t
+admission__throttle(admission_client_t *client);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* ADMISSION_H */
@@ -43,6 +43,7 @@
 #include "svn_ra.h"              /* for SVN_RA_CAPABILITY_* */
 #include "svn_ra_svn.h"
 #include "svn_repos.h"
+#include "svn_diff.h"
 #include "svn_dirent_uri.h"
 #include "svn_path.h"
 #include "svn_time.h"
@@ -54,7 +55,10 @@
 #include "private/svn_log.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_ra_svn_private.h"
+#include "private/svn_repos_private.h"
+#include "private/svn_stats.h"
 #include "private/svn_fspath.h"
+#include "private/svn_subr_private.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>   /* For getpid() */
@@ -62,6 +66,7 @@
 
 #include "server.h"
 #include "logger.h"
+#include "admission.h"
 
 typedef struct commit_callback_baton_t {
   apr_pool_t *pool;
@@ -149,7 +154,40 @@ log_fail_and_flush(svn_error_t *err, server_baton_t *server,
   return svn_ra_svn__flush(conn, pool);
 }
 
-/* Log a client command. */
+/* Write the log entry of the current command in B, if any, and append
+   the costs of the command CONN is executing.  Use POOL for temporaries. */
+static svn_error_t *
+write_pending_log(server_baton_t *b,
+                  svn_ra_svn_conn_t *conn,
+                  apr_pool_t *pool)
+{
+  apr_array_header_t *changes = NULL;
+  const char *line;
+
+  if (b->pending_log == NULL)
+    return SVN_NO_ERROR;
+
+  if (b->log_stats)
+    {
+      apr_array_header_t *infos;
+
+      SVN_ERR(svn_stats__get_info(&infos, pool));
+      SVN_ERR(svn_stats__get_changes(&changes, b->log_stats, infos, pool));
+    }
+
+  line = apr_pstrcat(pool, b->pending_log, " ",
+                     svn_log__stats(apr_time_now()
+                                      - svn_ra_svn__command_start_time(conn),
+                                    changes, pool),
+                     APR_EOL_STR, SVN_VA_NULL);
+  b->pending_log = NULL;
+
+  return logger__write(b->logger, line, strlen(line));
+}
+
+/* Log a client command.  While executing a command via handle_command(),
+   the entry will be written only once the command has finished, so it
+   can include the command's costs. */
 static svn_error_t *log_command(server_baton_t *b,
                                 svn_ra_svn_conn_t *conn,
                                 apr_pool_t *pool,
@@ -170,11 +208,21 @@ static svn_error_t *log_command(server_baton_t *b,
   va_end(ap);
 
   line = apr_psprintf(pool, "%" APR_PID_T_FMT
-                      " %s %s %s %s %s" APR_EOL_STR,
+                      " %s %s %s %s %s",
                       getpid(), timestr,
                       (remote_host ? remote_host : "-"),
                       (b->client_info->user ? b->client_info->user : "-"),
                       b->repository->repos_name, log);
+
+  if (b->log_pool)
+    {
+      /* Commands that log more than once get one entry per call. */
+      SVN_ERR(write_pending_log(b, conn, pool));
+      b->pending_log = apr_pstrdup(b->log_pool, line);
+      return SVN_NO_ERROR;
+    }
+
+  line = apr_pstrcat(pool, line, APR_EOL_STR, SVN_VA_NULL);
   nbytes = strlen(line);
 
   return logger__write(b->logger, line, nbytes);
@@ -433,15 +481,12 @@ static void convert_case(char *text, svn_boolean_t to_uppercase)
     }
 }
 
-/* Set *ALLOWED to TRUE if PATH is accessible in the REQUIRED mode to
-   the user described in BATON according to the authz rules in BATON.
-   Use POOL for temporary allocations only.  If no authz rules are
-   present in BATON, grant access by default. */
-static svn_error_t *authz_check_access(svn_boolean_t *allowed,
-                                       const char *path,
-                                       svn_repos_authz_access_t required,
-                                       server_baton_t *b,
-                                       apr_pool_t *pool)
+/* Like authz_check_access() but don't log denied access. */
+static svn_error_t *authz_check_access_quiet(svn_boolean_t *allowed,
+                                             const char *path,
+                                             svn_repos_authz_access_t required,
+                                             server_baton_t *b,
+                                             apr_pool_t *pool)
 {
   repository_t *repository = b->repository;
   client_info_t *client_info = b->client_info;
@@ -483,6 +528,21 @@ static svn_error_t *authz_check_access(svn_boolean_t *allowed,
                                        repository->authz_repos_name,
                                        path, client_info->authz_user,
                                        required, allowed, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *ALLOWED to TRUE if PATH is accessible in the REQUIRED mode to
+   the user described in BATON according to the authz rules in BATON.
+   Use POOL for temporary allocations only.  If no authz rules are
+   present in BATON, grant access by default. */
+static svn_error_t *authz_check_access(svn_boolean_t *allowed,
+                                       const char *path,
+                                       svn_repos_authz_access_t required,
+                                       server_baton_t *b,
+                                       apr_pool_t *pool)
+{
+  SVN_ERR(authz_check_access_quiet(allowed, path, required, b, pool));
   if (!*allowed)
     SVN_ERR(log_authz_denied(path, required, b, pool));
 
@@ -531,6 +591,24 @@ static svn_error_t *authz_commit_cb(svn_repos_authz_access_t required,
   return authz_check_access(allowed, path, required, sb->server, pool);
 }
 
+/* Set *ALLOWED to TRUE if the REQUIRED access to PATH is granted,
+ * according to the state in BATON, without logging denials.  This is
+ * for checks that merely decide whether finer-grained checks can be
+ * skipped.  Use POOL for temporary allocations only.  ROOT is not used.
+ * Implements the svn_repos_authz_callback_t interface.
+ */
+static svn_error_t *authz_probe_cb(svn_repos_authz_access_t required,
+                                   svn_boolean_t *allowed,
+                                   svn_fs_root_t *root,
+                                   const char *path,
+                                   void *baton,
+                                   apr_pool_t *pool)
+{
+  authz_baton_t *sb = baton;
+
+  return authz_check_access_quiet(allowed, path, required, sb->server, pool);
+}
+
 /* Return the access level specified for OPTION in CFG.  If no such
  * setting exists, use DEF.  If READ_ONLY is set, unconditionally disable
  * write access.
@@ -1593,6 +1671,9 @@ get_file(svn_ra_svn_conn_t *conn,
   svn_revnum_t rev;
   svn_fs_root_t *root;
   svn_stream_t *contents;
+  apr_file_t *contents_file = NULL;
+  apr_off_t contents_offset;
+  svn_filesize_t contents_length;
   apr_hash_t *props = NULL;
   apr_array_header_t *inherited_props;
   svn_string_t write_str;
@@ -1646,7 +1727,13 @@ get_file(svn_ra_svn_conn_t *conn,
                           wants_inherited_props ? &inherited_props : NULL,
                           &ab, root, full_path,
                           pool));
+  /* Contents stored verbatim in the repository can be sent straight
+     from the revision file. */
   if (want_contents)
+    SVN_CMD_ERR(svn_fs_file_contents_range(&contents_file, &contents_offset,
+                                           &contents_length, root,
+                                           full_path, pool, pool));
+  if (want_contents && !contents_file)
     SVN_CMD_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
 
   /* Send successful command response with revision and props. */
@@ -1677,7 +1764,15 @@ get_file(svn_ra_svn_conn_t *conn,
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!))"));
 
   /* Now send the file's contents. */
-  if (want_contents)
+  if (contents_file)
+    {
+      SVN_ERR(svn_ra_svn__write_file_range(conn, pool, contents_file,
+                                           contents_offset,
+                                           contents_length));
+      SVN_ERR(svn_ra_svn__write_cstring(conn, pool, ""));
+      SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+    }
+  else if (want_contents)
     {
       err = SVN_NO_ERROR;
       while (1)
@@ -1911,11 +2006,10 @@ get_dir(svn_ra_svn_conn_t *conn,
             cdate = missing_date;
 
           /* Send the entry. */
-          SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "cwnbr(?c)(?c)", name,
-                                          svn_node_kind_to_word(entry_kind),
-                                          (apr_uint64_t) entry_size,
-                                          has_props, created_rev,
-                                          cdate, last_author));
+          SVN_ERR(svn_ra_svn__write_data_dir_entry(conn, pool, name,
+                                                   entry_kind, entry_size,
+                                                   has_props, created_rev,
+                                                   cdate, last_author));
         }
       svn_pool_destroy(subpool);
     }
@@ -2516,10 +2610,12 @@ log_cmd(svn_ra_svn_conn_t *conn,
   lb.conn = conn;
   lb.stack_depth = 0;
   lb.started = FALSE;
-  err = svn_repos_get_logs5(b->repository->repos, full_paths, start_rev,
+  err = svn_repos__get_logs(b->repository->repos, full_paths, start_rev,
                             end_rev, (int) limit,
                             strict_node, include_merged_revisions,
-                            revprops, authz_check_access_cb_func(b), &ab,
+                            revprops, authz_check_access_cb_func(b),
+                            b->repository->authzdb ? authz_probe_cb : NULL,
+                            &ab,
                             send_changed_paths ? path_change_receiver : NULL,
                             send_changed_paths ? &lb : NULL,
                             revision_receiver, &lb, pool);
@@ -2948,6 +3044,83 @@ get_file_revs(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* This implements svn_blame_run_receiver_t.  Send one run of lines to
+   the client on BATON, the connection. */
+static svn_error_t *
+blame_run_receiver(void *baton,
+                   apr_int64_t start_line,
+                   apr_int64_t line_count,
+                   svn_revnum_t revision,
+                   apr_hash_t *rev_props,
+                   apr_pool_t *pool)
+{
+  svn_ra_svn_conn_t *conn = baton;
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "nn(?r)(!",
+                                  (apr_uint64_t)start_line,
+                                  (apr_uint64_t)line_count, revision));
+  if (rev_props)
+    SVN_ERR(svn_ra_svn__write_proplist(conn, pool, rev_props));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!))"));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+blame(svn_ra_svn_conn_t *conn,
+      apr_pool_t *pool,
+      svn_ra_svn__list_t *params,
+      void *baton)
+{
+  server_baton_t *b = baton;
+  svn_error_t *err, *write_err;
+  svn_revnum_t start_rev, end_rev;
+  const char *path;
+  const char *full_path;
+  const char *canonical_path;
+  const char *ignore_space;
+  svn_boolean_t ignore_eol_style;
+  svn_diff_file_options_t *diff_options;
+  authz_baton_t ab;
+
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Parse arguments. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "c(?r)(?r)wb",
+                                  &path, &start_rev, &end_rev,
+                                  &ignore_space, &ignore_eol_style));
+  SVN_ERR(svn_relpath_canonicalize_safe(&canonical_path, NULL, path,
+                                        pool, pool));
+  path = canonical_path;
+  SVN_ERR(trivial_auth_request(conn, pool, b));
+  full_path = svn_fspath__join(b->repository->fs_path->data, path, pool);
+
+  diff_options = svn_diff_file_options_create(pool);
+  if (strcmp(ignore_space, "change") == 0)
+    diff_options->ignore_space = svn_diff_file_ignore_space_change;
+  else if (strcmp(ignore_space, "all") == 0)
+    diff_options->ignore_space = svn_diff_file_ignore_space_all;
+  diff_options->ignore_eol_style = ignore_eol_style;
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__blame(full_path, start_rev, end_rev, pool)));
+
+  err = svn_repos_blame(b->repository->repos, full_path, start_rev, end_rev,
+                        diff_options, authz_check_access_cb_func(b), &ab,
+                        blame_run_receiver, conn, NULL, NULL, pool);
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+  SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 lock(svn_ra_svn_conn_t *conn,
      apr_pool_t *pool,
@@ -3780,6 +3953,12 @@ list(svn_ra_svn_conn_t *conn,
   return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
 }
 
+static svn_error_t *
+batch_cmd(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton);
+
 static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "reparent",        reparent },
   { "get-latest-rev",  get_latest_rev },
@@ -3802,6 +3981,7 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "get-locations",   get_locations },
   { "get-location-segments",   get_location_segments },
   { "get-file-revs",   get_file_revs },
+  { "blame",           blame },
   { "lock",            lock },
   { "lock-many",       lock_many },
   { "unlock",          unlock },
@@ -3813,9 +3993,37 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "get-deleted-rev", get_deleted_rev },
   { "get-iprops",      get_inherited_props },
   { "list",            list },
+  { "batch",           batch_cmd },
+  { NULL }
+};
+
+/* The main commands that may be part of a batch, i.e. those that send a
+   single response and leave the command set unchanged. */
+static const svn_ra_svn__cmd_entry_t batch_commands[] = {
+  { "get-latest-rev",  get_latest_rev },
+  { "get-dated-rev",   get_dated_rev },
+  { "rev-proplist",    rev_proplist },
+  { "rev-prop",        rev_prop },
+  { "get-file",        get_file },
+  { "get-dir",         get_dir },
+  { "check-path",      check_path },
+  { "stat",            stat_cmd },
+  { "get-locations",   get_locations },
+  { "get-lock",        get_lock },
+  { "get-iprops",      get_inherited_props },
   { NULL }
 };
 
+static svn_error_t *
+batch_cmd(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton)
+{
+  return svn_error_trace(svn_ra_svn__handle_batch(conn, pool, params,
+                                                  batch_commands, baton));
+}
+
 /* Skip past the scheme part of a URL, including the tunnel specification
  * if present.  Return NULL if the scheme part is invalid for ra_svn. */
 static const char *skip_scheme_part(const char *url)
@@ -3873,7 +4081,8 @@ repos_path_valid(const char *path)
  * and fs_path fields of REPOSITORY.  VHOST and READ_ONLY flags are the
  * same as in the server baton.
  *
- * CONFIG_POOL shall be used to load config objects.
+ * CONFIG_POOL shall be used to load config objects and REPOS_POOL to
+ * open the repository.
  *
  * Use SCRATCH_POOL for temporary allocations.
  *
@@ -3886,6 +4095,7 @@ find_repos(const char *url,
            svn_config_t *cfg,
            repository_t *repository,
            svn_repos__config_pool_t *config_pool,
+           svn_repos__repos_pool_t *repos_pool,
            apr_hash_t *fs_config,
            svn_repos_authz_warning_func_t authz_warning_func,
            void *authz_warning_baton,
@@ -3931,8 +4141,9 @@ find_repos(const char *url,
                              "No repository found in '%s'", url);
 
   /* Open the repository and fill in b with the resulting information. */
-  SVN_ERR(svn_repos_open3(&repository->repos, repository->repos_root,
-                          fs_config, result_pool, scratch_pool));
+  SVN_ERR(svn_repos__repos_pool_get(&repository->repos, repos_pool,
+                                    repository->repos_root, fs_config,
+                                    result_pool, scratch_pool));
   SVN_ERR(svn_repos_remember_client_capabilities(repository->repos,
                                                  repository->capabilities));
   repository->fs = svn_repos_fs(repository->repos);
@@ -4202,44 +4413,18 @@ handle_authz_warning(void *baton,
   SVN_UNUSED(scratch_pool);
 }
 
-/* Construct the server baton for CONN using PARAMS and return it in *BATON.
- * It's lifetime is the same as that of CONN.  SCRATCH_POOL
- */
+/* Send the server greeting for PARAMS over CONN, listing the starttls
+ * capability if OFFER_TLS is set.  We don't support version 1 any more,
+ * so we can send an empty mechlist.  Use POOL for temporaries. */
 static svn_error_t *
-construct_server_baton(server_baton_t **baton,
-                       svn_ra_svn_conn_t *conn,
-                       serve_params_t *params,
-                       apr_pool_t *scratch_pool)
+send_greeting(svn_ra_svn_conn_t *conn,
+              serve_params_t *params,
+              svn_boolean_t offer_tls,
+              apr_pool_t *pool)
 {
-  svn_error_t *err;
-  apr_uint64_t ver;
-  const char *client_url, *ra_client_string, *client_string, *canonical_url;
-  svn_ra_svn__list_t *caplist;
-  apr_pool_t *conn_pool = svn_ra_svn__get_pool(conn);
-  server_baton_t *b = apr_pcalloc(conn_pool, sizeof(*b));
-  fs_warning_baton_t *warn_baton;
-  svn_stringbuf_t *cap_log = svn_stringbuf_create_empty(scratch_pool);
-
-  b->repository = apr_pcalloc(conn_pool, sizeof(*b->repository));
-  b->repository->username_case = params->username_case;
-  b->repository->base = params->base;
-  b->repository->pwdb = NULL;
-  b->repository->authzdb = NULL;
-  b->repository->realm = NULL;
-  b->repository->use_sasl = FALSE;
-
-  b->read_only = params->read_only;
-  b->pool = conn_pool;
-  b->vhost = params->vhost;
-
-  b->logger = params->logger;
-  b->client_info = get_client_info(conn, params, conn_pool);
-
-  /* Send greeting.  We don't support version 1 any more, so we can
-   * send an empty mechlist. */
   if (params->compression_level > 0)
-    SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+    SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool,
+                                           "nn()(wwwwwwwwwwwwwww?ww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
@@ -4253,11 +4438,19 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_COMMAND_BATCH,
+                                           SVN_RA_SVN_CAP_BLAME,
+                                           svn__zstd_supported()
+                                             ? SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED
+                                             : NULL,
+                                           offer_tls
+                                             ? SVN_RA_SVN_CAP_STARTTLS
+                                             : NULL
                                            ));
   else
-    SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+    SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool,
+                                           "nn()(wwwwwwwwwwwww?w)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4269,21 +4462,127 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_COMMAND_BATCH,
+                                           SVN_RA_SVN_CAP_BLAME,
+                                           offer_tls
+                                             ? SVN_RA_SVN_CAP_STARTTLS
+                                             : NULL
                                            ));
 
-  /* Read client response, which we assume to be in version 2 format:
-   * version, capability list, and client URL; then we do an auth
-   * request. */
-  SVN_ERR(svn_ra_svn__read_tuple(conn, scratch_pool, "nlc?c(?c)",
-                                 &ver, &caplist, &client_url,
-                                 &ra_client_string,
-                                 &client_string));
-  if (ver != 2)
+  return SVN_NO_ERROR;
+}
+
+/* Return TRUE if the capability word CAP is in CAPLIST. */
+static svn_boolean_t
+has_capability(const svn_ra_svn__list_t *caplist,
+               const char *cap)
+{
+  int i;
+
+  for (i = 0; i < caplist->nelts; i++)
+    {
+      svn_ra_svn__item_t *item = &SVN_RA_SVN__LIST_ITEM(caplist, i);
+
+      if (item->kind == SVN_RA_SVN_WORD
+          && strcmp(item->u.word.data, cap) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Read the client's response to our greeting from CONN, which we assume
+ * to be in version 2 format: version, capability list, and client URL,
+ * optionally followed by client identification strings.  Allocate the
+ * output values in POOL. */
+static svn_error_t *
+read_client_greeting(apr_uint64_t *ver,
+                     svn_ra_svn__list_t **caplist,
+                     const char **client_url,
+                     const char **ra_client_string,
+                     const char **client_string,
+                     svn_ra_svn_conn_t *conn,
+                     apr_pool_t *pool)
+{
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "nlc?c(?c)",
+                                 ver, caplist, client_url,
+                                 ra_client_string,
+                                 client_string));
+  if (*ver != 2)
     return svn_error_createf(SVN_ERR_RA_SVN_BAD_VERSION, NULL,
                              "Unsupported ra_svn protocol version"
                              " %"APR_UINT64_T_FMT
-                             " (supported versions: [2])", ver);
+                             " (supported versions: [2])", *ver);
+
+  return SVN_NO_ERROR;
+}
+
+/* Construct the server baton for CONN using PARAMS and return it in *BATON.
+ * It's lifetime is the same as that of CONN.  SCRATCH_POOL
+ */
+static svn_error_t *
+construct_server_baton(server_baton_t **baton,
+                       svn_ra_svn_conn_t *conn,
+                       serve_params_t *params,
+                       apr_pool_t *scratch_pool)
+{
+  svn_error_t *err;
+  apr_uint64_t ver;
+  const char *client_url, *ra_client_string, *client_string, *canonical_url;
+  svn_ra_svn__list_t *caplist;
+  svn_boolean_t offer_tls;
+  apr_pool_t *conn_pool = svn_ra_svn__get_pool(conn);
+  server_baton_t *b = apr_pcalloc(conn_pool, sizeof(*b));
+  fs_warning_baton_t *warn_baton;
+  svn_stringbuf_t *cap_log = svn_stringbuf_create_empty(scratch_pool);
+
+  b->repository = apr_pcalloc(conn_pool, sizeof(*b->repository));
+  b->repository->username_case = params->username_case;
+  b->repository->base = params->base;
+  b->repository->pwdb = NULL;
+  b->repository->authzdb = NULL;
+  b->repository->realm = NULL;
+  b->repository->use_sasl = FALSE;
+
+  b->read_only = params->read_only;
+  b->pool = conn_pool;
+  b->vhost = params->vhost;
+
+  b->logger = params->logger;
+  b->client_info = get_client_info(conn, params, conn_pool);
+
+  /* Send greeting.  Only offer TLS on connections that aren't secured
+   * by a tunnel agent already. */
+  offer_tls = (params->tls != NULL && !params->tunnel);
+  SVN_ERR(send_greeting(conn, params, offer_tls, scratch_pool));
+
+  /* Read client response; then we do an auth request. */
+  SVN_ERR(read_client_greeting(&ver, &caplist, &client_url,
+                               &ra_client_string, &client_string,
+                               conn, scratch_pool));
+
+  /* A client asking for TLS sends no real URL or client strings, yet.
+   * It gets greeted again once the TLS session is up. */
+  if (offer_tls && has_capability(caplist, SVN_RA_SVN_CAP_STARTTLS))
+    {
+      SVN_ERR(svn_ra_svn__tls_accept(conn, params->tls, scratch_pool));
+      SVN_ERR(send_greeting(conn, params, FALSE, scratch_pool));
+      SVN_ERR(read_client_greeting(&ver, &caplist, &client_url,
+                                   &ra_client_string, &client_string,
+                                   conn, scratch_pool));
+    }
+  else if (offer_tls && params->tls_required)
+    {
+      err = error_create_and_log(SVN_ERR_RA_SVN_TLS_FAILED, NULL,
+                                 "This server only accepts TLS connections",
+                                 b);
+      err = svn_error_compose_create(err,
+              svn_ra_svn__write_cmd_failure(conn, scratch_pool, err));
+      err = svn_error_compose_create(err,
+              svn_ra_svn__flush(conn, scratch_pool));
+      return err;
+    }
 
   SVN_ERR(svn_uri_canonicalize_safe(&canonical_url, NULL, client_url,
                                     conn_pool, scratch_pool));
@@ -4336,6 +4635,7 @@ construct_server_baton(server_baton_t **baton,
   err = handle_config_error(find_repos(client_url, params->root, b->vhost,
                                        b->read_only, params->cfg,
                                        b->repository, params->config_pool,
+                                       params->repos_pool,
                                        params->fs_config,
                                        handle_authz_warning, b,
                                        conn_pool, scratch_pool),
@@ -4432,6 +4732,67 @@ construct_server_baton(server_baton_t **baton,
   return SVN_NO_ERROR;
 }
 
+/* Return TRUE if the client of CONNECTION exceeded its command rate and
+ * the connection shall be resumed after CONNECTION->THROTTLE_DELAY.
+ * That is only an option if CAN_RESCHEDULE is set; otherwise, wait right
+ * here until the next command may be executed and return FALSE.
+ */
+static svn_boolean_t
+must_throttle(connection_t *connection,
+              svn_boolean_t can_reschedule)
+{
+  apr_interval_time_t delay;
+
+  if (!connection->client)
+    return FALSE;
+
+  delay = admission__throttle(connection->client);
+  if (delay && can_reschedule)
+    {
+      connection->throttle_delay = delay;
+      return TRUE;
+    }
+
+  while (delay)
+    {
+      apr_sleep(delay);
+      delay = admission__throttle(connection->client);
+    }
+
+  return FALSE;
+}
+
+/* Read and execute the next command from CONN using the handlers in
+   CMD_HASH, like svn_ra_svn__handle_command() does for baton B.  If the
+   command got logged, complete its log entry with the command's costs.
+   Use POOL for all allocations. */
+static svn_error_t *
+handle_command(svn_boolean_t *terminate,
+               apr_hash_t *cmd_hash,
+               server_baton_t *b,
+               svn_ra_svn_conn_t *conn,
+               apr_pool_t *pool)
+{
+  svn_error_t *err;
+
+  if (b->logger == NULL)
+    return svn_error_trace(svn_ra_svn__handle_command(terminate, cmd_hash,
+                                                      b, conn, FALSE, pool));
+
+  b->pending_log = NULL;
+  b->log_stats = NULL;
+  if (svn_stats__enabled())
+    SVN_ERR(svn_stats__get_info(&b->log_stats, pool));
+
+  b->log_pool = pool;
+  err = svn_ra_svn__handle_command(terminate, cmd_hash, b, conn, FALSE,
+                                   pool);
+  err = svn_error_compose_create(err, write_pending_log(b, conn, pool));
+  b->log_pool = NULL;
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *
 serve_interruptable(svn_boolean_t *terminate_p,
                     connection_t *connection,
@@ -4476,6 +4837,10 @@ serve_interruptable(svn_boolean_t *terminate_p,
                                   connection->params->max_request_size,
                                   connection->params->max_response_size,
                                   connection->pool);
+      if (connection->params->tune_compression)
+        svn_ra_svn__tune_compression(connection->conn,
+                                     SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                                     SVN_DELTA_COMPRESSION_LEVEL_MAX);
 
       /* Construct server baton and open the repository for the first time. */
       err = construct_server_baton(&connection->baton, connection->conn,
@@ -4495,15 +4860,14 @@ serve_interruptable(svn_boolean_t *terminate_p,
           svn_boolean_t has_command;
 
           /* If the server is busy, execute just one command and only if
-           * there is one currently waiting in our receive buffers.
+           * it has been received completely, so that handling it won't
+           * block this thread on a slow client.
            */
-          err = svn_ra_svn__has_command(&has_command, &terminate,
-                                        connection->conn, iterpool);
-          if (!err && has_command)
-            err = svn_ra_svn__handle_command(&terminate, cmd_hash,
-                                             connection->baton,
-                                             connection->conn,
-                                             FALSE, iterpool);
+          err = svn_ra_svn__has_complete_command(&has_command, &terminate,
+                                                 connection->conn, iterpool);
+          if (!err && has_command && !must_throttle(connection, TRUE))
+            err = handle_command(&terminate, cmd_hash, connection->baton,
+                                 connection->conn, iterpool);
 
           break;
         }
@@ -4514,10 +4878,11 @@ serve_interruptable(svn_boolean_t *terminate_p,
            * busy() callback test to return TRUE while there are still some
            * resources left.
            */
-          err = svn_ra_svn__handle_command(&terminate, cmd_hash,
-                                           connection->baton,
-                                           connection->conn,
-                                           FALSE, iterpool);
+          if (must_throttle(connection, is_busy != NULL))
+            break;
+
+          err = handle_command(&terminate, cmd_hash, connection->baton,
+                               connection->conn, iterpool);
         }
     }
 
@@ -4534,7 +4899,22 @@ svn_error_t *serve(svn_ra_svn_conn_t *conn,
                    apr_pool_t *pool)
 {
   server_baton_t *baton = NULL;
+  const svn_ra_svn__cmd_entry_t *command;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_hash_t *cmd_hash = apr_hash_make(pool);
+  svn_boolean_t terminate = FALSE;
 
   SVN_ERR(construct_server_baton(&baton, conn, params, pool));
-  return svn_ra_svn__handle_commands2(conn, pool, main_commands, baton, FALSE);
+
+  for (command = main_commands; command->cmdname; command++)
+    svn_hash_sets(cmd_hash, command->cmdname, command);
+
+  while (!terminate)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(handle_command(&terminate, cmd_hash, baton, conn, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
 }
@@ -38,6 +38,7 @@ extern "C" {
 
 #include "private/svn_atomic.h"
 #include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 
@@ -91,6 +92,12 @@ typedef struct server_baton_t {
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
   apr_pool_t *pool;
+
+  /* Log entry for the command currently being executed.  It gets written
+     together with the command's costs once the command has finished. */
+  const char *pending_log;
+  apr_array_header_t *log_stats; /* svn_stats snapshot or NULL */
+  apr_pool_t *log_pool;          /* NULL while no command is executing */
 } server_baton_t;
 
 typedef struct serve_params_t {
@@ -127,6 +134,9 @@ typedef struct serve_params_t {
   /* all configurations should be opened through this factory */
   svn_repos__config_pool_t *config_pool;
 
+  /* all repositories should be opened through this factory */
+  svn_repos__repos_pool_t *repos_pool;
+
   /* The FS configuration to be applied to all repositories.
      It mainly contains things like cache settings. */
   apr_hash_t *fs_config;
@@ -143,6 +153,10 @@ typedef struct serve_params_t {
      Defaults to SVN_DELTA_COMPRESSION_LEVEL_DEFAULT. */
   int compression_level;
 
+  /* If set, COMPRESSION_LEVEL is only the initial level and each
+     connection adapts it to its throughput. */
+  svn_boolean_t tune_compression;
+
   /* Item size up to which we use the zero-copy code path to transmit
      them over the network.  0 disables that code path. */
   apr_size_t zero_copy_limit;
@@ -159,11 +173,20 @@ typedef struct serve_params_t {
 
   /* Use virtual-host-based path to repo. */
   svn_boolean_t vhost;
+
+  /* If not NULL, offer TLS to the clients, using this configuration. */
+  svn_ra_svn__tls_server_t *tls;
+
+  /* Refuse clients that don't switch to TLS. */
+  svn_boolean_t tls_required;
 } serve_params_t;
 
 /* This structure contains all data that describes a client / server
    connection.  Their lifetime is separated from the thread-local
    serving pools. */
+/* Per-client admission control state, see admission.h. */
+typedef struct admission_client_t admission_client_t;
+
 typedef struct connection_t
 {
   /* socket return by accept() */
@@ -192,6 +215,13 @@ typedef struct connection_t
      released.  */
   svn_atomic_t ref_count;
 
+  /* admission control state of the client; NULL if not limited */
+  admission_client_t *client;
+
+  /* If not 0, serve_interruptable() stopped because the client exceeded
+     its command rate and should be resumed after this time. */
+  apr_interval_time_t throttle_delay;
+
 } connection_t;
 
 /* Return a client_info_t structure allocated in POOL and initialize it
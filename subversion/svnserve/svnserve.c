@@ -56,10 +56,12 @@
 #include "private/svn_cmdline_private.h"
 #include "private/svn_atomic.h"
 #include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
 #include "private/svn_subr_private.h"
 
 #if APR_HAS_THREADS
 #    include <apr_thread_pool.h>
+#    include <apr_poll.h>
 #endif
 
 #include "winservice.h"
@@ -70,6 +72,7 @@
 
 #include "server.h"
 #include "logger.h"
+#include "admission.h"
 
 /* The strategy for handling incoming connections.  Some of these may be
    unavailable due to platform limitations. */
@@ -145,6 +148,13 @@ enum run_mode {
  */
 #define THREADPOOL_THREAD_IDLE_LIMIT 1000000
 
+/* Number of connections that the event loop is expected to watch while
+ * they wait for their next command.  Connections beyond this hint are
+ * still accepted but may fall back to being polled round-robin by the
+ * worker threads.
+ */
+#define IDLE_CONNECTIONS_SIZE 1024
+
 /* Number of client to server connections that may concurrently in the
  * TCP 3-way handshake state, i.e. are in the process of being created.
  *
@@ -222,6 +232,14 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_SHARED_CACHE    277
+#define SVNSERVE_OPT_MAX_CLIENT_CONNS 278
+#define SVNSERVE_OPT_MAX_CLIENT_RATE 279
+#define SVNSERVE_OPT_MAX_QUEUE_SIZE  280
+#define SVNSERVE_OPT_TLS_CERT_FILE   281
+#define SVNSERVE_OPT_TLS_KEY_FILE    282
+#define SVNSERVE_OPT_TLS_REQUIRED    283
+#define SVNSERVE_OPT_WARM_CACHE      284
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -286,7 +304,9 @@ static const apr_getopt_option_t svnserve__options[] =
         "                             "
         "[0 .. no compression, 5 .. default, \n"
         "                             "
-        " 9 .. maximum compression]")},
+        " 9 .. maximum compression, auto .. adapt the\n"
+        "                             "
+        " level to each connection's throughput]")},
     {"memory-cache-size", 'M', 1,
      N_("size of the extra in-memory cache in MB used to\n"
         "                             "
@@ -297,6 +317,12 @@ static const apr_getopt_option_t svnserve__options[] =
         "0 switches to dynamically sized caches.\n"
         "                             "
         "[used for FSFS and FSX repositories only]")},
+    {"memory-cache-shared", SVNSERVE_OPT_SHARED_CACHE, 0,
+     N_("share the in-memory cache between all connection\n"
+        "                             "
+        "processes instead of giving each its own copy.\n"
+        "                             "
+        "[mode: daemon, used without --threads only]")},
     {"cache-txdeltas", SVNSERVE_OPT_CACHE_TXDELTAS, 1,
      N_("enable or disable caching of deltas between older\n"
         "                             "
@@ -362,6 +388,27 @@ static const apr_getopt_option_t svnserve__options[] =
         "                             "
         "Default is " APR_STRINGIFY(THREADPOOL_MAX_SIZE) "."
         ONLY_AVAILABLE_WITH_THEADS)},
+    {"max-client-connections", SVNSERVE_OPT_MAX_CLIENT_CONNS, 1,
+     N_("Maximum number of concurrent connections per\n"
+        "                             "
+        "client IP address.  Further connections get\n"
+        "                             "
+        "rejected.  Default is 0 (unlimited)."
+        ONLY_AVAILABLE_WITH_THEADS)},
+    {"max-client-rate", SVNSERVE_OPT_MAX_CLIENT_RATE, 1,
+     N_("Maximum number of commands per second per client\n"
+        "                             "
+        "IP address.  Clients sending more get delayed.\n"
+        "                             "
+        "Default is 0 (unlimited)."
+        ONLY_AVAILABLE_WITH_THEADS)},
+    {"max-queue-size", SVNSERVE_OPT_MAX_QUEUE_SIZE, 1,
+     N_("Maximum number of requests waiting for a server\n"
+        "                             "
+        "thread.  New connections get rejected while the\n"
+        "                             "
+        "queue is full.  Default is 0 (unlimited)."
+        ONLY_AVAILABLE_WITH_THEADS)},
 #endif
     {"max-request-size", SVNSERVE_OPT_MAX_REQUEST, 1,
      N_("Maximum acceptable size of a client request in MB.\n"
@@ -386,6 +433,32 @@ static const apr_getopt_option_t svnserve__options[] =
         "checking out at the wrong path level.\n"
         "                             "
         "Default is 0 (disabled).")},
+    {"tls-cert-file",    SVNSERVE_OPT_TLS_CERT_FILE, 1,
+     N_("offer TLS to clients, presenting the PEM encoded\n"
+        "                             "
+        "certificate chain in ARG\n"
+        "                             "
+        "[mode: daemon, inetd, listen-once]")},
+    {"tls-key-file",     SVNSERVE_OPT_TLS_KEY_FILE, 1,
+     N_("read the private key for the TLS certificate\n"
+        "                             "
+        "from ARG.  Default is the certificate file.")},
+    {"tls-required",     SVNSERVE_OPT_TLS_REQUIRED, 0,
+     N_("refuse clients that don't switch to TLS")},
+    {"warm-cache",       SVNSERVE_OPT_WARM_CACHE, 1,
+     N_("after startup, load the data listed in the warm-up\n"
+        "                             "
+        "profile ARG into the in-memory cache in the\n"
+        "                             "
+        "background.  ARG has one [REPOS] section per\n"
+        "                             "
+        "repository with optional 'paths' and\n"
+        "                             "
+        "'recent-revisions' settings.\n"
+        "                             "
+        "[mode: daemon, used with --threads or\n"
+        "                             "
+        "--memory-cache-shared only]")},
     {"foreground",        SVNSERVE_OPT_FOREGROUND, 0,
      N_("run in foreground (useful for debugging)\n"
         "                             "
@@ -492,6 +565,46 @@ static void sigchld_handler(int signo)
 }
 #endif
 
+#ifdef SIGHUP
+/* Set when we received a SIGHUP and have not reloaded our configuration
+   since. */
+static volatile sig_atomic_t reload_requested = FALSE;
+
+static void sighup_handler(int signo)
+{
+  reload_requested = TRUE;
+}
+#endif
+
+/* Read the configuration file CONFIG_FILENAME, if given, again and make
+ * it the configuration that PARAMS provide to new connections.  On error,
+ * PARAMS remain unchanged.  Allocate the result in POOL.
+ *
+ * Connections accepted before keep using the old configuration.  There
+ * is nothing to do for per-repository configurations as well as password
+ * and authz files; these are being looked up once per connection anyway
+ * and the config and authz pools only parse them again if their contents
+ * changed.  Likewise, the FS caches remain unaffected.
+ */
+static svn_error_t *
+reload_config(serve_params_t *params,
+              const char *config_filename,
+              apr_pool_t *pool)
+{
+  svn_config_t *cfg;
+
+  if (config_filename == NULL)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__config_pool_get(&cfg, params->config_pool,
+                                     config_filename,
+                                     TRUE, /* must_exist */
+                                     NULL, pool));
+  params->cfg = cfg;
+
+  return SVN_NO_ERROR;
+}
+
 /* Redirect stdout to stderr.  ARG is the pool.
  *
  * In tunnel or inetd mode, we don't want hook scripts corrupting the
@@ -583,7 +696,33 @@ close_connection(connection_t *connection)
 {
   /* this will automatically close USOCK */
   if (svn_atomic_dec(&connection->ref_count) == 0)
-    svn_pool_destroy(connection->pool);
+    {
+      if (connection->client)
+        admission__leave(connection->client);
+
+      svn_pool_destroy(connection->pool);
+    }
+}
+
+/* Tell the client of CONNECTION that we won't serve it because of ERR,
+ * log that and clear ERR.  Use POOL for temporary allocations.
+ */
+static void
+reject_connection(connection_t *connection,
+                  svn_error_t *err,
+                  apr_pool_t *pool)
+{
+  svn_ra_svn_conn_t *conn = svn_ra_svn_create_conn5(connection->usock,
+                                                    NULL, NULL, 0, 0, 0,
+                                                    0, 0, connection->pool);
+
+  logger__log_error(connection->params->logger, err, NULL,
+                    get_client_info(conn, connection->params, pool));
+
+  /* The client expects a greeting but will report a failure as well. */
+  svn_error_clear(svn_ra_svn__write_cmd_failure(conn, pool, err));
+  svn_error_clear(svn_ra_svn__flush(conn, pool));
+  svn_error_clear(err);
 }
 
 /* Wrapper around serve() that takes a socket instead of a connection.
@@ -614,6 +753,48 @@ static svn_root_pools__t *connection_pools;
 /* The global thread pool serving all connections. */
 static apr_thread_pool_t *threads;
 
+/* Connections waiting for their next command, watched by IDLE_THREAD.
+   NULL if the platform can't share a pollset between threads, in which
+   case idle connections get polled round-robin by THREADS. */
+static apr_pollset_t *idle_connections = NULL;
+
+/* Per-client limits for the connections served by THREADS.
+   NULL if there are none. */
+static admission_t *admission = NULL;
+
+/* Commands that are cheap to execute.  When the server is busy, they get
+   served ahead of the others. */
+static const char *cheap_commands[] = {
+  "reparent",
+  "get-latest-rev",
+  "get-dated-rev",
+  "rev-proplist",
+  "rev-prop",
+  "check-path",
+  "stat",
+  "get-lock",
+  NULL
+};
+
+/* Return the THREADS task priority for serving the next command that
+   has been received on CONNECTION.  Use POOL for allocations. */
+static int
+command_priority(connection_t *connection,
+                 apr_pool_t *pool)
+{
+  const char *command = connection->conn
+                      ? svn_ra_svn__peek_command(connection->conn, pool)
+                      : NULL;
+  int i;
+
+  if (command)
+    for (i = 0; cheap_commands[i]; i++)
+      if (strcmp(command, cheap_commands[i]) == 0)
+        return APR_THREAD_TASK_PRIORITY_HIGH;
+
+  return 0;
+}
+
 /* Very simple load determination callback for serve_interruptable:
    With less than half the threads in THREADS in use, we can afford to
    wait in the socket read() function.  Otherwise, poll them round-robin. */
@@ -624,19 +805,81 @@ is_busy(connection_t *connection)
        > apr_thread_pool_thread_max_get(threads);
 }
 
+static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data);
+
+/* Hand CONNECTION to IDLE_CONNECTIONS until more data comes in.  If that
+   fails, put it back into THREADS' task queue instead. */
+static void
+park_connection(connection_t *connection)
+{
+  apr_pollfd_t desc = { 0 };
+
+  desc.p = connection->pool;
+  desc.desc_type = APR_POLL_SOCKET;
+  desc.desc.s = connection->usock;
+  desc.reqevents = APR_POLLIN;
+  desc.client_data = connection;
+
+  if (apr_pollset_add(idle_connections, &desc) != APR_SUCCESS)
+    apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+}
+
+/* Wait for data on any of the IDLE_CONNECTIONS and schedule those
+   connections for THREADS to serve.  Runs for the lifetime of the
+   process. */
+static void * APR_THREAD_FUNC idle_thread(apr_thread_t *tid, void *data)
+{
+  while (TRUE)
+    {
+      apr_int32_t count;
+      const apr_pollfd_t *signalled;
+      apr_int32_t i;
+      apr_status_t status;
+
+      status = apr_pollset_poll(idle_connections, -1, &count, &signalled);
+      if (status)
+        {
+          if (!APR_STATUS_IS_EINTR(status))
+            apr_sleep(APR_USEC_PER_SEC / 100);
+          continue;
+        }
+
+      for (i = 0; i < count; i++)
+        {
+          apr_pollset_remove(idle_connections, &signalled[i]);
+          apr_thread_pool_push(threads, serve_thread,
+                               signalled[i].client_data, 0, NULL);
+        }
+    }
+
+  return NULL;
+}
+
 /* Serve the connection given by DATA.  Under high load, serve only
    the current command (if any) and then put the connection back into
-   THREAD's task pool. */
+   THREAD's task pool, or into IDLE_CONNECTIONS if it has to wait for
+   the client to send the next command. */
 static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
 {
   svn_boolean_t done;
+  svn_boolean_t has_command = TRUE;
   connection_t *connection = data;
+  apr_interval_time_t throttle_delay;
+  int priority = 0;
   svn_error_t *err;
 
   apr_pool_t *pool = svn_root_pools__acquire_pool(connection_pools);
 
   /* process the actual request and log errors */
   err = serve_interruptable(&done, connection, is_busy, pool);
+  throttle_delay = connection->throttle_delay;
+  connection->throttle_delay = 0;
+
+  if (!err && !done && !throttle_delay && idle_connections)
+    err = svn_ra_svn__has_complete_command(&has_command, &done,
+                                           connection->conn, pool);
+  if (!err && !done && !throttle_delay && has_command)
+    priority = command_priority(connection, pool);
   if (err)
     {
       logger__log_error(connection->params->logger, err, NULL,
@@ -650,9 +893,113 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
   /* Close or re-schedule connection. */
   if (done)
     close_connection(connection);
+  else if (throttle_delay)
+    apr_thread_pool_schedule(threads, serve_thread, connection,
+                             throttle_delay, NULL);
+  else if (!has_command)
+    park_connection(connection);
   else
-    apr_thread_pool_push(threads, serve_thread, connection, 0, NULL);
+    apr_thread_pool_push(threads, serve_thread, connection, priority, NULL);
+
+  return NULL;
+}
+
+#endif
+
+/* Pause between the steps of warming the caches to limit the I/O load. */
+#define WARM_CACHE_PAUSE (APR_USEC_PER_SEC / 100)
+
+/* Default number of latest revisions to warm per repository. */
+#define WARM_CACHE_RECENT_REVISIONS 100
 
+/* Baton for warm_repository(). */
+typedef struct warm_cache_baton_t
+{
+  svn_config_t *profile;
+  serve_params_t *params;
+} warm_cache_baton_t;
+
+/* Implements svn_config_section_enumerator2_t.  Warm the caches for the
+   repository given by the section NAME of the profile in BATON.  Log
+   errors and continue with the next repository. */
+static svn_boolean_t
+warm_repository(const char *name, void *baton, apr_pool_t *pool)
+{
+  warm_cache_baton_t *b = baton;
+  const char *repos_path, *value;
+  apr_array_header_t *paths;
+  apr_int64_t recent;
+  svn_repos_t *repos;
+  svn_error_t *err;
+
+  repos_path = svn_dirent_join(b->params->root,
+                               svn_dirent_internal_style(name, pool), pool);
+  svn_config_get(b->profile, &value, name, "paths", "/");
+  paths = svn_cstring_split(value, " \t\n,", TRUE, pool);
+
+  err = svn_config_get_int64(b->profile, &recent, name, "recent-revisions",
+                             WARM_CACHE_RECENT_REVISIONS);
+  if (!err)
+    err = svn_repos_open3(&repos, repos_path, b->params->fs_config, pool,
+                          pool);
+  if (!err)
+    err = svn_repos_warm_cache(repos, paths,
+                               recent > APR_INT32_MAX ? APR_INT32_MAX
+                                                      : (int)recent,
+                               WARM_CACHE_PAUSE, NULL, NULL, pool);
+
+  logger__log_error(b->params->logger, err, NULL, NULL);
+  svn_error_clear(err);
+
+  return TRUE;
+}
+
+/* Load the data listed in the warm-up profile PROFILE_FILENAME into the
+   caches, as configured in PARAMS.  Use POOL for temporary allocations.
+
+   Each section of the profile names a repository, relative to PARAMS->ROOT.
+   Its "paths" option lists the paths within HEAD to prefetch, separated
+   by whitespace or commas, and "recent-revisions" the number of latest
+   revisions whose revprops and root directories should be loaded. */
+static svn_error_t *
+warm_caches(const char *profile_filename,
+            serve_params_t *params,
+            apr_pool_t *pool)
+{
+  warm_cache_baton_t baton;
+
+  SVN_ERR(svn_config_read3(&baton.profile, profile_filename, TRUE, FALSE,
+                           FALSE, pool));
+  baton.params = params;
+  svn_config_enumerate_sections2(baton.profile, warm_repository, &baton,
+                                 pool);
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Arguments of warm_cache_thread(). */
+typedef struct warm_cache_thread_baton_t
+{
+  const char *profile_filename;
+  serve_params_t *params;
+} warm_cache_thread_baton_t;
+
+/* Run warm_caches() for the warm_cache_thread_baton_t given as DATA and
+   log any error. */
+static void * APR_THREAD_FUNC warm_cache_thread(apr_thread_t *tid,
+                                                void *data)
+{
+  warm_cache_thread_baton_t *baton = data;
+  apr_pool_t *pool = svn_root_pools__acquire_pool(connection_pools);
+  svn_error_t *err;
+
+  err = warm_caches(baton->profile_filename, baton->params, pool);
+  logger__log_error(baton->params->logger, err, NULL, NULL);
+  svn_error_clear(err);
+
+  svn_root_pools__release_pool(pool, connection_pools);
   return NULL;
 }
 
@@ -725,6 +1072,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_boolean_t cache_txdeltas = TRUE;
   svn_boolean_t cache_revprops = FALSE;
   svn_boolean_t use_block_read = FALSE;
+  svn_boolean_t shared_cache = FALSE;
   apr_uint16_t port = SVN_RA_SVN_PORT;
   const char *host = NULL;
   int family = APR_INET;
@@ -742,6 +1090,12 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_node_kind_t kind;
   apr_size_t min_thread_count = THREADPOOL_MIN_SIZE;
   apr_size_t max_thread_count = THREADPOOL_MAX_SIZE;
+  int max_client_connections = 0;
+  int max_client_rate = 0;
+  apr_size_t max_queue_size = 0;
+  const char *tls_cert_filename = NULL;
+  const char *tls_key_filename = NULL;
+  const char *warm_cache_filename = NULL;
 #ifdef SVN_HAVE_SASL
   SVN_ERR(cyrus_init(pool));
 #endif
@@ -764,8 +1118,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.base = NULL;
   params.cfg = NULL;
   params.compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
+  params.tune_compression = FALSE;
   params.logger = NULL;
   params.config_pool = NULL;
+  params.repos_pool = NULL;
   params.fs_config = NULL;
   params.vhost = FALSE;
   params.username_case = CASE_ASIS;
@@ -774,6 +1130,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.error_check_interval = 4096;
   params.max_request_size = MAX_REQUEST_SIZE * 0x100000;
   params.max_response_size = 0;
+  params.tls = NULL;
+  params.tls_required = FALSE;
 
   while (1)
     {
@@ -893,6 +1251,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           break;
 
         case 'c':
+          if (strcmp(arg, "auto") == 0)
+            {
+              params.tune_compression = TRUE;
+              params.compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
+              break;
+            }
+
+          params.tune_compression = FALSE;
           params.compression_level = atoi(arg);
           if (params.compression_level < SVN_DELTA_COMPRESSION_LEVEL_NONE)
             params.compression_level = SVN_DELTA_COMPRESSION_LEVEL_NONE;
@@ -925,6 +1291,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           cache_nodeprops = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
 
+        case SVNSERVE_OPT_SHARED_CACHE:
+          shared_cache = TRUE;
+          break;
+
         case SVNSERVE_OPT_BLOCK_READ:
           use_block_read = svn_tristate__from_word(arg) == svn_tristate_true;
           break;
@@ -962,6 +1332,46 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           max_thread_count = (apr_size_t)apr_strtoi64(arg, NULL, 0);
           break;
 
+        case SVNSERVE_OPT_MAX_CLIENT_CONNS:
+          max_client_connections = (int)apr_strtoi64(arg, NULL, 0);
+          break;
+
+        case SVNSERVE_OPT_MAX_CLIENT_RATE:
+          max_client_rate = (int)apr_strtoi64(arg, NULL, 0);
+          break;
+
+        case SVNSERVE_OPT_MAX_QUEUE_SIZE:
+          max_queue_size = (apr_size_t)apr_strtoi64(arg, NULL, 0);
+          break;
+
+        case SVNSERVE_OPT_TLS_CERT_FILE:
+          SVN_ERR(svn_utf_cstring_to_utf8(&tls_cert_filename, arg, pool));
+          tls_cert_filename = svn_dirent_internal_style(tls_cert_filename,
+                                                        pool);
+          SVN_ERR(svn_dirent_get_absolute(&tls_cert_filename,
+                                          tls_cert_filename, pool));
+          break;
+
+        case SVNSERVE_OPT_TLS_KEY_FILE:
+          SVN_ERR(svn_utf_cstring_to_utf8(&tls_key_filename, arg, pool));
+          tls_key_filename = svn_dirent_internal_style(tls_key_filename,
+                                                       pool);
+          SVN_ERR(svn_dirent_get_absolute(&tls_key_filename,
+                                          tls_key_filename, pool));
+          break;
+
+        case SVNSERVE_OPT_TLS_REQUIRED:
+          params.tls_required = TRUE;
+          break;
+
+        case SVNSERVE_OPT_WARM_CACHE:
+          SVN_ERR(svn_utf_cstring_to_utf8(&warm_cache_filename, arg, pool));
+          warm_cache_filename = svn_dirent_internal_style(warm_cache_filename,
+                                                          pool);
+          SVN_ERR(svn_dirent_get_absolute(&warm_cache_filename,
+                                          warm_cache_filename, pool));
+          break;
+
 #ifdef WIN32
         case SVNSERVE_OPT_SERVICE:
           if (run_mode != run_mode_service)
@@ -1053,6 +1463,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   SVN_ERR(svn_repos__config_pool_create(&params.config_pool,
                                         is_multi_threaded,
                                         pool));
+  SVN_ERR(svn_repos__repos_pool_create(&params.repos_pool,
+                                       is_multi_threaded,
+                                       pool));
 
   /* If a configuration file is specified, load it and any referenced
    * password and authorization files. */
@@ -1079,6 +1492,18 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                _("Option --tunnel-user is only valid in tunnel mode"));
     }
 
+  /* The key is often stored right next to the certificate. */
+  if (tls_cert_filename)
+    SVN_ERR(svn_ra_svn__tls_server_create(&params.tls, tls_cert_filename,
+                                          tls_key_filename
+                                            ? tls_key_filename
+                                            : tls_cert_filename,
+                                          pool));
+  else if (tls_key_filename || params.tls_required)
+    return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+             _("Options --tls-key-file and --tls-required require "
+               "--tls-cert-file"));
+
   if (run_mode == run_mode_inetd || run_mode == run_mode_tunnel)
     {
       apr_pool_t *connection_pool;
@@ -1106,6 +1531,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
                                      params.max_request_size,
                                      params.max_response_size,
                                      connection_pool);
+      if (params.tune_compression)
+        svn_ra_svn__tune_compression(conn, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                                     SVN_DELTA_COMPRESSION_LEVEL_MAX);
       err = serve(conn, &params, connection_pool);
       svn_pool_destroy(connection_pool);
 
@@ -1244,6 +1672,11 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   apr_signal(SIGCHLD, sigchld_handler);
 #endif
 
+#ifdef SIGHUP
+  /* Re-read the configuration on SIGHUP instead of terminating. */
+  apr_signal(SIGHUP, sighup_handler);
+#endif
+
 #ifdef SIGPIPE
   /* Disable SIGPIPE generation for the platforms that have it. */
   apr_signal(SIGPIPE, SIG_IGN);
@@ -1274,7 +1707,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
    * keep the per-process caches smaller than the default.
    * Also, apply the respective command line parameters, if given. */
   {
-    svn_cache_config_t settings = *svn_cache_config_get();
+    svn_cache_config2_t settings = *svn_cache_config2_get();
 
     if (params.memory_cache_size != -1)
       settings.cache_size = params.memory_cache_size;
@@ -1294,7 +1727,14 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 #endif
       }
 
-    svn_cache_config_set(&settings);
+    /* A shared cache must be allocated before forking the first
+     * connection process. */
+    settings.shared_memory = shared_cache
+                          && handling_mode == connection_mode_fork;
+
+    svn_cache_config2_set(&settings);
+    if (settings.shared_memory)
+      svn_cache_config_preallocate();
   }
 
 #if APR_HAS_THREADS
@@ -1323,6 +1763,30 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 
       /* don't queue requests unless we reached the worker thread limit */
       apr_thread_pool_threshold_set(threads, 0);
+
+      if (max_client_connections > 0 || max_client_rate > 0)
+        SVN_ERR(admission__create(&admission, max_client_connections,
+                                  max_client_rate, pool));
+
+      /* Let a single thread wait for data on idle connections instead of
+         having the workers poll them.  Not all pollset implementations
+         support being used from multiple threads; simply keep polling
+         round-robin on those. */
+      status = apr_pollset_create(&idle_connections, IDLE_CONNECTIONS_SIZE,
+                                  pool, APR_POLLSET_THREADSAFE);
+      if (status == APR_SUCCESS)
+        {
+          apr_thread_t *tid;
+          apr_threadattr_t *tattr;
+
+          status = apr_threadattr_create(&tattr, pool);
+          if (status == APR_SUCCESS)
+            status = apr_threadattr_detach_set(tattr, 1);
+          if (status == APR_SUCCESS)
+            status = apr_thread_create(&tid, tattr, idle_thread, NULL, pool);
+        }
+      if (status)
+        idle_connections = NULL;
     }
   else
     {
@@ -1330,11 +1794,67 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     }
 #endif
 
+  /* Warm the caches in the background.  That is only useful if they are
+     shared with the connection handlers. */
+  if (warm_cache_filename)
+    {
+#if APR_HAS_THREADS
+      if (handling_mode == connection_mode_thread)
+        {
+          apr_thread_t *tid;
+          apr_threadattr_t *tattr;
+          warm_cache_thread_baton_t *baton = apr_palloc(pool, sizeof(*baton));
+
+          baton->profile_filename = warm_cache_filename;
+          baton->params = &params;
+
+          status = apr_threadattr_create(&tattr, pool);
+          if (status == APR_SUCCESS)
+            status = apr_threadattr_detach_set(tattr, 1);
+          if (status == APR_SUCCESS)
+            status = apr_thread_create(&tid, tattr, warm_cache_thread, baton,
+                                       pool);
+          if (status)
+            return svn_error_wrap_apr(status,
+                                      _("Can't create cache warm-up thread"));
+        }
+#endif
+#if APR_HAS_FORK
+      if (handling_mode == connection_mode_fork && shared_cache)
+        {
+          status = apr_proc_fork(&proc, pool);
+          if (status == APR_INCHILD)
+            {
+              apr_socket_close(sock);
+
+              err = warm_caches(warm_cache_filename, &params, pool);
+              logger__log_error(params.logger, err, NULL, NULL);
+              svn_error_clear(err);
+              return SVN_NO_ERROR;
+            }
+          else if (status != APR_INPARENT)
+            return svn_error_wrap_apr(status, "apr_proc_fork");
+        }
+#endif
+    }
+
   while (1)
     {
       connection_t *connection = NULL;
       SVN_ERR(accept_connection(&connection, sock, &params, handling_mode,
                                 pool));
+
+#ifdef SIGHUP
+      /* Make sure the new connection sees the latest configuration. */
+      if (reload_requested)
+        {
+          reload_requested = FALSE;
+          err = reload_config(&params, config_filename, pool);
+          logger__log_error(params.logger, err, NULL, NULL);
+          svn_error_clear(err);
+        }
+#endif
+
       if (run_mode == run_mode_listen_once)
         {
           err = serve_socket(connection, connection->pool);
@@ -1371,6 +1891,39 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
              particularly sophisticated strategy for a threaded server, it's
              little different from forking one process per connection. */
 #if APR_HAS_THREADS
+          /* Admission control.  Don't let requests pile up and don't let
+             a single client occupy all threads. */
+          if (max_queue_size
+              && apr_thread_pool_tasks_count(threads) >= max_queue_size)
+            {
+              reject_connection(connection,
+                  svn_error_createf(SVN_ERR_RA_SVN_SERVER_BUSY, NULL,
+                                    _("Request queue is full "
+                                      "(%" APR_SIZE_T_FMT " requests "
+                                      "waiting)"),
+                                    apr_thread_pool_tasks_count(threads)),
+                  connection->pool);
+              break;
+            }
+
+          if (admission)
+            {
+              apr_sockaddr_t *sa;
+              char *remote_ip = NULL;
+
+              if (apr_socket_addr_get(&sa, APR_REMOTE, connection->usock)
+                  || apr_sockaddr_ip_get(&remote_ip, sa))
+                remote_ip = NULL;
+
+              err = admission__enter(&connection->client, admission,
+                                     remote_ip, connection->pool);
+              if (err)
+                {
+                  reject_connection(connection, err, connection->pool);
+                  break;
+                }
+            }
+
           attach_connection(connection);
 
           status = apr_thread_pool_push(threads, serve_thread, connection,
@@ -34,6 +34,7 @@
 #include "svn_subst.h"
 #include "svn_string.h"
 #include "svn_version.h"
+#include "svn_sorts.h"
 
 #include "private/svn_opt_private.h"
 #include "private/svn_ra_private.h"
@@ -74,6 +75,10 @@ enum svnsync__opt {
   svnsync_opt_steal_lock
 };
 
+/* Number of revisions whose revision properties 'svnsync copy-revprops'
+   fetches with a single request per repository. */
+#define SVNSYNC_REVPROPS_BATCH_SIZE 1000
+
 #define SVNSYNC_OPTS_DEFAULT svnsync_opt_non_interactive, \
                              svnsync_opt_force_interactive, \
                              svnsync_opt_no_auth_cache, \
@@ -696,6 +701,10 @@ log_properties_normalized(int normalized_rev_props_count,
  * Make sure the values of svn:* revision properties use only LF (\n)
  * line ending style, correcting their values as necessary. The number
  * of properties that were normalized is returned in *NORMALIZED_COUNT.
+ *
+ * If SOURCE_PROPS and TARGET_PROPS are not NULL, they map the revisions
+ * to their already known revision properties (apr_hash_t *) in the
+ * respective repository.  Only revisions missing from them are fetched.
  */
 static svn_error_t *
 copy_revprops(svn_ra_session_t *from_session,
@@ -705,22 +714,27 @@ copy_revprops(svn_ra_session_t *from_session,
               svn_boolean_t skip_unchanged,
               svn_boolean_t quiet,
               const char *source_prop_encoding,
+              apr_hash_t *source_props,
+              apr_hash_t *target_props,
               int *normalized_count,
               apr_pool_t *pool)
 {
   apr_pool_t *subpool = svn_pool_create(pool);
-  apr_hash_t *existing_props, *rev_props;
+  apr_hash_t *existing_props = NULL, *rev_props = NULL;
   int filtered_count = 0;
 
   /* Get the list of revision properties on REV of TARGET. We're only interested
      in the property names, but we'll get the values 'for free'. */
-  if (sync)
+  if (sync && target_props)
+    existing_props = apr_hash_get(target_props, &rev, sizeof(rev));
+  if (sync && !existing_props)
     SVN_ERR(svn_ra_rev_proplist(to_session, rev, &existing_props, subpool));
-  else
-    existing_props = NULL;
 
   /* Get the list of revision properties on REV of SOURCE. */
-  SVN_ERR(svn_ra_rev_proplist(from_session, rev, &rev_props, subpool));
+  if (source_props)
+    rev_props = apr_hash_get(source_props, &rev, sizeof(rev));
+  if (!rev_props)
+    SVN_ERR(svn_ra_rev_proplist(from_session, rev, &rev_props, subpool));
 
   /* If necessary, normalize encoding and line ending style and return the count
      of EOL-normalized properties in int *NORMALIZED_COUNT. */
@@ -877,7 +891,7 @@ do_initialize(svn_ra_session_t *to_session,
      consistent while allowing folks to see what the latest revision is.  */
   SVN_ERR(copy_revprops(from_session, to_session, latest, FALSE, FALSE,
                         baton->quiet, baton->source_prop_encoding,
-                        &normalized_rev_props_count, pool));
+                        NULL, NULL, &normalized_rev_props_count, pool));
 
   SVN_ERR(log_properties_normalized(normalized_rev_props_count, 0, pool));
 
@@ -1495,7 +1509,7 @@ do_synchronize(svn_ra_session_t *to_session,
             {
               SVN_ERR(copy_revprops(from_session, to_session, to_latest, TRUE,
                                     baton->skip_unchanged, baton->quiet,
-                                    baton->source_prop_encoding,
+                                    baton->source_prop_encoding, NULL, NULL,
                                     &normalized_rev_props_count, pool));
               last_merged = copying;
               last_merged_rev = svn_string_create
@@ -1621,6 +1635,52 @@ synchronize_cmd(apr_getopt_t *os, void *b, apr_pool_t *pool)
 
 /*** `svnsync copy-revprops' ***/
 
+/* Implements svn_log_entry_receiver_t.  Store a copy of the revision
+ * properties of LOG_ENTRY in the hash given as BATON, keyed by the
+ * revision number and allocated in the hash's pool.
+ */
+static svn_error_t *
+collect_revprops(void *baton,
+                 svn_log_entry_t *log_entry,
+                 apr_pool_t *pool)
+{
+  apr_hash_t *revprops = baton;
+  apr_pool_t *result_pool = apr_hash_pool_get(revprops);
+  svn_revnum_t *rev = apr_pmemdup(result_pool, &log_entry->revision,
+                                  sizeof(*rev));
+
+  apr_hash_set(revprops, rev, sizeof(*rev),
+               log_entry->revprops
+                 ? svn_prop_hash_dup(log_entry->revprops, result_pool)
+                 : apr_hash_make(result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *REVPROPS to a hash mapping the revisions from START_REV to END_REV
+ * in the repository of SESSION to their revision properties (apr_hash_t *),
+ * fetched with a single log request.  Revisions that the log did not
+ * report are not contained in *REVPROPS.  Allocate the result in POOL.
+ */
+static svn_error_t *
+fetch_revprops(apr_hash_t **revprops,
+               svn_ra_session_t *session,
+               svn_revnum_t start_rev,
+               svn_revnum_t end_rev,
+               apr_pool_t *pool)
+{
+  apr_array_header_t *paths = apr_array_make(pool, 1, sizeof(const char *));
+
+  APR_ARRAY_PUSH(paths, const char *) = "";
+  *revprops = apr_hash_make(pool);
+
+  /* A NULL list of revprops means all of them. */
+  return svn_error_trace(svn_ra_get_log2(session, paths, start_rev, end_rev,
+                                         0, FALSE, TRUE, FALSE, NULL,
+                                         collect_revprops, *revprops,
+                                         pool));
+}
+
 /* Copy revision properties to the repository associated with RA
  * session TO_SESSION, using information found in BATON.
  *
@@ -1635,6 +1695,10 @@ do_copy_revprops(svn_ra_session_t *to_session,
   svn_string_t *last_merged_rev;
   svn_revnum_t i;
   svn_revnum_t step = 1;
+  svn_revnum_t batch_end = SVN_INVALID_REVNUM;
+  apr_hash_t *source_props = NULL;
+  apr_hash_t *target_props = NULL;
+  apr_pool_t *batchpool = NULL;
   int normalized_rev_props_count = 0;
 
   SVN_ERR(open_source_session(&from_session, &last_merged_rev,
@@ -1660,19 +1724,50 @@ do_copy_revprops(svn_ra_session_t *to_session,
        _("Cannot copy revprops for a revision (%ld) that has not "
          "been synchronized yet"), baton->end_rev);
 
-  /* Now, copy all the requested revisions, in the requested order. */
+  /* Now, copy all the requested revisions, in the requested order.
+     Rather than asking both repositories for the revprops of every single
+     revision, fetch them for a batch of revisions at once.  Revisions
+     that a log request does not report, e.g. because the source URL is
+     not the repository root, are still fetched one by one. */
   step = (baton->start_rev > baton->end_rev) ? -1 : 1;
   for (i = baton->start_rev; i != baton->end_rev + step; i = i + step)
     {
       int normalized_count;
+
+      if (!batchpool || i == batch_end + step)
+        {
+          svn_revnum_t remaining = (baton->end_rev - i) * step;
+
+          if (!batchpool)
+            batchpool = svn_pool_create(pool);
+          else
+            svn_pool_clear(batchpool);
+
+          batch_end = (remaining < SVNSYNC_REVPROPS_BATCH_SIZE)
+                    ? baton->end_rev
+                    : i + step * (SVNSYNC_REVPROPS_BATCH_SIZE - 1);
+
+          SVN_ERR(check_cancel(NULL));
+          SVN_ERR(fetch_revprops(&source_props, from_session,
+                                 MIN(i, batch_end), MAX(i, batch_end),
+                                 batchpool));
+          SVN_ERR(fetch_revprops(&target_props, to_session,
+                                 MIN(i, batch_end), MAX(i, batch_end),
+                                 batchpool));
+        }
+
       SVN_ERR(check_cancel(NULL));
       SVN_ERR(copy_revprops(from_session, to_session, i, TRUE,
                             baton->skip_unchanged, baton->quiet,
-                            baton->source_prop_encoding, &normalized_count,
-                            pool));
+                            baton->source_prop_encoding,
+                            source_props, target_props, &normalized_count,
+                            batchpool));
       normalized_rev_props_count += normalized_count;
     }
 
+  if (batchpool)
+    svn_pool_destroy(batchpool);
+
   /* Notify about normalized props, if any. */
   SVN_ERR(log_properties_normalized(normalized_rev_props_count, 0, pool));
 
@@ -33,6 +33,7 @@
 #include "svn_private_config.h"
 
 #define SVNVERSION_OPT_VERSION SVN_OPT_FIRST_LONGOPT_ID
+#define SVNVERSION_OPT_QUICK   (SVN_OPT_FIRST_LONGOPT_ID + 1)
 
 
 static svn_error_t *
@@ -135,6 +136,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   svn_wc_context_t *wc_ctx;
   svn_boolean_t quiet = FALSE;
   svn_boolean_t is_version = FALSE;
+  svn_boolean_t quick = FALSE;
   const apr_getopt_option_t options[] =
     {
       {"no-newline", 'n', 0, N_("do not output the trailing newline")},
@@ -144,6 +146,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
        N_("show program version information")},
       {"quiet",         'q', 0,
        N_("no progress (only errors) to stderr")},
+      {"quick", SVNVERSION_OPT_QUICK, 0,
+       N_("treat files with changed timestamps as modified\n"
+          "                             "
+          "without comparing their contents")},
       {0,             0,  0,  0}
     };
 
@@ -192,6 +198,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
         case SVNVERSION_OPT_VERSION:
           is_version = TRUE;
           break;
+        case SVNVERSION_OPT_QUICK:
+          quick = TRUE;
+          break;
         default:
           *exit_code = EXIT_FAILURE;
           usage(pool);
@@ -224,8 +233,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   else
     trail_url = NULL;
 
-  err = svn_wc_revision_status2(&res, wc_ctx, local_abspath, trail_url,
-                                committed, NULL, NULL, pool, pool);
+  err = svn_wc_revision_status3(&res, wc_ctx, local_abspath, trail_url,
+                                committed, quick, NULL, NULL, pool, pool);
 
   if (err && (err->apr_err == SVN_ERR_WC_PATH_NOT_FOUND
               || err->apr_err == SVN_ERR_WC_NOT_WORKING_COPY))
@@ -0,0 +1,721 @@
+/* primitives-bench.c -- microbenchmarks for libsvn_subr and libsvn_delta
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* Each benchmark below runs a single kernel on fixed, generated input
+ * until a minimum amount of wall clock time has passed.  The results
+ * are written to stdout as tab-separated lines
+ *
+ *     NAME  ITERATIONS  NS-PER-OP  MB-PER-S
+ *
+ * so that runs of different builds can be compared with a script.
+ * The inputs depend on nothing but the fixed seeds used here, so the
+ * numbers of two runs are only affected by the code and the machine.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "svn_pools.h"
+#include "svn_cmdline.h"
+#include "svn_checksum.h"
+#include "svn_delta.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_mergeinfo.h"
+#include "svn_string.h"
+#include "svn_time.h"
+
+#include "private/svn_cache.h"
+#include "private/svn_packed_data.h"
+#include "private/svn_subr_private.h"
+
+#include "svn_private_config.h"
+
+
+/*** Corpora. ***/
+
+/* Size of the generated text corpus. */
+#define CORPUS_SIZE (1024 * 1024)
+
+/* The inputs shared by all benchmarks. */
+typedef struct bench_corpus_t
+{
+  /* Source-code-like text of CORPUS_SIZE bytes. */
+  svn_stringbuf_t *text;
+
+  /* TEXT with a few scattered edits, as a later version of a file. */
+  svn_stringbuf_t *edited;
+
+  /* The svndiff of EDITED against TEXT. */
+  svn_stringbuf_t *svndiff;
+
+  /* TEXT compressed with zlib and with LZ4. */
+  svn_stringbuf_t *zlib;
+  svn_stringbuf_t *lz4;
+
+  /* Mergeinfo text with many paths and ranges, and a second one that
+     overlaps it. */
+  const char *mergeinfo;
+  const char *mergeinfo_changes;
+
+  /* A packed data container as written by svn_packed__data_write(). */
+  svn_stringbuf_t *packed;
+
+  /* A membuffer cache pre-filled with the keys KEYS, containing
+     CACHE_KEY_COUNT NUL-terminated strings. */
+  svn_cache__t *cache;
+  const char **keys;
+} bench_corpus_t;
+
+/* Number of distinct keys used with the membuffer cache. */
+#define CACHE_KEY_COUNT 1000
+
+/* Number of entries in the packed data container. */
+#define PACKED_COUNT 100000
+
+/* A trivial, fixed-seed pseudo-random number generator, so that the
+   corpora are the same on every platform and in every run. */
+static apr_uint32_t
+next_random(apr_uint32_t *seed)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+/* Return CORPUS_SIZE bytes of text that looks roughly like C source,
+   built from SEED in POOL. */
+static svn_stringbuf_t *
+generate_text(apr_uint32_t seed,
+              apr_pool_t *pool)
+{
+  static const char * const words[] =
+    { "svn_error_t", "*", "apr_pool_t", "pool", "return", "if", "(",
+      ")", "{", "}", ";", "SVN_ERR", "svn_stringbuf_t", "const", "char",
+      "NULL", "for", "i", "=", "0", "<", "++", "baton", "scratch_pool",
+      "result_pool", "->", "len", "data", "svn_stream_t", "stream" };
+  svn_stringbuf_t *text = svn_stringbuf_create_ensure(CORPUS_SIZE + 80,
+                                                      pool);
+
+  while (text->len < CORPUS_SIZE)
+    {
+      int indent = next_random(&seed) % 4;
+      int count = 2 + next_random(&seed) % 10;
+
+      svn_stringbuf_appendfill(text, ' ', indent * 2);
+      while (count--)
+        {
+          svn_stringbuf_appendcstr(text,
+                                   words[next_random(&seed)
+                                         % (sizeof(words) / sizeof(*words))]);
+          svn_stringbuf_appendbyte(text, ' ');
+        }
+      svn_stringbuf_appendbyte(text, '\n');
+    }
+
+  svn_stringbuf_chop(text, text->len - CORPUS_SIZE);
+  return text;
+}
+
+/* Return a copy of TEXT with some insertions, deletions and changes
+   chosen by SEED, allocated in POOL. */
+static svn_stringbuf_t *
+edit_text(const svn_stringbuf_t *text,
+          apr_uint32_t seed,
+          apr_pool_t *pool)
+{
+  svn_stringbuf_t *edited = svn_stringbuf_dup(text, pool);
+  int i;
+
+  for (i = 0; i < 200; ++i)
+    {
+      apr_size_t pos = next_random(&seed) % (edited->len - 100);
+      switch (next_random(&seed) % 3)
+        {
+          case 0:
+            svn_stringbuf_insert(edited, pos, "/* inserted */", 14);
+            break;
+          case 1:
+            svn_stringbuf_remove(edited, pos, next_random(&seed) % 64);
+            break;
+          default:
+            edited->data[pos] = 'x';
+            break;
+        }
+    }
+
+  return edited;
+}
+
+/* Return mergeinfo text for COUNT paths with RANGES ranges each, with
+   revisions chosen by SEED, allocated in POOL. */
+static const char *
+generate_mergeinfo(int count,
+                   int ranges,
+                   apr_uint32_t seed,
+                   apr_pool_t *pool)
+{
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(pool);
+  int i, k;
+
+  for (i = 0; i < count; ++i)
+    {
+      svn_revnum_t rev = 1;
+
+      svn_stringbuf_appendcstr(buf,
+                               apr_psprintf(pool, "/branches/b%d/trunk:",
+                                            i * 3));
+      for (k = 0; k < ranges; ++k)
+        {
+          svn_revnum_t start = rev + 1 + next_random(&seed) % 10;
+          svn_revnum_t end = start + next_random(&seed) % 5;
+
+          svn_stringbuf_appendcstr(buf,
+                                   apr_psprintf(pool, "%s%ld-%ld",
+                                                k ? "," : "", start, end));
+          rev = end + 1;
+        }
+      svn_stringbuf_appendbyte(buf, '\n');
+    }
+
+  return buf->data;
+}
+
+/* Implements svn_write_fn_t.  Append DATA to the stringbuf BATON. */
+static svn_error_t *
+append_to_stringbuf(void *baton,
+                    const char *data,
+                    apr_size_t *len)
+{
+  svn_stringbuf_appendbytes(baton, data, *len);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_write_fn_t.  Discard DATA. */
+static svn_error_t *
+discard_bytes(void *baton,
+              const char *data,
+              apr_size_t *len)
+{
+  return SVN_NO_ERROR;
+}
+
+/* Write the svndiff of TARGET against SOURCE to OUT, allocating in
+   SCRATCH_POOL. */
+static svn_error_t *
+write_svndiff(svn_stream_t *out,
+              svn_stringbuf_t *source,
+              svn_stringbuf_t *target,
+              apr_pool_t *scratch_pool)
+{
+  svn_txdelta_stream_t *txstream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  svn_txdelta2(&txstream,
+               svn_stream_from_stringbuf(source, scratch_pool),
+               svn_stream_from_stringbuf(target, scratch_pool),
+               FALSE, scratch_pool);
+  svn_txdelta_to_svndiff3(&handler, &handler_baton, out, 1,
+                          SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, scratch_pool);
+
+  return svn_error_trace(svn_txdelta_send_txstream(txstream, handler,
+                                                   handler_baton,
+                                                   scratch_pool));
+}
+
+/* Implements svn_cache__serialize_func_t for NUL-terminated strings. */
+static svn_error_t *
+serialize_cstring(void **data,
+                  apr_size_t *data_len,
+                  void *in,
+                  apr_pool_t *pool)
+{
+  *data_len = strlen(in) + 1;
+  *data = apr_pmemdup(pool, in, *data_len);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__deserialize_func_t for NUL-terminated strings. */
+static svn_error_t *
+deserialize_cstring(void **out,
+                    void *data,
+                    apr_size_t data_len,
+                    apr_pool_t *pool)
+{
+  *out = data;
+  return SVN_NO_ERROR;
+}
+
+/* Fill *CORPUS in POOL. */
+static svn_error_t *
+create_corpus(bench_corpus_t *corpus,
+              apr_pool_t *pool)
+{
+  svn_stream_t *stream;
+  svn_membuffer_t *membuffer;
+  svn_packed__data_root_t *root;
+  svn_packed__int_stream_t *ints;
+  svn_packed__byte_stream_t *bytes;
+  apr_uint32_t seed = 42;
+  int i;
+
+  corpus->text = generate_text(1, pool);
+  corpus->edited = edit_text(corpus->text, 2, pool);
+
+  corpus->svndiff = svn_stringbuf_create_empty(pool);
+  stream = svn_stream_create(corpus->svndiff, pool);
+  svn_stream_set_write(stream, append_to_stringbuf);
+  SVN_ERR(write_svndiff(stream, corpus->text, corpus->edited, pool));
+
+  corpus->zlib = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn__compress_zlib(corpus->text->data, corpus->text->len,
+                             corpus->zlib,
+                             SVN_DELTA_COMPRESSION_LEVEL_DEFAULT));
+  corpus->lz4 = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn__compress_lz4(corpus->text->data, corpus->text->len,
+                            corpus->lz4));
+
+  corpus->mergeinfo = generate_mergeinfo(500, 20, 3, pool);
+  corpus->mergeinfo_changes = generate_mergeinfo(500, 20, 4, pool);
+
+  root = svn_packed__data_create_root(pool);
+  ints = svn_packed__create_int_stream(root, TRUE, FALSE);
+  bytes = svn_packed__create_bytes_stream(root);
+  for (i = 0; i < PACKED_COUNT; ++i)
+    {
+      svn_packed__add_uint(ints, i * 7 + next_random(&seed) % 5);
+      svn_packed__add_bytes(bytes, corpus->text->data + i, 8);
+    }
+  corpus->packed = svn_stringbuf_create_empty(pool);
+  SVN_ERR(svn_packed__data_write(svn_stream_from_stringbuf(corpus->packed,
+                                                           pool),
+                                 root, pool));
+
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 16 * 1024 * 1024,
+                                            0, 0, FALSE, FALSE, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(&corpus->cache, membuffer,
+                                            serialize_cstring,
+                                            deserialize_cstring,
+                                            APR_HASH_KEY_STRING, "bench:",
+                                       SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            FALSE, FALSE, pool, pool));
+  corpus->keys = apr_palloc(pool, CACHE_KEY_COUNT * sizeof(*corpus->keys));
+  for (i = 0; i < CACHE_KEY_COUNT; ++i)
+    {
+      corpus->keys[i] = apr_psprintf(pool, "/trunk/subversion/file-%d.c", i);
+      SVN_ERR(svn_cache__set(corpus->cache, corpus->keys[i],
+                             (void *)corpus->keys[i], pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/*** The benchmarks. ***/
+
+/* Run one operation of a benchmark on CORPUS.  Temporary allocations
+   go into SCRATCH_POOL, which gets cleared between operations. */
+typedef svn_error_t *(*bench_func_t)(bench_corpus_t *corpus,
+                                     apr_pool_t *scratch_pool);
+
+static svn_error_t *
+bench_xdelta(bench_corpus_t *corpus,
+             apr_pool_t *scratch_pool)
+{
+  svn_txdelta_stream_t *txstream;
+
+  svn_txdelta2(&txstream,
+               svn_stream_from_stringbuf(corpus->text, scratch_pool),
+               svn_stream_from_stringbuf(corpus->edited, scratch_pool),
+               FALSE, scratch_pool);
+
+  return svn_error_trace(
+           svn_txdelta_send_txstream(txstream, svn_delta_noop_window_handler,
+                                     NULL, scratch_pool));
+}
+
+static svn_error_t *
+bench_svndiff_encode(bench_corpus_t *corpus,
+                     apr_pool_t *scratch_pool)
+{
+  svn_stream_t *out = svn_stream_create(NULL, scratch_pool);
+  svn_stream_set_write(out, discard_bytes);
+
+  return svn_error_trace(write_svndiff(out, corpus->text, corpus->edited,
+                                       scratch_pool));
+}
+
+static svn_error_t *
+bench_svndiff_decode(bench_corpus_t *corpus,
+                     apr_pool_t *scratch_pool)
+{
+  svn_stream_t *parser;
+  apr_size_t len = corpus->svndiff->len;
+
+  parser = svn_txdelta_parse_svndiff(svn_delta_noop_window_handler, NULL,
+                                     TRUE, scratch_pool);
+  SVN_ERR(svn_stream_write(parser, corpus->svndiff->data, &len));
+
+  return svn_error_trace(svn_stream_close(parser));
+}
+
+static svn_error_t *
+bench_zlib_compress(bench_corpus_t *corpus,
+                    apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *out = svn_stringbuf_create_empty(scratch_pool);
+
+  return svn_error_trace(svn__compress_zlib(corpus->text->data,
+                                            corpus->text->len, out,
+                                        SVN_DELTA_COMPRESSION_LEVEL_DEFAULT));
+}
+
+static svn_error_t *
+bench_zlib_decompress(bench_corpus_t *corpus,
+                      apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *out = svn_stringbuf_create_empty(scratch_pool);
+
+  return svn_error_trace(svn__decompress_zlib(corpus->zlib->data,
+                                              corpus->zlib->len, out,
+                                              CORPUS_SIZE));
+}
+
+static svn_error_t *
+bench_lz4_compress(bench_corpus_t *corpus,
+                   apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *out = svn_stringbuf_create_empty(scratch_pool);
+
+  return svn_error_trace(svn__compress_lz4(corpus->text->data,
+                                           corpus->text->len, out));
+}
+
+static svn_error_t *
+bench_lz4_decompress(bench_corpus_t *corpus,
+                     apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *out = svn_stringbuf_create_empty(scratch_pool);
+
+  return svn_error_trace(svn__decompress_lz4(corpus->lz4->data,
+                                             corpus->lz4->len, out,
+                                             CORPUS_SIZE));
+}
+
+static svn_error_t *
+bench_md5(bench_corpus_t *corpus,
+          apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+
+  return svn_error_trace(svn_checksum(&checksum, svn_checksum_md5,
+                                      corpus->text->data, corpus->text->len,
+                                      scratch_pool));
+}
+
+static svn_error_t *
+bench_sha1(bench_corpus_t *corpus,
+           apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+
+  return svn_error_trace(svn_checksum(&checksum, svn_checksum_sha1,
+                                      corpus->text->data, corpus->text->len,
+                                      scratch_pool));
+}
+
+static svn_error_t *
+bench_fnv1a(bench_corpus_t *corpus,
+            apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+
+  return svn_error_trace(svn_checksum(&checksum, svn_checksum_fnv1a_32x4,
+                                      corpus->text->data, corpus->text->len,
+                                      scratch_pool));
+}
+
+static svn_error_t *
+bench_packed_write(bench_corpus_t *corpus,
+                   apr_pool_t *scratch_pool)
+{
+  svn_packed__data_root_t *root = svn_packed__data_create_root(scratch_pool);
+  svn_packed__int_stream_t *ints
+    = svn_packed__create_int_stream(root, TRUE, FALSE);
+  svn_packed__byte_stream_t *bytes = svn_packed__create_bytes_stream(root);
+  svn_stream_t *out = svn_stream_create(NULL, scratch_pool);
+  int i;
+
+  svn_stream_set_write(out, discard_bytes);
+  for (i = 0; i < PACKED_COUNT; ++i)
+    {
+      svn_packed__add_uint(ints, i * 7);
+      svn_packed__add_bytes(bytes, corpus->text->data + i, 8);
+    }
+
+  return svn_error_trace(svn_packed__data_write(out, root, scratch_pool));
+}
+
+static svn_error_t *
+bench_packed_read(bench_corpus_t *corpus,
+                  apr_pool_t *scratch_pool)
+{
+  svn_packed__data_root_t *root;
+  svn_packed__int_stream_t *ints;
+  svn_packed__byte_stream_t *bytes;
+  apr_size_t len;
+
+  SVN_ERR(svn_packed__data_read(&root,
+                                svn_stream_from_stringbuf(corpus->packed,
+                                                          scratch_pool),
+                                scratch_pool, scratch_pool));
+  ints = svn_packed__first_int_stream(root);
+  bytes = svn_packed__first_byte_stream(root);
+  while (svn_packed__int_count(ints))
+    {
+      svn_packed__get_uint(ints);
+      svn_packed__get_bytes(bytes, &len);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+bench_membuffer_get(bench_corpus_t *corpus,
+                    apr_pool_t *scratch_pool)
+{
+  void *value;
+  svn_boolean_t found;
+  int i;
+
+  for (i = 0; i < CACHE_KEY_COUNT; ++i)
+    SVN_ERR(svn_cache__get(&value, &found, corpus->cache, corpus->keys[i],
+                           scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+bench_membuffer_set(bench_corpus_t *corpus,
+                    apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < CACHE_KEY_COUNT; ++i)
+    SVN_ERR(svn_cache__set(corpus->cache, corpus->keys[i],
+                           (void *)corpus->keys[i], scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+bench_stringbuf_appendbytes(bench_corpus_t *corpus,
+                            apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(scratch_pool);
+  apr_size_t pos;
+
+  /* Short appends, as done by the XML and protocol writers. */
+  for (pos = 0; pos + 16 <= corpus->text->len; pos += 16)
+    svn_stringbuf_appendbytes(buf, corpus->text->data + pos, 16);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+bench_dirent_join(bench_corpus_t *corpus,
+                  apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < CACHE_KEY_COUNT; ++i)
+    svn_dirent_join("/home/user/wc/subversion/libsvn_subr",
+                    corpus->keys[i] + 1, scratch_pool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+bench_mergeinfo_parse(bench_corpus_t *corpus,
+                      apr_pool_t *scratch_pool)
+{
+  svn_mergeinfo_t mergeinfo;
+
+  return svn_error_trace(svn_mergeinfo_parse(&mergeinfo, corpus->mergeinfo,
+                                             scratch_pool));
+}
+
+static svn_error_t *
+bench_mergeinfo_merge(bench_corpus_t *corpus,
+                      apr_pool_t *scratch_pool)
+{
+  svn_mergeinfo_t mergeinfo, changes;
+
+  SVN_ERR(svn_mergeinfo_parse(&mergeinfo, corpus->mergeinfo, scratch_pool));
+  SVN_ERR(svn_mergeinfo_parse(&changes, corpus->mergeinfo_changes,
+                              scratch_pool));
+
+  return svn_error_trace(svn_mergeinfo_merge2(mergeinfo, changes,
+                                              scratch_pool, scratch_pool));
+}
+
+/* A benchmark and the amount of input data one of its operations
+   processes, used to compute its throughput.  A SIZE of 0 means that
+   the throughput is not meaningful. */
+typedef struct bench_desc_t
+{
+  const char *name;
+  bench_func_t func;
+  apr_size_t size;
+} bench_desc_t;
+
+static const bench_desc_t benchmarks[] =
+{
+  { "xdelta",                bench_xdelta,                CORPUS_SIZE },
+  { "svndiff-encode",        bench_svndiff_encode,        CORPUS_SIZE },
+  { "svndiff-decode",        bench_svndiff_decode,        CORPUS_SIZE },
+  { "zlib-compress",         bench_zlib_compress,         CORPUS_SIZE },
+  { "zlib-decompress",       bench_zlib_decompress,       CORPUS_SIZE },
+  { "lz4-compress",          bench_lz4_compress,          CORPUS_SIZE },
+  { "lz4-decompress",        bench_lz4_decompress,        CORPUS_SIZE },
+  { "checksum-md5",          bench_md5,                   CORPUS_SIZE },
+  { "checksum-sha1",         bench_sha1,                  CORPUS_SIZE },
+  { "checksum-fnv1a-32x4",   bench_fnv1a,                 CORPUS_SIZE },
+  { "packed-data-write",     bench_packed_write,          0 },
+  { "packed-data-read",      bench_packed_read,           0 },
+  { "membuffer-get",         bench_membuffer_get,         0 },
+  { "membuffer-set",         bench_membuffer_set,         0 },
+  { "stringbuf-appendbytes", bench_stringbuf_appendbytes, CORPUS_SIZE },
+  { "dirent-join",           bench_dirent_join,           0 },
+  { "mergeinfo-parse",       bench_mergeinfo_parse,       0 },
+  { "mergeinfo-merge",       bench_mergeinfo_merge,       0 },
+  { NULL }
+};
+
+/* Run BENCH on CORPUS repeatedly for at least MIN_TIME and print its
+   result line. */
+static svn_error_t *
+run_bench(const bench_desc_t *bench,
+          bench_corpus_t *corpus,
+          apr_time_t min_time,
+          apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_time_t start, elapsed;
+  apr_int64_t iterations = 0;
+  double seconds;
+
+  /* One untimed warm-up run, so that one-off pool growth and cache
+     misses don't show up in the result. */
+  SVN_ERR(bench->func(corpus, iterpool));
+
+  start = apr_time_now();
+  do
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(bench->func(corpus, iterpool));
+      ++iterations;
+      elapsed = apr_time_now() - start;
+    }
+  while (elapsed < min_time);
+  svn_pool_destroy(iterpool);
+
+  seconds = (double)elapsed / APR_USEC_PER_SEC;
+  if (bench->size)
+    SVN_ERR(svn_cmdline_printf(pool, "%s\t%" APR_INT64_T_FMT "\t%.0f\t%.1f\n",
+                               bench->name, iterations,
+                               seconds * 1e9 / iterations,
+                               (double)bench->size * iterations
+                                 / seconds / (1024 * 1024)));
+  else
+    SVN_ERR(svn_cmdline_printf(pool, "%s\t%" APR_INT64_T_FMT "\t%.0f\t-\n",
+                               bench->name, iterations,
+                               seconds * 1e9 / iterations));
+
+  return SVN_NO_ERROR;
+}
+
+/* Run all benchmarks whose name contains one of the PATTERNS (or all,
+   if there are none) for at least MIN_TIME each. */
+static svn_error_t *
+run_all(const char **patterns,
+        int pattern_count,
+        apr_time_t min_time,
+        apr_pool_t *pool)
+{
+  bench_corpus_t corpus;
+  const bench_desc_t *bench;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(create_corpus(&corpus, pool));
+
+  for (bench = benchmarks; bench->name; ++bench)
+    {
+      svn_boolean_t selected = (pattern_count == 0);
+      int i;
+
+      for (i = 0; i < pattern_count && !selected; ++i)
+        selected = (strstr(bench->name, patterns[i]) != NULL);
+
+      if (selected)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(run_bench(bench, &corpus, min_time, iterpool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+int main (int argc, const char *argv[])
+{
+  apr_pool_t *pool = NULL;
+  svn_error_t *err;
+  int msec = 500;
+  int first = 1;
+
+  if (svn_cmdline_init("primitives-bench", stderr) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  pool = svn_pool_create(NULL);
+
+  if (argc > 2 && strcmp(argv[1], "-t") == 0)
+    {
+      msec = atoi(argv[2]);
+      first = 3;
+    }
+
+  if (msec <= 0 || (argc > 1 && argv[1][0] == '-' && first == 1))
+    err = svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                           _("Usage: primitives-bench [-t MSEC] [NAME...]"));
+  else
+    err = run_all(argv + first, argc - first,
+                  apr_time_from_msec(msec), pool);
+
+  if (err)
+    return svn_cmdline_handle_exit_error(err, pool, "primitives-bench: ");
+
+  svn_pool_destroy(pool);
+  return EXIT_SUCCESS;
+}
@@ -3242,6 +3242,23 @@ def filtered_ls_top_level_path(sbox):
     exit_code, output, error = svntest.actions.run_and_verify_svn(
       [], [], 'ls', f_path, '--search=*/*', *extra_opts)
 
+def status_profile(sbox):
+  "svn --profile prints statistics"
+
+  sbox.build(read_only = True)
+
+  exit_code, output, errput = svntest.main.run_svn(1, 'status', '--profile',
+                                                   sbox.wc_dir)
+  if exit_code != 0:
+    raise svntest.Failure("svn status --profile failed")
+
+  # Working copy database statements get reported by name.
+  if not any(line.startswith('Profile') for line in errput):
+    raise svntest.Failure("No profile header found")
+  if not any(line.strip().startswith('sqlite.STMT_') for line in errput):
+    raise svntest.Failure("No per-statement counters found")
+
+
 
 ########################################################################
 # Run the tests
@@ -3318,6 +3335,7 @@ test_list = [ None,
               null_update_last_changed_revision,
               null_prop_update_last_changed_revision,
               filtered_ls_top_level_path,
+              status_profile,
              ]
 
 if __name__ == '__main__':
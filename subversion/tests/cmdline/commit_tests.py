@@ -25,7 +25,7 @@
 ######################################################################
 
 # General modules
-import sys, os, re
+import sys, os, re, time
 
 # Our testing module
 import svntest
@@ -3180,6 +3180,150 @@ def commit_sees_tree_conflict_on_unversioned_path(sbox):
 
   os.chdir(was_cwd)
 
+def commit_with_commit_jobs(sbox):
+  "commit computing text deltas concurrently"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  config_dir = sbox.create_config_dir("""
+[auth]
+password-stores =
+
+[miscellany]
+interactive-conflicts = false
+commit-jobs = 4
+""")
+
+  # More files than workers, so some deltas wait in the queue.
+  paths = ['A/mu', 'A/B/lambda', 'A/B/E/alpha', 'A/B/E/beta',
+           'A/D/gamma', 'A/D/G/pi', 'A/D/G/rho', 'A/D/H/omega']
+  for path in paths:
+    svntest.main.file_append(sbox.ospath(path), "More text in %s.\n" % path)
+  svntest.main.file_write(sbox.ospath('A/new'), "A new file.\n" * 1000)
+  sbox.simple_add('A/new')
+
+  expected_output = svntest.wc.State(wc_dir, {
+    'A/new' : Item(verb='Adding'),
+    })
+  expected_status = svntest.actions.get_virginal_state(wc_dir, 1)
+  for path in paths:
+    expected_output.add({ path : Item(verb='Sending') })
+    expected_status.tweak(path, wc_rev=2)
+  expected_status.add({
+    'A/new' : Item(status='  ', wc_rev=2),
+    })
+
+  svntest.actions.run_and_verify_commit(wc_dir,
+                                        expected_output,
+                                        expected_status,
+                                        [],
+                                        wc_dir,
+                                        '--config-dir', config_dir)
+
+  # The repository got the texts right, and so does the working copy's
+  # record of them.
+  for path in paths + ['A/new']:
+    expected = open(sbox.ospath(path)).readlines()
+    svntest.actions.run_and_verify_svn(expected, [],
+                                       'cat', sbox.repo_url + '/' + path)
+  svntest.actions.run_and_verify_svn([], [], 'diff', wc_dir)
+
+
+def post_commit_hook_async(sbox):
+  "post-commit hook running in the background"
+
+  sbox.build()
+  repo_dir = sbox.repo_dir
+
+  svntest.main.file_write(os.path.join(repo_dir, 'conf', 'hooks-env'),
+                          '[async-hooks]\n'
+                          'post-commit = yes\n')
+
+  # A failing hook that records the revisions it ran for.
+  log_path = os.path.abspath(os.path.join(repo_dir, 'post-commit.log'))
+  svntest.main.create_python_hook_script(
+    svntest.main.get_post_commit_hook_path(repo_dir),
+    'import sys\n'
+    'open(%r, "a").write(sys.argv[2] + "\\n")\n'
+    'sys.stderr.write("post-commit failed")\n'
+    'sys.exit(1)\n' % log_path)
+
+  # The hook's failure is not reported to the client.
+  for rev in (2, 3):
+    sbox.simple_append('iota', 'More text in r%d.\n' % rev)
+    svntest.actions.run_and_verify_svn(
+      ['Sending        %s\n' % sbox.ospath('iota'),
+       'Transmitting file data .done\n',
+       'Committing transaction...\n',
+       'Committed revision %d.\n' % rev],
+      [], 'ci', '-m', 'log msg', sbox.wc_dir)
+
+  # The hook ran for each revision and in commit order.  A long-running
+  # server may still be busy with it.
+  for i in range(100):
+    if os.path.exists(log_path) \
+       and open(log_path).read() == '2\n3\n':
+      break
+    time.sleep(0.1)
+  else:
+    raise svntest.Failure("post-commit hook did not run as expected")
+
+def pre_commit_checks(sbox):
+  "in-process pre-commit checks in hooks-env"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  svntest.main.file_write(os.path.join(sbox.repo_dir, 'conf', 'hooks-env'),
+                          '[pre-commit-checks]\n'
+                          'max-file-size = 100\n'
+                          'reject-paths = *.exe, /A/D/H/*\n'
+                          'reject-properties = svn:needs-lock\n'
+                          'require-log-message = yes\n')
+
+  def blocked(reason):
+    return svntest.verify.RegexOutput('.*' + reason, match_all=False)
+
+  sbox.simple_append('iota', 'Short change.\n')
+  svntest.actions.run_and_verify_svn(None,
+                                     blocked('A log message is required'),
+                                     'ci', '-m', ' ', wc_dir)
+
+  sbox.simple_append('A/mu', 'Long change.\n' * 10)
+  svntest.actions.run_and_verify_svn(None,
+                                     blocked("File '/A/mu' is .* bytes long"),
+                                     'ci', '-m', 'log msg', wc_dir)
+  sbox.simple_revert('A/mu')
+
+  sbox.simple_add_text('Not a program.\n', 'A/tool.exe')
+  svntest.actions.run_and_verify_svn(None,
+                                     blocked("Path '/A/tool.exe' is not"),
+                                     'ci', '-m', 'log msg', wc_dir)
+  sbox.simple_revert('A/tool.exe')
+  os.remove(sbox.ospath('A/tool.exe'))
+
+  sbox.simple_append('A/D/H/chi', 'Short change.\n')
+  svntest.actions.run_and_verify_svn(None,
+                                     blocked("Path '/A/D/H/chi' is not"),
+                                     'ci', '-m', 'log msg', wc_dir)
+  sbox.simple_revert('A/D/H/chi')
+
+  sbox.simple_propset('svn:needs-lock', '*', 'A/B/lambda')
+  svntest.actions.run_and_verify_svn(None,
+                                     blocked("Property 'svn:needs-lock'"),
+                                     'ci', '-m', 'log msg', wc_dir)
+  sbox.simple_revert('A/B/lambda')
+
+  # A commit passing all checks goes through.
+  expected_output = svntest.wc.State(wc_dir, {
+    'iota' : Item(verb='Sending'),
+    })
+  expected_status = svntest.actions.get_virginal_state(wc_dir, 1)
+  expected_status.tweak('iota', wc_rev=2)
+  svntest.actions.run_and_verify_commit(wc_dir, expected_output,
+                                        expected_status)
+
 
 ########################################################################
 # Run the tests
@@ -3260,6 +3404,9 @@ test_list = [ None,
               commit_xml,
               commit_issue4722_checksum,
               commit_sees_tree_conflict_on_unversioned_path,
+              commit_with_commit_jobs,
+              post_commit_hook_async,
+              pre_commit_checks,
              ]
 
 if __name__ == '__main__':
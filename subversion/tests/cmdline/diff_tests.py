@@ -2592,6 +2592,59 @@ def basic_diff_summarize(sbox):
   svntest.actions.run_and_verify_diff_summarize(expected_reverse_diff,
                                                 p('Q/R'), '-c-3')
 
+#----------------------------------------------------------------------
+def diff_summarize_revision_range(sbox):
+  "diff summarize over several revisions"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+  p = sbox.ospath
+
+  # r2: change some nodes and add a file that we delete again in r3.
+  svntest.main.file_append(p('A/mu'), 'new text\n')
+  svntest.main.file_append(p('A/tmp'), 'new text\n')
+  sbox.simple_add('A/tmp')
+  sbox.simple_propset('prop', 'val', 'A/B')
+  sbox.simple_commit()
+
+  # r3: change prop and text in separate revisions, delete a directory.
+  sbox.simple_rm('A/tmp', 'A/D/H')
+  sbox.simple_propset('prop', 'val', 'A/mu')
+  sbox.simple_commit()
+
+  # r4: add a directory and put a file in it in r5.
+  sbox.simple_mkdir('A/N')
+  sbox.simple_commit()
+  svntest.main.file_append(p('A/N/new'), 'new text\n')
+  sbox.simple_add('A/N/new')
+  sbox.simple_commit()
+
+  expected_diff = svntest.wc.State(wc_dir, {
+    'A/mu':           Item(status='MM'),
+    'A/B':            Item(status=' M'),
+    'A/D/H':          Item(status='D '),
+    'A/D/H/chi':      Item(status='D '),
+    'A/D/H/psi':      Item(status='D '),
+    'A/D/H/omega':    Item(status='D '),
+    'A/N':            Item(status='A '),
+    'A/N/new':        Item(status='A '),
+    })
+  svntest.actions.run_and_verify_diff_summarize(expected_diff,
+                                                wc_dir, '-r1:5')
+
+  expected_diff = svntest.wc.State(wc_dir, {
+    'A/mu':           Item(status='MM'),
+    'A/B':            Item(status=' M'),
+    'A/D/H':          Item(status='A '),
+    'A/D/H/chi':      Item(status='A '),
+    'A/D/H/psi':      Item(status='A '),
+    'A/D/H/omega':    Item(status='A '),
+    'A/N':            Item(status='D '),
+    'A/N/new':        Item(status='D '),
+    })
+  svntest.actions.run_and_verify_diff_summarize(expected_diff,
+                                                wc_dir, '-r5:1')
+
 #----------------------------------------------------------------------
 def diff_weird_author(sbox):
   "diff with svn:author that has < in it"
@@ -5373,6 +5426,7 @@ test_list = [ None,
               diff_base_repos_moved,
               diff_added_subtree,
               basic_diff_summarize,
+              diff_summarize_revision_range,
               diff_weird_author,
               diff_ignore_whitespace,
               diff_ignore_eolstyle,
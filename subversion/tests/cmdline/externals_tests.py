@@ -4446,6 +4446,52 @@ def update_dir_external_exclude(sbox):
                                         '--set-depth=infinity',
                                         sbox.ospath('A/B/E'))
 
+def checkout_with_externals_jobs(sbox):
+  "checkout and update fetching externals concurrently"
+
+  externals_test_setup(sbox)
+
+  wc_dir         = sbox.wc_dir
+  repo_url       = sbox.repo_url
+
+  config_dir = sbox.create_config_dir("""
+[auth]
+password-stores =
+
+[miscellany]
+interactive-conflicts = false
+externals-jobs = 4
+""")
+
+  svntest.actions.run_and_verify_svn(None, [],
+                                     'checkout', repo_url, wc_dir,
+                                     '--config-dir', config_dir)
+
+  # exdir_A/G and exdir_A/H lie within exdir_A, so they are fetched after
+  # it; the file external gamma is handled on the main thread.
+  expected_existing_paths = [
+    sbox.ospath('A/B/gamma'),
+    sbox.ospath('A/C/exdir_G/pi'),
+    sbox.ospath('A/C/exdir_H/omega'),
+    sbox.ospath('A/D/exdir_A/G/pi'),
+    sbox.ospath('A/D/exdir_A/H/omega'),
+    sbox.ospath('A/D/x/y/z/blah/E/alpha'),
+    ]
+  probe_paths_exist(expected_existing_paths)
+
+  for path, contents in ((sbox.ospath('A/C/exdir_H/omega'),
+                          "This is the file 'omega'.\n"),
+                         (sbox.ospath('A/B/gamma'),
+                          "This is the file 'gamma'.\n")):
+    if open(path).read() != contents:
+      raise svntest.Failure("Unexpected contents for rev 1 of " + path)
+
+  # Updating visits every external again.
+  svntest.actions.run_and_verify_svn(None, [],
+                                     'update', wc_dir,
+                                     '--config-dir', config_dir)
+  probe_paths_exist(expected_existing_paths)
+
 
 ########################################################################
 # Run the tests
@@ -4524,6 +4570,7 @@ test_list = [ None,
               external_externally_removed,
               invalid_uris_in_repo,
               update_dir_external_exclude,
+              checkout_with_externals_jobs,
              ]
 
 if __name__ == '__main__':
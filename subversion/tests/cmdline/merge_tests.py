@@ -18658,6 +18658,63 @@ def merge_deleted_folder_with_mergeinfo_2(sbox):
 
   os.chdir(was_cwd)
 
+#----------------------------------------------------------------------
+# Recording mergeinfo on many subtrees learns the history of most of them
+# from a single log and listing of the merge source, and falls back to
+# asking for the history of each remaining subtree.  Either way the result
+# must be the same as asking for every subtree's history.
+@SkipUnless(server_has_mergeinfo)
+def merge_records_mergeinfo_on_many_subtrees(sbox):
+  "merge records mergeinfo on many subtrees"
+
+  sbox.build()
+  set_up_branch(sbox)
+  sbox.simple_update()
+
+  # Give several subtrees of the branch their own mergeinfo, directories
+  # as well as files.
+  svntest.actions.run_and_verify_svn(None, [], 'merge', '-c3',
+                                     sbox.repo_url + '/A/D/H',
+                                     sbox.ospath('A_COPY/D/H'))
+  svntest.actions.run_and_verify_svn(None, [], 'merge', '-c4',
+                                     sbox.repo_url + '/A/D/G',
+                                     sbox.ospath('A_COPY/D/G'))
+  svntest.actions.run_and_verify_svn(None, [], 'merge', '-c5',
+                                     sbox.repo_url + '/A/B',
+                                     sbox.ospath('A_COPY/B'))
+  sbox.simple_propset(SVN_PROP_MERGEINFO, '/A/mu:3', 'A_COPY/mu')
+  sbox.simple_propset(SVN_PROP_MERGEINFO, '/A/D/gamma:3', 'A_COPY/D/gamma')
+  sbox.simple_commit(message='subtree merges') # r7
+
+  # Change the source below one of those subtrees, modify another one
+  # and delete a third.
+  svntest.main.file_write(sbox.ospath('A/D/H/zeta'), "This is zeta.\n")
+  sbox.simple_add('A/D/H/zeta')
+  sbox.simple_append('A/mu', "More mu.\n")
+  sbox.simple_rm('A/D/gamma')
+  sbox.simple_commit(message='source changes') # r8
+  sbox.simple_update()
+
+  # Merge a range that leaves every subtree with mergeinfo different from
+  # the one it would inherit, so nothing elides.
+  svntest.actions.run_and_verify_svn(None, [], 'merge', '-r5:8',
+                                     sbox.repo_url + '/A',
+                                     sbox.ospath('A_COPY'))
+
+  # A_COPY/D/gamma was deleted along with its mergeinfo; no other subtree
+  # gains mergeinfo.
+  check_mergeinfo_recursively(sbox.ospath('A_COPY'),
+                              { sbox.ospath('A_COPY')     : '/A:6-8',
+                                sbox.ospath('A_COPY/B')   : '/A/B:5-8',
+                                sbox.ospath('A_COPY/D/G') : '/A/D/G:4,6-8',
+                                sbox.ospath('A_COPY/D/H') : '/A/D/H:3,6-8',
+                                sbox.ospath('A_COPY/mu')  : '/A/mu:3,6-8',
+                              })
+  if os.path.exists(sbox.ospath('A_COPY/D/gamma')):
+    raise svntest.Failure("A_COPY/D/gamma was not deleted")
+  if not os.path.exists(sbox.ospath('A_COPY/D/H/zeta')):
+    raise svntest.Failure("A_COPY/D/H/zeta was not added")
+
 ########################################################################
 # Run the tests
 
@@ -18807,6 +18864,7 @@ test_list = [ None,
               merge_dir_delete_force,
               merge_deleted_folder_with_mergeinfo,
               merge_deleted_folder_with_mergeinfo_2,
+              merge_records_mergeinfo_on_many_subtrees,
              ]
 
 if __name__ == '__main__':
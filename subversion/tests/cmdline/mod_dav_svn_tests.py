@@ -687,6 +687,49 @@ def last_modified_header(sbox):
   r.read()
 
 
+@SkipUnless(svntest.main.is_ra_type_dav)
+def apply_txn_other_author(sbox):
+  "reject 'apply-txn' POST to another user's txn"
+
+  sbox.build(create_wc=False)
+
+  owner_headers = {
+    'Authorization': 'Basic ' + base64.b64encode(b'jrandom:rayjandom').decode(),
+    'Content-Type': 'application/vnd.svn-skel',
+  }
+  other_headers = {
+    'Authorization': 'Basic ' + base64.b64encode(b'jconstant:rayjandom').decode(),
+    'Content-Type': 'application/vnd.svn-skel',
+  }
+
+  h = svntest.main.create_http_connection(sbox.repo_url)
+
+  # POST /repos/!svn/me as jrandom creates a txn owned by jrandom.
+  h.request('POST', sbox.repo_url + '/!svn/me', '( create-txn )',
+            owner_headers)
+  r = h.getresponse()
+  if r.status != httplib.CREATED:
+    raise svntest.Failure('Request failed: %d %s' % (r.status, r.reason))
+  txn_name = r.getheader('SVN-Txn-Name')
+  r.read()
+
+  # jconstant must not be able to put changes into jrandom's txn.
+  other_headers['SVN-Txn-Name'] = txn_name
+  h.request('POST', sbox.repo_url + '/!svn/me',
+            '( apply-txn ( props 5:/iota 0: ( evil bad ) ( ) ) )',
+            other_headers)
+  r = h.getresponse()
+  if r.status not in (httplib.NOT_IMPLEMENTED, httplib.FORBIDDEN):
+    raise svntest.Failure('Unexpected status: %d %s' % (r.status, r.reason))
+  r.read()
+
+  # And the txn must not have been modified.
+  exit_code, output, errput = svntest.main.run_svnlook('proplist', '-t',
+                                                       txn_name,
+                                                       sbox.repo_dir, 'iota')
+  svntest.verify.verify_outputs(None, output, errput, [], [])
+
+
 ########################################################################
 # Run the tests
 
@@ -700,6 +743,7 @@ test_list = [ None,
               propfind_allprop,
               propfind_propname,
               last_modified_header,
+              apply_txn_other_author,
              ]
 serial_only = True
 
@@ -27,6 +27,7 @@
 # General modules
 import os
 import re
+import sys
 import time
 import datetime
 import logging
@@ -2301,6 +2302,118 @@ def status_missing_conflicts(sbox):
   # But not in status!
   svntest.actions.run_and_verify_status(wc_dir, expected_status)
 
+@SkipUnless(svntest.main.is_posix_os)
+def status_with_fsmonitor(sbox):
+  "status trusts the configured fsmonitor"
+
+  sbox.build(read_only = True)
+  wc_dir = sbox.wc_dir
+  iota_path = sbox.ospath('iota')
+
+  # A monitor that reports the paths in CHANGES once, and nothing after.
+  changes = os.path.abspath(os.path.join(svntest.main.temp_dir,
+                                         sbox.name + '-changes'))
+  monitor = os.path.abspath(os.path.join(svntest.main.temp_dir,
+                                         sbox.name + '-monitor'))
+  svntest.main.file_write(monitor,
+                          "#!%s\n"
+                          "import os, sys\n"
+                          "out = getattr(sys.stdout, 'buffer', sys.stdout)\n"
+                          "out.write(b'token\\0')\n"
+                          "if os.path.exists(%r):\n"
+                          "  out.write(open(%r, 'rb').read())\n"
+                          "  os.remove(%r)\n"
+                          % (sys.executable, changes, changes, changes))
+  os.chmod(monitor, svntest.main.S_ALL_RX)
+
+  config_dir = sbox.create_config_dir("""
+[auth]
+password-stores =
+
+[miscellany]
+interactive-conflicts = false
+
+[working-copy]
+fsmonitor = %s
+""" % monitor)
+
+  # Without any earlier state, everything is checked.
+  sbox.simple_append('A/mu', 'appended mu text')
+  expected_output = [ 'M       %s\n' % sbox.ospath('A/mu') ]
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'status', wc_dir,
+                                     '--config-dir', config_dir)
+
+  # A change the monitor doesn't report is not seen ...
+  sbox.simple_append('iota', 'appended iota text')
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'status', wc_dir,
+                                     '--config-dir', config_dir)
+
+  # ... until it does.  And modified files stay modified, even when the
+  # monitor has nothing new to report.
+  svntest.main.file_write(changes, 'iota\0')
+  expected_output = UnorderedOutput(
+                      [ 'M       %s\n' % sbox.ospath('A/mu'),
+                        'M       %s\n' % iota_path ])
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'status', wc_dir,
+                                     '--config-dir', config_dir)
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'status', wc_dir,
+                                     '--config-dir', config_dir)
+
+  # Reporting a directory covers all files below it.
+  sbox.simple_append('A/B/lambda', 'appended lambda text')
+  svntest.main.file_write(changes, 'A/B/\0')
+  expected_output = UnorderedOutput(
+                      [ 'M       %s\n' % sbox.ospath('A/mu'),
+                        'M       %s\n' % sbox.ospath('A/B/lambda'),
+                        'M       %s\n' % iota_path ])
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'status', wc_dir,
+                                     '--config-dir', config_dir)
+
+@SkipUnless(svntest.main.is_posix_os)
+def status_with_status_jobs(sbox):
+  "status stat()ing files concurrently"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  sbox.simple_mkdir('many')
+  for i in range(20):
+    sbox.simple_add_text('file %d\n' % i, 'many/file%d' % i)
+  sbox.simple_commit()
+
+  config_dir = sbox.create_config_dir("""
+[auth]
+password-stores =
+
+[miscellany]
+interactive-conflicts = false
+
+[working-copy]
+status-jobs = 4
+""")
+
+  sbox.simple_append('many/file3', 'appended text')
+  sbox.simple_append('many/file17', 'appended text')
+  os.remove(sbox.ospath('many/file11'))
+  os.remove(sbox.ospath('many/file12'))
+  os.symlink('file1', sbox.ospath('many/file12'))
+  svntest.main.file_write(sbox.ospath('many/unversioned'), 'new\n')
+
+  expected_output = UnorderedOutput(
+                      [ 'M       %s\n' % sbox.ospath('many/file3'),
+                        'M       %s\n' % sbox.ospath('many/file17'),
+                        '!       %s\n' % sbox.ospath('many/file11'),
+                        '~       %s\n' % sbox.ospath('many/file12'),
+                        '?       %s\n' % sbox.ospath('many/unversioned') ])
+  svntest.actions.run_and_verify_svn(expected_output, [],
+                                     'status', wc_dir,
+                                     '--config-dir', config_dir)
+
 
 
 
@@ -2355,6 +2468,8 @@ test_list = [ None,
               status_move_missing_direct,
               status_move_missing_direct_base,
               status_missing_conflicts,
+              status_with_fsmonitor,
+              status_with_status_jobs,
              ]
 
 if __name__ == '__main__':
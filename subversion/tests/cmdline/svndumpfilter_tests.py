@@ -251,6 +251,44 @@ def dumpfilter_with_patterns(sbox):
   _simple_dumpfilter_test(sbox, dumpfile,
                           'exclude', '--pattern', '/A/D/[GH]*', '/A/[B]/E*')
 
+def dumpfilter_with_many_prefixes(sbox):
+  "svndumpfilter with many prefixes"
+
+  sbox.build(empty=True)
+
+  dumpfile_location = os.path.join(os.path.dirname(sys.argv[0]),
+                                   'svndumpfilter_tests_data',
+                                   'greek_tree.dump')
+  dumpfile = svntest.actions.load_dumpfile(dumpfile_location)
+
+  # Prefixes that must not match any path because they only share part
+  # of a path component, are below a path or do not exist, mixed with
+  # prefixes of nested paths.
+  (fd, targets_file) = tempfile.mkstemp(dir=svntest.main.temp_dir)
+  try:
+    targets = open(targets_file, 'w')
+    for i in range(1000):
+      targets.write('/A/B/lambda/%d\n' % i)
+      targets.write('/A/mu%d\n' % i)
+    targets.write('/iot\n')
+    targets.write('/A/D/gamm\n')
+    targets.write('/A/D/H\n')
+    targets.write('/A/D/H/psi\n')
+    targets.write('/A/D/G/rho\n')
+    targets.write('/A/D/G\n')
+    targets.close()
+    _simple_dumpfilter_test(sbox, dumpfile,
+                            'exclude', '/A/B/E', '--targets', targets_file)
+  finally:
+    os.close(fd)
+    os.remove(targets_file)
+
+  # Literal patterns match whole paths only.
+  sbox.build(empty=True)
+  _simple_dumpfilter_test(sbox, dumpfile,
+                          'exclude', '--pattern', '/A/D/[GH]*', '/A/B/E',
+                          '/A/B/E/alpha', '/A/B/E/beta', '/A/B/E/gamma')
+
 #----------------------------------------------------------------------
 # More testing for issue #3020 'Reflect dropped/renumbered revisions in
 # svn:mergeinfo data during svnadmin load'
@@ -778,6 +816,7 @@ test_list = [ None,
               accepts_deltas,
               dumpfilter_targets_expect_leading_slash_prefixes,
               drop_all_empty_revisions,
+              dumpfilter_with_many_prefixes,
               ]
 
 if __name__ == '__main__':
@@ -718,6 +718,45 @@ def property_delete(sbox):
   svntest.actions.run_and_verify_svnlook(["_U  A/mu\n"], [],
                                          'changed', repo_dir)
 
+def batch_queries(sbox):
+  "svnlook batch"
+
+  sbox.build()
+  repo_dir = sbox.repo_dir
+
+  sbox.simple_propset('foo', 'bar baz', 'A/mu')
+  sbox.simple_commit()
+
+  query_file = sbox.get_tempname()
+  svntest.main.file_write(query_file,
+                          "# Queries for the last commit\n"
+                          "changed\n"
+                          "\n"
+                          "author\n"
+                          "propget foo A/mu\n"
+                          "no-such-query\n"
+                          "youngest\n")
+
+  # propget doesn't print a trailing newline.
+  expected_output = [
+    "svnlook-batch: begin changed\n",
+    "_U  A/mu\n",
+    "svnlook-batch: end ok\n",
+    "svnlook-batch: begin author\n",
+    "jrandom\n",
+    "svnlook-batch: end ok\n",
+    "svnlook-batch: begin propget foo A/mu\n",
+    "bar bazsvnlook-batch: end ok\n",
+    "svnlook-batch: begin no-such-query\n",
+    "svnlook-batch: end error\n",
+    "svnlook-batch: begin youngest\n",
+    "2\n",
+    "svnlook-batch: end ok\n",
+    ]
+  svntest.actions.run_and_verify_svnlook(expected_output,
+                                         svntest.verify.AnyOutput,
+                                         'batch', repo_dir, query_file)
+
 
 ########################################################################
 # Run the tests
@@ -738,6 +777,7 @@ test_list = [ None,
               test_filesize,
               test_txn_flag,
               property_delete,
+              batch_queries,
              ]
 
 if __name__ == '__main__':
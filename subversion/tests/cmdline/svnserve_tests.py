@@ -0,0 +1,255 @@
+#!/usr/bin/env python
+#
+#  svnserve_tests.py:  testing svnserve's own network features, using
+#                      server instances started by the tests themselves.
+#
+#  Subversion is a tool for revision control.
+#  See http://subversion.apache.org for more information.
+#
+# ====================================================================
+#    Licensed to the Apache Software Foundation (ASF) under one
+#    or more contributor license agreements.  See the NOTICE file
+#    distributed with this work for additional information
+#    regarding copyright ownership.  The ASF licenses this file
+#    to you under the Apache License, Version 2.0 (the
+#    "License"); you may not use this file except in compliance
+#    with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing,
+#    software distributed under the License is distributed on an
+#    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#    KIND, either express or implied.  See the License for the
+#    specific language governing permissions and limitations
+#    under the License.
+######################################################################
+
+# General modules
+import os
+import socket
+import subprocess
+import time
+
+# Our testing module
+import svntest
+
+# (abbreviation)
+Skip = svntest.testcase.Skip_deco
+SkipUnless = svntest.testcase.SkipUnless_deco
+XFail = svntest.testcase.XFail_deco
+Issues = svntest.testcase.Issues_deco
+Issue = svntest.testcase.Issue_deco
+Wimp = svntest.testcase.Wimp_deco
+
+######################################################################
+# Helpers
+
+def openssl_available():
+  "Return True iff the 'openssl' command line tool can be run."
+  try:
+    return subprocess.call(['openssl', 'version'],
+                           stdout=subprocess.PIPE,
+                           stderr=subprocess.PIPE) == 0
+  except OSError:
+    return False
+
+def run_openssl(*args):
+  "Run 'openssl' with ARGS, raising a failure if it doesn't succeed."
+  proc = subprocess.Popen(['openssl'] + list(args),
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+  stdout, stderr = proc.communicate()
+  if proc.returncode != 0:
+    raise svntest.Failure('openssl %s failed: %s' % (args[0], stderr))
+
+def make_ca(sbox, name):
+  """Create a self-signed CA called NAME for SBOX.
+     Return the paths of its certificate and key."""
+  cert = sbox.get_tempname(name + '-cert')
+  key = sbox.get_tempname(name + '-key')
+  run_openssl('req', '-x509', '-newkey', 'rsa:2048', '-nodes',
+              '-days', '2', '-subj', '/CN=' + name,
+              '-addext', 'basicConstraints=critical,CA:TRUE',
+              '-addext', 'keyUsage=critical,keyCertSign,cRLSign',
+              '-keyout', key, '-out', cert)
+  return cert, key
+
+def make_server_cert(sbox, ca, hostname):
+  """Create a server certificate for HOSTNAME, signed by the CA returned
+     by make_ca().  Return the paths of the certificate and its key."""
+  ca_cert, ca_key = ca
+  cert = sbox.get_tempname(hostname + '-cert')
+  key = sbox.get_tempname(hostname + '-key')
+  csr = sbox.get_tempname(hostname + '-csr')
+  ext = sbox.get_tempname(hostname + '-ext')
+  svntest.main.file_write(ext,
+                          'subjectAltName = DNS:%s\n'
+                          'basicConstraints = CA:FALSE\n'
+                          'extendedKeyUsage = serverAuth\n' % hostname)
+  run_openssl('req', '-newkey', 'rsa:2048', '-nodes',
+              '-subj', '/CN=' + hostname, '-keyout', key, '-out', csr)
+  run_openssl('x509', '-req', '-in', csr, '-days', '2',
+              '-CA', ca_cert, '-CAkey', ca_key, '-set_serial', '1',
+              '-extfile', ext, '-out', cert)
+  return cert, key
+
+def unused_port():
+  "Return a TCP port on 127.0.0.1 that nobody listens on right now."
+  s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+  try:
+    s.bind(('127.0.0.1', 0))
+    return s.getsockname()[1]
+  finally:
+    s.close()
+
+class Svnserve:
+  """An svnserve daemon serving SBOX's repository on 127.0.0.1, started
+     with the extra command line ARGS.  Use in a 'with' statement."""
+
+  def __init__(self, sbox, *args):
+    self.port = unused_port()
+    self.url = 'svn://localhost:%d' % self.port
+    self.argv = [svntest.main.svnserve_binary, '-d', '--foreground',
+                 '--listen-host', '127.0.0.1',
+                 '--listen-port', str(self.port),
+                 '-r', os.path.abspath(sbox.repo_dir)] + list(args)
+    self.proc = None
+
+  def __enter__(self):
+    self.proc = subprocess.Popen(self.argv, stdout=subprocess.PIPE,
+                                 stderr=subprocess.PIPE)
+
+    # Wait for the daemon to listen, or to fail at startup.
+    deadline = time.time() + 10
+    while time.time() < deadline:
+      if self.proc.poll() is not None:
+        stderr = self.proc.stderr.read().decode('utf-8', 'replace')
+        if 'without TLS support' in stderr:
+          raise svntest.Skip('svnserve was built without TLS support')
+        raise svntest.Failure('svnserve exited: %s' % stderr)
+      try:
+        socket.create_connection(('127.0.0.1', self.port), 1).close()
+        return self
+      except socket.error:
+        time.sleep(0.1)
+
+    self.__exit__(None, None, None)
+    raise svntest.Failure('svnserve did not start listening')
+
+  def __exit__(self, exc_type, exc_value, traceback):
+    if self.proc.poll() is None:
+      self.proc.terminate()
+    self.proc.communicate()
+
+def tls_config_dir(sbox, ca_cert=None, use_tls='yes'):
+  """Create a config dir for SBOX that sets svn-use-tls to USE_TLS and
+     trusts CA_CERT, if given, as its only certificate authority."""
+  servers = '[global]\nsvn-use-tls = %s\nssl-trust-default-ca = no\n' \
+            % use_tls
+  if ca_cert:
+    servers += 'ssl-authority-files = %s\n' % ca_cert
+  return sbox.create_config_dir(server_contents=servers)
+
+expected_ls = ['A/\n', 'iota\n']
+
+######################################################################
+# Tests
+#
+#   Each test must return on success or raise on failure.
+
+
+#----------------------------------------------------------------------
+
+@SkipUnless(openssl_available)
+def tls_starttls(sbox):
+  "list a repository over native TLS"
+
+  sbox.build(create_wc=False)
+
+  ca = make_ca(sbox, 'ca')
+  cert, key = make_server_cert(sbox, ca, 'localhost')
+
+  with Svnserve(sbox, '--tls-cert-file', cert,
+                '--tls-key-file', key) as server:
+    # svn-use-tls = yes fails unless the session was switched to TLS.
+    svntest.actions.run_and_verify_svn(expected_ls, [],
+                                       'ls', server.url,
+                                       '--non-interactive', '--config-dir',
+                                       tls_config_dir(sbox, ca[0]))
+
+@SkipUnless(openssl_available)
+def tls_required(sbox):
+  "--tls-required rejects plaintext clients"
+
+  sbox.build(create_wc=False)
+
+  ca = make_ca(sbox, 'ca')
+  cert, key = make_server_cert(sbox, ca, 'localhost')
+
+  with Svnserve(sbox, '--tls-cert-file', cert, '--tls-key-file', key,
+                '--tls-required') as server:
+    expected_err = svntest.verify.RegexOutput(
+                     '.*This server only accepts TLS connections',
+                     match_all=False)
+    svntest.actions.run_and_verify_svn(None, expected_err,
+                                       'ls', server.url,
+                                       '--non-interactive', '--config-dir',
+                                       tls_config_dir(sbox, ca[0], 'no'))
+
+    # Clients that switch to TLS are still served.
+    svntest.actions.run_and_verify_svn(expected_ls, [],
+                                       'ls', server.url,
+                                       '--non-interactive', '--config-dir',
+                                       tls_config_dir(sbox, ca[0], 'auto'))
+
+@SkipUnless(openssl_available)
+def tls_verify_failures(sbox):
+  "untrusted or misnamed server certificates"
+
+  sbox.build(create_wc=False)
+
+  ca = make_ca(sbox, 'ca')
+  other_ca = make_ca(sbox, 'other-ca')
+
+  # A certificate for a different host, issued by a trusted CA.
+  cert, key = make_server_cert(sbox, ca, 'svn.example.com')
+  with Svnserve(sbox, '--tls-cert-file', cert,
+                '--tls-key-file', key) as server:
+    expected_err = svntest.verify.RegexOutput(
+                     '.*certificate issued for a different hostname',
+                     match_all=False)
+    svntest.actions.run_and_verify_svn(None, expected_err,
+                                       'ls', server.url,
+                                       '--non-interactive', '--config-dir',
+                                       tls_config_dir(sbox, ca[0]))
+
+  # A certificate for the right host, issued by an untrusted CA.
+  cert, key = make_server_cert(sbox, other_ca, 'localhost')
+  with Svnserve(sbox, '--tls-cert-file', cert,
+                '--tls-key-file', key) as server:
+    expected_err = svntest.verify.RegexOutput(
+                     '.*issuer is not trusted',
+                     match_all=False)
+    svntest.actions.run_and_verify_svn(None, expected_err,
+                                       'ls', server.url,
+                                       '--non-interactive', '--config-dir',
+                                       tls_config_dir(sbox, ca[0]))
+
+
+########################################################################
+# Run the tests
+
+
+# list all tests here, starting with None:
+test_list = [ None,
+              tls_starttls,
+              tls_required,
+              tls_verify_failures,
+             ]
+
+if __name__ == '__main__':
+  svntest.main.run_tests(test_list)
+  # NOTREACHED
+
+
+### End of file.
@@ -336,6 +336,51 @@ def copy_revprops(sbox):
   "test copying revprops other than svn:*"
   run_test(sbox, "revprops.dump")
 
+def copy_revprops_range(sbox):
+  "copy-revprops for a range of revisions"
+
+  sbox.build(create_wc=False)
+  svntest.actions.enable_revprop_changes(sbox.repo_dir)
+  for i in range(2, 6):
+    svntest.actions.run_and_verify_svnmucc(None, [],
+                                           '-U', sbox.repo_url,
+                                           '-m', 'log %d' % i,
+                                           'mkdir', 'dir%d' % i)
+
+  dest_sbox = sbox.clone_dependent()
+  dest_sbox.build(create_wc=False, empty=True)
+  svntest.actions.enable_revprop_changes(dest_sbox.repo_dir)
+  run_init(dest_sbox.repo_url, sbox.repo_url)
+  run_sync(dest_sbox.repo_url)
+
+  # Change, add and delete revprops of several revisions in the source.
+  for rev in range(1, 6):
+    svntest.actions.run_and_verify_svn(None, [],
+                                       'propset', '--revprop', '-r', rev,
+                                       'answer', 'r%d' % rev, sbox.repo_url)
+  svntest.actions.run_and_verify_svn(None, [],
+                                     'propdel', '--revprop', '-r', 3,
+                                     'svn:log', sbox.repo_url)
+
+  expected_output = ['Copied properties for revision %d.\n' % rev
+                     for rev in range(5, 0, -1)]
+  svntest.actions.run_and_verify_svnsync(expected_output, [],
+                                         'copy-revprops', dest_sbox.repo_url,
+                                         sbox.repo_url, '5:1')
+
+  for rev in range(1, 6):
+    svntest.actions.run_and_verify_svn(['r%d\n' % rev], [],
+                                       'propget', '--revprop', '-r', rev,
+                                       'answer',
+                                       dest_sbox.repo_url)
+  svntest.actions.run_and_verify_svn(['log 4\n'], [],
+                                     'propget', '--revprop', '-r', 4,
+                                     'svn:log',
+                                     dest_sbox.repo_url)
+  svntest.actions.run_and_verify_svn([], '.*W200017: Property.*not found.*',
+                                     'propget', '--revprop', '-r', 3,
+                                     'svn:log', dest_sbox.repo_url)
+
 @SkipUnless(server_has_partial_replay)
 def only_trunk(sbox):
   "test syncing subdirectories"
@@ -625,6 +670,7 @@ test_list = [ None,
               fd_leak_sync_from_serf_to_local, # calls setrlimit
               mergeinfo_contains_r0,
               up_to_date_sync,
+              copy_revprops_range,
              ]
 
 if __name__ == '__main__':
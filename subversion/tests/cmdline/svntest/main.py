@@ -180,6 +180,7 @@ svnversion_binary = P('svnversion/svnversion')
 svndumpfilter_binary = P('svndumpfilter/svndumpfilter')
 svnmucc_binary = P('svnmucc/svnmucc')
 svnfsfs_binary = P('svnfsfs/svnfsfs')
+svnserve_binary = P('svnserve/svnserve')
 entriesdump_binary = P('tests/cmdline/entries-dump')
 lock_helper_binary = P('tests/cmdline/lock-helper')
 atomic_ra_revprop_change_binary = P('tests/cmdline/atomic-ra-revprop-change')
@@ -2417,6 +2418,7 @@ def execute_tests(test_list, serial_only = False, test_name = None,
   global svnversion_binary
   global svnmover_binary
   global svnmucc_binary
+  global svnserve_binary
   global svnauthz_binary
   global svnauthz_validate_binary
   global options
@@ -2520,6 +2522,7 @@ def execute_tests(test_list, serial_only = False, test_name = None,
                                           'svndumpfilter' + _exe)
       svnversion_binary = os.path.join(options.svn_bin, 'svnversion' + _exe)
       svnmucc_binary = os.path.join(options.svn_bin, 'svnmucc' + _exe)
+      svnserve_binary = os.path.join(options.svn_bin, 'svnserve' + _exe)
 
   if options.tools_bin:
     svnauthz_binary = os.path.join(options.tools_bin, 'svnauthz' + _exe)
@@ -284,6 +284,26 @@ def committed_revisions(sbox):
                                             [ "1:2\n" ], [],
                                             "--committed")
 
+def quick_modified_check(sbox):
+  "test 'svnversion --quick'"
+  sbox.build(read_only = True)
+  wc_dir = sbox.wc_dir
+  repo_url = sbox.repo_url
+  iota_path = sbox.ospath('iota')
+
+  # Touching a file without changing it is not a modification, but
+  # --quick cannot tell without comparing the contents.
+  os.utime(iota_path, (0, 0))
+  svntest.actions.run_and_verify_svnversion(wc_dir, repo_url,
+                                            [ "1\n" ], [])
+  svntest.actions.run_and_verify_svnversion(wc_dir, repo_url,
+                                            [ "1M\n" ], [],
+                                            "--quick")
+
+  svntest.main.file_append(iota_path, "modified\n")
+  svntest.actions.run_and_verify_svnversion(wc_dir, repo_url,
+                                            [ "1M\n" ], [])
+
 def non_reposroot_wc(sbox):
   "test 'svnversion' on a non-repos-root working copy"
   sbox.build(create_wc=False)
@@ -388,6 +408,7 @@ test_list = [ None,
               svnversion_with_excluded_subtrees,
               svnversion_with_structural_changes,
               committed_revisions,
+              quick_modified_check,
               non_reposroot_wc,
               child_switched,
              ]
@@ -39,6 +39,7 @@
 #include "private/svn_wc_private.h"
 #include "svn_props.h"
 #include "svn_hash.h"
+#include "svn_ra_svn.h"
 
 #include "../svn_test.h"
 #include "../svn_test_fs.h"
@@ -1419,6 +1420,244 @@ test_copy_pin_externals_select_subtree(const svn_test_opts_t *opts, apr_pool_t *
   return SVN_NO_ERROR;
 }
 
+/* Commit CONTENTS as the new text of iota in the repository at REPOS_URL,
+ * using CTX. */
+static svn_error_t *
+put_iota(const char *repos_url,
+         const char *contents,
+         svn_client_ctx_t *ctx,
+         apr_pool_t *pool)
+{
+  svn_client__mtcc_t *mtcc;
+
+  SVN_ERR(svn_client__mtcc_create(&mtcc, repos_url, -1, ctx, pool, pool));
+  SVN_ERR(svn_client__mtcc_add_update_file("iota",
+                                           svn_stream_from_string(
+                                             svn_string_create(contents,
+                                                               pool),
+                                             pool),
+                                           NULL, NULL, NULL, mtcc, pool));
+  return svn_error_trace(svn_client__mtcc_commit(NULL, NULL, NULL, mtcc,
+                                                 pool));
+}
+
+/* The svnserve tunnel of test_blame_youngest_first(). */
+typedef struct blame_tunnel_t
+{
+  /* The svnserve process. */
+  apr_proc_t proc;
+
+  /* The stream that svnserve's responses are read from. */
+  svn_stream_t *response;
+
+  /* Whether we removed the blame capability from the greeting yet. */
+  svn_boolean_t hidden;
+} blame_tunnel_t;
+
+/* Implements svn_read_fn_t.  Read the responses of the svnserve tunnel in
+ * BATON, but don't let the client see that svnserve can compute blame. */
+static svn_error_t *
+hide_blame_read(void *baton,
+                char *buffer,
+                apr_size_t *len)
+{
+  blame_tunnel_t *tunnel = baton;
+  apr_size_t i;
+
+  SVN_ERR(svn_stream_read2(tunnel->response, buffer, len));
+
+  /* The greeting lists the capabilities as words separated by spaces. */
+  for (i = 0; !tunnel->hidden && i + 7 <= *len; ++i)
+    if (memcmp(buffer + i, " " SVN_RA_SVN_CAP_BLAME " ", 7) == 0)
+      {
+        memset(buffer + i + 1, ' ', 5);
+        tunnel->hidden = TRUE;
+      }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_check_tunnel_func_t. */
+static svn_boolean_t
+check_blame_tunnel(void *tunnel_baton,
+                   const char *tunnel_name)
+{
+  return strcmp(tunnel_name, "test") == 0;
+}
+
+/* Implements svn_ra_close_tunnel_func_t. */
+static void
+close_blame_tunnel(void *tunnel_context,
+                   void *tunnel_baton)
+{
+  blame_tunnel_t *tunnel = tunnel_context;
+  int exitcode;
+  apr_exit_why_e exitwhy;
+
+  apr_file_close(tunnel->proc.in);
+  apr_file_close(tunnel->proc.out);
+  apr_proc_wait(&tunnel->proc, &exitcode, &exitwhy, APR_WAIT);
+}
+
+/* Implements svn_ra_open_tunnel_func_t.  Run svnserve in tunnel mode on
+ * the directory given by TUNNEL_BATON. */
+static svn_error_t *
+open_blame_tunnel(svn_stream_t **request,
+                  svn_stream_t **response,
+                  svn_ra_close_tunnel_func_t *close_func,
+                  void **close_baton,
+                  void *tunnel_baton,
+                  const char *tunnel_name,
+                  const char *user,
+                  const char *hostname,
+                  int port,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *pool)
+{
+  const char *root = tunnel_baton;
+  blame_tunnel_t *tunnel = apr_pcalloc(pool, sizeof(*tunnel));
+  const char *args[] = { "svnserve", "-t", "-r", NULL, NULL };
+  const char *svnserve;
+  svn_node_kind_t kind;
+  apr_procattr_t *attr;
+  apr_status_t status;
+
+  SVN_ERR(svn_dirent_get_absolute(&svnserve, "../../svnserve/svnserve",
+                                  pool));
+#ifdef WIN32
+  svnserve = apr_pstrcat(pool, svnserve, ".exe", SVN_VA_NULL);
+#endif
+  SVN_ERR(svn_io_check_path(svnserve, &kind, pool));
+  if (kind != svn_node_file)
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                             "Could not find svnserve at %s",
+                             svn_dirent_local_style(svnserve, pool));
+
+  args[3] = svn_dirent_local_style(root, pool);
+
+  status = apr_procattr_create(&attr, pool);
+  if (status == APR_SUCCESS)
+    status = apr_procattr_io_set(attr, 1, 1, 0);
+  if (status == APR_SUCCESS)
+    status = apr_procattr_cmdtype_set(attr, APR_PROGRAM);
+  if (status == APR_SUCCESS)
+    status = apr_proc_create(&tunnel->proc,
+                             svn_dirent_local_style(svnserve, pool),
+                             args, NULL, attr, pool);
+  if (status != APR_SUCCESS)
+    return svn_error_wrap_apr(status, "Could not run svnserve");
+  apr_pool_note_subprocess(pool, &tunnel->proc, APR_KILL_NEVER);
+
+  /* Don't let later child processes hold the tunnel open. */
+  apr_file_inherit_unset(tunnel->proc.in);
+  apr_file_inherit_unset(tunnel->proc.out);
+
+  tunnel->response = svn_stream_from_aprfile2(tunnel->proc.out, FALSE, pool);
+
+  *request = svn_stream_from_aprfile2(tunnel->proc.in, FALSE, pool);
+  *response = svn_stream_create(tunnel, pool);
+  svn_stream_set_read2(*response, hide_blame_read, NULL);
+  *close_func = close_blame_tunnel;
+  *close_baton = tunnel;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_client_blame_receiver4_t.  Append the revision of each
+ * line to the array of svn_revnum_t in BATON. */
+static svn_error_t *
+blame_revision_receiver(void *baton,
+                        apr_int64_t line_no,
+                        svn_revnum_t revision,
+                        apr_hash_t *rev_props,
+                        svn_revnum_t merged_revision,
+                        apr_hash_t *merged_rev_props,
+                        const char *merged_path,
+                        const svn_string_t *line,
+                        svn_boolean_t local_change,
+                        apr_pool_t *pool)
+{
+  apr_array_header_t *revs = baton;
+
+  APR_ARRAY_PUSH(revs, svn_revnum_t) = revision;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_wc_notify_func2_t.  Append the revisions that blame
+ * received to the array of svn_revnum_t in BATON. */
+static void
+blame_notify(void *baton,
+             const svn_wc_notify_t *notify,
+             apr_pool_t *pool)
+{
+  apr_array_header_t *revs = baton;
+
+  if (notify->action == svn_wc_notify_blame_revision)
+    APR_ARRAY_PUSH(revs, svn_revnum_t) = notify->revision;
+}
+
+/* Test the blame walk from the youngest revision towards older ones that
+ * the client does if the server can't compute the blame itself.  It must
+ * stop once all lines are attributed. */
+static svn_error_t *
+test_blame_youngest_first(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  const char *repos_url;
+  const char *root_abspath;
+  svn_client_ctx_t *ctx;
+  svn_opt_revision_t peg_rev, start_rev, end_rev;
+  apr_array_header_t *line_revs = apr_array_make(pool, 3,
+                                                 sizeof(svn_revnum_t));
+  apr_array_header_t *notified = apr_array_make(pool, 4,
+                                                sizeof(svn_revnum_t));
+  int i;
+
+  SVN_ERR(create_greek_repos(&repos_url, "test-blame-youngest-first", opts,
+                             pool));
+  SVN_ERR(svn_client_create_context(&ctx, pool));
+
+  /* r2 changes iota, r3 replaces all of its lines and r4 adds one more. */
+  SVN_ERR(put_iota(repos_url, "This is the file 'iota'.\nmore\n", ctx,
+                   pool));
+  SVN_ERR(put_iota(repos_url, "line a\nline b\n", ctx, pool));
+  SVN_ERR(put_iota(repos_url, "line a\nline b\nline c\n", ctx, pool));
+
+  /* Access the repository through svnserve but hide its blame support. */
+  SVN_ERR(svn_dirent_get_absolute(&root_abspath, svn_test_data_path("", pool),
+                                  pool));
+  ctx->check_tunnel_func = check_blame_tunnel;
+  ctx->open_tunnel_func = open_blame_tunnel;
+  ctx->tunnel_baton = (void *)root_abspath;
+  ctx->notify_func2 = blame_notify;
+  ctx->notify_baton2 = notified;
+
+  peg_rev.kind = svn_opt_revision_head;
+  start_rev.kind = svn_opt_revision_number;
+  start_rev.value.number = 1;
+  end_rev.kind = svn_opt_revision_head;
+
+  SVN_ERR(svn_client_blame6(NULL, NULL,
+                            "svn+test://localhost/"
+                            "test-blame-youngest-first/iota",
+                            &peg_rev, &start_rev, &end_rev,
+                            NULL, FALSE, FALSE, blame_revision_receiver,
+                            line_revs, ctx, pool));
+
+  SVN_TEST_INT_ASSERT(line_revs->nelts, 3);
+  SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(line_revs, 0, svn_revnum_t), 3);
+  SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(line_revs, 1, svn_revnum_t), 3);
+  SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(line_revs, 2, svn_revnum_t), 4);
+
+  /* The walk went from r4 down to r2, where all lines were attributed. */
+  SVN_TEST_INT_ASSERT(notified->nelts, 3);
+  for (i = 0; i < notified->nelts; i++)
+    SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(notified, i, svn_revnum_t), 4 - i);
+
+  return SVN_NO_ERROR;
+}
+
 /* ========================================================================== */
 
 
@@ -1447,6 +1686,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_client_copy7 with externals_to_pin"),
     SVN_TEST_OPTS_PASS(test_copy_pin_externals_select_subtree,
                        "pin externals on selected subtrees only"),
+    SVN_TEST_OPTS_PASS(test_blame_youngest_first,
+                       "test blame walking youngest revisions first"),
     SVN_TEST_NULL
   };
 
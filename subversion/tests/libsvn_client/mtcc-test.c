@@ -842,6 +842,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test iprops url format"),
     SVN_TEST_OPTS_PASS(test_move_and_delete_ancestor,
                        "test move and delete ancestor (issue 4666)"),
+    SVN_TEST_OPTS_PASS(test_many_children,
+                       "test mtcc with many children in one directory"),
     SVN_TEST_NULL
   };
 
@@ -37,6 +37,8 @@
 #include "svn_pools.h"
 #include "svn_error.h"
 
+#include "private/svn_subr_private.h"
+
 #include "../../libsvn_delta/delta.h"
 #include "delta-window-test.h"
 
@@ -289,6 +291,8 @@ do_random_test(apr_pool_t *pool,
   apr_size_t bytes_range;
   int i, iterations, dump_files, print_windows;
   const char *random_bytes;
+  /* svndiff3 can only be produced with Zstandard support. */
+  int max_svndiff_versions = svn__zstd_supported() ? 4 : 3;
 
   /* Initialize parameters and print out the seed in case we dump core
      or something. */
@@ -330,8 +334,8 @@ do_random_test(apr_pool_t *pool,
 
       /* Make stage 2: encode the text delta in svndiff format using
                        varying svndiff versions and compression levels. */
-      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream, i % 3,
-                              i % 10, delta_pool);
+      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                              i % max_svndiff_versions, i % 10, delta_pool);
 
       /* Make stage 1: create the text delta.  */
       svn_txdelta2(&txdelta_stream,
@@ -380,6 +384,8 @@ do_random_combine_test(apr_pool_t *pool,
   apr_size_t bytes_range;
   int i, iterations, dump_files, print_windows;
   const char *random_bytes;
+  /* svndiff3 can only be produced with Zstandard support. */
+  int max_svndiff_versions = svn__zstd_supported() ? 4 : 3;
 
   /* Initialize parameters and print out the seed in case we dump core
      or something. */
@@ -426,8 +432,8 @@ do_random_combine_test(apr_pool_t *pool,
 
       /* Make stage 2: encode the text delta in svndiff format using
                        varying svndiff versions and compression levels. */
-      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream, i % 3,
-                              i % 10, delta_pool);
+      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                              i % max_svndiff_versions, i % 10, delta_pool);
 
       /* Make stage 1: create the text deltas.  */
 
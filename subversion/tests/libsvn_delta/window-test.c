@@ -21,6 +21,8 @@
  * ====================================================================
  */
 
+#include <string.h>
+
 #include <apr_pools.h>
 
 #include "../svn_test.h"
@@ -28,7 +30,9 @@
 #include "svn_types.h"
 #include "svn_error.h"
 #include "svn_delta.h"
+#include "svn_checksum.h"
 
+#include "private/svn_delta_private.h"
 #include "private/svn_subr_private.h"
 
 static svn_error_t *
@@ -97,6 +101,319 @@ stream_window_test(apr_pool_t *pool)
 }
 
 
+
+
+/* Size of the test data for multi_window_test, i.e. about 9 windows. */
+#define MULTI_WINDOW_SIZE (9 * SVN_DELTA_WINDOW_SIZE + 12345)
+
+static svn_error_t *
+multi_window_test(apr_pool_t *pool)
+{
+  /* Note: put these in data segment, not the stack */
+  static char source[MULTI_WINDOW_SIZE];
+  static char target[MULTI_WINDOW_SIZE];
+  apr_uint32_t seed = 0x12345678;
+  svn_stringbuf_t *pull_diff = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *push_diff = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  svn_string_t source_str, target_str;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_txdelta_stream_t *txstream;
+  svn_stream_t *stream;
+  apr_size_t i, len;
+
+  /* Pseudo-random source and a target that differs in a few places. */
+  for (i = 0; i < MULTI_WINDOW_SIZE; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      source[i] = (char)(seed >> 16) & 0x3f;
+    }
+
+  memcpy(target, source + 1000, MULTI_WINDOW_SIZE - 1000);
+  memcpy(target + MULTI_WINDOW_SIZE - 1000, source, 1000);
+  for (i = 0; i < MULTI_WINDOW_SIZE; i += 4321)
+    target[i] = 'X';
+
+  source_str.data = source;
+  source_str.len = MULTI_WINDOW_SIZE;
+  target_str.data = target;
+  target_str.len = MULTI_WINDOW_SIZE;
+
+  /* Deltify using a txdelta stream ... */
+  svn_txdelta_to_svndiff3(&handler, &handler_baton,
+                          svn_stream_from_stringbuf(pull_diff, pool), 1,
+                          SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, pool);
+  svn_txdelta2(&txstream, svn_stream_from_string(&source_str, pool),
+               svn_stream_from_string(&target_str, pool), TRUE, pool);
+  SVN_ERR(svn_txdelta_send_txstream(txstream, handler, handler_baton, pool));
+
+  /* ... and using a target push stream fed in odd-sized chunks. */
+  svn_txdelta_to_svndiff3(&handler, &handler_baton,
+                          svn_stream_from_stringbuf(push_diff, pool), 1,
+                          SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, pool);
+  stream = svn_txdelta_target_push(handler, handler_baton,
+                                   svn_stream_from_string(&source_str, pool),
+                                   pool);
+  for (i = 0; i < MULTI_WINDOW_SIZE; i += len)
+    {
+      len = MULTI_WINDOW_SIZE - i;
+      if (len > 7777)
+        len = 7777;
+      SVN_ERR(svn_stream_write(stream, target + i, &len));
+    }
+  SVN_ERR(svn_stream_close(stream));
+
+  /* Both must produce the same windows in the same order. */
+  SVN_TEST_ASSERT(svn_stringbuf_compare(pull_diff, push_diff));
+
+  /* Applying the delta must reproduce the target. */
+  svn_txdelta_apply(svn_stream_from_string(&source_str, pool),
+                    svn_stream_from_stringbuf(result, pool), NULL, NULL,
+                    pool, &handler, &handler_baton);
+  stream = svn_txdelta_parse_svndiff(handler, handler_baton, TRUE, pool);
+  len = pull_diff->len;
+  SVN_ERR(svn_stream_write(stream, pull_diff->data, &len));
+  SVN_ERR(svn_stream_close(stream));
+
+  SVN_TEST_ASSERT(result->len == MULTI_WINDOW_SIZE);
+  SVN_TEST_ASSERT(memcmp(result->data, target, MULTI_WINDOW_SIZE) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+/* Length of each text in compose_chain_test. */
+#define CHAIN_TEXT_SIZE 20000
+
+/* Number of deltas in the chain for compose_chain_test. */
+#define CHAIN_LENGTH 20
+
+/* Set *WINDOW to the single delta window transforming SOURCE into TARGET,
+   allocated in POOL. */
+static svn_error_t *
+single_window_delta(svn_txdelta_window_t **window,
+                    const svn_string_t *source,
+                    const svn_string_t *target,
+                    apr_pool_t *pool)
+{
+  svn_txdelta_stream_t *txstream;
+
+  svn_txdelta2(&txstream, svn_stream_from_string(source, pool),
+               svn_stream_from_string(target, pool), FALSE, pool);
+  SVN_ERR(svn_txdelta_next_window(window, txstream, pool));
+  SVN_TEST_ASSERT(*window != NULL);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+compose_chain_test(apr_pool_t *pool)
+{
+  svn_string_t *texts[CHAIN_LENGTH + 1];
+  apr_array_header_t *windows
+    = apr_array_make(pool, CHAIN_LENGTH, sizeof(svn_txdelta_window_t *));
+  svn_txdelta_window_t *composite, *pairwise;
+  apr_uint32_t seed = 0x87654321;
+  char *buf;
+  apr_size_t len;
+  int i, k;
+
+  /* Each text is a modified copy of the previous one. */
+  buf = apr_palloc(pool, CHAIN_TEXT_SIZE);
+  for (k = 0; k < CHAIN_TEXT_SIZE; ++k)
+    {
+      seed = seed * 1103515245 + 12345;
+      buf[k] = 'a' + (char)((seed >> 16) % 26);
+    }
+  texts[0] = svn_string_ncreate(buf, CHAIN_TEXT_SIZE, pool);
+
+  for (i = 1; i <= CHAIN_LENGTH; ++i)
+    {
+      buf = apr_pmemdup(pool, texts[i - 1]->data, CHAIN_TEXT_SIZE);
+      for (k = 0; k < 10; ++k)
+        {
+          apr_size_t pos, count;
+
+          seed = seed * 1103515245 + 12345;
+          pos = (seed >> 8) % (CHAIN_TEXT_SIZE - 200);
+          count = (seed >> 4) % 200;
+          if (k % 2)
+            memmove(buf + pos, buf + pos + count / 2, count / 2);
+          else
+            memset(buf + pos, 'A' + i, count);
+        }
+      texts[i] = svn_string_ncreate(buf, CHAIN_TEXT_SIZE, pool);
+    }
+
+  /* Newest first. */
+  for (i = CHAIN_LENGTH; i > 0; --i)
+    {
+      svn_txdelta_window_t *window;
+      SVN_ERR(single_window_delta(&window, texts[i - 1], texts[i], pool));
+      APR_ARRAY_PUSH(windows, svn_txdelta_window_t *) = window;
+    }
+
+  composite = svn_txdelta__compose_window_list(windows, pool, pool);
+
+  pairwise = APR_ARRAY_IDX(windows, 0, svn_txdelta_window_t *);
+  for (i = 1; i < windows->nelts; ++i)
+    pairwise = svn_txdelta_compose_windows(
+                 APR_ARRAY_IDX(windows, i, svn_txdelta_window_t *),
+                 pairwise, pool);
+
+  /* Both must describe the final text in terms of the first one. */
+  SVN_TEST_ASSERT(composite->tview_len == CHAIN_TEXT_SIZE);
+  SVN_TEST_ASSERT(composite->num_ops == pairwise->num_ops);
+
+  buf = apr_palloc(pool, CHAIN_TEXT_SIZE);
+  len = CHAIN_TEXT_SIZE;
+  svn_txdelta_apply_instructions(composite, texts[0]->data, buf, &len);
+  SVN_TEST_ASSERT(len == CHAIN_TEXT_SIZE);
+  SVN_TEST_ASSERT(memcmp(buf, texts[CHAIN_LENGTH]->data, len) == 0);
+
+  len = CHAIN_TEXT_SIZE;
+  svn_txdelta_apply_instructions(pairwise, texts[0]->data, buf, &len);
+  SVN_TEST_ASSERT(len == CHAIN_TEXT_SIZE);
+  SVN_TEST_ASSERT(memcmp(buf, texts[CHAIN_LENGTH]->data, len) == 0);
+
+  return SVN_NO_ERROR;
+}
+static svn_error_t *
+apply_instructions_test(apr_pool_t *pool)
+{
+  /* Exercise overlapping and non-overlapping target copies. */
+  static const char expected[] = "abababababab" "bbbbb" "yz0" "baba";
+  svn_txdelta_op_t ops[] =
+    {
+      { svn_txdelta_new, 0, 2 },
+      { svn_txdelta_target, 0, 10 },
+      { svn_txdelta_target, 11, 5 },
+      { svn_txdelta_source, 1, 3 },
+      { svn_txdelta_target, 3, 4 }
+    };
+  svn_txdelta_window_t window = { 0 };
+  char tbuf[sizeof(expected)];
+  apr_size_t len;
+
+  window.sview_len = 4;
+  window.tview_len = sizeof(expected) - 1;
+  window.num_ops = sizeof(ops) / sizeof(ops[0]);
+  window.src_ops = 1;
+  window.ops = ops;
+  window.new_data = svn_string_create("ab", pool);
+
+  len = sizeof(tbuf);
+  svn_txdelta_apply_instructions(&window, "xyz0", tbuf, &len);
+  SVN_TEST_INT_ASSERT(len, sizeof(expected) - 1);
+  SVN_TEST_ASSERT(memcmp(tbuf, expected, len) == 0);
+
+  /* Only produce part of the target. */
+  memset(tbuf, 0, sizeof(tbuf));
+  len = 15;
+  svn_txdelta_apply_instructions(&window, "xyz0", tbuf, &len);
+  SVN_TEST_INT_ASSERT(len, 15);
+  SVN_TEST_ASSERT(memcmp(tbuf, expected, len) == 0);
+  SVN_TEST_ASSERT(tbuf[len] == 0);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Two versions of a zip archive with a single deflated member, differing
+   in one line of that member. */
+static const char zip_v1[] =
+  "\x50\x4b\x03\x04\x14\x00\x00\x00\x08\x00\x00\x00\x21\x50\x80\x9f"
+  "\x71\x3d\x77\x00\x00\x00\x66\x03\x00\x00\x07\x00\x00\x00\x64\x6f"
+  "\x63\x2e\x78\x6d\x6c\x6d\xd2\xbb\x0d\x02\x41\x10\x44\x41\x9f\x28"
+  "\x2e\x03\x98\x69\xbe\xd2\xea\x72\x59\x0b\xcc\xd5\xe5\x6f\x60\x60"
+  "\x21\x95\xfb\xac\x29\xf5\x8c\xb5\xcf\x6d\xcd\x63\xbe\x8f\xb9\x3e"
+  "\xdb\x65\x9c\xd7\x7e\x1a\xff\xb1\x14\x5b\x31\x8a\x57\xc5\x9b\xe2"
+  "\x5d\xf1\xa1\xf8\x54\x7c\xf1\x78\x93\x68\x2a\xa2\x8a\xaa\x22\xab"
+  "\xe8\x2a\xc2\x8a\xb2\x22\xad\x68\x6b\xda\xda\x7b\xd1\xd6\xb4\x35"
+  "\x6d\x4d\x5b\xd3\xd6\xb4\x35\x6d\x4d\x5b\x68\x0b\x6d\xf1\x33\xd2"
+  "\x16\xda\x42\x5b\x68\x0b\x6d\xa1\x2d\x3f\xdb\x17\x50\x4b\x01\x02"
+  "\x14\x03\x14\x00\x00\x00\x08\x00\x00\x00\x21\x50\x80\x9f\x71\x3d"
+  "\x77\x00\x00\x00\x66\x03\x00\x00\x07\x00\x00\x00\x00\x00\x00\x00"
+  "\x00\x00\x00\x00\x80\x01\x00\x00\x00\x00\x64\x6f\x63\x2e\x78\x6d"
+  "\x6c\x50\x4b\x05\x06\x00\x00\x00\x00\x01\x00\x01\x00\x35\x00\x00"
+  "\x00\x9c\x00\x00\x00\x00\x00";
+
+static const char zip_v2[] =
+  "\x50\x4b\x03\x04\x14\x00\x00\x00\x08\x00\x00\x00\x21\x50\x24\xdf"
+  "\xaa\x1d\x83\x00\x00\x00\x6c\x03\x00\x00\x07\x00\x00\x00\x64\x6f"
+  "\x63\x2e\x78\x6d\x6c\x6d\xd2\x3d\x0a\xc2\x50\x14\x44\xe1\xde\x55"
+  "\x64\x07\x3a\x33\xfe\x05\x1e\xd9\xcb\x45\x25\xa9\xe4\x91\xfd\x17"
+  "\x16\x42\x48\xe0\xb4\xa7\xba\x1f\x73\x5b\x9f\x6a\xe8\xb5\xd6\xbc"
+  "\x56\x5f\x86\x4b\x3b\xf7\xe9\xd4\x8e\x51\x14\x4d\x31\x14\xaf\x14"
+  "\x6f\x14\xef\x14\x1f\x14\x9f\x14\x47\x3c\x9e\x49\x68\x12\xa2\x84"
+  "\x2a\x21\x4b\xe8\x12\xc2\x84\x32\x21\x4d\x9b\xed\xb5\xd4\x77\xfe"
+  "\xbc\xf7\x4b\xa0\xd0\xbc\x1a\x0a\x8d\x42\xa3\xd0\x28\x34\x0a\x8d"
+  "\x42\xa3\xd0\xb8\x5e\xd0\x16\xb4\x85\x5f\x12\x6d\x41\x5b\xd0\x16"
+  "\xb4\x05\x6d\x41\x5b\xfe\xb6\x1f\x50\x4b\x01\x02\x14\x03\x14\x00"
+  "\x00\x00\x08\x00\x00\x00\x21\x50\x24\xdf\xaa\x1d\x83\x00\x00\x00"
+  "\x6c\x03\x00\x00\x07\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+  "\x80\x01\x00\x00\x00\x00\x64\x6f\x63\x2e\x78\x6d\x6c\x50\x4b\x05"
+  "\x06\x00\x00\x00\x00\x01\x00\x01\x00\x35\x00\x00\x00\xa8\x00\x00"
+  "\x00\x00\x00";
+
+static svn_error_t *
+transformed_delta_test(apr_pool_t *pool)
+{
+  const svn_txdelta__transform_t *transform;
+  svn_string_t *source = svn_string_ncreate(zip_v1, sizeof(zip_v1) - 1,
+                                            pool);
+  svn_string_t *target = svn_string_ncreate(zip_v2, sizeof(zip_v2) - 1,
+                                            pool);
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_checksum_t *checksum;
+  svn_checksum_t *expected;
+
+  SVN_TEST_ASSERT(svn_txdelta__transform_for_mime_type("text/plain", pool)
+                  == NULL);
+  SVN_TEST_ASSERT(svn_txdelta__transform_for_mime_type(NULL, pool) == NULL);
+  SVN_TEST_ASSERT(svn_txdelta__transform_for_mime_type(
+                    "application/vnd.openxmlformats-officedocument"
+                    ".wordprocessingml.document", pool) != NULL);
+  transform = svn_txdelta__transform_for_mime_type(
+                "Application/Zip; charset=binary", pool);
+  SVN_TEST_ASSERT(transform != NULL);
+
+  svn_txdelta__apply_transformed(svn_stream_from_string(source, pool),
+                                 svn_stream_from_stringbuf(result, pool),
+                                 transform, pool, &handler, &handler_baton);
+  SVN_ERR(svn_txdelta__run_transformed(svn_stream_from_string(source, pool),
+                                       svn_stream_from_string(target, pool),
+                                       transform, handler, handler_baton,
+                                       svn_checksum_md5, &checksum,
+                                       NULL, NULL, pool, pool));
+
+  SVN_TEST_INT_ASSERT(result->len, target->len);
+  SVN_TEST_ASSERT(memcmp(result->data, target->data, target->len) == 0);
+
+  SVN_ERR(svn_checksum(&expected, svn_checksum_md5, target->data,
+                       target->len, pool));
+  SVN_TEST_ASSERT(svn_checksum_match(checksum, expected));
+
+  /* Data that is not a zip archive at all must survive, too. */
+  svn_stringbuf_setempty(result);
+  svn_txdelta__apply_transformed(svn_stream_from_string(target, pool),
+                                 svn_stream_from_stringbuf(result, pool),
+                                 transform, pool, &handler, &handler_baton);
+  SVN_ERR(svn_txdelta__run_transformed(svn_stream_from_string(target, pool),
+                                       svn_stream_from_string(
+                                         svn_string_create("PK\3\4", pool),
+                                         pool),
+                                       transform, handler, handler_baton,
+                                       svn_checksum_md5, NULL,
+                                       NULL, NULL, pool, pool));
+  SVN_TEST_STRING_ASSERT(result->data, "PK\3\4");
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* The test table.  */
 
@@ -107,6 +424,14 @@ static struct svn_test_descriptor_t test_funcs[] =
     SVN_TEST_NULL,
     SVN_TEST_PASS2(stream_window_test,
                    "txdelta stream and windows test"),
+    SVN_TEST_PASS2(multi_window_test,
+                   "multi-window txdelta and target push test"),
+    SVN_TEST_PASS2(compose_chain_test,
+                   "compose a long chain of delta windows"),
+    SVN_TEST_PASS2(apply_instructions_test,
+                   "apply delta instructions with target copies"),
+    SVN_TEST_PASS2(transformed_delta_test,
+                   "delta zip archives through a transform"),
     SVN_TEST_NULL
   };
 
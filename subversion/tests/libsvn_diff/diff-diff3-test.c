@@ -28,6 +28,8 @@
 #include "svn_pools.h"
 #include "svn_utf.h"
 
+#include "private/svn_diff_private.h"
+
 /* Used to terminate lines in large multi-line string literals. */
 #define NL APR_EOL_STR
 
@@ -2251,9 +2253,11 @@ random_trivial_merge(apr_pool_t *pool)
    for each selected line either adding an additional line, replacing the
    line, or deleting the line.  The two subsets are chosen so that each
    selected line is distinct and no two selected lines are adjacent. This
-   means the two sets of changes should merge without conflict.  */
+   means the two sets of changes should merge without conflict.  Use
+   OPTIONS to control the diff.  */
 static svn_error_t *
-random_three_way_merge(apr_pool_t *pool)
+random_three_way_merge_with_options(const svn_diff_file_options_t *options,
+                                    apr_pool_t *pool)
 {
   int i;
   apr_pool_t *subpool = svn_pool_create(pool);
@@ -2307,12 +2311,12 @@ random_three_way_merge(apr_pool_t *pool)
 
       SVN_ERR(three_way_merge(base_filename1, base_filename2, base_filename3,
                               original->data, modified1->data,
-                              modified2->data, combined->data, NULL,
+                              modified2->data, combined->data, options,
                               svn_diff_conflict_display_modified_latest,
                               subpool));
       SVN_ERR(three_way_merge(base_filename1, base_filename3, base_filename2,
                               original->data, modified2->data,
-                              modified1->data, combined->data, NULL,
+                              modified1->data, combined->data, options,
                               svn_diff_conflict_display_modified_latest,
                               subpool));
 
@@ -2325,6 +2329,335 @@ random_three_way_merge(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+random_three_way_merge(apr_pool_t *pool)
+{
+  return random_three_way_merge_with_options(NULL, pool);
+}
+
+/* Like random_three_way_merge but using the histogram algorithm, selected
+   the same way the command line clients do it. */
+static svn_error_t *
+random_three_way_merge_histogram(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  apr_array_header_t *args = apr_array_make(pool, 1, sizeof(const char *));
+
+  APR_ARRAY_PUSH(args, const char *) = "--histogram";
+  SVN_ERR(svn_diff_file_options_parse(options, args, pool));
+  SVN_TEST_ASSERT(options->algorithm == svn_diff_file_algorithm_histogram);
+
+  return random_three_way_merge_with_options(options, pool);
+}
+
+/* Baton for the windowed_diff_output_* callbacks, which rebuild each of
+   the two datasources from the other one and the diff between them. */
+struct windowed_diff_baton_t
+{
+  /* Start offsets of the lines in CONTENTS, followed by its length. */
+  apr_array_header_t *lines[2];
+  svn_stringbuf_t *contents[2];
+  svn_stringbuf_t *rebuilt[2];
+  /* The line at which the next hunk has to start. */
+  apr_off_t next[2];
+  apr_off_t common_lines;
+};
+
+/* Return an array of the start offsets of the lines in CONTENTS, followed
+   by the length of CONTENTS. */
+static apr_array_header_t *
+split_lines(svn_stringbuf_t *contents,
+            apr_pool_t *pool)
+{
+  apr_array_header_t *lines = apr_array_make(pool, 0, sizeof(apr_size_t));
+  apr_size_t i;
+
+  for (i = 0; i < contents->len; i++)
+    if (i == 0 || contents->data[i - 1] == '\n')
+      APR_ARRAY_PUSH(lines, apr_size_t) = i;
+  APR_ARRAY_PUSH(lines, apr_size_t) = contents->len;
+
+  return lines;
+}
+
+/* Append LENGTH lines of datasource IDX of BATON, starting at START, to
+   the datasource rebuilt for TARGET_IDX. */
+static svn_error_t *
+append_lines(struct windowed_diff_baton_t *baton,
+             int idx,
+             int target_idx,
+             apr_off_t start,
+             apr_off_t length)
+{
+  apr_size_t from, to;
+
+  SVN_TEST_ASSERT(start + length < baton->lines[idx]->nelts);
+  from = APR_ARRAY_IDX(baton->lines[idx], start, apr_size_t);
+  to = APR_ARRAY_IDX(baton->lines[idx], start + length, apr_size_t);
+  svn_stringbuf_appendbytes(baton->rebuilt[target_idx],
+                            baton->contents[idx]->data + from, to - from);
+
+  return SVN_NO_ERROR;
+}
+
+/* Check that a hunk starts where the previous one ended. */
+static svn_error_t *
+check_hunk_start(struct windowed_diff_baton_t *baton,
+                 apr_off_t original_start, apr_off_t original_length,
+                 apr_off_t modified_start, apr_off_t modified_length)
+{
+  SVN_TEST_INT_ASSERT(original_start, baton->next[0]);
+  SVN_TEST_INT_ASSERT(modified_start, baton->next[1]);
+  baton->next[0] += original_length;
+  baton->next[1] += modified_length;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_diff_output_fns_t.output_common. */
+static svn_error_t *
+windowed_diff_output_common(void *baton,
+                            apr_off_t original_start,
+                            apr_off_t original_length,
+                            apr_off_t modified_start,
+                            apr_off_t modified_length,
+                            apr_off_t latest_start,
+                            apr_off_t latest_length)
+{
+  struct windowed_diff_baton_t *b = baton;
+
+  SVN_TEST_INT_ASSERT(original_length, modified_length);
+  SVN_ERR(check_hunk_start(b, original_start, original_length,
+                           modified_start, modified_length));
+  SVN_ERR(append_lines(b, 0, 1, original_start, original_length));
+  SVN_ERR(append_lines(b, 1, 0, modified_start, modified_length));
+  b->common_lines += original_length;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_diff_output_fns_t.output_diff_modified. */
+static svn_error_t *
+windowed_diff_output_modified(void *baton,
+                              apr_off_t original_start,
+                              apr_off_t original_length,
+                              apr_off_t modified_start,
+                              apr_off_t modified_length,
+                              apr_off_t latest_start,
+                              apr_off_t latest_length)
+{
+  struct windowed_diff_baton_t *b = baton;
+
+  SVN_ERR(check_hunk_start(b, original_start, original_length,
+                           modified_start, modified_length));
+  SVN_ERR(append_lines(b, 0, 0, original_start, original_length));
+  SVN_ERR(append_lines(b, 1, 1, modified_start, modified_length));
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_output_fns_t windowed_diff_output_fns =
+{
+  windowed_diff_output_common,
+  windowed_diff_output_modified
+};
+
+/* Diff FILENAME1 and FILENAME2 using OPTIONS and verify that the result
+   describes both files completely.  Return the number of common lines
+   in *COMMON_LINES. */
+static svn_error_t *
+verify_windowed_diff(apr_off_t *common_lines,
+                     const char *filename1,
+                     const char *filename2,
+                     const svn_diff_file_options_t *options,
+                     apr_pool_t *pool)
+{
+  struct windowed_diff_baton_t baton = { { 0 } };
+  svn_diff_t *diff;
+  int i;
+
+  SVN_ERR(svn_stringbuf_from_file2(&baton.contents[0], filename1, pool));
+  SVN_ERR(svn_stringbuf_from_file2(&baton.contents[1], filename2, pool));
+  for (i = 0; i < 2; i++)
+    {
+      baton.lines[i] = split_lines(baton.contents[i], pool);
+      baton.rebuilt[i] = svn_stringbuf_create_empty(pool);
+    }
+
+  SVN_ERR(svn_diff_file_diff_2(&diff, filename1, filename2, options, pool));
+  SVN_ERR(svn_diff_output2(diff, &baton, &windowed_diff_output_fns,
+                           NULL, NULL));
+
+  for (i = 0; i < 2; i++)
+    {
+      SVN_TEST_INT_ASSERT(baton.next[i], baton.lines[i]->nelts - 1);
+      SVN_TEST_STRING_ASSERT(baton.rebuilt[i]->data, baton.contents[i]->data);
+    }
+
+  *common_lines = baton.common_lines;
+  return SVN_NO_ERROR;
+}
+
+/* Diff large random files with a small window, as configured by the
+   command line clients, and check that the result is a valid diff. */
+static svn_error_t *
+random_windowed_two_way_diff(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options = svn_diff_file_options_create(pool);
+  apr_array_header_t *args = apr_array_make(pool, 2, sizeof(const char *));
+  apr_pool_t *subpool = svn_pool_create(pool);
+  const char *filename1 = svn_test_data_path("windowed1", pool);
+  const char *filename2 = svn_test_data_path("windowed2", pool);
+  int i;
+
+  APR_ARRAY_PUSH(args, const char *) = "--window-lines";
+  APR_ARRAY_PUSH(args, const char *) = "64";
+  SVN_ERR(svn_diff_file_options_parse(options, args, pool));
+  SVN_TEST_INT_ASSERT(options->window_lines, 64);
+
+  seed_val();
+
+  for (i = 0; i < 10; ++i)
+    {
+      int num_lines = 4000, num_mods = 40;
+      svn_boolean_t *lines = apr_pcalloc(subpool, sizeof(*lines) * num_lines);
+      struct random_mod *mod_lines = apr_palloc(subpool,
+                                                sizeof(*mod_lines) * num_mods);
+      apr_off_t common_lines;
+
+      /* Sparse changes between long runs of distinct lines.  Each change
+         affects at most one original line, so the window must not get in
+         the way of finding most of the common lines. */
+      select_lines(mod_lines, num_mods, lines, num_lines);
+      SVN_ERR(make_random_merge_file(filename1, num_lines, NULL, 0, subpool));
+      SVN_ERR(make_random_merge_file(filename2, num_lines, mod_lines,
+                                     num_mods, subpool));
+
+      SVN_ERR(verify_windowed_diff(&common_lines, filename1, filename2,
+                                   options, subpool));
+      SVN_TEST_ASSERT(common_lines >= num_lines - 2 * num_mods);
+
+      /* Unrelated files with many repeated lines. */
+      SVN_ERR(make_random_file(filename1, 1000, 2000, 20, 10, i % 2,
+                               subpool));
+      SVN_ERR(make_random_file(filename2, 1000, 2000, 20, 0, i % 3,
+                               subpool));
+
+      SVN_ERR(verify_windowed_diff(&common_lines, filename1, filename2,
+                                   options, subpool));
+
+      svn_pool_clear(subpool);
+    }
+
+  SVN_ERR(svn_io_remove_file2(filename1, TRUE, pool));
+  SVN_ERR(svn_io_remove_file2(filename2, TRUE, pool));
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the unified diff DIFF of ORIGINAL and MODIFIED in *OUTPUT. */
+static svn_error_t *
+unified_diff_text(const char **output,
+                  svn_diff_t *diff,
+                  const char *original,
+                  const char *modified,
+                  apr_pool_t *pool)
+{
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  svn_stream_t *ostream = svn_stream_from_stringbuf(actual, pool);
+
+  SVN_ERR(svn_diff_file_output_unified4(ostream, diff, original, modified,
+                                        "original", "modified",
+                                        SVN_APR_LOCALE_CHARSET, NULL, FALSE,
+                                        -1, NULL, NULL, pool));
+  SVN_ERR(svn_stream_close(ostream));
+
+  *output = actual->data;
+  return SVN_NO_ERROR;
+}
+
+/* Diff a series of random files, each against the previous one, through
+   a file diff chain and check that every diff matches the one from
+   svn_diff_file_diff_2(). */
+static svn_error_t *
+random_chained_two_way_diff(apr_pool_t *pool)
+{
+  svn_diff_file_options_t *options[2];
+  apr_pool_t *subpool = svn_pool_create(pool);
+  const char *filenames[3];
+  int i, j;
+
+  options[0] = svn_diff_file_options_create(pool);
+  options[1] = svn_diff_file_options_create(pool);
+  options[1]->ignore_space = svn_diff_file_ignore_space_change;
+  options[1]->ignore_eol_style = TRUE;
+
+  filenames[0] = svn_test_data_path("chained1", pool);
+  filenames[1] = svn_test_data_path("chained2", pool);
+  filenames[2] = svn_test_data_path("chained3", pool);
+
+  seed_val();
+
+  for (j = 0; j < 2; ++j)
+    {
+      svn_diff__file_chain_t *chain
+        = svn_diff__file_chain_create(options[j], pool);
+
+      for (i = 0; i < 30; ++i)
+        {
+          const char *original = filenames[i % 3];
+          const char *modified = filenames[(i + 1) % 3];
+          const char *expected, *actual;
+          svn_diff_t *diff;
+
+          /* Each file only depends on the current iteration, so writing
+             MODIFIED doesn't invalidate what CHAIN keeps of ORIGINAL. */
+          if (i == 0)
+            SVN_ERR(make_random_merge_file(original, 10000, NULL, 0,
+                                           subpool));
+
+          if (i % 5 == 4)
+            {
+              /* Mostly unrelated contents with many repeated lines. */
+              SVN_ERR(make_random_file(modified, 100, 2000, 20, i % 3, i % 2,
+                                       subpool));
+            }
+          else
+            {
+              int num_lines = 10000, num_mods = (i % 4) * 10 + 1;
+              svn_boolean_t *lines = apr_pcalloc(subpool,
+                                                 sizeof(*lines) * num_lines);
+              struct random_mod *mod_lines
+                = apr_palloc(subpool, sizeof(*mod_lines) * num_mods);
+
+              select_lines(mod_lines, num_mods, lines, num_lines);
+              SVN_ERR(make_random_merge_file(modified, num_lines, mod_lines,
+                                             num_mods, subpool));
+            }
+
+          SVN_ERR(svn_diff_file_diff_2(&diff, original, modified, options[j],
+                                       subpool));
+          SVN_ERR(unified_diff_text(&expected, diff, original, modified,
+                                    subpool));
+
+          SVN_ERR(svn_diff__file_chain_diff(&diff, chain, original, modified,
+                                            subpool));
+          SVN_ERR(unified_diff_text(&actual, diff, original, modified,
+                                    subpool));
+
+          SVN_TEST_STRING_ASSERT(actual, expected);
+          svn_pool_clear(subpool);
+        }
+    }
+
+  for (i = 0; i < 3; ++i)
+    SVN_ERR(svn_io_remove_file2(filenames[i], TRUE, pool));
+  svn_pool_destroy(subpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* This is similar to random_three_way_merge above, except this time half
    of the original-to-modified1 changes are already present in modified2
    (or, equivalently, half the original-to-modified2 changes are already
@@ -3089,6 +3422,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "random trivial merge"),
     SVN_TEST_PASS2(random_three_way_merge,
                    "random 3-way merge"),
+    SVN_TEST_PASS2(random_three_way_merge_histogram,
+                   "random 3-way merge using histogram diff"),
+    SVN_TEST_PASS2(random_windowed_two_way_diff,
+                   "random 2-way diff in bounded windows"),
+    SVN_TEST_PASS2(random_chained_two_way_diff,
+                   "random 2-way diffs through a file diff chain"),
     SVN_TEST_PASS2(merge_with_part_already_present,
                    "merge with part already present"),
     SVN_TEST_PASS2(merge_adjacent_changes,
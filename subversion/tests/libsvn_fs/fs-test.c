@@ -5702,8 +5702,8 @@ upgrade_while_committing(const svn_test_opts_t *opts,
   SVN_ERR(test_commit_txn(&head_rev, txn1, NULL, pool));
 
   /* Verify filesystem content. */
-  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM, NULL, NULL,
-                        NULL, NULL, pool));
+  SVN_ERR(svn_fs_verify2(fs_path, NULL, 0, SVN_INVALID_REVNUM, 1, NULL, NULL,
+                         NULL, NULL, pool));
 
   return SVN_NO_ERROR;
 }
@@ -7182,8 +7182,8 @@ commit_with_locked_rep_cache(const svn_test_opts_t *opts,
    * svn_fs_t keeping an unusable db connection (and associated file
    * locks) within it.
    */
-  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM, NULL, NULL,
-                        NULL, NULL, pool));
+  SVN_ERR(svn_fs_verify2(fs_path, NULL, 0, SVN_INVALID_REVNUM, 1, NULL, NULL,
+                         NULL, NULL, pool));
 
   return SVN_NO_ERROR;
 }
@@ -7469,6 +7469,326 @@ test_unrecognized_ioctl(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Many edits below the same directories, followed by replacing some of
+   them, must not serve stale DAG nodes of the original, mutable parents. */
+static svn_error_t *
+test_txn_mutable_node_reuse(const svn_test_opts_t *opts,
+                            apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t new_rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  static svn_test__tree_entry_t expected_entries[] = {
+    /* path, contents (0 = dir) */
+    { "iota",        "This is the file 'iota'.\n" },
+    { "A",           0 },
+    { "A/mu",        "This is the file 'mu'.\n" },
+    { "A/B",         0 },
+    { "A/B/lambda",  "new lambda\n" },
+    { "A/C",         0 },
+    { "A/D",         0 },
+    { "A/D/gamma",   "This is the file 'gamma'.\n" },
+    { "A/D/G",       0 },
+    { "A/D/G/alpha", "new alpha\n" },
+    { "A/D/G/beta",  "This is the file 'beta'.\n" },
+    { "A/D/H",       0 },
+    { "A/D/H/chi",   "chi 99\n" },
+    { "A/D/H/psi",   "This is the file 'psi'.\n" },
+    { "A/D/H/omega", "This is the file 'omega'.\n" }
+  };
+
+  SVN_ERR(svn_test__create_fs(&fs, "test-txn-mutable-node-reuse",
+                              opts, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(test_commit_txn(&new_rev, txn, NULL, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, new_rev, pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, new_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+
+  /* Edit the same files repeatedly. */
+  for (i = 0; i < 100; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/G/pi",
+                                          apr_psprintf(iterpool, "pi %d\n",
+                                                       i),
+                                          iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/H/chi",
+                                          apr_psprintf(iterpool, "chi %d\n",
+                                                       i),
+                                          iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Replace a modified directory by a copy and edit below it. */
+  SVN_ERR(svn_fs_delete(txn_root, "A/D/G", pool));
+  SVN_ERR(svn_fs_copy(rev_root, "A/B/E", txn_root, "A/D/G", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/G/alpha",
+                                      "new alpha\n", pool));
+
+  /* Replace another modified directory by a new one. */
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/lambda",
+                                      "old lambda\n", pool));
+  SVN_ERR(svn_fs_delete(txn_root, "A/B", pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "A/B", pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "A/B/lambda", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/lambda",
+                                      "new lambda\n", pool));
+
+  SVN_ERR(svn_test__validate_tree(txn_root, expected_entries,
+                                  sizeof(expected_entries)
+                                    / sizeof(expected_entries[0]),
+                                  pool));
+
+  SVN_ERR(test_commit_txn(&new_rev, txn, NULL, pool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, new_rev, pool));
+  SVN_ERR(svn_test__validate_tree(rev_root, expected_entries,
+                                  sizeof(expected_entries)
+                                    / sizeof(expected_entries[0]),
+                                  pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dir_entries_info(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t rev1, rev2;
+  apr_array_header_t *infos;
+  svn_checksum_t *expected_checksum;
+  int i, found = 0;
+
+  SVN_ERR(svn_test__create_fs(&fs, "test-dir-entries-info", opts, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(test_commit_txn(&rev1, txn, NULL, pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev1, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "A/D/gamma", "foo",
+                                  svn_string_create("bar", pool), pool));
+  SVN_ERR(test_commit_txn(&rev2, txn, NULL, pool));
+
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, rev2, pool));
+  SVN_ERR(svn_fs_file_checksum(&expected_checksum, svn_checksum_md5,
+                               rev_root, "A/D/gamma", TRUE, pool));
+
+  SVN_ERR(svn_fs_dir_entries_info(&infos, rev_root, "A/D", TRUE, TRUE,
+                                  svn_checksum_md5, pool, pool));
+  SVN_TEST_ASSERT(infos->nelts == 3);
+
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      svn_fs_dirent_info_t *info
+        = APR_ARRAY_IDX(infos, i, svn_fs_dirent_info_t *);
+
+      if (strcmp(info->name, "gamma") == 0)
+        {
+          SVN_TEST_ASSERT(info->kind == svn_node_file);
+          SVN_TEST_ASSERT(info->created_rev == rev2);
+          SVN_TEST_ASSERT(info->size
+                          == strlen("This is the file 'gamma'.\n"));
+          SVN_TEST_ASSERT(info->has_props);
+          SVN_TEST_ASSERT(apr_hash_count(info->props) == 1);
+          SVN_TEST_STRING_ASSERT(svn_prop_get_value(info->props, "foo"),
+                                 "bar");
+          SVN_TEST_ASSERT(svn_checksum_match(info->checksum,
+                                             expected_checksum));
+          ++found;
+        }
+      else if (   strcmp(info->name, "G") == 0
+               || strcmp(info->name, "H") == 0)
+        {
+          SVN_TEST_ASSERT(info->kind == svn_node_dir);
+          SVN_TEST_ASSERT(info->created_rev == rev1);
+          SVN_TEST_ASSERT(info->size == SVN_INVALID_FILESIZE);
+          SVN_TEST_ASSERT(!info->has_props);
+          SVN_TEST_ASSERT(apr_hash_count(info->props) == 0);
+          SVN_TEST_ASSERT(info->checksum == NULL);
+          ++found;
+        }
+    }
+
+  SVN_TEST_ASSERT(found == 3);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *PATHS to the paths reported by svn_fs_paths_changed_below() for
+   PATH and INCLUDE_PARENTS in ROOT. */
+static svn_error_t *
+get_changed_paths_below(apr_hash_t **paths,
+                        svn_fs_root_t *root,
+                        const char *path,
+                        svn_boolean_t include_parents,
+                        apr_pool_t *pool)
+{
+  svn_fs_path_change_iterator_t *iterator;
+  svn_fs_path_change3_t *change;
+
+  *paths = apr_hash_make(pool);
+  SVN_ERR(svn_fs_paths_changed_below(&iterator, root, path, include_parents,
+                                     pool, pool));
+  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  while (change)
+    {
+      svn_hash_sets(*paths, apr_pstrmemdup(pool, change->path.data,
+                                           change->path.len), "");
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_paths_changed_below(const svn_test_opts_t *opts,
+                         apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t new_rev;
+  apr_hash_t *paths;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i, pass;
+
+  SVN_ERR(svn_test__create_fs(&fs, "test-paths-changed-below", opts, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(test_commit_txn(&new_rev, txn, NULL, pool));
+
+  /* Enough unrelated changes to fill several blocks of the changed
+     paths list. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, new_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "big", pool));
+  for (i = 0; i < 250; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_make_file(txn_root,
+                               apr_psprintf(iterpool, "big/f%d", i),
+                               iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/G/pi", "new pi\n",
+                                      pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/lambda", "new\n",
+                                      pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "A/D", "foo",
+                                  svn_string_create("bar", pool), pool));
+
+  /* Check the txn root first, then the revision root. */
+  for (pass = 0; pass < 2; ++pass)
+    {
+      svn_fs_root_t *root = txn_root;
+      if (pass)
+        {
+          SVN_ERR(test_commit_txn(&new_rev, txn, NULL, pool));
+          SVN_ERR(svn_fs_revision_root(&rev_root, fs, new_rev, pool));
+          root = rev_root;
+        }
+
+      SVN_ERR(get_changed_paths_below(&paths, root, "A/D/G", FALSE, pool));
+      SVN_TEST_ASSERT(apr_hash_count(paths) == 1);
+      SVN_TEST_ASSERT(svn_hash_gets(paths, "/A/D/G/pi"));
+
+      SVN_ERR(get_changed_paths_below(&paths, root, "/A/D/G", TRUE, pool));
+      SVN_TEST_ASSERT(apr_hash_count(paths) == 2);
+      SVN_TEST_ASSERT(svn_hash_gets(paths, "/A/D/G/pi"));
+      SVN_TEST_ASSERT(svn_hash_gets(paths, "/A/D"));
+
+      SVN_ERR(get_changed_paths_below(&paths, root, "A", FALSE, pool));
+      SVN_TEST_ASSERT(apr_hash_count(paths) == 3);
+
+      SVN_ERR(get_changed_paths_below(&paths, root, "A/C", FALSE, pool));
+      SVN_TEST_ASSERT(apr_hash_count(paths) == 0);
+
+      SVN_ERR(get_changed_paths_below(&paths, root, "/", FALSE, pool));
+      SVN_TEST_ASSERT(apr_hash_count(paths) == 254);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_prefetch_tree(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t new_rev;
+  static svn_test__tree_entry_t expected_entries[] = {
+    /* path, contents (0 = dir) */
+    { "iota",        "This is the file 'iota'.\n" },
+    { "A",           0 },
+    { "A/mu",        "This is the file 'mu'.\n" },
+    { "A/B",         0 },
+    { "A/B/lambda",  "This is the file 'lambda'.\n" },
+    { "A/B/E",       0 },
+    { "A/B/E/alpha", "This is the file 'alpha'.\n" },
+    { "A/B/E/beta",  "This is the file 'beta'.\n" },
+    { "A/B/F",       0 },
+    { "A/C",         0 },
+    { "A/D",         0 },
+    { "A/D/gamma",   "This is the file 'gamma'.\n" },
+    { "A/D/G",       0 },
+    { "A/D/G/pi",    "This is the file 'pi'.\n" },
+    { "A/D/G/rho",   "Changed file 'rho'.\n" },
+    { "A/D/G/tau",   "This is the file 'tau'.\n" },
+    { "A/D/H",       0 },
+    { "A/D/H/chi",   "This is the file 'chi'.\n" },
+    { "A/D/H/psi",   "This is the file 'psi'.\n" },
+    { "A/D/H/omega", "This is the file 'omega'.\n" },
+    { "A/D/H/zeta",  "This is the file 'zeta'.\n" }
+  };
+
+  SVN_ERR(svn_test__create_fs(&fs, "test-prefetch-tree", opts, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(test_commit_txn(&new_rev, txn, NULL, pool));
+
+  /* Spread the tree across two revisions. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, new_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/G/rho",
+                                      "Changed file 'rho'.\n", pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "A/D/H/zeta", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/H/zeta",
+                                      "This is the file 'zeta'.\n", pool));
+
+  /* Prefetching must be a mere hint, even for txn roots. */
+  SVN_ERR(svn_fs_prefetch_tree(txn_root, "/", NULL, NULL, pool));
+  SVN_ERR(svn_test__validate_tree(txn_root, expected_entries, 21, pool));
+  SVN_ERR(test_commit_txn(&new_rev, txn, NULL, pool));
+
+  /* Prefetch a sub-tree and the whole tree.  The result must not change. */
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, new_rev, pool));
+  SVN_ERR(svn_fs_prefetch_tree(rev_root, "/A/D", NULL, NULL, pool));
+  SVN_ERR(svn_fs_prefetch_tree(rev_root, "/", NULL, NULL, pool));
+  SVN_ERR(svn_test__validate_tree(rev_root, expected_entries, 21, pool));
+
+  /* Files are fine as well. */
+  SVN_ERR(svn_fs_prefetch_tree(rev_root, "/iota", NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* ------------------------------------------------------------------------ */
 
 /* The test table.  */
@@ -7617,6 +7937,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "svn_fs_closest_copy after replacing file with dir"),
     SVN_TEST_OPTS_PASS(test_unrecognized_ioctl,
                        "test svn_fs_ioctl with unrecognized code"),
+    SVN_TEST_OPTS_PASS(test_txn_mutable_node_reuse,
+                       "test many edits and replacements in one txn"),
+    SVN_TEST_OPTS_PASS(test_dir_entries_info,
+                       "test svn_fs_dir_entries_info"),
+    SVN_TEST_OPTS_PASS(test_paths_changed_below,
+                       "test svn_fs_paths_changed_below"),
+    SVN_TEST_OPTS_PASS(test_prefetch_tree,
+                       "test svn_fs_prefetch_tree"),
     SVN_TEST_NULL
   };
 
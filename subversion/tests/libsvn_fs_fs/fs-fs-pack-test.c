@@ -28,11 +28,14 @@
 #include "../../libsvn_fs/fs-loader.h"
 #include "../../libsvn_fs_fs/fs.h"
 #include "../../libsvn_fs_fs/fs_fs.h"
+#include "../../libsvn_fs_fs/lock-index.h"
 #include "../../libsvn_fs_fs/low_level.h"
+#include "../../libsvn_fs_fs/mergeinfo-index.h"
 #include "../../libsvn_fs_fs/pack.h"
 #include "../../libsvn_fs_fs/util.h"
 
 #include "svn_hash.h"
+#include "svn_mergeinfo.h"
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
@@ -191,7 +194,7 @@ create_packed_filesystem(const char *dir,
   /* Now pack the FS */
   pnb.expected_shard = 0;
   pnb.expected_action = svn_fs_pack_notify_start;
-  return svn_fs_pack(dir, pack_notify, &pnb, NULL, NULL, pool);
+  return svn_fs_pack2(dir, 1, pack_notify, &pnb, NULL, NULL, pool);
 }
 
 /* Create a packed FSFS filesystem for revprop tests at REPO_NAME with
@@ -226,7 +229,7 @@ prepare_revprop_repo(svn_fs_t **fs,
   svn_pool_destroy(subpool);
 
   /* Pack the repository. */
-  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(repo_name, 1, NULL, NULL, NULL, NULL, pool));
 
   return SVN_NO_ERROR;
 }
@@ -663,7 +666,7 @@ recover_fully_packed(const svn_test_opts_t *opts,
   SVN_ERR(svn_fs_commit_txn(&conflict, &after_rev, txn, subpool));
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(after_rev));
   svn_pool_destroy(subpool);
-  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(REPO_NAME, 1, NULL, NULL, NULL, NULL, pool));
   SVN_ERR(svn_fs_recover(REPO_NAME, NULL, NULL, pool));
 
   /* Now, delete the youngest revprop file, and recover again.  This
@@ -1002,7 +1005,7 @@ upgrade_txns_to_log_addressing(const svn_test_opts_t *opts,
   /* Pack repo to verify that old and new shard get packed according to
      their respective addressing mode */
 
-  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(repo_name, 1, NULL, NULL, NULL, NULL, pool));
 
   /* verify that our changes got in */
 
@@ -1029,9 +1032,9 @@ upgrade_txns_to_log_addressing(const svn_test_opts_t *opts,
 
   /* verify that the indexes are consistent, we calculated the correct
      low-level checksums etc. */
-  SVN_ERR(svn_fs_verify(repo_name, NULL,
-                        SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
-                        NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_verify2(repo_name, NULL,
+                         SVN_INVALID_REVNUM, SVN_INVALID_REVNUM, 1,
+                         NULL, NULL, NULL, NULL, pool));
   for (; rev >= 0; --rev)
     {
       svn_pool_clear(iterpool);
@@ -1181,6 +1184,71 @@ revprop_caching_on_off(const svn_test_opts_t *opts,
 
 /* ------------------------------------------------------------------------ */
 
+#define REPO_NAME "test-repo-revprop-generation"
+#define SHARD_SIZE 4
+#define MAX_REV 10
+static svn_error_t *
+revprop_generation(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_fs_t *fs1;
+  svn_fs_t *fs2;
+  apr_hash_t *fs_config;
+  svn_string_t *value;
+  svn_string_t *neighbour_value;
+  svn_stringbuf_t *generation;
+  apr_int64_t number;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(prepare_revprop_repo(&fs1, REPO_NAME, MAX_REV, SHARD_SIZE, opts,
+                               pool));
+
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_REVPROPS, "1");
+  SVN_ERR(svn_fs_open2(&fs2, svn_fs_path(fs1, pool), fs_config, pool, pool));
+
+  /* Fill FS2's revprop cache from the pack. */
+  SVN_ERR(svn_fs_revision_prop2(&value, fs2, 5, SVN_PROP_REVISION_AUTHOR,
+                                FALSE, pool, pool));
+  SVN_ERR(svn_fs_revision_prop2(&neighbour_value, fs2, 6,
+                                SVN_PROP_REVISION_DATE, FALSE, pool, pool));
+
+  SVN_ERR(svn_fs_change_rev_prop2(fs1, 5, SVN_PROP_REVISION_AUTHOR, NULL,
+                                  svn_string_create("tweaked", pool),
+                                  pool));
+
+  /* The change must be visible after the next sync barrier, both for the
+   * revision that changed and for its neighbours in the same pack. */
+  SVN_ERR(svn_fs_refresh_revision_props(fs2, pool));
+  SVN_ERR(svn_fs_revision_prop2(&value, fs2, 5, SVN_PROP_REVISION_AUTHOR,
+                                FALSE, pool, pool));
+  SVN_TEST_STRING_ASSERT(value->data, "tweaked");
+  SVN_ERR(svn_fs_revision_prop2(&value, fs2, 5, SVN_PROP_REVISION_AUTHOR,
+                                TRUE, pool, pool));
+  SVN_TEST_STRING_ASSERT(value->data, "tweaked");
+  SVN_ERR(svn_fs_revision_prop2(&value, fs2, 6, SVN_PROP_REVISION_DATE,
+                                FALSE, pool, pool));
+  SVN_TEST_STRING_ASSERT(value->data, neighbour_value->data);
+
+  /* The generation is stable (even) after the change. */
+  SVN_ERR(svn_stringbuf_from_file2(&generation,
+                                   svn_fs_fs__path_revprop_generation(fs1,
+                                                                      pool),
+                                   pool));
+  svn_stringbuf_strip_whitespace(generation);
+  SVN_ERR(svn_cstring_atoi64(&number, generation->data));
+  SVN_TEST_ASSERT(number > 0 && number % 2 == 0);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+
 static svn_error_t *
 id_parser_test(const svn_test_opts_t *opts,
                apr_pool_t *pool)
@@ -1796,16 +1864,79 @@ pack_with_limited_memory(const svn_test_opts_t *opts,
 
       /* Pack it with a narrow memory budget. */
       SVN_ERR(svn_fs_open2(&fs, dir, NULL, iterpool, iterpool));
-      SVN_ERR(svn_fs_fs__pack(fs, max_mem, NULL, NULL, NULL, NULL,
+      SVN_ERR(svn_fs_fs__pack(fs, max_mem, NULL, NULL, NULL, NULL, NULL,
                               iterpool));
 
       /* To be sure: Verify that we didn't break the repo. */
-      SVN_ERR(svn_fs_verify(dir, NULL, 0, MAX_REV, NULL, NULL, NULL, NULL,
-                            iterpool));
+      SVN_ERR(svn_fs_verify2(dir, NULL, 0, MAX_REV, 1, NULL, NULL, NULL, NULL,
+                             iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-pack-with-multiple-jobs"
+#define SHARD_SIZE 3
+#define MAX_REV 53
+static svn_error_t *
+pack_with_multiple_jobs(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  struct pack_notify_baton pnb;
+  svn_fs_t *fs;
+  svn_revnum_t i;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Create the repo and fill it. */
+  SVN_ERR(create_non_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                       pool));
+
+  /* Pack it using multiple threads.  Notifications must still arrive in
+     shard order and no shard may be skipped. */
+  pnb.expected_shard = 0;
+  pnb.expected_action = svn_fs_pack_notify_start;
+  SVN_ERR(svn_fs_pack2(REPO_NAME, 4, pack_notify, &pnb, NULL, NULL, pool));
+  SVN_TEST_ASSERT(pnb.expected_shard == (MAX_REV + 1) / SHARD_SIZE);
+  SVN_TEST_ASSERT(pnb.expected_action == svn_fs_pack_notify_start);
+
+  /* All contents must still be readable. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  for (i = 1; i < (MAX_REV + 1); i++)
+    {
+      svn_fs_root_t *rev_root;
+      svn_stream_t *rstream;
+      svn_stringbuf_t *rstring;
+      svn_stringbuf_t *sb;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, i, iterpool));
+      SVN_ERR(svn_fs_file_contents(&rstream, rev_root, "iota", iterpool));
+      SVN_ERR(svn_test__stream_to_string(&rstring, rstream, iterpool));
+
+      if (i == 1)
+        sb = svn_stringbuf_create("This is the file 'iota'.\n", iterpool);
+      else
+        sb = svn_stringbuf_create(get_rev_contents(i, iterpool), iterpool);
+
+      if (! svn_stringbuf_compare(rstring, sb))
+        return svn_error_createf(SVN_ERR_FS_GENERAL, NULL,
+                                 "Bad data in revision %ld.", i);
     }
 
   svn_pool_destroy(iterpool);
 
+  /* To be sure: Verify that we didn't break the repo. */
+  SVN_ERR(svn_fs_verify2(REPO_NAME, NULL, 0, MAX_REV, 1, NULL, NULL, NULL,
+                         NULL, pool));
+
   return SVN_NO_ERROR;
 }
 #undef REPO_NAME
@@ -1814,6 +1945,156 @@ pack_with_limited_memory(const svn_test_opts_t *opts,
 
 /* ------------------------------------------------------------------------ */
 
+#define REPO_NAME "test-repo-read-mapped-packed-fs"
+#define SHARD_SIZE 5
+#define MAX_REV 11
+static svn_error_t *
+read_mapped_packed_fs(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  apr_hash_t *fs_config;
+  svn_revnum_t i;
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE, pool));
+
+  /* Use block-read and disjoint caches to exercise all mapped code paths. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ, "1");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+
+  /* Old formats can't be packed, just read them as usual. */
+  ffd = fs->fsap_data;
+  if (ffd->format >= SVN_FS_FS__MIN_PACKED_FORMAT)
+    ffd->mmap_packed_files = TRUE;
+
+  for (i = 1; i < (MAX_REV + 1); i++)
+    {
+      svn_fs_root_t *rev_root;
+      svn_stream_t *rstream;
+      svn_stringbuf_t *rstring;
+      svn_stringbuf_t *sb;
+
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, i, pool));
+      SVN_ERR(svn_fs_file_contents(&rstream, rev_root, "iota", pool));
+      SVN_ERR(svn_test__stream_to_string(&rstring, rstream, pool));
+
+      if (i == 1)
+        sb = svn_stringbuf_create("This is the file 'iota'.\n", pool);
+      else
+        sb = svn_stringbuf_create(get_rev_contents(i, pool), pool);
+
+      if (! svn_stringbuf_compare(rstring, sb))
+        return svn_error_createf(SVN_ERR_FS_GENERAL, NULL,
+                                 "Bad data in revision %ld.", i);
+    }
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-index-readahead"
+#define SHARD_SIZE 32
+#define MAX_REV 64
+
+/* Read the contents of 'iota' in all revisions of FS, starting at FIRST
+   and moving by STEP, and compare them with the expected values. */
+static svn_error_t *
+check_iota_contents(svn_fs_t *fs,
+                    svn_revnum_t first,
+                    int step,
+                    apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t i;
+
+  for (i = first; i > 0 && i <= MAX_REV; i += step)
+    {
+      svn_fs_root_t *rev_root;
+      svn_stream_t *rstream;
+      svn_stringbuf_t *rstring;
+      svn_stringbuf_t *sb;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, i, iterpool));
+      SVN_ERR(svn_fs_file_contents(&rstream, rev_root, "iota", iterpool));
+      SVN_ERR(svn_test__stream_to_string(&rstring, rstream, iterpool));
+
+      if (i == 1)
+        sb = svn_stringbuf_create("This is the file 'iota'.\n", iterpool);
+      else
+        sb = svn_stringbuf_create(get_rev_contents(i, iterpool), iterpool);
+
+      if (! svn_stringbuf_compare(rstring, sb))
+        return svn_error_createf(SVN_ERR_FS_GENERAL, NULL,
+                                 "Bad data in revision %ld.", i);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the filesystem at PATH in *FS with block-read enabled and private
+   caches.  Use a tiny block size, such that index read-ahead will span
+   multiple blocks. */
+static svn_error_t *
+open_for_readahead(svn_fs_t **fs,
+                   const char *path,
+                   apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd;
+  apr_hash_t *fs_config = apr_hash_make(pool);
+
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_BLOCK_READ, "1");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_NS,
+                           svn_uuid_generate(pool));
+  SVN_ERR(svn_fs_open2(fs, path, fs_config, pool, pool));
+
+  ffd = (*fs)->fsap_data;
+  ffd->block_size = 0x400;
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+index_readahead(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE, pool));
+
+  /* Read-ahead only applies to log-addressed repositories. */
+  SVN_ERR(open_for_readahead(&fs, REPO_NAME, pool));
+  if (!svn_fs_fs__use_log_addressing(fs))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "requires log addressing");
+
+  /* Sequential access, potentially reading ahead ... */
+  SVN_ERR(check_iota_contents(fs, 1, 1, pool));
+
+  /* ... and random access must produce the same results. */
+  SVN_ERR(open_for_readahead(&fs, REPO_NAME, pool));
+  SVN_ERR(check_iota_contents(fs, MAX_REV, -7, pool));
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+
 #define REPO_NAME "test-repo-large_delta_against_plain"
 
 static svn_error_t *
@@ -1888,6 +2169,646 @@ large_delta_against_plain(const svn_test_opts_t *opts,
 
 #undef REPO_NAME
 
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-paths-changed-range"
+#define SHARD_SIZE 4
+#define MAX_REV 10
+
+/* Baton type used by changes_range_receiver. */
+typedef struct changes_range_baton_t
+{
+  /* Filesystem to compare against. */
+  svn_fs_t *fs;
+
+  /* Revision that we expect to be reported next. */
+  svn_revnum_t expected;
+
+  /* +1 for ascending order, -1 for descending order. */
+  int step;
+} changes_range_baton_t;
+
+/* Implements svn_fs_changes_receiver_t.  Verify that the changes reported
+ * in ITERATOR for REVISION match those returned by svn_fs_paths_changed3
+ * for that revision.  BATON is a changes_range_baton_t. */
+static svn_error_t *
+changes_range_receiver(void *baton,
+                       svn_revnum_t revision,
+                       svn_fs_path_change_iterator_t *iterator,
+                       apr_pool_t *scratch_pool)
+{
+  changes_range_baton_t *b = baton;
+  svn_fs_root_t *root;
+  svn_fs_path_change_iterator_t *expected_iterator;
+  svn_fs_path_change3_t *change, *expected_change;
+
+  SVN_TEST_ASSERT(revision == b->expected);
+  b->expected += b->step;
+
+  SVN_ERR(svn_fs_revision_root(&root, b->fs, revision, scratch_pool));
+  SVN_ERR(svn_fs_paths_changed3(&expected_iterator, root, scratch_pool,
+                                scratch_pool));
+
+  do
+    {
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+      SVN_ERR(svn_fs_path_change_get(&expected_change, expected_iterator));
+
+      SVN_TEST_ASSERT((change == NULL) == (expected_change == NULL));
+      if (change)
+        {
+          SVN_TEST_STRING_ASSERT(change->path.data,
+                                 expected_change->path.data);
+          SVN_TEST_ASSERT(change->change_kind
+                          == expected_change->change_kind);
+          SVN_TEST_ASSERT(change->node_kind == expected_change->node_kind);
+        }
+    }
+  while (change);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+paths_changed_range(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  changes_range_baton_t baton;
+
+  /* Pack all but the last, incomplete shard such that the range spans
+   * packed as well as non-packed revisions. */
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  baton.fs = fs;
+
+  /* Ascending order. */
+  baton.expected = 0;
+  baton.step = 1;
+  SVN_ERR(svn_fs_paths_changed_range(fs, 0, MAX_REV,
+                                     changes_range_receiver, &baton,
+                                     NULL, NULL, pool));
+  SVN_TEST_ASSERT(baton.expected == MAX_REV + 1);
+
+  /* Descending order, starting and ending within a shard. */
+  baton.expected = MAX_REV - 1;
+  baton.step = -1;
+  SVN_ERR(svn_fs_paths_changed_range(fs, MAX_REV - 1, 2,
+                                     changes_range_receiver, &baton,
+                                     NULL, NULL, pool));
+  SVN_TEST_ASSERT(baton.expected == 1);
+
+  /* A single revision. */
+  baton.expected = 5;
+  baton.step = 1;
+  SVN_ERR(svn_fs_paths_changed_range(fs, 5, 5,
+                                     changes_range_receiver, &baton,
+                                     NULL, NULL, pool));
+  SVN_TEST_ASSERT(baton.expected == 6);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-txn-id-blocks"
+#define BLOCK_SIZE 8
+/* Return the value stored in FS's txn-current file in *VALUE.
+   Use POOL for allocations. */
+static svn_error_t *
+read_txn_current(apr_uint64_t *value,
+                 svn_fs_t *fs,
+                 apr_pool_t *pool)
+{
+  svn_stringbuf_t *content;
+  SVN_ERR(svn_stringbuf_from_file2(&content,
+                                   svn_fs_fs__path_txn_current(fs, pool),
+                                   pool));
+  *value = svn__base36toui64(NULL, content->data);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+txn_id_blocks(const svn_test_opts_t *opts,
+              apr_pool_t *pool)
+{
+  svn_fs_t *fs, *fs2;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  apr_uint64_t start, value;
+  apr_hash_t *names = apr_hash_make(pool);
+  const char *name;
+  int i;
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_TXN_CURRENT_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.5 formats don't use txn-current");
+
+  ffd->txn_id_block_size = BLOCK_SIZE;
+  SVN_ERR(read_txn_current(&start, fs, pool));
+
+  /* The first txn reserves a whole block of numbers. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_name(&name, txn, pool));
+  svn_hash_sets(names, name, name);
+  SVN_ERR(read_txn_current(&value, fs, pool));
+  SVN_TEST_ASSERT(value == start + BLOCK_SIZE);
+
+  /* Other svn_fs_t instances in this process share that block.
+     Their txns don't need to touch txn-current. */
+  SVN_ERR(svn_fs_open2(&fs2, REPO_NAME, NULL, pool, pool));
+  ffd = fs2->fsap_data;
+  ffd->txn_id_block_size = BLOCK_SIZE;
+  for (i = 1; i < BLOCK_SIZE; ++i)
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, i % 2 ? fs2 : fs, 0, pool));
+      SVN_ERR(svn_fs_txn_name(&name, txn, pool));
+      SVN_TEST_ASSERT(svn_hash_gets(names, name) == NULL);
+      svn_hash_sets(names, name, name);
+    }
+
+  SVN_ERR(read_txn_current(&value, fs, pool));
+  SVN_TEST_ASSERT(value == start + BLOCK_SIZE);
+
+  /* Once the block has been used up, the next one gets reserved. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_name(&name, txn, pool));
+  SVN_TEST_ASSERT(svn_hash_gets(names, name) == NULL);
+  SVN_ERR(read_txn_current(&value, fs, pool));
+  SVN_TEST_ASSERT(value == start + 2 * BLOCK_SIZE);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef BLOCK_SIZE
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-large-dir-index"
+#define ENTRY_COUNT 1200
+static svn_error_t *
+large_dir_index(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  svn_node_kind_t kind;
+  svn_cache__t *dir_cache;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Create a directory with many entries. */
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  ffd = fs->fsap_data;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, "big", pool));
+  for (i = 0; i < ENTRY_COUNT; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_make_file(root,
+                               apr_psprintf(iterpool, "big/f%04d", i),
+                               iterpool));
+    }
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Without directory caches, the directory gets indexed upon lookup. */
+  dir_cache = ffd->dir_cache;
+  ffd->dir_cache = NULL;
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/f0042", pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_TEST_ASSERT(ffd->large_dir != NULL);
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/none", pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  /* Modify it in a txn.  The index must follow those changes. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  ffd->txn_dir_cache = NULL;
+
+  SVN_ERR(svn_fs_delete(root, "big/f0500", pool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/f0500", pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  SVN_ERR(svn_fs_make_dir(root, "big/new", pool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/new", pool));
+  SVN_TEST_ASSERT(kind == svn_node_dir);
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/f0501", pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  /* The commit itself expects the cache to be present. */
+  ffd->dir_cache = dir_cache;
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Verify the committed result. */
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/f0500", pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/new", pool));
+  SVN_TEST_ASSERT(kind == svn_node_dir);
+  SVN_ERR(svn_fs_check_path(&kind, root, "big/f0999", pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef ENTRY_COUNT
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-packed-dir-cache"
+#define ENTRY_COUNT 100
+
+/* Return the name of the I-th entry in the test directory.  The names
+ * share prefixes of varying length and sort in the order of I. */
+static const char *
+packed_dir_entry_name(int i,
+                      apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "entry_%s_%03d", i % 2 ? "long_suffix" : "s", i);
+}
+
+static svn_error_t *
+packed_dir_cache(const svn_test_opts_t *opts,
+                 apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  svn_node_kind_t kind;
+  apr_hash_t *entries;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i, pass;
+
+  /* Create a directory with some files and sub-directories. */
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, "dir", pool));
+  for (i = 0; i < ENTRY_COUNT; ++i)
+    {
+      const char *path;
+
+      svn_pool_clear(iterpool);
+      path = svn_relpath_join("dir", packed_dir_entry_name(i, iterpool),
+                              iterpool);
+      if (i % 3)
+        SVN_ERR(svn_fs_make_file(root, path, iterpool));
+      else
+        SVN_ERR(svn_fs_make_dir(root, path, iterpool));
+    }
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Look up every entry, once before and once after the whole directory
+   * has been read into the cache. */
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  for (pass = 0; pass < 2; ++pass)
+    {
+      for (i = 0; i < ENTRY_COUNT; ++i)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(svn_fs_check_path(&kind, root,
+                                    svn_relpath_join(
+                                      "dir",
+                                      packed_dir_entry_name(i, iterpool),
+                                      iterpool),
+                                    iterpool));
+          SVN_TEST_ASSERT(kind == (i % 3 ? svn_node_file : svn_node_dir));
+        }
+
+      /* Names before, between and after the existing ones. */
+      SVN_ERR(svn_fs_check_path(&kind, root, "dir/a", pool));
+      SVN_TEST_ASSERT(kind == svn_node_none);
+      SVN_ERR(svn_fs_check_path(&kind, root, "dir/entry_s", pool));
+      SVN_TEST_ASSERT(kind == svn_node_none);
+      SVN_ERR(svn_fs_check_path(&kind, root, "dir/entry_s_0000", pool));
+      SVN_TEST_ASSERT(kind == svn_node_none);
+      SVN_ERR(svn_fs_check_path(&kind, root, "dir/z", pool));
+      SVN_TEST_ASSERT(kind == svn_node_none);
+
+      SVN_ERR(svn_fs_dir_entries(&entries, root, "dir", pool));
+      SVN_TEST_ASSERT(apr_hash_count(entries) == ENTRY_COUNT);
+    }
+
+  /* The listing must match the individual nodes. */
+  for (i = 0; i < ENTRY_COUNT; ++i)
+    {
+      const char *name;
+      svn_fs_dirent_t *dirent;
+      const svn_fs_id_t *id;
+
+      svn_pool_clear(iterpool);
+      name = packed_dir_entry_name(i, iterpool);
+      dirent = svn_hash_gets(entries, name);
+      SVN_TEST_ASSERT(dirent != NULL);
+      SVN_TEST_STRING_ASSERT(dirent->name, name);
+      SVN_TEST_ASSERT(dirent->kind
+                      == (i % 3 ? svn_node_file : svn_node_dir));
+
+      SVN_ERR(svn_fs_node_id(&id, root, svn_relpath_join("dir", name,
+                                                         iterpool),
+                             iterpool));
+      SVN_TEST_ASSERT(svn_fs_compare_ids(id, dirent->id) == 0);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef ENTRY_COUNT
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-mergeinfo-index"
+
+/* Implements svn_fs_mergeinfo_receiver_t, collecting MERGEINFO for PATH
+   in the catalog BATON. */
+static svn_error_t *
+collect_mergeinfo(const char *path,
+                  svn_mergeinfo_t mergeinfo,
+                  void *baton,
+                  apr_pool_t *scratch_pool)
+{
+  svn_mergeinfo_catalog_t catalog = baton;
+  apr_pool_t *pool = apr_hash_pool_get(catalog);
+
+  svn_hash_sets(catalog, apr_pstrdup(pool, path),
+                svn_mergeinfo_dup(mergeinfo, pool));
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+mergeinfo_index(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  svn_node_kind_t kind;
+  svn_boolean_t found;
+  svn_mergeinfo_t mergeinfo;
+  svn_string_t *mergeinfo_string;
+  svn_mergeinfo_catalog_t catalog = apr_hash_make(pool);
+  apr_array_header_t *paths = apr_array_make(pool, 2, sizeof(const char *));
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_MERGEINFO_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.5 formats don't track mergeinfo");
+
+  ffd->mergeinfo_index = TRUE;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, "A", pool));
+  SVN_ERR(svn_fs_make_dir(root, "A/B", pool));
+  SVN_ERR(svn_fs_change_node_prop(root, "A", SVN_PROP_MERGEINFO,
+                                  svn_string_create("/trunk:1", pool),
+                                  pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Answering a query fills the index - including the paths that don't
+     have any mergeinfo. */
+  APR_ARRAY_PUSH(paths, const char *) = "/A/B";
+  APR_ARRAY_PUSH(paths, const char *) = "/";
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs_get_mergeinfo3(root, paths, svn_mergeinfo_inherited,
+                                FALSE, TRUE, collect_mergeinfo, catalog,
+                                pool));
+  SVN_TEST_ASSERT(apr_hash_count(catalog) == 1);
+  SVN_ERR(svn_mergeinfo_to_string(&mergeinfo_string,
+                                  svn_hash_gets(catalog, "/A/B"), pool));
+  SVN_TEST_STRING_ASSERT(mergeinfo_string->data, "/trunk/B:1");
+
+  SVN_ERR(svn_io_check_path(svn_dirent_join(fs->path,
+                                            MERGEINFO_INDEX_DB_NAME, pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+
+  SVN_ERR(svn_fs_fs__get_indexed_mergeinfo(&found, &mergeinfo, fs, rev,
+                                           "/A/B", svn_mergeinfo_inherited,
+                                           TRUE, pool, pool));
+  SVN_TEST_ASSERT(found && mergeinfo);
+  SVN_ERR(svn_mergeinfo_to_string(&mergeinfo_string, mergeinfo, pool));
+  SVN_TEST_STRING_ASSERT(mergeinfo_string->data, "/trunk/B:1");
+
+  SVN_ERR(svn_fs_fs__get_indexed_mergeinfo(&found, &mergeinfo, fs, rev,
+                                           "/", svn_mergeinfo_inherited,
+                                           TRUE, pool, pool));
+  SVN_TEST_ASSERT(found && !mergeinfo);
+
+  /* Other kinds of query are separate entries. */
+  SVN_ERR(svn_fs_fs__get_indexed_mergeinfo(&found, &mergeinfo, fs, rev,
+                                           "/A/B", svn_mergeinfo_explicit,
+                                           TRUE, pool, pool));
+  SVN_TEST_ASSERT(!found);
+
+  /* Entries for revisions that are gone get dropped. */
+  SVN_ERR(svn_fs_fs__prune_mergeinfo_index(fs, rev - 1, pool));
+  SVN_ERR(svn_fs_fs__get_indexed_mergeinfo(&found, &mergeinfo, fs, rev,
+                                           "/A/B", svn_mergeinfo_inherited,
+                                           TRUE, pool, pool));
+  SVN_TEST_ASSERT(!found);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-lock-index"
+
+/* Implements svn_fs_get_locks_callback_t, counting locks in the int
+   BATON. */
+static svn_error_t *
+count_locks(void *baton,
+            svn_lock_t *lock,
+            apr_pool_t *pool)
+{
+  int *count = baton;
+
+  ++*count;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+lock_index(const svn_test_opts_t *opts,
+           apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  svn_fs_access_t *access;
+  svn_lock_t *lock, *lock_f1;
+  svn_node_kind_t kind;
+  svn_boolean_t usable;
+  apr_array_header_t *locks;
+  int count;
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  ffd = fs->fsap_data;
+
+  SVN_ERR(svn_fs_create_access(&access, "user", pool));
+  SVN_ERR(svn_fs_set_access(fs, access));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(root, "A", pool));
+  SVN_ERR(svn_fs_make_file(root, "A/f1", pool));
+  SVN_ERR(svn_fs_make_file(root, "A/f2", pool));
+  SVN_ERR(svn_fs_make_dir(root, "AB", pool));
+  SVN_ERR(svn_fs_make_file(root, "AB/f3", pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Locks taken before the index gets enabled must end up in it, too. */
+  SVN_ERR(svn_fs_lock(&lock_f1, fs, "/A/f1", NULL, "c1", FALSE, 0, rev,
+                      FALSE, pool));
+  ffd->lock_index = TRUE;
+  SVN_ERR(svn_fs_fs__lock_index_usable(&usable, fs, pool));
+  SVN_TEST_ASSERT(!usable);
+
+  SVN_ERR(svn_fs_lock(&lock, fs, "/A/f2", NULL, NULL, FALSE, 0, rev,
+                      FALSE, pool));
+  SVN_ERR(svn_fs_lock(&lock, fs, "/AB/f3", NULL, NULL, FALSE, 0, rev,
+                      FALSE, pool));
+
+  SVN_ERR(svn_io_check_path(svn_dirent_join(fs->path, LOCK_INDEX_DB_NAME,
+                                            pool),
+                            &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_ERR(svn_fs_fs__lock_index_usable(&usable, fs, pool));
+  SVN_TEST_ASSERT(usable);
+
+  SVN_ERR(svn_fs_fs__get_indexed_lock(&lock, fs, "/A/f1", pool));
+  SVN_TEST_ASSERT(lock);
+  SVN_TEST_STRING_ASSERT(lock->token, lock_f1->token);
+  SVN_TEST_STRING_ASSERT(lock->owner, "user");
+  SVN_TEST_STRING_ASSERT(lock->comment, "c1");
+  SVN_TEST_ASSERT(lock->creation_date == lock_f1->creation_date);
+
+  /* Range queries must not pick up siblings sharing a name prefix. */
+  SVN_ERR(svn_fs_fs__get_indexed_locks(&locks, fs, "/A", pool));
+  SVN_TEST_ASSERT(locks->nelts == 2);
+  SVN_ERR(svn_fs_fs__get_indexed_locks(&locks, fs, "/", pool));
+  SVN_TEST_ASSERT(locks->nelts == 3);
+
+  count = 0;
+  SVN_ERR(svn_fs_get_locks2(fs, "/A", svn_depth_infinity, count_locks,
+                            &count, pool));
+  SVN_TEST_ASSERT(count == 2);
+
+  /* Unlocking updates the index. */
+  SVN_ERR(svn_fs_unlock(fs, "/A/f1", lock_f1->token, FALSE, pool));
+  SVN_ERR(svn_fs_fs__get_indexed_lock(&lock, fs, "/A/f1", pool));
+  SVN_TEST_ASSERT(!lock);
+  SVN_ERR(svn_fs_get_lock(&lock, fs, "/A/f1", pool));
+  SVN_TEST_ASSERT(!lock);
+
+  count = 0;
+  SVN_ERR(svn_fs_get_locks2(fs, "/", svn_depth_infinity, count_locks,
+                            &count, pool));
+  SVN_TEST_ASSERT(count == 2);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-verify-with-multiple-jobs"
+#define SHARD_SIZE 3
+#define MAX_REV 22
+
+/* Baton for verify_notify(). */
+struct verify_notify_baton
+{
+  svn_revnum_t last_rev;
+  svn_boolean_t out_of_order;
+};
+
+/* Implements svn_fs_progress_notify_func_t. */
+static void
+verify_notify(svn_revnum_t revision,
+              void *baton,
+              apr_pool_t *pool)
+{
+  struct verify_notify_baton *vnb = baton;
+
+  if (revision < vnb->last_rev)
+    vnb->out_of_order = TRUE;
+  vnb->last_rev = revision;
+}
+
+static svn_error_t *
+verify_with_multiple_jobs(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  struct verify_notify_baton vnb = { SVN_INVALID_REVNUM, FALSE };
+  svn_fs_t *fs;
+  const char *pack_path;
+  svn_stringbuf_t *pack_contents;
+  svn_error_t *err;
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (opts->server_minor_version && (opts->server_minor_version < 9))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.9 SVN doesn't have index metadata");
+
+  /* Some packed shards and a few non-packed revisions. */
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  if (!svn_fs_fs__use_log_addressing(fs))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "requires log addressing");
+
+  /* Notifications must arrive in ascending order. */
+  SVN_ERR(svn_fs_verify2(REPO_NAME, NULL, 0, MAX_REV, 4,
+                         verify_notify, &vnb, NULL, NULL, pool));
+  SVN_TEST_ASSERT(!vnb.out_of_order);
+  SVN_TEST_ASSERT(vnb.last_rev >= MAX_REV - SHARD_SIZE);
+
+  /* Damage one of the pack files.  The checksums must catch that. */
+  pack_path = svn_fs_fs__path_rev_packed(fs, SHARD_SIZE, PATH_PACKED, pool);
+  SVN_ERR(svn_stringbuf_from_file2(&pack_contents, pack_path, pool));
+  pack_contents->data[pack_contents->len / 4] ^= 0x55;
+  SVN_ERR(svn_io_write_atomic2(pack_path, pack_contents->data,
+                               pack_contents->len, NULL, FALSE, pool));
+
+  err = svn_fs_verify2(REPO_NAME, NULL, 0, MAX_REV, 4,
+                       NULL, NULL, NULL, NULL, pool);
+  SVN_TEST_ASSERT_ANY_ERROR(err);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+#undef MAX_REV
+#undef SHARD_SIZE
+
+/* ------------------------------------------------------------------------ */
 
 
 /* The test table.  */
@@ -1929,6 +2850,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "metadata checksums being checked"),
     SVN_TEST_OPTS_PASS(revprop_caching_on_off,
                        "change revprops with enabled and disabled caching"),
+    SVN_TEST_OPTS_PASS(revprop_generation,
+                       "revprop cache invalidation by generation"),
     SVN_TEST_OPTS_PASS(id_parser_test,
                        "id parser test"),
     SVN_TEST_OPTS_PASS(plain_0_length,
@@ -1943,6 +2866,26 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(pack_with_multiple_jobs,
+                       "pack FSFS using multiple worker threads"),
+    SVN_TEST_OPTS_PASS(read_mapped_packed_fs,
+                       "read from memory-mapped FSFS pack files"),
+    SVN_TEST_OPTS_PASS(index_readahead,
+                       "index read-ahead for sequential access"),
+    SVN_TEST_OPTS_PASS(paths_changed_range,
+                       "read changed paths of a revision range"),
+    SVN_TEST_OPTS_PASS(txn_id_blocks,
+                       "allocate txn IDs from reserved blocks"),
+    SVN_TEST_OPTS_PASS(large_dir_index,
+                       "index directories too large for the caches"),
+    SVN_TEST_OPTS_PASS(packed_dir_cache,
+                       "cache committed directories in packed format"),
+    SVN_TEST_OPTS_PASS(mergeinfo_index,
+                       "persistent mergeinfo index"),
+    SVN_TEST_OPTS_PASS(lock_index,
+                       "indexed lock storage"),
+    SVN_TEST_OPTS_PASS(verify_with_multiple_jobs,
+                       "verify FSFS metadata using multiple threads"),
     SVN_TEST_NULL
   };
 
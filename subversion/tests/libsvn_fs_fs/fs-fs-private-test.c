@@ -258,6 +258,42 @@ get_repo_stats(const svn_test_opts_t *opts,
   SVN_ERR(verify_histogram(&stats->dir_rep_histogram));
   SVN_ERR(verify_histogram(&stats->dir_prop_histogram));
   SVN_ERR(verify_histogram(&stats->dir_prop_rep_histogram));
+  SVN_ERR(verify_histogram(&stats->chain_length_histogram));
+
+  /* The chain length histogram covers each representation exactly once. */
+  SVN_TEST_ASSERT(stats->chain_length_histogram.total.count
+                  == stats->total_rep_stats.total.count);
+  SVN_TEST_ASSERT(stats->chain_length_histogram.total.sum
+                  == stats->total_rep_stats.chain_len);
+
+  /* Every Greek tree file has been added as PLAIN in r1, so reading its
+   * latest text means reading just that one representation. */
+  SVN_ERR(verify_histogram(&stats->head_chain_length_histogram));
+  SVN_ERR(verify_histogram(&stats->head_reconstruct_histogram));
+  SVN_ERR(verify_histogram(&stats->head_shard_histogram));
+  SVN_TEST_ASSERT(stats->head_chain_length_histogram.total.count == 12);
+  SVN_TEST_ASSERT(stats->head_chain_length_histogram.total.sum == 12);
+  SVN_TEST_ASSERT(stats->head_shard_histogram.total.sum == 12);
+  SVN_TEST_ASSERT(stats->head_reconstruct_size
+                  == stats->file_rep_stats.total.packed_size);
+  SVN_TEST_ASSERT(stats->delta_count == 0);
+  SVN_TEST_ASSERT(stats->cross_shard_delta_count == 0);
+
+  SVN_TEST_ASSERT(stats->costly_paths->nelts == 12);
+  SVN_TEST_ASSERT(stats->hot_paths->nelts == 12);
+  for (i = 0; i < stats->costly_paths->nelts; ++i)
+    {
+      const svn_fs_fs__path_cost_t *cost
+        = APR_ARRAY_IDX(stats->costly_paths, i, svn_fs_fs__path_cost_t *);
+
+      SVN_TEST_ASSERT(cost->chain_length == 1);
+      SVN_TEST_ASSERT(cost->change_count == 1);
+      SVN_TEST_ASSERT(cost->revision == rev);
+      if (i > 0)
+        SVN_TEST_ASSERT(cost->reconstruct_size
+          <= APR_ARRAY_IDX(stats->costly_paths, i - 1,
+                           svn_fs_fs__path_cost_t *)->reconstruct_size);
+    }
 
   /* No file in the Greek tree has an externsion */
   SVN_TEST_ASSERT(apr_hash_count(stats->by_extension) == 1);
@@ -424,8 +460,8 @@ load_index(const svn_test_opts_t *opts, apr_pool_t *pool)
   SVN_ERR(svn_fs_ioctl(svn_repos_fs(repos), SVN_FS_FS__IOCTL_LOAD_INDEX,
                        &load_input, NULL, NULL, NULL, pool, pool));
 
-  SVN_TEST_ASSERT_ERROR(svn_repos_verify_fs3(repos, rev, rev, FALSE, FALSE,
-                                             NULL, NULL, NULL, NULL, NULL,
+  SVN_TEST_ASSERT_ERROR(svn_repos_verify_fs4(repos, rev, rev, FALSE, FALSE,
+                                             1, NULL, NULL, NULL, NULL, NULL,
                                              NULL, pool),
                         SVN_ERR_FS_INDEX_CORRUPTION);
 
@@ -434,7 +470,7 @@ load_index(const svn_test_opts_t *opts, apr_pool_t *pool)
   load_input.entries = entries;
   SVN_ERR(svn_fs_ioctl(svn_repos_fs(repos), SVN_FS_FS__IOCTL_LOAD_INDEX,
                        &load_input, NULL, NULL, NULL, pool, pool));
-  SVN_ERR(svn_repos_verify_fs3(repos, rev, rev, FALSE, FALSE, NULL, NULL,
+  SVN_ERR(svn_repos_verify_fs4(repos, rev, rev, FALSE, FALSE, 1, NULL, NULL,
                                NULL, NULL, NULL, NULL, pool));
 
   return SVN_NO_ERROR;
@@ -493,8 +529,189 @@ build_rep_cache(const svn_test_opts_t *opts, apr_pool_t *pool)
   SVN_ERR(svn_fs_fs__exists_rep_cache(&exists, fs, pool));
   SVN_TEST_ASSERT(exists);
 
-  SVN_ERR(svn_fs_verify(fs_path, NULL, 0, SVN_INVALID_REVNUM,
-                        NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_verify2(fs_path, NULL, 0, SVN_INVALID_REVNUM, 1, NULL, NULL,
+                         NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Baton for build_rep_cache_progress(). */
+typedef struct build_rep_cache_progress_baton_t
+{
+  svn_revnum_t last_rev;
+  svn_boolean_t out_of_order;
+} build_rep_cache_progress_baton_t;
+
+/* Implements svn_fs_progress_notify_func_t.  Check that revisions get
+ * reported strictly in ascending order. */
+static void
+build_rep_cache_progress(svn_revnum_t revision,
+                         void *baton,
+                         apr_pool_t *pool)
+{
+  build_rep_cache_progress_baton_t *b = baton;
+
+  if (revision != b->last_rev + 1)
+    b->out_of_order = TRUE;
+
+  b->last_rev = revision;
+}
+
+static svn_error_t *
+build_rep_cache_jobs(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  build_rep_cache_progress_baton_t progress = { 0 };
+  int i;
+  const char *fs_path;
+  representation_t *rep;
+  svn_checksum_t *checksum;
+  svn_fs_fs__ioctl_build_rep_cache_input_t input = {0};
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support FSFS rep-sharing");
+
+  /* Create a filesystem and explicitly disable rep-sharing. */
+  fs_path = "test-repo-build-rep-cache-jobs-test";
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, pool));
+  ffd = fs->fsap_data;
+  ffd->rep_sharing_allowed = FALSE;
+
+  /* Add the Greek tree and modify it in a number of revisions. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  for (i = 0; i < 20; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(iterpool,
+                                                       "iota %d\n", i),
+                                          iterpool));
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, iterpool));
+    }
+
+  /* Build the rep-cache using a number of workers. */
+  ffd->rep_sharing_allowed = TRUE;
+
+  input.start_rev = 1;
+  input.end_rev = rev;
+  input.jobs = 4;
+  input.progress_func = build_rep_cache_progress;
+  input.progress_baton = &progress;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_REP_CACHE,
+                       &input, NULL, NULL, NULL, pool, pool));
+
+  /* All revisions must have been reported, in order. */
+  SVN_TEST_ASSERT(!progress.out_of_order);
+  SVN_TEST_INT_ASSERT(progress.last_rev, rev);
+
+  /* The latest file contents must be in the rep-cache. */
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, "iota 19\n",
+                       strlen("iota 19\n"), pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep != NULL);
+  SVN_TEST_INT_ASSERT(rep->revision, rev);
+
+  /* Resuming an overlapping range must be harmless. */
+  input.start_rev = rev - 2;
+  input.progress_func = NULL;
+  input.progress_baton = NULL;
+  SVN_ERR(svn_fs_ioctl(fs, SVN_FS_FS__IOCTL_BUILD_REP_CACHE,
+                       &input, NULL, NULL, NULL, pool, pool));
+
+  SVN_ERR(svn_fs_verify2(fs_path, NULL, 0, SVN_INVALID_REVNUM, 1, NULL, NULL,
+                         NULL, NULL, pool));
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
+static svn_error_t *
+rep_cache_filter(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_fs_t *fs, *fs2;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+  representation_t *rep;
+  svn_checksum_t *checksum;
+  const char *fs_path = "test-repo-rep-cache-filter-test";
+  const char *iota_contents = "This is the file 'iota'.\n";
+  const char *new_contents = "Added by another process.\n";
+
+  /* Bail (with success) on known-untestable scenarios */
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this will test FSFS repositories only");
+
+  if (opts->server_minor_version && (opts->server_minor_version < 6))
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "pre-1.6 SVN doesn't support FSFS rep-sharing");
+
+  /* Create a filesystem with rep-sharing and the filter enabled. */
+  SVN_ERR(svn_test__create_fs2(&fs, fs_path, opts, NULL, pool));
+  ffd = fs->fsap_data;
+  ffd->rep_sharing_allowed = TRUE;
+  ffd->rep_cache_filter = TRUE;
+
+  /* Add the Greek tree. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Known contents must still be found, unknown ones must not. */
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, iota_contents,
+                       strlen(iota_contents), pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep != NULL);
+  SVN_TEST_ASSERT(rep->revision == rev);
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, new_contents,
+                       strlen(new_contents), pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep == NULL);
+
+  /* Commit through an instance that does not use the filter.
+     To the filter, this is just like a commit by some other process. */
+  SVN_ERR(svn_fs_open2(&fs2, fs_path, NULL, pool, pool));
+  ffd = fs2->fsap_data;
+  ffd->rep_cache_filter = FALSE;
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs2, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "new", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "new", new_contents, pool));
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(rev));
+
+  /* Once we know about the new revision, the filter catches up. */
+  SVN_ERR(svn_fs_youngest_rev(&rev, fs, pool));
+  SVN_ERR(svn_fs_fs__get_rep_reference(&rep, fs, checksum, pool));
+  SVN_TEST_ASSERT(rep != NULL);
+  SVN_TEST_ASSERT(rep->revision == rev);
 
   return SVN_NO_ERROR;
 }
@@ -516,6 +733,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "load the P2L index"),
     SVN_TEST_OPTS_PASS(build_rep_cache,
                        "build the representation cache"),
+    SVN_TEST_OPTS_PASS(build_rep_cache_jobs,
+                       "test concurrent build-repcache"),
+    SVN_TEST_OPTS_PASS(rep_cache_filter,
+                       "skip rep-cache lookups using a Bloom filter"),
     SVN_TEST_NULL
   };
 
@@ -25,13 +25,17 @@
 #include <apr_pools.h>
 
 #include "../svn_test.h"
-#include "../../libsvn_fs_x/batch_fsync.h"
 #include "../../libsvn_fs_x/fs.h"
+#include "../../libsvn_fs_x/cached_data.h"
+#include "../../libsvn_fs_x/dag_cache.h"
+#include "../../libsvn_fs_x/util.h"
 #include "../../libsvn_fs_x/reps.h"
 
+#include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
+#include "private/svn_batch_fsync.h"
 #include "private/svn_string_private.h"
 
 #include "../svn_test_fs.h"
@@ -116,17 +120,16 @@ pack_notify(void *baton,
 
 #define R1_LOG_MSG "Let's serf"
 
-/* Create a packed filesystem in DIR.  Set the shard size to
-   SHARD_SIZE and create NUM_REVS number of revisions (in addition to
-   r0).  Use POOL for allocations.  After this function successfully
-   completes, the filesystem's youngest revision number will be the
-   same as NUM_REVS.  */
+/* Create a filesystem in DIR.  Set the shard size to SHARD_SIZE and
+   create NUM_REVS number of revisions (in addition to r0).  Use POOL for
+   allocations.  After this function successfully completes, the
+   filesystem's youngest revision number will be NUM_REVS.  */
 static svn_error_t *
-create_packed_filesystem(const char *dir,
-                         const svn_test_opts_t *opts,
-                         int num_revs,
-                         int shard_size,
-                         apr_pool_t *pool)
+create_non_packed_filesystem(const char *dir,
+                             const svn_test_opts_t *opts,
+                             int num_revs,
+                             int shard_size,
+                             apr_pool_t *pool)
 {
   svn_fs_t *fs;
   svn_fs_txn_t *txn;
@@ -134,7 +137,6 @@ create_packed_filesystem(const char *dir,
   const char *conflict;
   svn_revnum_t after_rev;
   apr_pool_t *subpool = svn_pool_create(pool);
-  struct pack_notify_baton pnb;
   apr_pool_t *iterpool;
   int version;
 
@@ -189,10 +191,31 @@ create_packed_filesystem(const char *dir,
   svn_pool_destroy(iterpool);
   svn_pool_destroy(subpool);
 
+  return SVN_NO_ERROR;
+}
+
+/* Create a packed filesystem in DIR.  Set the shard size to
+   SHARD_SIZE and create NUM_REVS number of revisions (in addition to
+   r0).  Use POOL for allocations.  After this function successfully
+   completes, the filesystem's youngest revision number will be the
+   same as NUM_REVS.  */
+static svn_error_t *
+create_packed_filesystem(const char *dir,
+                         const svn_test_opts_t *opts,
+                         int num_revs,
+                         int shard_size,
+                         apr_pool_t *pool)
+{
+  struct pack_notify_baton pnb;
+
+  /* Create the repo and fill it. */
+  SVN_ERR(create_non_packed_filesystem(dir, opts, num_revs, shard_size,
+                                       pool));
+
   /* Now pack the FS */
   pnb.expected_shard = 0;
   pnb.expected_action = svn_fs_pack_notify_start;
-  return svn_fs_pack(dir, pack_notify, &pnb, NULL, NULL, pool);
+  return svn_fs_pack2(dir, 1, pack_notify, &pnb, NULL, NULL, pool);
 }
 
 /* Create a packed FSFS filesystem for revprop tests at REPO_NAME with
@@ -227,7 +250,7 @@ prepare_revprop_repo(svn_fs_t **fs,
   svn_pool_destroy(subpool);
 
   /* Pack the repository. */
-  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(repo_name, 1, NULL, NULL, NULL, NULL, pool));
 
   return SVN_NO_ERROR;
 }
@@ -652,7 +675,7 @@ recover_fully_packed(const svn_test_opts_t *opts,
   SVN_ERR(svn_fs_commit_txn(&conflict, &after_rev, txn, subpool));
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(after_rev));
   svn_pool_destroy(subpool);
-  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(REPO_NAME, 1, NULL, NULL, NULL, NULL, pool));
   SVN_ERR(svn_fs_recover(REPO_NAME, NULL, NULL, pool));
 
   /* Now, delete the youngest revprop file, and recover again.  This
@@ -851,7 +874,7 @@ test_batch_fsync(const svn_test_opts_t *opts,
                  apr_pool_t *pool)
 {
   const char *abspath;
-  svn_fs_x__batch_fsync_t *batch;
+  svn_batch_fsync__t *batch;
   int i;
 
   /* Disable this test for non FSX backends because it has no relevance to
@@ -870,13 +893,13 @@ test_batch_fsync(const svn_test_opts_t *opts,
 
   /* Initialize infrastructure with a pool that lives as long as this
    * application. */
-  SVN_ERR(svn_fs_x__batch_fsync_init(pool));
+  SVN_ERR(svn_batch_fsync__init(pool));
 
   /* We use and re-use the same batch object throughout this test. */
-  SVN_ERR(svn_fs_x__batch_fsync_create(&batch, TRUE, pool));
+  SVN_ERR(svn_batch_fsync__create(&batch, TRUE, pool));
 
   /* The working directory is new. */
-  SVN_ERR(svn_fs_x__batch_fsync_new_path(batch, abspath, pool));
+  SVN_ERR(svn_batch_fsync__new_path(batch, abspath, pool));
 
   /* 1st run: Has to fire up worker threads etc. */
   for (i = 0; i < 10; ++i)
@@ -887,12 +910,12 @@ test_batch_fsync(const svn_test_opts_t *opts,
                                          pool);
       apr_size_t len = strlen(path);
 
-      SVN_ERR(svn_fs_x__batch_fsync_open_file(&file, batch, path, pool));
+      SVN_ERR(svn_batch_fsync__open_file(&file, batch, path, pool));
 
       SVN_ERR(svn_io_file_write(file, path, &len, pool));
     }
 
-  SVN_ERR(svn_fs_x__batch_fsync_run(batch, pool));
+  SVN_ERR(svn_batch_fsync__run(batch, pool));
 
   /* 2nd run: Running a batch must leave the container in an empty,
    * re-usable state. Hence, try to re-use it. */
@@ -904,12 +927,12 @@ test_batch_fsync(const svn_test_opts_t *opts,
                                          pool);
       apr_size_t len = strlen(path);
 
-      SVN_ERR(svn_fs_x__batch_fsync_open_file(&file, batch, path, pool));
+      SVN_ERR(svn_batch_fsync__open_file(&file, batch, path, pool));
 
       SVN_ERR(svn_io_file_write(file, path, &len, pool));
     }
 
-  SVN_ERR(svn_fs_x__batch_fsync_run(batch, pool));
+  SVN_ERR(svn_batch_fsync__run(batch, pool));
 
   /* 3rd run: Schedule but don't execute. POOL cleanup shall not fail. */
   for (i = 0; i < 10; ++i)
@@ -920,7 +943,7 @@ test_batch_fsync(const svn_test_opts_t *opts,
                                          pool);
       apr_size_t len = strlen(path);
 
-      SVN_ERR(svn_fs_x__batch_fsync_open_file(&file, batch, path, pool));
+      SVN_ERR(svn_batch_fsync__open_file(&file, batch, path, pool));
 
       SVN_ERR(svn_io_file_write(file, path, &len, pool));
     }
@@ -929,6 +952,211 @@ test_batch_fsync(const svn_test_opts_t *opts,
 }
 #undef REPO_NAME
 /* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-fsx-pack-with-multiple-jobs"
+#define SHARD_SIZE 3
+#define MAX_REV 53
+static svn_error_t *
+pack_with_multiple_jobs(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  struct pack_notify_baton pnb;
+  svn_fs_t *fs;
+  svn_revnum_t i;
+  svn_string_t *propval;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Create the repo and fill it. */
+  SVN_ERR(create_non_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                       pool));
+
+  /* Pack it using multiple threads.  Notifications must still arrive in
+     shard order and no shard may be skipped. */
+  pnb.expected_shard = 0;
+  pnb.expected_action = svn_fs_pack_notify_start;
+  SVN_ERR(svn_fs_pack2(REPO_NAME, 4, pack_notify, &pnb, NULL, NULL, pool));
+  SVN_TEST_ASSERT(pnb.expected_shard == (MAX_REV + 1) / SHARD_SIZE);
+  SVN_TEST_ASSERT(pnb.expected_action == svn_fs_pack_notify_start);
+
+  /* All contents and revprops must still be readable. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  SVN_ERR(svn_fs_revision_prop(&propval, fs, 1, SVN_PROP_REVISION_LOG, pool));
+  SVN_TEST_STRING_ASSERT(propval->data, R1_LOG_MSG);
+
+  for (i = 1; i < (MAX_REV + 1); i++)
+    {
+      svn_fs_root_t *rev_root;
+      svn_stream_t *rstream;
+      svn_stringbuf_t *rstring;
+      svn_stringbuf_t *sb;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, i, iterpool));
+      SVN_ERR(svn_fs_file_contents(&rstream, rev_root, "iota", iterpool));
+      SVN_ERR(svn_test__stream_to_string(&rstring, rstream, iterpool));
+
+      if (i == 1)
+        sb = svn_stringbuf_create("This is the file 'iota'.\n", iterpool);
+      else
+        sb = svn_stringbuf_create(get_rev_contents(i, iterpool), iterpool);
+
+      if (! svn_stringbuf_compare(rstring, sb))
+        return svn_error_createf(SVN_ERR_FS_GENERAL, NULL,
+                                 "Bad data in revision %ld.", i);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* To be sure: Verify that we didn't break the repo. */
+  SVN_ERR(svn_fs_verify2(REPO_NAME, NULL, 0, MAX_REV, 1, NULL, NULL, NULL,
+                         NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-fsx-dag-cache-snapshot"
+#define SHARD_SIZE 4
+#define MAX_REV 5
+static svn_error_t *
+dag_cache_snapshot(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  svn_fs_root_t *root;
+  svn_stream_t *stream;
+  svn_stringbuf_t *contents;
+  svn_node_kind_t kind;
+  const char *snapshot_path;
+  apr_hash_t *fs_config = apr_hash_make(pool);
+
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSX_DAG_CACHE_SNAPSHOT, "1");
+
+  /* Create the repo and fill it. */
+  SVN_ERR(create_non_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                       pool));
+
+  /* Walk a few paths and persist the lookups. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+  SVN_ERR(svn_fs_revision_root(&root, fs, 1, pool));
+  SVN_ERR(svn_fs_file_contents(&stream, root, "A/B/E/alpha", pool));
+  SVN_ERR(svn_stream_close(stream));
+  SVN_ERR(svn_fs_revision_root(&root, fs, MAX_REV, pool));
+  SVN_ERR(svn_fs_file_contents(&stream, root, "iota", pool));
+  SVN_ERR(svn_stream_close(stream));
+  SVN_ERR(svn_fs_x__dag_cache_write_snapshot(fs, pool));
+
+  snapshot_path = svn_fs_x__path_dag_cache(fs, pool);
+  SVN_ERR(svn_stringbuf_from_file2(&contents, snapshot_path, pool));
+  SVN_TEST_ASSERT(strstr(contents->data, " 1 A/B/E/alpha\n"));
+  SVN_TEST_ASSERT(strstr(contents->data, " 5 iota\n"));
+
+  /* A new session must find the same nodes using the snapshot. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, fs_config, pool, pool));
+  SVN_ERR(svn_fs_revision_root(&root, fs, 1, pool));
+  SVN_ERR(svn_fs_file_contents(&stream, root, "A/B/E/alpha", pool));
+  SVN_ERR(svn_test__stream_to_string(&contents, stream, pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'alpha'.\n");
+  SVN_ERR(svn_fs_revision_root(&root, fs, MAX_REV, pool));
+  SVN_ERR(svn_fs_file_contents(&stream, root, "iota", pool));
+  SVN_ERR(svn_test__stream_to_string(&contents, stream, pool));
+  SVN_TEST_STRING_ASSERT(contents->data, get_rev_contents(MAX_REV, pool));
+
+  /* Lookups that the snapshot does not cover still work. */
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/D/G/rho", pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/B/E/no-such-file", pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  /* Without the option, we neither need nor touch the snapshot. */
+  SVN_ERR(svn_io_remove_file2(snapshot_path, FALSE, pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  SVN_ERR(svn_fs_revision_root(&root, fs, 1, pool));
+  SVN_ERR(svn_fs_check_path(&kind, root, "A/B/E/alpha", pool));
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_ERR(svn_fs_x__dag_cache_write_snapshot(fs, pool));
+  SVN_ERR(svn_io_check_path(snapshot_path, &kind, pool));
+  SVN_TEST_ASSERT(kind == svn_node_none);
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-fsx-changes-paths-only"
+#define SHARD_SIZE 2
+#define MAX_REV 3
+/* Read all changes of REVISION in FS into *CHANGES, allocated in POOL.
+   Set the PATHS_ONLY projection in the changes context as given. */
+static svn_error_t *
+read_all_changes(apr_array_header_t **changes,
+                 svn_fs_t *fs,
+                 svn_revnum_t revision,
+                 svn_boolean_t paths_only,
+                 apr_pool_t *pool)
+{
+  svn_fs_x__changes_context_t *context;
+
+  *changes = apr_array_make(pool, 0, sizeof(svn_fs_x__change_t *));
+  SVN_ERR(svn_fs_x__create_changes_context(&context, fs, revision,
+                                           pool, pool));
+  context->paths_only = paths_only;
+
+  while (!context->eol)
+    {
+      apr_array_header_t *block;
+      SVN_ERR(svn_fs_x__get_changes(&block, context, pool, pool));
+      apr_array_cat(*changes, block);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+changes_paths_only(const svn_test_opts_t *opts,
+                   apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  apr_array_header_t *full, *projected;
+  int i;
+
+  /* r1 is in a packed shard and uses a changes container. */
+  SVN_ERR(create_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                   pool));
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+
+  SVN_ERR(read_all_changes(&full, fs, 1, FALSE, pool));
+  SVN_ERR(read_all_changes(&projected, fs, 1, TRUE, pool));
+  SVN_TEST_INT_ASSERT(projected->nelts, full->nelts);
+  SVN_TEST_ASSERT(full->nelts > 0);
+
+  for (i = 0; i < full->nelts; ++i)
+    {
+      svn_fs_x__change_t *lhs = APR_ARRAY_IDX(full, i, svn_fs_x__change_t *);
+      svn_fs_x__change_t *rhs
+        = APR_ARRAY_IDX(projected, i, svn_fs_x__change_t *);
+
+      SVN_TEST_STRING_ASSERT(rhs->path.data, lhs->path.data);
+      SVN_TEST_ASSERT(rhs->change_kind == lhs->change_kind);
+      SVN_TEST_ASSERT(rhs->node_kind == lhs->node_kind);
+      SVN_TEST_ASSERT(rhs->text_mod == lhs->text_mod);
+      SVN_TEST_ASSERT(rhs->prop_mod == lhs->prop_mod);
+
+      /* Only the projection leaves the copy-from info unknown. */
+      SVN_TEST_ASSERT(lhs->copyfrom_known);
+      SVN_TEST_ASSERT(!rhs->copyfrom_known);
+      SVN_TEST_ASSERT(rhs->copyfrom_path == NULL);
+    }
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+/* ------------------------------------------------------------------------ */
 
 /* The test table.  */
 
@@ -963,6 +1191,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test packing with shard size = 1"),
     SVN_TEST_OPTS_PASS(test_batch_fsync,
                        "test batch fsync"),
+    SVN_TEST_OPTS_PASS(pack_with_multiple_jobs,
+                       "pack FSX using multiple worker threads"),
+    SVN_TEST_OPTS_PASS(dag_cache_snapshot,
+                       "persist FSX DAG cache lookups"),
+    SVN_TEST_OPTS_PASS(changes_paths_only,
+                       "read FSX changes without copy-from info"),
     SVN_TEST_NULL
   };
 
@@ -238,6 +238,51 @@ many_strings_table_body(svn_boolean_t do_load_store,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+path_strings_table_body(svn_boolean_t do_load_store,
+                        apr_pool_t *pool)
+{
+  /* paths with long common prefixes, some of them being prefixes of
+     others or being the same modulo case */
+  enum { COUNT = 300 };
+
+  const char *strings[COUNT] = { 0 };
+  apr_size_t indexes[COUNT] = { 0 };
+
+  string_table_builder_t *builder;
+  string_table_t *table;
+  int i;
+
+  builder = svn_fs_x__string_table_builder_create(pool);
+  for (i = 0; i < COUNT; ++i)
+    {
+      strings[i] = apr_psprintf(pool, "/trunk/subversion/libsvn_fs_x/%s%d",
+                                i % 3 ? "dir/" : "Dir/", i % 67);
+      indexes[i] = svn_fs_x__string_table_builder_add(builder, strings[i], 0);
+    }
+
+  table = svn_fs_x__string_table_create(builder, pool);
+  if (do_load_store)
+    SVN_ERR(store_and_load_table(&table, pool));
+
+  for (i = 0; i < COUNT; ++i)
+    {
+      apr_size_t len;
+      const char *string
+        = svn_fs_x__string_table_get(table, indexes[i], &len, pool);
+
+      SVN_TEST_STRING_ASSERT(string, strings[i]);
+      SVN_TEST_ASSERT(len == strlen(strings[i]));
+
+      /* the sequence repeats after 3 * 67 strings and equal strings
+         must have been stored only once */
+      if (i + 3 * 67 < COUNT)
+        SVN_TEST_ASSERT(indexes[i] == indexes[i + 3 * 67]);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 create_empty_table(apr_pool_t *pool)
 {
@@ -262,6 +307,18 @@ many_strings_table(apr_pool_t *pool)
   return svn_error_trace(many_strings_table_body(FALSE, pool));
 }
 
+static svn_error_t *
+path_strings_table(apr_pool_t *pool)
+{
+  return svn_error_trace(path_strings_table_body(FALSE, pool));
+}
+
+static svn_error_t *
+store_load_path_strings_table(apr_pool_t *pool)
+{
+  return svn_error_trace(path_strings_table_body(TRUE, pool));
+}
+
 static svn_error_t *
 store_load_short_string_table(apr_pool_t *pool)
 {
@@ -312,6 +369,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "store and load table with large strings only"),
     SVN_TEST_PASS2(store_load_many_strings_table,
                    "store and load string table with many strings"),
+    SVN_TEST_PASS2(path_strings_table,
+                   "string table with many similar paths"),
+    SVN_TEST_PASS2(store_load_path_strings_table,
+                   "store and load string table with many similar paths"),
     SVN_TEST_NULL
   };
 
@@ -656,6 +656,77 @@ get_dir_test(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Test svn_ra_stat_many(). */
+static svn_error_t *
+stat_many_test(const svn_test_opts_t *opts,
+               apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+  apr_array_header_t *paths = apr_array_make(pool, 4, sizeof(const char *));
+  apr_hash_t *dirents;
+  svn_dirent_t *ent;
+
+  SVN_ERR(make_and_open_repos(&session, "test-stat-many", opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  APR_ARRAY_PUSH(paths, const char *) = "";
+  APR_ARRAY_PUSH(paths, const char *) = "A/B";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB/g";
+  APR_ARRAY_PUSH(paths, const char *) = "non/existing/relpath";
+
+  SVN_ERR(svn_ra_stat_many(session, &dirents, paths, 1, pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 3);
+
+  ent = svn_hash_gets(dirents, "");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_dir);
+  ent = svn_hash_gets(dirents, "A/B");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_dir);
+  ent = svn_hash_gets(dirents, "A/BB/g");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_file);
+  SVN_TEST_INT_ASSERT(ent->created_rev, 1);
+
+  /* Nothing exists in revision 0 except the root. */
+  SVN_ERR(svn_ra_stat_many(session, &dirents, paths, 0, pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 1);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test svn_ra_stat_many() with more paths than fit into one request. */
+static svn_error_t *
+stat_many_large_test(const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+  apr_array_header_t *paths = apr_array_make(pool, 200, sizeof(const char *));
+  apr_hash_t *dirents;
+  svn_dirent_t *ent;
+  int i;
+
+  SVN_ERR(make_and_open_repos(&session, "test-stat-many-large", opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  /* Every fourth path exists. */
+  for (i = 0; i < 200; i++)
+    APR_ARRAY_PUSH(paths, const char *)
+      = (i % 4) ? apr_psprintf(pool, "A/missing-%d", i)
+                : (i % 8) ? "A/B/f" : "A/BB";
+
+  SVN_ERR(svn_ra_stat_many(session, &dirents, paths, 1, pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 2);
+
+  ent = svn_hash_gets(dirents, "A/B/f");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_file);
+  ent = svn_hash_gets(dirents, "A/BB");
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_dir);
+
+  /* The session must still be usable afterwards. */
+  SVN_ERR(svn_ra_stat(session, "A/BB/g", 1, &ent, pool));
+  SVN_TEST_ASSERT(ent && ent->kind == svn_node_file);
+
+  return SVN_NO_ERROR;
+}
+
 /* Implements svn_commit_callback2_t for commit_callback_failure() */
 static svn_error_t *
 commit_callback_with_failure(const svn_commit_info_t *info,
@@ -1878,6 +1949,155 @@ test_get_deleted_rev_errors(const svn_test_opts_t *opts,
 }
 
 
+/* Commit TEXT as the content of the file "f", adding it if ADD is set. */
+static svn_error_t *
+commit_file_text(svn_ra_session_t *session,
+                 svn_boolean_t add,
+                 const char *text,
+                 apr_pool_t *pool)
+{
+  apr_hash_t *revprop_table = apr_hash_make(pool);
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  void *root_baton, *file_baton;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  SVN_ERR(svn_ra_get_commit_editor3(session, &editor, &edit_baton,
+                                    revprop_table,
+                                    NULL, NULL, NULL, TRUE, pool));
+  SVN_ERR(editor->open_root(edit_baton, SVN_INVALID_REVNUM,
+                            pool, &root_baton));
+  if (add)
+    SVN_ERR(editor->add_file("f", root_baton, NULL, SVN_INVALID_REVNUM,
+                             pool, &file_baton));
+  else
+    SVN_ERR(editor->open_file("f", root_baton, SVN_INVALID_REVNUM,
+                              pool, &file_baton));
+  SVN_ERR(editor->apply_textdelta(file_baton, NULL, pool,
+                                  &handler, &handler_baton));
+  SVN_ERR(svn_txdelta_send_string(svn_string_create(text, pool),
+                                  handler, handler_baton, pool));
+  SVN_ERR(editor->close_file(file_baton, NULL, pool));
+  SVN_ERR(editor->close_directory(root_baton, pool));
+  SVN_ERR(editor->close_edit(edit_baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_window_handler_t.  Refuse any further input. */
+static svn_error_t *
+cease_window_handler(svn_txdelta_window_t *window,
+                     void *baton)
+{
+  return svn_error_create(SVN_ERR_CEASE_INVOCATION, NULL, NULL);
+}
+
+/* Baton for cease_file_rev_handler(). */
+struct cease_file_revs_baton_t
+{
+  /* Number of revisions received. */
+  int count;
+
+  /* Whether to stop in the delta of the first revision. */
+  svn_boolean_t cease;
+};
+
+/* Implements svn_file_rev_handler_t for tunnel_get_file_revs_cease(). */
+static svn_error_t *
+cease_file_rev_handler(void *baton,
+                       const char *path,
+                       svn_revnum_t rev,
+                       apr_hash_t *rev_props,
+                       svn_boolean_t result_of_merge,
+                       svn_txdelta_window_handler_t *delta_handler,
+                       void **delta_baton,
+                       apr_array_header_t *prop_diffs,
+                       apr_pool_t *pool)
+{
+  struct cease_file_revs_baton_t *b = baton;
+
+  b->count++;
+  if (delta_handler)
+    {
+      *delta_handler = b->cease ? cease_window_handler
+                                : svn_delta_noop_window_handler;
+      *delta_baton = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Stopping svn_ra_get_file_revs2() from a handler must leave the session
+   usable for further requests. */
+static svn_error_t *
+tunnel_get_file_revs_cease(const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  tunnel_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+  const char *url;
+  svn_ra_callbacks2_t *cbtable;
+  svn_ra_session_t *session;
+  const char tunnel_repos_name[] = "test-get-file-revs-cease";
+  struct cease_file_revs_baton_t frb;
+  svn_revnum_t youngest;
+  svn_error_t *err;
+
+  b->magic = TUNNEL_MAGIC;
+
+  SVN_ERR(svn_test__create_repos(NULL, tunnel_repos_name, opts, scratch_pool));
+
+  /* Immediately close the repository to avoid race condition with svnserve
+     (and then the cleanup code) with BDB when our pool is cleared. */
+  svn_pool_clear(scratch_pool);
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", tunnel_repos_name,
+                    SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = b;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+                                         TRUE  /* non_interactive */,
+                                         "jrandom", "rayjandom",
+                                         NULL,
+                                         TRUE  /* no_auth_cache */,
+                                         FALSE /* trust_server_cert */,
+                                         FALSE, FALSE, FALSE, FALSE,
+                                         NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open5(&session, NULL, NULL, url, NULL, cbtable, NULL, NULL,
+                       scratch_pool));
+
+  SVN_ERR(commit_file_text(session, TRUE, "one\n", pool));
+  SVN_ERR(commit_file_text(session, FALSE, "one\ntwo\n", pool));
+  SVN_ERR(commit_file_text(session, FALSE, "one\ntwo\nthree\n", pool));
+
+  /* Stop in the delta of the youngest revision... */
+  frb.count = 0;
+  frb.cease = TRUE;
+  err = svn_ra_get_file_revs2(session, "f", 3, 1, FALSE,
+                              cease_file_rev_handler, &frb, pool);
+  SVN_TEST_ASSERT_ERROR(err, SVN_ERR_CEASE_INVOCATION);
+  SVN_TEST_INT_ASSERT(frb.count, 1);
+
+  /* ... and the connection must not be stuck in the middle of the
+     remaining response. */
+  SVN_ERR(svn_ra_get_latest_revnum(session, &youngest, pool));
+  SVN_TEST_INT_ASSERT(youngest, 3);
+
+  frb.count = 0;
+  frb.cease = FALSE;
+  SVN_ERR(svn_ra_get_file_revs2(session, "f", 3, 1, FALSE,
+                                cease_file_rev_handler, &frb, pool));
+  SVN_TEST_INT_ASSERT(frb.count, 3);
+
+  svn_pool_destroy(scratch_pool);
+  return SVN_NO_ERROR;
+}
+
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -1895,6 +2115,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "lock multiple paths"),
     SVN_TEST_OPTS_PASS(get_dir_test,
                        "test ra_get_dir2"),
+    SVN_TEST_OPTS_PASS(stat_many_test,
+                       "test ra_stat_many"),
+    SVN_TEST_OPTS_PASS(stat_many_large_test,
+                       "test ra_stat_many with many paths"),
     SVN_TEST_OPTS_PASS(commit_callback_failure,
                        "commit callback failure"),
     SVN_TEST_OPTS_PASS(base_revision_above_youngest,
@@ -1917,6 +2141,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test get-deleted-rev no delete"),
     SVN_TEST_OPTS_PASS(test_get_deleted_rev_errors,
                        "test get-deleted-rev errors"),
+    SVN_TEST_OPTS_PASS(tunnel_get_file_revs_cease,
+                       "stop get-file-revs early over a tunnel"),
     SVN_TEST_NULL
   };
 
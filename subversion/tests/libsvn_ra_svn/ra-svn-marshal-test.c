@@ -0,0 +1,289 @@
+/*
+ * ra-svn-marshal-test.c :  round-trip tests for the ra_svn data codecs
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+
+#include <string.h>
+
+#include <apr_pools.h>
+
+#include "svn_delta.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_props.h"
+#include "svn_ra_svn.h"
+
+#include "private/svn_ra_svn_private.h"
+
+#include "../svn_test.h"
+
+/*-------------------------------------------------------------------*/
+
+/** Helper routines. **/
+
+/* Return a connection that writes into the new, empty buffer *BUF.
+   Allocate both in POOL. */
+static svn_ra_svn_conn_t *
+make_writer(svn_stringbuf_t **buf,
+            apr_pool_t *pool)
+{
+  *buf = svn_stringbuf_create_empty(pool);
+
+  return svn_ra_svn_create_conn5(NULL, svn_stream_empty(pool),
+                                 svn_stream_from_stringbuf(*buf, pool),
+                                 SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                                 0, 0, 0, 0, pool);
+}
+
+/* Flush CONN, which was returned by make_writer() together with BUF, and
+   parse the single tuple it wrote.  Return it in *LIST, allocated in
+   POOL. */
+static svn_error_t *
+read_back(const svn_ra_svn__list_t **list,
+          svn_ra_svn_conn_t *conn,
+          svn_stringbuf_t *buf,
+          apr_pool_t *pool)
+{
+  svn_ra_svn_conn_t *reader;
+  svn_ra_svn__item_t *item;
+
+  SVN_ERR(svn_ra_svn__flush(conn, pool));
+
+  reader = svn_ra_svn_create_conn5(NULL,
+                                   svn_stream_from_stringbuf(buf, pool),
+                                   svn_stream_empty(pool),
+                                   SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                                   0, 0, 0, 0, pool);
+  SVN_ERR(svn_ra_svn__read_item(reader, pool, &item));
+  SVN_TEST_ASSERT(item->kind == SVN_RA_SVN_LIST);
+
+  *list = &item->u.list;
+  return SVN_NO_ERROR;
+}
+
+/* Send a complete log entry over CONN the way svnserve's log receiver
+   does: an empty changed paths list, the main members, REVPROPS and the
+   SUBTRACTIVE_MERGE flag. */
+static svn_error_t *
+write_log_entry(svn_ra_svn_conn_t *conn,
+                svn_revnum_t revision,
+                const svn_string_t *author,
+                const svn_string_t *date,
+                const svn_string_t *message,
+                svn_boolean_t has_children,
+                svn_boolean_t invalid_revnum,
+                apr_hash_t *revprops,
+                svn_boolean_t subtractive_merge,
+                apr_pool_t *pool)
+{
+  unsigned revprop_count = revprops ? apr_hash_count(revprops) : 0;
+
+  SVN_ERR(svn_ra_svn__start_list(conn, pool));
+  SVN_ERR(svn_ra_svn__start_list(conn, pool));
+  SVN_ERR(svn_ra_svn__end_list(conn, pool));
+
+  SVN_ERR(svn_ra_svn__write_data_log_entry(conn, pool, revision,
+                                           author, date, message,
+                                           has_children, invalid_revnum,
+                                           revprop_count));
+
+  SVN_ERR(svn_ra_svn__start_list(conn, pool));
+  if (revprop_count)
+    SVN_ERR(svn_ra_svn__write_proplist(conn, pool, revprops));
+  SVN_ERR(svn_ra_svn__end_list(conn, pool));
+
+  SVN_ERR(svn_ra_svn__write_boolean(conn, pool, subtractive_merge));
+  SVN_ERR(svn_ra_svn__end_list(conn, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/*-------------------------------------------------------------------*/
+
+/** The tests **/
+
+static svn_error_t *
+dir_entry_round_trip(apr_pool_t *pool)
+{
+  svn_ra_svn_conn_t *conn;
+  svn_stringbuf_t *buf;
+  const svn_ra_svn__list_t *list;
+  const char *name, *kind_word, *cdate, *last_author;
+  apr_uint64_t size;
+  svn_boolean_t has_props;
+  svn_revnum_t created_rev;
+
+  /* All fields present, with a size that doesn't fit into 32 bits. */
+  conn = make_writer(&buf, pool);
+  SVN_ERR(svn_ra_svn__write_data_dir_entry(conn, pool, "iota",
+                                           svn_node_file,
+                                           APR_INT64_C(0x123456789),
+                                           TRUE, 42,
+                                           "2026-01-02T03:04:05.000000Z",
+                                           "jrandom"));
+  SVN_ERR(read_back(&list, conn, buf, pool));
+  SVN_ERR(svn_ra_svn__read_data_dir_entry(list, &name, &kind_word, &size,
+                                          &has_props, &created_rev,
+                                          &cdate, &last_author));
+
+  SVN_TEST_STRING_ASSERT(name, "iota");
+  SVN_TEST_STRING_ASSERT(kind_word, "file");
+  SVN_TEST_ASSERT(size == APR_UINT64_C(0x123456789));
+  SVN_TEST_ASSERT(has_props);
+  SVN_TEST_ASSERT(created_rev == 42);
+  SVN_TEST_STRING_ASSERT(cdate, "2026-01-02T03:04:05.000000Z");
+  SVN_TEST_STRING_ASSERT(last_author, "jrandom");
+
+  /* Optional date and author absent. */
+  conn = make_writer(&buf, pool);
+  SVN_ERR(svn_ra_svn__write_data_dir_entry(conn, pool, "A B",
+                                           svn_node_dir, 0, FALSE, 0,
+                                           NULL, NULL));
+  SVN_ERR(read_back(&list, conn, buf, pool));
+  SVN_ERR(svn_ra_svn__read_data_dir_entry(list, &name, &kind_word, &size,
+                                          &has_props, &created_rev,
+                                          &cdate, &last_author));
+
+  SVN_TEST_STRING_ASSERT(name, "A B");
+  SVN_TEST_STRING_ASSERT(kind_word, "dir");
+  SVN_TEST_ASSERT(size == 0);
+  SVN_TEST_ASSERT(!has_props);
+  SVN_TEST_ASSERT(created_rev == 0);
+  SVN_TEST_ASSERT(cdate == NULL);
+  SVN_TEST_ASSERT(last_author == NULL);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+log_entry_round_trip(apr_pool_t *pool)
+{
+  svn_ra_svn_conn_t *conn;
+  svn_stringbuf_t *buf;
+  svn_stringbuf_t *long_message;
+  const svn_ra_svn__list_t *list, *changed_paths, *revprop_list;
+  svn_revnum_t revision;
+  svn_string_t *author, *date, *message;
+  apr_uint64_t has_children, invalid_revnum, revprop_count;
+  apr_uint64_t subtractive_merge;
+  apr_hash_t *revprops = apr_hash_make(pool);
+
+  /* A message larger than the connection's write buffer. */
+  long_message = svn_stringbuf_create_ensure(20000, pool);
+  while (long_message->len < 20000)
+    svn_stringbuf_appendcstr(long_message, "log message text ");
+
+  svn_hash_sets(revprops, "custom", svn_string_create("value", pool));
+
+  /* All fields present. */
+  conn = make_writer(&buf, pool);
+  SVN_ERR(write_log_entry(conn, 7,
+                          svn_string_create("jrandom", pool),
+                          svn_string_create("2026-01-02T03:04:05.000000Z",
+                                            pool),
+                          svn_string_create_from_buf(long_message, pool),
+                          TRUE, FALSE, revprops, TRUE, pool));
+  SVN_ERR(read_back(&list, conn, buf, pool));
+  SVN_ERR(svn_ra_svn__read_data_log_entry(list, &changed_paths, &revision,
+                                          &author, &date, &message,
+                                          &has_children, &invalid_revnum,
+                                          &revprop_count, &revprop_list,
+                                          &subtractive_merge));
+
+  SVN_TEST_ASSERT(changed_paths->nelts == 0);
+  SVN_TEST_ASSERT(revision == 7);
+  SVN_TEST_STRING_ASSERT(author->data, "jrandom");
+  SVN_TEST_STRING_ASSERT(date->data, "2026-01-02T03:04:05.000000Z");
+  SVN_TEST_ASSERT(message->len == long_message->len);
+  SVN_TEST_ASSERT(!memcmp(message->data, long_message->data, message->len));
+  SVN_TEST_ASSERT(has_children == TRUE);
+  SVN_TEST_ASSERT(invalid_revnum == FALSE);
+  SVN_TEST_ASSERT(revprop_count == 1);
+  SVN_TEST_ASSERT(subtractive_merge == TRUE);
+
+  SVN_TEST_ASSERT(revprop_list != NULL);
+  SVN_ERR(svn_ra_svn__parse_proplist(revprop_list, pool, &revprops));
+  SVN_TEST_ASSERT(apr_hash_count(revprops) == 1);
+  SVN_TEST_STRING_ASSERT(svn_prop_get_value(revprops, "custom"), "value");
+
+  /* Standard revprops absent and an invalid revision. */
+  conn = make_writer(&buf, pool);
+  SVN_ERR(write_log_entry(conn, 0, NULL, NULL, NULL, FALSE, TRUE, NULL,
+                          FALSE, pool));
+  SVN_ERR(read_back(&list, conn, buf, pool));
+  SVN_ERR(svn_ra_svn__read_data_log_entry(list, &changed_paths, &revision,
+                                          &author, &date, &message,
+                                          &has_children, &invalid_revnum,
+                                          &revprop_count, &revprop_list,
+                                          &subtractive_merge));
+
+  SVN_TEST_ASSERT(revision == 0);
+  SVN_TEST_ASSERT(author == NULL);
+  SVN_TEST_ASSERT(date == NULL);
+  SVN_TEST_ASSERT(message == NULL);
+  SVN_TEST_ASSERT(has_children == FALSE);
+  SVN_TEST_ASSERT(invalid_revnum == TRUE);
+  SVN_TEST_ASSERT(revprop_count == 0);
+  SVN_TEST_ASSERT(revprop_list != NULL && revprop_list->nelts == 0);
+  SVN_TEST_ASSERT(subtractive_merge == FALSE);
+
+  /* An entry from an old server that only sends the mandatory elements. */
+  conn = make_writer(&buf, pool);
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "()r(?c)(?c)(?c)",
+                                  (svn_revnum_t)3, "jconstant", NULL, NULL));
+  SVN_ERR(read_back(&list, conn, buf, pool));
+  SVN_ERR(svn_ra_svn__read_data_log_entry(list, &changed_paths, &revision,
+                                          &author, &date, &message,
+                                          &has_children, &invalid_revnum,
+                                          &revprop_count, &revprop_list,
+                                          &subtractive_merge));
+
+  SVN_TEST_ASSERT(revision == 3);
+  SVN_TEST_STRING_ASSERT(author->data, "jconstant");
+  SVN_TEST_ASSERT(date == NULL);
+  SVN_TEST_ASSERT(message == NULL);
+  SVN_TEST_ASSERT(has_children == SVN_RA_SVN_UNSPECIFIED_NUMBER);
+  SVN_TEST_ASSERT(invalid_revnum == SVN_RA_SVN_UNSPECIFIED_NUMBER);
+  SVN_TEST_ASSERT(revprop_count == SVN_RA_SVN_UNSPECIFIED_NUMBER);
+  SVN_TEST_ASSERT(revprop_list == NULL);
+  SVN_TEST_ASSERT(subtractive_merge == SVN_RA_SVN_UNSPECIFIED_NUMBER);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* The test table.  */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(dir_entry_round_trip,
+                   "round-trip get-dir entries"),
+    SVN_TEST_PASS2(log_entry_round_trip,
+                   "round-trip log entries"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
@@ -76,8 +76,8 @@ test_dump_bad_props(svn_stringbuf_t **dump_data_p,
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
 
   /* Test that a dump completes without error. */
-  SVN_ERR(svn_repos_dump_fs4(repos, stream, start_rev, end_rev,
-                             FALSE, FALSE, TRUE, TRUE,
+  SVN_ERR(svn_repos_dump_fs5(repos, stream, start_rev, end_rev,
+                             FALSE, FALSE, TRUE, TRUE, 1,
                              notify_func, notify_baton,
                              NULL, NULL, NULL, NULL,
                              pool));
@@ -273,6 +273,242 @@ test_load_r0_mergeinfo(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+
+/* Baton for dump_concurrently_notifier(). */
+struct dump_notify_baton_t
+{
+  /* The next revision that we expect to be reported as dumped. */
+  svn_revnum_t next_rev;
+
+  /* Set if notifications came in the wrong order. */
+  svn_boolean_t out_of_order;
+
+  /* Number of warnings received. */
+  int warnings;
+};
+
+/* Implements svn_repos_notify_func_t.  Check that the per-revision
+   notifications arrive in ascending revision order and count warnings. */
+static void
+dump_concurrently_notifier(void *baton,
+                           const svn_repos_notify_t *notify,
+                           apr_pool_t *scratch_pool)
+{
+  struct dump_notify_baton_t *b = baton;
+
+  if (notify->action == svn_repos_notify_warning)
+    b->warnings++;
+
+  if (notify->action != svn_repos_notify_dump_rev_end)
+    return;
+
+  if (notify->revision != b->next_rev)
+    b->out_of_order = TRUE;
+
+  b->next_rev = notify->revision + 1;
+}
+
+/* Dump revisions START_REV to END_REV of REPOS once sequentially and once
+   with JOBS workers, using INCREMENTAL and USE_DELTAS, and verify that
+   both runs produce the same data and notifications. */
+static svn_error_t *
+compare_concurrent_dump(svn_repos_t *repos,
+                        svn_revnum_t start_rev,
+                        svn_revnum_t end_rev,
+                        svn_boolean_t incremental,
+                        svn_boolean_t use_deltas,
+                        int jobs,
+                        apr_pool_t *pool)
+{
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *actual = svn_stringbuf_create_empty(pool);
+  struct dump_notify_baton_t expected_baton = { 0 };
+  struct dump_notify_baton_t actual_baton = { 0 };
+
+  expected_baton.next_rev = start_rev;
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(expected, pool),
+                             start_rev, end_rev, incremental, use_deltas,
+                             TRUE, TRUE, 1,
+                             dump_concurrently_notifier, &expected_baton,
+                             NULL, NULL, NULL, NULL, pool));
+
+  actual_baton.next_rev = start_rev;
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(actual, pool),
+                             start_rev, end_rev, incremental, use_deltas,
+                             TRUE, TRUE, jobs,
+                             dump_concurrently_notifier, &actual_baton,
+                             NULL, NULL, NULL, NULL, pool));
+
+  SVN_TEST_ASSERT(!actual_baton.out_of_order);
+  SVN_TEST_ASSERT(actual_baton.next_rev == end_rev + 1);
+  SVN_TEST_INT_ASSERT(actual_baton.warnings, expected_baton.warnings);
+  SVN_TEST_ASSERT(svn_stringbuf_compare(actual, expected));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_dump_concurrently(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Create a repository with a number of revisions to dump. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-concurrently",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  for (i = 0; i < 20; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(iterpool,
+                                                       "This is iota %d.\n",
+                                                       i),
+                                          iterpool));
+
+      /* Reference a revision from before the sub-range dumped below. */
+      if (i == 10)
+        {
+          svn_fs_root_t *rev_root;
+          SVN_ERR(svn_fs_revision_root(&rev_root, fs, 1, iterpool));
+          SVN_ERR(svn_fs_copy(rev_root, "A/B", txn_root, "B-copy",
+                              iterpool));
+        }
+
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Full dumps with more workers than there are revisions per worker. */
+  SVN_ERR(compare_concurrent_dump(repos, 0, youngest_rev, FALSE, FALSE, 8,
+                                  pool));
+  SVN_ERR(compare_concurrent_dump(repos, 0, youngest_rev, FALSE, TRUE, 3,
+                                  pool));
+
+  /* Sub-ranges that refer to older revisions. */
+  SVN_ERR(compare_concurrent_dump(repos, 5, 15, FALSE, TRUE, 4, pool));
+  SVN_ERR(compare_concurrent_dump(repos, 5, 15, TRUE, TRUE, 2, pool));
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Load revision START_REV to END_REV from the dumpfile at DUMP_PATH into
+   a new repository named REPOS_NAME and return it in *REPOS_P. */
+static svn_error_t *
+load_range_from_file(svn_repos_t **repos_p,
+                     const char *dump_path,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     const char *repos_name,
+                     const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  svn_stream_t *stream;
+
+  SVN_ERR(svn_test__create_repos(repos_p, repos_name, opts, pool));
+  SVN_ERR(svn_stream_open_readonly(&stream, dump_path, pool, pool));
+  SVN_ERR(svn_repos_load_fs6(*repos_p, stream, start_rev, end_rev,
+                             svn_repos_load_uuid_default, NULL,
+                             FALSE, FALSE, FALSE, FALSE, FALSE,
+                             NULL, NULL, NULL, NULL, pool));
+
+  return svn_error_trace(svn_stream_close(stream));
+}
+
+/* Test that loading a revision range from a dumpfile skips the contents
+   of all other revisions without losing track of the records, and that
+   it still detects truncated input. */
+static svn_error_t *
+test_load_range_from_file(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_fs_root_t *rev_root;
+  svn_revnum_t youngest_rev;
+  svn_stringbuf_t *dump_data = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *contents;
+  svn_stream_t *file_contents;
+  const char *dump_path = svn_test_data_path("test-load-range-from-file",
+                                             pool);
+  int i;
+
+  /* Create a repository with a few revisions of larger texts. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-load-range-src",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  for (i = 0; i < 3; ++i)
+    {
+      svn_stringbuf_t *text = svn_stringbuf_create_empty(pool);
+      int k;
+
+      for (k = 0; k < 10000; ++k)
+        svn_stringbuf_appendcstr(text, apr_psprintf(pool, "%d:%d\n", i, k));
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota", text->data,
+                                          pool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      pool));
+    }
+
+  SVN_ERR(svn_repos_dump_fs5(repos, svn_stream_from_stringbuf(dump_data, pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             FALSE, FALSE, TRUE, TRUE, 1,
+                             NULL, NULL, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_io_file_create_bytes(dump_path, dump_data->data,
+                                   dump_data->len, pool));
+
+  /* Load only the first revisions. */
+  SVN_ERR(load_range_from_file(&repos, dump_path, 1, 2,
+                               "test-repo-load-range-dst", opts, pool));
+  fs = svn_repos_fs(repos);
+  SVN_ERR(svn_fs_youngest_rev(&youngest_rev, fs, pool));
+  SVN_TEST_INT_ASSERT(youngest_rev, 2);
+
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_file_contents(&file_contents, rev_root, "iota", pool));
+  SVN_ERR(svn_stringbuf_from_stream(&contents, file_contents, 0, pool));
+  SVN_TEST_ASSERT(strstr(contents->data, "0:9999\n"));
+
+  /* Truncated contents of skipped revisions must still be detected. */
+  SVN_ERR(svn_io_file_create_bytes(dump_path, dump_data->data,
+                                   dump_data->len - 10, pool));
+  SVN_TEST_ASSERT_ERROR(load_range_from_file(&repos, dump_path, 1, 2,
+                                             "test-repo-load-range-trunc",
+                                             opts, pool),
+                        SVN_ERR_INCOMPLETE_DATA);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -284,6 +520,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test dumping with r0 mergeinfo"),
     SVN_TEST_OPTS_PASS(test_load_r0_mergeinfo,
                        "test loading with r0 mergeinfo"),
+    SVN_TEST_OPTS_PASS(test_dump_concurrently,
+                       "test svn_repos_dump_fs5 with multiple jobs"),
+    SVN_TEST_OPTS_PASS(test_load_range_from_file,
+                       "test loading a revision range from a file"),
     SVN_TEST_NULL
   };
 
@@ -40,6 +40,7 @@
 #include "svn_sorts.h"
 #include "svn_version.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_fspath.h"
 #include "private/svn_dep_compat.h"
 
 /* be able to look into svn_config_t */
@@ -897,6 +898,88 @@ node_locations2(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Test that svn_repos_trace_node_locations() doesn't report locations of
+   a node that got replaced at the same path. */
+static svn_error_t *
+node_locations_replaced(const svn_test_opts_t *opts,
+                        apr_pool_t *pool)
+{
+  apr_pool_t *subpool = svn_pool_create(pool);
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-node-locations-replaced",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* Revision 1: Add /foo and /foo/bar.
+     Revision 2: Modify /foo/bar. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "/foo", subpool));
+  SVN_ERR(svn_fs_make_file(txn_root, "/foo/bar", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/foo/bar", "one", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  /* Revision 3: Replace /foo/bar with a new file.
+     Revision 4: Modify /foo/bar. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_delete(txn_root, "/foo/bar", subpool));
+  SVN_ERR(svn_fs_make_file(txn_root, "/foo/bar", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/foo/bar", "two", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  SVN_TEST_ASSERT(youngest_rev == 4);
+  svn_pool_destroy(subpool);
+
+  /* Only the revisions since the replacement belong to the node. */
+  {
+    struct locations_info info[] =
+      {
+        { 4, "/foo/bar" },
+        { 3, "/foo/bar" },
+        { 0 }
+      };
+    apr_array_header_t *revs = apr_array_make(pool, 4, sizeof(svn_revnum_t));
+    apr_hash_t *locations;
+
+    APR_ARRAY_PUSH(revs, svn_revnum_t) = 1;
+    APR_ARRAY_PUSH(revs, svn_revnum_t) = 2;
+    APR_ARRAY_PUSH(revs, svn_revnum_t) = 3;
+    APR_ARRAY_PUSH(revs, svn_revnum_t) = 4;
+    SVN_ERR(svn_repos_trace_node_locations(fs, &locations, "/foo/bar", 4,
+                                           revs, NULL, NULL, pool));
+    SVN_ERR(check_locations_info(locations, info));
+  }
+
+  /* Before the replacement, the old node has its full history. */
+  {
+    struct locations_info info[] =
+      {
+        { 2, "/foo/bar" },
+        { 1, "/foo/bar" },
+        { 0 }
+      };
+    SVN_ERR(check_locations(fs, info, "/foo/bar", 2, pool));
+  }
+
+  return SVN_NO_ERROR;
+}
+
 
 
 /* Testing the reporter. */
@@ -1727,6 +1810,118 @@ test_authz_recursive_override(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Test that cached access decisions don't leak between different
+   kinds of requests or different authz instances sharing them. */
+static svn_error_t *
+test_authz_decision_cache(apr_pool_t *pool)
+{
+  svn_authz_t *authz_cfg;
+  const char *contents;
+  int i;
+
+  struct check_access_tests test_set[] = {
+    { "/A", "greek", NULL, svn_authz_read, TRUE },
+    { "/A", "greek", NULL, svn_authz_read | svn_authz_recursive, FALSE },
+    { "/A", "greek", NULL, svn_authz_write, FALSE },
+    { "/A", "greek", "plato", svn_authz_write, TRUE },
+    { "/A", "greek", "plato", svn_authz_write | svn_authz_recursive, FALSE },
+    { "/A/B", "greek", NULL, svn_authz_read, FALSE },
+    { "/A/B/", "greek", NULL, svn_authz_read, FALSE },
+    { "/A/B", "greek", "plato", svn_authz_read, TRUE },
+    { "/A/C", "greek", NULL, svn_authz_read, TRUE },
+    { "/A/C", "other", NULL, svn_authz_read, FALSE },
+    /* Sentinel */
+    { NULL, NULL, NULL, svn_authz_none, FALSE }
+  };
+
+  contents =
+    "[greek:/A]"                                                             NL
+    "* = r"                                                                  NL
+    "plato = rw"                                                             NL
+    ""                                                                       NL
+    "[greek:/A/B]"                                                           NL
+    "* ="                                                                    NL
+    "plato = r"                                                              NL
+    ""                                                                       NL;
+
+  /* Make the filtered trees, and their decisions, shared between authz
+   * instances read from the same file. */
+  SVN_ERR(svn_repos_authz_initialize(pool));
+
+  /* Each round must give the same answers, whether they have been cached
+   * in the previous rounds or not. */
+  for (i = 0; i < 3; ++i)
+    {
+      SVN_ERR(authz_get_handle(&authz_cfg, contents, i % 2, pool));
+      SVN_ERR(authz_check_access(authz_cfg, contents, test_set, pool));
+      SVN_ERR(authz_check_access(authz_cfg, contents, test_set, pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Test checking many paths at once against the same rules. */
+static svn_error_t *
+test_authz_check_access_many(apr_pool_t *pool)
+{
+  svn_authz_t *authz_cfg;
+  apr_array_header_t *paths = apr_array_make(pool, 8, sizeof(const char *));
+  svn_boolean_t granted[8];
+  const char *contents;
+  int i;
+
+  contents =
+    "[/]"                                                                    NL
+    "* = r"                                                                  NL
+    ""                                                                       NL
+    "[/A/B]"                                                                 NL
+    "* ="                                                                    NL
+    "plato = rw"                                                             NL
+    ""                                                                       NL;
+
+  SVN_ERR(authz_get_handle(&authz_cfg, contents, FALSE, pool));
+
+  APR_ARRAY_PUSH(paths, const char *) = "/A";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/B";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/B/lambda";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/C";
+  APR_ARRAY_PUSH(paths, const char *) = "/iota";
+
+  /* Mixed results must match the individual checks. */
+  SVN_ERR(svn_repos_authz_check_access_many(authz_cfg, NULL, paths, NULL,
+                                            svn_authz_read, granted, pool));
+  SVN_TEST_ASSERT(granted[0] && !granted[1] && !granted[2]);
+  SVN_TEST_ASSERT(granted[3] && granted[4]);
+
+  for (i = 0; i < paths->nelts; ++i)
+    {
+      svn_boolean_t access_granted;
+
+      SVN_ERR(svn_repos_authz_check_access(authz_cfg, NULL,
+                                           APR_ARRAY_IDX(paths, i,
+                                                         const char *),
+                                           NULL, svn_authz_read,
+                                           &access_granted, pool));
+      SVN_TEST_ASSERT(access_granted == granted[i]);
+    }
+
+  /* Recursive access to the common ancestor grants everything below. */
+  apr_array_clear(paths);
+  APR_ARRAY_PUSH(paths, const char *) = "/A/B";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/B/E/alpha";
+  APR_ARRAY_PUSH(paths, const char *) = "/A/B/lambda";
+
+  SVN_ERR(svn_repos_authz_check_access_many(authz_cfg, NULL, paths, "plato",
+                                            svn_authz_write, granted, pool));
+  SVN_TEST_ASSERT(granted[0] && granted[1] && granted[2]);
+
+  SVN_ERR(svn_repos_authz_check_access_many(authz_cfg, NULL, paths, NULL,
+                                            svn_authz_read, granted, pool));
+  SVN_TEST_ASSERT(!granted[0] && !granted[1] && !granted[2]);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_authz_pattern_tests(apr_pool_t *pool)
 {
@@ -3514,6 +3709,255 @@ get_logs(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_repos_log_entry_receiver_t, appending the revision of
+   LOG_ENTRY to the svn_revnum_t array BATON. */
+static svn_error_t *
+log_rev_collector(void *baton,
+                  svn_repos_log_entry_t *log_entry,
+                  apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *revs = baton;
+
+  APR_ARRAY_PUSH(revs, svn_revnum_t) = log_entry->revision;
+  return SVN_NO_ERROR;
+}
+
+/* Fetch the log of PATHS in REPOS from HEAD to r0 in pages of LIMIT
+   revisions and check that they add up to the same list of revisions as
+   a single svn_repos_get_logs5() call. */
+static svn_error_t *
+check_log_pages(svn_repos_t *repos,
+                const apr_array_header_t *paths,
+                int limit,
+                apr_pool_t *pool)
+{
+  apr_array_header_t *expected = apr_array_make(pool, 8,
+                                                sizeof(svn_revnum_t));
+  apr_array_header_t *paged = apr_array_make(pool, 8, sizeof(svn_revnum_t));
+  const char *cursor = NULL;
+  int pages = 0;
+  int i;
+
+  SVN_ERR(svn_repos_get_logs5(repos, paths, SVN_INVALID_REVNUM, 0, 0,
+                              FALSE, FALSE, NULL, NULL, NULL, NULL, NULL,
+                              log_rev_collector, expected, pool));
+
+  do
+    {
+      int page_start = paged->nelts;
+
+      SVN_ERR(svn_repos_get_logs_page(&cursor, repos, paths,
+                                      SVN_INVALID_REVNUM, 0, limit, cursor,
+                                      FALSE, NULL, NULL, NULL, NULL, NULL,
+                                      log_rev_collector, paged, pool, pool));
+      SVN_TEST_ASSERT(paged->nelts - page_start <= limit);
+      SVN_TEST_ASSERT(++pages <= expected->nelts + 1);
+    }
+  while (cursor);
+
+  SVN_TEST_INT_ASSERT(paged->nelts, expected->nelts);
+  for (i = 0; i < expected->nelts; i++)
+    SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(paged, i, svn_revnum_t),
+                        APR_ARRAY_IDX(expected, i, svn_revnum_t));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_page(const svn_test_opts_t *opts,
+              apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_array_header_t *paths = apr_array_make(pool, 2, sizeof(const char *));
+  apr_array_header_t *revs = apr_array_make(pool, 1, sizeof(svn_revnum_t));
+  apr_pool_t *subpool = svn_pool_create(pool);
+  const char *cursor;
+  svn_error_t *err;
+  int limit;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-page",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: Greek tree.  r2: edit A/mu.  r3: move A/mu to A/mu2.
+     r4: edit A/mu2 and iota.  r5: edit iota. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu", "r2", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_copy(rev_root, "A/mu", txn_root, "A/mu2", subpool));
+  SVN_ERR(svn_fs_delete(txn_root, "A/mu", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu2", "r4", subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota", "r4", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, subpool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "iota", "r5", subpool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, subpool));
+  svn_pool_clear(subpool);
+
+  for (limit = 1; limit <= 3; limit++)
+    {
+      /* The whole repository. */
+      apr_array_clear(paths);
+      SVN_ERR(check_log_pages(repos, paths, limit, subpool));
+
+      /* A file that has been moved. */
+      APR_ARRAY_PUSH(paths, const char *) = "/A/mu2";
+      SVN_ERR(check_log_pages(repos, paths, limit, subpool));
+
+      /* Several paths with interleaved histories. */
+      APR_ARRAY_PUSH(paths, const char *) = "/iota";
+      SVN_ERR(check_log_pages(repos, paths, limit, subpool));
+
+      svn_pool_clear(subpool);
+    }
+
+  /* Bogus cursors are rejected. */
+  err = svn_repos_get_logs_page(&cursor, repos, NULL, SVN_INVALID_REVNUM,
+                                0, 1, "x /A/mu2\n", FALSE, NULL, NULL, NULL,
+                                NULL, NULL, log_rev_collector, revs,
+                                subpool, subpool);
+  SVN_TEST_ASSERT_ERROR(err, SVN_ERR_INCORRECT_PARAMS);
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+
+/* Baton for the authz callbacks of get_logs_authz_subtree(). */
+typedef struct log_authz_baton_t
+{
+  /* Paths at and below this one are unreadable. */
+  const char *hidden;
+
+  /* Number of calls to log_authz_read() and changed paths received. */
+  int read_checks;
+  int changes;
+} log_authz_baton_t;
+
+/* Implements svn_repos_authz_func_t. */
+static svn_error_t *
+log_authz_read(svn_boolean_t *allowed,
+               svn_fs_root_t *root,
+               const char *path,
+               void *baton,
+               apr_pool_t *pool)
+{
+  log_authz_baton_t *lab = baton;
+
+  lab->read_checks++;
+  *allowed = !svn_fspath__skip_ancestor(lab->hidden, path);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_authz_callback_t for recursive checks. */
+static svn_error_t *
+log_authz_subtree(svn_repos_authz_access_t required,
+                  svn_boolean_t *allowed,
+                  svn_fs_root_t *root,
+                  const char *path,
+                  void *baton,
+                  apr_pool_t *pool)
+{
+  log_authz_baton_t *lab = baton;
+
+  *allowed = !svn_fspath__skip_ancestor(lab->hidden, path)
+          && !svn_fspath__skip_ancestor(path, lab->hidden);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_repos_path_change_receiver_t. */
+static svn_error_t *
+log_change_counter(void *baton,
+                   svn_repos_path_change_t *change,
+                   apr_pool_t *scratch_pool)
+{
+  log_authz_baton_t *lab = baton;
+
+  lab->changes++;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_logs_authz_subtree(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  apr_array_header_t *revs = apr_array_make(pool, 4, sizeof(svn_revnum_t));
+  log_authz_baton_t first = { "/A/D/H" };
+  log_authz_baton_t second = { "/A/D/H" };
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-get-logs-authz-subtree",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: Greek tree.  r2: edit below /A/B/E, which is readable as a whole.
+     r3: edit /A/D/gamma and /A/D/H/chi, which is not. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/E/alpha", "r2", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/B/E/beta", "r2", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/gamma", "r3", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/D/H/chi", "r3", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* The first run learns where each revision's changes are, the second
+     one can skip the per-path checks for r2. */
+  SVN_ERR(svn_repos__get_logs(repos, NULL, SVN_INVALID_REVNUM, 0, 0,
+                              FALSE, FALSE, NULL, log_authz_read,
+                              log_authz_subtree, &first,
+                              log_change_counter, &first,
+                              log_rev_collector, revs, pool));
+  SVN_ERR(svn_repos__get_logs(repos, NULL, SVN_INVALID_REVNUM, 0, 0,
+                              FALSE, FALSE, NULL, log_authz_read,
+                              log_authz_subtree, &second,
+                              log_change_counter, &second,
+                              log_rev_collector, revs, pool));
+
+  /* Same results, fewer checks. */
+  SVN_TEST_INT_ASSERT(revs->nelts, 8);
+  for (i = 0; i < 4; i++)
+    SVN_TEST_INT_ASSERT(APR_ARRAY_IDX(revs, i, svn_revnum_t),
+                        APR_ARRAY_IDX(revs, i + 4, svn_revnum_t));
+  SVN_TEST_INT_ASSERT(second.changes, first.changes);
+  SVN_TEST_INT_ASSERT(second.read_checks, first.read_checks - 2);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Tests for svn_repos_get_file_revsN() */
 
@@ -3645,6 +4089,87 @@ test_get_file_revs(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_blame_run_receiver_t.  Append the run to the
+   svn_stringbuf_t BATON as "START:COUNT:REV ". */
+static svn_error_t *
+blame_run_receiver(void *baton,
+                   apr_int64_t start_line,
+                   apr_int64_t line_count,
+                   svn_revnum_t revision,
+                   apr_hash_t *rev_props,
+                   apr_pool_t *pool)
+{
+  svn_stringbuf_t *runs = baton;
+
+  /* Revision properties come with every changed line. */
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(revision) == (rev_props != NULL));
+
+  svn_stringbuf_appendcstr(runs,
+                           apr_psprintf(pool, "%" APR_INT64_T_FMT ":%"
+                                        APR_INT64_T_FMT ":%ld ",
+                                        start_line, line_count, revision));
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_blame(const svn_test_opts_t *opts,
+           apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *runs = svn_stringbuf_create_empty(pool);
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-blame", opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1: three lines. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "/f", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/f", "a\nb\nc\n", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r2: change one line and add another. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/f", "a\nB\nc\nd\n",
+                                      pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r3: a property change, which doesn't count. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "/f", "p",
+                                  svn_string_create("v", pool), pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* r4: delete the first line. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "/f", "B\nc\nd\n", pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  SVN_ERR(svn_repos_blame(repos, "/f", 1, youngest_rev, NULL, NULL, NULL,
+                          blame_run_receiver, runs, NULL, NULL, pool));
+  SVN_TEST_STRING_ASSERT(runs->data, "0:1:2 1:1:1 2:1:2 ");
+
+  /* Lines from before the start of the range have no revision. */
+  svn_stringbuf_setempty(runs);
+  SVN_ERR(svn_repos_blame(repos, "/f", 2, youngest_rev, NULL, NULL, NULL,
+                          blame_run_receiver, runs, NULL, NULL, pool));
+  SVN_TEST_STRING_ASSERT(runs->data, "0:1:2 1:1:-1 2:1:2 ");
+
+  svn_stringbuf_setempty(runs);
+  SVN_ERR(svn_repos_blame(repos, "/f", 1, 1, NULL, NULL, NULL,
+                          blame_run_receiver, runs, NULL, NULL, pool));
+  SVN_TEST_STRING_ASSERT(runs->data, "0:3:1 ");
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 issue_4060(const svn_test_opts_t *opts,
            apr_pool_t *pool)
@@ -4073,6 +4598,63 @@ test_config_pool(const svn_test_opts_t *opts,
 }
 
 
+static svn_error_t *
+test_repos_pool(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  const char *repo_name = "test-repo-repos-pool";
+  svn_repos_t *repos, *repos1, *repos2;
+  const char *repos_path, *uuid, *old_uuid;
+  svn_repos__repos_pool_t *repos_pool;
+  apr_pool_t *subpool1 = svn_pool_create(pool);
+  apr_pool_t *subpool2 = svn_pool_create(pool);
+
+  /* BDB environments can't be removed while the pool keeps them open. */
+  if (strcmp(opts->fs_type, SVN_FS_TYPE_BDB) == 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                            "this test does not apply to BDB");
+
+  SVN_ERR(svn_test__create_repos(&repos, repo_name, opts, pool));
+  SVN_ERR(svn_dirent_get_absolute(&repos_path, repo_name, pool));
+  SVN_ERR(svn_fs_get_uuid(svn_repos_fs(repos), &old_uuid, pool));
+
+  SVN_ERR(svn_repos__repos_pool_create(&repos_pool, TRUE, pool));
+
+  /* instances in use are not being handed out a second time */
+  SVN_ERR(svn_repos__repos_pool_get(&repos1, repos_pool, repos_path, NULL,
+                                    subpool1, pool));
+  SVN_ERR(svn_repos__repos_pool_get(&repos2, repos_pool, repos_path, NULL,
+                                    subpool2, pool));
+  SVN_TEST_ASSERT(repos1 != repos2);
+
+  /* released instances get reused */
+  svn_pool_clear(subpool1);
+  SVN_ERR(svn_repos__repos_pool_get(&repos, repos_pool, repos_path, NULL,
+                                    subpool1, pool));
+  SVN_TEST_ASSERT(repos == repos1);
+
+  svn_pool_clear(subpool2);
+  SVN_ERR(svn_repos__repos_pool_get(&repos, repos_pool, repos_path, NULL,
+                                    subpool2, pool));
+  SVN_TEST_ASSERT(repos == repos2);
+
+  svn_pool_clear(subpool1);
+  svn_pool_clear(subpool2);
+
+  /* a new repository at the same location must not be confused with the
+     old one */
+  SVN_ERR(svn_test__create_repos(&repos, repo_name, opts, pool));
+  SVN_ERR(svn_repos__repos_pool_get(&repos, repos_pool, repos_path, NULL,
+                                    subpool1, pool));
+  SVN_ERR(svn_fs_get_uuid(svn_repos_fs(repos), &uuid, pool));
+  SVN_TEST_ASSERT(strcmp(uuid, old_uuid) != 0);
+
+  svn_pool_destroy(subpool1);
+  svn_pool_destroy(subpool2);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_repos_fs_type(const svn_test_opts_t *opts,
                    apr_pool_t *pool)
@@ -4431,6 +5013,29 @@ list_callback(const char *path,
   return SVN_NO_ERROR;
 }
 
+/* Implements svn_repos_dirent_receiver_t.  Verify the details reported for
+ * the nodes of test_list() and count them in *BATON. */
+static svn_error_t *
+list_author_callback(const char *path,
+                     svn_dirent_t *dirent,
+                     void *baton,
+                     apr_pool_t *pool)
+{
+  /* Only A/mu and its parent directory got changed in r2. */
+  svn_boolean_t changed = (strcmp(path, "/A") == 0
+                           || strcmp(path, "/A/mu") == 0);
+
+  SVN_TEST_ASSERT(dirent->created_rev == (changed ? 2 : 1));
+  SVN_TEST_ASSERT(dirent->time != 0);
+  if (changed)
+    SVN_TEST_STRING_ASSERT(dirent->last_author, "jconstant");
+  else
+    SVN_TEST_ASSERT(dirent->last_author == NULL);
+
+  *(int *)baton += 1;
+
+  return SVN_NO_ERROR;
+}
 
 static svn_error_t *
 test_list(const svn_test_opts_t *opts,
@@ -4465,6 +5070,257 @@ test_list(const svn_test_opts_t *opts,
                          pool));
   SVN_TEST_ASSERT(counter == 7);
 
+  /* Commit a change to one file by another author. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "A/mu", "changed\n", pool));
+  SVN_ERR(svn_fs_change_txn_prop(txn, SVN_PROP_REVISION_AUTHOR,
+                                 svn_string_create("jconstant", pool),
+                                 pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* Each node gets the author of its own last change. */
+  counter = 0;
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
+  SVN_ERR(svn_repos_list(rev_root, "/A", NULL, svn_depth_infinity, FALSE,
+                         NULL, NULL, list_author_callback, &counter,
+                         NULL, NULL, pool));
+  SVN_TEST_ASSERT(counter == 19);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for verify_notify_func(). */
+struct verify_notify_baton_t
+{
+  /* The next revision that we expect to be reported as verified. */
+  svn_revnum_t next_rev;
+
+  /* Set if notifications came in the wrong order. */
+  svn_boolean_t out_of_order;
+};
+
+/* Implements svn_repos_notify_func_t.  Check that the per-revision
+   notifications arrive in ascending revision order. */
+static void
+verify_notify_func(void *baton,
+                   const svn_repos_notify_t *notify,
+                   apr_pool_t *scratch_pool)
+{
+  struct verify_notify_baton_t *b = baton;
+
+  if (notify->action != svn_repos_notify_verify_rev_end)
+    return;
+
+  if (notify->revision != b->next_rev)
+    b->out_of_order = TRUE;
+
+  b->next_rev = notify->revision + 1;
+}
+
+static svn_error_t *
+test_verify_concurrently(const svn_test_opts_t *opts,
+                         apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  struct verify_notify_baton_t baton;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  /* Create a repository with a number of revisions to verify. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-verify-concurrently",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  for (i = 0; i < 20; ++i)
+    {
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                          apr_psprintf(iterpool, "%d", i),
+                                          iterpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Verify all of them using more workers than there are revisions per
+     worker.  Results must be reported in revision order. */
+  baton.next_rev = 0;
+  baton.out_of_order = FALSE;
+  SVN_ERR(svn_repos_verify_fs4(repos, 0, youngest_rev, FALSE, FALSE, 8,
+                               verify_notify_func, &baton, NULL, NULL,
+                               NULL, NULL, pool));
+  SVN_TEST_ASSERT(!baton.out_of_order);
+  SVN_TEST_ASSERT(baton.next_rev == youngest_rev + 1);
+
+  /* Same for a sub-range. */
+  baton.next_rev = 5;
+  SVN_ERR(svn_repos_verify_fs4(repos, 5, 12, FALSE, FALSE, 3,
+                               verify_notify_func, &baton, NULL, NULL,
+                               NULL, NULL, pool));
+  SVN_TEST_ASSERT(!baton.out_of_order);
+  SVN_TEST_ASSERT(baton.next_rev == 13);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Return the contents of file number I in revision REV of the
+   test_update_report_prefetch repository. */
+static const char *
+prefetch_file_contents(int i,
+                       svn_revnum_t rev,
+                       apr_pool_t *pool)
+{
+  /* Leave every fourth file unchanged. */
+  if (rev == 1 || i % 4 == 3)
+    return apr_psprintf(pool, "This is file %d.\n", i);
+
+  return apr_psprintf(pool, "This is file %d.\nIt changed.\n", i);
+}
+
+static svn_error_t *
+test_update_report_prefetch(const svn_test_opts_t *opts,
+                            apr_pool_t *pool)
+{
+  enum { file_count = 40 };
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  const svn_delta_editor_t *editor;
+  void *edit_baton, *report_baton;
+  svn_test__tree_entry_t entries[file_count + 2];
+  svn_stringbuf_t *big;
+  svn_revnum_t rev;
+  int i;
+
+  /* Many modified files in one directory make the reporter compute
+     their deltas in the background.  Include a file too large for
+     that. */
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-update-prefetch",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  big = svn_stringbuf_create_empty(pool);
+  while (big->len < 1024 * 1024)
+    svn_stringbuf_appendcstr(big, "Some filler text for a big file.\n");
+
+  for (rev = 1; rev <= 2; ++rev)
+    {
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, rev - 1, pool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+      if (rev == 1)
+        SVN_ERR(svn_fs_make_dir(txn_root, "A", pool));
+
+      for (i = 0; i < file_count; ++i)
+        {
+          const char *path = apr_psprintf(pool, "A/f%02d", i);
+
+          if (rev == 1)
+            SVN_ERR(svn_fs_make_file(txn_root, path, pool));
+          if (rev == 1 || i % 4 != 3)
+            SVN_ERR(svn_test__set_file_contents(txn_root, path,
+                                                prefetch_file_contents(i, rev,
+                                                                       pool),
+                                                pool));
+        }
+
+      if (rev == 1)
+        SVN_ERR(svn_fs_make_file(txn_root, "A/big", pool));
+      else
+        svn_stringbuf_appendcstr(big, "The end.\n");
+      SVN_ERR(svn_test__set_file_contents(txn_root, "A/big", big->data,
+                                          pool));
+
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      pool));
+    }
+
+  /* Update a copy of r1 to r2. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 1, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs, txn_root, "",
+                               pool));
+
+  SVN_ERR(svn_repos_begin_report3(&report_baton, 2, repos, "/", "", NULL,
+                                  TRUE, svn_depth_infinity, FALSE, FALSE,
+                                  editor, edit_baton, NULL, NULL, 0, pool));
+  SVN_ERR(svn_repos_set_path3(report_baton, "", 1, svn_depth_infinity,
+                              FALSE, NULL, pool));
+  SVN_ERR(svn_repos_finish_report(report_baton, pool));
+
+  /* All files must have their r2 contents now. */
+  entries[0].path = "A";
+  entries[0].contents = NULL;
+  for (i = 0; i < file_count; ++i)
+    {
+      entries[i + 1].path = apr_psprintf(pool, "A/f%02d", i);
+      entries[i + 1].contents = prefetch_file_contents(i, 2, pool);
+    }
+  entries[file_count + 1].path = "A/big";
+  entries[file_count + 1].contents = big->data;
+
+  SVN_ERR(svn_test__validate_tree(txn_root, entries,
+                                  sizeof(entries) / sizeof(entries[0]),
+                                  pool));
+
+  svn_error_clear(svn_fs_abort_txn(txn, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_warm_cache(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root, *rev_root;
+  svn_revnum_t youngest_rev;
+  apr_array_header_t *paths;
+  svn_stringbuf_t *contents;
+  svn_stream_t *stream;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-warm-cache",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__create_greek_tree(txn_root, pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+
+  /* Missing paths must be skipped and the number of revisions may
+     exceed the youngest revision. */
+  paths = apr_array_make(pool, 3, sizeof(const char *));
+  APR_ARRAY_PUSH(paths, const char *) = "/A/D";
+  APR_ARRAY_PUSH(paths, const char *) = "/no/such/path";
+  APR_ARRAY_PUSH(paths, const char *) = "/iota";
+  SVN_ERR(svn_repos_warm_cache(repos, paths, 10, 0, NULL, NULL, pool));
+  SVN_ERR(svn_repos_warm_cache(repos, NULL, 0, 0, NULL, NULL, pool));
+
+  /* A mere optimization.  The data must still be the same. */
+  SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_file_contents(&stream, rev_root, "A/D/G/pi", pool));
+  SVN_ERR(svn_stringbuf_from_stream(&contents, stream, 0, pool));
+  SVN_TEST_STRING_ASSERT(contents->data, "This is the file 'pi'.\n");
+
   return SVN_NO_ERROR;
 }
 
@@ -4507,8 +5363,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test if revprops are validated by repos"),
     SVN_TEST_OPTS_PASS(get_logs,
                        "test svn_repos_get_logs ranges and limits"),
+    SVN_TEST_OPTS_PASS(get_logs_page,
+                       "test svn_repos_get_logs_page cursors"),
+    SVN_TEST_OPTS_PASS(get_logs_authz_subtree,
+                       "test log skipping authz for readable subtrees"),
     SVN_TEST_OPTS_PASS(test_get_file_revs,
                        "test svn_repos_get_file_revsN"),
+    SVN_TEST_OPTS_PASS(test_blame,
+                       "test svn_repos_blame"),
     SVN_TEST_OPTS_PASS(issue_4060,
                        "test issue 4060"),
     SVN_TEST_OPTS_PASS(test_delete_repos,
@@ -4519,6 +5381,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test svn_repos_info_*"),
     SVN_TEST_OPTS_PASS(test_config_pool,
                        "test svn_repos__config_pool_*"),
+    SVN_TEST_OPTS_PASS(test_repos_pool,
+                       "test svn_repos__repos_pool_*"),
     SVN_TEST_OPTS_PASS(test_repos_fs_type,
                        "test test_repos_fs_type"),
     SVN_TEST_OPTS_PASS(deprecated_access_context_api,
@@ -4531,6 +5395,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test authz prefixes"),
     SVN_TEST_PASS2(test_authz_recursive_override,
                    "test recursively authz rule override"),
+    SVN_TEST_PASS2(test_authz_decision_cache,
+                   "test authz decision caching"),
+    SVN_TEST_PASS2(test_authz_check_access_many,
+                   "test checking authz for many paths at once"),
     SVN_TEST_PASS2(test_authz_pattern_tests,
                    "test various basic authz pattern combinations"),
     SVN_TEST_PASS2(test_authz_wildcards,
@@ -4539,6 +5407,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "optional authz wildcard performance test"),
     SVN_TEST_OPTS_PASS(test_list,
                        "test svn_repos_list"),
+    SVN_TEST_OPTS_PASS(test_verify_concurrently,
+                       "test svn_repos_verify_fs4 with multiple jobs"),
+    SVN_TEST_OPTS_PASS(test_update_report_prefetch,
+                       "test update report with many modified files"),
+    SVN_TEST_OPTS_PASS(node_locations_replaced,
+                       "test svn_repos_trace_node_locations on replacement"),
+    SVN_TEST_OPTS_PASS(test_warm_cache,
+                       "test svn_repos_warm_cache"),
     SVN_TEST_NULL
   };
 
@@ -22,14 +22,17 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <apr_general.h>
 #include <apr_lib.h>
 #include <apr_time.h>
+#include <apr_thread_proc.h>
 
 #include "svn_pools.h"
 
 #include "private/svn_cache.h"
+#include "private/svn_stats.h"
 #include "svn_private_config.h"
 
 #include "../svn_test.h"
@@ -489,6 +492,38 @@ test_null_cache(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_layered_cache(apr_pool_t *pool)
+{
+  svn_cache__t *front, *back, *cache;
+  svn_revnum_t forty = 40, *answer;
+  svn_boolean_t found;
+
+  SVN_ERR(svn_cache__create_inprocess(&front, serialize_revnum,
+                                      deserialize_revnum,
+                                      APR_HASH_KEY_STRING, 1, 2, TRUE,
+                                      "front", pool));
+  SVN_ERR(svn_cache__create_inprocess(&back, serialize_revnum,
+                                      deserialize_revnum,
+                                      APR_HASH_KEY_STRING, 1, 2, TRUE,
+                                      "back", pool));
+  SVN_ERR(svn_cache__create_layered(&cache, front, back, pool));
+
+  SVN_ERR(basic_cache_test(cache, FALSE, pool));
+
+  /* Entries only found in BACK get copied to FRONT. */
+  SVN_ERR(svn_cache__set(back, "forty", &forty, pool));
+  SVN_ERR(svn_cache__has_key(&found, front, "forty", pool));
+  SVN_TEST_ASSERT(!found);
+
+  SVN_ERR(svn_cache__get((void **)&answer, &found, cache, "forty", pool));
+  SVN_TEST_ASSERT(found && *answer == 40);
+  SVN_ERR(svn_cache__get((void **)&answer, &found, front, "forty", pool));
+  SVN_TEST_ASSERT(found && *answer == 40);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_membuffer_unaligned_string_keys(apr_pool_t *pool)
 {
@@ -590,6 +625,582 @@ test_membuffer_unaligned_fixed_keys(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_membuffer_admission_filter(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_cache__info_t info;
+  svn_stringbuf_t *value = svn_stringbuf_create_ensure(200, pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t key;
+  int i;
+
+  /* Small data buffer but plenty of directory entries such that inserting
+   * new items will evict old ones from the data buffer. */
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 100 * 1024,
+                                            40 * 1024, 1, FALSE, FALSE,
+                                            pool));
+  SVN_ERR(svn_cache__membuffer_enable_admission_filter(membuffer, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, NULL, NULL, sizeof(key), "admission",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, FALSE, FALSE,
+            pool, pool));
+
+  memset(value->data, 'x', 200);
+  value->data[200] = '\0';
+  value->len = 200;
+
+  /* Add a few items and use them frequently. */
+  for (key = 0; key < 20; ++key)
+    SVN_ERR(svn_cache__set(cache, &key, value, pool));
+
+  for (i = 0; i < 10; ++i)
+    for (key = 0; key < 20; ++key)
+      {
+        svn_stringbuf_t *result;
+        svn_boolean_t found;
+
+        svn_pool_clear(iterpool);
+        SVN_ERR(svn_cache__get((void **)&result, &found, cache, &key,
+                               iterpool));
+        SVN_TEST_ASSERT(found);
+      }
+
+  /* Scan lots of items that are read only once. */
+  for (key = 1000; key < 3000; ++key)
+    {
+      svn_stringbuf_t *result;
+      svn_boolean_t found;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_cache__get((void **)&result, &found, cache, &key,
+                             iterpool));
+      SVN_TEST_ASSERT(!found);
+      SVN_ERR(svn_cache__set(cache, &key, value, iterpool));
+    }
+
+  /* The frequently used items must have survived. */
+  for (key = 0; key < 20; ++key)
+    {
+      svn_stringbuf_t *result;
+      svn_boolean_t found;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_cache__get((void **)&result, &found, cache, &key,
+                             iterpool));
+      SVN_TEST_ASSERT(found);
+      SVN_TEST_STRING_ASSERT(result->data, value->data);
+    }
+
+  /* The scan data should have been rejected. */
+  SVN_ERR(svn_cache__get_info(cache, &info, FALSE, pool));
+  SVN_TEST_ASSERT(info.admission_rejects > 0);
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_membuffer_size_estimates(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_cache__info_t info;
+  svn_stringbuf_t *value = svn_stringbuf_create_ensure(200, pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_revnum_t key;
+  svn_revnum_t key_count;
+  int i;
+
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 1024 * 1024,
+                                            200 * 1024, 1, FALSE, FALSE,
+                                            pool));
+  SVN_ERR(svn_cache__membuffer_enable_size_estimates(membuffer, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, NULL, NULL, sizeof(key), "estimates",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, FALSE, FALSE,
+            pool, pool));
+
+  memset(value->data, 'x', 200);
+  value->data[200] = '\0';
+  value->len = 200;
+
+  /* Loop over a working set about twice the size of the cache.  An LRU
+   * cache gets no hits at all for this until it is large enough. */
+  SVN_ERR(svn_cache__get_info(cache, &info, FALSE, pool));
+  key_count = (svn_revnum_t)(2 * info.data_size / 200);
+
+  for (i = 0; i < 5; ++i)
+    for (key = 0; key < key_count; ++key)
+      {
+        svn_stringbuf_t *result;
+        svn_boolean_t found;
+
+        svn_pool_clear(iterpool);
+        SVN_ERR(svn_cache__get((void **)&result, &found, cache, &key,
+                               iterpool));
+        if (!found)
+          SVN_ERR(svn_cache__set(cache, &key, value, iterpool));
+      }
+
+  SVN_ERR(svn_cache__get_info(cache, &info, FALSE, pool));
+  SVN_TEST_ASSERT(info.estimate_sizes[3] == info.data_size);
+  for (i = 1; i < SVN_CACHE__SIZE_ESTIMATES; ++i)
+    {
+      SVN_TEST_ASSERT(info.estimate_sizes[i] > info.estimate_sizes[i-1]);
+      SVN_TEST_ASSERT(info.estimated_hit_ratios[i]
+                      >= info.estimated_hit_ratios[i-1]);
+    }
+
+  /* Everything but the first pass hits with 4 times the size. */
+  SVN_TEST_ASSERT(info.estimated_hit_ratios[0] < 0.1);
+  SVN_TEST_ASSERT(info.estimated_hit_ratios[5] > 0.7);
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Number of distinct keys used by the concurrent lookup test. */
+#define CONCURRENT_KEY_COUNT 1000
+
+/* Number of lookups per thread in the concurrent lookup test. */
+#define CONCURRENT_LOOKUP_COUNT 200000
+
+#if APR_HAS_THREADS
+/* Baton type for concurrent_lookup_thread. */
+typedef struct concurrent_lookup_baton_t
+{
+  /* Thread-safe cache to read from and, optionally, write to. */
+  svn_cache__t *cache;
+
+  /* If set, overwrite every 16th entry with the same value. */
+  svn_boolean_t write;
+
+  /* Set to an error if the thread found an inconsistency. */
+  svn_error_t *err;
+} concurrent_lookup_baton_t;
+
+/* Look up all keys in BATON->CACHE many times and verify the results.
+ * Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+concurrent_lookups(concurrent_lookup_baton_t *baton,
+                   apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < CONCURRENT_LOOKUP_COUNT; ++i)
+    {
+      svn_revnum_t key = i % CONCURRENT_KEY_COUNT;
+      svn_revnum_t *value;
+      svn_boolean_t found;
+
+      if ((i % 1000) == 0)
+        svn_pool_clear(iterpool);
+
+      if (baton->write && (i % 16) == 0)
+        SVN_ERR(svn_cache__set(baton->cache, &key, &key, iterpool));
+
+      SVN_ERR(svn_cache__get((void **)&value, &found, baton->cache, &key,
+                             iterpool));
+
+      /* Items may be evicted but must never be wrong. */
+      if (found && *value != key)
+        return svn_error_createf(SVN_ERR_TEST_FAILED, NULL,
+                                 "expected %ld but found %ld",
+                                 key, *value);
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+static void *
+APR_THREAD_FUNC concurrent_lookup_thread(apr_thread_t *tid, void *data)
+{
+  concurrent_lookup_baton_t *baton = data;
+  apr_pool_t *pool = svn_pool_create(NULL);
+
+  baton->err = concurrent_lookups(baton, pool);
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(tid, APR_SUCCESS);
+
+  return NULL;
+}
+
+/* Run CONCURRENT_LOOKUP_COUNT lookups in each of THREAD_COUNT threads
+ * against CACHE.  Have one additional writer thread if WRITE is set.
+ * Return the time it took in *DURATION. */
+static svn_error_t *
+run_concurrent_lookups(apr_interval_time_t *duration,
+                       svn_cache__t *cache,
+                       int thread_count,
+                       svn_boolean_t write,
+                       apr_pool_t *pool)
+{
+  int total_count = thread_count + (write ? 1 : 0);
+  apr_thread_t **threads = apr_pcalloc(pool, total_count * sizeof(*threads));
+  concurrent_lookup_baton_t *batons
+    = apr_pcalloc(pool, total_count * sizeof(*batons));
+  apr_time_t start = apr_time_now();
+  svn_error_t *err = SVN_NO_ERROR;
+  int i;
+
+  for (i = 0; i < total_count; ++i)
+    {
+      apr_status_t status;
+
+      batons[i].cache = cache;
+      batons[i].write = i >= thread_count;
+
+      status = apr_thread_create(&threads[i], NULL, concurrent_lookup_thread,
+                                 &batons[i], pool);
+      if (status)
+        return svn_error_wrap_apr(status, "Can't create thread");
+    }
+
+  /* wait for the threads to finish */
+  for (i = 0; i < total_count; ++i)
+    {
+      apr_status_t retval;
+      apr_status_t status = apr_thread_join(&retval, threads[i]);
+      if (status)
+        return svn_error_wrap_apr(status, "Can't join thread");
+
+      err = svn_error_compose_create(err, batons[i].err);
+    }
+
+  *duration = apr_time_now() - start;
+  return svn_error_trace(err);
+}
+#endif
+
+static svn_error_t *
+test_membuffer_concurrent_lookup(const svn_test_opts_t *opts,
+                                 apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_revnum_t key;
+  int thread_count;
+
+  /* Use a single segment to maximize contention. */
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 1024*1024, 0, 1,
+                                            TRUE, TRUE, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, serialize_revnum, deserialize_revnum,
+            sizeof(key), "concurrent",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY, TRUE, FALSE,
+            pool, pool));
+
+  for (key = 0; key < CONCURRENT_KEY_COUNT; ++key)
+    SVN_ERR(svn_cache__set(cache, &key, &key, pool));
+
+  /* Lookups should scale with the number of threads.
+   * Print the timings in verbose mode to be able to see that. */
+  for (thread_count = 1; thread_count <= 16; thread_count *= 2)
+    {
+      apr_interval_time_t read_only, read_write;
+
+      SVN_ERR(run_concurrent_lookups(&read_only, cache, thread_count, FALSE,
+                                     pool));
+      SVN_ERR(run_concurrent_lookups(&read_write, cache, thread_count, TRUE,
+                                     pool));
+
+      if (opts->verbose)
+        printf("%2d threads: %8" APR_INT64_T_FMT " usec read-only, "
+               "%8" APR_INT64_T_FMT " usec with writer\n",
+               thread_count, (apr_int64_t)read_only,
+               (apr_int64_t)read_write);
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_membuffer_shared_cache(apr_pool_t *pool)
+{
+#if APR_HAS_FORK
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_revnum_t key = 42;
+  svn_revnum_t *value;
+  svn_boolean_t found;
+  svn_error_t *err;
+  apr_proc_t proc;
+  apr_status_t status;
+  int exitcode;
+  apr_exit_why_e exitwhy;
+
+  err = svn_cache__membuffer_cache_create_shared(&membuffer, 1024*1024, 0,
+                                                 0, FALSE, pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, err,
+                            "shared caches not supported");
+  SVN_ERR(err);
+
+  status = apr_proc_fork(&proc, pool);
+  if (status == APR_INCHILD)
+    {
+      /* Create a separate front-end in the child and add an item. */
+      err = svn_cache__create_membuffer_cache(
+              &cache, membuffer, serialize_revnum, deserialize_revnum,
+              sizeof(key), "shared", SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+              TRUE, FALSE, pool, pool);
+      if (!err)
+        err = svn_cache__set(cache, &key, &key, pool);
+
+      exit(err ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+  else if (status != APR_INPARENT)
+    {
+      return svn_error_wrap_apr(status, "Can't fork");
+    }
+
+  status = apr_proc_wait(&proc, &exitcode, &exitwhy, APR_WAIT);
+  if (status != APR_CHILD_DONE)
+    return svn_error_wrap_apr(status, "Can't wait for child process");
+  SVN_TEST_ASSERT(APR_PROC_CHECK_EXIT(exitwhy) && exitcode == EXIT_SUCCESS);
+
+  /* The item written by the child must be visible to the parent. */
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, serialize_revnum, deserialize_revnum,
+            sizeof(key), "shared", SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+            TRUE, FALSE, pool, pool));
+  SVN_ERR(svn_cache__get((void **)&value, &found, cache, &key, pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*value == key);
+
+  return SVN_NO_ERROR;
+#else
+  return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                          "fork() not supported");
+#endif
+}
+
+#if APR_HAS_FORK
+/* Fork a process that adds VALUE under KEY to a new front-end of MEMBUFFER
+ * with PREFIX and wait for it to finish.  Use POOL for allocations. */
+static svn_error_t *
+set_in_child(svn_membuffer_t *membuffer,
+             const char *prefix,
+             svn_revnum_t key,
+             svn_revnum_t value,
+             apr_pool_t *pool)
+{
+  apr_proc_t proc;
+  apr_status_t status;
+  int exitcode;
+  apr_exit_why_e exitwhy;
+
+  status = apr_proc_fork(&proc, pool);
+  if (status == APR_INCHILD)
+    {
+      svn_cache__t *cache;
+      svn_error_t *err;
+
+      err = svn_cache__create_membuffer_cache(
+              &cache, membuffer, serialize_revnum, deserialize_revnum,
+              sizeof(key), prefix, SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+              TRUE, FALSE, pool, pool);
+      if (!err)
+        err = svn_cache__set(cache, &key, &value, pool);
+
+      exit(err ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+  else if (status != APR_INPARENT)
+    {
+      return svn_error_wrap_apr(status, "Can't fork");
+    }
+
+  status = apr_proc_wait(&proc, &exitcode, &exitwhy, APR_WAIT);
+  if (status != APR_CHILD_DONE)
+    return svn_error_wrap_apr(status, "Can't wait for child process");
+  SVN_TEST_ASSERT(APR_PROC_CHECK_EXIT(exitwhy) && exitcode == EXIT_SUCCESS);
+
+  return SVN_NO_ERROR;
+}
+#endif
+
+static svn_error_t *
+test_membuffer_shared_prefixes(apr_pool_t *pool)
+{
+#if APR_HAS_FORK
+  svn_cache__t *cache;
+  svn_membuffer_t *membuffer;
+  svn_revnum_t key = 42;
+  svn_revnum_t *value;
+  svn_boolean_t found;
+  svn_error_t *err;
+
+  err = svn_cache__membuffer_cache_create_shared(&membuffer, 1024*1024, 0,
+                                                 0, FALSE, pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, err,
+                            "shared caches not supported");
+  SVN_ERR(err);
+
+  /* Each child registers a new prefix after the fork. */
+  SVN_ERR(set_in_child(membuffer, "first-prefix", key, 1, pool));
+  SVN_ERR(set_in_child(membuffer, "second-prefix", key, 2, pool));
+
+  /* Both prefixes must still be intact and map to their own items. */
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, serialize_revnum, deserialize_revnum,
+            sizeof(key), "first-prefix",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+            TRUE, FALSE, pool, pool));
+  SVN_ERR(svn_cache__get((void **)&value, &found, cache, &key, pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*value == 1);
+
+  SVN_ERR(svn_cache__create_membuffer_cache(
+            &cache, membuffer, serialize_revnum, deserialize_revnum,
+            sizeof(key), "second-prefix",
+            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+            TRUE, FALSE, pool, pool));
+  SVN_ERR(svn_cache__get((void **)&value, &found, cache, &key, pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*value == 2);
+
+  return SVN_NO_ERROR;
+#else
+  return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL,
+                          "fork() not supported");
+#endif
+}
+
+
+SVN__COUNTER_DEFINE(test_counter, "test.counter");
+SVN__COUNTER_DEFINE(test_timer, "test.timer");
+
+static svn_error_t *
+test_stats_counters(apr_pool_t *pool)
+{
+  apr_array_header_t *infos;
+  const svn_stats__info_t *counter_info = NULL;
+  const svn_stats__info_t *timer_info = NULL;
+  apr_time_t start;
+  int i;
+
+  svn_stats__set_enabled(TRUE);
+
+  SVN__COUNTER_INC(test_counter);
+  SVN__COUNTER_ADD(test_counter, 41);
+  SVN__TIMER_START(test_timer, start);
+  SVN_TEST_ASSERT(start != 0);
+  SVN__TIMER_STOP(test_timer, start);
+
+  SVN_ERR(svn_stats__get_info(&infos, pool));
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_stats__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_stats__info_t *);
+
+      if (strcmp(info->name, "test.counter") == 0)
+        counter_info = info;
+      else if (strcmp(info->name, "test.timer") == 0)
+        timer_info = info;
+
+      if (i > 0)
+        SVN_TEST_ASSERT(strcmp(APR_ARRAY_IDX(infos, i - 1,
+                                             svn_stats__info_t *)->name,
+                               info->name) <= 0);
+    }
+
+  SVN_TEST_ASSERT(counter_info);
+  SVN_TEST_ASSERT(counter_info->count == 2);
+  SVN_TEST_ASSERT(counter_info->total == 42);
+  SVN_TEST_STRING_ASSERT(svn_stats__format_info(counter_info, pool)->data,
+                         "test.counter: 2 events, total 42, average 21");
+
+  SVN_TEST_ASSERT(timer_info);
+  SVN_TEST_ASSERT(timer_info->count == 1);
+  SVN_TEST_ASSERT(svn_stats__enabled());
+
+  /* Counters created at runtime are unique per name. */
+  {
+    svn_stats__counter_t *dynamic = svn_stats__get_counter("test.dynamic");
+
+    SVN_TEST_ASSERT(dynamic);
+    SVN_TEST_ASSERT(svn_stats__get_counter("test.dynamic") == dynamic);
+    SVN__COUNTER_ADD(*dynamic, 5);
+    SVN_TEST_ASSERT(dynamic->count == 1 && dynamic->total == 5);
+  }
+
+  /* Only counters that changed since the snapshot get reported. */
+  {
+    apr_array_header_t *before = infos;
+    apr_array_header_t *changes;
+
+    SVN__COUNTER_ADD(test_counter, 8);
+    SVN_ERR(svn_stats__get_info(&infos, pool));
+    SVN_ERR(svn_stats__get_changes(&changes, before, infos, pool));
+
+    counter_info = NULL;
+    for (i = 0; i < changes->nelts; ++i)
+      {
+        const svn_stats__info_t *info
+          = APR_ARRAY_IDX(changes, i, const svn_stats__info_t *);
+
+        SVN_TEST_ASSERT(strcmp(info->name, "test.timer") != 0);
+        if (strcmp(info->name, "test.counter") == 0)
+          counter_info = info;
+      }
+
+    SVN_TEST_ASSERT(counter_info);
+    SVN_TEST_ASSERT(counter_info->count == 1);
+    SVN_TEST_ASSERT(counter_info->total == 8);
+  }
+
+  svn_stats__reset();
+  SVN_ERR(svn_stats__get_info(&infos, pool));
+  for (i = 0; i < infos->nelts; ++i)
+    SVN_TEST_ASSERT(APR_ARRAY_IDX(infos, i, svn_stats__info_t *)->count == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_membuffer_segment_infos(apr_pool_t *pool)
+{
+  apr_array_header_t *infos;
+  svn_cache__info_t *global_info;
+  apr_uint64_t gets = 0;
+  apr_uint64_t used_entries = 0;
+  int i;
+
+  infos = svn_cache__membuffer_get_global_segment_infos(pool);
+  if (!svn_cache__get_global_membuffer_cache())
+    {
+      SVN_TEST_ASSERT(infos->nelts == 0);
+      return SVN_NO_ERROR;
+    }
+
+  global_info = svn_cache__membuffer_get_global_info(pool);
+  SVN_TEST_ASSERT(infos->nelts > 0);
+
+  for (i = 0; i < infos->nelts; ++i)
+    {
+      const svn_cache__info_t *info
+        = APR_ARRAY_IDX(infos, i, const svn_cache__info_t *);
+
+      SVN_TEST_STRING_ASSERT(info->id, apr_psprintf(pool, "%d", i));
+      gets += info->gets;
+      used_entries += info->used_entries;
+    }
+
+  SVN_TEST_ASSERT(gets == global_info->gets);
+  SVN_TEST_ASSERT(used_entries == global_info->used_entries);
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* The test table.  */
 
@@ -616,6 +1227,23 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test membuffer cache with unaligned string keys"),
     SVN_TEST_PASS2(test_membuffer_unaligned_fixed_keys,
                    "test membuffer cache with unaligned fixed keys"),
+    SVN_TEST_PASS2(test_membuffer_admission_filter,
+                   "test membuffer cache admission filter"),
+    SVN_TEST_OPTS_SKIP(test_membuffer_concurrent_lookup,
+                       ! APR_HAS_THREADS,
+                       "test concurrent membuffer cache lookups"),
+    SVN_TEST_PASS2(test_membuffer_shared_cache,
+                   "test membuffer cache shared between processes"),
+    SVN_TEST_PASS2(test_membuffer_shared_prefixes,
+                   "test prefixes registered by forked processes"),
+    SVN_TEST_PASS2(test_stats_counters,
+                   "test process-wide statistics counters"),
+    SVN_TEST_PASS2(test_membuffer_segment_infos,
+                   "test per-segment membuffer cache stats"),
+    SVN_TEST_PASS2(test_membuffer_size_estimates,
+                   "test membuffer cache size estimates"),
+    SVN_TEST_PASS2(test_layered_cache,
+                   "test a cache layered in front of another"),
     SVN_TEST_NULL
   };
 
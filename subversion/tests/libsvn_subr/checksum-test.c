@@ -21,12 +21,17 @@
  * ====================================================================
  */
 
+#include <string.h>
 #include <apr_pools.h>
+#include <apr_sha1.h>
 
 #include <zlib.h>
 
 #include "svn_error.h"
 #include "svn_io.h"
+#include "svn_sorts.h"
+#include "private/svn_io_private.h"
+#include "private/svn_subr_private.h"
 
 #include "../svn_test.h"
 
@@ -364,6 +369,116 @@ test_checksummed_stream_reset(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Fill LEN bytes in BUF with some pseudo-random, reproducible data. */
+static void
+fill_test_data(char *buf,
+               apr_size_t len)
+{
+  apr_uint32_t seed = 0x12345678;
+  apr_size_t i;
+
+  for (i = 0; i < len; ++i)
+    {
+      seed = seed * 1103515245 + 12345;
+      buf[i] = (char)(seed >> 16);
+    }
+}
+
+static svn_error_t *
+test_sha1_implementation(apr_pool_t *pool)
+{
+  enum { DATA_SIZE = 70000 };
+  char *data = apr_palloc(pool, DATA_SIZE);
+  apr_size_t lens[] = { 0, 1, 55, 56, 63, 64, 65, 119, 120, 127, 128,
+                        1000, DATA_SIZE };
+  apr_size_t steps[] = { 1, 7, 64, 4096, DATA_SIZE };
+  svn_checksum_t *checksum;
+  apr_size_t i, k;
+
+  /* Well-known test vector. */
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, "abc", 3, pool));
+  SVN_TEST_STRING_ASSERT(svn_checksum_to_cstring_display(checksum, pool),
+                         "a9993e364706816aba3e25717850c26c9cd0d89d");
+
+  /* Whichever implementation svn_checksum uses, its results must match
+     APR's, regardless of how the data gets fed into the context. */
+  fill_test_data(data, DATA_SIZE);
+  for (i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i)
+    {
+      apr_sha1_ctx_t apr_ctx;
+      unsigned char digest[APR_SHA1_DIGESTSIZE];
+
+      apr_sha1_init(&apr_ctx);
+      apr_sha1_update(&apr_ctx, data, (unsigned int)lens[i]);
+      apr_sha1_final(digest, &apr_ctx);
+
+      SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, data, lens[i],
+                           pool));
+      SVN_TEST_ASSERT(memcmp(checksum->digest, digest, sizeof(digest)) == 0);
+
+      for (k = 0; k < sizeof(steps) / sizeof(steps[0]); ++k)
+        {
+          svn_checksum_ctx_t *ctx
+            = svn_checksum_ctx_create(svn_checksum_sha1, pool);
+          apr_size_t pos;
+
+          for (pos = 0; pos < lens[i]; pos += steps[k])
+            SVN_ERR(svn_checksum_update(ctx, data + pos,
+                                        MIN(steps[k], lens[i] - pos)));
+
+          SVN_ERR(svn_checksum_final(&checksum, ctx, pool));
+          SVN_TEST_ASSERT(memcmp(checksum->digest, digest,
+                                 sizeof(digest)) == 0);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_checksummed_stream_dual(apr_pool_t *pool)
+{
+  enum { DATA_SIZE = 100000 };
+  char *data = apr_palloc(pool, DATA_SIZE);
+  svn_string_t *str;
+  svn_stream_t *stream;
+  svn_checksum_t *md5_checksum, *sha1_checksum;
+  svn_checksum_t *expected_md5, *expected_sha1;
+  svn_stringbuf_t *written = svn_stringbuf_create_empty(pool);
+  apr_size_t len = DATA_SIZE;
+
+  fill_test_data(data, DATA_SIZE);
+  str = svn_string_ncreate(data, DATA_SIZE, pool);
+  SVN_ERR(svn_checksum(&expected_md5, svn_checksum_md5, data, DATA_SIZE,
+                       pool));
+  SVN_ERR(svn_checksum(&expected_sha1, svn_checksum_sha1, data, DATA_SIZE,
+                       pool));
+
+  /* Read both checksums in one pass. */
+  stream = svn_stream__checksummed(svn_stream_from_string(str, pool),
+                                   &md5_checksum, &sha1_checksum,
+                                   NULL, NULL,
+                                   svn_checksum_md5, svn_checksum_sha1,
+                                   TRUE, pool);
+  SVN_ERR(svn_stream_close(stream));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_md5, md5_checksum));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_sha1, sha1_checksum));
+
+  /* Same for writing, at the same time. */
+  stream = svn_stream__checksummed(svn_stream_from_stringbuf(written, pool),
+                                   NULL, NULL,
+                                   &md5_checksum, &sha1_checksum,
+                                   svn_checksum_md5, svn_checksum_sha1,
+                                   FALSE, pool);
+  SVN_ERR(svn_stream_write(stream, data, &len));
+  SVN_ERR(svn_stream_close(stream));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_md5, md5_checksum));
+  SVN_TEST_ASSERT(svn_checksum_match(expected_sha1, sha1_checksum));
+  SVN_TEST_INT_ASSERT(written->len, DATA_SIZE);
+
+  return SVN_NO_ERROR;
+}
+
 /* An array of all test functions */
 
 static int max_threads = 1;
@@ -389,6 +504,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "read from checksummed stream"),
     SVN_TEST_PASS2(test_checksummed_stream_reset,
                    "reset checksummed stream"),
+    SVN_TEST_PASS2(test_sha1_implementation,
+                   "SHA1 implementation consistency"),
+    SVN_TEST_PASS2(test_checksummed_stream_dual,
+                   "calculate two checksums in one stream"),
     SVN_TEST_NULL
   };
 
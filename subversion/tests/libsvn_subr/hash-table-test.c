@@ -0,0 +1,253 @@
+/*
+ * hash-table-test.c:  a collection of svn_hash__table_* tests
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* ====================================================================
+   To add tests, look toward the bottom of this file.
+
+*/
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <apr_pools.h>
+#include <apr_hash.h>
+#include <apr_strings.h>
+
+#include "../svn_test.h"
+
+#include "svn_error.h"
+#include "svn_hash.h"
+#include "svn_string.h"   /* This includes <apr_*.h> */
+#include "private/svn_subr_private.h"
+
+/* Number of keys used by the bulk tests. */
+#define KEY_COUNT 10000
+
+/* Return the I-th test key allocated in POOL. */
+static const char *
+make_key(int i, apr_pool_t *pool)
+{
+  return apr_psprintf(pool, "/branches/feature-%d/subversion/file.c", i);
+}
+
+static svn_error_t *
+test_empty(apr_pool_t *pool)
+{
+  svn_hash__table_t *table = svn_hash__table_create(0, pool);
+  apr_size_t iter = 0;
+
+  SVN_TEST_ASSERT(svn_hash__table_count(table) == 0);
+  SVN_TEST_ASSERT(svn_hash__table_get(table, "a", APR_HASH_KEY_STRING)
+                  == NULL);
+  SVN_TEST_ASSERT(!svn_hash__table_next(table, &iter, NULL, NULL, NULL));
+
+  /* Removing non-existent keys is a no-op. */
+  svn_hash__table_set(table, "a", APR_HASH_KEY_STRING, NULL);
+  SVN_TEST_ASSERT(svn_hash__table_count(table) == 0);
+
+  /* The empty key is a valid key. */
+  svn_hash__table_set(table, "", 0, "empty");
+  SVN_TEST_STRING_ASSERT(svn_hash__table_get(table, "", APR_HASH_KEY_STRING),
+                         "empty");
+  SVN_TEST_ASSERT(svn_hash__table_count(table) == 1);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_get_set(apr_pool_t *pool)
+{
+  svn_hash__table_t *table = svn_hash__table_create(0, pool);
+  const char **keys = apr_palloc(pool, KEY_COUNT * sizeof(*keys));
+  int i;
+
+  for (i = 0; i < KEY_COUNT; i++)
+    {
+      keys[i] = make_key(i, pool);
+      svn_hash__table_set(table, keys[i], APR_HASH_KEY_STRING,
+                          (void *)keys[i]);
+    }
+
+  SVN_TEST_ASSERT(svn_hash__table_count(table) == KEY_COUNT);
+
+  /* Look up copies of the keys, i.e. compare by value. */
+  for (i = 0; i < KEY_COUNT; i++)
+    {
+      const char *key = make_key(i, pool);
+      SVN_TEST_ASSERT(svn_hash__table_get(table, key, strlen(key))
+                      == keys[i]);
+    }
+
+  /* Keys with explicit length may be prefixes of longer strings. */
+  SVN_TEST_ASSERT(svn_hash__table_get(table, keys[1], strlen(keys[1]) - 1)
+                  == NULL);
+
+  /* Replace every other value. */
+  for (i = 0; i < KEY_COUNT; i += 2)
+    svn_hash__table_set(table, keys[i], APR_HASH_KEY_STRING, "replaced");
+
+  SVN_TEST_ASSERT(svn_hash__table_count(table) == KEY_COUNT);
+  for (i = 0; i < KEY_COUNT; i++)
+    {
+      const char *value = svn_hash__table_get(table, keys[i],
+                                              APR_HASH_KEY_STRING);
+      if (i % 2)
+        SVN_TEST_ASSERT(value == keys[i]);
+      else
+        SVN_TEST_STRING_ASSERT(value, "replaced");
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_remove(apr_pool_t *pool)
+{
+  svn_hash__table_t *table = svn_hash__table_create(KEY_COUNT, pool);
+  const char **keys = apr_palloc(pool, KEY_COUNT * sizeof(*keys));
+  int i, round;
+
+  for (i = 0; i < KEY_COUNT; i++)
+    {
+      keys[i] = make_key(i, pool);
+      svn_hash__table_set(table, keys[i], APR_HASH_KEY_STRING,
+                          (void *)keys[i]);
+    }
+
+  /* Repeatedly remove and re-add entries such that deleted slots must
+     be reused or purged. */
+  for (round = 0; round < 10; round++)
+    {
+      for (i = round % 3; i < KEY_COUNT; i += 3)
+        svn_hash__table_set(table, keys[i], APR_HASH_KEY_STRING, NULL);
+
+      for (i = 0; i < KEY_COUNT; i++)
+        {
+          void *value = svn_hash__table_get(table, keys[i],
+                                            APR_HASH_KEY_STRING);
+          if (i % 3 == round % 3)
+            SVN_TEST_ASSERT(value == NULL);
+          else
+            SVN_TEST_ASSERT(value == keys[i]);
+        }
+
+      for (i = round % 3; i < KEY_COUNT; i += 3)
+        svn_hash__table_set(table, keys[i], APR_HASH_KEY_STRING,
+                            (void *)keys[i]);
+
+      SVN_TEST_ASSERT(svn_hash__table_count(table) == KEY_COUNT);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_iterate(apr_pool_t *pool)
+{
+  svn_hash__table_t *table = svn_hash__table_create(0, pool);
+  svn_boolean_t *seen = apr_pcalloc(pool, KEY_COUNT * sizeof(*seen));
+  const char *key;
+  apr_size_t klen;
+  void *value;
+  apr_size_t iter = 0;
+  int count = 0;
+  int i;
+
+  for (i = 0; i < KEY_COUNT; i++)
+    svn_hash__table_set(table, make_key(i, pool), APR_HASH_KEY_STRING,
+                        &seen[i]);
+
+  /* Remove entries while iterating. */
+  while (svn_hash__table_next(table, &iter, &key, &klen, &value))
+    {
+      svn_boolean_t *flag = value;
+
+      SVN_TEST_ASSERT(klen == strlen(key));
+      SVN_TEST_ASSERT(!*flag);
+      *flag = TRUE;
+      count++;
+
+      svn_hash__table_set(table, key, klen, NULL);
+    }
+
+  SVN_TEST_ASSERT(count == KEY_COUNT);
+  SVN_TEST_ASSERT(svn_hash__table_count(table) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_apr_conversion(apr_pool_t *pool)
+{
+  apr_hash_t *hash = apr_hash_make(pool);
+  apr_hash_t *result;
+  svn_hash__table_t *table;
+  apr_hash_index_t *hi;
+  int i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      const char *key = make_key(i, pool);
+      svn_hash_sets(hash, key, key);
+    }
+
+  table = svn_hash__table_from_apr(hash, pool);
+  SVN_TEST_ASSERT(svn_hash__table_count(table) == apr_hash_count(hash));
+
+  for (hi = apr_hash_first(pool, hash); hi; hi = apr_hash_next(hi))
+    SVN_TEST_ASSERT(svn_hash__table_get(table, apr_hash_this_key(hi),
+                                        apr_hash_this_key_len(hi))
+                    == apr_hash_this_val(hi));
+
+  result = svn_hash__table_to_apr(table, pool);
+  SVN_TEST_ASSERT(apr_hash_count(result) == apr_hash_count(hash));
+
+  for (hi = apr_hash_first(pool, hash); hi; hi = apr_hash_next(hi))
+    SVN_TEST_ASSERT(svn_hash_gets(result, apr_hash_this_key(hi))
+                    == apr_hash_this_val(hi));
+
+  return SVN_NO_ERROR;
+}
+
+/* An array of all test functions */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(test_empty,
+                   "empty tables"),
+    SVN_TEST_PASS2(test_get_set,
+                   "get / set entries"),
+    SVN_TEST_PASS2(test_remove,
+                   "remove and re-add entries"),
+    SVN_TEST_PASS2(test_iterate,
+                   "iterate over entries"),
+    SVN_TEST_PASS2(test_apr_conversion,
+                   "convert from and to APR hashes"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
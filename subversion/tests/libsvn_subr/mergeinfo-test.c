@@ -2406,7 +2406,6 @@ mergeinfo_random_non_validated(svn_mergeinfo_t *mp,
   return SVN_NO_ERROR;
 }
 
-#if 0
 static const char *
 mergeinfo_to_string_debug(svn_mergeinfo_t m,
                           apr_pool_t *pool)
@@ -2423,7 +2422,6 @@ mergeinfo_to_string_debug(svn_mergeinfo_t m,
     }
   return s->data;
 }
-#endif
 
 /* Try a mergeinfo merge.  This does not check the result. */
 static svn_error_t *
@@ -2481,6 +2479,99 @@ test_mergeinfo_merge_random_non_validated_inputs(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Generate random mergeinfo with canonical rangelists for a random
+ * subset of a few paths. */
+static void
+mergeinfo_random_canonical(svn_mergeinfo_t *mp,
+                           apr_uint32_t *seed,
+                           apr_pool_t *pool)
+{
+  svn_mergeinfo_t m = apr_hash_make(pool);
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      svn_rangelist_t *rl;
+
+      if (rand_less_than(4, seed) == 0)
+        continue;
+
+      rangelist_random_canonical(&rl, seed, pool);
+      svn_hash_sets(m, apr_psprintf(pool, "/path%d", i), rl);
+    }
+
+  *mp = m;
+}
+
+/* Test the flat mergeinfo set operations against their hash based
+ * counterparts. */
+static svn_error_t *
+test_mergeinfo_flat_random_canonical_inputs(apr_pool_t *pool)
+{
+  static apr_uint32_t seed = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < 2000; i++)
+    {
+      svn_mergeinfo_t mx, my, expected, actual;
+      svn_mergeinfo__flat_t *fx, *fy, *result;
+      svn_boolean_t consider_inheritance;
+      svn_boolean_t equal;
+
+      svn_pool_clear(iterpool);
+      mergeinfo_random_canonical(&mx, &seed, iterpool);
+      mergeinfo_random_canonical(&my, &seed, iterpool);
+
+      SVN_ERR(svn_mergeinfo__flat_from_mergeinfo(&fx, mx, iterpool,
+                                                 iterpool));
+      SVN_ERR(svn_mergeinfo__flat_from_mergeinfo(&fy, my, iterpool,
+                                                 iterpool));
+
+      /* Round trip. */
+      SVN_ERR(svn_mergeinfo__flat_to_mergeinfo(&actual, fx, iterpool));
+      SVN_ERR(svn_mergeinfo__equals(&equal, mx, actual, TRUE, iterpool));
+      SVN_TEST_ASSERT(equal);
+
+      /* Union. */
+      expected = svn_mergeinfo_dup(mx, iterpool);
+      SVN_ERR(svn_mergeinfo_merge2(expected, my, iterpool, iterpool));
+      SVN_ERR(svn_mergeinfo__flat_merge(&result, fx, fy, iterpool));
+      SVN_ERR(svn_mergeinfo__flat_to_mergeinfo(&actual, result, iterpool));
+      SVN_ERR(svn_mergeinfo__equals(&equal, expected, actual, TRUE,
+                                    iterpool));
+      if (!equal)
+        return fail(pool, "flat merge of '%s' and '%s' differs",
+                    mergeinfo_to_string_debug(mx, iterpool),
+                    mergeinfo_to_string_debug(my, iterpool));
+
+      /* Intersection. */
+      for (consider_inheritance = FALSE; consider_inheritance <= TRUE;
+           consider_inheritance++)
+        {
+          SVN_ERR(svn_mergeinfo_intersect2(&expected, mx, my,
+                                           consider_inheritance,
+                                           iterpool, iterpool));
+          SVN_ERR(svn_mergeinfo__flat_intersect(&result, fx, fy,
+                                                consider_inheritance,
+                                                iterpool));
+          SVN_ERR(svn_mergeinfo__flat_to_mergeinfo(&actual, result,
+                                                   iterpool));
+          SVN_ERR(svn_mergeinfo__equals(&equal, expected, actual, TRUE,
+                                        iterpool));
+          if (!equal)
+            return fail(pool, "flat intersection of '%s' and '%s' "
+                        "(consider inheritance: %d) differs",
+                        mergeinfo_to_string_debug(mx, iterpool),
+                        mergeinfo_to_string_debug(my, iterpool),
+                        consider_inheritance);
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -2540,6 +2631,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test rangelist merge random non-validated inputs"),
     SVN_TEST_PASS2(test_mergeinfo_merge_random_non_validated_inputs,
                    "test mergeinfo merge random non-validated inputs"),
+    SVN_TEST_PASS2(test_mergeinfo_flat_random_canonical_inputs,
+                   "test flat mergeinfo with random canonical inputs"),
     SVN_TEST_NULL
   };
 
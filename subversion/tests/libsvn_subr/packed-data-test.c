@@ -133,6 +133,30 @@ test_uint_stream(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_small_uint_runs(apr_pool_t *pool)
+{
+  enum { COUNT = 100 };
+  apr_uint64_t values[COUNT];
+  apr_size_t i;
+
+  /* Runs of single-byte values of varying length, interrupted by wider
+   * ones, such that word-wise decoding gets to start at any offset. */
+  for (i = 0; i < COUNT; ++i)
+    values[i] = i % 11 == 10 ? APR_UINT64_C(0x12345) * i : i % 0x80;
+
+  SVN_ERR(verify_uint_stream(values, COUNT, FALSE, pool));
+  SVN_ERR(verify_uint_stream(values, COUNT, TRUE, pool));
+
+  /* Nothing but small values. */
+  for (i = 0; i < COUNT; ++i)
+    values[i] = (i * 7) % 0x80;
+
+  SVN_ERR(verify_uint_stream(values, COUNT, FALSE, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Check that COUNT numbers from VALUES can be written as signed ints to a
  * packed data stream and can be read from that stream again.  Deltify
  * data in the stream if DIFF is set.  Use POOL for allocations.
@@ -564,6 +588,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test empty container"),
     SVN_TEST_PASS2(test_uint_stream,
                    "test a single uint stream"),
+    SVN_TEST_PASS2(test_small_uint_runs,
+                   "write / read runs of small uint values"),
     SVN_TEST_PASS2(test_int_stream,
                    "test a single int stream"),
     SVN_TEST_PASS2(test_byte_stream,
@@ -170,6 +170,135 @@ test_sqlite_txn_commit_busy(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Set *COUNT to the number of rows in the test table of SDB, using the
+   statement with index IDX. */
+static svn_error_t *
+count_rows(int *count,
+           svn_sqlite__db_t *sdb,
+           int idx)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, idx));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  SVN_TEST_ASSERT(have_row);
+  *count = svn_sqlite__column_int(stmt, 0);
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+static svn_error_t *
+test_sqlite_batch(apr_pool_t *pool)
+{
+  svn_sqlite__db_t *sdb1;
+  svn_sqlite__db_t *sdb2;
+  const char *db_abspath;
+  int count;
+
+  static const char *const statements[] = {
+    "CREATE TABLE test (one TEXT NOT NULL PRIMARY KEY)",
+
+    "INSERT INTO test(one) VALUES ('foo')",
+
+    "INSERT INTO test(one) VALUES ('bar')",
+
+    "SELECT COUNT(*) from test",
+
+    NULL
+  };
+
+  SVN_ERR(open_db(&sdb1, &db_abspath, "batch", statements, 250, pool));
+  SVN_ERR(svn_sqlite__open(&sdb2, db_abspath, svn_sqlite__mode_readwrite,
+                           statements, 0, NULL, 250, pool, pool));
+  SVN_ERR(svn_sqlite__exec_statements(sdb1, 0));
+
+  SVN_ERR(svn_sqlite__begin_batch(sdb1));
+  SVN_TEST_ASSERT(svn_sqlite__in_batch(sdb1));
+
+  /* Transactions within the batch still succeed or fail on their own. */
+  SVN_SQLITE__WITH_TXN(svn_sqlite__exec_statements(sdb1, 1 /* INSERT */),
+                       sdb1);
+  SVN_ERR(svn_sqlite__begin_transaction(sdb1));
+  SVN_ERR(svn_sqlite__exec_statements(sdb1, 2 /* INSERT */));
+  SVN_TEST_ASSERT_ERROR(
+    svn_sqlite__finish_transaction(
+      sdb1, svn_error_create(SVN_ERR_TEST_FAILED, NULL, "fake error")),
+    SVN_ERR_TEST_FAILED);
+
+  SVN_ERR(count_rows(&count, sdb1, 3));
+  SVN_TEST_INT_ASSERT(count, 1);
+
+  /* But nothing is committed before the batch is finished. */
+  SVN_ERR(count_rows(&count, sdb2, 3));
+  SVN_TEST_INT_ASSERT(count, 0);
+
+  SVN_ERR(svn_sqlite__finish_batch(sdb1, SVN_NO_ERROR));
+  SVN_TEST_ASSERT(!svn_sqlite__in_batch(sdb1));
+
+  SVN_ERR(count_rows(&count, sdb2, 3));
+  SVN_TEST_INT_ASSERT(count, 1);
+
+  SVN_ERR(svn_sqlite__close(sdb2));
+  SVN_ERR(svn_sqlite__close(sdb1));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_sqlite_tune(apr_pool_t *pool)
+{
+  svn_sqlite__db_t *sdb1;
+  svn_sqlite__db_t *sdb2;
+  svn_sqlite__stmt_t *stmt;
+  const char *db_abspath;
+  int count;
+
+  static const char *const statements[] = {
+    "CREATE TABLE test (one TEXT NOT NULL PRIMARY KEY)",
+
+    "INSERT INTO test(one) VALUES ('foo')",
+
+    "SELECT COUNT(*) from test",
+
+    "PRAGMA journal_mode",
+
+    NULL
+  };
+
+  SVN_ERR(open_db(&sdb1, &db_abspath, "tune", statements, 250, pool));
+  SVN_ERR(svn_sqlite__exec_statements(sdb1, 0));
+  SVN_ERR(svn_sqlite__tune(sdb1, 1024 * 1024, 1024 * 1024, TRUE, pool));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb1, 3));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+  SVN_TEST_STRING_ASSERT(svn_sqlite__column_text(stmt, 0, NULL), "wal");
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  /* Readers don't have to wait for the writer. */
+  SVN_ERR(svn_sqlite__open(&sdb2, db_abspath, svn_sqlite__mode_readwrite,
+                           statements, 0, NULL, 0, pool, pool));
+  SVN_ERR(svn_sqlite__begin_transaction(sdb1));
+  SVN_ERR(svn_sqlite__exec_statements(sdb1, 1 /* INSERT */));
+  SVN_ERR(count_rows(&count, sdb2, 2));
+  SVN_TEST_INT_ASSERT(count, 0);
+  SVN_ERR(svn_sqlite__finish_transaction(sdb1, SVN_NO_ERROR));
+  SVN_ERR(count_rows(&count, sdb2, 2));
+  SVN_TEST_INT_ASSERT(count, 1);
+
+  /* Switching back succeeds once we are the only user. */
+  SVN_ERR(svn_sqlite__close(sdb2));
+  SVN_ERR(svn_sqlite__tune(sdb1, 0, 0, FALSE, pool));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb1, 3));
+  SVN_ERR(svn_sqlite__step_row(stmt));
+  SVN_TEST_STRING_ASSERT(svn_sqlite__column_text(stmt, 0, NULL), "truncate");
+  SVN_ERR(svn_sqlite__reset(stmt));
+
+  SVN_ERR(svn_sqlite__close(sdb1));
+
+  return SVN_NO_ERROR;
+}
+
 
 static int max_threads = 1;
 
@@ -180,6 +309,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "sqlite reset"),
     SVN_TEST_PASS2(test_sqlite_txn_commit_busy,
                    "sqlite busy on transaction commit"),
+    SVN_TEST_PASS2(test_sqlite_batch,
+                   "sqlite batched transactions"),
+    SVN_TEST_PASS2(test_sqlite_tune,
+                   "sqlite connection tuning"),
     SVN_TEST_NULL
   };
 
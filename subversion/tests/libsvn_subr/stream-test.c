@@ -29,6 +29,7 @@
 #include <apr_general.h>
 
 #include "private/svn_io_private.h"
+#include "private/svn_subr_private.h"
 
 #include "../svn_test.h"
 
@@ -772,6 +773,79 @@ test_stream_base64_2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Encode LEN bytes of DATA the naive way, with line breaks. */
+static const char *
+reference_base64(const unsigned char *data,
+                 apr_size_t len,
+                 apr_pool_t *pool)
+{
+  static const char tab[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                            "abcdefghijklmnopqrstuvwxyz0123456789+/";
+  svn_stringbuf_t *result = svn_stringbuf_create_empty(pool);
+  apr_size_t i;
+
+  for (i = 0; i < len; i += 3)
+    {
+      apr_uint32_t n = (apr_uint32_t)data[i] << 16;
+      if (i + 1 < len)
+        n |= (apr_uint32_t)data[i + 1] << 8;
+      if (i + 2 < len)
+        n |= data[i + 2];
+
+      svn_stringbuf_appendbyte(result, tab[n >> 18]);
+      svn_stringbuf_appendbyte(result, tab[(n >> 12) & 0x3f]);
+      svn_stringbuf_appendbyte(result, i + 1 < len ? tab[(n >> 6) & 0x3f]
+                                                   : '=');
+      svn_stringbuf_appendbyte(result, i + 2 < len ? tab[n & 0x3f] : '=');
+
+      if (i + 3 >= len || (i + 3) % 57 == 0)
+        svn_stringbuf_appendbyte(result, '\n');
+    }
+
+  return result->data;
+}
+
+static svn_error_t *
+test_base64_all_values(apr_pool_t *pool)
+{
+  unsigned char data[1000];
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_size_t len;
+
+  /* Make sure every byte value ends up at every position within a group
+     and that every base64 char shows up. */
+  for (len = 0; len < sizeof(data); len++)
+    data[len] = (unsigned char)(len * 7 + len / 256);
+
+  for (len = 0; len <= sizeof(data); len += (len < 200 ? 1 : 97))
+    {
+      svn_string_t str;
+      const svn_string_t *encoded, *decoded;
+      const char *expected;
+
+      svn_pool_clear(iterpool);
+      str.data = (const char *)data;
+      str.len = len;
+      expected = reference_base64(data, len, iterpool);
+
+      encoded = svn_base64_encode_string2(&str, TRUE, iterpool);
+      SVN_TEST_STRING_ASSERT(encoded->data, expected);
+      decoded = svn_base64_decode_string(encoded, iterpool);
+      SVN_TEST_ASSERT(decoded->len == len);
+      SVN_TEST_ASSERT(memcmp(decoded->data, data, len) == 0);
+
+      encoded = svn_base64_encode_string2(&str, FALSE, iterpool);
+      SVN_TEST_ASSERT(memchr(encoded->data, '\n', encoded->len) == NULL);
+      decoded = svn_base64_decode_string(encoded, iterpool);
+      SVN_TEST_ASSERT(decoded->len == len);
+      SVN_TEST_ASSERT(memcmp(decoded->data, data, len) == 0);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_stringbuf_from_stream(apr_pool_t *pool)
 {
@@ -1065,6 +1139,174 @@ test_stream_readline_file_nul(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Read all of STREAM through svn_stream__read_borrowed() in pieces of at
+   most MAX_LEN bytes and return the concatenation in *RESULT. */
+static svn_error_t *
+read_all_borrowed(svn_stringbuf_t **result,
+                  svn_stream_t *stream,
+                  apr_size_t max_len,
+                  apr_pool_t *pool)
+{
+  *result = svn_stringbuf_create_empty(pool);
+
+  SVN_TEST_ASSERT(svn_stream__supports_read_borrowed(stream));
+  while (TRUE)
+    {
+      const char *data;
+      apr_size_t len = max_len;
+
+      SVN_ERR(svn_stream__read_borrowed(stream, &data, &len));
+      SVN_TEST_ASSERT(len <= max_len);
+      if (len == 0)
+        break;
+
+      svn_stringbuf_appendbytes(*result, data, len);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_stream_read_borrowed(apr_pool_t *pool)
+{
+  svn_stringbuf_t *source = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *result;
+  svn_stringbuf_t *copy;
+  svn_checksum_t *expected;
+  svn_checksum_t *actual;
+  svn_stream_t *stream;
+  svn_spillbuf_t *spillbuf;
+  const char *translated;
+  apr_size_t len;
+  int i;
+
+  /* Several chunks worth of lines, such that every wrapper has to refill
+     its buffers a couple of times. */
+  for (i = 0; source->len < 3 * SVN__STREAM_CHUNK_SIZE + 17; i++)
+    svn_stringbuf_appendcstr(source,
+                             apr_psprintf(pool, "line %d of the text\n", i));
+
+  SVN_ERR(svn_checksum(&expected, svn_checksum_md5,
+                       source->data, source->len, pool));
+
+  /* String streams, passed through the disown wrapper. */
+  stream = svn_stream_from_string(svn_string_create_from_buf(source, pool),
+                                  pool);
+  stream = svn_stream_disown(stream, pool);
+  SVN_ERR(read_all_borrowed(&result, stream, 1000, pool));
+  SVN_TEST_STRING_ASSERT(result->data, source->data);
+
+  /* Stringbuf streams, with the checksum updated on the lent buffers. */
+  stream = svn_stream_from_stringbuf(svn_stringbuf_dup(source, pool), pool);
+  stream = svn_stream_checksummed2(stream, &actual, NULL, svn_checksum_md5,
+                                   FALSE, pool);
+  SVN_ERR(read_all_borrowed(&result, stream, SVN__STREAM_CHUNK_SIZE, pool));
+  SVN_TEST_STRING_ASSERT(result->data, source->data);
+  SVN_ERR(svn_stream_close(stream));
+  SVN_TEST_ASSERT(svn_checksum_match(expected, actual));
+
+  /* Spill buffers, partially spilled to disk. */
+  spillbuf = svn_spillbuf__create(1000, 5000, pool);
+  stream = svn_stream__from_spillbuf(spillbuf, pool);
+  len = source->len;
+  SVN_ERR(svn_stream_write(stream, source->data, &len));
+  SVN_ERR(read_all_borrowed(&result, stream, 700, pool));
+  SVN_TEST_STRING_ASSERT(result->data, source->data);
+
+  /* Translated streams. */
+  SVN_ERR(svn_subst_translate_cstring2(source->data, &translated, "\r\n",
+                                       FALSE, NULL, FALSE, pool));
+  stream = svn_stream_from_stringbuf(svn_stringbuf_dup(source, pool), pool);
+  stream = svn_subst_stream_translated(stream, "\r\n", FALSE, NULL, FALSE,
+                                       pool);
+  SVN_ERR(read_all_borrowed(&result, stream, 3333, pool));
+  SVN_TEST_STRING_ASSERT(result->data, translated);
+
+  /* svn_stream_copy3() takes the borrowing path for suitable sources. */
+  copy = svn_stringbuf_create_empty(pool);
+  stream = svn_stream_from_stringbuf(svn_stringbuf_dup(source, pool), pool);
+  SVN_ERR(svn_stream_copy3(stream, svn_stream_from_stringbuf(copy, pool),
+                           NULL, NULL, pool));
+  SVN_TEST_STRING_ASSERT(copy->data, source->data);
+
+  /* Streams without a borrowing handler report that. */
+  stream = svn_stream_empty(pool);
+  SVN_TEST_ASSERT(!svn_stream__supports_read_borrowed(stream));
+  len = 10;
+  SVN_TEST_ASSERT_ERROR(svn_stream__read_borrowed(stream, &translated, &len),
+                        SVN_ERR_STREAM_NOT_SUPPORTED);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_stream_read_ahead(apr_pool_t *pool)
+{
+  svn_stringbuf_t *source = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *line;
+  svn_stringbuf_t *rest;
+  svn_stream_t *stream;
+  const char *tmp_file;
+  apr_file_t *file;
+  svn_boolean_t eof;
+  char buffer[1000];
+  apr_size_t len;
+  int i;
+
+  /* Enough lines to fill all read-ahead buffers several times, with
+     CRLF sequences spanning some of the buffer boundaries. */
+  for (i = 0; source->len < 5 * 1024 * 1024; i++)
+    svn_stringbuf_appendcstr(source,
+                             apr_psprintf(pool, "line %d%s\r\n", i,
+                                          i % 7 ? "" : "\r"));
+
+  SVN_ERR(svn_io_write_unique(&tmp_file, NULL, source->data, source->len,
+                              svn_io_file_del_on_pool_cleanup, pool));
+  SVN_ERR(svn_io_file_open(&file, tmp_file, APR_READ | APR_BUFFERED,
+                           APR_OS_DEFAULT, pool));
+  SVN_ERR(svn_stream__create_read_ahead(&stream, file, pool));
+
+  /* Read most of the file by lines ... */
+  for (i = 0; i < 100000; i++)
+    {
+      SVN_ERR(svn_stream_readline(stream, &line, "\r\n", &eof, pool));
+      SVN_TEST_ASSERT(!eof);
+      SVN_TEST_STRING_ASSERT(line->data,
+                             apr_psprintf(pool, "line %d%s", i,
+                                          i % 7 ? "" : "\r"));
+    }
+
+  /* ... and the rest in odd sized blocks. */
+  rest = svn_stringbuf_create_empty(pool);
+  do
+    {
+      len = sizeof(buffer);
+      SVN_ERR(svn_stream_read_full(stream, buffer, &len));
+      svn_stringbuf_appendbytes(rest, buffer, len);
+    }
+  while (len == sizeof(buffer));
+
+  SVN_ERR(svn_stream_readline(stream, &line, "\r\n", &eof, pool));
+  SVN_TEST_ASSERT(eof && line->len == 0);
+  SVN_ERR(svn_stream_close(stream));
+  SVN_ERR(svn_io_file_close(file, pool));
+
+  SVN_TEST_ASSERT(rest->len < source->len);
+  SVN_TEST_STRING_ASSERT(rest->data,
+                         source->data + source->len - rest->len);
+
+  /* Closing the stream early stops the reader. */
+  SVN_ERR(svn_io_file_open(&file, tmp_file, APR_READ | APR_BUFFERED,
+                           APR_OS_DEFAULT, pool));
+  SVN_ERR(svn_stream__create_read_ahead(&stream, file, pool));
+  SVN_ERR(svn_stream_readline(stream, &line, "\r\n", &eof, pool));
+  SVN_TEST_STRING_ASSERT(line->data, "line 0\r");
+  SVN_ERR(svn_stream_close(stream));
+  SVN_ERR(svn_io_file_close(file, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 1;
@@ -1092,6 +1334,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test base64 encoding/decoding streams"),
     SVN_TEST_PASS2(test_stream_base64_2,
                    "base64 decoding allocation problem"),
+    SVN_TEST_PASS2(test_base64_all_values,
+                   "test base64 encoding of all byte values"),
     SVN_TEST_PASS2(test_stringbuf_from_stream,
                    "test svn_stringbuf_from_stream"),
     SVN_TEST_PASS2(test_stream_compressed_read_full,
@@ -1104,6 +1348,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test reading CRLF-terminated lines from file"),
     SVN_TEST_PASS2(test_stream_readline_file_nul,
                    "test reading line from file with nul bytes"),
+    SVN_TEST_PASS2(test_stream_read_borrowed,
+                   "test borrowed reads from streams"),
+    SVN_TEST_PASS2(test_stream_read_ahead,
+                   "test read-ahead file streams"),
     SVN_TEST_NULL
   };
 
@@ -872,6 +872,71 @@ test_string_matching(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Return the number of matching bytes at the start of A and B,
+ * looking at no more than MAX_LEN bytes.  Reference for
+ * svn_cstring__match_length(). */
+static apr_size_t
+naive_match_length(const char *a, const char *b, apr_size_t max_len)
+{
+  apr_size_t pos;
+  for (pos = 0; pos < max_len; ++pos)
+    if (a[pos] != b[pos])
+      break;
+
+  return pos;
+}
+
+/* Like naive_match_length() but scanning backwards from A and B. */
+static apr_size_t
+naive_reverse_match_length(const char *a, const char *b, apr_size_t max_len)
+{
+  apr_size_t pos;
+  for (pos = 0; pos < max_len; ++pos)
+    if (a[-1 - (apr_ssize_t)pos] != b[-1 - (apr_ssize_t)pos])
+      break;
+
+  return pos;
+}
+
+static svn_error_t *
+test_string_matching_offsets(apr_pool_t *pool)
+{
+  /* Large enough to cover several 16 byte blocks plus any tail. */
+  enum { BUF_SIZE = 80, MAX_OFFSET = 16 };
+  char a_buf[BUF_SIZE + MAX_OFFSET];
+  char b_buf[BUF_SIZE + MAX_OFFSET];
+  apr_size_t a_ofs, b_ofs, len, diff;
+
+  /* Run every combination of unaligned start offsets, lengths that do
+   * and do not fill whole 16 / 8 byte blocks, and mismatch positions
+   * within the block loops as well as in the byte-wise tail. */
+  for (a_ofs = 0; a_ofs < MAX_OFFSET; a_ofs += 3)
+    for (b_ofs = 0; b_ofs < MAX_OFFSET; b_ofs += 5)
+      for (len = 0; len <= BUF_SIZE - MAX_OFFSET; ++len)
+        for (diff = 0; diff <= len; ++diff)
+          {
+            char *a = a_buf + a_ofs;
+            char *b = b_buf + b_ofs;
+            apr_size_t i;
+
+            for (i = 0; i < len; ++i)
+              a[i] = b[i] = (char)('a' + (i % 26));
+
+            /* DIFF == LEN means "no mismatch". */
+            if (diff < len)
+              b[diff] = '_';
+
+            SVN_TEST_ASSERT(svn_cstring__match_length(a, b, len)
+                            == naive_match_length(a, b, len));
+            SVN_TEST_ASSERT(svn_cstring__reverse_match_length(a + len,
+                                                              b + len, len)
+                            == naive_reverse_match_length(a + len, b + len,
+                                                          len));
+          }
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_cstring_skip_prefix(apr_pool_t *pool)
 {
@@ -1141,6 +1206,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test string similarity scores"),
     SVN_TEST_PASS2(test_string_matching,
                    "test string matching"),
+    SVN_TEST_PASS2(test_string_matching_offsets,
+                   "test string matching at unaligned offsets"),
     SVN_TEST_PASS2(test_cstring_skip_prefix,
                    "test svn_cstring_skip_prefix()"),
     SVN_TEST_PASS2(test_stringbuf_replace_all,
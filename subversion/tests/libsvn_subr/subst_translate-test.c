@@ -31,6 +31,7 @@
 #include "svn_string.h"
 #include "svn_subst.h"
 #include "svn_hash.h"
+#include "svn_pools.h"
 
 #define ARRAY_LEN(ary) ((sizeof (ary)) / (sizeof ((ary)[0])))
 
@@ -500,6 +501,81 @@ test_svn_subst_long_keywords(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Translate SOURCE with EOL_STR and KEYWORDS using a translating stream
+ * and return the result in *RESULT. */
+static svn_error_t *
+translate_through_stream(const char **result,
+                         const char *source,
+                         const char *eol_str,
+                         apr_hash_t *keywords,
+                         apr_pool_t *pool)
+{
+  svn_stream_t *src_stream, *dst_stream;
+  svn_stringbuf_t *dst_stringbuf = svn_stringbuf_create_empty(pool);
+
+  src_stream = svn_stream_from_string(svn_string_create(source, pool), pool);
+  dst_stream = svn_stream_from_stringbuf(dst_stringbuf, pool);
+  dst_stream = svn_subst_stream_translated(dst_stream, eol_str, TRUE,
+                                           keywords, TRUE, pool);
+  SVN_ERR(svn_stream_copy3(src_stream, dst_stream, NULL, NULL, pool));
+
+  *result = dst_stringbuf->data;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_svn_subst_translate_offsets(apr_pool_t *pool)
+{
+  /* The scanners for EOLs and keywords process the data in chunks.
+     Place the interesting chars at all offsets relative to those chunks
+     and make sure that they are still found, with and without the other
+     kind of translation being active. */
+  apr_hash_t *keywords = apr_hash_make(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  svn_hash_sets(keywords, "Rev", svn_string_create("42", pool));
+
+  for (i = 0; i < 40; i++)
+    {
+      const char *pad;
+      const char *source;
+      const char *result;
+
+      svn_pool_clear(iterpool);
+      pad = apr_psprintf(iterpool, "%*s", i, "");
+      source = apr_pstrcat(iterpool, pad, "$Rev$", pad, "\r\n", pad,
+                           "x\ry\n", pad, SVN_VA_NULL);
+
+      /* Keywords and EOLs. */
+      SVN_ERR(translate_through_stream(&result, source, "\n", keywords,
+                                       iterpool));
+      SVN_TEST_STRING_ASSERT(result,
+                             apr_pstrcat(iterpool, pad, "$Rev: 42 $", pad,
+                                         "\n", pad, "x\ny\n", pad,
+                                         SVN_VA_NULL));
+
+      /* Keywords only; EOLs must be left alone. */
+      SVN_ERR(translate_through_stream(&result, source, NULL, keywords,
+                                       iterpool));
+      SVN_TEST_STRING_ASSERT(result,
+                             apr_pstrcat(iterpool, pad, "$Rev: 42 $", pad,
+                                         "\r\n", pad, "x\ry\n", pad,
+                                         SVN_VA_NULL));
+
+      /* EOLs only; keywords must be left alone. */
+      SVN_ERR(translate_through_stream(&result, source, "\r\n", NULL,
+                                       iterpool));
+      SVN_TEST_STRING_ASSERT(result,
+                             apr_pstrcat(iterpool, pad, "$Rev$", pad,
+                                         "\r\n", pad, "x\r\ny\r\n", pad,
+                                         SVN_VA_NULL));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 1;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -519,6 +595,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test truncated keywords (issue 4349)"),
     SVN_TEST_PASS2(test_svn_subst_long_keywords,
                    "test long keywords (issue 4350)"),
+    SVN_TEST_PASS2(test_svn_subst_translate_offsets,
+                   "test translation at all chunk offsets"),
     SVN_TEST_NULL
   };
 
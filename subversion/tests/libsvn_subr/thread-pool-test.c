@@ -0,0 +1,208 @@
+/*
+ * thread-pool-test.c -- test the svn_thread_pool__* API
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_time.h>
+
+#include "private/svn_thread_pool.h"
+
+#include "../svn_test.h"
+
+/* Number of jobs to run per test. */
+#define JOB_COUNT 100
+
+/* Number of worker threads to use. */
+#define THREAD_COUNT 4
+
+/* Per-worker state. */
+typedef struct worker_baton_t
+{
+  int index;
+} worker_baton_t;
+
+/* Per-job state. */
+typedef struct job_baton_t
+{
+  int value;
+  int result;
+  worker_baton_t *worker;
+  svn_thread_pool__job_t *job;
+} job_baton_t;
+
+/* Implements svn_thread_pool__worker_init_t. */
+static svn_error_t *
+init_worker(void **worker_baton,
+            void *baton,
+            int worker_index,
+            apr_pool_t *worker_pool)
+{
+  worker_baton_t *result = apr_pcalloc(worker_pool, sizeof(*result));
+  result->index = worker_index;
+
+  *worker_baton = result;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Square the job's value. */
+static svn_error_t *
+square(void *job_baton,
+       void *worker_baton,
+       svn_cancel_func_t cancel_func,
+       void *cancel_baton,
+       apr_pool_t *scratch_pool)
+{
+  job_baton_t *job = job_baton;
+  job->worker = worker_baton;
+  job->result = job->value * job->value;
+
+  if (job->value % 7 == 3)
+    return svn_error_createf(SVN_ERR_TEST_FAILED, NULL, "%d", job->value);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_thread_pool__job_func_t.  Block until cancelled. */
+static svn_error_t *
+block(void *job_baton,
+      void *worker_baton,
+      svn_cancel_func_t cancel_func,
+      void *cancel_baton,
+      apr_pool_t *scratch_pool)
+{
+  while (TRUE)
+    {
+      SVN_ERR(cancel_func(cancel_baton));
+      apr_sleep(1000);
+    }
+}
+
+static svn_error_t *
+test_in_order_results(apr_pool_t *pool)
+{
+  svn_thread_pool__t *thread_pool;
+  job_baton_t jobs[JOB_COUNT];
+  int i;
+
+  SVN_ERR(svn_thread_pool__create(&thread_pool, THREAD_COUNT, init_worker,
+                                  NULL, pool));
+
+  for (i = 0; i < JOB_COUNT; ++i)
+    {
+      jobs[i].value = i;
+      jobs[i].result = -1;
+      SVN_ERR(svn_thread_pool__submit(&jobs[i].job, thread_pool, square,
+                                      &jobs[i]));
+    }
+
+  for (i = 0; i < JOB_COUNT; ++i)
+    {
+      svn_error_t *err = svn_thread_pool__wait(thread_pool, jobs[i].job,
+                                               NULL, NULL);
+      if (i % 7 == 3)
+        SVN_TEST_ASSERT_ERROR(err, SVN_ERR_TEST_FAILED);
+      else
+        SVN_ERR(err);
+
+      SVN_TEST_INT_ASSERT(jobs[i].result, i * i);
+      SVN_TEST_ASSERT(jobs[i].worker);
+      SVN_TEST_ASSERT(jobs[i].worker->index < THREAD_COUNT);
+    }
+
+  /* The threads get restarted on demand. */
+  SVN_ERR(svn_thread_pool__join(thread_pool, FALSE));
+
+  jobs[0].value = 5;
+  SVN_ERR(svn_thread_pool__submit(&jobs[0].job, thread_pool, square,
+                                  &jobs[0]));
+  SVN_ERR(svn_thread_pool__join(thread_pool, FALSE));
+  SVN_ERR(svn_thread_pool__wait(thread_pool, jobs[0].job, NULL, NULL));
+  SVN_TEST_INT_ASSERT(jobs[0].result, 25);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_cancellation(apr_pool_t *pool)
+{
+  svn_thread_pool__t *thread_pool;
+  job_baton_t jobs[JOB_COUNT];
+  int i;
+
+  SVN_ERR(svn_thread_pool__create(&thread_pool, THREAD_COUNT, init_worker,
+                                  NULL, pool));
+
+  /* Keep all workers busy, such that the remaining jobs stay queued. */
+  for (i = 0; i < JOB_COUNT; ++i)
+    {
+      jobs[i].value = i;
+      jobs[i].result = -1;
+      SVN_ERR(svn_thread_pool__submit(&jobs[i].job, thread_pool,
+                                      i < THREAD_COUNT ? block : square,
+                                      &jobs[i]));
+    }
+
+  for (i = 0; i < JOB_COUNT; ++i)
+    SVN_ERR(svn_thread_pool__cancel_job(thread_pool, jobs[i].job));
+
+  for (i = 0; i < JOB_COUNT; ++i)
+    {
+      svn_error_t *err = svn_thread_pool__wait(thread_pool, jobs[i].job,
+                                               NULL, NULL);
+
+      /* Cancelled jobs either did not run at all, got interrupted or ran
+         to completion. */
+      if (i < THREAD_COUNT && err)
+        SVN_TEST_ASSERT_ERROR(err, SVN_ERR_CANCELLED);
+      else if (jobs[i].result == -1)
+        SVN_TEST_ASSERT(err == SVN_NO_ERROR);
+      else
+        svn_error_clear(err);
+    }
+
+  /* Aborting stops blocked jobs without waiting for them. */
+  for (i = 0; i < THREAD_COUNT; ++i)
+    SVN_ERR(svn_thread_pool__submit(&jobs[i].job, thread_pool, block,
+                                    &jobs[i]));
+
+  SVN_ERR(svn_thread_pool__join(thread_pool, TRUE));
+
+  return SVN_NO_ERROR;
+}
+
+
+/* The test table.  */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(test_in_order_results,
+                   "test in-order results of concurrent jobs"),
+    SVN_TEST_SKIP2(test_cancellation,
+                   ! APR_HAS_THREADS,
+                   "test cancelling and aborting jobs"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
@@ -21,6 +21,8 @@
  * ====================================================================
  */
 
+#include <apr_thread_proc.h>
+
 #include "../svn_test.h"
 #include "svn_utf.h"
 #include "svn_pools.h"
@@ -215,6 +217,54 @@ utf_validate2(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Random strings hardly ever contain long runs of ASCII chars, which is
+   what the chunked fast path in the validator is skipping.  Place valid
+   and invalid multi-byte sequences at all offsets within such runs. */
+static svn_error_t *
+utf_validate_ascii_runs(apr_pool_t *pool)
+{
+  static const char *sequences[] = {
+    "\xc3\xa9",          /* valid 2-byte sequence */
+    "\xe2\x82\xac",      /* valid 3-byte sequence */
+    "\xc3",              /* truncated sequence */
+    "\xff",              /* invalid octet */
+  };
+  apr_size_t i, j;
+
+  for (i = 0; i < sizeof(sequences) / sizeof(sequences[0]); ++i)
+    for (j = 0; j < 48; ++j)
+      {
+        char str[64];
+        apr_size_t seq_len = strlen(sequences[i]);
+        apr_size_t len = sizeof(str) - 1;
+        svn_boolean_t valid = (i < 2);
+
+        memset(str, 'a', len);
+        memcpy(str + j, sequences[i], seq_len);
+        str[len] = 0;
+
+        if (svn_utf__last_valid(str, len) != svn_utf__last_valid2(str, len))
+          return svn_error_createf
+            (SVN_ERR_TEST_FAILED, NULL,
+             "last_valid mismatch for sequence %d at offset %d",
+             (int)i, (int)j);
+
+        if (svn_utf__is_valid(str, len) != valid)
+          return svn_error_createf
+            (SVN_ERR_TEST_FAILED, NULL,
+             "is_valid failed for sequence %d at offset %d",
+             (int)i, (int)j);
+
+        if (svn_utf__last_valid(str, len) != (valid ? str + len : str + j))
+          return svn_error_createf
+            (SVN_ERR_TEST_FAILED, NULL,
+             "last_valid failed for sequence %d at offset %d",
+             (int)i, (int)j);
+      }
+
+  return SVN_NO_ERROR;
+}
+
 /* Test conversion from different codepages to utf8. */
 static svn_error_t *
 test_utf_cstring_to_utf8_ex2(apr_pool_t *pool)
@@ -998,6 +1048,81 @@ test_utf_xfrm(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+#if APR_HAS_THREADS
+/* Convert a string to UTF-8 and back to native many times.  Exit with
+   a non-zero status if any of the results is not as expected. */
+static void *
+APR_THREAD_FUNC utf_convert_thread(apr_thread_t *tid, void *data)
+{
+  apr_pool_t *pool = svn_pool_create(NULL);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_status_t status = APR_SUCCESS;
+  int i;
+
+  apr_thread_yield();
+
+  for (i = 0; i < 1000 && status == APR_SUCCESS; ++i)
+    {
+      static const char *const text = "trunk/some file\twith\nspaces";
+      const char *utf8, *native;
+      svn_error_t *err;
+
+      svn_pool_clear(iterpool);
+
+      err = svn_utf_cstring_to_utf8(&utf8, text, iterpool);
+      if (!err)
+        err = svn_utf_cstring_from_utf8(&native, utf8, iterpool);
+
+      if (err)
+        {
+          status = err->apr_err;
+          svn_error_clear(err);
+        }
+      else if (strcmp(utf8, text) || strcmp(native, text))
+        status = APR_EGENERAL;
+    }
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(tid, status);
+
+  return NULL;
+}
+#endif
+
+static svn_error_t *
+test_utf_concurrent_conversions(apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  enum { THREAD_COUNT = 8 };
+  apr_thread_t *threads[THREAD_COUNT];
+  apr_status_t status;
+  int i;
+
+  for (i = 0; i < THREAD_COUNT; ++i)
+    {
+      status = apr_thread_create(&threads[i], NULL, utf_convert_thread,
+                                 NULL, pool);
+      if (status)
+        return svn_error_wrap_apr(status, "Can't create thread");
+    }
+
+  for (i = 0; i < THREAD_COUNT; ++i)
+    {
+      apr_status_t retval;
+
+      status = apr_thread_join(&retval, threads[i]);
+      if (status)
+        return svn_error_wrap_apr(status, "Can't join thread");
+      if (retval)
+        return svn_error_wrap_apr(retval, "Conversion failed in thread %d",
+                                  i);
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+
 
 /* The test table.  */
 
@@ -1010,6 +1135,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test is_valid/last_valid"),
     SVN_TEST_PASS2(utf_validate2,
                    "test last_valid/last_valid2"),
+    SVN_TEST_PASS2(utf_validate_ascii_runs,
+                   "test validation within ASCII runs"),
     SVN_TEST_PASS2(test_utf_cstring_to_utf8_ex2,
                    "test svn_utf_cstring_to_utf8_ex2"),
     SVN_TEST_PASS2(test_utf_cstring_from_utf8_ex2,
@@ -1028,6 +1155,9 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test svn_utf__normalize"),
     SVN_TEST_PASS2(test_utf_xfrm,
                    "test svn_utf__xfrm"),
+    SVN_TEST_SKIP2(test_utf_concurrent_conversions,
+                   ! APR_HAS_THREADS,
+                   "test concurrent native conversions"),
     SVN_TEST_NULL
   };
 
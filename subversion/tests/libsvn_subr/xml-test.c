@@ -20,6 +20,7 @@
  * ====================================================================
  */
 
+#include <string.h>
 #include <apr.h>
 
 #include "svn_pools.h"
@@ -332,6 +333,49 @@ test_xml_doctype_declaration(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_xml_escape(apr_pool_t *pool)
+{
+  svn_stringbuf_t *escaped = NULL;
+  const char *text = "<log>& \"x\"\t'y'\r\n</log>";
+  svn_stringbuf_t *long_text = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *expected = svn_stringbuf_create_empty(pool);
+  int i;
+
+  svn_xml_escape_cdata_cstring(&escaped, text, pool);
+  SVN_TEST_STRING_ASSERT(escaped->data,
+                         "&lt;log&gt;&amp; \"x\"\t'y'&#13;\n&lt;/log&gt;");
+
+  escaped = NULL;
+  svn_xml_escape_attr_cstring(&escaped, text, pool);
+  SVN_TEST_STRING_ASSERT(escaped->data,
+                         "&lt;log&gt;&amp; &quot;x&quot;&#9;&apos;y&apos;"
+                         "&#13;&#10;&lt;/log&gt;");
+
+  /* Special chars at all positions within and across larger blocks,
+     appended to existing contents. */
+  for (i = 0; i < 100; i++)
+    {
+      svn_stringbuf_appendbytes(long_text, "abcdefghijklmnopq", i % 17);
+      svn_stringbuf_appendbyte(long_text, i % 2 ? '<' : '&');
+      svn_stringbuf_appendbytes(expected, "abcdefghijklmnopq", i % 17);
+      svn_stringbuf_appendcstr(expected, i % 2 ? "&lt;" : "&amp;");
+    }
+  svn_stringbuf_appendcstr(long_text, "0123456789abcdefghijklmnopqrstuvwxyz");
+  svn_stringbuf_appendcstr(expected, "0123456789abcdefghijklmnopqrstuvwxyz");
+
+  escaped = svn_stringbuf_create("prefix:", pool);
+  svn_xml_escape_cdata_stringbuf(&escaped, long_text, pool);
+  SVN_TEST_ASSERT(strncmp(escaped->data, "prefix:", 7) == 0);
+  SVN_TEST_STRING_ASSERT(escaped->data + 7, expected->data);
+
+  escaped = NULL;
+  svn_xml_escape_attr_stringbuf(&escaped, long_text, pool);
+  SVN_TEST_STRING_ASSERT(escaped->data, expected->data);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 static int max_threads = 1;
 
@@ -354,6 +398,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test XML custom entity expansion"),
     SVN_TEST_PASS2(test_xml_doctype_declaration,
                    "test XML doctype declaration"),
+    SVN_TEST_PASS2(test_xml_escape,
+                   "test XML escaping of cdata and attributes"),
     SVN_TEST_NULL
   };
 
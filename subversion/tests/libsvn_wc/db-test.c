@@ -34,6 +34,7 @@
 #define SVN_DEPRECATED
 #include "svn_io.h"
 
+#include "svn_config.h"
 #include "svn_dirent_uri.h"
 #include "svn_pools.h"
 
@@ -1525,6 +1526,181 @@ test_externals_store(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Set *SUMMARY to a string describing everything svn_wc__db_read_info()
+   returns for LOCAL_ABSPATH in DB, or the error it returns. */
+static svn_error_t *
+read_info_summary(const char **summary,
+                  svn_wc__db_t *db,
+                  const char *local_abspath,
+                  apr_pool_t *pool)
+{
+  svn_wc__db_status_t status;
+  svn_node_kind_t kind;
+  svn_revnum_t revision, changed_rev, original_revision;
+  const char *repos_relpath, *repos_root_url, *repos_uuid;
+  const char *original_repos_relpath, *original_root_url, *original_uuid;
+  apr_time_t changed_date, recorded_time;
+  const char *changed_author, *target, *changelist;
+  svn_depth_t depth;
+  const svn_checksum_t *checksum;
+  svn_wc__db_lock_t *lock;
+  svn_filesize_t recorded_size;
+  svn_boolean_t conflicted, op_root, had_props, props_mod;
+  svn_boolean_t have_base, have_more_work, have_work;
+  svn_error_t *err;
+
+  err = svn_wc__db_read_info(&status, &kind, &revision, &repos_relpath,
+                             &repos_root_url, &repos_uuid, &changed_rev,
+                             &changed_date, &changed_author, &depth,
+                             &checksum, &target, &original_repos_relpath,
+                             &original_root_url, &original_uuid,
+                             &original_revision, &lock, &recorded_size,
+                             &recorded_time, &changelist, &conflicted,
+                             &op_root, &had_props, &props_mod, &have_base,
+                             &have_more_work, &have_work,
+                             db, local_abspath, pool, pool);
+  if (err)
+    {
+      *summary = apr_psprintf(pool, "error %d", err->apr_err);
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  *summary = apr_psprintf(pool,
+                          "%d %d %ld %s %s %s %ld %" APR_TIME_T_FMT " %s %d "
+                          "%s %s %s %s %s %ld %s %" SVN_FILESIZE_T_FMT
+                          " %" APR_TIME_T_FMT " %s %d %d %d %d %d %d %d",
+                          status, kind, revision, repos_relpath,
+                          repos_root_url, repos_uuid, changed_rev,
+                          changed_date, changed_author, depth,
+                          svn_checksum_to_cstring(checksum, pool), target,
+                          original_repos_relpath, original_root_url,
+                          original_uuid, original_revision,
+                          lock ? lock->token : NULL, recorded_size,
+                          recorded_time, changelist, conflicted, op_root,
+                          had_props, props_mod, have_base, have_more_work,
+                          have_work);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_node_cache(apr_pool_t *pool)
+{
+  const char *local_abspath;
+  svn_wc__db_t *db;
+  const apr_array_header_t *children;
+  apr_array_header_t *summaries;
+  apr_hash_t *nodes, *conflicts;
+  const char *A_abspath, *summary;
+  svn_filesize_t recorded_size;
+  apr_time_t recorded_time;
+  int i;
+
+  SVN_ERR(create_open(&db, &local_abspath, "test_node_cache", pool));
+
+  SVN_ERR(svn_wc__db_read_children(&children, db, local_abspath,
+                                   pool, pool));
+  summaries = apr_array_make(pool, children->nelts, sizeof(const char *));
+
+  /* Read every child by itself, before the cache is filled. */
+  for (i = 0; i < children->nelts; i++)
+    {
+      const char *name = APR_ARRAY_IDX(children, i, const char *);
+
+      SVN_ERR(read_info_summary(&summary, db,
+                                svn_dirent_join(local_abspath, name, pool),
+                                pool));
+      APR_ARRAY_PUSH(summaries, const char *) = summary;
+    }
+
+  /* Fill the cache, which must not make a difference. */
+  SVN_ERR(svn_wc__db_read_children_info(&nodes, &conflicts, db,
+                                        local_abspath, FALSE, pool, pool));
+
+  for (i = 0; i < children->nelts; i++)
+    {
+      const char *name = APR_ARRAY_IDX(children, i, const char *);
+
+      SVN_ERR(read_info_summary(&summary, db,
+                                svn_dirent_join(local_abspath, name, pool),
+                                pool));
+      SVN_TEST_STRING_ASSERT(summary,
+                             APR_ARRAY_IDX(summaries, i, const char *));
+    }
+
+  /* Writing to the database must invalidate the cache. */
+  A_abspath = svn_dirent_join(local_abspath, "A", pool);
+  SVN_ERR(svn_wc__db_global_record_fileinfo(db, A_abspath, 1234, 5678,
+                                            pool));
+  SVN_ERR(svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL,
+                               &recorded_size, &recorded_time,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               db, A_abspath, pool, pool));
+  SVN_TEST_ASSERT(recorded_size == 1234);
+  SVN_TEST_ASSERT(recorded_time == 5678);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_checksum_cache(apr_pool_t *pool)
+{
+  const char *local_abspath;
+  svn_wc__db_t *db;
+  svn_config_t *config;
+  const char *A_abspath;
+  svn_checksum_t *sha1;
+  const svn_checksum_t *cached;
+
+  SVN_ERR(create_open(&db, &local_abspath, "test_checksum_cache", pool));
+  A_abspath = svn_dirent_join(local_abspath, "A", pool);
+  SVN_ERR(svn_checksum_parse_hex(&sha1, svn_checksum_sha1, SHA1_1, pool));
+
+  /* Without the option nothing is remembered. */
+  SVN_ERR(svn_wc__db_checksum_cache_set(db, A_abspath, 10, 20, 30, 40, sha1,
+                                        pool));
+  SVN_ERR(svn_wc__db_checksum_cache_get(&cached, db, A_abspath,
+                                        10, 20, 30, 40, pool, pool));
+  SVN_TEST_ASSERT(cached == NULL);
+  SVN_ERR(svn_wc__db_close(db));
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set_bool(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                      SVN_CONFIG_OPTION_CHECKSUM_CACHE, TRUE);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+
+  SVN_ERR(svn_wc__db_checksum_cache_set(db, A_abspath, 10, 20, 30, 40, sha1,
+                                        pool));
+  SVN_ERR(svn_wc__db_checksum_cache_get(&cached, db, A_abspath,
+                                        10, 20, 30, 40, pool, pool));
+  SVN_TEST_ASSERT(cached && svn_checksum_match(cached, sha1));
+
+  /* Any change to the signature misses. */
+  SVN_ERR(svn_wc__db_checksum_cache_get(&cached, db, A_abspath,
+                                        11, 20, 30, 40, pool, pool));
+  SVN_TEST_ASSERT(cached == NULL);
+  SVN_ERR(svn_wc__db_checksum_cache_get(&cached, db, A_abspath,
+                                        10, 20, 31, 40, pool, pool));
+  SVN_TEST_ASSERT(cached == NULL);
+  SVN_ERR(svn_wc__db_checksum_cache_get(&cached, db, A_abspath,
+                                        10, 20, 30, 41, pool, pool));
+  SVN_TEST_ASSERT(cached == NULL);
+
+  /* A new signature replaces the old one. */
+  SVN_ERR(svn_wc__db_checksum_cache_set(db, A_abspath, 10, 21, 30, 40, sha1,
+                                        pool));
+  SVN_ERR(svn_wc__db_checksum_cache_get(&cached, db, A_abspath,
+                                        10, 20, 30, 40, pool, pool));
+  SVN_TEST_ASSERT(cached == NULL);
+  SVN_ERR(svn_wc__db_checksum_cache_get(&cached, db, A_abspath,
+                                        10, 21, 30, 40, pool, pool));
+  SVN_TEST_ASSERT(cached != NULL);
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 2;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -1550,6 +1726,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "work queue processing"),
     SVN_TEST_PASS2(test_externals_store,
                    "externals store"),
+    SVN_TEST_PASS2(test_node_cache,
+                   "reading nodes through the node cache"),
+    SVN_TEST_PASS2(test_checksum_cache,
+                   "remembering checksums of working files"),
     SVN_TEST_NULL
   };
 
@@ -34,6 +34,7 @@
 #define SVN_DEPRECATED
 #include "svn_io.h"
 
+#include "svn_config.h"
 #include "svn_dirent_uri.h"
 #include "svn_pools.h"
 #include "svn_repos.h"
@@ -306,6 +307,258 @@ reject_mismatching_text(const svn_test_opts_t *opts,
 #endif
 }
 
+/* Test installing and reading a pristine text stored compressed. */
+static svn_error_t *
+pristine_compressed(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  const char *wc_abspath;
+
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  svn_stringbuf_t *data = svn_stringbuf_create_empty(pool);
+  svn_string_t *data_string;
+  svn_checksum_t *data_sha1, *data_md5;
+  apr_size_t sz;
+  int i;
+
+  for (i = 0; i < 100; i++)
+    svn_stringbuf_appendcstr(data, "A line that compresses very well\n");
+  data_string = svn_string_create_from_buf(data, pool);
+
+  SVN_ERR(create_repos_and_wc(&wc_abspath, &db,
+                              "pristine_compressed", opts, pool));
+
+  /* Make the working copy compress new pristines.  The setting is kept in
+     the working copy, so a DB context without any config honors it. */
+  SVN_ERR(svn_wc__db_set_compress_pristines(db, wc_abspath, TRUE, pool));
+  SVN_ERR(svn_wc__db_open(&db, NULL, FALSE, TRUE, pool, pool));
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              &data_sha1, &data_md5,
+                                              db, wc_abspath,
+                                              pool, pool));
+  sz = data_string->len;
+  SVN_ERR(svn_stream_write(pristine_stream, data_string->data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+  SVN_ERR(svn_wc__db_pristine_install(install_data,
+                                      data_sha1, data_md5, pool));
+
+  /* The text is present, and stored smaller than it is. */
+  {
+    svn_boolean_t present;
+    const char *storage_abspath;
+    svn_boolean_t compressed;
+    apr_finfo_t finfo;
+
+    SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                      pool));
+    SVN_TEST_ASSERT(present);
+
+    SVN_ERR(svn_wc__db_pristine_get_storage(&storage_abspath, &compressed,
+                                            db, wc_abspath, data_sha1,
+                                            pool, pool));
+    SVN_TEST_ASSERT(compressed);
+    SVN_ERR(svn_io_stat(&finfo, storage_abspath, APR_FINFO_SIZE, pool));
+    SVN_TEST_ASSERT(finfo.size < (apr_off_t)data_string->len);
+  }
+
+  /* Reading it yields the text and its real size. */
+  {
+    svn_stream_t *data_read_back;
+    svn_filesize_t size;
+    svn_boolean_t same;
+
+    SVN_ERR(svn_wc__db_pristine_read(&data_read_back, &size, db, wc_abspath,
+                                     data_sha1, pool, pool));
+    SVN_TEST_ASSERT(size == (svn_filesize_t)data_string->len);
+    SVN_ERR(svn_stream_contents_same2(&same, data_read_back,
+                                      svn_stream_from_string(data_string,
+                                                             pool),
+                                      pool));
+    SVN_TEST_ASSERT(same);
+  }
+
+  /* So does the file that svn_wc__db_pristine_get_path() hands out. */
+  {
+    const char *pristine_abspath;
+    svn_stringbuf_t *contents;
+
+    SVN_ERR(svn_wc__db_pristine_get_path(&pristine_abspath, db, wc_abspath,
+                                         data_sha1, pool, pool));
+    SVN_ERR(svn_stringbuf_from_file2(&contents, pristine_abspath, pool));
+    SVN_TEST_STRING_ASSERT(contents->data, data_string->data);
+  }
+
+  /* And it can be removed again. */
+  {
+    svn_boolean_t present;
+
+    SVN_ERR(svn_wc__db_pristine_remove(db, wc_abspath, data_sha1, pool));
+    SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                      pool));
+    SVN_TEST_ASSERT(! present);
+  }
+
+  return SVN_NO_ERROR;
+}
+
+/* Test sharing pristine texts through a shared pristine store. */
+static svn_error_t *
+pristine_shared(const svn_test_opts_t *opts,
+                apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  const char *wc_abspath;
+  const char *shared_abspath;
+  svn_config_t *config;
+
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  svn_stream_t *shared_stream;
+  const char data[] = "Shared blah";
+  svn_string_t *data_string = svn_string_create(data, pool);
+  svn_checksum_t *data_sha1, *data_md5;
+  apr_size_t sz;
+  svn_boolean_t same;
+
+  SVN_ERR(create_repos_and_wc(&wc_abspath, &db,
+                              "pristine_shared", opts, pool));
+
+  shared_abspath = svn_test_data_path("pristine_shared_store", pool);
+  SVN_ERR(svn_io_remove_dir2(shared_abspath, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(shared_abspath);
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_SHARED_PRISTINES, shared_abspath);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+
+  SVN_ERR(svn_wc__db_pristine_read_shared(&shared_stream, db,
+                                          svn_checksum_create(
+                                            svn_checksum_sha1, pool),
+                                          pool, pool));
+  SVN_TEST_ASSERT(shared_stream == NULL);
+
+  /* Installing a text offers it to the shared store. */
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              &data_sha1, &data_md5,
+                                              db, wc_abspath,
+                                              pool, pool));
+  sz = strlen(data);
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+  SVN_ERR(svn_wc__db_pristine_install(install_data,
+                                      data_sha1, data_md5, pool));
+
+  SVN_ERR(svn_wc__db_pristine_read_shared(&shared_stream, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(shared_stream != NULL);
+  SVN_ERR(svn_stream_contents_same2(&same, shared_stream,
+                                    svn_stream_from_string(data_string,
+                                                           pool),
+                                    pool));
+  SVN_TEST_ASSERT(same);
+
+  /* Cleanup keeps it while the working copy uses it... */
+  SVN_ERR(svn_wc__db_pristine_cleanup(db, wc_abspath, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&shared_stream, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(shared_stream != NULL);
+  SVN_ERR(svn_stream_close(shared_stream));
+
+  /* ...but not once no working copy does. */
+  SVN_ERR(svn_wc__db_pristine_remove(db, wc_abspath, data_sha1, pool));
+  SVN_ERR(svn_wc__db_pristine_cleanup(db, wc_abspath, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&shared_stream, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(shared_stream == NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test dehydrating a pristine text and installing it again. */
+static svn_error_t *
+pristine_dehydrated(const svn_test_opts_t *opts,
+                    apr_pool_t *pool)
+{
+  svn_wc__db_t *db;
+  const char *wc_abspath;
+
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  const char data[] = "Dehydrated blah";
+  svn_string_t *data_string = svn_string_create(data, pool);
+  svn_checksum_t *data_sha1, *data_md5;
+  apr_size_t sz;
+  svn_boolean_t present;
+  svn_boolean_t same;
+  svn_error_t *err;
+
+  SVN_ERR(create_repos_and_wc(&wc_abspath, &db,
+                              "pristine_dehydrated", opts, pool));
+
+  /* Texts can only be dropped where the working copy allows it. */
+  SVN_ERR(svn_wc__db_set_pristines_on_demand(db, wc_abspath, TRUE, pool));
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              &data_sha1, &data_md5,
+                                              db, wc_abspath,
+                                              pool, pool));
+  sz = strlen(data);
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+  SVN_ERR(svn_wc__db_pristine_install(install_data,
+                                      data_sha1, data_md5, pool));
+
+  /* A dehydrated text is known, but can't be read. */
+  SVN_ERR(svn_wc__db_pristine_dehydrate(db, wc_abspath, data_sha1, pool));
+  SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                    pool));
+  SVN_TEST_ASSERT(! present);
+  SVN_ERR(svn_wc__db_pristine_read(NULL, NULL, db, wc_abspath, data_sha1,
+                                   pool, pool));
+  err = svn_wc__db_pristine_read(&pristine_stream, NULL, db, wc_abspath,
+                                 data_sha1, pool, pool);
+  SVN_TEST_ASSERT_ERROR(err, SVN_ERR_WC_PRISTINE_DEHYDRATED);
+
+  /* Installing it again puts it back. */
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              &data_sha1, &data_md5,
+                                              db, wc_abspath,
+                                              pool, pool));
+  sz = strlen(data);
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+  SVN_ERR(svn_wc__db_pristine_install(install_data,
+                                      data_sha1, data_md5, pool));
+
+  SVN_ERR(svn_wc__db_pristine_check(&present, db, wc_abspath, data_sha1,
+                                    pool));
+  SVN_TEST_ASSERT(present);
+  SVN_ERR(svn_wc__db_pristine_read(&pristine_stream, NULL, db, wc_abspath,
+                                   data_sha1, pool, pool));
+  SVN_ERR(svn_stream_contents_same2(&same, pristine_stream,
+                                    svn_stream_from_string(data_string,
+                                                           pool),
+                                    pool));
+  SVN_TEST_ASSERT(same);
+
+  /* An unreferenced dehydrated text can still be removed. */
+  SVN_ERR(svn_wc__db_pristine_dehydrate(db, wc_abspath, data_sha1, pool));
+  SVN_ERR(svn_wc__db_pristine_remove(db, wc_abspath, data_sha1, pool));
+  err = svn_wc__db_pristine_read(NULL, NULL, db, wc_abspath, data_sha1,
+                                 pool, pool);
+  SVN_TEST_ASSERT_ERROR(err, SVN_ERR_WC_PATH_NOT_FOUND);
+
+  return SVN_NO_ERROR;
+}
+
 
 static int max_threads = -1;
 
@@ -318,6 +571,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pristine_delete_while_open"),
     SVN_TEST_OPTS_PASS(reject_mismatching_text,
                        "reject_mismatching_text"),
+    SVN_TEST_OPTS_PASS(pristine_compressed,
+                       "pristine_compressed"),
+    SVN_TEST_OPTS_PASS(pristine_shared,
+                       "pristine_shared"),
+    SVN_TEST_OPTS_PASS(pristine_dehydrated,
+                       "pristine_dehydrated"),
     SVN_TEST_NULL
   };
 
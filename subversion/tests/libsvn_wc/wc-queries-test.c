@@ -71,6 +71,7 @@ static const int schema_statements[] =
   /* Usual tables */
   STMT_CREATE_SCHEMA,
   STMT_INSTALL_SCHEMA_STATISTICS,
+  STMT_CREATE_CHECKSUM_CACHE,
   /* Memory tables */
   STMT_CREATE_TARGETS_LIST,
   STMT_CREATE_CHANGELIST_LIST,
@@ -104,6 +105,7 @@ static const int slow_statements[] =
 
   /* Designed as slow to avoid penalty on other queries */
   STMT_SELECT_UNREFERENCED_PRISTINES,
+  STMT_DELETE_CHECKSUM_CACHE_ORPHANS,
 
   /* Slow, but just if foreign keys are enabled:
    * STMT_DELETE_PRISTINE_IF_UNREFERENCED,
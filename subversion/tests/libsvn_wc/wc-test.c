@@ -21,6 +21,8 @@
  * ====================================================================
  */
 
+#include <string.h>
+
 #include <apr_pools.h>
 #include <apr_general.h>
 #include <apr_md5.h>
@@ -493,6 +495,136 @@ test_internal_file_modified(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Baton for merge_queue_done(). */
+typedef struct merge_queue_baton_t
+{
+  apr_array_header_t *installed;
+  apr_pool_t *pool;
+} merge_queue_baton_t;
+
+/* Implements svn_wc__merge_done_func_t. */
+static svn_error_t *
+merge_queue_done(void *baton,
+                 const char *target_abspath,
+                 enum svn_wc_merge_outcome_t content_outcome,
+                 svn_wc_notify_state_t props_outcome,
+                 apr_pool_t *scratch_pool)
+{
+  merge_queue_baton_t *b = baton;
+
+  SVN_TEST_ASSERT(content_outcome == svn_wc_merge_merged);
+  SVN_TEST_ASSERT(props_outcome == svn_wc_notify_state_unchanged);
+  APR_ARRAY_PUSH(b->installed, const char *)
+    = apr_pstrdup(b->pool, target_abspath);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_merge_queue(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  const char *files[] = { "iota", "A/mu", "A/B/lambda", "A/B/E/alpha",
+                          "A/B/E/beta", "A/D/gamma", "A/D/G/pi",
+                          "A/D/G/rho", "A/D/G/tau", "A/D/H/chi" };
+  svn_test__sandbox_t b;
+  svn_wc__merge_queue_t *queue;
+  merge_queue_baton_t baton;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "merge_queue", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  baton.installed = apr_array_make(pool, 0, sizeof(const char *));
+  baton.pool = pool;
+  SVN_ERR(svn_wc__merge_queue_create(&queue, b.wc_ctx, 4, NULL, NULL,
+                                     pool));
+
+  for (i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+      const char *name = svn_relpath_basename(files[i], NULL);
+      const char *left;
+      const char *right;
+      const char *left_abspath;
+      const char *right_abspath;
+
+      svn_pool_clear(iterpool);
+      left = apr_psprintf(iterpool, "This is the file '%s'.\n", name);
+      right = apr_pstrcat(iterpool, left, "merged\n", SVN_VA_NULL);
+
+      /* The queue must not depend on the sources outliving the call. */
+      SVN_ERR(svn_io_write_unique(&left_abspath, NULL, left, strlen(left),
+                                  svn_io_file_del_on_pool_cleanup,
+                                  iterpool));
+      SVN_ERR(svn_io_write_unique(&right_abspath, NULL, right, strlen(right),
+                                  svn_io_file_del_on_pool_cleanup,
+                                  iterpool));
+      SVN_ERR(svn_wc__merge_queue_add(queue, left_abspath, right_abspath,
+                                      sbox_wc_path(&b, files[i]),
+                                      NULL, NULL, NULL, NULL, NULL,
+                                      FALSE, NULL, NULL,
+                                      apr_hash_make(iterpool), NULL, FALSE,
+                                      merge_queue_done, &baton, iterpool));
+    }
+  svn_pool_clear(iterpool);
+  SVN_ERR(svn_wc__merge_queue_flush(queue, iterpool));
+
+  /* All merges got installed in the order they were added. */
+  SVN_TEST_INT_ASSERT(baton.installed->nelts,
+                      sizeof(files) / sizeof(files[0]));
+  for (i = 0; i < baton.installed->nelts; i++)
+    {
+      const char *name = svn_relpath_basename(files[i], NULL);
+      svn_stringbuf_t *contents;
+
+      svn_pool_clear(iterpool);
+      SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(baton.installed, i, const char *),
+                             sbox_wc_path(&b, files[i]));
+      SVN_ERR(svn_stringbuf_from_file2(&contents, sbox_wc_path(&b, files[i]),
+                                       iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             apr_psprintf(iterpool,
+                                          "This is the file '%s'.\n"
+                                          "merged\n", name));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_install_jobs(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  const struct svn_test__tree_entry_t *node;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  SVN_ERR(svn_test__sandbox_create(&b, "install_jobs", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Let the work queue prepare file installs on worker threads. */
+  b.wc_ctx->db->install_jobs = 4;
+
+  SVN_ERR(sbox_wc_update(&b, "", 0));
+  SVN_ERR(sbox_wc_update(&b, "", 1));
+
+  for (node = svn_test__greek_tree_nodes; node->path; node++)
+    {
+      svn_stringbuf_t *contents;
+
+      if (!node->contents)
+        continue;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_stringbuf_from_file2(&contents, sbox_wc_path(&b, node->path),
+                                       iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data, node->contents);
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 /* ---------------------------------------------------------------------- */
 /* The list of test functions */
 
@@ -515,6 +647,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test legacy commit2"),
     SVN_TEST_OPTS_PASS(test_internal_file_modified,
                        "test internal_file_modified"),
+    SVN_TEST_OPTS_PASS(test_merge_queue,
+                       "test svn_wc__merge_queue"),
+    SVN_TEST_OPTS_PASS(test_install_jobs,
+                       "test preparing file installs concurrently"),
     SVN_TEST_NULL
   };
 
@@ -0,0 +1,129 @@
+/* admission-test.c --- tests for svnserve's per-client admission control
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "../../svnserve/admission.c"
+
+#include "../svn_test.h"
+
+
+static svn_error_t *
+test_connection_limit(apr_pool_t *pool)
+{
+  admission_t *admission;
+  admission_client_t *first, *second, *third, *other;
+
+  SVN_ERR(admission__create(&admission, 2, 0, pool));
+
+  SVN_ERR(admission__enter(&first, admission, "192.0.2.1", pool));
+  SVN_ERR(admission__enter(&second, admission, "192.0.2.1", pool));
+  SVN_TEST_ASSERT(first == second);
+
+  /* The third connection from the same address is refused ... */
+  SVN_TEST_ASSERT_ERROR(admission__enter(&third, admission, "192.0.2.1",
+                                         pool),
+                        SVN_ERR_RA_SVN_SERVER_BUSY);
+  SVN_TEST_ASSERT(third == NULL);
+
+  /* ... but other clients are not affected. */
+  SVN_ERR(admission__enter(&other, admission, "192.0.2.2", pool));
+  SVN_TEST_ASSERT(other != first);
+
+  /* Closing a connection makes room for a new one. */
+  admission__leave(first);
+  SVN_ERR(admission__enter(&third, admission, "192.0.2.1", pool));
+  SVN_TEST_ASSERT(third == first);
+  SVN_TEST_ASSERT_ERROR(admission__enter(&third, admission, "192.0.2.1",
+                                         pool),
+                        SVN_ERR_RA_SVN_SERVER_BUSY);
+
+  /* Without a rate limit, commands are never throttled. */
+  SVN_TEST_ASSERT(admission__throttle(first) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_rate_limit(apr_pool_t *pool)
+{
+  admission_t *admission;
+  admission_client_t *client;
+  apr_interval_time_t delay;
+  int i;
+
+  /* At 10 commands per second, a token takes 100ms to refill.  That is
+     far more than the time it takes to run the checks between refills,
+     so we move the client's clock instead of waiting. */
+  SVN_ERR(admission__create(&admission, 0, 10, pool));
+  SVN_ERR(admission__enter(&client, admission, "192.0.2.1", pool));
+
+  /* New clients start with a full bucket. */
+  for (i = 0; i < 10; ++i)
+    SVN_TEST_ASSERT(admission__throttle(client) == 0);
+
+  /* Once it is empty, we have to wait for a token, but no more than
+     the time it takes to refill one. */
+  delay = admission__throttle(client);
+  SVN_TEST_ASSERT(delay > 0 && delay <= APR_USEC_PER_SEC / 10 + 1);
+
+  /* Being refused does not use up tokens. */
+  client->tokens = 0.0;
+  SVN_TEST_ASSERT(admission__throttle(client) > 0);
+  SVN_TEST_ASSERT(admission__throttle(client) > 0);
+
+  /* Half a second refills half of the bucket. */
+  client->last_update -= APR_USEC_PER_SEC / 2;
+  for (i = 0; i < 5; ++i)
+    SVN_TEST_ASSERT(admission__throttle(client) == 0);
+  SVN_TEST_ASSERT(admission__throttle(client) > 0);
+
+  /* The bucket never holds more than one second worth of commands. */
+  client->last_update -= 10 * APR_USEC_PER_SEC;
+  for (i = 0; i < 10; ++i)
+    SVN_TEST_ASSERT(admission__throttle(client) == 0);
+  SVN_TEST_ASSERT(admission__throttle(client) > 0);
+
+  /* Waiting for the delay we were given is enough. */
+  delay = admission__throttle(client);
+  client->last_update -= delay;
+  SVN_TEST_ASSERT(admission__throttle(client) == 0);
+
+  admission__leave(client);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* The test table.  */
+
+static int max_threads = 1;
+
+static struct svn_test_descriptor_t test_funcs[] =
+  {
+    SVN_TEST_NULL,
+    SVN_TEST_PASS2(test_connection_limit,
+                   "refuse connections over the per-client limit"),
+    SVN_TEST_PASS2(test_rate_limit,
+                   "throttle commands and refill the token bucket"),
+    SVN_TEST_NULL
+  };
+
+SVN_TEST_MAIN
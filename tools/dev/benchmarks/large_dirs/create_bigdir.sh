@@ -17,6 +17,9 @@
 # specific language governing permissions and limitations
 # under the License.
 
+# See large_dirs.py for a benchmark covering multiple backends and
+# directory sizes that validates its results and records trends.
+
 # usage: run this script from the root of your working copy
 #        and / or adjust the path settings below as needed
 
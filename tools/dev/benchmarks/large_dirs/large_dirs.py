@@ -0,0 +1,312 @@
+#!/usr/bin/env python
+
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Usage: large_dirs.py [options] [LABEL]
+
+Measure how svn scales with the number of entries in a single directory.
+
+For each filesystem type and directory size, a fresh repository is created
+and the following operations are timed on a single directory containing
+SIZE files:
+
+  add        'svn add' of the new directory
+  commit     committing the added directory
+  ls         'svn ls' of the directory URL
+  update     updating a second working copy that does not have the
+             directory yet
+  delete     'svn rm' of all files in the directory
+  commit-del committing those deletions
+
+After each step, the result is checked (e.g. 'svn ls' must report SIZE
+entries) and the run aborts if svn did not do what it was asked to.
+Creating the files on disk is not timed.
+
+Results are appended to a tab-separated file (default: large_dirs.tsv in
+the current directory) together with LABEL, which defaults to the output
+of 'svn --version --quiet'.  Each run prints its timings next to those of
+the previous run with the same LABEL, or of the last run with any other
+label if this is the first one, and the time per entry relative to the
+smallest size, which should stay close to 1.0 for operations that scale
+linearly.
+
+Filesystem types that 'svnadmin create' rejects, e.g. bdb in builds
+without Berkeley DB support, are reported and skipped.
+
+Examples:
+  ./large_dirs.py --svn-bin-dir ~/svn-prefix/trunk/bin trunk
+  ./large_dirs.py -s 1000,10000 -t fsfs,fsx --root /dev/shm 1.14.x
+"""
+
+import os
+import sys
+import time
+import shutil
+import optparse
+import tempfile
+import subprocess
+
+DEFAULT_SIZES = '1000,10000,100000,1000000'
+DEFAULT_FS_TYPES = 'fsfs,fsx,bdb'
+OPERATIONS = ('add', 'commit', 'ls', 'update', 'delete', 'commit-del')
+
+j = os.path.join
+
+class BenchmarkError(Exception):
+  pass
+
+def bail(msg):
+  sys.stderr.write('large_dirs.py: %s\n' % msg)
+  sys.exit(1)
+
+class Runner:
+  """Runs svn commands from the configured bin dir."""
+
+  def __init__(self, bin_dir, verbose):
+    self.bin_dir = bin_dir
+    self.verbose = verbose
+
+  def tool(self, name):
+    if self.bin_dir:
+      return j(self.bin_dir, name)
+    return name
+
+  def run(self, tool, *args):
+    """Run TOOL with ARGS and return (stdout lines, elapsed seconds).
+    Raise BenchmarkError if the command fails."""
+    cmd = [self.tool(tool)] + list(args)
+    if self.verbose:
+      print('CMD: %s' % ' '.join(cmd))
+
+    start = time.time()
+    try:
+      p = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                           stderr=subprocess.PIPE)
+    except OSError as e:
+      raise BenchmarkError('%s: %s' % (cmd[0], e))
+    stdout, stderr = p.communicate()
+    elapsed = time.time() - start
+
+    if p.returncode != 0:
+      raise BenchmarkError('%s failed:\n%s' % (' '.join(cmd),
+                                               stderr.decode('utf-8',
+                                                             'replace')))
+    return stdout.decode('utf-8', 'replace').splitlines(), elapsed
+
+  def svn(self, *args):
+    return self.run('svn', *args)
+
+def expect(what, actual, expected):
+  if actual != expected:
+    raise BenchmarkError('%s: expected %s, got %s' % (what, expected, actual))
+
+def create_files(dir_path, size):
+  os.mkdir(dir_path)
+  for i in range(size):
+    f = open(j(dir_path, 'f%07d' % i), 'w')
+    f.write('File number %d\n' % i)
+    f.close()
+
+def run_one(runner, root, fs_type, size):
+  """Time all OPERATIONS for SIZE entries in a repository of FS_TYPE below
+  ROOT.  Return a dict mapping operation names to seconds or None if
+  FS_TYPE is not supported."""
+  repo = j(root, 'repo')
+  wc = j(root, 'wc')
+  wc2 = j(root, 'wc2')
+  url = 'file://' + os.path.abspath(repo).replace(os.sep, '/')
+  if not url.startswith('file:///'):
+    url = 'file:///' + url[len('file://'):]
+  dir_url = url + '/big'
+  big = j(wc, 'big')
+  timings = {}
+
+  try:
+    runner.run('svnadmin', 'create', '--fs-type', fs_type, repo)
+  except BenchmarkError as e:
+    print('  %s not supported, skipping: %s' % (fs_type, str(e).strip()))
+    return None
+
+  runner.svn('checkout', '-q', url, wc)
+  runner.svn('checkout', '-q', url, wc2)
+  create_files(big, size)
+
+  lines, timings['add'] = runner.svn('add', '-q', big)
+  lines, elapsed = runner.svn('status', '-q', big)
+  expect('status after add', len(lines), size + 1)
+
+  lines, timings['commit'] = runner.svn('commit', '-q', '-m', 'add', big)
+  lines, elapsed = runner.svn('info', '--show-item', 'revision', url)
+  expect('HEAD after commit', lines[0].strip(), '1')
+
+  lines, timings['ls'] = runner.svn('ls', dir_url)
+  expect('entries listed', len(lines), size)
+
+  lines, timings['update'] = runner.svn('update', '-q', wc2)
+  expect('entries updated', len(os.listdir(j(wc2, 'big'))), size)
+
+  targets = j(root, 'targets')
+  f = open(targets, 'w')
+  for name in sorted(os.listdir(big)):
+    if name != '.svn':
+      f.write(j(big, name) + '\n')
+  f.close()
+
+  lines, timings['delete'] = runner.svn('rm', '-q', '--targets', targets)
+  lines, elapsed = runner.svn('status', '-q', big)
+  expect('status after delete', len(lines), size)
+
+  lines, timings['commit-del'] = runner.svn('commit', '-q', '-m', 'del', big)
+  lines, elapsed = runner.svn('ls', dir_url)
+  expect('entries after delete', len(lines), 0)
+
+  return timings
+
+def read_results(path):
+  """Return the rows of the results file at PATH as lists of strings."""
+  rows = []
+  if os.path.exists(path):
+    for line in open(path):
+      fields = line.rstrip('\n').split('\t')
+      if len(fields) == 6 and not line.startswith('#'):
+        rows.append(fields)
+  return rows
+
+def find_previous(rows, label):
+  """Return a dict (fs_type, size, operation) -> seconds for the most
+  recent run in ROWS with LABEL, or with any other label if there is none,
+  and that run's label."""
+  runs = [r[0] for r in rows if r[1] == label] \
+         or [r[0] for r in rows]
+  if not runs:
+    return {}, None
+
+  last = max(runs)
+  previous = {}
+  prev_label = None
+  for run, row_label, fs_type, size, op, seconds in rows:
+    if run == last:
+      previous[(fs_type, int(size), op)] = float(seconds)
+      prev_label = row_label
+  return previous, prev_label
+
+def main():
+  parser = optparse.OptionParser(usage=__doc__)
+  parser.add_option('-b', '--svn-bin-dir', default=None,
+                    help='directory containing svn and svnadmin '
+                         '(default: use $PATH)')
+  parser.add_option('-s', '--sizes', default=DEFAULT_SIZES,
+                    help='comma separated directory sizes '
+                         '(default: %s)' % DEFAULT_SIZES)
+  parser.add_option('-t', '--fs-types', default=DEFAULT_FS_TYPES,
+                    help='comma separated filesystem types '
+                         '(default: %s)' % DEFAULT_FS_TYPES)
+  parser.add_option('-r', '--root', default=None,
+                    help='directory for temporary repositories and '
+                         'working copies (default: system temp dir)')
+  parser.add_option('-f', '--results', default='large_dirs.tsv',
+                    help='file to append results to and to compare with '
+                         '(default: %default)')
+  parser.add_option('-v', '--verbose', action='store_true', default=False,
+                    help='print the commands being run')
+  options, args = parser.parse_args()
+
+  if len(args) > 1:
+    parser.print_help()
+    sys.exit(1)
+
+  try:
+    sizes = sorted(int(s) for s in options.sizes.split(','))
+  except ValueError:
+    bail('invalid --sizes: %s' % options.sizes)
+  if not sizes or sizes[0] < 1:
+    bail('invalid --sizes: %s' % options.sizes)
+  fs_types = [t for t in options.fs_types.split(',') if t]
+
+  runner = Runner(options.svn_bin_dir, options.verbose)
+  try:
+    runner.run('svnadmin', '--version', '--quiet')
+    version = runner.svn('--version', '--quiet')[0][0].strip()
+  except BenchmarkError as e:
+    bail(str(e))
+  if args:
+    label = args[0]
+  else:
+    label = version
+
+  rows = read_results(options.results)
+  previous, prev_label = find_previous(rows, label)
+  run_id = time.strftime('%Y-%m-%d %H:%M:%S')
+
+  print('Label:    %s' % label)
+  if prev_label:
+    print('Previous: %s' % prev_label)
+  print('')
+  print('%-5s %8s %-10s %10s %10s %7s %9s'
+        % ('fs', 'entries', 'operation', 'seconds', 'previous', 'change',
+           'per-entry'))
+
+  results = open(options.results, 'a')
+  if not rows:
+    results.write('# run\tlabel\tfs-type\tentries\toperation\tseconds\n')
+
+  try:
+    for fs_type in fs_types:
+      base = {}
+      for size in sizes:
+        root = tempfile.mkdtemp(prefix='large_dirs-', dir=options.root)
+        try:
+          timings = run_one(runner, root, fs_type, size)
+        except BenchmarkError as e:
+          bail('%s, %d entries: %s' % (fs_type, size, e))
+        finally:
+          shutil.rmtree(root, ignore_errors=True)
+
+        if timings is None:
+          break
+
+        for op in OPERATIONS:
+          seconds = timings[op]
+          results.write('%s\t%s\t%s\t%d\t%s\t%.3f\n'
+                        % (run_id, label, fs_type, size, op, seconds))
+
+          old = previous.get((fs_type, size, op))
+          if old:
+            old_str = '%.3f' % old
+            change_str = '%+.0f%%' % ((seconds - old) * 100.0 / old)
+          else:
+            old_str = change_str = '-'
+
+          # Time per entry relative to the smallest size.
+          if op not in base:
+            base[op] = (seconds / size, size)
+          base_per_entry = base[op][0]
+          if base_per_entry > 0:
+            scale_str = '%.2f' % (seconds / size / base_per_entry)
+          else:
+            scale_str = '-'
+
+          print('%-5s %8d %-10s %10.3f %10s %7s %9s'
+                % (fs_type, size, op, seconds, old_str, change_str,
+                   scale_str))
+        results.flush()
+  finally:
+    results.close()
+
+if __name__ == '__main__':
+  main()
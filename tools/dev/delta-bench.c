@@ -0,0 +1,143 @@
+/* delta-bench.c -- measure speed and output size of the delta engine
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <stdlib.h>
+
+#include "svn_pools.h"
+#include "svn_cmdline.h"
+#include "svn_string.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
+#include "svn_delta.h"
+#include "svn_time.h"
+
+#include "svn_private_config.h"
+
+/* Implements svn_write_fn_t.  Add the length of DATA to the counter
+   in BATON and discard the data. */
+static svn_error_t *
+count_bytes(void *baton, const char *data, apr_size_t *len)
+{
+  apr_uint64_t *total = baton;
+  *total += *len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Compute the uncompressed svndiff of TARGET against SOURCE and set
+   *DELTA_SIZE to its length in bytes. */
+static svn_error_t *
+run_delta(apr_uint64_t *delta_size,
+          const svn_stringbuf_t *source,
+          const svn_stringbuf_t *target,
+          apr_pool_t *scratch_pool)
+{
+  svn_txdelta_stream_t *txstream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_stream_t *out = svn_stream_create(delta_size, scratch_pool);
+
+  *delta_size = 0;
+  svn_stream_set_write(out, count_bytes);
+
+  svn_txdelta2(&txstream,
+               svn_stream_from_stringbuf((svn_stringbuf_t *)source,
+                                         scratch_pool),
+               svn_stream_from_stringbuf((svn_stringbuf_t *)target,
+                                         scratch_pool),
+               FALSE, scratch_pool);
+  svn_txdelta_to_svndiff3(&handler, &handler_baton, out, 0,
+                          SVN_DELTA_COMPRESSION_LEVEL_NONE, scratch_pool);
+
+  return svn_error_trace(svn_txdelta_send_txstream(txstream, handler,
+                                                   handler_baton,
+                                                   scratch_pool));
+}
+
+static svn_error_t *
+run_bench(const char *source_path,
+          const char *target_path,
+          int iterations,
+          apr_pool_t *pool)
+{
+  svn_stringbuf_t *source, *target;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_uint64_t delta_size = 0;
+  apr_time_t start, elapsed;
+  double seconds;
+  int i;
+
+  SVN_ERR(svn_stringbuf_from_file2(&source, source_path, pool));
+  SVN_ERR(svn_stringbuf_from_file2(&target, target_path, pool));
+
+  start = apr_time_now();
+  for (i = 0; i < iterations; ++i)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(run_delta(&delta_size, source, target, iterpool));
+    }
+  elapsed = apr_time_now() - start;
+  svn_pool_destroy(iterpool);
+
+  seconds = elapsed > 0 ? (double)elapsed / APR_USEC_PER_SEC : 1e-6;
+  SVN_ERR(svn_cmdline_printf(pool, _("Source size: %" APR_SIZE_T_FMT "\n"),
+                             source->len));
+  SVN_ERR(svn_cmdline_printf(pool, _("Target size: %" APR_SIZE_T_FMT "\n"),
+                             target->len));
+  SVN_ERR(svn_cmdline_printf(pool, _("Delta size: %" APR_UINT64_T_FMT "\n"),
+                             delta_size));
+  SVN_ERR(svn_cmdline_printf(pool, _("Time per run: %.3f ms\n"),
+                             seconds * 1000 / iterations));
+  SVN_ERR(svn_cmdline_printf(pool, _("Throughput: %.1f MB/s\n"),
+                             (double)target->len * iterations
+                               / seconds / (1024 * 1024)));
+
+  return SVN_NO_ERROR;
+}
+
+int main (int argc, const char *argv[])
+{
+  apr_pool_t *pool = NULL;
+  svn_error_t *err;
+  int iterations = 10;
+
+  apr_initialize();
+  atexit(apr_terminate);
+
+  pool = svn_pool_create(NULL);
+
+  if (argc < 3 || argc > 4)
+    err = svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                           _("Usage: delta-bench SOURCE TARGET [ITERATIONS]"));
+  else if (argc == 4 && (iterations = atoi(argv[3])) <= 0)
+    err = svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                            _("Invalid iteration count '%s'"), argv[3]);
+  else
+    err = run_bench(svn_dirent_canonicalize(argv[1], pool),
+                    svn_dirent_canonicalize(argv[2], pool),
+                    iterations, pool);
+
+  if (err)
+    return svn_cmdline_handle_exit_error(err, pool, "delta-bench: ");
+
+  return 0;
+}
@@ -0,0 +1,521 @@
+/* fsfs-replay.c -- replay an FSFS I/O trace against a repository
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* The trace files are written by FSFS when the "io-trace-file" option
+ * in the [debug] section of fsfs.conf is set.  Each line describes one
+ * logical read as
+ *
+ *     TIME CAUSE FILE OFFSET LENGTH
+ *
+ * This tool reads the very same data again, block by block, from the
+ * files below FS_DB_PATH.  Block size and (simulated) cache size can be
+ * varied to evaluate layout and caching changes without having to re-run
+ * the original workload.
+ */
+
+#include <stdlib.h>
+
+#include "svn_pools.h"
+#include "svn_cmdline.h"
+#include "svn_string.h"
+#include "svn_dirent_uri.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_time.h"
+
+#include "svn_private_config.h"
+
+/* Read causes as written by FSFS, see svn_fs_fs__io_cause_t. */
+static const char *cause_names[] =
+{
+  "footer",
+  "l2p",
+  "p2l",
+  "noderev",
+  "changes",
+  "rep",
+  "block"
+};
+
+#define CAUSE_COUNT ((int)(sizeof(cause_names) / sizeof(cause_names[0])))
+
+/* A file referenced by the trace.  There is one instance per path. */
+typedef struct file_info_t
+{
+  /* path relative to FS_DB_PATH, as found in the trace */
+  const char *path;
+
+  /* unique number used in cache keys */
+  int id;
+
+  /* file handle, opened upon first access */
+  apr_file_t *file;
+} file_info_t;
+
+/* A single trace record. */
+typedef struct record_t
+{
+  /* index into CAUSE_NAMES */
+  int cause;
+
+  /* file being read */
+  file_info_t *file;
+
+  /* first byte to read */
+  apr_off_t offset;
+
+  /* number of bytes to read; 0 if unknown */
+  apr_size_t len;
+} record_t;
+
+/* Entry in the simulated block cache.  Entries form a doubly-linked
+ * list in LRU order. */
+typedef struct cache_entry_t
+{
+  /* key in CACHE_T.ENTRIES */
+  const char *key;
+
+  struct cache_entry_t *prev;
+  struct cache_entry_t *next;
+} cache_entry_t;
+
+/* Simulated LRU block cache. */
+typedef struct cache_t
+{
+  /* key -> cache_entry_t * */
+  apr_hash_t *entries;
+
+  /* most and least recently used entries */
+  cache_entry_t *first;
+  cache_entry_t *last;
+
+  /* current and maximum number of entries */
+  apr_size_t count;
+  apr_size_t capacity;
+
+  /* unused entries, available for re-use */
+  cache_entry_t *free_list;
+
+  apr_pool_t *pool;
+} cache_t;
+
+/* Per-cause statistics of a replay pass. */
+typedef struct cause_stats_t
+{
+  /* number of trace records */
+  apr_int64_t accesses;
+
+  /* number of blocks touched */
+  apr_int64_t blocks;
+
+  /* number of blocks found in the simulated cache */
+  apr_int64_t hits;
+
+  /* number of bytes actually read from disk */
+  apr_int64_t bytes;
+} cause_stats_t;
+
+/* Return the file_info_t for PATH in FILES, creating it in POOL if it
+ * does not exist, yet. */
+static file_info_t *
+get_file(apr_hash_t *files,
+         const char *path,
+         apr_pool_t *pool)
+{
+  file_info_t *info = svn_hash_gets(files, path);
+  if (info == NULL)
+    {
+      info = apr_pcalloc(pool, sizeof(*info));
+      info->path = apr_pstrdup(pool, path);
+      info->id = apr_hash_count(files);
+      svn_hash_sets(files, info->path, info);
+    }
+
+  return info;
+}
+
+/* Parse the trace at TRACE_PATH and return its records in *RECORDS.
+ * Intern file names in FILES.  Allocate everything in POOL. */
+static svn_error_t *
+read_trace(apr_array_header_t **records,
+           apr_hash_t *files,
+           const char *trace_path,
+           apr_pool_t *pool)
+{
+  svn_stream_t *stream;
+  svn_boolean_t eof = FALSE;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_int64_t line_no = 0;
+
+  *records = apr_array_make(pool, 0x10000, sizeof(record_t));
+  SVN_ERR(svn_stream_open_readonly(&stream, trace_path, pool, iterpool));
+
+  while (!eof)
+    {
+      svn_stringbuf_t *line;
+      apr_array_header_t *tokens;
+      record_t *record;
+      apr_int64_t value;
+      int cause;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_stream_readline(stream, &line, "\n", &eof, iterpool));
+      ++line_no;
+      if (line->len == 0)
+        continue;
+
+      tokens = svn_cstring_split(line->data, " ", TRUE, iterpool);
+      if (tokens->nelts != 5)
+        return svn_error_createf(SVN_ERR_MALFORMED_FILE, NULL,
+                                 _("Malformed trace record in line %s"),
+                                 apr_psprintf(iterpool, "%" APR_INT64_T_FMT,
+                                              line_no));
+
+      for (cause = 0; cause < CAUSE_COUNT; ++cause)
+        if (!strcmp(APR_ARRAY_IDX(tokens, 1, const char *),
+                    cause_names[cause]))
+          break;
+
+      if (cause == CAUSE_COUNT)
+        return svn_error_createf(SVN_ERR_MALFORMED_FILE, NULL,
+                                 _("Unknown read cause '%s'"),
+                                 APR_ARRAY_IDX(tokens, 1, const char *));
+
+      record = apr_array_push(*records);
+      record->cause = cause;
+      record->file = get_file(files, APR_ARRAY_IDX(tokens, 2, const char *),
+                              pool);
+
+      SVN_ERR(svn_cstring_atoi64(&value,
+                                 APR_ARRAY_IDX(tokens, 3, const char *)));
+      record->offset = (apr_off_t)value;
+      SVN_ERR(svn_cstring_atoi64(&value,
+                                 APR_ARRAY_IDX(tokens, 4, const char *)));
+      record->len = (apr_size_t)value;
+    }
+
+  svn_pool_destroy(iterpool);
+  SVN_ERR(svn_stream_close(stream));
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove ENTRY from the LRU list in CACHE. */
+static void
+unlink_entry(cache_t *cache,
+             cache_entry_t *entry)
+{
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    cache->first = entry->next;
+
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  else
+    cache->last = entry->prev;
+}
+
+/* Make ENTRY the most recently used entry in CACHE. */
+static void
+link_entry(cache_t *cache,
+           cache_entry_t *entry)
+{
+  entry->prev = NULL;
+  entry->next = cache->first;
+  if (cache->first)
+    cache->first->prev = entry;
+  else
+    cache->last = entry;
+
+  cache->first = entry;
+}
+
+/* Look up block BLOCK of FILE in CACHE and return TRUE if it has been
+ * found.  Otherwise, add it to the cache, evicting the least recently
+ * used entry if necessary, and return FALSE.  A CACHE with 0 capacity
+ * never hits. */
+static svn_boolean_t
+cache_lookup(cache_t *cache,
+             file_info_t *file,
+             apr_int64_t block)
+{
+  char key[64];
+  cache_entry_t *entry;
+
+  if (cache->capacity == 0)
+    return FALSE;
+
+  apr_snprintf(key, sizeof(key), "%d:%" APR_INT64_T_FMT, file->id, block);
+  entry = svn_hash_gets(cache->entries, key);
+  if (entry)
+    {
+      unlink_entry(cache, entry);
+      link_entry(cache, entry);
+      return TRUE;
+    }
+
+  if (cache->count == cache->capacity)
+    {
+      entry = cache->last;
+      unlink_entry(cache, entry);
+      svn_hash_sets(cache->entries, entry->key, NULL);
+      entry->next = cache->free_list;
+      cache->free_list = entry;
+      --cache->count;
+    }
+
+  if (cache->free_list)
+    {
+      entry = cache->free_list;
+      cache->free_list = entry->next;
+    }
+  else
+    {
+      entry = apr_palloc(cache->pool, sizeof(*entry));
+    }
+
+  /* Keys are short, so leaking them upon eviction is acceptable. */
+  entry->key = apr_pstrdup(cache->pool, key);
+  svn_hash_sets(cache->entries, entry->key, entry);
+  link_entry(cache, entry);
+  ++cache->count;
+
+  return FALSE;
+}
+
+/* Read block BLOCK of size BLOCK_SIZE from FILE below DB_PATH into
+ * BUFFER and add the number of bytes read to *BYTES. */
+static svn_error_t *
+read_block(apr_int64_t *bytes,
+           file_info_t *file,
+           const char *db_path,
+           apr_int64_t block,
+           apr_size_t block_size,
+           char *buffer,
+           apr_pool_t *pool)
+{
+  apr_off_t offset = (apr_off_t)(block * block_size);
+  apr_size_t read = 0;
+
+  if (file->file == NULL)
+    SVN_ERR(svn_io_file_open(&file->file,
+                             svn_dirent_join(db_path, file->path, pool),
+                             APR_READ | APR_BUFFERED, APR_OS_DEFAULT, pool));
+
+  SVN_ERR(svn_io_file_seek(file->file, APR_SET, &offset, pool));
+  SVN_ERR(svn_io_file_read_full2(file->file, buffer, block_size, &read,
+                                 NULL, pool));
+  *bytes += read;
+
+  return SVN_NO_ERROR;
+}
+
+/* Replay all RECORDS once against the files below DB_PATH, reading
+ * BLOCK_SIZE bytes at a time and skipping blocks found in CACHE.
+ * Accumulate statistics per cause in STATS. */
+static svn_error_t *
+replay(cause_stats_t *stats,
+       apr_array_header_t *records,
+       const char *db_path,
+       apr_size_t block_size,
+       cache_t *cache,
+       apr_pool_t *pool)
+{
+  char *buffer = apr_palloc(pool, block_size);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  for (i = 0; i < records->nelts; ++i)
+    {
+      const record_t *record = &APR_ARRAY_IDX(records, i, record_t);
+      cause_stats_t *cause_stats = &stats[record->cause];
+      apr_size_t len = record->len ? record->len : 1;
+      apr_int64_t block = record->offset / block_size;
+      apr_int64_t last = (record->offset + len - 1) / block_size;
+
+      svn_pool_clear(iterpool);
+      ++cause_stats->accesses;
+
+      for (; block <= last; ++block)
+        {
+          ++cause_stats->blocks;
+          if (cache_lookup(cache, record->file, block))
+            ++cause_stats->hits;
+          else
+            SVN_ERR(read_block(&cause_stats->bytes, record->file, db_path,
+                               block, block_size, buffer, iterpool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Print STATS for pass PASS which took ELAPSED microseconds. */
+static svn_error_t *
+print_stats(const cause_stats_t *stats,
+            int pass,
+            apr_time_t elapsed,
+            apr_pool_t *pool)
+{
+  cause_stats_t total = { 0 };
+  double seconds = elapsed > 0 ? (double)elapsed / APR_USEC_PER_SEC : 1e-6;
+  int i;
+
+  SVN_ERR(svn_cmdline_printf(pool, _("\nPass %d:\n"), pass));
+  SVN_ERR(svn_cmdline_printf(pool, "%-8s %12s %12s %12s %14s\n",
+                             _("cause"), _("accesses"), _("blocks"),
+                             _("hits"), _("bytes read")));
+  for (i = 0; i < CAUSE_COUNT; ++i)
+    {
+      if (stats[i].accesses == 0)
+        continue;
+
+      SVN_ERR(svn_cmdline_printf(pool,
+                                 "%-8s %12" APR_INT64_T_FMT
+                                 " %12" APR_INT64_T_FMT
+                                 " %12" APR_INT64_T_FMT
+                                 " %14" APR_INT64_T_FMT "\n",
+                                 cause_names[i], stats[i].accesses,
+                                 stats[i].blocks, stats[i].hits,
+                                 stats[i].bytes));
+      total.accesses += stats[i].accesses;
+      total.blocks += stats[i].blocks;
+      total.hits += stats[i].hits;
+      total.bytes += stats[i].bytes;
+    }
+
+  SVN_ERR(svn_cmdline_printf(pool,
+                             "%-8s %12" APR_INT64_T_FMT
+                             " %12" APR_INT64_T_FMT
+                             " %12" APR_INT64_T_FMT
+                             " %14" APR_INT64_T_FMT "\n",
+                             _("total"), total.accesses, total.blocks,
+                             total.hits, total.bytes));
+  SVN_ERR(svn_cmdline_printf(pool, _("Time: %.3f s\n"), seconds));
+  SVN_ERR(svn_cmdline_printf(pool, _("Throughput: %.1f MB/s\n"),
+                             (double)total.bytes / seconds / (1024 * 1024)));
+
+  return SVN_NO_ERROR;
+}
+
+/* Replay the trace at TRACE_PATH PASSES times against DB_PATH. */
+static svn_error_t *
+run_replay(const char *db_path,
+           const char *trace_path,
+           apr_size_t block_size,
+           apr_size_t cache_size,
+           int passes,
+           apr_pool_t *pool)
+{
+  apr_hash_t *files = apr_hash_make(pool);
+  apr_array_header_t *records;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  cache_t cache = { 0 };
+  int pass;
+
+  SVN_ERR(read_trace(&records, files, trace_path, pool));
+  SVN_ERR(svn_cmdline_printf(pool,
+                             _("%d records in %u files, block size %"
+                               APR_SIZE_T_FMT ", cache size %"
+                               APR_SIZE_T_FMT " blocks\n"),
+                             records->nelts, apr_hash_count(files),
+                             block_size, cache_size / block_size));
+
+  /* The cache persists across passes, i.e. later passes show the effect
+   * of a warm cache. */
+  cache.entries = apr_hash_make(pool);
+  cache.capacity = cache_size / block_size;
+  cache.pool = pool;
+
+  for (pass = 1; pass <= passes; ++pass)
+    {
+      cause_stats_t stats[CAUSE_COUNT] = { { 0 } };
+      apr_time_t start;
+
+      svn_pool_clear(iterpool);
+
+      start = apr_time_now();
+      SVN_ERR(replay(stats, records, db_path, block_size, &cache, iterpool));
+      SVN_ERR(print_stats(stats, pass, apr_time_now() - start, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static void
+print_usage(void)
+{
+  printf("fsfs-replay [-b BLOCK_SIZE] [-c CACHE_MB] [-n PASSES] "
+         "FS_DB_PATH TRACE_FILE\n\n");
+  printf("Reads the data recorded in TRACE_FILE from the FSFS repository\n");
+  printf("at FS_DB_PATH again, BLOCK_SIZE bytes at a time (default: 65536).\n");
+  printf("Blocks found in a simulated LRU cache of CACHE_MB megabytes\n");
+  printf("(default: 0, i.e. no cache) will not be read.  The trace will be\n");
+  printf("replayed PASSES times (default: 1).\n");
+}
+
+int main(int argc, const char *argv[])
+{
+  apr_pool_t *pool = NULL;
+  svn_error_t *err = SVN_NO_ERROR;
+  apr_size_t block_size = 0x10000;
+  apr_size_t cache_size = 0;
+  int passes = 1;
+  int i;
+
+  apr_initialize();
+  atexit(apr_terminate);
+
+  pool = svn_pool_create(NULL);
+
+  for (i = 1; i + 1 < argc && argv[i][0] == '-'; i += 2)
+    {
+      int value = atoi(argv[i + 1]);
+      if (!strcmp(argv[i], "-b") && value > 0)
+        block_size = value;
+      else if (!strcmp(argv[i], "-c") && value >= 0)
+        cache_size = (apr_size_t)value * 1024 * 1024;
+      else if (!strcmp(argv[i], "-n") && value > 0)
+        passes = value;
+      else
+        break;
+    }
+
+  if (argc - i != 2)
+    {
+      print_usage();
+      return 1;
+    }
+
+  err = run_replay(svn_dirent_internal_style(argv[i], pool),
+                   svn_dirent_internal_style(argv[i + 1], pool),
+                   block_size, cache_size, passes, pool);
+  if (err)
+    return svn_cmdline_handle_exit_error(err, pool, "fsfs-replay: ");
+
+  return 0;
+}